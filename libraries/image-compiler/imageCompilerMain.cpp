@@ -61,11 +61,10 @@ int main(int argc, char *argv[])
       return 1;
    }
    theTheme.SetFilePath(argv[1]);
-   const std::vector<unsigned char> empty;
    std::list<ThemeBase::RegisteredTheme> registrations;
    for (int ii = 2; ii < argc; ++ii)
       registrations.emplace_back( EnumValueSymbol{ argv[ii], {} },
-         PreferredSystemAppearance::Light, empty );
+         PreferredSystemAppearance::Light, nullptr, 0 );
 
    wxDISABLE_DEBUG_SUPPORT();
    
@@ -17,6 +17,7 @@ Paul Licameli split from AudioIO.cpp
 #include <wx/sstream.h>
 #include <wx/txtstrm.h>
 
+#include "DeviceManager.h"
 #include "IteratorX.h"
 #include "Meter.h"
 #include "Prefs.h"
@@ -384,6 +385,9 @@ std::vector<long> AudioIOBase::GetSupportedPlaybackRates(int devIndex, double ra
       return mCachedPlaybackRates;
    }
 
+   // The rates are found by opening the device
+   DeviceManager::Instance()->AwaitScan();
+
    std::vector<long> supported;
    int irate = (int)rate;
    const PaDeviceInfo* devInfo = NULL;
@@ -449,6 +453,9 @@ std::vector<long> AudioIOBase::GetSupportedCaptureRates(int devIndex, double rat
       return mCachedCaptureRates;
    }
 
+   // The rates are found by opening the device
+   DeviceManager::Instance()->AwaitScan();
+
    std::vector<long> supported;
    int irate = (int)rate;
    const PaDeviceInfo* devInfo = NULL;
@@ -585,6 +592,8 @@ int AudioIOBase::getRecordSourceIndex(PxMixer *portMixer)
 
 int AudioIOBase::getPlayDevIndex(const wxString &devNameArg)
 {
+   DeviceManager::Instance()->AwaitPortAudio();
+
    wxString devName(devNameArg);
    // if we don't get given a device, look up the preferences
    if (devName.empty())
@@ -640,6 +649,8 @@ int AudioIOBase::getPlayDevIndex(const wxString &devNameArg)
 
 int AudioIOBase::getRecordDevIndex(const wxString &devNameArg)
 {
+   DeviceManager::Instance()->AwaitPortAudio();
+
    wxString devName(devNameArg);
    // if we don't get given a device, look up the preferences
    if (devName.empty())
@@ -697,6 +708,8 @@ int AudioIOBase::getRecordDevIndex(const wxString &devNameArg)
 
 wxString AudioIOBase::GetDeviceInfo() const
 {
+   DeviceManager::Instance()->AwaitPortAudio();
+
    wxStringOutputStream o;
    wxTextOutputStream s(o, wxEOL_UNIX);
 
@@ -10,6 +10,7 @@
 #include "DeviceManager.h"
 
 #include <wx/log.h>
+#include <algorithm>
 #include <thread>
 
 
@@ -24,6 +25,9 @@
 #endif
 
 #include "AudioIOBase.h"
+#include "BasicUI.h"
+#include "Prefs.h"
+#include "Tracing.h"
 
 #include "DeviceChange.h" // for HAVE_DEVICE_CHANGE
 
@@ -61,6 +65,7 @@ wxString MakeDeviceSourceString(const DeviceSourceMap *map)
 
 DeviceSourceMap* DeviceManager::GetDefaultDevice(int hostIndex, int isInput)
 {
+   AwaitPortAudio();
    if (hostIndex < 0 || hostIndex >= Pa_GetHostApiCount()) {
       return NULL;
    }
@@ -233,28 +238,100 @@ static void AddSources(int deviceIndex, int rate, std::vector<DeviceSourceMap> *
    }
 }
 
+auto DeviceManager::Scan() -> DeviceMaps
+{
+   DeviceMaps result;
+
+   // FIXME: TRAP_ERR PaErrorCode not handled in ReScan()
+   int nDevices = Pa_GetDeviceCount();
+
+   //The hierarchy for devices is Host/device/source.
+   //Some newer systems aggregate this.
+   //So we need to call port mixer for every device to get the sources
+   for (int i = 0; i < nDevices; i++) {
+      const PaDeviceInfo *info = Pa_GetDeviceInfo(i);
+      if (info->maxOutputChannels > 0) {
+         AddSources(i, info->defaultSampleRate, &result.outputs, 0);
+      }
+
+      if (info->maxInputChannels > 0) {
+         AddSources(i, info->defaultSampleRate, &result.inputs, 1);
+      }
+   }
+   return result;
+}
+
+namespace {
+const auto InputsCachePath = wxT("/DeviceCache/Inputs");
+const auto OutputsCachePath = wxT("/DeviceCache/Outputs");
+
+bool SameMaps(
+   const std::vector<DeviceSourceMap> &a, const std::vector<DeviceSourceMap> &b)
+{
+   return std::equal(a.begin(), a.end(), b.begin(), b.end(),
+      [](const DeviceSourceMap &x, const DeviceSourceMap &y){
+         return x.deviceIndex == y.deviceIndex &&
+            x.sourceIndex == y.sourceIndex &&
+            x.hostIndex == y.hostIndex &&
+            x.totalSources == y.totalSources &&
+            x.numChannels == y.numChannels &&
+            x.sourceString == y.sourceString &&
+            x.deviceString == y.deviceString &&
+            x.hostString == y.hostString;
+      });
+}
+
+void WriteMaps(const wxString &path, const std::vector<DeviceSourceMap> &maps)
+{
+   gPrefs->DeleteGroup(path);
+   gPrefs->Write(path + wxT("/Count"), static_cast<int>(maps.size()));
+   for (size_t ii = 0; ii < maps.size(); ++ii) {
+      const auto &map = maps[ii];
+      const auto prefix = wxString::Format(wxT("%s/%d/"), path, int(ii));
+      gPrefs->Write(prefix + wxT("DeviceIndex"), map.deviceIndex);
+      gPrefs->Write(prefix + wxT("SourceIndex"), map.sourceIndex);
+      gPrefs->Write(prefix + wxT("HostIndex"), map.hostIndex);
+      gPrefs->Write(prefix + wxT("TotalSources"), map.totalSources);
+      gPrefs->Write(prefix + wxT("NumChannels"), map.numChannels);
+      gPrefs->Write(prefix + wxT("Source"), map.sourceString);
+      gPrefs->Write(prefix + wxT("Device"), map.deviceString);
+      gPrefs->Write(prefix + wxT("Host"), map.hostString);
+   }
+}
+
+bool ReadMaps(const wxString &path, std::vector<DeviceSourceMap> &maps)
+{
+   int count = 0;
+   if (!gPrefs->Read(path + wxT("/Count"), &count))
+      return false;
+   for (int ii = 0; ii < count; ++ii) {
+      DeviceSourceMap map;
+      const auto prefix = wxString::Format(wxT("%s/%d/"), path, ii);
+      if (!(gPrefs->Read(prefix + wxT("DeviceIndex"), &map.deviceIndex) &&
+            gPrefs->Read(prefix + wxT("SourceIndex"), &map.sourceIndex) &&
+            gPrefs->Read(prefix + wxT("HostIndex"), &map.hostIndex) &&
+            gPrefs->Read(prefix + wxT("TotalSources"), &map.totalSources) &&
+            gPrefs->Read(prefix + wxT("NumChannels"), &map.numChannels) &&
+            gPrefs->Read(prefix + wxT("Source"), &map.sourceString) &&
+            gPrefs->Read(prefix + wxT("Device"), &map.deviceString) &&
+            gPrefs->Read(prefix + wxT("Host"), &map.hostString)))
+         return false;
+      maps.push_back(map);
+   }
+   return true;
+}
+}
+
 /// Gets a NEW list of devices by terminating and restarting portaudio
 /// Assumes that DeviceManager is only used on the main thread.
 void DeviceManager::Rescan()
 {
-   // get rid of the previous scan info
-   this->mInputDeviceSourceMaps.clear();
-   this->mOutputDeviceSourceMaps.clear();
+   // Finish any scan in the background first, which may use portaudio
+   AwaitScan();
 
    // if we are doing a second scan then restart portaudio to get NEW devices
    if (m_inited) {
-      // check to see if there is a stream open - can happen if monitoring,
-      // but otherwise Rescan() should not be available to the user.
-      auto gAudioIO = AudioIOBase::Get();
-      if (gAudioIO) {
-         if (gAudioIO->IsMonitoring())
-         {
-            using namespace std::chrono;
-            gAudioIO->StopStream();
-            while (gAudioIO->IsBusy())
-               std::this_thread::sleep_for(100ms);
-         }
-      }
+      StopMonitoring();
 
       // restart portaudio - this updates the device list
       // FIXME: TRAP_ERR restarting PortAudio
@@ -262,29 +339,103 @@ void DeviceManager::Rescan()
       Pa_Initialize();
    }
 
-   // FIXME: TRAP_ERR PaErrorCode not handled in ReScan()
-   int nDevices = Pa_GetDeviceCount();
+   AdoptScan(Scan());
+}
 
-   //The hierarchy for devices is Host/device/source.
-   //Some newer systems aggregate this.
-   //So we need to call port mixer for every device to get the sources
-   for (int i = 0; i < nDevices; i++) {
-      const PaDeviceInfo *info = Pa_GetDeviceInfo(i);
-      if (info->maxOutputChannels > 0) {
-         AddSources(i, info->defaultSampleRate, &mOutputDeviceSourceMaps, 0);
+void DeviceManager::StopMonitoring()
+{
+   // check to see if there is a stream open - can happen if monitoring,
+   // but otherwise Rescan() should not be available to the user.
+   auto gAudioIO = AudioIOBase::Get();
+   if (gAudioIO) {
+      if (gAudioIO->IsMonitoring())
+      {
+         using namespace std::chrono;
+         gAudioIO->StopStream();
+         while (gAudioIO->IsBusy())
+            std::this_thread::sleep_for(100ms);
       }
+   }
+}
 
-      if (info->maxInputChannels > 0) {
-         AddSources(i, info->defaultSampleRate, &mInputDeviceSourceMaps, 1);
-      }
+void DeviceManager::StartScan()
+{
+   if (m_inited || mPendingScan.valid())
+      return;
+
+   // Devices of the previous session serve until the scan validates them
+   DeviceMaps cached;
+   if (ReadMaps(InputsCachePath, cached.inputs) &&
+       ReadMaps(OutputsCachePath, cached.outputs)) {
+      mInputDeviceSourceMaps = std::move(cached.inputs);
+      mOutputDeviceSourceMaps = std::move(cached.outputs);
+      m_inited = true;
    }
+   ScanInBackground(false);
+}
+
+void DeviceManager::ScanInBackground(bool restart)
+{
+   mRestarting = restart;
+   mPendingScan = std::async(std::launch::async, [this, restart]{
+      TRACE_SCOPE("DeviceScan");
+      if (restart) {
+         Pa_Terminate();
+         Pa_Initialize();
+      }
+      auto result = Scan();
+      // Take the results on the main thread, if nothing else did sooner
+      BasicUI::CallAfter([this]{ AwaitScan(); });
+      return result;
+   });
+}
+
+void DeviceManager::AwaitScan()
+{
+   if (!mPendingScan.valid())
+      return;
+   auto maps = mPendingScan.get();
+   mRestarting = false;
+   AdoptScan(std::move(maps));
+}
 
-   // If this was not an initial scan update each device toolbar.
-   if ( m_inited )
-      Publish(DeviceChangeMessage::Rescan);
+void DeviceManager::AwaitPortAudio()
+{
+   if (mRestarting)
+      AwaitScan();
+}
+
+void DeviceManager::AdoptScan(DeviceMaps maps)
+{
+   const bool changed = !m_inited ||
+      !SameMaps(maps.inputs, mInputDeviceSourceMaps) ||
+      !SameMaps(maps.outputs, mOutputDeviceSourceMaps);
+   const bool wasInited = m_inited;
 
+   mInputDeviceSourceMaps = std::move(maps.inputs);
+   mOutputDeviceSourceMaps = std::move(maps.outputs);
    m_inited = true;
    mRescanTime = std::chrono::steady_clock::now();
+
+   if (changed) {
+      WriteMaps(InputsCachePath, mInputDeviceSourceMaps);
+      WriteMaps(OutputsCachePath, mOutputDeviceSourceMaps);
+      gPrefs->Flush();
+   }
+
+   if (!mScanned) {
+      mScanned = true;
+#if defined(EXPERIMENTAL_DEVICE_CHANGE_HANDLER)
+#if defined(HAVE_DEVICE_CHANGE)
+      DeviceChangeHandler::Enable(true);
+#endif
+#endif
+   }
+
+   // If this was not the first list, update each device toolbar, later,
+   // because this may happen as a stream starts
+   if (wasInited && changed)
+      BasicUI::CallAfter([this]{ Publish(DeviceChangeMessage::Rescan); });
 }
 
 
@@ -314,21 +465,21 @@ DeviceManager::~DeviceManager()
 
 void DeviceManager::Init()
 {
-    Rescan();
-
-#if defined(EXPERIMENTAL_DEVICE_CHANGE_HANDLER)
-#if defined(HAVE_DEVICE_CHANGE)
-   DeviceChangeHandler::Enable(true);
-#endif
-#endif
+   if (mPendingScan.valid())
+      AwaitScan();
+   else
+      Rescan();
 }
 
 #if defined(EXPERIMENTAL_DEVICE_CHANGE_HANDLER)
 #if defined(HAVE_DEVICE_CHANGE)
 void DeviceManager::DeviceChangeNotification()
 {
-   Rescan();
-   return;
+   // Restarting portaudio could block for seconds; instead, keep the old
+   // lists until the new ones are found, and block only uses of portaudio
+   AwaitScan();
+   StopMonitoring();
+   ScanInBackground(true);
 }
 #endif
 #endif
@@ -19,6 +19,7 @@
 #define __AUDACITY_DEVICEMANAGER__
 
 #include <chrono>
+#include <future>
 #include <vector>
 
 #include <wx/string.h> // member variables
@@ -54,6 +55,20 @@ class AUDIO_DEVICES_API DeviceManager final
    /// Assumes that DeviceManager is only used on the main thread.
    void Rescan();
 
+   /// Begins the initial scan in another thread, because probing devices
+   /// can take seconds.  Until it finishes, the lists are those found in the
+   /// previous session, if any; else the first request for them waits.
+   /// Call after portaudio is initialized, on the main thread.
+   void StartScan();
+
+   /// Blocks until any scan in the background finishes, and takes its lists.
+   /// Call on the main thread before opening a device.
+   void AwaitScan();
+
+   /// Blocks while a scan in the background restarts portaudio.
+   /// Call on the main thread before any other use of portaudio.
+   void AwaitPortAudio();
+
    // Time since devices scanned in seconds.
    std::chrono::duration<float> GetTimeSinceRescan();
 
@@ -71,7 +86,24 @@ class AUDIO_DEVICES_API DeviceManager final
 #endif
 
 private:
+   struct DeviceMaps {
+      std::vector<DeviceSourceMap> inputs;
+      std::vector<DeviceSourceMap> outputs;
+   };
+   //! Enumerate the devices, without other effects
+   static DeviceMaps Scan();
+   static void StopMonitoring();
+   void ScanInBackground(bool restart);
+   //! Replace the lists, saving them for the next session, and notify if
+   //! they changed
+   void AdoptScan(DeviceMaps maps);
+
    std::chrono::time_point<std::chrono::steady_clock> mRescanTime;
+   std::future<DeviceMaps> mPendingScan;
+   //! Whether the pending scan restarts portaudio
+   bool mRestarting{ false };
+   //! Whether any scan finished in this session
+   bool mScanned{ false };
 
  protected:
    //private constructor - Singleton.
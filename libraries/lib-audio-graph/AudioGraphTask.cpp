@@ -39,6 +39,11 @@ bool AudioGraph::Task::RunLoop()
 }
 
 auto AudioGraph::Task::RunOnce() -> Status
+{
+   return Deliver(Fetch());
+}
+
+std::optional<size_t> AudioGraph::Task::Fetch()
 {
    const auto blockSize = mBuffers.BlockSize();
    assert(mBuffers.Remaining() >= blockSize); // pre
@@ -50,18 +55,29 @@ auto AudioGraph::Task::RunOnce() -> Status
       oldRemaining.emplace(mSource.Remaining());
    // else Remaining() may not be meaningful
 #endif
- 
-   if (auto oCurBlockSize = mSource.Acquire(mBuffers, blockSize)) {
-      const auto curBlockSize = *oCurBlockSize;
+
+   const auto oCurBlockSize = mSource.Acquire(mBuffers, blockSize);
 #ifndef NDEBUG
+   if (oCurBlockSize) {
       mRanOnce = true;
       const auto remaining = mSource.Remaining();
       // Assert a post of Acquire which is part of proof of termination
       assert(!mSource.Terminates() || !oldRemaining ||
          *oldRemaining == remaining);
-      oldRemaining.emplace(remaining);
       // Assert another post that guarantees progress (even if not terminating)
-      assert(blockSize == 0 || remaining == 0 || curBlockSize > 0);
+      assert(blockSize == 0 || remaining == 0 || *oCurBlockSize > 0);
+   }
+#endif
+   return oCurBlockSize;
+}
+
+auto AudioGraph::Task::Deliver(std::optional<size_t> oCurBlockSize) -> Status
+{
+   if (oCurBlockSize) {
+      const auto blockSize = mBuffers.BlockSize();
+      const auto curBlockSize = *oCurBlockSize;
+#ifndef NDEBUG
+      const auto remaining = mSource.Remaining();
 #endif
       if (curBlockSize == 0)
          // post (same as pre) obviously preserved
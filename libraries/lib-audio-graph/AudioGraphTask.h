@@ -14,6 +14,9 @@
 #ifndef __AUDACITY_AUDIO_GRAPH_TASK__
 #define __AUDACITY_AUDIO_GRAPH_TASK__
 
+#include <cstddef>
+#include <optional>
+
 namespace AudioGraph {
 
 class Buffers;
@@ -31,7 +34,18 @@ public:
    Task(Source &source, Buffers &buffers, Sink &sink);
    enum class Status { More, Done, Fail };
    //! Do an increment of the copy
+   /*! Same as `Deliver(Fetch())` */
    Status RunOnce();
+   //! First half of RunOnce(): acquire a block from the source
+   /*!
+    Touches only the source and the buffers, so that the fetches of tasks
+    with distinct sources and buffers may be done at once in several threads
+    @return what the source acquired, to be passed to Deliver()
+    @pre `mBuffers.Remaining() >= mBuffers.BlockSize()`
+    */
+   std::optional<size_t> Fetch();
+   //! Second half of RunOnce(): give the fetched block to the sink
+   Status Deliver(std::optional<size_t> oCurBlockSize);
    //! Do the complete copy
    /*!
     @return success
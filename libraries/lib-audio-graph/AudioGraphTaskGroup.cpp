@@ -0,0 +1,53 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file AudioGraphTaskGroup.cpp
+
+**********************************************************************/
+#include "AudioGraphTaskGroup.h"
+#include "concurrency/ThreadPool.h"
+
+AudioGraph::TaskGroup::TaskGroup(std::vector<Task*> tasks)
+{
+   mUnfinished.reserve(tasks.size());
+   for (size_t ii = 0; ii < tasks.size(); ++ii)
+      mUnfinished.push_back({ tasks[ii], ii, {} });
+}
+
+auto AudioGraph::TaskGroup::RunOnce(const DoneHandler &onDone) -> Status
+{
+   if (mUnfinished.empty())
+      return Status::Done;
+
+   const auto fetch = [this](size_t ii){
+      auto &entry = mUnfinished[ii];
+      entry.fetched = entry.pTask->Fetch();
+   };
+   audacity::concurrency::ThreadPool::GetDefault()
+      .ParallelFor(mUnfinished.size(), fetch);
+
+   // Deliver in this thread, in order
+   for (auto iter = mUnfinished.begin(); iter != mUnfinished.end();) {
+      const auto status = iter->pTask->Deliver(iter->fetched);
+      if (status == Status::Fail)
+         return Status::Fail;
+      if (status == Status::Done) {
+         if (onDone && !onDone(iter->index))
+            return Status::Fail;
+         iter = mUnfinished.erase(iter);
+      }
+      else
+         ++iter;
+   }
+   return mUnfinished.empty() ? Status::Done : Status::More;
+}
+
+bool AudioGraph::TaskGroup::RunLoop(const DoneHandler &onDone)
+{
+   Status status{};
+   do
+      status = RunOnce(onDone);
+   while (status == Status::More);
+   return status == Status::Done;
+}
@@ -0,0 +1,71 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file AudioGraphTaskGroup.h
+  @brief Runs several independent tasks at once
+
+**********************************************************************/
+
+#ifndef __AUDACITY_AUDIO_GRAPH_TASK_GROUP__
+#define __AUDACITY_AUDIO_GRAPH_TASK_GROUP__
+
+#include "AudioGraphTask.h"
+
+#include <functional>
+#include <optional>
+#include <vector>
+
+namespace AudioGraph {
+
+//! Runs tasks, each a chain from a Source to a Sink, side by side
+/*!
+ Each increment fetches a block for every unfinished task at once, on the
+ default thread pool and in the calling thread; then delivers them in the
+ calling thread, in the order of the tasks.  So the sources may compute
+ concurrently, while sinks, which may write tracks, never do.
+
+ The stages of a chain pass their buffers along without copying, as in a
+ single Task.
+ */
+class AUDIO_GRAPH_API TaskGroup final {
+public:
+   using Status = Task::Status;
+   //! Called in the calling thread when the task of the given index is done
+   /*! @return false to fail */
+   using DoneHandler = std::function<bool(size_t)>;
+
+   /*!
+    @pre the sources and buffers of distinct tasks are distinct, and the
+    fetch of one task touches nothing that another task touches
+    @pre each task's buffers satisfy the precondition of Task::Fetch(), as
+    after `Buffers::Rewind()`
+    */
+   explicit TaskGroup(std::vector<Task*> tasks);
+
+   //! Do an increment of every unfinished task
+   /*!
+    The first exception from any fetch propagates, after all fetches finish
+    @return Done after the last task is done, Fail if any task or onDone
+    fails, else More
+    */
+   Status RunOnce(const DoneHandler &onDone = {});
+
+   //! Do the complete copies
+   /*! @return success */
+   bool RunLoop(const DoneHandler &onDone = {});
+
+   //! How many tasks are not yet done
+   size_t Unfinished() const { return mUnfinished.size(); }
+
+private:
+   struct Entry {
+      Task *pTask;
+      size_t index;
+      std::optional<size_t> fetched;
+   };
+   std::vector<Entry> mUnfinished;
+};
+
+}
+#endif
@@ -70,6 +70,8 @@ time warp info and AudioIOListener and whether the playback is looped.
 #include <math.h>
 #include <stdlib.h>
 #include <algorithm>
+#include <limits>
+#include <new>
 #include <numeric>
 #include <optional>
 
@@ -103,14 +105,20 @@ time warp info and AudioIOListener and whether the playback is looped.
 #include "Meter.h"
 #include "Mix.h"
 #include "Resample.h"
+#include "MeterLevels.h"
+#include "MultiChannelRingBuffer.h"
+#include "RecordingSpool.h"
 #include "RingBuffer.h"
 #include "Decibels.h"
 #include "Prefs.h"
+#include "PrefsSnapshot.h"
 #include "Project.h"
 #include "TransactionScope.h"
 
 #include "RealtimeEffectManager.h"
 #include "QualitySettings.h"
+#include "RealtimeAllocationTrap.h"
+#include "Tracing.h"
 #include "BasicUI.h"
 
 #include "Gain.h"
@@ -180,6 +188,30 @@ int audacityAudioCallback(const void *inputBuffer, void *outputBuffer,
                           const PaStreamCallbackTimeInfo *timeInfo,
                           PaStreamCallbackFlags statusFlags, void *userData );
 
+namespace {
+//! Preferences copied when starting streams
+struct StreamPrefs {
+   bool softwarePlaythrough{ false };
+   bool microFades{ false };
+   int silenceLevelDB{ -50 };
+};
+
+const StreamPrefs &GetStreamPrefs()
+{
+   static PrefsSnapshot<StreamPrefs> snapshot{ [](StreamPrefs &prefs){
+      gPrefs->Read(wxT("/AudioIO/SWPlaythrough"),
+         &prefs.softwarePlaythrough, false);
+      gPrefs->Read(wxT("/AudioIO/Microfades"), &prefs.microFades, false);
+      gPrefs->Read(wxT("/AudioIO/SilenceLevel"), &prefs.silenceLevelDB, -50);
+   }, AudioIOPrefsID() };
+   return snapshot.Get();
+}
+}
+
+int AudioIOPrefsID()
+{
+   return 10001;
+}
 
 //////////////////////////////////////////////////////////////////////
 //
@@ -473,6 +505,9 @@ static PaSampleFormat AudacityToPortAudioSampleFormat(sampleFormat format)
 bool AudioIO::StartPortAudioStream(const AudioIOStartStreamOptions &options,
    unsigned int numPlaybackChannels, unsigned int numCaptureChannels)
 {
+   // Devices found in the background must be known before opening one
+   DeviceManager::Instance()->AwaitScan();
+
    auto sampleRate = options.rate;
    mNumPauseFrames = 0;
    SetOwningProject( options.pProject );
@@ -708,6 +743,7 @@ bool AudioIO::StartPortAudioStream(const AudioIOStartStreamOptions &options,
          if (mUsingAlsa)
             mHardwarePlaybackLatencyFrames *= 3;
 #endif
+         ReserveCallbackArena();
          break;
       }
       wxLogDebug("Attempt %u to open capture stream failed with: %d", 1 + tries, mLastPaError);
@@ -751,6 +787,22 @@ bool AudioIO::StartPortAudioStream(const AudioIOStartStreamOptions &options,
    return (success = (mLastPaError == paNoError));
 }
 
+void AudioIO::ReserveCallbackArena()
+{
+   // Buffers of the callback are not of fixed size, but are unlikely to
+   // exceed the hardware latency.  Larger ones fall back to the stack.
+   const size_t maxFrames =
+      std::max<size_t>(16384, 2 * mHardwarePlaybackLatencyFrames);
+   // See the allocations in AudioCallback() and FillOutputBuffers()
+   const size_t floats = maxFrames * (2 * mNumPlaybackChannels +
+      std::max(mNumCaptureChannels, mNumPlaybackChannels));
+   const size_t pointers = mNumPlaybackChannels;
+   // Allow some padding for alignment of each block
+   const size_t slack = (mNumPlaybackChannels + 2) * alignof(std::max_align_t);
+   mCallbackArena.Reserve(
+      floats * sizeof(float) + pointers * sizeof(float*) + slack);
+}
+
 wxString AudioIO::LastPaErrorString()
 {
    return wxString::Format(wxT("%d %s."), (int) mLastPaError, Pa_GetErrorText(mLastPaError));
@@ -780,7 +832,7 @@ void AudioIO::StartMonitoring( const AudioIOStartStreamOptions &options )
    bool success;
    auto captureFormat = QualitySettings::SampleFormatChoice();
    auto captureChannels = AudioIORecordChannels.Read();
-   gPrefs->Read(wxT("/AudioIO/SWPlaythrough"), &mSoftwarePlaythrough, false);
+   mSoftwarePlaythrough = GetStreamPrefs().softwarePlaythrough;
    int playbackChannels = 0;
 
    if (mSoftwarePlaythrough)
@@ -847,6 +899,8 @@ int AudioIO::StartStream(const TransportSequences &sequences,
    if( IsBusy() )
       return 0;
 
+   mStatistics.Reset();
+
    // We just want to set mStreamToken to -1 - this way avoids
    // an extremely rare but possible race condition, if two functions
    // somehow called StartStream at the same time...
@@ -870,11 +924,11 @@ int AudioIO::StartStream(const TransportSequences &sequences,
       }
    }
 
-   gPrefs->Read(wxT("/AudioIO/SWPlaythrough"), &mSoftwarePlaythrough, false);
+   const auto &prefs = GetStreamPrefs();
+   mSoftwarePlaythrough = prefs.softwarePlaythrough;
    mPauseRec = SoundActivatedRecord.Read();
-   gPrefs->Read(wxT("/AudioIO/Microfades"), &mbMicroFades, false);
-   int silenceLevelDB;
-   gPrefs->Read(wxT("/AudioIO/SilenceLevel"), &silenceLevelDB, -50);
+   mbMicroFades = prefs.microFades;
+   int silenceLevelDB = prefs.silenceLevelDB;
    int dBRange = DecibelScaleCutoff.Read();
    if(silenceLevelDB < -dBRange)
    {
@@ -927,7 +981,10 @@ int AudioIO::StartStream(const TransportSequences &sequences,
    mScratchBuffers.clear();
    mScratchPointers.clear();
    mPlaybackMixers.clear();
-   mCaptureBuffers.clear();
+   mPlaybackMixerKeys.clear();
+   mRecordingSpool.reset();
+   mCaptureBuffer.reset();
+   mLevelBuffer.reset();
    mResample.clear();
    mPlaybackSchedule.mTimeQueue.Clear();
 
@@ -1031,6 +1088,8 @@ int AudioIO::StartStream(const TransportSequences &sequences,
 
    // Now that we are done with AllocateBuffers() and SetSequenceTime():
    mPlaybackSchedule.mTimeQueue.Prime(mPlaybackSchedule.GetSequenceTime());
+   mPlaybackSchedule.mTimeStreams.Publish(
+      PlaybackTimeStreams::Playback, mPlaybackSchedule.GetSequenceTime());
    // else recording only without overdub
 
    // We signal the audio thread to call SequenceBufferExchange, to prime the RingBuffers
@@ -1175,6 +1234,34 @@ bool AudioIO::AllocateBuffers(
    auto &policy = mPlaybackSchedule.GetPolicy();
    auto times = policy.SuggestedBufferTimes(mPlaybackSchedule);
 
+   // Direct playback needs all material resident already, and kept so until
+   // the stream stops, because reading storage by the audio thread, with its
+   // tiny lead, could miss the deadline of the callback
+   const auto residentStart = std::min({ t0, t1, mPlaybackSchedule.mT0 });
+   const auto residentEnd = std::max(t0, t1);
+   mResidencyPins.clear();
+   mDirectPlayback = mNumPlaybackChannels > 0 &&
+      !mPlaybackSequences.empty() &&
+      DirectPlayback.Read() &&
+      policy.AllowDirectPlayback(mPlaybackSchedule) &&
+      std::all_of(mPlaybackSequences.begin(), mPlaybackSequences.end(),
+         [&](const auto &pSequence){
+            auto pin = pSequence->PinResident(residentStart, residentEnd);
+            if (!pin)
+               return false;
+            mResidencyPins.push_back(move(pin));
+            return true;
+         });
+   if (!mDirectPlayback)
+      mResidencyPins.clear();
+   if (mDirectPlayback) {
+      using namespace std::chrono;
+      // The audio thread produces in small batches, and the queue is kept
+      // only one batch beyond the hardware latency
+      times.batchSize = 2ms;
+      times.latency = 0s;
+   }
+
    //
    // The (audio) stream has been opened successfully (assuming we tried
    // to open it). We now proceed to
@@ -1237,9 +1324,16 @@ bool AudioIO::AllocateBuffers(
             mPlaybackBuffers.resize(0);
             mPlaybackBuffers.resize(
                std::max<size_t>(1, totalWidth));
-            // Number of scratch buffers depends on device playback channels
+            // Number of scratch buffers depends on device playback channels,
+            // with one set of them for each thread that may apply effects
+            mScratchSetsCount = std::max<size_t>(1, std::min(
+               RealtimeEffectManager::GetProcessingThreadsCount(),
+               mPlaybackSequences.size()));
+            mStatistics.realtimeThreads.store(
+               mScratchSetsCount, std::memory_order_relaxed);
             if (mNumPlaybackChannels > 0) {
-               mScratchBuffers.resize(mNumPlaybackChannels * 2 + 1);
+               mScratchBuffers.resize(
+                  mScratchSetsCount * (mNumPlaybackChannels * 2 + 1));
                mScratchPointers.clear();
                for (auto &buffer : mScratchBuffers) {
                   buffer.Allocate(playbackBufferSize, floatSample);
@@ -1248,9 +1342,15 @@ bool AudioIO::AllocateBuffers(
                }
             }
             mPlaybackMixers.clear();
+            mPlaybackMixerKeys.clear();
 
             const auto &warpOptions =
                policy.MixerWarpOptions(mPlaybackSchedule);
+            // Mixers left by the previous stream of the project
+            auto pOwningProject = mOwningProject.lock();
+            auto warmMixers = pOwningProject
+               ? ProjectAudioIO::Get(*pOwningProject).TakeWarmMixers()
+               : ProjectAudioIO::WarmMixers{};
 
             mPlaybackQueueMinimum = lrint( mRate * times.latency.count() );
             mPlaybackQueueMinimum =
@@ -1259,11 +1359,23 @@ bool AudioIO::AllocateBuffers(
             // Limit the mPlaybackQueueMinimum to the hardware latency
             mPlaybackQueueMinimum =
                std::max(mPlaybackQueueMinimum, mHardwarePlaybackLatencyFrames);
+            if (mDirectPlayback)
+               // Margin for one pass of the audio thread
+               mPlaybackQueueMinimum = std::min(playbackBufferSize,
+                  mPlaybackQueueMinimum + mPlaybackSamplesToCopy);
 
             // Make mPlaybackQueueMinimum a multiple of mPlaybackSamplesToCopy
             mPlaybackQueueMinimum = mPlaybackSamplesToCopy *
                ((mPlaybackQueueMinimum + mPlaybackSamplesToCopy - 1) / mPlaybackSamplesToCopy);
 
+            // The audio thread may keep more than the minimum queued, but
+            // must leave room for one batch
+            mAudioThreadScheduler.Reset(mPlaybackQueueMinimum,
+               playbackBufferSize - std::min(playbackBufferSize,
+                  mPlaybackSamplesToCopy),
+               mPlaybackSamplesToCopy, mRate,
+               !mDirectPlayback && AdaptivePlaybackLead.Read());
+
             if (mPlaybackSequences.empty())
                // Make at least one playback buffer
                mPlaybackBuffers[0] =
@@ -1306,24 +1418,50 @@ bool AudioIO::AllocateBuffers(
 
                Mixer::Inputs mixSequences;
                mixSequences.push_back(Mixer::Input{ pSequence });
-               mPlaybackMixers.emplace_back(std::make_unique<Mixer>(
-                  move(mixSequences),
-                  // Don't throw for read errors, just play silence:
-                  false,
-                  warpOptions, startTime, endTime, pSequence->NChannels(),
+               const ProjectAudioIO::MixerKey key{ mRate,
                   std::max( mPlaybackSamplesToCopy, mPlaybackQueueMinimum ),
-                  false, // not interleaved
-                  mRate, floatSample,
-                  false, // low quality dithering and resampling
-                  nullptr, // no custom mix-down
-                  Mixer::ApplyGain::Discard // don't apply gains
-               ));
+                  warpOptions.envelope,
+                  warpOptions.minSpeed, warpOptions.maxSpeed };
+               // Reuse a mixer made in the same way, skipping the allocation
+               // of its buffers
+               const auto end = warmMixers.end(),
+                  found = std::find_if(warmMixers.begin(), end,
+                     [&](const ProjectAudioIO::WarmMixer &warm){
+                        return warm.key == key &&
+                           warm.pMixer->Reusable(mixSequences);
+                     });
+               if (found != end) {
+                  auto pMixer = move(found->pMixer);
+                  warmMixers.erase(found);
+                  pMixer->Rebind(move(mixSequences));
+                  // Skipping, so that resamplers are remade, as after seeking
+                  pMixer->SetTimesAndSpeed(
+                     startTime, endTime, warpOptions.initialSpeed, true);
+                  mPlaybackMixers.push_back(move(pMixer));
+               }
+               else
+                  mPlaybackMixers.emplace_back(std::make_unique<Mixer>(
+                     move(mixSequences),
+                     // Don't throw for read errors, just play silence:
+                     false,
+                     warpOptions, startTime, endTime, pSequence->NChannels(),
+                     key.bufferSize,
+                     false, // not interleaved
+                     mRate, floatSample,
+                     false, // low quality dithering and resampling
+                     nullptr, // no custom mix-down
+                     Mixer::ApplyGain::Discard // don't apply gains
+                  ));
+               mPlaybackMixerKeys.push_back(key);
             }
 
             const auto timeQueueSize = 1 +
                (playbackBufferSize + TimeQueueGrainSize - 1)
                   / TimeQueueGrainSize;
             mPlaybackSchedule.mTimeQueue.Resize( timeQueueSize );
+
+            mPlaybackPrefetcher.Start(mPlaybackSequences,
+               mPlaybackSchedule.mT0, mPlaybackSchedule.ReversedTime());
          }
 
          if( mNumCaptureChannels > 0 )
@@ -1341,19 +1479,33 @@ bool AudioIO::AllocateBuffers(
                return false;
             }
 
-            mCaptureBuffers.resize(0);
-            mCaptureBuffers.resize(mNumCaptureChannels);
+            mCaptureBuffer = std::make_unique<MultiChannelRingBuffer>(
+               mCaptureFormat, mNumCaptureChannels, captureBufferSize);
+            if (mPauseRec)
+               // Half a second, because the audio thread measures often
+               mLevelBuffer = std::make_unique<MultiChannelRingBuffer>(
+                  floatSample, mNumCaptureChannels,
+                  std::max<size_t>(100, size_t(mRate / 2)));
             mResample.resize(0);
             mResample.resize(mNumCaptureChannels);
             mFactor = sampleRate / mRate;
 
             for (unsigned int i = 0; i < mNumCaptureChannels; ++i) {
-               mCaptureBuffers[i] = std::make_unique<RingBuffer>(
-                  mCaptureFormat, captureBufferSize);
                mResample[i] =
                   std::make_unique<Resample>(true, mFactor, mFactor);
                   // constant rate resampling
             }
+
+            // Crossfading and resampling need each channel separately;
+            // without a temporary file, append directly as before
+            if (RecordToSpoolFile.Read() && mFactor == 1.0 &&
+                mRecordingSchedule.mCrossfadeData.empty())
+               mRecordingSpool = RecordingSpool::Create(
+                  mCaptureSequences, mCaptureFormat, mNumCaptureChannels,
+                  [this]{
+                     if (auto pListener = GetListener())
+                        pListener->OnAudioIONewBlocks();
+                  });
          }
       }
       catch(std::bad_alloc&)
@@ -1387,11 +1539,16 @@ void AudioIO::StartStreamCleanup(bool bOnlyBuffers)
 {
    mpTransportState.reset();
 
+   mPlaybackPrefetcher.Stop();
    mPlaybackBuffers.clear();
+   mResidencyPins.clear();
    mScratchBuffers.clear();
    mScratchPointers.clear();
    mPlaybackMixers.clear();
-   mCaptureBuffers.clear();
+   mPlaybackMixerKeys.clear();
+   mRecordingSpool.reset();
+   mCaptureBuffer.reset();
+   mLevelBuffer.reset();
    mResample.clear();
    mPlaybackSchedule.mTimeQueue.Clear();
 
@@ -1550,10 +1707,21 @@ void AudioIO::StopStream()
    // Everything is taken care of.  Now, just free all the resources
    // we allocated in StartStream()
    //
+   mPlaybackPrefetcher.Stop();
    mPlaybackBuffers.clear();
    mScratchBuffers.clear();
    mScratchPointers.clear();
+   // Keep the mixers for the next stream of the project
+   if (auto pOwningProject = mOwningProject.lock()) {
+      ProjectAudioIO::WarmMixers warmMixers;
+      for (size_t ii = 0; ii < mPlaybackMixers.size(); ++ii)
+         warmMixers.push_back(
+            { mPlaybackMixerKeys[ii], move(mPlaybackMixers[ii]) });
+      ProjectAudioIO::Get(*pOwningProject).SetWarmMixers(move(warmMixers));
+   }
    mPlaybackMixers.clear();
+   mPlaybackMixerKeys.clear();
+   mResidencyPins.clear();
    mPlaybackSchedule.mTimeQueue.Clear();
 
    if (mStreamToken > 0)
@@ -1562,9 +1730,20 @@ void AudioIO::StopStream()
       // Offset all recorded sequences to account for latency
       //
       if (mCaptureSequences.size() > 0) {
-         mCaptureBuffers.clear();
+         mCaptureBuffer.reset();
+         mLevelBuffer.reset();
          mResample.clear();
 
+         if (mRecordingSpool) {
+            // Let the worker append all that was captured, before flushing
+            GuardedCall([&]{ mRecordingSpool->Finish(); },
+               [&](AudacityException *) {
+                  for (auto &pSequence : mCaptureSequences)
+                     pSequence->RepairChannels();
+               });
+            mRecordingSpool.reset();
+         }
+
          //
          // We only apply latency correction when we actually played back
          // sequences during the recording. If we did not play back sequences,
@@ -1798,11 +1977,15 @@ void AudioIO::AudioThread(std::atomic<bool> &finish)
 {
    enum class State { eUndefined, eOnce, eLoopRunning, eDoNothing, eMonitoring } lastState = State::eUndefined;
    AudioIO *const gAudioIO = AudioIO::Get();
+   Tracing::RegisterThread("Audio");
+   // Failure leaves the normal priority, which usually suffices
+   AudioThreadScheduler::RaiseCurrentThreadPriority();
    while (!finish.load(std::memory_order_acquire)) {
       using Clock = std::chrono::steady_clock;
       auto loopPassStart = Clock::now();
       auto &schedule = gAudioIO->mPlaybackSchedule;
-      const auto interval = schedule.GetPolicy().SleepInterval(schedule);
+      const auto interval = gAudioIO->mAudioThreadScheduler.SleepInterval(
+         schedule.GetPolicy().SleepInterval(schedule));
 
       // Set LoopActive outside the tests to avoid race condition
       gAudioIO->mAudioThreadSequenceBufferExchangeLoopActive
@@ -1889,7 +2072,7 @@ size_t AudioIoCallback::GetCommonlyWrittenForPlayback()
 
 size_t AudioIO::GetCommonlyAvailCapture()
 {
-   return MinValue(mCaptureBuffers, &RingBuffer::AvailForGet);
+   return mCaptureBuffer ? mCaptureBuffer->AvailForGet() : 0;
 }
 
 // This method is the data gateway between the audio thread (which
@@ -1897,11 +2080,33 @@ size_t AudioIO::GetCommonlyAvailCapture()
 // (which communicates with the audio device).
 void AudioIO::SequenceBufferExchange()
 {
+   TRACE_SCOPE("SequenceBufferExchange");
+   const auto once = mAudioThreadShouldCallSequenceBufferExchangeOnce
+      .load(std::memory_order_relaxed);
+   // The main thread resets the scheduler only before requesting such a pass
+   if (once)
+      mAudioThreadScheduler.ApplyReset();
+   // Measure the passes of the loop, not priming or reloading, which begin
+   // with an empty queue
+   const auto measure = !once && mNumPlaybackChannels > 0;
+   const auto readyBefore = measure ? GetCommonlyReadyPlayback() : 0;
+   const auto passStart = std::chrono::steady_clock::now();
+
    FillPlayBuffers();
    DrainRecordBuffers();
+   MeasureSoundActivationLevel();
+
+   if (measure)
+      mAudioThreadScheduler.NotePass(readyBefore,
+         std::chrono::steady_clock::now() - passStart);
 }
 
 void AudioIO::FillPlayBuffers()
+{
+   FillPlayBuffers(mAudioThreadScheduler.GetLead());
+}
+
+void AudioIO::FillPlayBuffers(size_t queueMinimum)
 {
    std::optional<RealtimeEffects::ProcessingScope> pScope;
    if (mpTransportState && mpTransportState->mpRealtimeInitialization)
@@ -1936,7 +2141,7 @@ void AudioIO::FillPlayBuffers()
       // Note that reader might concurrently consume between loop passes below
       // So this might not be nondecreasing
       auto nReady = GetCommonlyWrittenForPlayback();
-      return mPlaybackQueueMinimum - std::min(mPlaybackQueueMinimum, nReady);
+      return queueMinimum - std::min(queueMinimum, nReady);
    };
    auto nNeeded = GetNeeded();
 
@@ -1955,10 +2160,13 @@ void AudioIO::FillPlayBuffers()
          pBuffer->Flush();
    };
 
+   // The mixers' buffers are no longer than this
+   const auto limit = std::max(mPlaybackSamplesToCopy, mPlaybackQueueMinimum);
+
    while (true) {
       // Limit maximum buffer size (increases performance)
-      auto available = std::min( nAvailable,
-         std::max( nNeeded, mPlaybackSamplesToCopy ) );
+      auto available = std::min({ nAvailable,
+         std::max( nNeeded, mPlaybackSamplesToCopy ), limit });
 
       // After each loop pass or after break
       Finally Do{ Flush };
@@ -1977,6 +2185,9 @@ void AudioIO::FillPlayBuffers()
       // Might increase because the reader consumed some
       nAvailable = GetCommonlyFreePlayback();
    }
+
+   // Let the worker read ahead of where the mixers now are
+   mPlaybackPrefetcher.Request(mPlaybackSchedule.GetSequenceTime());
 }
 
 bool AudioIO::ProcessPlaybackSlices(
@@ -2015,8 +2226,14 @@ bool AudioIO::ProcessPlaybackSlices(
          // warping
          if (frames > 0) {
             size_t produced = 0;
-            if (toProduce)
+            if (toProduce) {
+               using Clock = std::chrono::steady_clock;
+               const auto start = Clock::now();
                produced = mixer->Process(toProduce);
+               mStatistics.playbackResampling.Add(
+                  std::chrono::duration_cast<std::chrono::microseconds>(
+                     Clock::now() - start).count());
+            }
             //wxASSERT(produced <= toProduce);
             // Copy (non-interleaved) mixer outputs to one or more ring buffers
             const auto nChannels = mPlaybackSequences[iSequence++]->NChannels();
@@ -2054,13 +2271,20 @@ void AudioIO::TransformPlayBuffers(
    std::optional<RealtimeEffects::ProcessingScope> &pScope)
 {
    // Transform written but un-flushed samples in the RingBuffers in-place.
+   if (!pScope)
+      return;
 
    // Avoiding std::vector
-   const auto pointers = stackAllocate(float*, mNumPlaybackChannels);
-
+   using GroupJob = RealtimeEffectManager::GroupJob;
    const auto numPlaybackSequences = mPlaybackSequences.size();
+   const auto jobs = stackAllocate(GroupJob, numPlaybackSequences);
+   const auto pointers =
+      stackAllocate(float*, 2 * numPlaybackSequences * mNumPlaybackChannels);
+
    // mPlaybackBuffers correspond many-to-one with mPlaybackSequences
    size_t iBuffer = 0;
+   size_t nJobs = 0;
+   auto nextPointers = pointers;
    for (const auto vt : mPlaybackSequences) {
       if (!vt)
          continue;
@@ -2070,16 +2294,20 @@ void AudioIO::TransformPlayBuffers(
       // vt is mono, or is the first of its group of channels
       const auto nChannels = std::min<size_t>(
          mNumPlaybackChannels, vt->NChannels());
+      auto &job = *new (&jobs[nJobs++]) GroupJob{};
+      job.pGroup = pGroup;
+      job.nChannels = nChannels;
 
-      // Loop over the blocks of unflushed data, at most two
+      // Describe the blocks of unflushed data, at most two
       for (unsigned iBlock : {0, 1}) {
+         auto &block = job.blocks[iBlock];
+         block.buffers = nextPointers;
          size_t len = 0;
-         size_t iChannel = 0;
-         for (; iChannel < nChannels; ++iChannel) {
+         for (size_t iChannel = 0; iChannel < nChannels; ++iChannel) {
             auto &ringBuffer = *mPlaybackBuffers[iBuffer + iChannel];
             const auto pair = ringBuffer.GetUnflushed(iBlock);
             // Playback RingBuffers have float format: see AllocateBuffers
-            pointers[iChannel] = reinterpret_cast<float*>(pair.first);
+            *nextPointers++ = reinterpret_cast<float*>(pair.first);
             // The lengths of corresponding unflushed blocks should be
             // the same for all channels
             if (len == 0)
@@ -2087,34 +2315,44 @@ void AudioIO::TransformPlayBuffers(
             else
                assert(len == pair.second);
          }
+         block.numSamples = len;
+      }
+      iBuffer += vt->NChannels();
+   }
 
-         // Are there more output device channels than channels of vt?
-         // Such as when a mono sequence is processed for stereo play?
-         // Then supply some non-null fake input buffers, because the
-         // various ProcessBlock overrides of effects may crash without it.
-         // But it would be good to find the fixes to make this unnecessary.
-         float **scratch = &mScratchPointers[mNumPlaybackChannels + 1];
-         while (iChannel < mNumPlaybackChannels)
-            memset((pointers[iChannel++] = *scratch++), 0, len * sizeof(float));
-
-         if (len && pScope) {
-            auto discardable = pScope->Process(*pGroup, &pointers[0],
-               mScratchPointers.data(),
-               // The single dummy output buffer:
-               mScratchPointers[mNumPlaybackChannels],
-               mNumPlaybackChannels, len);
-            iChannel = 0;
-            for (; iChannel < nChannels; ++iChannel) {
-               auto &ringBuffer = *mPlaybackBuffers[iBuffer + iChannel];
-               auto discarded = ringBuffer.Unput(discardable);
-               // assert(discarded == discardable);
-            }
+   // Independent groups may be processed by several threads, each with its
+   // own set of scratch buffers
+   pScope->ProcessGroups(jobs, nJobs,
+      mScratchPointers.data(), mScratchSetsCount, mNumPlaybackChannels);
+
+   iBuffer = 0;
+   auto pJob = jobs;
+   for (const auto vt : mPlaybackSequences) {
+      if (!vt || !vt->FindChannelGroup())
+         continue;
+      if (pJob->elapsed)
+         mStatistics.realtimeChain.Add(pJob->elapsed->count());
+      for (auto &block : pJob->blocks) {
+         if (block.numSamples == 0)
+            continue;
+         for (size_t iChannel = 0; iChannel < pJob->nChannels; ++iChannel) {
+            auto &ringBuffer = *mPlaybackBuffers[iBuffer + iChannel];
+            auto discarded = ringBuffer.Unput(block.discardable);
+            // assert(discarded == block.discardable);
          }
       }
+      ++pJob;
       iBuffer += vt->NChannels();
    }
 }
 
+[[noreturn]] static void ThrowSpoolError()
+{
+   throw SimpleMessageBoxException{ ExceptionType::BadEnvironment,
+      XO("The recording could not be written to a temporary file."),
+      XO("Warning") };
+}
+
 void AudioIO::DrainRecordBuffers()
 {
    if (mRecordingException || mCaptureSequences.empty())
@@ -2142,6 +2380,10 @@ void AudioIO::DrainRecordBuffers()
    };
 
    GuardedCall( [&] {
+      if (mRecordingSpool)
+         // The worker stopped at a failed append; stop recording here too
+         mRecordingSpool->RethrowException();
+
       // start record buffering
       const auto avail = GetCommonlyAvailCapture(); // samples
       const auto remainingTime =
@@ -2181,11 +2423,19 @@ void AudioIO::DrainRecordBuffers()
                   // Once only (per sequence per recording), insert some initial
                   // silence.
                   size_t size = floor( correction * mRate * mFactor);
-                  SampleBuffer temp(size, mCaptureFormat);
-                  ClearSamples(temp.ptr(), mCaptureFormat, 0, size);
-                  (*iter)->Append(iChannel, temp.ptr(), mCaptureFormat, size, 1,
-                     // Do not dither recordings
-                     narrowestSampleFormat);
+                  if (mRecordingSpool) {
+                     // The same for all channels, so write frames once
+                     if (i == 0 && !mRecordingSpool->WriteSilence(size))
+                        ThrowSpoolError();
+                  }
+                  else {
+                     SampleBuffer temp(size, mCaptureFormat);
+                     ClearSamples(temp.ptr(), mCaptureFormat, 0, size);
+                     (*iter)->Append(iChannel,
+                        temp.ptr(), mCaptureFormat, size, 1,
+                        // Do not dither recordings
+                        narrowestSampleFormat);
+                  }
                }
                else {
                   // Leftward shift
@@ -2194,8 +2444,9 @@ void AudioIO::DrainRecordBuffers()
                      mRecordingSchedule.ToDiscard() * mRate );
 
                   // The ring buffer might have grown concurrently -- don't discard more
-                  // than the "avail" value noted above.
-                  discarded = mCaptureBuffers[i]->Discard(std::min(avail, size));
+                  // than the "avail" value noted above.  The frames of all
+                  // channels are consumed together after the loop.
+                  discarded = std::min(avail, size);
 
                   if (discarded < size)
                      // We need to visit this again to complete the
@@ -2223,6 +2474,37 @@ void AudioIO::DrainRecordBuffers()
 
             wxASSERT(discarded <= avail);
             size_t toGet = avail - discarded;
+
+            if (mFactor == 1.0 && !pCrossfadeSrc) {
+               // Append straight from the ring buffer, skipping the other
+               // channels, with no intermediate copy
+               size_t toAppend = toGet;
+               if (double(toAppend) > remainingSamples)
+                  toAppend = floor(remainingSamples);
+               const auto offset = (i * SAMPLE_SIZE(mCaptureFormat));
+               for (unsigned iBlock = 0; iBlock < 2; ++iBlock) {
+                  const auto [ptr, frames] =
+                     mCaptureBuffer->GetReadable(discarded, toAppend, iBlock);
+                  if (frames == 0)
+                     continue;
+                  if (mRecordingSpool) {
+                     // All channels of the frames at once; the worker
+                     // appends them
+                     if (i == 0 && !mRecordingSpool->Write(ptr, frames))
+                        ThrowSpoolError();
+                     continue;
+                  }
+                  // see comment in second handler about guarantee
+                  newBlocks = (*iter)->Append(iChannel,
+                     ptr + offset, mCaptureFormat, frames,
+                     mCaptureBuffer->Channels(),
+                     // Do not dither recordings
+                     narrowestSampleFormat
+                  ) || newBlocks;
+               }
+               continue;
+            }
+
             SampleBuffer temp;
             size_t size;
             sampleFormat format;
@@ -2236,8 +2518,8 @@ void AudioIO::DrainRecordBuffers()
                else
                   format = mCaptureFormat;
                temp.Allocate(size, format);
-               const auto got =
-                  mCaptureBuffers[i]->Get(temp.ptr(), format, toGet);
+               const auto got = mCaptureBuffer->Peek(
+                  i, discarded, temp.ptr(), format, toGet);
                // wxASSERT(got == toGet);
                // but we can't assert in this thread
                wxUnusedVar(got);
@@ -2250,8 +2532,8 @@ void AudioIO::DrainRecordBuffers()
                format = floatSample;
                SampleBuffer temp1(toGet, floatSample);
                temp.Allocate(size, format);
-               const auto got =
-                  mCaptureBuffers[i]->Get(temp1.ptr(), floatSample, toGet);
+               const auto got = mCaptureBuffer->Peek(
+                  i, discarded, temp1.ptr(), floatSample, toGet);
                // wxASSERT(got == toGet);
                // but we can't assert in this thread
                wxUnusedVar(got);
@@ -2262,10 +2544,15 @@ void AudioIO::DrainRecordBuffers()
                if (toGet > 0 ) {
                   if (double(toGet) > remainingSamples)
                      toGet = floor(remainingSamples);
+                  using Clock = std::chrono::steady_clock;
+                  const auto start = Clock::now();
                   const auto results =
                   mResample[i]->Process(mFactor, (float *)temp1.ptr(), toGet,
                                         !IsStreamActive(), (float *)temp.ptr(), size);
                   size = results.second;
+                  mStatistics.captureResampling.Add(
+                     std::chrono::duration_cast<std::chrono::microseconds>(
+                        Clock::now() - start).count());
                }
             }
 
@@ -2295,6 +2582,9 @@ void AudioIO::DrainRecordBuffers()
             ) || newBlocks;
          } // end loop over capture channels
 
+         // Each channel took, or discarded, all of avail
+         mCaptureBuffer->Discard(avail);
+
          // Now update the recording schedule position
          mRecordingSchedule.mPosition += avail / mRate;
          mRecordingSchedule.mLatencyCorrected = latencyCorrected;
@@ -2544,16 +2834,37 @@ void AudioIoCallback::CheckSoundActivatedRecordingLevel(
    )
 {
    // Quick returns if next to nothing to do.
-   if( !mPauseRec )
+   if( !mPauseRec || !mLevelBuffer )
       return;
 
-   float maxPeak = 0.;
-   for( unsigned long i = 0, cnt = framesPerBuffer * mNumCaptureChannels; i < cnt; ++i ) {
-      float sample = fabs(*(inputSamples++));
-      if (sample > maxPeak) {
-         maxPeak = sample;
-      }
+   // Only copy; the audio thread measures.  If it falls behind, frames are
+   // dropped, which delays a decision but loses no recording
+   mLevelBuffer->Put(reinterpret_cast<constSamplePtr>(inputSamples),
+      floatSample, framesPerBuffer);
+}
+
+void AudioIoCallback::MeasureSoundActivationLevel()
+{
+   if (!mLevelBuffer)
+      return;
+   const auto avail = mLevelBuffer->AvailForGet();
+   if (avail == 0)
+      return;
+
+   float maxPeak = 0;
+   std::vector<MeterLevels::Levels> levels(mNumCaptureChannels);
+   for (unsigned iBlock = 0; iBlock < 2; ++iBlock) {
+      const auto [ptr, frames] = mLevelBuffer->GetReadable(0, avail, iBlock);
+      if (frames == 0)
+         continue;
+      // Without counting peaked samples
+      MeterLevels::Measure(reinterpret_cast<const float*>(ptr),
+         mNumCaptureChannels, frames, levels.data(), levels.size(),
+         0, std::numeric_limits<float>::infinity());
+      for (const auto &level : levels)
+         maxPeak = std::max(maxPeak, level.peak);
    }
+   mLevelBuffer->Discard(avail);
 
    bool bShouldBePaused = maxPeak < mSilenceLevel;
    if( bShouldBePaused != IsPaused() )
@@ -2654,11 +2965,14 @@ bool AudioIoCallback::FillOutputBuffers(
 
    // ------ MEMORY ALLOCATION ----------------------
    // These are small structures.
-   const auto tempBufs = stackAllocate(float *, numPlaybackChannels);
+   auto tempBufs = mCallbackArena.Allocate<float *>(numPlaybackChannels);
+   if (!tempBufs)
+      tempBufs = stackAllocate(float *, numPlaybackChannels);
 
    // And these are larger structures....
    for (unsigned int c = 0; c < numPlaybackChannels; c++)
-      tempBufs[c] = stackAllocate(float, framesPerBuffer);
+      if (!(tempBufs[c] = mCallbackArena.Allocate<float>(framesPerBuffer)))
+         tempBufs[c] = stackAllocate(float, framesPerBuffer);
    // ------ End of MEMORY ALLOCATION ---------------
 
    // Choose a common size to take from all ring buffers
@@ -2790,8 +3104,10 @@ void AudioIoCallback::UpdateTimePosition(unsigned long framesPerBuffer)
       return;
 
    // Update the position seen by drawing code
-   mPlaybackSchedule.SetSequenceTime(
-      mPlaybackSchedule.mTimeQueue.Consumer( mMaxFramesOutput, mRate ) );
+   const auto time =
+      mPlaybackSchedule.mTimeQueue.Consumer( mMaxFramesOutput, mRate );
+   mPlaybackSchedule.SetSequenceTime( time );
+   mPlaybackSchedule.mTimeStreams.Publish(PlaybackTimeStreams::Playback, time);
 }
 
 // return true, IFF we have fully handled the callback.
@@ -2801,8 +3117,7 @@ void AudioIoCallback::UpdateTimePosition(unsigned long framesPerBuffer)
 void AudioIoCallback::DrainInputBuffers(
    constSamplePtr inputBuffer,
    unsigned long framesPerBuffer,
-   const PaStreamCallbackFlags statusFlags,
-   float * tempFloats
+   const PaStreamCallbackFlags statusFlags
 )
 {
    const auto numPlaybackChannels = mNumPlaybackChannels;
@@ -2813,7 +3128,7 @@ void AudioIoCallback::DrainInputBuffers(
       return;
    if( !inputBuffer )
       return;
-   if( numCaptureChannels <= 0 )
+   if( numCaptureChannels <= 0 || !mCaptureBuffer )
       return;
 
    // If there are no playback sequences, and we are recording, then the
@@ -2832,9 +3147,8 @@ void AudioIoCallback::DrainInputBuffers(
    // So we have not decided to enable this extra detection yet in
    // production
 
-   size_t len = framesPerBuffer;
-   for(unsigned t = 0; t < numCaptureChannels; t++)
-      len = std::min( len, mCaptureBuffers[t]->AvailForPut() );
+   size_t len = std::min<size_t>(
+      framesPerBuffer, mCaptureBuffer->AvailForPut());
 
    if (mSimulateRecordingErrors && 100LL * rand() < RAND_MAX)
       // Make spurious errors for purposes of testing the error
@@ -2843,7 +3157,7 @@ void AudioIoCallback::DrainInputBuffers(
 
    // A different symptom is that len < framesPerBuffer because
    // the other thread, executing SequenceBufferExchange, isn't consuming fast
-   // enough from mCaptureBuffers; maybe it's CPU-bound, or maybe the
+   // enough from mCaptureBuffer; maybe it's CPU-bound, or maybe the
    // storage device it writes is too slow
    if (mDetectDropouts &&
          ((mDetectUpstreamDropouts.load(std::memory_order_relaxed)
@@ -2873,53 +3187,15 @@ void AudioIoCallback::DrainInputBuffers(
    if (len <= 0)
       return;
 
-   // We have an ASSERT in the AudioIO constructor to alert us to
-   // possible issues with the (short*) cast.  We'd have a problem if
-   // sizeof(short) > sizeof(float) since our buffers are sized for floats.
-   for(unsigned t = 0; t < numCaptureChannels; t++) {
-
-      // dmazzoni:
-      // Un-interleave.  Ugly special-case code required because the
-      // capture channels could be in three different sample formats;
-      // it'd be nice to be able to call CopySamples, but it can't
-      // handle multiplying by the gain and then clipping.  Bummer.
-
-      switch(mCaptureFormat) {
-         case floatSample: {
-            auto inputFloats = (const float *)inputBuffer;
-            for(unsigned i = 0; i < len; i++)
-               tempFloats[i] =
-                  inputFloats[numCaptureChannels*i+t];
-         } break;
-         case int24Sample:
-            // We should never get here. Audacity's int24Sample format
-            // is different from PortAudio's sample format and so we
-            // make PortAudio return float samples when recording in
-            // 24-bit samples.
-            wxASSERT(false);
-            break;
-         case int16Sample: {
-            auto inputShorts = (const short *)inputBuffer;
-            short *tempShorts = (short *)tempFloats;
-            for( unsigned i = 0; i < len; i++) {
-               float tmp = inputShorts[numCaptureChannels*i+t];
-               tmp = std::clamp(tmp, -32768.0f, 32767.0f);
-               tempShorts[i] = (short)(tmp);
-            }
-         } break;
-      } // switch
-
-      // JKC: mCaptureFormat must be for samples with sizeof(float) or
-      // fewer bytes (because tempFloats is sized for floats).  All
-      // formats are 2 or 4 bytes, so we are OK.
-      const auto put =
-         mCaptureBuffers[t]->Put(
-            (samplePtr)tempFloats, mCaptureFormat, len);
-      // wxASSERT(put == len);
-      // but we can't assert in this thread
-      wxUnusedVar(put);
-      mCaptureBuffers[t]->Flush();
-   }
+   // The ring buffer keeps the device's interleaving and format, so that
+   // one copy suffices here; the audio thread separates the channels.
+   // mCaptureFormat is float when recording 24-bit, because Audacity's
+   // int24Sample differs from PortAudio's format.
+   const auto put = mCaptureBuffer->Put(
+      static_cast<constSamplePtr>(inputBuffer), mCaptureFormat, len);
+   // wxASSERT(put == len);
+   // but we can't assert in this thread
+   wxUnusedVar(put);
 }
 
 
@@ -3104,6 +3380,30 @@ int AudioIoCallback::AudioCallback(
    const PaStreamCallbackTimeInfo *timeInfo,
    const PaStreamCallbackFlags statusFlags, void * WXUNUSED(userData) )
 {
+   // Nothing here should use the heap, which could wait on a lock of the
+   // allocator.  Mixing and realtime effects, which may allocate, stay on the
+   // audio thread, also in direct playback; this only copies their results
+   RealtimeAllocationTrap::Scope trapScope;
+   mCallbackArena.Reset();
+
+   using Clock = std::chrono::steady_clock;
+   const auto callbackStart = Clock::now();
+   if (mNumPlaybackChannels > 0 && !mPlaybackBuffers.empty())
+      mStatistics.playbackFill.Add(100 * GetCommonlyReadyPlayback() /
+         std::max<size_t>(1, mPlaybackBuffers[0]->Capacity()));
+   Finally Do{ [&]{
+      using namespace std::chrono;
+      const auto elapsed =
+         duration_cast<microseconds>(Clock::now() - callbackStart).count();
+      mStatistics.callbackDuration.Add(elapsed);
+      if (mRate > 0 && framesPerBuffer > 0)
+         mStatistics.callbackLoad.Add(
+            lrint(elapsed * 1e-4 * mRate / framesPerBuffer));
+      if (mNumCaptureChannels > 0 && mCaptureBuffer)
+         mStatistics.captureFill.Add(100 * mCaptureBuffer->AvailForGet() /
+            std::max<size_t>(1, mCaptureBuffer->Capacity()));
+   } };
+
    // Poll sequences for change of state.
    // (User might click mute and solo buttons.)
    mbHasSoloSequences = CountSoloingSequences() > 0 ;
@@ -3131,17 +3431,26 @@ int AudioIoCallback::AudioCallback(
    // audio data.  One temporary use is for the InputMeter data.
    const auto numPlaybackChannels = mNumPlaybackChannels;
    const auto numCaptureChannels = mNumCaptureChannels;
-   const auto tempFloats = stackAllocate(float,
-      framesPerBuffer * std::max(numCaptureChannels, numPlaybackChannels));
+   // They come from the arena, which was reserved when the stream opened,
+   // unless it is exhausted by an unusually large buffer
+   const auto nTempFloats =
+      framesPerBuffer * std::max(numCaptureChannels, numPlaybackChannels);
+   auto tempFloats = mCallbackArena.Allocate<float>(nTempFloats);
+   if (!tempFloats)
+      tempFloats = stackAllocate(float, nTempFloats);
 
    bool bVolEmulationActive =
       (outputBuffer && GetMixerOutputVol() != 1.0);
    // outputMeterFloats is the scratch pad for the output meter.
    // we can often reuse the existing outputBuffer and save on allocating
    // something new.
-   const auto outputMeterFloats = bVolEmulationActive
-      ? stackAllocate(float, framesPerBuffer * numPlaybackChannels)
-      : outputBuffer;
+   auto outputMeterFloats = outputBuffer;
+   if (bVolEmulationActive) {
+      const auto nMeterFloats = framesPerBuffer * numPlaybackChannels;
+      outputMeterFloats = mCallbackArena.Allocate<float>(nMeterFloats);
+      if (!outputMeterFloats)
+         outputMeterFloats = stackAllocate(float, nMeterFloats);
+   }
    // ----- END of MEMORY ALLOCATIONS ------------------------------------------
 
    if (inputBuffer && numCaptureChannels) {
@@ -3201,8 +3510,7 @@ int AudioIoCallback::AudioCallback(
    DrainInputBuffers(
       inputBuffer,
       framesPerBuffer,
-      statusFlags,
-      tempFloats);
+      statusFlags);
 
    SendVuOutputMeterData( outputMeterFloats, framesPerBuffer);
 
@@ -3215,6 +3523,9 @@ int AudioIoCallback::AudioCallback(
 
 int AudioIoCallback::CallbackDoSeek()
 {
+   // This waits for the audio thread anyway
+   RealtimeAllocationTrap::Exemption exemption;
+
    const int token = mStreamToken;
    wxMutexLocker locker(mSuspendAudioThread);
    if (token != mStreamToken)
@@ -3262,6 +3573,7 @@ int AudioIoCallback::CallbackDoSeek()
    }
 
    mPlaybackSchedule.mTimeQueue.Prime(time);
+   mPlaybackSchedule.mTimeStreams.Publish(PlaybackTimeStreams::Playback, time);
 
    // Reload the ring buffers
    ProcessOnceAndWait();
@@ -3352,3 +3664,6 @@ bool AudioIO::IsCapturing() const
 }
 
 BoolSetting SoundActivatedRecord{ "/AudioIO/SoundActivatedRecord", false };
+BoolSetting DirectPlayback{ "/AudioIO/DirectPlayback", false };
+BoolSetting RecordToSpoolFile{ "/AudioIO/RecordToSpoolFile", false };
+BoolSetting AdaptivePlaybackLead{ "/AudioIO/AdaptivePlaybackLead", true };
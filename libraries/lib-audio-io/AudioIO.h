@@ -15,7 +15,12 @@
 
 #include "AudioIOBase.h" // to inherit
 #include "AudioIOSequences.h"
+#include "AudioIOStatistics.h" // member variable
+#include "AudioThreadScheduler.h" // member variable
+#include "PlaybackPrefetcher.h" // member variable
 #include "PlaybackSchedule.h" // member variable
+#include "ProjectAudioIO.h" // member variable
+#include "RealtimeArena.h" // member variable
 
 #include <functional>
 #include <memory>
@@ -32,6 +37,8 @@
 class wxArrayString;
 class AudioIOBase;
 class AudioIO;
+class MultiChannelRingBuffer;
+class RecordingSpool;
 class RingBuffer;
 class Mixer;
 class OtherPlayableSequence;
@@ -188,10 +195,14 @@ public:
    bool SequenceHasBeenFadedOut(const OldChannelGains &gains);
    bool AllSequencesAlreadySilent();
 
+   //! Publish the captured floats for MeasureSoundActivationLevel()
    void CheckSoundActivatedRecordingLevel(
       float *inputSamples,
       unsigned long framesPerBuffer
    );
+   //! Called by the audio thread; pause or resume sound activated recording
+   //! by the levels that the callback published
+   void MeasureSoundActivationLevel();
 
    /*!
     @param[in,out] channelGain
@@ -213,8 +224,7 @@ public:
    void DrainInputBuffers(
       constSamplePtr inputBuffer, 
       unsigned long framesPerBuffer,
-      const PaStreamCallbackFlags statusFlags,
-      float * tempFloats
+      const PaStreamCallbackFlags statusFlags
    );
    void UpdateTimePosition(
       unsigned long framesPerBuffer
@@ -269,7 +279,13 @@ public:
    std::vector<std::unique_ptr<Resample>> mResample;
 
    using RingBuffers = std::vector<std::unique_ptr<RingBuffer>>;
-   RingBuffers mCaptureBuffers;
+   //! All captured channels, interleaved as the device delivers them
+   std::unique_ptr<MultiChannelRingBuffer> mCaptureBuffer;
+   //! Captured floats, when recording is sound activated, for the audio
+   //! thread to measure instead of the callback
+   std::unique_ptr<MultiChannelRingBuffer> mLevelBuffer;
+   //! If not null, DrainRecordBuffers() writes here instead of appending
+   std::unique_ptr<RecordingSpool> mRecordingSpool;
    RecordableSequences mCaptureSequences;
    /*! Read by worker threads but unchanging during playback */
    RingBuffers mPlaybackBuffers;
@@ -280,8 +296,14 @@ public:
    // Temporary buffers, each as large as the playback buffers
    std::vector<SampleBuffer> mScratchBuffers;
    std::vector<float *> mScratchPointers; //!< pointing into mScratchBuffers
+   //! How many threads' sets of 2 * mNumPlaybackChannels + 1 scratch buffers
+   size_t mScratchSetsCount{ 1 };
 
    std::vector<std::unique_ptr<Mixer>> mPlaybackMixers;
+   //! Parallel to mPlaybackMixers; how each was made, for its reuse
+   std::vector<ProjectAudioIO::MixerKey> mPlaybackMixerKeys;
+   //! Warms sample data ahead of what mPlaybackMixers will fetch
+   PlaybackPrefetcher mPlaybackPrefetcher;
 
    std::atomic<float>  mMixerOutputVol{ 1.0 };
    static int          mNextStreamToken;
@@ -300,6 +322,18 @@ public:
    size_t              mHardwarePlaybackLatencyFrames {};
    /// Occupancy of the queue we try to maintain, with bigger batches if needed
    size_t              mPlaybackQueueMinimum;
+   /// True if the audio thread keeps playback RingBuffers filled only a
+   /// little beyond the hardware latency, from resident material
+   /*! Read by worker threads but unchanging during playback */
+   bool                mDirectPlayback{ false };
+   /// During direct playback, keep the played samples resident for all of
+   /// the stream, exempt from evictions of caches
+   std::vector<std::shared_ptr<const void>> mResidencyPins;
+   /// Scratch memory for the callback, reserved when the stream opens, and
+   /// reset at the start of each callback
+   RealtimeArena       mCallbackArena;
+   /// Updated by the callback and audio threads
+   AudioIOStatistics   mStatistics;
 
    double              mMinCaptureSecsToCopy;
    /*! Read by a worker thread but unchanging during playback */
@@ -392,6 +426,16 @@ public:
    const std::vector< std::pair<double, double> > &LostCaptureIntervals()
    { return mLostCaptureIntervals; }
 
+   //! Timings and queue occupancies since the last stream started; may be
+   //! read from any thread
+   const AudioIOStatistics &GetStatistics() const { return mStatistics; }
+
+   //! Make samples of the playing sequences resident between the times,
+   //! ahead of a jump, as scrubbing predicts; may be called from any thread
+   /*! @return false if no playback is prefetching */
+   bool PrefetchPlayback(double t0, double t1)
+   { return mPlaybackPrefetcher.RequestRange(t0, t1); }
+
    // Used only for testing purposes in alpha builds
    bool mSimulateRecordingErrors{ false };
 
@@ -575,6 +619,11 @@ public:
     */
    double GetStreamTime();
 
+   //! Streams of sequence times that any thread may read without locks,
+   //! including the played time as stream PlaybackTimeStreams::Playback
+   /*! Other streams may be acquired for other producers */
+   PlaybackTimeStreams &GetTimeStreams() { return mPlaybackSchedule.mTimeStreams; }
+
    static void AudioThread(std::atomic<bool> &finish);
 
    static void Init();
@@ -604,6 +653,8 @@ private:
     * and false if it did not. */
    bool StartPortAudioStream(const AudioIOStartStreamOptions &options,
       unsigned int numPlaybackChannels, unsigned int numCaptureChannels);
+   //! Size mCallbackArena for the channels and latency of the stream
+   void ReserveCallbackArena();
 
    void SetOwningProject( const std::shared_ptr<AudacityProject> &pProject );
    void ResetOwningProject();
@@ -618,6 +669,8 @@ private:
 
    //! First part of SequenceBufferExchange
    void FillPlayBuffers();
+   //! @param queueMinimum occupancy of the queue to reach, if possible
+   void FillPlayBuffers(size_t queueMinimum);
    void TransformPlayBuffers(
       std::optional<RealtimeEffects::ProcessingScope> &scope);
    bool ProcessPlaybackSlices(
@@ -657,6 +710,9 @@ private:
      * If bOnlyBuffers is specified, it only cleans up the buffers. */
    void StartStreamCleanup(bool bOnlyBuffers = false);
 
+   //! Used by the audio thread, except when it makes no passes
+   AudioThreadScheduler mAudioThreadScheduler;
+
    std::mutex mPostRecordingActionMutex;
    PostRecordingAction mPostRecordingAction;
 
@@ -664,5 +720,22 @@ private:
 };
 
 AUDIO_IO_API extern BoolSetting SoundActivatedRecord;
+//! Whether playback of material resident in memory may be mixed by the audio
+//! thread only one small batch ahead of the device, for latency little more
+//! than the device buffer
+AUDIO_IO_API extern BoolSetting DirectPlayback;
+//! Whether recording streams to a temporary file, and a worker thread appends
+//! from it to the tracks, so that slow storage of the project never makes
+//! the capture buffer overflow
+AUDIO_IO_API extern BoolSetting RecordToSpoolFile;
+//! Whether the audio thread may fill the playback queue further ahead than
+//! the preferred latency, when its passes are expensive
+AUDIO_IO_API extern BoolSetting AdaptivePlaybackLead;
+
+//! Identifies changes of the software playthrough, micro-fades and silence
+//! level preferences, which AudioIO copies; broadcast it after writing them
+//! anywhere but in the Preferences dialog
+/*! @see PrefsListener::Broadcast */
+AUDIO_IO_API int AudioIOPrefsID();
 
 #endif
@@ -0,0 +1,32 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file AudioIOStatistics.cpp
+
+**********************************************************************/
+
+#include "AudioIOStatistics.h"
+
+namespace {
+constexpr auto Percents = AtomicHistogram::Scale::Linear;
+// 5% per bin, so that 100% and more fill bin 20
+constexpr uint64_t PercentsWidth = 5;
+}
+
+AudioIOStatistics::AudioIOStatistics()
+   : callbackLoad{ Percents, PercentsWidth }
+   , playbackFill{ Percents, PercentsWidth }
+   , captureFill{ Percents, PercentsWidth }
+{
+}
+
+void AudioIOStatistics::Reset() noexcept
+{
+   for (auto pHistogram : {
+      &callbackDuration, &callbackLoad, &playbackFill, &captureFill,
+      &playbackResampling, &captureResampling, &realtimeChain
+   })
+      pHistogram->Reset();
+   realtimeThreads.store(0, std::memory_order_relaxed);
+}
@@ -0,0 +1,50 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file AudioIOStatistics.h
+  @brief Distributions of timings and queue occupancies of the audio engine
+
+**********************************************************************/
+
+#ifndef __AUDACITY_AUDIO_IO_STATISTICS__
+#define __AUDACITY_AUDIO_IO_STATISTICS__
+
+#include "AtomicHistogram.h"
+
+#include <atomic>
+#include <cstddef>
+
+//! Instrumentation that the callback and audio threads update without locks,
+//! and any thread may read, as during playback
+/*! All are reset when a stream starts */
+struct AUDIO_IO_API AudioIOStatistics final
+{
+   AudioIOStatistics();
+
+   //! Done in the main thread; values added concurrently may persist
+   void Reset() noexcept;
+
+   //! Microseconds spent in each callback
+   AtomicHistogram callbackDuration;
+   //! Percent of the callback's deadline, which is the duration of its buffer,
+   //! spent in it
+   AtomicHistogram callbackLoad;
+   //! Percent of capacity of the playback queue, at the start of each callback
+   AtomicHistogram playbackFill;
+   //! Percent of capacity of the capture queue, at the end of each callback
+   AtomicHistogram captureFill;
+   //! Microseconds spent in each call to a playback mixer, which resamples,
+   //! converts formats, and warps time
+   AtomicHistogram playbackResampling;
+   //! Microseconds spent in each call resampling one captured channel
+   AtomicHistogram captureResampling;
+   //! Microseconds spent applying the realtime effect chain of one track to
+   //! the samples it had pending, in each pass that filled the queue
+   AtomicHistogram realtimeChain;
+   //! How many threads may apply the chains of different tracks at once,
+   //! including that filling the queue; set when the stream starts
+   std::atomic<size_t> realtimeThreads{ 0 };
+};
+
+#endif
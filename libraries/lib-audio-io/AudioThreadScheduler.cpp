@@ -0,0 +1,136 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file AudioThreadScheduler.cpp
+
+**********************************************************************/
+
+#include "AudioThreadScheduler.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(_WIN32)
+#include <windows.h>
+#elif defined(__APPLE__)
+#include <pthread.h>
+#include <sys/qos.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+//! Per pass decay of the remembered peak cost; about 200 passes, which is
+//! two seconds at the default interval, halve a spike
+constexpr double PeakDecay = 0.9965;
+//! The lead covers this many of the most expensive recent passes
+constexpr double CostsCovered = 4.0;
+//! Sustained headroom, in passes, before the lead shrinks one step
+constexpr size_t CalmPassesToShrink = 500;
+}
+
+void AudioThreadScheduler::Reset(size_t minimumLead, size_t maximumLead,
+   size_t batch, double rate, bool adaptive)
+{
+   mPending = { minimumLead, std::max(minimumLead, maximumLead),
+      std::max<size_t>(1, batch), rate, adaptive };
+   mResetPending = true;
+}
+
+void AudioThreadScheduler::ApplyReset()
+{
+   if (!mResetPending)
+      return;
+   mResetPending = false;
+   mMinimumLead = mPending.minimumLead;
+   mMaximumLead = mPending.maximumLead;
+   mBatch = mPending.batch;
+   mRate = mPending.rate;
+   mAdaptive = mPending.adaptive;
+   mLead = mMinimumLead;
+   mPeakCost = 0;
+   mCalmPasses = 0;
+}
+
+size_t AudioThreadScheduler::ToFrames(Duration interval) const
+{
+   using namespace std::chrono;
+   const auto seconds = duration_cast<duration<double>>(interval).count();
+   return static_cast<size_t>(std::max(0.0, std::ceil(seconds * mRate)));
+}
+
+void AudioThreadScheduler::Grow(size_t lead)
+{
+   // Keep multiples of the batch, as AllocateBuffers does for the minimum
+   lead = mBatch * ((lead + mBatch - 1) / mBatch);
+   mLead = std::clamp(lead, mLead, mMaximumLead);
+   mCalmPasses = 0;
+}
+
+void AudioThreadScheduler::NotePass(size_t readyBefore, Duration elapsed)
+{
+   if (!mAdaptive)
+      return;
+
+   const auto cost = static_cast<double>(ToFrames(elapsed));
+   mPeakCost = std::max(cost, mPeakCost * PeakDecay);
+
+   // Enough queued to survive several of the worst recent passes, plus the
+   // one batch that the next pass might still be producing
+   const auto desired = std::max(mMinimumLead,
+      static_cast<size_t>(CostsCovered * mPeakCost) + mBatch);
+
+   if (readyBefore < mLead / 4) {
+      // The consumer nearly caught up:  the cost of one pass is not the
+      // whole story (preemption, a late wake-up), so grow by half at least
+      Grow(std::max(desired, mLead + mLead / 2));
+      return;
+   }
+   if (desired > mLead) {
+      Grow(desired);
+      return;
+   }
+
+   // Shrink by small steps, only after long calm
+   if (readyBefore >= mLead / 2 && desired + desired / 2 < mLead) {
+      if (++mCalmPasses >= CalmPassesToShrink) {
+         const auto step = std::max(mBatch, mLead / 8);
+         mLead = std::max(desired, mLead - std::min(mLead, step));
+         mLead = std::max(mLead, mMinimumLead);
+         mCalmPasses = 0;
+      }
+   }
+   else
+      mCalmPasses = 0;
+}
+
+auto AudioThreadScheduler::SleepInterval(Duration policyInterval) const
+   -> Duration
+{
+   using namespace std::chrono;
+   if (mRate <= 0)
+      return policyInterval;
+   // Wake at least four times while a full lead would drain
+   const auto quarterLead = duration_cast<Duration>(
+      duration<double>{ mLead / (4 * mRate) });
+   return std::min(policyInterval,
+      std::max<Duration>(quarterLead, 1ms));
+}
+
+bool AudioThreadScheduler::RaiseCurrentThreadPriority()
+{
+#if defined(_WIN32)
+   // Still below the time critical priority of the device callback
+   return SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_HIGHEST) != 0;
+#elif defined(__APPLE__)
+   return pthread_set_qos_class_self_np(QOS_CLASS_USER_INTERACTIVE, 0) == 0;
+#else
+   // The least realtime priority, below that of device callbacks; fails
+   // harmlessly without the privilege
+   sched_param param{};
+   param.sched_priority = sched_get_priority_min(SCHED_RR);
+   return pthread_setschedparam(pthread_self(), SCHED_RR, &param) == 0;
+#endif
+}
@@ -0,0 +1,97 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file AudioThreadScheduler.h
+  @brief Adapts the playback lead and the wake-ups of the audio thread to
+  the measured cost of its passes
+
+**********************************************************************/
+
+#ifndef __AUDACITY_AUDIO_THREAD_SCHEDULER__
+#define __AUDACITY_AUDIO_THREAD_SCHEDULER__
+
+#include <chrono>
+#include <cstddef>
+
+//! Decides how full the audio thread keeps the playback queue, and how long
+//! it may sleep between passes
+/*!
+ Each pass of the audio thread reports the queue's occupancy when it began
+ and the time it took.  The lead grows at once when the queue ran low or the
+ passes became expensive, and shrinks slowly after sustained headroom, never
+ below the minimum the policy and the hardware need.
+
+ All functions but Reset() are for the audio thread only.  Reset() is for
+ the main thread, and takes effect when the audio thread calls ApplyReset(),
+ in the pass that the main thread requests after it, through the release and
+ acquire of the flag for one exchange.  So no field is shared.
+ */
+class AUDIO_IO_API AudioThreadScheduler final
+{
+public:
+   using Duration = std::chrono::steady_clock::duration;
+
+   //! Start adapting for a new stream
+   /*!
+    @param minimumLead frames of the queue that must always be the goal
+    @param maximumLead frames beyond which the lead may not grow
+    @param batch preferred frames to produce in each pass
+    @param rate frames per second
+    @param adaptive if false, the lead stays at minimumLead
+    */
+   void Reset(size_t minimumLead, size_t maximumLead, size_t batch,
+      double rate, bool adaptive);
+
+   //! Start adapting with the parameters of the last Reset(), if not yet done
+   void ApplyReset();
+
+   //! Occupancy of the queue to maintain, in frames
+   size_t GetLead() const { return mLead; }
+
+   //! Record one pass that produced or consumed samples
+   /*!
+    @param readyBefore frames in the playback queue when the pass began
+    @param elapsed time taken by the pass
+    */
+   void NotePass(size_t readyBefore, Duration elapsed);
+
+   //! How long to sleep after a pass, no longer than the policy's interval,
+   //! and short enough to wake several times while the lead drains, even if
+   //! it does not adapt
+   Duration SleepInterval(Duration policyInterval) const;
+
+   //! Give the calling thread a priority above normal, if the platform
+   //! allows it without special privileges
+   /*! @return whether the priority changed */
+   static bool RaiseCurrentThreadPriority();
+
+private:
+   size_t ToFrames(Duration interval) const;
+   void Grow(size_t lead);
+
+   struct Parameters {
+      size_t minimumLead{ 0 };
+      size_t maximumLead{ 0 };
+      size_t batch{ 1 };
+      double rate{ 44100 };
+      bool adaptive{ false };
+   };
+   //! Written by Reset(), read by ApplyReset()
+   Parameters mPending;
+   bool mResetPending{ false };
+
+   size_t mMinimumLead{ 0 };
+   size_t mMaximumLead{ 0 };
+   size_t mBatch{ 1 };
+   double mRate{ 44100 };
+   bool mAdaptive{ false };
+
+   size_t mLead{ 0 };
+   //! Slowly decaying maximum of the frames that elapsed during a pass
+   double mPeakCost{ 0 };
+   //! Consecutive passes that found enough headroom to shrink the lead
+   size_t mCalmPasses{ 0 };
+};
+
+#endif
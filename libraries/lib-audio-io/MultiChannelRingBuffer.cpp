@@ -0,0 +1,150 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file MultiChannelRingBuffer.cpp
+
+  The ordering of atomic operations is as in RingBuffer.cpp.
+
+**********************************************************************/
+
+#include "MultiChannelRingBuffer.h"
+#include "Dither.h"
+
+#include <algorithm>
+#include <cstring>
+
+MultiChannelRingBuffer::MultiChannelRingBuffer(
+   sampleFormat format, size_t nChannels, size_t frames)
+   : mChannels{ std::max<size_t>(nChannels, 1) }
+   , mBufferSize{ std::max<size_t>(frames, 64) }
+   , mFormat{ format }
+   , mBuffer{ mBufferSize * mChannels, mFormat }
+{
+}
+
+MultiChannelRingBuffer::~MultiChannelRingBuffer()
+{
+}
+
+size_t MultiChannelRingBuffer::Filled(size_t start, size_t end) const
+{
+   return (end + mBufferSize - start) % mBufferSize;
+}
+
+size_t MultiChannelRingBuffer::Free(size_t start, size_t end) const
+{
+   return std::max<size_t>(mBufferSize - Filled(start, end), 4) - 4;
+}
+
+//
+// For the writer only:
+//
+
+size_t MultiChannelRingBuffer::AvailForPut() const
+{
+   auto start = mStart.load(std::memory_order_relaxed);
+   auto end = mEnd.load(std::memory_order_relaxed);
+   return Free(start, end);
+}
+
+size_t MultiChannelRingBuffer::Put(
+   constSamplePtr buffer, sampleFormat format, size_t frames)
+{
+   auto start = mStart.load(std::memory_order_acquire);
+   auto end = mEnd.load(std::memory_order_relaxed);
+   frames = std::min(frames, Free(start, end));
+   const auto frameSize = SAMPLE_SIZE(mFormat) * mChannels;
+   const auto srcFrameSize = SAMPLE_SIZE(format) * mChannels;
+   auto src = buffer;
+   auto pos = end;
+   size_t copied = 0;
+
+   while (frames) {
+      // At most two blocks, each copied at once, all channels together
+      const auto block = std::min(frames, mBufferSize - pos);
+      const auto dst = mBuffer.ptr() + pos * frameSize;
+      if (format == mFormat)
+         memcpy(dst, src, block * frameSize);
+      else
+         CopySamples(src, format, dst, mFormat, block * mChannels,
+            DitherType::none);
+      src += block * srcFrameSize;
+      pos = (pos + block) % mBufferSize;
+      frames -= block;
+      copied += block;
+   }
+
+   mEnd.store(pos, std::memory_order_release);
+   return copied;
+}
+
+//
+// For the reader only:
+//
+
+size_t MultiChannelRingBuffer::AvailForGet() const
+{
+   auto end = mEnd.load(std::memory_order_relaxed);
+   auto start = mStart.load(std::memory_order_relaxed);
+   return Filled(start, end);
+}
+
+size_t MultiChannelRingBuffer::Peek(size_t channel, size_t offset,
+   samplePtr buffer, sampleFormat format, size_t frames) const
+{
+   if (channel >= mChannels)
+      return 0;
+   auto end = mEnd.load(std::memory_order_acquire);
+   auto start = mStart.load(std::memory_order_relaxed);
+   const auto filled = Filled(start, end);
+   offset = std::min(offset, filled);
+   frames = std::min(frames, filled - offset);
+   const auto sampleSize = SAMPLE_SIZE(mFormat);
+   auto pos = (start + offset) % mBufferSize;
+   auto dest = buffer;
+   size_t copied = 0;
+
+   while (frames) {
+      const auto block = std::min(frames, mBufferSize - pos);
+      // De-interleave
+      CopySamples(
+         mBuffer.ptr() + (pos * mChannels + channel) * sampleSize, mFormat,
+         dest, format, block, DitherType::none, mChannels, 1);
+      dest += block * SAMPLE_SIZE(format);
+      pos = (pos + block) % mBufferSize;
+      frames -= block;
+      copied += block;
+   }
+
+   return copied;
+}
+
+std::pair<constSamplePtr, size_t> MultiChannelRingBuffer::GetReadable(
+   size_t offset, size_t frames, unsigned iBlock) const
+{
+   auto end = mEnd.load(std::memory_order_acquire);
+   auto start = mStart.load(std::memory_order_relaxed);
+   const auto filled = Filled(start, end);
+   offset = std::min(offset, filled);
+   frames = std::min(frames, filled - offset);
+   const auto pos = (start + offset) % mBufferSize;
+   const auto size0 = std::min(frames, mBufferSize - pos);
+   const auto frameSize = SAMPLE_SIZE(mFormat) * mChannels;
+   if (iBlock == 0)
+      return { size0 ? mBuffer.ptr() + pos * frameSize : nullptr, size0 };
+   const auto size1 = frames - size0;
+   return { size1 ? mBuffer.ptr() : nullptr, size1 };
+}
+
+size_t MultiChannelRingBuffer::Discard(size_t frames)
+{
+   auto end = mEnd.load(std::memory_order_relaxed);
+   auto start = mStart.load(std::memory_order_relaxed);
+   frames = std::min(frames, Filled(start, end));
+
+   // Release, so that the reads in Peek() happen-before reuse of the space
+   mStart.store((start + frames) % mBufferSize, std::memory_order_release);
+
+   return frames;
+}
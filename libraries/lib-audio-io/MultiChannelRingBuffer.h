@@ -0,0 +1,82 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file MultiChannelRingBuffer.h
+  @brief Holds streamed frames of several channels, interleaved
+
+**********************************************************************/
+
+#ifndef __AUDACITY_MULTI_CHANNEL_RING_BUFFER__
+#define __AUDACITY_MULTI_CHANNEL_RING_BUFFER__
+
+#include "SampleFormat.h"
+#include <atomic>
+#include <utility>
+
+//! A lock-free bounded queue of frames for one writer and one reader, like
+//! RingBuffer, but with one pair of positions for all channels
+/*!
+ Frames are stored interleaved, as audio devices deliver them, so that the
+ writer copies each buffer from the device at once, and only one cache line
+ of positions is shared between the threads, however many the channels.
+ The reader takes out one channel at a time, and then consumes frames of all
+ channels together.
+ */
+class MultiChannelRingBuffer final : public NonInterferingBase {
+ public:
+   MultiChannelRingBuffer(
+      sampleFormat format, size_t nChannels, size_t frames);
+   ~MultiChannelRingBuffer();
+
+   size_t Channels() const { return mChannels; }
+   //! For either thread; a little more than may be filled, in frames
+   size_t Capacity() const { return mBufferSize; }
+
+   //
+   // For the writer only:
+   //
+
+   size_t AvailForPut() const;
+   //! Copy interleaved frames with as many channels as this, and make them
+   //! available to the reader at once
+   /*! Does not apply dithering */
+   size_t Put(constSamplePtr buffer, sampleFormat format, size_t frames);
+
+   //
+   // For the reader only:
+   //
+
+   size_t AvailForGet() const;
+   //! Copy one channel of frames, after skipping some, without consuming
+   /*! Does not apply dithering */
+   size_t Peek(size_t channel, size_t offset,
+      samplePtr buffer, sampleFormat format, size_t frames) const;
+   //! Direct access to interleaved frames, after skipping some, without
+   //! consuming; they are in at most two blocks
+   /*!
+    @param frames at most this many, in both blocks together
+    @return pointer to the first channel of the first frame of the block,
+    and the number of frames in it
+    */
+   std::pair<constSamplePtr, size_t>
+   GetReadable(size_t offset, size_t frames, unsigned iBlock) const;
+   //! Consume frames of all channels
+   size_t Discard(size_t frames);
+
+ private:
+   size_t Filled(size_t start, size_t end) const;
+   size_t Free(size_t start, size_t end) const;
+
+   // Align the two atomics to avoid false sharing
+   NonInterfering< std::atomic<size_t> > mStart{ 0 }, mEnd{ 0 };
+
+   const size_t mChannels;
+   //! In frames
+   const size_t mBufferSize;
+
+   const sampleFormat mFormat;
+   const SampleBuffer mBuffer;
+};
+
+#endif
@@ -0,0 +1,116 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file PlaybackPrefetcher.cpp
+
+**********************************************************************/
+
+#include "PlaybackPrefetcher.h"
+
+#include <algorithm>
+#include <cmath>
+
+PlaybackPrefetcher::PlaybackPrefetcher() = default;
+
+PlaybackPrefetcher::~PlaybackPrefetcher()
+{
+   Stop();
+}
+
+void PlaybackPrefetcher::Start(
+   ConstPlayableSequences sequences, double time, bool reversed)
+{
+   Stop();
+   if (sequences.empty())
+      return;
+
+   {
+      std::lock_guard<std::mutex> lock{ mMutex };
+      mSequences = move(sequences);
+      mStop = false;
+   }
+   mReversed = reversed;
+   mThread = std::thread{ [this]{ Run(); } };
+
+   // Force the first request
+   mLastRequestedTime = time + 2 * Granularity;
+   Request(time);
+}
+
+void PlaybackPrefetcher::Request(double time)
+{
+   if (!mThread.joinable() ||
+      std::abs(time - mLastRequestedTime) < Granularity)
+      return;
+   mLastRequestedTime = time;
+   {
+      std::lock_guard<std::mutex> lock{ mMutex };
+      mRequestedTime = time;
+      mPending = true;
+   }
+   mCondition.notify_one();
+}
+
+bool PlaybackPrefetcher::RequestRange(double t0, double t1)
+{
+   {
+      std::lock_guard<std::mutex> lock{ mMutex };
+      if (mSequences.empty())
+         return false;
+      mRangeStart = std::max(0.0, std::min(t0, t1));
+      mRangeEnd = std::max(0.0, std::max(t0, t1));
+      mRangePending = true;
+   }
+   mCondition.notify_one();
+   return true;
+}
+
+void PlaybackPrefetcher::Stop()
+{
+   if (!mThread.joinable())
+      return;
+   {
+      std::lock_guard<std::mutex> lock{ mMutex };
+      mStop = true;
+   }
+   mCondition.notify_one();
+   mThread.join();
+
+   std::lock_guard<std::mutex> lock{ mMutex };
+   mSequences.clear();
+   mPending = false;
+   mRangePending = false;
+}
+
+void PlaybackPrefetcher::Run()
+{
+   std::unique_lock<std::mutex> lock{ mMutex };
+   while (true) {
+      mCondition.wait(lock,
+         [this]{ return mStop || mPending || mRangePending; });
+      if (mStop)
+         return;
+      double t0, t1;
+      if (mRangePending) {
+         // A predicted jump is more urgent than reading ahead
+         mRangePending = false;
+         t0 = mRangeStart;
+         t1 = mRangeEnd;
+      }
+      else {
+         mPending = false;
+         const auto time = mRequestedTime;
+         t0 = std::max(0.0, mReversed ? time - Horizon : time);
+         t1 = std::max(0.0, mReversed ? time : time + Horizon);
+      }
+      // Copy the pointers, so the lock need not be held while prefetching
+      const auto sequences = mSequences;
+      lock.unlock();
+
+      for (const auto &pSequence : sequences)
+         pSequence->Prefetch(t0, t1);
+
+      lock.lock();
+   }
+}
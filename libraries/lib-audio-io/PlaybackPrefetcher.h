@@ -0,0 +1,68 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file PlaybackPrefetcher.h
+  @brief Warms sample data ahead of the play head on a worker thread
+
+**********************************************************************/
+
+#ifndef __AUDACITY_PLAYBACK_PREFETCHER__
+#define __AUDACITY_PLAYBACK_PREFETCHER__
+
+#include "AudioIOSequences.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+//! Asks the playing sequences to make upcoming samples resident, so that
+//! the audio thread, filling play buffers, need not wait for storage
+class AUDIO_IO_API PlaybackPrefetcher final
+{
+public:
+   //! How far ahead of the play head, in sequence seconds, to prefetch
+   static constexpr double Horizon = 8.0;
+   //! Movement of the play head, in sequence seconds, before a new request
+   static constexpr double Granularity = 1.0;
+
+   PlaybackPrefetcher();
+   ~PlaybackPrefetcher();
+
+   //! Start the worker thread and prefetch from the given time
+   void Start(ConstPlayableSequences sequences, double time, bool reversed);
+
+   //! Called by the thread that fills play buffers; does not block for long
+   void Request(double time);
+
+   //! Prefetch the given range before the next request of Request(), as
+   //! where scrubbing is predicted to go; may be called from any thread, and
+   //! replaces any range still pending
+   /*! @return false if not started */
+   bool RequestRange(double t0, double t1);
+
+   //! Stops the worker, waiting for any prefetch in progress
+   void Stop();
+
+private:
+   void Run();
+
+   std::thread mThread;
+   std::mutex mMutex;
+   std::condition_variable mCondition;
+
+   // Guarded by mMutex
+   ConstPlayableSequences mSequences;
+   double mRequestedTime{ 0 };
+   double mRangeStart{ 0 };
+   double mRangeEnd{ 0 };
+   bool mPending{ false };
+   bool mRangePending{ false };
+   bool mStop{ false };
+
+   // Accessed by the requesting thread only
+   double mLastRequestedTime{ 0 };
+   bool mReversed{ false };
+};
+
+#endif
@@ -15,6 +15,7 @@
 #include "MessageBuffer.h"
 #include "Mix.h"
 #include "Observer.h"
+#include "PlaybackTimeStreams.h"
 #include <atomic>
 #include <chrono>
 #include <vector>
@@ -94,6 +95,12 @@ public:
    //! Provide hints for construction of playback RingBuffer objects
    virtual BufferTimes SuggestedBufferTimes(PlaybackSchedule &schedule);
 
+   //! Whether the AudioIO::SequenceBufferExchange thread may keep the
+   //! playback RingBuffers filled only a little ahead of the device, when the
+   //! material is resident in memory
+   /*! Default returns true. */
+   virtual bool AllowDirectPlayback(PlaybackSchedule &schedule);
+
    //! @section Called by the PortAudio callback thread
 
    //! Whether repositioning commands are allowed during playback
@@ -251,6 +258,10 @@ struct AUDIO_IO_API PlaybackSchedule {
       NonInterfering<Cursor> mHead, mTail;
    } mTimeQueue;
 
+   //! Times published for readers at display rate, such as the play head;
+   //! stream Playback repeats what the consumer of mTimeQueue finds
+   PlaybackTimeStreams mTimeStreams;
+
    PlaybackPolicy &GetPolicy();
    const PlaybackPolicy &GetPolicy() const;
 
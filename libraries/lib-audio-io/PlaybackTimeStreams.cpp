@@ -0,0 +1,93 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file PlaybackTimeStreams.cpp
+
+**********************************************************************/
+
+#include "PlaybackTimeStreams.h"
+
+#include <chrono>
+
+namespace {
+double Now()
+{
+   using namespace std::chrono;
+   return duration<double>{ steady_clock::now().time_since_epoch() }.count();
+}
+}
+
+PlaybackTimeStreams::PlaybackTimeStreams() = default;
+
+auto PlaybackTimeStreams::Acquire() noexcept -> StreamID
+{
+   auto inUse = mInUse.load(std::memory_order_relaxed);
+   while (~inUse != 0) {
+      StreamID id = 0;
+      while (inUse & (1u << id))
+         ++id;
+      if (mInUse.compare_exchange_weak(inUse, inUse | (1u << id),
+         std::memory_order_acquire, std::memory_order_relaxed)) {
+         Reset(id);
+         return id;
+      }
+   }
+   return NoStream;
+}
+
+void PlaybackTimeStreams::Release(StreamID id) noexcept
+{
+   if (id == Playback || id >= MaxStreams)
+      return;
+   Reset(id);
+   mInUse.fetch_and(~(1u << id), std::memory_order_release);
+}
+
+void PlaybackTimeStreams::Publish(StreamID id, double time) noexcept
+{
+   if (id >= MaxStreams)
+      return;
+   auto &slot = mSlots[id];
+   const auto sequence = slot.sequence.load(std::memory_order_relaxed);
+   // Make the count odd, and keep the stores below from moving ahead of it
+   slot.sequence.store(sequence | 1, std::memory_order_relaxed);
+   std::atomic_thread_fence(std::memory_order_release);
+   slot.time.store(time, std::memory_order_relaxed);
+   slot.stamp.store(Now(), std::memory_order_relaxed);
+   // Next even count, never zero
+   auto next = (sequence | 1) + 1;
+   if (next == 0)
+      next = 2;
+   slot.sequence.store(next, std::memory_order_release);
+}
+
+bool PlaybackTimeStreams::Read(StreamID id, Sample &sample) const noexcept
+{
+   if (id >= MaxStreams)
+      return false;
+   auto &slot = mSlots[id];
+   while (true) {
+      const auto before = slot.sequence.load(std::memory_order_acquire);
+      if (before == 0)
+         return false;
+      if (before & 1)
+         // Writer is busy and will finish promptly
+         continue;
+      Sample result{
+         slot.time.load(std::memory_order_relaxed),
+         slot.stamp.load(std::memory_order_relaxed)
+      };
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (slot.sequence.load(std::memory_order_relaxed) == before) {
+         sample = result;
+         return true;
+      }
+   }
+}
+
+void PlaybackTimeStreams::Reset(StreamID id) noexcept
+{
+   if (id < MaxStreams)
+      mSlots[id].sequence.store(0, std::memory_order_release);
+}
@@ -0,0 +1,78 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file PlaybackTimeStreams.h
+  @brief Lock-free publication of several sequence time streams
+
+**********************************************************************/
+
+#ifndef __AUDACITY_PLAYBACK_TIME_STREAMS__
+#define __AUDACITY_PLAYBACK_TIME_STREAMS__
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "MemoryX.h"
+
+//! Independent streams of sequence times, each written by one thread at a
+//! time and read by any threads without locks
+/*!
+ Stream Playback is reserved for the time consumed by the PortAudio callback.
+ Others, such as latency-compensated positions of tracks or scrubbing, may be
+ acquired and released by any thread.
+
+ Each stream is a sequence lock:  the writer never waits, and readers retry
+ only if they overlap a write, so that the main thread reading at display
+ rate does not delay the callback.
+ */
+class AUDIO_IO_API PlaybackTimeStreams final
+{
+public:
+   using StreamID = size_t;
+   static constexpr size_t MaxStreams = 32;
+   static constexpr StreamID Playback = 0;
+   //! Returned by Acquire when all streams are in use
+   static constexpr StreamID NoStream = MaxStreams;
+
+   struct Sample {
+      double time{};
+      //! Seconds of the steady clock when the time was published, which
+      //! allows readers to extrapolate between publications
+      double stamp{};
+   };
+
+   PlaybackTimeStreams();
+
+   //! Claim an unused stream, initially with no sample; any thread
+   StreamID Acquire() noexcept;
+   //! Give the stream back; its writer must not publish any more
+   void Release(StreamID id) noexcept;
+
+   //! Called only by the single writer of the stream; wait-free
+   void Publish(StreamID id, double time) noexcept;
+
+   //! Any thread; lock-free
+   /*! @return false if nothing was published since the stream was acquired
+    or reset */
+   bool Read(StreamID id, Sample &sample) const noexcept;
+
+   //! Forget the sample of the stream; called by its writer
+   void Reset(StreamID id) noexcept;
+
+private:
+   struct Slot {
+      //! Odd while a write is in progress; zero if never written
+      std::atomic<uint32_t> sequence{ 0 };
+      std::atomic<double> time{ 0 };
+      std::atomic<double> stamp{ 0 };
+   };
+   //! Aligned to avoid false sharing among writers of different streams
+   NonInterfering<Slot> mSlots[MaxStreams];
+   std::atomic<uint32_t> mInUse{ 1u << Playback };
+
+   static_assert(MaxStreams <= 32, "Too many streams for the in-use mask");
+};
+
+#endif
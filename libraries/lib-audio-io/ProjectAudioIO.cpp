@@ -62,6 +62,30 @@ ProjectAudioIO::~ProjectAudioIO()
 {
 }
 
+bool ProjectAudioIO::MixerKey::operator ==(const MixerKey &other) const
+{
+   return rate == other.rate &&
+      bufferSize == other.bufferSize &&
+      envelope == other.envelope &&
+      minSpeed == other.minSpeed &&
+      maxSpeed == other.maxSpeed;
+}
+
+auto ProjectAudioIO::TakeWarmMixers() -> WarmMixers
+{
+   return std::move(mWarmMixers);
+}
+
+void ProjectAudioIO::SetWarmMixers(WarmMixers mixers)
+{
+   mWarmMixers = std::move(mixers);
+}
+
+void ProjectAudioIO::ReleaseWarmMixers()
+{
+   WarmMixers{}.swap(mWarmMixers);
+}
+
 int ProjectAudioIO::GetAudioIOToken() const
 {
    return mAudioIOToken;
@@ -18,9 +18,12 @@ Paul Licameli split from AudacityProject.h
 
 #include <atomic>
 #include <memory>
+#include <vector>
 class AudacityProject;
 struct AudioIOStartStreamOptions;
+class BoundedEnvelope;
 class Meter;
+class Mixer;
 
 struct SpeedChangeMessage {};
 
@@ -73,6 +76,29 @@ public:
       return mPlaySpeed.load( std::memory_order_relaxed ); }
    void SetPlaySpeed( double value );
 
+   //! How a playback mixer was made, beyond what Mixer::Reusable() examines
+   struct MixerKey {
+      double rate;
+      size_t bufferSize;
+      const BoundedEnvelope *envelope;
+      double minSpeed, maxSpeed;
+
+      bool operator ==(const MixerKey &other) const;
+   };
+   //! A playback mixer kept after its stream, for reuse by the next stream of
+   //! the project, rebound to the sequences it plays
+   struct WarmMixer {
+      MixerKey key;
+      std::unique_ptr<Mixer> pMixer;
+   };
+   using WarmMixers = std::vector<WarmMixer>;
+
+   WarmMixers TakeWarmMixers();
+   void SetWarmMixers(WarmMixers mixers);
+   //! Let go of the mixers and the sequences they hold, as when the project
+   //! closes
+   void ReleaseWarmMixers();
+
 private:
    AudacityProject &mProject;
 
@@ -85,6 +111,8 @@ private:
    std::atomic<double> mPlaySpeed{};
 
    int  mAudioIOToken{ -1 };
+
+   WarmMixers mWarmMixers;
 };
 
 #endif
@@ -0,0 +1,179 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file RecordingSpool.cpp
+
+**********************************************************************/
+
+#include "RecordingSpool.h"
+
+#include "AudacityException.h"
+
+#include <algorithm>
+
+namespace {
+
+bool Seek(FILE *file, long long offset)
+{
+#ifdef _WIN32
+   return _fseeki64(file, offset, SEEK_SET) == 0;
+#else
+   return fseeko(file, offset, SEEK_SET) == 0;
+#endif
+}
+
+[[noreturn]] void ThrowFileError()
+{
+   throw SimpleMessageBoxException{ ExceptionType::BadEnvironment,
+      XO("The temporary file of the recording could not be read."),
+      XO("Warning") };
+}
+
+}
+
+void RecordingSpool::FileCloser::operator()(FILE *file) const
+{
+   if (file)
+      fclose(file);
+}
+
+std::unique_ptr<RecordingSpool> RecordingSpool::Create(
+   RecordableSequences sequences, sampleFormat format, size_t nChannels,
+   NewBlocksCallback onNewBlocks)
+{
+   // Deleted when closed, even if the program ends abnormally
+   const auto file = std::tmpfile();
+   if (!file)
+      return {};
+   return std::make_unique<RecordingSpool>(file, move(sequences), format,
+      nChannels, move(onNewBlocks));
+}
+
+RecordingSpool::RecordingSpool(FILE *file, RecordableSequences sequences,
+   sampleFormat format, size_t nChannels, NewBlocksCallback onNewBlocks
+)  : mFile{ file }
+   , mSequences{ move(sequences) }
+   , mOnNewBlocks{ move(onNewBlocks) }
+   , mFormat{ format }
+   , mChannels{ nChannels }
+   , mFrameSize{ nChannels * SAMPLE_SIZE(format) }
+{
+   mThread = std::thread{ [this]{ Run(); } };
+}
+
+RecordingSpool::~RecordingSpool()
+{
+   GuardedCall([this]{ Finish(); });
+}
+
+bool RecordingSpool::Write(constSamplePtr frames, size_t nFrames)
+{
+   if (nFrames == 0)
+      return true;
+   {
+      std::lock_guard<std::mutex> lock{ mMutex };
+      // The worker moves the position when it reads
+      if (!Seek(mFile.get(), mWritten * mFrameSize) ||
+          fwrite(frames, mFrameSize, nFrames, mFile.get()) != nFrames)
+         return false;
+      mWritten += nFrames;
+   }
+   mCondition.notify_one();
+   return true;
+}
+
+bool RecordingSpool::WriteSilence(size_t nFrames)
+{
+   // All sample formats are silent when all bytes are zero
+   static const char zeroes[4096]{};
+   const auto framesPerWrite = std::max<size_t>(1, sizeof zeroes / mFrameSize);
+   SampleBuffer buffer;
+   constSamplePtr source = reinterpret_cast<constSamplePtr>(zeroes);
+   if (mFrameSize > sizeof zeroes) {
+      buffer.Allocate(mChannels, mFormat);
+      ClearSamples(buffer.ptr(), mFormat, 0, mChannels);
+      source = buffer.ptr();
+   }
+   while (nFrames > 0) {
+      const auto count = std::min(nFrames, framesPerWrite);
+      if (!Write(source, count))
+         return false;
+      nFrames -= count;
+   }
+   return true;
+}
+
+void RecordingSpool::RethrowException()
+{
+   if (!mFailed.load(std::memory_order_acquire))
+      return;
+   std::exception_ptr exception;
+   {
+      std::lock_guard<std::mutex> lock{ mMutex };
+      exception = mException;
+   }
+   if (exception)
+      std::rethrow_exception(exception);
+}
+
+void RecordingSpool::Finish()
+{
+   if (mThread.joinable()) {
+      {
+         std::lock_guard<std::mutex> lock{ mMutex };
+         mFinishing = true;
+      }
+      mCondition.notify_one();
+      mThread.join();
+   }
+   RethrowException();
+}
+
+void RecordingSpool::Run()
+{
+   try {
+      SampleBuffer buffer(ChunkFrames * mChannels, mFormat);
+      while (true) {
+         size_t frames = 0;
+         {
+            std::unique_lock<std::mutex> lock{ mMutex };
+            mCondition.wait(lock,
+               [this]{ return mRead < mWritten || mFinishing; });
+            if (mRead == mWritten)
+               return;
+            frames = std::min<long long>(ChunkFrames, mWritten - mRead);
+            if (!Seek(mFile.get(), mRead * mFrameSize) ||
+                fread(buffer.ptr(), mFrameSize, frames, mFile.get()) != frames)
+               ThrowFileError();
+            mRead += frames;
+         }
+         // Not holding the lock, so that the writer never waits on appends
+         if (AppendChunk(buffer.ptr(), frames) && mOnNewBlocks)
+            mOnNewBlocks();
+      }
+   }
+   catch (...) {
+      std::lock_guard<std::mutex> lock{ mMutex };
+      mException = std::current_exception();
+      mFailed.store(true, std::memory_order_release);
+   }
+}
+
+bool RecordingSpool::AppendChunk(constSamplePtr buffer, size_t frames)
+{
+   bool newBlocks = false;
+   size_t channel = 0;
+   const auto sampleSize = SAMPLE_SIZE(mFormat);
+   for (const auto &pSequence : mSequences) {
+      const auto width = pSequence->NChannels();
+      for (size_t iChannel = 0;
+         iChannel < width && channel < mChannels; ++iChannel, ++channel)
+         newBlocks = pSequence->Append(iChannel,
+            buffer + channel * sampleSize, mFormat, frames, mChannels,
+            // Do not dither recordings
+            narrowestSampleFormat
+         ) || newBlocks;
+   }
+   return newBlocks;
+}
@@ -0,0 +1,93 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file RecordingSpool.h
+  @brief Streams captured frames to a temporary file, and appends them to
+  the recording sequences on a worker thread
+
+**********************************************************************/
+
+#ifndef __AUDACITY_RECORDING_SPOOL__
+#define __AUDACITY_RECORDING_SPOOL__
+
+#include "AudioIOSequences.h"
+#include "SampleFormat.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+//! Decouples the thread that drains the capture buffer from the database
+/*!
+ The draining thread only writes interleaved frames sequentially to an
+ anonymous temporary file, which costs no more than a copy into the page
+ cache.  A worker reads them back in large chunks and appends them to the
+ sequences, so that a stall in committing sample blocks delays only the
+ worker, while the capture buffer keeps draining.
+ */
+class AUDIO_IO_API RecordingSpool final
+{
+public:
+   //! Called by the worker after appends that made new sample blocks
+   using NewBlocksCallback = std::function<void()>;
+
+   //! Frames appended to the sequences at once
+   static constexpr size_t ChunkFrames = 16384;
+
+   //! @return null if no temporary file can be made
+   /*!
+    @param sequences whose channels, in order, are the channels of frames
+    */
+   static std::unique_ptr<RecordingSpool> Create(
+      RecordableSequences sequences, sampleFormat format, size_t nChannels,
+      NewBlocksCallback onNewBlocks);
+
+   RecordingSpool(FILE *file, RecordableSequences sequences,
+      sampleFormat format, size_t nChannels, NewBlocksCallback onNewBlocks);
+   ~RecordingSpool();
+
+   //! Write interleaved frames, in the format and with all channels
+   /*! @return false if the file could not be written */
+   bool Write(constSamplePtr frames, size_t nFrames);
+   //! Write silent frames
+   /*! @return false if the file could not be written */
+   bool WriteSilence(size_t nFrames);
+
+   //! Rethrow the exception, if any, that stopped the worker
+   void RethrowException();
+
+   //! Wait until the worker has appended everything written, then stop it
+   /*! May rethrow an exception of appending */
+   void Finish();
+
+private:
+   struct FileCloser { void operator()(FILE *file) const; };
+
+   void Run();
+   //! @return whether new sample blocks were made
+   bool AppendChunk(constSamplePtr buffer, size_t frames);
+
+   const std::unique_ptr<FILE, FileCloser> mFile;
+   const RecordableSequences mSequences;
+   const NewBlocksCallback mOnNewBlocks;
+   const sampleFormat mFormat;
+   const size_t mChannels;
+   const size_t mFrameSize;
+
+   std::thread mThread;
+   std::mutex mMutex; //!< Guards the file and the fields below
+   std::condition_variable mCondition;
+   long long mWritten{ 0 }; //!< Frames
+   long long mRead{ 0 }; //!< Frames
+   bool mFinishing{ false };
+   std::exception_ptr mException;
+   std::atomic<bool> mFailed{ false };
+};
+
+#endif
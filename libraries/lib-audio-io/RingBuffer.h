@@ -19,6 +19,9 @@ class RingBuffer final : public NonInterferingBase {
    RingBuffer(sampleFormat format, size_t size);
    ~RingBuffer();
 
+   //! For either thread; a little more than may be filled
+   size_t Capacity() const { return mBufferSize; }
+
    //
    // For the writer only:
    //
@@ -0,0 +1,87 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  RingBufferTest.cpp
+
+**********************************************************************/
+#include <catch2/catch.hpp>
+
+#include "RingBuffer.h"
+#include "RealtimeArena.h"
+#include "RealtimeAllocationTrap.h"
+
+#include <memory>
+#include <vector>
+
+TEST_CASE("RingBuffer consumption in direct playback does not allocate")
+{
+   // As AudioIO sets up direct playback: the producer keeps one small batch
+   // beyond the hardware latency, and the callback takes its scratch memory
+   // from a reserved arena
+   constexpr size_t channels = 2;
+   constexpr size_t framesPerBuffer = 256;
+   constexpr size_t batch = 88;
+   constexpr size_t queueMinimum = framesPerBuffer + batch;
+
+   std::vector<std::unique_ptr<RingBuffer>> buffers;
+   for (size_t c = 0; c < channels; ++c)
+      buffers.push_back(
+         std::make_unique<RingBuffer>(floatSample, 4 * queueMinimum));
+
+   RealtimeArena arena;
+   arena.Reserve(2 * channels * framesPerBuffer * sizeof(float));
+
+   std::vector<float> source(batch);
+   float next = 0;
+   auto produce = [&]{
+      // The audio thread, outside any trap scope
+      while (buffers[0]->WrittenForGet() < queueMinimum) {
+         for (auto &sample : source)
+            sample = next++;
+         for (auto &pBuffer : buffers) {
+            pBuffer->Put(reinterpret_cast<constSamplePtr>(source.data()),
+               floatSample, batch);
+            pBuffer->Flush();
+         }
+      }
+   };
+
+   const auto trapped = RealtimeAllocationTrap::TrappedCount();
+   float expected = 0;
+   for (int pass = 0; pass < 100; ++pass) {
+      produce();
+
+      // The callback; assertions, which might allocate, wait until after
+      bool trapping = false;
+      size_t got[channels]{};
+      float first[channels]{}, last[channels]{};
+      {
+         RealtimeAllocationTrap::Scope scope;
+         trapping = RealtimeAllocationTrap::IsTrapping();
+         arena.Reset();
+         for (size_t c = 0; c < channels; ++c) {
+            const auto dest = arena.Allocate<float>(framesPerBuffer);
+            if (!dest)
+               break;
+            got[c] = buffers[c]->Get(reinterpret_cast<samplePtr>(dest),
+               floatSample, framesPerBuffer);
+            first[c] = dest[0];
+            last[c] = dest[framesPerBuffer - 1];
+         }
+      }
+      REQUIRE(trapping);
+      for (size_t c = 0; c < channels; ++c) {
+         REQUIRE(got[c] == framesPerBuffer);
+         REQUIRE(first[c] == expected);
+         REQUIRE(last[c] == expected + framesPerBuffer - 1);
+      }
+      expected += framesPerBuffer;
+   }
+   REQUIRE(arena.Failures() == 0);
+
+   // Counts only in builds with the replaced operator new
+   if (RealtimeAllocationTrap::IsEnabled())
+      REQUIRE(RealtimeAllocationTrap::TrappedCount() == trapped);
+}
@@ -20,6 +20,8 @@
 
 #include "crypto/SHA256.h"
 
+#include "concurrency/ThreadPool.h"
+
 namespace audacity::cloud::audiocom::sync
 {
 class BlockHasher::Workers final
@@ -30,7 +32,8 @@ public:
    explicit Workers(
       BlockHashCache& cache, const std::vector<LockedBlock> blocks,
       std::function<void()> onComplete)
-       : mThreadsCount { std::max(1u, std::thread::hardware_concurrency() / 2) }
+       : mThreadsCount { std::max<size_t>(
+            1, concurrency::ThreadPool::GetDefault().GetThreadsCount() / 2) }
        , mCache { cache }
        , mOnComplete { std::move(onComplete) }
    {
@@ -53,8 +56,8 @@ public:
          for (size_t j = startIndex; j < blocksCount; j += mThreadsCount)
             threadBlocks.emplace_back(blocks[j]);
 
-         mResults.emplace_back(std::async(
-            std::launch::async,
+         // Hashing may wait, so it should not delay work the user waits for
+         mResults.emplace_back(concurrency::ThreadPool::GetDefault().Async(
             [this, threadBlocks = std::move(threadBlocks)]()
             {
                Result result;
@@ -64,7 +67,8 @@ public:
                   result.emplace(block.Id, ComputeHash(sampleData, block));
 
                return result;
-            }));
+            },
+            concurrency::ThreadPool::Priority::Background));
       }
 
       mWaiter = std::async(
@@ -78,6 +82,13 @@ public:
          });
    }
 
+   ~Workers()
+   {
+      // The pool's futures do not wait in their destructors, as async's do
+      if (mWaiter.valid())
+         mWaiter.wait();
+   }
+
    bool IsReady() const
    {
       return std::all_of(
@@ -97,6 +108,11 @@ public:
       if (mCache.GetHash(block.Id, hash))
          return { hash, false };
 
+      // Perhaps it was computed when the block was made
+      hash = block.Block->GetContentHash();
+      if (!hash.empty())
+         return { hash, true };
+
       const auto sampleFormat = block.Format;
       const auto sampleCount  = block.Block->GetSampleCount();
       const auto dataSize     = sampleCount * SAMPLE_SIZE(sampleFormat);
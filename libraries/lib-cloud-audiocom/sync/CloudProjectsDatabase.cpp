@@ -301,6 +301,36 @@ std::optional<std::string> CloudProjectsDatabase::GetBlockHash(
    return {};
 }
 
+std::unordered_map<int64_t, std::string>
+CloudProjectsDatabase::GetBlockHashes(std::string_view projectId) const
+{
+   std::unordered_map<int64_t, std::string> hashes;
+
+   auto connection = GetConnection();
+
+   if (!connection)
+      return hashes;
+
+   auto statement = connection->CreateStatement(
+      "SELECT block_id, hash FROM block_hashes WHERE project_id = ?");
+
+   if (!statement)
+      return hashes;
+
+   auto result = statement->Prepare(projectId).Run();
+
+   for (auto row : result)
+   {
+      int64_t blockId {};
+      std::string hash;
+
+      if (row.Get(0, blockId) && row.Get(1, hash))
+         hashes.emplace(blockId, std::move(hash));
+   }
+
+   return hashes;
+}
+
 void CloudProjectsDatabase::UpdateBlockHashes(
    std::string_view projectId,
    const std::vector<std::pair<int64_t, std::string>>& hashes)
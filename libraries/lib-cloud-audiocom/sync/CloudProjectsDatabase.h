@@ -13,6 +13,7 @@
 #include <mutex>
 #include <optional>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "sqlite/SafeConnection.h"
@@ -103,6 +104,9 @@ public:
 
    std::optional<std::string>
    GetBlockHash(std::string_view projectId, int64_t blockId) const;
+   //! All hashes known for the project, in one query
+   std::unordered_map<int64_t, std::string>
+   GetBlockHashes(std::string_view projectId) const;
 
    void UpdateBlockHashes(
       std::string_view projectId,
@@ -72,7 +72,8 @@ struct DataUploader::UploadOperation final :
 
       if (std::holds_alternative<std::vector<uint8_t>>(Data))
       {
-         auto data = *std::get_if<std::vector<uint8_t>>(&Data);
+         // The payload copies the data, so that retries can resend it
+         const auto& data = *std::get_if<std::vector<uint8_t>>(&Data);
 
          NetworkResponse = NetworkManager::GetInstance().doPut(
             request, data.data(), data.size());
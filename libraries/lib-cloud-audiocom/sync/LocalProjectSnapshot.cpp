@@ -57,6 +57,10 @@ struct LocalProjectSnapshot::ProjectBlocksLock final : private BlockHashCache
    std::unordered_map<int64_t, size_t> BlockIdToIndex;
    std::unordered_map<std::string, size_t> BlockHashToIndex;
 
+   //! Hashes from earlier snapshots.  Block IDs are never reused within a
+   //! project, and blocks never change, so these stay valid
+   std::unordered_map<int64_t, std::string> CachedHashes;
+
    std::unique_ptr<BlockHasher> Hasher;
 
    std::future<void> UpdateCacheFuture;
@@ -76,6 +80,10 @@ struct LocalProjectSnapshot::ProjectBlocksLock final : private BlockHashCache
       {
          CloudProjectsDatabase::Get().UpdateProjectBlockList(
             Extension.GetCloudProjectId(), BlockIds);
+         // Read once, rather than once for each block from the hashing
+         // threads
+         CachedHashes = CloudProjectsDatabase::Get().GetBlockHashes(
+            Extension.GetCloudProjectId());
       }
 
       Hasher = std::make_unique<BlockHasher>();
@@ -148,16 +156,13 @@ struct LocalProjectSnapshot::ProjectBlocksLock final : private BlockHashCache
 
    bool GetHash(int64_t blockId, std::string& hash) const override
    {
-      if (!Extension.IsCloudProject())
-         return false;
-
-      auto cachedResult = CloudProjectsDatabase::Get().GetBlockHash(
-         Extension.GetCloudProjectId(), blockId);
+      // Only read while hashing, so no lock is needed
+      auto it = CachedHashes.find(blockId);
 
-      if (!cachedResult)
+      if (it == CachedHashes.end())
          return false;
 
-      hash = std::move(*cachedResult);
+      hash = it->second;
 
       return true;
    }
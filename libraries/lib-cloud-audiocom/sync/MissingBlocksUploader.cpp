@@ -11,6 +11,8 @@
 
 #include "MissingBlocksUploader.h"
 
+#include <algorithm>
+
 #include "DataUploader.h"
 
 #include "WavPackCompressor.h"
@@ -101,7 +103,7 @@ void MissingBlocksUploader::ConsumeBlock(ProducedItem item)
          lock,
          [this]
          {
-            return mConcurrentUploads < NUM_UPLOADERS ||
+            return mConcurrentUploads < mUploadsLimit ||
                    !mIsRunning.load(std::memory_order_consume);
          });
 
@@ -111,10 +113,12 @@ void MissingBlocksUploader::ConsumeBlock(ProducedItem item)
       ++mConcurrentUploads;
    }
 
+   const auto uploadedBytes = item.CompressedData.size();
+
    DataUploader::Get().Upload(
       mCancellationContext, mServiceConfig, item.Task.BlockUrls,
       std::move(item.CompressedData),
-      [this, task = item.Task,
+      [this, task = item.Task, uploadedBytes,
        weakThis = weak_from_this()](ResponseResult result)
       {
          auto lock = weakThis.lock();
@@ -125,7 +129,7 @@ void MissingBlocksUploader::ConsumeBlock(ProducedItem item)
          if (result.Code != SyncResultCode::Success)
             HandleFailedBlock(result, task);
          else
-            ConfirmBlock(task);
+            ConfirmBlock(task, uploadedBytes);
       });
 }
 
@@ -172,7 +176,8 @@ MissingBlocksUploader::ProducedItem MissingBlocksUploader::PopBlockFromQueue()
    return std::move(item);
 }
 
-void MissingBlocksUploader::ConfirmBlock(BlockUploadTask item)
+void MissingBlocksUploader::ConfirmBlock(
+   BlockUploadTask item, size_t uploadedBytes)
 {
    MissingBlocksUploadProgress progressData;
    {
@@ -186,10 +191,36 @@ void MissingBlocksUploader::ConfirmBlock(BlockUploadTask item)
    {
       std::lock_guard<std::mutex> lock(mUploadsMutex);
       --mConcurrentUploads;
+      UpdateUploadsLimit(uploadedBytes);
       mUploadsNotFull.notify_one();
    }
 }
 
+void MissingBlocksUploader::UpdateUploadsLimit(size_t uploadedBytes)
+{
+   mWindowBytes += uploadedBytes;
+
+   const auto now     = std::chrono::steady_clock::now();
+   const auto elapsed = std::chrono::duration<double>(now - mWindowStart);
+
+   if (elapsed < THROUGHPUT_WINDOW)
+      return;
+
+   const auto throughput = mWindowBytes / elapsed.count();
+
+   // Keep going the same way while it helps; turn back when it hurts,
+   // allowing for some noise in the measurement
+   if (throughput < mLastThroughput * 0.95)
+      mUploadsLimitStep = -mUploadsLimitStep;
+
+   mUploadsLimit = std::clamp<size_t>(
+      mUploadsLimit + mUploadsLimitStep, MIN_UPLOADERS, MAX_UPLOADERS);
+
+   mLastThroughput = throughput;
+   mWindowStart    = now;
+   mWindowBytes    = 0;
+}
+
 void MissingBlocksUploader::HandleFailedBlock(
    const ResponseResult& result, BlockUploadTask task)
 {
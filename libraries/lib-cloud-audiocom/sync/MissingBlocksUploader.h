@@ -12,6 +12,7 @@
 
 #include <array>
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <cstdint>
 #include <mutex>
@@ -70,9 +71,16 @@ class MissingBlocksUploader final :
 
 public:
    static constexpr auto NUM_PRODUCERS    = 3;
+   //! Concurrent uploads at the start; the limit then follows the measured
+   //! throughput, between MIN_UPLOADERS and MAX_UPLOADERS
    static constexpr auto NUM_UPLOADERS    = 6;
+   static constexpr auto MIN_UPLOADERS    = 2;
+   static constexpr auto MAX_UPLOADERS    = 16;
    static constexpr auto RING_BUFFER_SIZE = 16;
 
+   //! How long throughput is measured before the limit is adjusted
+   static constexpr auto THROUGHPUT_WINDOW = std::chrono::seconds(2);
+
    MissingBlocksUploader(Tag, const ServiceConfig& serviceConfig);
 
    static std::shared_ptr<MissingBlocksUploader> Create(
@@ -102,9 +110,13 @@ private:
    void PushBlockToQueue(ProducedItem item);
    ProducedItem PopBlockFromQueue();
 
-   void ConfirmBlock(BlockUploadTask task);
+   void ConfirmBlock(BlockUploadTask task, size_t uploadedBytes);
    void HandleFailedBlock(const ResponseResult& result, BlockUploadTask task);
 
+   //! Climb towards the number of concurrent uploads giving the best
+   //! throughput.  Called with mUploadsMutex locked
+   void UpdateUploadsLimit(size_t uploadedBytes);
+
    void ProducerThread();
    void ConsumerThread();
 
@@ -124,6 +136,13 @@ private:
    std::mutex mUploadsMutex;
    std::condition_variable mUploadsNotFull;
    size_t mConcurrentUploads { 0 };
+   size_t mUploadsLimit { NUM_UPLOADERS };
+   int mUploadsLimitStep { 1 };
+   std::chrono::steady_clock::time_point mWindowStart {
+      std::chrono::steady_clock::now()
+   };
+   size_t mWindowBytes { 0 };
+   double mLastThroughput { 0.0 };
 
    std::mutex mRingBufferMutex;
 
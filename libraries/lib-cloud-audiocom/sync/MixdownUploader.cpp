@@ -15,7 +15,10 @@
 
 #include "WaveTrack.h"
 
+#include "ClientData.h"
 #include "CodeConversions.h"
+#include "Project.h"
+#include "XMLWriter.h"
 
 #include "ServiceConfig.h"
 
@@ -79,6 +82,56 @@ bool HasPlayableTracks(const AudacityProject& project)
    return false;
 }
 
+//! What the mixdown depends on; the tracks are written as the project file
+//! writes them, which is more than the mix depends on, so that any change
+//! renders again
+std::string MakeMixdownKey(
+   const TrackList& trackList, double rate, int nChannels)
+{
+   XMLStringWriter writer;
+   for (const auto track : trackList)
+      track->WriteXML(writer);
+
+   return std::to_string(std::hash<std::wstring> {}(writer.ToStdWstring())) +
+          ":" + std::to_string(writer.length()) + ":" + std::to_string(rate) +
+          ":" + std::to_string(nChannels) + ":" +
+          std::to_string(trackList.GetEndTime());
+}
+
+//! The file of the last mixdown rendered for a project, kept while the
+//! project is open, to upload again while the project mixes the same
+struct LastMixdown final : ClientData::Base
+{
+   static LastMixdown& Get(const AudacityProject& project);
+
+   ~LastMixdown() override
+   {
+      Reset();
+   }
+
+   void Reset()
+   {
+      if (!Path.empty() && wxFileExists(Path))
+         wxRemoveFile(Path);
+
+      Path.clear();
+      Key.clear();
+   }
+
+   std::string Key;
+   std::string Path;
+};
+
+const AudacityProject::AttachedObjects::RegisteredFactory sLastMixdownKey {
+   [](AudacityProject&) { return std::make_shared<LastMixdown>(); }
+};
+
+LastMixdown& LastMixdown::Get(const AudacityProject& project)
+{
+   return const_cast<AudacityProject&>(project)
+      .AttachedObjects::Get<LastMixdown>(sLastMixdownKey);
+}
+
 } // namespace
 
 class MixdownUploader::DataExporter final : public ExportProcessorDelegate
@@ -112,7 +165,7 @@ public:
 
       if (result == ExportResult::Success)
       {
-         mParent.UploadMixdown();
+         mParent.OnExported();
       }
       else
       {
@@ -231,7 +284,7 @@ MixdownUploader::MixdownUploader(
 
 MixdownUploader::~MixdownUploader()
 {
-   if (wxFileExists(mExportedFilePath))
+   if (!mExportedFileKept && wxFileExists(mExportedFilePath))
       wxRemoveFile(mExportedFilePath);
 }
 
@@ -256,26 +309,30 @@ std::shared_ptr<MixdownUploader> MixdownUploader::Upload(
 
 void MixdownUploader::SetUrls(const UploadUrls& urls)
 {
-   auto lock = std::lock_guard { mUploadUrlsMutex };
+   {
+      auto lock = std::lock_guard { mUploadUrlsMutex };
 
-   assert(!mUploadUrls);
-   mUploadUrls = urls;
+      assert(!mUploadUrls);
+      mUploadUrls = urls;
+   }
 
-   mUploadUrlsSet.notify_one();
+   StartUploadIfReady();
 }
 
 void MixdownUploader::Cancel()
 {
-   if (!mDataExporter)
+   if (mFinished.load())
       return;
 
    if (mUploadCancelled.exchange(true, std::memory_order_acq_rel))
       return;
 
    // To be on a safe side, we cancel both operations
-   mDataExporter->Cancel();
+   if (mDataExporter)
+      mDataExporter->Cancel();
+
    // And ensure that WaitingForUrls is interrupted too
-   mUploadUrlsSet.notify_all();
+   StartUploadIfReady();
 }
 
 std::future<MixdownResult> MixdownUploader::GetResultFuture()
@@ -338,6 +395,19 @@ void MixdownUploader::ExportProject()
    const double t1 = tracks.GetEndTime();
 
    const int nChannels = CalculateChannels(tracks);
+   const double rate   = ProjectRate::Get(mProject).GetRate();
+
+   mMixdownKey = MakeMixdownKey(tracks, rate, nChannels);
+
+   if (auto& lastMixdown = LastMixdown::Get(mProject);
+       lastMixdown.Key == mMixdownKey && wxFileExists(lastMixdown.Path))
+   {
+      mExportedFilePath = lastMixdown.Path;
+      mExportedFileKept = true;
+      mExported         = true;
+      ReportProgress(MixdownState::Exporting, 1.0, {});
+      return;
+   }
 
    auto hasMimeType = [](const auto&& mimeTypes, const std::string& mimeType)
    {
@@ -378,7 +448,7 @@ void MixdownUploader::ExportProject()
       auto builder = ExportTaskBuilder {}
                         .SetParameters(parameters)
                         .SetNumChannels(nChannels)
-                        .SetSampleRate(ProjectRate::Get(mProject).GetRate())
+                        .SetSampleRate(rate)
                         .SetPlugin(plugin)
                         .SetFileName(audacity::ToWXString(path))
                         .SetRange(t0, t1, false);
@@ -398,22 +468,51 @@ void MixdownUploader::ExportProject()
    }
 }
 
-void MixdownUploader::UploadMixdown()
+void MixdownUploader::OnExported()
 {
-   ReportProgress(MixdownState::WaitingForUrls, 0.0, {});
+   // The project keeps the file now, replacing any earlier one
+   auto& lastMixdown = LastMixdown::Get(mProject);
+   lastMixdown.Reset();
+   lastMixdown.Key   = mMixdownKey;
+   lastMixdown.Path  = mExportedFilePath;
+   mExportedFileKept = true;
 
    {
-      auto lock = std::unique_lock { mUploadUrlsMutex };
-      mUploadUrlsSet.wait(
-         lock, [this] { return mUploadCancelled.load() || !!mUploadUrls; });
+      auto lock = std::lock_guard { mUploadUrlsMutex };
+      mExported = true;
    }
 
-   if (mUploadCancelled.load(std::memory_order_acquire))
+   ReportProgress(MixdownState::WaitingForUrls, 0.0, {});
+
+   StartUploadIfReady();
+}
+
+void MixdownUploader::StartUploadIfReady()
+{
+   bool cancelled = false;
+
    {
-      ReportProgress(MixdownState::Cancelled, 0.0, {});
-      return;
+      auto lock = std::lock_guard { mUploadUrlsMutex };
+
+      if (!mExported || mUploadResolved)
+         return;
+
+      cancelled = mUploadCancelled.load(std::memory_order_acquire);
+
+      if (!cancelled && !mUploadUrls)
+         return;
+
+      mUploadResolved = true;
    }
 
+   if (cancelled)
+      ReportProgress(MixdownState::Cancelled, 0.0, {});
+   else
+      UploadMixdown();
+}
+
+void MixdownUploader::UploadMixdown()
+{
    ReportProgress(MixdownState::Uploading, 0.0, {});
 
    DataUploader::Get().Upload(
@@ -12,7 +12,6 @@
 
 #include <atomic>
 #include <cstdint>
-#include <condition_variable>
 #include <functional>
 #include <future>
 #include <memory>
@@ -72,11 +71,18 @@ public:
 
    ~MixdownUploader();
 
+   //! Starts rendering at once, in another thread, or reuses the file
+   //! rendered for an earlier upload, if the project still mixes the same
+   /*!
+    The upload starts when both the file and the urls are ready, so the
+    rendering may overlap the creation of the snapshot that gives the urls
+    */
    static std::shared_ptr<MixdownUploader> Upload(
       concurrency::CancellationContextPtr cancellationContext,
       const ServiceConfig& config, const AudacityProject& project,
       MixdownProgressCallback progressCallback);
 
+   //! Does not block; call on the main thread
    void SetUrls(const UploadUrls& urls);
 
    std::future<MixdownResult> GetResultFuture();
@@ -87,14 +93,20 @@ private:
    void ReportProgress(
       MixdownState state, double progress, ResponseResult uploadResult);
    void ExportProject();
+   void OnExported();
+   void StartUploadIfReady();
    void UploadMixdown();
 
    const ServiceConfig& mServiceConfig;
    const AudacityProject& mProject;
 
    std::mutex mUploadUrlsMutex;
-   std::condition_variable mUploadUrlsSet;
    std::optional<UploadUrls> mUploadUrls;
+   //! Whether the file is ready
+   bool mExported { false };
+   //! Whether the upload started, or the cancellation was reported, while
+   //! exported
+   bool mUploadResolved { false };
 
    MixdownProgressCallback mProgressCallback;
 
@@ -102,6 +114,10 @@ private:
    std::unique_ptr<DataExporter> mDataExporter;
 
    std::string mExportedFilePath;
+   //! Identifies what was mixed, for reuse of the file
+   std::string mMixdownKey;
+   //! Whether the project keeps the file, after this is destroyed
+   bool mExportedFileKept { false };
 
    std::atomic<double> mProgress {};
 
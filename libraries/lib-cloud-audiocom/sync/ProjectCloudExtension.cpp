@@ -33,7 +33,9 @@
 
 #include "CloudProjectsDatabase.h"
 
+#include "SampleBlock.h"
 #include "Track.h"
+#include "WaveTrack.h"
 
 namespace audacity::cloud::audiocom::sync
 {
@@ -238,6 +240,8 @@ void ProjectCloudExtension::OnSnapshotCreated(
       mSnapshotId = response.Snapshot.Id;
    }
 
+   UpdateContentHashing(true);
+
    auto lock    = std::lock_guard { mUploadQueueMutex };
    auto element = UnsafeFindUploadQueueElement(uploadOperation);
 
@@ -487,6 +491,8 @@ void ProjectCloudExtension::UpdateIdFromDatabase()
       mSnapshotId = projectData->SnapshotId;
    }
 
+   UpdateContentHashing(true);
+
    Publish(
       {
          projectData->SyncStatus ==
@@ -497,6 +503,14 @@ void ProjectCloudExtension::UpdateIdFromDatabase()
       false);
 }
 
+void ProjectCloudExtension::UpdateContentHashing(bool isCloudProject)
+{
+   // New blocks of a cloud project hash their samples with the summaries, so
+   // that synchronization need not read them again
+   WaveTrackFactory::Get(mProject).GetSampleBlockFactory()
+      ->SetComputesContentHashes(isCloudProject);
+}
+
 void ProjectCloudExtension::UnsafeUpdateProgress()
 {
    if (mUploadQueue.empty())
@@ -604,6 +618,8 @@ void ProjectCloudExtension::OnProjectPathChanged()
       mSnapshotId.clear();
    }
 
+   UpdateContentHashing(false);
+
    // This will set the status to cloud if the project is a cloud project
    UpdateIdFromDatabase();
 
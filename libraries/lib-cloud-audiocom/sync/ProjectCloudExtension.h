@@ -124,6 +124,7 @@ private:
    struct CloudStatusChangedNotifier;
 
    void UpdateIdFromDatabase();
+   void UpdateContentHashing(bool isCloudProject);
 
    void UnsafeUpdateProgress();
    void Publish(CloudStatusChangedMessage cloudStatus, bool canMerge);
@@ -27,6 +27,8 @@
 
 #include "WavPackCompressor.h"
 
+#include "concurrency/ThreadPool.h"
+
 namespace audacity::cloud::audiocom::sync
 {
 namespace
@@ -152,6 +154,13 @@ RemoteProjectSnapshot::~RemoteProjectSnapshot()
       mResponsesEmptyCV.wait(lock, [this] { return mResponses.empty(); });
    }
 
+   {
+      auto lock = std::unique_lock { mWritesMutex };
+      mWritesCV.wait(
+         lock,
+         [this] { return mBlocksDecompressing == 0 && !mWriterRunning; });
+   }
+
    auto db = CloudProjectsDatabase::Get().GetConnection();
 
    for (const auto& dbName : ListAttachedDatabases())
@@ -379,7 +388,10 @@ void RemoteProjectSnapshot::DownloadBlob(
          mDownloadedBytes.fetch_add(
             response->getBytesAvailable(), std::memory_order_acq_rel);
 
-         RemoveResponse(response.get());
+         // Only after the success handler has handed the data on, so that
+         // the destructor waits for it
+         auto removeResponse =
+            finally([this, &response] { RemoveResponse(response.get()); });
 
          auto responseResult = GetResponseResult(*response, false);
 
@@ -511,37 +523,117 @@ void RemoteProjectSnapshot::OnProjectBlobDownloaded(
 void RemoteProjectSnapshot::OnBlockDownloaded(
    std::string blockHash, audacity::network_manager::ResponsePtr response)
 {
-   const auto compressedData = response->readAll<std::vector<uint8_t>>();
-   const auto blockData =
-      DecompressBlock(compressedData.data(), compressedData.size());
+   auto compressedData = response->readAll<std::vector<uint8_t>>();
+
+   mUnwrittenBlocks.fetch_add(1, std::memory_order_acq_rel);
+
+   {
+      auto lock = std::lock_guard { mWritesMutex };
+      ++mBlocksDecompressing;
+   }
+
+   concurrency::ThreadPool::GetDefault().Post(
+      [this, blockHash = std::move(blockHash),
+       compressedData = std::move(compressedData)]() mutable
+      {
+         DecompressDownloadedBlock(
+            std::move(blockHash), std::move(compressedData));
+      });
+}
+
+void RemoteProjectSnapshot::DecompressDownloadedBlock(
+   std::string blockHash, std::vector<uint8_t> compressedData)
+{
+   std::optional<DecompressedBlock> blockData;
+
+   if (InProgress())
+      blockData = DecompressBlock(compressedData.data(), compressedData.size());
+
+   const auto failed = InProgress() && !blockData;
+
+   bool startWriter = false;
+   {
+      auto lock = std::lock_guard { mWritesMutex };
 
-   if (!blockData)
+      if (blockData)
+      {
+         mBlocksToWrite.push_back(
+            { std::move(blockHash), std::move(*blockData) });
+         startWriter    = !mWriterRunning;
+         mWriterRunning = true;
+      }
+      else
+         mUnwrittenBlocks.fetch_sub(1, std::memory_order_acq_rel);
+
+      --mBlocksDecompressing;
+      mWritesCV.notify_all();
+   }
+
+   if (failed)
    {
       OnFailure(
          { SyncResultCode::InternalClientError,
            audacity::ToUTF8(XO("Failed to decompress the Cloud project block")
                                .Translation()) });
-      return;
    }
 
+   // A single writer, as there is a single connection to the database
+   if (startWriter)
+      WriteBlocks();
+}
+
+void RemoteProjectSnapshot::WriteBlocks()
+{
+   while (true)
+   {
+      std::vector<DownloadedBlock> blocks;
+      {
+         auto lock = std::lock_guard { mWritesMutex };
+
+         if (mBlocksToWrite.empty() || !InProgress())
+         {
+            mUnwrittenBlocks.fetch_sub(
+               mBlocksToWrite.size(), std::memory_order_acq_rel);
+            mBlocksToWrite.clear();
+            mWriterRunning = false;
+            mWritesCV.notify_all();
+            break;
+         }
+
+         blocks.swap(mBlocksToWrite);
+      }
+
+      if (InsertBlocks(blocks))
+      {
+         mDownloadedBlocks.fetch_add(blocks.size(), std::memory_order_acq_rel);
+         ReportProgress();
+      }
+
+      mUnwrittenBlocks.fetch_sub(blocks.size(), std::memory_order_acq_rel);
+
+      // Downloads may be waiting for the writes
+      auto lock = std::lock_guard { mRequestsMutex };
+      mRequestsCV.notify_one();
+   }
+}
+
+bool RemoteProjectSnapshot::InsertBlocks(
+   const std::vector<DownloadedBlock>& blocks)
+{
    auto db          = CloudProjectsDatabase::Get().GetConnection();
-   auto transaction = db->BeginTransaction("b_" + blockHash);
+   auto transaction = db->BeginTransaction("b_" + mProjectInfo.Id);
 
    auto hashesStatement = db->CreateStatement(
       "INSERT INTO block_hashes (project_id, block_id, hash) VALUES (?1, ?2, ?3) "
       "ON CONFLICT(project_id, block_id) DO UPDATE SET hash = ?3");
 
-   auto result =
-      hashesStatement->Prepare(mProjectInfo.Id, blockData->BlockId, blockHash)
-         .Run();
-
-   if (!result.IsOk())
+   if (!hashesStatement)
    {
       OnFailure(
          { SyncResultCode::InternalClientError,
            audacity::ToUTF8(
-              result.GetErrors().front().GetErrorString().Translation()) });
-      return;
+              hashesStatement.GetError().GetErrorString().Translation()) });
+      return false;
    }
 
    auto blockStatement = db->CreateStatement(
@@ -555,46 +647,60 @@ void RemoteProjectSnapshot::OnBlockDownloaded(
          { SyncResultCode::InternalClientError,
            audacity::ToUTF8(
               blockStatement.GetError().GetErrorString().Translation()) });
-      return;
+      return false;
    }
 
-   auto& preparedStatement = blockStatement->Prepare();
-
-   preparedStatement.Bind(1, blockData->BlockId);
-   preparedStatement.Bind(2, static_cast<int64_t>(blockData->Format));
-   preparedStatement.Bind(3, blockData->BlockMinMaxRMS.Min);
-   preparedStatement.Bind(4, blockData->BlockMinMaxRMS.Max);
-   preparedStatement.Bind(5, blockData->BlockMinMaxRMS.RMS);
-   preparedStatement.Bind(
-      6, blockData->Summary256.data(),
-      blockData->Summary256.size() * sizeof(MinMaxRMS), false);
-   preparedStatement.Bind(
-      7, blockData->Summary64k.data(),
-      blockData->Summary64k.size() * sizeof(MinMaxRMS), false);
-   preparedStatement.Bind(
-      8, blockData->Data.data(), blockData->Data.size(), false);
+   for (const auto& [blockHash, blockData] : blocks)
+   {
+      auto result =
+         hashesStatement->Prepare(mProjectInfo.Id, blockData.BlockId, blockHash)
+            .Run();
 
-   result = preparedStatement.Run();
+      if (!result.IsOk())
+      {
+         OnFailure(
+            { SyncResultCode::InternalClientError,
+              audacity::ToUTF8(
+                 result.GetErrors().front().GetErrorString().Translation()) });
+         return false;
+      }
 
-   if (!result.IsOk())
-   {
-      OnFailure(
-         { SyncResultCode::InternalClientError,
-           audacity::ToUTF8(
-              result.GetErrors().front().GetErrorString().Translation()) });
-      return;
+      auto& preparedStatement = blockStatement->Prepare();
+
+      preparedStatement.Bind(1, blockData.BlockId);
+      preparedStatement.Bind(2, static_cast<int64_t>(blockData.Format));
+      preparedStatement.Bind(3, blockData.BlockMinMaxRMS.Min);
+      preparedStatement.Bind(4, blockData.BlockMinMaxRMS.Max);
+      preparedStatement.Bind(5, blockData.BlockMinMaxRMS.RMS);
+      preparedStatement.Bind(
+         6, blockData.Summary256.data(),
+         blockData.Summary256.size() * sizeof(MinMaxRMS), false);
+      preparedStatement.Bind(
+         7, blockData.Summary64k.data(),
+         blockData.Summary64k.size() * sizeof(MinMaxRMS), false);
+      preparedStatement.Bind(
+         8, blockData.Data.data(), blockData.Data.size(), false);
+
+      result = preparedStatement.Run();
+
+      if (!result.IsOk())
+      {
+         OnFailure(
+            { SyncResultCode::InternalClientError,
+              audacity::ToUTF8(
+                 result.GetErrors().front().GetErrorString().Translation()) });
+         return false;
+      }
    }
 
    if (auto error = transaction.Commit(); error.IsError())
    {
       OnFailure({ SyncResultCode::InternalClientError,
                   audacity::ToUTF8(error.GetErrorString().Translation()) });
-      return;
+      return false;
    }
 
-   mDownloadedBlocks.fetch_add(1, std::memory_order_acq_rel);
-
-   ReportProgress();
+   return true;
 }
 
 void RemoteProjectSnapshot::OnFailure(ResponseResult result)
@@ -690,7 +796,9 @@ bool RemoteProjectSnapshot::InProgress() const
 
 void RemoteProjectSnapshot::RequestsThread()
 {
-   constexpr auto MAX_CONCURRENT_REQUESTS = 6;
+   constexpr auto MAX_CONCURRENT_REQUESTS = 12;
+   // Bounds the memory for blocks downloaded faster than they are written
+   constexpr int64_t MAX_UNWRITTEN_BLOCKS = 64;
 
    while (InProgress())
    {
@@ -699,15 +807,14 @@ void RemoteProjectSnapshot::RequestsThread()
       {
          auto lock = std::unique_lock { mRequestsMutex };
 
-         if (mRequestsInProgress >= MAX_CONCURRENT_REQUESTS)
-         {
-            mRequestsCV.wait(
-               lock,
-               [this, MAX_CONCURRENT_REQUESTS] {
-                  return mRequestsInProgress < MAX_CONCURRENT_REQUESTS ||
-                         !InProgress();
-               });
-         }
+         mRequestsCV.wait(
+            lock,
+            [this, MAX_CONCURRENT_REQUESTS, MAX_UNWRITTEN_BLOCKS] {
+               return (mRequestsInProgress < MAX_CONCURRENT_REQUESTS &&
+                       mUnwrittenBlocks.load(std::memory_order_acquire) <
+                          MAX_UNWRITTEN_BLOCKS) ||
+                      !InProgress();
+            });
 
          if (!InProgress())
             return;
@@ -722,7 +829,7 @@ void RemoteProjectSnapshot::RequestsThread()
       DownloadBlob(std::move(request.first), std::move(request.second), 3);
 
       // TODO: Random sleep to avoid overloading the server
-      std::this_thread::sleep_for(std::chrono::milliseconds(50));
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
    }
 }
 
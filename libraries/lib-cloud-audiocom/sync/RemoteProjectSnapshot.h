@@ -23,6 +23,7 @@
 
 #include "CloudSyncDTO.h"
 #include "NetworkUtils.h"
+#include "WavPackCompressor.h"
 
 namespace audacity::network_manager
 {
@@ -106,6 +107,20 @@ private:
    void OnBlockDownloaded(
       std::string blockHash, audacity::network_manager::ResponsePtr response);
 
+   struct DownloadedBlock final
+   {
+      std::string Hash;
+      DecompressedBlock Data;
+   };
+
+   //! Runs on the thread pool, so the network threads are free for the
+   //! next downloads
+   void DecompressDownloadedBlock(
+      std::string blockHash, std::vector<uint8_t> data);
+   //! Drains mBlocksToWrite, one transaction for all the blocks queued
+   void WriteBlocks();
+   bool InsertBlocks(const std::vector<DownloadedBlock>& blocks);
+
    void OnFailure(ResponseResult result);
    void RemoveResponse(audacity::network_manager::IResponse* response);
 
@@ -148,6 +163,15 @@ private:
       mResponses;
    std::condition_variable mResponsesEmptyCV;
 
+   std::mutex mWritesMutex;
+   std::condition_variable mWritesCV;
+   std::vector<DownloadedBlock> mBlocksToWrite;
+   int mBlocksDecompressing { 0 };
+   bool mWriterRunning { false };
+   //! Downloaded, but not in the database yet; downloads wait while there
+   //! are too many
+   std::atomic<int64_t> mUnwrittenBlocks { 0 };
+
    std::atomic<int64_t> mDownloadedBlocks { 0 };
    std::atomic<int64_t> mCopiedBlocks { 0 };
    std::atomic<int64_t> mDownloadedBytes { 0 };
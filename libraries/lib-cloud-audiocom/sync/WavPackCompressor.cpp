@@ -80,6 +80,10 @@ struct Exporter final
       const size_t samplesRead = Block.Block->GetSamples(
          sampleData.data(), Block.Format, 0, sampleCount, false);
 
+      // WriteBlock appends without reallocations, unless the samples do not
+      // compress at all
+      CompressedData.reserve(dataSize + 1024);
+
       if (sampleFormat == int16Sample)
       {
          constexpr size_t conversionSamplesCount = 1024;
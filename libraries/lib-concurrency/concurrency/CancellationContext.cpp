@@ -42,6 +42,11 @@ void CancellationContext::Cancel()
       });
 }
 
+bool CancellationContext::IsCancelled() const noexcept
+{
+   return mCancelled.load(std::memory_order_acquire);
+}
+
 void CancellationContext::OnCancelled(CancellableWPtr cancellable)
 {
    auto locked = cancellable.lock();
@@ -35,6 +35,7 @@ public:
    [[nodiscard]] static CancellationContextPtr Create();
 
    void Cancel();
+   bool IsCancelled() const noexcept;
 
    using CancellableWPtr = std::weak_ptr<ICancellable>;
    void OnCancelled(CancellableWPtr cancellable);
@@ -0,0 +1,200 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ * SPDX-FileName: ThreadPool.cpp
+ */
+
+#include "ThreadPool.h"
+#include "Tracing.h"
+
+#include <algorithm>
+#include <string>
+
+namespace audacity::concurrency
+{
+namespace
+{
+thread_local const ThreadPool* CurrentPool = nullptr;
+thread_local size_t CurrentWorker = 0;
+
+template<typename Queue>
+bool PopFront(Queue& queue, typename Queue::value_type& entry)
+{
+   if (queue.empty())
+      return false;
+   entry = std::move(queue.front());
+   queue.pop_front();
+   return true;
+}
+}
+
+ThreadPool::ThreadPool(size_t threadsCount)
+{
+   if (threadsCount == 0)
+      threadsCount = std::max(1u, std::thread::hardware_concurrency()) - 1;
+   threadsCount = std::max<size_t>(1, threadsCount);
+
+   mWorkers.reserve(threadsCount);
+   for (size_t i = 0; i < threadsCount; ++i)
+      mWorkers.push_back(std::make_unique<Worker>());
+
+   mThreads.reserve(threadsCount);
+   for (size_t i = 0; i < threadsCount; ++i)
+      mThreads.emplace_back([this, i] { Run(i); });
+}
+
+ThreadPool::~ThreadPool()
+{
+   {
+      std::lock_guard<std::mutex> lock { mMutex };
+      mStopping = true;
+   }
+   mCondition.notify_all();
+
+   for (auto& thread : mThreads)
+      thread.join();
+}
+
+ThreadPool& ThreadPool::GetDefault()
+{
+   static ThreadPool pool;
+   return pool;
+}
+
+size_t ThreadPool::GetThreadsCount() const noexcept
+{
+   return mThreads.size();
+}
+
+bool ThreadPool::IsWorkerThread() const noexcept
+{
+   return CurrentPool == this;
+}
+
+void ThreadPool::Post(Task task, Priority priority, CancellationContextPtr context)
+{
+   const auto index = static_cast<size_t>(priority);
+   Entry entry { std::move(task), std::move(context), Clock::now(),
+                 mWorkers.size() };
+   ++mCounters[index].posted;
+
+   if (IsWorkerThread())
+   {
+      // Count it first, so that no worker sleeps while it is queued
+      {
+         std::lock_guard<std::mutex> lock { mMutex };
+         ++mPending;
+      }
+      // Keep it near the data that the posting task has in cache, unless
+      // another worker is idle
+      entry.owner = CurrentWorker;
+      auto& worker = *mWorkers[CurrentWorker];
+      std::lock_guard<std::mutex> lock { worker.mutex };
+      worker.queues[index].push_back(std::move(entry));
+   }
+   else
+   {
+      std::lock_guard<std::mutex> lock { mMutex };
+      ++mPending;
+      mTasks[index].push_back(std::move(entry));
+   }
+   mCondition.notify_one();
+}
+
+auto ThreadPool::GetStatistics(Priority priority) const -> Statistics
+{
+   const auto& counters = mCounters[static_cast<size_t>(priority)];
+   return { counters.posted.load(), counters.completed.load(),
+            counters.cancelled.load(), counters.stolen.load(),
+            std::chrono::nanoseconds { counters.waiting.load() },
+            std::chrono::nanoseconds { counters.running.load() } };
+}
+
+bool ThreadPool::Take(size_t index, Entry& entry, size_t& priority)
+{
+   const auto count = mWorkers.size();
+   for (priority = 0; priority < PrioritiesCount; ++priority)
+   {
+      {
+         auto& own = *mWorkers[index];
+         std::lock_guard<std::mutex> lock { own.mutex };
+         if (PopFront(own.queues[priority], entry))
+            return true;
+      }
+      {
+         std::lock_guard<std::mutex> lock { mMutex };
+         if (PopFront(mTasks[priority], entry))
+            return true;
+      }
+      // Steal the newest, which the owner would reach last
+      for (size_t i = 1; i < count; ++i)
+      {
+         auto& other = *mWorkers[(index + i) % count];
+         std::lock_guard<std::mutex> lock { other.mutex };
+         auto& queue = other.queues[priority];
+         if (!queue.empty())
+         {
+            entry = std::move(queue.back());
+            queue.pop_back();
+            return true;
+         }
+      }
+   }
+   return false;
+}
+
+void ThreadPool::Execute(size_t index, Entry& entry, size_t priority)
+{
+   auto& counters = mCounters[priority];
+   if (entry.context && entry.context->IsCancelled())
+   {
+      ++counters.cancelled;
+      return;
+   }
+
+   if (entry.owner < mWorkers.size() && entry.owner != index)
+      ++counters.stolen;
+
+   const auto start = Clock::now();
+   counters.waiting += (start - entry.posted).count();
+   try
+   {
+      TRACE_SCOPE("Task");
+      entry.task();
+   }
+   catch (...)
+   {
+   }
+   counters.running += (Clock::now() - start).count();
+   ++counters.completed;
+}
+
+void ThreadPool::Run(size_t index)
+{
+   CurrentPool = this;
+   CurrentWorker = index;
+   Tracing::RegisterThread("Worker " + std::to_string(index + 1));
+
+   while (true)
+   {
+      Entry entry;
+      size_t priority;
+      if (Take(index, entry, priority))
+      {
+         {
+            std::lock_guard<std::mutex> lock { mMutex };
+            --mPending;
+         }
+         Execute(index, entry, priority);
+         // Destroy the task and its captures before waiting again
+         entry = {};
+         continue;
+      }
+
+      std::unique_lock<std::mutex> lock { mMutex };
+      mCondition.wait(lock, [this] { return mStopping || mPending > 0; });
+
+      if (mPending == 0)
+         return;
+   }
+}
+} // namespace audacity::concurrency
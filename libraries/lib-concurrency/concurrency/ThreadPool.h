@@ -0,0 +1,212 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ * SPDX-FileName: ThreadPool.h
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "CancellationContext.h"
+
+namespace audacity::concurrency
+{
+//! A fixed set of worker threads executing queued tasks
+/*!
+ Tasks of higher priority start first; those of equal priority start in
+ FIFO order, except that a task posted from a worker goes to that worker's
+ own queue, from which idle workers steal.  So a pool can be shared by all
+ subsystems of the process, without oversubscribing the cores.
+ */
+class CONCURRENCY_API ThreadPool final
+{
+public:
+   using Task = std::function<void()>;
+
+   enum class Priority
+   {
+      //! Work that something near to real time waits for, such as rendering
+      //! ahead for playback
+      Realtime,
+      //! Work that the user waits for
+      Interactive,
+      //! Work that may wait, such as hashing for synchronization
+      Background,
+   };
+   static constexpr size_t PrioritiesCount = 3;
+
+   //! Counts for the tasks of one priority, since the pool was made
+   struct Statistics
+   {
+      size_t posted {};
+      size_t completed {};
+      //! Not run, because their cancellation context was cancelled first
+      size_t cancelled {};
+      //! Run by a worker other than the one that posted them
+      size_t stolen {};
+      //! Total time from posting to starting
+      std::chrono::nanoseconds waiting {};
+      //! Total time running
+      std::chrono::nanoseconds running {};
+   };
+
+   //! @param threadsCount zero means one less than the hardware concurrency,
+   //! but at least one
+   explicit ThreadPool(size_t threadsCount = 0);
+
+   //! Finishes all queued tasks, then joins the threads
+   ~ThreadPool();
+
+   ThreadPool(const ThreadPool&)            = delete;
+   ThreadPool& operator=(const ThreadPool&) = delete;
+
+   //! A pool shared by the whole application, created on first use
+   static ThreadPool& GetDefault();
+
+   size_t GetThreadsCount() const noexcept;
+
+   //! Whether the calling thread is one of this pool's workers
+   /*! Work that would wait for other tasks of the pool should then be done
+    inline, to avoid deadlock */
+   bool IsWorkerThread() const noexcept;
+
+   //! Enqueue a task; exceptions escaping it are ignored
+   /*!
+    @param context if not null and cancelled before the task starts, the task
+    is destroyed without running
+    */
+   void Post(Task task, Priority priority = Priority::Interactive,
+      CancellationContextPtr context = {});
+
+   //! Enqueue a callable; the future receives its result or exception
+   /*!
+    If the context is cancelled before the callable starts, the future
+    receives a std::future_error, for a broken promise
+    */
+   template<typename F>
+   auto Async(F&& f, Priority priority = Priority::Interactive,
+      CancellationContextPtr context = {})
+      -> std::future<std::invoke_result_t<std::decay_t<F>>>
+   {
+      using Result = std::invoke_result_t<std::decay_t<F>>;
+      // std::function requires copyability, so share the packaged task
+      auto pTask = std::make_shared<std::packaged_task<Result()>>(
+         std::forward<F>(f));
+      auto future = pTask->get_future();
+      Post([pTask] { (*pTask)(); }, priority, std::move(context));
+      return future;
+   }
+
+   //! Call f(i) for each i in [0, n), concurrently, returning when all are done
+   /*!
+    Calls for indices from 1 are posted, and index 0 runs in this thread.  From
+    a worker thread, all run here in order instead, because waiting for other
+    tasks of the pool from within it could deadlock.
+
+    Exceptions are rethrown only after all calls finish; that of the least
+    index wins.  So f may refer to locals of the caller.
+    */
+   template<typename F>
+   void ParallelFor(size_t n, F&& f, Priority priority = Priority::Interactive)
+   {
+      if (n < 2 || IsWorkerThread())
+      {
+         for (size_t i = 0; i < n; ++i)
+            f(i);
+         return;
+      }
+
+      std::vector<std::future<void>> futures;
+      futures.reserve(n - 1);
+      std::exception_ptr pException;
+      try
+      {
+         for (size_t i = 1; i < n; ++i)
+            futures.push_back(Async([&f, i] { f(i); }, priority));
+         f(0);
+      }
+      catch (...)
+      {
+         pException = std::current_exception();
+      }
+      for (auto& future : futures)
+      {
+         try
+         {
+            future.get();
+         }
+         catch (...)
+         {
+            if (!pException)
+               pException = std::current_exception();
+         }
+      }
+      if (pException)
+         std::rethrow_exception(pException);
+   }
+
+   Statistics GetStatistics(Priority priority) const;
+
+private:
+   using Clock = std::chrono::steady_clock;
+
+   struct Entry
+   {
+      Task task;
+      CancellationContextPtr context;
+      Clock::time_point posted;
+      //! Index of the posting worker, or the count of workers if none
+      size_t owner {};
+   };
+   using Queues = std::array<std::deque<Entry>, PrioritiesCount>;
+
+   //! Tasks posted by one worker, which others may steal
+   struct Worker
+   {
+      std::mutex mutex;
+      Queues queues;
+   };
+
+   struct Counters
+   {
+      std::atomic<size_t> posted {};
+      std::atomic<size_t> completed {};
+      std::atomic<size_t> cancelled {};
+      std::atomic<size_t> stolen {};
+      std::atomic<long long> waiting {};
+      std::atomic<long long> running {};
+   };
+
+   void Run(size_t index);
+   //! Take the task of highest priority from the worker's own queue, or
+   //! from the shared queue, or from another worker
+   bool Take(size_t index, Entry& entry, size_t& priority);
+   void Execute(size_t index, Entry& entry, size_t priority);
+
+   std::vector<std::unique_ptr<Worker>> mWorkers;
+   std::vector<std::thread> mThreads;
+
+   //! Guards the fields below
+   std::mutex mMutex;
+   std::condition_variable mCondition;
+   //! Tasks posted from outside the pool
+   Queues mTasks;
+   //! Tasks in any queue
+   size_t mPending { 0 };
+   bool mStopping { false };
+
+   std::array<Counters, PrioritiesCount> mCounters;
+}; // class ThreadPool
+} // namespace audacity::concurrency
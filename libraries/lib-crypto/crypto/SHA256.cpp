@@ -8,9 +8,43 @@
 
 #include "SHA256.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cstring>
 
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#  if defined(__GNUC__) || defined(__clang__)
+#     define SHA256_SHANI
+#     define SHANI_TARGET __attribute__((target("sha,sse4.1")))
+#     include <cpuid.h>
+#     include <immintrin.h>
+#  elif defined(_MSC_VER)
+#     define SHA256_SHANI
+#     define SHANI_TARGET
+#     include <immintrin.h>
+#     include <intrin.h>
+#  endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#  include <arm_neon.h>
+#  if defined(__ARM_FEATURE_SHA2) || defined(__ARM_FEATURE_CRYPTO) || \
+      defined(_M_ARM64)
+#     define SHA256_ARMV8
+#     define ARMV8_TARGET
+#  elif defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 10
+#     define SHA256_ARMV8
+#     define ARMV8_TARGET __attribute__((target("+crypto")))
+#  endif
+#  if defined(SHA256_ARMV8)
+#     if defined(__linux__)
+#        include <sys/auxv.h>
+#        include <asm/hwcap.h>
+#     elif defined(_WIN32)
+#        include <windows.h>
+#     endif
+#  endif
+#endif
+
 namespace crypto
 {
 
@@ -88,8 +122,359 @@ void sha256_transform(uint32_t state[8], const uint8_t data[64])
    state[7] += h;
 }
 
+void ScalarBlocks(uint32_t state[8], const uint8_t* data, std::size_t blocks)
+{
+   for (; blocks > 0; --blocks, data += SHA256::BLOCK_SIZE)
+      sha256_transform(state, data);
+}
+
+void ScalarBlocks2(
+   uint32_t stateA[8], const uint8_t* dataA, uint32_t stateB[8],
+   const uint8_t* dataB, std::size_t blocks)
+{
+   ScalarBlocks(stateA, dataA, blocks);
+   ScalarBlocks(stateB, dataB, blocks);
+}
+
+//////////////////////////////////////////////////////////////////////////
+#ifdef SHA256_SHANI
+
+//! Compress the same number of blocks of N messages, interleaved
+template<std::size_t N>
+SHANI_TARGET void SHANIBlocks(
+   uint32_t* const states[N], const uint8_t* const data[N], std::size_t blocks)
+{
+   const auto mask =
+      _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+   // The instructions want the state as ABEF and CDGH
+   __m128i abef[N], cdgh[N];
+   for (std::size_t n = 0; n < N; ++n)
+   {
+      const auto cdab = _mm_shuffle_epi32(
+         _mm_loadu_si128(reinterpret_cast<const __m128i*>(states[n])), 0xB1);
+      const auto efgh = _mm_shuffle_epi32(
+         _mm_loadu_si128(reinterpret_cast<const __m128i*>(states[n] + 4)),
+         0x1B);
+      abef[n] = _mm_alignr_epi8(cdab, efgh, 8);
+      cdgh[n] = _mm_blend_epi16(efgh, cdab, 0xF0);
+   }
+
+   for (std::size_t block = 0; block < blocks; ++block)
+   {
+      __m128i w[N][4], savedAbef[N], savedCdgh[N];
+      for (std::size_t n = 0; n < N; ++n)
+      {
+         savedAbef[n] = abef[n];
+         savedCdgh[n] = cdgh[n];
+         const auto p = data[n] + block * SHA256::BLOCK_SIZE;
+         for (int i = 0; i < 4; ++i)
+            w[n][i] = _mm_shuffle_epi8(
+               _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16 * i)),
+               mask);
+      }
+
+      // Sixteen groups of four rounds; from the fifth on, each group first
+      // extends the schedule into the words of the group four before
+      for (int g = 0; g < 16; ++g)
+      {
+         const auto k =
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(K + 4 * g));
+         for (std::size_t n = 0; n < N; ++n)
+         {
+            auto& x = w[n][g & 3];
+            if (g >= 4)
+            {
+               x = _mm_sha256msg1_epu32(x, w[n][(g + 1) & 3]);
+               x = _mm_add_epi32(
+                  x, _mm_alignr_epi8(w[n][(g + 3) & 3], w[n][(g + 2) & 3], 4));
+               x = _mm_sha256msg2_epu32(x, w[n][(g + 3) & 3]);
+            }
+            const auto msg = _mm_add_epi32(x, k);
+            cdgh[n] = _mm_sha256rnds2_epu32(cdgh[n], abef[n], msg);
+            abef[n] = _mm_sha256rnds2_epu32(
+               abef[n], cdgh[n], _mm_shuffle_epi32(msg, 0x0E));
+         }
+      }
+
+      for (std::size_t n = 0; n < N; ++n)
+      {
+         abef[n] = _mm_add_epi32(abef[n], savedAbef[n]);
+         cdgh[n] = _mm_add_epi32(cdgh[n], savedCdgh[n]);
+      }
+   }
+
+   for (std::size_t n = 0; n < N; ++n)
+   {
+      const auto feba = _mm_shuffle_epi32(abef[n], 0x1B);
+      const auto dchg = _mm_shuffle_epi32(cdgh[n], 0xB1);
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(states[n]),
+         _mm_blend_epi16(feba, dchg, 0xF0));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(states[n] + 4),
+         _mm_alignr_epi8(dchg, feba, 8));
+   }
+}
+
+void SHANIBlocks1(uint32_t state[8], const uint8_t* data, std::size_t blocks)
+{
+   uint32_t* const states[] { state };
+   const uint8_t* const datas[] { data };
+   SHANIBlocks<1>(states, datas, blocks);
+}
+
+void SHANIBlocks2(
+   uint32_t stateA[8], const uint8_t* dataA, uint32_t stateB[8],
+   const uint8_t* dataB, std::size_t blocks)
+{
+   uint32_t* const states[] { stateA, stateB };
+   const uint8_t* const datas[] { dataA, dataB };
+   SHANIBlocks<2>(states, datas, blocks);
+}
+
+bool HasSHANI()
+{
+   // SSE4.1 in leaf 1, and SHA in leaf 7
+#if defined(_MSC_VER) && !defined(__clang__)
+   int info[4];
+   __cpuid(info, 0);
+   if (info[0] < 7)
+      return false;
+   __cpuid(info, 1);
+   if ((info[2] & (1 << 19)) == 0)
+      return false;
+   __cpuidex(info, 7, 0);
+   return (info[1] & (1 << 29)) != 0;
+#else
+   unsigned a, b, c, d;
+   if (!__get_cpuid(1, &a, &b, &c, &d) || (c & (1u << 19)) == 0)
+      return false;
+   return __get_cpuid_count(7, 0, &a, &b, &c, &d) && (b & (1u << 29)) != 0;
+#endif
+}
+
+#endif
+
+//////////////////////////////////////////////////////////////////////////
+#ifdef SHA256_ARMV8
+
+//! Compress the same number of blocks of N messages, interleaved
+template<std::size_t N>
+ARMV8_TARGET void ARMv8Blocks(
+   uint32_t* const states[N], const uint8_t* const data[N], std::size_t blocks)
+{
+   uint32x4_t abcd[N], efgh[N];
+   for (std::size_t n = 0; n < N; ++n)
+   {
+      abcd[n] = vld1q_u32(states[n]);
+      efgh[n] = vld1q_u32(states[n] + 4);
+   }
+
+   for (std::size_t block = 0; block < blocks; ++block)
+   {
+      uint32x4_t w[N][4], savedAbcd[N], savedEfgh[N];
+      for (std::size_t n = 0; n < N; ++n)
+      {
+         savedAbcd[n] = abcd[n];
+         savedEfgh[n] = efgh[n];
+         const auto p = data[n] + block * SHA256::BLOCK_SIZE;
+         for (int i = 0; i < 4; ++i)
+            w[n][i] = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(p + 16 * i)));
+      }
+
+      // Sixteen groups of four rounds; from the fifth on, each group first
+      // extends the schedule into the words of the group four before
+      for (int g = 0; g < 16; ++g)
+      {
+         const auto k = vld1q_u32(K + 4 * g);
+         for (std::size_t n = 0; n < N; ++n)
+         {
+            auto& x = w[n][g & 3];
+            if (g >= 4)
+               x = vsha256su1q_u32(
+                  vsha256su0q_u32(x, w[n][(g + 1) & 3]), w[n][(g + 2) & 3],
+                  w[n][(g + 3) & 3]);
+            const auto msg = vaddq_u32(x, k);
+            const auto previous = abcd[n];
+            abcd[n] = vsha256hq_u32(abcd[n], efgh[n], msg);
+            efgh[n] = vsha256h2q_u32(efgh[n], previous, msg);
+         }
+      }
+
+      for (std::size_t n = 0; n < N; ++n)
+      {
+         abcd[n] = vaddq_u32(abcd[n], savedAbcd[n]);
+         efgh[n] = vaddq_u32(efgh[n], savedEfgh[n]);
+      }
+   }
+
+   for (std::size_t n = 0; n < N; ++n)
+   {
+      vst1q_u32(states[n], abcd[n]);
+      vst1q_u32(states[n] + 4, efgh[n]);
+   }
+}
+
+void ARMv8Blocks1(uint32_t state[8], const uint8_t* data, std::size_t blocks)
+{
+   uint32_t* const states[] { state };
+   const uint8_t* const datas[] { data };
+   ARMv8Blocks<1>(states, datas, blocks);
+}
+
+void ARMv8Blocks2(
+   uint32_t stateA[8], const uint8_t* dataA, uint32_t stateB[8],
+   const uint8_t* dataB, std::size_t blocks)
+{
+   uint32_t* const states[] { stateA, stateB };
+   const uint8_t* const datas[] { dataA, dataB };
+   ARMv8Blocks<2>(states, datas, blocks);
+}
+
+bool HasARMv8()
+{
+#if defined(__APPLE__)
+   // All Apple processors of this architecture have it
+   return true;
+#elif defined(__linux__)
+   return (getauxval(AT_HWCAP) & HWCAP_SHA2) != 0;
+#elif defined(_WIN32)
+   return IsProcessorFeaturePresent(PF_ARM_V8_CRYPTO_INSTRUCTIONS_AVAILABLE);
+#else
+   return false;
+#endif
+}
+
+#endif
+
+//////////////////////////////////////////////////////////////////////////
+// Dispatch
+
+struct Kernels final
+{
+   SHA256::Implementation implementation;
+   void (*blocks)(uint32_t state[8], const uint8_t* data, std::size_t blocks);
+   //! Two messages at once; as fast as one would be, where the rounds are
+   //! bound by latency
+   void (*blocks2)(
+      uint32_t stateA[8], const uint8_t* dataA, uint32_t stateB[8],
+      const uint8_t* dataB, std::size_t blocks);
+};
+
+const Kernels ScalarKernels { SHA256::Implementation::Scalar, ScalarBlocks,
+                              ScalarBlocks2 };
+
+#ifdef SHA256_SHANI
+const Kernels SHANIKernels { SHA256::Implementation::SHANI, SHANIBlocks1,
+                             SHANIBlocks2 };
+#endif
+
+#ifdef SHA256_ARMV8
+const Kernels ARMv8Kernels { SHA256::Implementation::ARMv8, ARMv8Blocks1,
+                             ARMv8Blocks2 };
+#endif
+
+const Kernels* FindKernels(SHA256::Implementation implementation)
+{
+   switch (implementation)
+   {
+#ifdef SHA256_SHANI
+   case SHA256::Implementation::SHANI:
+      return HasSHANI() ? &SHANIKernels : &ScalarKernels;
+#endif
+#ifdef SHA256_ARMV8
+   case SHA256::Implementation::ARMv8:
+      return HasARMv8() ? &ARMv8Kernels : &ScalarKernels;
+#endif
+   default:
+      return &ScalarKernels;
+   }
+}
+
+std::atomic<const Kernels*>& Active()
+{
+   static std::atomic<const Kernels*> kernels { FindKernels(
+      SHA256::DetectedImplementation()) };
+   return kernels;
+}
+
+const Kernels& Get()
+{
+   return *Active().load(std::memory_order_relaxed);
+}
+
 } // namespace
 
+SHA256::Implementation SHA256::DetectedImplementation()
+{
+#if defined(SHA256_SHANI)
+   if (HasSHANI())
+      return Implementation::SHANI;
+#elif defined(SHA256_ARMV8)
+   if (HasARMv8())
+      return Implementation::ARMv8;
+#endif
+   return Implementation::Scalar;
+}
+
+SHA256::Implementation SHA256::ActiveImplementation()
+{
+   return Get().implementation;
+}
+
+void SHA256::SetImplementation(Implementation implementation)
+{
+   Active().store(FindKernels(implementation), std::memory_order_relaxed);
+}
+
+const char* SHA256::ImplementationName(Implementation implementation)
+{
+   switch (implementation)
+   {
+   case Implementation::SHANI:
+      return "SHA-NI";
+   case Implementation::ARMv8:
+      return "ARMv8";
+   default:
+      return "scalar";
+   }
+}
+
+std::vector<std::string> SHA256::HashMany(
+   const std::vector<std::pair<const void*, std::size_t>>& messages)
+{
+   std::vector<std::string> results;
+   results.reserve(messages.size());
+
+   const auto& kernels = Get();
+   SHA256 first, second;
+   std::size_t i = 0;
+   for (; i + 1 < messages.size(); i += 2)
+   {
+      const auto dataA = static_cast<const uint8_t*>(messages[i].first);
+      const auto dataB = static_cast<const uint8_t*>(messages[i + 1].first);
+      const auto sizeA = messages[i].second;
+      const auto sizeB = messages[i + 1].second;
+
+      // Compress the blocks that both have together, then the rest alone
+      const auto blocks = std::min(sizeA, sizeB) / BLOCK_SIZE;
+      const auto bytes = blocks * BLOCK_SIZE;
+      kernels.blocks2(first.mState, dataA, second.mState, dataB, blocks);
+      first.mBitLength = second.mBitLength = uint64_t(bytes) * 8;
+
+      first.Update(dataA + bytes, sizeA - bytes);
+      results.push_back(first.Finalize());
+      second.Update(dataB + bytes, sizeB - bytes);
+      results.push_back(second.Finalize());
+   }
+   for (; i < messages.size(); ++i)
+   {
+      first.Update(messages[i].first, messages[i].second);
+      results.push_back(first.Finalize());
+   }
+
+   return results;
+}
+
 SHA256::SHA256()
 {
    Reset();
@@ -101,6 +486,18 @@ void SHA256::Update(const void* data, std::size_t size)
 
    while (size > 0)
    {
+      if (mBufferLength == 0 && size >= SHA256::BLOCK_SIZE)
+      {
+         // Whole blocks need no copy into the buffer
+         const auto blocks = size / SHA256::BLOCK_SIZE;
+         const auto bytes = blocks * SHA256::BLOCK_SIZE;
+         Get().blocks(mState, dataPtr, blocks);
+         mBitLength += uint64_t(bytes) * 8;
+         dataPtr += bytes;
+         size -= bytes;
+         continue;
+      }
+
       std::size_t blockSize =
          std::min<size_t>(size, SHA256::BLOCK_SIZE - mBufferLength);
 
@@ -112,7 +509,7 @@ void SHA256::Update(const void* data, std::size_t size)
 
       if (mBufferLength == SHA256::BLOCK_SIZE)
       {
-         sha256_transform(mState, mBuffer);
+         Get().blocks(mState, mBuffer, 1);
          mBitLength += 512;
          mBufferLength = 0;
       }
@@ -145,7 +542,7 @@ std::string SHA256::Finalize()
       mBuffer[mBufferLength++] = 0x80;
       std::memset(
          mBuffer + mBufferLength, 0, SHA256::BLOCK_SIZE - mBufferLength);
-      sha256_transform(mState, mBuffer);
+      Get().blocks(mState, mBuffer, 1);
       std::memset(mBuffer, 0, 56);
    }
 
@@ -159,7 +556,7 @@ std::string SHA256::Finalize()
    mBuffer[62] = (mBitLength >> 8) & 0xff;
    mBuffer[63] = (mBitLength >> 0) & 0xff;
 
-   sha256_transform(mState, mBuffer);
+   Get().blocks(mState, mBuffer, 1);
 
    uint8_t result[SHA256::HASH_SIZE];
 
@@ -10,6 +10,8 @@
 #include <cstddef>
 
 #include <string>
+#include <utility>
+#include <vector>
 
 namespace crypto
 {
@@ -19,6 +21,31 @@ public:
    static constexpr std::size_t HASH_SIZE = 32;
    static constexpr std::size_t BLOCK_SIZE = 64;
 
+   //! Instruction sets for the compression of blocks, chosen at run time
+   enum class Implementation
+   {
+      Scalar,
+      SHANI,
+      ARMv8,
+   };
+
+   //! The best implementation that both this build and this processor
+   //! support
+   static Implementation DetectedImplementation();
+   //! The implementation now in use
+   static Implementation ActiveImplementation();
+   //! Choose the implementation, as for testing; one that is not supported
+   //! selects the scalar one
+   static void SetImplementation(Implementation implementation);
+   static const char* ImplementationName(Implementation implementation);
+
+   //! Hash several messages, compressing two at once, which is faster where
+   //! the rounds of the SHA instructions are bound by latency
+   /*! @return the hashes, in the order of the messages, as Finalize()
+    returns them */
+   static std::vector<std::string>
+   HashMany(const std::vector<std::pair<const void*, std::size_t>>& messages);
+
    SHA256();
 
    SHA256(const SHA256&) = delete;
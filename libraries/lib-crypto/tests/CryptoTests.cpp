@@ -8,6 +8,10 @@
 
 #include "crypto/SHA256.h"
 
+#include <algorithm>
+#include <string>
+#include <vector>
+
 TEST_CASE("SHA256", "")
 {
    crypto::SHA256 sha256;
@@ -35,3 +39,50 @@ TEST_CASE("SHA256", "")
          " is a free, open source, cross-platform audio software for multi-track recording and editing.") ==
          "00E7C81A5357B1734035CE4CAE5DC0B3F886D22C8AF2E3952E2F5569A994B8A8");
 }
+
+TEST_CASE("SHA256 implementations", "")
+{
+   // Lengths around the block size and the padding boundary
+   std::vector<std::string> messages;
+   for (size_t length : { 0, 1, 55, 56, 63, 64, 65, 119, 128, 1000, 4096 })
+   {
+      std::string message(length, '\0');
+      for (size_t i = 0; i < length; ++i)
+         message[i] = char(i * 31 + length);
+      messages.push_back(std::move(message));
+   }
+
+   crypto::SHA256::SetImplementation(crypto::SHA256::Implementation::Scalar);
+   std::vector<std::string> expected;
+   for (const auto& message : messages)
+      expected.push_back(crypto::sha256(message));
+
+   std::vector<std::pair<const void*, size_t>> spans;
+   for (const auto& message : messages)
+      spans.emplace_back(message.data(), message.size());
+
+   for (auto implementation : { crypto::SHA256::Implementation::Scalar,
+                                crypto::SHA256::Implementation::SHANI,
+                                crypto::SHA256::Implementation::ARMv8 })
+   {
+      crypto::SHA256::SetImplementation(implementation);
+      if (crypto::SHA256::ActiveImplementation() != implementation)
+         continue;
+
+      for (size_t i = 0; i < messages.size(); ++i)
+      {
+         // Fed in uneven pieces
+         crypto::SHA256 hasher;
+         const auto& message = messages[i];
+         for (size_t offset = 0; offset < message.size(); offset += 37)
+            hasher.Update(
+               message.data() + offset,
+               std::min<size_t>(37, message.size() - offset));
+         REQUIRE(hasher.Finalize() == expected[i]);
+         REQUIRE(crypto::sha256(message) == expected[i]);
+      }
+      REQUIRE(crypto::SHA256::HashMany(spans) == expected);
+   }
+   crypto::SHA256::SetImplementation(
+      crypto::SHA256::DetectedImplementation());
+}
@@ -0,0 +1,84 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ * SPDX-FileName: SHA256Benchmark.cpp
+ *
+ * Throughput of each implementation of SHA256, one message at a time and
+ * with HashMany(), printed so that regressions show up in the test log.
+ */
+
+#include <catch2/catch.hpp>
+
+#include "crypto/SHA256.h"
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+namespace
+{
+// Sample blocks of one million bytes, as the sample block factory makes
+constexpr size_t Length = 1 << 20;
+constexpr size_t Messages = 16;
+
+template<typename F> double MegabytesPerSecond(F f)
+{
+   using namespace std::chrono;
+   // Warm up caches
+   f();
+   const auto start = steady_clock::now();
+   f();
+   const auto seconds = duration<double>(steady_clock::now() - start).count();
+   return Length * double(Messages) / seconds / 1e6;
+}
+} // namespace
+
+TEST_CASE("SHA256Benchmark")
+{
+   std::vector<std::vector<char>> messages(Messages);
+   std::vector<std::pair<const void*, size_t>> spans;
+   for (size_t i = 0; i < Messages; ++i)
+   {
+      messages[i].resize(Length);
+      for (size_t j = 0; j < Length; ++j)
+         messages[i][j] = char(i + j * 7);
+      spans.emplace_back(messages[i].data(), Length);
+   }
+
+   double scalarRate = 0;
+   for (auto implementation : { crypto::SHA256::Implementation::Scalar,
+                                crypto::SHA256::Implementation::SHANI,
+                                crypto::SHA256::Implementation::ARMv8 })
+   {
+      crypto::SHA256::SetImplementation(implementation);
+      if (crypto::SHA256::ActiveImplementation() != implementation)
+         continue;
+
+      const auto report = [&](const char* name, double rate)
+      {
+         std::cout << std::setw(8)
+                   << crypto::SHA256::ImplementationName(implementation)
+                   << std::setw(12) << name << std::setw(10) << std::fixed
+                   << std::setprecision(0) << rate << " MB/s\n";
+         REQUIRE(rate > 0);
+      };
+
+      const auto single = MegabytesPerSecond(
+         [&]
+         {
+            for (const auto& message : messages)
+               crypto::sha256(message);
+         });
+      report("single", single);
+      report("many", MegabytesPerSecond(
+         [&] { crypto::SHA256::HashMany(spans); }));
+
+      if (implementation == crypto::SHA256::Implementation::Scalar)
+         scalarRate = single;
+      else
+         // The instructions should beat the scalar code by far
+         CHECK(single > 2 * scalarRate);
+   }
+   crypto::SHA256::SetImplementation(
+      crypto::SHA256::DetectedImplementation());
+}
@@ -62,12 +62,10 @@ EffectOutputTracks::EffectOutputTracks(
                   *pTrack, effectTimeInterval->first,
                   effectTimeInterval->second);
             };
-            BasicUI::SplitProgress(
-               tracksToUnstretch.begin(), tracksToUnstretch.end(),
-               [&](WaveTrack* aTrack, const ProgressReporter& child) {
-                  aTrack->ApplyPitchAndSpeed(effectTimeInterval, child);
-               },
-               parent);
+            // Render the clips of all tracks concurrently
+            WaveTrack::ApplyPitchAndSpeed(
+               { tracksToUnstretch.begin(), tracksToUnstretch.end() },
+               effectTimeInterval, parent);
          });
    }
 
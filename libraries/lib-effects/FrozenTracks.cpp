@@ -0,0 +1,355 @@
+/**********************************************************************
+
+Audacity: A Digital Audio Editor
+
+FrozenTracks.cpp
+
+**********************************************************************/
+
+#include "FrozenTracks.h"
+
+#include "BasicUI.h"
+#include "MemoryX.h"
+#include "Tracing.h"
+#include "MixAndRender.h"
+#include "Project.h"
+#include "RealtimeEffectList.h"
+#include "StretchingSequence.h"
+#include "WaveClip.h"
+#include "WaveTrack.h"
+#include "XMLWriter.h"
+
+namespace {
+//! Plays the samples of a rendering with the gains and the mute and solo
+//! state of the track that was rendered
+class FrozenSequence final : public PlayableSequence
+{
+public:
+   FrozenSequence(std::shared_ptr<const WaveTrack> pSource,
+      std::shared_ptr<const WaveTrack> pRender)
+      : mpSource{ move(pSource) }
+      , mpRender{ move(pRender) }
+   {}
+
+   const WaveTrack &GetSource() const { return *mpSource; }
+
+   // WideSampleSequence
+   size_t NChannels() const override { return Render().NChannels(); }
+   float GetChannelGain(int channel) const override
+      { return Source().GetChannelGain(channel); }
+   bool DoGet(
+      size_t iChannel, size_t nBuffers, const samplePtr buffers[],
+      sampleFormat format, sampleCount start, size_t len, bool backwards,
+      fillFormat fill, bool mayThrow, sampleCount *pNumWithinClips)
+   const override
+   {
+      return Render().DoGet(iChannel, nBuffers, buffers, format, start, len,
+         backwards, fill, mayThrow, pNumWithinClips);
+   }
+   double GetStartTime() const override { return Render().GetStartTime(); }
+   double GetEndTime() const override { return Render().GetEndTime(); }
+   double GetRate() const override { return Render().GetRate(); }
+   sampleFormat WidestEffectiveFormat() const override
+      { return Render().WidestEffectiveFormat(); }
+   bool HasTrivialEnvelope() const override
+      { return Render().HasTrivialEnvelope(); }
+   void GetEnvelopeValues(
+      double *buffer, size_t bufferLen, double t0, bool backwards)
+   const override
+      { Render().GetEnvelopeValues(buffer, bufferLen, t0, backwards); }
+   void Prefetch(double t0, double t1) const noexcept override
+      { Render().Prefetch(t0, t1); }
+   bool IsResident(double t0, double t1) const noexcept override
+      { return Render().IsResident(t0, t1); }
+   std::shared_ptr<const void>
+   PinResident(double t0, double t1) const override
+      { return Render().PinResident(t0, t1); }
+
+   // PlayableSequence
+   //! The rendering has no realtime effects to process again
+   const ChannelGroup *FindChannelGroup() const override
+      { return Render().FindChannelGroup(); }
+   bool GetSolo() const override { return Source().GetSolo(); }
+   bool GetMute() const override { return Source().GetMute(); }
+
+   // AudioGraph::Channel
+   AudioGraph::ChannelType GetChannelType() const override
+      { return Render().GetChannelType(); }
+
+private:
+   const PlayableSequence &Source() const { return *mpSource; }
+   const PlayableSequence &Render() const { return *mpRender; }
+
+   const std::shared_ptr<const WaveTrack> mpSource;
+   const std::shared_ptr<const WaveTrack> mpRender;
+};
+}
+
+struct FrozenTracks::Job {
+   TrackId id;
+   wxString fingerprint;
+
+   //! Made in the main thread, and then used only by the worker thread
+   //! until the job is finished
+   std::shared_ptr<const WaveTrack> pCopy;
+   std::unique_ptr<Mixer> pMixer;
+
+   //! Used only in the main thread
+   std::shared_ptr<WaveTrack> pRender;
+
+   std::atomic<bool> cancelled{ false };
+
+   //! Destroy in the main thread
+   void Release()
+   {
+      pMixer.reset();
+      pCopy.reset();
+      pRender.reset();
+   }
+};
+
+static const AttachedProjectObjects::RegisteredFactory key
+{
+   [](AudacityProject &project)
+   {
+      return std::make_shared<FrozenTracks>(project);
+   }
+};
+
+FrozenTracks &FrozenTracks::Get(AudacityProject &project)
+{
+   return project.AttachedObjects::Get<FrozenTracks&>(key);
+}
+
+const FrozenTracks &FrozenTracks::Get(const AudacityProject &project)
+{
+   return Get(const_cast<AudacityProject &>(project));
+}
+
+FrozenTracks::FrozenTracks(AudacityProject &project)
+   : mProject{ project }
+{
+}
+
+FrozenTracks::~FrozenTracks()
+{
+   if (mThread.joinable()) {
+      {
+         std::lock_guard<std::mutex> guard{ mMutex };
+         mStop = true;
+         mCondition.notify_one();
+      }
+      mThread.join();
+   }
+
+   // Actions still pending in the main thread will do nothing
+   for (auto &pJob : mJobs) {
+      pJob->cancelled = true;
+      pJob->Release();
+   }
+   for (auto &[id, entry] : mEntries)
+      if (const auto pJob = entry.pJob) {
+         pJob->cancelled = true;
+         pJob->Release();
+      }
+}
+
+void FrozenTracks::Freeze(const WaveTrack &track)
+{
+   const auto id = track.GetId();
+   if (id == TrackId{})
+      // Not yet in the undo history
+      return;
+   auto &entry = mEntries[id];
+   const auto fingerprint = Fingerprint(track);
+   if (entry.fingerprint == fingerprint && (entry.pRender || entry.pJob))
+      return;
+   StartRendering(track, entry, fingerprint);
+}
+
+void FrozenTracks::Unfreeze(const WaveTrack &track)
+{
+   const auto iter = mEntries.find(track.GetId());
+   if (iter == mEntries.end())
+      return;
+   Cancel(iter->second);
+   mEntries.erase(iter);
+}
+
+bool FrozenTracks::IsFrozen(const WaveTrack &track) const
+{
+   return mEntries.count(track.GetId()) > 0;
+}
+
+std::shared_ptr<const PlayableSequence>
+FrozenTracks::GetPlayable(const WaveTrack &track)
+{
+   const auto iter = mEntries.find(track.GetId());
+   if (iter == mEntries.end())
+      return {};
+   auto &entry = iter->second;
+   const auto fingerprint = Fingerprint(track);
+   if (entry.fingerprint == fingerprint) {
+      if (entry.pRender)
+         return std::make_shared<FrozenSequence>(
+            track.SharedPointer<const WaveTrack>(), entry.pRender);
+      // else still rendering, or there was nothing to render
+      return {};
+   }
+   // Out of date; play the effects this time, and render again for the next
+   StartRendering(track, entry, fingerprint);
+   return {};
+}
+
+const ChannelGroup *FrozenTracks::FindSourceGroup(
+   const PlayableSequence &sequence)
+{
+   if (const auto pFrozen = dynamic_cast<const FrozenSequence*>(&sequence))
+      return pFrozen->GetSource().FindChannelGroup();
+   return sequence.FindChannelGroup();
+}
+
+wxString FrozenTracks::Fingerprint(const WaveTrack &track)
+{
+   // The same things that the project file saves, except the properties of
+   // the track applied after the effects, such as gain
+   XMLStringWriter writer;
+   writer.StartTag(wxT("frozen"));
+   writer.WriteAttr(wxT("rate"), track.GetRate());
+   writer.WriteAttr(wxT("sampleformat"),
+      static_cast<long>(track.GetSampleFormat()));
+   RealtimeEffectList::Get(track).WriteXML(writer);
+   for (const auto &pClip : track.Intervals())
+      for (size_t ii = 0, width = pClip->NChannels(); ii < width; ++ii)
+         pClip->WriteXML(ii, writer);
+   writer.EndTag(wxT("frozen"));
+   return std::move(writer);
+}
+
+void FrozenTracks::StartRendering(const WaveTrack &track, Entry &entry,
+   const wxString &fingerprint)
+{
+   Cancel(entry);
+   entry.fingerprint = fingerprint;
+
+   // Render a copy, which later edits of the track don't affect
+   const auto pCopy = std::static_pointer_cast<const WaveTrack>(
+      track.Duplicate());
+   auto stages = GetEffectStages(*pCopy);
+   const auto t0 = pCopy->GetStartTime(), t1 = pCopy->GetEndTime();
+   if (stages.empty() || !(t0 < t1))
+      // Playing the track costs no more than playing a rendering would
+      return;
+
+   const auto nChannels = pCopy->NChannels();
+   auto pRender = WaveTrackFactory::Get(mProject).Create(nChannels, *pCopy);
+   pRender->SetRate(pCopy->GetRate());
+   pRender->ConvertToSampleFormat(floatSample);
+   pRender->MoveTo(t0);
+   RealtimeEffectList::Get(*pRender).Clear();
+
+   // Effect instances are made here in the main thread
+   Mixer::Inputs inputs;
+   inputs.emplace_back(
+      StretchingSequence::Create(*pCopy, pCopy->GetClipInterfaces()),
+      move(stages));
+   auto pMixer = std::make_unique<Mixer>(move(inputs),
+      // Don't throw for read errors in the worker thread, just mix silence
+      false,
+      Mixer::WarpOptions{ 1.0, 1.0 },
+      t0, t1, nChannels, pRender->GetMaxBlockSize(),
+      false, // not interleaved
+      pCopy->GetRate(), floatSample,
+      true, // high quality
+      nullptr, // no custom mix-down
+      Mixer::ApplyGain::Discard // gains apply to the rendering in playback
+   );
+
+   const auto pJob = std::make_shared<Job>();
+   pJob->id = track.GetId();
+   pJob->fingerprint = fingerprint;
+   pJob->pCopy = pCopy;
+   pJob->pMixer = move(pMixer);
+   pJob->pRender = move(pRender);
+   entry.pJob = pJob;
+
+   if (!mThread.joinable())
+      mThread = std::thread{ [this]{ WorkerThread(); } };
+   std::lock_guard<std::mutex> guard{ mMutex };
+   mJobs.push_back(pJob);
+   mCondition.notify_one();
+}
+
+void FrozenTracks::Cancel(Entry &entry)
+{
+   // The worker thread, or a pending action, will release the job
+   if (entry.pJob)
+      entry.pJob->cancelled = true;
+   entry.pJob.reset();
+   entry.pRender.reset();
+   entry.fingerprint.clear();
+}
+
+void FrozenTracks::Finish(const std::shared_ptr<Job> &pJob)
+{
+   Finally Do{ [&]{ pJob->Release(); } };
+   if (pJob->cancelled)
+      return;
+   const auto iter = mEntries.find(pJob->id);
+   if (iter == mEntries.end() || iter->second.pJob != pJob)
+      return;
+   auto &entry = iter->second;
+   pJob->pRender->Flush();
+   entry.pRender = move(pJob->pRender);
+   entry.pJob.reset();
+}
+
+void FrozenTracks::WorkerThread()
+{
+   Tracing::RegisterThread("Frozen tracks");
+   const auto wProject = mProject.weak_from_this();
+   while (true) {
+      std::shared_ptr<Job> pJob;
+      {
+         std::unique_lock<std::mutex> lock{ mMutex };
+         mCondition.wait(lock, [this]{ return mStop || !mJobs.empty(); });
+         if (mStop)
+            break;
+         pJob = move(mJobs.front());
+         mJobs.pop_front();
+      }
+
+      auto &mixer = *pJob->pMixer;
+      const auto nChannels = mixer.NumChannels();
+      while (!pJob->cancelled && !mStop) {
+         const auto blockLen = mixer.Process();
+         if (blockLen == 0)
+            break;
+         // Append in the main thread, which owns the sample block factory
+         std::vector<std::vector<float>> chunk(nChannels);
+         for (unsigned iChannel = 0; iChannel < nChannels; ++iChannel) {
+            const auto buffer =
+               reinterpret_cast<const float*>(mixer.GetBuffer(iChannel));
+            chunk[iChannel].assign(buffer, buffer + blockLen);
+         }
+         BasicUI::CallAfter([pJob, chunk = move(chunk)]{
+            if (pJob->cancelled || !pJob->pRender)
+               return;
+            size_t iChannel = 0;
+            for (const auto pChannel : pJob->pRender->Channels()) {
+               const auto &samples = chunk[iChannel++];
+               pChannel->AppendBuffer(
+                  reinterpret_cast<constSamplePtr>(samples.data()),
+                  floatSample, samples.size(), 1, floatSample);
+            }
+         });
+      }
+
+      BasicUI::CallAfter([wProject, pJob]{
+         if (auto pProject = wProject.lock())
+            Get(*pProject).Finish(pJob);
+         else
+            pJob->Release();
+      });
+   }
+}
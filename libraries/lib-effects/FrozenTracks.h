@@ -0,0 +1,100 @@
+/**********************************************************************
+
+Audacity: A Digital Audio Editor
+
+FrozenTracks.h
+@brief Renders tracks through their realtime effects in the background, so
+that playback can read the results instead of processing the effects again
+
+**********************************************************************/
+
+#ifndef __AUDACITY_FROZEN_TRACKS__
+#define __AUDACITY_FROZEN_TRACKS__
+
+#include "ClientData.h"
+#include "Track.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+class AudacityProject;
+class ChannelGroup;
+struct PlayableSequence;
+class WaveTrack;
+
+//! Per project, the set of tracks whose realtime effects are "frozen"
+/*!
+ A frozen track is mixed through its realtime effect chain, from start to end,
+ in a worker thread.  When playback begins, a complete rendering is used only
+ if neither the samples and clips of the track nor its effects and their
+ settings changed since; otherwise the track plays through its effects as
+ usual, and rendering starts again.
+
+ Gain, pan, mute and solo still apply to the rendering as to the track.
+ Freezing is not saved with the project.
+ */
+class EFFECTS_API FrozenTracks final
+   : public ClientData::Base
+{
+public:
+   static FrozenTracks &Get(AudacityProject &project);
+   static const FrozenTracks &Get(const AudacityProject &project);
+
+   explicit FrozenTracks(AudacityProject &project);
+   FrozenTracks(const FrozenTracks &) = delete;
+   FrozenTracks &operator=(const FrozenTracks &) = delete;
+   ~FrozenTracks() override;
+
+   //! Begin rendering in the background, if the track has enabled effects
+   void Freeze(const WaveTrack &track);
+   //! Forget the rendering, or stop making it
+   void Unfreeze(const WaveTrack &track);
+   bool IsFrozen(const WaveTrack &track) const;
+
+   //! What playback should read instead of the track, or null
+   /*!
+    Null if the track is not frozen, or its rendering is not finished or not
+    current; in the last case a new rendering begins
+    */
+   std::shared_ptr<const PlayableSequence> GetPlayable(const WaveTrack &track);
+
+   //! The channel group of the track that a sequence plays, looking through
+   //! a rendering if the sequence was given by GetPlayable
+   static const ChannelGroup *FindSourceGroup(
+      const PlayableSequence &sequence);
+
+private:
+   struct Job;
+   struct Entry {
+      //! Describes the track and its effects as they were rendered
+      wxString fingerprint;
+      std::shared_ptr<const WaveTrack> pRender;
+      std::shared_ptr<Job> pJob;
+   };
+
+   //! Samples, clips and effect settings that determine the rendering
+   static wxString Fingerprint(const WaveTrack &track);
+
+   void StartRendering(const WaveTrack &track, Entry &entry,
+      const wxString &fingerprint);
+   static void Cancel(Entry &entry);
+   //! In the main thread
+   void Finish(const std::shared_ptr<Job> &pJob);
+   void WorkerThread();
+
+   AudacityProject &mProject;
+   std::map<TrackId, Entry> mEntries;
+
+   std::thread mThread;
+   std::mutex mMutex;
+   std::condition_variable mCondition;
+   std::deque<std::shared_ptr<Job>> mJobs;
+   std::atomic<bool> mStop{ false };
+};
+
+#endif
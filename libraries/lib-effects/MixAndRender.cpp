@@ -13,11 +13,83 @@ Paul Licameli split from Mix.cpp
 #include "BasicUI.h"
 #include "Mix.h"
 #include "RealtimeEffectList.h"
+#include "SampleBlock.h"
+#include "Sequence.h"
 #include "StretchingSequence.h"
+#include "WaveClip.h"
 #include "WaveTrack.h"
 
+#include <algorithm>
+#include <cmath>
+
 using WaveTrackConstArray = std::vector < std::shared_ptr < const WaveTrack > >;
 
+namespace {
+//! Seconds of silence kept around content, for the transients of resampling
+constexpr double ContentGuard = 0.05;
+
+//! Sorted, disjoint regions within [t0, t1] where any track may be audible
+/*!
+ Clips are found by their intervals, and in clips that are not stretched or
+ shifted, whole blocks of silence by their summaries, without reading samples
+ */
+WaveTrack::Regions ContentRegions(
+   const TrackIterRange<const WaveTrack> &trackRange, double t0, double t1)
+{
+   WaveTrack::Regions regions;
+   const auto add = [&](double start, double end){
+      start = std::max(t0, start - ContentGuard);
+      end = std::min(t1, end + ContentGuard);
+      if (start < end)
+         regions.emplace_back(start, end);
+   };
+   for (auto wt : trackRange) {
+      for (const auto &pClip : wt->Intervals()) {
+         const auto start = pClip->GetPlayStartTime();
+         const auto end = pClip->GetPlayEndTime();
+         if (pClip->HasPitchOrSpeed()) {
+            add(start, end);
+            continue;
+         }
+         const double rate = pClip->GetRate();
+         const auto offset = pClip->GetSequenceStartTime();
+         for (size_t ii = 0, nn = pClip->NChannels(); ii < nn; ++ii) {
+            auto blocksEnd = offset;
+            for (const auto &block : *pClip->GetSequenceBlockArray(ii)) {
+               const auto blockStart = offset + block.start.as_double() / rate;
+               blocksEnd = blockStart + block.sb->GetSampleCount() / rate;
+               const auto range = block.sb->GetMinMaxRMS(false);
+               if (range.min != 0 || range.max != 0)
+                  add(std::max(start, blockStart), std::min(end, blocksEnd));
+            }
+            // Samples not yet in blocks
+            add(std::max(start, blocksEnd), end);
+         }
+      }
+   }
+
+   std::sort(regions.begin(), regions.end());
+   WaveTrack::Regions merged;
+   for (const auto &region : regions) {
+      if (!merged.empty() && region.start <= merged.back().end)
+         merged.back().end = std::max(merged.back().end, region.end);
+      else
+         merged.push_back(region);
+   }
+   return merged;
+}
+
+//! Extend the mix with silent blocks, which store no samples
+void AppendSilence(WaveTrack &mix, sampleCount len)
+{
+   if (len <= 0)
+      return;
+   // Append buffers must go into blocks first, ahead of the silence
+   mix.Flush();
+   mix.RightmostOrNewClip()->AppendSilence(len.as_double() / mix.GetRate(), 1.0);
+}
+}
+
 //TODO-MB: wouldn't it make more sense to DELETE the time track after 'mix and render'?
 Track::Holder MixAndRender(const TrackIterRange<const WaveTrack> &trackRange,
    const Mixer::WarpOptions &warpOptions,
@@ -65,10 +137,15 @@ Track::Holder MixAndRender(const TrackIterRange<const WaveTrack> &trackRange,
 
    Mixer::Inputs waveArray;
 
+   // Effect stages may make sound anywhere, as reverberation after clips
+   bool anyStages = false;
+
    for (auto wt : trackRange) {
       const auto stretchingSequence =
          StretchingSequence::Create(*wt, wt->GetClipInterfaces());
-      waveArray.emplace_back(stretchingSequence, GetEffectStages(*wt));
+      auto &input = waveArray.emplace_back(
+         stretchingSequence, GetEffectStages(*wt));
+      anyStages = anyStages || !input.stages.empty();
       tstart = wt->GetStartTime();
       tend = wt->GetEndTime();
       if (tend > mixEndTime)
@@ -112,11 +189,21 @@ Track::Holder MixAndRender(const TrackIterRange<const WaveTrack> &trackRange,
       endTime = mixEndTime;
    }
 
+   // Render only where there may be sound, unless time is warped, so that
+   // output times do not correspond simply to input times
+   const bool skipSilence = !(anyStages || warpOptions.envelope);
+   auto regions = skipSilence
+      ? ContentRegions(trackRange, startTime, endTime)
+      : WaveTrack::Regions{ { startTime, endTime } };
+
    Mixer mixer(move(waveArray),
       // Throw to abort mix-and-render if read fails:
       true, warpOptions,
       startTime, endTime, mono ? 1 : 2, maxBlockLen, false,
-      rate, format);
+      rate, format,
+      true, nullptr, Mixer::ApplyGain::MapChannels,
+      // Offline, so the inputs may be fetched concurrently
+      true);
 
    using namespace BasicUI;
    auto updateResult = ProgressResult::Success;
@@ -125,21 +212,40 @@ Track::Holder MixAndRender(const TrackIterRange<const WaveTrack> &trackRange,
       auto pProgress = MakeProgress(XO("Mix and Render"),
          XO("Mixing and rendering tracks"));
 
-      while (updateResult == ProgressResult::Success) {
-         auto blockLen = mixer.Process();
-
-         if (blockLen == 0)
+      // Count output samples, so that there is no drift between regions
+      sampleCount written = 0;
+      const auto toSamples = [&](double t){
+         return sampleCount(std::floor((t - startTime) * rate + 0.5));
+      };
+      for (const auto &region : regions) {
+         if (updateResult != ProgressResult::Success)
             break;
-
-         for(auto channel : mix->Channels())
-         {
-            auto buffer = mixer.GetBuffer(channel->GetChannelIndex());
-            channel->AppendBuffer(buffer, format, blockLen, 1, effectiveFormat);
+         AppendSilence(*mix, toSamples(region.start) - written);
+         written = std::max(written, toSamples(region.start));
+         if (written > 0)
+            mixer.SetTimesAndSpeed(
+               startTime + written.as_double() / rate, region.end, 1.0);
+
+         while (updateResult == ProgressResult::Success) {
+            auto blockLen = mixer.Process();
+
+            if (blockLen == 0)
+               break;
+
+            for(auto channel : mix->Channels())
+            {
+               auto buffer = mixer.GetBuffer(channel->GetChannelIndex());
+               channel->AppendBuffer(
+                  buffer, format, blockLen, 1, effectiveFormat);
+            }
+            written += blockLen;
+
+            updateResult = pProgress->Poll(
+               written.as_double() / rate, endTime - startTime);
          }
-
-         updateResult = pProgress->Poll(
-            mixer.MixGetCurrentTime() - startTime, endTime - startTime);
       }
+      if (skipSilence && updateResult == ProgressResult::Success)
+         AppendSilence(*mix, toSamples(endTime) - written);
    }
    mix->Flush();
    if (updateResult == ProgressResult::Cancelled ||
@@ -23,6 +23,7 @@
 
 #include "AudioGraphBuffers.h"
 #include "AudioGraphTask.h"
+#include "AudioGraphTaskGroup.h"
 #include "EffectStage.h"
 #include "SyncLock.h"
 #include "TimeWarper.h"
@@ -30,6 +31,9 @@
 #include "WaveTrack.h"
 #include "WaveTrackSink.h"
 #include "WideSampleSource.h"
+#include "concurrency/ThreadPool.h"
+#include <algorithm>
+#include <atomic>
 
 PerTrackEffect::Instance::~Instance() = default;
 
@@ -61,6 +65,16 @@ bool PerTrackEffect::DoPass2() const
    return false;
 }
 
+bool PerTrackEffect::ProcessesTracksConcurrently() const
+{
+   return false;
+}
+
+bool PerTrackEffect::ProcessesChunksIndependently() const
+{
+   return false;
+}
+
 bool PerTrackEffect::Process(
    EffectInstance &instance, EffectSettings &settings) const
 {
@@ -110,6 +124,13 @@ bool PerTrackEffect::ProcessPass(TrackList &outputs,
    if (numAudioOut < 1)
       return false;
 
+   if (isProcessor && ProcessesTracksConcurrently()) {
+      auto &pool = audacity::concurrency::ThreadPool::GetDefault();
+      // Don't wait for other tasks of the pool from within it
+      if (!pool.IsWorkerThread() && pool.GetThreadsCount() > 1)
+         return ProcessPassConcurrently(outputs, instance, settings);
+   }
+
    // Instances that can be reused in each loop pass
    std::vector<std::shared_ptr<EffectInstance>> recycledInstances{
       // First one is the given one; any others pushed onto here are
@@ -352,6 +373,202 @@ bool PerTrackEffect::ProcessPass(TrackList &outputs,
    return bGoodResult;
 }
 
+namespace {
+//! State of the processing of a channel group, or a chunk of it, by
+//! ProcessPassConcurrently
+/*! Members are declared in the order of their dependencies */
+struct ChannelGroupJob {
+   AudioGraph::Buffers inBuffers, outBuffers;
+   std::optional<WideSampleSource> source;
+   std::optional<WaveTrackSink> sink;
+   std::vector<std::shared_ptr<EffectInstance>> instances;
+   std::unique_ptr<EffectStage> pStage;
+   std::optional<AudioGraph::Task> task;
+   //! Written by the source's poll in a worker, read in the main thread
+   std::atomic<double> fraction{ 0.0 };
+   double length{};
+   bool done{ false };
+};
+}
+
+bool PerTrackEffect::ProcessPassConcurrently(TrackList &outputs,
+   Instance &instance, EffectSettings &settings)
+{
+   assert(GetType() == EffectTypeProcess);
+   const auto duration = settings.extra.GetDuration();
+   const auto numAudioIn = instance.GetAudioInCount();
+   const auto numAudioOut = instance.GetAudioOutCount();
+   const bool multichannel = numAudioIn > 1;
+
+   // Gather the channel groups in the order that ProcessPass() visits them
+   struct Group {
+      WaveTrack &track;
+      WaveChannel &left;
+      WaveChannel *pRight;
+      int channel;
+   };
+   std::vector<Group> groups;
+   for (const auto pTrack : outputs.Any()) {
+      const auto pWaveTrack = dynamic_cast<WaveTrack *>(pTrack);
+      if (!(pWaveTrack && pWaveTrack->GetSelected())) {
+         if (SyncLock::IsSyncLockSelected(*pTrack))
+            pTrack->SyncLockAdjust(mT1, mT0 + duration);
+         continue;
+      }
+      auto &wt = *pWaveTrack;
+      const auto channels = wt.Channels();
+      if (multichannel) {
+         // TODO: more-than-two-channels
+         const auto pRight =
+            wt.NChannels() == 2 ? (*channels.rbegin()).get() : nullptr;
+         groups.push_back({ wt, **channels.begin(), pRight, -1 });
+      }
+      else {
+         int iChannel = 0;
+         for (const auto pChannel : channels)
+            groups.push_back({ wt, *pChannel, nullptr, iChannel++ });
+      }
+   }
+
+   auto &pool = audacity::concurrency::ThreadPool::GetDefault();
+   const auto nJobs = pool.GetThreadsCount();
+
+   // Split each group into chunks of at least this many samples, when
+   // the effect permits; the sinks of chunks then write disjoint ranges
+   constexpr size_t MinChunkLength = 1 << 20;
+   const bool chunked = ProcessesChunksIndependently();
+   struct Chunk {
+      size_t iGroup;
+      sampleCount start, len;
+   };
+   std::vector<Chunk> chunks;
+   double totalLength = 0;
+   for (size_t iGroup = 0; iGroup < groups.size(); ++iGroup) {
+      sampleCount start = 0, len = 0;
+      GetBounds(groups[iGroup].track, &start, &len);
+      if (len > 0 && numAudioIn < 1)
+         return false;
+      totalLength += len.as_double();
+      const auto nChunks = !chunked ? 1 : std::clamp<long long>(
+         len.as_long_long() / MinChunkLength, 1, nJobs);
+      for (long long iChunk = 0; iChunk < nChunks; ++iChunk) {
+         const auto chunkStart = start + len * iChunk / nChunks;
+         const auto chunkEnd = start + len * (iChunk + 1) / nChunks;
+         chunks.push_back({ iGroup, chunkStart, chunkEnd - chunkStart });
+      }
+   }
+
+   // Bound the number of jobs, and so the memory for buffers, at once
+   const auto nChunks = chunks.size();
+   double finishedLength = 0;
+   for (size_t first = 0; first < nChunks; first += nJobs) {
+      const auto last = std::min(nChunks, first + nJobs);
+      std::vector<std::unique_ptr<ChannelGroupJob>> jobs;
+      jobs.reserve(last - first);
+      for (auto ii = first; ii < last; ++ii) {
+         const auto &chunk = chunks[ii];
+         const auto start = chunk.start, len = chunk.len;
+         const auto &group = groups[chunk.iGroup];
+         auto &wt = group.track;
+
+         auto &job = *jobs.emplace_back(std::make_unique<ChannelGroupJob>());
+         job.length = len.as_double();
+         // The given instance serves the first chunk; each other chunk gets
+         // instances of its own
+         job.instances.push_back(ii == 0
+            ? std::dynamic_pointer_cast<EffectInstanceEx>(
+               instance.shared_from_this())
+            : MakeInstance());
+         const auto pInstance = job.instances.front();
+         if (!pInstance)
+            return false;
+
+         const auto max = wt.GetMaxBlockSize() * 2;
+         const auto blockSize = pInstance->SetBlockSize(max);
+         if (blockSize == 0)
+            return false;
+         const auto bufferSize =
+            ((max + (blockSize - 1)) / blockSize) * blockSize;
+         if (bufferSize == 0)
+            return false;
+         // Fresh buffers are zero-filled, so unused inputs need no clearing
+         job.inBuffers.Reinit(std::max(1u, numAudioIn),
+            blockSize, std::max<size_t>(1, bufferSize / blockSize));
+         job.outBuffers.Reinit(numAudioOut, blockSize,
+            (bufferSize / blockSize) + 1);
+
+         // Record progress for the main thread; cancellation is checked
+         // there between blocks
+         const auto pollUser = [&fraction = job.fraction, start,
+            length = std::max(1.0, len.as_double())
+         ](sampleCount inPos){
+            fraction.store((inPos - start).as_double() / length,
+               std::memory_order_relaxed);
+            return true;
+         };
+         auto &source = job.source.emplace(group.left,
+            size_t(group.pRight ? 2 : 1), start, len, pollUser);
+         assert(source.AcceptsBuffers(job.inBuffers));
+         assert(source.AcceptsBlockSize(job.inBuffers.BlockSize()));
+         auto &sink = job.sink.emplace(group.left, group.pRight, nullptr,
+            start, true,
+            pInstance->NeedsDither() ? widestSampleFormat : narrowestSampleFormat
+         );
+         assert(sink.AcceptsBuffers(job.outBuffers));
+
+         const auto factory =
+         [this, &instances = job.instances, counter = 0]() mutable {
+            auto index = counter++;
+            if (index < instances.size())
+               return instances[index];
+            else
+               return instances.emplace_back(MakeInstance());
+         };
+         job.pStage = EffectStage::Create(group.channel, source,
+            job.inBuffers, factory, settings, wt.GetRate(), {}, wt);
+         if (!job.pStage)
+            return false;
+         assert(job.pStage->AcceptsBuffers(job.outBuffers));
+         job.task.emplace(*job.pStage, job.outBuffers, sink);
+         // Satisfy the pre of Fetch() initially, as Task::RunLoop() does
+         job.outBuffers.Rewind();
+      }
+
+      // Jobs are independent:  each has its own range of a channel, instances
+      // and buffers, and nothing writes the tracks while the workers fetch
+      std::vector<AudioGraph::Task*> tasks;
+      tasks.reserve(jobs.size());
+      for (const auto &pJob : jobs)
+         tasks.push_back(&*pJob->task);
+      AudioGraph::TaskGroup group{ move(tasks) };
+      const auto onDone = [&](size_t ii){
+         auto &job = *jobs[ii];
+         job.sink->Flush(job.outBuffers);
+         if (!job.sink->IsOk())
+            return false;
+         finishedLength += job.length;
+         job.done = true;
+         return true;
+      };
+      for (;;) {
+         const auto status = group.RunOnce(onDone);
+         if (status == AudioGraph::Task::Status::Fail)
+            return false;
+         if (status == AudioGraph::Task::Status::Done)
+            break;
+
+         double progress = finishedLength;
+         for (const auto &pJob : jobs)
+            if (!pJob->done)
+               progress += pJob->length *
+                  pJob->fraction.load(std::memory_order_relaxed);
+         if (TotalProgress(progress / std::max(1.0, totalLength)))
+            return false;
+      }
+   }
+   return true;
+}
+
 bool PerTrackEffect::ProcessTrack(int channel, const Factory &factory,
    EffectSettings &settings,
    AudioGraph::Source &upstream, AudioGraph::Sink &sink,
@@ -63,6 +63,23 @@ protected:
    /* virtual */ bool DoPass1() const;
    /* virtual */ bool DoPass2() const;
 
+   //! Whether the tracks of a processing effect may be processed at once
+   /*!
+    Default is false.  Override to return true only if instances made by
+    MakeInstance() share no mutable state with one another or with the effect,
+    do not modify the settings in ProcessInitialize() or ProcessBlock(), and do
+    not depend on mSampleCnt, which is then not updated
+    */
+   virtual bool ProcessesTracksConcurrently() const;
+
+   //! Whether disjoint ranges of one channel may be processed at once
+   /*!
+    Default is false.  Considered only if ProcessesTracksConcurrently().
+    Override to return true only if each output sample depends on the input
+    at the same time alone, so that there is no latency and no history
+    */
+   virtual bool ProcessesChunksIndependently() const;
+
    // non-virtual
    bool Process(EffectInstance &instance, EffectSettings &settings) const;
 
@@ -79,6 +96,15 @@ private:
 
    bool ProcessPass(TrackList &outputs,
       Instance &instance, EffectSettings &settings);
+   //! ProcessPass() for effects that ProcessesTracksConcurrently()
+   /*!
+    Channel groups, or chunks of them if ProcessesChunksIndependently(),
+    advance a block at a time in lockstep:  their sources and effect stages
+    are acquired on the thread pool, while writing into the tracks and
+    reporting progress happen in the calling thread
+    */
+   bool ProcessPassConcurrently(TrackList &outputs,
+      Instance &instance, EffectSettings &settings);
    using Factory = std::function<std::shared_ptr<EffectInstance>()>;
    /*!
     Previous contents of inBuffers and outBuffers are ignored
@@ -45,10 +45,11 @@
 #include "MemoryX.h"
 
 #include <wx/wxcrtvararg.h>
+#include <algorithm>
 #include <stdlib.h>
 #include <math.h>
 
-#include "RealFFTf.h"
+#include "RealFFTPlan.h"
 
 using Floats = ArrayOf<float>;
 static ArraysOf<int> gFFTBitTable;
@@ -222,24 +223,21 @@ void FFT(size_t NumSamples,
 /*
  * Real Fast Fourier Transform
  *
- * This is merely a wrapper of RealFFTf() from RealFFTf.h.
+ * This is merely a wrapper of RealFFTPlan.
  */
 
 void RealFFT(size_t NumSamples, const float *RealIn, float *RealOut, float *ImagOut)
 {
-   auto hFFT = GetFFT(NumSamples);
-   Floats pFFT{ NumSamples };
-   // Copy the data into the processing buffer
-   for(size_t i = 0; i < NumSamples; i++)
-      pFFT[i] = RealIn[i];
+   RealFFTPlan plan{ NumSamples };
+   PffftFloatVector pFFT(RealIn, RealIn + NumSamples);
 
    // Perform the FFT
-   RealFFTf(pFFT.get(), hFFT.get());
+   plan.Forward(pFFT.data());
 
    // Copy the data into the real and imaginary outputs
    for (size_t i = 1; i<(NumSamples / 2); i++) {
-      RealOut[i]=pFFT[hFFT->BitReversed[i]  ];
-      ImagOut[i]=pFFT[hFFT->BitReversed[i]+1];
+      RealOut[i]=pFFT[2*i  ];
+      ImagOut[i]=pFFT[2*i+1];
    }
    // Handle the (real-only) DC and Fs/2 bins
    RealOut[0] = pFFT[0];
@@ -261,13 +259,13 @@ void RealFFT(size_t NumSamples, const float *RealIn, float *RealOut, float *Imag
  * Only the first half of RealIn and ImagIn are used due to this
  * symmetry assumption.
  *
- * This is merely a wrapper of InverseRealFFTf() from RealFFTf.h.
+ * This is merely a wrapper of RealFFTPlan.
  */
 void InverseRealFFT(size_t NumSamples, const float *RealIn, const float *ImagIn,
 		    float *RealOut)
 {
-   auto hFFT = GetFFT(NumSamples);
-   Floats pFFT{ NumSamples };
+   RealFFTPlan plan{ NumSamples };
+   PffftFloatVector pFFT(NumSamples);
    // Copy the data into the processing buffer
    for (size_t i = 0; i < (NumSamples / 2); i++)
       pFFT[2*i  ] = RealIn[i];
@@ -282,16 +280,16 @@ void InverseRealFFT(size_t NumSamples, const float *RealIn, const float *ImagIn,
    pFFT[1] = RealIn[NumSamples / 2];
 
    // Perform the FFT
-   InverseRealFFTf(pFFT.get(), hFFT.get());
+   plan.Inverse(pFFT.data());
 
    // Copy the data to the (purely real) output buffer
-   ReorderToTime(hFFT.get(), pFFT.get(), RealOut);
+   std::copy(pFFT.begin(), pFFT.end(), RealOut);
 }
 
 /*
  * PowerSpectrum
  *
- * This function uses RealFFTf() from RealFFTf.h to perform the real
+ * This function uses RealFFTPlan to perform the real
  * FFT computation, and then squares the real and imaginary part of
  * each coefficient, extracting the power and throwing away the phase.
  *
@@ -301,19 +299,15 @@ void InverseRealFFT(size_t NumSamples, const float *RealIn, const float *ImagIn,
 
 void PowerSpectrum(size_t NumSamples, const float *In, float *Out)
 {
-   auto hFFT = GetFFT(NumSamples);
-   Floats pFFT{ NumSamples };
-   // Copy the data into the processing buffer
-   for (size_t i = 0; i<NumSamples; i++)
-      pFFT[i] = In[i];
+   RealFFTPlan plan{ NumSamples };
+   PffftFloatVector pFFT(In, In + NumSamples);
 
    // Perform the FFT
-   RealFFTf(pFFT.get(), hFFT.get());
+   plan.Forward(pFFT.data());
 
    // Copy the data into the real and imaginary outputs
    for (size_t i = 1; i<NumSamples / 2; i++) {
-      Out[i]= (pFFT[hFFT->BitReversed[i]  ]*pFFT[hFFT->BitReversed[i]  ])
-         + (pFFT[hFFT->BitReversed[i]+1]*pFFT[hFFT->BitReversed[i]+1]);
+      Out[i]= (pFFT[2*i  ]*pFFT[2*i  ]) + (pFFT[2*i+1]*pFFT[2*i+1]);
    }
    // Handle the (real-only) DC and Fs/2 bins
    Out[0] = pFFT[0]*pFFT[0];
@@ -0,0 +1,100 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  PartitionedConvolver.cpp
+
+**********************************************************************/
+#include "PartitionedConvolver.h"
+
+#include <algorithm>
+
+namespace {
+//! Add the product of spectra in the layout of RealFFTPlan to `sum`
+void MultiplyAdd(float *sum, const float *x, const float *h, size_t size)
+{
+   // DC and Nyquist bins are real
+   sum[0] += x[0] * h[0];
+   sum[1] += x[1] * h[1];
+   for (size_t i = 2; i < size; i += 2) {
+      sum[i] += x[i] * h[i] - x[i + 1] * h[i + 1];
+      sum[i + 1] += x[i] * h[i + 1] + x[i + 1] * h[i];
+   }
+}
+}
+
+PartitionedConvolver::PartitionedConvolver(
+   const float *response, size_t responseLen, size_t blockSize
+)  : mBlockSize{ blockSize }
+   , mFFT{ 2 * blockSize }
+   , mWindow(2 * blockSize)
+   , mSum(2 * blockSize)
+   , mOutput(blockSize)
+{
+   const auto fftSize = 2 * mBlockSize;
+   const auto nPartitions =
+      std::max<size_t>(1, (responseLen + mBlockSize - 1) / mBlockSize);
+   mResponse.reserve(nPartitions);
+   for (size_t ii = 0; ii < nPartitions; ++ii) {
+      // Zero-pad each partition to the transform size
+      auto &spectrum = mResponse.emplace_back(fftSize);
+      const auto begin = std::min(responseLen, ii * mBlockSize);
+      const auto end = std::min(responseLen, begin + mBlockSize);
+      std::copy(response + begin, response + end, spectrum.data());
+      mFFT.Forward(spectrum.data());
+   }
+   mInputs.resize(nPartitions, PffftFloatVector(fftSize));
+}
+
+PartitionedConvolver::~PartitionedConvolver() = default;
+
+void PartitionedConvolver::Process(const float *in, float *out, size_t len)
+{
+   while (len > 0) {
+      const auto count = std::min(len, mBlockSize - mPosition);
+      // Take the input before overwriting it, if in place
+      std::copy(in, in + count, mWindow.data() + mBlockSize + mPosition);
+      std::copy_n(mOutput.data() + mPosition, count, out);
+      in += count;
+      out += count;
+      len -= count;
+      if ((mPosition += count) == mBlockSize) {
+         ProcessBlock();
+         mPosition = 0;
+      }
+   }
+}
+
+void PartitionedConvolver::Reset()
+{
+   for (auto &spectrum : mInputs)
+      std::fill(spectrum.begin(), spectrum.end(), 0.0f);
+   std::fill(mWindow.begin(), mWindow.end(), 0.0f);
+   std::fill(mOutput.begin(), mOutput.end(), 0.0f);
+   mNewest = 0;
+   mPosition = 0;
+}
+
+void PartitionedConvolver::ProcessBlock()
+{
+   const auto fftSize = 2 * mBlockSize;
+   const auto nPartitions = mResponse.size();
+
+   // Replace the oldest spectrum with that of the window
+   mNewest = (mNewest + nPartitions - 1) % nPartitions;
+   auto &newest = mInputs[mNewest];
+   std::copy(mWindow.begin(), mWindow.end(), newest.begin());
+   mFFT.Forward(newest.data());
+
+   std::fill(mSum.begin(), mSum.end(), 0.0f);
+   for (size_t ii = 0; ii < nPartitions; ++ii)
+      MultiplyAdd(mSum.data(),
+         mInputs[(mNewest + ii) % nPartitions].data(), mResponse[ii].data(),
+         fftSize);
+   mFFT.Inverse(mSum.data());
+
+   // Overlap-save:  the first half is wrapped around, the second is valid
+   std::copy(mSum.begin() + mBlockSize, mSum.end(), mOutput.begin());
+   std::copy(mWindow.begin() + mBlockSize, mWindow.end(), mWindow.begin());
+}
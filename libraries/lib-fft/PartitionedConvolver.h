@@ -0,0 +1,63 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  PartitionedConvolver.h
+
+**********************************************************************/
+#pragma once
+
+#include "RealFFTPlan.h"
+
+#include <vector>
+
+//! Convolution with a long impulse response by uniformly partitioned fast
+//! convolution
+/*!
+ The response is cut into partitions of the block size, whose spectra are
+ computed once.  Each block of input is transformed once, by overlap-save with
+ transforms of twice the block size, into a delay line of spectra; each block
+ of output is one inverse transform of the sum of the products of the delay
+ line and the partitions.  So the latency is one block, however long the
+ response.
+
+ Process() takes any numbers of samples at a time; the output lags the input
+ by exactly BlockSize() samples.
+ */
+class FFT_API PartitionedConvolver final
+{
+public:
+   //! @pre `blockSize` is a power of two, at least 2
+   PartitionedConvolver(
+      const float *response, size_t responseLen, size_t blockSize);
+   PartitionedConvolver(const PartitionedConvolver&) = delete;
+   PartitionedConvolver &operator=(const PartitionedConvolver&) = delete;
+   ~PartitionedConvolver();
+
+   size_t BlockSize() const { return mBlockSize; }
+   size_t Partitions() const { return mResponse.size(); }
+
+   //! Convolve `len` samples, which may be in place
+   void Process(const float *in, float *out, size_t len);
+
+   //! Forget all input, as if newly constructed
+   void Reset();
+
+private:
+   void ProcessBlock();
+
+   const size_t mBlockSize;
+   RealFFTPlan mFFT;
+   //! Spectra of the partitions of the response
+   std::vector<PffftFloatVector> mResponse;
+   //! Spectra of the latest input blocks, newest at mNewest, older after it
+   std::vector<PffftFloatVector> mInputs;
+   size_t mNewest{ 0 };
+   //! The previous and current blocks of input
+   PffftFloatVector mWindow;
+   PffftFloatVector mSum;
+   //! Output for the samples of the current input block
+   std::vector<float> mOutput;
+   size_t mPosition{ 0 };
+};
@@ -0,0 +1,145 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  RealFFTPlan.cpp
+
+**********************************************************************/
+#include "RealFFTPlan.h"
+#include "RealFFTf.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <pffft.h>
+
+struct RealFFTPlan::Tables
+{
+   //! Null when pffft can't transform the size
+   PffftSetupHolder setup;
+   //! Null when pffft can
+   HFFT hFFT;
+};
+
+namespace {
+//! pffft demands this alignment of buffers for SSE, NEON and Altivec
+constexpr uintptr_t PffftAlignmentMask = 0xF;
+
+bool IsAligned(const float *buffer)
+{
+   return (reinterpret_cast<uintptr_t>(buffer) & PffftAlignmentMask) == 0;
+}
+
+std::shared_ptr<const RealFFTPlan::Tables> GetTables(size_t size)
+{
+   // Tables are kept for the rest of the session, like the pool of GetFFT;
+   // the few sizes in use are requested again and again
+   static std::mutex mutex;
+   static std::map<size_t, std::shared_ptr<const RealFFTPlan::Tables>> cache;
+
+   std::lock_guard<std::mutex> locker{ mutex };
+   auto &pTables = cache[size];
+   if (!pTables) {
+      auto pNew = std::make_shared<RealFFTPlan::Tables>();
+      if (RealFFTPlan::IsPffftSize(size))
+         pNew->setup.reset(pffft_new_setup(size, PFFFT_REAL));
+      if (!pNew->setup)
+         pNew->hFFT = GetFFT(size);
+      pTables = move(pNew);
+   }
+   return pTables;
+}
+}
+
+bool RealFFTPlan::IsPffftSize(size_t size)
+{
+   // pffft_new_setup asserts, rather than returning null, for sizes that
+   // are not multiples of the minimum
+   const size_t minimum = pffft_min_fft_size(PFFFT_REAL);
+   return size >= minimum && size % minimum == 0;
+}
+
+RealFFTPlan::RealFFTPlan(size_t size)
+   : mSize{ size }
+   , mpTables{ GetTables(size) }
+   , mWork(mpTables->setup ? size : 0)
+   , mScratch(size)
+{
+   assert(size >= 4 && (size & (size - 1)) == 0);
+}
+
+RealFFTPlan::~RealFFTPlan() = default;
+
+bool RealFFTPlan::UsesPffft() const
+{
+   return mpTables->setup != nullptr;
+}
+
+void RealFFTPlan::Forward(float *buffer)
+{
+   const auto setup = mpTables->setup.get();
+   if (!setup) {
+      ForwardFallback(buffer);
+      return;
+   }
+   if (IsAligned(buffer))
+      pffft_transform_ordered(
+         setup, buffer, buffer, mWork.data(), PFFFT_FORWARD);
+   else {
+      const auto scratch = mScratch.data();
+      std::copy(buffer, buffer + mSize, scratch);
+      pffft_transform_ordered(
+         setup, scratch, scratch, mWork.data(), PFFFT_FORWARD);
+      std::copy(scratch, scratch + mSize, buffer);
+   }
+}
+
+void RealFFTPlan::Inverse(float *buffer)
+{
+   const auto setup = mpTables->setup.get();
+   if (!setup) {
+      InverseFallback(buffer);
+      return;
+   }
+   const auto scale = 1.0f / mSize;
+   if (IsAligned(buffer)) {
+      pffft_transform_ordered(
+         setup, buffer, buffer, mWork.data(), PFFFT_BACKWARD);
+      std::transform(buffer, buffer + mSize, buffer,
+         [scale](float value){ return value * scale; });
+   }
+   else {
+      const auto scratch = mScratch.data();
+      std::copy(buffer, buffer + mSize, scratch);
+      pffft_transform_ordered(
+         setup, scratch, scratch, mWork.data(), PFFFT_BACKWARD);
+      std::transform(scratch, scratch + mSize, buffer,
+         [scale](float value){ return value * scale; });
+   }
+}
+
+void RealFFTPlan::ForwardFallback(float *buffer)
+{
+   const auto hFFT = mpTables->hFFT.get();
+   RealFFTf(buffer, hFFT);
+   // Undo the bit reversal; DC and Fs/2 are already in place
+   const auto scratch = mScratch.data();
+   std::copy(buffer, buffer + mSize, scratch);
+   for (size_t i = 1; i < hFFT->Points; ++i) {
+      const auto index = hFFT->BitReversed[i];
+      buffer[2 * i] = scratch[index];
+      buffer[2 * i + 1] = scratch[index + 1];
+   }
+}
+
+void RealFFTPlan::InverseFallback(float *buffer)
+{
+   const auto hFFT = mpTables->hFFT.get();
+   InverseRealFFTf(buffer, hFFT);
+   const auto scratch = mScratch.data();
+   ReorderToTime(hFFT, buffer, scratch);
+   std::copy(scratch, scratch + mSize, buffer);
+}
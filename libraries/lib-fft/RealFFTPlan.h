@@ -0,0 +1,64 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  RealFFTPlan.h
+
+**********************************************************************/
+#pragma once
+
+#include "PowerSpectrumGetter.h"
+
+#include <memory>
+
+//! Transforms of real sequences of one power-of-two length, by pffft when it
+//! supports the length, else by RealFFTf
+/*!
+ Tables for each length are computed once and shared by all plans of that
+ length, in all threads.  Each plan has its own work space, so it is cheap to
+ make one per thread, but one plan must not be used by two threads at once.
+
+ The spectrum is ordered, not bit-reversed as RealFFTf leaves it:
+ the real parts of the DC and Nyquist bins in the first two places, then the
+ real and imaginary parts of the bins from 1 to `Size() / 2 - 1`.  That is
+ also the input layout that InverseRealFFTf expects.
+
+ The forward transform is not normalized, like RealFFTf; the inverse divides
+ by `Size()`, so that it undoes the forward transform, like InverseRealFFTf.
+
+ Buffers of PffftFloatVector avoid a copy, which pffft needs if they are not
+ aligned to 16 bytes.
+ */
+class FFT_API RealFFTPlan final
+{
+public:
+   //! @pre `size` is a power of two, at least 4
+   explicit RealFFTPlan(size_t size);
+   RealFFTPlan(const RealFFTPlan&) = delete;
+   RealFFTPlan &operator=(const RealFFTPlan&) = delete;
+   ~RealFFTPlan();
+
+   size_t Size() const { return mSize; }
+
+   //! Whether transforms are computed by pffft rather than RealFFTf
+   bool UsesPffft() const;
+
+   //! Replace `Size()` samples with their spectrum
+   void Forward(float *buffer);
+   //! Replace a spectrum of `Size()` values with its samples
+   void Inverse(float *buffer);
+
+   //! @return whether pffft computes transforms of this size
+   static bool IsPffftSize(size_t size);
+
+   struct Tables;
+private:
+   void ForwardFallback(float *buffer);
+   void InverseFallback(float *buffer);
+
+   const size_t mSize;
+   const std::shared_ptr<const Tables> mpTables;
+   PffftFloatVector mWork;
+   PffftFloatVector mScratch;
+};
@@ -0,0 +1,74 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  PartitionedConvolverTest.cpp
+
+**********************************************************************/
+#include "PartitionedConvolver.h"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace
+{
+std::vector<float> RandomSamples(size_t size, unsigned seed)
+{
+   std::mt19937 engine { seed };
+   std::uniform_real_distribution<float> dist { -1.f, 1.f };
+   std::vector<float> result(size);
+   for (auto& value : result)
+      value = dist(engine);
+   return result;
+}
+} // namespace
+
+TEST_CASE("PartitionedConvolver")
+{
+   const size_t blockSize = GENERATE(2, 64, 256);
+   const size_t responseLen = GENERATE(1, 100, 1000);
+   const auto response = RandomSamples(responseLen, 1);
+   const auto input = RandomSamples(3000, 2);
+
+   PartitionedConvolver convolver { response.data(), responseLen, blockSize };
+   REQUIRE(
+      convolver.Partitions() == (responseLen + blockSize - 1) / blockSize);
+
+   // Feed chunks of varying lengths, in place
+   auto output = input;
+   std::mt19937 engine { 3 };
+   std::uniform_int_distribution<size_t> chunkLen { 1, 700 };
+   for (size_t pos = 0; pos < output.size();)
+   {
+      const auto count = std::min(chunkLen(engine), output.size() - pos);
+      convolver.Process(output.data() + pos, output.data() + pos, count);
+      pos += count;
+   }
+
+   // Output lags the direct convolution by the block size
+   const auto margin = 1e-5 * responseLen;
+   for (size_t i = 0; i < output.size(); ++i)
+   {
+      double expected = 0;
+      if (i >= blockSize)
+      {
+         const auto n = i - blockSize;
+         for (size_t j = 0; j < responseLen && j <= n; ++j)
+            expected += double(response[j]) * input[n - j];
+      }
+      REQUIRE(output[i] == Approx(expected).margin(margin));
+   }
+
+   SECTION("Reset forgets the input")
+   {
+      convolver.Reset();
+      std::vector<float> silence(2 * blockSize + responseLen);
+      convolver.Process(silence.data(), silence.data(), silence.size());
+      REQUIRE(std::all_of(silence.begin(), silence.end(),
+         [](float value) { return value == 0.0f; }));
+   }
+}
@@ -0,0 +1,64 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  RealFFTPlanBenchmark.cpp
+
+  Time per forward transform of RealFFTf and of RealFFTPlan, for the sizes
+  of spectrograms and effects, printed so that regressions show up in the
+  test log.
+
+**********************************************************************/
+#include "RealFFTPlan.h"
+#include "RealFFTf.h"
+
+#include <catch2/catch.hpp>
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+
+namespace
+{
+// About as many samples as a long spectrogram, for each size
+constexpr size_t SamplesPerSize = 1 << 22;
+
+template <typename F> double NanosecondsPerTransform(size_t size, F f)
+{
+   using namespace std::chrono;
+   const auto repetitions = SamplesPerSize / size;
+   // Warm up caches
+   f();
+   const auto start = steady_clock::now();
+   for (size_t ii = 0; ii < repetitions; ++ii)
+      f();
+   const auto seconds = duration<double>(steady_clock::now() - start).count();
+   return seconds / repetitions * 1e9;
+}
+} // namespace
+
+TEST_CASE("RealFFTPlanBenchmark")
+{
+   for (size_t size = 256; size <= 65536; size *= 2)
+   {
+      PffftFloatVector buffer(size);
+      for (size_t ii = 0; ii < size; ++ii)
+         buffer[ii] = float(ii % 100) / 50 - 1;
+
+      const auto hFFT = GetFFT(size);
+      const auto legacy = NanosecondsPerTransform(
+         size, [&] { RealFFTf(buffer.data(), hFFT.get()); });
+
+      RealFFTPlan plan { size };
+      const auto planned =
+         NanosecondsPerTransform(size, [&] { plan.Forward(buffer.data()); });
+
+      std::cout << std::setw(6) << size << std::fixed << std::setprecision(0)
+                << std::setw(10) << legacy << " ns RealFFTf" << std::setw(10)
+                << planned << " ns " << (plan.UsesPffft() ? "pffft" : "RealFFTf")
+                << std::setprecision(2) << std::setw(8) << legacy / planned
+                << "x\n";
+      REQUIRE(planned > 0);
+   }
+}
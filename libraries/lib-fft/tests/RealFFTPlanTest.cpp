@@ -0,0 +1,79 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  RealFFTPlanTest.cpp
+
+**********************************************************************/
+#include "RealFFTPlan.h"
+#include "RealFFTf.h"
+
+#include <catch2/catch.hpp>
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace
+{
+std::vector<float> RandomSamples(size_t size)
+{
+   std::mt19937 engine { 1 };
+   std::uniform_real_distribution<float> dist { -1.f, 1.f };
+   std::vector<float> result(size);
+   for (auto& value : result)
+      value = dist(engine);
+   return result;
+}
+} // namespace
+
+TEST_CASE("RealFFTPlan")
+{
+   // Sizes below the pffft minimum fall back to RealFFTf
+   const size_t size = GENERATE(4, 8, 16, 32, 256, 4096);
+   const auto samples = RandomSamples(size);
+   RealFFTPlan plan { size };
+   REQUIRE(plan.UsesPffft() == RealFFTPlan::IsPffftSize(size));
+   // Margins grow with the sum of size terms of magnitude up to 1
+   const auto margin = 1e-6 * size;
+
+   SECTION("Forward agrees with RealFFTf, reordered")
+   {
+      auto expected = samples;
+      const auto hFFT = GetFFT(size);
+      RealFFTf(expected.data(), hFFT.get());
+
+      auto actual = samples;
+      plan.Forward(actual.data());
+      REQUIRE(actual[0] == Approx(expected[0]).margin(margin));
+      REQUIRE(actual[1] == Approx(expected[1]).margin(margin));
+      for (size_t i = 1; i < size / 2; ++i)
+      {
+         const auto index = hFFT->BitReversed[i];
+         REQUIRE(actual[2 * i] == Approx(expected[index]).margin(margin));
+         REQUIRE(
+            actual[2 * i + 1] == Approx(expected[index + 1]).margin(margin));
+      }
+   }
+
+   SECTION("Inverse undoes Forward")
+   {
+      auto actual = samples;
+      plan.Forward(actual.data());
+      plan.Inverse(actual.data());
+      for (size_t i = 0; i < size; ++i)
+         REQUIRE(actual[i] == Approx(samples[i]).margin(1e-5));
+   }
+
+   SECTION("Unaligned buffers give the same results")
+   {
+      PffftFloatVector aligned(samples.begin(), samples.end());
+      std::vector<float> unaligned(size + 1);
+      std::copy(samples.begin(), samples.end(), unaligned.begin() + 1);
+      plan.Forward(aligned.data());
+      plan.Forward(unaligned.data() + 1);
+      for (size_t i = 0; i < size; ++i)
+         REQUIRE(unaligned[i + 1] == aligned[i]);
+   }
+}
@@ -0,0 +1,282 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file MappedPCMReader.cpp
+
+**********************************************************************/
+
+#include "MappedPCMReader.h"
+
+#include <wx/string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <cstdint>
+#include <cstring>
+
+namespace {
+
+uint32_t LittleEndian32(const unsigned char *p)
+{
+   return p[0] | (p[1] << 8) | (p[2] << 16) | (uint32_t(p[3]) << 24);
+}
+
+uint32_t BigEndian32(const unsigned char *p)
+{
+   return (uint32_t(p[0]) << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+}
+
+//! @return offset of the samples of a RIFF WAV file, or -1
+sf_count_t FindWavData(const unsigned char *data, size_t size)
+{
+   if (size < 12 || memcmp(data, "RIFF", 4) || memcmp(data + 8, "WAVE", 4))
+      return -1;
+   size_t pos = 12;
+   while (pos + 8 <= size) {
+      const auto length = LittleEndian32(data + pos + 4);
+      if (!memcmp(data + pos, "data", 4))
+         return pos + 8;
+      // Chunks are padded to even lengths
+      pos += 8 + size_t(length) + (length & 1);
+   }
+   return -1;
+}
+
+//! @return offset of the samples of an AIFF or AIFF-C file, or -1
+sf_count_t FindAiffData(const unsigned char *data, size_t size)
+{
+   if (size < 12 || memcmp(data, "FORM", 4) ||
+       (memcmp(data + 8, "AIFF", 4) && memcmp(data + 8, "AIFC", 4)))
+      return -1;
+   size_t pos = 12;
+   while (pos + 8 <= size) {
+      const auto length = BigEndian32(data + pos + 4);
+      if (!memcmp(data + pos, "SSND", 4)) {
+         if (pos + 16 > size)
+            return -1;
+         // Skip the offset and block size fields, then the offset
+         return pos + 16 + BigEndian32(data + pos + 8);
+      }
+      pos += 8 + size_t(length) + (length & 1);
+   }
+   return -1;
+}
+
+bool HostIsLittleEndian()
+{
+   const uint16_t one = 1;
+   unsigned char byte;
+   memcpy(&byte, &one, 1);
+   return byte == 1;
+}
+
+}
+
+class MappedPCMReader::Impl final
+{
+public:
+   const unsigned char *mData{ nullptr };
+   size_t mSize{ 0 };
+#ifdef _WIN32
+   HANDLE mMapping{ nullptr };
+#endif
+
+   const unsigned char *mFrames{ nullptr };
+   int mSubtype{ 0 };
+   sampleFormat mFormat{ floatSample };
+   size_t mChannels{ 0 };
+   size_t mBytesPerSample{ 0 };
+   bool mSwap{ false };
+   bool mLittleEndian{ false };
+
+   ~Impl()
+   {
+#ifdef _WIN32
+      if (mData != nullptr)
+         UnmapViewOfFile(mData);
+      if (mMapping != nullptr)
+         CloseHandle(mMapping);
+#else
+      if (mData != nullptr)
+         munmap(const_cast<unsigned char *>(mData), mSize);
+#endif
+   }
+
+   bool Map(const wxString &path)
+   {
+#ifdef _WIN32
+      const auto file = CreateFileW(path.wc_str(), GENERIC_READ,
+         FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+         FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+      if (file == INVALID_HANDLE_VALUE)
+         return false;
+      LARGE_INTEGER size;
+      if (!GetFileSizeEx(file, &size) || size.QuadPart <= 0 ||
+          static_cast<unsigned long long>(size.QuadPart) > SIZE_MAX) {
+         CloseHandle(file);
+         return false;
+      }
+      mSize = static_cast<size_t>(size.QuadPart);
+      mMapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+      //mapping stays valid after the file handle is closed
+      CloseHandle(file);
+      if (mMapping == nullptr)
+         return false;
+      mData = static_cast<const unsigned char *>(
+         MapViewOfFile(mMapping, FILE_MAP_READ, 0, 0, 0));
+      return mData != nullptr;
+#else
+      const auto fd = open(path.fn_str(), O_RDONLY);
+      if (fd == -1)
+         return false;
+      struct stat st;
+      if (fstat(fd, &st) == -1 || st.st_size <= 0 ||
+          static_cast<unsigned long long>(st.st_size) > SIZE_MAX) {
+         close(fd);
+         return false;
+      }
+      mSize = static_cast<size_t>(st.st_size);
+      auto data = mmap(nullptr, mSize, PROT_READ, MAP_PRIVATE, fd, 0);
+      //mapping stays valid after the descriptor is closed
+      close(fd);
+      if (data == MAP_FAILED)
+         return false;
+      // Importing reads once from start to end
+      madvise(data, mSize, MADV_SEQUENTIAL);
+      mData = static_cast<const unsigned char *>(data);
+      return true;
+#endif
+   }
+
+   float ToFloat(const unsigned char *p) const
+   {
+      switch (mSubtype) {
+      case SF_FORMAT_PCM_16: {
+         int16_t value;
+         memcpy(&value, p, sizeof value);
+         if (mSwap)
+            value = int16_t(uint16_t(value) >> 8 | uint16_t(value) << 8);
+         return value / float(1 << 15);
+      }
+      case SF_FORMAT_PCM_24: {
+         const auto value = mLittleEndian
+            ? p[0] | (p[1] << 8) | (uint32_t(p[2]) << 16)
+            : (uint32_t(p[0]) << 16) | (p[1] << 8) | p[2];
+         // Extend the sign
+         return int32_t(value << 8) / float(1u << 31);
+      }
+      case SF_FORMAT_PCM_32: {
+         const auto value = mLittleEndian ? LittleEndian32(p) : BigEndian32(p);
+         return float(int32_t(value)) / float(1u << 31);
+      }
+      default: {
+         auto value = mLittleEndian ? LittleEndian32(p) : BigEndian32(p);
+         float result;
+         memcpy(&result, &value, sizeof result);
+         return result;
+      }
+      }
+   }
+};
+
+MappedPCMReader::MappedPCMReader(std::unique_ptr<Impl> impl)
+   : mImpl(std::move(impl))
+{
+}
+
+std::unique_ptr<MappedPCMReader> MappedPCMReader::Open(const wxString &path,
+   SNDFILE *file, const SF_INFO &info, sampleFormat format,
+   sf_count_t dataOffset)
+{
+   const auto subtype = info.format & SF_FORMAT_SUBMASK;
+   const auto type = info.format & SF_FORMAT_TYPEMASK;
+   size_t bytesPerSample = 0;
+   switch (subtype) {
+   case SF_FORMAT_PCM_16: bytesPerSample = 2; break;
+   case SF_FORMAT_PCM_24: bytesPerSample = 3; break;
+   case SF_FORMAT_PCM_32: bytesPerSample = 4; break;
+   case SF_FORMAT_FLOAT: bytesPerSample = 4; break;
+   default: return {};
+   }
+   if (format == int16Sample ? subtype != SF_FORMAT_PCM_16
+       : format != floatSample)
+      return {};
+   const bool wav = type == SF_FORMAT_WAV || type == SF_FORMAT_WAVEX;
+   if (info.channels < 1 || info.frames < 0 ||
+       (dataOffset < 0 && !wav && type != SF_FORMAT_AIFF))
+      return {};
+
+   auto impl = std::make_unique<Impl>();
+   if (!impl->Map(path))
+      return {};
+   if (dataOffset < 0)
+      dataOffset = wav
+         ? FindWavData(impl->mData, impl->mSize)
+         : FindAiffData(impl->mData, impl->mSize);
+   const auto frameSize = bytesPerSample * info.channels;
+   if (dataOffset < 0 || static_cast<size_t>(dataOffset) > impl->mSize ||
+       static_cast<unsigned long long>(info.frames) >
+          (impl->mSize - dataOffset) / frameSize)
+      return {};
+
+   impl->mFrames = impl->mData + dataOffset;
+   impl->mSubtype = subtype;
+   impl->mFormat = format;
+   impl->mChannels = info.channels;
+   impl->mBytesPerSample = bytesPerSample;
+   // The same byte order as sf_read_raw() would give
+   impl->mSwap = sf_command(file, SFC_RAW_DATA_NEEDS_ENDSWAP, nullptr, 0)
+      == SF_TRUE;
+   impl->mLittleEndian = HostIsLittleEndian() != impl->mSwap;
+   return std::unique_ptr<MappedPCMReader>(
+      new MappedPCMReader(std::move(impl)));
+}
+
+MappedPCMReader::~MappedPCMReader() = default;
+
+constSamplePtr MappedPCMReader::Read(sf_count_t start, size_t len,
+   size_t channel, samplePtr buffer, size_t &stride) const
+{
+   const auto &impl = *mImpl;
+   const auto frameSize = impl.mBytesPerSample * impl.mChannels;
+   const auto p =
+      impl.mFrames + start * frameSize + channel * impl.mBytesPerSample;
+
+   // Samples already in the wanted format and byte order, and aligned, are
+   // copied once only, by the caller
+   const bool inPlace = !impl.mSwap &&
+      (impl.mFormat == int16Sample
+         ? impl.mSubtype == SF_FORMAT_PCM_16
+         : impl.mSubtype == SF_FORMAT_FLOAT) &&
+      reinterpret_cast<uintptr_t>(p) % impl.mBytesPerSample == 0;
+   if (inPlace) {
+      stride = impl.mChannels;
+      return reinterpret_cast<constSamplePtr>(p);
+   }
+
+   stride = 1;
+   if (impl.mFormat == int16Sample) {
+      const auto dst = reinterpret_cast<short *>(buffer);
+      for (size_t ii = 0; ii < len; ++ii) {
+         uint16_t value;
+         memcpy(&value, p + ii * frameSize, sizeof value);
+         if (impl.mSwap)
+            value = uint16_t(value >> 8 | value << 8);
+         dst[ii] = short(value);
+      }
+   }
+   else {
+      const auto dst = reinterpret_cast<float *>(buffer);
+      for (size_t ii = 0; ii < len; ++ii)
+         dst[ii] = impl.ToFloat(p + ii * frameSize);
+   }
+   return buffer;
+}
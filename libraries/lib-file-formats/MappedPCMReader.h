@@ -0,0 +1,60 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file MappedPCMReader.h
+  @brief Reads uncompressed samples directly from a memory mapping of the
+  file, bypassing the buffered reads of libsndfile
+
+**********************************************************************/
+
+#ifndef __AUDACITY_MAPPED_PCM_READER__
+#define __AUDACITY_MAPPED_PCM_READER__
+
+#include "SampleFormat.h"
+
+#include <memory>
+#include <sndfile.h>
+
+class wxString;
+
+//! Reads the sample data of a file that libsndfile has opened, from a
+//! memory mapping
+/*!
+ Supports 16, 24 and 32 bit integer and 32 bit float encodings, in WAV and
+ AIFF files, or in raw files at a known offset.  Samples are the same as
+ sf_readf_short() or sf_readf_float() would give.
+ */
+class FILE_FORMATS_API MappedPCMReader final
+{
+   class Impl;
+   std::unique_ptr<Impl> mImpl;
+
+   explicit MappedPCMReader(std::unique_ptr<Impl> impl);
+public:
+   /*!
+    @param file open for reading the same path, described by info
+    @param format int16Sample or floatSample, for the samples to read
+    @param dataOffset of the first frame, if the file is raw; if negative,
+    found from the WAV or AIFF header
+    @return null if the file or encoding is not supported, or the file can't
+    be mapped; then use libsndfile instead
+    */
+   static std::unique_ptr<MappedPCMReader> Open(const wxString &path,
+      SNDFILE *file, const SF_INFO &info, sampleFormat format,
+      sf_count_t dataOffset = -1);
+
+   ~MappedPCMReader();
+
+   //! Read samples of one channel
+   /*!
+    @param buffer receives len samples, unless they can be read in place
+    @param[out] stride of the samples at the result
+    @return the samples, either in the mapping or in buffer
+    @pre `start + len` is not more than the frames of the file
+    */
+   constSamplePtr Read(sf_count_t start, size_t len, size_t channel,
+      samplePtr buffer, size_t &stride) const;
+};
+
+#endif
@@ -12,6 +12,7 @@
 #include "FrameStatistics.h"
 
 #include <algorithm>
+#include <cmath>
 #include <numeric>
 
 namespace
@@ -63,6 +64,46 @@ size_t FrameStatistics::Section::GetEventsCount() const noexcept
    return mEventsCount;
 }
 
+std::vector<FrameStatistics::Duration>
+FrameStatistics::Section::GetRecentDurations() const
+{
+   std::vector<Duration> result;
+   result.reserve(mHistoryItems);
+   // When the ring is not yet full, the oldest item is at index 0
+   const auto first = (mHistoryIndex + HISTORY_SIZE - mHistoryItems) % HISTORY_SIZE;
+   for (size_t i = 0; i < mHistoryItems; ++i)
+      result.push_back(mHistory[(first + i) % HISTORY_SIZE]);
+   return result;
+}
+
+FrameStatistics::Duration
+FrameStatistics::Section::GetPercentile(double percent) const
+{
+   if (mHistoryItems == 0)
+      return {};
+
+   std::vector<Duration> durations(mHistory, mHistory + mHistoryItems);
+   const auto rank = static_cast<size_t>(
+      std::ceil(std::clamp(percent, 0.0, 100.0) / 100.0 * durations.size()));
+   const auto nth = durations.begin() + (rank > 0 ? rank - 1 : 0);
+   std::nth_element(durations.begin(), nth, durations.end());
+   return *nth;
+}
+
+const std::array<size_t, FrameStatistics::Section::HISTOGRAM_BINS>&
+FrameStatistics::Section::GetHistogram() const noexcept
+{
+   return mHistogram;
+}
+
+FrameStatistics::Duration
+FrameStatistics::Section::GetHistogramBinStart(size_t bin) noexcept
+{
+   return bin == 0 ? Duration {} :
+      std::chrono::duration_cast<Duration>(
+         std::chrono::microseconds { 1ll << std::min(bin, HISTOGRAM_BINS - 1) });
+}
+
 void FrameStatistics::Section::AddEvent(Duration duration) noexcept
 {
    ++mEventsCount;
@@ -79,6 +120,18 @@ void FrameStatistics::Section::AddEvent(Duration duration) noexcept
 
    mNextIndex = (mNextIndex + 1) % KERNEL_SIZE;
 
+   mHistory[mHistoryIndex] = duration;
+   mHistoryIndex = (mHistoryIndex + 1) % HISTORY_SIZE;
+   if (mHistoryItems < HISTORY_SIZE)
+      ++mHistoryItems;
+
+   const auto mcs =
+      std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+   size_t bin = 0;
+   while (bin + 1 < HISTOGRAM_BINS && (1ll << (bin + 1)) <= mcs)
+      ++bin;
+   ++mHistogram[bin];
+
    if (mKernelItems < KERNEL_SIZE)
       ++mKernelItems;
 
@@ -112,6 +165,38 @@ FrameStatistics::GetSection(SectionID section) noexcept
    return fakeSection;
 }
 
+const char* FrameStatistics::GetSectionName(SectionID section) noexcept
+{
+   switch (section)
+   {
+   case SectionID::TrackPanel:
+      return "TrackPanel";
+   case SectionID::TrackPanelPartial:
+      return "TrackPanelPartial";
+   case SectionID::WaveformView:
+      return "WaveformView";
+   case SectionID::WaveDataCache:
+      return "WaveDataCache";
+   case SectionID::WaveBitmapCachePreprocess:
+      return "WaveBitmapCachePreprocess";
+   case SectionID::WaveBitmapCache:
+      return "WaveBitmapCache";
+   default:
+      return "";
+   }
+}
+
+void FrameStatistics::Reset() noexcept
+{
+   auto& instance = GetInstance();
+
+   for (size_t i = 0; i < size_t(SectionID::Count); ++i)
+   {
+      instance.mSections[i] = {};
+      instance.mUpdatePublisher.Invoke(SectionID(i));
+   }
+}
+
 Observer::Subscription
 FrameStatistics::Subscribe(UpdatePublisher::Callback callback)
 {
@@ -11,9 +11,11 @@
 
 #pragma once
 
+#include <array>
 #include <chrono>
 #include <cstddef>
 #include <functional>
+#include <vector>
 
 #include "Observer.h"
 
@@ -34,6 +36,8 @@ public:
    {
       //! Full repaint time of the TrackPanel
       TrackPanel,
+      //! Time to redraw only the refreshed tracks into the TrackPanel backing
+      TrackPanelPartial,
       //! Time required to draw a single clip
       WaveformView,
       //! Time required to access the data cache
@@ -80,6 +84,23 @@ public:
       Duration GetAverageDuration() const noexcept;
       //! Total number of the events in this section
       size_t   GetEventsCount() const noexcept;
+
+      //! Durations of the last HISTORY_SIZE events at most, oldest first
+      std::vector<Duration> GetRecentDurations() const;
+      //! Nearest rank percentile of the last HISTORY_SIZE events
+      /*! @param percent between 0 and 100
+          @return zero if there were no events */
+      Duration GetPercentile(double percent) const;
+
+      static constexpr size_t HISTOGRAM_BINS = 24;
+      //! Number of all the events in each bin
+      /*! Bin i counts durations from 2^i to 2^(i+1) microseconds, except
+          that the first and last bins are unbounded below and above */
+      const std::array<size_t, HISTOGRAM_BINS> &GetHistogram() const noexcept;
+      //! Least duration counted in a bin, except for the first
+      static Duration GetHistogramBinStart(size_t bin) noexcept;
+
+      static constexpr size_t HISTORY_SIZE = 512;
    private:
       void AddEvent(Duration duration) noexcept;
 
@@ -97,6 +118,13 @@ public:
 
       size_t mEventsCount { 0 };
 
+      // Ring buffer of recent durations
+      Duration mHistory[HISTORY_SIZE] {};
+      size_t mHistoryIndex { 0 };
+      size_t mHistoryItems { 0 };
+
+      std::array<size_t, HISTOGRAM_BINS> mHistogram {};
+
       friend class FrameStatistics;
    };
 
@@ -104,6 +132,10 @@ public:
    static Stopwatch CreateStopwatch(SectionID section) noexcept;
    //! Get the section data
    static const Section& GetSection(SectionID section) noexcept;
+   //! Name of the section, without spaces, for reports
+   static const char* GetSectionName(SectionID section) noexcept;
+   //! Discard the data of all sections, as before a measured test
+   static void Reset() noexcept;
    //! Subscribe to sections update
    static Observer::Subscription Subscribe(UpdatePublisher::Callback callback);
 private:
@@ -15,10 +15,14 @@
 
 #include "Export.h"
 
+#include <exception>
+#include <mutex>
 #include <numeric>
+#include <thread>
 
 #include "BasicUI.h"
 #include "ExportPluginRegistry.h"
+#include "ExportSharedMix.h"
 #include "Mix.h"
 #include "Project.h"
 #include "WaveTrack.h"
@@ -132,6 +136,159 @@ ExportTask ExportTaskBuilder::Build(AudacityProject& project)
       });
 }
 
+namespace {
+//! Gives each export of a shared mix its own progress, and reports the
+//! average
+class SharedExportDelegate final : public ExportProcessorDelegate
+{
+public:
+   struct Progress {
+      explicit Progress(ExportProcessorDelegate &parent, size_t count)
+         : parent{ parent }, fractions(count)
+      {}
+      ExportProcessorDelegate &parent;
+      std::mutex mutex;
+      std::vector<double> fractions;
+   };
+
+   SharedExportDelegate(Progress &progress, size_t index)
+      : mProgress{ progress }, mIndex{ index }
+   {}
+
+   bool IsCancelled() const override { return mProgress.parent.IsCancelled(); }
+   bool IsStopped() const override { return mProgress.parent.IsStopped(); }
+   // The parent describes all of the exports
+   void SetStatusString(const TranslatableString&) override {}
+
+   void OnProgress(double progress) override
+   {
+      std::lock_guard<std::mutex> lock{ mProgress.mutex };
+      auto &fractions = mProgress.fractions;
+      fractions[mIndex] = progress;
+      mProgress.parent.OnProgress(
+         std::accumulate(fractions.begin(), fractions.end(), 0.0) /
+            fractions.size());
+   }
+
+private:
+   Progress &mProgress;
+   const size_t mIndex;
+};
+
+//! Runs the tasks, each on its own thread, and combines their results
+ExportResult RunConcurrently(std::vector<ExportTask>& tasks,
+   const std::vector<std::shared_future<ExportResult>>& results,
+   ExportProcessorDelegate& delegate,
+   const std::function<void(size_t)>& onFinished)
+{
+   const auto count = tasks.size();
+   delegate.SetStatusString(
+      XO("Exporting the audio to %d files").Format(static_cast<int>(count)));
+
+   SharedExportDelegate::Progress progress{ delegate, count };
+   std::vector<SharedExportDelegate> delegates;
+   for (size_t ii = 0; ii < count; ++ii)
+      delegates.emplace_back(progress, ii);
+
+   std::vector<std::thread> threads;
+   for (size_t ii = 0; ii < count; ++ii)
+      threads.emplace_back([&, ii]{
+         // Exceptions are stored in the future
+         tasks[ii](delegates[ii]);
+         if (onFinished)
+            onFinished(ii);
+      });
+   for (auto &thread : threads)
+      thread.join();
+
+   // Report the worst result, or the first exception, after all are done
+   auto result = ExportResult::Success;
+   std::exception_ptr exception;
+   for (auto &future : results) {
+      try {
+         switch (future.get()) {
+         case ExportResult::Error:
+            result = ExportResult::Error;
+            break;
+         case ExportResult::Cancelled:
+            if (result != ExportResult::Error)
+               result = ExportResult::Cancelled;
+            break;
+         case ExportResult::Stopped:
+            if (result == ExportResult::Success)
+               result = ExportResult::Stopped;
+            break;
+         default:
+            break;
+         }
+      }
+      catch (...) {
+         if (!exception)
+            exception = std::current_exception();
+      }
+   }
+   if (exception)
+      std::rethrow_exception(exception);
+   return result;
+}
+
+std::vector<std::shared_future<ExportResult>>
+GetResults(std::vector<ExportTask>& tasks)
+{
+   std::vector<std::shared_future<ExportResult>> results;
+   for (auto &task : tasks)
+      results.push_back(task.get_future().share());
+   return results;
+}
+}
+
+ExportTask ExportTaskBuilder::BuildShared(
+   AudacityProject& project, std::vector<ExportTaskBuilder> builders)
+{
+   if (builders.size() == 1)
+      return builders.front().Build(project);
+   if (builders.empty())
+      return ExportTask([](ExportProcessorDelegate&){ return ExportResult::Cancelled; });
+
+   const auto &first = builders.front();
+   const auto mix = std::make_shared<ExportSharedMix>(
+      TrackList::Get(project), first.mSelectedOnly, first.mT0, first.mT1,
+      first.mMixerSpec ? first.mMixerSpec->GetNumChannels() : first.mNumChannels,
+      first.mSampleRate, first.mMixerSpec);
+
+   // Each processor makes its mixer when initialized
+   const auto tasks = std::make_shared<std::vector<ExportTask>>();
+   for (size_t ii = 0; ii < builders.size(); ++ii) {
+      ExportSharedMix::Scope scope{ *mix, ii };
+      tasks->push_back(builders[ii].Build(project));
+   }
+
+   return ExportTask([mix, tasks, results = GetResults(*tasks)]
+      (ExportProcessorDelegate& delegate)
+   {
+      mix->Start();
+      return RunConcurrently(*tasks, results, delegate, [&](size_t ii){
+         // Don't make the others wait for this one, if it ended early
+         mix->Release(ii);
+      });
+   });
+}
+
+ExportTask MakeConcurrentExportTask(std::vector<ExportTask> tasks,
+   std::vector<std::shared_future<ExportResult>>* pResults)
+{
+   auto results = GetResults(tasks);
+   if (pResults)
+      *pResults = results;
+   return ExportTask([
+      tasks = std::make_shared<std::vector<ExportTask>>(move(tasks)),
+      results = move(results)
+   ](ExportProcessorDelegate& delegate)
+   {
+      return RunConcurrently(*tasks, results, delegate, {});
+   });
+}
+
 void ShowDiskFullExportErrorDialog(const wxFileNameWrapper &fileName)
 {
    BasicUI::ShowErrorDialog( {},
@@ -46,6 +46,16 @@ public:
    ExportTaskBuilder& SetMixerSpec(MixerOptions::Downmix* mixerSpec) noexcept;
    
    ExportTask Build(AudacityProject& project);
+
+   //! Build one task that exports the same audio with each of the builders
+   /*!
+    The builders should agree in range, sample rate, channels and mixer spec;
+    then the tracks are mixed only once, and the exports encode that mix
+    concurrently, each on its own thread.  An export that mixes differently
+    mixes for itself.
+    */
+   static ExportTask BuildShared(
+      AudacityProject& project, std::vector<ExportTaskBuilder> builders);
    
 private:
    wxFileName mFileName;
@@ -61,6 +71,15 @@ private:
    const Tags* mTags{};
 };
 
+//! Make one task that runs the given export tasks concurrently, each on its own thread
+/*!
+ Its result is the worst of theirs; an exception from any of them is rethrown
+ after all have finished.
+ @param pResults if not null, receives the result of each of the tasks, in order
+ */
+IMPORT_EXPORT_API ExportTask MakeConcurrentExportTask(std::vector<ExportTask> tasks,
+   std::vector<std::shared_future<ExportResult>>* pResults = nullptr);
+
 void IMPORT_EXPORT_API ShowExportErrorDialog(const TranslatableString& message,
    const TranslatableString& caption,
    bool allowReporting);
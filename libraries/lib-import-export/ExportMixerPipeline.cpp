@@ -0,0 +1,147 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  ExportMixerPipeline.cpp
+
+**********************************************************************/
+
+#include "ExportMixerPipeline.h"
+
+#include <cstring>
+
+#include "Mix.h"
+#include "Prefs.h"
+#include "Tracing.h"
+
+BoolSetting ExportMixerPipeline::Enabled{ L"/Export/Pipelined", true };
+
+ExportMixerPipeline::ExportMixerPipeline(std::unique_ptr<Mixer> pMixer)
+   : ExportMixerPipeline{ move(pMixer), Enabled.Read() }
+{
+}
+
+ExportMixerPipeline::ExportMixerPipeline(
+   std::unique_ptr<Mixer> pMixer, bool pipelined)
+   : mpMixer{ move(pMixer) }
+   , mNumChannels{ mpMixer->NumChannels() }
+   , mBufferSize{ mpMixer->BufferSize() }
+   , mSampleSize{ size_t(SAMPLE_SIZE(mpMixer->Format())) }
+   , mInterleaved{ mpMixer->IsInterleaved() }
+{
+   if (!pipelined)
+      return;
+   mChunks.resize(QueueDepth);
+   mThread = std::thread{ [this]{ Run(); } };
+}
+
+ExportMixerPipeline::~ExportMixerPipeline()
+{
+   if (mThread.joinable()) {
+      {
+         std::lock_guard<std::mutex> lock{ mMutex };
+         mStop = true;
+      }
+      mConsumed.notify_one();
+      mThread.join();
+   }
+}
+
+void ExportMixerPipeline::Fill(Chunk &chunk)
+{
+   TRACE_SCOPE("Export mix");
+   chunk.frames = mpMixer->Process();
+   chunk.time = mpMixer->MixGetCurrentTime();
+   chunk.data.resize(mNumChannels * mBufferSize * mSampleSize);
+   if (chunk.frames == 0)
+      return;
+   if (mInterleaved)
+      memcpy(chunk.data.data(), mpMixer->GetBuffer(),
+         chunk.frames * mNumChannels * mSampleSize);
+   else
+      for (unsigned channel = 0; channel < mNumChannels; ++channel)
+         memcpy(chunk.data.data() + channel * mBufferSize * mSampleSize,
+            mpMixer->GetBuffer(channel), chunk.frames * mSampleSize);
+}
+
+void ExportMixerPipeline::Run()
+{
+   Tracing::RegisterThread("Export mixer");
+   while (true) {
+      size_t index;
+      {
+         std::unique_lock<std::mutex> lock{ mMutex };
+         mConsumed.wait(lock, [this]{
+            return mStop || mCount < mChunks.size(); });
+         if (mStop)
+            return;
+         index = (mHead + mCount) % mChunks.size();
+      }
+
+      // Mix without the lock; only this thread touches the free slot
+      auto &chunk = mChunks[index];
+      bool finished = false;
+      try {
+         Fill(chunk);
+         finished = (chunk.frames == 0);
+      }
+      catch (...) {
+         std::lock_guard<std::mutex> lock{ mMutex };
+         mException = std::current_exception();
+         finished = true;
+      }
+
+      {
+         std::lock_guard<std::mutex> lock{ mMutex };
+         if (!mException)
+            ++mCount;
+         mFinished = finished;
+      }
+      mProduced.notify_one();
+      if (finished)
+         return;
+   }
+}
+
+size_t ExportMixerPipeline::Process()
+{
+   if (!mThread.joinable()) {
+      Fill(mCurrent);
+      return mCurrent.frames;
+   }
+
+   std::unique_lock<std::mutex> lock{ mMutex };
+   if (mConsuming) {
+      // Give back the chunk from the previous call
+      mConsuming = false;
+      mHead = (mHead + 1) % mChunks.size();
+      --mCount;
+      mConsumed.notify_one();
+   }
+   mProduced.wait(lock, [this]{
+      return mCount > 0 || mFinished; });
+   if (mCount == 0) {
+      if (mException)
+         std::rethrow_exception(mException);
+      return 0;
+   }
+   mConsuming = true;
+   return mChunks[mHead].frames;
+}
+
+constSamplePtr ExportMixerPipeline::GetBuffer() const
+{
+   auto &chunk = mThread.joinable() ? mChunks[mHead] : mCurrent;
+   return chunk.data.data();
+}
+
+constSamplePtr ExportMixerPipeline::GetBuffer(int channel) const
+{
+   return GetBuffer() + channel * mBufferSize * mSampleSize;
+}
+
+double ExportMixerPipeline::MixGetCurrentTime() const
+{
+   auto &chunk = mThread.joinable() ? mChunks[mHead] : mCurrent;
+   return chunk.time;
+}
@@ -0,0 +1,95 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  ExportMixerPipeline.h
+
+**********************************************************************/
+
+#pragma once
+
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "SampleFormat.h"
+
+class BoolSetting;
+class Mixer;
+
+//! Runs a Mixer for export on a worker thread, ahead of the encoder
+/*!
+ Mixing, with conversion to the output format, then overlaps encoding in the
+ calling thread.  Mixed chunks pass through a bounded queue, so memory use
+ does not depend on the length of the export.
+
+ Presents the part of the interface of Mixer that export plug-ins use.  When
+ not pipelined, calls pass through to the mixer in the calling thread.
+ */
+class IMPORT_EXPORT_API ExportMixerPipeline final
+{
+public:
+   //! Whether exports pipeline their mixing; default true
+   static BoolSetting Enabled;
+
+   //! How many chunks the mixer may run ahead of the encoder
+   static constexpr size_t QueueDepth = 4;
+
+   //! Pipelined as the preference directs
+   explicit ExportMixerPipeline(std::unique_ptr<Mixer> pMixer);
+   ExportMixerPipeline(std::unique_ptr<Mixer> pMixer, bool pipelined);
+   ExportMixerPipeline(const ExportMixerPipeline&) = delete;
+   ExportMixerPipeline &operator=(const ExportMixerPipeline&) = delete;
+   //! Stops mixing, if the export ends early
+   ~ExportMixerPipeline();
+
+   //! Wait for the next mixed chunk, which replaces the previous one
+   /*!
+    @return the number of frames, or 0 at the end
+    @throws whatever the mixer threw while making the chunk
+    */
+   size_t Process();
+
+   //! Retrieve the main buffer or the interleaved buffer of the last chunk
+   constSamplePtr GetBuffer() const;
+
+   //! Retrieve one of the non-interleaved buffers of the last chunk
+   constSamplePtr GetBuffer(int channel) const;
+
+   //! Mixer time at the end of the last chunk, for progress indication
+   double MixGetCurrentTime() const;
+
+private:
+   struct Chunk {
+      std::vector<char> data;
+      size_t frames{};
+      double time{};
+   };
+
+   void Fill(Chunk &chunk);
+   void Run();
+
+   const std::unique_ptr<Mixer> mpMixer;
+   const unsigned mNumChannels;
+   const size_t mBufferSize;
+   const size_t mSampleSize;
+   const bool mInterleaved;
+
+   //! Ring of chunks; the consumer owns the one at mHead until the next
+   //! Process()
+   std::vector<Chunk> mChunks;
+   size_t mHead{ 0 };
+   size_t mCount{ 0 };
+   bool mConsuming{ false };
+   Chunk mCurrent;
+
+   std::mutex mMutex;
+   std::condition_variable mProduced, mConsumed;
+   bool mStop{ false };
+   bool mFinished{ false };
+   std::exception_ptr mException;
+   std::thread mThread;
+};
@@ -11,6 +11,8 @@
 **********************************************************************/
 
 #include "ExportPluginHelpers.h"
+#include "ExportMixerPipeline.h"
+#include "ExportSharedMix.h"
 #include "Track.h"
 #include "Mix.h"
 #include "WaveTrack.h"
@@ -27,6 +29,12 @@ std::unique_ptr<Mixer> ExportPluginHelpers::CreateMixer(const TrackList &tracks,
          double outRate, sampleFormat outFormat,
          MixerOptions::Downmix *mixerSpec)
 {
+   // Convert a mix already made for another export, if there is one
+   if (auto pMixer = ExportSharedMix::CreateMixer(tracks, selectionOnly,
+         startTime, stopTime, numOutChannels, outBufferSize, outInterleaved,
+         outRate, outFormat, mixerSpec))
+      return pMixer;
+
    Mixer::Inputs inputs;
 
    for (auto pTrack: ExportUtils::FindExportWaveTracks(tracks, selectionOnly))
@@ -42,12 +50,15 @@ std::unique_ptr<Mixer> ExportPluginHelpers::CreateMixer(const TrackList &tracks,
                   numOutChannels, outBufferSize, outInterleaved,
                   outRate, outFormat,
                   true, mixerSpec,
-                  mixerSpec ? Mixer::ApplyGain::MapChannels : Mixer::ApplyGain::Mixdown);
+                  mixerSpec ? Mixer::ApplyGain::MapChannels : Mixer::ApplyGain::Mixdown,
+                  // Offline, so the inputs may be fetched concurrently
+                  true);
 }
 
 namespace
 {
-   double EvalExportProgress(Mixer &mixer, double t0, double t1)
+   template<typename MixerType>
+   double EvalExportProgress(MixerType &mixer, double t0, double t1)
    {
       const auto duration = t1 - t0;
       if(duration > 0)
@@ -66,3 +77,13 @@ ExportResult ExportPluginHelpers::UpdateProgress(ExportProcessorDelegate& delega
    return ExportResult::Success;
 }
 
+ExportResult ExportPluginHelpers::UpdateProgress(ExportProcessorDelegate& delegate, ExportMixerPipeline &mixer, double t0, double t1)
+{
+   delegate.OnProgress(EvalExportProgress(mixer, t0, t1));
+   if(delegate.IsStopped())
+      return ExportResult::Stopped;
+   if(delegate.IsCancelled())
+      return ExportResult::Cancelled;
+   return ExportResult::Success;
+}
+
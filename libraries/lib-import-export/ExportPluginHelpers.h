@@ -21,6 +21,7 @@
 class TrackList;
 class WaveTrack;
 class Mixer;
+class ExportMixerPipeline;
 
 namespace MixerOptions
 {
@@ -42,6 +43,7 @@ public:
    ///\brief Sends progress update to delegate and retrieves state update from it.
    ///Typically used inside each export iteration.
    static ExportResult UpdateProgress(ExportProcessorDelegate& delegate, Mixer& mixer, double t0, double t1);
+   static ExportResult UpdateProgress(ExportProcessorDelegate& delegate, ExportMixerPipeline& mixer, double t0, double t1);
 
    template<typename T>
    static T GetParameterValue(const ExportProcessor::Parameters& parameters, int id, T defaultValue = T())
@@ -15,6 +15,7 @@
 #include "Internat.h"
 #include "BasicUI.h"
 #include "FileException.h"
+#include "Tracing.h"
 
 namespace
 {
@@ -83,7 +84,11 @@ ExportResult ExportProgressUI::Show(ExportTask exportTask)
 
    auto f = exportTask.get_future();
    DialogExportProgressDelegate delegate;
-   std::thread(std::move(exportTask), std::ref(delegate)).detach();
+   std::thread([task = std::move(exportTask), &delegate]() mutable {
+      Tracing::RegisterThread("Export");
+      TRACE_SCOPE("Export");
+      task(delegate);
+   }).detach();
    auto result = ExportResult::Error;
    while(f.wait_for(std::chrono::milliseconds(50)) != std::future_status::ready)
       delegate.UpdateUI();
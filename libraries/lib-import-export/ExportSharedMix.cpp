@@ -0,0 +1,291 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  ExportSharedMix.cpp
+
+**********************************************************************/
+
+#include "ExportSharedMix.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#include "ExportPluginHelpers.h"
+#include "Mix.h"
+#include "Track.h"
+#include "Tracing.h"
+#include "WideSampleSequence.h"
+
+namespace {
+//! The mix and consumer of the active Scope
+ExportSharedMix *sCurrentMix = nullptr;
+size_t sCurrentConsumer = 0;
+}
+
+//! Presents the shared mix as a sequence, read forward only, for one mixer
+class ExportSharedMix::Reader final : public WideSampleSequence
+{
+public:
+   Reader(std::shared_ptr<ExportSharedMix> pMix, size_t index)
+      : mpMix{ move(pMix) }, mIndex{ index }
+   {}
+
+   AudioGraph::ChannelType GetChannelType() const override
+   {
+      // The identity mixer spec ignores this
+      return AudioGraph::MonoChannel;
+   }
+
+   size_t NChannels() const override { return mpMix->mNumChannels; }
+
+   // Gains were applied in the shared mix
+   float GetChannelGain(int) const override { return 1.0f; }
+
+   bool DoGet(size_t iChannel, size_t nBuffers, const samplePtr buffers[],
+      sampleFormat format, sampleCount start, size_t len, bool backward,
+      fillFormat, bool, sampleCount* pNumWithinClips) const override
+   {
+      // Export never mixes backwards
+      assert(!backward);
+      mpMix->Read(mIndex, iChannel, nBuffers, buffers, format, start, len);
+      if (pNumWithinClips)
+         *pNumWithinClips = len;
+      return true;
+   }
+
+   double GetStartTime() const override { return mpMix->mT0; }
+   double GetEndTime() const override { return mpMix->mT1; }
+   double GetRate() const override { return mpMix->mRate; }
+
+   sampleFormat WidestEffectiveFormat() const override { return floatSample; }
+
+   bool HasTrivialEnvelope() const override { return true; }
+
+   void GetEnvelopeValues(
+      double* buffer, size_t bufferLen, double, bool) const override
+   {
+      std::fill(buffer, buffer + bufferLen, 1.0);
+   }
+
+private:
+   const std::shared_ptr<ExportSharedMix> mpMix;
+   const size_t mIndex;
+};
+
+ExportSharedMix::Scope::Scope(ExportSharedMix &mix, size_t consumer)
+{
+   assert(!sCurrentMix);
+   sCurrentMix = &mix;
+   sCurrentConsumer = consumer;
+}
+
+ExportSharedMix::Scope::~Scope()
+{
+   sCurrentMix = nullptr;
+}
+
+ExportSharedMix::ExportSharedMix(const TrackList &tracks, bool selectionOnly,
+   double startTime, double stopTime, unsigned numChannels,
+   double rate, MixerOptions::Downmix *mixerSpec)
+   : mT0{ startTime }, mT1{ stopTime }, mRate{ rate }
+   , mNumChannels{ numChannels }
+   // As in WideSampleSequence::TimeToLongSamples(), which the readers use
+   , mStart{ std::floor(startTime * rate + 0.5) }
+   , mSelectionOnly{ selectionOnly }
+   , mTracks{ tracks }
+   , mpMixerSpec{ mixerSpec }
+   , mIdentity{ numChannels, numChannels }
+   , mpMixer{ ExportPluginHelpers::CreateMixer(tracks, selectionOnly,
+      startTime, stopTime, numChannels, BufferSize, false,
+      rate, floatSample, mixerSpec) }
+{
+}
+
+ExportSharedMix::~ExportSharedMix()
+{
+   if (mThread.joinable()) {
+      {
+         std::lock_guard<std::mutex> lock{ mMutex };
+         mStop = true;
+      }
+      mConsumed.notify_one();
+      mThread.join();
+   }
+}
+
+std::unique_ptr<Mixer> ExportSharedMix::CreateMixer(const TrackList &tracks,
+   bool selectionOnly, double startTime, double stopTime,
+   unsigned numOutChannels, size_t outBufferSize, bool outInterleaved,
+   double outRate, sampleFormat outFormat,
+   MixerOptions::Downmix *mixerSpec)
+{
+   const auto pMix = sCurrentMix;
+   if (!pMix || &tracks != &pMix->mTracks ||
+       selectionOnly != pMix->mSelectionOnly ||
+       startTime != pMix->mT0 || stopTime != pMix->mT1 ||
+       numOutChannels != pMix->mNumChannels || outRate != pMix->mRate ||
+       mixerSpec != pMix->mpMixerSpec)
+      return {};
+
+   size_t index;
+   {
+      std::lock_guard<std::mutex> lock{ pMix->mMutex };
+      assert(!pMix->mThread.joinable());
+      index = pMix->mReaders.size();
+      pMix->mReaders.push_back({ sCurrentConsumer, pMix->mStart });
+   }
+
+   // This mixer only converts, so it needs neither the thread pool nor a
+   // time warp
+   Mixer::Inputs inputs;
+   inputs.emplace_back(
+      std::make_shared<Reader>(pMix->shared_from_this(), index));
+   return std::make_unique<Mixer>(move(inputs),
+      true,
+      Mixer::WarpOptions{ 1.0, 1.0 },
+      startTime, stopTime,
+      numOutChannels, outBufferSize, outInterleaved,
+      outRate, outFormat,
+      true, &pMix->mIdentity, Mixer::ApplyGain::Discard);
+}
+
+void ExportSharedMix::Start()
+{
+   std::lock_guard<std::mutex> lock{ mMutex };
+   if (!mThread.joinable() && !mReaders.empty())
+      mThread = std::thread{ [this]{ Run(); } };
+}
+
+void ExportSharedMix::Release(size_t consumer)
+{
+   {
+      std::lock_guard<std::mutex> lock{ mMutex };
+      for (auto &reader : mReaders)
+         if (reader.consumer == consumer)
+            reader.released = true;
+   }
+   mConsumed.notify_one();
+}
+
+bool ExportSharedMix::HasReaders() const
+{
+   return std::any_of(mReaders.begin(), mReaders.end(),
+      [](const ReaderState &reader){ return !reader.released; });
+}
+
+void ExportSharedMix::Trim()
+{
+   while (!mChunks.empty()) {
+      const auto end = mChunks.front().End();
+      if (std::any_of(mReaders.begin(), mReaders.end(),
+         [&](const ReaderState &reader){
+            return !reader.released && reader.position < end; }))
+         break;
+      mChunks.pop_front();
+   }
+}
+
+void ExportSharedMix::Run()
+{
+   Tracing::RegisterThread("Export shared mixer");
+   auto position = mStart;
+   while (true) {
+      {
+         std::unique_lock<std::mutex> lock{ mMutex };
+         mConsumed.wait(lock, [this]{
+            Trim();
+            return mStop || !HasReaders() || mChunks.size() < QueueDepth;
+         });
+         if (mStop || !HasReaders())
+            return;
+      }
+
+      // Mix without the lock; only this thread touches the mixer
+      Chunk chunk;
+      bool finished = false;
+      try {
+         chunk.start = position;
+         chunk.frames = mpMixer->Process();
+         finished = (chunk.frames == 0);
+         chunk.data.resize(mNumChannels * chunk.frames);
+         for (unsigned channel = 0; channel < mNumChannels; ++channel) {
+            const auto buffer =
+               reinterpret_cast<const float*>(mpMixer->GetBuffer(channel));
+            std::copy(buffer, buffer + chunk.frames,
+               chunk.data.begin() + channel * chunk.frames);
+         }
+         position = chunk.End();
+      }
+      catch (...) {
+         std::lock_guard<std::mutex> lock{ mMutex };
+         mException = std::current_exception();
+         finished = true;
+      }
+
+      {
+         std::lock_guard<std::mutex> lock{ mMutex };
+         if (!mException && chunk.frames > 0)
+            mChunks.push_back(move(chunk));
+         mFinished = finished;
+      }
+      mProduced.notify_all();
+      if (finished)
+         return;
+   }
+}
+
+void ExportSharedMix::Read(size_t reader, size_t iChannel, size_t nBuffers,
+   const samplePtr buffers[], sampleFormat format,
+   sampleCount start, size_t len)
+{
+   const auto sampleSize = SAMPLE_SIZE(format);
+   const auto end = start + len;
+   auto pos = start;
+   // Zero-fill what is outside the mix, or was not kept
+   const auto fill = [&](sampleCount until) {
+      const auto n = (until - pos).as_size_t();
+      for (size_t ii = 0; ii < nBuffers; ++ii)
+         ClearSamples(buffers[ii], format, (pos - start).as_size_t(), n);
+      pos = until;
+   };
+
+   std::unique_lock<std::mutex> lock{ mMutex };
+   auto &state = mReaders[reader];
+   while (pos < end) {
+      mProduced.wait(lock, [&]{
+         return mFinished ||
+            (!mChunks.empty() && mChunks.back().End() > pos); });
+
+      const auto iter = std::find_if(mChunks.begin(), mChunks.end(),
+         [&](const Chunk &chunk){ return chunk.End() > pos; });
+      if (iter == mChunks.end()) {
+         // The mix is done
+         if (mException)
+            std::rethrow_exception(mException);
+         fill(end);
+         break;
+      }
+      if (iter->start > pos) {
+         fill(std::min(end, iter->start));
+         continue;
+      }
+
+      // Copy from the chunk, converting
+      const auto offset = (pos - iter->start).as_size_t();
+      const auto n = std::min(iter->End(), end) - pos;
+      for (size_t ii = 0; ii < nBuffers; ++ii)
+         CopySamples(
+            reinterpret_cast<constSamplePtr>(
+               iter->data.data() + (iChannel + ii) * iter->frames + offset),
+            floatSample,
+            buffers[ii] + (pos - start).as_size_t() * sampleSize, format,
+            n.as_size_t(), DitherType::none);
+      pos += n;
+
+      // Let the mix drop what this reader is past
+      state.position = std::max(state.position, pos);
+      mConsumed.notify_one();
+   }
+}
@@ -0,0 +1,132 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  ExportSharedMix.h
+
+**********************************************************************/
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "MixerOptions.h"
+#include "SampleCount.h"
+#include "SampleFormat.h"
+
+class Mixer;
+class TrackList;
+
+//! Mixes the tracks once, for several exports of the same audio
+/*!
+ A worker thread runs one Mixer, with the time warp, effect stages and
+ downmixing of an export, into floating point chunks.  While a Scope is
+ active, ExportPluginHelpers::CreateMixer() makes mixers that only convert
+ those chunks to the format and layout that each export plug-in asks for, if
+ it asks for the same range, rate and channels.
+
+ Chunks pass through a bounded queue, and are kept until every consumer has
+ read them, so memory use does not depend on the length of the export; but
+ mixing can run only as far ahead as the slowest consumer.
+ */
+class IMPORT_EXPORT_API ExportSharedMix final
+   : public std::enable_shared_from_this<ExportSharedMix>
+{
+public:
+   //! Frames in one mixed chunk
+   static constexpr size_t BufferSize = 16384;
+
+   //! How many chunks the mixer may run ahead of the slowest consumer
+   static constexpr size_t QueueDepth = 8;
+
+   //! Makes ExportPluginHelpers::CreateMixer() read the mix, for one consumer
+   class IMPORT_EXPORT_API Scope final
+   {
+   public:
+      Scope(ExportSharedMix &mix, size_t consumer);
+      Scope(const Scope&) = delete;
+      Scope &operator=(const Scope&) = delete;
+      ~Scope();
+   };
+
+   //! Arguments are as for ExportPluginHelpers::CreateMixer()
+   /*!
+    @param mixerSpec null or else must have a lifetime enclosing this object's
+    */
+   ExportSharedMix(const TrackList &tracks, bool selectionOnly,
+      double startTime, double stopTime, unsigned numChannels,
+      double rate, MixerOptions::Downmix *mixerSpec);
+   ExportSharedMix(const ExportSharedMix&) = delete;
+   ExportSharedMix &operator=(const ExportSharedMix&) = delete;
+   //! Stops mixing, if the exports end early
+   ~ExportSharedMix();
+
+   //! Called from ExportPluginHelpers::CreateMixer()
+   /*!
+    @return a mixer reading the shared mix, for the consumer of the active
+    Scope; or null if there is none, or the arguments do not match the mix
+    */
+   static std::unique_ptr<Mixer> CreateMixer(const TrackList &tracks,
+      bool selectionOnly, double startTime, double stopTime,
+      unsigned numOutChannels, size_t outBufferSize, bool outInterleaved,
+      double outRate, sampleFormat outFormat,
+      MixerOptions::Downmix *mixerSpec);
+
+   //! Begin mixing, after the consumers have made their mixers
+   void Start();
+
+   //! The consumer will read no more, so the mix need not wait for it
+   void Release(size_t consumer);
+
+private:
+   class Reader;
+
+   struct Chunk {
+      std::vector<float> data;
+      sampleCount start;
+      size_t frames{};
+      sampleCount End() const { return start + frames; }
+   };
+
+   struct ReaderState {
+      size_t consumer;
+      //! Before this position the reader needs no more samples
+      sampleCount position;
+      bool released{ false };
+   };
+
+   void Run();
+   //! Drop chunks that all readers are past
+   void Trim();
+   bool HasReaders() const;
+
+   //! Copy mixed samples for a reader, waiting for the mix as needed
+   void Read(size_t reader, size_t iChannel, size_t nBuffers,
+      const samplePtr buffers[], sampleFormat format,
+      sampleCount start, size_t len);
+
+   const double mT0, mT1, mRate;
+   const unsigned mNumChannels;
+   const sampleCount mStart;
+   const bool mSelectionOnly;
+   const TrackList &mTracks;
+   MixerOptions::Downmix *const mpMixerSpec;
+   //! Maps the channels of the mix one to one onto those of each consumer
+   MixerOptions::Downmix mIdentity;
+   std::unique_ptr<Mixer> mpMixer;
+
+   std::mutex mMutex;
+   std::condition_variable mProduced, mConsumed;
+   std::deque<Chunk> mChunks;
+   std::vector<ReaderState> mReaders;
+   bool mStop{ false };
+   bool mFinished{ false };
+   std::exception_ptr mException;
+   std::thread mThread;
+};
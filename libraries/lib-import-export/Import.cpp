@@ -35,14 +35,22 @@ ImportFileHandle
 #include "Import.h"
 
 #include "ImportPlugin.h"
+#include "ImportUtils.h"
 
 #include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <exception>
+#include <future>
 #include <unordered_set>
 
 #include <wx/log.h>
 #include "FileNames.h"
 #include "Project.h"
+#include "QualitySettings.h"
 #include "WaveTrack.h"
+#include "concurrency/ThreadPool.h"
 
 #include "Prefs.h"
 
@@ -90,6 +98,161 @@ public:
    }
 };
 
+//! Stands for all the files of Importer::ImportConcurrently() before the
+//! listener, which may cancel or stop them from the main thread
+class ConcurrentImportHandle final : public ImportFileHandle
+{
+   const size_t mFileCount;
+   const ByteCount mBytes;
+   std::atomic<bool> mCancelled{ false };
+   std::atomic<bool> mStopped{ false };
+public:
+   ConcurrentImportHandle(size_t fileCount, ByteCount bytes)
+      : mFileCount{ fileCount }
+      , mBytes{ bytes }
+   {
+   }
+
+   FilePath GetFilename() const override
+   {
+      return {};
+   }
+
+   TranslatableString GetFileDescription() override
+   {
+      return XP("%d file", "%d files", 0).Format(static_cast<int>(mFileCount));
+   }
+
+   ByteCount GetFileUncompressedBytes() override
+   {
+      return mBytes;
+   }
+
+   wxInt32 GetStreamCount() override
+   {
+      return 1;
+   }
+
+   const TranslatableStrings &GetStreamInfo() override
+   {
+      static TranslatableStrings empty;
+      return empty;
+   }
+
+   void SetStreamUsage(wxInt32, bool) override
+   {
+   }
+
+   void Import(
+      ImportProgressListener&, WaveTrackFactory*, TrackHolders&, Tags*,
+      std::optional<LibFileFormats::AcidizerTags>&) override
+   {
+      // The files are imported by their own handles
+      assert(false);
+   }
+
+   void Cancel() override
+   {
+      if (!mStopped)
+         mCancelled = true;
+   }
+
+   void Stop() override
+   {
+      if (!mCancelled)
+         mStopped = true;
+   }
+
+   bool IsCancelled() const noexcept
+   {
+      return mCancelled;
+   }
+
+   bool IsStopped() const noexcept
+   {
+      return mStopped;
+   }
+};
+
+//! Listens to the import of one file on a worker thread
+class ConcurrentImportListener final : public ImportProgressListener
+{
+   ImportFileHandle& mHandle;
+   const ConcurrentImportHandle& mBatch;
+   std::atomic<double>& mProgress;
+   ImportResult mResult{ ImportResult::Error };
+public:
+   ConcurrentImportListener(ImportFileHandle& handle,
+      const ConcurrentImportHandle& batch, std::atomic<double>& progress)
+      : mHandle{ handle }
+      , mBatch{ batch }
+      , mProgress{ progress }
+   {
+   }
+
+   bool OnImportFileOpened(ImportFileHandle&) override
+   {
+      return true;
+   }
+
+   void OnImportProgress(double progress) override
+   {
+      mProgress.store(progress, std::memory_order_relaxed);
+      // Pass on the wishes of the user on this thread, which the handle may
+      // then check without synchronization
+      if (mBatch.IsCancelled())
+         mHandle.Cancel();
+      else if (mBatch.IsStopped())
+         mHandle.Stop();
+   }
+
+   void OnImportResult(ImportResult result) override
+   {
+      mResult = result;
+   }
+
+   ImportResult GetResult() const noexcept
+   {
+      return mResult;
+   }
+};
+
+//! Listens to the import of one file begun by Importer::ImportAsync()
+class AsyncImportListener final : public ImportProgressListener
+{
+   ImportFileHandle& mHandle;
+   const std::atomic<bool>& mCancel;
+   ImportResult mResult{ ImportResult::Error };
+public:
+   AsyncImportListener(
+      ImportFileHandle& handle, const std::atomic<bool>& cancel)
+      : mHandle{ handle }
+      , mCancel{ cancel }
+   {
+   }
+
+   bool OnImportFileOpened(ImportFileHandle&) override
+   {
+      return true;
+   }
+
+   void OnImportProgress(double) override
+   {
+      if (mCancel.load(std::memory_order_relaxed))
+         mHandle.Cancel();
+   }
+
+   void OnImportResult(ImportResult result) override
+   {
+      mResult = result;
+   }
+
+   ImportResult GetResult() const noexcept
+   {
+      return mResult;
+   }
+};
+
 }
 
 // ============================================================================
@@ -482,34 +645,12 @@ std::unique_ptr<ExtImportItem> Importer::CreateDefaultImportItem()
    return new_item;
 }
 
-// returns number of tracks imported
-bool Importer::Import(
-   AudacityProject& project, const FilePath& fName,
-   ImportProgressListener* importProgressListener,
-   WaveTrackFactory* trackFactory, TrackHolders& tracks, Tags* tags,
-   std::optional<LibFileFormats::AcidizerTags>& outAcidTags,
-   TranslatableString& errorMessage)
+std::vector<ImportPlugin*> Importer::GetPluginsToTry(const FilePath& fName)
 {
-   AudacityProject *pProj = &project;
-   auto cleanup = valueRestorer( pProj->mbBusyImporting, true );
-
    const FileExtension extension{ fName.AfterLast(wxT('.')) };
 
-   // Bug #2647: Peter has a Word 2000 .doc file that is recognized and imported by FFmpeg.
-   if (wxFileName(fName).GetExt() == wxT("doc")) {
-      errorMessage =
-         XO("\"%s\" \nis a not an audio file. \nAudacity cannot open this type of file.")
-         .Format( fName );
-      return false;
-   }
-
-   using ImportPluginPtrs = std::vector< ImportPlugin* >;
-
    // This list is used to call plugins in correct order
-   ImportPluginPtrs importPlugins;
-
-   // This list is used to remember plugins that should have been compatible with the file.
-   ImportPluginPtrs compatiblePlugins;
+   std::vector<ImportPlugin*> importPlugins;
 
    // Not implemented (yet?)
    wxString mime_type = wxT("*");
@@ -622,6 +763,36 @@ bool Importer::Import(
       }
    }
 
+   return importPlugins;
+}
+
+// returns number of tracks imported
+bool Importer::Import(
+   AudacityProject& project, const FilePath& fName,
+   ImportProgressListener* importProgressListener,
+   WaveTrackFactory* trackFactory, TrackHolders& tracks, Tags* tags,
+   std::optional<LibFileFormats::AcidizerTags>& outAcidTags,
+   TranslatableString& errorMessage,
+   const std::optional<ImportTimeRange>& timeRange)
+{
+   AudacityProject *pProj = &project;
+   auto cleanup = valueRestorer( pProj->mbBusyImporting, true );
+
+   const FileExtension extension{ fName.AfterLast(wxT('.')) };
+
+   // Bug #2647: Peter has a Word 2000 .doc file that is recognized and imported by FFmpeg.
+   if (wxFileName(fName).GetExt() == wxT("doc")) {
+      errorMessage =
+         XO("\"%s\" \nis a not an audio file. \nAudacity cannot open this type of file.")
+         .Format( fName );
+      return false;
+   }
+
+   const auto importPlugins = GetPluginsToTry(fName);
+
+   // This list is used to remember plugins that should have been compatible with the file.
+   std::vector<ImportPlugin*> compatiblePlugins;
+
    ImportProgressResultProxy importResultProxy(importProgressListener);
 
    // Try the import plugins, in the permuted sequences just determined
@@ -636,12 +807,20 @@ bool Importer::Import(
          if(!importResultProxy.OnImportFileOpened(*inFile))
             return false;
 
+         const bool seeks = timeRange && inFile->SetTimeRange(*timeRange);
+
          inFile->Import(
             importResultProxy, trackFactory, tracks, tags, outAcidTags);
          const auto importResult = importResultProxy.GetResult();
          if (importResult == ImportProgressListener::ImportResult::Success ||
              importResult == ImportProgressListener::ImportResult::Stopped)
          {
+            // The plug-in decoded the whole file; keep only the range
+            if (timeRange && !seeks)
+               for (const auto &track : tracks)
+                  ImportUtils::TrimToRange(
+                     *track, timeRange->t0, timeRange->t1);
+
             // LOF ("list-of-files") has different semantics
             if (extension.IsSameAs(wxT("lof"), false))
             {
@@ -834,4 +1013,165 @@ bool Importer::Import(
    return false;
 }
 
+auto Importer::ImportConcurrently(
+   AudacityProject& project, std::vector<ImportJob>& jobs,
+   ImportProgressListener* importProgressListener,
+   WaveTrackFactory* trackFactory) -> ImportProgressListener::ImportResult
+{
+   using ImportResult = ImportProgressListener::ImportResult;
+
+   AudacityProject *pProj = &project;
+   auto cleanup = valueRestorer( pProj->mbBusyImporting, true );
+
+   // Settings cache what they read, so read those that the importers consult
+   // here, and not first on the workers
+   QualitySettings::SampleFormatChoice();
+
+   struct Task {
+      ImportJob& job;
+      std::unique_ptr<ImportFileHandle> handle;
+      ImportFileHandle::ByteCount bytes;
+   };
+   std::vector<Task> tasks;
+
+   // Probing is quick, so open the files here, in the order of the listing
+   for (auto& job : jobs) {
+      job.imported = false;
+      if (auto inFile = OpenForConcurrentImport(project, job.fileName)) {
+         const auto bytes = inFile->GetFileUncompressedBytes();
+         tasks.push_back({ job, std::move(inFile), bytes });
+      }
+   }
+   if (tasks.empty())
+      return ImportResult::Success;
+
+   ImportFileHandle::ByteCount totalBytes = 0;
+   for (const auto& task : tasks)
+      totalBytes += std::max<ImportFileHandle::ByteCount>(task.bytes, 1);
+
+   ConcurrentImportHandle batch{ tasks.size(), totalBytes };
+   ImportProgressResultProxy importResultProxy(importProgressListener);
+   if (!importResultProxy.OnImportFileOpened(batch))
+      return ImportResult::Cancelled;
+
+   const auto nTasks = tasks.size();
+   std::vector<std::atomic<double>> progresses(nTasks);
+   std::vector<std::future<ImportResult>> futures;
+   futures.reserve(nTasks);
+   auto& pool = audacity::concurrency::ThreadPool::GetDefault();
+   for (size_t ii = 0; ii < nTasks; ++ii) {
+      auto& progress = progresses[ii];
+      progress = 0;
+      futures.push_back(pool.Async([&task = tasks[ii], &batch, &progress,
+         trackFactory]{
+         if (batch.IsCancelled() || batch.IsStopped())
+            return ImportResult::Cancelled;
+         auto& job = task.job;
+         ConcurrentImportListener listener{ *task.handle, batch, progress };
+         task.handle->Import(listener,
+            trackFactory, job.tracks, job.tags.get(), job.acidTags);
+         return listener.GetResult();
+      }));
+   }
+
+   // Report progress of all, weighted by size, until all are done
+   std::exception_ptr pException;
+   for (size_t next = 0; next < nTasks;) {
+      double done = 0;
+      for (size_t ii = 0; ii < nTasks; ++ii)
+         done += std::max<ImportFileHandle::ByteCount>(tasks[ii].bytes, 1) *
+            (ii < next ? 1.0 : progresses[ii].load(std::memory_order_relaxed));
+      importResultProxy.OnImportProgress(done / totalBytes);
+
+      auto& future = futures[next];
+      if (future.wait_for(std::chrono::milliseconds{ 50 }) !=
+          std::future_status::ready)
+         continue;
+      auto& task = tasks[next++];
+      try {
+         const auto result = future.get();
+         task.job.imported =
+            (result == ImportResult::Success ||
+             result == ImportResult::Stopped) && !task.job.tracks.empty();
+      }
+      catch (...) {
+         if (!pException)
+            pException = std::current_exception();
+      }
+      // Close the file
+      task.handle.reset();
+   }
+   if (pException)
+      std::rethrow_exception(pException);
+
+   const auto result = batch.IsCancelled() ? ImportResult::Cancelled
+      : batch.IsStopped() ? ImportResult::Stopped
+      : ImportResult::Success;
+   if (result == ImportResult::Cancelled)
+      for (auto& job : jobs) {
+         job.tracks.clear();
+         job.imported = false;
+      }
+   importResultProxy.OnImportResult(result);
+   return result;
+}
+
+auto Importer::ImportAsync(
+   AudacityProject& project, ImportJob& job, WaveTrackFactory* trackFactory,
+   const std::atomic<bool>& cancel)
+   -> std::future<ImportProgressListener::ImportResult>
+{
+   using ImportResult = ImportProgressListener::ImportResult;
+
+   job.imported = false;
+   QualitySettings::SampleFormatChoice();
+   std::shared_ptr<ImportFileHandle> pHandle =
+      OpenForConcurrentImport(project, job.fileName);
+   if (!pHandle)
+      return {};
+   return audacity::concurrency::ThreadPool::GetDefault().Async(
+   [pHandle = std::move(pHandle), &job, trackFactory, &cancel]() mutable {
+      if (cancel.load(std::memory_order_relaxed))
+         return ImportResult::Cancelled;
+      AsyncImportListener listener{ *pHandle, cancel };
+      pHandle->Import(listener,
+         trackFactory, job.tracks, job.tags.get(), job.acidTags);
+      // Close the file
+      pHandle.reset();
+      const auto result = listener.GetResult();
+      job.imported =
+         (result == ImportResult::Success ||
+          result == ImportResult::Stopped) && !job.tracks.empty();
+      return result;
+   });
+}
+
+std::unique_ptr<ImportFileHandle> Importer::OpenForConcurrentImport(
+   AudacityProject& project, const FilePath& fileName)
+{
+   const FileExtension extension{ fileName.AfterLast(wxT('.')) };
+   // Leave files with other semantics, and those with
+   // errors to report, to Import()
+   if (extension.IsSameAs(wxT("lof"), false) ||
+       extension.IsSameAs(wxT("aup"), false) ||
+       extension.IsSameAs(wxT("aup3"), false) ||
+       extension.IsSameAs(wxT("doc"), false))
+      return {};
+   for (const auto plugin : GetPluginsToTry(fileName)) {
+      auto inFile = plugin->Open(fileName, &project);
+      if (!inFile || inFile->GetStreamCount() <= 0)
+         continue;
+      // Choosing among streams needs a dialog
+      if (inFile->SupportsConcurrentImport() &&
+          inFile->GetStreamCount() == 1) {
+         inFile->SetStreamUsage(0, true);
+         return inFile;
+      }
+      break;
+   }
+   return {};
+}
+
 BoolSetting NewImportingSession{ L"/NewImportingSession", false };
+
+BoolSetting ImportOnDemand{ L"/FileFormats/ImportOnDemand", false };
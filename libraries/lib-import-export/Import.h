@@ -13,10 +13,16 @@
 
 #include "ImportForwards.h"
 #include "Identifier.h"
+#include <atomic>
+#include <future>
+#include <memory>
+#include <optional>
 #include <vector>
 #include <wx/tokenzr.h> // for enum wxStringTokenizerMode
 
+#include "AcidizerTags.h"
 #include "FileNames.h" // for FileType
+#include "ImportProgressListener.h"
 
 #include "Registry.h"
 
@@ -27,18 +33,13 @@ class WaveTrackFactory;
 class Track;
 class TrackList;
 class ImportPlugin;
-class ImportProgressListener;
+class ImportFileHandle;
 class UnusableImportPlugin;
 typedef bool (*progress_callback_t)( void *userData, float percent );
 
 class ExtImportItem;
 class WaveTrack;
 
-namespace LibFileFormats
-{
-struct AcidizerTags;
-}
-
 using ExtImportItems = std::vector<std::unique_ptr<ExtImportItem>>;
 using TrackHolders = std::vector<std::shared_ptr<Track>>;
 
@@ -175,14 +176,66 @@ public:
     std::unique_ptr<ExtImportItem> CreateDefaultImportItem();
 
    // if false, the import failed and errorMessage will be set.
+   // If timeRange is given, only that interval of the file is imported,
+   // decoding no more than that when the plug-in can seek.
     bool Import(
        AudacityProject& project, const FilePath& fName,
        ImportProgressListener* importProgressListener,
        WaveTrackFactory* trackFactory, TrackHolders& tracks, Tags* tags,
        std::optional<LibFileFormats::AcidizerTags>& outAcidTags,
-       TranslatableString& errorMessage);
+       TranslatableString& errorMessage,
+       const std::optional<ImportTimeRange>& timeRange = {});
+
+    //! One file of a batch given to ImportConcurrently()
+    struct ImportJob
+    {
+       FilePath fileName;
+       //! Receives the tags that the file defines; must not be null
+       std::shared_ptr<Tags> tags;
+       TrackHolders tracks;
+       std::optional<LibFileFormats::AcidizerTags> acidTags;
+       //! Whether tracks were imported; if not, the file was not attempted
+       //! or failed, and Import() may retry it and report the error
+       bool imported{ false };
+    };
+
+    //! Import several files at once, decoding them on the thread pool
+    /*!
+     Files are opened in order on the calling thread, but only those with one
+     stream and a handle that @ref ImportFileHandle::SupportsConcurrentImport
+     "supports concurrent import" are decoded, the rest are left for Import().
+     Progress for all of them is reported to the listener as if for one file,
+     described by a handle whose Cancel() and Stop() apply to every file.
+     @return Cancelled if the user cancelled, and then no job is imported;
+     Stopped if the user stopped, and then the files not imported yet should
+     not be imported either; else Success, even if some files failed
+     */
+    ImportProgressListener::ImportResult ImportConcurrently(
+       AudacityProject& project, std::vector<ImportJob>& jobs,
+       ImportProgressListener* importProgressListener,
+       WaveTrackFactory* trackFactory);
+
+    //! Begin decoding one file on the thread pool, returning at once
+    /*!
+     The file is opened on the calling thread, and decoded only if
+     ImportConcurrently() would decode it; otherwise the result is an invalid
+     future, and the file is left for Import().  `job`, `trackFactory` and
+     `cancel` must outlive the decoding.  Setting `cancel` abandons it.
+     When the future is ready, `job.imported` tells whether tracks were
+     imported
+     */
+    std::future<ImportProgressListener::ImportResult> ImportAsync(
+       AudacityProject& project, ImportJob& job,
+       WaveTrackFactory* trackFactory, const std::atomic<bool>& cancel);
 
  private:
+    //! Plug-ins in the order to try them for the file
+    std::vector<ImportPlugin*> GetPluginsToTry(const FilePath& fName);
+
+    //! A handle of the file, ready to decode on another thread, or null
+    std::unique_ptr<ImportFileHandle> OpenForConcurrentImport(
+       AudacityProject& project, const FilePath& fileName);
+
     struct Traits : Registry::DefaultTraits
     {
        using LeafTypes = List<ImporterItem>;
@@ -204,4 +257,8 @@ public:
 
 extern IMPORT_EXPORT_API BoolSetting NewImportingSession;
 
+//! Whether importers that can may leave samples in the imported files, to be
+//! copied into the project later
+extern IMPORT_EXPORT_API BoolSetting ImportOnDemand;
+
 #endif
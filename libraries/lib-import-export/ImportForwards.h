@@ -20,4 +20,11 @@ using ImportPluginList =
 using UnusableImportPluginList =
    std::vector< std::unique_ptr<UnusableImportPlugin> >;
 
+//! Interval of a file to import, in seconds from its start
+struct ImportTimeRange
+{
+   double t0;
+   double t1;
+};
+
 #endif
@@ -80,3 +80,13 @@ TranslatableString ImportFileHandle::GetErrorMessage() const
 {
    return {};
 }
+
+bool ImportFileHandle::SupportsConcurrentImport() const
+{
+   return false;
+}
+
+bool ImportFileHandle::SetTimeRange(const ImportTimeRange&)
+{
+   return false;
+}
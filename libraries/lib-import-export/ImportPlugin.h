@@ -47,6 +47,7 @@ but little else.
 
 #include "AcidizerTags.h"
 #include "Identifier.h"
+#include "ImportForwards.h"
 #include "Internat.h"
 #include "wxArrayStringEx.h"
 #include <memory>
@@ -153,6 +154,23 @@ public:
    virtual void Cancel() = 0;
 
    virtual void Stop() = 0;
+
+   //! Whether Import() may run on a worker thread, alongside imports of
+   //! other files
+   /*!
+    If so, Import() must not show any dialogs, and must touch nothing shared
+    but the track factory; Cancel() and Stop() are then called only from
+    within the progress listener.  Default returns false.
+    */
+   virtual bool SupportsConcurrentImport() const;
+
+   //! Ask that Import() decode only the given interval, before it is called
+   /*!
+    The imported tracks then begin with the sample at the start of the range.
+    @return whether the handle can seek to the range; if not, it will import
+    the whole file, and the caller must trim the tracks.  Default returns false.
+    */
+   virtual bool SetTimeRange(const ImportTimeRange& range);
 };
 
 class IMPORT_EXPORT_API ImportFileHandleEx : public ImportFileHandle
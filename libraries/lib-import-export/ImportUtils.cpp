@@ -16,6 +16,8 @@
 #include "QualitySettings.h"
 #include "BasicUI.h"
 
+#include <algorithm>
+
 sampleFormat ImportUtils::ChooseFormat(sampleFormat effectiveFormat)
 {
    // Consult user preference
@@ -88,3 +90,15 @@ void ImportUtils::ForEachChannel(WaveTrack &track, const std::function<void(Wave
       op(*channel);
    }
 }
+
+void ImportUtils::TrimToRange(Track &track, double t0, double t1)
+{
+   const auto end = track.GetEndTime();
+   if (t1 < end)
+      track.Clear(std::max(t1, 0.0), end);
+   // Clearing also shifts the rest of the track left
+   if (t0 > 0)
+      track.Clear(0, t0);
+   else if (t0 < 0)
+      track.InsertSilence(0, -t0);
+}
@@ -63,4 +63,9 @@ public:
    //! Flushes the given channels and moves them to \p outTracks
    static
    void FinalizeImport(TrackHolders& outTracks, WaveTrack &track);
+
+   //! Keeps only the part of the track from t0 to t1, moved to begin at zero
+   //! If t0 is negative, inserts that much silence at the start instead
+   static
+   void TrimToRange(Track &track, double t0, double t1);
 };
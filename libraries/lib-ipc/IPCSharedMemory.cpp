@@ -0,0 +1,130 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file IPCSharedMemory.cpp
+
+  Part of lib-ipc library
+
+**********************************************************************/
+
+#include "IPCSharedMemory.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <cstring>
+
+class IPCSharedMemory::Impl final
+{
+public:
+   std::string mName;
+   void* mData{nullptr};
+   size_t mSize{0};
+   bool mOwner{false};
+#ifdef _WIN32
+   HANDLE mMapping{nullptr};
+#endif
+
+   ~Impl()
+   {
+#ifdef _WIN32
+      if(mData != nullptr)
+         UnmapViewOfFile(mData);
+      if(mMapping != nullptr)
+         CloseHandle(mMapping);
+#else
+      if(mData != nullptr)
+         munmap(mData, mSize);
+      if(mOwner)
+         shm_unlink(mName.c_str());
+#endif
+   }
+
+   bool Map(bool create)
+   {
+#ifdef _WIN32
+      const auto name = "Local\\" + mName;
+      if(create)
+         mMapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr,
+            PAGE_READWRITE,
+            static_cast<DWORD>(static_cast<unsigned long long>(mSize) >> 32),
+            static_cast<DWORD>(mSize & 0xFFFFFFFFu),
+            name.c_str());
+      else
+         mMapping = OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, name.c_str());
+      if(mMapping == nullptr)
+         return false;
+      mData = MapViewOfFile(mMapping, FILE_MAP_ALL_ACCESS, 0, 0, mSize);
+      return mData != nullptr;
+#else
+      const auto name = "/" + mName;
+      const auto fd = create
+         ? shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR)
+         : shm_open(name.c_str(), O_RDWR, 0);
+      if(fd == -1)
+         return false;
+      mName = name;
+      mOwner = create;
+      if(create && ftruncate(fd, static_cast<off_t>(mSize)) == -1)
+      {
+         close(fd);
+         return false;
+      }
+      auto data = mmap(nullptr, mSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+      //mapping stays valid after the descriptor is closed
+      close(fd);
+      if(data == MAP_FAILED)
+         return false;
+      mData = data;
+      return true;
+#endif
+   }
+};
+
+IPCSharedMemory::IPCSharedMemory(std::unique_ptr<Impl> impl)
+   : mImpl(std::move(impl))
+{
+}
+
+std::unique_ptr<IPCSharedMemory> IPCSharedMemory::Create(
+   const std::string& name, size_t size)
+{
+   auto impl = std::make_unique<Impl>();
+   impl->mName = name;
+   impl->mSize = size;
+   if(!impl->Map(true))
+      return {};
+   //Fresh pages are zero-filled on every platform, but be explicit
+   std::memset(impl->mData, 0, size);
+   return std::unique_ptr<IPCSharedMemory>(new IPCSharedMemory(std::move(impl)));
+}
+
+std::unique_ptr<IPCSharedMemory> IPCSharedMemory::Open(
+   const std::string& name, size_t size)
+{
+   auto impl = std::make_unique<Impl>();
+   impl->mName = name;
+   impl->mSize = size;
+   if(!impl->Map(false))
+      return {};
+   return std::unique_ptr<IPCSharedMemory>(new IPCSharedMemory(std::move(impl)));
+}
+
+IPCSharedMemory::~IPCSharedMemory() = default;
+
+void* IPCSharedMemory::GetData() const noexcept
+{
+   return mImpl->mData;
+}
+
+size_t IPCSharedMemory::GetSize() const noexcept
+{
+   return mImpl->mSize;
+}
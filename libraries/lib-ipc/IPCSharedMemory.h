@@ -0,0 +1,50 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file IPCSharedMemory.h
+
+  Part of lib-ipc library
+
+**********************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+/**
+ * \brief Named memory region that can be mapped by several processes.
+ * The process which created the region removes its name on destruction,
+ * others keep their mapping valid until they destroy their own object.
+ */
+class IPC_API IPCSharedMemory final
+{
+   class Impl;
+   std::unique_ptr<Impl> mImpl;
+
+   explicit IPCSharedMemory(std::unique_ptr<Impl> impl);
+public:
+   /**
+    * \brief Creates a new zero-filled region
+    * \param name Unique name, without path separators
+    * \param size Size of the region in bytes
+    * \return nullptr on failure
+    */
+   static std::unique_ptr<IPCSharedMemory> Create(
+      const std::string& name, size_t size);
+   /**
+    * \brief Maps a region created by another process
+    * \param name Same name as was passed to Create
+    * \param size Same size as was passed to Create
+    * \return nullptr on failure
+    */
+   static std::unique_ptr<IPCSharedMemory> Open(
+      const std::string& name, size_t size);
+
+   ~IPCSharedMemory();
+
+   void* GetData() const noexcept;
+   size_t GetSize() const noexcept;
+};
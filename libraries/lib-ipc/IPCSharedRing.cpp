@@ -0,0 +1,111 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file IPCSharedRing.cpp
+
+  Part of lib-ipc library
+
+**********************************************************************/
+
+#include "IPCSharedRing.h"
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+size_t IPCSharedRing::RequiredSize(size_t capacity) noexcept
+{
+   return sizeof(Header) + capacity;
+}
+
+void IPCSharedRing::Initialize(void* memory, size_t capacity) noexcept
+{
+   auto header = new (memory) Header;
+   header->writePosition.store(0, std::memory_order_relaxed);
+   header->readPosition.store(0, std::memory_order_relaxed);
+   header->capacity = capacity;
+   std::atomic_thread_fence(std::memory_order_release);
+}
+
+IPCSharedRing::IPCSharedRing(void* memory) noexcept
+   : mHeader(static_cast<Header*>(memory))
+   , mData(static_cast<unsigned char*>(memory) + sizeof(Header))
+{
+}
+
+bool IPCSharedRing::Write(const Part* parts, size_t count) noexcept
+{
+   const auto capacity = mHeader->capacity;
+   const auto writePosition =
+      mHeader->writePosition.load(std::memory_order_relaxed);
+   const auto readPosition =
+      mHeader->readPosition.load(std::memory_order_acquire);
+
+   size_t total = 0;
+   for(size_t i = 0; i < count; ++i)
+      total += parts[i].size;
+   if(total > capacity - (writePosition - readPosition))
+      return false;
+
+   auto position = writePosition;
+   for(size_t i = 0; i < count; ++i)
+   {
+      auto bytes = static_cast<const unsigned char*>(parts[i].data);
+      auto remaining = parts[i].size;
+      while(remaining > 0)
+      {
+         const auto offset = position % capacity;
+         const auto n = std::min<uint64_t>(remaining, capacity - offset);
+         std::memcpy(mData + offset, bytes, n);
+         bytes += n;
+         remaining -= n;
+         position += n;
+      }
+   }
+   //Publish the whole record at once
+   mHeader->writePosition.store(position, std::memory_order_release);
+   return true;
+}
+
+bool IPCSharedRing::Write(const void* data, size_t size) noexcept
+{
+   const Part part { data, size };
+   return Write(&part, 1);
+}
+
+size_t IPCSharedRing::ReadAvailable() const noexcept
+{
+   return mHeader->writePosition.load(std::memory_order_acquire) -
+      mHeader->readPosition.load(std::memory_order_relaxed);
+}
+
+bool IPCSharedRing::Read(void* data, size_t size) noexcept
+{
+   if(ReadAvailable() < size)
+      return false;
+
+   const auto capacity = mHeader->capacity;
+   auto position = mHeader->readPosition.load(std::memory_order_relaxed);
+   auto bytes = static_cast<unsigned char*>(data);
+   auto remaining = size;
+   while(remaining > 0)
+   {
+      const auto offset = position % capacity;
+      const auto n = std::min<uint64_t>(remaining, capacity - offset);
+      std::memcpy(bytes, mData + offset, n);
+      bytes += n;
+      remaining -= n;
+      position += n;
+   }
+   mHeader->readPosition.store(position, std::memory_order_release);
+   return true;
+}
+
+bool IPCSharedRing::Skip(size_t size) noexcept
+{
+   if(ReadAvailable() < size)
+      return false;
+   mHeader->readPosition.fetch_add(size, std::memory_order_release);
+   return true;
+}
@@ -0,0 +1,71 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file IPCSharedRing.h
+
+  Part of lib-ipc library
+
+**********************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * \brief Lock-free single producer, single consumer queue of byte records,
+ * that lives in memory shared by two processes (see IPCSharedMemory).
+ * Neither side ever blocks: writes fail when there is not enough free space,
+ * and reads fail when there is not enough data.
+ */
+class IPC_API IPCSharedRing final
+{
+   struct Header
+   {
+      alignas(64) std::atomic<uint64_t> writePosition;
+      alignas(64) std::atomic<uint64_t> readPosition;
+      alignas(64) uint64_t capacity;
+   };
+   static_assert(std::atomic<uint64_t>::is_always_lock_free,
+      "positions must be lock-free to be shared between processes");
+
+   Header* mHeader{nullptr};
+   unsigned char* mData{nullptr};
+
+public:
+   struct Part
+   {
+      const void* data;
+      size_t size;
+   };
+
+   ///Size of the memory needed for a ring that holds capacity bytes
+   static size_t RequiredSize(size_t capacity) noexcept;
+   ///Prepares memory for use by the ring, should be called once
+   ///by the process that created the memory before the other side attaches
+   static void Initialize(void* memory, size_t capacity) noexcept;
+
+   IPCSharedRing() = default;
+   ///Attaches to memory prepared with Initialize
+   explicit IPCSharedRing(void* memory) noexcept;
+
+   /**
+    * \brief Writes all the parts as a single record, called by the producer
+    * \return false, writing nothing, if there is not enough space
+    */
+   bool Write(const Part* parts, size_t count) noexcept;
+   bool Write(const void* data, size_t size) noexcept;
+
+   ///Number of bytes that can be read, called by the consumer
+   size_t ReadAvailable() const noexcept;
+   /**
+    * \brief Reads exactly size bytes, called by the consumer.
+    * The rest of a record is available as soon as its first byte is
+    * \return false, reading nothing, if there is not enough data
+    */
+   bool Read(void* data, size_t size) noexcept;
+   ///Discards size bytes, if that many are available
+   bool Skip(size_t size) noexcept;
+};
@@ -289,6 +289,13 @@ std::shared_ptr<EffectInstance> LadspaEffectBase::MakeInstance() const
       mLatencyPort);
 }
 
+bool LadspaEffectBase::ProcessesTracksConcurrently() const
+{
+   // Each instance has its own plugin handle; the settings, to which input
+   // control ports connect, are only read
+   return true;
+}
+
 bool LadspaEffectBase::SaveSettings(
    const EffectSettings &settings, CommandParameters & parms) const
 {
@@ -67,6 +67,7 @@ protected:
    bool InitializeControls(LadspaEffectSettings &settings) const;
 
    std::shared_ptr<EffectInstance> MakeInstance() const override;
+   bool ProcessesTracksConcurrently() const override;
 
    bool CanExportPresets() const override;
 
@@ -13,6 +13,7 @@
 #include "LadspaInstance.h"       // This class's header file
 #include "ConfigInterface.h"
 #include "AudacityException.h"
+#include <limits>
 
 static const wchar_t *OptionsKey = L"Options";
 static const wchar_t *UseLatencyKey = L"UseLatency";
@@ -181,6 +182,9 @@ size_t LadspaInstance::ProcessBlock(EffectSettings &,
 
 bool LadspaInstance::RealtimeInitialize(EffectSettings &, double)
 {
+   // run() takes any sample count, so let each group process the whole
+   // buffer in one call, rather than in the small blocks requested before
+   SetBlockSize(std::numeric_limits<unsigned long>::max());
    return true;
 }
 
@@ -268,7 +272,7 @@ bool LadspaInstance::RealtimeProcessEnd(EffectSettings &) noexcept
 
 LADSPA_Handle LadspaInstance::InitInstance(
    float sampleRate, LadspaEffectSettings &settings,
-   LadspaEffectOutputs *pOutputs) const
+   LadspaEffectOutputs *pOutputs)
 {
    /* Instantiate the plugin */
    LADSPA_Handle handle = mData->instantiate(mData, sampleRate);
@@ -281,11 +285,9 @@ LADSPA_Handle LadspaInstance::InitInstance(
       if (LADSPA_IS_PORT_CONTROL(d)) {
          if (LADSPA_IS_PORT_INPUT(d))
             mData->connect_port(handle, p, &controls[p]);
-         else {
-            static LADSPA_Data sink;
+         else
             mData->connect_port(handle, p,
-               pOutputs ? &pOutputs->controls[p] : &sink);
-         }
+               pOutputs ? &pOutputs->controls[p] : &mOutputSink);
       }
    }
    if (mData->activate)
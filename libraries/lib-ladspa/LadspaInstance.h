@@ -95,7 +95,7 @@ struct LADSPA_API LadspaInstance
 
    LADSPA_Handle InitInstance(
       float sampleRate, LadspaEffectSettings &settings,
-      LadspaEffectOutputs *pOutputs) const;
+      LadspaEffectOutputs *pOutputs);
    void FreeInstance(LADSPA_Handle handle) const;
 
    const LADSPA_Descriptor *const mData;
@@ -108,6 +108,12 @@ struct LADSPA_API LadspaInstance
    // Realtime processing
    std::vector<LADSPA_Handle> mSlaves;
 
+   //! Receives output controls that nothing reads
+   /*!
+    One per instance, not static, because instances may run concurrently
+    */
+   LADSPA_Data mOutputSink{};
+
    const unsigned mAudioIns;
    const unsigned mAudioOuts;
    const int mLatencyPort;
@@ -24,6 +24,7 @@
 #include "LV2Wrapper.h"
 #include "LV2FeaturesList.h"
 #include "LV2Ports.h"
+#include "concurrency/ThreadPool.h"
 
 #if defined(__WXMSW__)
 #include <wx/msw/wrapwin.h>
@@ -110,12 +111,11 @@ void LV2Wrapper::ConnectPorts(const LV2Ports &ports, LV2PortStates &portStates,
 LV2Wrapper::~LV2Wrapper()
 {
    if (mInstance) {
-      if (mThread.joinable()) {
-         // Even if we have been freewheeling, this unblocks the unused thread
-         // so it can be joined
-         mStopWorker = true;
-         mRequests.Post({ 0, NULL });  // Must do after writing mStopWorker
-         mThread.join();
+      {
+         // The pool task must not outlive this
+         std::unique_lock<std::mutex> lock{ mRequestsMutex };
+         mRequests.clear();
+         mWorkDone.wait(lock, [this]{ return !mWorking; });
       }
       Deactivate();
    }
@@ -152,10 +152,6 @@ LV2Wrapper::LV2Wrapper(CreateToken&&, LV2InstanceFeaturesList &baseFeatures,
    lilv_instance_get_extension_data(mInstance.get(), LV2_WORKER__interface))
 }
 {
-   if (mWorkerInterface)
-      mThread = std::thread{
-         std::mem_fn( &LV2Wrapper::ThreadFunction ), std::ref(*this)
-      };
 }
 
 void LV2Wrapper::Activate()
@@ -208,16 +204,26 @@ void LV2Wrapper::SendBlockSize()
    }
 }
 
-// Thread body
-void LV2Wrapper::ThreadFunction()
+// Pool task body
+void LV2Wrapper::DoWork()
 {
-   for (LV2Work work{};
-      // Must test mStopWorker only after reading mRequests
-      mRequests.Receive(work) == wxMSGQUEUE_NO_ERROR && !mStopWorker;
-   )
+   while (true) {
+      LV2Work work{};
+      {
+         std::lock_guard<std::mutex> lock{ mRequestsMutex };
+         if (mRequests.empty()) {
+            mWorking = false;
+            // Notify under the lock, because the destructor may follow
+            mWorkDone.notify_all();
+            return;
+         }
+         work = mRequests.front();
+         mRequests.pop_front();
+      }
       // Call foreign instance code in this thread, which is neither the
       // main nor the audio thread
       mWorkerInterface->work(mHandle, respond, this, work.size, work.data);
+   }
 }
 
 void LV2Wrapper::ConsumeResponses()
@@ -247,11 +253,22 @@ LV2_Worker_Status LV2Wrapper::ScheduleWork(uint32_t size, const void *data)
       // Not using another thread
       return mWorkerInterface->work(mHandle, respond, this, size, data);
    else {
-      // Put in the queue for the worker thread
+      // Put in the queue for a pool task
       // which will then do mWorkerInterface->work
-      const auto err = mRequests.Post({ size, data });
-      return (err == wxMSGQUEUE_NO_ERROR)
-         ? LV2_WORKER_SUCCESS : LV2_WORKER_ERR_UNKNOWN;
+      try {
+         std::lock_guard<std::mutex> lock{ mRequestsMutex };
+         mRequests.push_back({ size, data });
+         if (!mWorking) {
+            audacity::concurrency::ThreadPool::GetDefault().Post(
+               [this]{ DoWork(); },
+               audacity::concurrency::ThreadPool::Priority::Interactive);
+            mWorking = true;
+         }
+      }
+      catch (...) {
+         return LV2_WORKER_ERR_UNKNOWN;
+      }
+      return LV2_WORKER_SUCCESS;
    }
 }
 
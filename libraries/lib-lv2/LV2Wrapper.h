@@ -27,7 +27,9 @@
 #include "lv2/state/state.h"
 #include "lv2/worker/worker.h"
 
-#include <thread>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
 #include <wx/msgqueue.h>
 
 struct EffectOutputs;
@@ -59,12 +61,11 @@ public:
       const LV2EffectSettings &settings, float sampleRate,
       EffectOutputs *pOutputs);
 
-   //! Constructor may spawn a thread
    LV2Wrapper(CreateToken&&,
       LV2InstanceFeaturesList &baseFeatures,
       const LilvPlugin &plugin, float sampleRate);
 
-   //! If a thread was started, joins it
+   //! Drops pending work requests, and waits for any that has started
    ~LV2Wrapper();
 
    void ConnectControlPorts(const LV2Ports &ports,
@@ -93,7 +94,9 @@ public:
    const LV2WrapperFeaturesList &GetFeatures() const { return mFeaturesList; }
 
 private:
-   void ThreadFunction();
+   //! Body of a task in the shared thread pool; does the queued requests
+   //! in order, so that work for this instance is never concurrent
+   void DoWork();
 
    // Another object with an explicit virtual function table
    LV2_Worker_Schedule mWorkerSchedule{ this, LV2Wrapper::schedule_work };
@@ -113,17 +116,18 @@ private:
    // Worker extension
    const LV2_Worker_Interface *const mWorkerInterface;
 
-   std::thread mThread;
-   wxMessageQueue<LV2Work> mRequests;
+   //! Requests are served by tasks in the thread pool shared by all
+   //! instances, not by a thread for each instance
+   std::mutex mRequestsMutex;
+   std::condition_variable mWorkDone;
+   std::deque<LV2Work> mRequests;
+   //! Whether a task is posted or running, guarded by mRequestsMutex
+   bool mWorking{ false };
    wxMessageQueue<LV2Work> mResponses;
    float mLatency{ 0.0 };
 
-   //! If true, do not spawn extra worker threads
+   //! If true, do work in the scheduling thread
    bool mFreeWheeling{ false };
-
-   //! Written by main thread, read by worker, but atomic isn't needed because
-   //! mRequests provides synchronization
-   bool mStopWorker{ false };
    bool mActivated{ false };
 };
 
@@ -39,12 +39,15 @@ and get deterministic behaviour.
 
 #include "Internat.h"
 #include "Prefs.h"
+#include "SampleConversion.h"
 
 // Erik de Castro Lopo's header file that
 // makes sure that we have lrint and lrintf
 // (Note: this file should be included first)
 #include "float_cast.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <stdlib.h>
 #include <math.h>
 #include <string.h>
@@ -54,6 +57,16 @@ and get deterministic behaviour.
 
 #include <wx/defs.h>
 
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#  if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#     define DITHER_SSE2
+#     include <emmintrin.h>
+#  endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#  define DITHER_NEON
+#  include <arm_neon.h>
+#endif
+
 //////////////////////////////////////////////////////////////////////////
 
 // Constants for the noise shaping buffer
@@ -68,14 +81,84 @@ struct State {
     int mPhase;
     float mTriangleState;
     float mBuffer[8 /* = BUF_SIZE */];
+    // Of the generator of noise
+    uint32_t mSeed;
 } mState;
 
 using Ditherer = float (*)(State &, float);
 
+// The noise comes from a linear congruential generator, which may also take
+// four steps at once in the lanes of a vector, giving the same sequence
+constexpr uint32_t LCG_A = 1664525u;
+constexpr uint32_t LCG_C = 1013904223u;
+constexpr uint32_t LCG_A4 = LCG_A * LCG_A * LCG_A * LCG_A;
+constexpr uint32_t LCG_C4 = LCG_C * (1u + LCG_A + LCG_A * LCG_A
+    + LCG_A * LCG_A * LCG_A);
+constexpr float NOISE_SCALE = 1.0f / (1 << 24);
+
+// The high 24 bits as a signed fraction, exactly
+static inline float TO_NOISE(uint32_t seed)
+{
+    return float(int32_t(seed) >> 8) * NOISE_SCALE;
+}
+
 // This is supposed to produce white noise and no dc
-static inline float DITHER_NOISE()
+static inline float DITHER_NOISE(State &state)
 {
-    return rand() / (float)RAND_MAX - 0.5f;
+    state.mSeed = state.mSeed * LCG_A + LCG_C;
+    return TO_NOISE(state.mSeed);
+}
+
+// The same as len calls of DITHER_NOISE
+static void FILL_NOISE(State &state, float *noise, size_t len)
+{
+    size_t ii = 0;
+#if defined(DITHER_SSE2) || defined(DITHER_NEON)
+    if (len >= 4) {
+        uint32_t seeds[4];
+        for (auto &seed : seeds)
+            seed = state.mSeed = state.mSeed * LCG_A + LCG_C;
+        const auto whole = len - len % 4;
+#if defined(DITHER_SSE2)
+        // SSE2 multiplies only the even lanes, widening
+        const auto mul = [](__m128i x, __m128i a) {
+            const auto even = _mm_mul_epu32(x, a);
+            const auto odd =
+                _mm_mul_epu32(_mm_srli_epi64(x, 32), _mm_srli_epi64(a, 32));
+            return _mm_unpacklo_epi32(
+                _mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+        };
+        const auto a = _mm_set1_epi32(int(LCG_A4));
+        const auto c = _mm_set1_epi32(int(LCG_C4));
+        const auto scale = _mm_set1_ps(NOISE_SCALE);
+        auto x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(seeds));
+        auto last = x;
+        for (; ii < whole; ii += 4) {
+            _mm_storeu_ps(noise + ii,
+                _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(x, 8)), scale));
+            last = x;
+            x = _mm_add_epi32(mul(x, a), c);
+        }
+        state.mSeed = uint32_t(_mm_cvtsi128_si32(
+            _mm_shuffle_epi32(last, _MM_SHUFFLE(3, 3, 3, 3))));
+#else
+        const auto a = vdupq_n_u32(LCG_A4);
+        const auto c = vdupq_n_u32(LCG_C4);
+        auto x = vld1q_u32(seeds);
+        auto last = x;
+        for (; ii < whole; ii += 4) {
+            vst1q_f32(noise + ii, vmulq_n_f32(vcvtq_f32_s32(
+                vshrq_n_s32(vreinterpretq_s32_u32(x), 8)), NOISE_SCALE));
+            last = x;
+            x = vmlaq_u32(c, x, a);
+        }
+        state.mSeed = vgetq_lane_u32(last, 3);
+#endif
+    }
+#endif
+    for (; ii < len; ++ii)
+        noise[ii] = DITHER_NOISE(state);
 }
 
 // Defines for sample conversion
@@ -157,16 +240,93 @@ static inline void DITHER_LOOP( Ditherer dither, State &state,
         }
 }
 
+static inline float NoDither(State &, float sample);
+static inline float RectangleDither(State &, float sample);
+static inline float TriangleDither(State &state, float sample);
+static inline float ShapedDither(State &state, float sample);
+static inline float ShapedStep(State &state, float sample, float r);
+
+// Implement a dithering loop over contiguous float samples, by blocks.  The
+// clipping and scaling, the noise, and the stores go through vector kernels;
+// only the feedback of shaped dither goes one sample at a time.  The results
+// equal those of DITHER_LOOP.
+template<typename dstType>
+static inline void DITHER_FLOAT_BLOCKS( DitherType ditherType, State &state,
+    dstType *dst, size_t dstStride, const float *src, size_t len,
+    float scale, dstType min_bound, dstType max_bound,
+    void (*round)(const float *, dstType *, size_t))
+{
+    constexpr size_t blockSize = 256;
+    float block[blockSize];
+    float noise[2 * blockSize];
+    while (len > 0) {
+        const auto count = std::min(len, blockSize);
+        SampleConversion::ClipAndScale(src, block, count, scale);
+        switch (ditherType) {
+        case DitherType::rectangle:
+            FILL_NOISE(state, noise, count);
+            for (size_t ii = 0; ii < count; ++ii)
+                block[ii] -= noise[ii];
+            break;
+        case DitherType::triangle: {
+            FILL_NOISE(state, noise, count);
+            block[0] = block[0] + noise[0] - state.mTriangleState;
+            for (size_t ii = 1; ii < count; ++ii)
+                block[ii] = block[ii] + noise[ii] - noise[ii - 1];
+            state.mTriangleState = noise[count - 1];
+            break;
+        }
+        case DitherType::shaped:
+            FILL_NOISE(state, noise, 2 * count);
+            for (size_t ii = 0; ii < count; ++ii)
+                block[ii] = ShapedStep(state, block[ii],
+                    noise[2 * ii] + noise[2 * ii + 1]);
+            break;
+        default:
+            break;
+        }
+        if (dstStride == 1)
+            round(block, dst, count);
+        else
+            for (size_t ii = 0; ii < count; ++ii)
+                IMPLEMENT_STORE<dstType>(dst + ii * dstStride,
+                    block[ii], min_bound, max_bound);
+        dst += count * dstStride;
+        src += count;
+        len -= count;
+    }
+}
+
 // Implement a dither. There are only 3 cases where we must dither,
 // in all other cases, no dithering is necessary.
-static inline void DITHER( Ditherer dither, State &state,
+static inline void DITHER( DitherType ditherType, State &state,
    samplePtr dst, sampleFormat dstFormat, size_t dstStride,
    constSamplePtr src, sampleFormat srcFormat, size_t srcStride, size_t len)
 {
+    Ditherer dither = NoDither;
+    switch (ditherType) {
+    case DitherType::rectangle: dither = RectangleDither; break;
+    case DitherType::triangle: dither = TriangleDither; break;
+    case DitherType::shaped: dither = ShapedDither; break;
+    default: break;
+    }
+
     if (srcFormat == int24Sample && dstFormat == int16Sample)
         DITHER_LOOP<int, short>(dither, state,
             DITHER_TO_INT16, FROM_INT24, dst,
             int16Sample, dstStride, src, int24Sample, srcStride, len);
+    else if (srcFormat == floatSample && srcStride == 1 && dstFormat == int16Sample)
+        DITHER_FLOAT_BLOCKS<short>(ditherType, state,
+            reinterpret_cast<short *>(dst), dstStride,
+            reinterpret_cast<const float *>(src), len,
+            CONVERT_DIV16, short(-32768), short(32767),
+            SampleConversion::RoundToInt16);
+    else if (srcFormat == floatSample && srcStride == 1 && dstFormat == int24Sample)
+        DITHER_FLOAT_BLOCKS<int>(ditherType, state,
+            reinterpret_cast<int *>(dst), dstStride,
+            reinterpret_cast<const float *>(src), len,
+            CONVERT_DIV24, -8388608, 8388607,
+            SampleConversion::RoundToInt24);
     else if (srcFormat == floatSample && dstFormat == int16Sample)
         DITHER_LOOP<float, short>(dither, state,
             DITHER_TO_INT16, FROM_FLOAT, dst,
@@ -178,11 +338,17 @@ static inline void DITHER( Ditherer dither, State &state,
     else { wxASSERT(false); }
 }
 
+// Reset the filters, but not the generator of noise, so that noise does not
+// repeat from one conversion to the next
+static inline void RESET_FILTERS(State &state)
+{
+    state.mTriangleState = 0;
+    state.mPhase = 0;
+    memset(state.mBuffer, 0, sizeof(float) * BUF_SIZE);
+}
 
-static inline float NoDither(State &, float sample);
-static inline float RectangleDither(State &, float sample);
-static inline float TriangleDither(State &state, float sample);
-static inline float ShapedDither(State &state, float sample);
+// Any fixed seed makes dithering reproducible after Reset()
+constexpr uint32_t INITIAL_SEED = 22222u;
 
 Dither::Dither()
 {
@@ -192,9 +358,8 @@ Dither::Dither()
 
 void Dither::Reset()
 {
-    mState.mTriangleState = 0;
-    mState.mPhase = 0;
-    memset(mState.mBuffer, 0, sizeof(float) * BUF_SIZE);
+    RESET_FILTERS(mState);
+    mState.mSeed = INITIAL_SEED;
 }
 
 // This only decides if we must dither at all, the dithers
@@ -278,6 +443,12 @@ void Dither::Apply(enum DitherType ditherType,
         // No clipping should be necessary.
         auto d = (float*)dest;
 
+        if (destStride == 1 && sourceStride == 1 && sourceFormat == int16Sample)
+            SampleConversion::Int16ToFloat((const short*)source, d, len);
+        else
+        if (destStride == 1 && sourceStride == 1 && sourceFormat == int24Sample)
+            SampleConversion::Int24ToFloat((const int*)source, d, len);
+        else
         if (sourceFormat == int16Sample)
         {
             auto s = (const short*)source;
@@ -306,18 +477,35 @@ void Dither::Apply(enum DitherType ditherType,
         switch (ditherType)
         {
         case DitherType::none:
-            DITHER(NoDither, mState, dest, destFormat, destStride, source, sourceFormat, sourceStride, len);
+            if (destStride == 1 && sourceStride == 1 &&
+                sourceFormat == floatSample)
+            {
+                // Plain conversion of contiguous samples by vector kernels
+                if (destFormat == int16Sample)
+                {
+                    SampleConversion::FloatToInt16(
+                        (const float*)source, (short*)dest, len);
+                    break;
+                }
+                if (destFormat == int24Sample)
+                {
+                    SampleConversion::FloatToInt24(
+                        (const float*)source, (int*)dest, len);
+                    break;
+                }
+            }
+            DITHER(ditherType, mState, dest, destFormat, destStride, source, sourceFormat, sourceStride, len);
             break;
         case DitherType::rectangle:
-            DITHER(RectangleDither, mState, dest, destFormat, destStride, source, sourceFormat, sourceStride, len);
+            DITHER(ditherType, mState, dest, destFormat, destStride, source, sourceFormat, sourceStride, len);
             break;
         case DitherType::triangle:
-            Reset(); // reset dither filter for this NEW conversion
-            DITHER(TriangleDither, mState, dest, destFormat, destStride, source, sourceFormat, sourceStride, len);
+            RESET_FILTERS(mState); // for this NEW conversion
+            DITHER(ditherType, mState, dest, destFormat, destStride, source, sourceFormat, sourceStride, len);
             break;
         case DitherType::shaped:
-            Reset(); // reset dither filter for this NEW conversion
-            DITHER(ShapedDither, mState, dest, destFormat, destStride, source, sourceFormat, sourceStride, len);
+            RESET_FILTERS(mState); // for this NEW conversion
+            DITHER(ditherType, mState, dest, destFormat, destStride, source, sourceFormat, sourceStride, len);
             break;
         default:
             wxASSERT(false); // unknown dither algorithm
@@ -334,15 +522,15 @@ inline float NoDither(State &, float sample)
 }
 
 // Rectangle dithering, apply one-step noise
-inline float RectangleDither(State &, float sample)
+inline float RectangleDither(State &state, float sample)
 {
-    return sample - DITHER_NOISE();
+    return sample - DITHER_NOISE(state);
 }
 
 // Triangle dither - high pass filtered
 inline float TriangleDither(State &state, float sample)
 {
-    float r = DITHER_NOISE();
+    float r = DITHER_NOISE(state);
     float result = sample + r - state.mTriangleState;
     state.mTriangleState = r;
 
@@ -353,7 +541,14 @@ inline float TriangleDither(State &state, float sample)
 inline float ShapedDither(State &state, float sample)
 {
     // Generate triangular dither, +-1 LSB, flat psd
-    float r = DITHER_NOISE() + DITHER_NOISE();
+    float r = DITHER_NOISE(state);
+    r += DITHER_NOISE(state);
+    return ShapedStep(state, sample, r);
+}
+
+// Shaped dither, given the triangular noise
+inline float ShapedStep(State &state, float sample, float r)
+{
     if(sample != sample)  // test for NaN
        sample = 0; // and do the best we can with it
 
@@ -10,6 +10,7 @@
 
 #include "InterpolateAudio.h"
 
+#include <algorithm>
 #include <math.h>
 #include <stdlib.h>
 
@@ -134,16 +135,21 @@ void InterpolateAudio(float *buffer, const size_t len,
    Matrix X(P, P);
    Vector b(P);
 
+   // X is symmetric, so accumulate only the upper triangle
    for(size_t i = 0; i + P < len; i++)
       if (i+P < firstBad || i >= (firstBad + numBad))
          for(size_t row=0; row<P; row++) {
-            for(size_t col=0; col<P; col++)
+            for(size_t col=row; col<P; col++)
                X[row][col] += (s[i+row] * s[i+col]);
             b[row] += s[i+P] * s[i+row];
          }
+   for(size_t row=1; row<P; row++)
+      for(size_t col=0; col<row; col++)
+         X[row][col] = X[col][row];
 
-   Matrix Xinv(P, P);
-   if (!InvertMatrix(X, Xinv)) {
+   // This vector will contain the autoregression coefficients
+   Vector a;
+   if (!SolveLinear(X, b, a)) {
       // The matrix is singular!  Fall back on linear...
       // In practice I have never seen this happen if
       // we add the tiny bit of random noise.
@@ -151,52 +157,51 @@ void InterpolateAudio(float *buffer, const size_t len,
       return;
    }
 
-   // This vector now contains the autoregression coefficients
-   const Vector &a = Xinv * b;
-
-   // Create a matrix (a "Toeplitz" matrix, as it turns out)
-   // which encodes the autoregressive relationship between
-   // elements of the sequence.
-   Matrix A(N-P, N);
-   for(size_t row=0; row<N-P; row++) {
-      for(size_t col=0; col<P; col++)
-         A[row][row+col] = -a[col];
-      A[row][row+P] = 1;
+   // The autoregressive relationship between elements of the sequence is
+   // a (Toeplitz) matrix A of N-P rows, where row r has -a in columns r to
+   // r+P-1 and 1 in column r+P.  Split into columns of the unknown (bad)
+   // samples, Au, and of the known (good) ones, Ak, the best guess of the
+   // unknown samples su solves (AuT Au) su = -AuT Ak sk.
+   // A is banded, so it is not formed, and the products cost O(N P) and
+   // O(N P^2) instead of O(N^2 numBad).
+   const auto coef = [&](size_t offset){
+      return offset < P ? -a[offset] : 1.0;
+   };
+   const auto isBad = [&](size_t col){
+      return col >= firstBad && col < firstBad + numBad;
+   };
+
+   // AuT Au, and -AuT Ak sk, from the only rows that meet bad columns,
+   // which they do in [row, row + P]
+   Matrix X1(numBad, numBad);
+   Vector rhs(numBad);
+   const auto firstRow = firstBad > P ? firstBad - P : 0;
+   const auto endRow = std::min(N - P, firstBad + numBad);
+   for(size_t row=firstRow; row<endRow; row++) {
+      // Row of Ak sk
+      double r = 0;
+      for(size_t offset=0; offset<=P; offset++)
+         if (!isBad(row + offset))
+            r += coef(offset) * s[row + offset];
+
+      const auto first = std::max(row, firstBad);
+      const auto last = std::min(row + P + 1, firstBad + numBad);
+      for(auto col1=first; col1<last; col1++) {
+         const auto c1 = coef(col1 - row);
+         rhs[col1 - firstBad] -= c1 * r;
+         for(auto col2=first; col2<last; col2++)
+            X1[col1 - firstBad][col2 - firstBad] += c1 * coef(col2 - row);
+      }
    }
 
-   // Split both the Toeplitz matrix and the signal into
-   // two pieces.  Note that this code could be made to
-   // work even in the case where the "bad" samples are
-   // not contiguous, but currently it assumes they are.
-   //   "u" is for unknown (bad)
-   //   "k" is for known (good)
-   Matrix Au = MatrixSubset(A, 0, N-P, firstBad, numBad);
-   Matrix A_left = MatrixSubset(A, 0, N-P, 0, firstBad);
-   Matrix A_right = MatrixSubset(A, 0, N-P,
-                                 firstBad+numBad, N-(firstBad+numBad));
-   Matrix Ak = MatrixConcatenateCols(A_left, A_right);
-
-   const Vector &s_left = VectorSubset(s, 0, firstBad);
-   const Vector &s_right = VectorSubset(s, firstBad+numBad,
-                                 N-(firstBad+numBad));
-   const Vector &sk = VectorConcatenate(s_left, s_right);
-
-   // Do some linear algebra to find the best possible
-   // values that fill in the "bad" area
-   Matrix AuT = TransposeMatrix(Au);
-   Matrix X1 = MatrixMultiply(AuT, Au);
-   Matrix X2(X1.Rows(), X1.Cols());
-   if (!InvertMatrix(X1, X2)) {
+   // This vector contains our best guess as to the
+   // unknown values
+   Vector su;
+   if (!SolveLinear(X1, rhs, su)) {
       // The matrix is singular!  Fall back on linear...
       LinearInterpolateAudio(buffer, len, firstBad, numBad);
       return;
    }
-   Matrix X2b = X2 * -1.0;
-   Matrix X3 = MatrixMultiply(X2b, AuT);
-   Matrix X4 = MatrixMultiply(X3, Ak);
-   // This vector contains our best guess as to the
-   // unknown values
-   const Vector &su = X4 * sk;
 
    // Put the results into the return buffer
    for(size_t i=0; i<numBad; i++)
@@ -0,0 +1,143 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  LookaheadCompressor.cpp
+
+**********************************************************************/
+#include "LookaheadCompressor.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace {
+double SmoothingCoefficient(double ms, double sampleRate)
+{
+   const auto samples = ms * 0.001 * sampleRate;
+   return samples > 0 ? std::exp(-1.0 / samples) : 0.0;
+}
+}
+
+LookaheadCompressor::LookaheadCompressor(size_t nChannels,
+   double sampleRate, double lookaheadMs, const Parameters &parameters
+)  : mChannels{ nChannels }
+   , mSampleRate{ sampleRate }
+   , mLookahead{ static_cast<size_t>(
+      std::max(0.0, std::round(lookaheadMs * 0.001 * sampleRate))) }
+   , mMinQueue(mLookahead + 1)
+   , mDelay(nChannels, std::vector<float>(mLookahead + ChunkSize))
+   , mLevel(ChunkSize)
+   , mGain(ChunkSize)
+   , mInputs(nChannels)
+   , mOutputs(nChannels)
+{
+   SetParameters(parameters);
+}
+
+void LookaheadCompressor::SetParameters(const Parameters &parameters)
+{
+   mParameters = parameters;
+   mAttackCoefficient = SmoothingCoefficient(parameters.attackMs, mSampleRate);
+   mReleaseCoefficient =
+      SmoothingCoefficient(parameters.releaseMs, mSampleRate);
+}
+
+void LookaheadCompressor::Reset()
+{
+   mGainDb = 0;
+   mQueueHead = mQueueSize = 0;
+   mIndex = 0;
+   for (auto &delay : mDelay)
+      std::fill(delay.begin(), delay.end(), 0.0f);
+}
+
+double LookaheadCompressor::StaticCurve(
+   const Parameters &parameters, double levelDb)
+{
+   const auto slope = 1.0 / parameters.ratio - 1.0;
+   const auto over = levelDb - parameters.thresholdDb;
+   const auto halfKnee = parameters.kneeDb / 2;
+   if (over <= -halfKnee)
+      return 0;
+   if (over >= halfKnee)
+      return slope * over;
+   // Quadratic through the knee, meeting both lines with equal slopes
+   const auto t = over + halfKnee;
+   return slope * t * t / (2 * parameters.kneeDb);
+}
+
+void LookaheadCompressor::Process(
+   const float *const *in, float *const *out, size_t len)
+{
+   std::copy(in, in + mChannels, mInputs.begin());
+   std::copy(out, out + mChannels, mOutputs.begin());
+   while (len > 0) {
+      const auto count = std::min(len, ChunkSize);
+      ProcessChunk(mInputs.data(), mOutputs.data(), count);
+      for (size_t iChannel = 0; iChannel < mChannels; ++iChannel) {
+         mInputs[iChannel] += count;
+         mOutputs[iChannel] += count;
+      }
+      len -= count;
+   }
+}
+
+void LookaheadCompressor::ProcessChunk(
+   const float *const *in, float *const *out, size_t len)
+{
+   assert(len <= ChunkSize);
+   const auto level = mLevel.data();
+   const auto gain = mGain.data();
+
+   // Linked peak detector
+   std::fill(level, level + len, 0.0f);
+   for (size_t iChannel = 0; iChannel < mChannels; ++iChannel) {
+      const auto pIn = in[iChannel];
+      for (size_t ii = 0; ii < len; ++ii)
+         level[ii] = std::max(level[ii], std::abs(pIn[ii]));
+   }
+
+   // Gain computer
+   for (size_t ii = 0; ii < len; ++ii)
+      gain[ii] = StaticCurve(mParameters,
+         20 * std::log10(std::max(level[ii], 1e-10f)));
+
+   // The least gain of the lookahead window, then smoothing
+   const auto window = mLookahead + 1;
+   auto gainDb = mGainDb;
+   for (size_t ii = 0; ii < len; ++ii) {
+      const auto index = mIndex++;
+      const auto target = gain[ii];
+      while (mQueueSize > 0 && mMinQueue[
+         (mQueueHead + mQueueSize - 1) % window].second >= target)
+         --mQueueSize;
+      mMinQueue[(mQueueHead + mQueueSize++) % window] = { index, target };
+      if (mMinQueue[mQueueHead].first + window <= index) {
+         mQueueHead = (mQueueHead + 1) % window;
+         --mQueueSize;
+      }
+      const double least = mMinQueue[mQueueHead].second;
+      const auto coefficient =
+         least < gainDb ? mAttackCoefficient : mReleaseCoefficient;
+      gainDb = least + coefficient * (gainDb - least);
+      gain[ii] = gainDb;
+   }
+   mGainDb = gainDb;
+
+   const auto makeupDb = mParameters.makeupDb;
+   for (size_t ii = 0; ii < len; ++ii)
+      gain[ii] = std::pow(10.0f, (gain[ii] + float(makeupDb)) / 20);
+
+   // Delay by the lookahead and apply the gain
+   for (size_t iChannel = 0; iChannel < mChannels; ++iChannel) {
+      const auto delay = mDelay[iChannel].data();
+      // Take the input before overwriting it, if in place
+      std::copy(in[iChannel], in[iChannel] + len, delay + mLookahead);
+      const auto pOut = out[iChannel];
+      for (size_t ii = 0; ii < len; ++ii)
+         pOut[ii] = delay[ii] * gain[ii];
+      std::copy(delay + len, delay + len + mLookahead, delay);
+   }
+}
@@ -0,0 +1,94 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  LookaheadCompressor.h
+
+**********************************************************************/
+#pragma once
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+//! Single-pass feed-forward compressor and limiter with lookahead
+/*!
+ Samples go through in blocks.  The detector takes the peak of the linked
+ channels; the gain computer applies threshold, ratio and a soft knee in dB.
+ The gain reduction that will be needed within the lookahead is then applied
+ ahead of time, smoothed by attack and release, to audio delayed by the
+ lookahead, which is therefore also the latency.
+
+ The detector, gain computer and gain stages are loops over whole blocks that
+ compilers can vectorize; only the sliding minimum and the smoothing recur
+ sample by sample.
+ */
+class MATH_API LookaheadCompressor final
+{
+public:
+   struct Parameters {
+      double thresholdDb{ -12.0 };
+      //! Above 1; large values make a limiter
+      double ratio{ 4.0 };
+      //! Width of the soft knee, centered on the threshold; 0 for hard knee
+      double kneeDb{ 6.0 };
+      double attackMs{ 10.0 };
+      double releaseMs{ 150.0 };
+      double makeupDb{ 0.0 };
+   };
+
+   /*!
+    @param lookaheadMs fixed for the life of the object, because it is the
+    latency
+    */
+   LookaheadCompressor(size_t nChannels, double sampleRate,
+      double lookaheadMs, const Parameters &parameters);
+
+   //! Takes effect smoothly from the next sample; does not allocate
+   void SetParameters(const Parameters &parameters);
+
+   //! Latency in samples
+   size_t Latency() const { return mLookahead; }
+
+   //! Process `len` samples of each channel, which may be in place;
+   //! does not allocate
+   void Process(const float *const *in, float *const *out, size_t len);
+
+   //! Forget all input, as if newly constructed
+   void Reset();
+
+   //! Gain change in dB for a detector level in dB, before smoothing
+   static double StaticCurve(const Parameters &parameters, double levelDb);
+
+private:
+   void ProcessChunk(const float *const *in, float *const *out, size_t len);
+
+   static constexpr size_t ChunkSize = 512;
+
+   const size_t mChannels;
+   const double mSampleRate;
+   const size_t mLookahead;
+
+   Parameters mParameters;
+   double mAttackCoefficient{};
+   double mReleaseCoefficient{};
+
+   //! Smoothed gain change in dB
+   double mGainDb{ 0 };
+
+   //! Monotonic queue of (index, target) for the sliding minimum
+   std::vector<std::pair<size_t, float>> mMinQueue;
+   size_t mQueueHead{ 0 };
+   size_t mQueueSize{ 0 };
+   //! Count of samples taken, for the sliding window
+   size_t mIndex{ 0 };
+
+   //! For each channel, lookahead history followed by room for a chunk
+   std::vector<std::vector<float>> mDelay;
+   std::vector<float> mLevel;
+   std::vector<float> mGain;
+   //! Channel pointers advanced through the chunks, so as not to allocate
+   std::vector<const float*> mInputs;
+   std::vector<float*> mOutputs;
+};
@@ -343,3 +343,62 @@ bool InvertMatrix(const Matrix& input, Matrix& Minv)
 
    return true;
 }
+
+bool SolveLinear(const Matrix& input, const Vector& b, Vector& x)
+{
+   // Gaussian elimination with partial pivoting, then back substitution,
+   // costing a third of the inversion.  The right hand side is an extra
+   // column, and the inner loops run over contiguous rows, so that they
+   // may be vectorized.
+   // Returns true if successful
+
+   wxASSERT(input.Rows() == input.Cols());
+   wxASSERT(b.Len() == input.Rows());
+   const auto N = input.Rows();
+
+   Matrix M(N, N + 1);
+   for(unsigned i = 0; i < N; i++) {
+      for(unsigned j = 0; j < N; j++)
+         M[i][j] = input[i][j];
+      M[i][N] = b[i];
+   }
+
+   for(unsigned i = 0; i < N; i++) {
+      double absmax = 0.0;
+      unsigned int argmax = 0;
+      for(unsigned j = i; j < N; j++)
+         if (fabs(M[j][i]) > absmax) {
+            absmax = fabs(M[j][i]);
+            argmax = j;
+         }
+
+      // If no row has a nonzero value in that column,
+      // the matrix is singular and we have to give up.
+      if (absmax == 0)
+         return false;
+
+      if (i != argmax)
+         M.SwapRows(i, argmax);
+
+      const double *const pivot = &M[i][0];
+      for(unsigned j = i + 1; j < N; j++) {
+         double *const row = &M[j][0];
+         const double factor = row[i] / pivot[i];
+         if (factor == 0)
+            continue;
+         for(unsigned k = i; k <= N; k++)
+            row[k] -= pivot[k] * factor;
+      }
+   }
+
+   x.Reinit(N);
+   for(unsigned i = N; i-- > 0;) {
+      const double *const row = &M[i][0];
+      double sum = row[N];
+      for(unsigned k = i + 1; k < N; k++)
+         sum -= row[k] * x[k];
+      x[i] = sum / row[i];
+   }
+
+   return true;
+}
@@ -110,4 +110,8 @@ Matrix MatrixConcatenateCols(const Matrix& left, const Matrix& right);
 
 bool InvertMatrix(const Matrix& M, Matrix& Minv);
 
+//! Solve M x = b, without inverting M
+/*! @return false if M is singular */
+bool SolveLinear(const Matrix& M, const Vector& b, Vector& x);
+
 #endif // __AUDACITY_MATRIX__
@@ -0,0 +1,175 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file MeterLevels.cpp
+
+*******************************************************************//*!
+
+\file MeterLevels.cpp
+\brief SSE2 and NEON passes for peak and RMS, and a scalar pass for the
+  rest
+
+  A vector of four consecutive samples holds four channels, or two frames of
+  two channels, or four frames of one channel; so each lane always holds the
+  same channel, and lanes are folded into channels at the end.
+
+*//*******************************************************************/
+
+#include "MeterLevels.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#  if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#     define METER_LEVELS_SSE2
+#     include <emmintrin.h>
+#  endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#  define METER_LEVELS_NEON
+#  include <arm_neon.h>
+#endif
+
+namespace MeterLevels {
+namespace {
+
+constexpr size_t Lanes = 4;
+//! Groups of four channels accumulated in one pass over the buffer
+constexpr size_t MaxGroups = 16;
+
+//! Accumulate the peak and sum of squares of each lane of groups
+//! [firstGroup, firstGroup + nGroups) of rows of width floats
+void VectorPass(const float *samples, size_t width, size_t rows,
+   size_t firstGroup, size_t nGroups, float *peaks, float *sumsqs)
+{
+#if defined(METER_LEVELS_SSE2)
+   const auto absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+   __m128 peak[MaxGroups], sumsq[MaxGroups];
+   for (size_t gg = 0; gg < nGroups; ++gg)
+      peak[gg] = sumsq[gg] = _mm_setzero_ps();
+   for (size_t row = 0; row < rows; ++row) {
+      const auto pRow = samples + row * width + firstGroup * Lanes;
+      for (size_t gg = 0; gg < nGroups; ++gg) {
+         const auto x = _mm_loadu_ps(pRow + gg * Lanes);
+         peak[gg] = _mm_max_ps(peak[gg], _mm_and_ps(x, absMask));
+         sumsq[gg] = _mm_add_ps(sumsq[gg], _mm_mul_ps(x, x));
+      }
+   }
+   for (size_t gg = 0; gg < nGroups; ++gg) {
+      _mm_storeu_ps(peaks + gg * Lanes, peak[gg]);
+      _mm_storeu_ps(sumsqs + gg * Lanes, sumsq[gg]);
+   }
+#elif defined(METER_LEVELS_NEON)
+   float32x4_t peak[MaxGroups], sumsq[MaxGroups];
+   for (size_t gg = 0; gg < nGroups; ++gg)
+      peak[gg] = sumsq[gg] = vdupq_n_f32(0);
+   for (size_t row = 0; row < rows; ++row) {
+      const auto pRow = samples + row * width + firstGroup * Lanes;
+      for (size_t gg = 0; gg < nGroups; ++gg) {
+         const auto x = vld1q_f32(pRow + gg * Lanes);
+         peak[gg] = vmaxq_f32(peak[gg], vabsq_f32(x));
+         sumsq[gg] = vmlaq_f32(sumsq[gg], x, x);
+      }
+   }
+   for (size_t gg = 0; gg < nGroups; ++gg) {
+      vst1q_f32(peaks + gg * Lanes, peak[gg]);
+      vst1q_f32(sumsqs + gg * Lanes, sumsq[gg]);
+   }
+#else
+   // Lanes as arrays, which compilers may still vectorize
+   std::fill(peaks, peaks + nGroups * Lanes, 0.0f);
+   std::fill(sumsqs, sumsqs + nGroups * Lanes, 0.0f);
+   for (size_t row = 0; row < rows; ++row) {
+      const auto pRow = samples + row * width + firstGroup * Lanes;
+      for (size_t ii = 0; ii < nGroups * Lanes; ++ii) {
+         const auto x = pRow[ii];
+         peaks[ii] = std::max(peaks[ii], std::fabs(x));
+         sumsqs[ii] += x * x;
+      }
+   }
+#endif
+}
+
+//! Count runs of peaked samples of one channel
+void CountPeaks(const float *samples, size_t numChannels, size_t numFrames,
+   Levels &levels, int clipRun, float clipLevel)
+{
+   int run = 0;
+   auto head = numFrames;
+   for (size_t ii = 0; ii < numFrames; ++ii) {
+      if (std::fabs(samples[ii * numChannels]) >= clipLevel) {
+         if (++run > clipRun)
+            levels.clipping = true;
+      }
+      else {
+         if (head == numFrames)
+            head = ii;
+         run = 0;
+      }
+   }
+   levels.headPeakCount = static_cast<int>(head);
+   levels.tailPeakCount = run;
+}
+
+}
+
+void Measure(const float *samples, size_t numChannels,
+   size_t numFrames, Levels *levels, size_t numLevels,
+   int clipRun, float clipLevel)
+{
+   std::fill(levels, levels + numLevels, Levels{});
+   if (numLevels == 0 || numFrames == 0)
+      return;
+
+   // Sums of squares accumulate in the rms fields until the end
+   const auto total = numChannels * numFrames;
+   size_t width = 0;
+   if (numChannels % Lanes == 0)
+      width = numChannels;
+   else if (Lanes % numChannels == 0)
+      width = Lanes;
+   size_t done = 0;
+   if (width > 0) {
+      const auto rows = total / width;
+      // Only groups containing measured channels
+      const auto groups =
+         std::min(width / Lanes, (numLevels + Lanes - 1) / Lanes);
+      float peaks[MaxGroups * Lanes], sumsqs[MaxGroups * Lanes];
+      for (size_t first = 0; first < groups; first += MaxGroups) {
+         const auto nGroups = std::min(MaxGroups, groups - first);
+         VectorPass(samples, width, rows, first, nGroups, peaks, sumsqs);
+         for (size_t ii = 0; ii < nGroups * Lanes; ++ii) {
+            const auto channel = ((first * Lanes) + ii) % numChannels;
+            if (channel >= numLevels)
+               continue;
+            auto &level = levels[channel];
+            level.peak = std::max(level.peak, peaks[ii]);
+            level.rms += sumsqs[ii];
+         }
+      }
+      done = rows * width;
+   }
+
+   // The remainder, or all if no vector fits; it begins at channel 0, because
+   // width is a multiple of numChannels
+   for (auto ii = done; ii < total; ++ii) {
+      const auto channel = ii % numChannels;
+      if (channel >= numLevels)
+         continue;
+      const auto x = samples[ii];
+      auto &level = levels[channel];
+      level.peak = std::max(level.peak, std::fabs(x));
+      level.rms += x * x;
+   }
+
+   for (size_t channel = 0; channel < numLevels; ++channel) {
+      auto &level = levels[channel];
+      level.rms = std::sqrt(level.rms / numFrames);
+      if (level.peak >= clipLevel)
+         CountPeaks(samples + channel, numChannels, numFrames, level,
+            clipRun, clipLevel);
+   }
+}
+
+}
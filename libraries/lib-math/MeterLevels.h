@@ -0,0 +1,47 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file MeterLevels.h
+  @brief Peak, RMS and clipping of each channel of a buffer, as meters show
+  them, cheap enough for the audio callback
+
+**********************************************************************/
+
+#ifndef __AUDACITY_METER_LEVELS__
+#define __AUDACITY_METER_LEVELS__
+
+#include <cstddef>
+
+namespace MeterLevels {
+
+//! Levels of one channel over one buffer
+struct Levels {
+   float peak = 0;
+   float rms = 0;
+   //! Whether more than the given run of peaked samples occurred
+   bool clipping = false;
+   //! Peaked samples at the start and at the end of the buffer, so that runs
+   //! crossing buffers may be detected
+   int headPeakCount = 0;
+   int tailPeakCount = 0;
+};
+
+//! Measure the first numLevels channels of interleaved samples
+/*!
+ Peak and RMS are computed with vectors, for 1, 2 or any multiple of 4
+ channels, and otherwise by a scalar loop.  Peaked samples, of at least
+ clipLevel in magnitude, are counted only in channels whose peak reaches it,
+ so most buffers cost only the vector pass.
+
+ Does not allocate or lock.
+
+ @pre numLevels <= numChannels
+ */
+MATH_API void Measure(const float *samples, size_t numChannels,
+   size_t numFrames, Levels *levels, size_t numLevels,
+   int clipRun, float clipLevel);
+
+}
+
+#endif
@@ -0,0 +1,58 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file MixDown.cpp
+
+*******************************************************************//*!
+
+\file MixDown.cpp
+\brief SSE2 and NEON passes for the weighted sum, and a scalar pass for the
+  rest
+
+*//*******************************************************************/
+
+#include "MixDown.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#  if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#     define MIX_DOWN_SSE2
+#     include <emmintrin.h>
+#  endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#  define MIX_DOWN_NEON
+#  include <arm_neon.h>
+#endif
+
+namespace MixDown {
+
+void WeightedSum(const float *left, const float *right,
+   float leftWeight, float rightWeight, float *dst, size_t len)
+{
+   size_t ii = 0;
+#if defined(MIX_DOWN_SSE2)
+   const auto wl = _mm_set1_ps(leftWeight), wr = _mm_set1_ps(rightWeight);
+   for (; ii + 8 <= len; ii += 8) {
+      const auto l0 = _mm_loadu_ps(left + ii), l1 = _mm_loadu_ps(left + ii + 4);
+      const auto r0 = _mm_loadu_ps(right + ii),
+         r1 = _mm_loadu_ps(right + ii + 4);
+      _mm_storeu_ps(dst + ii,
+         _mm_add_ps(_mm_mul_ps(l0, wl), _mm_mul_ps(r0, wr)));
+      _mm_storeu_ps(dst + ii + 4,
+         _mm_add_ps(_mm_mul_ps(l1, wl), _mm_mul_ps(r1, wr)));
+   }
+#elif defined(MIX_DOWN_NEON)
+   const auto wl = vdupq_n_f32(leftWeight), wr = vdupq_n_f32(rightWeight);
+   for (; ii + 8 <= len; ii += 8) {
+      const auto l0 = vld1q_f32(left + ii), l1 = vld1q_f32(left + ii + 4);
+      const auto r0 = vld1q_f32(right + ii), r1 = vld1q_f32(right + ii + 4);
+      vst1q_f32(dst + ii, vaddq_f32(vmulq_f32(l0, wl), vmulq_f32(r0, wr)));
+      vst1q_f32(dst + ii + 4,
+         vaddq_f32(vmulq_f32(l1, wl), vmulq_f32(r1, wr)));
+   }
+#endif
+   for (; ii < len; ++ii)
+      dst[ii] = left[ii] * leftWeight + right[ii] * rightWeight;
+}
+
+}
@@ -0,0 +1,30 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file MixDown.h
+  @brief Weighted sums of two channels into one, as for mixing stereo to
+  mono
+
+**********************************************************************/
+
+#ifndef __AUDACITY_MIX_DOWN__
+#define __AUDACITY_MIX_DOWN__
+
+#include <cstddef>
+
+namespace MixDown {
+
+//! dst[i] = left[i] * leftWeight + right[i] * rightWeight
+/*!
+ With vectors, where the build supports SSE2 or NEON.  dst may be left or
+ right, but may not otherwise overlap them.
+
+ Does not allocate or lock.
+ */
+MATH_API void WeightedSum(const float *left, const float *right,
+   float leftWeight, float rightWeight, float *dst, size_t len);
+
+}
+
+#endif
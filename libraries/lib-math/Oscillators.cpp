@@ -0,0 +1,170 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file Oscillators.cpp
+
+*******************************************************************//*!
+
+\file Oscillators.cpp
+\brief SSE2 and NEON passes for sines and noise, and scalar passes for
+  the rest
+
+*//*******************************************************************/
+
+#include "Oscillators.h"
+
+#include <cmath>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#  if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#     define OSCILLATORS_SSE2
+#     include <emmintrin.h>
+#  endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#  define OSCILLATORS_NEON
+#  include <arm_neon.h>
+#endif
+
+namespace Oscillators {
+namespace {
+
+constexpr size_t Lanes = 4;
+constexpr double TwoPi = 2 * M_PI;
+
+//! Taylor coefficients of sin(2 pi x), enough for |x| <= 1/4
+constexpr float C1 = TwoPi;
+constexpr float C3 = -TwoPi * TwoPi * TwoPi / 6;
+constexpr float C5 = -C3 * TwoPi * TwoPi / 20;
+constexpr float C7 = -C5 * TwoPi * TwoPi / 42;
+constexpr float C9 = -C7 * TwoPi * TwoPi / 72;
+constexpr float C11 = -C9 * TwoPi * TwoPi / 110;
+
+float ScalarSine(float phase)
+{
+   // Reduce to [-1/2, 1/2], then fold to [-1/4, 1/4] by the symmetry of sine
+   // about a quarter cycle
+   auto x = phase - std::nearbyint(phase);
+   const auto half = std::copysign(0.5f, x);
+   if (std::fabs(x) > 0.25f)
+      x = half - x;
+   const auto x2 = x * x;
+   return x * (C1 + x2 * (C3 + x2 * (C5 + x2 * (C7 + x2 * (C9 + x2 * C11)))));
+}
+
+uint32_t Next(uint32_t &x)
+{
+   x ^= x << 13;
+   x ^= x >> 17;
+   x ^= x << 5;
+   return x;
+}
+
+//! Map 23 high bits to [-1, 1)
+float ToFloat(uint32_t bits)
+{
+   const uint32_t one = (bits >> 9) | 0x3f800000u;
+   float result;
+   std::memcpy(&result, &one, sizeof result);
+   return 2 * result - 3;
+}
+
+}
+
+void Sine(const float *phases, float *out, size_t len)
+{
+   size_t ii = 0;
+#if defined(OSCILLATORS_SSE2)
+   const auto signMask = _mm_castsi128_ps(_mm_set1_epi32(0x80000000));
+   const auto quarter = _mm_set1_ps(0.25f), half = _mm_set1_ps(0.5f);
+   for (; ii + Lanes <= len; ii += Lanes) {
+      const auto p = _mm_loadu_ps(phases + ii);
+      auto x = _mm_sub_ps(p, _mm_cvtepi32_ps(_mm_cvtps_epi32(p)));
+      const auto sign = _mm_and_ps(x, signMask);
+      const auto folded = _mm_sub_ps(_mm_or_ps(half, sign), x);
+      const auto fold = _mm_cmpgt_ps(_mm_andnot_ps(signMask, x), quarter);
+      x = _mm_or_ps(_mm_and_ps(fold, folded), _mm_andnot_ps(fold, x));
+      const auto x2 = _mm_mul_ps(x, x);
+      auto y = _mm_add_ps(_mm_set1_ps(C9), _mm_mul_ps(x2, _mm_set1_ps(C11)));
+      y = _mm_add_ps(_mm_set1_ps(C7), _mm_mul_ps(x2, y));
+      y = _mm_add_ps(_mm_set1_ps(C5), _mm_mul_ps(x2, y));
+      y = _mm_add_ps(_mm_set1_ps(C3), _mm_mul_ps(x2, y));
+      y = _mm_add_ps(_mm_set1_ps(C1), _mm_mul_ps(x2, y));
+      _mm_storeu_ps(out + ii, _mm_mul_ps(x, y));
+   }
+#elif defined(OSCILLATORS_NEON)
+   const auto quarter = vdupq_n_f32(0.25f);
+   for (; ii + Lanes <= len; ii += Lanes) {
+      const auto p = vld1q_f32(phases + ii);
+      auto x = vsubq_f32(p, vrndnq_f32(p));
+      const auto half = vbslq_f32(vdupq_n_u32(0x80000000), x, vdupq_n_f32(0.5f));
+      const auto fold = vcagtq_f32(x, quarter);
+      x = vbslq_f32(fold, vsubq_f32(half, x), x);
+      const auto x2 = vmulq_f32(x, x);
+      auto y = vmlaq_f32(vdupq_n_f32(C9), x2, vdupq_n_f32(C11));
+      y = vmlaq_f32(vdupq_n_f32(C7), x2, y);
+      y = vmlaq_f32(vdupq_n_f32(C5), x2, y);
+      y = vmlaq_f32(vdupq_n_f32(C3), x2, y);
+      y = vmlaq_f32(vdupq_n_f32(C1), x2, y);
+      vst1q_f32(out + ii, vmulq_f32(x, y));
+   }
+#endif
+   for (; ii < len; ++ii)
+      out[ii] = ScalarSine(phases[ii]);
+}
+
+NoiseState SeedNoise(uint32_t seed)
+{
+   NoiseState state;
+   // splitmix32 steps, which are distinct for distinct inputs
+   for (size_t lane = 0; lane < Lanes; ++lane) {
+      auto z = (seed += 0x9e3779b9u);
+      z = (z ^ (z >> 16)) * 0x85ebca6bu;
+      z = (z ^ (z >> 13)) * 0xc2b2ae35u;
+      z ^= z >> 16;
+      state.lanes[lane] = z ? z : 1;
+   }
+   return state;
+}
+
+void WhiteNoise(NoiseState &state, float *out, size_t len)
+{
+   size_t ii = 0;
+#if defined(OSCILLATORS_SSE2)
+   auto x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(state.lanes));
+   const auto exponent = _mm_set1_epi32(0x3f800000);
+   const auto two = _mm_set1_ps(2.0f), three = _mm_set1_ps(3.0f);
+   for (; ii + Lanes <= len; ii += Lanes) {
+      x = _mm_xor_si128(x, _mm_slli_epi32(x, 13));
+      x = _mm_xor_si128(x, _mm_srli_epi32(x, 17));
+      x = _mm_xor_si128(x, _mm_slli_epi32(x, 5));
+      const auto one =
+         _mm_castsi128_ps(_mm_or_si128(_mm_srli_epi32(x, 9), exponent));
+      _mm_storeu_ps(out + ii, _mm_sub_ps(_mm_mul_ps(two, one), three));
+   }
+   _mm_storeu_si128(reinterpret_cast<__m128i*>(state.lanes), x);
+#elif defined(OSCILLATORS_NEON)
+   auto x = vld1q_u32(state.lanes);
+   const auto exponent = vdupq_n_u32(0x3f800000);
+   const auto two = vdupq_n_f32(2.0f), three = vdupq_n_f32(3.0f);
+   for (; ii + Lanes <= len; ii += Lanes) {
+      x = veorq_u32(x, vshlq_n_u32(x, 13));
+      x = veorq_u32(x, vshrq_n_u32(x, 17));
+      x = veorq_u32(x, vshlq_n_u32(x, 5));
+      const auto one =
+         vreinterpretq_f32_u32(vorrq_u32(vshrq_n_u32(x, 9), exponent));
+      vst1q_f32(out + ii, vsubq_f32(vmulq_f32(two, one), three));
+   }
+   vst1q_u32(state.lanes, x);
+#else
+   for (; ii + Lanes <= len; ii += Lanes)
+      for (size_t lane = 0; lane < Lanes; ++lane)
+         out[ii + lane] = ToFloat(Next(state.lanes[lane]));
+#endif
+   // The remainder steps only the first lanes
+   for (size_t lane = 0; ii < len; ++ii, ++lane)
+      out[ii] = ToFloat(Next(state.lanes[lane]));
+}
+
+}
@@ -0,0 +1,42 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file Oscillators.h
+  @brief Sine waves and white noise for whole buffers at once, with vectors
+
+**********************************************************************/
+
+#ifndef __AUDACITY_OSCILLATORS__
+#define __AUDACITY_OSCILLATORS__
+
+#include <cstddef>
+#include <cstdint>
+
+namespace Oscillators {
+
+//! out[i] = sin(2 pi phases[i]), with phases in cycles
+/*!
+ A polynomial after reduction of the phase to a quarter cycle, with four
+ samples in the lanes of SSE2 or NEON vectors.  The error is within 2e-7.
+
+ @param out may equal phases
+ @pre `|phases[i]| < 2^31`
+ */
+MATH_API void Sine(const float *phases, float *out, size_t len);
+
+//! State of four interleaved xorshift generators, one in each lane of a
+//! vector
+struct NoiseState {
+   uint32_t lanes[4];
+};
+
+//! @return a state whose lanes are all nonzero and distinct
+MATH_API NoiseState SeedNoise(uint32_t seed);
+
+//! Uniform white noise in [-1, 1)
+MATH_API void WhiteNoise(NoiseState &state, float *out, size_t len);
+
+}
+
+#endif
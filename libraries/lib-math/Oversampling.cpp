@@ -0,0 +1,199 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file Oversampling.cpp
+
+*******************************************************************//*!
+
+\file Oversampling.cpp
+\brief Half-band filters designed as by Valenzuela and Constantinides, and
+  their cascades
+
+  For the design see "Digital signal processing schemes for efficient
+  interpolation and decimation", IEE Proceedings G, 1983, and the HIIR
+  library of Laurent de Soras, which computes the same coefficients.
+
+*//*******************************************************************/
+
+#include "Oversampling.h"
+
+#include <cassert>
+#include <cmath>
+
+namespace Oversampling {
+namespace {
+
+// Sums of the series of elliptic functions that give the coefficients
+double Numerator(double q, size_t order, size_t c)
+{
+   double acc = 0;
+   double sign = 1;
+   for (size_t ii = 0;; ++ii) {
+      const auto term = std::pow(q, double(ii * (ii + 1))) *
+         std::sin((2 * ii + 1) * c * M_PI / order) * sign;
+      acc += term;
+      sign = -sign;
+      if (std::fabs(term) < 1e-100)
+         return acc;
+   }
+}
+
+double Denominator(double q, size_t order, size_t c)
+{
+   double acc = 0;
+   double sign = -1;
+   for (size_t ii = 1;; ++ii) {
+      const auto term = std::pow(q, double(ii * ii)) *
+         std::cos(2 * ii * c * M_PI / order) * sign;
+      acc += term;
+      sign = -sign;
+      if (std::fabs(term) < 1e-100)
+         return acc;
+   }
+}
+
+//! Numbers of coefficients and transition widths of the stages, from the
+//! lowest rate
+struct StageDesign {
+   size_t nCoefs;
+   double transition;
+};
+constexpr StageDesign Designs[]{
+   // Attenuating 107 dB, and passing to 0.225 of the doubled rate
+   { 8, 0.05 },
+   // 117 dB, passing to 0.125
+   { 4, 0.25 },
+   // 104 dB, passing to 0.1
+   { 3, 0.3 },
+};
+
+//! One sample through the sections of one chain, every other coefficient
+inline float Chain(float sample, const float *coefs, float *x, float *y,
+   size_t first, size_t count)
+{
+   for (auto ii = first; ii < count; ii += 2) {
+      const auto out = (sample - y[ii]) * coefs[ii] + x[ii];
+      x[ii] = sample;
+      y[ii] = out;
+      sample = out;
+   }
+   return sample;
+}
+
+}
+
+void DesignHalfBand(double *coefs, size_t nCoefs, double transition)
+{
+   assert(0 < transition && transition < 0.5);
+   auto k = std::tan((1 - transition * 2) * M_PI / 4);
+   k *= k;
+   const auto root = std::pow(1 - k * k, 0.25);
+   const auto e = 0.5 * (1 - root) / (1 + root);
+   const auto e4 = e * e * e * e;
+   const auto q = e * (1 + e4 * (2 + e4 * (15 + 150 * e4)));
+   const auto order = 2 * nCoefs + 1;
+   for (size_t ii = 0; ii < nCoefs; ++ii) {
+      const auto c = ii + 1;
+      const auto num = Numerator(q, order, c) * std::pow(q, 0.25);
+      const auto den = Denominator(q, order, c) + 0.5;
+      const auto ww = num / den;
+      const auto wwsq = ww * ww;
+      const auto x = std::sqrt((1 - wwsq * k) * (1 - wwsq / k)) / (1 + wwsq);
+      coefs[ii] = (1 - x) / (1 + x);
+   }
+}
+
+void HalfBand::SetCoefficients(const double *coefs, size_t nCoefs)
+{
+   assert(nCoefs <= MaxCoefs);
+   mCount = std::min(nCoefs, MaxCoefs);
+   std::copy(coefs, coefs + mCount, mCoefs);
+   Reset();
+}
+
+void HalfBand::Reset()
+{
+   std::fill_n(mUpX, MaxCoefs, 0.0f);
+   std::fill_n(mUpY, MaxCoefs, 0.0f);
+   std::fill_n(mDownX, MaxCoefs, 0.0f);
+   std::fill_n(mDownY, MaxCoefs, 0.0f);
+}
+
+void HalfBand::Upsample(const float *in, float *out, size_t len)
+{
+   for (size_t ii = 0; ii < len; ++ii) {
+      const auto sample = in[ii];
+      out[2 * ii] = Chain(sample, mCoefs, mUpX, mUpY, 0, mCount);
+      out[2 * ii + 1] = Chain(sample, mCoefs, mUpX, mUpY, 1, mCount);
+   }
+}
+
+void HalfBand::Downsample(const float *in, float *out, size_t len)
+{
+   for (size_t ii = 0; ii < len; ++ii) {
+      const auto even = Chain(in[2 * ii + 1], mCoefs, mDownX, mDownY, 0, mCount);
+      const auto odd = Chain(in[2 * ii], mCoefs, mDownX, mDownY, 1, mCount);
+      out[ii] = 0.5f * (even + odd);
+   }
+}
+
+Oversampler::Oversampler(unsigned factor)
+{
+   double coefs[HalfBand::MaxCoefs];
+   for (size_t ii = 0; ii < MaxStages; ++ii) {
+      const auto &design = Designs[ii];
+      DesignHalfBand(coefs, design.nCoefs, design.transition);
+      mStages[ii].SetCoefficients(coefs, design.nCoefs);
+   }
+   SetFactor(factor);
+}
+
+void Oversampler::SetFactor(unsigned factor)
+{
+   assert(factor == 1 || factor == 2 || factor == 4 || factor == 8);
+   if (factor == mFactor)
+      return;
+   mFactor = factor;
+   mNumStages = 0;
+   while ((1u << mNumStages) < std::min(factor, MaxFactor))
+      ++mNumStages;
+   Reset();
+}
+
+void Oversampler::Reset()
+{
+   for (auto &stage : mStages)
+      stage.Reset();
+}
+
+float *Oversampler::Upsample(const float *in, size_t len)
+{
+   assert(len <= ChunkSize);
+   if (mNumStages == 0) {
+      std::copy(in, in + len, mBuffer);
+      return mBuffer;
+   }
+   // Alternate buffers so that the last stage writes mBuffer
+   auto src = in;
+   for (size_t ii = 0; ii < mNumStages; ++ii) {
+      const auto dst = (mNumStages - ii) % 2 ? mBuffer : mScratch;
+      mStages[ii].Upsample(src, dst, len << ii);
+      src = dst;
+   }
+   return mBuffer;
+}
+
+void Oversampler::Downsample(float *out, size_t len)
+{
+   if (mNumStages == 0) {
+      std::copy(mBuffer, mBuffer + len, out);
+      return;
+   }
+   // In place, from the highest rate
+   for (auto ii = mNumStages; ii-- > 1;)
+      mStages[ii].Downsample(mBuffer, mBuffer, len << ii);
+   mStages[0].Downsample(mBuffer, out, len);
+}
+
+}
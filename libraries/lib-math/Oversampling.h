@@ -0,0 +1,119 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file Oversampling.h
+  @brief Oversampling by 2, 4 or 8 with polyphase IIR half-band filters, for
+  nonlinear processing that would otherwise alias
+
+**********************************************************************/
+
+#ifndef __AUDACITY_OVERSAMPLING__
+#define __AUDACITY_OVERSAMPLING__
+
+#include <algorithm>
+#include <cstddef>
+
+namespace Oversampling {
+
+//! Design the allpass coefficients of a half-band filter
+/*!
+ The filter is the mean of two chains of first order allpass sections in
+ z^-2, the even numbered coefficients in one and the odd in the other, with
+ one sample of delay between them.  Its attenuation is equiripple in the
+ stop band.
+
+ @param transition width of the transition band about a quarter of the
+ sample rate, as a fraction of the rate
+ @pre `0 < transition && transition < 0.5`
+ */
+MATH_API void DesignHalfBand(double *coefs, size_t nCoefs, double transition);
+
+//! Doubles or halves the sample rate with a half-band filter, keeping
+//! separate state for each direction
+class MATH_API HalfBand final {
+public:
+   static constexpr size_t MaxCoefs = 8;
+
+   //! @pre `nCoefs <= MaxCoefs`
+   void SetCoefficients(const double *coefs, size_t nCoefs);
+   void Reset();
+
+   //! Write 2 * len samples to out
+   void Upsample(const float *in, float *out, size_t len);
+   //! Read 2 * len samples of in
+   /*! @param out may equal in */
+   void Downsample(const float *in, float *out, size_t len);
+
+private:
+   float mCoefs[MaxCoefs]{};
+   size_t mCount{ 0 };
+   //! Previous inputs and outputs of each section
+   float mUpX[MaxCoefs]{}, mUpY[MaxCoefs]{};
+   float mDownX[MaxCoefs]{}, mDownY[MaxCoefs]{};
+};
+
+//! Upsampling, then processing, then downsampling, of chunks of a buffer
+/*!
+ Each doubling is a half-band stage.  The first stage is steep, passing the
+ original band up to 0.45 of its rate and attenuating the rest by about
+ 100 dB; later stages protect only the original band and are cheaper.
+
+ Buffers are members, so that processing and changing the factor never
+ allocate.
+ */
+class MATH_API Oversampler final {
+public:
+   static constexpr unsigned MaxFactor = 8;
+   //! Most input samples upsampled at once
+   static constexpr size_t ChunkSize = 256;
+
+   //! @pre factor is 1, 2, 4 or 8
+   explicit Oversampler(unsigned factor = 1);
+
+   //! Change the factor, resetting state if it changes
+   /*! @pre factor is 1, 2, 4 or 8 */
+   void SetFactor(unsigned factor);
+   unsigned GetFactor() const { return mFactor; }
+
+   //! Clear the state of the filters
+   void Reset();
+
+   //! Apply function, taking a pointer and a count of samples, to each
+   //! chunk of in at the higher rate, in place, writing the result to out
+   /*! @param out may equal in */
+   template<typename Function>
+   void Process(const float *in, float *out, size_t len,
+      const Function &function)
+   {
+      if (mFactor == 1) {
+         std::copy(in, in + len, out);
+         function(out, len);
+         return;
+      }
+      for (size_t ii = 0; ii < len; ii += ChunkSize) {
+         const auto count = std::min(ChunkSize, len - ii);
+         function(Upsample(in + ii, count), count * mFactor);
+         Downsample(out + ii, count);
+      }
+   }
+
+   //! Upsample len samples into a buffer, and return it
+   /*! @pre `len <= ChunkSize` */
+   float *Upsample(const float *in, size_t len);
+
+   //! Downsample the buffer, as Upsample() returned it, into len samples
+   void Downsample(float *out, size_t len);
+
+private:
+   static constexpr size_t MaxStages = 3;
+   HalfBand mStages[MaxStages];
+   unsigned mFactor{ 1 };
+   size_t mNumStages{ 0 };
+   float mBuffer[MaxFactor * ChunkSize];
+   float mScratch[MaxFactor * ChunkSize / 2];
+};
+
+}
+
+#endif
@@ -29,7 +29,12 @@
 
 #include <soxr.h>
 
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
 Resample::Resample(const bool useBestMethod, const double dMinFactor, const double dMaxFactor)
+   : mMinFactor{ dMinFactor }, mMaxFactor{ dMaxFactor }
 {
    this->SetMethod(useBestMethod);
    soxr_quality_spec_t q_spec;
@@ -50,6 +55,76 @@ Resample::~Resample()
 {
 }
 
+namespace {
+//! Idle resamplers, most recently recycled last
+/*!
+ Creating a soxr instance, especially for the best method, costs enough to
+ delay the start of playback, and every mixer makes one per channel
+ */
+struct Pool {
+   static Pool &Get()
+   {
+      static Pool pool;
+      return pool;
+   }
+   //! Enough for several stereo mixers
+   static constexpr size_t MaxIdle = 32;
+
+   std::mutex mutex;
+   std::vector<std::unique_ptr<Resample>> idle;
+};
+}
+
+std::unique_ptr<Resample> Resample::Acquire(
+   const bool useBestMethod, const double dMinFactor, const double dMaxFactor)
+{
+   // The method depends on preferences, which may change between uses
+   const auto method = useBestMethod
+      ? BestMethodSetting.ReadEnum()
+      : FastMethodSetting.ReadEnum();
+   auto &pool = Pool::Get();
+   std::unique_ptr<Resample> result;
+   {
+      std::lock_guard<std::mutex> guard{ pool.mutex };
+      auto &idle = pool.idle;
+      const auto iter = std::find_if(idle.rbegin(), idle.rend(),
+         [&](const auto &pResample){
+            return pResample->mMethod == method &&
+               pResample->mMinFactor == dMinFactor &&
+               pResample->mMaxFactor == dMaxFactor;
+         });
+      if (iter != idle.rend()) {
+         result = move(*iter);
+         idle.erase(std::next(iter).base());
+      }
+   }
+   if (result)
+      result->Reset();
+   else
+      result = std::make_unique<Resample>(
+         useBestMethod, dMinFactor, dMaxFactor);
+   return result;
+}
+
+void Resample::Recycle(std::unique_ptr<Resample> pResample)
+{
+   if (!pResample || !pResample->mHandle)
+      return;
+   auto &pool = Pool::Get();
+   std::lock_guard<std::mutex> guard{ pool.mutex };
+   auto &idle = pool.idle;
+   if (idle.size() >= Pool::MaxIdle)
+      // Forget the least recently used
+      idle.erase(idle.begin());
+   idle.push_back(move(pResample));
+}
+
+void Resample::Reset()
+{
+   if (mHandle)
+      soxr_clear(mHandle.get());
+}
+
 //////////
 static const std::initializer_list<EnumValueSymbol> methodNames{
    { wxT("LowQuality"), XO("Low Quality (Fastest)") },
@@ -39,6 +39,16 @@ class MATH_API Resample final
    Resample(const bool useBestMethod, const double dMinFactor, const double dMaxFactor);
    ~Resample();
 
+   //! Like the constructor, but reuse an idle instance with the same method
+   //! and factors if there is one, reset to its initial state
+   static std::unique_ptr<Resample> Acquire(
+      bool useBestMethod, double dMinFactor, double dMaxFactor);
+   //! Keep an instance for reuse by Acquire(); it may also be destroyed
+   static void Recycle(std::unique_ptr<Resample> pResample);
+
+   //! Discard buffered samples and history, keeping the configuration
+   void Reset();
+
    static EnumSetting< int > FastMethodSetting;
    static EnumSetting< int > BestMethodSetting;
 
@@ -77,6 +87,7 @@ class MATH_API Resample final
 
  protected:
    int   mMethod; // resampler-specific enum for resampling method
+   double mMinFactor, mMaxFactor;
    soxrHandle mHandle; // constant-rate or variable-rate resampler (XOR per instance)
    bool mbWantConstRateResampling;
 };
@@ -0,0 +1,581 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file SampleConversion.cpp
+
+*******************************************************************//*!
+
+\file SampleConversion.cpp
+\brief Scalar, SSE2, AVX2 and NEON kernels for SampleConversion
+
+  Each kernel processes whole vectors and leaves the remainder to the
+  scalar kernel.  NaN converts to zero.
+
+*//*******************************************************************/
+
+#include "SampleConversion.h"
+
+// (Note: this file should be included first)
+#include "float_cast.h"
+
+#include <atomic>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#  if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#     define SAMPLE_CONVERSION_SSE2
+#     include <emmintrin.h>
+#  endif
+#  if defined(__GNUC__) || defined(__clang__)
+#     define SAMPLE_CONVERSION_AVX2
+#     define AVX2_TARGET __attribute__((target("avx2")))
+#     include <immintrin.h>
+#  elif defined(_MSC_VER)
+#     define SAMPLE_CONVERSION_AVX2
+#     define AVX2_TARGET
+#     include <immintrin.h>
+#     include <intrin.h>
+#  endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#  define SAMPLE_CONVERSION_NEON
+#  include <arm_neon.h>
+#endif
+
+namespace SampleConversion {
+namespace {
+
+constexpr float Scale16 = float(1 << 15);
+constexpr float Scale24 = float(1 << 23);
+constexpr float Max24 = 8388607.0f;
+
+//////////////////////////////////////////////////////////////////////////
+// Scalar kernels, the same arithmetic as in Dither.cpp
+
+inline float Clip(float sample)
+{
+   if (sample != sample)
+      return 0;
+   return sample > 1.0f ? 1.0f : sample < -1.0f ? -1.0f : sample;
+}
+
+template<typename Int>
+inline Int Store(float sample, Int min_bound, Int max_bound)
+{
+   int x = lrintf(sample);
+   return x > max_bound ? max_bound : x < min_bound ? min_bound : Int(x);
+}
+
+void ScalarInt16ToFloat(const short *src, float *dst, size_t len)
+{
+   for (size_t ii = 0; ii < len; ++ii)
+      dst[ii] = src[ii] / Scale16;
+}
+
+void ScalarInt24ToFloat(const int *src, float *dst, size_t len)
+{
+   for (size_t ii = 0; ii < len; ++ii)
+      dst[ii] = src[ii] / Scale24;
+}
+
+void ScalarFloatToInt16(const float *src, short *dst, size_t len)
+{
+   for (size_t ii = 0; ii < len; ++ii)
+      dst[ii] = Store<short>(Clip(src[ii]) * Scale16, -32768, 32767);
+}
+
+void ScalarFloatToInt24(const float *src, int *dst, size_t len)
+{
+   for (size_t ii = 0; ii < len; ++ii)
+      dst[ii] = Store<int>(Clip(src[ii]) * Scale24, -8388608, 8388607);
+}
+
+void ScalarClipAndScale(const float *src, float *dst, size_t len, float scale)
+{
+   for (size_t ii = 0; ii < len; ++ii)
+      dst[ii] = Clip(src[ii]) * scale;
+}
+
+void ScalarRoundToInt16(const float *src, short *dst, size_t len)
+{
+   for (size_t ii = 0; ii < len; ++ii)
+      dst[ii] = Store<short>(src[ii], -32768, 32767);
+}
+
+void ScalarRoundToInt24(const float *src, int *dst, size_t len)
+{
+   for (size_t ii = 0; ii < len; ++ii)
+      dst[ii] = Store<int>(src[ii], -8388608, 8388607);
+}
+
+//////////////////////////////////////////////////////////////////////////
+#ifdef SAMPLE_CONVERSION_SSE2
+
+inline __m128 ClipSSE2(__m128 x)
+{
+   // Zero for NaN
+   x = _mm_and_ps(x, _mm_cmpord_ps(x, x));
+   return _mm_min_ps(_mm_max_ps(x, _mm_set1_ps(-1.0f)), _mm_set1_ps(1.0f));
+}
+
+void SSE2Int16ToFloat(const short *src, float *dst, size_t len)
+{
+   const auto scale = _mm_set1_ps(1.0f / Scale16);
+   size_t ii = 0;
+   for (; ii + 8 <= len; ii += 8) {
+      const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + ii));
+      // Sign-extend by shifting each short into the high half of an int
+      const auto lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+      const auto hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+      _mm_storeu_ps(dst + ii, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+      _mm_storeu_ps(dst + ii + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+   }
+   ScalarInt16ToFloat(src + ii, dst + ii, len - ii);
+}
+
+void SSE2Int24ToFloat(const int *src, float *dst, size_t len)
+{
+   const auto scale = _mm_set1_ps(1.0f / Scale24);
+   size_t ii = 0;
+   for (; ii + 4 <= len; ii += 4) {
+      const auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + ii));
+      _mm_storeu_ps(dst + ii, _mm_mul_ps(_mm_cvtepi32_ps(v), scale));
+   }
+   ScalarInt24ToFloat(src + ii, dst + ii, len - ii);
+}
+
+void SSE2FloatToInt16(const float *src, short *dst, size_t len)
+{
+   const auto scale = _mm_set1_ps(Scale16);
+   size_t ii = 0;
+   for (; ii + 8 <= len; ii += 8) {
+      const auto lo = _mm_cvtps_epi32(
+         _mm_mul_ps(ClipSSE2(_mm_loadu_ps(src + ii)), scale));
+      const auto hi = _mm_cvtps_epi32(
+         _mm_mul_ps(ClipSSE2(_mm_loadu_ps(src + ii + 4)), scale));
+      // Saturation takes 32768 to 32767
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + ii),
+         _mm_packs_epi32(lo, hi));
+   }
+   ScalarFloatToInt16(src + ii, dst + ii, len - ii);
+}
+
+void SSE2FloatToInt24(const float *src, int *dst, size_t len)
+{
+   const auto scale = _mm_set1_ps(Scale24);
+   const auto max = _mm_set1_ps(Max24);
+   size_t ii = 0;
+   for (; ii + 4 <= len; ii += 4) {
+      const auto x = _mm_min_ps(
+         _mm_mul_ps(ClipSSE2(_mm_loadu_ps(src + ii)), scale), max);
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + ii),
+         _mm_cvtps_epi32(x));
+   }
+   ScalarFloatToInt24(src + ii, dst + ii, len - ii);
+}
+
+void SSE2ClipAndScale(const float *src, float *dst, size_t len, float scale)
+{
+   const auto factor = _mm_set1_ps(scale);
+   size_t ii = 0;
+   for (; ii + 4 <= len; ii += 4)
+      _mm_storeu_ps(dst + ii,
+         _mm_mul_ps(ClipSSE2(_mm_loadu_ps(src + ii)), factor));
+   ScalarClipAndScale(src + ii, dst + ii, len - ii, scale);
+}
+
+void SSE2RoundToInt16(const float *src, short *dst, size_t len)
+{
+   size_t ii = 0;
+   for (; ii + 8 <= len; ii += 8) {
+      const auto lo = _mm_cvtps_epi32(_mm_loadu_ps(src + ii));
+      const auto hi = _mm_cvtps_epi32(_mm_loadu_ps(src + ii + 4));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + ii),
+         _mm_packs_epi32(lo, hi));
+   }
+   ScalarRoundToInt16(src + ii, dst + ii, len - ii);
+}
+
+void SSE2RoundToInt24(const float *src, int *dst, size_t len)
+{
+   // Clamping before rounding gives the same results as after, because
+   // floats of that magnitude are spaced by halves at most
+   const auto min = _mm_set1_ps(-Max24 - 1);
+   const auto max = _mm_set1_ps(Max24);
+   size_t ii = 0;
+   for (; ii + 4 <= len; ii += 4) {
+      const auto x = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(src + ii), min), max);
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + ii),
+         _mm_cvtps_epi32(x));
+   }
+   ScalarRoundToInt24(src + ii, dst + ii, len - ii);
+}
+
+#endif
+
+//////////////////////////////////////////////////////////////////////////
+#ifdef SAMPLE_CONVERSION_AVX2
+
+AVX2_TARGET inline __m256 ClipAVX2(__m256 x)
+{
+   x = _mm256_and_ps(x, _mm256_cmp_ps(x, x, _CMP_ORD_Q));
+   return _mm256_min_ps(
+      _mm256_max_ps(x, _mm256_set1_ps(-1.0f)), _mm256_set1_ps(1.0f));
+}
+
+AVX2_TARGET void AVX2Int16ToFloat(const short *src, float *dst, size_t len)
+{
+   const auto scale = _mm256_set1_ps(1.0f / Scale16);
+   size_t ii = 0;
+   for (; ii + 8 <= len; ii += 8) {
+      const auto v = _mm256_cvtepi16_epi32(
+         _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + ii)));
+      _mm256_storeu_ps(dst + ii, _mm256_mul_ps(_mm256_cvtepi32_ps(v), scale));
+   }
+   ScalarInt16ToFloat(src + ii, dst + ii, len - ii);
+}
+
+AVX2_TARGET void AVX2Int24ToFloat(const int *src, float *dst, size_t len)
+{
+   const auto scale = _mm256_set1_ps(1.0f / Scale24);
+   size_t ii = 0;
+   for (; ii + 8 <= len; ii += 8) {
+      const auto v =
+         _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + ii));
+      _mm256_storeu_ps(dst + ii, _mm256_mul_ps(_mm256_cvtepi32_ps(v), scale));
+   }
+   ScalarInt24ToFloat(src + ii, dst + ii, len - ii);
+}
+
+AVX2_TARGET void AVX2FloatToInt16(const float *src, short *dst, size_t len)
+{
+   const auto scale = _mm256_set1_ps(Scale16);
+   size_t ii = 0;
+   for (; ii + 16 <= len; ii += 16) {
+      const auto lo = _mm256_cvtps_epi32(
+         _mm256_mul_ps(ClipAVX2(_mm256_loadu_ps(src + ii)), scale));
+      const auto hi = _mm256_cvtps_epi32(
+         _mm256_mul_ps(ClipAVX2(_mm256_loadu_ps(src + ii + 8)), scale));
+      // Packing works within 128-bit lanes; restore the order of quadwords
+      const auto packed = _mm256_permute4x64_epi64(
+         _mm256_packs_epi32(lo, hi), 0xD8);
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + ii), packed);
+   }
+   ScalarFloatToInt16(src + ii, dst + ii, len - ii);
+}
+
+AVX2_TARGET void AVX2FloatToInt24(const float *src, int *dst, size_t len)
+{
+   const auto scale = _mm256_set1_ps(Scale24);
+   const auto max = _mm256_set1_ps(Max24);
+   size_t ii = 0;
+   for (; ii + 8 <= len; ii += 8) {
+      const auto x = _mm256_min_ps(
+         _mm256_mul_ps(ClipAVX2(_mm256_loadu_ps(src + ii)), scale), max);
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + ii),
+         _mm256_cvtps_epi32(x));
+   }
+   ScalarFloatToInt24(src + ii, dst + ii, len - ii);
+}
+
+AVX2_TARGET void AVX2ClipAndScale(
+   const float *src, float *dst, size_t len, float scale)
+{
+   const auto factor = _mm256_set1_ps(scale);
+   size_t ii = 0;
+   for (; ii + 8 <= len; ii += 8)
+      _mm256_storeu_ps(dst + ii,
+         _mm256_mul_ps(ClipAVX2(_mm256_loadu_ps(src + ii)), factor));
+   ScalarClipAndScale(src + ii, dst + ii, len - ii, scale);
+}
+
+AVX2_TARGET void AVX2RoundToInt16(const float *src, short *dst, size_t len)
+{
+   size_t ii = 0;
+   for (; ii + 16 <= len; ii += 16) {
+      const auto lo = _mm256_cvtps_epi32(_mm256_loadu_ps(src + ii));
+      const auto hi = _mm256_cvtps_epi32(_mm256_loadu_ps(src + ii + 8));
+      const auto packed = _mm256_permute4x64_epi64(
+         _mm256_packs_epi32(lo, hi), 0xD8);
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + ii), packed);
+   }
+   ScalarRoundToInt16(src + ii, dst + ii, len - ii);
+}
+
+AVX2_TARGET void AVX2RoundToInt24(const float *src, int *dst, size_t len)
+{
+   const auto min = _mm256_set1_ps(-Max24 - 1);
+   const auto max = _mm256_set1_ps(Max24);
+   size_t ii = 0;
+   for (; ii + 8 <= len; ii += 8) {
+      const auto x = _mm256_min_ps(
+         _mm256_max_ps(_mm256_loadu_ps(src + ii), min), max);
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + ii),
+         _mm256_cvtps_epi32(x));
+   }
+   ScalarRoundToInt24(src + ii, dst + ii, len - ii);
+}
+
+bool HasAVX2()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+   int info[4];
+   __cpuid(info, 0);
+   if (info[0] < 7)
+      return false;
+   __cpuid(info, 1);
+   // OSXSAVE and AVX, then whether the OS saves the ymm registers
+   constexpr int osxsave = 1 << 27, avx = 1 << 28;
+   if ((info[2] & (osxsave | avx)) != (osxsave | avx) ||
+       (_xgetbv(0) & 6) != 6)
+      return false;
+   __cpuidex(info, 7, 0);
+   return (info[1] & (1 << 5)) != 0;
+#else
+   return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif
+
+//////////////////////////////////////////////////////////////////////////
+#ifdef SAMPLE_CONVERSION_NEON
+
+inline float32x4_t ClipNEON(float32x4_t x)
+{
+   // Zero for NaN
+   x = vreinterpretq_f32_u32(
+      vandq_u32(vreinterpretq_u32_f32(x), vceqq_f32(x, x)));
+   return vminq_f32(vmaxq_f32(x, vdupq_n_f32(-1.0f)), vdupq_n_f32(1.0f));
+}
+
+void NEONInt16ToFloat(const short *src, float *dst, size_t len)
+{
+   const auto scale = 1.0f / Scale16;
+   size_t ii = 0;
+   for (; ii + 8 <= len; ii += 8) {
+      const auto v = vld1q_s16(src + ii);
+      vst1q_f32(dst + ii,
+         vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(v))), scale));
+      vst1q_f32(dst + ii + 4,
+         vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(v))), scale));
+   }
+   ScalarInt16ToFloat(src + ii, dst + ii, len - ii);
+}
+
+void NEONInt24ToFloat(const int *src, float *dst, size_t len)
+{
+   const auto scale = 1.0f / Scale24;
+   size_t ii = 0;
+   for (; ii + 4 <= len; ii += 4)
+      vst1q_f32(dst + ii, vmulq_n_f32(vcvtq_f32_s32(vld1q_s32(src + ii)), scale));
+   ScalarInt24ToFloat(src + ii, dst + ii, len - ii);
+}
+
+void NEONFloatToInt16(const float *src, short *dst, size_t len)
+{
+   size_t ii = 0;
+   for (; ii + 8 <= len; ii += 8) {
+      // Round to nearest even, like lrintf in the default mode
+      const auto lo = vcvtnq_s32_f32(
+         vmulq_n_f32(ClipNEON(vld1q_f32(src + ii)), Scale16));
+      const auto hi = vcvtnq_s32_f32(
+         vmulq_n_f32(ClipNEON(vld1q_f32(src + ii + 4)), Scale16));
+      // Saturation takes 32768 to 32767
+      vst1q_s16(dst + ii, vcombine_s16(vqmovn_s32(lo), vqmovn_s32(hi)));
+   }
+   ScalarFloatToInt16(src + ii, dst + ii, len - ii);
+}
+
+void NEONFloatToInt24(const float *src, int *dst, size_t len)
+{
+   const auto max = vdupq_n_f32(Max24);
+   size_t ii = 0;
+   for (; ii + 4 <= len; ii += 4) {
+      const auto x = vminq_f32(
+         vmulq_n_f32(ClipNEON(vld1q_f32(src + ii)), Scale24), max);
+      vst1q_s32(dst + ii, vcvtnq_s32_f32(x));
+   }
+   ScalarFloatToInt24(src + ii, dst + ii, len - ii);
+}
+
+void NEONClipAndScale(const float *src, float *dst, size_t len, float scale)
+{
+   size_t ii = 0;
+   for (; ii + 4 <= len; ii += 4)
+      vst1q_f32(dst + ii, vmulq_n_f32(ClipNEON(vld1q_f32(src + ii)), scale));
+   ScalarClipAndScale(src + ii, dst + ii, len - ii, scale);
+}
+
+void NEONRoundToInt16(const float *src, short *dst, size_t len)
+{
+   size_t ii = 0;
+   for (; ii + 8 <= len; ii += 8) {
+      const auto lo = vcvtnq_s32_f32(vld1q_f32(src + ii));
+      const auto hi = vcvtnq_s32_f32(vld1q_f32(src + ii + 4));
+      vst1q_s16(dst + ii, vcombine_s16(vqmovn_s32(lo), vqmovn_s32(hi)));
+   }
+   ScalarRoundToInt16(src + ii, dst + ii, len - ii);
+}
+
+void NEONRoundToInt24(const float *src, int *dst, size_t len)
+{
+   const auto min = vdupq_n_f32(-Max24 - 1);
+   const auto max = vdupq_n_f32(Max24);
+   size_t ii = 0;
+   for (; ii + 4 <= len; ii += 4) {
+      const auto x = vminq_f32(vmaxq_f32(vld1q_f32(src + ii), min), max);
+      vst1q_s32(dst + ii, vcvtnq_s32_f32(x));
+   }
+   ScalarRoundToInt24(src + ii, dst + ii, len - ii);
+}
+
+#endif
+
+//////////////////////////////////////////////////////////////////////////
+// Dispatch
+
+struct Kernels {
+   Level level;
+   void (*int16ToFloat)(const short *, float *, size_t);
+   void (*int24ToFloat)(const int *, float *, size_t);
+   void (*floatToInt16)(const float *, short *, size_t);
+   void (*floatToInt24)(const float *, int *, size_t);
+   void (*clipAndScale)(const float *, float *, size_t, float);
+   void (*roundToInt16)(const float *, short *, size_t);
+   void (*roundToInt24)(const float *, int *, size_t);
+};
+
+const Kernels ScalarKernels{ Level::Scalar,
+   ScalarInt16ToFloat, ScalarInt24ToFloat,
+   ScalarFloatToInt16, ScalarFloatToInt24, ScalarClipAndScale,
+   ScalarRoundToInt16, ScalarRoundToInt24 };
+
+#ifdef SAMPLE_CONVERSION_SSE2
+const Kernels SSE2Kernels{ Level::SSE2,
+   SSE2Int16ToFloat, SSE2Int24ToFloat,
+   SSE2FloatToInt16, SSE2FloatToInt24, SSE2ClipAndScale,
+   SSE2RoundToInt16, SSE2RoundToInt24 };
+#endif
+
+#ifdef SAMPLE_CONVERSION_AVX2
+const Kernels AVX2Kernels{ Level::AVX2,
+   AVX2Int16ToFloat, AVX2Int24ToFloat,
+   AVX2FloatToInt16, AVX2FloatToInt24, AVX2ClipAndScale,
+   AVX2RoundToInt16, AVX2RoundToInt24 };
+#endif
+
+#ifdef SAMPLE_CONVERSION_NEON
+const Kernels NEONKernels{ Level::NEON,
+   NEONInt16ToFloat, NEONInt24ToFloat,
+   NEONFloatToInt16, NEONFloatToInt24, NEONClipAndScale,
+   NEONRoundToInt16, NEONRoundToInt24 };
+#endif
+
+const Kernels *FindKernels(Level level)
+{
+   switch (level) {
+#ifdef SAMPLE_CONVERSION_SSE2
+   case Level::SSE2:
+      return &SSE2Kernels;
+#endif
+#ifdef SAMPLE_CONVERSION_AVX2
+   case Level::AVX2:
+      return HasAVX2() ? &AVX2Kernels : &ScalarKernels;
+#endif
+#ifdef SAMPLE_CONVERSION_NEON
+   case Level::NEON:
+      return &NEONKernels;
+#endif
+   default:
+      return &ScalarKernels;
+   }
+}
+
+std::atomic<const Kernels*> &Active()
+{
+   static std::atomic<const Kernels*> kernels{ FindKernels(DetectedLevel()) };
+   return kernels;
+}
+
+const Kernels &Get()
+{
+   return *Active().load(std::memory_order_relaxed);
+}
+
+}
+
+Level DetectedLevel()
+{
+#if defined(SAMPLE_CONVERSION_AVX2)
+   if (HasAVX2())
+      return Level::AVX2;
+#endif
+#if defined(SAMPLE_CONVERSION_SSE2)
+   return Level::SSE2;
+#elif defined(SAMPLE_CONVERSION_NEON)
+   return Level::NEON;
+#else
+   return Level::Scalar;
+#endif
+}
+
+Level ActiveLevel()
+{
+   return Get().level;
+}
+
+void SetLevel(Level level)
+{
+   Active().store(FindKernels(level), std::memory_order_relaxed);
+}
+
+const char *LevelName(Level level)
+{
+   switch (level) {
+   case Level::SSE2:
+      return "SSE2";
+   case Level::AVX2:
+      return "AVX2";
+   case Level::NEON:
+      return "NEON";
+   default:
+      return "scalar";
+   }
+}
+
+void Int16ToFloat(const short *src, float *dst, size_t len)
+{
+   Get().int16ToFloat(src, dst, len);
+}
+
+void Int24ToFloat(const int *src, float *dst, size_t len)
+{
+   Get().int24ToFloat(src, dst, len);
+}
+
+void FloatToInt16(const float *src, short *dst, size_t len)
+{
+   Get().floatToInt16(src, dst, len);
+}
+
+void FloatToInt24(const float *src, int *dst, size_t len)
+{
+   Get().floatToInt24(src, dst, len);
+}
+
+void ClipAndScale(const float *src, float *dst, size_t len, float scale)
+{
+   Get().clipAndScale(src, dst, len, scale);
+}
+
+void RoundToInt16(const float *src, short *dst, size_t len)
+{
+   Get().roundToInt16(src, dst, len);
+}
+
+void RoundToInt24(const float *src, int *dst, size_t len)
+{
+   Get().roundToInt24(src, dst, len);
+}
+
+}
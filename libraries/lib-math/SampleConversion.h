@@ -0,0 +1,61 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file SampleConversion.h
+  @brief Vectorized conversions between contiguous buffers of samples
+
+**********************************************************************/
+
+#ifndef __AUDACITY_SAMPLE_CONVERSION__
+#define __AUDACITY_SAMPLE_CONVERSION__
+
+#include <cstddef>
+
+//! Kernels for the conversions that need no dither, chosen at run time for
+//! the best instruction set of the processor
+/*!
+ Results are identical to those of the scalar loops in Dither.cpp:  integers
+ are scaled by powers of two, and floats are clipped to [-1, 1] and then
+ rounded to nearest.  The exception is NaN, which always converts to zero.
+ */
+namespace SampleConversion {
+
+enum class Level {
+   Scalar,
+   SSE2,
+   AVX2,
+   NEON,
+};
+
+//! The best level that both this build and this processor support
+MATH_API Level DetectedLevel();
+
+//! The level of the kernels now in use
+MATH_API Level ActiveLevel();
+
+//! Choose the kernels, as for testing; a level that is not supported
+//! selects the scalar kernels
+MATH_API void SetLevel(Level level);
+
+MATH_API const char *LevelName(Level level);
+
+MATH_API void Int16ToFloat(const short *src, float *dst, size_t len);
+MATH_API void Int24ToFloat(const int *src, float *dst, size_t len);
+
+//! Clip to [-1, 1], scale, and round to nearest
+MATH_API void FloatToInt16(const float *src, short *dst, size_t len);
+MATH_API void FloatToInt24(const float *src, int *dst, size_t len);
+
+//! Clip to [-1, 1] and multiply by scale, in preparation for dithering
+MATH_API void ClipAndScale(
+   const float *src, float *dst, size_t len, float scale);
+
+//! Round samples already scaled, as after dithering, to nearest, and
+//! saturate to the range of the format
+MATH_API void RoundToInt16(const float *src, short *dst, size_t len);
+MATH_API void RoundToInt24(const float *src, int *dst, size_t len);
+
+}
+
+#endif
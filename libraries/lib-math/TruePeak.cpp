@@ -0,0 +1,119 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file TruePeak.cpp
+
+*******************************************************************//*!
+
+\file TruePeak.cpp
+\brief SSE2 and NEON interpolation of the four phases at once, and a scalar
+  loop for other processors
+
+*//*******************************************************************/
+
+#include "TruePeak.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#  if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#     define TRUE_PEAK_SSE2
+#     include <emmintrin.h>
+#  endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#  define TRUE_PEAK_NEON
+#  include <arm_neon.h>
+#endif
+
+namespace {
+
+constexpr auto Taps = TruePeak::TapsPerPhase;
+constexpr auto Phases = TruePeak::Factor;
+
+//! The coefficients of BS.1770-4, Annex 2, transposed: row j holds tap j of
+//! each phase, to multiply the j-th oldest sample of the window
+alignas(16) const float Coefficients[Taps][Phases] = {
+   {  0.0017089843750f, -0.0291748046875f, -0.0189208984375f, -0.0083007812500f },
+   {  0.0109863281250f,  0.0292968750000f,  0.0330810546875f,  0.0148925781250f },
+   { -0.0196533203125f, -0.0517578125000f, -0.0582275390625f, -0.0266113281250f },
+   {  0.0332031250000f,  0.0891113281250f,  0.1015625000000f,  0.0476074218750f },
+   { -0.0594482421875f, -0.1665039062500f, -0.2003173828125f, -0.1022949218750f },
+   {  0.1373291015625f,  0.4650878906250f,  0.7797851562500f,  0.9721679687500f },
+   {  0.9721679687500f,  0.7797851562500f,  0.4650878906250f,  0.1373291015625f },
+   { -0.1022949218750f, -0.2003173828125f, -0.1665039062500f, -0.0594482421875f },
+   {  0.0476074218750f,  0.1015625000000f,  0.0891113281250f,  0.0332031250000f },
+   { -0.0266113281250f, -0.0582275390625f, -0.0517578125000f, -0.0196533203125f },
+   {  0.0148925781250f,  0.0330810546875f,  0.0292968750000f,  0.0109863281250f },
+   { -0.0083007812500f, -0.0189208984375f, -0.0291748046875f,  0.0017089843750f },
+};
+
+}
+
+void TruePeak::Reset()
+{
+   std::fill(mHistory, mHistory + 2 * Taps, 0.0f);
+   mPos = 0;
+   mPeak = 0;
+}
+
+void TruePeak::Process(const float *samples, size_t len, size_t stride)
+{
+   // The samples themselves
+   float peak = mPeak;
+   for (size_t ii = 0; ii < len; ++ii)
+      peak = std::max(peak, std::fabs(samples[ii * stride]));
+
+   // Then the interpolations between them
+#if defined(TRUE_PEAK_SSE2)
+   const auto absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+   __m128 coefs[Taps];
+   for (size_t jj = 0; jj < Taps; ++jj)
+      coefs[jj] = _mm_load_ps(Coefficients[jj]);
+   auto peaks = _mm_setzero_ps();
+   for (size_t ii = 0; ii < len; ++ii) {
+      mHistory[mPos] = mHistory[mPos + Taps] = samples[ii * stride];
+      const auto window = mHistory + mPos + 1;
+      auto acc = _mm_mul_ps(coefs[0], _mm_set1_ps(window[0]));
+      for (size_t jj = 1; jj < Taps; ++jj)
+         acc = _mm_add_ps(acc, _mm_mul_ps(coefs[jj], _mm_set1_ps(window[jj])));
+      peaks = _mm_max_ps(peaks, _mm_and_ps(acc, absMask));
+      mPos = (mPos + 1) % Taps;
+   }
+   alignas(16) float lanes[Phases];
+   _mm_store_ps(lanes, peaks);
+#elif defined(TRUE_PEAK_NEON)
+   float32x4_t coefs[Taps];
+   for (size_t jj = 0; jj < Taps; ++jj)
+      coefs[jj] = vld1q_f32(Coefficients[jj]);
+   auto peaks = vdupq_n_f32(0);
+   for (size_t ii = 0; ii < len; ++ii) {
+      mHistory[mPos] = mHistory[mPos + Taps] = samples[ii * stride];
+      const auto window = mHistory + mPos + 1;
+      auto acc = vmulq_n_f32(coefs[0], window[0]);
+      for (size_t jj = 1; jj < Taps; ++jj)
+         acc = vmlaq_n_f32(acc, coefs[jj], window[jj]);
+      peaks = vmaxq_f32(peaks, vabsq_f32(acc));
+      mPos = (mPos + 1) % Taps;
+   }
+   float lanes[Phases];
+   vst1q_f32(lanes, peaks);
+#else
+   // Lanes as arrays, which compilers may still vectorize
+   float lanes[Phases]{};
+   for (size_t ii = 0; ii < len; ++ii) {
+      mHistory[mPos] = mHistory[mPos + Taps] = samples[ii * stride];
+      const auto window = mHistory + mPos + 1;
+      float acc[Phases]{};
+      for (size_t jj = 0; jj < Taps; ++jj)
+         for (size_t pp = 0; pp < Phases; ++pp)
+            acc[pp] += Coefficients[jj][pp] * window[jj];
+      for (size_t pp = 0; pp < Phases; ++pp)
+         lanes[pp] = std::max(lanes[pp], std::fabs(acc[pp]));
+      mPos = (mPos + 1) % Taps;
+   }
+#endif
+
+   mPeak = std::max(peak, *std::max_element(lanes, lanes + Phases));
+}
@@ -0,0 +1,51 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file TruePeak.h
+  @brief Peak of the signal between samples, by oversampling as ITU-R
+  BS.1770-4 describes
+
+**********************************************************************/
+
+#ifndef __AUDACITY_TRUE_PEAK__
+#define __AUDACITY_TRUE_PEAK__
+
+#include <cstddef>
+
+//! Estimates the true peak of one channel
+/*!
+ Each sample is interpolated into four, by the 48 tap linear phase FIR filter
+ of BS.1770-4, Annex 2, in four phases of 12 taps that are computed in the
+ lanes of one SSE2 or NEON vector.  (The half-band filters of
+ Oversampling::Oversampler would be as cheap, but their phase response moves
+ the peaks.)
+
+ The samples themselves count too, so that the true peak is never less than
+ the sample peak.
+
+ Does not allocate or lock.
+ */
+class MATH_API TruePeak final
+{
+public:
+   static constexpr size_t Factor = 4;
+   static constexpr size_t TapsPerPhase = 12;
+
+   void Reset();
+
+   //! Take len samples, spaced stride apart
+   void Process(const float *samples, size_t len, size_t stride = 1);
+
+   //! Greatest magnitude, linear, since construction or Reset()
+   float GetPeak() const { return mPeak; }
+
+private:
+   //! The latest inputs, oldest first, from mHistory + mPos + 1; each is
+   //! stored twice, so that the window is contiguous
+   float mHistory[2 * TapsPerPhase]{};
+   size_t mPos{ 0 };
+   float mPeak{ 0 };
+};
+
+#endif
@@ -0,0 +1,100 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  DitherTests.cpp
+
+**********************************************************************/
+#include "Dither.h"
+#include "SampleConversion.h"
+
+#include <catch2/catch.hpp>
+
+#include <random>
+#include <vector>
+
+using namespace SampleConversion;
+
+namespace {
+// Several blocks and an odd remainder
+constexpr size_t Length = 1027;
+
+std::vector<Level> SupportedLevels()
+{
+   std::vector<Level> levels{ Level::Scalar };
+   for (auto level : { Level::SSE2, Level::AVX2, Level::NEON }) {
+      SetLevel(level);
+      if (ActiveLevel() == level)
+         levels.push_back(level);
+   }
+   SetLevel(DetectedLevel());
+   return levels;
+}
+
+template<typename T>
+std::vector<T> Apply(Dither &dither, DitherType type, sampleFormat format,
+   const float *source, unsigned sourceStride, unsigned destStride)
+{
+   std::vector<T> result(Length * destStride);
+   dither.Reset();
+   dither.Apply(type, reinterpret_cast<constSamplePtr>(source), floatSample,
+      reinterpret_cast<samplePtr>(result.data()), format, Length,
+      sourceStride, destStride);
+   std::vector<T> samples;
+   for (size_t ii = 0; ii < Length; ++ii)
+      samples.push_back(result[ii * destStride]);
+   return samples;
+}
+
+template<typename T>
+void Compare(Dither &dither, DitherType type, sampleFormat format,
+   const std::vector<float> &interleaved, const std::vector<float> &samples)
+{
+   // A source stride takes the sample by sample loop, which is the reference
+   const auto expected =
+      Apply<T>(dither, type, format, interleaved.data(), 2, 1);
+   REQUIRE(Apply<T>(dither, type, format, samples.data(), 1, 1) == expected);
+   REQUIRE(Apply<T>(dither, type, format, samples.data(), 1, 3) == expected);
+}
+}
+
+TEST_CASE("Dither of contiguous floats agrees with the sample loop")
+{
+   std::mt19937 engine{ 42 };
+   std::uniform_real_distribution<float> distribution{ -1.5f, 1.5f };
+   std::vector<float> samples(Length), interleaved(2 * Length);
+   for (size_t ii = 0; ii < Length; ++ii)
+      interleaved[2 * ii] = samples[ii] = distribution(engine);
+   // Quiet passages, where dither matters most
+   for (size_t ii = 100; ii < 400; ++ii)
+      interleaved[2 * ii] = samples[ii] = samples[ii] / 20000;
+
+   Dither dither;
+   for (auto level : SupportedLevels()) {
+      INFO(LevelName(level));
+      SetLevel(level);
+      for (auto type : { DitherType::none, DitherType::rectangle,
+         DitherType::triangle, DitherType::shaped }) {
+         INFO(int(type));
+         Compare<short>(dither, type, int16Sample, interleaved, samples);
+         Compare<int>(dither, type, int24Sample, interleaved, samples);
+      }
+   }
+   SetLevel(DetectedLevel());
+}
+
+TEST_CASE("Dither noise continues from one conversion to the next")
+{
+   // Half of the least significant bit, so the noise decides the rounding
+   const std::vector<float> samples(Length, 0.5f / 32768);
+   Dither dither;
+   const auto first =
+      Apply<short>(dither, DitherType::rectangle, int16Sample,
+         samples.data(), 1, 1);
+   std::vector<short> second(Length);
+   dither.Apply(DitherType::rectangle,
+      reinterpret_cast<constSamplePtr>(samples.data()), floatSample,
+      reinterpret_cast<samplePtr>(second.data()), int16Sample, Length);
+   REQUIRE(first != second);
+}
@@ -0,0 +1,36 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  InterpolateAudioTests.cpp
+
+**********************************************************************/
+#include "InterpolateAudio.h"
+
+#include <catch2/catch.hpp>
+
+#include <cmath>
+#include <vector>
+
+TEST_CASE("InterpolateAudio", "")
+{
+   // Lengths as Repair uses them, with the bad samples in the middle and at
+   // either edge
+   struct Case { size_t len, firstBad, numBad; };
+   for (const auto [len, firstBad, numBad] : {
+      Case{ 640, 256, 128 }, Case{ 300, 100, 20 },
+      Case{ 200, 0, 30 }, Case{ 200, 170, 30 }
+   }) {
+      std::vector<float> truth(len);
+      for (size_t ii = 0; ii < len; ++ii)
+         truth[ii] = 0.5 * std::sin(ii * 0.05) + 0.2 * std::sin(ii * 0.13 + 1);
+      auto buffer = truth;
+      for (auto ii = firstBad; ii < firstBad + numBad; ++ii)
+         buffer[ii] = 0.9f;
+
+      InterpolateAudio(buffer.data(), len, firstBad, numBad);
+      for (size_t ii = 0; ii < len; ++ii)
+         REQUIRE(std::fabs(buffer[ii] - truth[ii]) < 1e-3);
+   }
+}
@@ -0,0 +1,104 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  LookaheadCompressorTest.cpp
+
+**********************************************************************/
+#include "LookaheadCompressor.h"
+
+#include <catch2/catch.hpp>
+
+#include <cmath>
+#include <vector>
+
+namespace {
+constexpr double Rate = 44100;
+
+float Peak(const std::vector<float> &samples, size_t start, size_t end)
+{
+   float peak = 0;
+   for (auto ii = start; ii < end; ++ii)
+      peak = std::max(peak, std::abs(samples[ii]));
+   return peak;
+}
+}
+
+TEST_CASE("LookaheadCompressor::StaticCurve", "[LookaheadCompressor]")
+{
+   LookaheadCompressor::Parameters parameters;
+   parameters.thresholdDb = -20;
+   parameters.ratio = 4;
+   parameters.kneeDb = 0;
+   REQUIRE(LookaheadCompressor::StaticCurve(parameters, -30) == 0);
+   REQUIRE(LookaheadCompressor::StaticCurve(parameters, -20) == 0);
+   REQUIRE(LookaheadCompressor::StaticCurve(parameters, -8) ==
+      Approx(-9));
+
+   // The soft knee meets both lines
+   parameters.kneeDb = 6;
+   REQUIRE(LookaheadCompressor::StaticCurve(parameters, -23) == 0);
+   REQUIRE(LookaheadCompressor::StaticCurve(parameters, -17) ==
+      Approx(-2.25));
+   REQUIRE(LookaheadCompressor::StaticCurve(parameters, -20) < 0);
+}
+
+TEST_CASE("LookaheadCompressor delays quiet input unchanged",
+   "[LookaheadCompressor]")
+{
+   LookaheadCompressor::Parameters parameters;
+   parameters.thresholdDb = -6;
+   LookaheadCompressor compressor{ 2, Rate, 5.0, parameters };
+   const auto latency = compressor.Latency();
+   REQUIRE(latency == 221);
+
+   // Longer than a chunk, and processed in uneven pieces
+   const size_t length = 3000;
+   std::vector<float> left(length), right(length);
+   for (size_t ii = 0; ii < length; ++ii) {
+      left[ii] = 0.1f * std::sin(0.01 * ii);
+      right[ii] = 0.1f * std::cos(0.03 * ii);
+   }
+   auto outLeft = left, outRight = right;
+   for (size_t start = 0; start < length;) {
+      const auto count = std::min<size_t>(700, length - start);
+      const float *in[]{ outLeft.data() + start, outRight.data() + start };
+      float *out[]{ outLeft.data() + start, outRight.data() + start };
+      compressor.Process(in, out, count);
+      start += count;
+   }
+   for (size_t ii = 0; ii < latency; ++ii)
+      REQUIRE(outLeft[ii] == 0);
+   for (size_t ii = latency; ii < length; ++ii) {
+      REQUIRE(outLeft[ii] == Approx(left[ii - latency]));
+      REQUIRE(outRight[ii] == Approx(right[ii - latency]));
+   }
+}
+
+TEST_CASE("LookaheadCompressor limits ahead of a transient",
+   "[LookaheadCompressor]")
+{
+   LookaheadCompressor::Parameters parameters;
+   parameters.thresholdDb = -20;
+   parameters.ratio = 1000;
+   parameters.kneeDb = 0;
+   parameters.attackMs = 0.5;
+   LookaheadCompressor compressor{ 1, Rate, 5.0, parameters };
+   const auto latency = compressor.Latency();
+
+   const size_t onset = 2000, length = 6000;
+   std::vector<float> samples(length, 0.0f);
+   for (auto ii = onset; ii < length; ++ii)
+      samples[ii] = (ii % 2) ? 0.9f : -0.9f;
+   const float *in[]{ samples.data() };
+   std::vector<float> output(length);
+   float *out[]{ output.data() };
+   compressor.Process(in, out, length);
+
+   // Gain is already reduced when the transient comes out of the delay
+   const auto threshold = std::pow(10.0f, -20.0f / 20);
+   REQUIRE(Peak(output, onset + latency, length) < 1.2f * threshold);
+   REQUIRE(Peak(output, length - 500, length) ==
+      Approx(threshold).epsilon(0.01));
+}
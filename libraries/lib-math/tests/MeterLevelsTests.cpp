@@ -0,0 +1,109 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  MeterLevelsTests.cpp
+
+**********************************************************************/
+#include "MeterLevels.h"
+
+#include <catch2/catch.hpp>
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace MeterLevels;
+
+namespace {
+constexpr int ClipRun = 3;
+constexpr float ClipLevel = 0.99f;
+
+//! The loop that meters used before
+std::vector<Levels> Reference(
+   const std::vector<float> &samples, size_t numChannels, size_t numLevels)
+{
+   const auto numFrames = samples.size() / numChannels;
+   std::vector<Levels> result(numLevels);
+   std::vector<double> sumsq(numLevels);
+   for (size_t ii = 0; ii < numFrames; ++ii) {
+      for (size_t jj = 0; jj < numLevels; ++jj) {
+         const auto x = samples[ii * numChannels + jj];
+         auto &level = result[jj];
+         level.peak = std::max(level.peak, std::fabs(x));
+         sumsq[jj] += x * x;
+         if (std::fabs(x) >= ClipLevel) {
+            if (level.headPeakCount == int(ii))
+               ++level.headPeakCount;
+            if (++level.tailPeakCount > ClipRun)
+               level.clipping = true;
+         }
+         else
+            level.tailPeakCount = 0;
+      }
+   }
+   for (size_t jj = 0; jj < numLevels; ++jj)
+      result[jj].rms = std::sqrt(sumsq[jj] / numFrames);
+   return result;
+}
+
+void Check(const std::vector<float> &samples, size_t numChannels,
+   size_t numLevels)
+{
+   const auto expected = Reference(samples, numChannels, numLevels);
+   std::vector<Levels> levels(numLevels);
+   Measure(samples.data(), numChannels, samples.size() / numChannels,
+      levels.data(), numLevels, ClipRun, ClipLevel);
+   for (size_t jj = 0; jj < numLevels; ++jj) {
+      CAPTURE(numChannels, numLevels, jj);
+      REQUIRE(levels[jj].peak == expected[jj].peak);
+      REQUIRE(levels[jj].rms == Approx(expected[jj].rms).epsilon(1e-5));
+      REQUIRE(levels[jj].clipping == expected[jj].clipping);
+      REQUIRE(levels[jj].headPeakCount == expected[jj].headPeakCount);
+      REQUIRE(levels[jj].tailPeakCount == expected[jj].tailPeakCount);
+   }
+}
+}
+
+TEST_CASE("MeterLevels match the scalar loop", "[MeterLevels]")
+{
+   std::mt19937 engine{ 7 };
+   std::uniform_real_distribution<float> distribution{ -0.9f, 0.9f };
+   // Odd frame counts leave a remainder after the vectors
+   for (size_t numChannels : { 1, 2, 3, 4, 6, 8, 64, 72 }) {
+      for (size_t numFrames : { 1, 5, 511 }) {
+         std::vector<float> samples(numChannels * numFrames);
+         for (auto &sample : samples)
+            sample = distribution(engine);
+         Check(samples, numChannels, numChannels);
+         Check(samples, numChannels, std::min<size_t>(numChannels, 2));
+      }
+   }
+}
+
+TEST_CASE("MeterLevels count peaked samples", "[MeterLevels]")
+{
+   constexpr size_t numFrames = 64;
+   std::vector<float> samples(2 * numFrames, 0.5f);
+   // Channel 0 peaks at the head and in a run long enough to clip;
+   // channel 1 peaks at the tail only
+   for (size_t ii : { 0, 1, 20, 21, 22, 23 })
+      samples[2 * ii] = -1.0f;
+   for (size_t ii : { 62, 63 })
+      samples[2 * ii + 1] = 1.0f;
+   Check(samples, 2, 2);
+
+   std::vector<Levels> levels(2);
+   Measure(samples.data(), 2, numFrames, levels.data(), 2, ClipRun, ClipLevel);
+   REQUIRE(levels[0].clipping);
+   REQUIRE(levels[0].headPeakCount == 2);
+   REQUIRE(levels[0].tailPeakCount == 0);
+   REQUIRE(!levels[1].clipping);
+   REQUIRE(levels[1].headPeakCount == 0);
+   REQUIRE(levels[1].tailPeakCount == 2);
+
+   // A buffer peaked throughout
+   std::fill(samples.begin(), samples.end(), 1.0f);
+   Check(samples, 2, 2);
+}
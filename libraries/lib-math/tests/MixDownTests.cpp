@@ -0,0 +1,43 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  MixDownTests.cpp
+
+**********************************************************************/
+#include "MixDown.h"
+
+#include <catch2/catch.hpp>
+
+#include <random>
+#include <vector>
+
+TEST_CASE("MixDown::WeightedSum", "")
+{
+   std::mt19937 engine{ 7 };
+   std::uniform_real_distribution<float> distribution{ -1.0f, 1.0f };
+   const float leftWeight = 0.25f, rightWeight = 0.75f;
+
+   // Lengths that leave every remainder of the vector loop
+   for (const size_t len : { 0, 1, 7, 8, 9, 100, 1027 }) {
+      CAPTURE(len);
+      std::vector<float> left(len), right(len), dst(len);
+      for (size_t ii = 0; ii < len; ++ii) {
+         left[ii] = distribution(engine);
+         right[ii] = distribution(engine);
+      }
+      MixDown::WeightedSum(left.data(), right.data(),
+         leftWeight, rightWeight, dst.data(), len);
+      for (size_t ii = 0; ii < len; ++ii) {
+         // Compilers may fuse the multiplications of the scalar loop
+         REQUIRE(dst[ii] ==
+            Approx(left[ii] * leftWeight + right[ii] * rightWeight));
+      }
+
+      // In place
+      MixDown::WeightedSum(left.data(), right.data(),
+         leftWeight, rightWeight, left.data(), len);
+      REQUIRE(left == dst);
+   }
+}
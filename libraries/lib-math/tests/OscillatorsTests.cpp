@@ -0,0 +1,60 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  OscillatorsTests.cpp
+
+**********************************************************************/
+#include "Oscillators.h"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+TEST_CASE("Oscillators::Sine", "")
+{
+   // Phases over several cycles both ways, in a length that leaves a
+   // remainder after the vectors
+   constexpr size_t len = 4099;
+   std::vector<float> phases(len), out(len);
+   for (size_t ii = 0; ii < len; ++ii)
+      phases[ii] = -3.0f + 6.0f * ii / len;
+   Oscillators::Sine(phases.data(), out.data(), len);
+   for (size_t ii = 0; ii < len; ++ii)
+      REQUIRE(std::fabs(out[ii] - std::sin(2 * M_PI * phases[ii])) < 2e-7);
+
+   // In place
+   Oscillators::Sine(phases.data(), phases.data(), len);
+   REQUIRE(phases == out);
+}
+
+TEST_CASE("Oscillators::WhiteNoise", "")
+{
+   constexpr size_t len = 1 << 16;
+   std::vector<float> out(len);
+   auto state = Oscillators::SeedNoise(0);
+   for (auto lane : state.lanes)
+      REQUIRE(lane != 0);
+   Oscillators::WhiteNoise(state, out.data(), len - 1);
+
+   double sum = 0, sumsq = 0;
+   for (size_t ii = 0; ii + 1 < len; ++ii) {
+      const auto x = out[ii];
+      REQUIRE(x >= -1.0f);
+      REQUIRE(x < 1.0f);
+      sum += x;
+      sumsq += x * x;
+   }
+   const auto n = double(len - 1);
+   REQUIRE(std::fabs(sum / n) < 0.02);
+   REQUIRE(std::fabs(sumsq / n - 1.0 / 3) < 0.01);
+
+   // The same seed repeats the noise
+   std::vector<float> again(len);
+   auto state2 = Oscillators::SeedNoise(0);
+   Oscillators::WhiteNoise(state2, again.data(), len - 1);
+   REQUIRE(std::equal(out.begin(), out.end() - 1, again.begin()));
+}
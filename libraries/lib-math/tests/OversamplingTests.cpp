@@ -0,0 +1,99 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  OversamplingTests.cpp
+
+**********************************************************************/
+#include "Oversampling.h"
+
+#include <catch2/catch.hpp>
+
+#include <cmath>
+#include <complex>
+#include <vector>
+
+namespace {
+//! Amplitude of the component of the given frequency, in cycles per sample
+double Amplitude(const std::vector<float> &samples, size_t first,
+   double frequency)
+{
+   std::complex<double> sum;
+   for (auto ii = first; ii < samples.size(); ++ii)
+      sum += double(samples[ii]) *
+         std::polar(1.0, -2 * M_PI * frequency * ii);
+   return 2 * std::abs(sum) / (samples.size() - first);
+}
+
+std::vector<float> Sine(size_t len, double frequency)
+{
+   std::vector<float> result(len);
+   for (size_t ii = 0; ii < len; ++ii)
+      result[ii] = std::sin(2 * M_PI * frequency * ii);
+   return result;
+}
+}
+
+TEST_CASE("Oversampling::DesignHalfBand", "")
+{
+   double coefs[4];
+   Oversampling::DesignHalfBand(coefs, 4, 0.25);
+   // As HIIR computes them
+   REQUIRE(coefs[0] == Approx(0.042455).margin(1e-6));
+   REQUIRE(coefs[3] == Approx(0.745714).margin(1e-6));
+   for (size_t ii = 1; ii < 4; ++ii)
+      REQUIRE(coefs[ii - 1] < coefs[ii]);
+}
+
+TEST_CASE("Oversampling::Oversampler", "")
+{
+   // A whole number of cycles in the measured part
+   constexpr size_t len = 4096, settle = 1024;
+   constexpr double frequency = 0.0625;
+   const auto input = Sine(len, frequency);
+
+   for (unsigned factor : { 1, 2, 4, 8 }) {
+      Oversampling::Oversampler oversampler{ factor };
+      REQUIRE(oversampler.GetFactor() == factor);
+
+      // Upsampled, the sine has no images
+      std::vector<float> up;
+      std::vector<float> output(len);
+      oversampler.Process(input.data(), output.data(), len,
+         [&](float *samples, size_t count){
+            up.insert(up.end(), samples, samples + count);
+         });
+      REQUIRE(up.size() == len * factor);
+      REQUIRE(Amplitude(up, settle * factor, frequency / factor) ==
+         Approx(1).margin(1e-3));
+      if (factor > 1)
+         REQUIRE(Amplitude(up, settle * factor, (1 - frequency) / factor)
+            < 1e-4);
+
+      // Down again, the sine passes unchanged in amplitude
+      REQUIRE(Amplitude(output, settle, frequency) == Approx(1).margin(1e-3));
+   }
+}
+
+TEST_CASE("Oversampling::Oversampler rejects aliases", "")
+{
+   // A sine made at the higher rate, above the original band, mostly
+   // vanishes when downsampled
+   constexpr size_t len = 4096, settle = 1024;
+   for (unsigned factor : { 2, 4, 8 }) {
+      Oversampling::Oversampler oversampler{ factor };
+      const auto frequency = 0.7 / factor;
+      const auto high = Sine(len * factor, frequency);
+      std::vector<float> zeros(len), output(len);
+      size_t position = 0;
+      oversampler.Process(zeros.data(), output.data(), len,
+         [&](float *samples, size_t count){
+            std::copy(high.begin() + position,
+               high.begin() + position + count, samples);
+            position += count;
+         });
+      // Where it would alias
+      REQUIRE(Amplitude(output, settle, 0.3) < 1e-4);
+   }
+}
@@ -0,0 +1,75 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  SampleConversionBenchmark.cpp
+
+  Throughput of each level of SampleConversion kernels, printed so that
+  regressions show up in the test log.
+
+**********************************************************************/
+#include "SampleConversion.h"
+
+#include <catch2/catch.hpp>
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+using namespace SampleConversion;
+
+namespace {
+// About one block of the sample block factory, repeated
+constexpr size_t Length = 262144;
+constexpr int Repetitions = 64;
+
+template<typename F>
+double MegasamplesPerSecond(F f)
+{
+   using namespace std::chrono;
+   // Warm up caches
+   f();
+   const auto start = steady_clock::now();
+   for (int ii = 0; ii < Repetitions; ++ii)
+      f();
+   const auto seconds =
+      duration<double>(steady_clock::now() - start).count();
+   return Length * double(Repetitions) / seconds / 1e6;
+}
+}
+
+TEST_CASE("SampleConversionBenchmark")
+{
+   std::vector<short> shorts(Length);
+   std::vector<int> ints(Length);
+   std::vector<float> floats(Length), floats2(Length);
+   for (size_t ii = 0; ii < Length; ++ii)
+      floats[ii] = float(ii % 2000) / 1000 - 1;
+
+   for (auto level : { Level::Scalar, Level::SSE2, Level::AVX2, Level::NEON })
+   {
+      SetLevel(level);
+      if (ActiveLevel() != level)
+         continue;
+
+      const auto report = [&](const char *name, double rate) {
+         std::cout << std::setw(8) << LevelName(level) << std::setw(16)
+            << name << std::setw(10) << std::fixed << std::setprecision(0)
+            << rate << " Msamples/s\n";
+         REQUIRE(rate > 0);
+      };
+      report("int16->float", MegasamplesPerSecond([&]{
+         Int16ToFloat(shorts.data(), floats2.data(), Length); }));
+      report("int24->float", MegasamplesPerSecond([&]{
+         Int24ToFloat(ints.data(), floats2.data(), Length); }));
+      report("float->int16", MegasamplesPerSecond([&]{
+         FloatToInt16(floats.data(), shorts.data(), Length); }));
+      report("float->int24", MegasamplesPerSecond([&]{
+         FloatToInt24(floats.data(), ints.data(), Length); }));
+      report("clip+scale", MegasamplesPerSecond([&]{
+         ClipAndScale(floats.data(), floats2.data(), Length, 32768.0f); }));
+   }
+   SetLevel(DetectedLevel());
+}
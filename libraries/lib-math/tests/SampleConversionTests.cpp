@@ -0,0 +1,135 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  SampleConversionTests.cpp
+
+**********************************************************************/
+#include "SampleConversion.h"
+
+#include <catch2/catch.hpp>
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+using namespace SampleConversion;
+
+namespace {
+// Odd length, so that every kernel also leaves a remainder
+constexpr size_t Length = 1027;
+
+std::vector<Level> SupportedLevels()
+{
+   std::vector<Level> levels{ Level::Scalar };
+   for (auto level : { Level::SSE2, Level::AVX2, Level::NEON }) {
+      SetLevel(level);
+      if (ActiveLevel() == level)
+         levels.push_back(level);
+   }
+   SetLevel(DetectedLevel());
+   return levels;
+}
+
+std::vector<float> FloatSamples()
+{
+   std::mt19937 engine{ 42 };
+   std::uniform_real_distribution<float> distribution{ -1.5f, 1.5f };
+   std::vector<float> samples(Length);
+   for (auto &sample : samples)
+      sample = distribution(engine);
+   // Boundary cases
+   samples[0] = 1.0f;
+   samples[1] = -1.0f;
+   samples[2] = 0.0f;
+   samples[3] = 0.99999994f;
+   samples[4] = 1.5f / 32768;
+   samples[5] = 2.5f / 32768;
+   return samples;
+}
+
+template<typename T, typename F>
+std::vector<T> Convert(Level level, size_t len, F f)
+{
+   SetLevel(level);
+   std::vector<T> result(len);
+   f(result.data());
+   SetLevel(DetectedLevel());
+   return result;
+}
+}
+
+TEST_CASE("SampleConversion agrees with scalar kernels")
+{
+   const auto levels = SupportedLevels();
+   const auto floats = FloatSamples();
+
+   std::vector<short> shorts(Length);
+   std::vector<int> ints(Length);
+   {
+      std::mt19937 engine{ 7 };
+      std::uniform_int_distribution<int> distribution{ -8388608, 8388607 };
+      for (size_t ii = 0; ii < Length; ++ii) {
+         ints[ii] = distribution(engine);
+         shorts[ii] = static_cast<short>(ints[ii] >> 8);
+      }
+      shorts[0] = -32768;
+      shorts[1] = 32767;
+      ints[0] = -8388608;
+      ints[1] = 8388607;
+   }
+
+   for (auto level : levels) {
+      INFO(LevelName(level));
+
+      // Int16 to float
+      {
+         const auto fn = [&](float *dst){
+            Int16ToFloat(shorts.data(), dst, Length); };
+         REQUIRE(Convert<float>(level, Length, fn) ==
+            Convert<float>(Level::Scalar, Length, fn));
+         REQUIRE(Convert<float>(level, Length, fn)[0] == -1.0f);
+      }
+
+      // Int24 to float
+      {
+         const auto fn = [&](float *dst){
+            Int24ToFloat(ints.data(), dst, Length); };
+         REQUIRE(Convert<float>(level, Length, fn) ==
+            Convert<float>(Level::Scalar, Length, fn));
+      }
+
+      // Float to int16
+      {
+         const auto fn = [&](short *dst){
+            FloatToInt16(floats.data(), dst, Length); };
+         const auto result = Convert<short>(level, Length, fn);
+         REQUIRE(result == Convert<short>(Level::Scalar, Length, fn));
+         REQUIRE(result[0] == 32767);
+         REQUIRE(result[1] == -32768);
+         REQUIRE(result[2] == 0);
+         // Round half to even
+         REQUIRE(result[4] == 2);
+         REQUIRE(result[5] == 2);
+      }
+
+      // Float to int24
+      {
+         const auto fn = [&](int *dst){
+            FloatToInt24(floats.data(), dst, Length); };
+         const auto result = Convert<int>(level, Length, fn);
+         REQUIRE(result == Convert<int>(Level::Scalar, Length, fn));
+         REQUIRE(result[0] == 8388607);
+         REQUIRE(result[1] == -8388608);
+      }
+
+      // Clip and scale
+      {
+         const auto fn = [&](float *dst){
+            ClipAndScale(floats.data(), dst, Length, 32768.0f); };
+         REQUIRE(Convert<float>(level, Length, fn) ==
+            Convert<float>(Level::Scalar, Length, fn));
+      }
+   }
+}
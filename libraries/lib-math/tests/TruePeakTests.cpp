@@ -0,0 +1,95 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  TruePeakTests.cpp
+
+**********************************************************************/
+#include "TruePeak.h"
+
+#include <catch2/catch.hpp>
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace {
+std::vector<float> Sine(size_t len, double cyclesPerSample, double phase)
+{
+   std::vector<float> result(len);
+   for (size_t ii = 0; ii < len; ++ii)
+      result[ii] = std::sin(2 * M_PI * cyclesPerSample * ii + phase);
+   return result;
+}
+}
+
+TEST_CASE("TruePeak passes constant signals", "[TruePeak]")
+{
+   // Fade in slowly, so that the filter does not ring
+   std::vector<float> samples(1000, 0.5f);
+   for (size_t ii = 0; ii < 500; ++ii)
+      samples[ii] = 0.25 * (1 - std::cos(M_PI * ii / 500));
+   TruePeak truePeak;
+   truePeak.Process(samples.data(), samples.size());
+   REQUIRE(truePeak.GetPeak() == Approx(0.5f).epsilon(0.01));
+}
+
+TEST_CASE("TruePeak finds peaks between samples", "[TruePeak]")
+{
+   // At a quarter of the rate, and 45 degrees out of phase, every sample is
+   // about 0.707 in magnitude, but the sine reaches 1
+   const auto samples = Sine(1000, 0.25, M_PI / 4);
+   float samplePeak = 0;
+   for (auto x : samples)
+      samplePeak = std::max(samplePeak, std::fabs(x));
+   REQUIRE(samplePeak == Approx(M_SQRT1_2).epsilon(0.001));
+
+   TruePeak truePeak;
+   truePeak.Process(samples.data(), samples.size());
+   REQUIRE(truePeak.GetPeak() > 0.95f);
+   REQUIRE(truePeak.GetPeak() < 1.05f);
+}
+
+TEST_CASE("TruePeak is never less than the sample peak", "[TruePeak]")
+{
+   std::mt19937 engine{ 1 };
+   std::uniform_real_distribution<float> distribution{ -1, 1 };
+   std::vector<float> samples(4096);
+   for (auto &x : samples)
+      x = distribution(engine);
+   float samplePeak = 0;
+   for (auto x : samples)
+      samplePeak = std::max(samplePeak, std::fabs(x));
+
+   TruePeak truePeak;
+   truePeak.Process(samples.data(), samples.size());
+   REQUIRE(truePeak.GetPeak() >= samplePeak);
+}
+
+TEST_CASE("TruePeak is the same in pieces and with strides", "[TruePeak]")
+{
+   const auto samples = Sine(3000, 0.23, 0.3);
+
+   TruePeak whole;
+   whole.Process(samples.data(), samples.size());
+
+   TruePeak pieces;
+   for (size_t ii = 0; ii < samples.size(); ii += 7)
+      pieces.Process(samples.data() + ii,
+         std::min<size_t>(7, samples.size() - ii));
+   REQUIRE(pieces.GetPeak() == whole.GetPeak());
+
+   // The same samples, interleaved with another channel
+   std::vector<float> interleaved(2 * samples.size());
+   for (size_t ii = 0; ii < samples.size(); ++ii) {
+      interleaved[2 * ii] = 0.1f;
+      interleaved[2 * ii + 1] = samples[ii];
+   }
+   TruePeak strided;
+   strided.Process(interleaved.data() + 1, samples.size(), 2);
+   REQUIRE(strided.GetPeak() == whole.GetPeak());
+
+   strided.Reset();
+   REQUIRE(strided.GetPeak() == 0);
+}
@@ -15,6 +15,7 @@
 #include "AudacityException.h"
 #include "AudioGraphBuffers.h"
 #include "WideSampleSequence.h"
+#include "Tracing.h"
 #include <cassert>
 
 namespace {
@@ -327,6 +328,7 @@ bool EffectStage::Process(EffectInstance &instance,
       // as dummy output
       advancedOutPositions.resize(size, advancedOutPositions.back());
 
+      TRACE_SCOPE("Effect block");
       processed = instance.ProcessBlock(mSettings,
          inPositions.data(), advancedOutPositions.data(), curBlockSize);
    }
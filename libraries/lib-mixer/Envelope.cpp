@@ -29,6 +29,7 @@ a draggable point type.
 
 #include "Envelope.h"
 
+#include <algorithm>
 #include <float.h>
 #include <math.h>
 
@@ -60,6 +61,7 @@ bool Envelope::IsTrivial() const
 
 bool Envelope::ConsistencyCheck()
 {
+   InvalidateIntegrals();
    bool consistent = true;
 
    bool disorder;
@@ -115,6 +117,7 @@ bool Envelope::ConsistencyCheck()
 /// @maxValue - the NEW maximum value
 void Envelope::RescaleValues(double minValue, double maxValue)
 {
+   InvalidateIntegrals();
    double oldMinValue = mMinValue;
    double oldMaxValue = mMaxValue;
    mMinValue = minValue;
@@ -137,6 +140,7 @@ void Envelope::RescaleValues(double minValue, double maxValue)
 /// @value - the y-value for the flat envelope.
 void Envelope::Flatten(double value)
 {
+   InvalidateIntegrals();
    mEnv.clear();
    mDefaultValue = ClampValue(value);
 }
@@ -149,6 +153,7 @@ void Envelope::SetDragPoint(int dragPoint)
 
 void Envelope::SetDragPointValid(bool valid)
 {
+   InvalidateIntegrals();
    mDragPointValid = (valid && mDragPoint >= 0);
    if (mDragPoint >= 0 && !valid) {
       // We're going to be deleting the point; On
@@ -186,6 +191,7 @@ void Envelope::SetDragPointValid(bool valid)
 
 void Envelope::MoveDragPoint(double newWhen, double value)
 {
+   InvalidateIntegrals();
    SetDragPointValid(true);
    if (!mDragPointValid)
       return;
@@ -212,6 +218,7 @@ void Envelope::MoveDragPoint(double newWhen, double value)
 
 void Envelope::ClearDragPoint()
 {
+   InvalidateIntegrals();
    if (!mDragPointValid && mDragPoint >= 0)
       Delete(mDragPoint);
 
@@ -220,6 +227,7 @@ void Envelope::ClearDragPoint()
 }
 
 void Envelope::SetRange(double minValue, double maxValue) {
+   InvalidateIntegrals();
    mMinValue = minValue;
    mMaxValue = maxValue;
    mDefaultValue = ClampValue(mDefaultValue);
@@ -231,6 +239,7 @@ void Envelope::SetRange(double minValue, double maxValue) {
 // copy of another, or when truncating a track.
 void Envelope::AddPointAtEnd( double t, double val )
 {
+   InvalidateIntegrals();
    mEnv.push_back( EnvPoint{ t, val } );
 
    // Assume copied points were stored by nondecreasing time.
@@ -273,6 +282,7 @@ Envelope::Envelope(const Envelope &orig)
 
 void Envelope::CopyRange(const Envelope &orig, size_t begin, size_t end)
 {
+   InvalidateIntegrals();
    size_t len = orig.mEnv.size();
    size_t i = begin;
 
@@ -308,6 +318,7 @@ static double Limit( double Lo, double Value, double Hi )
 
 bool Envelope::HandleXMLTag(const std::string_view& tag, const AttributesList& attrs)
 {
+   InvalidateIntegrals();
    // Return unless it's the envelope tag.
    if (tag != "envelope")
       return false;
@@ -333,6 +344,7 @@ bool Envelope::HandleXMLTag(const std::string_view& tag, const AttributesList& a
 
 XMLTagHandler *Envelope::HandleXMLChild(const std::string_view& tag)
 {
+   InvalidateIntegrals();
    if (tag != "controlpoint")
       return NULL;
 
@@ -361,22 +373,26 @@ void Envelope::WriteXML(XMLWriter &xmlFile) const
 
 void Envelope::Delete( int point )
 {
+   InvalidateIntegrals();
    mEnv.erase(mEnv.begin() + point);
 }
 
 void Envelope::Insert(int point, const EnvPoint &p) noexcept
 {
+   InvalidateIntegrals();
    mEnv.insert(mEnv.begin() + point, p);
 }
 
 void Envelope::Insert(double when, double value)
 {
+   InvalidateIntegrals();
    mEnv.push_back( EnvPoint{ when, value });
 }
 
 /*! @excsafety{No-fail} */
 void Envelope::CollapseRegion(double t0, double t1, double sampleDur) noexcept
 {
+   InvalidateIntegrals();
    if ( t1 <= t0 )
       return;
 
@@ -465,6 +481,7 @@ void Envelope::CollapseRegion(double t0, double t1, double sampleDur) noexcept
 /*! @excsafety{No-fail} */
 void Envelope::PasteEnvelope( double t0, const Envelope *e, double sampleDur )
 {
+   InvalidateIntegrals();
    const bool wasEmpty = (this->mEnv.size() == 0);
    auto otherSize = e->mEnv.size();
    const double otherDur = e->mTrackLen;
@@ -549,6 +566,7 @@ void Envelope::PasteEnvelope( double t0, const Envelope *e, double sampleDur )
 void Envelope::RemoveUnneededPoints(
    size_t startAt, bool rightward, bool testNeighbors) noexcept
 {
+   InvalidateIntegrals();
    // startAt is the index of a recently inserted point which might make no
    // difference in envelope evaluation, or else might cause nearby points to
    // make no difference.
@@ -615,6 +633,7 @@ void Envelope::RemoveUnneededPoints(
 std::pair< int, int > Envelope::ExpandRegion
    ( double t0, double tlen, double *pLeftVal, double *pRightVal )
 {
+   InvalidateIntegrals();
    // t0 is relative time
 
    double val = GetValueRelative( t0 );
@@ -665,6 +684,7 @@ std::pair< int, int > Envelope::ExpandRegion
 /*! @excsafety{No-fail} */
 void Envelope::InsertSpace( double t0, double tlen )
 {
+   InvalidateIntegrals();
    auto range = ExpandRegion( t0 - mOffset, tlen, nullptr, nullptr );
 
    // Simplify the boundaries if possible
@@ -674,6 +694,7 @@ void Envelope::InsertSpace( double t0, double tlen )
 
 int Envelope::Reassign(double when, double value)
 {
+   InvalidateIntegrals();
    when -= mOffset;
 
    int len = mEnv.size();
@@ -713,6 +734,7 @@ void Envelope::GetPoints(double *bufferWhen,
 
 void Envelope::Cap( double sampleDur )
 {
+   InvalidateIntegrals();
    auto range = EqualRange( mTrackLen, sampleDur );
    if ( range.first == range.second )
       InsertOrReplaceRelative( mTrackLen, GetValueRelative( mTrackLen ) );
@@ -728,6 +750,7 @@ void Envelope::Cap( double sampleDur )
  */
 int Envelope::InsertOrReplaceRelative(double when, double value) noexcept
 {
+   InvalidateIntegrals();
 #if defined(_DEBUG)
    // in debug builds, do a spot of argument checking
    if(when > mTrackLen + 0.0000001)
@@ -793,6 +816,7 @@ void Envelope::SetOffset(double newOffset)
 /*! @excsafety{No-fail} */
 void Envelope::SetTrackLen( double trackLen, double sampleDur )
 {
+   InvalidateIntegrals();
    // Preserve the left-side limit at trackLen.
    auto range = EqualRange( trackLen, sampleDur );
    bool needPoint = ( range.first == range.second && trackLen < mTrackLen );
@@ -814,6 +838,7 @@ void Envelope::SetTrackLen( double trackLen, double sampleDur )
 /*! @excsafety{No-fail} */
 void Envelope::RescaleTimes( double newLength )
 {
+   InvalidateIntegrals();
    if ( mTrackLen == 0 ) {
       for ( auto &point : mEnv )
          point.SetT( 0 );
@@ -828,6 +853,7 @@ void Envelope::RescaleTimes( double newLength )
 
 void Envelope::RescaleTimesBy(double ratio)
 {
+   InvalidateIntegrals();
    for (auto& point : mEnv)
       point.SetT(point.GetT() * ratio);
    if (mTrackLen != DBL_MAX)
@@ -944,119 +970,163 @@ void Envelope::GetValues( double *buffer, int bufferLen,
    GetValuesRelative( buffer, bufferLen, t0, tstep);
 }
 
+namespace {
+//! Fill a run of samples between two envelope points
+/*!
+ The loops have no dependencies between iterations, except at a stride of
+ four samples in the exponential case, so that compilers can vectorize them
+ */
+void FillSegment(double *buffer, int len, double v, double vstep, bool db)
+{
+   if (db ? vstep == 1.0 : vstep == 0.0) {
+      // Flat stretch
+      std::fill(buffer, buffer + len, v);
+      return;
+   }
+   if (!db) {
+      for (int ii = 0; ii < len; ++ii)
+         buffer[ii] = v + ii * vstep;
+      return;
+   }
+   // Each of four lanes multiplies by the fourth power of the ratio
+   constexpr int lanes = 4;
+   double values[lanes];
+   values[0] = v;
+   for (int jj = 1; jj < lanes; ++jj)
+      values[jj] = values[jj - 1] * vstep;
+   const auto ratio = (vstep * vstep) * (vstep * vstep);
+   int ii = 0;
+   for (; ii + lanes <= len; ii += lanes)
+      for (int jj = 0; jj < lanes; ++jj) {
+         buffer[ii + jj] = values[jj];
+         values[jj] *= ratio;
+      }
+   for (int jj = 0; ii < len; ++ii, ++jj)
+      buffer[ii] = values[jj];
+}
+}
+
 void Envelope::GetValuesRelative
    (double *buffer, int bufferLen, double t0, double tstep, bool leftLimit)
    const noexcept
 {
    // JC: If bufferLen ==0 we have probably just allocated a zero sized buffer.
    // wxASSERT( bufferLen > 0 );
+   if (bufferLen <= 0)
+      return;
 
-   const auto epsilon = tstep / 2;
-   int len = mEnv.size();
+   // IF empty envelope THEN default value
+   const int len = mEnv.size();
+   if (len <= 0) {
+      std::fill(buffer, buffer + bufferLen, mDefaultValue);
+      return;
+   }
 
-   double t = t0;
+   const auto epsilon = tstep / 2;
    double increment = 0;
-   if ( len > 1 && t <= mEnv[0].GetT() && mEnv[0].GetT() == mEnv[1].GetT() )
+   if ( len > 1 && t0 <= mEnv[0].GetT() && mEnv[0].GetT() == mEnv[1].GetT() )
       increment = leftLimit ? -epsilon : epsilon;
 
-   double tprev, vprev, tnext = 0, vnext, vstep = 0;
-
-   for (int b = 0; b < bufferLen; b++) {
-
-      // Get easiest cases out the way first...
-      // IF empty envelope THEN default value
-      if (len <= 0) {
-         buffer[b] = mDefaultValue;
-         t += tstep;
-         continue;
-      }
+   const auto timeAt = [&](int b){ return t0 + b * tstep; };
+   const auto tFirst = mEnv[0].GetT(), tLast = mEnv[len - 1].GetT();
+
+   // How many samples from b on, up to the end of the buffer, satisfy a
+   // predicate of the time that is true for b and then false, when time
+   // increases; find the end by division, then correct for roundoff
+   const auto countRun = [&](int b, double limit, auto pred){
+      const auto remaining = bufferLen - b;
+      if (!(tstep > 0))
+         return remaining;
+      auto count = static_cast<int>(std::clamp<double>(
+         ceil((limit - timeAt(b) - increment) / tstep), 1, remaining));
+      while (count > 1 && !pred(timeAt(b + count - 1) + increment))
+         --count;
+      while (count < remaining && pred(timeAt(b + count) + increment))
+         ++count;
+      return count;
+   };
 
-      auto tplus = t + increment;
+   // The envelope is evaluated in runs of samples, each within one
+   // point-to-point interval, or before the first point, or after the last
+   for (int b = 0; b < bufferLen;) {
+      const auto t = timeAt(b);
+      const auto tplus = t + increment;
 
       // IF before envelope THEN first value
-      if ( leftLimit ? tplus <= mEnv[0].GetT() : tplus < mEnv[0].GetT() ) {
-         buffer[b] = mEnv[0].GetVal();
-         t += tstep;
+      const auto before = [&](double tt){
+         return leftLimit ? tt <= tFirst : tt < tFirst; };
+      if ( before(tplus) ) {
+         const auto n = countRun(b, tFirst, before);
+         std::fill(buffer + b, buffer + b + n, mEnv[0].GetVal());
+         b += n;
          continue;
       }
       // IF after envelope THEN last value
-      if ( leftLimit
-            ? tplus > mEnv[len - 1].GetT() : tplus >= mEnv[len - 1].GetT() ) {
-         buffer[b] = mEnv[len - 1].GetVal();
-         t += tstep;
-         continue;
+      if ( leftLimit ? tplus > tLast : tplus >= tLast ) {
+         std::fill(buffer + b, buffer + bufferLen, mEnv[len - 1].GetVal());
+         return;
       }
 
-      // be careful to get the correct limit even in case epsilon == 0
-      if ( b == 0 ||
-           ( leftLimit ? tplus > tnext : tplus >= tnext ) ) {
-
-         // We're beyond our tnext, so find the next one.
-         // Don't just increment lo or hi because we might
-         // be zoomed far out and that could be a large number of
-         // points to move over.  That's why we binary search.
-
-         int lo,hi;
-         if ( leftLimit )
-            BinarySearchForTime_LeftLimit( lo, hi, tplus );
-         else
-            BinarySearchForTime( lo, hi, tplus );
-
-         // mEnv[0] is before tplus because of eliminations above, therefore lo >= 0
-         // mEnv[len - 1] is after tplus, therefore hi <= len - 1
-         wxASSERT( lo >= 0 && hi <= len - 1 );
-
-         tprev = mEnv[lo].GetT();
-         tnext = mEnv[hi].GetT();
-
-         if ( hi + 1 < len && tnext == mEnv[ hi + 1 ].GetT() )
-            // There is a discontinuity after this point-to-point interval.
-            // Usually will stop evaluating in this interval when time is slightly
-            // before tNext, then use the right limit.
-            // This is the right intent
-            // in case small roundoff errors cause a sample time to be a little
-            // before the envelope point time.
-            // Less commonly we want a left limit, so we continue evaluating in
-            // this interval until shortly after the discontinuity.
-            increment = leftLimit ? -epsilon : epsilon;
-         else
-            increment = 0;
-
-         vprev = GetInterpolationStartValueAtPoint( lo );
-         vnext = GetInterpolationStartValueAtPoint( hi );
-
-         // Interpolate, either linear or log depending on mDB.
-         double dt = (tnext - tprev);
-         double to = t - tprev;
-         double v;
-         if (dt > 0.0)
-         {
-            v = (vprev * (dt - to) + vnext * to) / dt;
-            vstep = (vnext - vprev) * tstep / dt;
-         }
-         else
-         {
-            v = vnext;
-            vstep = 0.0;
-         }
+      // Don't just increment lo or hi because we might
+      // be zoomed far out and that could be a large number of
+      // points to move over.  That's why we binary search.
+      int lo,hi;
+      if ( leftLimit )
+         BinarySearchForTime_LeftLimit( lo, hi, tplus );
+      else
+         BinarySearchForTime( lo, hi, tplus );
+
+      // mEnv[0] is before tplus because of eliminations above, therefore lo >= 0
+      // mEnv[len - 1] is after tplus, therefore hi <= len - 1
+      wxASSERT( lo >= 0 && hi <= len - 1 );
+
+      const auto tprev = mEnv[lo].GetT();
+      const auto tnext = mEnv[hi].GetT();
+
+      if ( hi + 1 < len && tnext == mEnv[ hi + 1 ].GetT() )
+         // There is a discontinuity after this point-to-point interval.
+         // Usually will stop evaluating in this interval when time is slightly
+         // before tNext, then use the right limit.
+         // This is the right intent
+         // in case small roundoff errors cause a sample time to be a little
+         // before the envelope point time.
+         // Less commonly we want a left limit, so we continue evaluating in
+         // this interval until shortly after the discontinuity.
+         increment = leftLimit ? -epsilon : epsilon;
+      else
+         increment = 0;
 
-         // An adjustment if logarithmic scale.
-         if( mDB )
-         {
-            v = pow(10.0, v);
-            vstep = pow( 10.0, vstep );
-         }
+      const auto vprev = GetInterpolationStartValueAtPoint( lo );
+      const auto vnext = GetInterpolationStartValueAtPoint( hi );
 
-         buffer[b] = v;
-      } else {
-         if (mDB){
-            buffer[b] = buffer[b - 1] * vstep;
-         }else{
-            buffer[b] = buffer[b - 1] + vstep;
-         }
+      // Interpolate, either linear or log depending on mDB.
+      double dt = (tnext - tprev);
+      double to = t - tprev;
+      double v, vstep;
+      if (dt > 0.0)
+      {
+         v = (vprev * (dt - to) + vnext * to) / dt;
+         vstep = (vnext - vprev) * tstep / dt;
+      }
+      else
+      {
+         v = vnext;
+         vstep = 0.0;
       }
 
-      t += tstep;
+      // An adjustment if logarithmic scale.
+      if( mDB )
+      {
+         v = pow(10.0, v);
+         vstep = pow( 10.0, vstep );
+      }
+
+      // The first sample always belongs to the run; be careful to get the
+      // correct limit even in case epsilon == 0
+      const auto n = countRun(b, tnext, [&](double tt){
+         return leftLimit ? tt <= tnext : tt < tnext; });
+      FillSegment(buffer + b, n, v, vstep, mDB);
+      b += n;
    }
 }
 
@@ -1242,6 +1312,43 @@ double Envelope::Integral( double t0, double t1 ) const
    }
 }
 
+const std::vector<double> &Envelope::GetInverseIntegrals() const
+{
+   auto &cache = mInverseIntegrals;
+   if (!cache.valid.load(std::memory_order_acquire)) {
+      std::lock_guard<std::mutex> guard{ cache.mutex };
+      if (!cache.valid.load(std::memory_order_relaxed)) {
+         auto &sums = cache.sums;
+         const auto count = mEnv.size();
+         sums.resize(count);
+         double total = 0.0;
+         for (size_t i = 0; i < count; ++i) {
+            if (i > 0)
+               total += IntegrateInverseInterpolated(
+                  mEnv[i - 1].GetVal(), mEnv[i].GetVal(),
+                  mEnv[i].GetT() - mEnv[i - 1].GetT(), mDB);
+            sums[i] = total;
+         }
+         cache.valid.store(true, std::memory_order_release);
+      }
+   }
+   return cache.sums;
+}
+
+double Envelope::InverseIntegralTo(
+   const std::vector<double> &sums, double t) const noexcept
+{
+   const auto count = mEnv.size();
+   if (t < mEnv[0].GetT())
+      return (t - mEnv[0].GetT()) / mEnv[0].GetVal();
+   if (t >= mEnv[count - 1].GetT())
+      return sums[count - 1] + (t - mEnv[count - 1].GetT()) / mEnv[count - 1].GetVal();
+   int lo, hi;
+   BinarySearchForTime(lo, hi, t);
+   const auto val = InterpolatePoints(mEnv[lo].GetVal(), mEnv[hi].GetVal(), (t - mEnv[lo].GetT()) / (mEnv[hi].GetT() - mEnv[lo].GetT()), mDB);
+   return sums[lo] + IntegrateInverseInterpolated(mEnv[lo].GetVal(), val, t - mEnv[lo].GetT(), mDB);
+}
+
 double Envelope::IntegralOfInverse( double t0, double t1 ) const
 {
    if(t0 == t1)
@@ -1258,51 +1365,16 @@ double Envelope::IntegralOfInverse( double t0, double t1 ) const
    t0 -= mOffset;
    t1 -= mOffset;
 
-   double total = 0.0, lastT, lastVal;
-   unsigned int i; // this is the next point to check
-   if(t0 < mEnv[0].GetT()) // t0 preceding the first point
-   {
-      if(t1 <= mEnv[0].GetT())
-         return (t1 - t0) / mEnv[0].GetVal();
-      i = 1;
-      lastT = mEnv[0].GetT();
-      lastVal = mEnv[0].GetVal();
-      total += (lastT - t0) / lastVal;
-   }
-   else if(t0 >= mEnv[count - 1].GetT()) // t0 at or following the last point
-   {
+   // Both ends in the same interval, or both outside the points: integrate
+   // directly, without the roundoff of a difference of large sums
+   if (t1 <= mEnv[0].GetT())
+      return (t1 - t0) / mEnv[0].GetVal();
+   if (t0 >= mEnv[count - 1].GetT())
       return (t1 - t0) / mEnv[count - 1].GetVal();
-   }
-   else // t0 enclosed by points
-   {
-      // Skip any points that come before t0 using binary search
-      int lo, hi;
-      BinarySearchForTime(lo, hi, t0);
-      lastVal = InterpolatePoints(mEnv[lo].GetVal(), mEnv[hi].GetVal(), (t0 - mEnv[lo].GetT()) / (mEnv[hi].GetT() - mEnv[lo].GetT()), mDB);
-      lastT = t0;
-      i = hi; // the point immediately after t0.
-   }
 
-   // loop through the rest of the envelope points until we get to t1
-   while (1)
-   {
-      if(i >= count) // the requested range extends beyond the last point
-      {
-         return total + (t1 - lastT) / lastVal;
-      }
-      else if(mEnv[i].GetT() >= t1) // this point follows the end of the range
-      {
-         double thisVal = InterpolatePoints(mEnv[i - 1].GetVal(), mEnv[i].GetVal(), (t1 - mEnv[i - 1].GetT()) / (mEnv[i].GetT() - mEnv[i - 1].GetT()), mDB);
-         return total + IntegrateInverseInterpolated(lastVal, thisVal, t1 - lastT, mDB);
-      }
-      else // this point precedes the end of the range
-      {
-         total += IntegrateInverseInterpolated(lastVal, mEnv[i].GetVal(), mEnv[i].GetT() - lastT, mDB);
-         lastT = mEnv[i].GetT();
-         lastVal = mEnv[i].GetVal();
-         i++;
-      }
-   }
+   // Look up the sums of whole intervals in O(log n)
+   const auto &sums = GetInverseIntegrals();
+   return InverseIntegralTo(sums, t1) - InverseIntegralTo(sums, t0);
 }
 
 double Envelope::SolveIntegralOfInverse( double t0, double area ) const
@@ -1318,93 +1390,19 @@ double Envelope::SolveIntegralOfInverse( double t0, double area ) const
    t0 -= mOffset;
    return mOffset + [&] {
       // Now we can safely assume t0 is relative time!
-      double lastT, lastVal;
-      int i; // this is the next point to check
-      if(t0 < mEnv[0].GetT()) // t0 preceding the first point
-      {
-         if (area < 0) {
-            return t0 + area * mEnv[0].GetVal();
-         }
-         else {
-            i = 1;
-            lastT = mEnv[0].GetT();
-            lastVal = mEnv[0].GetVal();
-            double added = (lastT - t0) / lastVal;
-            if(added >= area)
-               return t0 + area * mEnv[0].GetVal();
-            area -= added;
-         }
-      }
-      else if(t0 >= mEnv[count - 1].GetT()) // t0 at or following the last point
-      {
-         if (area < 0) {
-            i = (int)count - 2;
-            lastT = mEnv[count - 1].GetT();
-            lastVal = mEnv[count - 1].GetVal();
-            double added = (lastT - t0) / lastVal; // negative
-            if(added <= area)
-               return t0 + area * mEnv[count - 1].GetVal();
-            area -= added;
-         }
-         else {
-            return t0 + area * mEnv[count - 1].GetVal();
-         }
-      }
-      else // t0 enclosed by points
-      {
-         // Skip any points that come before t0 using binary search
-         int lo, hi;
-         BinarySearchForTime(lo, hi, t0);
-         lastVal = InterpolatePoints(mEnv[lo].GetVal(), mEnv[hi].GetVal(), (t0 - mEnv[lo].GetT()) / (mEnv[hi].GetT() - mEnv[lo].GetT()), mDB);
-         lastT = t0;
-         if (area < 0)
-            i = lo;
-         else
-            i = hi; // the point immediately after t0.
-      }
-
-      if (area < 0) {
-         // loop BACKWARDS through the rest of the envelope points until we get to t1
-         // (which is less than t0)
-         while (1)
-         {
-            if(i < 0) // the requested range extends beyond the leftmost point
-            {
-               return lastT + area * lastVal;
-            }
-            else
-            {
-               double added =
-                  -IntegrateInverseInterpolated(mEnv[i].GetVal(), lastVal, lastT - mEnv[i].GetT(), mDB);
-               if(added <= area)
-                  return lastT - SolveIntegrateInverseInterpolated(lastVal, mEnv[i].GetVal(), lastT - mEnv[i].GetT(), -area, mDB);
-               area -= added;
-               lastT = mEnv[i].GetT();
-               lastVal = mEnv[i].GetVal();
-               --i;
-            }
-         }
-      }
-      else {
-         // loop through the rest of the envelope points until we get to t1
-         while (1)
-         {
-            if(i >= (int)count) // the requested range extends beyond the last point
-            {
-               return lastT + area * lastVal;
-            }
-            else
-            {
-               double added = IntegrateInverseInterpolated(lastVal, mEnv[i].GetVal(), mEnv[i].GetT() - lastT, mDB);
-               if(added >= area)
-                  return lastT + SolveIntegrateInverseInterpolated(lastVal, mEnv[i].GetVal(), mEnv[i].GetT() - lastT, area, mDB);
-               area -= added;
-               lastT = mEnv[i].GetT();
-               lastVal = mEnv[i].GetVal();
-               i++;
-            }
-         }
-      }
+      const auto &sums = GetInverseIntegrals();
+      const auto target = InverseIntegralTo(sums, t0) + area;
+
+      if (target < 0) // result precedes the first point
+         return mEnv[0].GetT() + target * mEnv[0].GetVal();
+      if (target >= sums[count - 1]) // result at or following the last point
+         return mEnv[count - 1].GetT() +
+            (target - sums[count - 1]) * mEnv[count - 1].GetVal();
+
+      // Find the interval, of positive length, whose sums bracket the area
+      const auto i = std::upper_bound(sums.begin(), sums.end(), target)
+         - sums.begin() - 1;
+      return mEnv[i].GetT() + SolveIntegrateInverseInterpolated(mEnv[i].GetVal(), mEnv[i + 1].GetVal(), mEnv[i + 1].GetT() - mEnv[i].GetT(), target - sums[i], mDB);
    }();
 }
 
@@ -13,8 +13,11 @@
 
 #include <stdlib.h>
 #include <algorithm>
+#include <atomic>
+#include <mutex>
 #include <vector>
 
+#include "ObjectPool.h"
 #include "XMLTagHandler.h"
 
 class wxRect;
@@ -66,7 +69,8 @@ private:
 
 };
 
-typedef std::vector<EnvPoint> EnvArray;
+//! Pooled, because most envelopes have few points, and edits copy them
+typedef std::vector<EnvPoint, ObjectPool::Allocator<EnvPoint>> EnvArray;
 struct TrackPanelDrawingContext;
 
 class MIXER_API Envelope /* not final */ : public XMLTagHandler {
@@ -93,7 +97,7 @@ public:
    double GetTrackLen() const { return mTrackLen; }
 
    bool GetExponential() const { return mDB; }
-   void SetExponential(bool db) { mDB = db; }
+   void SetExponential(bool db) { mDB = db; InvalidateIntegrals(); }
 
    void Flatten(double value);
 
@@ -170,7 +174,7 @@ public:
 
    bool IsDirty() const;
 
-   void Clear() { mEnv.clear(); }
+   void Clear() { mEnv.clear(); InvalidateIntegrals(); }
 
    /** \brief Add a point at a particular absolute time coordinate */
    int InsertOrReplace(double when, double value)
@@ -234,6 +238,29 @@ private:
       const noexcept;
    double GetInterpolationStartValueAtPoint(int iPoint) const noexcept;
 
+   //! Every change of the points or of the interpolation must call this
+   void InvalidateIntegrals() noexcept { mInverseIntegrals.valid = false; }
+   //! Integrals of the reciprocal from the first point to each point
+   /*! Computed again on demand after changes; safe to call from the audio
+    thread and the main thread at once */
+   const std::vector<double> &GetInverseIntegrals() const;
+   //! Integral of the reciprocal from the first point to relative time t,
+   //! negative before the first point
+   double InverseIntegralTo(
+      const std::vector<double> &sums, double t) const noexcept;
+
+   //! Copies of an envelope compute their own sums when needed
+   struct IntegralsCache {
+      IntegralsCache() = default;
+      IntegralsCache(const IntegralsCache &) {}
+      IntegralsCache &operator=(const IntegralsCache &)
+      { valid = false; return *this; }
+
+      std::vector<double> sums;
+      std::atomic<bool> valid{ false };
+      std::mutex mutex;
+   };
+
    // The list of envelope control points.
    EnvArray mEnv;
 
@@ -257,6 +284,8 @@ private:
    int mDragPoint { -1 };
 
    mutable int mSearchGuess { -2 };
+
+   mutable IntegralsCache mInverseIntegrals;
 };
 
 inline void EnvPoint::SetVal( Envelope *pEnvelope, double val )
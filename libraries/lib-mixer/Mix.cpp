@@ -23,6 +23,7 @@
 #include "Resample.h"
 #include "WideSampleSequence.h"
 #include "float_cast.h"
+#include "concurrency/ThreadPool.h"
 #include <numeric>
 
 namespace {
@@ -76,7 +77,7 @@ Mixer::Mixer(Inputs inputs,
    const size_t outBufferSize, const bool outInterleaved,
    double outRate, sampleFormat outFormat,
    const bool highQuality, MixerSpec *const mixerSpec,
-   ApplyGain applyGain
+   ApplyGain applyGain, const bool parallel
 )  : mNumChannels{ numOutChannels }
    , mInputs{ move(inputs) }
    , mBufferSize{ FindBufferSize(mInputs, outBufferSize) }
@@ -84,6 +85,7 @@ Mixer::Mixer(Inputs inputs,
    , mHighQuality{ highQuality }
    , mFormat{ outFormat }
    , mInterleaved{ outInterleaved }
+   , mRate{ outRate }
 
    , mTimesAndSpeed{ std::make_shared<TimesAndSpeed>( TimesAndSpeed{
       startTime, stopTime, warpOptions.initialSpeed, startTime
@@ -105,6 +107,7 @@ Mixer::Mixer(Inputs inputs,
       ](auto &buffer){ buffer.Allocate(size, format); }
    )}
    , mEffectiveFormat{ floatSample }
+   , mParallel{ parallel && mInputs.size() > 1 }
 {
    assert(BufferSize() <= outBufferSize);
    const auto nChannelsIn =
@@ -179,6 +182,13 @@ Mixer::Mixer(Inputs inputs,
       mDecoratedSources.emplace_back(Source{ source, *pDownstream });
    }
 
+   if (mParallel) {
+      mSourceBuffers.reserve(mDecoratedSources.size());
+      for (size_t ii = 0; ii < mDecoratedSources.size(); ++ii)
+         mSourceBuffers.emplace_back(3, mBufferSize, 1, 1);
+   }
+   mResults.resize(mDecoratedSources.size());
+
    // Decide once at construction time
    std::tie(mNeedsDither, mEffectiveFormat) = NeedsDither(needsDither, outRate);
 }
@@ -253,21 +263,75 @@ void Mixer::Clear()
       std::fill(buffer.begin(), buffer.end(), 0);
 }
 
-static void MixBuffers(unsigned numChannels,
-   const unsigned char *channelFlags, const float *gains,
-   const float &src, std::vector<std::vector<float>> &dests, int len)
+//! Accumulate into each output channel the input channels, weighted by one
+//! row of a gain matrix
+/*!
+ When one or two inputs contribute to an output, as for mono or stereo
+ sources, the output buffer is read and written only once; rows of zeroes
+ are skipped, and the loops have no dependencies between samples, so
+ compilers vectorize them
+ @param matrix numOutputs rows of nInputs gains
+ */
+static void MixBuffers(unsigned numOutputs, size_t nInputs,
+   const float *matrix, const float *const *srcs,
+   std::vector<std::vector<float>> &dests, size_t len)
 {
-   const auto pSrc = &src;
-   for (unsigned int c = 0; c < numChannels; c++) {
-      if (!channelFlags[c])
+   for (unsigned int c = 0; c < numOutputs; c++) {
+      const auto row = matrix + c * nInputs;
+      // Find at most two contributing inputs for the fast cases
+      size_t nUsed = 0;
+      size_t used[2]{};
+      for (size_t j = 0; j < nInputs; ++j)
+         if (row[j] != 0) {
+            if (nUsed < 2)
+               used[nUsed] = j;
+            ++nUsed;
+         }
+      if (nUsed == 0)
          continue;
-      for (int j = 0; j < len; ++j)
-         dests[c][j] += pSrc[j] * gains[c];   // the actual mixing process
+      const auto pDst = dests[c].data();
+      if (nUsed == 1) {
+         const auto pSrc = srcs[used[0]];
+         const auto gain = row[used[0]];
+         if (gain == 1.0f)
+            for (size_t i = 0; i < len; ++i)
+               pDst[i] += pSrc[i];
+         else
+            for (size_t i = 0; i < len; ++i)
+               pDst[i] += pSrc[i] * gain;
+      }
+      else if (nUsed == 2) {
+         const auto pSrc0 = srcs[used[0]], pSrc1 = srcs[used[1]];
+         const auto gain0 = row[used[0]], gain1 = row[used[1]];
+         for (size_t i = 0; i < len; ++i)
+            pDst[i] += pSrc0[i] * gain0 + pSrc1[i] * gain1;
+      }
+      else
+         for (size_t j = 0; j < nInputs; ++j) {
+            const auto pSrc = srcs[j];
+            const auto gain = row[j];
+            if (gain != 0)
+               for (size_t i = 0; i < len; ++i)
+                  pDst[i] += pSrc[i] * gain;
+         }
    }
 }
 
 #define stackAllocate(T, count) static_cast<T*>(alloca(count * sizeof(T)))
 
+void Mixer::AcquireAll(const size_t maxToProcess)
+{
+   auto acquire = [this, maxToProcess](size_t ii){
+      mResults[ii] = mDecoratedSources[ii].downstream.Acquire(
+         mSourceBuffers[ii], maxToProcess);
+   };
+
+   // Sources are independent:  each has its own sequence, resamplers, effect
+   // instances and buffers
+   audacity::concurrency::ThreadPool::GetDefault()
+      .ParallelFor(mDecoratedSources.size(), acquire);
+}
+
 size_t Mixer::Process(const size_t maxToProcess)
 {
    assert(maxToProcess <= BufferSize());
@@ -312,9 +376,19 @@ size_t Mixer::Process(const size_t maxToProcess)
    Clear();
    // TODO: more-than-two-channels
    auto maxChannels = std::max(2u, mFloatBuffers.Channels());
-
-   for (auto &[ upstream, downstream ] : mDecoratedSources) {
-      auto oResult = downstream.Acquire(mFloatBuffers, maxToProcess);
+   const auto matrix = stackAllocate(float, mNumChannels * maxChannels);
+   const auto srcs = stackAllocate(const float *, maxChannels);
+
+   // When serial, each source is acquired, summed and released in turn,
+   // reusing mFloatBuffers
+   if (mParallel)
+      AcquireAll(maxToProcess);
+
+   for (size_t ii = 0; ii < mDecoratedSources.size(); ++ii) {
+      auto &[ upstream, downstream ] = mDecoratedSources[ii];
+      auto &floatBuffers = mParallel ? mSourceBuffers[ii] : mFloatBuffers;
+      auto oResult = mParallel
+         ? mResults[ii] : downstream.Acquire(floatBuffers, maxToProcess);
       // One of MixVariableRates or MixSameRate assigns into mTemp[*][*] which
       // are the sources for the CopySamples calls, and they copy into
       // mBuffer[*][*]
@@ -322,12 +396,19 @@ size_t Mixer::Process(const size_t maxToProcess)
          return 0;
       auto result = *oResult;
       maxOut = std::max(maxOut, result);
+      const auto newT = upstream.NextTime();
+      if (backwards)
+         mTime = std::min(mTime, newT);
+      else
+         mTime = std::max(mTime, newT);
 
       // Insert effect stages here!  Passing them all channels of the track
 
+      // Fuse the channel map and the gains into one matrix, from the
+      // channels of the source to the output channels
       const auto limit = std::min<size_t>(upstream.Channels(), maxChannels);
       for (size_t j = 0; j < limit; ++j) {
-         const auto pFloat = (const float *)mFloatBuffers.GetReadPosition(j);
+         srcs[j] = (const float *)floatBuffers.GetReadPosition(j);
          auto &sequence = upstream.GetSequence();
          if (mApplyGain != ApplyGain::Discard) {
             for (size_t c = 0; c < mNumChannels; ++c) {
@@ -342,12 +423,14 @@ size_t Mixer::Process(const size_t maxToProcess)
          
          const auto flags =
             findChannelFlags(upstream.MixerSpec(j), sequence, j);
-         MixBuffers(mNumChannels, flags, gains, *pFloat, mTemp, result);
+         for (size_t c = 0; c < mNumChannels; ++c)
+            matrix[c * limit + j] = flags[c] ? gains[c] : 0.0f;
       }
+      MixBuffers(mNumChannels, limit, matrix, srcs, mTemp, result);
 
       downstream.Release();
-      mFloatBuffers.Advance(result);
-      mFloatBuffers.Rotate();
+      floatBuffers.Advance(result);
+      floatBuffers.Rotate();
    }
 
    if (backwards)
@@ -410,6 +493,32 @@ void Mixer::Reposition(double t, bool bSkipping)
       source.Reposition(mTime, bSkipping);
 }
 
+bool Mixer::Reusable(const Inputs &inputs) const
+{
+   if (!mStages.empty() || inputs.size() != mInputs.size())
+      return false;
+   for (size_t ii = 0; ii < inputs.size(); ++ii) {
+      const auto &pSequence = inputs[ii].pSequence;
+      const auto &old = *mInputs[ii].pSequence;
+      if (!pSequence || !inputs[ii].stages.empty() ||
+          pSequence->NChannels() != old.NChannels() ||
+          pSequence->GetRate() != old.GetRate())
+         return false;
+   }
+   return true;
+}
+
+void Mixer::Rebind(Inputs inputs)
+{
+   assert(Reusable(inputs));
+   mInputs = move(inputs);
+   // Sources correspond one-to-one with inputs when there are no stages
+   for (size_t ii = 0; ii < mInputs.size(); ++ii)
+      mSources[ii].Rebind(mInputs[ii].pSequence);
+   // Formats and envelopes of the new sequences may differ
+   std::tie(mNeedsDither, mEffectiveFormat) = NeedsDither(false, mRate);
+}
+
 void Mixer::SetTimesAndSpeed(double t0, double t1, double speed, bool bSkipping)
 {
    wxASSERT(std::isfinite(speed));
@@ -15,6 +15,7 @@
 #include "AudioGraphBuffers.h"
 #include "MixerOptions.h"
 #include "SampleFormat.h"
+#include <optional>
 
 class sampleCount;
 class BoundedEnvelope;
@@ -69,7 +70,11 @@ class MIXER_API Mixer {
          bool highQuality = true,
          //! Null or else must have a lifetime enclosing this object's
          MixerSpec *mixerSpec = nullptr,
-         ApplyGain applyGain = ApplyGain::MapChannels);
+         ApplyGain applyGain = ApplyGain::MapChannels,
+         //! Fetch, resample and apply stages to the inputs concurrently, on
+         //! the default thread pool, then sum them; for offline mixing only,
+         //! not in the audio thread
+         bool parallel = false);
 
    Mixer(const Mixer&) = delete;
    Mixer &operator=(const Mixer&) = delete;
@@ -77,6 +82,9 @@ class MIXER_API Mixer {
    virtual ~ Mixer();
 
    size_t BufferSize() const { return mBufferSize; }
+   unsigned NumChannels() const { return mNumChannels; }
+   bool IsInterleaved() const { return mInterleaved; }
+   sampleFormat Format() const { return mFormat; }
 
    //
    // Processing
@@ -100,6 +108,21 @@ class MIXER_API Mixer {
    //! Reposition processing to absolute time next time Process() is called.
    void Reposition(double t, bool bSkipping = false);
 
+   //! Whether Rebind() may take the inputs
+   /*!
+    @return whether they are as many as the mixer was made with, none with
+    stages, and each of the same number of channels and rate as the sequence
+    it would replace
+    */
+   bool Reusable(const Inputs &inputs) const;
+
+   //! Fetch from other sequences, keeping the buffers and resamplers
+   /*!
+    Follow with SetTimesAndSpeed() or Reposition()
+    @pre `Reusable(inputs)`
+    */
+   void Rebind(Inputs inputs);
+
    //! Used in scrubbing and other nonuniform playback policies.
    void SetTimesAndSpeed(
       double t0, double t1, double speed, bool bSkipping = false);
@@ -121,6 +144,10 @@ class MIXER_API Mixer {
  private:
 
    void Clear();
+   //! Acquire a block from every source, on the pool when parallel
+   /*! Leaves results in mResults; per-source exceptions propagate after all
+    sources are done */
+   void AcquireAll(size_t maxToProcess);
 
  private:
 
@@ -141,6 +168,7 @@ class MIXER_API Mixer {
    const bool       mHighQuality; // dithering
    const sampleFormat mFormat; // output format also influences dithering
    const bool       mInterleaved;
+   const double     mRate;
 
    // INPUT
    sampleFormat     mEffectiveFormat;
@@ -169,5 +197,11 @@ class MIXER_API Mixer {
 
    struct Source { MixerSource &upstream; AudioGraph::Source &downstream; };
    std::vector<Source> mDecoratedSources;
+
+   // Parallel mixing only
+   const bool mParallel;
+   //! Like mFloatBuffers, one for each decorated source
+   std::vector<AudioGraph::Buffers> mSourceBuffers;
+   std::vector<std::optional<size_t>> mResults;
 };
 #endif
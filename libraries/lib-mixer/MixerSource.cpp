@@ -35,14 +35,24 @@ initVector(size_t dim1, size_t dim2)
    return initVector<std::vector<T>>(dim1,
       [dim2](auto &row){ row.resize(dim2); });
 }
+
+//! Hoisting the pointers lets compilers vectorize the loop
+void ApplyEnvelope(float *buffer, const double *envValues, size_t len)
+{
+   for (size_t i = 0; i < len; i++)
+      buffer[i] *= envValues[i];
+}
 }
 
 void MixerSource::MakeResamplers()
 {
-   for (size_t j = 0; j < mnChannels; ++j)
-      mResample[j] = std::make_unique<Resample>(
+   for (size_t j = 0; j < mnChannels; ++j) {
+      // Reset the old instance and likely get it back
+      Resample::Recycle(move(mResample[j]));
+      mResample[j] = Resample::Acquire(
          mResampleParameters.mHighQuality,
          mResampleParameters.mMinFactor, mResampleParameters.mMaxFactor);
+   }
 }
 
 namespace {
@@ -135,13 +145,13 @@ size_t MixerSource::MixVariableRates(
                // for (size_t iChannel = 0; iChannel < nChannels; ++iChannel)
                   // memset(dst[i], 0, sizeof(float) * getLen);
             }
-            mpSeq->GetEnvelopeValues(
-               mEnvValues.data(), getLen, (pos).as_double() / sequenceRate,
-               backwards);
-            for (size_t iChannel = 0; iChannel < nChannels; ++iChannel) {
-               const auto queue = mSampleQueue[iChannel].data();
-               for (decltype(getLen) i = 0; i < getLen; i++)
-                  queue[(queueLen) + i] *= mEnvValues[i];
+            if (!mpSeq->HasTrivialEnvelope()) {
+               mpSeq->GetEnvelopeValues(
+                  mEnvValues.data(), getLen, (pos).as_double() / sequenceRate,
+                  backwards);
+               for (size_t iChannel = 0; iChannel < nChannels; ++iChannel)
+                  ApplyEnvelope(mSampleQueue[iChannel].data() + queueLen,
+                     mEnvValues.data(), getLen);
             }
 
             if (backwards)
@@ -260,12 +270,11 @@ size_t MixerSource::MixSameRate(unsigned nChannels, const size_t maxOut,
       
    }
 
-   mpSeq->GetEnvelopeValues(mEnvValues.data(), slen, t, backwards);
-
-   for (size_t iChannel = 0; iChannel < nChannels; ++iChannel) {
-      const auto pFloat = floatBuffers[iChannel];
-      for (size_t i = 0; i < slen; i++)
-         pFloat[i] *= mEnvValues[i]; // Track gain control will go here?
+   // Skip the multiplications by one
+   if (!mpSeq->HasTrivialEnvelope()) {
+      mpSeq->GetEnvelopeValues(mEnvValues.data(), slen, t, backwards);
+      for (size_t iChannel = 0; iChannel < nChannels; ++iChannel)
+         ApplyEnvelope(floatBuffers[iChannel], mEnvValues.data(), slen);
    }
 
    if (backwards)
@@ -311,7 +320,11 @@ MixerSource::MixerSource(
    MakeResamplers();
 }
 
-MixerSource::~MixerSource() = default;
+MixerSource::~MixerSource()
+{
+   for (auto &pResample : mResample)
+      Resample::Recycle(move(pResample));
+}
 
 const WideSampleSequence &MixerSource::GetSequence() const
 {
@@ -342,8 +355,6 @@ std::optional<size_t> MixerSource::Acquire(Buffers &data, size_t bound)
    assert(bound <= data.BlockSize());
    assert(data.BlockSize() <= data.Remaining());
 
-   auto &[mT0, mT1, _, mTime] = *mTimesAndSpeed;
-   const bool backwards = (mT1 < mT0);
    // TODO: more-than-two-channels
    const auto maxChannels = mMaxChannels = data.Channels();
    const auto limit = std::min<size_t>(mnChannels, maxChannels);
@@ -357,11 +368,6 @@ std::optional<size_t> MixerSource::Acquire(Buffers &data, size_t bound)
       ? MixVariableRates(limit, bound, pFloats)
       : MixSameRate(limit, bound, pFloats);
    maxTrack = std::max(maxTrack, result);
-   auto newT = mSamplePos.as_double() / rate;
-   if (backwards)
-      mTime = std::min(mTime, newT);
-   else
-      mTime = std::max(mTime, newT);
    for (size_t j = 0; j < limit; ++j) {
       mixed[j] = result;
    }
@@ -381,6 +387,11 @@ std::optional<size_t> MixerSource::Acquire(Buffers &data, size_t bound)
    return { mLastProduced };
 }
 
+double MixerSource::NextTime() const
+{
+   return mSamplePos.as_double() / GetSequence().GetRate();
+}
+
 // Does not return a strictly decreasing sequence of values such as to
 // provide proof of termination.  Just an indication of whether done or not.
 sampleCount MixerSource::Remaining() const
@@ -405,6 +416,13 @@ bool MixerSource::Terminates() const
    return false;
 }
 
+void MixerSource::Rebind(std::shared_ptr<const WideSampleSequence> seq)
+{
+   assert(seq && seq->NChannels() == mnChannels);
+   assert(seq->GetRate() == mpSeq->GetRate());
+   mpSeq = move(seq);
+}
+
 void MixerSource::Reposition(double time, bool skipping)
 {
    mSamplePos = GetSequence().TimeToLongSamples(time);
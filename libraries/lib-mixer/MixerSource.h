@@ -61,6 +61,16 @@ public:
    //! @return false
    bool Terminates() const override;
    void Reposition(double time, bool skipping);
+   //! Fetch from another sequence; follow with Reposition()
+   /*!
+    @pre `seq && seq->NChannels() == Channels()`
+    @pre `seq->GetRate()` equals the rate of the replaced sequence
+    */
+   void Rebind(std::shared_ptr<const WideSampleSequence> seq);
+   //! Time in the sequence of the next sample to fetch
+   /*! The mixer, not this, updates the shared time after each fetch, so
+    that sources may fetch concurrently */
+   double NextTime() const;
 
    bool VariableRates() const { return mResampleParameters.mVariableRates; }
 
@@ -97,7 +107,7 @@ private:
     */
    void ZeroFill(size_t produced, size_t max, float &floatBuffer);
 
-   const std::shared_ptr<const WideSampleSequence> mpSeq;
+   std::shared_ptr<const WideSampleSequence> mpSeq;
    size_t i;
 
    const size_t mnChannels;
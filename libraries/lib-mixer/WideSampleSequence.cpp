@@ -12,6 +12,21 @@ Paul Licameli split from SampleFrame.cpp
 
 WideSampleSequence::~WideSampleSequence() = default;
 
+void WideSampleSequence::Prefetch(double, double) const noexcept
+{
+}
+
+bool WideSampleSequence::IsResident(double, double) const noexcept
+{
+   return false;
+}
+
+std::shared_ptr<const void>
+WideSampleSequence::PinResident(double, double) const
+{
+   return nullptr;
+}
+
 sampleCount WideSampleSequence::TimeToLongSamples(double t0) const
 {
    return sampleCount(floor(t0 * GetRate() + 0.5));
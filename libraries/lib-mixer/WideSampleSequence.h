@@ -14,6 +14,8 @@ Paul Licameli split from SampleFrame.h
 #include "SampleCount.h"
 #include "SampleFormat.h"
 
+#include <memory>
+
 class WideSampleSequence;
 
 //! An interface for random-access fetches from a collection of streams of
@@ -126,6 +128,32 @@ public:
     */
    virtual void GetEnvelopeValues(
       double* buffer, size_t bufferLen, double t0, bool backwards) const = 0;
+
+   //! Hint that samples between the given times will soon be fetched
+   /*!
+    The override may make them resident in memory.  It may be called on a
+    worker thread, concurrently with fetches.  Default does nothing.
+    @pre `t0 <= t1`
+    */
+   virtual void Prefetch(double t0, double t1) const noexcept;
+
+   //! Whether fetching samples between the given times needs no access to
+   //! storage
+   /*!
+    May be called on any thread.  Default returns false.
+    @pre `t0 <= t1`
+    */
+   virtual bool IsResident(double t0, double t1) const noexcept;
+
+   //! Keep resident the samples between the given times, until the result is
+   //! destroyed, so that evictions from caches can't make fetches of them
+   //! access storage
+   /*!
+    May be called on any thread.  Default returns null.
+    @pre `t0 <= t1`
+    @return null if not all of them are resident now
+    */
+   virtual std::shared_ptr<const void> PinResident(double t0, double t1) const;
 };
 
 #endif
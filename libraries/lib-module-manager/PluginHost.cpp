@@ -24,6 +24,7 @@
 #include "IPCClient.h"
 #include "PlatformCompatibility.h"
 #include "PluginManager.h"
+#include "RealtimeSandbox.h"
 
 namespace
 {
@@ -72,6 +73,24 @@ namespace
          result.SetError("unknown error");
       }
    }
+
+   bool StartHostProcess(const char* argument, int connectPort)
+   {
+      const auto cmd = wxString::Format("\"%s\" %s %d",
+         PlatformCompatibility::GetExecutablePath(),
+         argument,
+         connectPort);
+
+      auto process = std::make_unique<wxProcess>();
+      process->Detach();
+      if(wxExecute(cmd, wxEXEC_ASYNC, process.get()) != 0)
+      {
+         //process will delete itself upon termination
+         process.release();
+         return true;
+      }
+      return false;
+   }
 }
 
 PluginHost::PluginHost(int connectPort)
@@ -183,26 +202,25 @@ void PluginHost::Stop() noexcept
 
 bool PluginHost::Start(int connectPort)
 {
-   const auto cmd = wxString::Format("\"%s\" %s %d",
-      PlatformCompatibility::GetExecutablePath(),
-      PluginHost::HostArgument,
-      connectPort);
-
-   auto process = std::make_unique<wxProcess>();
-   process->Detach();
-   if(wxExecute(cmd, wxEXEC_ASYNC, process.get()) != 0)
-   {
-      //process will delete itself upon termination
-      process.release();
-      return true;
-   }
-   return false;
+   return StartHostProcess(HostArgument, connectPort);
+}
+
+bool PluginHost::StartRealtimeHost(int connectPort)
+{
+   return StartHostProcess(RealtimeHostArgument, connectPort);
 }
 
 bool PluginHost::IsHostProcess()
 {
    return CommandLineArgs::argc >= 3 &&
-      wxStrcmp(CommandLineArgs::argv[1], HostArgument) == 0;
+      (wxStrcmp(CommandLineArgs::argv[1], HostArgument) == 0 ||
+       wxStrcmp(CommandLineArgs::argv[1], RealtimeHostArgument) == 0);
+}
+
+bool PluginHost::IsRealtimeHostProcess()
+{
+   return CommandLineArgs::argc >= 3 &&
+      wxStrcmp(CommandLineArgs::argv[1], RealtimeHostArgument) == 0;
 }
 
 class PluginHostModule final :
@@ -223,6 +241,12 @@ public:
          //redirect to log file later
          wxLog::EnableLogging(false);
 
+         if(PluginHost::IsRealtimeHostProcess())
+         {
+            RealtimeSandbox::Serve(connectPort);
+            return false;
+         }
+
          //Handle requests...
          PluginHost host(connectPort);
          while(host.Serve()) { }
@@ -35,6 +35,7 @@
 class MODULE_MANAGER_API PluginHost final : public IPCChannelStatusCallback
 {
    static constexpr auto HostArgument =  "--host";
+   static constexpr auto RealtimeHostArgument =  "--realtime-host";
 
    std::unique_ptr<IPCClient> mClient;
    IPCChannel* mChannel{nullptr};
@@ -55,8 +56,18 @@ public:
     */
    static bool Start(int connectPort);
 
-   ///Returns true if current process is considered to be a plugin host process
+   /**
+    * \brief Attempts to start a host application that processes
+    * realtime effects (see RealtimeSandbox)
+    * \return true if host has started successfully
+    */
+   static bool StartRealtimeHost(int connectPort);
+
+   ///Returns true if current process is considered to be a plugin host process,
+   ///of either kind
    static bool IsHostProcess();
+   ///Returns true if current process hosts sandboxed realtime effects
+   static bool IsRealtimeHostProcess();
 
    explicit PluginHost(int connectPort);
 
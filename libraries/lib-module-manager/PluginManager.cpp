@@ -24,6 +24,7 @@ for shared and private configs - which need to move out.
 
 
 #include <algorithm>
+#include <functional>
 
 #include <wx/log.h>
 #include <wx/tokenzr.h>
@@ -36,6 +37,7 @@ for shared and private configs - which need to move out.
 #include "MemoryX.h"
 #include "ModuleManager.h"
 #include "PlatformCompatibility.h"
+#include "PluginRegistryCache.h"
 #include "Base64.h"
 #include "Variant.h"
 
@@ -537,8 +539,61 @@ bool PluginManager::DropFile(const wxString &fileName)
    return false;
 }
 
+namespace {
+//! Gives the test of plugin paths read from the registry
+std::function<bool(const wxString&)> MakePathFilter()
+{
+#ifdef __WXMAC__
+   // Bug 1590: On Mac, we should purge the registry of Nyquist plug-ins
+   // bundled with other versions of Audacity, assuming both versions
+   // were properly installed in /Applications (or whatever it is called in
+   // your locale)
+
+   const auto fullExePath = PlatformCompatibility::GetExecutablePath();
+
+   // Strip rightmost path components up to *.app
+   wxFileName exeFn{ fullExePath };
+   exeFn.SetEmptyExt();
+   exeFn.SetName(wxString{});
+   while(exeFn.GetDirCount() && !exeFn.GetDirs().back().EndsWith(".app"))
+      exeFn.RemoveLastDir();
+
+   const auto goodPath = exeFn.GetPath();
+
+   if(exeFn.GetDirCount())
+      exeFn.RemoveLastDir();
+   const auto possiblyBadPath = exeFn.GetPath();
+
+   return [=](const wxString &path) {
+      if (!path.StartsWith(possiblyBadPath))
+         // Assume it's not under /Applications
+         return true;
+      if (path.StartsWith(goodPath))
+         // It's bundled with this executable
+         return true;
+      return false;
+   };
+#else
+   return [](const wxString&){ return true; };
+#endif
+}
+
+//! The order of loading, so that providers are registered before the rest
+constexpr PluginType LoadedTypes[] = {
+   PluginTypeModule,
+   PluginTypeEffect,
+   PluginTypeAudacityCommand,
+   PluginTypeExporter,
+   PluginTypeImporter,
+   PluginTypeStub,
+};
+}
+
 void PluginManager::Load()
 {
+   if (LoadCache())
+      return;
+
    // Create/Open the registry
    auto pRegistry = sFactory(FileNames::PluginRegistry());
    auto &registry = *pRegistry;
@@ -602,54 +657,38 @@ void PluginManager::Load()
       registry.Flush();
    }
 
-   // Load all provider plugins first
-   LoadGroup(&registry, PluginTypeModule);
-
-   // Now the rest
-   LoadGroup(&registry, PluginTypeEffect);
-   LoadGroup(&registry, PluginTypeAudacityCommand );
-   LoadGroup(&registry, PluginTypeExporter);
-   LoadGroup(&registry, PluginTypeImporter);
-
-   LoadGroup(&registry, PluginTypeStub);
+   // Load all provider plugins first, then the rest
+   for (auto type : LoadedTypes)
+      LoadGroup(&registry, type);
    return;
 }
 
-void PluginManager::LoadGroup(audacity::BasicSettings *pRegistry, PluginType type)
+bool PluginManager::LoadCache()
 {
-#ifdef __WXMAC__
-   // Bug 1590: On Mac, we should purge the registry of Nyquist plug-ins
-   // bundled with other versions of Audacity, assuming both versions
-   // were properly installed in /Applications (or whatever it is called in
-   // your locale)
-
-   const auto fullExePath = PlatformCompatibility::GetExecutablePath();
-
-   // Strip rightmost path components up to *.app
-   wxFileName exeFn{ fullExePath };
-   exeFn.SetEmptyExt();
-   exeFn.SetName(wxString{});
-   while(exeFn.GetDirCount() && !exeFn.GetDirs().back().EndsWith(".app"))
-      exeFn.RemoveLastDir();
-
-   const auto goodPath = exeFn.GetPath();
+   std::vector<PluginDescriptor> plugins;
+   PluginRegistryVersion regver;
+   if (!PluginRegistryCache::Read(FileNames::PluginRegistry(), regver, plugins)
+       // Conversions are done only when reading the text
+       || regver != REGVERCUR)
+      return false;
 
-   if(exeFn.GetDirCount())
-      exeFn.RemoveLastDir();
-   const auto possiblyBadPath = exeFn.GetPath();
+   // Same filtering as in LoadGroup
+   const auto AcceptPath = MakePathFilter();
+   for (auto &plug : plugins)
+   {
+      if (mRegisteredPlugins.count(plug.GetID()) ||
+          !AcceptPath(plug.GetPath()))
+         continue;
+      auto id = plug.GetID();
+      mRegisteredPlugins[id] = std::move(plug);
+   }
+   mRegver = regver;
+   return true;
+}
 
-   auto AcceptPath = [&](const wxString &path) {
-      if (!path.StartsWith(possiblyBadPath))
-         // Assume it's not under /Applications
-         return true;
-      if (path.StartsWith(goodPath))
-         // It's bundled with this executable
-         return true;
-      return false;
-   };
-#else
-   auto AcceptPath = [](const wxString&){ return true; };
-#endif
+void PluginManager::LoadGroup(audacity::BasicSettings *pRegistry, PluginType type)
+{
+   const auto AcceptPath = MakePathFilter();
 
    wxString strVal;
    bool boolVal;
@@ -895,6 +934,16 @@ void PluginManager::Save()
    registry.Flush();
 
    mRegver = REGVERCUR;
+
+   // Copy to the cache, now that the text file is complete, and in the same
+   // order as Load() reads the groups
+   std::vector<const PluginDescriptor*> plugins;
+   plugins.reserve(mRegisteredPlugins.size());
+   for (auto type : LoadedTypes)
+      for (auto &pair : mRegisteredPlugins)
+         if (pair.second.GetPluginType() == type)
+            plugins.push_back(&pair.second);
+   PluginRegistryCache::Write(FileNames::PluginRegistry(), mRegver, plugins);
 }
 
 void PluginManager::NotifyPluginsChanged()
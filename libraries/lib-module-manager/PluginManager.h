@@ -197,6 +197,8 @@ private:
 
    void InitializePlugins();
 
+   //! @return whether the binary cache was current, so the text was not read
+   bool LoadCache();
    void LoadGroup(audacity::BasicSettings* pRegistry, PluginType type);
    void SaveGroup(audacity::BasicSettings* pRegistry, PluginType type);
 
@@ -249,6 +251,6 @@ private:
 #define NYQUIST_PROMPT_NAME XO("Nyquist Prompt")
 
 // Latest version of the plugin registry config
-constexpr auto REGVERCUR = "1.3";
+constexpr auto REGVERCUR = "1.4";
 
 #endif /* __AUDACITY_PLUGINMANAGER_H__ */
@@ -0,0 +1,288 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file PluginRegistryCache.cpp
+
+  Part of lib-module-manager library
+
+**********************************************************************/
+
+#include "PluginRegistryCache.h"
+
+#include <cstdint>
+#include <cstring>
+
+#include <wx/file.h>
+#include <wx/filefn.h>
+#include <wx/filename.h>
+
+namespace
+{
+//! Begins the file, and changes when the layout of records changes
+constexpr uint32_t CacheMagic = 0x43525041; // "APRC"
+constexpr uint32_t CacheFormat = 1;
+
+FilePath CachePath(const FilePath &registryPath)
+{
+   wxFileName fn{ registryPath };
+   fn.SetExt(wxT("cache"));
+   return fn.GetFullPath();
+}
+
+//! Identifies the contents of the registry file, without reading it
+struct Stamp
+{
+   int64_t modified{};
+   uint64_t size{};
+
+   bool operator ==(const Stamp &other) const
+   {
+      return modified == other.modified && size == other.size;
+   }
+};
+
+bool GetStamp(const FilePath &path, Stamp &stamp)
+{
+   wxFileName fn{ path };
+   if (!fn.FileExists())
+      return false;
+   const auto modified = fn.GetModificationTime();
+   const auto size = fn.GetSize();
+   if (!modified.IsValid() || size == wxInvalidSize)
+      return false;
+   stamp = { modified.GetValue().GetValue(), size.GetValue() };
+   return true;
+}
+
+class Writer
+{
+public:
+   template<typename T> void Put(T value)
+   {
+      const auto pos = mBytes.size();
+      mBytes.resize(pos + sizeof(T));
+      memcpy(mBytes.data() + pos, &value, sizeof(T));
+   }
+
+   void Put(const wxString &str)
+   {
+      const auto utf8 = str.utf8_str();
+      const auto length = static_cast<uint32_t>(utf8.length());
+      Put(length);
+      mBytes.insert(mBytes.end(), utf8.data(), utf8.data() + length);
+   }
+
+   const std::vector<char> &GetBytes() const { return mBytes; }
+
+private:
+   std::vector<char> mBytes;
+};
+
+//! Reads what Writer wrote; fails, rather than reads out of bounds, if the
+//! file is truncated
+class Reader
+{
+public:
+   Reader(const char *begin, const char *end) : mPos{ begin }, mEnd{ end } {}
+
+   template<typename T> bool Get(T &value)
+   {
+      if (mEnd - mPos < static_cast<ptrdiff_t>(sizeof(T)))
+         return false;
+      memcpy(&value, mPos, sizeof(T));
+      mPos += sizeof(T);
+      return true;
+   }
+
+   bool Get(wxString &str)
+   {
+      uint32_t length;
+      if (!Get(length) || mEnd - mPos < static_cast<ptrdiff_t>(length))
+         return false;
+      str = wxString::FromUTF8(mPos, length);
+      mPos += length;
+      return true;
+   }
+
+   bool Get(bool &value)
+   {
+      uint8_t byte;
+      if (!Get(byte))
+         return false;
+      value = byte != 0;
+      return true;
+   }
+
+private:
+   const char *mPos;
+   const char *const mEnd;
+};
+
+void WriteDescriptor(Writer &writer, const PluginDescriptor &plug)
+{
+   const auto type = plug.GetPluginType();
+   writer.Put(static_cast<uint32_t>(type));
+   writer.Put(plug.GetID());
+   writer.Put(plug.GetProviderID());
+   writer.Put(plug.GetPath());
+   writer.Put(plug.GetSymbol().Internal());
+   writer.Put(plug.GetUntranslatedVersion());
+   writer.Put(plug.GetVendor());
+   writer.Put(static_cast<uint8_t>(plug.IsEnabled()));
+   writer.Put(static_cast<uint8_t>(plug.IsValid()));
+
+   if (type == PluginTypeEffect)
+   {
+      writer.Put(static_cast<uint32_t>(plug.GetEffectType()));
+      writer.Put(plug.GetEffectFamily());
+      writer.Put(static_cast<uint8_t>(plug.IsEffectDefault()));
+      writer.Put(static_cast<uint8_t>(plug.IsEffectInteractive()));
+      writer.Put(plug.SerializeRealtimeSupport());
+      writer.Put(static_cast<uint8_t>(plug.IsEffectAutomatable()));
+   }
+   else if (type == PluginTypeImporter)
+   {
+      writer.Put(plug.GetImporterIdentifier());
+      const auto &extensions = plug.GetImporterExtensions();
+      writer.Put(static_cast<uint32_t>(extensions.size()));
+      for (const auto &extension : extensions)
+         writer.Put(extension);
+   }
+}
+
+bool ReadDescriptor(Reader &reader, PluginDescriptor &plug)
+{
+   uint32_t type;
+   wxString id, providerID, path, symbol, version, vendor;
+   bool enabled, valid;
+   if (!(reader.Get(type) && reader.Get(id) && reader.Get(providerID) &&
+         reader.Get(path) && reader.Get(symbol) && reader.Get(version) &&
+         reader.Get(vendor) && reader.Get(enabled) && reader.Get(valid)))
+      return false;
+
+   plug.SetPluginType(static_cast<PluginType>(type));
+   plug.SetID(id);
+   plug.SetProviderID(providerID);
+   plug.SetPath(path);
+   plug.SetSymbol(symbol);
+   plug.SetVersion(version);
+   plug.SetVendor(vendor);
+   plug.SetEnabled(enabled);
+   plug.SetValid(valid);
+
+   if (type == PluginTypeEffect)
+   {
+      uint32_t effectType;
+      wxString family, realtime;
+      bool isDefault, interactive, automatable;
+      if (!(reader.Get(effectType) && reader.Get(family) &&
+            reader.Get(isDefault) && reader.Get(interactive) &&
+            reader.Get(realtime) && reader.Get(automatable)))
+         return false;
+      plug.SetEffectType(static_cast<EffectType>(effectType));
+      plug.SetEffectFamily(family);
+      plug.SetEffectDefault(isDefault);
+      plug.SetEffectInteractive(interactive);
+      plug.DeserializeRealtimeSupport(realtime);
+      plug.SetEffectAutomatable(automatable);
+   }
+   else if (type == PluginTypeImporter)
+   {
+      wxString identifier;
+      uint32_t count;
+      if (!(reader.Get(identifier) && reader.Get(count)))
+         return false;
+      FileExtensions extensions;
+      for (uint32_t ii = 0; ii < count; ++ii)
+      {
+         wxString extension;
+         if (!reader.Get(extension))
+            return false;
+         extensions.push_back(extension);
+      }
+      plug.SetImporterIdentifier(identifier);
+      plug.SetImporterExtensions(std::move(extensions));
+   }
+   return true;
+}
+}
+
+bool PluginRegistryCache::Read(const FilePath &registryPath,
+   PluginRegistryVersion &version, std::vector<PluginDescriptor> &plugins)
+{
+   Stamp stamp;
+   if (!GetStamp(registryPath, stamp))
+      return false;
+
+   // The whole file in one read; it is small compared with the text
+   wxFile file;
+   const auto cachePath = CachePath(registryPath);
+   if (!wxFileExists(cachePath) || !file.Open(cachePath))
+      return false;
+   const auto length = file.Length();
+   if (length <= 0)
+      return false;
+   std::vector<char> bytes(length);
+   if (file.Read(bytes.data(), bytes.size()) != length)
+      return false;
+
+   Reader reader{ bytes.data(), bytes.data() + bytes.size() };
+   uint32_t magic, format, count;
+   Stamp cached;
+   if (!(reader.Get(magic) && magic == CacheMagic &&
+         reader.Get(format) && format == CacheFormat &&
+         reader.Get(cached.modified) && reader.Get(cached.size) &&
+         cached == stamp &&
+         reader.Get(version) && reader.Get(count)))
+      return false;
+
+   std::vector<PluginDescriptor> result(count);
+   for (auto &plug : result)
+      if (!ReadDescriptor(reader, plug))
+         return false;
+   plugins = std::move(result);
+   return true;
+}
+
+void PluginRegistryCache::Write(const FilePath &registryPath,
+   const PluginRegistryVersion &version,
+   const std::vector<const PluginDescriptor*> &plugins)
+{
+   const auto cachePath = CachePath(registryPath);
+   Stamp stamp;
+   if (!GetStamp(registryPath, stamp))
+   {
+      if (wxFileExists(cachePath))
+         wxRemoveFile(cachePath);
+      return;
+   }
+
+   Writer writer;
+   writer.Put(CacheMagic);
+   writer.Put(CacheFormat);
+   writer.Put(stamp.modified);
+   writer.Put(stamp.size);
+   writer.Put(version);
+   writer.Put(static_cast<uint32_t>(plugins.size()));
+   for (auto pPlug : plugins)
+      WriteDescriptor(writer, *pPlug);
+
+   // Replace the old cache only when the new one is complete
+   const auto tempPath = cachePath + wxT(".tmp");
+   const auto &bytes = writer.GetBytes();
+   bool written = false;
+   {
+      wxFile file;
+      written = file.Create(tempPath, true) &&
+         file.Write(bytes.data(), bytes.size()) == bytes.size();
+   }
+   if (!written || !wxRenameFile(tempPath, cachePath, true))
+   {
+      // Don't leave a stale cache
+      if (wxFileExists(tempPath))
+         wxRemoveFile(tempPath);
+      if (wxFileExists(cachePath))
+         wxRemoveFile(cachePath);
+   }
+}
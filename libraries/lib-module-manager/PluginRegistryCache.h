@@ -0,0 +1,36 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file PluginRegistryCache.h
+  @brief Binary copy of the plugin registry
+
+  Part of lib-module-manager library
+
+**********************************************************************/
+
+#pragma once
+
+#include <vector>
+
+#include "PluginDescriptor.h"
+
+//! A binary copy of the text registry of plugins, which is much faster to
+//! read at startup than parsing the text
+/*!
+ The copy is stamped with the time and size of the text file as it was just
+ after PluginManager::Save() wrote it.  If anything else rewrites the text,
+ such as another version of Audacity, the copy is ignored.
+ */
+namespace PluginRegistryCache
+{
+//! Read the descriptors of the cache for the registry file, in saved order
+/*! @return false if there is no cache, or it does not match the file */
+bool Read(const FilePath &registryPath,
+   PluginRegistryVersion &version, std::vector<PluginDescriptor> &plugins);
+
+//! Replace the cache for the registry file, which must be written already
+/*! Failure is not an error; the registry is then read as text next time */
+void Write(const FilePath &registryPath, const PluginRegistryVersion &version,
+   const std::vector<const PluginDescriptor*> &plugins);
+}
@@ -0,0 +1,905 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file RealtimeSandbox.cpp
+
+  Part of lib-module-manager library
+
+**********************************************************************/
+
+#include "RealtimeSandbox.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include <wx/utils.h>
+
+#include "EffectAutomationParameters.h"
+#include "EffectInterface.h"
+#include "FileNames.h"
+#include "IPCChannel.h"
+#include "IPCClient.h"
+#include "IPCServer.h"
+#include "IPCSharedMemory.h"
+#include "IPCSharedRing.h"
+#include "ModuleManager.h"
+#include "PluginHost.h"
+#include "PluginIPCUtils.h"
+#include "PluginManager.h"
+#include "PluginProvider.h"
+#include "Prefs.h"
+
+BoolSetting RealtimeSandbox::Enabled {
+   L"/Effects/RealtimeSandbox", false
+};
+
+namespace
+{
+   using namespace std::chrono;
+
+   //Fields of control messages are separated by newlines; the last field
+   //(settings) takes the rest of the message
+   constexpr auto FieldSeparator = '\n';
+
+   constexpr auto RequestInit = "init";
+   constexpr auto RequestAddProcessor = "add";
+   constexpr auto RequestSettings = "settings";
+   constexpr auto RequestSuspend = "suspend";
+   constexpr auto RequestResume = "resume";
+   constexpr auto RequestFinalize = "finalize";
+
+   constexpr auto ReplyOk = "ok";
+   constexpr auto ReplyError = "error";
+
+   //Greatest number of channels in a block
+   constexpr unsigned MaxChannels = 32;
+   //How many blocks fit in a queue at once
+   constexpr size_t BlocksInFlight = 4;
+
+   //How long to wait for the host to start, or to answer a request
+   constexpr auto RequestTimeout = seconds(10);
+   //How often settings are sent to the host, at most
+   constexpr auto SettingsInterval = milliseconds(50);
+   //Fraction of the block duration the audio thread waits for the host
+   constexpr auto DeadlineFraction = 0.5;
+
+   enum class BlockKind : uint32_t
+   {
+      ProcessStart,
+      Process,
+      ProcessEnd,
+   };
+
+   struct BlockHeader
+   {
+      uint64_t sequence;
+      BlockKind kind;
+      uint32_t group;
+      uint32_t channels;
+      uint32_t frames;
+   };
+
+   size_t RingCapacity(size_t blockSize)
+   {
+      const auto blockBytes =
+         sizeof(BlockHeader) + MaxChannels * blockSize * sizeof(float);
+      //Keep the second ring aligned like the first
+      return (BlocksInFlight * blockBytes + 63) & ~size_t(63);
+   }
+
+   size_t SharedMemorySize(size_t blockSize)
+   {
+      return 2 * IPCSharedRing::RequiredSize(RingCapacity(blockSize));
+   }
+
+   //Queue of blocks to the host, and queue of results from the host
+   std::pair<IPCSharedRing, IPCSharedRing>
+   AttachRings(IPCSharedMemory& memory, size_t blockSize)
+   {
+      auto data = static_cast<char*>(memory.GetData());
+      const auto ringSize = IPCSharedRing::RequiredSize(RingCapacity(blockSize));
+      return { IPCSharedRing { data }, IPCSharedRing { data + ringSize } };
+   }
+
+   wxString MakeMessage(std::initializer_list<wxString> fields)
+   {
+      wxString result;
+      for(auto& field : fields)
+      {
+         if(!result.empty())
+            result += FieldSeparator;
+         result += field;
+      }
+      return result;
+   }
+
+   //Splits at most count - 1 times, to leave the last field whole
+   std::vector<wxString> SplitMessage(const wxString& message, size_t count)
+   {
+      std::vector<wxString> result;
+      auto rest = message;
+      while(result.size() + 1 < count && rest.Find(FieldSeparator) != wxNOT_FOUND)
+      {
+         result.push_back(rest.BeforeFirst(FieldSeparator));
+         rest = rest.AfterFirst(FieldSeparator);
+      }
+      result.push_back(rest);
+      return result;
+   }
+
+   wxString SerializeSettings(
+      const EffectInstanceFactory& effect, const EffectSettings& settings)
+   {
+      CommandParameters parms;
+      wxString result;
+      if(effect.SaveSettings(settings, parms))
+         parms.GetParameters(result);
+      return result;
+   }
+
+   std::string MakeSharedMemoryName()
+   {
+      static std::atomic<unsigned> counter { 0 };
+      return wxString::Format("audacity-rt-%lu-%u",
+         wxGetProcessId(), counter++).ToStdString();
+   }
+
+   ///Main process side
+   class SandboxedInstance final
+      : public EffectInstanceWithBlockSize
+      , public IPCChannelStatusCallback
+   {
+   public:
+      SandboxedInstance(const EffectInstanceFactory& effect,
+         wxString providerId, wxString path)
+         : mEffect { effect }
+         , mProviderId { std::move(providerId) }
+         , mPath { std::move(path) }
+      {
+      }
+
+      ~SandboxedInstance() override
+      {
+         Shutdown();
+      }
+
+      unsigned GetAudioInCount() const override { return mAudioIns; }
+      unsigned GetAudioOutCount() const override { return mAudioOuts; }
+
+      SampleCount GetLatency(const EffectSettings&, double) const override
+      {
+         return mLatency.load(std::memory_order_relaxed);
+      }
+
+      bool RealtimeInitialize(EffectSettings& settings, double sampleRate) override;
+      bool RealtimeAddProcessor(EffectSettings& settings,
+         EffectOutputs* pOutputs, unsigned numChannels, float sampleRate) override;
+      bool RealtimeSuspend() override;
+      bool RealtimeResume() override;
+      bool RealtimeProcessStart(MessagePackage& package) override;
+      size_t RealtimeProcess(size_t group, EffectSettings& settings,
+         const float* const* inBuf, float* const* outBuf, size_t numSamples)
+         override;
+      bool RealtimeProcessEnd(EffectSettings& settings) noexcept override;
+      bool RealtimeFinalize(EffectSettings& settings) noexcept override;
+
+      //Destructive processing stays in process
+      bool ProcessInitialize(EffectSettings&, double, ChannelNames) override
+      {
+         return false;
+      }
+      bool ProcessFinalize() noexcept override { return true; }
+      size_t ProcessBlock(EffectSettings&,
+         const float* const*, float* const*, size_t) override
+      {
+         return 0;
+      }
+
+      void OnConnect(IPCChannel& channel) noexcept override;
+      void OnDisconnect() noexcept override;
+      void OnConnectionError() noexcept override;
+      void OnDataAvailable(const void* data, size_t size) noexcept override;
+
+   private:
+      //Sends a request and waits for the reply, on the main thread
+      std::optional<wxString> Request(const wxString& request);
+      bool Send(const wxString& message) noexcept;
+      void Bypass(const float* const* inBuf, float* const* outBuf,
+         size_t numSamples) const noexcept;
+      void SendSettingsRoutine();
+      void Shutdown() noexcept;
+
+      const EffectInstanceFactory& mEffect;
+      const wxString mProviderId;
+      const wxString mPath;
+
+      unsigned mAudioIns { 0 };
+      unsigned mAudioOuts { 0 };
+      double mSampleRate { 0 };
+      std::atomic<SampleCount> mLatency { 0 };
+
+      std::unique_ptr<IPCServer> mServer;
+      std::unique_ptr<IPCSharedMemory> mMemory;
+      IPCSharedRing mToHost;
+      IPCSharedRing mFromHost;
+
+      //Guards the channel, the replies, and sending
+      std::mutex mSync;
+      std::condition_variable mReplyCondition;
+      IPCChannel* mChannel { nullptr };
+      detail::InputMessageReader mMessageReader;
+      std::deque<wxString> mReplies;
+      //Host has gone away, blocks pass through
+      std::atomic<bool> mLost { false };
+
+      //Written on the audio thread
+      uint64_t mSequence { 0 };
+      std::vector<IPCSharedRing::Part> mParts;
+      steady_clock::time_point mLastSettingsCopy {};
+      std::atomic<unsigned> mMissedDeadlines { 0 };
+
+      std::mutex mSettingsSync;
+      std::condition_variable mSettingsCondition;
+      std::optional<EffectSettings> mPendingSettings;
+      wxString mLastSentSettings;
+      bool mStopSettings { false };
+      std::thread mSettingsThread;
+   };
+
+   bool SandboxedInstance::RealtimeInitialize(
+      EffectSettings& settings, double sampleRate)
+   {
+      try
+      {
+         //The instance may be initialized again after finalization
+         mLost.store(false);
+         mSequence = 0;
+         mReplies.clear();
+
+         //Allow for the block size asked for, before this is called
+         if(mBlockSize == 0)
+            mBlockSize = 512;
+         const auto name = MakeSharedMemoryName();
+         const auto memorySize = SharedMemorySize(mBlockSize);
+         mMemory = IPCSharedMemory::Create(name, memorySize);
+         if(!mMemory)
+            return false;
+         auto data = static_cast<char*>(mMemory->GetData());
+         const auto capacity = RingCapacity(mBlockSize);
+         IPCSharedRing::Initialize(data, capacity);
+         IPCSharedRing::Initialize(
+            data + IPCSharedRing::RequiredSize(capacity), capacity);
+         std::tie(mToHost, mFromHost) = AttachRings(*mMemory, mBlockSize);
+
+         auto server = std::make_unique<IPCServer>(*this);
+         if(!PluginHost::StartRealtimeHost(server->GetConnectPort()))
+            return false;
+         mServer = std::move(server);
+
+         mSampleRate = sampleRate;
+         mLastSentSettings = SerializeSettings(mEffect, settings);
+         const auto reply = Request(MakeMessage({
+            RequestInit,
+            wxString::FromUTF8(name),
+            wxString::Format("%zu", mBlockSize),
+            wxString::FromCDouble(sampleRate),
+            mProviderId,
+            mPath,
+            mLastSentSettings
+         }));
+         if(!reply)
+            return false;
+         //ok, ins, outs, block size
+         const auto fields = SplitMessage(*reply, 4);
+         unsigned long ins, outs, blockSize;
+         if(fields.size() != 4 || fields[0] != ReplyOk ||
+            !fields[1].ToULong(&ins) || !fields[2].ToULong(&outs) ||
+            !fields[3].ToULong(&blockSize) ||
+            ins > MaxChannels || outs > MaxChannels)
+            return false;
+         mAudioIns = ins;
+         mAudioOuts = outs;
+         //Don't allocate on the audio thread
+         mParts.reserve(1 + MaxChannels);
+
+         mSettingsThread = std::thread { [this]{ SendSettingsRoutine(); } };
+         return true;
+      }
+      catch(...)
+      {
+         return false;
+      }
+   }
+
+   bool SandboxedInstance::RealtimeAddProcessor(
+      EffectSettings&, EffectOutputs*, unsigned numChannels, float sampleRate)
+   {
+      try
+      {
+         const auto reply = Request(MakeMessage({
+            RequestAddProcessor,
+            wxString::Format("%u", numChannels),
+            wxString::FromCDouble(sampleRate)
+         }));
+         if(!reply)
+            return false;
+         //ok, latency
+         const auto fields = SplitMessage(*reply, 2);
+         unsigned long long latency;
+         if(fields.size() != 2 || fields[0] != ReplyOk ||
+            !fields[1].ToULongLong(&latency))
+            return false;
+         mLatency.store(latency, std::memory_order_relaxed);
+         return true;
+      }
+      catch(...)
+      {
+         return false;
+      }
+   }
+
+   bool SandboxedInstance::RealtimeSuspend()
+   {
+      return Send(RequestSuspend);
+   }
+
+   bool SandboxedInstance::RealtimeResume()
+   {
+      return Send(RequestResume);
+   }
+
+   bool SandboxedInstance::RealtimeProcessStart(MessagePackage& package)
+   {
+      if(mLost.load(std::memory_order_relaxed))
+         return true;
+
+      //Hand a copy of the settings to the sending thread, now and then; it
+      //sends them only if they changed
+      const auto now = steady_clock::now();
+      if(now - mLastSettingsCopy >= SettingsInterval)
+      {
+         std::unique_lock lck(mSettingsSync, std::try_to_lock);
+         if(lck.owns_lock())
+         {
+            mPendingSettings = package.settings;
+            mLastSettingsCopy = now;
+            lck.unlock();
+            mSettingsCondition.notify_one();
+         }
+      }
+
+      const BlockHeader header { ++mSequence, BlockKind::ProcessStart };
+      mToHost.Write(&header, sizeof(header));
+      return true;
+   }
+
+   size_t SandboxedInstance::RealtimeProcess(size_t group, EffectSettings&,
+      const float* const* inBuf, float* const* outBuf, size_t numSamples)
+   {
+      if(mLost.load(std::memory_order_relaxed) || numSamples > mBlockSize)
+      {
+         Bypass(inBuf, outBuf, numSamples);
+         return numSamples;
+      }
+
+      const auto sequence = ++mSequence;
+      const BlockHeader header {
+         sequence, BlockKind::Process, static_cast<uint32_t>(group),
+         mAudioIns, static_cast<uint32_t>(numSamples)
+      };
+      mParts.clear();
+      mParts.push_back({ &header, sizeof(header) });
+      for(unsigned i = 0; i < mAudioIns; ++i)
+         mParts.push_back({ inBuf[i], numSamples * sizeof(float) });
+      if(!mToHost.Write(mParts.data(), mParts.size()))
+      {
+         //Host is behind
+         ++mMissedDeadlines;
+         Bypass(inBuf, outBuf, numSamples);
+         return numSamples;
+      }
+
+      const auto deadline = steady_clock::now() + duration_cast<
+         steady_clock::duration>(duration<double> {
+            DeadlineFraction * numSamples / mSampleRate });
+      while(true)
+      {
+         BlockHeader result;
+         if(mFromHost.Read(&result, sizeof(result)))
+         {
+            const auto bytes = result.frames * sizeof(float);
+            if(result.sequence != sequence || result.channels > mAudioOuts ||
+               result.frames != numSamples)
+            {
+               //Result of a block that was given up on
+               mFromHost.Skip(result.channels * bytes);
+               continue;
+            }
+            for(unsigned i = 0; i < result.channels; ++i)
+               mFromHost.Read(outBuf[i], bytes);
+            return numSamples;
+         }
+         if(mLost.load(std::memory_order_relaxed) ||
+            steady_clock::now() >= deadline)
+            break;
+         std::this_thread::yield();
+      }
+      ++mMissedDeadlines;
+      Bypass(inBuf, outBuf, numSamples);
+      return numSamples;
+   }
+
+   bool SandboxedInstance::RealtimeProcessEnd(EffectSettings&) noexcept
+   {
+      if(mLost.load(std::memory_order_relaxed))
+         return true;
+      const BlockHeader header { ++mSequence, BlockKind::ProcessEnd };
+      mToHost.Write(&header, sizeof(header));
+      return true;
+   }
+
+   bool SandboxedInstance::RealtimeFinalize(EffectSettings&) noexcept
+   {
+      Send(RequestFinalize);
+      Shutdown();
+      return true;
+   }
+
+   void SandboxedInstance::Bypass(const float* const* inBuf,
+      float* const* outBuf, size_t numSamples) const noexcept
+   {
+      for(unsigned i = 0; i < mAudioOuts; ++i)
+      {
+         if(i < mAudioIns)
+            std::copy(inBuf[i], inBuf[i] + numSamples, outBuf[i]);
+         else
+            std::fill(outBuf[i], outBuf[i] + numSamples, 0.0f);
+      }
+   }
+
+   void SandboxedInstance::SendSettingsRoutine()
+   {
+      std::unique_lock lck(mSettingsSync);
+      while(true)
+      {
+         mSettingsCondition.wait(lck,
+            [this]{ return mStopSettings || mPendingSettings.has_value(); });
+         if(mStopSettings)
+            return;
+         std::optional<EffectSettings> settings;
+         settings.swap(mPendingSettings);
+         lck.unlock();
+
+         try
+         {
+            auto serialized = SerializeSettings(mEffect, *settings);
+            if(serialized != mLastSentSettings &&
+               Send(MakeMessage({ RequestSettings, serialized })))
+               mLastSentSettings = std::move(serialized);
+         }
+         catch(...)
+         {
+         }
+
+         lck.lock();
+      }
+   }
+
+   void SandboxedInstance::Shutdown() noexcept
+   {
+      {
+         std::lock_guard lck(mSettingsSync);
+         mStopSettings = true;
+      }
+      mSettingsCondition.notify_one();
+      if(mSettingsThread.joinable())
+         mSettingsThread.join();
+      mStopSettings = false;
+
+      //Closing the connection lets the host exit
+      mServer.reset();
+      mLost.store(true);
+      mMemory.reset();
+   }
+
+   std::optional<wxString> SandboxedInstance::Request(const wxString& request)
+   {
+      std::unique_lock lck(mSync);
+      //The host connects after it has started; the request waits for it
+      if(!mReplyCondition.wait_for(lck, RequestTimeout,
+         [this]{ return mChannel != nullptr || mLost.load(); }) || mLost)
+         return {};
+      mReplies.clear();
+      detail::PutMessage(*mChannel, request);
+      if(!mReplyCondition.wait_for(lck, RequestTimeout,
+         [this]{ return !mReplies.empty() || mLost.load(); }) ||
+         mReplies.empty())
+         return {};
+      auto reply = std::move(mReplies.front());
+      mReplies.pop_front();
+      return reply;
+   }
+
+   bool SandboxedInstance::Send(const wxString& message) noexcept
+   {
+      try
+      {
+         std::lock_guard lck(mSync);
+         if(mChannel == nullptr)
+            return false;
+         detail::PutMessage(*mChannel, message);
+         return true;
+      }
+      catch(...)
+      {
+         return false;
+      }
+   }
+
+   void SandboxedInstance::OnConnect(IPCChannel& channel) noexcept
+   {
+      {
+         std::lock_guard lck(mSync);
+         mChannel = &channel;
+      }
+      mReplyCondition.notify_all();
+   }
+
+   void SandboxedInstance::OnDisconnect() noexcept
+   {
+      {
+         std::lock_guard lck(mSync);
+         mChannel = nullptr;
+         mLost.store(true);
+      }
+      mReplyCondition.notify_all();
+   }
+
+   void SandboxedInstance::OnConnectionError() noexcept
+   {
+      OnDisconnect();
+   }
+
+   void SandboxedInstance::OnDataAvailable(const void* data, size_t size) noexcept
+   {
+      try
+      {
+         {
+            std::lock_guard lck(mSync);
+            mMessageReader.ConsumeBytes(data, size);
+            while(mMessageReader.CanPop())
+               mReplies.push_back(mMessageReader.Pop());
+         }
+         mReplyCondition.notify_all();
+      }
+      catch(...)
+      {
+         OnDisconnect();
+      }
+   }
+
+   ///Host process side
+   class Host final : public IPCChannelStatusCallback
+   {
+   public:
+      explicit Host(int connectPort)
+      {
+         FileNames::InitializePathList();
+         InitPreferences(audacity::ApplicationSettings::Call());
+
+         auto& moduleManager = ModuleManager::Get();
+         moduleManager.Initialize();
+         moduleManager.DiscoverProviders();
+
+         mClient = std::make_unique<IPCClient>(connectPort, *this);
+      }
+
+      ~Host() override
+      {
+         if(mInstance && mInitialized)
+            mInstance->RealtimeFinalize(mSettings);
+         mClient.reset();
+      }
+
+      void OnConnect(IPCChannel& channel) noexcept override
+      {
+         std::lock_guard lck(mSync);
+         mChannel = &channel;
+      }
+
+      void OnDisconnect() noexcept override
+      {
+         std::lock_guard lck(mSync);
+         mRunning = false;
+         mChannel = nullptr;
+      }
+
+      void OnConnectionError() noexcept override
+      {
+         OnDisconnect();
+      }
+
+      void OnDataAvailable(const void* data, size_t size) noexcept override
+      {
+         try
+         {
+            std::lock_guard lck(mSync);
+            mMessageReader.ConsumeBytes(data, size);
+            while(mMessageReader.CanPop())
+               mRequests.push_back(mMessageReader.Pop());
+         }
+         catch(...)
+         {
+            OnDisconnect();
+         }
+      }
+
+      //Returns false when the main application is gone
+      bool Serve()
+      {
+         std::optional<wxString> request;
+         {
+            std::lock_guard lck(mSync);
+            if(!mRunning)
+               return false;
+            if(!mRequests.empty())
+            {
+               request = std::move(mRequests.front());
+               mRequests.pop_front();
+            }
+         }
+         if(request)
+            Handle(*request);
+
+         if(ProcessBlocks())
+            mIdleCount = 0;
+         //Spin a while after work, as the next block comes soon, then sleep
+         else if(++mIdleCount < 1000)
+            std::this_thread::yield();
+         else
+            std::this_thread::sleep_for(microseconds(200));
+         return true;
+      }
+
+   private:
+      void Reply(const wxString& message)
+      {
+         std::lock_guard lck(mSync);
+         if(mChannel)
+            detail::PutMessage(*mChannel, message);
+      }
+
+      void Handle(const wxString& request)
+      {
+         const auto kind = request.BeforeFirst(FieldSeparator);
+         try
+         {
+            if(kind == RequestInit)
+               Reply(Init(request));
+            else if(kind == RequestAddProcessor)
+               Reply(AddProcessor(request));
+            else if(kind == RequestSettings)
+               LoadSettings(SplitMessage(request, 2).back());
+            else if(kind == RequestSuspend && mInstance)
+               mInstance->RealtimeSuspend();
+            else if(kind == RequestResume && mInstance)
+               mInstance->RealtimeResume();
+            else if(kind == RequestFinalize)
+            {
+               std::lock_guard lck(mSync);
+               mRunning = false;
+            }
+         }
+         catch(...)
+         {
+            if(kind == RequestInit || kind == RequestAddProcessor)
+               Reply(ReplyError);
+         }
+      }
+
+      void LoadSettings(const wxString& serialized)
+      {
+         if(!mEffect)
+            return;
+         CommandParameters parms { serialized };
+         mEffect->LoadSettings(parms, mSettings);
+      }
+
+      wxString Init(const wxString& request)
+      {
+         //init, memory name, block size, rate, provider, path, settings
+         const auto fields = SplitMessage(request, 7);
+         unsigned long blockSize;
+         double sampleRate;
+         if(fields.size() != 7 || mInstance ||
+            !fields[2].ToULong(&blockSize) || !fields[3].ToCDouble(&sampleRate))
+            return ReplyError;
+
+         mMemory = IPCSharedMemory::Open(
+            fields[1].ToStdString(), SharedMemorySize(blockSize));
+         if(!mMemory)
+            return ReplyError;
+         std::tie(mFromMain, mToMain) = AttachRings(*mMemory, blockSize);
+
+         auto provider = ModuleManager::Get()
+            .CreateProviderInstance(fields[4], wxEmptyString);
+         if(!provider)
+            return ReplyError;
+         mPlugin = provider->LoadPlugin(fields[5]);
+         mEffect = dynamic_cast<EffectInstanceFactory*>(mPlugin.get());
+         if(!mEffect)
+            return ReplyError;
+         mSettings = mEffect->MakeSettings();
+         LoadSettings(fields[6]);
+
+         mInstance = mEffect->MakeInstance();
+         if(!mInstance)
+            return ReplyError;
+         mInstance->SetBlockSize(blockSize);
+         if(!mInstance->RealtimeInitialize(mSettings, sampleRate))
+            return ReplyError;
+         mInitialized = true;
+         mSampleRate = sampleRate;
+
+         const auto ins = mInstance->GetAudioInCount();
+         const auto outs = mInstance->GetAudioOutCount();
+         if(ins > MaxChannels || outs > MaxChannels)
+            return ReplyError;
+         mInputs.assign(ins, std::vector<float>(blockSize));
+         mOutputs.assign(outs, std::vector<float>(blockSize));
+         return MakeMessage({
+            ReplyOk,
+            wxString::Format("%u", ins),
+            wxString::Format("%u", outs),
+            wxString::Format("%lu", blockSize)
+         });
+      }
+
+      wxString AddProcessor(const wxString& request)
+      {
+         //add, channels, rate
+         const auto fields = SplitMessage(request, 3);
+         unsigned long numChannels;
+         double sampleRate;
+         if(fields.size() != 3 || !mInstance ||
+            !fields[1].ToULong(&numChannels) || !fields[2].ToCDouble(&sampleRate))
+            return ReplyError;
+         if(!mInstance->RealtimeAddProcessor(
+            mSettings, nullptr, numChannels, sampleRate))
+            return ReplyError;
+         return MakeMessage({
+            ReplyOk,
+            wxString::Format("%llu", static_cast<unsigned long long>(
+               mInstance->GetLatency(mSettings, mSampleRate)))
+         });
+      }
+
+      //Returns true if any block was handled
+      bool ProcessBlocks()
+      {
+         if(!mInstance)
+            return false;
+
+         bool handled = false;
+         BlockHeader header;
+         while(mFromMain.Read(&header, sizeof(header)))
+         {
+            handled = true;
+            switch(header.kind)
+            {
+            case BlockKind::ProcessStart:
+            {
+               EffectInstance::MessagePackage package { mSettings, nullptr };
+               mInstance->RealtimeProcessStart(package);
+               break;
+            }
+            case BlockKind::ProcessEnd:
+               mInstance->RealtimeProcessEnd(mSettings);
+               break;
+            case BlockKind::Process:
+               Process(header);
+               break;
+            }
+         }
+         return handled;
+      }
+
+      void Process(const BlockHeader& header)
+      {
+         const auto frames = header.frames;
+         const auto bytes = frames * sizeof(float);
+         const auto channels = std::min<size_t>(header.channels, mInputs.size());
+         for(size_t i = 0; i < channels; ++i)
+            mFromMain.Read(mInputs[i].data(), bytes);
+         mFromMain.Skip((header.channels - channels) * bytes);
+
+         //Process in the sizes the instance accepts, as does
+         //RealtimeEffectState
+         std::vector<const float*> in(mInputs.size());
+         std::vector<float*> out(mOutputs.size());
+         for(size_t i = 0; i < in.size(); ++i)
+            in[i] = mInputs[i].data();
+         for(size_t i = 0; i < out.size(); ++i)
+            out[i] = mOutputs[i].data();
+         const auto blockSize = std::max<size_t>(1, mInstance->GetBlockSize());
+         for(size_t done = 0; done < frames;)
+         {
+            const auto count = std::min<size_t>(frames - done, blockSize);
+            const auto processed = mInstance->RealtimeProcess(
+               header.group, mSettings, in.data(), out.data(), count);
+            if(processed == 0)
+               break;
+            for(auto& p : in)
+               p += processed;
+            for(auto& p : out)
+               p += processed;
+            done += processed;
+         }
+
+         const BlockHeader result {
+            header.sequence, BlockKind::Process, header.group,
+            static_cast<uint32_t>(mOutputs.size()), frames
+         };
+         std::vector<IPCSharedRing::Part> parts;
+         parts.reserve(1 + mOutputs.size());
+         parts.push_back({ &result, sizeof(result) });
+         for(auto& output : mOutputs)
+            parts.push_back({ output.data(), bytes });
+         //If main is not reading, it has given up on earlier results too
+         mToMain.Write(parts.data(), parts.size());
+      }
+
+      std::unique_ptr<IPCClient> mClient;
+      std::mutex mSync;
+      IPCChannel* mChannel { nullptr };
+      detail::InputMessageReader mMessageReader;
+      std::deque<wxString> mRequests;
+      bool mRunning { true };
+
+      std::unique_ptr<IPCSharedMemory> mMemory;
+      IPCSharedRing mFromMain;
+      IPCSharedRing mToMain;
+
+      std::unique_ptr<ComponentInterface> mPlugin;
+      EffectInstanceFactory* mEffect { nullptr };
+      EffectSettings mSettings;
+      std::shared_ptr<EffectInstance> mInstance;
+      bool mInitialized { false };
+      double mSampleRate { 0 };
+
+      std::vector<std::vector<float>> mInputs;
+      std::vector<std::vector<float>> mOutputs;
+      unsigned mIdleCount { 0 };
+   };
+}
+
+std::shared_ptr<EffectInstance>
+RealtimeSandbox::MakeInstance(const EffectInstanceFactory& effect, const PluginID& id)
+{
+   if(!Enabled.Read())
+      return {};
+   const auto desc = PluginManager::Get().GetPlugin(id);
+   if(desc == nullptr)
+      return {};
+   //Built-in and Nyquist effects are part of the application
+   const auto family = desc->GetEffectFamily();
+   if(family == "Audacity" || family == "Nyquist")
+      return {};
+   return std::make_shared<SandboxedInstance>(
+      effect, desc->GetProviderID(), desc->GetPath());
+}
+
+void RealtimeSandbox::Serve(int connectPort)
+{
+   Host host(connectPort);
+   while(host.Serve()) { }
+}
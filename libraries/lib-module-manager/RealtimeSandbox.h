@@ -0,0 +1,53 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file RealtimeSandbox.h
+
+  Part of lib-module-manager library
+
+**********************************************************************/
+
+#pragma once
+
+#include <memory>
+#include <wx/string.h>
+
+class BoolSetting;
+class EffectInstance;
+class EffectInstanceFactory;
+
+using PluginID = wxString;
+
+/**
+ * \brief Runs realtime effects of third-party plugins in a separate host
+ * process, so that a crash takes down only that process.
+ *
+ * Control requests, and settings, go over an IPCChannel; audio goes through
+ * two IPCSharedRing queues in shared memory, without locks.  Each block is
+ * processed within the audio callback that asks for it:  if the host does
+ * not answer within a fraction of the block duration, or has gone away, the
+ * block passes through unprocessed, so no latency is added either way.
+ *
+ * Effect messages and output meters are not transported; settings reach
+ * the host a few times a second at most.
+ */
+namespace RealtimeSandbox
+{
+   //! Whether new realtime instances of third-party effects are sandboxed
+   MODULE_MANAGER_API extern BoolSetting Enabled;
+
+   /**
+    * \brief Called in the main process
+    * \return an instance whose realtime processing happens in a host process,
+    * or nullptr if the sandbox is disabled or doesn't apply to the effect
+    */
+   MODULE_MANAGER_API std::shared_ptr<EffectInstance>
+   MakeInstance(const EffectInstanceFactory& effect, const PluginID& id);
+
+   /**
+    * \brief Called in the host process, processes requests until the
+    * main application disconnects
+    */
+   void Serve(int connectPort);
+}
@@ -10,41 +10,63 @@
 **********************************************************************/
 #include "DecimatingMirAudioReader.h"
 
+#include <algorithm>
+#include <cassert>
 #include <cmath>
 #include <vector>
 
 namespace MIR
 {
+namespace
+{
+int GetDecimationFactor(const MirAudioReader& reader)
+{
+   // Input rate divided by this integer will be as close as possible to
+   // 24kHz and not greater.
+   return static_cast<int>(std::ceil(reader.GetSampleRate() / 24000.));
+}
+
+std::vector<float> Decimate(const MirAudioReader& reader, int decimationFactor)
+{
+   // Take the floor
+   const auto numDecimated = reader.GetNumSamples() / decimationFactor;
+   std::vector<float> decimated(numDecimated);
+   constexpr long long chunkSize = 1 << 14;
+   std::vector<float> buffer(chunkSize * decimationFactor);
+   for (long long start = 0; start < numDecimated; start += chunkSize)
+   {
+      const auto count = std::min(chunkSize, numDecimated - start);
+      reader.ReadFloats(
+         buffer.data(), start * decimationFactor, count * decimationFactor);
+      for (auto i = 0; i < count; ++i)
+         decimated[start + i] = buffer[i * decimationFactor];
+   }
+   return decimated;
+}
+} // namespace
+
 DecimatingMirAudioReader::DecimatingMirAudioReader(const MirAudioReader& reader)
-    : mReader { reader }
-    , mDecimationFactor {
-       // Input rate divided by this integer will be as close as possible to
-       // 24kHz and not greater.
-       static_cast<int>(std::ceil(reader.GetSampleRate() / 24000.))
-    }
+    : mSampleRate { 1. * reader.GetSampleRate() / GetDecimationFactor(reader) }
+    , mSamples { Decimate(reader, GetDecimationFactor(reader)) }
 {
 }
 
 double DecimatingMirAudioReader::GetSampleRate() const
 {
-   return 1. * mReader.GetSampleRate() / mDecimationFactor;
+   return mSampleRate;
 }
 
 long long DecimatingMirAudioReader::GetNumSamples() const
 {
-   // Return the floor
-   return mReader.GetNumSamples() / mDecimationFactor;
+   return mSamples.size();
 }
 
 void DecimatingMirAudioReader::ReadFloats(
    float* decimated, long long decimatedStart, size_t numDecimatedFrames) const
 {
-   const auto numFrames = numDecimatedFrames * mDecimationFactor;
-   if (mBuffer.size() < numFrames)
-      mBuffer.resize(numFrames);
-   const auto start = decimatedStart * mDecimationFactor;
-   mReader.ReadFloats(mBuffer.data(), start, numFrames);
-   for (auto i = 0; i < numDecimatedFrames; ++i)
-      decimated[i] = mBuffer[i * mDecimationFactor];
+   assert(decimatedStart >= 0);
+   assert(decimatedStart + numDecimatedFrames <= mSamples.size());
+   std::copy_n(
+      mSamples.begin() + decimatedStart, numDecimatedFrames, decimated);
 }
 } // namespace MIR
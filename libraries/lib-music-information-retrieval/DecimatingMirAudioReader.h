@@ -25,6 +25,10 @@ namespace MIR
  * below the nyquist. Thus we can decimate the audio signal to a certain extent.
  * This is fast and easy to implement, meanwhile reducing dramatically the
  * amount of data and operations.
+ *
+ * The decimated signal is read whole at construction, so that the frames of
+ * an STFT, which overlap, do not read the source over again, and so that
+ * `ReadFloats` may be called concurrently.
  */
 class DecimatingMirAudioReader : public MirAudioReader
 {
@@ -37,8 +41,7 @@ public:
    ReadFloats(float* buffer, long long start, size_t numFrames) const override;
 
 private:
-   const MirAudioReader& mReader;
-   const int mDecimationFactor;
-   mutable std::vector<float> mBuffer;
+   const double mSampleRate;
+   const std::vector<float> mSamples;
 };
 } // namespace MIR
@@ -16,6 +16,8 @@
 #include "MirUtils.h"
 #include "PowerSpectrumGetter.h"
 #include "StftFrameProvider.h"
+#include "concurrency/ThreadPool.h"
+#include <atomic>
 #include <cassert>
 #include <cmath>
 #include <numeric>
@@ -25,12 +27,11 @@ namespace MIR
 {
 namespace
 {
-float GetNoveltyMeasure(
-   const PffftFloatVector& prevPowSpec, const PffftFloatVector& powSpec)
+float GetNoveltyMeasure(const float* prevPowSpec, const float* powSpec, int size)
 {
    auto k = 0;
    return std::accumulate(
-      powSpec.begin(), powSpec.end(), 0.f, [&](float a, float mag) {
+      powSpec, powSpec + size, 0.f, [&](float a, float mag) {
          // Half-wave-rectified stuff
          return a + std::max(0.f, mag - prevPowSpec[k++]);
       });
@@ -67,6 +68,113 @@ std::vector<float> GetMovingAverage(const std::vector<float>& x, double hopRate)
    });
    return movingAverage;
 }
+
+//! @return the next power spectrum of the stream, compressed in place, or null
+float* GetNextCompressedPowerSpectrum(StftPowerSpectrumStream& stream)
+{
+   const auto powSpec = stream.Next();
+   if (!powSpec)
+      return nullptr;
+
+   // Compress the frame as per section (6.5) in Müller, Meinard.
+   // Fundamentals of music processing: Audio, analysis, algorithms,
+   // applications. Vol. 5. Cham: Springer, 2015.
+   constexpr auto gamma = 100.f;
+   std::transform(
+      powSpec, powSpec + stream.GetPowerSpectrumSize(), powSpec,
+      [gamma](float x) { return FastLog2(1 + gamma * std::sqrt(x)); });
+   return powSpec;
+}
+
+/*!
+ * Fill `odf[n - 1]` with the novelty of frame `n` for `n` in `[begin, end)`,
+ * except for `n == 0`, whose novelty closes the loop
+ * @param[out] first power spectrum of frame `begin`
+ * @param[out] last power spectrum of frame `end - 1`
+ */
+void GetNoveltyMeasures(
+   const StftFrameProvider& frameProvider, int begin, int end,
+   std::vector<float>& odf, PffftFloatVector& first, PffftFloatVector& last)
+{
+   StftPowerSpectrumStream stream {
+      frameProvider, std::max(begin - 1, 0), end
+   };
+   const auto powSpecSize = stream.GetPowerSpectrumSize();
+   // A spectrum of the stream is valid only until the next is fetched
+   PffftFloatVector prevPowSpec(powSpecSize);
+   if (begin > 0)
+      std::copy_n(
+         GetNextCompressedPowerSpectrum(stream), powSpecSize,
+         prevPowSpec.begin());
+   for (auto n = begin; n < end; ++n)
+   {
+      const auto powSpec = GetNextCompressedPowerSpectrum(stream);
+      if (n == begin)
+         first.assign(powSpec, powSpec + powSpecSize);
+      if (n > 0)
+         odf[n - 1] =
+            GetNoveltyMeasure(prevPowSpec.data(), powSpec, powSpecSize);
+      std::copy_n(powSpec, powSpecSize, prevPowSpec.begin());
+   }
+   last = prevPowSpec;
+}
+
+/*!
+ * Like the loop of `GetOnsetDetectionFunction`, but computing chunks of
+ * frames on the default thread pool
+ * @pre `audio.ReadFloats` may be called concurrently
+ * @pre `frameProvider.GetNumFrames() > 0`
+ */
+std::vector<float> GetRawOdfConcurrently(
+   const StftFrameProvider& frameProvider,
+   const std::function<void(double)>& progressCallback)
+{
+   const auto numFrames = frameProvider.GetNumFrames();
+   auto& pool = audacity::concurrency::ThreadPool::GetDefault();
+   // Some more chunks than threads, for finer progress, but each long
+   // enough that the extra frame computed at its start costs little
+   constexpr auto minChunkSize = 64;
+   const auto numChunks = std::clamp<int>(
+      4 * (pool.GetThreadsCount() + 1), 1,
+      std::max(1, numFrames / minChunkSize));
+   std::vector<float> odf(numFrames);
+   std::vector<PffftFloatVector> firsts(numChunks), lasts(numChunks);
+   const auto compute = [&](int iChunk) {
+      GetNoveltyMeasures(
+         frameProvider, 1ll * numFrames * iChunk / numChunks,
+         1ll * numFrames * (iChunk + 1) / numChunks, odf, firsts[iChunk],
+         lasts[iChunk]);
+   };
+   // Chunks go to whichever thread is free; this thread reports the progress,
+   // whose callback may throw, between its chunks
+   std::atomic<int> nextChunk { 0 };
+   std::atomic<int> doneChunks { 0 };
+   std::atomic<bool> stopped { false };
+   pool.ParallelFor(pool.GetThreadsCount() + 1, [&](size_t slot) {
+      for (int iChunk; !stopped && (iChunk = nextChunk++) < numChunks;)
+      {
+         compute(iChunk);
+         const auto done = ++doneChunks;
+         if (slot == 0 && progressCallback)
+         {
+            try
+            {
+               progressCallback(1. * done / numChunks);
+            }
+            catch (...)
+            {
+               stopped = true;
+               throw;
+            }
+         }
+      }
+   });
+
+   // Close the loop.
+   odf[numFrames - 1] = GetNoveltyMeasure(
+      lasts.back().data(), firsts.front().data(), firsts.front().size());
+   return odf;
+}
 } // namespace
 
 std::vector<float>
@@ -112,49 +220,46 @@ std::vector<float> GetOnsetDetectionFunction(
    QuantizationFitDebugOutput* debugOutput)
 {
    StftFrameProvider frameProvider { audio };
-   const auto sampleRate = frameProvider.GetSampleRate();
    const auto numFrames = frameProvider.GetNumFrames();
-   const auto frameSize = frameProvider.GetFftSize();
-   PffftFloatVector buffer(frameSize);
    std::vector<float> odf;
-   odf.reserve(numFrames);
-   const auto powSpecSize = frameSize / 2 + 1;
-   PffftFloatVector powSpec(powSpecSize);
-   PffftFloatVector prevPowSpec(powSpecSize);
-   PffftFloatVector firstPowSpec;
-   std::fill(prevPowSpec.begin(), prevPowSpec.end(), 0.f);
-
-   PowerSpectrumGetter getPowerSpectrum { frameSize };
-
-   auto frameCounter = 0;
-   while (frameProvider.GetNextFrame(buffer))
+   auto& pool = audacity::concurrency::ThreadPool::GetDefault();
+   // The debug output wants all of the STFT; and don't wait for other tasks
+   // of the pool from within it, as when clips are analyzed concurrently
+   if (!debugOutput && numFrames > 0 && !pool.IsWorkerThread())
+      odf = GetRawOdfConcurrently(frameProvider, progressCallback);
+   else
    {
-      getPowerSpectrum(buffer.aligned(), powSpec.aligned());
+      StftPowerSpectrumStream stream { frameProvider, 0, numFrames };
+      odf.reserve(numFrames);
+      const auto powSpecSize = stream.GetPowerSpectrumSize();
+      PffftFloatVector prevPowSpec(powSpecSize);
+      PffftFloatVector firstPowSpec;
+      std::fill(prevPowSpec.begin(), prevPowSpec.end(), 0.f);
 
-      // Compress the frame as per section (6.5) in Müller, Meinard.
-      // Fundamentals of music processing: Audio, analysis, algorithms,
-      // applications. Vol. 5. Cham: Springer, 2015.
-      constexpr auto gamma = 100.f;
-      std::transform(
-         powSpec.begin(), powSpec.end(), powSpec.begin(),
-         [gamma](float x) { return FastLog2(1 + gamma * std::sqrt(x)); });
+      for (auto n = 0; n < numFrames; ++n)
+      {
+         const auto powSpec = GetNextCompressedPowerSpectrum(stream);
 
-      if (firstPowSpec.empty())
-         firstPowSpec = powSpec;
-      else
-         odf.push_back(GetNoveltyMeasure(prevPowSpec, powSpec));
+         if (firstPowSpec.empty())
+            firstPowSpec.assign(powSpec, powSpec + powSpecSize);
+         else
+            odf.push_back(
+               GetNoveltyMeasure(prevPowSpec.data(), powSpec, powSpecSize));
 
-      if (debugOutput)
-         debugOutput->postProcessedStft.push_back(powSpec);
+         if (debugOutput)
+            debugOutput->postProcessedStft.emplace_back(
+               powSpec, powSpec + powSpecSize);
 
-      std::swap(prevPowSpec, powSpec);
+         std::copy_n(powSpec, powSpecSize, prevPowSpec.begin());
 
-      if (progressCallback)
-         progressCallback(1. * ++frameCounter / numFrames);
-   }
+         if (progressCallback)
+            progressCallback(1. * (n + 1) / numFrames);
+      }
 
-   // Close the loop.
-   odf.push_back(GetNoveltyMeasure(prevPowSpec, firstPowSpec));
+      // Close the loop.
+      odf.push_back(GetNoveltyMeasure(
+         prevPowSpec.data(), firstPowSpec.data(), firstPowSpec.size()));
+   }
    assert(IsPowOfTwo(odf.size()));
 
    const auto movingAverage =
@@ -34,6 +34,13 @@ struct QuantizationFitDebugOutput;
  */
 std::vector<float> GetNormalizedCircularAutocorr(const std::vector<float>& x);
 
+/*!
+ * @brief Get the onset detection function of the audio, one value per STFT
+ * frame.  Without `debugInfo`, frames are computed on the default thread
+ * pool, unless this is called from within it.
+ *
+ * @pre `audio.ReadFloats` may be called concurrently
+ */
 std::vector<float> GetOnsetDetectionFunction(
    const MirAudioReader& audio,
    const std::function<void(double)>& progressCallback,
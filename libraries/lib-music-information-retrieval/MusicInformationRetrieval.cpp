@@ -55,6 +55,9 @@ GetProjectSyncInfo(const ProjectSyncInfoInput& in)
    std::optional<double> bpm;
    std::optional<TimeSignature> timeSignature;
    std::optional<TempoObtainedFrom> usedMethod;
+   const auto tolerance = in.viewIsBeatsAndMeasures ?
+                             FalsePositiveTolerance::Lenient :
+                             FalsePositiveTolerance::Strict;
 
    if (in.tags.has_value() && in.tags->bpm.has_value() && *in.tags->bpm > 30.)
    {
@@ -64,11 +67,11 @@ GetProjectSyncInfo(const ProjectSyncInfoInput& in)
    else if (bpm = GetBpmFromFilename(in.filename))
       usedMethod = TempoObtainedFrom::Title;
    else if (
-      const auto meter = GetMusicalMeterFromSignal(
-         in.source,
-         in.viewIsBeatsAndMeasures ? FalsePositiveTolerance::Lenient :
-                                     FalsePositiveTolerance::Strict,
-         in.progressCallback))
+      const auto meter =
+         in.meterFromSignal ?
+            in.meterFromSignal(in.source, tolerance, in.progressCallback) :
+            GetMusicalMeterFromSignal(
+               in.source, tolerance, in.progressCallback))
    {
       bpm = meter->bpm;
       timeSignature = meter->timeSignature;
@@ -51,6 +51,10 @@ static const std::unordered_map<FalsePositiveTolerance, LoopClassifierSettings>
       { FalsePositiveTolerance::Lenient, { .1, 0.7129778875046098 } },
    };
 
+using MeterFromSignal = std::function<std::optional<MusicalMeter>(
+   const MirAudioReader& source, FalsePositiveTolerance tolerance,
+   const std::function<void(double)>& progressCallback)>;
+
 struct ProjectSyncInfoInput
 {
    const MirAudioReader& source;
@@ -60,6 +64,9 @@ struct ProjectSyncInfoInput
    double projectTempo = 120.;
    bool projectWasEmpty = false;
    bool viewIsBeatsAndMeasures = false;
+   //! Analyzes the signal when neither tags nor filename give the tempo; if
+   //! empty, `GetMusicalMeterFromSignal` does, but a cache may be given
+   MeterFromSignal meterFromSignal;
 };
 
 std::optional<ProjectSyncInfo> MUSIC_INFORMATION_RETRIEVAL_API
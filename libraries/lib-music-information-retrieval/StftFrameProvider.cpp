@@ -47,7 +47,10 @@ StftFrameProvider::StftFrameProvider(const MirAudioReader& audio)
     : mAudio { audio }
     , mFftSize { GetFrameSize(audio.GetSampleRate()) }
     , mHopSize { GetHopSize(audio.GetSampleRate(), audio.GetNumSamples()) }
-    , mWindow { GetNormalizedHann(mFftSize) }
+    , mWindow { [this] {
+       const auto window = GetNormalizedHann(mFftSize);
+       return PffftFloatVector { window.begin(), window.end() };
+    }() }
     , mNumFrames { mHopSize > 0 ? static_cast<int>(std::round(
                                      audio.GetNumSamples() / mHopSize)) :
                                   0 }
@@ -60,26 +63,38 @@ bool StftFrameProvider::GetNextFrame(PffftFloatVector& frame)
 {
    if (mNumFramesProvided >= mNumFrames)
       return false;
+   GetFrame(mNumFramesProvided, frame);
+   ++mNumFramesProvided;
+   return true;
+}
+
+void StftFrameProvider::GetFrame(int index, PffftFloatVector& frame) const
+{
    frame.resize(mFftSize, 0.f);
+   GetFrame(index, frame.aligned());
+}
+
+void StftFrameProvider::GetFrame(int index, PffftFloats alignedFrame) const
+{
+   assert(0 <= index && index < mNumFrames);
+   const auto frame = alignedFrame.get();
    const int firstReadPosition = mHopSize - mFftSize;
-   int start = std::round(firstReadPosition + mNumFramesProvided * mHopSize);
+   int start = std::round(firstReadPosition + index * mHopSize);
    while (start < 0)
       start += mNumSamples;
    const auto end = std::min<long long>(start + mFftSize, mNumSamples);
    const auto numToRead = end - start;
-   mAudio.ReadFloats(frame.data(), start, numToRead);
+   mAudio.ReadFloats(frame, start, numToRead);
    // It's not impossible that some user drops a file so short that `mFftSize >
    // mNumSamples`. In that case we won't be returning a meaningful
    // STFT, but that's a use case we're not interested in. We just need to make
    // sure we don't crash.
    const auto numRemaining = std::min(mFftSize - numToRead, mNumSamples);
    if (numRemaining > 0)
-      mAudio.ReadFloats(frame.data() + numToRead, 0, numRemaining);
+      mAudio.ReadFloats(frame + numToRead, 0, numRemaining);
    std::transform(
-      frame.begin(), frame.end(), mWindow.begin(), frame.begin(),
+      frame, frame + mFftSize, mWindow.begin(), frame,
       std::multiplies<float>());
-   ++mNumFramesProvided;
-   return true;
 }
 
 int StftFrameProvider::GetNumFrames() const
@@ -101,4 +116,48 @@ int StftFrameProvider::GetFftSize() const
 {
    return mFftSize;
 }
+
+StftPowerSpectrumStream::StftPowerSpectrumStream(
+   const StftFrameProvider& provider, int begin, int end)
+    : mProvider { provider }
+    , mEnd { end }
+    , mPowSpecSize { provider.GetFftSize() / 2 + 1 }
+    , mFrameStride { static_cast<size_t>(provider.GetFftSize()) }
+    , mPowSpecStride { static_cast<size_t>(mPowSpecSize) }
+    , mGetPowerSpectrum { provider.GetFftSize() }
+    , mFrames(mFrameStride * static_cast<size_t>(batchSize))
+    , mPowSpecs(mPowSpecStride * static_cast<size_t>(batchSize))
+    , mNext { begin }
+{
+   assert(0 <= begin && begin <= end && end <= provider.GetNumFrames());
+}
+
+int StftPowerSpectrumStream::GetPowerSpectrumSize() const
+{
+   return mPowSpecSize;
+}
+
+float* StftPowerSpectrumStream::Next()
+{
+   if (mIndexInBatch == mNumInBatch)
+   {
+      if (mNext >= mEnd)
+         return nullptr;
+      FillBatch();
+   }
+   return mPowSpecs.aligned(mPowSpecStride, mIndexInBatch++).get();
+}
+
+void StftPowerSpectrumStream::FillBatch()
+{
+   mNumInBatch = std::min(batchSize, mEnd - mNext);
+   mIndexInBatch = 0;
+   for (auto i = 0; i < mNumInBatch; ++i)
+      mProvider.GetFrame(mNext + i, mFrames.aligned(mFrameStride, i));
+   for (auto i = 0; i < mNumInBatch; ++i)
+      mGetPowerSpectrum(
+         mFrames.aligned(mFrameStride, i),
+         mPowSpecs.aligned(mPowSpecStride, i));
+   mNext += mNumInBatch;
+}
 } // namespace MIR
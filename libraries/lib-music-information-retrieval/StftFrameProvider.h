@@ -30,6 +30,14 @@ class MUSIC_INFORMATION_RETRIEVAL_API StftFrameProvider
 public:
    StftFrameProvider(const MirAudioReader& source);
    bool GetNextFrame(PffftFloatVector& frame);
+   /*!
+    * Frames are independent, so that they may be computed concurrently, if
+    * the source may be read concurrently.
+    * @pre `0 <= index && index < GetNumFrames()`
+    */
+   void GetFrame(int index, PffftFloatVector& frame) const;
+   //! Like the other overload, writing `GetFftSize()` floats at `frame`
+   void GetFrame(int index, PffftFloats frame) const;
    int GetNumFrames() const;
    int GetSampleRate() const;
    double GetFrameRate() const;
@@ -39,9 +47,53 @@ private:
    const MirAudioReader& mAudio;
    const int mFftSize;
    const double mHopSize;
-   const std::vector<float> mWindow;
+   const PffftFloatVector mWindow;
    const int mNumFrames;
    const long long mNumSamples;
    int mNumFramesProvided = 0;
 };
+
+/*!
+ * Streams the power spectra of a range of frames of a `StftFrameProvider`.
+ * Frames are read, then transformed, a batch at a time, into aligned buffers
+ * that are reused, with one FFT setup, so that nothing is allocated per frame.
+ */
+class MUSIC_INFORMATION_RETRIEVAL_API StftPowerSpectrumStream
+{
+public:
+   //! Frames read and transformed at a time
+   static constexpr int batchSize = 8;
+
+   /*!
+    * @pre `0 <= begin && begin <= end && end <= provider.GetNumFrames()`
+    */
+   StftPowerSpectrumStream(
+      const StftFrameProvider& provider, int begin, int end);
+
+   //! `GetFftSize() / 2 + 1` of the provider
+   int GetPowerSpectrumSize() const;
+
+   /*!
+    * @return the power spectrum of the next frame, which the caller may
+    * modify, and which remains valid until the next call; or null after the
+    * last frame of the range
+    */
+   float* Next();
+
+private:
+   void FillBatch();
+
+   const StftFrameProvider& mProvider;
+   const int mEnd;
+   const int mPowSpecSize;
+   const PffftAlignedCount mFrameStride;
+   const PffftAlignedCount mPowSpecStride;
+   PowerSpectrumGetter mGetPowerSpectrum;
+   PffftFloatVector mFrames;
+   PffftFloatVector mPowSpecs;
+   //! Index of the first frame not yet in a batch
+   int mNext;
+   int mNumInBatch = 0;
+   int mIndexInBatch = 0;
+};
 } // namespace MIR
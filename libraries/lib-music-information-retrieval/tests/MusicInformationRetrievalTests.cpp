@@ -138,6 +138,30 @@ TEST_CASE("GetProjectSyncInfo")
          REQUIRE(info->rawAudioTempo == 100);
       }
 
+      SECTION("asks meterFromSignal only if tags and filename fail")
+      {
+         auto input = arbitaryInput;
+         auto numCalls = 0;
+         input.meterFromSignal = [&](const MirAudioReader&,
+                                     FalsePositiveTolerance tolerance,
+                                     const std::function<void(double)>&) {
+            ++numCalls;
+            REQUIRE(tolerance == FalsePositiveTolerance::Strict);
+            return std::make_optional(
+               MusicalMeter { 90., TimeSignature::FourFour });
+         };
+         input.filename = filename100bpm;
+         REQUIRE(GetProjectSyncInfo(input)->rawAudioTempo == 100);
+         REQUIRE(numCalls == 0);
+
+         input.filename = "filenameWithoutBpm";
+         const auto info = GetProjectSyncInfo(input);
+         REQUIRE(numCalls == 1);
+         REQUIRE(info);
+         REQUIRE(info->rawAudioTempo == 90);
+         REQUIRE(info->usedMethod == TempoObtainedFrom::Signal);
+      }
+
       SECTION("stretchMinimizingPowOfTwo is as expected")
       {
          auto input = arbitaryInput;
@@ -13,6 +13,7 @@
 #include "StftFrameProvider.h"
 
 #include <catch2/catch.hpp>
+#include <cmath>
 
 namespace MIR
 {
@@ -42,6 +43,26 @@ public:
       REQUIRE(where + numFrames <= numSamples);
    };
 };
+
+class NoiseMirAudioReader : public MirAudioReader
+{
+public:
+   double GetSampleRate() const override
+   {
+      return 44100;
+   };
+   long long GetNumSamples() const override
+   {
+      return 44100;
+   };
+   void
+   ReadFloats(float* buffer, long long where, size_t numFrames) const override
+   {
+      // Same value for the same position, whatever the order of reading
+      for (size_t i = 0; i < numFrames; ++i)
+         buffer[i] = std::sin((where + i) * (where + i) * 1e-3f);
+   };
+};
 } // namespace
 TEST_CASE("StftFrameProvider")
 {
@@ -71,4 +92,30 @@ TEST_CASE("StftFrameProvider")
          ;
    }
 }
+
+TEST_CASE("StftPowerSpectrumStream")
+{
+   NoiseMirAudioReader reader;
+   const StftFrameProvider provider { reader };
+   const auto fftSize = provider.GetFftSize();
+   // Cross a batch boundary, and end with a partial batch
+   const auto begin = 3;
+   const auto end = begin + StftPowerSpectrumStream::batchSize + 2;
+   REQUIRE(end <= provider.GetNumFrames());
+
+   StftPowerSpectrumStream sut { provider, begin, end };
+   REQUIRE(sut.GetPowerSpectrumSize() == fftSize / 2 + 1);
+   PowerSpectrumGetter getPowerSpectrum { fftSize };
+   PffftFloatVector frame;
+   PffftFloatVector expected(fftSize / 2 + 1);
+   for (auto n = begin; n < end; ++n)
+   {
+      const auto powSpec = sut.Next();
+      REQUIRE(powSpec);
+      provider.GetFrame(n, frame);
+      getPowerSpectrum(frame.aligned(), expected.aligned());
+      REQUIRE(std::equal(expected.begin(), expected.end(), powSpec));
+   }
+   REQUIRE(!sut.Next());
+}
 } // namespace MIR
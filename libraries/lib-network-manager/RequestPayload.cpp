@@ -10,6 +10,7 @@
 
 #include "RequestPayload.h"
 
+#include <algorithm>
 #include <iterator>
 #include <vector>
 
@@ -174,6 +175,50 @@ private:
    wxStructStat mFileStat;
 }; // class FileRequestPayloadStream
 
+class CallbackRequestPayloadStream final : public RequestPayloadStream
+{
+public:
+   CallbackRequestPayloadStream(RequestPayloadReader reader, int64_t size)
+       : mReader { std::move(reader) }
+       , mStreamSize { size }
+   {
+   }
+
+   bool HasData() const override
+   {
+      return static_cast<bool>(mReader);
+   }
+
+   int64_t GetDataSize() const override
+   {
+      return mStreamSize;
+   }
+
+   bool Seek(int64_t offset, SeekDirection direction) override
+   {
+      // Only rewinding a stream that was not read yet is possible
+      return mStreamPosition == 0 && direction != SeekDirection::End &&
+             offset == 0;
+   }
+
+   int64_t Read(void* buffer, int64_t size) override
+   {
+      if (!mReader || size <= 0)
+         return 0;
+
+      const auto bytesRead = std::clamp<int64_t>(mReader(buffer, size), 0, size);
+      mStreamPosition += bytesRead;
+
+      return bytesRead;
+   }
+
+private:
+   RequestPayloadReader mReader;
+
+   int64_t mStreamSize {};
+   int64_t mStreamPosition {};
+}; // class CallbackRequestPayloadStream
+
 } // namespace
 
 RequestPayloadStream::~RequestPayloadStream()
@@ -196,4 +241,11 @@ RequestPayloadStreamPtr CreateRequestPayloadStream(const std::string& filePath)
    return std::make_shared<FileRequestPayloadStream>(filePath);
 }
 
+RequestPayloadStreamPtr
+CreateRequestPayloadStream(RequestPayloadReader reader, int64_t size)
+{
+   return std::make_shared<CallbackRequestPayloadStream>(
+      std::move(reader), size);
+}
+
 } // namespace audacity::network_manager
@@ -11,6 +11,7 @@
 #pragma once
 
 #include <cstdint>
+#include <functional>
 #include <memory>
 #include <string>
 
@@ -51,5 +52,19 @@ NETWORK_MANAGER_API RequestPayloadStreamPtr CreateRequestPayloadStream();
 NETWORK_MANAGER_API RequestPayloadStreamPtr
 CreateRequestPayloadStream(const std::string& filePath);
 
+//! Fills at most size bytes of buffer, returns the number of bytes written,
+//! or 0 at the end of the data
+using RequestPayloadReader = std::function<int64_t(void* buffer, int64_t size)>;
+
+//! Creates a stream that pulls the body from reader while it is sent
+/*!
+ The body is never held in memory as a whole.  The stream can't be rewound
+ once reading started, so requests that must resend the body fail instead.
+ @param size of the body, or 0 if it is not known in advance, so that it is
+ sent in chunks
+ */
+NETWORK_MANAGER_API RequestPayloadStreamPtr
+CreateRequestPayloadStream(RequestPayloadReader reader, int64_t size = 0);
+
 
 } // namespace audacity::network_manager
@@ -129,6 +129,14 @@ CurlHandleManager::Handle::Handle(CurlHandleManager* owner, CURL* handle, Reques
       disableSSLValidation();
 
     setOption (CURLOPT_ACCEPT_ENCODING, "");
+
+    // Negotiate HTTP/2 over TLS, falling back to HTTP/1.1. Waiting for a
+    // connection that may multiplex beats opening a new one
+    setOption (CURLOPT_HTTP_VERSION, long (CURL_HTTP_VERSION_2TLS));
+    setOption (CURLOPT_PIPEWAIT, 1L);
+
+    if (mOwner->mShare != nullptr)
+        setOption (CURLOPT_SHARE, mOwner->mShare);
 }
 
 CurlHandleManager::Handle::Handle (Handle&& rhs) noexcept
@@ -280,14 +288,51 @@ CurlHandleManager::CurlHandleManager ()
     mUserAgent = ss.str ();
 
     mProxy = gCurlConfig.Proxy;
+
+    mShare = curl_share_init ();
+
+    if (mShare != nullptr)
+    {
+        curl_share_setopt (mShare, CURLSHOPT_LOCKFUNC, LockSharedData);
+        curl_share_setopt (mShare, CURLSHOPT_UNLOCKFUNC, UnlockSharedData);
+        curl_share_setopt (mShare, CURLSHOPT_USERDATA, this);
+
+        curl_share_setopt (mShare, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+        curl_share_setopt (mShare, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+        curl_share_setopt (mShare, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+    }
 }
 
 CurlHandleManager::~CurlHandleManager ()
 {
-    std::lock_guard<std::mutex> lock (mHandleCacheLock);
+    {
+        std::lock_guard<std::mutex> lock (mHandleCacheLock);
+
+        for (auto& cachedHandle : mHandleCache)
+            curl_easy_cleanup (cachedHandle.Handle);
+
+        mHandleCache.clear ();
+    }
+
+    // All the handles using the share are gone now
+    if (mShare != nullptr)
+        curl_share_cleanup (mShare);
+}
+
+void CurlHandleManager::LockSharedData (CURL*, curl_lock_data data, curl_lock_access, void* userptr) noexcept
+{
+    auto manager = static_cast<CurlHandleManager*> (userptr);
+
+    if (data >= 0 && data < CURL_LOCK_DATA_LAST)
+        manager->mShareLocks[data].lock ();
+}
+
+void CurlHandleManager::UnlockSharedData (CURL*, curl_lock_data data, void* userptr) noexcept
+{
+    auto manager = static_cast<CurlHandleManager*> (userptr);
 
-    for (auto& cachedHandle : mHandleCache)
-        curl_easy_cleanup (cachedHandle.Handle);
+    if (data >= 0 && data < CURL_LOCK_DATA_LAST)
+        manager->mShareLocks[data].unlock ();
 }
 
 void CurlHandleManager::setProxy (std::string proxy)
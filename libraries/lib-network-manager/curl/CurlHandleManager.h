@@ -114,6 +114,9 @@ private:
 
     std::string getUserAgent () const;
 
+    static void LockSharedData (CURL* handle, curl_lock_data data, curl_lock_access access, void* userptr) noexcept;
+    static void UnlockSharedData (CURL* handle, curl_lock_data data, void* userptr) noexcept;
+
     CURL* getCurlHandleFromCache (RequestVerb verb, const std::string& url);
     void cacheHandle (Handle& handle);
 
@@ -126,6 +129,12 @@ private:
 
     std::mutex mHandleCacheLock;
     std::vector<CachedHandle> mHandleCache;
+
+    //! Connections, TLS sessions and DNS entries shared by all the handles,
+    //! so that a request reuses any idle connection to its host, and HTTP/2
+    //! streams of sequential requests share one connection
+    CURLSH* mShare { nullptr };
+    std::mutex mShareLocks[CURL_LOCK_DATA_LAST];
 };
 
 }
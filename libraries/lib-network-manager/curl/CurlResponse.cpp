@@ -311,6 +311,12 @@ void CurlResponse::perform ()
           else
              handle.setOption(CURLOPT_INFILESIZE_LARGE, payloadSize);
        }
+       else if (mVerb == RequestVerb::Post)
+       {
+          // Uploads are chunked by curl itself when the size is unknown,
+          // but HTTP/1.1 posts need to ask for it. HTTP/2 ignores the header.
+          handle.appendHeader({ "Transfer-Encoding", "chunked" });
+       }
 
         handle.setOption (CURLOPT_READFUNCTION, DataStreamRead);
         handle.setOption (CURLOPT_READDATA, mPayload.get());
@@ -20,7 +20,8 @@ namespace audacity
 namespace network_manager
 {
 
-constexpr decltype(std::thread::hardware_concurrency ()) MIN_CURL_THREADS = 6;
+// Enough for the concurrent block uploads of cloud sync
+constexpr decltype(std::thread::hardware_concurrency ()) MIN_CURL_THREADS = 16;
 
 CurlResponseFactory::CurlResponseFactory ()
     : mThreadPool (std::make_unique<ThreadPool>(
@@ -26,11 +26,15 @@ Paul Licameli split from AudioIO.cpp and AudioIOBase.cpp
   or rush synchronous audio samples (without distortion).
 
   \par
-  MIDI output is driven by the low latency thread (PortAudio's callback)
+  MIDI timing is driven by the low latency thread (PortAudio's callback)
   that also sends samples to the output device.  The relatively low
   latency to the output device allows Audacity to stop audio output
   quickly. We want the same behavior for MIDI, but there is not
   periodic callback from PortMidi (because MIDI is asynchronous).
+  So a scheduler thread of MIDIPlay wakes every millisecond, and writes
+  the events due a little later, with timestamps; the callback only
+  updates the estimates of time.  Thus the granularity of output does
+  not grow with the size of audio buffers.
 
   \par
   When Audio is running, MIDI is synchronized to Audio. Globals are set
@@ -358,9 +362,11 @@ Time (in seconds, = total_sample_count / sample_rate)
 
 #include "BasicUI.h"
 #include "Prefs.h"
+#include "Tracing.h"
 #include "portaudio.h"
 #include <portmidi.h>
 #include <porttime.h>
+#include <chrono>
 #include <thread>
 
 #define ROUND(x) (int) ((x)+0.5)
@@ -480,6 +486,12 @@ enum {
    MIDI_MINIMAL_LATENCY_MS = 1
 };
 
+//! How often the scheduler thread wakes to output events
+constexpr std::chrono::milliseconds SchedulerPeriod{ 1 };
+//! How far ahead of the estimated audio time the scheduler outputs events,
+//! covering its period and the lateness of its wake-ups
+constexpr double SchedulerLookahead = 0.010;
+
 // return the system time as a double
 static double streamStartTime = 0; // bias system time to small number
 
@@ -547,6 +559,7 @@ MIDIPlay::MIDIPlay(const PlaybackSchedule &schedule)
 
 MIDIPlay::~MIDIPlay()
 {
+   StopScheduler();
    Pm_Terminate();
 }
 
@@ -564,6 +577,11 @@ bool MIDIPlay::StartOtherStream(const TransportSequences &tracks,
    streamStartTime = 0;
    streamStartTime = SystemTime(mUsingAlsa);
 
+   mRate = rate;
+   mPauseFrames.store(0, std::memory_order_relaxed);
+   mPaused.store(false, std::memory_order_relaxed);
+   mHasSolo.store(false, std::memory_order_relaxed);
+
    mNumFrames = 0;
    // we want this initial value to be way high. It should be
    // sufficient to assume AudioTime is zero and therefore
@@ -571,8 +589,9 @@ bool MIDIPlay::StartOtherStream(const TransportSequences &tracks,
    // for good measure. On the first callback, this should be
    // reduced to SystemTime() - mT0, and note that mT0 is always
    // positive.
-   mSystemMinusAudioTimePlusLatency =
-      mSystemMinusAudioTime = SystemTime(mUsingAlsa) + 1000;
+   const auto systemMinusAudioTime = SystemTime(mUsingAlsa) + 1000;
+   mSystemMinusAudioTime.store(
+      systemMinusAudioTime, std::memory_order_relaxed);
    mAudioOutLatency = 0.0; // set when stream is opened
    mCallbackCount = 0;
    mAudioFramesPerBuffer = 0;
@@ -582,8 +601,9 @@ bool MIDIPlay::StartOtherStream(const TransportSequences &tracks,
       // this is an initial guess, but for PA/Linux/ALSA it's wrong and will be
       // updated with a better value:
       mAudioOutLatency = info->outputLatency;
-      mSystemMinusAudioTimePlusLatency += mAudioOutLatency;
    }
+   mSystemMinusAudioTimePlusLatency.store(
+      systemMinusAudioTime + mAudioOutLatency, std::memory_order_relaxed);
 
    // TODO: it may be that midi out will not work unless audio in or out is
    // active -- this would be a bug and may require a change in the
@@ -734,16 +754,58 @@ bool MIDIPlay::StartPortMidiStream(double rate)
       // until after the first audio callback, which provides necessary
       // data for MidiTime().
       Pm_Synchronize(mMidiStream); // start using timestamps
+      StartScheduler();
    }
    return (mLastPmError == pmNoError);
 }
 
+void MIDIPlay::StartScheduler()
+{
+   StopScheduler();
+   mStopScheduler.store(false, std::memory_order_relaxed);
+   mScheduler = std::thread{ [this]{
+      Tracing::RegisterThread("MIDI");
+      Schedule();
+   } };
+}
+
+void MIDIPlay::StopScheduler()
+{
+   mStopScheduler.store(true, std::memory_order_release);
+   if (mScheduler.joinable())
+      mScheduler.join();
+}
+
+// The scheduler thread, and not the audio callback, owns the iterator and
+// writes to the stream while it runs.  Events are not written at the times
+// of audio callbacks, which come far apart with large buffers, but a short
+// time before they are due; PortMidi delivers them at their timestamps.
+void MIDIPlay::Schedule()
+{
+   while (!mStopScheduler.load(std::memory_order_acquire)) {
+      if (mPaused.load(std::memory_order_relaxed)) {
+         if (!mMidiPaused) {
+            mMidiPaused = true;
+            AllNotesOff(); // to avoid hanging notes during pause
+         }
+      }
+      else {
+         mMidiPaused = false;
+         OutputDueEvents();
+      }
+      std::this_thread::sleep_for(SchedulerPeriod);
+   }
+}
+
 void MIDIPlay::StopOtherStream()
 {
    if (mMidiStream && mMidiStreamActive) {
       /* Stop Midi playback */
       mMidiStreamActive = false;
 
+      // Take back the iterator and the stream from the scheduler
+      StopScheduler();
+
       mMidiOutputComplete = true;
 
       // now we can assume "ownership" of the mMidiStream
@@ -989,20 +1051,32 @@ void Iterator::GetNextEvent()
 }
 
 void MIDIPlay::FillOtherBuffers(
-   double rate, unsigned long pauseFrames, bool paused, bool hasSolo)
+   double, unsigned long pauseFrames, bool, bool hasSolo)
+{
+   // Only publish the state of the callback; the scheduler thread outputs
+   // the events
+   mPauseFrames.store(pauseFrames, std::memory_order_relaxed);
+   mHasSolo.store(hasSolo, std::memory_order_relaxed);
+}
+
+void MIDIPlay::OutputDueEvents()
 {
    if (!mMidiStream)
       return;
 
-   // If not paused, fill buffers.
-   if (paused)
-      return;
+   const auto pauseTime =
+      PauseTime(mRate, mPauseFrames.load(std::memory_order_relaxed));
+   const bool hasSolo = mHasSolo.load(std::memory_order_relaxed);
 
    // If we compute until GetNextEventTime() > current audio time,
    // we would have a built-in compute-ahead of mAudioOutLatency, and
    // it's probably good to compute MIDI when we compute audio (so when
    // we stop, both stop about the same time).
-   double time = AudioTime(rate); // compute to here
+   // The audio time is estimated from the system clock, as AudioTime()
+   // would be if callbacks came continually, not at buffer intervals.
+   double time = SystemTime(mUsingAlsa) -
+      mSystemMinusAudioTime.load(std::memory_order_relaxed) +
+      SchedulerLookahead; // compute to here
    // But if mAudioOutLatency is very low, we might need some extra
    // compute-ahead to deal with mSynthLatency or even this thread.
    double actual_latency  = (MIDI_MINIMAL_LATENCY_MS + mSynthLatency) * 0.001;
@@ -1011,8 +1085,8 @@ void MIDIPlay::FillOtherBuffers(
    }
    while (mIterator &&
           mIterator->mNextEvent &&
-          mIterator->UncorrectedMidiEventTime(PauseTime(rate, pauseFrames)) < time) {
-      if (mIterator->OutputEvent(PauseTime(rate, pauseFrames), false, hasSolo)) {
+          mIterator->UncorrectedMidiEventTime(pauseTime) < time) {
+      if (mIterator->OutputEvent(pauseTime, false, hasSolo)) {
          if (mPlaybackSchedule.GetPolicy().Looping(mPlaybackSchedule)) {
             // jump back to beginning of loop
             ++mMidiLoopPasses;
@@ -1053,7 +1127,7 @@ PmTimestamp MIDIPlay::MidiTime()
    double now = SystemTime(mUsingAlsa);
    ts = (PmTimestamp) ((unsigned long)
          (1000 * (now + 1.0005 -
-                  mSystemMinusAudioTimePlusLatency)));
+            mSystemMinusAudioTimePlusLatency.load(std::memory_order_relaxed))));
    // wxPrintf("AudioIO::MidiTime() %d time %g sys-aud %g\n",
    //        ts, now, mSystemMinusAudioTime);
    return ts + MIDI_MINIMAL_LATENCY_MS;
@@ -1144,14 +1218,17 @@ void MIDIPlay::ComputeOtherTimings(double rate, bool paused,
       // Add worst-case clock drift using previous framesPerBuffer:
       const auto increase =
          mAudioFramesPerBuffer * 0.0002 / rate;
-      mSystemMinusAudioTime += increase;
-      mSystemMinusAudioTimePlusLatency += increase;
-      double enow = rnow - mSystemMinusAudioTime;
+      auto systemMinusAudioTime =
+         mSystemMinusAudioTime.load(std::memory_order_relaxed) + increase;
+      auto systemMinusAudioTimePlusLatency =
+         mSystemMinusAudioTimePlusLatency.load(std::memory_order_relaxed) +
+         increase;
+      double enow = rnow - systemMinusAudioTime;
 
 
       // now, use anow instead if it is ahead of enow
       if (anow > enow) {
-         mSystemMinusAudioTime = rnow - anow;
+         systemMinusAudioTime = rnow - anow;
          // Update our mAudioOutLatency estimate during the first 20 callbacks.
          // During this period, the buffer should fill. Once we have a good
          // estimate of mSystemMinusAudioTime (expected in fewer than 20 callbacks)
@@ -1160,33 +1237,33 @@ void MIDIPlay::ComputeOtherTimings(double rate, bool paused,
          // in the first 20 callbacks should be negligible, however.
          if (mCallbackCount < 20) {
             mAudioOutLatency = mStartTime -
-               mSystemMinusAudioTime;
+               systemMinusAudioTime;
          }
-         mSystemMinusAudioTimePlusLatency =
-            mSystemMinusAudioTime + mAudioOutLatency;
+         systemMinusAudioTimePlusLatency =
+            systemMinusAudioTime + mAudioOutLatency;
       }
+      mSystemMinusAudioTime.store(
+         systemMinusAudioTime, std::memory_order_relaxed);
+      mSystemMinusAudioTimePlusLatency.store(
+         systemMinusAudioTimePlusLatency, std::memory_order_relaxed);
    }
    else {
       // If not using Alsa, rely on timeInfo to have meaningful values that are
       // more precise than the output latency value reported at stream start.
-      mSystemMinusAudioTime = rnow - anow;
-      mSystemMinusAudioTimePlusLatency =
-         mSystemMinusAudioTime +
-            (timeInfo->outputBufferDacTime - timeInfo->currentTime);
+      const auto systemMinusAudioTime = rnow - anow;
+      mSystemMinusAudioTime.store(
+         systemMinusAudioTime, std::memory_order_relaxed);
+      mSystemMinusAudioTimePlusLatency.store(
+         systemMinusAudioTime +
+            (timeInfo->outputBufferDacTime - timeInfo->currentTime),
+         std::memory_order_relaxed);
    }
 
    mAudioFramesPerBuffer = framesPerBuffer;
    mNumFrames += framesPerBuffer;
 
-   // Keep track of time paused.
-   if (paused) {
-      if (!mMidiPaused) {
-         mMidiPaused = true;
-         AllNotesOff(); // to avoid hanging notes during pause
-      }
-   }
-   else if (mMidiPaused)
-      mMidiPaused = false;
+   // Keep track of time paused; the scheduler thread turns notes off
+   mPaused.store(paused, std::memory_order_relaxed);
 }
 
 unsigned MIDIPlay::CountOtherSolo() const
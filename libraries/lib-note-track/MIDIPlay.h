@@ -13,7 +13,9 @@ Paul Licameli split from AudIOBase.h
 #define __AUDACITY_MIDI_PLAY__
 
 #include "AudioIOExt.h"
+#include <atomic>
 #include <optional>
+#include <thread>
 #include "WrapAllegro.h"
 
 typedef void PmStream;
@@ -125,7 +127,8 @@ struct MIDIPlay : AudioIOExt
    /// Offset from ideal sample computation time to system time,
    /// where "ideal" means when we would get the callback if there
    /// were no scheduling delays or computation time
-   double mSystemMinusAudioTime = 0.0;
+   /// Written by the audio callback, read by the scheduler thread
+   std::atomic<double> mSystemMinusAudioTime{ 0.0 };
    /// audio output latency reported by PortAudio
    /// (initially; for Alsa, we adjust it to the largest "observed" value)
    double mAudioOutLatency = 0.0;
@@ -139,7 +142,20 @@ struct MIDIPlay : AudioIOExt
    /// number of callbacks since stream start
    long mCallbackCount = 0;
 
-   double mSystemMinusAudioTimePlusLatency = 0.0;
+   /// Written by the audio callback, read in MidiTime()
+   std::atomic<double> mSystemMinusAudioTimePlusLatency{ 0.0 };
+
+   // State of the audio callback, published for the scheduler thread
+   double mRate = 0.0;
+   std::atomic<unsigned long> mPauseFrames{ 0 };
+   std::atomic<bool> mPaused{ false };
+   std::atomic<bool> mHasSolo{ false };
+
+   /// Iterates the tracks and writes timestamped events to PortMidi, a short
+   /// time ahead of the system clock, at a period independent of the audio
+   /// buffer size
+   std::thread mScheduler;
+   std::atomic<bool> mStopScheduler{ false };
 
    std::optional<Iterator> mIterator;
 
@@ -149,6 +165,12 @@ struct MIDIPlay : AudioIOExt
 
    void PrepareMidiIterator(bool send, double startTime, double offset);
    bool StartPortMidiStream(double rate);
+   void StartScheduler();
+   void StopScheduler();
+   //! Body of the scheduler thread
+   void Schedule();
+   //! Output events due before the estimated audio write time, plus latencies
+   void OutputDueEvents();
    double PauseTime(double rate, unsigned long pauseFrames);
    void AllNotesOff(bool looping = false);
 
@@ -19,6 +19,9 @@
 #if defined(USE_MIDI)
 #include "WrapAllegro.h"
 
+#include <algorithm>
+#include <iterator>
+#include <limits>
 #include <sstream>
 
 #define ROUND(x) ((int) ((x) + 0.5))
@@ -155,6 +158,79 @@ NoteTrack::~NoteTrack()
 {
 }
 
+//! Notes sorted by start time, in seconds of the sequence
+/*!
+ Notes no longer than MaxShortDuration are searched from a start time that
+ much before the range; the few longer notes are searched from the beginning.
+ */
+struct NoteTrack::NoteIndex {
+   static constexpr double MaxShortDuration = 4.0;
+   using Entry = std::pair<double, Alg_note*>;
+   std::vector<Entry> shortNotes;
+   std::vector<Entry> longNotes;
+};
+
+void NoteTrack::InvalidateNoteIndex() const
+{
+   mpNoteIndex.reset();
+}
+
+std::vector<Alg_note*> NoteTrack::GetNotesInRange(double t0, double t1) const
+{
+   auto &seq = GetSeq();
+   seq.convert_to_seconds();
+   if (!mpNoteIndex) {
+      auto pIndex = std::make_unique<NoteIndex>();
+      Alg_iterator iterator(&seq, false);
+      iterator.begin();
+      while (const auto event = iterator.next()) {
+         if (!event->is_note())
+            continue;
+         const auto note = static_cast<Alg_note*>(event);
+         (note->dur <= NoteIndex::MaxShortDuration
+            ? pIndex->shortNotes : pIndex->longNotes)
+               .emplace_back(note->time, note);
+      }
+      iterator.end();
+      // The iterator merges tracks in time order already, but be sure
+      const auto compare = [](const auto &a, const auto &b){
+         return a.first < b.first; };
+      std::stable_sort(
+         pIndex->shortNotes.begin(), pIndex->shortNotes.end(), compare);
+      std::stable_sort(
+         pIndex->longNotes.begin(), pIndex->longNotes.end(), compare);
+      mpNoteIndex = std::move(pIndex);
+   }
+
+   t0 -= mOrigin;
+   t1 -= mOrigin;
+   const auto &index = *mpNoteIndex;
+   const auto startsBefore = [](const NoteIndex::Entry &entry, double time){
+      return entry.first < time; };
+   const auto collect = [&](const auto &entries, double from){
+      std::vector<Alg_note*> result;
+      const auto end = std::lower_bound(
+         entries.begin(), entries.end(), t1, startsBefore);
+      for (auto iter = std::lower_bound(
+              entries.begin(), end, from, startsBefore);
+           iter != end; ++iter)
+         if (iter->first + iter->second->dur > t0)
+            result.push_back(iter->second);
+      return result;
+   };
+   auto shortNotes = collect(index.shortNotes, t0 - NoteIndex::MaxShortDuration);
+   const auto longNotes =
+      collect(index.longNotes, -std::numeric_limits<double>::infinity());
+   if (longNotes.empty())
+      return shortNotes;
+   std::vector<Alg_note*> result;
+   result.reserve(shortNotes.size() + longNotes.size());
+   std::merge(shortNotes.begin(), shortNotes.end(),
+      longNotes.begin(), longNotes.end(), std::back_inserter(result),
+      [](const Alg_note *a, const Alg_note *b){ return a->time < b->time; });
+   return result;
+}
+
 Alg_seq &NoteTrack::GetSeq() const
 {
    if (!mSeq) {
@@ -221,6 +297,7 @@ void NoteTrack::WarpAndTransposeNotes(double t0, double t1,
                                       const TimeWarper &warper,
                                       double semitones)
 {
+   InvalidateNoteIndex();
    double offset = this->mOrigin; // track is shifted this amount
    auto &seq = GetSeq();
    seq.convert_to_seconds(); // make sure time units are right
@@ -255,6 +332,7 @@ void NoteTrack::WarpAndTransposeNotes(double t0, double t1,
 
 void NoteTrack::SetSequence(std::unique_ptr<Alg_seq> &&seq)
 {
+   InvalidateNoteIndex();
    mSeq = std::move(seq);
 }
 
@@ -319,6 +397,7 @@ void NoteTrack::PrintSequence()
 
 Track::Holder NoteTrack::Cut(double t0, double t1)
 {
+   InvalidateNoteIndex();
    if (t1 < t0)
       THROW_INCONSISTENCY_EXCEPTION;
 
@@ -372,6 +451,7 @@ Track::Holder NoteTrack::Copy(double t0, double t1, bool) const
 
 bool NoteTrack::Trim(double t0, double t1)
 {
+   InvalidateNoteIndex();
    if (t1 < t0)
       return false;
    auto &seq = GetSeq();
@@ -396,6 +476,7 @@ bool NoteTrack::Trim(double t0, double t1)
 
 void NoteTrack::Clear(double t0, double t1)
 {
+   InvalidateNoteIndex();
    if (t1 < t0)
       THROW_INCONSISTENCY_EXCEPTION;
 
@@ -429,6 +510,7 @@ void NoteTrack::Clear(double t0, double t1)
 
 void NoteTrack::Paste(double t, const Track &src)
 {
+   InvalidateNoteIndex();
    // Paste inserts src at time t. If src has a positive offset,
    // the offset is treated as silence which is also inserted. If
    // the offset is negative, the offset is ignored and the ENTIRE
@@ -479,6 +561,7 @@ void NoteTrack::Paste(double t, const Track &src)
 
 void NoteTrack::Silence(double t0, double t1, ProgressReporter)
 {
+   InvalidateNoteIndex();
    if (t1 < t0)
       THROW_INCONSISTENCY_EXCEPTION;
 
@@ -494,6 +577,7 @@ void NoteTrack::Silence(double t0, double t1, ProgressReporter)
 
 void NoteTrack::InsertSilence(double t, double len)
 {
+   InvalidateNoteIndex();
    if (len < 0)
       THROW_INCONSISTENCY_EXCEPTION;
 
@@ -522,6 +606,7 @@ void NoteTrack::DoSetVelocity(float velocity)
 // NOT the function that handles horizontal dragging.
 bool NoteTrack::Shift(double t) // t is always seconds
 {
+   InvalidateNoteIndex();
    if (t > 0) {
       auto &seq = GetSeq();
       // insert an even number of measures
@@ -601,6 +686,7 @@ NoteTrack::DoGetInterval(size_t iInterval)
 
 void NoteTrack::AddToDuration( double delta )
 {
+   InvalidateNoteIndex();
    auto &seq = GetSeq();
 #if 0
    // PRL:  Would this be better ?
@@ -614,6 +700,7 @@ void NoteTrack::AddToDuration( double delta )
 bool NoteTrack::StretchRegion
    ( QuantizedTimeAndBeat t0, QuantizedTimeAndBeat t1, double newDur )
 {
+   InvalidateNoteIndex();
    auto &seq = GetSeq();
    bool result = seq.stretch_region( t0.second, t1.second, newDur );
    if (result) {
@@ -833,6 +920,7 @@ bool NoteTrack::HandleXMLTag(const std::string_view& tag, const AttributesList &
              std::string s(value.ToWString());
              std::istringstream data(s);
              mSeq = std::make_unique<Alg_seq>(data, false);
+             InvalidateNoteIndex();
          }
       } // while
       return true;
@@ -12,6 +12,7 @@
 #define __AUDACITY_NOTETRACK__
 
 #include <utility>
+#include <vector>
 #include "AudioIOSequences.h"
 #include "CRTPBase.h"
 #include "Prefs.h"
@@ -45,6 +46,7 @@ SONFNS(AutoSave)
 class wxDC;
 class wxRect;
 
+class Alg_note;  // from "allegro.h"
 class Alg_seq;   // from "allegro.h"
 
 using QuantizedTimeAndBeat = std::pair< double, double >;
@@ -99,6 +101,17 @@ public:
 
    Alg_seq &GetSeq() const;
 
+   //! Notes sounding at any time in [t0, t1), in order of start time
+   /*!
+    Times are of the track, including its offset.  An index of the notes by
+    time makes this cost proportional to the notes found, not to all notes
+    of the sequence.
+    */
+   std::vector<Alg_note*> GetNotesInRange(double t0, double t1) const;
+
+   //! Call after changing the sequence through GetSeq() directly
+   void InvalidateNoteIndex() const;
+
    void WarpAndTransposeNotes(double t0, double t1,
                               const TimeWarper &warper, double semitones);
 
@@ -208,6 +221,10 @@ private:
    mutable std::unique_ptr<char[]> mSerializationBuffer;
    mutable long mSerializationLength;
 
+   struct NoteIndex;
+   //! Built on demand, and reset by editing
+   mutable std::unique_ptr<NoteIndex> mpNoteIndex;
+
    //! Atomic because it may be read by worker threads in playback
    std::atomic<float> mVelocity{ 0.0f }; // velocity offset
 
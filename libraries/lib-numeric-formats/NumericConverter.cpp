@@ -80,11 +80,17 @@ void NumericConverter::ValueToControls(double rawValue, bool nearest /* = true *
    if (!mFormatter)
       return;
 
+   // The string may also have been edited since it was formatted
+   if (mFormatted && mFormatted->rawValue == rawValue &&
+       mFormatted->nearest == nearest && mFormatted->valueString == mValueString)
+      return;
+
    UpdateFormatToFit(rawValue);
    auto result = mFormatter->ValueToString(rawValue, nearest);
 
    mValueString = std::move(result.valueString);
    mFieldValueStrings = std::move(result.fieldValueStrings);
+   mFormatted = Memo{ rawValue, nearest, mValueString };
 }
 
 void NumericConverter::ControlsToValue()
@@ -95,7 +101,9 @@ void NumericConverter::ControlsToValue()
       return;
    }
 
-   auto result = mFormatter->StringToValue(mValueString);
+   if (!mParsed || mParsed->first != mValueString)
+      mParsed.emplace(mValueString, mFormatter->StringToValue(mValueString));
+   const auto &result = mParsed->second;
 
    mValue = result.has_value() ?
                std::clamp(*result, mMinValue, mMaxValue) :
@@ -229,6 +237,9 @@ void NumericConverter::Decrement(int focusedDigit)
 
 bool NumericConverter::UpdateFormatter()
 {
+   mFormatted.reset();
+   mParsed.reset();
+
    if (!mFormatID.empty())
    {
       auto formatterItem = NumericConverterRegistry::Find(mContext, mType, mFormatID);
@@ -261,9 +272,12 @@ bool NumericConverter::UpdateFormatter()
 
 void NumericConverter::OnFormatUpdated(bool)
 {
+   mFormatted.reset();
+   mParsed.reset();
+
    if (!mFormatter)
       return;
-   
+
    ValueToControls();
    ControlsToValue();
 }
@@ -18,6 +18,8 @@
 
 #include <memory>
 #include <numeric>
+#include <optional>
+#include <utility>
 
 #include "NumericConverterType.h"
 #include "NumericConverterFormatter.h"
@@ -107,5 +109,17 @@ protected:
 
 private:
    int GetSafeFocusedDigit(int focusedDigit) const noexcept;
+
+   //! Last results of the formatter, reused while the value, the string and
+   //! the format are unchanged, as when each repaint sets the same time again
+   struct Memo {
+      double rawValue;
+      bool nearest;
+      //! Formatted from rawValue
+      wxString valueString;
+   };
+   std::optional<Memo> mFormatted;
+   //! Last string parsed, and the result
+   std::optional<std::pair<wxString, std::optional<double>>> mParsed;
 };
 #endif // __AUDACITY_NUMERIC_CONVERTER__
@@ -13,6 +13,7 @@
 
 #include "formatters/ParsedNumericConverterFormatter.h"
 #include "formatters/BeatsNumericConverterFormatter.h"
+#include "NumericConverter.h"
 #include "NumericConverterFormatterContext.h"
 
 #include "Project.h"
@@ -68,6 +69,32 @@ TEST_CASE("ParsedNumericConverterFormatter", "")
 }
 
 
+TEST_CASE("NumericConverter", "")
+{
+   NumericConverter converter{ FormatterContext::SampleRateContext(44100.0),
+      NumericConverterType_TIME() };
+   converter.SetCustomFormat(Verbatim("0100 h 060 m 060 s"));
+
+   converter.SetValue(30.0);
+   REQUIRE(converter.GetString() == "00 h 00 m 30 s");
+   REQUIRE(converter.GetValue() == Approx(30.0));
+
+   // The same value again, as repainting does
+   converter.SetValue(30.0);
+   REQUIRE(converter.GetString() == "00 h 00 m 30 s");
+
+   converter.SetValue(80.0);
+   REQUIRE(converter.GetString() == "00 h 01 m 20 s");
+   REQUIRE(converter.GetValue() == Approx(80.0));
+
+   // A change of format is not hidden by the values last formatted
+   converter.SetCustomFormat(Verbatim("0100 h 060 m"));
+   REQUIRE(converter.GetString() == "00 h 01 m");
+   converter.SetValue(80.0);
+   REQUIRE(converter.GetString() == "00 h 01 m");
+   REQUIRE(converter.GetValue() == Approx(60.0));
+}
+
 TEST_CASE("BeatsNumericConverterFormatter", "")
 {
    MockedPrefs mockedPrefs;
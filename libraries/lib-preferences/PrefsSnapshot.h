@@ -0,0 +1,68 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file PrefsSnapshot.h
+  @brief A typed copy of preference values, refreshed when preferences change
+
+**********************************************************************/
+
+#ifndef __AUDACITY_PREFS_SNAPSHOT__
+#define __AUDACITY_PREFS_SNAPSHOT__
+
+#include "Observer.h"
+#include "Prefs.h"
+
+#include <functional>
+
+//! A typed copy of some preference values, for code that reads them often
+/*!
+ A reader function fills the structure from preferences at construction,
+ and again after PrefsListener::Broadcast() with no id or with the id given
+ to the constructor.  Readers then see plain fields instead of string-keyed
+ lookups in the configuration.  Subscribers are notified after each refresh.
+
+ Construct, refresh and read it in the main thread only.
+ */
+template<typename Values>
+class PrefsSnapshot final
+   : public PrefsListener
+   , public Observer::Publisher<Values>
+{
+public:
+   using Reader = std::function<void(Values &)>;
+
+   //! @param id for changes of only these preferences; 0 for none
+   explicit PrefsSnapshot(Reader reader, int id = 0)
+      : mReader{ std::move(reader) }
+      , mID{ id }
+   {
+      Refresh();
+   }
+
+   const Values &Get() const noexcept { return mValues; }
+   int GetID() const noexcept { return mID; }
+
+   //! Read the preferences now, and notify subscribers
+   void Refresh()
+   {
+      Values values{};
+      mReader(values);
+      mValues = values;
+      this->Publish(mValues);
+   }
+
+private:
+   void UpdatePrefs() override { Refresh(); }
+   void UpdateSelectedPrefs(int id) override
+   {
+      if (mID > 0 && id == mID)
+         Refresh();
+   }
+
+   const Reader mReader;
+   const int mID;
+   Values mValues{};
+};
+
+#endif
@@ -0,0 +1,247 @@
+/*!********************************************************************
+
+Audacity: A Digital Audio Editor
+
+@file CompactUndoTracks.cpp
+
+**********************************************************************/
+
+#include "CompactUndoTracks.h"
+
+#include <wx/mstream.h>
+#include <wx/zstream.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+#include "AudacityException.h"
+#include "BufferedStreamReader.h"
+#include "MemoryBudget.h"
+#include "PendingTracks.h"
+#include "Project.h"
+#include "ProjectSerializer.h"
+#include "SampleBlock.h"
+#include "Track.h"
+#include "UndoManager.h"
+#include "UndoTracks.h"
+
+namespace {
+
+const auto Tracks_tag = "undotracks";
+
+//! Of all compact states; these can't be evicted, but are shown with the
+//! caches
+std::atomic<size_t> sBytes{ 0 };
+
+MemoryBudget::Consumer sConsumer{ "Compact undo states", 100,
+   []{ return sBytes.load(); } };
+
+//! Reads the dictionary, then the inflated document
+class BytesReader final : public BufferedStreamReader
+{
+public:
+   explicit BytesReader(MemoryStream::StreamData bytes)
+      : BufferedStreamReader(32 * 1024)
+      , mBytes{ std::move(bytes) }
+   {
+   }
+
+protected:
+   bool HasMoreData() const override
+   {
+      return mOffset < mBytes.size();
+   }
+
+   size_t ReadData(void* buffer, size_t maxBytes) override
+   {
+      const auto count = std::min(maxBytes, mBytes.size() - mOffset);
+      memcpy(buffer, mBytes.data() + mOffset, count);
+      mOffset += count;
+      return count;
+   }
+
+private:
+   const MemoryStream::StreamData mBytes;
+   size_t mOffset{ 0 };
+};
+
+//! Adds the decoded tracks to the project, as loading of a project does
+class TracksReader final : public XMLTagHandler
+{
+public:
+   explicit TracksReader(AudacityProject &project)
+      : mProject{ project }
+   {
+   }
+
+   bool HandleXMLTag(
+      const std::string_view& tag, const AttributesList &) override
+   {
+      return tag == Tracks_tag;
+   }
+
+   XMLTagHandler *HandleXMLChild(const std::string_view& tag) override
+   {
+      return ProjectFileIORegistry::Get().CallObjectAccessor(tag, mProject);
+   }
+
+private:
+   AudacityProject &mProject;
+};
+
+struct CompactTracks final : UndoStateExtension
+{
+   explicit CompactTracks(const TrackList &tracks)
+   {
+      // ProjectSerializer does not throw
+      ProjectSerializer serializer;
+      serializer.StartTag(Tracks_tag);
+      for (auto pTrack : tracks)
+         pTrack->WriteXML(serializer);
+      serializer.EndTag(Tracks_tag);
+
+      // Deflate fast; states are compacted as they are pushed
+      wxMemoryOutputStream memory;
+      {
+         wxZlibOutputStream zlib{ memory, wxZ_BEST_SPEED, wxZLIB_NO_HEADER };
+         for (const auto &[data, size] : serializer.GetData()) {
+            zlib.Write(data, size);
+            mInflatedSize += size;
+         }
+         zlib.Close();
+      }
+      mDeflated.resize(memory.GetLength());
+      memory.CopyTo(mDeflated.data(), mDeflated.size());
+
+      // Hold the blocks that the copies held, but each once
+      WaveTrackUtilities::SampleBlockIDSet seen;
+      WaveTrackUtilities::InspectBlocks(tracks,
+         [this](SampleBlockConstPtr pBlock){
+            if (pBlock->GetBlockID() > 0)
+               mBlocks.push_back(std::move(pBlock));
+         },
+         &seen);
+      mBlocks.shrink_to_fit();
+      sBytes += GetMemory();
+   }
+
+   ~CompactTracks() override
+   {
+      sBytes -= GetMemory();
+   }
+
+   void RestoreUndoRedoState(AudacityProject &project) override
+   {
+      auto &tracks = TrackList::Get(project);
+      std::vector<Track::Holder> oldTracks;
+      for (auto pTrack : tracks)
+         oldTracks.push_back(pTrack->SharedPointer());
+
+      // Append the decoded tracks, then remove the others; or remove the
+      // decoded tracks, on failure
+      try {
+         TracksReader reader{ project };
+         BytesReader stream{ Inflate() };
+         if (!ProjectSerializer::Decode(stream, &reader))
+            throw SimpleMessageBoxException{
+               ExceptionType::Internal,
+               XO("Unable to restore the tracks of the undo history state."),
+               XO("Warning")
+            };
+      }
+      catch (...) {
+         std::vector<Track::Holder> newTracks;
+         for (auto pTrack : tracks)
+            if (std::find(oldTracks.begin(), oldTracks.end(),
+               pTrack->SharedPointer()) == oldTracks.end())
+               newTracks.push_back(pTrack->SharedPointer());
+         for (auto &pTrack : newTracks)
+            tracks.Remove(*pTrack);
+         throw;
+      }
+      for (auto &pTrack : oldTracks)
+         tracks.Remove(*pTrack);
+
+      // Make wide tracks of the channels of stereo tracks, as loading does.
+      // Beware iterator invalidation, because stereo channels get zipped,
+      // replacing WaveTracks
+      for (auto iter = tracks.begin(); iter != tracks.end();) {
+         auto pTrack = (*iter++)->SharedPointer();
+         pTrack->LinkConsistencyFix();
+      }
+   }
+
+   bool CanUndoOrRedo(const AudacityProject &project) override
+   {
+      return !PendingTracks::Get(project).HasPendingTracks();
+   }
+
+   bool IsCompact() const override { return true; }
+
+   MemoryStream::StreamData Inflate() const
+   {
+      // Names in the document refer to the dictionary, which only grows
+      auto bytes = ProjectSerializer::CopyDict();
+      const auto dictSize = bytes.size();
+      bytes.resize(dictSize + mInflatedSize);
+      wxMemoryInputStream memory{ mDeflated.data(), mDeflated.size() };
+      wxZlibInputStream zlib{ memory, wxZLIB_NO_HEADER };
+      zlib.Read(bytes.data() + dictSize, mInflatedSize);
+      if (zlib.LastRead() != mInflatedSize)
+         bytes.resize(dictSize + zlib.LastRead());
+      return bytes;
+   }
+
+   size_t GetMemory() const
+   {
+      return sizeof(*this) + mDeflated.capacity() +
+         mBlocks.capacity() * sizeof(SampleBlockConstPtr);
+   }
+
+   MemoryStream::StreamData mDeflated;
+   size_t mInflatedSize{ 0 };
+   std::vector<SampleBlockConstPtr> mBlocks;
+};
+
+const CompactTracks *FindCompact(const UndoStackElem &state)
+{
+   for (auto &pExtension : state.state.extensions)
+      if (auto pCompact = dynamic_cast<const CompactTracks*>(pExtension.get()))
+         return pCompact;
+   return nullptr;
+}
+
+UndoTracks::Compactor::Scope scope{
+   [](AudacityProject &, const TrackList &tracks)
+      -> std::shared_ptr<UndoStateExtension>
+   {
+      if (tracks.empty())
+         return nullptr;
+      return std::make_shared<CompactTracks>(tracks);
+   }
+};
+
+}
+
+void CompactUndoTracks::InspectBlocks(const UndoStackElem &state,
+   WaveTrackUtilities::BlockInspector inspector,
+   WaveTrackUtilities::SampleBlockIDSet *pIDs)
+{
+   if (auto pTracks = UndoTracks::Find(state))
+      WaveTrackUtilities::InspectBlocks(*pTracks, std::move(inspector), pIDs);
+   else if (auto pCompact = FindCompact(state))
+      for (auto &pBlock : pCompact->mBlocks) {
+         if (pIDs && !pIDs->insert(pBlock->GetBlockID()).second)
+            continue;
+         if (inspector)
+            inspector(pBlock);
+      }
+}
+
+size_t CompactUndoTracks::GetMemory(const UndoStackElem &state)
+{
+   if (auto pCompact = FindCompact(state))
+      return pCompact->GetMemory();
+   return 0;
+}
@@ -0,0 +1,45 @@
+/*!********************************************************************
+
+Audacity: A Digital Audio Editor
+
+@file CompactUndoTracks.h
+@brief Tracks of states of undo history, far from the current state, encoded
+in less memory
+
+**********************************************************************/
+
+#ifndef __AUDACITY_COMPACT_UNDO_TRACKS__
+#define __AUDACITY_COMPACT_UNDO_TRACKS__
+
+#include "WaveTrackUtilities.h"
+
+struct UndoStackElem;
+
+//! Replaces the copies of tracks in old undo states with deflated encodings
+/*!
+ Tracks are encoded as the project file encodes them, and decoded into the
+ project again when the state is restored, as when a project loads.  A
+ compact state holds each of its sample blocks once, so that the blocks live
+ as long as the state.
+
+ UndoTracks::Find() gives null for compact states; use these functions
+ instead, to visit the sample blocks of any state.
+ */
+namespace CompactUndoTracks {
+
+//! Visit the sample blocks of the tracks of a state, compact or not
+/*!
+ Like WaveTrackUtilities::InspectBlocks(), skips blocks with ids in the set,
+ and adds the ids of those visited.  Silent blocks of compact states are not
+ visited.
+ */
+PROJECT_FILE_IO_API void InspectBlocks(const UndoStackElem &state,
+   WaveTrackUtilities::BlockInspector inspector,
+   WaveTrackUtilities::SampleBlockIDSet *pIDs = nullptr);
+
+//! Bytes held by the compact tracks of a state, or 0 if it has none
+PROJECT_FILE_IO_API size_t GetMemory(const UndoStackElem &state);
+
+}
+
+#endif
@@ -13,6 +13,9 @@ Paul Licameli -- split from ProjectFileIO.cpp
 
 #include "sqlite3.h"
 
+#include <algorithm>
+#include <chrono>
+
 #include <wx/string.h>
 
 #include "AudacityLogger.h"
@@ -23,6 +26,8 @@ Paul Licameli -- split from ProjectFileIO.cpp
 #include "FileException.h"
 #include "wxFileNameWrapper.h"
 #include "SentryHelper.h"
+#include "Tracing.h"
+#include "concurrency/ThreadPool.h"
 
 #define AUDACITY_PROJECT_PAGE_SIZE 65536
 
@@ -34,12 +39,22 @@ static const char* PageSizeConfig =
    "VACUUM;";
 
 // Configuration to provide "safe" connections
+// The checkpoint thread copies the WAL in steps; when the WAL restarts, it is
+// truncated to the limit, so that it does not keep its greatest size
 static const char* SafeConfig =
    "PRAGMA <schema>.busy_timeout = 5000;"
    "PRAGMA <schema>.locking_mode = SHARED;"
    "PRAGMA <schema>.synchronous = NORMAL;"
    "PRAGMA <schema>.journal_mode = WAL;"
-   "PRAGMA <schema>.wal_autocheckpoint = 0;";
+   "PRAGMA <schema>.wal_autocheckpoint = 0;"
+   "PRAGMA <schema>.journal_size_limit = 67108864;";
+
+// Configuration for connections that only read, as when reviewing a
+// finished project; larger files leave the rest to the page cache
+static const char *ReadOnlyConfig =
+   "PRAGMA <schema>.busy_timeout = 5000;"
+   "PRAGMA <schema>.query_only = ON;"
+   "PRAGMA <schema>.mmap_size = 2147483648;";
 
 // Configuration to provide "Fast" connections
 static const char *FastConfig =
@@ -48,6 +63,41 @@ static const char *FastConfig =
    "PRAGMA <schema>.synchronous = OFF;"
    "PRAGMA <schema>.journal_mode = OFF;";
 
+namespace {
+//! Rows of sampleblocks deleted by each update queued for the writer thread
+constexpr size_t DeletionsPerStep = 64;
+
+//! Delete some rows of sampleblocks, all or none
+/*! @return SQLITE_OK, or else the error, after rolling back */
+int DeleteSampleBlockRows(sqlite3 *db, const std::vector<int64_t> &ids)
+{
+   // A savepoint, which may be nested in a transaction already open
+   int rc = sqlite3_exec(db, "SAVEPOINT DeleteBlocks;",
+      nullptr, nullptr, nullptr);
+   if (rc != SQLITE_OK)
+      return rc;
+
+   sqlite3_stmt *stmt = nullptr;
+   rc = sqlite3_prepare_v2(db,
+      "DELETE FROM sampleblocks WHERE blockid = ?1;", -1, &stmt, nullptr);
+   for (auto iter = ids.begin(); rc == SQLITE_OK && iter != ids.end(); ++iter)
+   {
+      sqlite3_bind_int64(stmt, 1, *iter);
+      rc = sqlite3_step(stmt);
+      if (rc == SQLITE_DONE)
+         rc = SQLITE_OK;
+      sqlite3_reset(stmt);
+   }
+   sqlite3_finalize(stmt);
+
+   if (rc != SQLITE_OK)
+      sqlite3_exec(db, "ROLLBACK TO DeleteBlocks;", nullptr, nullptr, nullptr);
+   const int releaseRc = sqlite3_exec(db, "RELEASE DeleteBlocks;",
+      nullptr, nullptr, nullptr);
+   return rc != SQLITE_OK ? rc : releaseRc;
+}
+}
+
 DBConnection::DBConnection(
    const std::weak_ptr<AudacityProject> &pProject,
    const std::shared_ptr<DBConnectionErrors> &pErrors,
@@ -81,6 +131,395 @@ bool DBConnection::ShouldBypass()
    return mBypass;
 }
 
+void DBConnection::WriteInBackground(BackgroundWrite write)
+{
+   if (!mBackgroundDB)
+   {
+      // Open the second connection on first use
+      const char *name = sqlite3_db_filename(mDB, "main");
+      sqlite3 *db = nullptr;
+      int rc = sqlite3_open(name, &db);
+      if (rc == SQLITE_OK)
+         rc = ModeConfig(db, "main", SafeConfig);
+      if (rc != SQLITE_OK)
+      {
+         ADD_EXCEPTION_CONTEXT("sqlite3.rc", std::to_string(rc));
+         ADD_EXCEPTION_CONTEXT(
+            "sqlite3.context", "DBConnection::WriteInBackground::open");
+
+         wxLogMessage("Failed to open background connection to %s: %d, %s\n",
+            name,
+            rc,
+            sqlite3_errstr(rc));
+         sqlite3_close(db);
+
+         // Write in this thread instead, after the updates submitted before
+         WaitForBackgroundWrite();
+         write(mDB);
+         return;
+      }
+
+      // Commits on this connection grow the WAL too
+      sqlite3_wal_hook(db, CheckpointHook, this);
+
+      mBackgroundDB = db;
+   }
+
+   std::lock_guard<std::mutex> guard(mWriterMutex);
+   StartWriter();
+   // Drop the update this one supersedes
+   for (auto iter = mWrites.begin(); iter != mWrites.end();)
+   {
+      if (iter->background)
+      {
+         iter->promise.set_value(SQLITE_OK);
+         iter = mWrites.erase(iter);
+      }
+      else
+         ++iter;
+   }
+   mWrites.emplace_back().background = std::move(write);
+   mWriterCondition.notify_all();
+}
+
+std::shared_future<int> DBConnection::SubmitWrite(Write write)
+{
+   std::lock_guard<std::mutex> guard(mWriterMutex);
+   StartWriter();
+   auto &queued = mWrites.emplace_back();
+   queued.write = std::move(write);
+   auto result = queued.promise.get_future().share();
+   mWriterCondition.notify_all();
+   return result;
+}
+
+int DBConnection::GetWriteError() const
+{
+   return mWriteError;
+}
+
+std::unique_lock<std::mutex> DBConnection::PauseWriter()
+{
+   WaitForBackgroundWrite();
+   return std::unique_lock<std::mutex>{ mGroupMutex };
+}
+
+int64_t DBConnection::ReserveBlockID()
+{
+   std::lock_guard<std::mutex> guard(mBlockIDMutex);
+   if (mNextBlockID == 0)
+   {
+      // Continue after the greatest id ever used in the file, as
+      // AUTOINCREMENT would, so that ids of deleted blocks are not reused
+      // in a later session; explicit ids also advance sqlite_sequence
+      sqlite3_stmt *stmt = nullptr;
+      int rc = sqlite3_prepare_v2(mDB,
+         "SELECT max("
+         "coalesce((SELECT seq FROM sqlite_sequence"
+         " WHERE name = 'sampleblocks'), 0),"
+         "coalesce((SELECT max(blockid) FROM sampleblocks), 0));",
+         -1, &stmt, nullptr);
+      if (rc == SQLITE_OK)
+         rc = sqlite3_step(stmt);
+      const auto maxID =
+         rc == SQLITE_ROW ? sqlite3_column_int64(stmt, 0) : 0;
+      sqlite3_finalize(stmt);
+      if (rc != SQLITE_ROW)
+      {
+         ADD_EXCEPTION_CONTEXT("sqlite3.rc", std::to_string(rc));
+         ADD_EXCEPTION_CONTEXT("sqlite3.context", "DBConnection::ReserveBlockID");
+         ThrowException(false);
+      }
+      mNextBlockID = std::max<int64_t>(maxID, 0) + 1;
+   }
+   return mNextBlockID++;
+}
+
+void DBConnection::PrefetchSampleBlocks()
+{
+   EndPrefetch();
+
+   std::string name = sqlite3_db_filename(mDB, "main");
+   std::lock_guard<std::mutex> guard(mPrefetchMutex);
+   // One scan rather than one query for each block; on its own connection,
+   // so that decoding in this thread need not wait for it
+   mPrefetchFuture = audacity::concurrency::ThreadPool::GetDefault().Async(
+      [name = std::move(name)]
+   {
+      SampleBlockInfos result;
+      sqlite3 *db = nullptr;
+      sqlite3_stmt *stmt = nullptr;
+      if (sqlite3_open_v2(name.c_str(), &db, SQLITE_OPEN_READONLY, nullptr)
+             == SQLITE_OK &&
+          sqlite3_prepare_v2(db,
+             "SELECT blockid, sampleformat, summin, summax, sumrms,"
+             "       length(samples),"
+             "       length(blockid) + length(sampleformat) +"
+             "       length(summin) + length(summax) + length(sumrms) +"
+             "       length(summary256) + length(summary64k) +"
+             "       length(samples)"
+             "  FROM sampleblocks;", -1, &stmt, nullptr) == SQLITE_OK)
+      {
+         // Rows before any error are still good
+         while (sqlite3_step(stmt) == SQLITE_ROW)
+            result[sqlite3_column_int64(stmt, 0)] = {
+               sqlite3_column_int(stmt, 1),
+               sqlite3_column_double(stmt, 2),
+               sqlite3_column_double(stmt, 3),
+               sqlite3_column_double(stmt, 4),
+               sqlite3_column_int(stmt, 5),
+               sqlite3_column_int64(stmt, 6) };
+      }
+      sqlite3_finalize(stmt);
+      sqlite3_close(db);
+      return result;
+   });
+}
+
+bool DBConnection::FindPrefetchedSampleBlock(
+   int64_t id, SampleBlockInfo &info)
+{
+   std::lock_guard<std::mutex> guard(mPrefetchMutex);
+   if (mPrefetchFuture.valid())
+      mPrefetched = mPrefetchFuture.get();
+   const auto iter = mPrefetched.find(id);
+   if (iter == mPrefetched.end())
+      return false;
+   info = iter->second;
+   return true;
+}
+
+void DBConnection::EndPrefetch()
+{
+   std::lock_guard<std::mutex> guard(mPrefetchMutex);
+   if (mPrefetchFuture.valid())
+      mPrefetchFuture.wait();
+   mPrefetchFuture = {};
+   SampleBlockInfos{}.swap(mPrefetched);
+}
+
+bool DBConnection::GetPrefetchedBlockIDs(std::vector<int64_t> &ids)
+{
+   std::lock_guard<std::mutex> guard(mPrefetchMutex);
+   if (mPrefetchFuture.valid())
+      mPrefetched = mPrefetchFuture.get();
+   ids.clear();
+   ids.reserve(mPrefetched.size());
+   for (const auto &[id, info] : mPrefetched)
+      ids.push_back(id);
+   return !ids.empty();
+}
+
+void DBConnection::AddSpaceUsage(int64_t delta)
+{
+   std::lock_guard<std::mutex> guard(mSpaceUsageMutex);
+   if (mSpaceUsage)
+      *mSpaceUsage += delta;
+}
+
+std::optional<int64_t> DBConnection::GetSpaceUsage() const
+{
+   std::lock_guard<std::mutex> guard(mSpaceUsageMutex);
+   return mSpaceUsage;
+}
+
+void DBConnection::SetSpaceUsage(std::optional<int64_t> usage)
+{
+   std::lock_guard<std::mutex> guard(mSpaceUsageMutex);
+   mSpaceUsage = usage;
+}
+
+void DBConnection::DeleteInBackground(std::vector<int64_t> blockIDs)
+{
+   if (blockIDs.empty() || mReadOnly || !mDB)
+      return;
+
+   // Delete on the primary connection, as its other updates are made, so
+   // that no other connection commits while a transaction of it is open;
+   // a few rows in each update, so that others may be queued between
+   for (size_t first = 0; first < blockIDs.size(); first += DeletionsPerStep)
+   {
+      const auto last = std::min(blockIDs.size(), first + DeletionsPerStep);
+      SubmitWrite([ids = std::vector<int64_t>(
+         blockIDs.begin() + first, blockIDs.begin() + last)](sqlite3 *db)
+      {
+         TRACE_SCOPE("Delete sample blocks");
+         const int rc = DeleteSampleBlockRows(db, ids);
+         if (rc != SQLITE_OK)
+            wxLogMessage("Failed to delete sample blocks in %s: %d, %s\n",
+               sqlite3_db_filename(db, nullptr),
+               rc,
+               sqlite3_errstr(rc));
+         // The rows remain as orphans, which are deleted when the project is
+         // next opened; that is no failure to write
+         return SQLITE_OK;
+      });
+   }
+}
+
+void DBConnection::WaitForBackgroundWrite()
+{
+   std::unique_lock<std::mutex> lock(mWriterMutex);
+   mWriterCondition.wait(lock, [this]{
+      return mWrites.empty() && !mWriterActive;
+   });
+}
+
+bool DBConnection::InTransaction()
+{
+   return mDB && !sqlite3_get_autocommit(mDB);
+}
+
+void DBConnection::StartWriter()
+{
+   // mWriterMutex is held
+   if (mWriterThread.joinable())
+      return;
+   mWriterStop = false;
+   mWriterThread = std::thread([this]{ WriterThread(); });
+}
+
+void DBConnection::WriterThread()
+{
+   Tracing::RegisterThread("Writer");
+   std::unique_lock<std::mutex> lock(mWriterMutex);
+   while (true)
+   {
+      // Wait for work or the stop signal; finish pending work first
+      mWriterCondition.wait(lock, [this]{
+         return !mWrites.empty() || mWriterStop;
+      });
+      if (mWrites.empty())
+         break;
+
+      // Take one document, or else the updates waiting before the next
+      // one, so that more arrive while these are written
+      std::vector<QueuedWrite> group;
+      do {
+         group.push_back(std::move(mWrites.front()));
+         mWrites.pop_front();
+      } while (!group.front().background && !mWrites.empty() &&
+         !mWrites.front().background && group.size() < mGroupLimit);
+      mWriterActive = true;
+      lock.unlock();
+
+      if (auto &background = group.front().background)
+      {
+         TRACE_SCOPE("Background write");
+         background(mBackgroundDB);
+         group.front().promise.set_value(SQLITE_OK);
+      }
+      else
+      {
+         TRACE_SCOPE("Write group");
+         RunGroup(group);
+      }
+
+      lock.lock();
+      mWriterActive = false;
+      mWriterCondition.notify_all();
+   }
+}
+
+void DBConnection::RunGroup(std::vector<QueuedWrite> &group)
+{
+   std::lock_guard<std::mutex> guard(mGroupMutex);
+   int rc = mDB ? SQLITE_OK : SQLITE_MISUSE;
+
+   // Commit the group at once, unless a transaction of the primary
+   // connection is open, which it then joins
+   const bool own = rc == SQLITE_OK && group.size() > 1 &&
+      mSavepointDepth == 0 && sqlite3_get_autocommit(mDB);
+   if (own)
+      rc = sqlite3_exec(mDB, "SAVEPOINT WriteGroup;",
+         nullptr, nullptr, nullptr);
+
+   std::vector<int> results;
+   results.reserve(group.size());
+   for (auto &queued : group)
+      results.push_back(rc == SQLITE_OK ? queued.write(mDB) : rc);
+
+   if (own && rc == SQLITE_OK)
+   {
+      rc = sqlite3_exec(mDB, "RELEASE WriteGroup;", nullptr, nullptr, nullptr);
+      if (rc != SQLITE_OK)
+         sqlite3_exec(mDB, "ROLLBACK TO WriteGroup; RELEASE WriteGroup;",
+            nullptr, nullptr, nullptr);
+   }
+
+   for (size_t ii = 0; ii < group.size(); ++ii)
+   {
+      const auto result = rc == SQLITE_OK ? results[ii] : rc;
+      if (result != SQLITE_OK)
+      {
+         wxLogMessage("Failed to write to %s: %d, %s\n",
+            mDB ? sqlite3_db_filename(mDB, nullptr) : "",
+            result,
+            sqlite3_errstr(result));
+         int expected = SQLITE_OK;
+         mWriteError.compare_exchange_strong(expected, result);
+      }
+      group[ii].promise.set_value(result);
+   }
+}
+
+void DBConnection::StopBackgroundWrites()
+{
+   {
+      std::lock_guard<std::mutex> guard(mWriterMutex);
+      mWriterStop = true;
+      mWriterCondition.notify_all();
+   }
+   if (mWriterThread.joinable())
+      mWriterThread.join();
+
+   if (!mBackgroundDB)
+      return;
+   sqlite3_wal_hook(mBackgroundDB, nullptr, nullptr);
+   int rc = sqlite3_close(mBackgroundDB);
+   if (rc != SQLITE_OK)
+   {
+      ADD_EXCEPTION_CONTEXT("sqlite3.rc", std::to_string(rc));
+      ADD_EXCEPTION_CONTEXT("sqlite3.context", "DBConnection::Close::close_background");
+
+      wxLogMessage("Failed to close background connection for %s\n"
+                   "\tError: %s\n",
+                   sqlite3_db_filename(mBackgroundDB, nullptr),
+                   sqlite3_errmsg(mBackgroundDB));
+   }
+   mBackgroundDB = nullptr;
+}
+
+void DBConnection::BeginBulkWrite(size_t rowsPerTransaction)
+{
+   std::lock_guard<std::mutex> guard(mWriterMutex);
+   if (mBulkDepth++ == 0)
+      // Nested scopes share the outer limit
+      mGroupLimit = std::max<size_t>(1, rowsPerTransaction);
+}
+
+void DBConnection::EndBulkWrite()
+{
+   std::lock_guard<std::mutex> guard(mWriterMutex);
+   wxASSERT(mBulkDepth > 0);
+   if (mBulkDepth > 0 && --mBulkDepth == 0)
+      mGroupLimit = DefaultGroupLimit;
+}
+
+BulkWriteScope::BulkWriteScope(
+   AudacityProject &project, size_t rowsPerTransaction)
+   : mpConnection{ ConnectionPtr::Get(project).mpConnection.get() }
+{
+   if (mpConnection)
+      mpConnection->BeginBulkWrite(rowsPerTransaction);
+}
+
+BulkWriteScope::~BulkWriteScope()
+{
+   if (mpConnection)
+      mpConnection->EndBulkWrite();
+}
+
 void DBConnection::SetError(
    const TranslatableString &msg, const TranslatableString &libraryError, int errorCode)
 {
@@ -139,16 +578,25 @@ void DBConnection::SetDBError(
    }
 }
 
-int DBConnection::Open(const FilePath fileName)
+int DBConnection::Open(const FilePath fileName, bool readOnly)
 {
    wxASSERT(mDB == nullptr);
    int rc;
 
+   mReadOnly = readOnly;
+   // Nothing will be written, so nothing need be deleted
+   mBypass = mBypass || readOnly;
+
    // Initialize checkpoint controls
    mCheckpointStop = false;
    mCheckpointPending = false;
    mCheckpointActive = false;
-   rc = OpenStepByStep( fileName );
+   mCheckpointHurry = false;
+   mWALPages = 0;
+   mCheckpointedPages = 0;
+   mCheckpoints = 0;
+   mCheckpointNanoseconds = 0;
+   rc = OpenStepByStep( fileName, readOnly );
    if ( rc != SQLITE_OK)
    {
       if (mCheckpointDB)
@@ -166,12 +614,14 @@ int DBConnection::Open(const FilePath fileName)
    return rc;
 }
 
-int DBConnection::OpenStepByStep(const FilePath fileName)
+int DBConnection::OpenStepByStep(const FilePath fileName, bool readOnly)
 {
    const char *name = fileName.ToUTF8();
 
    bool success = false;
-   int rc = sqlite3_open(name, &mDB);
+   int rc = readOnly
+      ? sqlite3_open_v2(name, &mDB, SQLITE_OPEN_READONLY, nullptr)
+      : sqlite3_open(name, &mDB);
    if (rc != SQLITE_OK) 
    {
       ADD_EXCEPTION_CONTEXT("sqlite3.rc", std::to_string(rc));
@@ -184,6 +634,17 @@ int DBConnection::OpenStepByStep(const FilePath fileName)
       return rc;
    }
 
+   if (readOnly)
+   {
+      // No page size change, no WAL configuration, and no checkpoint
+      // connection, thread, or hook
+      rc = ReadOnlyMode();
+      if (rc != SQLITE_OK)
+         SetDBError(XO("Failed to set read-only mode on connection to %s")
+            .Format(fileName));
+      return rc;
+   }
+
    rc = SetPageSize();
 
    if (rc != SQLITE_OK)
@@ -241,10 +702,26 @@ bool DBConnection::Close()
       return true;
    }
 
+   EndPrefetch();
+
+   // Finish writing and deleting in the background first, because that may
+   // make more checkpoints
+   StopBackgroundWrites();
+   mNextBlockID = 0;
+
    // Uninstall our checkpoint hook so that no additional checkpoints
    // are sent our way.  (Though this shouldn't really happen.)
    sqlite3_wal_hook(mDB, nullptr, nullptr);
 
+   // Copy the rest of the log at full speed; the thresholds kept it short
+   {
+      std::lock_guard<std::mutex> guard(mCheckpointMutex);
+      mCheckpointHurry = true;
+      if (mWALPages > mCheckpointedPages)
+         mCheckpointPending = true;
+      mCheckpointCondition.notify_one();
+   }
+
    // Display a progress dialog if there's active or pending checkpoints
    if (mCheckpointPending || mCheckpointActive)
    {
@@ -362,6 +839,16 @@ int DBConnection::FastMode(const char *schema /* = "main" */)
    return ModeConfig(mDB, schema, FastConfig);
 }
 
+int DBConnection::ReadOnlyMode(const char *schema /* = "main" */)
+{
+   return ModeConfig(mDB, schema, ReadOnlyConfig);
+}
+
+bool DBConnection::IsReadOnly() const
+{
+   return mReadOnly;
+}
+
 int DBConnection::SetPageSize(const char* schema)
 {
    // First of all - let's check if the database is empty.
@@ -490,21 +977,96 @@ sqlite3_stmt *DBConnection::Prepare(enum StatementID id, const char *sql)
    return stmt;
 }
 
+void DBConnection::SetCheckpointPolicy(const CheckpointPolicy &policy)
+{
+   std::lock_guard<std::mutex> guard(mCheckpointMutex);
+   mCheckpointPolicy = policy;
+   mCheckpointCondition.notify_one();
+}
+
+void DBConnection::ReserveSpace(int64_t bytes)
+{
+   if (mReadOnly || !mDB)
+      return;
+
+   // SQLite rounds the size up to a multiple of the chunk, both when the file
+   // grows and when a checkpoint truncates it; so the room stays reserved
+   // until the chunk size is reset
+   constexpr int64_t MaxChunk = 1 << 30;
+   int chunk = int(std::clamp<int64_t>(bytes, 0, MaxChunk));
+   chunk -= chunk % AUDACITY_PROJECT_PAGE_SIZE;
+   for (const auto db : { mDB, mCheckpointDB })
+      if (db) {
+         auto size = chunk;
+         sqlite3_file_control(db, "main", SQLITE_FCNTL_CHUNK_SIZE, &size);
+      }
+   if (chunk == 0)
+      return;
+
+   sqlite3_int64 pages = 0;
+   sqlite3_stmt *stmt = nullptr;
+   if (sqlite3_prepare_v2(mDB, "PRAGMA main.page_count;", -1, &stmt, nullptr)
+          == SQLITE_OK &&
+       sqlite3_step(stmt) == SQLITE_ROW)
+      pages = sqlite3_column_int64(stmt, 0);
+   sqlite3_finalize(stmt);
+
+   // Extend to the next multiple of the chunk now, as the first checkpoint
+   // would, which writes the file through the other connection
+   const sqlite3_int64 pageSize = mPageSize ? mPageSize.load()
+      : AUDACITY_PROJECT_PAGE_SIZE;
+   sqlite3_int64 hint = pages * pageSize + 1;
+   sqlite3_file_control(mCheckpointDB ? mCheckpointDB : mDB,
+      "main", SQLITE_FCNTL_SIZE_HINT, &hint);
+}
+
+auto DBConnection::GetWALStatistics() const -> WALStatistics
+{
+   return {
+      mWALPages,
+      mCheckpointedPages,
+      mPageSize,
+      mCheckpoints,
+      std::chrono::nanoseconds{ mCheckpointNanoseconds.load() }
+   };
+}
+
 void DBConnection::CheckpointThread(sqlite3 *db, const FilePath &fileName)
 {
+   Tracing::RegisterThread("Checkpoint");
+   using namespace std::chrono;
    int rc = SQLITE_OK;
    bool giveUp = false;
 
+   {
+      sqlite3_stmt *stmt = nullptr;
+      if (sqlite3_prepare_v2(db, "PRAGMA main.page_size;", -1, &stmt, nullptr)
+             == SQLITE_OK &&
+          sqlite3_step(stmt) == SQLITE_ROW)
+         mPageSize = sqlite3_column_int64(stmt, 0);
+      sqlite3_finalize(stmt);
+   }
+
+   auto last = steady_clock::now();
+   // Whether readers kept the last checkpoint from copying anything
+   bool stalled = false;
    while (true)
    {
       {
-         // Wait for work or the stop signal
+         // Wait for enough pages of the log, or for the interval to pass
+         // with any, or the stop signal
          std::unique_lock<std::mutex> lock(mCheckpointMutex);
-         mCheckpointCondition.wait(lock,
-                                   [&]
-                                   {
-                                      return mCheckpointPending || mCheckpointStop;
-                                   });
+         while (!mCheckpointStop && !mCheckpointPending)
+         {
+            const auto uncopied = mWALPages - mCheckpointedPages;
+            if (!stalled && uncopied >= mCheckpointPolicy.pages)
+               break;
+            if (uncopied <= 0)
+               mCheckpointCondition.wait(lock);
+            else if (mCheckpointCondition.wait_until(
+               lock, last + mCheckpointPolicy.interval) == std::cv_status::timeout)
+               break;
+         }
 
          // Requested to stop, so bail
          if (mCheckpointStop)
@@ -512,23 +1074,42 @@ void DBConnection::CheckpointThread(sqlite3 *db, const FilePath &fileName)
             break;
          }
 
-         // Capture the number of pages that need checkpointing and reset
          mCheckpointActive = true;
          mCheckpointPending = false;
       }
 
       // And kick off the checkpoint. This may not checkpoint ALL frames
       // in the WAL.  They'll be gotten the next time around.
-      using namespace std::chrono;
-      do {
-         rc = giveUp ? SQLITE_OK :
-            sqlite3_wal_checkpoint_v2(
-               db, nullptr, SQLITE_CHECKPOINT_PASSIVE, nullptr, nullptr);
+      const auto start = steady_clock::now();
+      int logPages = 0, copiedPages = 0;
+      {
+         TRACE_SCOPE("Checkpoint");
+         do {
+            rc = giveUp ? SQLITE_OK :
+               sqlite3_wal_checkpoint_v2(db, nullptr,
+                  SQLITE_CHECKPOINT_PASSIVE, &logPages, &copiedPages);
+         }
+         // Contentions for an exclusive lock on the database are possible,
+         // even while the main thread is merely drawing the tracks, which
+         // may perform reads
+         while (rc == SQLITE_BUSY && (std::this_thread::sleep_for(1ms), true));
+      }
+      const auto elapsed = steady_clock::now() - start;
+
+      // After the log restarts, it holds fewer pages than were copied of it
+      const int before = mCheckpointedPages;
+      const auto newlyCopied =
+         copiedPages >= before ? copiedPages - before : copiedPages;
+      stalled = newlyCopied == 0 && copiedPages < logPages;
+      if (giveUp || rc != SQLITE_OK)
+         // Nothing more to expect
+         mCheckpointedPages = mWALPages.load();
+      else {
+         mWALPages = logPages;
+         mCheckpointedPages = copiedPages;
+         ++mCheckpoints;
+         mCheckpointNanoseconds += duration_cast<nanoseconds>(elapsed).count();
       }
-      // Contentions for an exclusive lock on the database are possible,
-      // even while the main thread is merely drawing the tracks, which
-      // may perform reads
-      while (rc == SQLITE_BUSY && (std::this_thread::sleep_for(1ms), true));
 
       // Reset
       mCheckpointActive = false;
@@ -579,6 +1160,23 @@ void DBConnection::CheckpointThread(sqlite3 *db, const FilePath &fileName)
             }
          );
       }
+      else if (newlyCopied > 0)
+      {
+         // Limit the rate, so that other writes to the device are not starved
+         std::unique_lock<std::mutex> lock(mCheckpointMutex);
+         if (const auto rate = mCheckpointPolicy.bytesPerSecond;
+             rate > 0 && !mCheckpointHurry)
+         {
+            const auto pause = duration_cast<nanoseconds>(
+               duration<double>(double(newlyCopied) * mPageSize / rate))
+                  - elapsed;
+            if (pause > 0ns)
+               mCheckpointCondition.wait_for(lock, pause, [this]{
+                  return mCheckpointStop || mCheckpointHurry;
+               });
+         }
+      }
+      last = steady_clock::now();
    }
 
    return;
@@ -589,9 +1187,14 @@ int DBConnection::CheckpointHook(void *data, sqlite3 *db, const char *schema, in
    // Get access to our object
    DBConnection *that = static_cast<DBConnection *>(data);
 
-   // Queue the database pointer for our checkpoint thread to process
+   // Let our checkpoint thread decide whether a checkpoint is due
    std::lock_guard<std::mutex> guard(that->mCheckpointMutex);
-   that->mCheckpointPending = true;
+   if (pages < that->mCheckpointedPages)
+      // The log restarted
+      that->mCheckpointedPages = 0;
+   that->mWALPages = pages;
+   if (that->mCheckpointHurry)
+      that->mCheckpointPending = true;
    that->mCheckpointCondition.notify_one();
 
    return SQLITE_OK;
@@ -608,6 +1211,9 @@ struct DBConnectionTransactionScopeImpl final : TransactionScopeImpl {
    bool TransactionCommit(const wxString &name) override;
    bool TransactionRollback(const wxString &name) override;
 
+   //! Release the savepoint; the caller pauses the writer
+   bool Release(const wxString &name);
+
    DBConnection &mConnection;
 };
 
@@ -627,12 +1233,18 @@ bool DBConnectionTransactionScopeImpl::TransactionStart(const wxString &name)
 {
    char *errmsg = nullptr;
 
+   // Rows submitted before the scope are not rolled back with it; the
+   // writer thread joins the savepoint from now on
+   const auto pause = mConnection.PauseWriter();
    int rc = sqlite3_exec(mConnection.DB(),
                          wxT("SAVEPOINT ") + name + wxT(";"),
                          nullptr,
                          nullptr,
                          &errmsg);
 
+   if (rc == SQLITE_OK)
+      ++mConnection.mSavepointDepth;
+
    if (errmsg)
    {
       ADD_EXCEPTION_CONTEXT("sqlite3.rc", std::to_string(rc));
@@ -648,6 +1260,14 @@ bool DBConnectionTransactionScopeImpl::TransactionStart(const wxString &name)
 }
 
 bool DBConnectionTransactionScopeImpl::TransactionCommit(const wxString &name)
+{
+   // A group of the writer thread may have joined the savepoint; don't
+   // release it while the group runs
+   const auto pause = mConnection.PauseWriter();
+   return Release(name);
+}
+
+bool DBConnectionTransactionScopeImpl::Release(const wxString &name)
 {
    char *errmsg = nullptr;
 
@@ -657,6 +1277,9 @@ bool DBConnectionTransactionScopeImpl::TransactionCommit(const wxString &name)
                          nullptr,
                          &errmsg);
 
+   if (rc == SQLITE_OK)
+      --mConnection.mSavepointDepth;
+
    if (errmsg)
    {
       ADD_EXCEPTION_CONTEXT("sqlite3.rc", std::to_string(rc));
@@ -675,6 +1298,9 @@ bool DBConnectionTransactionScopeImpl::TransactionRollback(const wxString &name)
 {
    char *errmsg = nullptr;
 
+   // Rows submitted in the scope are rolled back with it, and no other
+   // writes run in the midst of the rollback
+   const auto pause = mConnection.PauseWriter();
    int rc = sqlite3_exec(mConnection.DB(),
                          wxT("ROLLBACK TO ") + name + wxT(";"),
                          nullptr,
@@ -698,7 +1324,7 @@ bool DBConnectionTransactionScopeImpl::TransactionRollback(const wxString &name)
    // -- must do both; rolling back a savepoint only rewinds it
    // without removing it, unlike the ROLLBACK command
 
-   return TransactionCommit(name);
+   return Release(name);
 }
 
 ConnectionPtr::~ConnectionPtr()
@@ -13,12 +13,18 @@ Paul Licameli -- split from ProjectFileIO.h
 #define __AUDACITY_DB_CONNECTION__
 
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
+#include <deque>
 #include <functional>
+#include <future>
 #include <map>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <thread>
+#include <unordered_map>
+#include <vector>
 
 #include "ClientData.h"
 #include "Identifier.h"
@@ -51,9 +57,13 @@ public:
    );
    ~DBConnection();
 
-   int Open(const FilePath fileName);
+   //! @param readOnly if true, the file is memory-mapped for reading and
+   //! never checkpointed; all updates will fail
+   int Open(const FilePath fileName, bool readOnly = false);
    bool Close();
 
+   bool IsReadOnly() const;
+
    //! throw and show appropriate message box
    [[noreturn]] void ThrowException(
       bool write //!< If true, a database update failed; if false, only a SELECT failed
@@ -61,6 +71,7 @@ public:
 
    int SafeMode(const char *schema = "main");
    int FastMode(const char* schema = "main");
+   int ReadOnlyMode(const char* schema = "main");
    int SetPageSize(const char* schema = "main");
 
    bool Assign(sqlite3 *handle);
@@ -74,19 +85,141 @@ public:
    enum StatementID
    {
       GetSamples,
+      GetSamplesBatch,
       GetSummary256,
       GetSummary64k,
       LoadSampleBlock,
       InsertSampleBlock,
+      UpdateSampleBlockSummary,
+      UpdateSampleBlock,
       DeleteSampleBlock,
       GetSampleBlockSize,
-      GetAllSampleBlocksSize
+      GetAllSampleBlocksSize,
+      LoadSpectrogramTiles,
+      InsertSpectrogramTile
    };
    sqlite3_stmt *Prepare(enum StatementID id, const char *sql);
 
    void SetBypass( bool bypass );
    bool ShouldBypass();
 
+   //! A complete update, to run on another connection to the same file
+   /*! Must not throw */
+   using BackgroundWrite = std::function<void(sqlite3 *db)>;
+   //! Run the update later in the writer thread, so that the calling thread
+   //! does not wait for the disk
+   /*! It runs after updates passed to SubmitWrite() before it.  An update
+    not yet started is replaced, so each must supersede all those before it */
+   void WriteInBackground(BackgroundWrite write);
+   //! Block until all updates passed to WriteInBackground or SubmitWrite are
+   //! done
+   void WaitForBackgroundWrite();
+   //! Whether the primary connection has an open transaction, which another
+   //! connection would have to wait for
+   bool InTransaction();
+
+   //! An update of the primary connection, for the writer thread
+   /*! Must not throw.  @return SQLITE_OK, or else the error */
+   using Write = std::function<int(sqlite3 *db)>;
+   //! Queue an update of the primary connection, so that the calling thread
+   //! does not wait for the disk
+   /*!
+    The writer thread runs updates in the order queued, and commits all that
+    are waiting, up to a limit, in one transaction; or they join the
+    transaction open in the primary connection, if any.  May be called from
+    any thread.
+    @return becomes ready with the result when the update has run
+    */
+   std::shared_future<int> SubmitWrite(Write write);
+   //! The first error of an update passed to SubmitWrite(), or SQLITE_OK
+   /*! Rows it failed to write stay missing, so the error is not cleared */
+   int GetWriteError() const;
+   //! Wait for updates submitted so far, then keep the writer thread from
+   //! using the primary connection while the lock is held
+   /*! Do not wait for a submitted update while holding it */
+   std::unique_lock<std::mutex> PauseWriter();
+   //! An id for a new row of sampleblocks, which may be inserted later
+   /*! May be called from any thread */
+   int64_t ReserveBlockID();
+
+   //! Let the writer commit more updates together
+   /*! Calls nest; only the outermost call sets the limit */
+   void BeginBulkWrite(size_t rowsPerTransaction);
+   //! Restore the default limit, when the outermost call ends
+   void EndBulkWrite();
+
+   //! When, and how fast, the checkpoint thread copies the write-ahead log
+   //! into the database
+   struct CheckpointPolicy
+   {
+      //! Begin a passive checkpoint when so many pages of the log are not
+      //! yet copied...
+      int pages{ 256 };
+      //! ...or when any are, and so long has passed since the last one
+      std::chrono::milliseconds interval{ 1000 };
+      //! Pause after each checkpoint, so that they copy no more than this on
+      //! average, or no limit if 0; except while closing
+      size_t bytesPerSecond{ 32 << 20 };
+   };
+   //! May be called from any thread; applies from the next checkpoint
+   void SetCheckpointPolicy(const CheckpointPolicy &policy);
+
+   //! Let the database file grow in steps of about so many bytes, and extend
+   //! it by one step now, so that a long recording does not make the file
+   //! system allocate often; 0 restores the default growth, releasing the
+   //! unused room at the next complete checkpoint
+   void ReserveSpace(int64_t bytes);
+
+   struct WALStatistics
+   {
+      //! Pages in the write-ahead log
+      int pages{};
+      //! How many of them are copied into the database
+      int checkpointedPages{};
+      size_t pageSize{};
+      size_t checkpoints{};
+      //! In checkpoints, not counting the pauses between them
+      std::chrono::nanoseconds checkpointTime{};
+   };
+   //! May be called from any thread
+   WALStatistics GetWALStatistics() const;
+
+   //! The columns of one row of sampleblocks, except the blobs
+   struct SampleBlockInfo
+   {
+      int format{};
+      double sumMin{}, sumMax{}, sumRms{};
+      int bytes{};
+      //! As ProjectFileIO::GetDiskUsage() would find it
+      int64_t spaceUsage{};
+   };
+   //! Begin reading all rows of sampleblocks in a worker thread, on another
+   //! connection, while the project document that refers to them is decoded
+   void PrefetchSampleBlocks();
+   //! Find a row read by PrefetchSampleBlocks(), waiting for the read
+   /*! @return false if there was no prefetch, or it failed before the row */
+   bool FindPrefetchedSampleBlock(int64_t id, SampleBlockInfo &info);
+   //! Release the rows that PrefetchSampleBlocks() read
+   void EndPrefetch();
+   //! The ids of all rows read by PrefetchSampleBlocks(), waiting for the read
+   /*! @return false if there was no prefetch, or it found no rows */
+   bool GetPrefetchedBlockIDs(std::vector<int64_t> &ids);
+
+   //! Delete rows of sampleblocks later, a few in each update queued for the
+   //! writer thread, so that the calling thread does not wait for the disk
+   /*! May be called from any thread.  Rows not deleted when the program ends
+    are orphans, which are deleted when the project is next opened. */
+   void DeleteInBackground(std::vector<int64_t> blockIDs);
+
+   //! Change the running total of the space that rows of sampleblocks use,
+   //! as ProjectFileIO::GetDiskUsage() estimates it, if it is known
+   /*! May be called from any thread */
+   void AddSpaceUsage(int64_t delta);
+   //! The running total, if known
+   std::optional<int64_t> GetSpaceUsage() const;
+   //! Begin the running total, or forget it after other changes of the rows
+   void SetSpaceUsage(std::optional<int64_t> usage);
+
    //! Just set stored errors
    void SetError(
       const TranslatableString &msg,
@@ -100,10 +233,24 @@ public:
       int errorCode = -1);
 
 private:
-   int OpenStepByStep(const FilePath fileName);
+   int OpenStepByStep(const FilePath fileName, bool readOnly);
    int ModeConfig(sqlite3 *db, const char *schema, const char *config);
 
    void CheckpointThread(sqlite3 *db, const FilePath &fileName);
+   struct QueuedWrite {
+      //! On the primary connection, grouped with others
+      Write write;
+      //! Or else, alone, on the background connection
+      BackgroundWrite background;
+      std::promise<int> promise;
+   };
+   //! Updates the writer commits in one transaction, outside of bulk writes
+   static constexpr size_t DefaultGroupLimit = 64;
+
+   void StartWriter();
+   void WriterThread();
+   void RunGroup(std::vector<QueuedWrite> &group);
+   void StopBackgroundWrites();
    static int CheckpointHook(void *data, sqlite3 *db, const char *schema, int pages);
 
 private:
@@ -117,6 +264,32 @@ private:
    std::atomic_bool mCheckpointStop{ false };
    std::atomic_bool mCheckpointPending{ false };
    std::atomic_bool mCheckpointActive{ false };
+   //! Guarded by mCheckpointMutex
+   CheckpointPolicy mCheckpointPolicy;
+   //! Checkpoint without thresholds or pauses, as when closing; guarded by
+   //! mCheckpointMutex
+   bool mCheckpointHurry{ false };
+   std::atomic_int mWALPages{ 0 };
+   std::atomic_int mCheckpointedPages{ 0 };
+   std::atomic<size_t> mPageSize{ 0 };
+   std::atomic<size_t> mCheckpoints{ 0 };
+   std::atomic<int64_t> mCheckpointNanoseconds{ 0 };
+
+   sqlite3 *mBackgroundDB{};
+   std::thread mWriterThread;
+   std::condition_variable mWriterCondition;
+   std::mutex mWriterMutex;
+   std::deque<QueuedWrite> mWrites;
+   size_t mBulkDepth{ 0 };
+   size_t mGroupLimit{ DefaultGroupLimit };
+   bool mWriterActive{ false };
+   bool mWriterStop{ false };
+   //! Held by the writer thread for each group of updates
+   std::mutex mGroupMutex;
+   std::atomic_int mWriteError{ 0 };
+
+   std::mutex mBlockIDMutex;
+   int64_t mNextBlockID{ 0 };
 
    std::mutex mStatementMutex;
    using StatementIndex = std::pair<enum StatementID, std::thread::id>;
@@ -127,10 +300,43 @@ private:
 
    // Bypass transactions if database will be deleted after close
    bool mBypass;
+
+   friend struct DBConnectionTransactionScopeImpl;
+   // Count of savepoints made by TransactionScope, which updates of the
+   // writer thread join
+   std::atomic_int mSavepointDepth{ 0 };
+
+   bool mReadOnly{ false };
+
+   mutable std::mutex mSpaceUsageMutex;
+   std::optional<int64_t> mSpaceUsage;
+
+   using SampleBlockInfos = std::unordered_map<int64_t, SampleBlockInfo>;
+   std::mutex mPrefetchMutex;
+   std::future<SampleBlockInfos> mPrefetchFuture;
+   SampleBlockInfos mPrefetched;
 };
 
 using Connection = std::unique_ptr<DBConnection>;
 
+//! RAII object that lets sample block insertions, such as those of an
+//! import, be committed in fewer and larger transactions
+/*! Rows written in the scope are committed even if it ends by exception,
+ because sample block objects already refer to them. */
+class PROJECT_FILE_IO_API BulkWriteScope final
+{
+public:
+   explicit BulkWriteScope(
+      AudacityProject &project, size_t rowsPerTransaction = 256);
+   ~BulkWriteScope();
+
+   BulkWriteScope(const BulkWriteScope &) = delete;
+   BulkWriteScope &operator=(const BulkWriteScope &) = delete;
+
+private:
+   DBConnection *mpConnection{};
+};
+
 // This object attached to the project simply holds the pointer to the
 // project's current database connection, which is initialized on demand,
 // and may be redirected, temporarily or permanently, to another connection
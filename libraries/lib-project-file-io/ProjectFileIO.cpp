@@ -10,7 +10,9 @@ Paul Licameli split from AudacityProject.cpp
 
 #include "ProjectFileIO.h"
 
+#include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <sqlite3.h>
 #include <optional>
 #include <cstring>
@@ -33,6 +35,7 @@ Paul Licameli split from AudacityProject.cpp
 #include "SampleBlock.h"
 #include "TempDirectory.h"
 #include "TransactionScope.h"
+#include "UndoManager.h"
 #include "WaveTrack.h"
 #include "WaveTrackUtilities.h"
 #include "BasicUI.h"
@@ -101,6 +104,9 @@ static const char *ProjectFileSchema =
    // settings.
    "PRAGMA <schema>.application_id = %d;"
    "PRAGMA <schema>.user_version = %u;"
+   // Let Compact() return free pages a few at a time; this must precede
+   // creation of any table to take effect
+   "PRAGMA <schema>.auto_vacuum = INCREMENTAL;"
    ""
    // project is a binary representation of an XML file.
    // it's in binary for speed.
@@ -152,7 +158,8 @@ static const char *ProjectFileSchema =
    // blockID is a 64 bit number.
    //
    // Rows are immutable -- never updated after addition, but may be
-   // deleted.
+   // deleted.  The exception is that summin to summary64k may be NULL at
+   // first, and written once when calculated in the background.
    //
    // summin to summary64K are summaries at 3 distance scales.
    "CREATE TABLE IF NOT EXISTS <schema>.sampleblocks"
@@ -416,6 +423,22 @@ ProjectFileIO::ProjectFileIO(AudacityProject &project)
 
    SetProjectTitle();
 
+   // Reuse of track encodings in autosave is good only until the tracks
+   // change
+   mUndoSubscription = UndoManager::Get(project)
+      .Subscribe([this](const UndoRedoMessage &message){
+         switch (message.type) {
+         case UndoRedoMessage::Pushed:
+         case UndoRedoMessage::Modified:
+         case UndoRedoMessage::UndoOrRedo:
+         case UndoRedoMessage::Reset:
+            mAutoSaveFragments.clear();
+            break;
+         default:
+            break;
+         }
+      });
+
    // Make sure there is plenty of space for Sqlite files
    wxLongLong freeSpace = 0;
 
@@ -484,7 +507,8 @@ sqlite3 *ProjectFileIO::DB()
  @pre *CurConn() does not exist
  @post *CurConn() exists or return value is false
  */
-bool ProjectFileIO::OpenConnection(FilePath fileName /* = {}  */)
+bool ProjectFileIO::OpenConnection(
+   FilePath fileName /* = {}  */, bool readOnly /* = false */)
 {
    auto &curConn = CurrConn();
    wxASSERT(!curConn);
@@ -515,7 +539,7 @@ bool ProjectFileIO::OpenConnection(FilePath fileName /* = {}  */)
    // Pass weak_ptr to project into DBConnection constructor
    curConn = std::make_unique<DBConnection>(
       mProject.shared_from_this(), mpErrors, [this]{ OnCheckpointFailure(); } );
-   auto rc = curConn->Open(fileName);
+   auto rc = curConn->Open(fileName, readOnly);
    if (rc != SQLITE_OK)
    {
       // Must use SetError() here since we do not have an active DB
@@ -812,61 +836,114 @@ bool ProjectFileIO::InstallSchema(sqlite3 *db, const char *schema /* = "main" */
 // The orphan block handling should be removed once autosave and related
 // blocks become part of the same transaction.
 
-// An SQLite function that takes a blockid and looks it up in a set of
-// blockids captured during project load.  If the blockid isn't found
-// in the set, it will be deleted.
-namespace
-{
-struct ContextData final
+// An SQLite function that takes a blockid and tells whether an extension
+// locks it, in which case it is kept though not in the set of blockids
+// captured during project load.
+void ProjectFileIO::IsLocked(sqlite3_context *context, int argc, sqlite3_value **argv)
 {
-   const AudacityProject& project;
-   const BlockIDs& blockids;
-};
-}
-
-void ProjectFileIO::InSet(sqlite3_context *context, int argc, sqlite3_value **argv)
-{
-   auto contextData = reinterpret_cast<ContextData*>(sqlite3_user_data(context));
+   auto &project = *reinterpret_cast<const AudacityProject*>(
+      sqlite3_user_data(context));
    SampleBlockID blockid = sqlite3_value_int64(argv[0]);
 
    sqlite3_result_int(
-      context,
-      contextData->blockids.find(blockid) != contextData->blockids.end() ||
-         ProjectFileIOExtensionRegistry::IsBlockLocked(
-            contextData->project, blockid));
+      context, ProjectFileIOExtensionRegistry::IsBlockLocked(project, blockid));
 }
 
-bool ProjectFileIO::DeleteBlocks(const BlockIDs &blockids, bool complement)
+bool ProjectFileIO::StoreBlockSet(const BlockIDs &blockids)
 {
    auto db = DB();
    int rc;
 
-   ContextData contextData{ mProject, blockids };
+   // Keep the writer thread's savepoints from interleaving with this one
+   const auto pause = GetConnection().PauseWriter();
+
+   // Add the function used to keep blocks that extensions still use
+   rc = sqlite3_create_function(db, "islocked", 1, SQLITE_UTF8 | SQLITE_DETERMINISTIC,
+      const_cast<AudacityProject*>(&mProject), IsLocked, nullptr, nullptr);
+   if (rc != SQLITE_OK)
+   {
+      ADD_EXCEPTION_CONTEXT("sqlite3.rc", std::to_string(rc));
+      ADD_EXCEPTION_CONTEXT("sqlite3.context", "ProjectGileIO::StoreBlockSet::create_function");
 
+      /* i18n-hint: An error message.  Don't translate islocked or blockids.*/
+      SetDBError(XO("Unable to add 'islocked' function (can't verify blockids)"));
+      return false;
+   }
+
+   // Load the set into a temporary table, so that deletions are joins by
+   // key, rather than calls into the application for every row.
+   // Ids go in ascending order, appending to the table's tree.
+   sqlite3_stmt *stmt = nullptr;
    auto cleanup = finally([&]
    {
-      // Remove our function, whether it was successfully defined or not.
-      sqlite3_create_function(db, "inset", 1, SQLITE_UTF8 | SQLITE_DETERMINISTIC, nullptr, nullptr, nullptr, nullptr);
+      if (stmt)
+         sqlite3_finalize(stmt);
    });
 
-   // Add the function used to verify each row's blockid against the set of active blockids
-   rc = sqlite3_create_function(db, "inset", 1, SQLITE_UTF8 | SQLITE_DETERMINISTIC, &contextData, InSet, nullptr, nullptr);
+   std::vector<SampleBlockID> sorted{ blockids.begin(), blockids.end() };
+   std::sort(sorted.begin(), sorted.end());
+
+   rc = sqlite3_exec(db,
+      "CREATE TEMP TABLE IF NOT EXISTS blockset(blockid INTEGER PRIMARY KEY);"
+      "DELETE FROM temp.blockset;"
+      "SAVEPOINT blockset;",
+      nullptr, nullptr, nullptr);
+   if (rc == SQLITE_OK)
+      rc = sqlite3_prepare_v2(db,
+         "INSERT INTO temp.blockset VALUES(?);", -1, &stmt, nullptr);
+   for (auto iter = sorted.begin();
+        rc == SQLITE_OK && iter != sorted.end(); ++iter)
+   {
+      rc = sqlite3_bind_int64(stmt, 1, *iter);
+      if (rc == SQLITE_OK && (rc = sqlite3_step(stmt)) == SQLITE_DONE)
+         rc = sqlite3_reset(stmt);
+   }
+   if (rc == SQLITE_OK)
+      rc = sqlite3_exec(db, "RELEASE blockset;", nullptr, nullptr, nullptr);
    if (rc != SQLITE_OK)
    {
       ADD_EXCEPTION_CONTEXT("sqlite3.rc", std::to_string(rc));
-      ADD_EXCEPTION_CONTEXT("sqlite3.context", "ProjectGileIO::DeleteBlocks::create_function");
-
-      /* i18n-hint: An error message.  Don't translate inset or blockids.*/
-      SetDBError(XO("Unable to add 'inset' function (can't verify blockids)"));
+      ADD_EXCEPTION_CONTEXT("sqlite3.context", "ProjectGileIO::StoreBlockSet");
+
+      sqlite3_finalize(stmt);
+      stmt = nullptr;
+      sqlite3_exec(db, "ROLLBACK TO blockset; RELEASE blockset;", nullptr, nullptr, nullptr);
+      DropBlockSet();
+      /* i18n-hint: An error message.  Don't translate blockids.*/
+      SetDBError(XO("Unable to store the set of blockids"));
       return false;
    }
 
+   return true;
+}
+
+void ProjectFileIO::DropBlockSet()
+{
+   auto db = DB();
+   sqlite3_create_function(db, "islocked", 1, SQLITE_UTF8 | SQLITE_DETERMINISTIC, nullptr, nullptr, nullptr, nullptr);
+   sqlite3_exec(db, "DROP TABLE IF EXISTS temp.blockset;", nullptr, nullptr, nullptr);
+}
+
+bool ProjectFileIO::DeleteBlocks(const BlockIDs &blockids, bool complement)
+{
+   auto db = DB();
+   int rc;
+
+   if (!StoreBlockSet(blockids))
+      return false;
+   auto cleanup = finally([&]{ DropBlockSet(); });
+
    // Delete all rows in the set, or not in it
    // This is the first command that writes to the database, and so we
    // do more informative error reporting than usual, if it fails.
-   auto sql = wxString::Format(
-      "DELETE FROM sampleblocks WHERE %sinset(blockid);",
-      complement ? "NOT " : "" );
+   // Locked blocks count as members of the set
+   auto sql = wxString{ complement
+      ? "DELETE FROM sampleblocks"
+        " WHERE blockid NOT IN (SELECT blockid FROM temp.blockset)"
+        " AND NOT islocked(blockid);"
+      : "DELETE FROM sampleblocks"
+        " WHERE blockid IN (SELECT blockid FROM temp.blockset)"
+        " OR islocked(blockid);" };
    rc = sqlite3_exec(db, sql, nullptr, nullptr, nullptr);
    if (rc != SQLITE_OK)
    {
@@ -906,6 +983,9 @@ bool ProjectFileIO::DeleteBlocks(const BlockIDs &blockids, bool complement)
    int changes = sqlite3_changes(db);
    if (changes > 0)
    {
+      // Rows went away without their block objects
+      CurrConn()->SetSpaceUsage({});
+
       wxLogInfo(XO("Total orphan blocks deleted %d").Translation(), changes);
       mRecovered = true;
    }
@@ -925,6 +1005,10 @@ bool ProjectFileIO::CopyTo(const FilePath &destpath,
    if (!pConn)
       return false;
 
+   // Rows are copied as they are, so they must be complete
+   if (!FlushSampleBlocks())
+      return false;
+
    // Get access to the active tracklist
    auto pProject = &mProject;
 
@@ -980,6 +1064,8 @@ bool ProjectFileIO::CopyTo(const FilePath &destpath,
          // If this fails (probably due to memory or disk space), the transaction will
          // (presumably) still be active, so further updates to the project file will
          // fail as well. Not really much we can do about it except tell the user.
+         // (Not while the writer thread has a transaction of its own)
+         const auto pause = GetConnection().PauseWriter();
          auto result = sqlite3_exec(db, "ROLLBACK;", nullptr, nullptr, nullptr);
 
          // Only capture the error if there wasn't a previous error
@@ -1088,7 +1174,11 @@ bool ProjectFileIO::CopyTo(const FilePath &destpath,
       // Also note that we will have an open transaction if we fail
       // while copying the blocks. This is fine since we're just going
       // to delete the database anyway.
-      sqlite3_exec(db, "BEGIN;", nullptr, nullptr, nullptr);
+      {
+         // Updates of the writer thread join the transaction
+         const auto pause = GetConnection().PauseWriter();
+         sqlite3_exec(db, "BEGIN;", nullptr, nullptr, nullptr);
+      }
 
       // Copy sample blocks from the main DB to the outbound DB
       for (auto blockid : blockids)
@@ -1406,7 +1496,7 @@ ProjectFileIO::BackupProject::~BackupProject()
 }
 
 void ProjectFileIO::Compact(
-   const std::vector<const TrackList *> &tracks, bool force)
+   const std::vector<const TrackList *> &tracks, bool force, double maxSeconds)
 {
    // Haven't compacted yet
    mWasCompacted = false;
@@ -1415,12 +1505,18 @@ void ProjectFileIO::Compact(
    // at project close time will still occur.
    mHadUnused = true;
 
+   // A file made with incremental vacuuming may keep free pages from an
+   // interrupted compaction in an earlier session
+   const auto progress = GetCompactProgress();
+   const bool incremental = progress.incremental && !IsTemporary();
+
    // If forcing compaction, bypass inspection.
    if (!force)
    {
       // Don't compact if this is a temporary project or if it's determined there are not
       // enough unused blocks to make it worthwhile.
-      if (IsTemporary() || !ShouldCompact(tracks))
+      if (IsTemporary() ||
+          !(ShouldCompact(tracks) || (incremental && progress.freePages > 0)))
       {
          // Delete the AutoSave doc it if exists
          if (IsModified())
@@ -1439,6 +1535,23 @@ void ProjectFileIO::Compact(
       }
    }
 
+   if (incremental)
+   {
+      // Rewrite nothing; delete rows and return pages in bounded steps
+      // instead, so that what is left undone can resume later
+      if (tracks.empty())
+         CompactIncrementally(nullptr, maxSeconds);
+      else
+      {
+         BlockIDs active;
+         for (auto pTracks : tracks)
+            if (pTracks)
+               WaveTrackUtilities::InspectBlocks(*pTracks, {}, &active);
+         CompactIncrementally(&active, maxSeconds);
+      }
+      return;
+   }
+
    wxString origName = mFileName;
    wxString backName = origName + "_compact_back";
    wxString tempName = origName + "_compact_temp";
@@ -1538,6 +1651,122 @@ void ProjectFileIO::Compact(
    return;
 }
 
+ProjectFileIO::CompactProgress ProjectFileIO::GetCompactProgress()
+{
+   CompactProgress progress;
+   if (!HasConnection())
+      return progress;
+
+   int64_t value = 0;
+   if (GetValue("PRAGMA main.auto_vacuum;", value, true))
+      // 2 means INCREMENTAL
+      progress.incremental = (value == 2);
+   if (GetValue("PRAGMA main.freelist_count;", value, true))
+      progress.freePages = value;
+   if (GetValue("PRAGMA main.page_count;", value, true))
+      progress.totalPages = value;
+
+   return progress;
+}
+
+int ProjectFileIO::DeleteUnusedBlocks(size_t maxBlocks)
+{
+   auto db = DB();
+   int rc;
+
+   auto sql = wxString::Format(
+      "DELETE FROM sampleblocks WHERE blockid IN "
+      "(SELECT blockid FROM sampleblocks"
+      " WHERE blockid NOT IN (SELECT blockid FROM temp.blockset)"
+      " AND NOT islocked(blockid) LIMIT %zu);",
+      maxBlocks);
+   rc = sqlite3_exec(db, sql, nullptr, nullptr, nullptr);
+   if (rc != SQLITE_OK)
+   {
+      ADD_EXCEPTION_CONTEXT("sqlite3.query", sql.ToStdString());
+      ADD_EXCEPTION_CONTEXT("sqlite3.rc", std::to_string(rc));
+      ADD_EXCEPTION_CONTEXT("sqlite3.context", "ProjectFileIO::DeleteUnusedBlocks");
+
+      /* i18n-hint: An error message.  Don't translate blockfiles.*/
+      SetDBError(XO("Unable to work with the blockfiles"));
+      return -1;
+   }
+
+   const auto changes = sqlite3_changes(db);
+   if (changes > 0)
+      // Rows went away without their block objects
+      CurrConn()->SetSpaceUsage({});
+   return changes;
+}
+
+bool ProjectFileIO::CompactIncrementally(
+   const BlockIDs *pActive, double maxSeconds)
+{
+   using namespace BasicUI;
+   using Clock = std::chrono::steady_clock;
+
+   // Sizes of steps, each of which is its own transaction
+   constexpr size_t BlocksPerStep = 500;
+   constexpr int PagesPerStep = 256;
+
+   const auto start = Clock::now();
+   const auto expired = [&]{
+      return maxSeconds > 0 &&
+         std::chrono::duration<double>(Clock::now() - start).count()
+            >= maxSeconds;
+   };
+
+   auto progress =
+      MakeProgress(XO("Progress"), XO("Compacting project"), ProgressShowCancel);
+
+   // Delete unused rows first, which frees the pages to be returned next
+   if (pActive)
+   {
+      // Store the set once for all the steps
+      if (!StoreBlockSet(*pActive))
+         return false;
+      auto cleanup = finally([&]{ DropBlockSet(); });
+
+      int deleted = 0;
+      do {
+         deleted = DeleteUnusedBlocks(BlocksPerStep);
+         if (deleted < 0)
+            return false;
+         if (progress->Poll(0, 1) != ProgressResult::Success || expired())
+            // Unused rows stay unused, and will be found by a later Compact()
+            return true;
+      } while (deleted == BlocksPerStep);
+   }
+
+   const auto initial = GetCompactProgress().freePages;
+   auto remaining = initial;
+   const auto sql =
+      wxString::Format("PRAGMA main.incremental_vacuum(%d);", PagesPerStep);
+   while (remaining > 0)
+   {
+      if (!Query(sql, [](int, char **, char **){ return 0; }))
+         return false;
+
+      const auto next = GetCompactProgress().freePages;
+      if (next >= remaining)
+         // No headway, perhaps because a reader holds the pages
+         break;
+      remaining = next;
+
+      // Free pages persist in the file, so a later Compact() resumes
+      if (progress->Poll(initial - remaining, initial)
+            != ProgressResult::Success || expired())
+         break;
+   }
+
+   // The file shrinks only when the write-ahead log is checkpointed; failure
+   // just leaves that to the checkpoint thread
+   Query("PRAGMA main.wal_checkpoint(TRUNCATE);",
+      [](int, char **, char **){ return 0; }, true);
+
+   return true;
+}
+
 bool ProjectFileIO::WasCompacted()
 {
    return mWasCompacted;
@@ -1744,7 +1973,8 @@ void ProjectFileIO::WriteXMLHeader(XMLWriter &xmlFile) const
 
 void ProjectFileIO::WriteXML(XMLWriter &xmlFile,
                              bool recording /* = false */,
-                             const TrackList *tracks /* = nullptr */)
+                             const TrackList *tracks /* = nullptr */,
+                             const TrackWriter &writeTrack /* = {} */)
 // may throw
 {
    auto &proj = mProject;
@@ -1763,6 +1993,7 @@ void ProjectFileIO::WriteXML(XMLWriter &xmlFile,
    auto &pendingTracks = PendingTracks::Get(proj);
    tracklist.Any().Visit([&](const Track &t) {
       auto useTrack = &t;
+      bool pending = false;
       if (recording) {
          // When append-recording, there is a temporary "shadow" track accumulating
          // changes and displayed on the screen but it is not yet part of the
@@ -1770,6 +2001,7 @@ void ProjectFileIO::WriteXML(XMLWriter &xmlFile,
          // SubstitutePendingChangedTrack() fetches the shadow, if the track has
          // one, else it gives the same track back.
          useTrack = &pendingTracks.SubstitutePendingChangedTrack(t);
+         pending = (useTrack != &t || t.GetId() == TrackId{});
       }
       else if (useTrack->GetId() == TrackId{}) {
          // This is a track added during a non-appending recording that is
@@ -1777,7 +2009,10 @@ void ProjectFileIO::WriteXML(XMLWriter &xmlFile,
          // when pushing.  Don't auto-save it.
          return;
       }
-      useTrack->WriteXML(xmlFile);
+      if (writeTrack)
+         writeTrack(*useTrack, pending);
+      else
+         useTrack->WriteXML(xmlFile);
    });
 
    xmlFile.EndTag(wxT("project"));
@@ -1787,17 +2022,186 @@ void ProjectFileIO::WriteXML(XMLWriter &xmlFile,
 
 bool ProjectFileIO::AutoSave(bool recording)
 {
-   ProjectSerializer autosave;
+   if (IsReadOnly())
+   {
+      SetError(XO("The project was opened read-only and cannot be saved"));
+      return false;
+   }
+
+   // Encode each track, unless it is not being recorded and is unchanged
+   // since the last autosave.  Keep copies of the encodings for next time.
+   decltype(mAutoSaveFragments) fragments;
+   auto pAutosave = std::make_shared<ProjectSerializer>();
+   auto &autosave = *pAutosave;
    WriteXMLHeader(autosave);
-   WriteXML(autosave, recording);
+   WriteXML(autosave, recording, nullptr,
+      [&](const Track &track, bool pending) {
+         if (recording && !pending) {
+            auto iter = mAutoSaveFragments.find(&track);
+            if (iter != mAutoSaveFragments.end() &&
+                iter->second.pTrack.lock().get() == &track) {
+               autosave.AppendData(iter->second.data);
+               fragments.insert(mAutoSaveFragments.extract(iter));
+               return;
+            }
+         }
+         const auto from = autosave.GetDataSize();
+         track.WriteXML(autosave);
+         if (!pending)
+            fragments[&track] =
+               { track.shared_from_this(), autosave.CopyData(from) };
+      });
+   mAutoSaveFragments.swap(fragments);
 
-   if (WriteDoc("autosave", autosave))
+   // The document must not refer to incomplete rows, nor to rows whose
+   // samples are still only in imported files, which recovery after a crash
+   // could not find
+   if (!FlushSampleBlocks())
+      return false;
+
+   auto &connection = GetConnection();
+   if (connection.InTransaction())
    {
-      mModified = true;
-      return true;
+      // Another connection would wait for this one, so write here
+      WaitForBackgroundAutoSave();
+      if (!WriteDoc("autosave", autosave))
+         return false;
    }
+   else
+      WriteAutoSaveInBackground(connection, std::move(pAutosave));
 
-   return false;
+   mModified = true;
+   return true;
+}
+
+namespace {
+//! Write the autosave document in one transaction, as WriteDoc does, but
+//! without use of the project; for a worker thread
+bool WriteAutoSaveDoc(sqlite3 *db, const MemoryStream::StreamData &dict,
+   const MemoryStream &data, unsigned requiredVersion)
+{
+   sqlite3_stmt *stmt = nullptr;
+   bool success = false;
+   auto cleanup = finally([&]
+   {
+      if (stmt)
+         sqlite3_finalize(stmt);
+      if (!success)
+      {
+         wxLogMessage("Failed to write autosave document to %s\n"
+                      "\tError: %s\n",
+                      sqlite3_db_filename(db, nullptr),
+                      sqlite3_errmsg(db));
+         sqlite3_exec(db, "ROLLBACK;", nullptr, nullptr, nullptr);
+      }
+   });
+
+   // Take the write lock at once, or wait for it with the busy timeout
+   if (sqlite3_exec(db, "BEGIN IMMEDIATE;", nullptr, nullptr, nullptr)
+       != SQLITE_OK)
+      return false;
+
+   const char *sql =
+      "INSERT INTO main.autosave(id, dict, doc) VALUES(1, ?1, ?2)"
+      "       ON CONFLICT(id) DO UPDATE SET dict = ?1, doc = ?2;";
+   if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK ||
+       sqlite3_bind_zeroblob(stmt, 1, dict.size()) ||
+       sqlite3_bind_zeroblob(stmt, 2, data.GetSize()) ||
+       sqlite3_step(stmt) != SQLITE_DONE)
+      return false;
+   sqlite3_finalize(stmt);
+   stmt = nullptr;
+
+   if (sqlite3_prepare_v2(db, "SELECT ROWID FROM main.autosave WHERE id = 1;",
+          -1, &stmt, nullptr) != SQLITE_OK ||
+       sqlite3_step(stmt) != SQLITE_ROW)
+      return false;
+   const int64_t rowID = sqlite3_column_int64(stmt, 0);
+   sqlite3_finalize(stmt);
+   stmt = nullptr;
+
+   {
+      auto blobStream =
+         SQLiteBlobStream::Open(db, "main", "autosave", "dict", rowID, false);
+      if (!blobStream ||
+          (!dict.empty() &&
+           blobStream->Write(dict.data(), dict.size()) != SQLITE_OK) ||
+          blobStream->Close() != SQLITE_OK)
+         return false;
+   }
+
+   {
+      auto blobStream =
+         SQLiteBlobStream::Open(db, "main", "autosave", "doc", rowID, false);
+      if (!blobStream)
+         return false;
+      for (auto chunk : data)
+         if (SQLITE_OK != blobStream->Write(chunk.first, chunk.second))
+            return false;
+      if (blobStream->Close() != SQLITE_OK)
+         return false;
+   }
+
+   char setVersionSql[64];
+   sqlite3_snprintf(sizeof(setVersionSql), setVersionSql,
+      "PRAGMA user_version = %u", requiredVersion);
+   if (sqlite3_exec(db, setVersionSql, nullptr, nullptr, nullptr) !=
+          SQLITE_OK ||
+       sqlite3_exec(db, "COMMIT;", nullptr, nullptr, nullptr) != SQLITE_OK)
+      return false;
+
+   success = true;
+   return true;
+}
+}
+
+void ProjectFileIO::WriteAutoSaveInBackground(
+   DBConnection &connection, std::shared_ptr<ProjectSerializer> pAutosave)
+{
+   const auto requiredVersion = ProjectFormatExtensionsRegistry::Get()
+      .GetRequiredVersion(mProject).GetPacked();
+   // The dictionary is shared with serializers in this thread, so copy it
+   connection.WriteInBackground(
+      [dict = ProjectSerializer::CopyDict(), pAutosave = std::move(pAutosave),
+         requiredVersion](sqlite3 *db)
+   {
+      if (!WriteAutoSaveDoc(db, dict, pAutosave->GetData(), requiredVersion))
+         // Report to the user in the main thread, in idle time
+         GuardedCall([]{
+            throw SimpleMessageBoxException{
+               ExceptionType::Internal,
+               XO("Automatic database backup failed."),
+               XO("Warning"),
+               "Error:_Disk_full_or_not_writable"
+            };
+         });
+   });
+}
+
+void ProjectFileIO::WaitForBackgroundAutoSave()
+{
+   if (auto &curConn = CurrConn())
+      curConn->WaitForBackgroundWrite();
+}
+
+void ProjectFileIO::BeginLongRecording(int64_t expectedBytes)
+{
+   auto &curConn = CurrConn();
+   if (!curConn)
+      return;
+   curConn->ReserveSpace(expectedBytes);
+   DBConnection::CheckpointPolicy policy;
+   policy.pages = 64;
+   curConn->SetCheckpointPolicy(policy);
+}
+
+void ProjectFileIO::EndLongRecording()
+{
+   auto &curConn = CurrConn();
+   if (!curConn)
+      return;
+   curConn->ReserveSpace(0);
+   curConn->SetCheckpointPolicy({});
 }
 
 bool ProjectFileIO::AutoSaveDelete(sqlite3 *db /* = nullptr */)
@@ -1809,6 +2213,9 @@ bool ProjectFileIO::AutoSaveDelete(sqlite3 *db /* = nullptr */)
       db = DB();
    }
 
+   // A document written later would restore what is deleted here
+   WaitForBackgroundAutoSave();
+
    rc = sqlite3_exec(db, "DELETE FROM autosave;", nullptr, nullptr, nullptr);
    if (rc != SQLITE_OK)
    {
@@ -1830,6 +2237,19 @@ bool ProjectFileIO::WriteDoc(const char *table,
                              const ProjectSerializer &autosave,
                              const char *schema /* = "main" */)
 {
+   if (IsReadOnly())
+   {
+      SetError(XO("The project was opened read-only and cannot be saved"));
+      return false;
+   }
+
+   // The document must not refer to incomplete rows
+   if (!FlushSampleBlocks())
+      return false;
+
+   // Don't let an older autosave document be written after this one
+   WaitForBackgroundAutoSave();
+
    auto db = DB();
 
    TransactionScope transaction(mProject, "UpdateProject");
@@ -2027,7 +2447,8 @@ void ProjectFileIO::TentativeConnection::Commit()
    }
 }
 
-auto ProjectFileIO::LoadProject(const FilePath &fileName, bool ignoreAutosave)
+auto ProjectFileIO::LoadProject(
+   const FilePath &fileName, bool ignoreAutosave, bool readOnly)
    -> std::optional<TentativeConnection>
 {
    auto now = std::chrono::high_resolution_clock::now();
@@ -2037,7 +2458,7 @@ auto ProjectFileIO::LoadProject(const FilePath &fileName, bool ignoreAutosave)
    bool success = false;
 
    // Open the project file
-   if (!OpenConnection(fileName))
+   if (!OpenConnection(fileName, readOnly))
       return {};
 
    int64_t rowId = -1;
@@ -2065,6 +2486,12 @@ auto ProjectFileIO::LoadProject(const FilePath &fileName, bool ignoreAutosave)
       return {};
    else
    {
+      // Read the sample block rows meanwhile, instead of one by one as
+      // the document refers to them
+      auto &connection = GetConnection();
+      connection.PrefetchSampleBlocks();
+      auto endPrefetch = finally([&]{ connection.EndPrefetch(); });
+
       // Load 'er up
       BufferedProjectBlobStream stream(
          DB(), "main", useAutosave ? "autosave" : "project", rowId);
@@ -2081,10 +2508,30 @@ auto ProjectFileIO::LoadProject(const FilePath &fileName, bool ignoreAutosave)
 
       // Check for orphans blocks...sets mRecovered if any were deleted
       
-      auto blockids = WaveTrackFactory::Get( mProject )
-         .GetSampleBlockFactory()
-            ->GetActiveBlockIDs();
-      if (blockids.size() > 0)
+      auto blockids = readOnly
+         ? SampleBlockFactory::SampleBlockIDs{}
+         : WaveTrackFactory::Get( mProject )
+            .GetSampleBlockFactory()
+               ->GetActiveBlockIDs();
+      std::vector<int64_t> orphans;
+      if (blockids.size() > 0 && connection.GetPrefetchedBlockIDs(orphans))
+      {
+         // Find the orphans among the rows already read, without a query,
+         // and let the connection delete them in the background
+         orphans.erase(std::remove_if(orphans.begin(), orphans.end(),
+            [&](int64_t id){
+               return blockids.count(id) > 0 ||
+                  ProjectFileIOExtensionRegistry::IsBlockLocked(mProject, id);
+            }), orphans.end());
+         if (!orphans.empty())
+         {
+            wxLogInfo(XO("Total orphan blocks deleted %d").Translation(),
+               static_cast<int>(orphans.size()));
+            mRecovered = true;
+            connection.DeleteInBackground(move(orphans));
+         }
+      }
+      else if (blockids.size() > 0)
       {
          success = DeleteBlocks(blockids, true);
          if (!success)
@@ -2363,9 +2810,9 @@ bool ProjectFileIO::SaveCopy(const FilePath& fileName)
       {&TrackList::Get(mProject)});
 }
 
-bool ProjectFileIO::OpenProject()
+bool ProjectFileIO::OpenProject(bool readOnly)
 {
-   return OpenConnection();
+   return OpenConnection({}, readOnly);
 }
 
 void ProjectFileIO::CloseProject()
@@ -2424,6 +2871,28 @@ bool ProjectFileIO::IsRecovered() const
    return mRecovered;
 }
 
+bool ProjectFileIO::FlushSampleBlocks()
+{
+   return GuardedCall<bool>( [&]{
+      auto &pFactory = WaveTrackFactory::Get( mProject ).GetSampleBlockFactory();
+      pFactory->FlushDeferred();
+      // Last, because it waits for the writes
+      pFactory->Flush();
+      return true;
+   }, MakeSimpleGuard( false ) );
+}
+
+bool ProjectFileIO::MaterializeDeferredBlocks()
+{
+   return FlushSampleBlocks();
+}
+
+bool ProjectFileIO::IsReadOnly() const
+{
+   auto &curConn = ConnectionPtr::Get( mProject ).mpConnection;
+   return curConn && curConn->IsReadOnly();
+}
+
 void ProjectFileIO::MarkTemporary()
 {
    mTemporary = true;
@@ -2568,7 +3037,15 @@ int64_t ProjectFileIO::GetTotalUsage()
    auto pConn = CurrConn().get();
    if (!pConn)
       return 0;
-   return GetDiskUsage(*pConn, 0);
+   if (const auto usage = pConn->GetSpaceUsage())
+      return *usage;
+
+   // Scan the rows once; then the sample blocks keep the total as they
+   // insert, update and delete them
+   pConn->WaitForBackgroundWrite();
+   const auto usage = GetDiskUsage(*pConn, 0);
+   pConn->SetSpaceUsage(usage);
+   return usage;
 }
 
 //
@@ -11,13 +11,16 @@ Paul Licameli split from AudacityProject.h
 #ifndef __AUDACITY_PROJECT_FILE_IO__
 #define __AUDACITY_PROJECT_FILE_IO__
 
+#include <functional>
 #include <memory>
 #include <optional>
+#include <unordered_map>
 #include <unordered_set>
 
 #include <wx/event.h>
 
 #include "ClientData.h" // to inherit
+#include "MemoryStream.h"
 #include "Observer.h"
 #include "Prefs.h" // to inherit
 #include "XMLTagHandler.h" // to inherit
@@ -32,6 +35,7 @@ class DBConnection;
 struct DBConnectionErrors;
 class ProjectSerializer;
 class SqliteSampleBlock;
+class Track;
 class TrackList;
 class WaveTrack;
 
@@ -107,20 +111,31 @@ public:
    bool IsModified() const;
    bool IsTemporary() const;
    bool IsRecovered() const;
+   //! Whether the current connection was opened for reviewing only
+   bool IsReadOnly() const;
 
    void MarkTemporary();
 
+   //! Write the autosave document; with recording, the write may be done
+   //! later in a worker thread, and tracks not being recorded are
+   //! written as in the previous autosave
    bool AutoSave(bool recording = false);
    bool AutoSaveDelete(sqlite3 *db = nullptr);
 
-   bool OpenProject();
+   //! @param readOnly see LoadProject
+   bool OpenProject(bool readOnly = false);
    void CloseProject();
    bool ReopenProject();
 
    //! If successful, return non-empty; the caller must commit to keep the
    //! association of the opened file with the project
-   std::optional<TentativeConnection>
-      LoadProject(const FilePath &fileName, bool ignoreAutosave);
+   /*!
+    @param readOnly if true, open for listening and measuring only: the file
+    is memory-mapped, never checkpointed, and orphan blocks are not removed;
+    saving and autosaving fail
+    */
+   std::optional<TentativeConnection> LoadProject(const FilePath &fileName,
+      bool ignoreAutosave, bool readOnly = false);
 
    bool UpdateSaved(const TrackList *tracks = nullptr);
    bool SaveProject(const FilePath &fileName, const TrackList *lastSaved);
@@ -137,6 +152,7 @@ public:
 
    // Return the bytes used by all sample blocks in the project file, whether
    // they are attached to the active tracks or held by the Undo manager.
+   // Only the first call scans them; the connection keeps a running total.
    int64_t GetTotalUsage();
 
    // Return the bytes used for the given block using the connection to a
@@ -167,6 +183,20 @@ public:
    //    ProjectManager::OnCloseWindow()
    void SetBypass();
 
+   //! Prepare the database for a long unattended recording of about so many
+   //! bytes: reserve room for it, and checkpoint the log in smaller steps, so
+   //! that the recording is durable as it goes and little is left to copy
+   //! when it stops
+   void BeginLongRecording(int64_t expectedBytes);
+   //! Restore what BeginLongRecording() changed
+   void EndLongRecording();
+
+   //! Copy into the database the samples of blocks that are still only in
+   //! imported files or in other projects, and complete deferred writes
+   /*! As before another project, from which audio was pasted, closes.
+    @return false if that failed */
+   bool MaterializeDeferredBlocks();
+
 private:
    //! Strings like -wal that may be appended to main project name to get other files created by
    //! the database system
@@ -201,18 +231,32 @@ public:
       FilePath mPath, mSafety;
    };
 
-   // Remove all unused space within a project file
-   void Compact(
-      const std::vector<const TrackList *> &tracks, bool force = false);
+   // Remove all unused space within a project file.
+   // Files made with incremental vacuuming are compacted in place, in steps,
+   // stopping after maxSeconds if positive; what remains is resumed by the
+   // next call, perhaps in another session.
+   void Compact(const std::vector<const TrackList *> &tracks,
+      bool force = false, double maxSeconds = 0);
+
+   //! Space that compaction in place could still reclaim
+   struct CompactProgress {
+      unsigned long long freePages{ 0 };
+      unsigned long long totalPages{ 0 };
+      //! Whether the file can be compacted in place, without a copy
+      bool incremental{ false };
+   };
+   CompactProgress GetCompactProgress();
 
-   // The last compact check did actually compact the project file if true
+   // The last compact check did actually compact the project file if true.
+   // Compaction in place leaves this false:  the documents are not rewritten.
    bool WasCompacted();
 
    // The last compact check found unused blocks in the project file
    bool HadUnused();
 
    // In one SQL command, delete sample blocks with ids in the given set, or
-   // (when complement is true), with ids not in the given set.
+   // (when complement is true), with ids not in the given set.  The set is
+   // loaded into a temporary table, so SQLite joins it by key.
    bool DeleteBlocks(const BlockIDs &blockids, bool complement);
 
    // Type of function that is given the fields of one row and returns
@@ -232,8 +276,13 @@ private:
    void OnCheckpointFailure();
 
    void WriteXMLHeader(XMLWriter &xmlFile) const;
+
+   //! Writes a track; pending is true for a track that is being recorded
+   using TrackWriter = std::function<void(const Track &track, bool pending)>;
+   //! @param writeTrack if empty, each track writes itself to xmlFile
    void WriteXML(XMLWriter &xmlFile, bool recording = false,
-      const TrackList *tracks = nullptr) /* not override */;
+      const TrackList *tracks = nullptr,
+      const TrackWriter &writeTrack = {}) /* not override */;
 
    // XMLTagHandler callback methods
    bool HandleXMLTag(const std::string_view& tag, const AttributesList &attrs) override;
@@ -248,7 +297,12 @@ private:
    // if opening fails.
    sqlite3 *DB();
 
-   bool OpenConnection(FilePath fileName = {});
+   bool OpenConnection(FilePath fileName = {}, bool readOnly = false);
+
+   //! Copy into the database the samples of blocks that are still only in
+   //! imported files or in other projects, and complete deferred writes of
+   //! sample blocks; false if that failed
+   bool FlushSampleBlocks();
    bool CloseConnection();
 
    // Put the current database connection aside, keeping it open, so that
@@ -275,8 +329,15 @@ private:
    // Write project or autosave XML (binary) documents
    bool WriteDoc(const char *table, const ProjectSerializer &autosave, const char *schema = "main");
 
-   // Application defined function to verify blockid exists is in set of blockids
-   static void InSet(sqlite3_context *context, int argc, sqlite3_value **argv);
+   //! Write the autosave document in a worker thread with another connection
+   void WriteAutoSaveInBackground(
+      DBConnection &connection, std::shared_ptr<ProjectSerializer> pAutosave);
+   //! Finish any autosave in the worker thread, before replacing or deleting
+   //! the document
+   void WaitForBackgroundAutoSave();
+
+   // Application defined function to verify blockid is locked by an extension
+   static void IsLocked(sqlite3_context *context, int argc, sqlite3_value **argv);
 
    // Return a database connection if successful, which caller must close
    bool CopyTo(const FilePath &destpath,
@@ -302,6 +363,21 @@ private:
    bool ShouldCompact(const std::vector<const TrackList *> &tracks);
 
 private:
+   //! Store a set of blockids in a temporary table, for the deletions
+   //! @return false for failure, with the error set
+   bool StoreBlockSet(const BlockIDs &blockids);
+   //! Drop the table of StoreBlockSet()
+   void DropBlockSet();
+
+   //! Delete at most maxBlocks sample blocks not in the stored set
+   //! @pre StoreBlockSet() succeeded
+   //! @return number deleted, or -1 for failure
+   int DeleteUnusedBlocks(size_t maxBlocks);
+
+   //! Delete unused blocks (if pActive is not null), then return free pages
+   //! to the file system, in bounded steps
+   bool CompactIncrementally(const BlockIDs *pActive, double maxSeconds);
+
    Connection &CurrConn();
 
    // non-static data members
@@ -332,6 +408,15 @@ private:
    Connection mPrevConn;
    FilePath mPrevFileName;
    bool mPrevTemporary;
+
+   //! Encoding of a track as of the last autosave, reused while recording
+   //! others
+   struct AutoSaveFragment {
+      std::weak_ptr<const Track> pTrack;
+      MemoryStream::StreamData data;
+   };
+   std::unordered_map<const Track*, AutoSaveFragment> mAutoSaveFragments;
+   Observer::Subscription mUndoSubscription;
 };
 
 //! Makes a temporary project that doesn't display on the screen
@@ -37,8 +37,9 @@
 // It is not intended that the user view or modify the file.
 //
 // It IS intended that very little work be done during auto save, so numbers
-// and strings are written in their native format.  They will be converted
-// during recovery.
+// are written in their native format.  They will be converted during
+// recovery.  Strings are written as UTF-8, which takes a quarter or half the
+// space of the native wide characters, and needs no conversion when read.
 //
 // The file has 3 main sections:
 //
@@ -53,7 +54,9 @@
 // To save space, each name (attribute or element) encountered is stored in
 // the name dictionary and replaced with the assigned 2-byte identifier.
 //
-// All strings are in native unicode format, 2-byte or 4-byte.
+// All strings are UTF-8, and the character size is 1.  Documents written by
+// earlier versions have native 2-byte or 4-byte strings, which the decoder
+// still converts.
 //
 // All name "lengths" are 2-byte signed, so are limited to 32767 bytes long.
 // All string/data "lengths" are 4-byte signed.
@@ -353,9 +356,9 @@ ProjectSerializer::ProjectSerializer(size_t allocSize)
    std::call_once(flag, []{
       // Just once per run, store header information in the unique static
       // dictionary that will be written into each project that is saved.
-      // Store the size of "wxStringCharType" so we can convert during recovery
-      // in case the file is used on a system with a different character size.
-      char size = sizeof(wxStringCharType);
+      // Store the character size, so that the decoder can tell UTF-8 from
+      // the wide characters written by earlier versions.
+      char size = 1;
       mDict.AppendByte(FT_CharSize);
       mDict.AppendData(&size, 1);
    });
@@ -389,9 +392,10 @@ void ProjectSerializer::WriteAttr(const wxString & name, const wxString & value)
    mBuffer.AppendByte(FT_String);
    WriteName(name);
 
-   const Length len = value.length() * sizeof(wxStringCharType);
+   const auto utf8 = value.utf8_str();
+   const Length len = utf8.length();
    WriteLength( mBuffer, len );
-   mBuffer.AppendData(value.wx_str(), len);
+   mBuffer.AppendData(utf8.data(), len);
 }
 
 void ProjectSerializer::WriteAttr(const wxString & name, int value)
@@ -456,22 +460,23 @@ void ProjectSerializer::WriteData(const wxString & value)
 {
    mBuffer.AppendByte(FT_Data);
 
-   Length len = value.length() * sizeof(wxStringCharType);
+   const auto utf8 = value.utf8_str();
+   const Length len = utf8.length();
    WriteLength( mBuffer, len );
-   mBuffer.AppendData(value.wx_str(), len);
+   mBuffer.AppendData(utf8.data(), len);
 }
 
 void ProjectSerializer::Write(const wxString & value)
 {
    mBuffer.AppendByte(FT_Raw);
-   Length len = value.length() * sizeof(wxStringCharType);
+   const auto utf8 = value.utf8_str();
+   const Length len = utf8.length();
    WriteLength( mBuffer, len );
-   mBuffer.AppendData(value.wx_str(), len);
+   mBuffer.AppendData(utf8.data(), len);
 }
 
 void ProjectSerializer::WriteName(const wxString & name)
 {
-   wxASSERT(name.length() * sizeof(wxStringCharType) <= SHRT_MAX);
    UShort id;
 
    auto nameiter = mNames.find(name);
@@ -483,7 +488,9 @@ void ProjectSerializer::WriteName(const wxString & name)
    {
       // mNames is static.  This appends each name to static mDict only once
       // in each run.
-      UShort len = name.length() * sizeof(wxStringCharType);
+      const auto utf8 = name.utf8_str();
+      wxASSERT(utf8.length() <= SHRT_MAX);
+      UShort len = utf8.length();
 
       id = mNames.size();
       mNames[name] = id;
@@ -491,7 +498,7 @@ void ProjectSerializer::WriteName(const wxString & name)
       mDict.AppendByte(FT_Name);
       WriteUShort( mDict, id );
       WriteUShort( mDict, len );
-      mDict.AppendData(name.wx_str(), len);
+      mDict.AppendData(utf8.data(), len);
 
       mDictChanged = true;
    }
@@ -519,6 +526,43 @@ bool ProjectSerializer::DictChanged() const
    return mDictChanged;
 }
 
+size_t ProjectSerializer::GetDataSize() const
+{
+   return mBuffer.GetSize();
+}
+
+MemoryStream::StreamData ProjectSerializer::CopyData(size_t from) const
+{
+   MemoryStream::StreamData result;
+   result.reserve(mBuffer.GetSize() - std::min(from, mBuffer.GetSize()));
+   size_t position = 0;
+   for (auto chunk : mBuffer)
+   {
+      const auto begin = static_cast<const uint8_t*>(chunk.first);
+      const auto skip = std::min(chunk.second, from - std::min(from, position));
+      result.insert(result.end(), begin + skip, begin + chunk.second);
+      position += chunk.second;
+   }
+   return result;
+}
+
+void ProjectSerializer::AppendData(const MemoryStream::StreamData &data)
+{
+   mBuffer.AppendData(data.data(), data.size());
+}
+
+MemoryStream::StreamData ProjectSerializer::CopyDict()
+{
+   MemoryStream::StreamData result;
+   result.reserve(mDict.GetSize());
+   for (auto chunk : mDict)
+   {
+      const auto begin = static_cast<const uint8_t*>(chunk.first);
+      result.insert(result.end(), begin, begin + chunk.second);
+   }
+   return result;
+}
+
 // See ProjectFileIO::LoadProject() for explanation of the blockids arg
 bool ProjectSerializer::Decode(BufferedStreamReader& in, XMLTagHandler* handler)
 {
@@ -551,9 +595,20 @@ bool ProjectSerializer::Decode(BufferedStreamReader& in, XMLTagHandler* handler)
 
    auto ReadString = [&mCharSize, &in, &bytes, &stringsCount, &stringsLength](int len) -> std::string
    {
-      bytes.reserve( len );
-      auto data = bytes.data();
-      in.Read( data, len );
+      // Borrow the bytes from the reader, unless they are longer than its
+      // buffer, or misaligned for wide characters
+      auto [data, size] = in.ReadView(len);
+      if (data == nullptr || size != static_cast<size_t>(len) ||
+          (mCharSize > 1 &&
+           reinterpret_cast<uintptr_t>(data) % mCharSize != 0))
+      {
+         bytes.resize( len );
+         if (data != nullptr)
+            std::copy_n(static_cast<const char*>(data), size, bytes.data());
+         else
+            in.Read( bytes.data(), len );
+         data = bytes.data();
+      }
 
       stringsCount++;
       stringsLength += len;
@@ -561,13 +616,13 @@ bool ProjectSerializer::Decode(BufferedStreamReader& in, XMLTagHandler* handler)
       switch (mCharSize)
       {
          case 1:
-            return std::string(bytes.data(), len);
+            return std::string(static_cast<const char*>(data), len);
 
          case 2:
-            return FastStringConvert<char16_t>(bytes.data(), len);
+            return FastStringConvert<char16_t>(data, len);
 
          case 4:
-            return FastStringConvert<char32_t>(bytes.data(), len);
+            return FastStringConvert<char32_t>(data, len);
 
          default:
             wxASSERT_MSG(false, wxT("Characters size not 1, 2, or 4"));
@@ -65,6 +65,18 @@ public:
    bool IsEmpty() const;
    bool DictChanged() const;
 
+   //! Bytes of data written so far
+   size_t GetDataSize() const;
+   //! Copy of the data written after the given size, such as the encoding of
+   //! one element, to be reused with AppendData() by another serializer
+   /*! Names refer to the shared dictionary, so the copy remains valid for
+    all serializers in the same run of the program */
+   MemoryStream::StreamData CopyData(size_t from) const;
+   void AppendData(const MemoryStream::StreamData &data);
+   //! Copy of the dictionary, which other threads may read while this thread
+   //! adds names
+   static MemoryStream::StreamData CopyDict();
+
    // Returns empty string if decoding fails
    static bool Decode(BufferedStreamReader& in, XMLTagHandler* handler);
 
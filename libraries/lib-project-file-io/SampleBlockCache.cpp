@@ -0,0 +1,190 @@
+/*!********************************************************************
+
+Audacity: A Digital Audio Editor
+
+@file SampleBlockCache.cpp
+
+**********************************************************************/
+
+#include "SampleBlockCache.h"
+#include "MemoryBudget.h"
+
+#include <algorithm>
+
+namespace {
+// Guards the set of caches, not their contents
+std::mutex &InstancesMutex()
+{
+   static std::mutex mutex;
+   return mutex;
+}
+
+std::vector<SampleBlockCache*> &Instances()
+{
+   static std::vector<SampleBlockCache*> instances;
+   return instances;
+}
+
+// Cheap to refill from the database, but it may hold much
+MemoryBudget::Consumer sConsumer{ "Sample block cache", 10,
+   []{
+      std::lock_guard<std::mutex> lock{ InstancesMutex() };
+      size_t bytes = 0;
+      for (auto pCache : Instances())
+         bytes += pCache->GetStatistics().bytes;
+      return bytes;
+   },
+   [](size_t bytes){
+      std::lock_guard<std::mutex> lock{ InstancesMutex() };
+      size_t freed = 0;
+      for (auto pCache : Instances()) {
+         if (freed >= bytes)
+            break;
+         freed += pCache->Evict(bytes - freed);
+      }
+      return freed;
+   }
+};
+}
+
+SampleBlockCache::SampleBlockCache(size_t budget)
+   : mBudget{ budget }
+{
+   std::lock_guard<std::mutex> lock{ InstancesMutex() };
+   Instances().push_back(this);
+}
+
+SampleBlockCache::~SampleBlockCache()
+{
+   std::lock_guard<std::mutex> lock{ InstancesMutex() };
+   auto &instances = Instances();
+   instances.erase(
+      std::remove(instances.begin(), instances.end(), this), instances.end());
+}
+
+auto SampleBlockCache::Find(SampleBlockID id) -> Payload
+{
+   std::lock_guard<std::mutex> lock{ mMutex };
+   const auto iter = mIndex.find(id);
+   // Pinned payloads remain available even if the cache is disabled
+   if (iter == mIndex.end() || (mBudget == 0 && !mPins.count(id))) {
+      if (mBudget > 0)
+         ++mMisses;
+      return {};
+   }
+   ++mHits;
+   // Move to front
+   mEntries.splice(mEntries.begin(), mEntries, iter->second);
+   return iter->second->payload;
+}
+
+bool SampleBlockCache::Contains(SampleBlockID id) const
+{
+   std::lock_guard<std::mutex> lock{ mMutex };
+   return (mBudget > 0 || mPins.count(id)) && mIndex.find(id) != mIndex.end();
+}
+
+void SampleBlockCache::Insert(SampleBlockID id, Payload payload)
+{
+   if (!payload)
+      return;
+   std::lock_guard<std::mutex> lock{ mMutex };
+   if (payload->size() > mBudget)
+      // Includes the disabled case; also don't flush everything else for
+      // one block that could never fit
+      return;
+   if (const auto iter = mIndex.find(id); iter != mIndex.end()) {
+      mBytes -= iter->second->payload->size();
+      mEntries.erase(iter->second);
+      mIndex.erase(iter);
+   }
+   mBytes += payload->size();
+   mEntries.push_front({ id, move(payload) });
+   mIndex[id] = mEntries.begin();
+   Trim();
+}
+
+void SampleBlockCache::Erase(SampleBlockID id)
+{
+   std::lock_guard<std::mutex> lock{ mMutex };
+   if (mPins.count(id))
+      return;
+   if (const auto iter = mIndex.find(id); iter != mIndex.end()) {
+      mBytes -= iter->second->payload->size();
+      mEntries.erase(iter->second);
+      mIndex.erase(iter);
+   }
+}
+
+void SampleBlockCache::Clear()
+{
+   std::lock_guard<std::mutex> lock{ mMutex };
+   EvictWhile([](size_t){ return true; });
+}
+
+void SampleBlockCache::SetBudget(size_t budget)
+{
+   std::lock_guard<std::mutex> lock{ mMutex };
+   mBudget = budget;
+   Trim();
+}
+
+size_t SampleBlockCache::GetBudget() const
+{
+   std::lock_guard<std::mutex> lock{ mMutex };
+   return mBudget;
+}
+
+SampleBlockFactory::CacheStatistics SampleBlockCache::GetStatistics() const
+{
+   std::lock_guard<std::mutex> lock{ mMutex };
+   return { mHits, mMisses, mBytes, mBudget };
+}
+
+bool SampleBlockCache::Pin(SampleBlockID id)
+{
+   std::lock_guard<std::mutex> lock{ mMutex };
+   if (mIndex.find(id) == mIndex.end())
+      return false;
+   ++mPins[id];
+   return true;
+}
+
+void SampleBlockCache::Unpin(SampleBlockID id)
+{
+   std::lock_guard<std::mutex> lock{ mMutex };
+   if (const auto iter = mPins.find(id);
+      iter != mPins.end() && --iter->second == 0)
+      mPins.erase(iter);
+}
+
+template<typename Predicate>
+size_t SampleBlockCache::EvictWhile(const Predicate &pred)
+{
+   size_t freed = 0;
+   // From the back, skipping pinned payloads, as of blocks being played
+   for (auto iter = mEntries.end(); iter != mEntries.begin();) {
+      auto &entry = *--iter;
+      if (mPins.count(entry.id))
+         continue;
+      if (!pred(freed))
+         break;
+      const auto size = entry.payload->size();
+      freed += size;
+      mBytes -= size;
+      mIndex.erase(entry.id);
+      iter = mEntries.erase(iter);
+   }
+   return freed;
+}
+
+size_t SampleBlockCache::Evict(size_t bytes)
+{
+   std::lock_guard<std::mutex> lock{ mMutex };
+   return EvictWhile([bytes](size_t freed){ return freed < bytes; });
+}
+
+void SampleBlockCache::Trim()
+{
+   EvictWhile([this](size_t){ return mBytes > mBudget; });
+}
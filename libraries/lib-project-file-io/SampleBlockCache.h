@@ -0,0 +1,94 @@
+/*!********************************************************************
+
+Audacity: A Digital Audio Editor
+
+@file SampleBlockCache.h
+@brief Byte-budgeted, least-recently-used cache of sample block contents
+
+**********************************************************************/
+
+#ifndef __AUDACITY_SAMPLE_BLOCK_CACHE__
+#define __AUDACITY_SAMPLE_BLOCK_CACHE__
+
+#include "SampleBlock.h"
+
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+//! Holds stored sample bytes of recently read blocks, shared by all blocks of
+//! one factory, so that repeated reads of hot blocks avoid the database
+/*! All member functions are thread-safe.  All caches together are a consumer
+ of the MemoryBudget, which may evict from them */
+class SampleBlockCache final
+{
+public:
+   //! Bytes of a block in its stored sample format
+   using Payload = std::shared_ptr<const std::vector<char>>;
+
+   explicit SampleBlockCache(size_t budget);
+   ~SampleBlockCache();
+
+   //! @return null, if not cached; counts a hit or miss unless disabled
+   Payload Find(SampleBlockID id);
+
+   //! Whether the id is cached, without counting a hit or miss, or changing
+   //! the order of eviction
+   bool Contains(SampleBlockID id) const;
+
+   //! Replaces any previous payload for the id; may evict others
+   void Insert(SampleBlockID id, Payload payload);
+
+   //! Has no effect on a pinned id, whose block is still in use, so its
+   //! stored samples can't have changed
+   void Erase(SampleBlockID id);
+   //! Frees all payloads that are not pinned
+   void Clear();
+
+   //! Exempt the payload of the id from evictions, including those of the
+   //! MemoryBudget, Clear(), Erase() and disabling of the cache, until as
+   //! many calls of Unpin(); calls nest
+   //! @return false, and has no effect, if the id is not cached
+   bool Pin(SampleBlockID id);
+   void Unpin(SampleBlockID id);
+
+   //! A budget of zero disables the cache
+   void SetBudget(size_t budget);
+   size_t GetBudget() const;
+
+   SampleBlockFactory::CacheStatistics GetStatistics() const;
+
+   //! Free the least recently used payloads that are not pinned, of at least
+   //! the given bytes if there are so many
+   //! @return bytes freed
+   size_t Evict(size_t bytes);
+
+private:
+   //! @pre mMutex is held
+   void Trim();
+   //! Free payloads that are not pinned, least recently used first, while
+   //! the predicate of the bytes freed so far holds
+   //! @pre mMutex is held
+   //! @return bytes freed
+   template<typename Predicate> size_t EvictWhile(const Predicate &pred);
+
+   struct Entry {
+      SampleBlockID id;
+      Payload payload;
+   };
+   //! Most recently used at front
+   using List = std::list<Entry>;
+
+   mutable std::mutex mMutex;
+   List mEntries;
+   std::unordered_map<SampleBlockID, List::iterator> mIndex;
+   //! Counts of pins of ids
+   std::unordered_map<SampleBlockID, size_t> mPins;
+   size_t mBudget;
+   size_t mBytes{ 0 };
+   size_t mHits{ 0 };
+   size_t mMisses{ 0 };
+};
+
+#endif
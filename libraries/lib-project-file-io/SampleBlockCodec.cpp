@@ -0,0 +1,286 @@
+/*!********************************************************************
+
+Audacity: A Digital Audio Editor
+
+@file SampleBlockCodec.cpp
+
+**********************************************************************/
+
+#include "SampleBlockCodec.h"
+
+#include <algorithm>
+#include <cstring>
+#include <sqlite3.h>
+
+#include "MemoryX.h"
+#include "Prefs.h"
+#include "Project.h"
+#include "XMLAttributeValueView.h"
+#include "XMLWriter.h"
+
+#if USE_WAVPACK
+#include <wavpack/wavpack.h>
+#endif
+
+namespace {
+constexpr char Magic[4] = { 'A', 'U', 'W', 'V' };
+constexpr size_t HeaderBytes = sizeof(Magic) + sizeof(uint32_t);
+//! Samples converted at a time to and from the codec's 32 bit words
+constexpr size_t ChunkSamples = 4096;
+
+#if USE_WAVPACK
+int WriteBytes(void *id, void *data, int32_t length)
+{
+   auto &bytes = *static_cast<std::vector<char>*>(id);
+   const auto start = static_cast<const char*>(data);
+   bytes.insert(bytes.end(), start, start + length);
+   return true;
+}
+
+//! Stream of an encoding in memory, for the decoder
+struct Reader {
+   const char *const data;
+   const int64_t size;
+   int64_t offset{ 0 };
+
+   static Reader &Get(void *id) { return *static_cast<Reader*>(id); }
+
+   static int32_t ReadBytes(void *id, void *dest, int32_t count)
+   {
+      auto &reader = Get(id);
+      const auto result = static_cast<int32_t>(
+         std::min<int64_t>(count, reader.size - reader.offset));
+      memcpy(dest, reader.data + reader.offset, result);
+      reader.offset += result;
+      return result;
+   }
+   static int32_t WriteBytes(void *, void *, int32_t) { return 0; }
+   static int64_t GetPos(void *id) { return Get(id).offset; }
+   static int SetPosAbs(void *id, int64_t pos)
+   {
+      return SetPosRel(id, pos, SEEK_SET);
+   }
+   static int SetPosRel(void *id, int64_t delta, int mode)
+   {
+      auto &reader = Get(id);
+      const auto base = mode == SEEK_SET ? 0
+         : mode == SEEK_CUR ? reader.offset
+         : reader.size;
+      const auto position = base + delta;
+      if (position < 0 || position > reader.size)
+         return 1;
+      reader.offset = position;
+      return 0;
+   }
+   // The decoder pushes back only a byte that it just read
+   static int PushBackByte(void *id, int c)
+   {
+      auto &reader = Get(id);
+      if (reader.offset == 0)
+         return EOF;
+      --reader.offset;
+      return c;
+   }
+   static int64_t GetLength(void *id) { return Get(id).size; }
+   static int CanSeek(void *) { return 1; }
+   static int Close(void *) { return 0; }
+
+   static WavpackStreamReader64 functions;
+};
+
+WavpackStreamReader64 Reader::functions {
+   ReadBytes, WriteBytes, GetPos, SetPosAbs, SetPosRel, PushBackByte,
+   GetLength, CanSeek, nullptr, Close
+};
+
+bool DoEncode(std::vector<char> &result,
+   constSamplePtr src, size_t numsamples, sampleFormat format)
+{
+   const auto context = WavpackOpenFileOutput(WriteBytes, &result, nullptr);
+   if (!context)
+      return false;
+   auto cleanup = finally([&]{ WavpackCloseFile(context); });
+
+   WavpackConfig config{};
+   config.num_channels = 1;
+   config.channel_mask = 0x4;
+   // Sample rate is irrelevant, so just set it to something
+   config.sample_rate = 48000;
+   config.bytes_per_sample = SAMPLE_SIZE_DISK(format);
+   config.bits_per_sample = config.bytes_per_sample * 8;
+   config.float_norm_exp = format == floatSample ? 127 : 0;
+   if (!WavpackSetConfiguration(context, &config, numsamples) ||
+       !WavpackPackInit(context))
+      return false;
+
+   // 24 bit and float samples are already in 32 bit words
+   int32_t buffer[ChunkSamples];
+   for (size_t done = 0; done < numsamples;) {
+      const auto count = std::min(ChunkSamples, numsamples - done);
+      if (format == int16Sample) {
+         const auto samples = reinterpret_cast<const int16_t*>(src) + done;
+         std::copy(samples, samples + count, buffer);
+      }
+      else
+         memcpy(buffer, src + done * sizeof(int32_t), count * sizeof(int32_t));
+      if (!WavpackPackSamples(context, buffer, count))
+         return false;
+      done += count;
+   }
+   return WavpackFlushSamples(context);
+}
+#endif
+}
+
+bool SampleBlockCodec::IsAvailable()
+{
+#if USE_WAVPACK
+   return true;
+#else
+   return false;
+#endif
+}
+
+std::vector<char> SampleBlockCodec::Encode(
+   constSamplePtr src, size_t numsamples, sampleFormat format)
+{
+#if USE_WAVPACK
+   if (numsamples == 0)
+      return {};
+
+   std::vector<char> result(HeaderBytes);
+   memcpy(result.data(), Magic, sizeof(Magic));
+   const auto count = static_cast<uint32_t>(numsamples);
+   memcpy(result.data() + sizeof(Magic), &count, sizeof(count));
+   if (!DoEncode(result, src, numsamples, format))
+      return {};
+
+   // Storing raw samples is better than no gain; and make sure of the
+   // round trip, so that no project is ever lossy
+   const auto bytes = numsamples * SAMPLE_SIZE(format);
+   if (result.size() >= bytes)
+      return {};
+   SampleBuffer check{ numsamples, format };
+   if (!Decode(result.data(), result.size(), format, check.ptr(), numsamples) ||
+       memcmp(check.ptr(), src, bytes) != 0)
+      return {};
+   return result;
+#else
+   return {};
+#endif
+}
+
+size_t SampleBlockCodec::GetSampleCount(const void *data, size_t bytes)
+{
+   if (!data || bytes < HeaderBytes || memcmp(data, Magic, sizeof(Magic)))
+      return 0;
+   uint32_t count;
+   memcpy(&count, static_cast<const char*>(data) + sizeof(Magic), sizeof(count));
+   return count;
+}
+
+size_t SampleBlockCodec::ReadSampleCount(sqlite3 *db, int64_t blockID)
+{
+   sqlite3_blob *blob = nullptr;
+   if (sqlite3_blob_open(db, "main", "sampleblocks", "samples", blockID, 0,
+          &blob) != SQLITE_OK) {
+      sqlite3_blob_close(blob);
+      return 0;
+   }
+   char header[HeaderBytes];
+   const auto ok = sqlite3_blob_bytes(blob) >= static_cast<int>(HeaderBytes) &&
+      sqlite3_blob_read(blob, header, HeaderBytes, 0) == SQLITE_OK;
+   sqlite3_blob_close(blob);
+   return ok ? GetSampleCount(header, HeaderBytes) : 0;
+}
+
+bool SampleBlockCodec::Decode(const void *data, size_t bytes,
+   sampleFormat format, samplePtr dest, size_t numsamples)
+{
+#if USE_WAVPACK
+   if (numsamples == 0 || GetSampleCount(data, bytes) != numsamples)
+      return false;
+
+   Reader reader{ static_cast<const char*>(data) + HeaderBytes,
+      static_cast<int64_t>(bytes - HeaderBytes) };
+   char error[80];
+   const auto context = WavpackOpenFileInputEx64(
+      &Reader::functions, &reader, nullptr, error, 0, 0);
+   if (!context)
+      return false;
+   auto cleanup = finally([&]{ WavpackCloseFile(context); });
+
+   const bool isFloat = (WavpackGetMode(context) & MODE_FLOAT) != 0;
+   if (WavpackGetNumChannels(context) != 1 ||
+       WavpackGetNumSamples64(context) != static_cast<int64_t>(numsamples) ||
+       WavpackGetBytesPerSample(context) !=
+         static_cast<int>(SAMPLE_SIZE_DISK(format)) ||
+       isFloat != (format == floatSample))
+      return false;
+
+   int32_t buffer[ChunkSamples];
+   for (size_t done = 0; done < numsamples;) {
+      const auto count = std::min(ChunkSamples, numsamples - done);
+      if (WavpackUnpackSamples(context, buffer, count) != count)
+         return false;
+      if (format == int16Sample)
+         std::copy(buffer, buffer + count,
+            reinterpret_cast<int16_t*>(dest) + done);
+      else
+         memcpy(dest + done * sizeof(int32_t), buffer, count * sizeof(int32_t));
+      done += count;
+   }
+   return true;
+#else
+   return false;
+#endif
+}
+
+BoolSetting SampleBlockCompression::DefaultEnabled{
+   L"/SampleBlocks/Compress", false };
+
+static const AudacityProject::AttachedObjects::RegisteredFactory
+sKey{
+  []( AudacityProject & ){
+     return std::make_shared< SampleBlockCompression >();
+   }
+};
+
+SampleBlockCompression &SampleBlockCompression::Get(AudacityProject &project)
+{
+   return project.AttachedObjects::Get< SampleBlockCompression >( sKey );
+}
+
+const SampleBlockCompression &SampleBlockCompression::Get(
+   const AudacityProject &project)
+{
+   return Get( const_cast< AudacityProject & >( project ) );
+}
+
+SampleBlockCompression::SampleBlockCompression()
+   : mEnabled{ SampleBlockCodec::IsAvailable() && DefaultEnabled.Read() }
+{
+}
+
+SampleBlockCompression::~SampleBlockCompression() = default;
+
+void SampleBlockCompression::SetEnabled(bool enabled)
+{
+   mEnabled.store(enabled && SampleBlockCodec::IsAvailable(),
+      std::memory_order_relaxed);
+}
+
+static ProjectFileIORegistry::AttributeWriterEntry entry {
+[](const AudacityProject &project, XMLWriter &xmlFile){
+   xmlFile.WriteAttr(wxT("compressblocks"),
+      SampleBlockCompression::Get(project).IsEnabled());
+}
+};
+
+static ProjectFileIORegistry::AttributeReaderEntries entries {
+// Just a pointer to function, but needing overload resolution as non-const:
+(SampleBlockCompression& (*)(AudacityProject &)) &SampleBlockCompression::Get, {
+   { "compressblocks", [](auto &compression, auto value){
+      compression.SetEnabled(value.Get(compression.IsEnabled()));
+   } },
+} };
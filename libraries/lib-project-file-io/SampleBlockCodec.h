@@ -0,0 +1,78 @@
+/*!********************************************************************
+
+Audacity: A Digital Audio Editor
+
+@file SampleBlockCodec.h
+@brief Lossless encoding of the samples of sample blocks, and the project
+setting that chooses it
+
+**********************************************************************/
+
+#ifndef __AUDACITY_SAMPLE_BLOCK_CODEC__
+#define __AUDACITY_SAMPLE_BLOCK_CODEC__
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "ClientData.h"
+#include "SampleFormat.h"
+
+class AudacityProject;
+class BoolSetting;
+struct sqlite3;
+
+//! Stores samples of a block in a WavPack lossless stream, after a header
+//! that gives their count
+namespace SampleBlockCodec {
+
+//! Or-ed into the sampleformat column of rows whose samples are encoded
+constexpr int EncodedFlag = 0x40000000;
+
+//! Whether this build can encode and decode
+PROJECT_FILE_IO_API bool IsAvailable();
+
+//! @return the encoding, or empty if unavailable, or if it would not be
+//! smaller than the samples, or not decode to the same bytes
+std::vector<char> Encode(
+   constSamplePtr src, size_t numsamples, sampleFormat format);
+
+//! @return the count of samples in an encoding, or 0 if it is not valid
+size_t GetSampleCount(const void *data, size_t bytes);
+
+//! Read the count of samples in the encoded samples of a row, fetching only
+//! the header
+/*! @return 0 if the row or header is not valid */
+size_t ReadSampleCount(sqlite3 *db, int64_t blockID);
+
+//! Decode all samples, in the format they were encoded from
+/*! @return whether the encoding was valid, of numsamples in the format */
+bool Decode(const void *data, size_t bytes,
+   sampleFormat format, samplePtr dest, size_t numsamples);
+}
+
+//! Whether new sample blocks of a project are encoded
+/*! Saved with the project.  Blocks keep the storage they were made with. */
+class PROJECT_FILE_IO_API SampleBlockCompression final
+   : public ClientData::Base
+{
+public:
+   //! Whether new projects compress, where the codec is available
+   static BoolSetting DefaultEnabled;
+
+   static SampleBlockCompression &Get(AudacityProject &project);
+   static const SampleBlockCompression &Get(const AudacityProject &project);
+
+   SampleBlockCompression();
+   ~SampleBlockCompression() override;
+
+   //! May be called from any thread
+   bool IsEnabled() const { return mEnabled.load(std::memory_order_relaxed); }
+   //! Has effect only if SampleBlockCodec::IsAvailable()
+   void SetEnabled(bool enabled);
+
+private:
+   std::atomic<bool> mEnabled;
+};
+
+#endif
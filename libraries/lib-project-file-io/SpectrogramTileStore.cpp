@@ -0,0 +1,342 @@
+/*!********************************************************************
+
+Audacity: A Digital Audio Editor
+
+@file SpectrogramTileStore.cpp
+
+**********************************************************************/
+
+#include "SpectrogramTileStore.h"
+
+#include <sqlite3.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include <wx/log.h>
+
+#include "BasicUI.h"
+#include "DBConnection.h"
+#include "MemoryX.h"
+#include "Project.h"
+#include "ProjectFileIO.h"
+
+namespace {
+
+// CREATE SQL spectrogramtiles
+// positions is an array of 64 bit sample positions of the columns.
+// magnitudes is an array of 16 bit values in hundredths of a decibel, column
+// by column, with equal numbers of values per column.
+// firstsample and lastsample repeat the least and greatest positions.
+//
+// Rows are immutable -- never updated after addition, but may be deleted.
+const char *TileSchema =
+   "CREATE TABLE IF NOT EXISTS main.spectrogramtiles"
+   "("
+   "  tileid               INTEGER PRIMARY KEY AUTOINCREMENT,"
+   "  contentkey           INTEGER,"
+   "  settingskey          INTEGER,"
+   "  firstsample          INTEGER,"
+   "  lastsample           INTEGER,"
+   "  positions            BLOB,"
+   "  magnitudes           BLOB"
+   ");"
+   "CREATE INDEX IF NOT EXISTS main.spectrogramtiles_key"
+   "  ON spectrogramtiles (contentkey, settingskey, firstsample);";
+
+//! The table shrinks to three quarters of this, when it exceeds it
+constexpr long long BudgetBytes = 256ll << 20;
+
+constexpr float ValuesPerDecibel = 100.0f;
+
+sqlite3_int64 ToInt64(uint64_t key)
+{
+   // SQLite integers are signed; keep all the bits
+   sqlite3_int64 result;
+   memcpy(&result, &key, sizeof(result));
+   return result;
+}
+
+}
+
+static const AudacityProject::AttachedObjects::RegisteredFactory sKey{
+   []( AudacityProject &parent ){
+      return std::make_shared< SpectrogramTileStore >( parent );
+   }
+};
+
+SpectrogramTileStore &SpectrogramTileStore::Get(AudacityProject &project)
+{
+   return project.AttachedObjects::Get< SpectrogramTileStore >( sKey );
+}
+
+SpectrogramTileStore::SpectrogramTileStore(AudacityProject &project)
+   : mProject{ project }
+{
+}
+
+SpectrogramTileStore::~SpectrogramTileStore() = default;
+
+DBConnection *SpectrogramTileStore::Connection(bool create)
+{
+   auto &projectFileIO = ProjectFileIO::Get(mProject);
+   if (!projectFileIO.HasConnection())
+      return nullptr;
+   auto &conn = projectFileIO.GetConnection();
+   const auto db = conn.DB();
+   if (!db)
+      return nullptr;
+   if (&conn == mCheckedConnection && db == mCheckedDB)
+      return &conn;
+
+   bool exists = false;
+   int rc = sqlite3_exec(db,
+      "SELECT 1 FROM main.sqlite_master"
+      "   WHERE type = 'table' AND name = 'spectrogramtiles';",
+      [](void *data, int, char **, char **) {
+         *static_cast<bool*>(data) = true;
+         return 0;
+      }, &exists, nullptr);
+   if (rc != SQLITE_OK)
+      return nullptr;
+
+   if (!exists) {
+      if (!create || conn.IsReadOnly())
+         return nullptr;
+      rc = sqlite3_exec(db, TileSchema, nullptr, nullptr, nullptr);
+      if (rc != SQLITE_OK) {
+         wxLogDebug(wxT("SpectrogramTileStore - SQLITE error %s"),
+            sqlite3_errmsg(db));
+         return nullptr;
+      }
+   }
+
+   mCheckedConnection = &conn;
+   mCheckedDB = db;
+   mStoredBytes = -1;
+   return &conn;
+}
+
+auto SpectrogramTileStore::Load(
+   const Key &key, Position first, Position last,
+   const std::function<bool(Position)> &wanted) -> std::vector<Tile>
+{
+   std::vector<Tile> result;
+   const auto pConn = Connection(false);
+   if (!pConn)
+      return result;
+
+   // Prepare and cache statement...automatically finalized at DB close
+   sqlite3_stmt *stmt = pConn->Prepare(DBConnection::LoadSpectrogramTiles,
+      "SELECT positions, magnitudes FROM spectrogramtiles"
+      "   WHERE contentkey = ?1 AND settingskey = ?2"
+      "      AND firstsample <= ?4 AND lastsample >= ?3;");
+   auto cleanup = finally([stmt]{
+      // Clear statement bindings and rewind statement
+      sqlite3_clear_bindings(stmt);
+      sqlite3_reset(stmt);
+   });
+
+   if (sqlite3_bind_int64(stmt, 1, ToInt64(key.content)) ||
+       sqlite3_bind_int64(stmt, 2, ToInt64(key.settings)) ||
+       sqlite3_bind_int64(stmt, 3, first) ||
+       sqlite3_bind_int64(stmt, 4, last))
+   {
+      wxASSERT_MSG(false, wxT("Binding failed...bug!!!"));
+      return result;
+   }
+
+   int rc;
+   while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+      // Read the small positions column first, so that the values, in
+      // overflow pages, are read only for useful tiles
+      const auto nPositions =
+         sqlite3_column_bytes(stmt, 0) / sizeof(Position);
+      if (nPositions == 0)
+         continue;
+      Tile tile;
+      tile.positions.resize(nPositions);
+      // The blob might not be aligned
+      memcpy(tile.positions.data(), sqlite3_column_blob(stmt, 0),
+         nPositions * sizeof(Position));
+      if (std::none_of(
+         tile.positions.begin(), tile.positions.end(), wanted))
+         continue;
+
+      const auto nValues = sqlite3_column_bytes(stmt, 1) / sizeof(int16_t);
+      if (nValues == 0 || nValues % nPositions != 0)
+         continue;
+      std::vector<int16_t> magnitudes(nValues);
+      memcpy(magnitudes.data(), sqlite3_column_blob(stmt, 1),
+         nValues * sizeof(int16_t));
+      tile.values.resize(nValues);
+      std::transform(magnitudes.begin(), magnitudes.end(),
+         tile.values.begin(),
+         [](int16_t value){ return value / ValuesPerDecibel; });
+      result.push_back(std::move(tile));
+   }
+
+   if (rc != SQLITE_DONE)
+      wxLogDebug(wxT("SpectrogramTileStore::Load - SQLITE error %s"),
+         sqlite3_errmsg(pConn->DB()));
+
+   return result;
+}
+
+void SpectrogramTileStore::Store(const Key &key, Tile tile)
+{
+   if (tile.positions.empty())
+      return;
+   mPending.push_back({ key, std::move(tile) });
+   if (!mFlushScheduled) {
+      mFlushScheduled = true;
+      BasicUI::CallAfter([wThis = weak_from_this()]{
+         if (auto pThis = wThis.lock()) {
+            pThis->mFlushScheduled = false;
+            pThis->Flush();
+         }
+      });
+   }
+}
+
+void SpectrogramTileStore::Flush()
+{
+   if (mPending.empty())
+      return;
+
+   const auto pConn = Connection(true);
+   if (!pConn || pConn->IsReadOnly()) {
+      mPending.clear();
+      return;
+   }
+   // Don't join a transaction that might be rolled back; try again after the
+   // next Store()
+   if (pConn->InTransaction())
+      return;
+
+   const auto db = pConn->DB();
+   if (sqlite3_exec(db, "BEGIN;", nullptr, nullptr, nullptr) != SQLITE_OK)
+      return;
+
+   bool committed = false;
+   auto rollback = finally([&]{
+      if (!committed) {
+         sqlite3_exec(db, "ROLLBACK;", nullptr, nullptr, nullptr);
+         mStoredBytes = -1;
+      }
+   });
+
+   auto pending = std::move(mPending);
+   mPending.clear();
+   for (const auto &[key, tile] : pending)
+      Insert(*pConn, key, tile);
+   Trim(*pConn);
+
+   committed =
+      sqlite3_exec(db, "COMMIT;", nullptr, nullptr, nullptr) == SQLITE_OK;
+   if (!committed)
+      wxLogDebug(wxT("SpectrogramTileStore::Flush - SQLITE error %s"),
+         sqlite3_errmsg(db));
+}
+
+void SpectrogramTileStore::Insert(
+   DBConnection &conn, const Key &key, const Tile &tile)
+{
+   const auto &positions = tile.positions;
+   std::vector<int16_t> magnitudes(tile.values.size());
+   std::transform(tile.values.begin(), tile.values.end(), magnitudes.begin(),
+      [](float value){
+         return static_cast<int16_t>(std::clamp(
+            std::lrint(value * ValuesPerDecibel), -32768l, 32767l));
+      });
+   const auto positionBytes = positions.size() * sizeof(Position);
+   const auto magnitudeBytes = magnitudes.size() * sizeof(int16_t);
+
+   // Prepare and cache statement...automatically finalized at DB close
+   sqlite3_stmt *stmt = conn.Prepare(DBConnection::InsertSpectrogramTile,
+      "INSERT INTO spectrogramtiles"
+      "   (contentkey, settingskey, firstsample, lastsample,"
+      "    positions, magnitudes)"
+      "   VALUES(?1, ?2, ?3, ?4, ?5, ?6);");
+   auto cleanup = finally([stmt]{
+      // Clear statement bindings and rewind statement
+      sqlite3_clear_bindings(stmt);
+      sqlite3_reset(stmt);
+   });
+
+   if (sqlite3_bind_int64(stmt, 1, ToInt64(key.content)) ||
+       sqlite3_bind_int64(stmt, 2, ToInt64(key.settings)) ||
+       sqlite3_bind_int64(stmt, 3, positions.front()) ||
+       sqlite3_bind_int64(stmt, 4, positions.back()) ||
+       sqlite3_bind_blob(stmt, 5, positions.data(), positionBytes,
+          SQLITE_STATIC) ||
+       sqlite3_bind_blob(stmt, 6, magnitudes.data(), magnitudeBytes,
+          SQLITE_STATIC))
+   {
+      wxASSERT_MSG(false, wxT("Binding failed...bug!!!"));
+      return;
+   }
+
+   if (sqlite3_step(stmt) != SQLITE_DONE) {
+      wxLogDebug(wxT("SpectrogramTileStore::Insert - SQLITE error %s"),
+         sqlite3_errmsg(conn.DB()));
+      return;
+   }
+   if (mStoredBytes >= 0)
+      mStoredBytes += positionBytes + magnitudeBytes;
+}
+
+void SpectrogramTileStore::Trim(DBConnection &conn)
+{
+   const auto db = conn.DB();
+   const auto query = [db](const char *sql, auto &&onRow) {
+      sqlite3_stmt *stmt = nullptr;
+      if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK)
+         return false;
+      auto cleanup = finally([stmt]{ sqlite3_finalize(stmt); });
+      int rc;
+      while ((rc = sqlite3_step(stmt)) == SQLITE_ROW)
+         if (!onRow(stmt))
+            return true;
+      return rc == SQLITE_DONE;
+   };
+
+   if (mStoredBytes < 0 && !query(
+      "SELECT COALESCE(SUM(LENGTH(positions) + LENGTH(magnitudes)), 0)"
+      "   FROM spectrogramtiles;",
+      [this](sqlite3_stmt *stmt){
+         mStoredBytes = sqlite3_column_int64(stmt, 0);
+         return false;
+      }))
+      return;
+
+   if (mStoredBytes <= BudgetBytes)
+      return;
+
+   // Find how many of the oldest tiles to delete
+   const auto excess = mStoredBytes - BudgetBytes * 3 / 4;
+   long long removed = 0;
+   sqlite3_int64 lastDeleted = 0;
+   if (!query(
+      "SELECT tileid, LENGTH(positions) + LENGTH(magnitudes)"
+      "   FROM spectrogramtiles ORDER BY tileid;",
+      [&](sqlite3_stmt *stmt){
+         lastDeleted = sqlite3_column_int64(stmt, 0);
+         removed += sqlite3_column_int64(stmt, 1);
+         return removed < excess;
+      }))
+      return;
+
+   sqlite3_stmt *stmt = nullptr;
+   if (sqlite3_prepare_v2(db,
+      "DELETE FROM spectrogramtiles WHERE tileid <= ?1;", -1, &stmt, nullptr)
+          != SQLITE_OK)
+      return;
+   auto cleanup = finally([stmt]{ sqlite3_finalize(stmt); });
+   if (sqlite3_bind_int64(stmt, 1, lastDeleted) == SQLITE_OK &&
+       sqlite3_step(stmt) == SQLITE_DONE)
+      mStoredBytes -= removed;
+   else
+      mStoredBytes = -1;
+}
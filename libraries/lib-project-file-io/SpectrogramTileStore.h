@@ -0,0 +1,104 @@
+/*!********************************************************************
+
+Audacity: A Digital Audio Editor
+
+@file SpectrogramTileStore.h
+@brief Optional table of the project file holding spectrogram columns
+calculated in earlier sessions
+
+**********************************************************************/
+
+#ifndef __AUDACITY_SPECTROGRAM_TILE_STORE__
+#define __AUDACITY_SPECTROGRAM_TILE_STORE__
+
+#include "ClientData.h"
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+class AudacityProject;
+class DBConnection;
+struct sqlite3;
+
+//! Keeps spectrogram columns in the project file, so that a project reopened
+//! with the same settings need not calculate them again
+/*!
+ Rows are tiles of columns, keyed by hashes of the samples and of the
+ settings they were calculated from, and by the range of sample positions
+ they cover.  Values are quantized to hundredths of a decibel.
+
+ The table is created when first written and is not part of the project
+ schema; older versions ignore it, and copying the project does not keep it.
+ Rows are never updated; the oldest are deleted when the table exceeds a
+ budget, which also retires tiles of samples that were since edited.
+
+ All member functions are for the main thread only.  Failures of the
+ database are logged and otherwise ignored, because the table only saves
+ recalculation.
+ */
+class PROJECT_FILE_IO_API SpectrogramTileStore final
+   : public ClientData::Base
+   , public std::enable_shared_from_this<SpectrogramTileStore>
+{
+public:
+   using Position = long long;
+
+   struct Key {
+      //! Identifies the samples of one channel of a clip
+      uint64_t content;
+      //! Identifies the settings that affect the calculation
+      uint64_t settings;
+   };
+
+   //! Columns of equal numbers of values in dB, at increasing sample positions
+   struct Tile {
+      std::vector<Position> positions;
+      std::vector<float> values;
+   };
+
+   static SpectrogramTileStore &Get(AudacityProject &project);
+
+   explicit SpectrogramTileStore(AudacityProject &project);
+   SpectrogramTileStore(const SpectrogramTileStore &) = delete;
+   SpectrogramTileStore &operator=(const SpectrogramTileStore &) = delete;
+   ~SpectrogramTileStore() override;
+
+   //! Stored tiles overlapping positions from first to last, inclusive, but
+   //! only those having some column at a wanted position
+   /*! Decodes the values only of those tiles */
+   std::vector<Tile> Load(const Key &key, Position first, Position last,
+      const std::function<bool(Position)> &wanted);
+
+   //! Write the tile later, in idle time
+   void Store(const Key &key, Tile tile);
+
+   //! Write all stored tiles now, unless a transaction is open
+   void Flush();
+
+private:
+   //! @return null if the project has no connection, or the table does not
+   //! exist and can't be created
+   DBConnection *Connection(bool create);
+   void Insert(DBConnection &conn, const Key &key, const Tile &tile);
+   //! Delete the oldest rows if the table exceeds its budget
+   void Trim(DBConnection &conn);
+
+   AudacityProject &mProject;
+
+   struct Pending {
+      Key key;
+      Tile tile;
+   };
+   std::vector<Pending> mPending;
+   bool mFlushScheduled{ false };
+
+   //! Connection known to have the table, since checked
+   const DBConnection *mCheckedConnection{};
+   const sqlite3 *mCheckedDB{};
+   //! Bytes of values in the table, if known
+   long long mStoredBytes{ -1 };
+};
+
+#endif
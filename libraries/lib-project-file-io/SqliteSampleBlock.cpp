@@ -12,22 +12,35 @@ Paul Licameli -- split from SampleBlock.cpp and SampleBlock.h
 #include <sqlite3.h>
 
 #include "BasicUI.h"
+#include "CompactUndoTracks.h"
 #include "DBConnection.h"
+#include "ObjectPool.h"
 #include "ProjectFileIO.h"
+#include "ProjectFormatExtensionsRegistry.h"
+#include "Prefs.h"
+#include "SampleBlockCache.h"
+#include "SampleBlockCodec.h"
 #include "SampleFormat.h"
 #include "AudioSegmentSampleView.h"
 #include "XMLTagHandler.h"
 
 #include "SampleBlock.h" // to inherit
 #include "UndoManager.h"
-#include "UndoTracks.h"
 #include "WaveTrack.h"
 #include "WaveTrackUtilities.h"
 
 #include "SentryHelper.h"
+#include "concurrency/ThreadPool.h"
+#include "crypto/SHA256.h"
 #include <wx/log.h>
 
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <deque>
+#include <future>
 #include <mutex>
+#include <optional>
 
 class SqliteSampleBlockFactory;
 
@@ -50,10 +63,30 @@ public:
 
    void SetSamples(
       constSamplePtr src, size_t numsamples, sampleFormat srcformat);
+   //! Take the buffer's storage, or leave it unchanged if there is an
+   //! exception
+   void SetSamples(
+      SampleBuffer &buffer, size_t numsamples, sampleFormat srcformat);
 
    //! Numbers of bytes needed for 256 and for 64k summaries
    using Sizes = std::pair< size_t, size_t >;
-   void Commit(Sizes sizes);
+   //! Insert a row, with summaries only if they were calculated already
+   void Commit(Sizes sizes, constSamplePtr samples, bool withSummaries);
+
+   //! Write summaries that were calculated in the background, if not yet
+   //! written
+   void FlushSummary();
+   //! Whether FlushSummary() would not wait for a calculation
+   bool IsSummaryReady() const;
+
+   //! Whether the samples are still only in a SampleBlockSource
+   bool IsDeferred() const;
+   //! Read the source and calculate summaries, if not done yet, but don't
+   //! write them; may be called in a worker thread
+   void PrepareMaterialization();
+   //! Write samples and summaries of a deferred block into its row, reading
+   //! the source first if that was not done yet; may throw
+   void Materialize() const;
 
    void Delete();
 
@@ -81,27 +114,79 @@ public:
    size_t GetSpaceUsage() const override;
    void SaveXML(XMLWriter &xmlFile) override;
 
+   //! Reads the block into the factory's cache, if that is enabled
+   void Prefetch() noexcept override;
+
+   //! Whether the block is silent, or its samples are in the factory's cache
+   bool IsResident() const noexcept override;
+
+   //! Keeps the samples in the factory's cache, exempt from its evictions
+   std::shared_ptr<const void> PinResident() const override;
+
+   //! Waits for any background calculation of summaries
+   std::string GetContentHash() const override;
+
+   //! Whether the row holds an encoding of the samples
+   bool IsEncoded() const { return mEncoded; }
+
 private:
    bool IsSilent() const { return mBlockID <= 0; }
+   //! Encode the samples if the project compresses, and say how to store them
+   /*! @return the value for the sampleformat column */
+   int Encode(constSamplePtr samples, std::vector<char> &encoded);
+   //! Take the sampleformat column of a row, and the length of its samples
+   void SetStorage(int format, size_t blobbytes);
    void Load(SampleBlockID sbid);
    bool GetSummary(float *dest,
                    size_t frameoffset,
                    size_t numframes,
                    DBConnection::StatementID id,
                    const char *sql);
+   //! Fetch all stored bytes of the block, from the cache if possible
+   SampleBlockCache::Payload GetPayload();
    size_t GetBlob(void *dest,
                   sampleFormat destformat,
                   sqlite3_stmt *stmt,
                   sampleFormat srcformat,
                   size_t srcoffset,
                   size_t srcbytes);
+   static size_t CopyBlob(void *dest,
+                  sampleFormat destformat,
+                  constSamplePtr src,
+                  size_t blobbytes,
+                  sampleFormat srcformat,
+                  size_t srcoffset,
+                  size_t srcbytes);
 
    enum {
       fields = 3, /* min, max, rms */
       bytesPerFrame = fields * sizeof(float),
    };
    Sizes SetSizes( size_t numsamples, sampleFormat srcformat );
-   void CalcSummary(Sizes sizes);
+   void CalcSummary(Sizes sizes, constSamplePtr samples);
+   //! Block until any background calculation of summaries completes
+   void WaitForSummary() const;
+
+   //! If the block is deferred, fetch from its source and return true
+   bool ReadSource(samplePtr dest, sampleFormat destformat,
+      size_t sampleoffset, size_t numsamples);
+   //! Implements PrepareMaterialization(); mSourceMutex must be held
+   void DoPrepareMaterialization();
+
+   //! Queue an update of the row for the writer thread
+   void SubmitWrite(DBConnection::Write write) const;
+   //! Block until the queued updates of the row are done
+   /*! @throw FileException if one failed */
+   void WaitForWrite() const;
+
+   //! What length() of the columns of a row adds up to, as in
+   //! ProjectFileIO::GetDiskUsage(), when none of them is NULL
+   static int64_t RowSpaceUsage(SampleBlockID id, int format,
+      double sumMin, double sumMax, double sumRms,
+      Sizes summarySizes, size_t blobBytes);
+   //! Record the space of the row after an update, and change the running
+   //! total of the connection by the difference
+   void SetSpaceUsage(int64_t usage) const;
 
 private:
    //! This must never be called for silent blocks
@@ -120,16 +205,47 @@ private:
 
    SampleBlockID mBlockID{ 0 };
 
-   ArrayOf<char> mSamples;
+   //! Bytes of the samples, not of their encoding
    size_t mSampleBytes;
+   //! Bytes of the samples column, if inserted by Commit()
+   size_t mBlobBytes{ 0 };
    size_t mSampleCount;
    sampleFormat mSampleFormat;
+   bool mEncoded{ false };
 
    ArrayOf<char> mSummary256;
    ArrayOf<char> mSummary64k;
    double mSumMin;
    double mSumMax;
    double mSumRms;
+   //! Calculated with the summaries, if the factory asks
+   std::string mContentHash;
+
+   //! Becomes ready when the summary fields above are calculated
+   std::shared_future<void> mSummaryFuture;
+   //! Guards the background summaries between calculation and writing
+   mutable std::mutex mSummaryMutex;
+   //! Whether summaries are calculated, or being calculated, but not written
+   bool mSummaryPending{ false };
+   Sizes mSummarySizes;
+
+   //! Where the samples are, until they are copied into the row, or null
+   /*! The row of a deferred block has no samples and no summaries yet */
+   SampleBlockSourcePtr mpSource;
+   sampleCount mSourceStart{ 0 };
+   //! Samples read from the source but not yet written
+   std::unique_ptr<SampleBuffer> mpPrepared;
+   //! Guards the fields above and the summaries of a deferred block
+   mutable std::mutex mSourceMutex;
+
+   //! Becomes ready when the last update of the row that was queued for the
+   //! writer thread is done, unless not valid
+   mutable std::shared_future<int> mWriteFuture;
+   mutable std::mutex mWriteFutureMutex;
+
+   //! What the row adds to ProjectFileIO::GetDiskUsage(), or negative if
+   //! not known; rows change only by updates of this object
+   mutable std::atomic<int64_t> mSpaceUsage{ -1 };
 
 #if defined(WORDS_BIGENDIAN)
 #error All sample block data is little endian...big endian not yet supported
@@ -141,6 +257,7 @@ private:
 // used length values
 static std::map< SampleBlockID, std::shared_ptr<SqliteSampleBlock> >
    sSilentBlocks;
+static std::mutex sSilentBlocksMutex;
 
 ///\brief Implementation of @ref SampleBlockFactory using Sqlite database
 class SqliteSampleBlockFactory final
@@ -158,6 +275,10 @@ public:
       size_t numsamples,
       sampleFormat srcformat) override;
 
+   SampleBlockPtr DoCreateFromBuffer(SampleBuffer &buffer,
+      size_t numsamples,
+      sampleFormat srcformat) override;
+
    SampleBlockPtr DoCreateSilent(
       size_t numsamples,
       sampleFormat srcformat) override;
@@ -169,14 +290,62 @@ public:
    SampleBlockPtr DoCreateFromId(
       sampleFormat srcformat, SampleBlockID id) override;
 
+   SampleBlockPtr DoCreateDeferred(const SampleBlockSourcePtr &pSource,
+      sampleCount start, size_t numsamples, sampleFormat srcformat) override;
+
+   void Flush() override;
+
+   void FlushDeferred() override;
+
+   CacheStatistics GetCacheStatistics() const override;
+
+   bool DoGetSamples(
+      const SampleBlockRanges &ranges, sampleFormat destformat) override;
+
+   //! How many block ids are bound in one multi-block SELECT
+   static constexpr size_t BatchSize = 16;
+
 private:
+   //! Track a block made by DoCreate() or DoCreateFromBuffer()
+   void AddCreated(const std::shared_ptr<SqliteSampleBlock> &sb);
+
+   //! Write summaries of blocks whose rows were inserted without them
+   /*! @param onlyReady if true, skip blocks still being summarized */
+   void FlushSummaries(bool onlyReady);
+
+   //! Read ranges whose blocks all belong to this factory and are not silent
+   /*! There are at most BatchSize distinct block ids among them */
+   bool ReadBatch(const std::vector<
+      std::pair<SqliteSampleBlock*, const SampleBlockRange*>> &batch,
+      sampleFormat destformat);
+
+   //! Read the sources of deferred blocks, in a worker thread, handing
+   //! each block to the main thread to write it
+   void PrepareDeferred();
+   //! Start PrepareDeferred() if it is not running; mDeferredMutex must be
+   //! held
+   void StartPreparingDeferred();
+   //! Write a block that PrepareDeferred() handed over, in the main thread
+   void FinishDeferred(const std::shared_ptr<SqliteSampleBlock> &pBlock);
+
+   //! How many blocks PrepareDeferred() may hand over before the main thread
+   //! writes them, so that memory use stays bounded
+   static constexpr size_t MaxDeferredInFlight = 4;
+
    void OnBeginPurge(size_t begin, size_t end);
    void OnEndPurge();
 
    friend SqliteSampleBlock;
 
    AudacityProject &mProject;
+   //! Consulted in worker threads too, so found once here
+   const SampleBlockCompression &mCompression;
    Observer::Subscription mUndoSubscription;
+
+   //! Serializes the statements that insert and delete blocks, and the
+   //! bookkeeping of them, when several threads import into the project
+   /*! Recursive, because destroying a block deletes its row */
+   std::recursive_mutex mWriteMutex;
    std::optional<SampleBlock::DeletionCallback::Scope> mScope;
    const std::shared_ptr<ConnectionPtr> mppConnection;
 
@@ -187,11 +356,34 @@ private:
    using AllBlocksMap =
       std::map< SampleBlockID, std::weak_ptr< SqliteSampleBlock > >;
    AllBlocksMap mAllBlocks;
+
+   //! Contents of recently read blocks
+   SampleBlockCache mPayloadCache;
+
+   std::mutex mPendingSummariesMutex;
+   //! Blocks created with summaries calculated in the background, and maybe
+   //! not yet written
+   std::vector<std::weak_ptr<SqliteSampleBlock>> mPendingSummaries;
+
+   //! Guards the fields below
+   std::mutex mDeferredMutex;
+   //! Deferred blocks not yet visited by PrepareDeferred()
+   std::deque<std::weak_ptr<SqliteSampleBlock>> mDeferred;
+   std::future<void> mMaterializer;
+   size_t mDeferredInFlight{ 0 };
+   bool mMaterializing{ false };
+   bool mStopMaterializing{ false };
 };
 
+//! Megabytes of sample block contents retained per project for re-reading
+static IntSetting SampleBlockCacheSize{ L"/SampleBlockCache/Megabytes", 64 };
+
 SqliteSampleBlockFactory::SqliteSampleBlockFactory( AudacityProject &project )
    : mProject{ project }
+   , mCompression{ SampleBlockCompression::Get(project) }
    , mppConnection{ ConnectionPtr::Get(project).shared_from_this() }
+   , mPayloadCache{
+      static_cast<size_t>(std::max(0, SampleBlockCacheSize.Read())) << 20 }
 {
    mUndoSubscription = UndoManager::Get(project)
       .Subscribe([this](UndoRedoMessage message){
@@ -206,20 +398,104 @@ SqliteSampleBlockFactory::SqliteSampleBlockFactory( AudacityProject &project )
       });
 }
 
-SqliteSampleBlockFactory::~SqliteSampleBlockFactory() = default;
+SqliteSampleBlockFactory::~SqliteSampleBlockFactory()
+{
+   // No block remains, but the worker may still be visiting expired ones
+   {
+      std::lock_guard<std::mutex> lock{ mDeferredMutex };
+      mStopMaterializing = true;
+   }
+   if (mMaterializer.valid())
+      mMaterializer.wait();
+}
+
+auto SqliteSampleBlockFactory::GetCacheStatistics() const -> CacheStatistics
+{
+   return mPayloadCache.GetStatistics();
+}
 
 SampleBlockPtr SqliteSampleBlockFactory::DoCreate(
    constSamplePtr src, size_t numsamples, sampleFormat srcformat )
 {
-   auto sb = std::make_shared<SqliteSampleBlock>(shared_from_this());
+   std::lock_guard<std::recursive_mutex> lock{ mWriteMutex };
+   auto sb = ObjectPool::MakeShared<SqliteSampleBlock>(shared_from_this());
    sb->SetSamples(src, numsamples, srcformat);
+   AddCreated(sb);
+   return sb;
+}
+
+SampleBlockPtr SqliteSampleBlockFactory::DoCreateFromBuffer(
+   SampleBuffer &buffer, size_t numsamples, sampleFormat srcformat )
+{
+   std::lock_guard<std::recursive_mutex> lock{ mWriteMutex };
+   auto sb = ObjectPool::MakeShared<SqliteSampleBlock>(shared_from_this());
+   sb->SetSamples(buffer, numsamples, srcformat);
+   AddCreated(sb);
+   return sb;
+}
+
+void SqliteSampleBlockFactory::AddCreated(
+   const std::shared_ptr<SqliteSampleBlock> &sb)
+{
    // block id has now been assigned
    mAllBlocks[ sb->GetBlockID() ] = sb;
-   return sb;
+
+   // Write earlier summaries that are done, while later ones are calculated
+   {
+      std::lock_guard<std::mutex> lock{ mPendingSummariesMutex };
+      mPendingSummaries.push_back(sb);
+   }
+   FlushSummaries(true);
+}
+
+void SqliteSampleBlockFactory::Flush()
+{
+   std::lock_guard<std::recursive_mutex> lock{ mWriteMutex };
+   FlushSummaries(false);
+
+   // Let the document refer only to rows that are written
+   if (auto &pConnection = mppConnection->mpConnection) {
+      pConnection->WaitForBackgroundWrite();
+      if (const auto rc = pConnection->GetWriteError(); rc != SQLITE_OK)
+      {
+         ADD_EXCEPTION_CONTEXT("sqlite3.rc", std::to_string(rc));
+         ADD_EXCEPTION_CONTEXT("sqlite3.context", "SqliteSampleBlockFactory::Flush");
+         pConnection->ThrowException(true);
+      }
+   }
+}
+
+void SqliteSampleBlockFactory::FlushSummaries(bool onlyReady)
+{
+   decltype(mPendingSummaries) pending, kept;
+   {
+      std::lock_guard<std::mutex> lock{ mPendingSummariesMutex };
+      pending.swap(mPendingSummaries);
+   }
+
+   // Put back what remains, even if an exception escapes
+   auto iter = pending.begin();
+   auto restore = finally([&]{
+      std::lock_guard<std::mutex> lock{ mPendingSummariesMutex };
+      mPendingSummaries.insert(mPendingSummaries.end(), kept.begin(), kept.end());
+      mPendingSummaries.insert(mPendingSummaries.end(), iter, pending.end());
+   });
+
+   for (auto end = pending.end(); iter != end; ++iter) {
+      auto pBlock = iter->lock();
+      if (!pBlock)
+         continue;
+      if (onlyReady && !pBlock->IsSummaryReady()) {
+         kept.push_back(*iter);
+         continue;
+      }
+      pBlock->FlushSummary();
+   }
 }
 
 auto SqliteSampleBlockFactory::GetActiveBlockIDs() -> SampleBlockIDs
 {
+   std::lock_guard<std::recursive_mutex> lock{ mWriteMutex };
    SampleBlockIDs result;
    for (auto end = mAllBlocks.end(), it = mAllBlocks.begin(); it != end;) {
       if (it->second.expired())
@@ -237,9 +513,10 @@ SampleBlockPtr SqliteSampleBlockFactory::DoCreateSilent(
    size_t numsamples, sampleFormat )
 {
    auto id = -static_cast< SampleBlockID >(numsamples);
+   std::lock_guard<std::mutex> lock{ sSilentBlocksMutex };
    auto &result = sSilentBlocks[ id ];
    if ( !result ) {
-      result = std::make_shared<SqliteSampleBlock>(nullptr);
+      result = ObjectPool::MakeShared<SqliteSampleBlock>(nullptr);
       result->mBlockID = id;
 
       // Ignore the supplied sample format
@@ -275,6 +552,7 @@ SampleBlockPtr SqliteSampleBlockFactory::DoCreateFromId(
    if (id <= 0)
       return DoCreateSilent(-id, floatSample);
 
+   std::lock_guard<std::recursive_mutex> lock{ mWriteMutex };
    // First see if this block id was previously loaded
    auto& wb = mAllBlocks[id];
 
@@ -282,7 +560,7 @@ SampleBlockPtr SqliteSampleBlockFactory::DoCreateFromId(
       return block;
 
    // First sight of this id
-   auto ssb           = std::make_shared<SqliteSampleBlock>(shared_from_this());
+   auto ssb           = ObjectPool::MakeShared<SqliteSampleBlock>(shared_from_this());
    wb                 = ssb;
    ssb->mSampleFormat = srcformat;
    // This may throw database errors
@@ -292,6 +570,276 @@ SampleBlockPtr SqliteSampleBlockFactory::DoCreateFromId(
    return ssb;
 }
 
+SampleBlockPtr SqliteSampleBlockFactory::DoCreateDeferred(
+   const SampleBlockSourcePtr &pSource,
+   sampleCount start, size_t numsamples, sampleFormat srcformat)
+{
+   std::lock_guard<std::recursive_mutex> lock{ mWriteMutex };
+   auto sb = ObjectPool::MakeShared<SqliteSampleBlock>(shared_from_this());
+   // Insert the row now, to assign the block id, but without samples or
+   // summaries, which Materialize() writes later
+   sb->mSummarySizes = sb->SetSizes(numsamples, srcformat);
+   sb->Commit(sb->mSummarySizes, nullptr, false);
+   {
+      std::lock_guard<std::mutex> sourceLock{ sb->mSourceMutex };
+      sb->mpSource = pSource;
+      sb->mSourceStart = start;
+   }
+   mAllBlocks[ sb->GetBlockID() ] = sb;
+
+   std::lock_guard<std::mutex> deferredLock{ mDeferredMutex };
+   mDeferred.push_back(sb);
+   StartPreparingDeferred();
+   return sb;
+}
+
+void SqliteSampleBlockFactory::StartPreparingDeferred()
+{
+   if (mMaterializing || mStopMaterializing || mDeferred.empty() ||
+       mDeferredInFlight >= MaxDeferredInFlight)
+      return;
+   mMaterializing = true;
+   mMaterializer = audacity::concurrency::ThreadPool::GetDefault()
+      .Async([this]{ PrepareDeferred(); });
+}
+
+void SqliteSampleBlockFactory::PrepareDeferred()
+{
+   while (true) {
+      std::shared_ptr<SqliteSampleBlock> pBlock;
+      {
+         std::lock_guard<std::mutex> lock{ mDeferredMutex };
+         // Don't wait for the main thread, but let FinishDeferred() restart
+         // this when it catches up
+         if (mStopMaterializing || mDeferred.empty() ||
+             mDeferredInFlight >= MaxDeferredInFlight) {
+            mMaterializing = false;
+            return;
+         }
+         pBlock = mDeferred.front().lock();
+         mDeferred.pop_front();
+         if (!pBlock)
+            continue;
+         ++mDeferredInFlight;
+      }
+
+      // Failures will be reported when the samples are really needed
+      try { pBlock->PrepareMaterialization(); }
+      catch (...) {}
+
+      // The main thread writes the row, and so the database is not used
+      // while connections are closed or swapped.  It also releases the block,
+      // which may be the last reference, so that destruction happens there.
+      BasicUI::CallAfter([pBlock = std::move(pBlock)]{
+         pBlock->mpFactory->FinishDeferred(pBlock);
+      });
+   }
+}
+
+void SqliteSampleBlockFactory::FinishDeferred(
+   const std::shared_ptr<SqliteSampleBlock> &pBlock)
+{
+   {
+      std::lock_guard<std::mutex> lock{ mDeferredMutex };
+      --mDeferredInFlight;
+      StartPreparingDeferred();
+   }
+
+   if (!mppConnection->mpConnection) {
+      // The project is closed, and there is no row left to delete
+      pBlock->mLocked = true;
+      return;
+   }
+   GuardedCall([&]{ pBlock->Materialize(); });
+}
+
+void SqliteSampleBlockFactory::FlushDeferred()
+{
+   // Visit all blocks, including those the worker has already dequeued
+   // (Don't lock the blocks while locking mWriteMutex, which Materialize()
+   // locks in the other order)
+   std::vector<std::shared_ptr<SqliteSampleBlock>> blocks;
+   {
+      std::lock_guard<std::recursive_mutex> lock{ mWriteMutex };
+      for (auto &[id, wBlock] : mAllBlocks)
+         if (auto pBlock = wBlock.lock())
+            blocks.push_back(std::move(pBlock));
+   }
+
+   std::optional<BulkWriteScope> bulkWrite;
+   for (auto &pBlock : blocks) {
+      if (!pBlock->IsDeferred())
+         continue;
+      if (!bulkWrite)
+         bulkWrite.emplace(mProject);
+      pBlock->Materialize();
+   }
+
+   // What remains in the queue is written already
+   std::lock_guard<std::mutex> lock{ mDeferredMutex };
+   mDeferred.clear();
+}
+
+bool SqliteSampleBlockFactory::DoGetSamples(
+   const SampleBlockRanges &ranges, sampleFormat destformat)
+{
+   bool result = true;
+   std::vector<std::pair<SqliteSampleBlock*, const SampleBlockRange*>> batch;
+   size_t nIds = 0;
+   SampleBlockID lastId = 0;
+   const auto flush = [&]{
+      if (!batch.empty() && !ReadBatch(batch, destformat))
+         result = false;
+      batch.clear();
+      nIds = 0;
+      lastId = 0;
+   };
+
+   for (auto &range : ranges) {
+      const auto pBlock = dynamic_cast<SqliteSampleBlock*>(range.pBlock);
+      if (!pBlock || pBlock->IsSilent() ||
+          pBlock->mpFactory.get() != this || pBlock->IsDeferred()) {
+         // Not worth batching, or not ours to batch, or not in the database
+         if (range.pBlock->GetSamples(range.dest, destformat,
+               range.sampleoffset, range.numsamples) != range.numsamples)
+            result = false;
+         continue;
+      }
+      const auto id = pBlock->GetBlockID();
+      if (auto payload = mPayloadCache.Find(id)) {
+         const auto size = SAMPLE_SIZE(pBlock->mSampleFormat);
+         SqliteSampleBlock::CopyBlob(range.dest, destformat,
+            payload->data(), payload->size(), pBlock->mSampleFormat,
+            range.sampleoffset * size, range.numsamples * size);
+         continue;
+      }
+      if (id != lastId) {
+         if (nIds == BatchSize)
+            flush();
+         ++nIds;
+         lastId = id;
+      }
+      batch.emplace_back(pBlock, &range);
+   }
+   flush();
+
+   return result;
+}
+
+bool SqliteSampleBlockFactory::ReadBatch(const std::vector<
+   std::pair<SqliteSampleBlock*, const SampleBlockRange*>> &batch,
+   sampleFormat destformat)
+{
+   static const std::string sql = []{
+      std::string result = "SELECT blockid, samples FROM sampleblocks"
+         " WHERE blockid IN (";
+      for (size_t ii = 1; ii <= BatchSize; ++ii) {
+         if (ii > 1)
+            result += ",";
+         result += "?" + std::to_string(ii);
+      }
+      return result + ");";
+   }();
+
+   wxASSERT(!batch.empty());
+   auto conn = batch.front().first->Conn();
+   auto db = conn->DB();
+
+   // Prepare and cache statement...automatically finalized at DB close
+   sqlite3_stmt *stmt =
+      conn->Prepare(DBConnection::GetSamplesBatch, sql.c_str());
+
+   // Loading may itself use the database, so do it before binding; and
+   // rows may still be queued for the writer thread
+   for (auto &[pBlock, pRange] : batch) {
+      if (!pBlock->mValid)
+         pBlock->Load(pBlock->mBlockID);
+      pBlock->WaitForWrite();
+   }
+
+   // Bind statement parameters; unused parameters remain NULL and match
+   // no row
+   int param = 0;
+   SampleBlockID lastId = 0;
+   for (auto &[pBlock, pRange] : batch) {
+      const auto id = pBlock->GetBlockID();
+      if (id == lastId)
+         continue;
+      lastId = id;
+      // Might return SQLITE_MISUSE which means it's our mistake that we
+      // violated preconditions; should return SQL_OK which is 0
+      if (sqlite3_bind_int64(stmt, ++param, id))
+      {
+         ADD_EXCEPTION_CONTEXT(
+            "sqlite3.rc", std::to_string(sqlite3_errcode(db)));
+         ADD_EXCEPTION_CONTEXT(
+            "sqlite3.context", "SqliteSampleBlockFactory::ReadBatch::bind");
+
+         wxASSERT_MSG(false, wxT("Binding failed...bug!!!"));
+      }
+   }
+
+   // Rows arrive in no particular order; visit each range of each row
+   const bool caching = mPayloadCache.GetBudget() > 0;
+   size_t nFound = 0;
+   int rc;
+   while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+      const auto id = sqlite3_column_int64(stmt, 0);
+      auto src = (constSamplePtr) sqlite3_column_blob(stmt, 1);
+      size_t blobbytes = (size_t) sqlite3_column_bytes(stmt, 1);
+      // Decode once for all ranges of the row, and cache what is decoded
+      SampleBlockCache::Payload payload;
+      const auto found = std::find_if(batch.begin(), batch.end(),
+         [id](const auto &pair){ return pair.first->GetBlockID() == id; });
+      if (found != batch.end() && found->first->mEncoded) {
+         const auto pBlock = found->first;
+         auto decoded =
+            std::make_shared<std::vector<char>>(pBlock->mSampleBytes);
+         if (!SampleBlockCodec::Decode(src, blobbytes, pBlock->mSampleFormat,
+               decoded->data(), pBlock->mSampleCount)) {
+            rc = SQLITE_CORRUPT;
+            break;
+         }
+         src = decoded->data();
+         blobbytes = decoded->size();
+         payload = std::move(decoded);
+      }
+      if (caching)
+         mPayloadCache.Insert(id, payload ? payload
+            : std::make_shared<std::vector<char>>(src, src + blobbytes));
+      for (auto &[pBlock, pRange] : batch) {
+         if (pBlock->GetBlockID() != id)
+            continue;
+         const auto srcformat = pBlock->mSampleFormat;
+         const auto size = SAMPLE_SIZE(srcformat);
+         SqliteSampleBlock::CopyBlob(pRange->dest, destformat,
+            src, blobbytes, srcformat,
+            pRange->sampleoffset * size, pRange->numsamples * size);
+         ++nFound;
+      }
+   }
+
+   // Clear statement bindings and rewind statement
+   sqlite3_clear_bindings(stmt);
+   sqlite3_reset(stmt);
+
+   if (rc != SQLITE_DONE || nFound != batch.size())
+   {
+      ADD_EXCEPTION_CONTEXT("sqlite3.rc", std::to_string(rc));
+      ADD_EXCEPTION_CONTEXT(
+         "sqlite3.context", "SqliteSampleBlockFactory::ReadBatch::step");
+
+      wxLogDebug(wxT("SqliteSampleBlockFactory::ReadBatch - SQLITE error %s"),
+         sqlite3_errmsg(db));
+
+      // Just showing the user a simple message, not the library error too
+      // which isn't internationalized
+      conn->ThrowException( false );
+   }
+
+   return true;
+}
+
 BlockSampleView SqliteSampleBlock::GetFloatSampleView(bool mayThrow)
 {
    assert(mSampleCount > 0);
@@ -340,6 +888,10 @@ SqliteSampleBlock::SqliteSampleBlock(
 
 SqliteSampleBlock::~SqliteSampleBlock()
 {
+   // The worker may still be writing into this
+   if (mSummaryFuture.valid())
+      mSummaryFuture.wait();
+
    DeletionCallback::Call(*this);
 
    if (IsSilent()) {
@@ -387,6 +939,9 @@ DBConnection *SqliteSampleBlock::Conn() const
 void SqliteSampleBlock::CloseLock() noexcept
 {
    mLocked = true;
+   // The row survives, so it must be complete
+   if (!IsSilent())
+      GuardedCall( [this]{ Materialize(); FlushSummary(); } );
 }
 
 SampleBlockID SqliteSampleBlock::GetBlockID() const
@@ -415,6 +970,17 @@ size_t SqliteSampleBlock::DoGetSamples(samplePtr dest,
       return numsamples;
    }
 
+   if (ReadSource(dest, destformat, sampleoffset, numsamples))
+      return numsamples;
+
+   if (auto payload = GetPayload()) {
+      const auto size = SAMPLE_SIZE(mSampleFormat);
+      return CopyBlob(dest, destformat,
+         payload->data(), payload->size(), mSampleFormat,
+         sampleoffset * size, numsamples * size) / size;
+   }
+
+   // Caching is disabled; fetch only the requested range
    // Prepare and cache statement...automatically finalized at DB close
    sqlite3_stmt *stmt = Conn()->Prepare(DBConnection::GetSamples,
       "SELECT samples FROM sampleblocks WHERE blockid = ?1;");
@@ -427,17 +993,354 @@ size_t SqliteSampleBlock::DoGetSamples(samplePtr dest,
                   numsamples * SAMPLE_SIZE(mSampleFormat)) / SAMPLE_SIZE(mSampleFormat);
 }
 
+SampleBlockCache::Payload SqliteSampleBlock::GetPayload()
+{
+   auto &cache = mpFactory->mPayloadCache;
+   // Find() still serves pinned payloads when the cache is disabled
+   if (auto payload = cache.Find(mBlockID))
+      return payload;
+   if (cache.GetBudget() == 0)
+      return {};
+
+   if (!mValid)
+      Load(mBlockID);
+
+   // Prepare and cache statement...automatically finalized at DB close
+   sqlite3_stmt *stmt = Conn()->Prepare(DBConnection::GetSamples,
+      "SELECT samples FROM sampleblocks WHERE blockid = ?1;");
+   auto payload = std::make_shared<std::vector<char>>(mSampleBytes);
+   GetBlob(payload->data(), mSampleFormat, stmt, mSampleFormat,
+      0, mSampleBytes);
+   cache.Insert(mBlockID, payload);
+   return payload;
+}
+
+void SqliteSampleBlock::Prefetch() noexcept
+{
+   // A deferred row has no samples to fetch yet
+   if (IsSilent() || IsDeferred())
+      return;
+   // Failures will be reported when the samples are really needed
+   try { GetPayload(); }
+   catch (...) {}
+}
+
+bool SqliteSampleBlock::IsResident() const noexcept
+{
+   if (IsSilent())
+      return true;
+   // Without the metadata, GetPayload() would query the database
+   return mValid && mpFactory->mPayloadCache.Contains(mBlockID);
+}
+
+std::shared_ptr<const void> SqliteSampleBlock::PinResident() const
+{
+   if (IsSilent())
+      // Nothing to keep, but the result must not be null
+      return mpFactory;
+   if (!mValid || !mpFactory->mPayloadCache.Pin(mBlockID))
+      return nullptr;
+   // The factory, which owns the cache, lives as long as the pin
+   return std::shared_ptr<const void>{ mpFactory.get(),
+      [pFactory = mpFactory, id = mBlockID](const void *){
+         pFactory->mPayloadCache.Unpin(id);
+      } };
+}
+
+bool SqliteSampleBlock::ReadSource(samplePtr dest, sampleFormat destformat,
+   size_t sampleoffset, size_t numsamples)
+{
+   std::lock_guard<std::mutex> lock{ mSourceMutex };
+   if (!mpSource)
+      return false;
+
+   const auto first = std::min(sampleoffset, mSampleCount);
+   const auto count = std::min(numsamples, mSampleCount - first);
+   if (mpPrepared)
+      CopySamples(mpPrepared->ptr() + first * SAMPLE_SIZE(mSampleFormat),
+         mSampleFormat, dest, destformat, count);
+   else if (destformat == mSampleFormat)
+      mpSource->Read(mSourceStart + first, count, dest, mSampleFormat);
+   else {
+      SampleBuffer buffer{ count, mSampleFormat };
+      mpSource->Read(mSourceStart + first, count, buffer.ptr(), mSampleFormat);
+      CopySamples(buffer.ptr(), mSampleFormat, dest, destformat, count);
+   }
+   ClearSamples(dest, destformat, count, numsamples - count);
+   return true;
+}
+
+bool SqliteSampleBlock::IsDeferred() const
+{
+   std::lock_guard<std::mutex> lock{ mSourceMutex };
+   return mpSource != nullptr;
+}
+
+void SqliteSampleBlock::PrepareMaterialization()
+{
+   std::lock_guard<std::mutex> lock{ mSourceMutex };
+   if (mpSource && !mpPrepared)
+      DoPrepareMaterialization();
+}
+
+void SqliteSampleBlock::DoPrepareMaterialization()
+{
+   auto pSamples = std::make_unique<SampleBuffer>(mSampleCount, mSampleFormat);
+   mpSource->Read(mSourceStart, mSampleCount, pSamples->ptr(), mSampleFormat);
+   CalcSummary(mSummarySizes, pSamples->ptr());
+   mpPrepared = std::move(pSamples);
+}
+
+//! Run a statement of the writer thread, whose bind callback returns
+//! nonzero if a binding failed
+/*! @return SQLITE_OK, or else the error */
+template<typename Bind>
+static int RunWrite(DBConnection &conn, DBConnection::StatementID id,
+   const char *sql, const Bind &bind) noexcept
+{
+   sqlite3_stmt *stmt = nullptr;
+   try {
+      // Prepare and cache statement...automatically finalized at DB close
+      stmt = conn.Prepare(id, sql);
+   }
+   catch (...) {
+      return SQLITE_ERROR;
+   }
+
+   // Might fail with SQLITE_MISUSE which means it's our mistake that we
+   // violated preconditions
+   int rc = bind(stmt) ? SQLITE_MISUSE : sqlite3_step(stmt);
+   if (rc == SQLITE_DONE)
+      rc = SQLITE_OK;
+   else
+      wxLogDebug(wxT("SqliteSampleBlock::RunWrite - SQLITE error %s"),
+         sqlite3_errmsg(conn.DB()));
+
+   // Clear statement bindings and rewind statement
+   sqlite3_clear_bindings(stmt);
+   sqlite3_reset(stmt);
+   return rc;
+}
+
+void SqliteSampleBlock::SubmitWrite(DBConnection::Write write) const
+{
+   auto future = Conn()->SubmitWrite(std::move(write));
+   // Updates run in order, so this one is done only after the others
+   std::lock_guard<std::mutex> lock{ mWriteFutureMutex };
+   mWriteFuture = std::move(future);
+}
+
+void SqliteSampleBlock::WaitForWrite() const
+{
+   std::shared_future<int> future;
+   {
+      std::lock_guard<std::mutex> lock{ mWriteFutureMutex };
+      future = mWriteFuture;
+   }
+   if (!future.valid())
+      return;
+   if (const auto rc = future.get(); rc != SQLITE_OK)
+   {
+      ADD_EXCEPTION_CONTEXT("sqlite3.rc", std::to_string(rc));
+      ADD_EXCEPTION_CONTEXT("sqlite3.context", "SqliteSampleBlock::WaitForWrite");
+
+      // Just showing the user a simple message, not the library error too
+      // which isn't internationalized
+      Conn()->ThrowException( true );
+   }
+}
+
+void SqliteSampleBlock::Materialize() const
+{
+   if (IsSilent())
+      return;
+
+   std::lock_guard<std::mutex> lock{ mSourceMutex };
+   if (!mpSource)
+      return;
+
+   // This changes where the samples are found, not what they are
+   auto &self = const_cast<SqliteSampleBlock&>(*this);
+   if (!mpPrepared)
+      self.DoPrepareMaterialization();
+
+   std::lock_guard<std::recursive_mutex> writeLock{ mpFactory->mWriteMutex };
+
+   // The update owns what it writes
+   struct Row {
+      double sumMin, sumMax, sumRms;
+      ArrayOf<char> summary256, summary64k;
+      Sizes sizes;
+      std::unique_ptr<SampleBuffer> pSamples;
+      std::vector<char> encoded;
+      size_t bytes;
+      int format;
+   };
+   auto pRow = std::make_shared<Row>();
+   auto &row = *pRow;
+   row.format = self.Encode(mpPrepared->ptr(), row.encoded);
+   row.sumMin = mSumMin;
+   row.sumMax = mSumMax;
+   row.sumRms = mSumRms;
+   row.summary256 = std::move(self.mSummary256);
+   row.summary64k = std::move(self.mSummary64k);
+   row.sizes = mSummarySizes;
+   row.pSamples = std::move(self.mpPrepared);
+   row.bytes = mSampleBytes;
+
+   SetSpaceUsage(RowSpaceUsage(mBlockID, row.format,
+      row.sumMin, row.sumMax, row.sumRms, row.sizes,
+      row.encoded.empty() ? row.bytes : row.encoded.size()));
+
+   SubmitWrite([conn = Conn(), id = mBlockID, pRow](sqlite3 *)
+   {
+      auto &row = *pRow;
+      return RunWrite(*conn, DBConnection::UpdateSampleBlock,
+         "UPDATE sampleblocks SET summin = ?1, summax = ?2, sumrms = ?3,"
+         "                        summary256 = ?4, summary64k = ?5,"
+         "                        samples = ?6, sampleformat = ?7"
+         "                    WHERE blockid = ?8;",
+         [&](sqlite3_stmt *stmt) {
+            return sqlite3_bind_double(stmt, 1, row.sumMin) ||
+               sqlite3_bind_double(stmt, 2, row.sumMax) ||
+               sqlite3_bind_double(stmt, 3, row.sumRms) ||
+               sqlite3_bind_blob(stmt, 4, row.summary256.get(), row.sizes.first, SQLITE_STATIC) ||
+               sqlite3_bind_blob(stmt, 5, row.summary64k.get(), row.sizes.second, SQLITE_STATIC) ||
+               (!row.encoded.empty()
+                  ? sqlite3_bind_blob(stmt, 6, row.encoded.data(), row.encoded.size(), SQLITE_STATIC)
+                  : sqlite3_bind_blob(stmt, 6, row.pSamples->ptr(), row.bytes, SQLITE_STATIC)) ||
+               sqlite3_bind_int(stmt, 7, row.format) ||
+               sqlite3_bind_int64(stmt, 8, id);
+         });
+   });
+
+   mpFactory->mPayloadCache.Erase(mBlockID);
+
+   self.mpSource.reset();
+}
+
 void SqliteSampleBlock::SetSamples(constSamplePtr src,
                                    size_t numsamples,
                                    sampleFormat srcformat)
+{
+   auto &pool = audacity::concurrency::ThreadPool::GetDefault();
+   if (pool.IsWorkerThread()) {
+      // Don't wait for other tasks of the pool from within it
+      auto sizes = SetSizes(numsamples, srcformat);
+      CalcSummary( sizes, src );
+      Commit( sizes, src, true );
+      return;
+   }
+
+   // The worker that calculates summaries needs its own copy
+   SampleBuffer copy{ numsamples, srcformat };
+   memcpy(copy.ptr(), src, numsamples * SAMPLE_SIZE(srcformat));
+   SetSamples(copy, numsamples, srcformat);
+}
+
+void SqliteSampleBlock::SetSamples(SampleBuffer &buffer,
+                                   size_t numsamples,
+                                   sampleFormat srcformat)
 {
    auto sizes = SetSizes(numsamples, srcformat);
-   mSamples.reinit(mSampleBytes);
-   memcpy(mSamples.get(), src, mSampleBytes);
 
-   CalcSummary( sizes );
+   auto &pool = audacity::concurrency::ThreadPool::GetDefault();
+   if (pool.IsWorkerThread()) {
+      // Don't wait for other tasks of the pool from within it
+      CalcSummary( sizes, buffer.ptr() );
+      Commit( sizes, buffer.ptr(), true );
+      return;
+   }
+
+   // Shared with the worker that calculates summaries, concurrently with
+   // insertion of the samples; FlushSummary() writes the summaries later
+   auto pSamples = std::make_shared<SampleBuffer>(std::move(buffer));
+   {
+      std::lock_guard<std::mutex> lock{ mSummaryMutex };
+      mSummarySizes = sizes;
+      mSummaryPending = true;
+      mSummaryFuture = pool.Async([this, sizes, pSamples]{
+         CalcSummary( sizes, pSamples->ptr() );
+      }).share();
+   }
+
+   try {
+      Commit( sizes, pSamples->ptr(), false );
+   }
+   catch (...) {
+      // Give the samples back, after the worker is done with them
+      mSummaryFuture.wait();
+      buffer = std::move(*pSamples);
+      throw;
+   }
+}
+
+std::string SqliteSampleBlock::GetContentHash() const
+{
+   WaitForSummary();
+   // Also guards the hash of a deferred block
+   std::lock_guard<std::mutex> lock{ mSourceMutex };
+   return mContentHash;
+}
+
+bool SqliteSampleBlock::IsSummaryReady() const
+{
+   return !mSummaryFuture.valid() ||
+      mSummaryFuture.wait_for(std::chrono::seconds{ 0 }) ==
+         std::future_status::ready;
+}
+
+void SqliteSampleBlock::WaitForSummary() const
+{
+   if (mSummaryFuture.valid())
+      mSummaryFuture.wait();
+}
 
-   Commit( sizes );
+void SqliteSampleBlock::FlushSummary()
+{
+   std::lock_guard<std::mutex> lock{ mSummaryMutex };
+   if (!mSummaryPending)
+      return;
+   // Rethrows any exception from the calculation
+   mSummaryFuture.get();
+
+   // The update owns what it writes
+   struct Summary {
+      double sumMin, sumMax, sumRms;
+      ArrayOf<char> summary256, summary64k;
+      Sizes sizes;
+   };
+   auto pSummary = std::make_shared<Summary>();
+   pSummary->sumMin = mSumMin;
+   pSummary->sumMax = mSumMax;
+   pSummary->sumRms = mSumRms;
+   pSummary->summary256 = std::move(mSummary256);
+   pSummary->summary64k = std::move(mSummary64k);
+   pSummary->sizes = mSummarySizes;
+
+   SetSpaceUsage(RowSpaceUsage(mBlockID,
+      static_cast<int>(mSampleFormat) |
+         (mEncoded ? SampleBlockCodec::EncodedFlag : 0),
+      mSumMin, mSumMax, mSumRms, mSummarySizes, mBlobBytes));
+
+   SubmitWrite([conn = Conn(), id = mBlockID, pSummary](sqlite3 *)
+   {
+      auto &summary = *pSummary;
+      return RunWrite(*conn, DBConnection::UpdateSampleBlockSummary,
+         "UPDATE sampleblocks SET summin = ?1, summax = ?2, sumrms = ?3,"
+         "                        summary256 = ?4, summary64k = ?5"
+         "                    WHERE blockid = ?6;",
+         [&](sqlite3_stmt *stmt) {
+            return sqlite3_bind_double(stmt, 1, summary.sumMin) ||
+               sqlite3_bind_double(stmt, 2, summary.sumMax) ||
+               sqlite3_bind_double(stmt, 3, summary.sumRms) ||
+               sqlite3_bind_blob(stmt, 4, summary.summary256.get(), summary.sizes.first, SQLITE_STATIC) ||
+               sqlite3_bind_blob(stmt, 5, summary.summary64k.get(), summary.sizes.second, SQLITE_STATIC) ||
+               sqlite3_bind_int64(stmt, 6, id);
+         });
+   });
+
+   mSummaryPending = false;
 }
 
 bool SqliteSampleBlock::GetSummary256(float *dest,
@@ -465,6 +1368,28 @@ bool SqliteSampleBlock::GetSummary(float *dest,
    // Non-throwing, it returns true for success
    bool silent = IsSilent();
    if (!silent) {
+      // Summaries of a deferred block are calculated on first use
+      try { Materialize(); }
+      catch ( const AudacityException & ) {
+         memset(dest, 0, 3 * numframes * sizeof( float ));
+         return false;
+      }
+
+      std::unique_lock<std::mutex> lock{ mSummaryMutex };
+      if (mSummaryPending) {
+         // Not yet written; use what the worker calculates
+         WaitForSummary();
+         const bool is256 = (id == DBConnection::GetSummary256);
+         CopyBlob(dest, floatSample,
+            (is256 ? mSummary256 : mSummary64k).get(),
+            is256 ? mSummarySizes.first : mSummarySizes.second,
+            floatSample,
+            frameoffset * fields * SAMPLE_SIZE(floatSample),
+            numframes * fields * SAMPLE_SIZE(floatSample));
+         return true;
+      }
+      lock.unlock();
+
       // Not a silent block
       try {
          // Prepare and cache statement...automatically finalized at DB close
@@ -489,16 +1414,22 @@ bool SqliteSampleBlock::GetSummary(float *dest,
 
 double SqliteSampleBlock::GetSumMin() const
 {
+   Materialize();
+   WaitForSummary();
    return mSumMin;
 }
 
 double SqliteSampleBlock::GetSumMax() const
 {
+   Materialize();
+   WaitForSummary();
    return mSumMax;
 }
 
 double SqliteSampleBlock::GetSumRms() const
 {
+   Materialize();
+   WaitForSummary();
    return mSumRms;
 }
 
@@ -514,22 +1445,20 @@ MinMaxRMS SqliteSampleBlock::DoGetMinMaxRMS(size_t start, size_t len)
 
    float min = FLT_MAX;
    float max = -FLT_MAX;
-   float sumsq = 0;
+   double sumsq = 0;
 
    if (!mValid)
    {
       Load(mBlockID);
    }
 
-   if (start < mSampleCount)
-   {
-      len = std::min(len, mSampleCount - start);
-
-      // TODO: actually use summaries
-      SampleBuffer blockData(len, floatSample);
+   const auto accumulate = [&](size_t from, size_t count) {
+      if (count == 0)
+         return;
+      SampleBuffer blockData(count, floatSample);
       float *samples = (float *) blockData.ptr();
 
-      size_t copied = DoGetSamples((samplePtr) samples, floatSample, start, len);
+      size_t copied = DoGetSamples((samplePtr) samples, floatSample, from, count);
       for (size_t i = 0; i < copied; ++i, ++samples)
       {
          float sample = *samples;
@@ -546,6 +1475,36 @@ MinMaxRMS SqliteSampleBlock::DoGetMinMaxRMS(size_t start, size_t len)
 
          sumsq += (sample * sample);
       }
+   };
+
+   if (start < mSampleCount)
+   {
+      len = std::min(len, mSampleCount - start);
+
+      // Unless the samples are cached, use the 256 sample summaries of the
+      // frames wholly inside the range, reading only the samples of partial
+      // frames at the ends
+      const auto frame0 = (start + 255) / 256;
+      const auto frame1 = (start + len) / 256;
+      bool summarized = false;
+      if (frame1 > frame0 && !IsResident()) {
+         const auto nFrames = frame1 - frame0;
+         SampleBuffer summary(fields * nFrames, floatSample);
+         const auto frames = (const float *) summary.ptr();
+         if (GetSummary256((float *) summary.ptr(), frame0, nFrames)) {
+            for (size_t i = 0; i < nFrames; ++i) {
+               const auto frame = frames + fields * i;
+               min = std::min(min, frame[0]);
+               max = std::max(max, frame[1]);
+               sumsq += double(frame[2]) * frame[2] * 256;
+            }
+            accumulate(start, frame0 * 256 - start);
+            accumulate(frame1 * 256, start + len - frame1 * 256);
+            summarized = true;
+         }
+      }
+      if (!summarized)
+         accumulate(start, len);
    }
 
    return { min, max, (float) sqrt(sumsq / len) };
@@ -556,6 +1515,8 @@ MinMaxRMS SqliteSampleBlock::DoGetMinMaxRMS(size_t start, size_t len)
 /// these values are already computed.
 MinMaxRMS SqliteSampleBlock::DoGetMinMaxRMS() const
 {
+   Materialize();
+   WaitForSummary();
    return { (float) mSumMin, (float) mSumMax, (float) mSumRms };
 }
 
@@ -563,8 +1524,40 @@ size_t SqliteSampleBlock::GetSpaceUsage() const
 {
    if (IsSilent())
       return 0;
-   else
-      return ProjectFileIO::GetDiskUsage(*Conn(), mBlockID);
+   if (const auto usage = mSpaceUsage.load(); usage >= 0)
+      return usage;
+   WaitForWrite();
+   const auto usage = ProjectFileIO::GetDiskUsage(*Conn(), mBlockID);
+   {
+      // A deferred block still changes the row
+      std::lock_guard<std::mutex> lock{ mSourceMutex };
+      if (!mpSource) {
+         auto expected = int64_t{ -1 };
+         mSpaceUsage.compare_exchange_strong(expected, usage);
+      }
+   }
+   return usage;
+}
+
+int64_t SqliteSampleBlock::RowSpaceUsage(SampleBlockID id, int format,
+   double sumMin, double sumMax, double sumRms,
+   Sizes summarySizes, size_t blobBytes)
+{
+   // Numbers are measured as the text that SQLite would make of them
+   const auto realLength = [](double value) {
+      char buffer[32];
+      sqlite3_snprintf(sizeof buffer, buffer, "%!.15g", value);
+      return strlen(buffer);
+   };
+   return std::to_string(id).size() + std::to_string(format).size() +
+      realLength(sumMin) + realLength(sumMax) + realLength(sumRms) +
+      summarySizes.first + summarySizes.second + blobBytes;
+}
+
+void SqliteSampleBlock::SetSpaceUsage(int64_t usage) const
+{
+   const auto old = mSpaceUsage.exchange(usage);
+   Conn()->AddSpaceUsage(usage - std::max<int64_t>(old, 0));
 }
 
 size_t SqliteSampleBlock::GetBlob(void *dest,
@@ -582,9 +1575,9 @@ size_t SqliteSampleBlock::GetBlob(void *dest,
    {
       Load(mBlockID);
    }
+   WaitForWrite();
 
    int rc;
-   size_t minbytes = 0;
 
    // Bind statement parameters
    // Might return SQLITE_MISUSE which means it's our mistake that we violated
@@ -624,16 +1617,48 @@ size_t SqliteSampleBlock::GetBlob(void *dest,
    }
 
    // Retrieve returned data
-   samplePtr src = (samplePtr) sqlite3_column_blob(stmt, 0);
+   auto src = (constSamplePtr) sqlite3_column_blob(stmt, 0);
    size_t blobbytes = (size_t) sqlite3_column_bytes(stmt, 0);
 
-   srcoffset = std::min(srcoffset, blobbytes);
-   minbytes = std::min(srcbytes, blobbytes - srcoffset);
-
-   if (srcoffset != 0)
-   {
-      srcoffset += 0;
+   // An encoding is decoded whole, even for part of the samples
+   std::optional<SampleBuffer> decoded;
+   bool valid = true;
+   if (mEncoded) {
+      decoded.emplace(mSampleCount, mSampleFormat);
+      valid = SampleBlockCodec::Decode(
+         src, blobbytes, mSampleFormat, decoded->ptr(), mSampleCount);
+      src = decoded->ptr();
+      blobbytes = mSampleBytes;
    }
+   if (valid)
+      CopyBlob(dest, destformat, src, blobbytes, srcformat, srcoffset, srcbytes);
+
+   // Clear statement bindings and rewind statement
+   sqlite3_clear_bindings(stmt);
+   sqlite3_reset(stmt);
+
+   if (!valid)
+      throw SimpleMessageBoxException{
+         ExceptionType::Internal,
+         XO("Audio data in the project file could not be decoded"),
+         XO("Warning")
+      };
+
+   return srcbytes;
+}
+
+//! Copy part of a blob fetched from the database, padding with zeroes
+/*! @return srcbytes */
+size_t SqliteSampleBlock::CopyBlob(void *dest,
+                                   sampleFormat destformat,
+                                   constSamplePtr src,
+                                   size_t blobbytes,
+                                   sampleFormat srcformat,
+                                   size_t srcoffset,
+                                   size_t srcbytes)
+{
+   srcoffset = std::min(srcoffset, blobbytes);
+   const auto minbytes = std::min(srcbytes, blobbytes - srcoffset);
 
    /*
     Will dithering happen in CopySamples?  Answering this as of 3.0.3 by
@@ -684,10 +1709,6 @@ size_t SqliteSampleBlock::GetBlob(void *dest,
       memset(dest, 0, srcbytes - minbytes);
    }
 
-   // Clear statement bindings and rewind statement
-   sqlite3_clear_bindings(stmt);
-   sqlite3_reset(stmt);
-
    return srcbytes;
 }
 
@@ -705,9 +1726,27 @@ void SqliteSampleBlock::Load(SampleBlockID sbid)
    mSumMax = -FLT_MAX;
    mSumMin = 0.0;
 
+   // While a project loads, the row was probably read ahead
+   DBConnection::SampleBlockInfo info;
+   if (Conn()->FindPrefetchedSampleBlock(sbid, info))
+   {
+      mBlockID = sbid;
+      mSumMin = info.sumMin;
+      mSumMax = info.sumMax;
+      mSumRms = info.sumRms;
+      mSpaceUsage = info.spaceUsage;
+      SetStorage(info.format, info.bytes);
+      mValid = true;
+      return;
+   }
+
    // Prepare and cache statement...automatically finalized at DB close
    sqlite3_stmt *stmt = Conn()->Prepare(DBConnection::LoadSampleBlock,
       "SELECT sampleformat, summin, summax, sumrms,"
+      "       length(samples),"
+      "       length(blockid) + length(sampleformat) +"
+      "       length(summin) + length(summax) + length(sumrms) +"
+      "       length(summary256) + length(summary64k) +"
       "       length(samples)"
       "  FROM sampleblocks WHERE blockid = ?1;");
 
@@ -745,135 +1784,164 @@ void SqliteSampleBlock::Load(SampleBlockID sbid)
 
    // Retrieve returned data
    mBlockID = sbid;
-   mSampleFormat = (sampleFormat) sqlite3_column_int(stmt, 0);
+   const auto format = sqlite3_column_int(stmt, 0);
    mSumMin = sqlite3_column_double(stmt, 1);
    mSumMax = sqlite3_column_double(stmt, 2);
    mSumRms = sqlite3_column_double(stmt, 3);
-   mSampleBytes = sqlite3_column_int(stmt, 4);
-   mSampleCount = mSampleBytes / SAMPLE_SIZE(mSampleFormat);
+   const auto blobbytes = sqlite3_column_int(stmt, 4);
+   mSpaceUsage = sqlite3_column_int64(stmt, 5);
 
    // Clear statement bindings and rewind statement
    sqlite3_clear_bindings(stmt);
    sqlite3_reset(stmt);
 
+   SetStorage(format, blobbytes);
    mValid = true;
 }
 
-void SqliteSampleBlock::Commit(Sizes sizes)
+int SqliteSampleBlock::Encode(
+   constSamplePtr samples, std::vector<char> &encoded)
 {
-   const auto mSummary256Bytes = sizes.first;
-   const auto mSummary64kBytes = sizes.second;
-
-   auto db = DB();
-   int rc;
-
-   // Prepare and cache statement...automatically finalized at DB close
-   sqlite3_stmt *stmt = Conn()->Prepare(DBConnection::InsertSampleBlock,
-      "INSERT INTO sampleblocks (sampleformat, summin, summax, sumrms,"
-      "                          summary256, summary64k, samples)"
-      "                         VALUES(?1,?2,?3,?4,?5,?6,?7);");
-
-   // Bind statement parameters
-   // Might return SQLITE_MISUSE which means it's our mistake that we violated
-   // preconditions; should return SQL_OK which is 0
-   if (sqlite3_bind_int(stmt, 1, static_cast<int>(mSampleFormat)) ||
-       sqlite3_bind_double(stmt, 2, mSumMin) ||
-       sqlite3_bind_double(stmt, 3, mSumMax) ||
-       sqlite3_bind_double(stmt, 4, mSumRms) ||
-       sqlite3_bind_blob(stmt, 5, mSummary256.get(), mSummary256Bytes, SQLITE_STATIC) ||
-       sqlite3_bind_blob(stmt, 6, mSummary64k.get(), mSummary64kBytes, SQLITE_STATIC) ||
-       sqlite3_bind_blob(stmt, 7, mSamples.get(), mSampleBytes, SQLITE_STATIC))
-   {
-
-      ADD_EXCEPTION_CONTEXT(
-         "sqlite3.rc", std::to_string(sqlite3_errcode(Conn()->DB())));
-      ADD_EXCEPTION_CONTEXT("sqlite3.context", "SqliteSampleBlock::Commit::bind");
+   encoded.clear();
+   if (samples && mpFactory->mCompression.IsEnabled())
+      encoded = SampleBlockCodec::Encode(samples, mSampleCount, mSampleFormat);
+   mEncoded = !encoded.empty();
+   return static_cast<int>(mSampleFormat) |
+      (mEncoded ? SampleBlockCodec::EncodedFlag : 0);
+}
 
+void SqliteSampleBlock::SetStorage(int format, size_t blobbytes)
+{
+   mEncoded = (format & SampleBlockCodec::EncodedFlag) != 0;
+   mSampleFormat =
+      static_cast<sampleFormat>(format & ~SampleBlockCodec::EncodedFlag);
+   mSampleCount = mEncoded
+      ? SampleBlockCodec::ReadSampleCount(DB(), mBlockID)
+      : blobbytes / SAMPLE_SIZE(mSampleFormat);
+   mSampleBytes = mSampleCount * SAMPLE_SIZE(mSampleFormat);
+}
 
-      wxASSERT_MSG(false, wxT("Binding failed...bug!!!"));
+void SqliteSampleBlock::Commit(
+   Sizes sizes, constSamplePtr samples, bool withSummaries)
+{
+   const auto conn = Conn();
+   // The row is inserted later, but its id is known now
+   mBlockID = conn->ReserveBlockID();
+
+   // The update owns what it writes
+   struct Row {
+      double sumMin, sumMax, sumRms;
+      ArrayOf<char> summary256, summary64k;
+      Sizes sizes;
+      std::vector<char> samples;
+      int format;
+      bool withSummaries, withSamples;
+   };
+   auto pRow = std::make_shared<Row>();
+   auto &row = *pRow;
+   // A deferred block has no samples yet, and is encoded when it gets them
+   row.format = Encode(samples, row.samples);
+   if (samples && !mEncoded)
+      row.samples.assign(samples, samples + mSampleBytes);
+   row.withSamples = samples != nullptr;
+   // If the summaries are still being calculated, leave them NULL for now,
+   // and don't touch the fields that the worker writes
+   row.withSummaries = withSummaries;
+   if (withSummaries) {
+      row.sumMin = mSumMin;
+      row.sumMax = mSumMax;
+      row.sumRms = mSumRms;
+      row.summary256 = std::move(mSummary256);
+      row.summary64k = std::move(mSummary64k);
+      row.sizes = sizes;
    }
+   mBlobBytes = row.samples.size();
 
-   // Execute the statement
-   rc = sqlite3_step(stmt);
-   if (rc != SQLITE_DONE)
-   {
-      ADD_EXCEPTION_CONTEXT("sqlite3.rc", std::to_string(rc));
-      ADD_EXCEPTION_CONTEXT("sqlite3.context", "SqliteSampleBlock::Commit::step");
+   // GetDiskUsage() finds nothing in a row with a NULL column, until
+   // FlushSummary() or Materialize() fills them
+   SetSpaceUsage(withSummaries && row.withSamples
+      ? RowSpaceUsage(mBlockID, row.format,
+         row.sumMin, row.sumMax, row.sumRms, row.sizes, mBlobBytes)
+      : 0);
 
-      wxLogDebug(wxT("SqliteSampleBlock::Commit - SQLITE error %s"), sqlite3_errmsg(db));
-
-      // Clear statement bindings and rewind statement
-      sqlite3_clear_bindings(stmt);
-      sqlite3_reset(stmt);
-
-      // Just showing the user a simple message, not the library error too
-      // which isn't internationalized
-      Conn()->ThrowException( true );
-   }
+   SubmitWrite([conn, id = mBlockID, pRow](sqlite3 *)
+   {
+      auto &row = *pRow;
+      return RunWrite(*conn, DBConnection::InsertSampleBlock,
+         "INSERT INTO sampleblocks (blockid, sampleformat,"
+         "                          summin, summax, sumrms,"
+         "                          summary256, summary64k, samples)"
+         "                         VALUES(?1,?2,?3,?4,?5,?6,?7,?8);",
+         [&](sqlite3_stmt *stmt) {
+            return sqlite3_bind_int64(stmt, 1, id) ||
+               sqlite3_bind_int(stmt, 2, row.format) ||
+               (row.withSummaries
+                  ? (sqlite3_bind_double(stmt, 3, row.sumMin) ||
+                     sqlite3_bind_double(stmt, 4, row.sumMax) ||
+                     sqlite3_bind_double(stmt, 5, row.sumRms) ||
+                     sqlite3_bind_blob(stmt, 6, row.summary256.get(), row.sizes.first, SQLITE_STATIC) ||
+                     sqlite3_bind_blob(stmt, 7, row.summary64k.get(), row.sizes.second, SQLITE_STATIC))
+                  : (sqlite3_bind_null(stmt, 3) ||
+                     sqlite3_bind_null(stmt, 4) ||
+                     sqlite3_bind_null(stmt, 5) ||
+                     sqlite3_bind_null(stmt, 6) ||
+                     sqlite3_bind_null(stmt, 7))) ||
+               (row.withSamples
+                  ? sqlite3_bind_blob(stmt, 8, row.samples.data(), row.samples.size(), SQLITE_STATIC)
+                  : sqlite3_bind_null(stmt, 8));
+         });
+   });
 
-   // Retrieve returned data
-   mBlockID = sqlite3_last_insert_rowid(db);
+   // In case a row id is reused, don't let stale contents be found
+   mpFactory->mPayloadCache.Erase(mBlockID);
 
-   // Reset local arrays
-   mSamples.reset();
-   mSummary256.reset();
-   mSummary64k.reset();
    {
       std::lock_guard<std::mutex> lock(mCacheMutex);
       mCache.reset();
    }
 
-   // Clear statement bindings and rewind statement
-   sqlite3_clear_bindings(stmt);
-   sqlite3_reset(stmt);
-
    mValid = true;
 }
 
 void SqliteSampleBlock::Delete()
 {
-   auto db = DB();
-   int rc;
-
    wxASSERT(!IsSilent());
 
-   // Prepare and cache statement...automatically finalized at DB close
-   sqlite3_stmt *stmt = Conn()->Prepare(DBConnection::DeleteSampleBlock,
-      "DELETE FROM sampleblocks WHERE blockid = ?1;");
-
-   // Bind statement parameters
-   // Might return SQLITE_MISUSE which means it's our mistake that we violated
-   // preconditions; should return SQL_OK which is 0
-   if (sqlite3_bind_int64(stmt, 1, mBlockID))
    {
-      ADD_EXCEPTION_CONTEXT(
-         "sqlite3.rc", std::to_string(sqlite3_errcode(Conn()->DB())));
-      ADD_EXCEPTION_CONTEXT("sqlite3.context", "SqliteSampleBlock::Delete::bind");
-
-      wxASSERT_MSG(false, wxT("Binding failed...bug!!!"));
+      // Summaries will never be needed
+      std::lock_guard<std::mutex> lock{ mSummaryMutex };
+      WaitForSummary();
+      mSummaryPending = false;
    }
 
-   // Execute the statement
-   rc = sqlite3_step(stmt);
-   if (rc != SQLITE_DONE)
+   std::shared_future<int> future;
    {
-      ADD_EXCEPTION_CONTEXT("sqlite3.rc", std::to_string(rc));
-      ADD_EXCEPTION_CONTEXT("sqlite3.context", "SqliteSampleBlock::Delete::step");
-
-      wxLogDebug(wxT("SqliteSampleBlock::Load - SQLITE error %s"), sqlite3_errmsg(db));
-
-      // Clear statement bindings and rewind statement
-      sqlite3_clear_bindings(stmt);
-      sqlite3_reset(stmt);
-
-      // Just showing the user a simple message, not the library error too
-      // which isn't internationalized
-      Conn()->ThrowException( true );
+      std::lock_guard<std::mutex> lock{ mWriteFutureMutex };
+      future = mWriteFuture;
    }
+   if (future.valid() &&
+       future.wait_for(std::chrono::seconds{ 0 }) != std::future_status::ready)
+      // The row is not yet written; delete it after it is
+      Conn()->SubmitWrite([conn = Conn(), id = mBlockID](sqlite3 *)
+      {
+         return RunWrite(*conn, DBConnection::DeleteSampleBlock,
+            "DELETE FROM sampleblocks WHERE blockid = ?1;",
+            [&](sqlite3_stmt *stmt) {
+               return sqlite3_bind_int64(stmt, 1, id);
+            });
+      });
+   else
+      // Freeing the pages of the row can take long, and discarding history
+      // destroys very many blocks at once, so not in this thread
+      Conn()->DeleteInBackground({ mBlockID });
 
-   // Clear statement bindings and rewind statement
-   sqlite3_clear_bindings(stmt);
-   sqlite3_reset(stmt);
+   mpFactory->mPayloadCache.Erase(mBlockID);
+
+   if (const auto usage = mSpaceUsage.exchange(0); usage >= 0)
+      Conn()->AddSpaceUsage(-usage);
+   else
+      // The total can't be kept
+      Conn()->SetSpaceUsage({});
 }
 
 void SqliteSampleBlock::SaveXML(XMLWriter &xmlFile)
@@ -898,7 +1966,7 @@ auto SqliteSampleBlock::SetSizes(
 /// This method also has the side effect of setting the mSumMin,
 /// mSumMax, and mSumRms members of this class.
 ///
-void SqliteSampleBlock::CalcSummary(Sizes sizes)
+void SqliteSampleBlock::CalcSummary(Sizes sizes, constSamplePtr src)
 {
    const auto mSummary256Bytes = sizes.first;
    const auto mSummary64kBytes = sizes.second;
@@ -908,12 +1976,12 @@ void SqliteSampleBlock::CalcSummary(Sizes sizes)
 
    if (mSampleFormat == floatSample)
    {
-      samples = (float *) mSamples.get();
+      samples = (float *) src;
    }
    else
    {
       samplebuffer.reinit((unsigned) mSampleCount);
-      SamplesToFloats(mSamples.get(), mSampleFormat,
+      SamplesToFloats(src, mSampleFormat,
          samplebuffer.get(), mSampleCount);
       samples = samplebuffer.get();
    }
@@ -930,6 +1998,12 @@ void SqliteSampleBlock::CalcSummary(Sizes sizes)
    double totalSquares = 0.0;
    double fraction = 0.0;
 
+   // Hash the stored bytes in the same pass, while they are in cache
+   std::optional<crypto::SHA256> hasher;
+   if (mpFactory->ComputesContentHashes())
+      hasher.emplace();
+   const auto sampleSize = SAMPLE_SIZE(mSampleFormat);
+
    // Recalc 256 summaries
    int sumLen = (mSampleCount + 255) / 256;
    int summaries = 256;
@@ -947,22 +2021,19 @@ void SqliteSampleBlock::CalcSummary(Sizes sizes)
          fraction = 1.0 - (jcount / 256.0);
       }
 
+      // Branch-free, so that compilers can vectorize it
+      const float *frame = samples + i * 256;
       for (int j = 1; j < jcount; ++j)
       {
-         float f1 = samples[i * 256 + j];
+         const float f1 = frame[j];
          sumsq += f1 * f1;
-
-         if (f1 < min)
-         {
-            min = f1;
-         }
-         else if (f1 > max)
-         {
-            max = f1;
-         }
+         min = std::min(min, f1);
+         max = std::max(max, f1);
       }
 
       totalSquares += sumsq;
+      if (hasher)
+         hasher->Update(src + i * 256 * sampleSize, jcount * sampleSize);
 
       summary256[i * fields] = min;
       summary256[i * fields + 1] = max;
@@ -1049,6 +2120,9 @@ void SqliteSampleBlock::CalcSummary(Sizes sizes)
 
    mSumMin = min;
    mSumMax = max;
+
+   if (hasher)
+      mContentHash = hasher->Finalize();
 }
 
 //! Just to find a denominator for a progress indicator.
@@ -1063,8 +2137,7 @@ static size_t EstimateRemovedBlocks(
    using namespace WaveTrackUtilities;
    SampleBlockIDSet wontDelete;
    auto f = [&](const UndoStackElem &elem) {
-      if (auto pTracks = UndoTracks::Find(elem))
-         InspectBlocks(*pTracks, {}, &wontDelete);
+      CompactUndoTracks::InspectBlocks(elem, {}, &wontDelete);
    };
    manager.VisitStates(f, 0, begin);
    manager.VisitStates(f, end, manager.GetNumStates());
@@ -1075,22 +2148,23 @@ static size_t EstimateRemovedBlocks(
    // Collect ids that won't survive (and are not negative pseudo ids)
    SampleBlockIDSet seen, mayDelete;
    manager.VisitStates([&](const UndoStackElem &elem) {
-      if (auto pTracks = UndoTracks::Find(elem)) {
-         InspectBlocks(*pTracks,
-            [&](SampleBlockConstPtr pBlock){
-               auto id = pBlock->GetBlockID();
-               if (id > 0 && !wontDelete.count(id))
-                  mayDelete.insert(id);
-            },
-            &seen
-         );
-      }
+      CompactUndoTracks::InspectBlocks(elem,
+         [&](SampleBlockConstPtr pBlock){
+            auto id = pBlock->GetBlockID();
+            if (id > 0 && !wontDelete.count(id))
+               mayDelete.insert(id);
+         },
+         &seen
+      );
    }, begin, end);
    return mayDelete.size();
 }
 
 void SqliteSampleBlockFactory::OnBeginPurge(size_t begin, size_t end)
 {
+   // Most of what is cached is about to be deleted
+   mPayloadCache.Clear();
+
    // Install a callback function that updates a progress indicator
    using namespace BasicUI;
 
@@ -1128,3 +2202,18 @@ static SampleBlockFactory::Factory::Scope scope{ []( AudacityProject &project )
 {
    return std::make_shared<SqliteSampleBlockFactory>( project );
 } };
+
+// Older versions would take encoded samples for raw ones
+static ProjectFormatExtensionsRegistry::Extension encodedBlocksExtension(
+   [](const AudacityProject& project) -> ProjectFormatVersion {
+      bool encoded = false;
+      WaveTrackUtilities::InspectBlocks(TrackList::Get(project),
+         [&](std::shared_ptr<const SampleBlock> pBlock){
+            if (const auto pSqliteBlock =
+                dynamic_cast<const SqliteSampleBlock*>(pBlock.get()))
+               encoded = encoded || pSqliteBlock->IsEncoded();
+         });
+      return encoded ? ProjectFormatVersion{ 3, 6, 0, 0 }
+         : BaseProjectFormatVersion;
+   }
+);
@@ -25,6 +25,8 @@ UndoManager
 
 #include <wx/hashset.h>
 
+#include <cstdlib>
+
 #include "BasicUI.h"
 #include "Project.h"
 #include "TransactionScope.h"
@@ -38,6 +40,17 @@ bool UndoStateExtension::CanUndoOrRedo(const AudacityProject &)
    return true;
 }
 
+std::shared_ptr<UndoStateExtension>
+UndoStateExtension::Compact(AudacityProject &)
+{
+   return nullptr;
+}
+
+bool UndoStateExtension::IsCompact() const
+{
+   return false;
+}
+
 namespace {
    using Savers = std::vector<UndoRedoExtensionRegistry::Saver>;
    static Savers &GetSavers()
@@ -54,6 +67,23 @@ namespace {
             result.emplace_back(saver(project));
       return result;
    }
+
+   //! Replace the compact extensions with new captures from the project
+   void ExpandExtensions(
+      AudacityProject &project, UndoState::Extensions &extensions)
+   {
+      // Extensions are in the order of the non-null savers
+      size_t ii = 0;
+      for (auto &saver : GetSavers()) {
+         if (!saver)
+            continue;
+         if (ii == extensions.size())
+            break;
+         if (auto &pExtension = extensions[ii++];
+             pExtension && pExtension->IsCompact())
+            pExtension = saver(project);
+      }
+   }
 }
 
 UndoRedoExtensionRegistry::Entry::Entry(const Saver &saver)
@@ -249,6 +279,8 @@ void UndoManager::PushState(const TranslatableString &longDescription,
 
    lastAction = longDescription;
 
+   CompactStates();
+
    EnqueueMessage({ UndoRedoMessage::Pushed });
 }
 
@@ -270,6 +302,8 @@ void UndoManager::SetStateTo(unsigned int n, const Consumer &consumer)
    mayConsolidate = false;
 
    consumer( *stack[current] );
+   ExpandCurrentState();
+   CompactStates();
 
    EnqueueMessage({ UndoRedoMessage::Reset });
 }
@@ -284,6 +318,8 @@ void UndoManager::Undo(const Consumer &consumer)
    mayConsolidate = false;
 
    consumer( *stack[current] );
+   ExpandCurrentState();
+   CompactStates();
 
    EnqueueMessage({ UndoRedoMessage::UndoOrRedo });
 }
@@ -311,10 +347,36 @@ void UndoManager::Redo(const Consumer &consumer)
    mayConsolidate = false;
 
    consumer( *stack[current] );
+   ExpandCurrentState();
+   CompactStates();
 
    EnqueueMessage({ UndoRedoMessage::UndoOrRedo });
 }
 
+void UndoManager::CompactStates()
+{
+   for (int ii = 0, size = stack.size(); ii < size; ++ii) {
+      auto &state = stack[ii]->state;
+      if (state.compacted || ii == saved ||
+          std::abs(ii - current) <= ExpandedStates)
+         continue;
+      for (auto &pExtension : state.extensions)
+         if (pExtension)
+            if (auto pCompact = pExtension->Compact(mProject))
+               pExtension = std::move(pCompact);
+      state.compacted = true;
+   }
+}
+
+void UndoManager::ExpandCurrentState()
+{
+   auto &state = stack[current]->state;
+   if (state.compacted) {
+      ExpandExtensions(mProject, state.extensions);
+      state.compacted = false;
+   }
+}
+
 void UndoManager::VisitStates( const Consumer &consumer, bool newestFirst )
 {
    auto fn = [&]( decltype(stack[0]) &ptr ){ consumer( *ptr ); };
@@ -89,6 +89,16 @@ public:
 
    //! Whether undo or redo is now permitted; default returns true
    virtual bool CanUndoOrRedo(const AudacityProject &project);
+
+   //! Return an equivalent using less memory, or null if there is none
+   /*! Called for states far from the current state; default returns null */
+   virtual std::shared_ptr<UndoStateExtension>
+      Compact(AudacityProject &project);
+
+   //! Whether this was returned by Compact(); default returns false
+   /*! Such extensions are not kept when their state becomes current, but
+    captured again from the restored project */
+   virtual bool IsCompact() const;
 };
 
 class PROJECT_HISTORY_API UndoRedoExtensionRegistry {
@@ -112,6 +122,8 @@ struct UndoState {
    {}
 
    Extensions extensions;
+   //! Whether Compact() was already tried on the extensions
+   bool compacted{ false };
 };
 
 struct UndoStackElem {
@@ -147,7 +159,12 @@ inline UndoPush operator & (UndoPush a, UndoPush b)
 { return static_cast<UndoPush>(static_cast<int>(a) & static_cast<int>(b)); }
 
 //! Maintain a non-persistent list of states of the project, to support undo and redo commands
-/*! The history should be cleared before destruction */
+/*! The history should be cleared before destruction.
+
+ States more than ExpandedStates away from the current state, other than the
+ saved state, are compacted, so that memory does not grow as fast as the
+ history; the current and saved states are never compact.
+ */
 class PROJECT_HISTORY_API UndoManager final
    : public ClientData::Base
    , public Observer::Publisher<UndoRedoMessage>
@@ -210,9 +227,17 @@ class PROJECT_HISTORY_API UndoManager final
 
    // void Debug(); // currently unused
 
+   //! States within this distance of the current one are not compacted
+   static constexpr int ExpandedStates = 10;
+
  private:
    bool CheckAvailable(int index);
 
+   //! Compact the states far from the current and the saved states
+   void CompactStates();
+   //! Capture again the compact extensions of the current state
+   void ExpandCurrentState();
+
    void EnqueueMessage(UndoRedoMessage message);
    void RemoveStateAt(int n);
 
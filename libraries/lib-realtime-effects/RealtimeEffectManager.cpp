@@ -9,12 +9,16 @@
  **********************************************************************/
 #include "RealtimeEffectManager.h"
 #include "RealtimeEffectState.h"
+#include "RealtimeEffectWorkers.h"
 #include "Channel.h"
 
 #include <memory>
+#include "Prefs.h"
 #include "Project.h"
 
+#include <algorithm>
 #include <atomic>
+#include <thread>
 #include <wx/time.h>
 
 static const AttachedProjectObjects::RegisteredFactory manager
@@ -36,6 +40,22 @@ RealtimeEffectManager::Get(const AudacityProject &project)
    return Get(const_cast<AudacityProject &>(project));
 }
 
+IntSetting RealtimeEffectManager::ProcessingThreads{
+   L"/RealtimeEffects/Threads", 0 };
+
+size_t RealtimeEffectManager::GetProcessingThreadsCount()
+{
+   constexpr int maxThreads = 16;
+   auto count = ProcessingThreads.Read();
+   if (count <= 0) {
+      // Leave one processor for the main thread, and stay modest, because
+      // the audio thread waits for the slowest chain
+      const int hardware = std::thread::hardware_concurrency();
+      count = std::min(hardware - 1, 4);
+   }
+   return std::clamp(count, 1, maxThreads);
+}
+
 RealtimeEffectManager::RealtimeEffectManager(AudacityProject &project)
    : mProject(project)
 {
@@ -56,11 +76,16 @@ void RealtimeEffectManager::Initialize(
    // (Re)Set processor parameters
    mRates.clear();
    mGroups.clear();
+   mChainLatencies.clear();
 
    // RealtimeAdd/RemoveEffect() needs to know when we're active so it can
    // initialize newly added effects
    mActive = true;
 
+   // Start helper threads now, not in the audio thread
+   if (const auto nThreads = GetProcessingThreadsCount(); nThreads > 1)
+      mpWorkers = std::make_unique<RealtimeEffectWorkers>(nThreads - 1);
+
    // Tell each state to get ready for action
    VisitAll([&scope, sampleRate](RealtimeEffectState &state, bool) {
       scope.mInstances.push_back(state.Initialize(sampleRate));
@@ -76,6 +101,7 @@ void RealtimeEffectManager::AddGroup(
 {
    mGroups.push_back(&group);
    mRates.insert({&group, rate});
+   mChainLatencies.try_emplace(&group, 0);
 
    VisitGroup(group,
       [&](RealtimeEffectState & state, bool) {
@@ -90,13 +116,16 @@ void RealtimeEffectManager::Finalize() noexcept
    SetSuspended(true);
 
    // Assume it is now safe to clean up
-   mLatency = std::chrono::microseconds(0);
+   mLatency.store(Latency{ 0 }, std::memory_order_relaxed);
 
    VisitAll([](RealtimeEffectState &state, bool){ state.Finalize(); });
 
+   mpWorkers.reset();
+
    // Reset processor parameters
    mGroups.clear();
    mRates.clear();
+   mChainLatencies.clear();
 
    // No longer active
    mActive = false;
@@ -132,6 +161,21 @@ size_t RealtimeEffectManager::Process(bool suspended,
    // are introducing
    auto start = std::chrono::steady_clock::now();
 
+   auto discardable =
+      ProcessChain(group, buffers, scratch, dummy, nBuffers, numSamples);
+
+   // Remember the latency
+   auto end = std::chrono::steady_clock::now();
+   mLatency.store(std::chrono::duration_cast<Latency>(end - start),
+      std::memory_order_relaxed);
+
+   return discardable;
+}
+
+size_t RealtimeEffectManager::ProcessChain(const ChannelGroup &group,
+   float *const *buffers, float *const *scratch, float *const dummy,
+   unsigned nBuffers, size_t numSamples)
+{
    // Allocate the in and out buffer arrays
    const auto ibuf =
       static_cast<float **>(alloca(nBuffers * sizeof(float *)));
@@ -150,11 +194,15 @@ size_t RealtimeEffectManager::Process(bool suspended,
    // Tracks how many processors were called
    size_t called = 0;
    size_t discardable = 0;
+   EffectInstance::SampleCount latency = 0;
    VisitGroup(group,
       [&](RealtimeEffectState &state, bool)
       {
+         // Each state discards its own latency from its output, so the
+         // group stays aligned with the others
          discardable +=
             state.Process(group, nBuffers, ibuf, obuf, dummy, numSamples);
+         latency += state.GetLatency(group);
          for (auto i = 0; i < nBuffers; ++i)
             std::swap(ibuf[i], obuf[i]);
          called++;
@@ -169,9 +217,9 @@ size_t RealtimeEffectManager::Process(bool suspended,
       for (unsigned int i = 0; i < nBuffers; i++)
          memcpy(buffers[i], ibuf[i], numSamples * sizeof(float));
 
-   // Remember the latency
-   auto end = std::chrono::steady_clock::now();
-   mLatency = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+   if (const auto iter = mChainLatencies.find(&group);
+       iter != mChainLatencies.end())
+      iter->second.store(latency, std::memory_order_relaxed);
 
    //
    // This is wrong...needs to handle tails
@@ -179,6 +227,83 @@ size_t RealtimeEffectManager::Process(bool suspended,
    return discardable;
 }
 
+bool RealtimeEffectManager::AnyProjectStateProcessing() const
+{
+   bool result = false;
+   RealtimeEffectList::Get(mProject).Visit(
+      [&](const RealtimeEffectState &state, bool) {
+         result = result || state.IsProcessing();
+      });
+   return result;
+}
+
+//
+// This will be called in a thread other than the main GUI thread.
+//
+void RealtimeEffectManager::ProcessGroups(bool suspended,
+   GroupJob *jobs, size_t nJobs,
+   float *const *scratch, size_t nScratchSets, unsigned nBuffers)
+{
+   if (suspended) {
+      for (size_t iJob = 0; iJob < nJobs; ++iJob)
+         for (auto &block : jobs[iJob].blocks)
+            block.discardable = 0;
+      return;
+   }
+
+   auto start = std::chrono::steady_clock::now();
+
+   struct Context {
+      RealtimeEffectManager &manager;
+      GroupJob *jobs;
+      float *const *scratch;
+      unsigned nBuffers;
+   } context{ *this, jobs, scratch, nBuffers };
+
+   const auto job = [](void *pContext, size_t iJob, size_t iThread) {
+      auto &[manager, jobs, scratch, nBuffers] =
+         *static_cast<Context*>(pContext);
+      auto &job = jobs[iJob];
+      const auto jobStart = std::chrono::steady_clock::now();
+      // Each thread has its own set of scratch buffers
+      const auto myScratch = scratch + iThread * (2 * nBuffers + 1);
+      const auto pointers =
+         static_cast<float **>(alloca(nBuffers * sizeof(float *)));
+      for (auto &block : job.blocks) {
+         const auto len = block.numSamples;
+         block.discardable = 0;
+         if (len == 0)
+            continue;
+         unsigned iChannel = 0;
+         for (; iChannel < job.nChannels; ++iChannel)
+            pointers[iChannel] = block.buffers[iChannel];
+         // Are there more output device channels than channels of the group?
+         // Then supply some non-null fake input buffers, because the
+         // various ProcessBlock overrides of effects may crash without it.
+         auto fake = myScratch + nBuffers + 1;
+         while (iChannel < nBuffers)
+            memset((pointers[iChannel++] = *fake++), 0, len * sizeof(float));
+         block.discardable = manager.ProcessChain(*job.pGroup, pointers,
+            myScratch, myScratch[nBuffers], nBuffers, len);
+      }
+      job.elapsed = std::chrono::duration_cast<Latency>(
+         std::chrono::steady_clock::now() - jobStart);
+   };
+
+   // States on the per-project list are shared by all groups, so their
+   // instances must not run in several threads at once
+   if (mpWorkers && nScratchSets > 1 && nJobs > 1 &&
+       !AnyProjectStateProcessing())
+      mpWorkers->Run(nJobs, job, &context, nScratchSets);
+   else
+      for (size_t iJob = 0; iJob < nJobs; ++iJob)
+         job(&context, iJob, 0);
+
+   auto end = std::chrono::steady_clock::now();
+   mLatency.store(std::chrono::duration_cast<Latency>(end - start),
+      std::memory_order_relaxed);
+}
+
 //
 // This will be called in a different thread than the main GUI thread.
 //
@@ -337,10 +462,16 @@ std::optional<size_t> RealtimeEffectManager::FindState(
    return states.FindState(pState);
 }
 
-// Where is this used?
-#if 0
 auto RealtimeEffectManager::GetLatency() const -> Latency
 {
-   return mLatency; // should this be atomic?
+   return mLatency.load(std::memory_order_relaxed);
+}
+
+auto RealtimeEffectManager::GetChainLatency(const ChannelGroup &group) const
+   -> EffectInstance::SampleCount
+{
+   if (const auto iter = mChainLatencies.find(&group);
+       iter != mChainLatencies.end())
+      return iter->second.load(std::memory_order_relaxed);
+   return 0;
 }
-#endif
@@ -20,12 +20,15 @@
 #include <vector>
 
 #include "ClientData.h"
+#include "EffectInterface.h" // for EffectInstance::SampleCount
 #include "Observer.h"
 #include "PluginProvider.h" // for PluginID
 #include "RealtimeEffectList.h"
 
 class ChannelGroup;
 class EffectInstance;
+class IntSetting;
+class RealtimeEffectWorkers;
 
 namespace RealtimeEffects {
    class InitializationScope;
@@ -58,11 +61,41 @@ public:
    static RealtimeEffectManager & Get(AudacityProject &project);
    static const RealtimeEffectManager & Get(const AudacityProject &project);
 
+   //! How many threads may apply independent effect chains at once;
+   //! 0 chooses by the number of processors
+   static IntSetting ProcessingThreads;
+
+   //! Interpret ProcessingThreads; the result is at least 1
+   static size_t GetProcessingThreadsCount();
+
+   //! The unflushed samples of one group, in up to two blocks, for
+   //! ProcessGroups
+   struct GroupJob {
+      const ChannelGroup *pGroup{};
+      //! Channels of the group that have buffers, at most nBuffers
+      unsigned nChannels{};
+      struct Block {
+         //! nChannels buffers; the rest are supplied from scratch
+         float *const *buffers{};
+         size_t numSamples{};
+         //! Result: how many leading samples are discardable for latency
+         size_t discardable{};
+      } blocks[2];
+      //! Result: time that the chain took for the blocks, unless processing
+      //! was suspended
+      std::optional<Latency> elapsed;
+   };
+
    // Realtime effect processing
 
    //! To be called only from main thread
    bool IsActive() const noexcept;
-//   Latency GetLatency() const;
+   //! How long the last block of processing took
+   Latency GetLatency() const;
+   //! Total latency in samples, at the group's rate, of the chain that was
+   //! last applied to the group, which playback compensates
+   /*! May be called from any thread */
+   EffectInstance::SampleCount GetChainLatency(const ChannelGroup &group) const;
 
    //! Main thread appends a global or per-group effect
    /*!
@@ -156,8 +189,19 @@ private:
       const ChannelGroup &group,
       float *const *buffers, float *const *scratch, float *dummy,
       unsigned nBuffers, size_t numSamples);
+   /*! @copydoc ProcessScope::ProcessGroups */
+   void ProcessGroups(bool suspended,
+      GroupJob *jobs, size_t nJobs,
+      float *const *scratch, size_t nScratchSets, unsigned nBuffers);
    void ProcessEnd(bool suspended) noexcept;
 
+   //! Apply the chains of one group, without timing
+   size_t ProcessChain(const ChannelGroup &group,
+      float *const *buffers, float *const *scratch, float *dummy,
+      unsigned nBuffers, size_t numSamples);
+   //! Whether any state on the per-project list processes in this scope
+   bool AnyProjectStateProcessing() const;
+
    RealtimeEffectManager(const RealtimeEffectManager&) = delete;
    RealtimeEffectManager &operator=(const RealtimeEffectManager&) = delete;
 
@@ -202,7 +246,7 @@ private:
    }
 
    AudacityProject &mProject;
-   Latency mLatency{ 0 };
+   std::atomic<Latency> mLatency{ Latency{ 0 } };
 
    std::atomic<bool> mSuspended{ true };
 
@@ -213,6 +257,13 @@ private:
    std::vector<const ChannelGroup *> mGroups; //!< all are non-null
 
    std::unordered_map<const ChannelGroup *, double> mRates;
+   //! Keys are mutated like mGroups; values are stored in the worker thread
+   std::unordered_map<const ChannelGroup *,
+      std::atomic<EffectInstance::SampleCount>> mChainLatencies;
+
+   //! Exists between Initialize() and Finalize(), if more than one thread
+   //! is allowed
+   std::unique_ptr<RealtimeEffectWorkers> mpWorkers;
 };
 
 namespace RealtimeEffects {
@@ -298,6 +349,27 @@ public:
          return 0; // consider them trivially processed
    }
 
+   //! Process each group's unflushed blocks, groups perhaps in parallel
+   /*!
+    Each job's blocks are processed in order, by one thread.  Results are
+    stored in the jobs.
+
+    @param scratch nScratchSets consecutive sets of 2 * nBuffers + 1 buffers,
+    long enough for any block:  nBuffers for output, one dummy, and nBuffers
+    for fake input channels
+    */
+   void ProcessGroups(RealtimeEffectManager::GroupJob *jobs, size_t nJobs,
+      float *const *scratch, size_t nScratchSets, unsigned nBuffers)
+   {
+      if (auto pProject = mwProject.lock())
+         RealtimeEffectManager::Get(*pProject).ProcessGroups(
+            mSuspended, jobs, nJobs, scratch, nScratchSets, nBuffers);
+      else
+         for (size_t iJob = 0; iJob < nJobs; ++iJob)
+            for (auto &block : jobs[iJob].blocks)
+               block.discardable = 0;
+   }
+
 private:
    RealtimeEffectManager::AllListsLock mLocks;
    std::weak_ptr<AudacityProject> mwProject;
@@ -14,6 +14,7 @@
 #include "EffectInterface.h"
 #include "MessageBuffer.h"
 #include "PluginManager.h"
+#include "RealtimeSandbox.h"
 #include "SampleCount.h"
 
 #include <chrono>
@@ -362,7 +363,10 @@ std::shared_ptr<EffectInstance> RealtimeEffectState::MakeInstance()
 {
    mMovedMessage.reset();
    mMessage.reset();
-   auto result = mPlugin->MakeInstance();
+   // Third-party effects may run in a separate process, if so preferred
+   auto result = RealtimeSandbox::MakeInstance(*mPlugin, mID);
+   if (!result)
+      result = mPlugin->MakeInstance();
    if (result) {
       // Allocate presized containers in messages, so later
       // copies of contents might avoid free store operations
@@ -422,7 +426,7 @@ RealtimeEffectState::Initialize(double sampleRate)
 
    mCurrentProcessor = 0;
    mGroups.clear();
-   mLatency = {};
+   mProcessingTimes.Reset();
    return EnsureInstance(sampleRate);
 }
 
@@ -508,6 +512,11 @@ bool RealtimeEffectState::ProcessStart(bool running)
             return false;
       }
       mLastActive = active;
+      if (active)
+         // Output is delayed again after resumption, so find the latency
+         // anew and discard again
+         for (auto &pair : mGroups)
+            pair.second.latency.reset();
    }
 
    bool result = false;
@@ -544,13 +553,31 @@ size_t RealtimeEffectState::Process(
          memcpy(outbuf[ii], inbuf[ii], numSamples * sizeof(float));
       return 0;
    }
+   using Clock = std::chrono::steady_clock;
+   const auto start = Clock::now();
+   Finally Do{ [&]{
+      using namespace std::chrono;
+      mProcessingTimes.Add(
+         duration_cast<microseconds>(Clock::now() - start).count());
+   } };
+
    const auto numAudioIn = pInstance->GetAudioInCount();
    const auto numAudioOut = pInstance->GetAudioOutCount();
    const auto clientIn = stackAllocate(const float *, numAudioIn);
    const auto clientOut = stackAllocate(float *, numAudioOut);
    size_t len = 0;
-   const auto &pair = mGroups[&group];
-   auto processor = pair.first;
+   auto &groupData = mGroups[&group];
+   auto processor = groupData.first;
+   auto &latency = groupData.latency;
+   if (latency) {
+      // Settings may have changed the latency since the last call:  discard
+      // more if it increased.  (A decrease can't yet be compensated.)
+      const auto reported =
+         pInstance->GetLatency(mWorkerSettings.settings, groupData.sampleRate);
+      if (reported > groupData.reported)
+         *latency += reported - groupData.reported;
+      groupData.reported = reported;
+   }
    // Outer loop over processors
    AllocateChannelsToProcessors(chans, numAudioIn, numAudioOut,
    [&](unsigned indx, unsigned ondx){
@@ -580,11 +607,13 @@ size_t RealtimeEffectState::Process(
          // Assuming we are in a processing scope, use the worker settings
          auto processed = pInstance->RealtimeProcess(processor,
             mWorkerSettings.settings, clientIn, clientOut, cnt);
-         if (!mLatency)
-            // Find latency once only per initialization scope,
+         if (!latency) {
+            // Find latency once only per initialization scope or resumption,
             // after processing one block
-            mLatency.emplace(
-               pInstance->GetLatency(mWorkerSettings.settings, pair.second));
+            latency.emplace(pInstance->GetLatency(
+               mWorkerSettings.settings, groupData.sampleRate));
+            groupData.reported = *latency;
+         }
          for (size_t i = 0 ; i < numAudioIn; i++)
             if (clientIn[i])
                clientIn[i] += cnt;
@@ -594,9 +623,9 @@ size_t RealtimeEffectState::Process(
          if (ondx == 0) {
             // For the first processor only
             len += processed;
-            auto discard = limitSampleBufferSize(len, *mLatency);
+            auto discard = limitSampleBufferSize(len, *latency);
             len -= discard;
-            *mLatency -= discard;
+            *latency -= discard;
          }
       }
       ++processor;
@@ -632,6 +661,16 @@ bool RealtimeEffectState::IsEnabled() const noexcept
    return mMainSettings.settings.extra.GetActive();
 }
 
+auto RealtimeEffectState::GetLatency(const ChannelGroup &group) const
+   -> EffectInstance::SampleCount
+{
+   if (!mLastActive)
+      return 0;
+   if (const auto iter = mGroups.find(&group); iter != mGroups.end())
+      return iter->second.reported;
+   return 0;
+}
+
 bool RealtimeEffectState::IsActive() const noexcept
 {
    return mWorkerSettings.settings.extra.GetActive();
@@ -666,7 +705,6 @@ bool RealtimeEffectState::Finalize() noexcept
    }
 
    auto result = pInstance->RealtimeFinalize(mMainSettings.settings);
-   mLatency = {};
    mInitialized = false;
    return result;
 }
@@ -16,6 +16,7 @@
 #include <optional>
 #include <unordered_map>
 #include <vector>
+#include "AtomicHistogram.h"
 #include "ClientData.h"
 #include "EffectInterface.h"
 #include "GlobalVariable.h"
@@ -88,6 +89,20 @@ public:
    //! Worker thread finishes a batch of samples
    bool ProcessEnd();
 
+   //! Latency that the instance last reported for the group, if processing
+   /*!
+    Process() compensates it by discarding as many leading samples of output
+    for the group.  Test only in the worker thread.
+    */
+   EffectInstance::SampleCount GetLatency(const ChannelGroup &group) const;
+
+   //! Microseconds taken by each Process() that called the instance, for any
+   //! group, since Initialize(); may be read from any thread
+   const AtomicHistogram &GetProcessingTimes() const
+   {
+      return mProcessingTimes;
+   }
+
    const EffectSettings &GetSettings() const { return mMainSettings.settings; }
 
    //! Test only in the main thread
@@ -96,6 +111,10 @@ public:
    //! Test only in the worker thread, or else when there is no processing
    bool IsActive() const noexcept;
 
+   //! Whether Process() calls the instance in this processing scope
+   /*! Test only in the worker thread, after ProcessStart() */
+   bool IsProcessing() const noexcept { return mLastActive; }
+
    //! Set only in the main thread
    void SetActive(bool active);
 
@@ -174,19 +193,32 @@ private:
    std::unique_ptr<EffectInstance::Message> mMovedMessage;
    std::unique_ptr<EffectOutputs> mOutputs;
 
-   //! How many samples must be discarded
-   std::optional<EffectInstance::SampleCount> mLatency;
    //! Assigned in the worker thread at the start of each processing scope
    bool mLastActive{};
 
+   AtomicHistogram mProcessingTimes;
+
    //! @}
 
    /*! @name Members that do not change during processing
     @{
     */
     
-   std::unordered_map<const ChannelGroup *, std::pair<size_t, double>>
-      mGroups;
+   struct GroupData {
+      //! Index of the first processor for the group
+      size_t first{};
+      double sampleRate{};
+
+      // These are changed in the worker thread, but only for existing keys
+      //! How many samples of output must yet be discarded; found after
+      //! processing one block
+      std::optional<EffectInstance::SampleCount> latency;
+      //! Latency last reported by the instance
+      EffectInstance::SampleCount reported{};
+   };
+   //! Per-group latencies are kept separately, because a state on the
+   //! per-project list processes every group, each needing the compensation
+   std::unordered_map<const ChannelGroup *, GroupData> mGroups;
 
    // This must not be reset to nullptr while a worker thread is running.
    // In fact it is never yet reset to nullptr, before destruction.
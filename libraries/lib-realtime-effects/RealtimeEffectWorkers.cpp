@@ -0,0 +1,94 @@
+/**********************************************************************
+
+ Audacity: A Digital Audio Editor
+
+ @file RealtimeEffectWorkers.cpp
+
+ **********************************************************************/
+#include "RealtimeEffectWorkers.h"
+
+RealtimeEffectWorkers::RealtimeEffectWorkers(size_t nHelpers)
+{
+   mThreads.reserve(nHelpers);
+   for (size_t ii = 0; ii < nHelpers; ++ii)
+      mThreads.emplace_back([this, ii]{ Work(ii + 1); });
+}
+
+RealtimeEffectWorkers::~RealtimeEffectWorkers()
+{
+   {
+      std::lock_guard<std::mutex> guard{ mMutex };
+      mStopping = true;
+   }
+   mStart.notify_all();
+   for (auto &thread : mThreads)
+      thread.join();
+}
+
+void RealtimeEffectWorkers::Run(
+   size_t nJobs, Job job, void *context, size_t maxThreads)
+{
+   if (nJobs == 0)
+      return;
+   if (mThreads.empty() || nJobs == 1 || maxThreads <= 1) {
+      for (size_t iJob = 0; iJob < nJobs; ++iJob)
+         job(context, iJob, 0);
+      return;
+   }
+
+   {
+      std::lock_guard<std::mutex> guard{ mMutex };
+      mJob = job;
+      mContext = context;
+      mJobsCount = nJobs;
+      mMaxThreads = maxThreads;
+      mNextJob.store(0, std::memory_order_relaxed);
+      mBusy = mThreads.size();
+      ++mGeneration;
+   }
+   mStart.notify_all();
+
+   Drain(0);
+
+   // Wait for helpers still finishing a job, and also for those that found
+   // nothing left to do, so that none sees the next batch's description early
+   std::unique_lock<std::mutex> lock{ mMutex };
+   mDone.wait(lock, [this]{ return mBusy == 0; });
+}
+
+void RealtimeEffectWorkers::Drain(size_t iThread)
+{
+   while (true) {
+      const auto iJob = mNextJob.fetch_add(1, std::memory_order_relaxed);
+      if (iJob >= mJobsCount)
+         break;
+      mJob(mContext, iJob, iThread);
+   }
+}
+
+void RealtimeEffectWorkers::Work(size_t iThread)
+{
+   unsigned long long generation = 0;
+   while (true) {
+      {
+         std::unique_lock<std::mutex> lock{ mMutex };
+         mStart.wait(lock,
+            [&]{ return mStopping || mGeneration != generation; });
+         if (mStopping)
+            return;
+         generation = mGeneration;
+      }
+
+      // Helpers beyond the limit only acknowledge the batch
+      if (iThread < mMaxThreads)
+         Drain(iThread);
+
+      bool last;
+      {
+         std::lock_guard<std::mutex> guard{ mMutex };
+         last = (--mBusy == 0);
+      }
+      if (last)
+         mDone.notify_one();
+   }
+}
@@ -0,0 +1,75 @@
+/**********************************************************************
+
+ Audacity: A Digital Audio Editor
+
+ @file RealtimeEffectWorkers.h
+ @brief Helper threads that share the realtime effect chains of one block
+
+ **********************************************************************/
+
+#ifndef __AUDACITY_REALTIME_EFFECT_WORKERS__
+#define __AUDACITY_REALTIME_EFFECT_WORKERS__
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//! A fixed set of helper threads, which join the calling thread to run a
+//! batch of independent jobs, and then wait for the next batch
+/*!
+ Jobs are claimed one at a time from a shared counter, so a thread that
+ finishes a short chain takes the next unclaimed one.  The calling thread
+ works too, and Run() returns only when all jobs are done and no helper still
+ refers to the batch.  Nothing is allocated while running.
+ */
+class REALTIME_EFFECTS_API RealtimeEffectWorkers final
+{
+public:
+   //! @param iThread is 0 for the calling thread, else 1 + index of helper
+   using Job = void (*)(void *context, size_t iJob, size_t iThread);
+
+   //! Start the helpers; none if nHelpers is 0
+   explicit RealtimeEffectWorkers(size_t nHelpers);
+   //! Stop and join the helpers
+   ~RealtimeEffectWorkers();
+
+   RealtimeEffectWorkers(const RealtimeEffectWorkers&) = delete;
+   RealtimeEffectWorkers &operator=(const RealtimeEffectWorkers&) = delete;
+
+   //! Count of threads that may run jobs, including the caller
+   size_t GetThreadsCount() const { return mThreads.size() + 1; }
+
+   //! Run job(context, iJob, iThread) for each iJob in [0, nJobs)
+   /*!
+    To be called from one thread at a time.  Jobs must not throw.
+    @param maxThreads iThread is always less than this, which is at least 1
+    */
+   void Run(size_t nJobs, Job job, void *context, size_t maxThreads);
+
+private:
+   void Work(size_t iThread);
+   void Drain(size_t iThread);
+
+   std::vector<std::thread> mThreads;
+
+   std::mutex mMutex;
+   std::condition_variable mStart;
+   std::condition_variable mDone;
+   //! Incremented for each batch; guarded by mMutex
+   unsigned long long mGeneration{ 0 };
+   //! Helpers not yet finished with the current batch; guarded by mMutex
+   size_t mBusy{ 0 };
+   bool mStopping{ false };
+
+   // Describe the current batch, written only while no helper is busy
+   Job mJob{};
+   void *mContext{};
+   size_t mJobsCount{ 0 };
+   size_t mMaxThreads{ 1 };
+   std::atomic<size_t> mNextJob{ 0 };
+};
+
+#endif
@@ -18,6 +18,7 @@
 #include "ProjectNumericFormats.h"
 #include "ProjectRate.h"
 #include "ProjectSnap.h"
+#include "SnapPointIndex.h"
 #include "Track.h"
 #include "ZoomInfo.h"
 
@@ -61,12 +62,18 @@ SnapManager::SnapManager(const AudacityProject &project,
             SnapPointArray candidates,
             bool noTimeSnap,
             int pixelTolerance)
-   : SnapManager{ project,
-      // Add candidates to given ones by default rules,
-      // then delegate to other ctor
-      FindCandidates( move(candidates), tracks ),
-      zoomInfo, noTimeSnap, pixelTolerance }
+: mProject{ &project }
+, mZoomInfo{ &zoomInfo }
+, mPixelTolerance{ pixelTolerance }
+, mNoTimeSnap{ noTimeSnap }
+// The index has the points of the project's own tracks already sorted
+, mIndexed{ &tracks == &TrackList::Get(project) }
 {
+   // Add candidates to given ones by default rules, unless indexed
+   mCandidates = mIndexed
+      ? move(candidates)
+      : FindCandidates( move(candidates), tracks );
+   Reinit();
 }
 
 SnapManager::~SnapManager()
@@ -109,6 +116,18 @@ void SnapManager::Reinit()
 
    // Sort all by time
    std::sort(mSnapPoints.begin(), mSnapPoints.end());
+
+   if (mIndexed) {
+      // Merge the many points of the tracks, sorted and filtered already
+      const auto &index = SnapPointIndex::Get(*mProject);
+      const auto points =
+         mSnapToTime ? index.GetPointsOnGrid() : index.GetPoints();
+      SnapPointArray merged;
+      merged.reserve(mSnapPoints.size() + points->size());
+      std::merge(mSnapPoints.begin(), mSnapPoints.end(),
+         points->begin(), points->end(), back_inserter(merged));
+      mSnapPoints.swap(merged);
+   }
 }
 
 // Adds to mSnapPoints, filtering by TimeConverter
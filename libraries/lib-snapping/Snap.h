@@ -64,6 +64,8 @@ public:
 
    //! Construct for (optionally) specified points, plus significant points
    //! on the tracks in the given list
+   /*! Those are taken from the SnapPointIndex of the project, if tracks are
+    the project's */
    SnapManager(const AudacityProject &project,
                const TrackList &tracks,
                const ZoomInfo &zoomInfo,
@@ -101,6 +103,8 @@ private:
    //! Two time points closer than this are considered the same
    double mEpsilon{ 1 / 44100.0 };
    SnapPointArray mCandidates;
+   //! Whether to add the points of SnapPointIndex to the candidates
+   bool mIndexed{ false };
    SnapPointArray mSnapPoints;
 
    // Info for snap-to-time
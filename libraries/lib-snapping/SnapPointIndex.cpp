@@ -0,0 +1,169 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file SnapPointIndex.cpp
+
+**********************************************************************/
+#include "SnapPointIndex.h"
+
+#include <algorithm>
+
+#include "Project.h"
+#include "ProjectNumericFormats.h"
+#include "ProjectRate.h"
+#include "ProjectSnap.h"
+#include "ProjectTimeSignature.h"
+#include "Track.h"
+#include "UndoManager.h"
+
+namespace {
+bool EarlierPoint(const SnapPoint &s1, const SnapPoint &s2)
+{
+   return s1.t < s2.t;
+}
+
+void AddTrackPoints(SnapPointArray &points, const Track &track)
+{
+   for (const auto &interval : track.Intervals()) {
+      points.emplace_back(interval->Start(), &track);
+      if (interval->Start() != interval->End())
+         points.emplace_back(interval->End(), &track);
+   }
+}
+}
+
+static const AudacityProject::AttachedObjects::RegisteredFactory sKey {
+   [](AudacityProject& project)
+   {
+      return std::make_shared<SnapPointIndex>(project);
+   }
+};
+
+SnapPointIndex& SnapPointIndex::Get(AudacityProject& project)
+{
+   return project.AttachedObjects::Get<SnapPointIndex>(sKey);
+}
+
+const SnapPointIndex& SnapPointIndex::Get(const AudacityProject& project)
+{
+   return Get(const_cast<AudacityProject&>(project));
+}
+
+SnapPointIndex::SnapPointIndex(AudacityProject& project)
+   : mProject{ project }
+   , mTrackListSubscription{
+      TrackList::Get(project).Subscribe([this](const TrackListEvent &event){
+         const auto pTrack = event.mpTrack.lock();
+         if (!pTrack)
+            return;
+         switch (event.mType) {
+         case TrackListEvent::ADDITION:
+            return OnTrackAdded(*pTrack);
+         case TrackListEvent::DELETION:
+            return OnTrackDeleted(*pTrack);
+         default:
+            return;
+         }
+      }) }
+   , mUndoSubscription{
+      UndoManager::Get(project).Subscribe([this](UndoRedoMessage message){
+         switch (message.type) {
+         case UndoRedoMessage::Pushed:
+         case UndoRedoMessage::Modified:
+         case UndoRedoMessage::UndoOrRedo:
+         case UndoRedoMessage::Reset:
+            // Any interval may have moved.  Gather again now, at idle time,
+            // so that the next drag finds the points ready
+            Invalidate();
+            GetPoints();
+            return;
+         default:
+            return;
+         }
+      }) }
+   , mSnapSubscription{
+      ProjectSnap::Get(project).Subscribe([this](auto&){
+         mPointsOnGrid.reset();
+      }) }
+   , mTimeSignatureSubscription{
+      ProjectTimeSignature::Get(project).Subscribe([this](auto&){
+         mPointsOnGrid.reset();
+      }) }
+{
+}
+
+SnapPointIndex::~SnapPointIndex() = default;
+
+SnapPointIndex::Points SnapPointIndex::GetPoints() const
+{
+   if (!mPoints) {
+      auto points = std::make_shared<SnapPointArray>();
+      for (const auto track : TrackList::Get(mProject))
+         AddTrackPoints(*points, *track);
+      std::sort(points->begin(), points->end(), EarlierPoint);
+      mPoints = move(points);
+   }
+   return mPoints;
+}
+
+SnapPointIndex::Points SnapPointIndex::GetPointsOnGrid() const
+{
+   const auto &formats = ProjectNumericFormats::Get(mProject);
+   const auto &snap = ProjectSnap::Get(mProject);
+   auto snapTo = snap.GetSnapTo();
+   auto rate = ProjectRate::Get(mProject).GetRate();
+   auto format = formats.GetSelectionFormat();
+
+   const auto points = GetPoints();
+   if (!mPointsOnGrid ||
+       snapTo != mSnapTo || rate != mRate || format != mFormat) {
+      mSnapTo = snapTo;
+      mRate = rate;
+      mFormat = format;
+      auto onGrid = std::make_shared<SnapPointArray>();
+      // Filtering preserves the order
+      std::copy_if(points->begin(), points->end(), back_inserter(*onGrid),
+         [&](const SnapPoint &point){
+            return snap.SnapTime(point.t).time == point.t; });
+      mPointsOnGrid = move(onGrid);
+   }
+   return mPointsOnGrid;
+}
+
+void SnapPointIndex::Invalidate()
+{
+   mPoints.reset();
+   mPointsOnGrid.reset();
+}
+
+void SnapPointIndex::OnTrackAdded(const Track &track)
+{
+   if (!mPoints)
+      return;
+   SnapPointArray added;
+   AddTrackPoints(added, track);
+   if (added.empty())
+      return;
+   std::sort(added.begin(), added.end(), EarlierPoint);
+   // Don't modify the array that callers may still hold
+   auto points = std::make_shared<SnapPointArray>();
+   points->reserve(mPoints->size() + added.size());
+   std::merge(mPoints->begin(), mPoints->end(), added.begin(), added.end(),
+      back_inserter(*points), EarlierPoint);
+   mPoints = move(points);
+   mPointsOnGrid.reset();
+}
+
+void SnapPointIndex::OnTrackDeleted(const Track &track)
+{
+   if (!mPoints)
+      return;
+   auto points = std::make_shared<SnapPointArray>();
+   points->reserve(mPoints->size());
+   std::copy_if(mPoints->begin(), mPoints->end(), back_inserter(*points),
+      [&](const SnapPoint &point){ return point.track != &track; });
+   mPoints = move(points);
+   mPointsOnGrid.reset();
+}
@@ -0,0 +1,67 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file SnapPointIndex.h
+  @brief Sorted edges of the intervals of all tracks of a project, kept for
+  the snap managers of successive drags
+
+**********************************************************************/
+#pragma once
+
+#include "ClientData.h"
+#include "Observer.h"
+#include "Snap.h"
+
+#include <memory>
+
+class AudacityProject;
+
+//! The points that SnapManager finds in the tracks of a project
+/*!
+ Gathering the edges of tens of thousands of intervals, and sorting them, is
+ done once after each change of the undo history, or incrementally when tracks
+ are added or removed, and not each time a drag starts.
+ */
+class SNAPPING_API SnapPointIndex final : public ClientData::Base
+{
+public:
+   static SnapPointIndex &Get(AudacityProject &project);
+   static const SnapPointIndex &Get(const AudacityProject &project);
+
+   explicit SnapPointIndex(AudacityProject &project);
+   SnapPointIndex(const SnapPointIndex&) = delete;
+   SnapPointIndex& operator=(const SnapPointIndex&) = delete;
+   ~SnapPointIndex() override;
+
+   using Points = std::shared_ptr<const SnapPointArray>;
+
+   //! Starts and ends of the intervals of all tracks, sorted by time
+   Points GetPoints() const;
+
+   //! The subset of GetPoints() that is unchanged by ProjectSnap::SnapTime()
+   Points GetPointsOnGrid() const;
+
+   //! Make the next GetPoints() gather all points again
+   void Invalidate();
+
+private:
+   void OnTrackAdded(const Track &track);
+   void OnTrackDeleted(const Track &track);
+
+   AudacityProject &mProject;
+
+   mutable Points mPoints;
+
+   //! Cached filtering of mPoints, for these settings
+   mutable Points mPointsOnGrid;
+   mutable Identifier mSnapTo{};
+   mutable double mRate{ 0.0 };
+   mutable NumericFormatID mFormat{};
+
+   Observer::Subscription mTrackListSubscription;
+   Observer::Subscription mUndoSubscription;
+   Observer::Subscription mSnapSubscription;
+   Observer::Subscription mTimeSignatureSubscription;
+};
@@ -8,15 +8,39 @@
 
 #include <algorithm>
 #include <cassert>
+#include <map>
 
 #include "sqlite3.h"
 
 #include "MemoryX.h"
 
 #include "SQLiteUtils.h"
+#include "StatementHandle.h"
 
 namespace audacity::sqlite
 {
+namespace
+{
+//! Distinct SQL texts kept; statements of further texts are not cached
+constexpr size_t MaxCachedQueries = 256;
+//! Statements of one SQL text kept for reuse
+constexpr size_t MaxPooledStatements = 4;
+} // namespace
+
+struct Connection::StatementCache final
+{
+   struct Entry final
+   {
+      std::shared_ptr<StatementCounters> Counters {
+         std::make_shared<StatementCounters>()
+      };
+      std::vector<StatementHandlePtr> Handles;
+   };
+
+   std::mutex Mutex;
+   std::map<std::string, Entry, std::less<>> Entries;
+};
+
 Result<Connection>
 Connection::Open(std::string_view path, OpenMode mode, ThreadMode threadMode)
 {
@@ -107,6 +131,7 @@ Connection::Reopen(sqlite3* connection, OpenMode mode, ThreadMode threadMode)
 
 Connection::Connection(sqlite3* connection, bool owned) noexcept
     : mConnection { connection }
+    , mStatementCache { std::make_unique<StatementCache>() }
     , mIsOwned { owned }
 {
 }
@@ -122,6 +147,7 @@ Connection& Connection::operator=(Connection&& rhs) noexcept
    std::swap(mIsOwned, rhs.mIsOwned);
    std::swap(mInDestructor, rhs.mInDestructor);
    std::swap(mPendingTransactions, rhs.mPendingTransactions);
+   std::swap(mStatementCache, rhs.mStatementCache);
 
    return *this;
 }
@@ -255,6 +281,36 @@ Result<Statement> Connection::CreateStatement(std::string_view sql) const
    if (mInDestructor || mConnection == nullptr)
       return Error(SQLITE_MISUSE);
 
+   std::shared_ptr<StatementCounters> counters;
+
+   if (mStatementCache != nullptr)
+   {
+      std::lock_guard lock { mStatementCache->Mutex };
+
+      auto& entries = mStatementCache->Entries;
+      auto it = entries.find(sql);
+
+      if (it == entries.end() && entries.size() < MaxCachedQueries)
+         it = entries.emplace(std::string(sql), StatementCache::Entry {}).first;
+
+      if (it != entries.end())
+      {
+         for (auto& handle : it->second.Handles)
+         {
+            // Only the cache holds it, and no one else can copy it while
+            // the cache is locked
+            if (handle.use_count() == 1)
+            {
+               sqlite3_reset(*handle);
+               sqlite3_clear_bindings(*handle);
+               return Result<Statement>(Statement(handle));
+            }
+         }
+
+         counters = it->second.Counters;
+      }
+   }
+
    sqlite3_stmt* statement = nullptr;
 
    auto error = Error(sqlite3_prepare_v2(
@@ -263,7 +319,45 @@ Result<Statement> Connection::CreateStatement(std::string_view sql) const
    if (error.IsError())
       return error;
 
-   return Result<Statement>(Statement(statement));
+   auto handle = std::make_shared<StatementHandle>(statement, counters);
+
+   if (counters != nullptr)
+   {
+      std::lock_guard lock { mStatementCache->Mutex };
+
+      auto& entries = mStatementCache->Entries;
+
+      if (auto it = entries.find(sql);
+          it != entries.end() && it->second.Handles.size() < MaxPooledStatements)
+         it->second.Handles.push_back(handle);
+   }
+
+   return Result<Statement>(Statement(std::move(handle)));
+}
+
+std::vector<StatementMetrics> Connection::GetStatementMetrics() const
+{
+   std::vector<StatementMetrics> result;
+
+   if (mStatementCache == nullptr)
+      return result;
+
+   std::lock_guard lock { mStatementCache->Mutex };
+
+   result.reserve(mStatementCache->Entries.size());
+
+   for (const auto& [sql, entry] : mStatementCache->Entries)
+   {
+      const auto& counters = *entry.Counters;
+
+      result.push_back(
+         { sql, counters.Executions.load(std::memory_order_relaxed),
+           counters.Rows.load(std::memory_order_relaxed),
+           std::chrono::nanoseconds {
+              counters.Nanoseconds.load(std::memory_order_relaxed) } });
+   }
+
+   return result;
 }
 
 Result<Blob> Connection::OpenBlob(
@@ -305,6 +399,13 @@ Error Connection::Close(bool force) noexcept
       if (auto err = transaction->Abort(); !force && err.IsError())
          return err;
 
+   // Cached statements must be finalized before the connection is closed
+   if (mStatementCache != nullptr)
+   {
+      std::lock_guard lock { mStatementCache->Mutex };
+      mStatementCache->Entries.clear();
+   }
+
    if (mConnection != nullptr && mIsOwned)
       if(auto err = Error(sqlite3_close(mConnection)); err.IsError())
          return err;
@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <memory>
 #include <mutex>
 #include <optional>
 #include <string>
@@ -91,8 +92,17 @@ public:
    Transaction BeginTransaction(std::string name);
 
    //! Prepares the given SQL statement for execution
+   /*!
+    * Compiled statements are cached by their SQL text and reused once the
+    * previous user has released them, with their bindings cleared. Several
+    * statements of one text may be in use at once, each from its own thread.
+    * The cache is safe to use from several threads, but other methods are not.
+    */
    Result<Statement> CreateStatement(std::string_view sql) const;
 
+   //! Returns the statistics of the cached statements, in order of SQL text
+   std::vector<StatementMetrics> GetStatementMetrics() const;
+
    //! Registers a scalar function with the given name
    template<typename ScalarFunctionType>
    ScalarFunction
@@ -138,10 +148,15 @@ private:
       Connection& connection, Transaction::TransactionOperation operation,
       Transaction& name);
 
+   struct StatementCache;
+
    sqlite3* mConnection {};
 
    std::vector<Transaction*> mPendingTransactions {};
 
+   //! Not null while the connection is open
+   std::unique_ptr<StatementCache> mStatementCache;
+
    bool mInDestructor {};
    bool mIsOwned {};
 };
@@ -7,41 +7,59 @@
 #include "Statement.h"
 
 #include <cassert>
+#include <chrono>
 #include <cstring>
 #include <utility>
 
 #include "Connection.h"
+#include "StatementHandle.h"
 
 #include "sqlite3.h"
 
 namespace audacity::sqlite
 {
-struct StatementHandle final
+StatementHandle::StatementHandle(
+   sqlite3_stmt* Handle, std::shared_ptr<StatementCounters> counters) noexcept
+    : Handle { Handle }
+    , Counters { std::move(counters) }
 {
-   sqlite3_stmt* Handle {};
+}
 
-   explicit StatementHandle(sqlite3_stmt* Handle) noexcept
-       : Handle { Handle }
-   {
-   }
+StatementHandle::~StatementHandle()
+{
+   if (Handle != nullptr)
+      sqlite3_finalize(Handle);
+}
 
-   operator sqlite3_stmt* () noexcept
-   {
-      return Handle;
-   }
+int StatementHandle::Step() noexcept
+{
+   if (Counters == nullptr)
+      return sqlite3_step(Handle);
 
-   ~StatementHandle()
-   {
-      if (Handle != nullptr)
-         sqlite3_finalize(Handle);
-   }
-};
+   const auto start = std::chrono::steady_clock::now();
+   const auto rc = sqlite3_step(Handle);
+   const auto elapsed = std::chrono::steady_clock::now() - start;
+
+   Counters->Nanoseconds.fetch_add(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(),
+      std::memory_order_relaxed);
+
+   if (rc == SQLITE_ROW)
+      Counters->Rows.fetch_add(1, std::memory_order_relaxed);
+
+   return rc;
+}
 
 Statement::Statement(sqlite3_stmt* stmt)
     : mStatement { std::make_shared<StatementHandle>(stmt) }
 {
 }
 
+Statement::Statement(StatementHandlePtr stmt) noexcept
+    : mStatement { std::move(stmt) }
+{
+}
+
 Statement::Statement(Statement&& rhs) noexcept
 {
    *this = std::move(rhs);
@@ -207,7 +225,10 @@ RunResult::RunResult(StatementHandlePtr stmt, std::vector<Error> errors) noexcep
    // mStatement can't be nullptr here, by construction
    assert(mStatement != nullptr);
 
-   const auto rc = sqlite3_step(*mStatement);
+   if (mStatement->Counters != nullptr)
+      mStatement->Counters->Executions.fetch_add(1, std::memory_order_relaxed);
+
+   const auto rc = mStatement->Step();
 
    mHasRows = rc == SQLITE_ROW;
 
@@ -301,7 +322,7 @@ RowIterator& RowIterator::operator++() noexcept
    if (mStatement == nullptr || mDone)
       return *this;
 
-   const auto rc = sqlite3_step(*mStatement);
+   const auto rc = mStatement->Step();
 
    if (rc == SQLITE_ROW)
       ++mRowIndex;
@@ -6,6 +6,8 @@
 
 #pragma once
 
+#include <chrono>
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <string>
@@ -24,6 +26,18 @@ using StatementHandlePtr = std::shared_ptr<StatementHandle>;
 
 class RowIterator;
 
+//! Execution statistics of the statements prepared from one SQL text
+struct SQLITE_HELPERS_API StatementMetrics final
+{
+   std::string Sql;
+   //! Number of times the statement was run
+   uint64_t Executions {};
+   //! Number of rows the runs returned
+   uint64_t Rows {};
+   //! Time spent in stepping the statement
+   std::chrono::nanoseconds TotalTime {};
+};
+
 //! A class representing a row in a result set
 /*!
  * Indices are 0-based
@@ -201,6 +215,7 @@ private:
 class SQLITE_HELPERS_API Statement final
 {
    explicit Statement(sqlite3_stmt* stmt);
+   explicit Statement(StatementHandlePtr stmt) noexcept;
 
 public:
 
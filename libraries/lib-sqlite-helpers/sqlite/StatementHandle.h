@@ -0,0 +1,47 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ * SPDX-FileName: StatementHandle.h
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+struct sqlite3_stmt;
+
+namespace audacity::sqlite
+{
+//! Execution counters shared by the pooled statements of one SQL text
+struct StatementCounters final
+{
+   std::atomic<uint64_t> Executions {};
+   std::atomic<uint64_t> Rows {};
+   std::atomic<int64_t> Nanoseconds {};
+};
+
+//! Owns a compiled statement, and finalizes it when the last user is done
+struct StatementHandle final
+{
+   sqlite3_stmt* Handle {};
+   //! Null for statements whose executions are not measured
+   std::shared_ptr<StatementCounters> Counters;
+
+   explicit StatementHandle(
+      sqlite3_stmt* Handle,
+      std::shared_ptr<StatementCounters> counters = {}) noexcept;
+   ~StatementHandle();
+
+   StatementHandle(const StatementHandle&) = delete;
+   StatementHandle& operator=(const StatementHandle&) = delete;
+
+   operator sqlite3_stmt*() noexcept
+   {
+      return Handle;
+   }
+
+   //! Steps the statement, timing the step and counting a returned row
+   int Step() noexcept;
+};
+} // namespace audacity::sqlite
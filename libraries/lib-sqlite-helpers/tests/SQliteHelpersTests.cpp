@@ -6,6 +6,8 @@
 
 #include <catch2/catch.hpp>
 
+#include <algorithm>
+
 #include "sqlite/Connection.h"
 
 TEST_CASE("SQLiteHelpers", "")
@@ -66,3 +68,52 @@ TEST_CASE("SQLiteHelpers", "")
       REQUIRE(rowId == 4);
    }
 }
+
+TEST_CASE("SQLiteHelpers statement cache", "")
+{
+   using namespace audacity::sqlite;
+
+   auto connection = Connection::Open(":memory:", OpenMode::Memory);
+   REQUIRE(connection);
+   REQUIRE(!!connection->Execute(
+      "CREATE TABLE test (id INTEGER PRIMARY KEY, name TEXT);"
+      "INSERT INTO test (name) VALUES ('test1'), ('test2');"));
+
+   const auto sql = "SELECT name FROM test WHERE id >= ?;";
+
+   {
+      auto stmt1 = connection->CreateStatement(sql);
+      auto stmt2 = connection->CreateStatement(sql);
+      REQUIRE(stmt1);
+      REQUIRE(stmt2);
+
+      // Statements in use at once are distinct
+      auto run1 = stmt1->Prepare(1).Run();
+      auto run2 = stmt2->Prepare(2).Run();
+
+      std::string name;
+      REQUIRE((*run1.begin()).Get(0, name));
+      REQUIRE(name == "test1");
+      REQUIRE((*run2.begin()).Get(0, name));
+      REQUIRE(name == "test2");
+   }
+
+   {
+      auto stmt = connection->CreateStatement(sql);
+      REQUIRE(stmt);
+
+      int rows = 0;
+      for (auto row : stmt->Prepare(1).Run())
+         ++rows;
+      REQUIRE(rows == 2);
+   }
+
+   const auto metrics = connection->GetStatementMetrics();
+   const auto it = std::find_if(
+      metrics.begin(), metrics.end(),
+      [&](const auto& metric) { return metric.Sql == sql; });
+
+   REQUIRE(it != metrics.end());
+   REQUIRE(it->Executions == 3);
+   REQUIRE(it->Rows == 4);
+}
@@ -20,10 +20,11 @@
 using ClipConstHolder = std::shared_ptr<const ClipInterface>;
 
 AudioSegmentFactory::AudioSegmentFactory(
-   int sampleRate, int numChannels, ClipConstHolders clips)
+   int sampleRate, int numChannels, ClipConstHolders clips, bool renderAhead)
     : mClips { std::move(clips) }
     , mSampleRate { sampleRate }
     , mNumChannels { numChannels }
+    , mRenderAhead { renderAhead }
 {
 }
 
@@ -60,7 +61,8 @@ AudioSegmentFactory::CreateAudioSegmentSequenceForward(double t0)
       else if (clip->GetPlayEndTime() <= t0)
          continue;
       segments.push_back(std::make_shared<ClipSegment>(
-         *clip, t0 - clip->GetPlayStartTime(), PlaybackDirection::forward));
+         *clip, t0 - clip->GetPlayStartTime(), PlaybackDirection::forward,
+         mRenderAhead));
       t0 = clip->GetPlayEndTime();
    }
    return segments;
@@ -91,7 +93,8 @@ AudioSegmentFactory::CreateAudioSegmentSequenceBackward(double t0)
       else if (clip->GetPlayStartTime() >= t0)
          continue;
       segments.push_back(std::make_shared<ClipSegment>(
-         *clip, clip->GetPlayEndTime() - t0, PlaybackDirection::backward));
+         *clip, clip->GetPlayEndTime() - t0, PlaybackDirection::backward,
+         mRenderAhead));
       t0 = clip->GetPlayStartTime();
    }
    return segments;
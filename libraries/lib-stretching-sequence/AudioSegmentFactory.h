@@ -24,7 +24,12 @@ class STRETCHING_SEQUENCE_API AudioSegmentFactory final :
     public AudioSegmentFactoryInterface
 {
 public:
-   AudioSegmentFactory(int sampleRate, int numChannels, ClipConstHolders clips);
+   /*!
+    * @param renderAhead passed to each ClipSegment
+    */
+   AudioSegmentFactory(
+      int sampleRate, int numChannels, ClipConstHolders clips,
+      bool renderAhead = false);
 
    std::vector<std::shared_ptr<AudioSegment>> CreateAudioSegmentSequence(
       double playbackStartTime, PlaybackDirection) override;
@@ -40,4 +45,5 @@ private:
    const ClipConstHolders mClips;
    const int mSampleRate;
    const int mNumChannels;
+   const bool mRenderAhead;
 };
@@ -14,6 +14,32 @@
 #include <cassert>
 #include <numeric>
 
+namespace
+{
+//! Call `function(src, count, offset)` for each contiguous part of the first
+//! `toVisit` samples of the block views, `offset` counting from the first
+//! @return number of samples visited
+template <typename Function>
+size_t VisitBlocks(
+   const std::vector<BlockSampleView>& blockViews, size_t start,
+   size_t toVisit, const Function& function)
+{
+   size_t visited = 0u;
+   size_t offset = start;
+   for (const auto& block : blockViews)
+   {
+      if (toVisit == 0u)
+         break;
+      const auto fromBlock = std::min(block->size() - offset, toVisit);
+      function(block->data() + offset, fromBlock, visited);
+      toVisit -= fromBlock;
+      visited += fromBlock;
+      offset = 0;
+   }
+   return visited;
+}
+} // namespace
+
 AudioSegmentSampleView::AudioSegmentSampleView(
    std::vector<BlockSampleView> blockViews, size_t start, size_t length)
     : mBlockViews { std::move(blockViews) }
@@ -54,23 +80,21 @@ size_t AudioSegmentSampleView::GetSampleCount() const
 
 void AudioSegmentSampleView::DoCopy(float* buffer, size_t bufferSize) const
 {
-   std::fill(buffer, buffer + bufferSize, 0.f);
-   DoAdd(buffer, bufferSize);
+   // One pass over the buffer, not zeroing before adding
+   const auto written = VisitBlocks(
+      mBlockViews, mStart, limitSampleBufferSize(bufferSize, mLength),
+      [buffer](const float* src, size_t count, size_t offset) {
+         std::copy(src, src + count, buffer + offset);
+      });
+   std::fill(buffer + written, buffer + bufferSize, 0.f);
 }
 
 void AudioSegmentSampleView::DoAdd(float* buffer, size_t bufferSize) const
 {
-   size_t toWrite { limitSampleBufferSize(bufferSize, mLength) };
-   size_t written = 0u;
-   size_t offset = mStart;
-   for (const auto& block : mBlockViews)
-   {
-      const auto toWriteFromBlock = std::min(block->size() - offset, toWrite);
-      const auto src = block->data() + offset;
-      const auto dst = buffer + written;
-      std::transform(src, src + toWriteFromBlock, dst, dst, std::plus {});
-      toWrite -= toWriteFromBlock;
-      written += toWriteFromBlock;
-      offset = 0;
-   }
+   VisitBlocks(
+      mBlockViews, mStart, limitSampleBufferSize(bufferSize, mLength),
+      [buffer](const float* src, size_t count, size_t offset) {
+         const auto dst = buffer + offset;
+         std::transform(src, src + count, dst, dst, std::plus {});
+      });
 }
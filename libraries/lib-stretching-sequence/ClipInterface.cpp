@@ -1,5 +1,12 @@
 #include "ClipInterface.h"
+#include "StretchedClipCache.h"
 
 ClipTimes::~ClipTimes() = default;
 
 ClipInterface::~ClipInterface() = default;
+
+std::shared_ptr<StretchedClipSlot>
+ClipInterface::GetStretchedClipSlot(const StretchedClipKey&) const
+{
+   return {};
+}
@@ -15,6 +15,9 @@
 #include "SampleCount.h"
 #include "SampleFormat.h"
 
+struct StretchedClipKey;
+class StretchedClipSlot;
+
 class STRETCHING_SEQUENCE_API ClipTimes
 {
 public:
@@ -63,6 +66,14 @@ public:
    [[nodiscard]] virtual Observer::Subscription
    SubscribeToPitchAndSpeedPresetChange(
       std::function<void(PitchAndSpeedPreset)> cb) const = 0;
+
+   /*!
+    * Where to find or keep the stretched rendering of the clip, as it is now,
+    * for the given settings
+    * @return null if the clip keeps no renderings, as the default does
+    */
+   virtual std::shared_ptr<StretchedClipSlot>
+   GetStretchedClipSlot(const StretchedClipKey&) const;
 };
 
 using ClipConstHolders = std::vector<std::shared_ptr<const ClipInterface>>;
@@ -10,8 +10,10 @@
 **********************************************************************/
 #include "ClipSegment.h"
 #include "ClipInterface.h"
+#include "RenderAheadTimeAndPitch.h"
 #include "SampleFormat.h"
 #include "StaffPadTimeAndPitch.h"
+#include "StretchedClipCache.h"
 #include <cassert>
 #include <cmath>
 #include <functional>
@@ -36,20 +38,43 @@ GetTotalNumSamplesToProduce(const ClipInterface& clip, double durationToDiscard)
                            clip.GetStretchRatio() -
                         durationToDiscard * clip.GetRate() + .5 };
 }
+
+//! A clip neither stretched nor shifted costs no more than a copy
+bool IsStretched(const ClipInterface& clip)
+{
+   return !TimeAndPitchInterface::IsPassThroughMode(clip.GetStretchRatio()) ||
+          clip.GetCentShift() != 0;
+}
+
+//! Longer clips are stretched every time, rather than held in memory for
+//! the whole pass
+constexpr sampleCount::type MaxSamplesToRecord = 1 << 23;
+
+std::unique_ptr<TimeAndPitchInterface> MakeStretcher(
+   const ClipInterface& clip, TimeAndPitchSource& source,
+   sampleCount totalNumSamplesToProduce, bool renderAhead)
+{
+   auto stretcher = std::make_unique<StaffPadTimeAndPitch>(
+      clip.GetRate(), clip.NChannels(), source,
+      GetStretchingParameters(clip));
+   if (!renderAhead || !IsStretched(clip))
+      return stretcher;
+   return std::make_unique<RenderAheadTimeAndPitch>(
+      std::move(stretcher), clip.NChannels(), totalNumSamplesToProduce);
+}
 } // namespace
 
 ClipSegment::ClipSegment(
    const ClipInterface& clip, double durationToDiscard,
-   PlaybackDirection direction)
-    : mTotalNumSamplesToProduce { GetTotalNumSamplesToProduce(
+   PlaybackDirection direction, bool renderAhead)
+    : mClip { clip }
+    , mPlaybackDirection { direction }
+    , mRenderAhead { renderAhead }
+    , mTotalNumSamplesToProduce { GetTotalNumSamplesToProduce(
          clip, durationToDiscard) }
-    , mSource { clip, durationToDiscard, direction }
     , mPreserveFormants { clip.GetPitchAndSpeedPreset() ==
                           PitchAndSpeedPreset::OptimizeForVoice }
     , mCentShift { clip.GetCentShift() }
-    , mStretcher { std::make_unique<StaffPadTimeAndPitch>(
-         clip.GetRate(), clip.NChannels(), mSource,
-         GetStretchingParameters(clip)) }
     , mOnSemitoneShiftChangeSubscription { clip.SubscribeToCentShiftChange(
          [this](int cents) {
             mCentShift = cents;
@@ -64,6 +89,36 @@ ClipSegment::ClipSegment(
           })
     }
 {
+   if (IsStretched(clip))
+      mSlot = clip.GetStretchedClipSlot({ clip.GetStretchRatio(), mCentShift,
+                                          mPreserveFormants, direction });
+   const auto wholeClip = GetTotalNumSamplesToProduce(clip, 0);
+   if (mSlot)
+   {
+      const auto rendering = mSlot->Find();
+      if (rendering && rendering->GetSampleCount() == wholeClip)
+      {
+         mRendering = rendering;
+         mRenderingOffset = wholeClip - mTotalNumSamplesToProduce;
+         return;
+      }
+      if (durationToDiscard == 0 && wholeClip <= MaxSamplesToRecord)
+      {
+         mRecording.emplace(NChannels());
+         for (auto& channel : *mRecording)
+            channel.reserve(wholeClip.as_size_t());
+      }
+   }
+   StartStretching(durationToDiscard);
+}
+
+void ClipSegment::StartStretching(double durationToDiscard)
+{
+   mStretcher.reset();
+   mSource.emplace(mClip, durationToDiscard, mPlaybackDirection);
+   mStretcher = MakeStretcher(
+      mClip, *mSource, mTotalNumSamplesToProduce - mTotalNumSamplesProduced,
+      mRenderAhead);
 }
 
 ClipSegment::~ClipSegment()
@@ -81,14 +136,51 @@ size_t ClipSegment::GetFloats(float* const* buffers, size_t numSamples)
    // cannot trust that the observer subscriptions do not get called after
    // destruction of this object, so better not do anything too sophisticated
    // there.
-   if (mUpdateFormantPreservation.exchange(false))
-      mStretcher->OnFormantPreservationChange(mPreserveFormants);
-   if (mUpdateCentShift.exchange(false))
-      mStretcher->OnCentShiftChange(mCentShift);
+   if (mUpdateFormantPreservation || mUpdateCentShift)
+   {
+      // What is produced now is not the rendering for the initial settings
+      mRecording.reset();
+      if (mRendering)
+      {
+         // Stretch with the new settings from here on
+         mRendering.reset();
+         mUpdateFormantPreservation = mUpdateCentShift = false;
+         StartStretching(
+            (mRenderingOffset + mTotalNumSamplesProduced).as_double() /
+            mClip.GetRate());
+      }
+   }
+   if (!mRendering)
+   {
+      if (mUpdateFormantPreservation.exchange(false))
+         mStretcher->OnFormantPreservationChange(mPreserveFormants);
+      if (mUpdateCentShift.exchange(false))
+         mStretcher->OnCentShiftChange(mCentShift);
+   }
    const auto numSamplesToProduce = limitSampleBufferSize(
       numSamples, mTotalNumSamplesToProduce - mTotalNumSamplesProduced);
-   mStretcher->GetSamples(buffers, numSamplesToProduce);
+   if (mRendering)
+      for (auto i = 0u; i < NChannels(); ++i)
+         mRendering
+            ->GetSampleView(
+               i, mRenderingOffset + mTotalNumSamplesProduced,
+               numSamplesToProduce)
+            .Copy(buffers[i], numSamplesToProduce);
+   else
+   {
+      mStretcher->GetSamples(buffers, numSamplesToProduce);
+      if (mRecording)
+         for (auto i = 0u; i < NChannels(); ++i)
+            (*mRecording)[i].insert(
+               (*mRecording)[i].end(), buffers[i],
+               buffers[i] + numSamplesToProduce);
+   }
    mTotalNumSamplesProduced += numSamplesToProduce;
+   if (mRecording && Empty())
+   {
+      mSlot->Store(std::move(*mRecording));
+      mRecording.reset();
+   }
    return numSamplesToProduce;
 }
 
@@ -99,5 +191,5 @@ bool ClipSegment::Empty() const
 
 size_t ClipSegment::NChannels() const
 {
-   return mSource.NChannels();
+   return mClip.NChannels();
 }
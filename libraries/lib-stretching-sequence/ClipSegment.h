@@ -16,8 +16,12 @@
 #include "PlaybackDirection.h"
 #include <atomic>
 #include <memory>
+#include <optional>
+#include <vector>
 
 class ClipInterface;
+class StretchedClipRendering;
+class StretchedClipSlot;
 class TimeAndPitchInterface;
 
 using PitchRatioChangeCbSubscriber =
@@ -26,12 +30,20 @@ using PitchRatioChangeCbSubscriber =
 /*!
  * It is important that objects of this class are instantiated and destroyed on
  * the same thread, due to the owned Observer::Subscription.
+ *
+ * A stretched or pitch-shifted clip is read from a rendering the clip kept,
+ * if there is one for the current settings. Otherwise a pass over the whole
+ * clip offers its output to be kept for the next pass.
  */
 class STRETCHING_SEQUENCE_API ClipSegment final : public AudioSegment
 {
 public:
+   /*!
+    * @param renderAhead if true, stretching runs on worker threads ahead of
+    * the reads; see RenderAheadTimeAndPitch
+    */
    ClipSegment(const ClipInterface&,
-      double durationToDiscard, PlaybackDirection);
+      double durationToDiscard, PlaybackDirection, bool renderAhead = false);
    ~ClipSegment() override;
 
    // AudioSegment
@@ -40,16 +52,28 @@ public:
    size_t NChannels() const override;
 
 private:
+   //! Make the source and the stretcher, for output from the given offset
+   void StartStretching(double durationToDiscard);
+
+   const ClipInterface& mClip;
+   const PlaybackDirection mPlaybackDirection;
+   const bool mRenderAhead;
    const sampleCount mTotalNumSamplesToProduce;
    sampleCount mTotalNumSamplesProduced = 0;
-   ClipTimeAndPitchSource mSource;
+   //! Where a rendering of the whole clip is found or kept; may be null
+   std::shared_ptr<StretchedClipSlot> mSlot;
+   //! If not null, samples are read from it rather than stretched
+   std::shared_ptr<const StretchedClipRendering> mRendering;
+   //! Position in `mRendering` of the first sample to produce
+   sampleCount mRenderingOffset = 0;
+   //! The output so far, to be offered to `mSlot` at the end of the clip
+   std::optional<std::vector<std::vector<float>>> mRecording;
+   std::optional<ClipTimeAndPitchSource> mSource;
    bool mPreserveFormants;
    int mCentShift;
    std::atomic<bool> mUpdateFormantPreservation = false;
    std::atomic<bool> mUpdateCentShift = false;
-   // Careful that this guy is constructed after `mSource`, which it refers to
-   // in its ctor.
-   // todo(mhodgkinson) make this safe.
+   // Careful that this guy is destroyed before `mSource`, which it refers to.
    std::unique_ptr<TimeAndPitchInterface> mStretcher;
    Observer::Subscription mOnSemitoneShiftChangeSubscription;
    Observer::Subscription mOnFormantPreservationChangeSubscription;
@@ -0,0 +1,167 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  RenderAheadTimeAndPitch.cpp
+
+**********************************************************************/
+#include "RenderAheadTimeAndPitch.h"
+#include "concurrency/ThreadPool.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace
+{
+//! Frames rendered at once by the worker, so that the reader may start
+//! consuming before the ring is full
+constexpr size_t WorkerBlockSize = 4096;
+} // namespace
+
+RenderAheadTimeAndPitch::RenderAheadTimeAndPitch(
+   std::unique_ptr<TimeAndPitchInterface> stretcher, size_t numChannels,
+   sampleCount totalNumSamples, size_t capacity)
+    : mStretcher { std::move(stretcher) }
+    , mNumChannels { numChannels }
+    , mCapacity { std::max<size_t>(capacity, WorkerBlockSize) }
+    , mTotalNumSamples { totalNumSamples }
+    , mRing(numChannels, std::vector<float>(mCapacity))
+    , mScratch(numChannels, std::vector<float>(WorkerBlockSize))
+{
+   assert(mStretcher);
+   // Get ahead of the first read
+   Launch();
+}
+
+RenderAheadTimeAndPitch::~RenderAheadTimeAndPitch()
+{
+   mStop.store(true, std::memory_order_relaxed);
+   if (mPending.valid())
+      mPending.wait();
+}
+
+size_t RenderAheadTimeAndPitch::AvailForGet() const
+{
+   const auto written = mWritten.load(std::memory_order_acquire);
+   const auto read = mRead.load(std::memory_order_relaxed);
+   return written - read;
+}
+
+void RenderAheadTimeAndPitch::Launch()
+{
+   using namespace std::chrono;
+   auto& pool = audacity::concurrency::ThreadPool::GetDefault();
+   if (pool.IsWorkerThread())
+   {
+      // Waiting for another task of the pool could deadlock
+      Fill();
+      return;
+   }
+   if (mPending.valid() &&
+       mPending.wait_for(seconds::zero()) != std::future_status::ready)
+      return;
+   if (mPending.valid())
+      // Rethrow what went wrong in the last task
+      mPending.get();
+   mPending = pool.Async([this] { Fill(); });
+}
+
+void RenderAheadTimeAndPitch::Wait()
+{
+   if (mPending.valid())
+      mPending.get();
+}
+
+void RenderAheadTimeAndPitch::GetSamples(
+   float* const* output, size_t outputLen)
+{
+   size_t done = 0;
+   while (done < outputLen)
+   {
+      auto avail = AvailForGet();
+      if (avail == 0)
+      {
+         // The worker has fallen behind, or was not busy
+         Launch();
+         Wait();
+         avail = AvailForGet();
+         if (avail == 0)
+            // Past the end
+            break;
+      }
+      const auto toCopy = std::min(avail, outputLen - done);
+      const auto read = mRead.load(std::memory_order_relaxed);
+      const auto pos = static_cast<size_t>(read % mCapacity);
+      const auto size0 = std::min(toCopy, mCapacity - pos);
+      for (size_t i = 0; i < mNumChannels; ++i)
+      {
+         const auto& ring = mRing[i];
+         const auto dst = output[i] + done;
+         std::copy(ring.begin() + pos, ring.begin() + pos + size0, dst);
+         std::copy(ring.begin(), ring.begin() + (toCopy - size0), dst + size0);
+      }
+      // Release, so that the reads above happen-before reuse of the space
+      mRead.store(read + toCopy, std::memory_order_release);
+      done += toCopy;
+   }
+   for (size_t i = 0; i < mNumChannels; ++i)
+      std::fill(output[i] + done, output[i] + outputLen, 0.f);
+
+   // Keep the worker busy once half the ring is free
+   if (AvailForGet() <= mCapacity / 2)
+      Launch();
+}
+
+void RenderAheadTimeAndPitch::OnCentShiftChange(int cents)
+{
+   mCentShift.store(cents, std::memory_order_relaxed);
+   mUpdateCentShift.store(true, std::memory_order_release);
+   Launch();
+}
+
+void RenderAheadTimeAndPitch::OnFormantPreservationChange(bool preserve)
+{
+   mPreserveFormants.store(preserve, std::memory_order_relaxed);
+   mUpdateFormantPreservation.store(true, std::memory_order_release);
+   Launch();
+}
+
+void RenderAheadTimeAndPitch::Fill()
+{
+   std::vector<float*> pointers(mNumChannels);
+   for (size_t i = 0; i < mNumChannels; ++i)
+      pointers[i] = mScratch[i].data();
+   while (!mStop.load(std::memory_order_relaxed))
+   {
+      if (mUpdateFormantPreservation.exchange(false, std::memory_order_acquire))
+         mStretcher->OnFormantPreservationChange(
+            mPreserveFormants.load(std::memory_order_relaxed));
+      if (mUpdateCentShift.exchange(false, std::memory_order_acquire))
+         mStretcher->OnCentShiftChange(
+            mCentShift.load(std::memory_order_relaxed));
+
+      const auto written = mWritten.load(std::memory_order_relaxed);
+      const auto read = mRead.load(std::memory_order_acquire);
+      const auto free = mCapacity - static_cast<size_t>(written - read);
+      const auto remaining = mTotalNumSamples - written;
+      const auto len = limitSampleBufferSize(
+         std::min(free, WorkerBlockSize), remaining);
+      if (len == 0)
+         break;
+
+      mStretcher->GetSamples(pointers.data(), len);
+
+      const auto pos = static_cast<size_t>(written % mCapacity);
+      const auto size0 = std::min(len, mCapacity - pos);
+      for (size_t i = 0; i < mNumChannels; ++i)
+      {
+         const auto src = mScratch[i].data();
+         auto& ring = mRing[i];
+         std::copy(src, src + size0, ring.begin() + pos);
+         std::copy(src + size0, src + len, ring.begin());
+      }
+      // Release, so that the reader sees the samples with the new position
+      mWritten.store(written + len, std::memory_order_release);
+   }
+}
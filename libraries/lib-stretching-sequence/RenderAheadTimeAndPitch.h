@@ -0,0 +1,82 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  RenderAheadTimeAndPitch.h
+
+**********************************************************************/
+#pragma once
+
+#include "MemoryX.h"
+#include "SampleCount.h"
+#include "TimeAndPitchInterface.h"
+
+#include <atomic>
+#include <future>
+#include <memory>
+#include <vector>
+
+/*!
+ * Runs another stretcher on the threads of the default thread pool, ahead of
+ * the reader, into a lock-free single-reader, single-writer ring buffer.
+ *
+ * The reader only waits when the worker has fallen behind. Cent shift and
+ * formant preservation changes are applied by the worker, and so are heard
+ * only after the samples already rendered.
+ *
+ * `GetSamples` and the change notifications must be called from one thread,
+ * the same that destroys the object.
+ */
+class STRETCHING_SEQUENCE_API RenderAheadTimeAndPitch final :
+    public TimeAndPitchInterface,
+    public NonInterferingBase
+{
+public:
+   //! Frames per channel rendered ahead by default
+   static constexpr size_t DefaultCapacity = 1 << 16;
+
+   /*!
+    * @param totalNumSamples the worker renders no more than this many frames
+    */
+   RenderAheadTimeAndPitch(
+      std::unique_ptr<TimeAndPitchInterface> stretcher, size_t numChannels,
+      sampleCount totalNumSamples, size_t capacity = DefaultCapacity);
+   ~RenderAheadTimeAndPitch() override;
+
+   // TimeAndPitchInterface
+   void GetSamples(float* const*, size_t) override;
+   void OnCentShiftChange(int cents) override;
+   void OnFormantPreservationChange(bool preserve) override;
+
+private:
+   size_t AvailForGet() const;
+   //! Post a rendering task if none is pending
+   void Launch();
+   //! Wait for the pending task, if any, and rethrow its exception
+   void Wait();
+   //! In a worker thread, render until the ring is full or the end is reached
+   void Fill();
+
+   const std::unique_ptr<TimeAndPitchInterface> mStretcher;
+   const size_t mNumChannels;
+   const size_t mCapacity;
+   const sampleCount mTotalNumSamples;
+
+   //! Channels of `mCapacity` frames each
+   std::vector<std::vector<float>> mRing;
+   //! Total frames written and read; the difference is what is filled
+   NonInterfering<std::atomic<sampleCount::type>> mWritten { 0 }, mRead { 0 };
+
+   //! Used only by the worker
+   std::vector<std::vector<float>> mScratch;
+
+   std::atomic<int> mCentShift { 0 };
+   std::atomic<bool> mPreserveFormants { false };
+   std::atomic<bool> mUpdateCentShift { false };
+   std::atomic<bool> mUpdateFormantPreservation { false };
+   std::atomic<bool> mStop { false };
+
+   //! Touched only by the reader
+   std::future<void> mPending;
+};
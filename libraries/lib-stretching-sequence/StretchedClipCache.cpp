@@ -0,0 +1,21 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  StretchedClipCache.cpp
+
+**********************************************************************/
+#include "StretchedClipCache.h"
+
+bool StretchedClipKey::operator==(const StretchedClipKey& other) const
+{
+   return stretchRatio == other.stretchRatio &&
+          centShift == other.centShift &&
+          preserveFormants == other.preserveFormants &&
+          direction == other.direction;
+}
+
+StretchedClipRendering::~StretchedClipRendering() = default;
+
+StretchedClipSlot::~StretchedClipSlot() = default;
@@ -0,0 +1,65 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  StretchedClipCache.h
+
+**********************************************************************/
+#pragma once
+
+#include "AudioSegmentSampleView.h"
+#include "PlaybackDirection.h"
+#include "SampleCount.h"
+
+#include <memory>
+#include <vector>
+
+//! The settings that determine the stretched rendering of a whole clip
+struct STRETCHING_SEQUENCE_API StretchedClipKey
+{
+   double stretchRatio = 1.0;
+   int centShift = 0;
+   bool preserveFormants = false;
+   PlaybackDirection direction = PlaybackDirection::forward;
+
+   bool operator==(const StretchedClipKey& other) const;
+   bool operator!=(const StretchedClipKey& other) const
+   {
+      return !(*this == other);
+   }
+};
+
+//! A complete stretched rendering of all visible samples of a clip
+class STRETCHING_SEQUENCE_API StretchedClipRendering
+{
+public:
+   virtual ~StretchedClipRendering();
+
+   //! Per channel
+   virtual sampleCount GetSampleCount() const = 0;
+
+   virtual AudioSegmentSampleView
+   GetSampleView(size_t iChannel, sampleCount start, size_t length) const = 0;
+};
+
+/*!
+ * Where the rendering of a clip for one key is to be found or kept, as the
+ * clip was when the slot was given out
+ */
+class STRETCHING_SEQUENCE_API StretchedClipSlot
+{
+public:
+   virtual ~StretchedClipSlot();
+
+   //! The rendering made earlier, or null
+   virtual std::shared_ptr<const StretchedClipRendering> Find() const = 0;
+
+   //! Offer the rendering, for the clip as it was when the slot was given
+   /*!
+    * May be called from any thread. It is ignored if the clip has changed
+    * since.
+    * @pre each channel holds the complete rendering
+    */
+   virtual void Store(std::vector<std::vector<float>> channels) = 0;
+};
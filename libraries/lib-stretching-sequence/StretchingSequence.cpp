@@ -149,6 +149,22 @@ void StretchingSequence::GetEnvelopeValues(
    mSequence.GetEnvelopeValues(buffer, bufferLen, t0, backwards);
 }
 
+void StretchingSequence::Prefetch(double t0, double t1) const noexcept
+{
+   mSequence.Prefetch(t0, t1);
+}
+
+bool StretchingSequence::IsResident(double t0, double t1) const noexcept
+{
+   return mSequence.IsResident(t0, t1);
+}
+
+std::shared_ptr<const void>
+StretchingSequence::PinResident(double t0, double t1) const
+{
+   return mSequence.PinResident(t0, t1);
+}
+
 AudioGraph::ChannelType StretchingSequence::GetChannelType() const
 {
    return mSequence.GetChannelType();
@@ -187,11 +203,12 @@ bool StretchingSequence::MutableGet(
 }
 
 std::shared_ptr<StretchingSequence> StretchingSequence::Create(
-   const PlayableSequence& sequence, const ClipConstHolders& clips)
+   const PlayableSequence& sequence, const ClipConstHolders& clips,
+   bool renderAhead)
 {
    const int sampleRate = sequence.GetRate();
    return std::make_shared<StretchingSequence>(
       sequence, sampleRate, sequence.NChannels(),
       std::make_unique<AudioSegmentFactory>(
-         sampleRate, sequence.NChannels(), clips));
+         sampleRate, sequence.NChannels(), clips, renderAhead));
 }
@@ -27,8 +27,13 @@ using ClipConstHolders = std::vector<std::shared_ptr<const ClipInterface>>;
 class STRETCHING_SEQUENCE_API StretchingSequence final : public PlayableSequence
 {
 public:
-   static std::shared_ptr<StretchingSequence>
-   Create(const PlayableSequence&, const ClipConstHolders& clips);
+   /*!
+    * @param renderAhead whether clips are stretched on worker threads ahead
+    * of the reads, as suits playback of many stretched clips at once
+    */
+   static std::shared_ptr<StretchingSequence> Create(
+      const PlayableSequence&, const ClipConstHolders& clips,
+      bool renderAhead = false);
 
    StretchingSequence(
       const PlayableSequence&, int sampleRate, size_t numChannels,
@@ -45,6 +50,10 @@ public:
    void GetEnvelopeValues(
       double* buffer, size_t bufferLen, double t0,
       bool backwards) const override;
+   void Prefetch(double t0, double t1) const noexcept override;
+   bool IsResident(double t0, double t1) const noexcept override;
+   std::shared_ptr<const void>
+   PinResident(double t0, double t1) const override;
    bool DoGet(
       size_t iChannel, size_t nBuffers, const samplePtr buffers[],
       sampleFormat format, sampleCount start, size_t len, bool backwards,
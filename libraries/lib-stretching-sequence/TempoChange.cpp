@@ -41,6 +41,10 @@ const ProjectTempo &ProjectTempo::Get(const ChannelGroup &group)
 void DoProjectTempoChange(ChannelGroup &group, double newTempo)
 {
    auto &oldTempo = ProjectTempo::Get(group).mProjectTempo;
+   // Changes of the time signature only, and additions of tracks already at
+   // this tempo, would rescale all times by 1
+   if (oldTempo == newTempo)
+      return;
    OnProjectTempoChange::Call(group, oldTempo, newTempo);
    oldTempo = newTempo;
 }
@@ -56,3 +56,32 @@ TEST_CASE("AudioSegmentSampleView", "Copy returns expected values when")
       }
    }
 }
+
+TEST_CASE("AudioSegmentSampleView AddTo", "AddTo adds expected values when")
+{
+   const auto segment1 = std::make_shared<std::vector<float>>(
+      std::vector<float> { 1.f, 2.f, 3.f });
+   const auto segment2 = std::make_shared<std::vector<float>>(
+      std::vector<float> { 4.f, 5.f, 6.f });
+   const auto segment3 = std::make_shared<std::vector<float>>(
+      std::vector<float> { 7.f, 8.f, 9.f });
+   constexpr auto start = 1u;
+   constexpr auto length = 6u;
+   AudioSegmentSampleView sut { { segment1, segment2, segment3 }, start,
+                                length };
+
+   SECTION("asked MORE values than it holds.")
+   {
+      std::vector<float> out(8u, 10.f);
+      sut.AddTo(out.data(), out.size());
+      REQUIRE(
+         out ==
+         std::vector<float> { 12.f, 13.f, 14.f, 15.f, 16.f, 17.f, 10.f, 10.f });
+   }
+   SECTION("asked FEWER values than it holds.")
+   {
+      std::vector<float> out(4u, 10.f);
+      sut.AddTo(out.data(), out.size());
+      REQUIRE(out == std::vector<float> { 12.f, 13.f, 14.f, 15.f });
+   }
+}
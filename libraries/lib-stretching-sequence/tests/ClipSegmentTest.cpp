@@ -11,7 +11,9 @@
 #include "ClipSegment.h"
 #include "AudioContainer.h"
 #include "FloatVectorClip.h"
+#include "StretchedClipCache.h"
 
+#include <cmath>
 
 #include <catch2/catch.hpp>
 
@@ -19,6 +21,67 @@ namespace
 {
 constexpr auto sampleRate = 3;
 using FloatVectorVector = std::vector<std::vector<float>>;
+
+class MemoryRendering final : public StretchedClipRendering
+{
+public:
+   explicit MemoryRendering(FloatVectorVector channels)
+       : mChannels { std::move(channels) }
+   {
+   }
+
+   sampleCount GetSampleCount() const override
+   {
+      return mChannels[0].size();
+   }
+
+   AudioSegmentSampleView GetSampleView(
+      size_t iChannel, sampleCount start, size_t length) const override
+   {
+      const auto& channel = mChannels[iChannel];
+      const auto begin = channel.begin() + start.as_size_t();
+      return AudioSegmentSampleView {
+         { std::make_shared<std::vector<float>>(begin, begin + length) },
+         0u,
+         length
+      };
+   }
+
+private:
+   const FloatVectorVector mChannels;
+};
+
+//! Keeps one rendering, whatever the key
+class CachingClip final : public FloatVectorClip
+{
+public:
+   using FloatVectorClip::FloatVectorClip;
+
+   std::shared_ptr<StretchedClipSlot>
+   GetStretchedClipSlot(const StretchedClipKey&) const override
+   {
+      struct Slot final : StretchedClipSlot
+      {
+         explicit Slot(const CachingClip& clip)
+             : clip { clip }
+         {
+         }
+         std::shared_ptr<const StretchedClipRendering> Find() const override
+         {
+            return clip.rendering;
+         }
+         void Store(FloatVectorVector channels) override
+         {
+            clip.rendering =
+               std::make_shared<MemoryRendering>(std::move(channels));
+         }
+         const CachingClip& clip;
+      };
+      return std::make_shared<Slot>(*this);
+   }
+
+   mutable std::shared_ptr<const StretchedClipRendering> rendering;
+};
 } // namespace
 
 TEST_CASE("ClipSegment")
@@ -76,3 +139,79 @@ TEST_CASE("ClipSegment")
       REQUIRE(output.channelVectors[0] == expected);
    }
 }
+
+TEST_CASE("ClipSegment renders ahead as it renders in place")
+{
+   constexpr auto rate = 44100;
+   std::vector<float> audio(rate / 2);
+   for (auto i = 0u; i < audio.size(); ++i)
+      audio[i] = std::sin(i * 0.05f);
+   const auto numChannels = GENERATE(1u, 2u);
+   const auto clip =
+      std::make_shared<FloatVectorClip>(rate, audio, numChannels);
+   clip->stretchRatio = 1.5;
+
+   const auto render = [&](bool renderAhead) {
+      ClipSegment sut { *clip, 0., PlaybackDirection::forward, renderAhead };
+      std::vector<std::vector<float>> result(numChannels);
+      // Odd block sizes, to exercise the wrapping of the ring buffer
+      constexpr auto blockSize = 3001u;
+      AudioContainer output(blockSize, numChannels);
+      while (!sut.Empty())
+      {
+         const auto produced =
+            sut.GetFloats(output.channelPointers.data(), blockSize);
+         for (auto i = 0u; i < numChannels; ++i)
+            result[i].insert(
+               result[i].end(), output.channelVectors[i].begin(),
+               output.channelVectors[i].begin() + produced);
+      }
+      return result;
+   };
+
+   const auto inPlace = render(false);
+   const auto ahead = render(true);
+   REQUIRE(inPlace.size() == ahead.size());
+   REQUIRE(inPlace[0].size() == ahead[0].size());
+   REQUIRE(inPlace == ahead);
+}
+
+TEST_CASE("ClipSegment plays again from the kept rendering")
+{
+   constexpr auto rate = 44100;
+   std::vector<float> audio(rate / 4);
+   for (auto i = 0u; i < audio.size(); ++i)
+      audio[i] = std::sin(i * 0.05f);
+   const auto clip = std::make_shared<CachingClip>(rate, audio, 1u);
+   clip->stretchRatio = 1.5;
+
+   const auto play = [&](double durationToDiscard) {
+      ClipSegment sut { *clip, durationToDiscard, PlaybackDirection::forward };
+      std::vector<float> result;
+      AudioContainer output(1000, 1u);
+      while (!sut.Empty())
+      {
+         const auto produced = sut.GetFloats(output.channelPointers.data(), 1000);
+         result.insert(
+            result.end(), output.channelVectors[0].begin(),
+            output.channelVectors[0].begin() + produced);
+      }
+      return result;
+   };
+
+   // A partial pass keeps nothing
+   play(0.1);
+   REQUIRE(clip->rendering == nullptr);
+
+   const auto first = play(0.);
+   REQUIRE(clip->rendering != nullptr);
+   REQUIRE(clip->rendering->GetSampleCount() == first.size());
+   REQUIRE(play(0.) == first);
+
+   // Playing from an offset reads the rendering from there
+   const auto fromOffset = play(0.1);
+   REQUIRE(fromOffset.size() < first.size());
+   const auto offset = first.size() - fromOffset.size();
+   REQUIRE(std::equal(
+      fromOffset.begin(), fromOffset.end(), first.begin() + offset));
+}
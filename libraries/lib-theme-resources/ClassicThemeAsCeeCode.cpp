@@ -8,10 +8,9 @@
  
  **********************************************************************/
 
-#include <vector>
 #include "Theme.h"
 
-static const std::vector<unsigned char> ImageCacheAsData {
+static const unsigned char ImageCacheAsData[] = {
 // Include the generated file full of numbers
 #include "ClassicThemeAsCeeCode.h"
 };
@@ -19,5 +18,6 @@ static const std::vector<unsigned char> ImageCacheAsData {
 static ThemeBase::RegisteredTheme theme{
    /* i18n-hint: describing the "classic" or traditional
       appearance of older versions of Audacity */
-   { "classic", XO("Classic") }, PreferredSystemAppearance::Light, ImageCacheAsData
+   { "classic", XO("Classic") }, PreferredSystemAppearance::Light,
+   ImageCacheAsData, sizeof ImageCacheAsData
 };
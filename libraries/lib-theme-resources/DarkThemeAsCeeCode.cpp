@@ -8,14 +8,14 @@
  
  **********************************************************************/
 
-#include <vector>
 #include "Theme.h"
 
-static const std::vector<unsigned char> ImageCacheAsData {
+static const unsigned char ImageCacheAsData[] = {
 // Include the generated file full of numbers
 #include "DarkThemeAsCeeCode.h"
 };
 
 static ThemeBase::RegisteredTheme theme{
-   { "dark", XO("Dark") }, PreferredSystemAppearance::Dark, ImageCacheAsData
+   { "dark", XO("Dark") }, PreferredSystemAppearance::Dark,
+   ImageCacheAsData, sizeof ImageCacheAsData
 };
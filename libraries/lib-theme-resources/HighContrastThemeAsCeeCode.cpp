@@ -8,10 +8,9 @@
  
  **********************************************************************/
 
-#include <vector>
 #include "Theme.h"
 
-static const std::vector<unsigned char> ImageCacheAsData {
+static const unsigned char ImageCacheAsData[] = {
 // Include the generated file full of numbers
 #include "HighContrastThemeAsCeeCode.h"
 };
@@ -21,5 +20,5 @@ static ThemeBase::RegisteredTheme theme{
       background colors */
    { "high-contrast", XO("High Contrast") },
    PreferredSystemAppearance::HighContrastDark,
-   ImageCacheAsData
+   ImageCacheAsData, sizeof ImageCacheAsData
 };
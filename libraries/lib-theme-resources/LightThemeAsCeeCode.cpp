@@ -8,15 +8,15 @@
  
  **********************************************************************/
 
-#include <vector>
 #include "Theme.h"
 
-static const std::vector<unsigned char> ImageCacheAsData {
+static const unsigned char ImageCacheAsData[] = {
 // Include the generated file full of numbers
 #include "LightThemeAsCeeCode.h"
 };
 
 static ThemeBase::RegisteredTheme theme{
    /* i18n-hint: Light meaning opposite of dark */
-   { "light", XO("Light") }, PreferredSystemAppearance::Light, ImageCacheAsData
+   { "light", XO("Light") }, PreferredSystemAppearance::Light,
+   ImageCacheAsData, sizeof ImageCacheAsData
 };
@@ -57,6 +57,7 @@ and use it for toolbar and window layouts too.
 
 
 
+#include <algorithm>
 #include <map>
 
 #include <wx/wxprec.h>
@@ -201,10 +202,11 @@ static ThemeCacheLookup &GetThemeCacheLookup()
 
 ThemeBase::RegisteredTheme::RegisteredTheme(
    EnumValueSymbol symbol, PreferredSystemAppearance preferredSystemAppearance,
-   const std::vector<unsigned char> &data )
+   const unsigned char *data, size_t size )
    : symbol{ symbol }
    , preferredSystemAppearance { preferredSystemAppearance }
    , data { data }
+   , size { size }
 {
    GetThemeCacheLookup().emplace(symbol, *this);
 }
@@ -611,6 +613,20 @@ const int ImageCacheWidth = 440;
 
 const int ImageCacheHeight = 836;
 
+//! The atlas that image-compiler generates begins with these bytes, then the
+//! width and height as 32 bit little endian; then rows of RGBA pixels, with
+//! alpha not premultiplied, which can be used without decoding, as by
+//! textures
+constexpr unsigned char AtlasMagic[] = {
+   'A', 'U', 'D', 'A', 'T', 'L', 'A', 'S' };
+constexpr size_t AtlasHeaderSize = sizeof AtlasMagic + 8;
+
+static uint32_t ReadLittleEndian( const unsigned char *bytes )
+{
+   return bytes[0] | ( bytes[1] << 8 ) | ( bytes[2] << 16 ) |
+      ( uint32_t( bytes[3] ) << 24 );
+}
+
 void ThemeBase::CreateImageCache()
 {
    ValueRestorer cleanup{ mpSet };
@@ -630,6 +646,7 @@ themes. */
 bool ThemeBase::CreateOneImageCache( teThemeType id, bool bBinarySave )
 {
    SwitchTheme( id );
+   MakeAllImages();
    auto &resources = *mpSet;
 
    wxImage ImageCache( ImageCacheWidth, ImageCacheHeight );
@@ -772,13 +789,8 @@ bool ThemeBase::CreateOneImageCache( teThemeType id, bool bBinarySave )
                .Format( FileName ));
          return false;
       }
-      if( !ImageCache.SaveFile(OutStream, wxBITMAP_TYPE_PNG ) )
-      {
-         ShowMessageBox(
-            XO("Audacity could not write images to file:\n  %s.")
-               .Format( FileName ));
-         return false;
-      }
+      // An atlas, which loads without decoding, unlike PNG
+      WriteAtlas( OutStream, ImageCache );
    }
    return true;
 }
@@ -913,6 +925,10 @@ bool ThemeBase::ReadImageCache( teThemeType type, bool bOkIfNotFound)
 
    using namespace BasicUI;
 
+   // Forget images pending in any atlas read before
+   resources.mAtlas = nullptr;
+   resources.mPendingRects.clear();
+
    if( type.empty() || type == "custom" )
    {
       mPreferredSystemAppearance = PreferredSystemAppearance::Light;
@@ -953,12 +969,21 @@ bool ThemeBase::ReadImageCache( teThemeType type, bool bOkIfNotFound)
 
       mPreferredSystemAppearance = iter->second.preferredSystemAppearance;
 
-      ImageSize = iter->second.data.size();
+      ImageSize = iter->second.size;
       if (ImageSize == 0)
          // This must be the image compiler
          return true;
 
-      pImage = iter->second.data.data();
+      pImage = iter->second.data;
+      if (ImageSize >= sizeof AtlasMagic &&
+          std::equal(std::begin(AtlasMagic), std::end(AtlasMagic), pImage)) {
+         if (ReadAtlas(pImage, ImageSize))
+            return true;
+         ShowMessageBox(
+            XO(
+"Audacity could not read its default theme.\nPlease report the problem."));
+         return false;
+      }
       //wxLogDebug("Reading ImageCache %p size %i", pImage, ImageSize );
       wxMemoryInputStream InternalStream( pImage, ImageSize );
 
@@ -1029,6 +1054,89 @@ bool ThemeBase::ReadImageCache( teThemeType type, bool bOkIfNotFound)
    return true;
 }
 
+bool ThemeBase::ReadAtlas( const unsigned char *data, size_t size )
+{
+   auto &resources = *mpSet;
+   if ( size < AtlasHeaderSize )
+      return false;
+   const auto width = ReadLittleEndian( data + sizeof AtlasMagic );
+   const auto height = ReadLittleEndian( data + sizeof AtlasMagic + 4 );
+   // The layout of the flow packer assumes the width
+   if ( width != ImageCacheWidth ||
+       size < AtlasHeaderSize + 4 * size_t( width ) * height )
+      return false;
+
+   resources.mAtlas = data + AtlasHeaderSize;
+   resources.mAtlasWidth = width;
+   resources.mPendingRects.assign( resources.mImages.size(), wxRect{} );
+   const wxRect bounds{ 0, 0, int( width ), int( height ) };
+
+   FlowPacker context{ ImageCacheWidth };
+   for (size_t i = 0; i < resources.mImages.size(); ++i)
+   {
+      const wxImage &Image = resources.mImages[i];
+      context.mFlags = mBitmapFlags[i];
+      if( !(mBitmapFlags[i] & resFlagInternal) )
+      {
+         context.GetNextPosition( Image.GetWidth(),Image.GetHeight() );
+         const auto R = context.RectInner();
+         if ( !bounds.Contains( R ) ) {
+            resources.mAtlas = nullptr;
+            resources.mPendingRects.clear();
+            return false;
+         }
+         resources.mPendingRects[i] = R;
+      }
+   }
+
+   // The colours are few, so read them now
+   int x,y;
+   context.SetColourGroup();
+   for (size_t i = 0; i < resources.mColours.size(); ++i)
+   {
+      context.GetNextPosition( iColSize, iColSize );
+      context.RectMid( x, y );
+      if ( !bounds.Contains( x, y ) )
+         continue;
+      const auto pixel = resources.mAtlas + 4 * ( size_t( y ) * width + x );
+      // Only change the colour if the alpha is opaque, as for PNG
+      if( pixel[3] > 128 )
+      {
+         const wxColour TempColour{ pixel[0], pixel[1], pixel[2] };
+         if( TempColour != wxColour(1,1,1) )
+            resources.mColours[i] = TempColour;
+      }
+   }
+   return true;
+}
+
+void ThemeBase::WriteAtlas( wxOutputStream &stream, const wxImage &ImageCache )
+{
+   const auto width = ImageCache.GetWidth();
+   const auto height = ImageCache.GetHeight();
+   unsigned char header[ AtlasHeaderSize ];
+   std::copy( std::begin(AtlasMagic), std::end(AtlasMagic), header );
+   for ( int ii = 0; ii < 4; ++ii ) {
+      header[ sizeof AtlasMagic + ii ] = ( width >> ( 8 * ii ) ) & 0xff;
+      header[ sizeof AtlasMagic + 4 + ii ] = ( height >> ( 8 * ii ) ) & 0xff;
+   }
+   stream.Write( header, sizeof header );
+
+   const auto rgb = ImageCache.GetData();
+   const auto alpha = ImageCache.HasAlpha() ? ImageCache.GetAlpha() : nullptr;
+   std::vector<unsigned char> row( 4 * width );
+   for ( int y = 0; y < height; ++y ) {
+      for ( int x = 0; x < width; ++x ) {
+         const auto index = size_t( y ) * width + x;
+         row[ 4 * x ] = rgb[ 3 * index ];
+         row[ 4 * x + 1 ] = rgb[ 3 * index + 1 ];
+         row[ 4 * x + 2 ] = rgb[ 3 * index + 2 ];
+         row[ 4 * x + 3 ] = alpha ? alpha[ index ] : 255;
+      }
+      stream.Write( row.data(), row.size() );
+   }
+}
+
 void ThemeBase::LoadThemeComponents( bool bOkIfNotFound )
 {
    ValueRestorer cleanup{ mpSet };
@@ -1039,6 +1147,7 @@ void ThemeBase::LoadThemeComponents( bool bOkIfNotFound )
 void ThemeBase::LoadOneThemeComponents( teThemeType id, bool bOkIfNotFound )
 {
    SwitchTheme( id );
+   MakeAllImages();
    auto &resources = *mpSet;
    // IF directory doesn't exist THEN return early.
    const auto dir = ThemeComponentsDir(GetFilePath(), id);
@@ -1146,6 +1255,7 @@ bool ThemeBase::SaveOneThemeComponents( teThemeType id )
 {
    using namespace BasicUI;
    SwitchTheme( id );
+   MakeAllImages();
    auto &resources = *mpSet;
    // IF directory doesn't exist THEN create it
    const auto dir = ThemeComponentsDir(GetFilePath(), id);
@@ -1305,6 +1415,7 @@ wxBitmap & ThemeBase::Bitmap( int iIndex )
    wxASSERT( iIndex >= 0 );
    auto &resources = *mpSet;
    EnsureInitialised();
+   MakeImage( iIndex );
    return resources.mBitmaps[iIndex];
 }
 
@@ -1313,6 +1424,7 @@ wxImage  & ThemeBase::Image( int iIndex )
    wxASSERT( iIndex >= 0 );
    auto &resources = *mpSet;
    EnsureInitialised();
+   MakeImage( iIndex );
    return resources.mImages[iIndex];
 }
 wxSize  ThemeBase::ImageSize( int iIndex )
@@ -1320,13 +1432,57 @@ wxSize  ThemeBase::ImageSize( int iIndex )
    wxASSERT( iIndex >= 0 );
    auto &resources = *mpSet;
    EnsureInitialised();
+   // A pending image has the size of the registered one
    wxImage & Image = resources.mImages[iIndex];
    return wxSize( Image.GetWidth(), Image.GetHeight());
 }
 
+void ThemeBase::MakeImage( int iIndex )
+{
+   auto &resources = *mpSet;
+   if ( size_t(iIndex) >= resources.mPendingRects.size() )
+      return;
+   auto &rect = resources.mPendingRects[iIndex];
+   if ( rect.IsEmpty() )
+      return;
+
+   const int width = rect.GetWidth();
+   const int height = rect.GetHeight();
+   wxImage image( width, height, false );
+   image.InitAlpha();
+   auto rgb = image.GetData();
+   auto alpha = image.GetAlpha();
+   for ( int y = 0; y < height; ++y ) {
+      auto pixel = resources.mAtlas +
+         4 * ( size_t( rect.y + y ) * resources.mAtlasWidth + rect.x );
+      for ( int x = 0; x < width; ++x, pixel += 4 ) {
+         *rgb++ = pixel[0];
+         *rgb++ = pixel[1];
+         *rgb++ = pixel[2];
+         *alpha++ = pixel[3];
+      }
+   }
+   resources.mImages[iIndex] = image;
+   resources.mBitmaps[iIndex] = wxBitmap( image );
+   rect = {};
+}
+
+void ThemeBase::MakeAllImages()
+{
+   auto &resources = *mpSet;
+   EnsureInitialised();
+   for ( size_t i = 0; i < resources.mPendingRects.size(); ++i )
+      MakeImage( i );
+}
+
 /// Replaces both the image and the bitmap.
 void ThemeBase::ReplaceImage( int iIndex, wxImage * pImage )
 {
+   auto &resources = *mpSet;
+   EnsureInitialised();
+   // No need to make the pending image that is replaced
+   if ( size_t(iIndex) < resources.mPendingRects.size() )
+      resources.mPendingRects[iIndex] = {};
    Image( iIndex ) = *pImage;
    Bitmap( iIndex ) = wxBitmap( *pImage );
 }
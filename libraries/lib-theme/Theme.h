@@ -41,6 +41,7 @@ class wxArrayString;
 class wxBitmap;
 class wxColour;
 class wxImage;
+class wxOutputStream;
 class wxPen;
 
 class ChoiceSetting;
@@ -104,6 +105,12 @@ struct ThemeSet
    std::vector<wxBitmap> mBitmaps;
    std::vector<wxColour> mColours;
 
+   //! Pixels of a theme read from an atlas, as rows of RGBA, not copied
+   const unsigned char *mAtlas = nullptr;
+   int mAtlasWidth = 0;
+   //! Where each image not yet made from the atlas lies in it, or empty
+   std::vector<wxRect> mPendingRects;
+
    bool bInitialised = false;
    bool bRecolourOnLoad = false;  // Request to recolour.
 };
@@ -135,14 +142,17 @@ public:
    struct THEME_API RegisteredTheme {
       RegisteredTheme(EnumValueSymbol symbol,
          PreferredSystemAppearance preferredSystemAppearance,
-         const std::vector<unsigned char> &data /*!<
-            A reference to this vector is stored, not a copy of it! */
+         const unsigned char *data, size_t size /*!<
+            The data are not copied, and should be a static array, which the
+            system maps from the program file as it is read */
       );
       ~RegisteredTheme();
 
       const EnumValueSymbol symbol;
       const PreferredSystemAppearance preferredSystemAppearance;
-      const std::vector<unsigned char>& data;
+      //! An atlas, as image-compiler generates, or else a PNG image cache
+      const unsigned char *const data;
+      const size_t size;
    };
 
    void SwitchTheme( teThemeType Theme );
@@ -162,6 +172,11 @@ public:
    void CreateImageCache();
    bool CreateOneImageCache(teThemeType id, bool bBinarySave);
    bool ReadImageCache( teThemeType type = {}, bool bOkIfNotFound=false);
+   //! Take pixels and colours of the atlas without copying; images are made
+   //! from it only when first used
+   bool ReadAtlas( const unsigned char *data, size_t size );
+   //! Write the image cache in the format of ReadAtlas
+   static void WriteAtlas( wxOutputStream &stream, const wxImage &ImageCache );
    void LoadThemeComponents( bool bOkIfNotFound =false);
    void LoadOneThemeComponents( teThemeType id, bool bOkIfNotFound = false);
    void SaveThemeComponents();
@@ -194,6 +209,12 @@ public:
    // Reclaim resources after finished with theme editing
    void DeleteUnusedThemes();
 
+private:
+   //! Make the image and bitmap, if still pending in the atlas
+   void MakeImage( int iIndex );
+   //! Before using all of mImages and mBitmaps directly
+   void MakeAllImages();
+
 protected:
    FilePath mThemeDir;
 
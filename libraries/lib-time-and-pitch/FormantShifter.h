@@ -16,6 +16,7 @@
 #include "StaffPad/SamplesFloat.h"
 #include <complex>
 #include <memory>
+#include <vector>
 
 namespace staffpad::audio
 {
@@ -59,9 +60,13 @@ public:
 private:
    const int mSampleRate;
    FormantShifterLoggerInterface& mLogger;
+   // Allocated by `Reset(fftSize)` and kept for as long as the size is the
+   // same, so that `Process` allocates nothing.
    std::unique_ptr<staffpad::audio::FourierTransform> mFft;
    staffpad::SamplesComplex mEnvelope;
    staffpad::SamplesReal mCepstrum;
    std::vector<float> mEnvelopeReal;
+   std::vector<float> mResampled;
    std::vector<float> mWeights;
+   bool mActive = false;
 };
@@ -2,13 +2,36 @@
 
 #include "pffft.h"
 
+#include <map>
+#include <mutex>
+
 namespace staffpad::audio {
 
+namespace {
+// Setups are costly to make (twiddle factors), and stretchers are made again
+// whenever a clip starts playing or its parameters change
+std::shared_ptr<PFFFT_Setup> getRealSetup(int32_t blockSize)
+{
+  static std::mutex mutex;
+  static std::map<int32_t, std::weak_ptr<PFFFT_Setup>> setups;
+
+  const std::lock_guard<std::mutex> lock { mutex };
+  auto& weak = setups[blockSize];
+  auto result = weak.lock();
+  if (!result)
+  {
+    result = std::shared_ptr<PFFFT_Setup>(pffft_new_setup(blockSize, PFFFT_REAL), pffft_destroy_setup);
+    weak = result;
+  }
+  return result;
+}
+} // namespace
+
 FourierTransform::FourierTransform(int32_t newBlockSize)
-    : _blockSize { newBlockSize }
+    : realFftSpec { getRealSetup(newBlockSize) }
+    , _blockSize { newBlockSize }
 {
   _pffft_scratch = (float*)pffft_aligned_malloc(_blockSize * sizeof(float));
-  realFftSpec = pffft_new_setup(_blockSize, PFFFT_REAL);
 }
 
 FourierTransform::~FourierTransform()
@@ -18,11 +41,6 @@ FourierTransform::~FourierTransform()
     pffft_aligned_free(_pffft_scratch);
     _pffft_scratch = nullptr;
   }
-  if (realFftSpec)
-  {
-    pffft_destroy_setup(realFftSpec);
-    realFftSpec = nullptr;
-  }
 }
 
 void FourierTransform::forwardReal(const SamplesReal& t, SamplesComplex& c)
@@ -33,7 +51,7 @@ void FourierTransform::forwardReal(const SamplesReal& t, SamplesComplex& c)
   {
     auto* spec = c.getPtr(ch); // interleaved complex numbers, size _blockSize + 2
     auto* cpx_flt = (float*)spec;
-    pffft_transform_ordered(realFftSpec, t.getPtr(ch), cpx_flt, _pffft_scratch, PFFFT_FORWARD);
+    pffft_transform_ordered(realFftSpec.get(), t.getPtr(ch), cpx_flt, _pffft_scratch, PFFFT_FORWARD);
     // pffft combines dc and nyq values into the first complex value,
     // adjust to CCS format.
     auto dc = cpx_flt[0];
@@ -55,7 +73,7 @@ void FourierTransform::inverseReal(const SamplesComplex& c, SamplesReal& t)
     auto* ts = t.getPtr(ch);
     ts[0] = spec[0].real();
     ts[1] = spec[c.getNumSamples() - 1].real();
-    pffft_transform_ordered(realFftSpec, ts, ts, _pffft_scratch, PFFFT_BACKWARD);
+    pffft_transform_ordered(realFftSpec.get(), ts, ts, _pffft_scratch, PFFFT_BACKWARD);
   }
 }
 
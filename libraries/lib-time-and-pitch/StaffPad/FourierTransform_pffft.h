@@ -5,6 +5,8 @@
 
 #include <stdint.h>
 
+#include <memory>
+
 #include "SamplesFloat.h"
 
 struct PFFFT_Setup;
@@ -23,8 +25,8 @@ public:
   void inverseReal(const SamplesComplex& c, SamplesReal& t);
 
 private:
-  PFFFT_Setup* realFftSpec = nullptr;
-  PFFFT_Setup* complexFftSpec = nullptr;
+  // Shared by all transforms of the same size; pffft only reads the setup
+  std::shared_ptr<PFFFT_Setup> realFftSpec;
   float* _pffft_scratch = nullptr;
 
   const int32_t _blockSize;
@@ -0,0 +1,295 @@
+/* SPDX-License-Identifier: zlib */
+/*
+ * 256-bit AVX2/FMA version of SimdComplexConversions_sse2.h, with the same
+ * approximations, eight lanes at a time.
+ *
+ * Every function is compiled for AVX2 and FMA whatever the flags of the
+ * including translation unit, so that they may be chosen at run time; call
+ * them only when the processor supports both.
+ */
+
+#pragma once
+
+#include <immintrin.h>
+
+#include <algorithm>
+
+#include "SimdComplexConversions_sse2.h"
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#   define SIMD_AVX2_TARGET
+#else
+#   define SIMD_AVX2_TARGET __attribute__((target("avx2,fma")))
+#endif
+
+namespace simd_complex_conversions::avx2
+{
+SIMD_AVX2_TARGET inline __m256 atan_ps(__m256 x)
+{
+   using namespace details;
+
+   const auto signMask = _mm256_set1_ps(sign_mask);
+   /* extract the sign bit (upper one) */
+   const __m256 sign_bit = _mm256_and_ps(x, signMask);
+   /* take the absolute value */
+   x = _mm256_and_ps(x, _mm256_set1_ps(inv_sign_mask));
+
+   /* range reduction, init x and y depending on range */
+   /* x > 2.414213562373095 */
+   __m256 cmp0 =
+      _mm256_cmp_ps(x, _mm256_set1_ps(2.414213562373095f), _CMP_GT_OQ);
+   /* x > 0.4142135623730950 */
+   __m256 cmp1 =
+      _mm256_cmp_ps(x, _mm256_set1_ps(0.4142135623730950f), _CMP_GT_OQ);
+
+   /* x > 0.4142135623730950 && !( x > 2.414213562373095 ) */
+   __m256 cmp2 = _mm256_andnot_ps(cmp0, cmp1);
+
+   /* -( 1.0/x ) */
+   __m256 y0 = _mm256_and_ps(cmp0, _mm256_set1_ps(cephes_PIO2F));
+   __m256 x0 = _mm256_div_ps(_mm256_set1_ps(1.0f), x);
+   x0 = _mm256_xor_ps(x0, signMask);
+
+   __m256 y1 = _mm256_and_ps(cmp2, _mm256_set1_ps(cephes_PIO4F));
+   /* (x-1.0)/(x+1.0) */
+   __m256 x1 = _mm256_div_ps(
+      _mm256_sub_ps(x, _mm256_set1_ps(1.0f)),
+      _mm256_add_ps(x, _mm256_set1_ps(1.0f)));
+
+   __m256 x2 = _mm256_and_ps(cmp2, x1);
+   x0 = _mm256_and_ps(cmp0, x0);
+   x2 = _mm256_or_ps(x2, x0);
+   cmp1 = _mm256_or_ps(cmp0, cmp2);
+   x2 = _mm256_and_ps(cmp1, x2);
+   x = _mm256_andnot_ps(cmp1, x);
+   x = _mm256_or_ps(x2, x);
+
+   __m256 y = _mm256_or_ps(y0, y1);
+
+   __m256 zz = _mm256_mul_ps(x, x);
+   __m256 acc = _mm256_set1_ps(atancof_p0);
+   acc = _mm256_fmsub_ps(acc, zz, _mm256_set1_ps(atancof_p1));
+   acc = _mm256_fmadd_ps(acc, zz, _mm256_set1_ps(atancof_p2));
+   acc = _mm256_fmsub_ps(acc, zz, _mm256_set1_ps(atancof_p3));
+   acc = _mm256_mul_ps(acc, zz);
+   acc = _mm256_fmadd_ps(acc, x, x);
+   y = _mm256_add_ps(y, acc);
+
+   /* update the sign */
+   return _mm256_xor_ps(y, sign_bit);
+}
+
+SIMD_AVX2_TARGET inline __m256 atan2_ps(__m256 y, __m256 x)
+{
+   using namespace details;
+
+   const auto signMask = _mm256_set1_ps(sign_mask);
+   __m256 zero = _mm256_setzero_ps();
+   __m256 x_eq_0 = _mm256_cmp_ps(x, zero, _CMP_EQ_OQ);
+   __m256 x_gt_0 = _mm256_cmp_ps(x, zero, _CMP_GT_OQ);
+   __m256 y_eq_0 = _mm256_cmp_ps(y, zero, _CMP_EQ_OQ);
+   __m256 x_lt_0 = _mm256_cmp_ps(x, zero, _CMP_LT_OQ);
+   __m256 y_lt_0 = _mm256_cmp_ps(y, zero, _CMP_LT_OQ);
+
+   __m256 zero_mask = _mm256_and_ps(x_eq_0, y_eq_0);
+   __m256 zero_mask_other_case = _mm256_and_ps(y_eq_0, x_gt_0);
+   zero_mask = _mm256_or_ps(zero_mask, zero_mask_other_case);
+
+   __m256 pio2_mask = _mm256_andnot_ps(y_eq_0, x_eq_0);
+   __m256 pio2_mask_sign = _mm256_and_ps(y_lt_0, signMask);
+   __m256 pio2_result = _mm256_set1_ps(cephes_PIO2F);
+   pio2_result = _mm256_xor_ps(pio2_result, pio2_mask_sign);
+   pio2_result = _mm256_and_ps(pio2_mask, pio2_result);
+
+   __m256 pi_mask = _mm256_and_ps(y_eq_0, x_lt_0);
+   __m256 pi = _mm256_set1_ps(cephes_PIF);
+   __m256 pi_result = _mm256_and_ps(pi_mask, pi);
+
+   __m256 swap_sign_mask_offset = _mm256_and_ps(x_lt_0, y_lt_0);
+   swap_sign_mask_offset = _mm256_and_ps(swap_sign_mask_offset, signMask);
+
+   __m256 offset1 = _mm256_set1_ps(cephes_PIF);
+   offset1 = _mm256_xor_ps(offset1, swap_sign_mask_offset);
+   __m256 offset = _mm256_and_ps(x_lt_0, offset1);
+
+   __m256 arg = _mm256_div_ps(y, x);
+   __m256 atan_result = atan_ps(arg);
+   atan_result = _mm256_add_ps(atan_result, offset);
+
+   /* select between zero_result, pio2_result and atan_result */
+
+   __m256 result = _mm256_andnot_ps(zero_mask, pio2_result);
+   atan_result = _mm256_andnot_ps(zero_mask, atan_result);
+   atan_result = _mm256_andnot_ps(pio2_mask, atan_result);
+   result = _mm256_or_ps(result, atan_result);
+   result = _mm256_or_ps(result, pi_result);
+
+   return result;
+}
+
+SIMD_AVX2_TARGET inline std::pair<__m256, __m256> sincos_ps(__m256 x)
+{
+   using namespace details;
+
+   const auto signMask = _mm256_set1_ps(sign_mask);
+   /* extract the sign bit (upper one) */
+   __m256 sign_bit_sin = _mm256_and_ps(x, signMask);
+   /* take the absolute value */
+   x = _mm256_and_ps(x, _mm256_set1_ps(inv_sign_mask));
+
+   /* scale by 4/Pi */
+   __m256 y = _mm256_mul_ps(x, _mm256_set1_ps(cephes_FOPI));
+
+   /* store the integer part of y in emm2 */
+   __m256i emm2 = _mm256_cvttps_epi32(y);
+
+   /* j=(j+1) & (~1) (see the cephes sources) */
+   emm2 = _mm256_add_epi32(emm2, _mm256_set1_epi32(1));
+   emm2 = _mm256_and_si256(emm2, _mm256_set1_epi32(~1));
+   y = _mm256_cvtepi32_ps(emm2);
+
+   __m256i emm4 = emm2;
+
+   /* get the swap sign flag for the sine */
+   __m256i emm0 = _mm256_and_si256(emm2, _mm256_set1_epi32(4));
+   emm0 = _mm256_slli_epi32(emm0, 29);
+   __m256 swap_sign_bit_sin = _mm256_castsi256_ps(emm0);
+
+   /* get the polynom selection mask for the sine*/
+   emm2 = _mm256_and_si256(emm2, _mm256_set1_epi32(2));
+   emm2 = _mm256_cmpeq_epi32(emm2, _mm256_setzero_si256());
+   __m256 poly_mask = _mm256_castsi256_ps(emm2);
+
+   /* The magic pass: "Extended precision modular arithmetic"
+      x = ((x - y * DP1) - y * DP2) - y * DP3; */
+   x = _mm256_fmadd_ps(y, _mm256_set1_ps(minus_cephes_DP1), x);
+   x = _mm256_fmadd_ps(y, _mm256_set1_ps(minus_cephes_DP2), x);
+   x = _mm256_fmadd_ps(y, _mm256_set1_ps(minus_cephes_DP3), x);
+
+   emm4 = _mm256_sub_epi32(emm4, _mm256_set1_epi32(2));
+   emm4 = _mm256_andnot_si256(emm4, _mm256_set1_epi32(4));
+   emm4 = _mm256_slli_epi32(emm4, 29);
+   __m256 sign_bit_cos = _mm256_castsi256_ps(emm4);
+
+   sign_bit_sin = _mm256_xor_ps(sign_bit_sin, swap_sign_bit_sin);
+
+   /* Evaluate the first polynom  (0 <= x <= Pi/4) */
+   __m256 z = _mm256_mul_ps(x, x);
+   y = _mm256_set1_ps(coscof_p0);
+   y = _mm256_fmadd_ps(y, z, _mm256_set1_ps(coscof_p1));
+   y = _mm256_fmadd_ps(y, z, _mm256_set1_ps(coscof_p2));
+   y = _mm256_mul_ps(y, z);
+   y = _mm256_mul_ps(y, z);
+   y = _mm256_fnmadd_ps(z, _mm256_set1_ps(0.5f), y);
+   y = _mm256_add_ps(y, _mm256_set1_ps(1));
+
+   /* Evaluate the second polynom  (Pi/4 <= x <= 0) */
+   __m256 y2 = _mm256_set1_ps(sincof_p0);
+   y2 = _mm256_fmadd_ps(y2, z, _mm256_set1_ps(sincof_p1));
+   y2 = _mm256_fmadd_ps(y2, z, _mm256_set1_ps(sincof_p2));
+   y2 = _mm256_mul_ps(y2, z);
+   y2 = _mm256_fmadd_ps(y2, x, x);
+
+   /* select the correct result from the two polynoms */
+   const __m256 ysin = _mm256_blendv_ps(y, y2, poly_mask);
+   const __m256 ycos = _mm256_blendv_ps(y2, y, poly_mask);
+
+   /* update the sign */
+   return std::make_pair(
+      _mm256_xor_ps(ysin, sign_bit_sin), _mm256_xor_ps(ycos, sign_bit_cos));
+}
+
+SIMD_AVX2_TARGET inline __m256 norm(__m256 x, __m256 y)
+{
+   return _mm256_fmadd_ps(x, x, _mm256_mul_ps(y, y));
+}
+
+//! Real and imaginary parts of eight complex numbers, in order
+SIMD_AVX2_TARGET inline std::pair<__m256, __m256>
+deinterleave(const std::complex<float>* input)
+{
+   // Safe according to C++ standard
+   const auto p1 = _mm256_loadu_ps(reinterpret_cast<const float*>(input));
+   const auto p2 = _mm256_loadu_ps(reinterpret_cast<const float*>(input + 4));
+
+   // The shuffles work within 128-bit lanes, giving
+   // {r0, r1, r4, r5, r2, r3, r6, r7}; then put the pairs in order
+   const auto rp = _mm256_shuffle_ps(p1, p2, _MM_SHUFFLE(2, 0, 2, 0));
+   const auto ip = _mm256_shuffle_ps(p1, p2, _MM_SHUFFLE(3, 1, 3, 1));
+   return {
+      _mm256_castpd_ps(_mm256_permute4x64_pd(
+         _mm256_castps_pd(rp), _MM_SHUFFLE(3, 1, 2, 0))),
+      _mm256_castpd_ps(_mm256_permute4x64_pd(
+         _mm256_castps_pd(ip), _MM_SHUFFLE(3, 1, 2, 0)))
+   };
+}
+
+//! Inverse of deinterleave()
+SIMD_AVX2_TARGET inline void
+interleave(__m256 rp, __m256 ip, std::complex<float>* output)
+{
+   // {r0, i0, r1, i1, r4, i4, r5, i5} and {r2, i2, r3, i3, r6, i6, r7, i7}
+   const auto lo = _mm256_unpacklo_ps(rp, ip);
+   const auto hi = _mm256_unpackhi_ps(rp, ip);
+   _mm256_storeu_ps(
+      reinterpret_cast<float*>(output), _mm256_permute2f128_ps(lo, hi, 0x20));
+   _mm256_storeu_ps(
+      reinterpret_cast<float*>(output + 4),
+      _mm256_permute2f128_ps(lo, hi, 0x31));
+}
+
+template <typename fnc>
+SIMD_AVX2_TARGET void perform_parallel_simd(
+   const std::complex<float>* input, float* output, int n, const fnc& f)
+{
+   int i = 0;
+   for (; i <= n - 8; i += 8)
+   {
+      const auto [rp, ip] = deinterleave(input + i);
+      __m256 out;
+      f(rp, ip, out);
+      _mm256_storeu_ps(output + i, out);
+   }
+   // deal with last partial packet, padded with zeroes
+   if (const auto rest = n - i; rest > 0)
+   {
+      std::complex<float> in[8] {};
+      float out[8];
+      std::copy(input + i, input + n, in);
+      const auto [rp, ip] = deinterleave(in);
+      __m256 result;
+      f(rp, ip, result);
+      _mm256_storeu_ps(out, result);
+      std::copy(out, out + rest, output + i);
+   }
+}
+
+SIMD_AVX2_TARGET inline void rotate_parallel_simd(
+   const float* oldPhase, const float* newPhase, std::complex<float>* output,
+   int n)
+{
+   int i = 0;
+   for (; i <= n - 8; i += 8)
+   {
+      const auto theta =
+         oldPhase ?
+            _mm256_sub_ps(
+               _mm256_loadu_ps(newPhase + i), _mm256_loadu_ps(oldPhase + i)) :
+            _mm256_loadu_ps(newPhase + i);
+      const auto [sin, cos] = sincos_ps(theta);
+      const auto [rp, ip] = deinterleave(output + i);
+
+      // We need to calculate (rp, ip) * (cos, sin) -> (rp*cos - ip*sin, rp*sin + ip*cos)
+      const auto out_rp = _mm256_fmsub_ps(rp, cos, _mm256_mul_ps(ip, sin));
+      const auto out_ip = _mm256_fmadd_ps(rp, sin, _mm256_mul_ps(ip, cos));
+      interleave(out_rp, out_ip, output + i);
+   }
+   // deal with last partial packet
+   for (; i < n; ++i)
+   {
+      const auto theta = oldPhase ? newPhase[i] - oldPhase[i] : newPhase[i];
+      output[i] *= std::complex<float>(cosf(theta), sinf(theta));
+   }
+}
+
+} // namespace simd_complex_conversions::avx2
@@ -0,0 +1,268 @@
+/* SPDX-License-Identifier: zlib */
+/*
+ * NEON version of SimdComplexConversions_sse2.h for AArch64, with the same
+ * approximations, four lanes at a time.
+ */
+
+#pragma once
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#   include <arm64_neon.h>
+#else
+#   include <arm_neon.h>
+#endif
+
+#include <algorithm>
+#include <complex>
+#include <cstdint>
+#include <utility>
+
+namespace simd_complex_conversions::neon
+{
+namespace details
+{
+constexpr float cephes_PIF = 3.141592653589793238f;
+constexpr float cephes_PIO2F = 1.5707963267948966192f;
+constexpr float cephes_PIO4F = 0.7853981633974483096f;
+constexpr float cephes_FOPI = 1.27323954473516f; // 4 / M_PI
+constexpr float minus_cephes_DP1 = -0.78515625f;
+constexpr float minus_cephes_DP2 = -2.4187564849853515625e-4f;
+constexpr float minus_cephes_DP3 = -3.77489497744594108e-8f;
+constexpr float sincof_p0 = -1.9515295891e-4f;
+constexpr float sincof_p1 = 8.3321608736e-3f;
+constexpr float sincof_p2 = -1.6666654611e-1f;
+constexpr float coscof_p0 = 2.443315711809948e-005f;
+constexpr float coscof_p1 = -1.388731625493765e-003f;
+constexpr float coscof_p2 = 4.166664568298827e-002f;
+
+constexpr float atancof_p0 = 8.05374449538e-2f;
+constexpr float atancof_p1 = 1.38776856032e-1f;
+constexpr float atancof_p2 = 1.99777106478e-1f;
+constexpr float atancof_p3 = 3.33329491539e-1f;
+
+constexpr uint32_t sign_mask = 0x80000000u;
+
+inline uint32x4_t bits(float32x4_t x)
+{
+   return vreinterpretq_u32_f32(x);
+}
+
+inline float32x4_t floats(uint32x4_t x)
+{
+   return vreinterpretq_f32_u32(x);
+}
+
+//! Lanes of x where mask is set, else zero
+inline float32x4_t select(uint32x4_t mask, float32x4_t x)
+{
+   return floats(vandq_u32(mask, bits(x)));
+}
+} // namespace details
+
+inline float32x4_t atan_ps(float32x4_t x)
+{
+   using namespace details;
+
+   /* extract the sign bit (upper one) */
+   const uint32x4_t sign_bit = vandq_u32(bits(x), vdupq_n_u32(sign_mask));
+   /* take the absolute value */
+   x = vabsq_f32(x);
+
+   /* range reduction, init x and y depending on range */
+   /* x > 2.414213562373095 */
+   const uint32x4_t cmp0 = vcgtq_f32(x, vdupq_n_f32(2.414213562373095f));
+   /* x > 0.4142135623730950 */
+   const uint32x4_t cmp1 = vcgtq_f32(x, vdupq_n_f32(0.4142135623730950f));
+   /* x > 0.4142135623730950 && !( x > 2.414213562373095 ) */
+   const uint32x4_t cmp2 = vbicq_u32(cmp1, cmp0);
+
+   /* -( 1.0/x ) */
+   const float32x4_t x0 = vnegq_f32(vdivq_f32(vdupq_n_f32(1.0f), x));
+   /* (x-1.0)/(x+1.0) */
+   const float32x4_t x1 = vdivq_f32(
+      vsubq_f32(x, vdupq_n_f32(1.0f)), vaddq_f32(x, vdupq_n_f32(1.0f)));
+
+   x = vbslq_f32(cmp0, x0, vbslq_f32(cmp2, x1, x));
+   float32x4_t y = vaddq_f32(
+      select(cmp0, vdupq_n_f32(cephes_PIO2F)),
+      select(cmp2, vdupq_n_f32(cephes_PIO4F)));
+
+   const float32x4_t zz = vmulq_f32(x, x);
+   float32x4_t acc = vdupq_n_f32(atancof_p0);
+   acc = vfmaq_f32(vdupq_n_f32(-atancof_p1), acc, zz);
+   acc = vfmaq_f32(vdupq_n_f32(atancof_p2), acc, zz);
+   acc = vfmaq_f32(vdupq_n_f32(-atancof_p3), acc, zz);
+   acc = vmulq_f32(acc, zz);
+   acc = vfmaq_f32(x, acc, x);
+   y = vaddq_f32(y, acc);
+
+   /* update the sign */
+   return floats(veorq_u32(bits(y), sign_bit));
+}
+
+inline float32x4_t atan2_ps(float32x4_t y, float32x4_t x)
+{
+   using namespace details;
+
+   const float32x4_t zero = vdupq_n_f32(0);
+   const uint32x4_t signMask = vdupq_n_u32(sign_mask);
+   const uint32x4_t x_eq_0 = vceqq_f32(x, zero);
+   const uint32x4_t x_gt_0 = vcgtq_f32(x, zero);
+   const uint32x4_t y_eq_0 = vceqq_f32(y, zero);
+   const uint32x4_t x_lt_0 = vcltq_f32(x, zero);
+   const uint32x4_t y_lt_0 = vcltq_f32(y, zero);
+
+   const uint32x4_t zero_mask =
+      vorrq_u32(vandq_u32(x_eq_0, y_eq_0), vandq_u32(y_eq_0, x_gt_0));
+
+   const uint32x4_t pio2_mask = vbicq_u32(x_eq_0, y_eq_0);
+   const uint32x4_t pio2_result = vandq_u32(
+      pio2_mask, veorq_u32(
+                    bits(vdupq_n_f32(cephes_PIO2F)),
+                    vandq_u32(y_lt_0, signMask)));
+
+   const uint32x4_t pi_result =
+      vandq_u32(vandq_u32(y_eq_0, x_lt_0), bits(vdupq_n_f32(cephes_PIF)));
+
+   const uint32x4_t swap_sign = vandq_u32(vandq_u32(x_lt_0, y_lt_0), signMask);
+   const float32x4_t offset = floats(
+      vandq_u32(x_lt_0, veorq_u32(bits(vdupq_n_f32(cephes_PIF)), swap_sign)));
+
+   const float32x4_t atan_result =
+      vaddq_f32(atan_ps(vdivq_f32(y, x)), offset);
+
+   /* select between zero_result, pio2_result and atan_result */
+   uint32x4_t result = vbicq_u32(pio2_result, zero_mask);
+   result = vorrq_u32(
+      result, vbicq_u32(vbicq_u32(bits(atan_result), zero_mask), pio2_mask));
+   result = vorrq_u32(result, pi_result);
+   return floats(result);
+}
+
+inline std::pair<float32x4_t, float32x4_t> sincos_ps(float32x4_t x)
+{
+   using namespace details;
+
+   /* extract the sign bit (upper one) */
+   uint32x4_t sign_bit_sin = vandq_u32(bits(x), vdupq_n_u32(sign_mask));
+   /* take the absolute value */
+   x = vabsq_f32(x);
+
+   /* scale by 4/Pi */
+   float32x4_t y = vmulq_f32(x, vdupq_n_f32(cephes_FOPI));
+
+   /* store the integer part of y in emm2 */
+   uint32x4_t emm2 = vreinterpretq_u32_s32(vcvtq_s32_f32(y));
+
+   /* j=(j+1) & (~1) (see the cephes sources) */
+   emm2 = vaddq_u32(emm2, vdupq_n_u32(1));
+   emm2 = vandq_u32(emm2, vdupq_n_u32(~1u));
+   y = vcvtq_f32_s32(vreinterpretq_s32_u32(emm2));
+
+   /* get the swap sign flag for the sine */
+   const uint32x4_t swap_sign_bit_sin =
+      vshlq_n_u32(vandq_u32(emm2, vdupq_n_u32(4)), 29);
+
+   /* get the polynom selection mask for the sine*/
+   const uint32x4_t poly_mask =
+      vceqq_u32(vandq_u32(emm2, vdupq_n_u32(2)), vdupq_n_u32(0));
+
+   /* The magic pass: "Extended precision modular arithmetic"
+      x = ((x - y * DP1) - y * DP2) - y * DP3; */
+   x = vfmaq_f32(x, y, vdupq_n_f32(minus_cephes_DP1));
+   x = vfmaq_f32(x, y, vdupq_n_f32(minus_cephes_DP2));
+   x = vfmaq_f32(x, y, vdupq_n_f32(minus_cephes_DP3));
+
+   const uint32x4_t sign_bit_cos = vshlq_n_u32(
+      vbicq_u32(vdupq_n_u32(4), vsubq_u32(emm2, vdupq_n_u32(2))), 29);
+
+   sign_bit_sin = veorq_u32(sign_bit_sin, swap_sign_bit_sin);
+
+   /* Evaluate the first polynom  (0 <= x <= Pi/4) */
+   const float32x4_t z = vmulq_f32(x, x);
+   y = vdupq_n_f32(coscof_p0);
+   y = vfmaq_f32(vdupq_n_f32(coscof_p1), y, z);
+   y = vfmaq_f32(vdupq_n_f32(coscof_p2), y, z);
+   y = vmulq_f32(vmulq_f32(y, z), z);
+   y = vfmsq_f32(y, z, vdupq_n_f32(0.5f));
+   y = vaddq_f32(y, vdupq_n_f32(1));
+
+   /* Evaluate the second polynom  (Pi/4 <= x <= 0) */
+   float32x4_t y2 = vdupq_n_f32(sincof_p0);
+   y2 = vfmaq_f32(vdupq_n_f32(sincof_p1), y2, z);
+   y2 = vfmaq_f32(vdupq_n_f32(sincof_p2), y2, z);
+   y2 = vmulq_f32(y2, z);
+   y2 = vfmaq_f32(x, y2, x);
+
+   /* select the correct result from the two polynoms */
+   const float32x4_t ysin = vbslq_f32(poly_mask, y2, y);
+   const float32x4_t ycos = vbslq_f32(poly_mask, y, y2);
+
+   /* update the sign */
+   return std::make_pair(
+      floats(veorq_u32(bits(ysin), sign_bit_sin)),
+      floats(veorq_u32(bits(ycos), sign_bit_cos)));
+}
+
+inline float32x4_t norm(float32x4_t x, float32x4_t y)
+{
+   return vfmaq_f32(vmulq_f32(y, y), x, x);
+}
+
+template <typename fnc>
+void perform_parallel_simd(
+   const std::complex<float>* input, float* output, int n, const fnc& f)
+{
+   int i = 0;
+   for (; i <= n - 4; i += 4)
+   {
+      // Safe according to C++ standard
+      const auto p = vld2q_f32(reinterpret_cast<const float*>(input + i));
+      float32x4_t out;
+      f(p.val[0], p.val[1], out);
+      vst1q_f32(output + i, out);
+   }
+   // deal with last partial packet, padded with zeroes
+   if (const auto rest = n - i; rest > 0)
+   {
+      std::complex<float> in[4] {};
+      float out[4];
+      std::copy(input + i, input + n, in);
+      const auto p = vld2q_f32(reinterpret_cast<const float*>(in));
+      float32x4_t result;
+      f(p.val[0], p.val[1], result);
+      vst1q_f32(out, result);
+      std::copy(out, out + rest, output + i);
+   }
+}
+
+inline void rotate_parallel_simd(
+   const float* oldPhase, const float* newPhase, std::complex<float>* output,
+   int n)
+{
+   int i = 0;
+   for (; i <= n - 4; i += 4)
+   {
+      const auto theta =
+         oldPhase ?
+            vsubq_f32(vld1q_f32(newPhase + i), vld1q_f32(oldPhase + i)) :
+            vld1q_f32(newPhase + i);
+      const auto [sin, cos] = sincos_ps(theta);
+      const auto dst = reinterpret_cast<float*>(output + i);
+      auto p = vld2q_f32(dst);
+      const auto rp = p.val[0], ip = p.val[1];
+
+      // We need to calculate (rp, ip) * (cos, sin) -> (rp*cos - ip*sin, rp*sin + ip*cos)
+      p.val[0] = vfmsq_f32(vmulq_f32(rp, cos), ip, sin);
+      p.val[1] = vfmaq_f32(vmulq_f32(ip, cos), rp, sin);
+      vst2q_f32(dst, p);
+   }
+   // deal with last partial packet
+   for (; i < n; ++i)
+   {
+      const auto theta = oldPhase ? newPhase[i] - oldPhase[i] : newPhase[i];
+      output[i] *= std::complex<float>(cosf(theta), sinf(theta));
+   }
+}
+
+} // namespace simd_complex_conversions::neon
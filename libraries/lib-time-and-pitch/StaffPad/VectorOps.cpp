@@ -0,0 +1,184 @@
+#include "VectorOps.h"
+
+#include <cmath>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#  if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#    define VECTOR_OPS_SSE2
+#    include "SimdComplexConversions_sse2.h"
+#    if defined(__GNUC__) || defined(__clang__) || defined(_MSC_VER)
+#      define VECTOR_OPS_AVX2
+#      include "SimdComplexConversions_avx2.h"
+#      if defined(_MSC_VER) && !defined(__clang__)
+#        include <intrin.h>
+#      endif
+#    endif
+#  endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#  define VECTOR_OPS_NEON
+#  include "SimdComplexConversions_neon.h"
+#endif
+
+namespace staffpad {
+namespace vo {
+namespace {
+
+struct ComplexKernels
+{
+  void (*calcPhases)(const std::complex<float>* src, float* dst, int32_t n);
+  void (*calcNorms)(const std::complex<float>* src, float* dst, int32_t n);
+  void (*rotate)(const float* oldPhase, const float* newPhase, std::complex<float>* dst, int32_t n);
+};
+
+#if !defined(VECTOR_OPS_SSE2) && !defined(VECTOR_OPS_NEON)
+void scalarCalcPhases(const std::complex<float>* src, float* dst, int32_t n)
+{
+  for (int32_t i = 0; i < n; i++)
+    dst[i] = std::arg(src[i]);
+}
+
+void scalarCalcNorms(const std::complex<float>* src, float* dst, int32_t n)
+{
+  for (int32_t i = 0; i < n; i++)
+    dst[i] = std::norm(src[i]);
+}
+
+void scalarRotate(const float* oldPhase, const float* newPhase, std::complex<float>* dst, int32_t n)
+{
+  for (int32_t i = 0; i < n; i++) {
+    const auto theta = oldPhase ? newPhase[i] - oldPhase[i] : newPhase[i];
+    dst[i] *= std::complex<float>(cosf(theta), sinf(theta));
+  }
+}
+#endif
+
+#ifdef VECTOR_OPS_SSE2
+void sse2CalcPhases(const std::complex<float>* src, float* dst, int32_t n)
+{
+  simd_complex_conversions::perform_parallel_simd_aligned(
+     src, dst, n,
+     [](const __m128 rp, const __m128 ip, __m128& out)
+     { out = simd_complex_conversions::atan2_ps(ip, rp); });
+}
+
+void sse2CalcNorms(const std::complex<float>* src, float* dst, int32_t n)
+{
+  simd_complex_conversions::perform_parallel_simd_aligned(
+     src, dst, n,
+     [](const __m128 rp, const __m128 ip, __m128& out)
+     { out = simd_complex_conversions::norm(rp, ip); });
+}
+
+void sse2Rotate(const float* oldPhase, const float* newPhase, std::complex<float>* dst, int32_t n)
+{
+  simd_complex_conversions::rotate_parallel_simd_aligned(oldPhase, newPhase, dst, n);
+}
+#endif
+
+#ifdef VECTOR_OPS_AVX2
+SIMD_AVX2_TARGET void avx2CalcPhases(const std::complex<float>* src, float* dst, int32_t n)
+{
+  simd_complex_conversions::avx2::perform_parallel_simd(
+     src, dst, n,
+     [](const __m256 rp, const __m256 ip, __m256& out) SIMD_AVX2_TARGET
+     { out = simd_complex_conversions::avx2::atan2_ps(ip, rp); });
+}
+
+SIMD_AVX2_TARGET void avx2CalcNorms(const std::complex<float>* src, float* dst, int32_t n)
+{
+  simd_complex_conversions::avx2::perform_parallel_simd(
+     src, dst, n,
+     [](const __m256 rp, const __m256 ip, __m256& out) SIMD_AVX2_TARGET
+     { out = simd_complex_conversions::avx2::norm(rp, ip); });
+}
+
+SIMD_AVX2_TARGET void avx2Rotate(const float* oldPhase, const float* newPhase, std::complex<float>* dst, int32_t n)
+{
+  simd_complex_conversions::avx2::rotate_parallel_simd(oldPhase, newPhase, dst, n);
+}
+
+bool hasAvx2AndFma()
+{
+#  if defined(_MSC_VER) && !defined(__clang__)
+  int info[4];
+  __cpuid(info, 0);
+  if (info[0] < 7)
+    return false;
+  __cpuid(info, 1);
+  // FMA, OSXSAVE and AVX, then whether the OS saves the ymm registers
+  constexpr int fma = 1 << 12, osxsave = 1 << 27, avx = 1 << 28;
+  if ((info[2] & (fma | osxsave | avx)) != (fma | osxsave | avx) ||
+      (_xgetbv(0) & 6) != 6)
+    return false;
+  __cpuidex(info, 7, 0);
+  return (info[1] & (1 << 5)) != 0;
+#  else
+  return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#  endif
+}
+#endif
+
+#ifdef VECTOR_OPS_NEON
+void neonCalcPhases(const std::complex<float>* src, float* dst, int32_t n)
+{
+  simd_complex_conversions::neon::perform_parallel_simd(
+     src, dst, n,
+     [](const float32x4_t rp, const float32x4_t ip, float32x4_t& out)
+     { out = simd_complex_conversions::neon::atan2_ps(ip, rp); });
+}
+
+void neonCalcNorms(const std::complex<float>* src, float* dst, int32_t n)
+{
+  simd_complex_conversions::neon::perform_parallel_simd(
+     src, dst, n,
+     [](const float32x4_t rp, const float32x4_t ip, float32x4_t& out)
+     { out = simd_complex_conversions::neon::norm(rp, ip); });
+}
+
+void neonRotate(const float* oldPhase, const float* newPhase, std::complex<float>* dst, int32_t n)
+{
+  simd_complex_conversions::neon::rotate_parallel_simd(oldPhase, newPhase, dst, n);
+}
+#endif
+
+ComplexKernels chooseKernels()
+{
+#if defined(VECTOR_OPS_AVX2)
+  if (hasAvx2AndFma())
+    return { avx2CalcPhases, avx2CalcNorms, avx2Rotate };
+#endif
+#if defined(VECTOR_OPS_SSE2)
+  return { sse2CalcPhases, sse2CalcNorms, sse2Rotate };
+#elif defined(VECTOR_OPS_NEON)
+  return { neonCalcPhases, neonCalcNorms, neonRotate };
+#else
+  return { scalarCalcPhases, scalarCalcNorms, scalarRotate };
+#endif
+}
+
+const ComplexKernels& kernels()
+{
+  static const ComplexKernels result = chooseKernels();
+  return result;
+}
+
+} // namespace
+
+void calcPhases(const std::complex<float>* src, float* dst, int32_t n)
+{
+  kernels().calcPhases(src, dst, n);
+}
+
+void calcNorms(const std::complex<float>* src, float* dst, int32_t n)
+{
+  kernels().calcNorms(src, dst, n);
+}
+
+void rotate(const float* oldPhase, const float* newPhase, std::complex<float>* dst, int32_t n)
+{
+  kernels().rotate(oldPhase, newPhase, dst, n);
+}
+
+} // namespace vo
+} // namespace staffpad
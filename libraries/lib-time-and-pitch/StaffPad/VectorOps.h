@@ -14,15 +14,6 @@
 #include <cstdint>
 #include <cstring>
 
-#if defined(_MSC_VER) && (defined(_M_AMD64) || defined(_M_X64) || \
-                          (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
-#define USE_SSE2_COMPLEX 1
-#endif
-
-#if USE_SSE2_COMPLEX
-#   include "SimdComplexConversions_sse2.h"
-#endif
-
 namespace staffpad {
 namespace vo {
 
@@ -99,52 +90,15 @@ inline void findMaxElement(const T* src, int32_t n, int32_t& maxIndex, T& maxVal
   }
 }
 
-#if USE_SSE2_COMPLEX
+// The complex conversions dominate the phase vocoder.  They are defined in
+// VectorOps.cpp, which chooses the widest instruction set of the processor at
+// run time: AVX2 with FMA, SSE2, NEON, or else plain C++.
 
-inline void calcPhases(const std::complex<float>* src, float* dst, int32_t n)
-{
-  simd_complex_conversions::perform_parallel_simd_aligned(
-     src, dst, n,
-     [](const __m128 rp, const __m128 ip, __m128& out)
-     { out = simd_complex_conversions::atan2_ps(ip, rp); });
-}
+TIME_AND_PITCH_API void calcPhases(const std::complex<float>* src, float* dst, int32_t n);
 
-inline void calcNorms(const std::complex<float>* src, float* dst, int32_t n)
-{
-  simd_complex_conversions::perform_parallel_simd_aligned(
-     src, dst, n,
-     [](const __m128 rp, const __m128 ip, __m128& out)
-     { out = simd_complex_conversions::norm(rp, ip); });
-}
+TIME_AND_PITCH_API void calcNorms(const std::complex<float>* src, float* dst, int32_t n);
 
-inline void rotate(
-   const float* oldPhase, const float* newPhase, std::complex<float>* dst,
-   int32_t n)
-{
-  simd_complex_conversions::rotate_parallel_simd_aligned(
-     oldPhase, newPhase, dst, n);
-}
-#else
-inline void calcPhases(const std::complex<float>* src, float* dst, int32_t n)
-{
-  for (int32_t i = 0; i < n; i++)
-    dst[i] = std::arg(src[i]);
-}
-
-inline void calcNorms(const std::complex<float>* src, float* dst, int32_t n)
-{
-  for (int32_t i = 0; i < n; i++)
-    dst[i] = std::norm(src[i]);
-}
-
-inline void rotate(const float* oldPhase, const float* newPhase, std::complex<float>* dst, int32_t n)
-{
-  for (int32_t i = 0; i < n; i++) {
-    const auto theta = oldPhase ? newPhase[i] - oldPhase[i] : newPhase[i];
-    dst[i] *= std::complex<float>(cosf(theta), sinf(theta));
-  }
-}
-#endif
+TIME_AND_PITCH_API void rotate(const float* oldPhase, const float* newPhase, std::complex<float>* dst, int32_t n);
 
 } // namespace vo
 } // namespace staffpad
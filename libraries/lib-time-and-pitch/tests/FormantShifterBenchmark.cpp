@@ -0,0 +1,83 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  FormantShifterBenchmark.cpp
+
+  Real-time factor of StaffPadTimeAndPitch pitch-shifting with and without
+  formant preservation, printed so that regressions show up in the test log.
+
+**********************************************************************/
+#include "AudioContainer.h"
+#include "MockedPrefs.h"
+#include "StaffPadTimeAndPitch.h"
+
+#include <catch2/catch.hpp>
+
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+
+namespace
+{
+constexpr auto sampleRate = 44100;
+constexpr auto numChannels = 2u;
+constexpr auto durationSeconds = 10;
+constexpr size_t blockSize = 1024;
+
+//! Harmonics of a low voice, with a formant-like bump around 700 Hz
+struct VoiceLikeSource final : public TimeAndPitchSource
+{
+   void Pull(float* const* buffer, size_t numSamples) override
+   {
+      constexpr auto twoPi = 6.283185307179586;
+      constexpr auto f0 = 120.;
+      for (auto i = 0u; i < numSamples; ++i, ++mPosition)
+      {
+         const auto t = static_cast<double>(mPosition) / sampleRate;
+         auto sample = 0.;
+         for (auto h = 1; h * f0 < 5000; ++h)
+         {
+            const auto f = h * f0;
+            const auto gain = .1 / h + .2 * std::exp(-std::pow((f - 700) / 300, 2));
+            sample += gain * std::sin(twoPi * f * t);
+         }
+         for (auto ch = 0u; ch < numChannels; ++ch)
+            buffer[ch][i] = static_cast<float>(sample);
+      }
+   }
+
+   unsigned long long mPosition = 0;
+};
+
+double RealTimeFactor(bool preserveFormants)
+{
+   using namespace std::chrono;
+   VoiceLikeSource source;
+   TimeAndPitchInterface::Parameters params;
+   params.pitchRatio = 5. / 4.;
+   params.preserveFormants = preserveFormants;
+   StaffPadTimeAndPitch sut { sampleRate, numChannels, source, params };
+   AudioContainer container(blockSize, numChannels);
+   const auto numBlocks = durationSeconds * sampleRate / blockSize;
+   const auto start = steady_clock::now();
+   for (auto i = 0; i < numBlocks; ++i)
+      sut.GetSamples(container.Get(), blockSize);
+   const auto seconds = duration<double>(steady_clock::now() - start).count();
+   return numBlocks * blockSize / static_cast<double>(sampleRate) / seconds;
+}
+} // namespace
+
+TEST_CASE("FormantShifterBenchmark")
+{
+   MockedPrefs mockedPrefs;
+   const auto without = RealTimeFactor(false);
+   const auto with = RealTimeFactor(true);
+   std::cout << std::fixed << std::setprecision(1)
+             << "pitch shift, real-time factor: " << without
+             << "x without formant preservation, " << with << "x with\n";
+   REQUIRE(without > 0);
+   REQUIRE(with > 0);
+}
@@ -0,0 +1,87 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  VectorOpsTest.cpp
+
+**********************************************************************/
+#include "StaffPad/VectorOps.h"
+
+#include <catch2/catch.hpp>
+
+#include <cmath>
+#include <random>
+
+namespace
+{
+// Not a multiple of any vector width, so that the tails are exercised
+constexpr int32_t numValues = 1027;
+
+struct alignas(64) ComplexBuffer
+{
+   std::complex<float> values[numValues];
+};
+
+struct alignas(64) FloatBuffer
+{
+   float values[numValues];
+};
+} // namespace
+
+TEST_CASE("VectorOps complex conversions")
+{
+   std::mt19937 engine { 1 };
+   std::uniform_real_distribution<float> dist { -3.f, 3.f };
+
+   ComplexBuffer src;
+   for (auto& value : src.values)
+      value = { dist(engine), dist(engine) };
+   // Axes and origin
+   src.values[0] = { 0.f, 0.f };
+   src.values[1] = { 0.f, 1.f };
+   src.values[2] = { 0.f, -1.f };
+   src.values[3] = { -1.f, 0.f };
+   src.values[4] = { 1.f, 0.f };
+
+   SECTION("calcPhases")
+   {
+      FloatBuffer dst;
+      staffpad::vo::calcPhases(src.values, dst.values, numValues);
+      for (auto i = 0; i < numValues; ++i)
+         REQUIRE(
+            dst.values[i] == Approx(std::arg(src.values[i])).margin(1e-5));
+   }
+
+   SECTION("calcNorms")
+   {
+      FloatBuffer dst;
+      staffpad::vo::calcNorms(src.values, dst.values, numValues);
+      for (auto i = 0; i < numValues; ++i)
+         REQUIRE(
+            dst.values[i] == Approx(std::norm(src.values[i])).epsilon(1e-5));
+   }
+
+   SECTION("rotate")
+   {
+      FloatBuffer oldPhase, newPhase;
+      for (auto i = 0; i < numValues; ++i)
+      {
+         oldPhase.values[i] = 3 * dist(engine);
+         newPhase.values[i] = 3 * dist(engine);
+      }
+      const auto withOldPhase = GENERATE(false, true);
+      ComplexBuffer dst = src;
+      staffpad::vo::rotate(
+         withOldPhase ? oldPhase.values : nullptr, newPhase.values,
+         dst.values, numValues);
+      for (auto i = 0; i < numValues; ++i)
+      {
+         const auto theta = withOldPhase ?
+                               newPhase.values[i] - oldPhase.values[i] :
+                               newPhase.values[i];
+         const auto expected = src.values[i] * std::polar(1.f, theta);
+         REQUIRE(std::abs(dst.values[i] - expected) < 1e-5f);
+      }
+   }
+}
@@ -34,6 +34,10 @@ struct TrackListRestorer final : UndoStateExtension {
    bool CanUndoOrRedo(const AudacityProject &project) override {
       return !PendingTracks::Get(project).HasPendingTracks();
    }
+   std::shared_ptr<UndoStateExtension>
+   Compact(AudacityProject &project) override {
+      return UndoTracks::Compactor::Call(project, *mpTracks);
+   }
    const std::shared_ptr<TrackList> mpTracks;
 };
 
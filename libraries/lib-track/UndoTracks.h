@@ -10,11 +10,29 @@
 #ifndef __AUDACITY_UNDO_TRACKS__
 #define __AUDACITY_UNDO_TRACKS__
 
+#include "GlobalVariable.h"
+
+#include <memory>
+
+class AudacityProject;
 class TrackList;
 struct UndoStackElem;
+class UndoStateExtension;
 
 namespace UndoTracks {
+//! @return null if the state has no tracks, or they were compacted
 TRACK_API TrackList *Find(const UndoStackElem &state);
+
+//! Type of function that encodes the tracks of a state of undo history in
+//! less memory
+/*!
+ The result restores the project's tracks as the copies would; it may be null,
+ and then the copies are kept.  A library that can serialize tracks installs
+ the function.
+ */
+struct TRACK_API Compactor : GlobalHook<Compactor,
+   std::shared_ptr<UndoStateExtension>(AudacityProject &, const TrackList &)
+> {};
 }
 
 #endif
@@ -0,0 +1,107 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file AtomicHistogram.cpp
+
+**********************************************************************/
+
+#include "AtomicHistogram.h"
+
+#include <algorithm>
+#include <cmath>
+
+AtomicHistogram::AtomicHistogram(Scale scale, uint64_t width) noexcept
+   : mScale{ scale }
+   , mWidth{ std::max<uint64_t>(1, width) }
+{
+}
+
+size_t AtomicHistogram::BinIndex(uint64_t value) const noexcept
+{
+   size_t index = 0;
+   if (mScale == Scale::Linear)
+      index = std::min<uint64_t>(value / mWidth, BinsCount - 1);
+   else {
+      // One more than the position of the highest set bit
+      while (value != 0 && index < BinsCount - 1) {
+         value >>= 1;
+         ++index;
+      }
+   }
+   return index;
+}
+
+void AtomicHistogram::Add(uint64_t value) noexcept
+{
+   constexpr auto order = std::memory_order_relaxed;
+   mCounts[BinIndex(value)].fetch_add(1, order);
+   mCount.fetch_add(1, order);
+   mSum.fetch_add(value, order);
+   auto max = mMax.load(order);
+   while (value > max && !mMax.compare_exchange_weak(max, value, order))
+      ;
+}
+
+void AtomicHistogram::Reset() noexcept
+{
+   constexpr auto order = std::memory_order_relaxed;
+   for (auto &count : mCounts)
+      count.store(0, order);
+   mCount.store(0, order);
+   mSum.store(0, order);
+   mMax.store(0, order);
+}
+
+auto AtomicHistogram::GetSnapshot() const noexcept -> Snapshot
+{
+   constexpr auto order = std::memory_order_relaxed;
+   Snapshot result;
+   result.scale = mScale;
+   result.width = mWidth;
+   for (size_t ii = 0; ii < BinsCount; ++ii)
+      result.counts[ii] = mCounts[ii].load(order);
+   result.count = mCount.load(order);
+   result.sum = mSum.load(order);
+   result.max = mMax.load(order);
+   return result;
+}
+
+uint64_t AtomicHistogram::Snapshot::BinLower(size_t iBin) const noexcept
+{
+   if (scale == Scale::Linear)
+      return iBin * width;
+   return iBin == 0 ? 0 : uint64_t{ 1 } << (iBin - 1);
+}
+
+uint64_t AtomicHistogram::Snapshot::BinUpper(size_t iBin) const noexcept
+{
+   if (iBin + 1 >= BinsCount)
+      return std::max(BinLower(iBin), max) + 1;
+   return BinLower(iBin + 1);
+}
+
+double AtomicHistogram::Snapshot::Mean() const noexcept
+{
+   return count == 0 ? 0.0 : double(sum) / count;
+}
+
+uint64_t AtomicHistogram::Snapshot::Percentile(double fraction) const noexcept
+{
+   uint64_t total = 0;
+   for (auto binCount : counts)
+      total += binCount;
+   if (total == 0)
+      return 0;
+   const auto target = static_cast<uint64_t>(
+      std::ceil(std::clamp(fraction, 0.0, 1.0) * total));
+   uint64_t cumulative = 0;
+   for (size_t ii = 0; ii < BinsCount; ++ii) {
+      cumulative += counts[ii];
+      if (cumulative >= std::max<uint64_t>(1, target))
+         // No value seen exceeds the maximum
+         return std::min(BinUpper(ii) - 1, max);
+   }
+   return max;
+}
@@ -0,0 +1,86 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file AtomicHistogram.h
+  @brief Counts of values in fixed bins, which any thread may add to
+  without locks
+
+**********************************************************************/
+
+#ifndef __AUDACITY_ATOMIC_HISTOGRAM__
+#define __AUDACITY_ATOMIC_HISTOGRAM__
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+//! A distribution of unsigned values, cheap enough to update from a realtime
+//! thread, and readable at any time by other threads
+/*!
+ Add() neither allocates nor waits.  A snapshot taken while values are added
+ may be inconsistent by the few most recent values, which is acceptable for
+ instrumentation.
+ */
+class UTILITY_API AtomicHistogram final
+{
+public:
+   static constexpr size_t BinsCount = 32;
+
+   enum class Scale {
+      //! Bin 0 holds 0, bin k holds [2^(k-1), 2^k), for durations and sizes
+      Logarithmic,
+      //! Bin k holds [k * width, (k + 1) * width), for fractions of a whole
+      Linear,
+   };
+
+   //! The last bin holds also all greater values
+   /*! @param width for linear scale only; at least 1 */
+   explicit AtomicHistogram(
+      Scale scale = Scale::Logarithmic, uint64_t width = 1) noexcept;
+
+   AtomicHistogram(const AtomicHistogram&) = delete;
+   AtomicHistogram &operator=(const AtomicHistogram&) = delete;
+
+   //! May be called concurrently from any threads
+   void Add(uint64_t value) noexcept;
+
+   //! Forget all values; some of those added concurrently may persist
+   void Reset() noexcept;
+
+   size_t BinIndex(uint64_t value) const noexcept;
+
+   struct UTILITY_API Snapshot {
+      Scale scale{ Scale::Logarithmic };
+      uint64_t width{ 1 };
+      std::array<uint64_t, BinsCount> counts{};
+      uint64_t count{ 0 };
+      uint64_t sum{ 0 };
+      uint64_t max{ 0 };
+
+      //! Least value in the bin
+      uint64_t BinLower(size_t iBin) const noexcept;
+      //! Value just past the bin; for the last bin, the greatest value seen
+      //! plus one
+      uint64_t BinUpper(size_t iBin) const noexcept;
+
+      double Mean() const noexcept;
+      //! An upper estimate of the given quantile, such as 0.99
+      /*! @return 0 if there are no values */
+      uint64_t Percentile(double fraction) const noexcept;
+   };
+
+   Snapshot GetSnapshot() const noexcept;
+
+private:
+   const Scale mScale;
+   const uint64_t mWidth;
+   std::array<std::atomic<uint64_t>, BinsCount> mCounts{};
+   std::atomic<uint64_t> mCount{ 0 };
+   std::atomic<uint64_t> mSum{ 0 };
+   std::atomic<uint64_t> mMax{ 0 };
+};
+
+#endif
@@ -52,6 +52,33 @@ size_t BufferedStreamReader::Read(void* buffer, size_t maxBytes)
    return bytesWritten;
 }
 
+std::pair<const void*, size_t> BufferedStreamReader::ReadView(size_t size)
+{
+   if (size > mBufferSize)
+      return { nullptr, 0 };
+
+   if (mCurrentBytes - mCurrentIndex < size)
+   {
+      // Keep the buffered bytes, and read the rest after them
+      std::memmove(
+         mBufferStart, mBufferStart + mCurrentIndex,
+         mCurrentBytes - mCurrentIndex);
+      mCurrentBytes -= mCurrentIndex;
+      mCurrentIndex = 0;
+
+      while (mCurrentBytes < size && HasMoreData())
+         mCurrentBytes += ReadData(
+            mBufferStart + mCurrentBytes, mBufferSize - mCurrentBytes);
+   }
+
+   const auto view = mBufferStart + mCurrentIndex;
+   const auto bytesRead = std::min(size, mCurrentBytes - mCurrentIndex);
+
+   mCurrentIndex += bytesRead;
+
+   return { view, bytesRead };
+}
+
 bool BufferedStreamReader::Eof() const
 {
    return mCurrentBytes == mCurrentIndex && !HasMoreData();
@@ -14,6 +14,7 @@
 #include <cstddef>
 #include <cstdint>
 #include <type_traits>
+#include <utility>
 
 /*!
  * \brief A facade-like class, that implements buffered reading from the underlying data stream.
@@ -53,6 +54,16 @@ public:
       return true;
    }
 
+   //! Borrow the next size bytes from the buffer, without copying them
+   /*!
+    Fewer buffered bytes are moved to the start of the buffer first, if the
+    rest must be read.
+    @return a view valid until the next read, shorter than size only at the
+    end of the data; or a null view, reading nothing, if size exceeds the
+    buffer size
+    */
+   std::pair<const void*, size_t> ReadView(size_t size);
+
    //! Returns true if there is no more data available
    bool Eof() const;
 
@@ -0,0 +1,199 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file MemoryBudget.cpp
+
+**********************************************************************/
+
+#include "MemoryBudget.h"
+#include "AppEvents.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#elif defined(__APPLE__)
+#include <sys/sysctl.h>
+#include <sys/types.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+
+uint64_t PhysicalMemory()
+{
+#if defined(_WIN32)
+   MEMORYSTATUSEX status{};
+   status.dwLength = sizeof(status);
+   if (GlobalMemoryStatusEx(&status))
+      return status.ullTotalPhys;
+   return 0;
+#elif defined(__APPLE__)
+   uint64_t result = 0;
+   size_t size = sizeof(result);
+   if (sysctlbyname("hw.memsize", &result, &size, nullptr, 0) == 0)
+      return result;
+   return 0;
+#else
+   const auto pages = sysconf(_SC_PHYS_PAGES);
+   const auto pageSize = sysconf(_SC_PAGE_SIZE);
+   if (pages > 0 && pageSize > 0)
+      return uint64_t(pages) * uint64_t(pageSize);
+   return 0;
+#endif
+}
+
+std::atomic<size_t> &Budget()
+{
+   static std::atomic<size_t> budget{ size_t(std::min<uint64_t>(
+      PhysicalMemory() / 8, std::numeric_limits<size_t>::max())) };
+   return budget;
+}
+
+}
+
+namespace MemoryBudget {
+
+struct Registry {
+   static Registry &Get()
+   {
+      static Registry registry;
+      return registry;
+   }
+
+   Registry()
+      // Because AppEvents has its own static state, constructed first, this
+      // subscription is destroyed before that state is
+      : mSubscription{ AppEvents::OnAppIdle([]{ Get().OnIdle(); }) }
+   {
+   }
+
+   void Add(Consumer &consumer)
+   {
+      std::lock_guard lock{ mMutex };
+      // Keep the order of increasing cost, and of registration for equal cost
+      const auto pos = std::upper_bound(mConsumers.begin(), mConsumers.end(),
+         consumer.mCost, [](int cost, const Consumer *pConsumer){
+            return cost < pConsumer->mCost; });
+      mConsumers.insert(pos, &consumer);
+   }
+
+   void Remove(Consumer &consumer)
+   {
+      std::lock_guard lock{ mMutex };
+      const auto end = mConsumers.end();
+      if (const auto pos = std::find(mConsumers.begin(), end, &consumer);
+         pos != end)
+         mConsumers.erase(pos);
+   }
+
+   void OnIdle()
+   {
+      const auto now = std::chrono::steady_clock::now();
+      if (now - mLastIdle < std::chrono::seconds{ 1 })
+         return;
+      mLastIdle = now;
+      Enforce();
+   }
+
+   Report Enforce()
+   {
+      std::lock_guard lock{ mMutex };
+      size_t total = 0;
+      for (auto pConsumer : mConsumers) {
+         pConsumer->mBytes = pConsumer->mMeasurer ? pConsumer->mMeasurer() : 0;
+         total += pConsumer->mBytes;
+      }
+
+      // Free more than the excess, so that eviction is not done again at
+      // each idle time as the caches refill
+      if (const auto budget = Budget().load(); budget > 0 && total > budget) {
+         ++mEnforcements;
+         const auto goal = budget - budget / 4;
+         for (auto pConsumer : mConsumers) {
+            if (total <= goal)
+               break;
+            if (!pConsumer->mEvictor || pConsumer->mBytes == 0)
+               continue;
+            const auto freed = std::min(pConsumer->mBytes,
+               pConsumer->mEvictor(total - goal));
+            pConsumer->mBytes -= freed;
+            pConsumer->mEvicted += freed;
+            total -= freed;
+         }
+      }
+      return MakeReport();
+   }
+
+   Report GetReport()
+   {
+      std::lock_guard lock{ mMutex };
+      return MakeReport();
+   }
+
+private:
+   Report MakeReport() const
+   {
+      Report report{ Budget().load(), 0, mEnforcements, {} };
+      report.usages.reserve(mConsumers.size());
+      for (auto pConsumer : mConsumers) {
+         report.total += pConsumer->mBytes;
+         report.usages.push_back({ pConsumer->mName, pConsumer->mBytes,
+            pConsumer->mEvicted, bool(pConsumer->mEvictor) });
+      }
+      return report;
+   }
+
+   std::mutex mMutex;
+   std::vector<Consumer*> mConsumers;
+   size_t mEnforcements{ 0 };
+   std::chrono::steady_clock::time_point mLastIdle{};
+   Observer::Subscription mSubscription;
+};
+
+Consumer::Consumer(
+   const char *name, int cost, Measurer measurer, Evictor evictor)
+   : mName{ name }
+   , mCost{ cost }
+   , mMeasurer{ std::move(measurer) }
+   , mEvictor{ std::move(evictor) }
+{
+   Registry::Get().Add(*this);
+}
+
+Consumer::~Consumer()
+{
+   Registry::Get().Remove(*this);
+}
+
+size_t GetBudget()
+{
+   return Budget().load();
+}
+
+void SetBudget(size_t bytes)
+{
+   Budget().store(bytes);
+}
+
+Report Enforce()
+{
+   return Registry::Get().Enforce();
+}
+
+Report GetReport()
+{
+   return Registry::Get().GetReport();
+}
+
+}
@@ -0,0 +1,96 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file MemoryBudget.h
+  @brief One limit for the memory of all caches, and measurements of them
+
+**********************************************************************/
+
+#ifndef __AUDACITY_MEMORY_BUDGET__
+#define __AUDACITY_MEMORY_BUDGET__
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+//! Measures the memory that caches and other holders register, and frees
+//! some of the cheapest to rebuild, when the total exceeds a budget
+/*!
+ Each kind of holder registers one Consumer, usually statically, with
+ functions to measure all its instances, and maybe to evict from them by its
+ own policy.
+
+ Enforce() measures all consumers and evicts from them in order of
+ increasing cost, until the total is within three quarters of the budget.
+ It is done in the main thread at idle time, at most once a second, and the
+ measuring and evicting functions are called only then.
+ */
+namespace MemoryBudget {
+
+class UTILITY_API Consumer final {
+public:
+   //! Bytes held now, by all instances of the kind
+   using Measurer = std::function<size_t()>;
+   //! Free at least the given bytes, if possible
+   //! @return bytes freed
+   using Evictor = std::function<size_t(size_t bytes)>;
+
+   /*!
+    @param name for diagnostics; must outlive the consumer, as string literals
+    do
+    @param cost consumers of lesser cost are evicted first
+    @param evictor if null, the consumer is only measured
+    */
+   Consumer(const char *name, int cost, Measurer measurer,
+      Evictor evictor = {});
+   Consumer(const Consumer &) = delete;
+   Consumer &operator=(const Consumer &) = delete;
+   ~Consumer();
+
+private:
+   friend struct Registry;
+   const char *const mName;
+   const int mCost;
+   const Measurer mMeasurer;
+   const Evictor mEvictor;
+   size_t mBytes{ 0 };
+   size_t mEvicted{ 0 };
+};
+
+struct Usage {
+   const char *name;
+   //! At the last measurement
+   size_t bytes;
+   //! Bytes freed by all evictions
+   size_t evicted;
+   bool evictable;
+};
+
+struct Report {
+   //! 0 when there is no budget
+   size_t budget;
+   size_t total;
+   //! Evictions done
+   size_t enforcements;
+   //! In order of increasing cost
+   std::vector<Usage> usages;
+};
+
+//! 0 when there is no budget; by default, an eighth of the physical memory, if
+//! that is known
+UTILITY_API size_t GetBudget();
+UTILITY_API void SetBudget(size_t bytes);
+
+//! Measure all consumers, then evict from them, if the total exceeds the
+//! budget
+/*! Main thread only */
+UTILITY_API Report Enforce();
+
+//! Results of the last Enforce(), without measuring again
+UTILITY_API Report GetReport();
+
+}
+
+#endif
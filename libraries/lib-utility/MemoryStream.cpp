@@ -11,6 +11,7 @@
 #include "MemoryStream.h"
 
 #include <algorithm>
+#include <cassert>
 
 void MemoryStream::Clear()
 {
@@ -37,8 +38,37 @@ void MemoryStream::AppendData(const void* data, const size_t length)
    mDataSize += length;
 }
 
+void* MemoryStream::Reserve(size_t length)
+{
+   assert(length <= MaxSpan);
+
+   if (mChunks.empty() || ChunkSize - mChunks.back().BytesUsed < length)
+      mChunks.emplace_back();
+
+   auto& chunk = mChunks.back();
+
+   return chunk.Data.data() + chunk.BytesUsed;
+}
+
+void MemoryStream::Commit(size_t length) noexcept
+{
+   if (length == 0)
+      return;
+
+   auto& chunk = mChunks.back();
+
+   assert(chunk.BytesUsed + length <= ChunkSize);
+
+   chunk.BytesUsed += length;
+   mDataSize += length;
+}
+
 const void* MemoryStream::GetData() const
 {
+   // One chunk is linear already
+   if (mLinearData.empty() && mChunks.size() == 1)
+      return mChunks.front().Data.data();
+
    if (!mChunks.empty())
    {
       const size_t desiredSize = GetSize();
@@ -51,6 +51,8 @@ private:
    using ChunksList = std::list<Chunk>;
 
 public:
+   //! The longest span that Reserve() can give
+   static constexpr size_t MaxSpan = ChunkSize;
 
    MemoryStream() = default;
    MemoryStream(MemoryStream&&) = default;
@@ -60,8 +62,20 @@ public:
    void AppendByte(char data);
    void AppendData(const void* data, const size_t length);
 
+   //! Get length contiguous bytes at the end of the stream, to be written in
+   //! place instead of copied by AppendData()
+   /*!
+    The bytes are not a part of the stream until Commit(). A new chunk is
+    started, if the last one has less room.
+    @pre length <= MaxSpan
+    */
+   void* Reserve(size_t length);
+   //! Append the first length bytes at the result of the last Reserve()
+   /*! @pre length does not exceed the length last reserved */
+   void Commit(size_t length) noexcept;
+
    // This function possibly has O(size) complexity as it may
-   // require copying bytes to a linear chunk
+   // require copying bytes to a linear chunk, unless all the data is in one
    const void* GetData() const;
    const size_t GetSize() const noexcept;
 
@@ -0,0 +1,122 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file ObjectPool.cpp
+
+**********************************************************************/
+#include "ObjectPool.h"
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+#include "spinlock.h"
+
+namespace {
+constexpr size_t SlabSize = 64 * 1024;
+constexpr size_t ClassCount = ObjectPool::MaxSize / ObjectPool::Granularity;
+
+struct SizeClass {
+   struct Node {
+      Node *next;
+   };
+
+   spinlock lock;
+   Node *free{ nullptr };
+   std::vector<std::unique_ptr<std::max_align_t[]>> slabs;
+};
+
+//! Never destroyed, so that objects destroyed late in the exit of the
+//! process may still return their blocks
+SizeClass &GetClass(size_t index)
+{
+   static const auto classes = new SizeClass[ClassCount];
+   return classes[index];
+}
+
+std::atomic<size_t> sReserved{ 0 };
+std::atomic<size_t> sUsed{ 0 };
+
+bool IsPooled(size_t size, size_t alignment)
+{
+   return size <= ObjectPool::MaxSize &&
+      alignment <= alignof(std::max_align_t);
+}
+
+size_t ClassIndex(size_t size)
+{
+   return size == 0 ? 0 : (size - 1) / ObjectPool::Granularity;
+}
+
+//! Call with the lock of the class held
+void AddSlab(SizeClass &sizeClass, size_t blockSize)
+{
+   auto &slab = sizeClass.slabs.emplace_back(
+      std::make_unique<std::max_align_t[]>(
+         SlabSize / sizeof(std::max_align_t)));
+   const auto bytes = reinterpret_cast<std::byte*>(slab.get());
+   // Link blocks in address order
+   for (size_t offset = SlabSize - SlabSize % blockSize; offset > 0;) {
+      offset -= blockSize;
+      const auto node = reinterpret_cast<SizeClass::Node*>(bytes + offset);
+      node->next = sizeClass.free;
+      sizeClass.free = node;
+   }
+   sReserved.fetch_add(SlabSize, std::memory_order_relaxed);
+}
+}
+
+namespace ObjectPool {
+
+void *Allocate(size_t size, size_t alignment)
+{
+   if (!IsPooled(size, alignment)) {
+      if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+         return ::operator new(size, std::align_val_t{ alignment });
+      return ::operator new(size);
+   }
+
+   const auto index = ClassIndex(size);
+   const auto blockSize = (index + 1) * Granularity;
+   auto &sizeClass = GetClass(index);
+   std::lock_guard<spinlock> lock{ sizeClass.lock };
+   if (!sizeClass.free)
+      AddSlab(sizeClass, blockSize);
+   const auto node = sizeClass.free;
+   sizeClass.free = node->next;
+   sUsed.fetch_add(blockSize, std::memory_order_relaxed);
+   return node;
+}
+
+void Deallocate(void *p, size_t size, size_t alignment) noexcept
+{
+   if (!p)
+      return;
+
+   if (!IsPooled(size, alignment)) {
+      if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+         ::operator delete(p, std::align_val_t{ alignment });
+      else
+         ::operator delete(p);
+      return;
+   }
+
+   const auto index = ClassIndex(size);
+   auto &sizeClass = GetClass(index);
+   const auto node = static_cast<SizeClass::Node*>(p);
+   {
+      std::lock_guard<spinlock> lock{ sizeClass.lock };
+      node->next = sizeClass.free;
+      sizeClass.free = node;
+   }
+   sUsed.fetch_sub((index + 1) * Granularity, std::memory_order_relaxed);
+}
+
+Statistics GetStatistics() noexcept
+{
+   return { sReserved.load(std::memory_order_relaxed),
+      sUsed.load(std::memory_order_relaxed) };
+}
+}
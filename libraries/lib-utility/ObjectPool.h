@@ -0,0 +1,84 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file ObjectPool.h
+  @brief Free lists of small blocks, for objects that edits create and
+  destroy by the thousands
+
+**********************************************************************/
+
+#ifndef __AUDACITY_OBJECT_POOL__
+#define __AUDACITY_OBJECT_POOL__
+
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <new>
+
+//! Storage of small objects in size classes, whose freed blocks are reused
+/*!
+ Each size class takes its blocks from slabs, which are kept until the
+ process exits, so that the heap does not fragment with the churn of many
+ short lived objects.  Blocks may be freed by any thread.  Larger or more
+ aligned requests go to the global operator new.
+ */
+namespace ObjectPool {
+
+//! Size classes are multiples of this
+constexpr size_t Granularity = 16;
+//! Larger requests aren't pooled
+constexpr size_t MaxSize = 2048;
+
+//! @return storage of at least size bytes with the given alignment
+/*! @throws std::bad_alloc */
+UTILITY_API void *Allocate(size_t size, size_t alignment);
+
+//! @pre p came from Allocate() with the same size and alignment
+UTILITY_API void Deallocate(void *p, size_t size, size_t alignment) noexcept;
+
+struct Statistics {
+   //! Bytes of slabs
+   size_t reserved{ 0 };
+   //! Bytes of blocks given out and not freed
+   size_t used{ 0 };
+};
+
+UTILITY_API Statistics GetStatistics() noexcept;
+
+//! Allocator for standard containers and std::allocate_shared
+template<typename T> struct Allocator {
+   using value_type = T;
+
+   Allocator() = default;
+   template<typename U> Allocator(const Allocator<U>&) noexcept {}
+
+   T *allocate(size_t n)
+   {
+      if (n > std::numeric_limits<size_t>::max() / sizeof(T))
+         throw std::bad_array_new_length{};
+      return static_cast<T*>(Allocate(n * sizeof(T), alignof(T)));
+   }
+
+   void deallocate(T *p, size_t n) noexcept
+   {
+      Deallocate(p, n * sizeof(T), alignof(T));
+   }
+
+   template<typename U> bool operator ==(const Allocator<U>&) const noexcept
+   { return true; }
+   template<typename U> bool operator !=(const Allocator<U>&) const noexcept
+   { return false; }
+};
+
+//! Like std::make_shared, with the object and its count in one pooled block
+template<typename T, typename... Args>
+std::shared_ptr<T> MakeShared(Args&&... args)
+{
+   return std::allocate_shared<T>(
+      Allocator<T>{}, std::forward<Args>(args)...);
+}
+}
+
+#endif
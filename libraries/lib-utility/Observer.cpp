@@ -52,8 +52,9 @@ Subscription RecordList::Subscribe(std::shared_ptr<RecordBase> pRecord)
 bool RecordList::Visit(const void *arg)
 {
    assert(m_visitor); // See constructor
-   if (m_pPolicy)
-      m_pPolicy->OnBeginPublish();
+   if (!m_pPolicy)
+      return VisitWithoutPolicy(arg);
+   m_pPolicy->OnBeginPublish();
    bool result = false;
    for (auto pRecord = next; pRecord; pRecord = pRecord->next) {
       try {
@@ -66,18 +67,35 @@ bool RecordList::Visit(const void *arg)
          // the callback, because they are earlier in the list.
       }
       catch (...) {
-         if (m_pPolicy && m_pPolicy->OnEachFailedCallback()) {
+         if (m_pPolicy->OnEachFailedCallback()) {
             result = true;
             break;
          }
       }
    }
    // Intentionally not in a finally():
-   if (m_pPolicy)
-      m_pPolicy->OnEndPublish();
+   m_pPolicy->OnEndPublish();
    return result;
 }
 
+bool RecordList::VisitWithoutPolicy(const void *arg)
+{
+   // Most publishers, often with no subscribers at all
+   if (!next)
+      return false;
+   for (auto pRecord = next; pRecord; pRecord = pRecord->next) {
+      try {
+         if (m_visitor(*pRecord, arg))
+            return true;
+         // See Visit about removal of pRecord
+      }
+      catch (...) {
+         // Ignored, as documented for Publisher without a policy
+      }
+   }
+   return false;
+}
+
 }
 
 ExceptionPolicy::~ExceptionPolicy() noexcept = default;
@@ -14,6 +14,7 @@
 #include <cassert>
 #include <functional>
 #include <memory>
+#include <optional>
 #include <type_traits>
 
 namespace Observer {
@@ -61,6 +62,9 @@ struct UTILITY_API RecordList
    Subscription Subscribe(std::shared_ptr<RecordBase> pRecord);
    bool Visit(const void *arg);
 private:
+   //! Visit without calls to an exception policy, when there is none
+   bool VisitWithoutPolicy(const void *arg);
+
    ExceptionPolicy *const m_pPolicy;
    const Visitor m_visitor;
 };
@@ -212,6 +216,72 @@ auto Publisher<Message, NotifyAll>::Publish(const Message &message)
       return result;
 }
 
+//! A Publisher that merges the messages posted before the next Flush() into
+//! one, so that events firing many times per UI frame reach callbacks once
+/*!
+ The owner arranges the Flush(), such as with BasicUI::CallAfter, when Post()
+ returns true.  Publish() remains available for messages that can't wait.
+
+ @tparam Message must be copy constructible
+ */
+template<typename Message = Message>
+class CoalescingPublisher : public Publisher<Message, true> {
+public:
+   //! Type of functions making one message of a pending and a later one
+   using Merge = std::function<Message(const Message &pending,
+      const Message &message)>;
+
+   //! @param merge if null, the later message replaces the pending one
+   template<typename Alloc = std::allocator<typename Publisher<Message>::Record>>
+   explicit CoalescingPublisher(Merge merge = {},
+      ExceptionPolicy *pPolicy = nullptr, Alloc a = {})
+      : Publisher<Message, true>{ pPolicy, move(a) }
+      , m_merge{ move(merge) }
+   {}
+
+   CoalescingPublisher(CoalescingPublisher&&) = default;
+   CoalescingPublisher& operator=(CoalescingPublisher&&) = default;
+
+   //! Whether a message waits for Flush()
+   bool IsPending() const { return m_pending.has_value(); }
+
+protected:
+   //! Merge a message into the pending one
+   /*! @return whether no message was pending, so Flush() must be arranged */
+   bool Post(const Message &message)
+   {
+      if (!m_pending) {
+         m_pending.emplace(message);
+         return true;
+      }
+      if (m_merge) {
+         auto merged = m_merge(*m_pending, message);
+         m_pending.reset();
+         m_pending.emplace(std::move(merged));
+      }
+      else {
+         m_pending.reset();
+         m_pending.emplace(message);
+      }
+      return false;
+   }
+
+   //! Publish the pending message, if any
+   /*! Callbacks may Post() again, for a later Flush() */
+   void Flush()
+   {
+      if (!m_pending)
+         return;
+      const Message message{ std::move(*m_pending) };
+      m_pending.reset();
+      this->Publish(message);
+   }
+
+private:
+   std::optional<Message> m_pending;
+   Merge m_merge;
+};
+
 }
 
 #endif
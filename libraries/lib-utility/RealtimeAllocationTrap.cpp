@@ -0,0 +1,141 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file RealtimeAllocationTrap.cpp
+
+**********************************************************************/
+#include "RealtimeAllocationTrap.h"
+
+#include <atomic>
+#include <cassert>
+#include <cstdlib>
+#include <new>
+
+namespace RealtimeAllocationTrap {
+namespace {
+thread_local int sDepth = 0;
+std::atomic<size_t> sTrappedCount{ 0 };
+}
+
+Scope::Scope() noexcept
+{
+   ++sDepth;
+}
+
+Scope::~Scope() noexcept
+{
+   --sDepth;
+}
+
+Exemption::Exemption() noexcept
+   : mSavedDepth{ sDepth }
+{
+   sDepth = 0;
+}
+
+Exemption::~Exemption() noexcept
+{
+   sDepth = mSavedDepth;
+}
+
+bool IsTrapping() noexcept
+{
+   return sDepth > 0;
+}
+
+bool IsEnabled() noexcept
+{
+#if defined(AUDACITY_TRAP_REALTIME_ALLOCATIONS) && defined(__ELF__)
+   return true;
+#else
+   return false;
+#endif
+}
+
+size_t TrappedCount() noexcept
+{
+   return sTrappedCount.load(std::memory_order_relaxed);
+}
+
+#if defined(AUDACITY_TRAP_REALTIME_ALLOCATIONS) && defined(__ELF__)
+namespace {
+void Trap() noexcept
+{
+   if (sDepth <= 0)
+      return;
+   sTrappedCount.fetch_add(1, std::memory_order_relaxed);
+   // Don't trap again while failing the assertion
+   Exemption exemption;
+   assert(!"Heap allocation in a realtime scope");
+}
+
+void *Allocate(std::size_t size) noexcept
+{
+   Trap();
+   return std::malloc(size ? size : 1);
+}
+}
+#endif
+}
+
+#if defined(AUDACITY_TRAP_REALTIME_ALLOCATIONS) && defined(__ELF__)
+// Replacements of the global allocation functions.  The ELF dynamic linker
+// binds every module's references to the first definition it finds, and this
+// library is loaded before the C++ runtime library.  Two-level namespaces on
+// macOS and import libraries on Windows give no such interposition, so there
+// the trap stays disabled.  Over-aligned forms are not replaced.
+
+void *operator new(std::size_t size)
+{
+   if (auto p = RealtimeAllocationTrap::Allocate(size))
+      return p;
+   throw std::bad_alloc{};
+}
+
+void *operator new[](std::size_t size)
+{
+   return operator new(size);
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+   return RealtimeAllocationTrap::Allocate(size);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept
+{
+   return RealtimeAllocationTrap::Allocate(size);
+}
+
+void operator delete(void *p) noexcept
+{
+   std::free(p);
+}
+
+void operator delete[](void *p) noexcept
+{
+   std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept
+{
+   std::free(p);
+}
+
+void operator delete[](void *p, std::size_t) noexcept
+{
+   std::free(p);
+}
+
+void operator delete(void *p, const std::nothrow_t &) noexcept
+{
+   std::free(p);
+}
+
+void operator delete[](void *p, const std::nothrow_t &) noexcept
+{
+   std::free(p);
+}
+#endif
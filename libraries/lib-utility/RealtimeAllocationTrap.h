@@ -0,0 +1,58 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file RealtimeAllocationTrap.h
+  @brief Detection of heap allocation by threads with deadlines
+
+**********************************************************************/
+
+#ifndef __AUDACITY_REALTIME_ALLOCATION_TRAP__
+#define __AUDACITY_REALTIME_ALLOCATION_TRAP__
+
+#include <cstddef>
+
+/*!
+ Scopes mark code, such as the audio callback, that must not allocate from
+ the heap.  Only in builds configured with the trap_realtime_allocations
+ option, and only on ELF platforms such as Linux, is the global operator new
+ replaced, so that allocation in such a scope is counted, and is an assertion
+ failure in debug builds.  Otherwise the scopes cost only a thread-local
+ increment.
+ */
+namespace RealtimeAllocationTrap {
+
+//! While it exists, heap allocation by this thread is trapped
+class UTILITY_API Scope final {
+public:
+   Scope() noexcept;
+   ~Scope() noexcept;
+   Scope(const Scope&) = delete;
+   Scope &operator=(const Scope&) = delete;
+};
+
+//! While it exists, heap allocation by this thread is allowed again, as for
+//! a path that is known to wait anyway
+class UTILITY_API Exemption final {
+public:
+   Exemption() noexcept;
+   ~Exemption() noexcept;
+   Exemption(const Exemption&) = delete;
+   Exemption &operator=(const Exemption&) = delete;
+private:
+   int mSavedDepth;
+};
+
+//! Whether this thread is in a Scope and not in an Exemption
+UTILITY_API bool IsTrapping() noexcept;
+
+//! Whether operator new was replaced in this build
+UTILITY_API bool IsEnabled() noexcept;
+
+//! Number of trapped allocations by all threads, since the program started
+UTILITY_API size_t TrappedCount() noexcept;
+
+}
+
+#endif
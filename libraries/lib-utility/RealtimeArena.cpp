@@ -0,0 +1,50 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file RealtimeArena.cpp
+
+**********************************************************************/
+#include "RealtimeArena.h"
+
+RealtimeArena::RealtimeArena() = default;
+RealtimeArena::~RealtimeArena() = default;
+
+void RealtimeArena::Reserve(size_t bytes)
+{
+   Release();
+   const auto count =
+      (bytes + sizeof(std::max_align_t) - 1) / sizeof(std::max_align_t);
+   if (count > 0)
+      mStorage = std::make_unique<std::max_align_t[]>(count);
+   mCapacity = count * sizeof(std::max_align_t);
+}
+
+void RealtimeArena::Release() noexcept
+{
+   mStorage.reset();
+   mCapacity = 0;
+   mUsed = 0;
+   mHighWater.store(0, std::memory_order_relaxed);
+   mFailures.store(0, std::memory_order_relaxed);
+}
+
+void *RealtimeArena::Allocate(size_t bytes, size_t alignment) noexcept
+{
+   // Alignment is a power of two, not more than that of the storage
+   if (alignment == 0 || alignment > alignof(std::max_align_t) ||
+       (alignment & (alignment - 1)) != 0) {
+      mFailures.fetch_add(1, std::memory_order_relaxed);
+      return nullptr;
+   }
+   const auto start = (mUsed + alignment - 1) & ~(alignment - 1);
+   if (start > mCapacity || bytes > mCapacity - start) {
+      mFailures.fetch_add(1, std::memory_order_relaxed);
+      return nullptr;
+   }
+   mUsed = start + bytes;
+   if (mUsed > mHighWater.load(std::memory_order_relaxed))
+      mHighWater.store(mUsed, std::memory_order_relaxed);
+   return reinterpret_cast<unsigned char*>(mStorage.get()) + start;
+}
@@ -0,0 +1,76 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file RealtimeArena.h
+  @brief Preallocated memory for threads that must not use the heap
+
+**********************************************************************/
+
+#ifndef __AUDACITY_REALTIME_ARENA__
+#define __AUDACITY_REALTIME_ARENA__
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+//! Storage reserved ahead of time, from which a realtime thread takes
+//! temporary blocks in constant time, all of them released together
+/*!
+ Reserve() and Release() are for a thread that may allocate, while no
+ realtime thread uses the arena.  Allocate() and Reset() are then for one
+ realtime thread at a time.
+ */
+class UTILITY_API RealtimeArena final
+{
+public:
+   RealtimeArena();
+   ~RealtimeArena();
+
+   RealtimeArena(const RealtimeArena&) = delete;
+   RealtimeArena &operator=(const RealtimeArena&) = delete;
+
+   //! Replace the storage with at least the given number of bytes
+   /*! @post `Used() == 0` */
+   void Reserve(size_t bytes);
+   //! Free the storage
+   void Release() noexcept;
+
+   size_t Capacity() const noexcept { return mCapacity; }
+   size_t Used() const noexcept { return mUsed; }
+
+   //! @return null, if there isn't enough room left
+   void *Allocate(size_t bytes,
+      size_t alignment = alignof(std::max_align_t)) noexcept;
+
+   //! Uninitialized room for count objects of trivial type T
+   template<typename T> T *Allocate(size_t count) noexcept
+   {
+      return static_cast<T*>(Allocate(count * sizeof(T), alignof(T)));
+   }
+
+   //! Release all blocks allocated since Reserve() or the last Reset()
+   void Reset() noexcept { mUsed = 0; }
+
+   //! Greatest use since Reserve(); may be read from any thread
+   size_t HighWater() const noexcept
+   {
+      return mHighWater.load(std::memory_order_relaxed);
+   }
+   //! Number of failed allocations since Reserve(); may be read from any
+   //! thread
+   size_t Failures() const noexcept
+   {
+      return mFailures.load(std::memory_order_relaxed);
+   }
+
+private:
+   std::unique_ptr<std::max_align_t[]> mStorage;
+   size_t mCapacity{ 0 };
+   size_t mUsed{ 0 };
+   std::atomic<size_t> mHighWater{ 0 };
+   std::atomic<size_t> mFailures{ 0 };
+};
+
+#endif
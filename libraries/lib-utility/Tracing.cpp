@@ -0,0 +1,203 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file Tracing.cpp
+
+**********************************************************************/
+
+#include "Tracing.h"
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+namespace {
+struct Event {
+   const char *name;
+   uint64_t begin;
+   uint64_t end;
+};
+
+struct ThreadBuffer {
+   ThreadBuffer(std::string name, uint64_t id)
+      : name{ move(name) }, id{ id }
+   {}
+
+   //! Call with the registry locked
+   void Allocate()
+   {
+      if (!storage) {
+         storage = std::make_unique<Event[]>(Tracing::EventsPerThread);
+         events.store(storage.get(), std::memory_order_release);
+      }
+   }
+
+   const std::string name;
+   const uint64_t id;
+   //! Set once, and not freed while the process runs
+   std::unique_ptr<Event[]> storage;
+   std::atomic<Event*> events{ nullptr };
+   //! Written only by the thread
+   std::atomic<size_t> count{ 0 };
+};
+
+struct Registry {
+   std::mutex mutex;
+   //! Buffers outlive their threads, so that events of workers that are
+   //! done can be written
+   std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+   uint64_t start{ 0 };
+};
+
+Registry &GetRegistry()
+{
+   static Registry registry;
+   return registry;
+}
+
+thread_local ThreadBuffer *tBuffer = nullptr;
+
+//! Call with the registry locked
+ThreadBuffer &AddBuffer(Registry &registry, std::string name)
+{
+   const auto id = registry.buffers.size() + 1;
+   if (name.empty())
+      name = "Thread " + std::to_string(id);
+   auto &buffer = *registry.buffers.emplace_back(
+      std::make_unique<ThreadBuffer>(move(name), id));
+   if (Tracing::IsRecording())
+      buffer.Allocate();
+   return buffer;
+}
+
+void WriteString(std::ostream &stream, const std::string &string)
+{
+   stream << '"';
+   for (const auto c : string) {
+      if (c == '"' || c == '\\')
+         stream << '\\' << c;
+      else if (static_cast<unsigned char>(c) < 0x20)
+         stream << ' ';
+      else
+         stream << c;
+   }
+   stream << '"';
+}
+
+//! Chrome traces are in microseconds
+void WriteMicroseconds(std::ostream &stream, uint64_t nanoseconds)
+{
+   const auto fraction = nanoseconds % 1000;
+   stream << nanoseconds / 1000 << '.'
+      << char('0' + fraction / 100)
+      << char('0' + fraction / 10 % 10)
+      << char('0' + fraction % 10);
+}
+}
+
+namespace Tracing {
+
+std::atomic<bool> detail::recording{ false };
+
+uint64_t Now() noexcept
+{
+   using namespace std::chrono;
+   static const auto origin = steady_clock::now();
+   return duration_cast<nanoseconds>(steady_clock::now() - origin).count();
+}
+
+void Start()
+{
+   auto &registry = GetRegistry();
+   std::lock_guard<std::mutex> lock{ registry.mutex };
+   for (const auto &pBuffer : registry.buffers)
+      pBuffer->Allocate();
+   registry.start = Now();
+   detail::recording.store(true, std::memory_order_release);
+}
+
+void Stop()
+{
+   detail::recording.store(false, std::memory_order_release);
+}
+
+void RegisterThread(const std::string &name)
+{
+   if (tBuffer)
+      return;
+   auto &registry = GetRegistry();
+   std::lock_guard<std::mutex> lock{ registry.mutex };
+   tBuffer = &AddBuffer(registry, name);
+}
+
+void Record(const char *name, uint64_t begin, uint64_t end) noexcept
+{
+   auto pBuffer = tBuffer;
+   auto events = pBuffer
+      ? pBuffer->events.load(std::memory_order_acquire) : nullptr;
+   if (!events) {
+      // An unregistered thread, or recording began as it registered
+      try {
+         auto &registry = GetRegistry();
+         std::lock_guard<std::mutex> lock{ registry.mutex };
+         if (!pBuffer)
+            pBuffer = tBuffer = &AddBuffer(registry, {});
+         pBuffer->Allocate();
+         events = pBuffer->storage.get();
+      }
+      catch (...) {
+         return;
+      }
+   }
+   const auto count = pBuffer->count.load(std::memory_order_relaxed);
+   events[count % EventsPerThread] = { name, begin, end };
+   pBuffer->count.store(count + 1, std::memory_order_release);
+}
+
+void WriteChromeTrace(std::ostream &stream)
+{
+   auto &registry = GetRegistry();
+   std::lock_guard<std::mutex> lock{ registry.mutex };
+   stream << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+   bool first = true;
+   auto separate = [&]{
+      if (!first)
+         stream << ",";
+      first = false;
+      stream << "\n";
+   };
+   for (const auto &pBuffer : registry.buffers) {
+      separate();
+      stream << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+         << pBuffer->id << ",\"args\":{\"name\":";
+      WriteString(stream, pBuffer->name);
+      stream << "}}";
+
+      const auto events = pBuffer->events.load(std::memory_order_acquire);
+      if (!events)
+         continue;
+      const auto count = pBuffer->count.load(std::memory_order_acquire);
+      for (auto ii = count - std::min(count, EventsPerThread);
+           ii < count; ++ii) {
+         const auto &event = events[ii % EventsPerThread];
+         if (event.begin < registry.start)
+            continue;
+         separate();
+         stream << "{\"name\":";
+         WriteString(stream, event.name);
+         stream << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << pBuffer->id
+            << ",\"ts\":";
+         WriteMicroseconds(stream, event.begin);
+         stream << ",\"dur\":";
+         WriteMicroseconds(stream, event.end - event.begin);
+         stream << "}";
+      }
+   }
+   stream << "\n]}\n";
+}
+}
@@ -0,0 +1,96 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file Tracing.h
+  @brief Timed scopes, recorded per thread, for viewing what all threads did
+  on one timeline
+
+**********************************************************************/
+
+#ifndef __AUDACITY_TRACING__
+#define __AUDACITY_TRACING__
+
+#include <atomic>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+
+//! Recording of timed scopes from any threads, written in the Chrome trace
+//! event format, which Perfetto and chrome://tracing also read
+/*!
+ When not recording, a scope costs one relaxed atomic load.  When recording,
+ it costs two readings of the clock and one store into a buffer of the
+ thread, without locks.  Each buffer keeps the most recent events.
+
+ A thread that calls RegisterThread() gets a name in the trace, and its
+ buffer is allocated then, or by Start(), so that recording in it never
+ allocates.  Other threads allocate their buffer at their first event while
+ recording.
+ */
+namespace Tracing {
+
+//! Events each thread keeps, of 24 bytes each
+constexpr size_t EventsPerThread = 1 << 16;
+
+//! Nanoseconds since an origin fixed for the process
+UTILITY_API uint64_t Now() noexcept;
+
+namespace detail {
+extern UTILITY_API std::atomic<bool> recording;
+}
+
+inline bool IsRecording() noexcept
+{
+   return detail::recording.load(std::memory_order_relaxed);
+}
+
+//! Begin recording, leaving out events of earlier recordings
+UTILITY_API void Start();
+
+//! Stop recording; events finishing concurrently may still be recorded
+UTILITY_API void Stop();
+
+//! Name the calling thread in traces
+/*! Call at the start of a thread, where allocation is allowed */
+UTILITY_API void RegisterThread(const std::string &name);
+
+//! Record an event of the calling thread
+/*! @param name must outlive all writing of traces, as string literals do */
+UTILITY_API void Record(
+   const char *name, uint64_t begin, uint64_t end) noexcept;
+
+//! Write the events recorded since Start() as a JSON object
+/*! Stop() first; events recorded while writing may be inconsistent */
+UTILITY_API void WriteChromeTrace(std::ostream &stream);
+
+//! Records the time from its construction to its destruction, while
+//! recording
+class Scope final {
+public:
+   //! @param name must outlive all writing of traces, as string literals do
+   explicit Scope(const char *name) noexcept
+      : mName{ IsRecording() ? name : nullptr }
+      , mBegin{ mName ? Now() : 0 }
+   {}
+   Scope(const Scope&) = delete;
+   Scope &operator=(const Scope&) = delete;
+   ~Scope()
+   {
+      if (mName)
+         Record(mName, mBegin, Now());
+   }
+private:
+   const char *const mName;
+   const uint64_t mBegin;
+};
+}
+
+#define TRACING_CONCATENATE_DETAIL(a, b) a ## b
+#define TRACING_CONCATENATE(a, b) TRACING_CONCATENATE_DETAIL(a, b)
+//! Trace the rest of the enclosing block, under a string literal name
+#define TRACE_SCOPE(name) \
+   const Tracing::Scope TRACING_CONCATENATE(tracingScope, __LINE__){ name }
+
+#endif
@@ -0,0 +1,77 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  AtomicHistogramTest.cpp
+
+**********************************************************************/
+#include <catch2/catch.hpp>
+
+#include "AtomicHistogram.h"
+
+#include <thread>
+#include <vector>
+
+TEST_CASE("AtomicHistogram")
+{
+   SECTION("Logarithmic bins")
+   {
+      AtomicHistogram histogram;
+      REQUIRE(histogram.BinIndex(0) == 0);
+      REQUIRE(histogram.BinIndex(1) == 1);
+      REQUIRE(histogram.BinIndex(2) == 2);
+      REQUIRE(histogram.BinIndex(3) == 2);
+      REQUIRE(histogram.BinIndex(1024) == 11);
+      REQUIRE(histogram.BinIndex(~uint64_t{}) ==
+         AtomicHistogram::BinsCount - 1);
+
+      for (uint64_t value : { 0, 1, 3, 100, 100, 5000 })
+         histogram.Add(value);
+      const auto snapshot = histogram.GetSnapshot();
+      REQUIRE(snapshot.count == 6);
+      REQUIRE(snapshot.sum == 5204);
+      REQUIRE(snapshot.max == 5000);
+      REQUIRE(snapshot.counts[histogram.BinIndex(100)] == 2);
+      REQUIRE(snapshot.BinLower(7) == 64);
+      REQUIRE(snapshot.BinUpper(7) == 128);
+      // The median falls in the bin of 3, whose upper estimate is 3
+      REQUIRE(snapshot.Percentile(0.5) == 3);
+      REQUIRE(snapshot.Percentile(0.8) == 127);
+      REQUIRE(snapshot.Percentile(1.0) == 5000);
+
+      histogram.Reset();
+      REQUIRE(histogram.GetSnapshot().count == 0);
+      REQUIRE(histogram.GetSnapshot().Percentile(0.5) == 0);
+   }
+
+   SECTION("Linear bins")
+   {
+      AtomicHistogram histogram{ AtomicHistogram::Scale::Linear, 5 };
+      REQUIRE(histogram.BinIndex(4) == 0);
+      REQUIRE(histogram.BinIndex(5) == 1);
+      REQUIRE(histogram.BinIndex(100) == 20);
+      REQUIRE(histogram.BinIndex(1000) == AtomicHistogram::BinsCount - 1);
+      histogram.Add(50);
+      const auto snapshot = histogram.GetSnapshot();
+      REQUIRE(snapshot.BinLower(10) == 50);
+      REQUIRE(snapshot.BinUpper(10) == 55);
+      REQUIRE(snapshot.Mean() == 50.0);
+   }
+
+   SECTION("Concurrent additions are all counted")
+   {
+      AtomicHistogram histogram;
+      std::vector<std::thread> threads;
+      for (int ii = 0; ii < 4; ++ii)
+         threads.emplace_back([&histogram, ii]{
+            for (uint64_t jj = 0; jj < 10000; ++jj)
+               histogram.Add(jj * (ii + 1));
+         });
+      for (auto &thread : threads)
+         thread.join();
+      const auto snapshot = histogram.GetSnapshot();
+      REQUIRE(snapshot.count == 40000);
+      REQUIRE(snapshot.max == 9999 * 4);
+   }
+}
@@ -0,0 +1,97 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  MemoryBudgetTest.cpp
+
+**********************************************************************/
+#include <catch2/catch.hpp>
+
+#include "MemoryBudget.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+namespace {
+struct FakeCache {
+   size_t bytes{ 0 };
+   std::vector<size_t> requests;
+
+   size_t Evict(size_t wanted)
+   {
+      requests.push_back(wanted);
+      const auto freed = std::min(bytes, wanted);
+      bytes -= freed;
+      return freed;
+   }
+};
+}
+
+TEST_CASE("MemoryBudget")
+{
+   const auto oldBudget = MemoryBudget::GetBudget();
+   FakeCache cheap, dear, fixed;
+   MemoryBudget::Consumer dearConsumer{ "dear", 2,
+      [&]{ return dear.bytes; }, [&](size_t n){ return dear.Evict(n); } };
+   MemoryBudget::Consumer cheapConsumer{ "cheap", 1,
+      [&]{ return cheap.bytes; }, [&](size_t n){ return cheap.Evict(n); } };
+   MemoryBudget::Consumer fixedConsumer{ "fixed", 0,
+      [&]{ return fixed.bytes; } };
+
+   SECTION("Consumers are reported in order of cost")
+   {
+      MemoryBudget::SetBudget(0);
+      cheap.bytes = 100;
+      dear.bytes = 200;
+      fixed.bytes = 50;
+      const auto report = MemoryBudget::Enforce();
+      REQUIRE(report.total == 350);
+      REQUIRE(report.usages.size() == 3);
+      REQUIRE(std::string{ report.usages[0].name } == "fixed");
+      REQUIRE(!report.usages[0].evictable);
+      REQUIRE(std::string{ report.usages[1].name } == "cheap");
+      REQUIRE(std::string{ report.usages[2].name } == "dear");
+      REQUIRE(cheap.requests.empty());
+      REQUIRE(dear.requests.empty());
+   }
+
+   SECTION("Cheapest consumers are evicted first, to three quarters")
+   {
+      MemoryBudget::SetBudget(400);
+      cheap.bytes = 200;
+      dear.bytes = 300;
+      fixed.bytes = 50;
+      auto report = MemoryBudget::Enforce();
+      // 550 bytes, to be reduced to 300
+      REQUIRE(cheap.requests == std::vector<size_t>{ 250 });
+      REQUIRE(dear.requests == std::vector<size_t>{ 50 });
+      REQUIRE(cheap.bytes == 0);
+      REQUIRE(dear.bytes == 250);
+      REQUIRE(report.total == 300);
+      REQUIRE(report.usages[1].evicted == 200);
+      REQUIRE(report.usages[2].evicted == 50);
+
+      // Within the budget, nothing more is evicted
+      cheap.bytes = 50;
+      report = MemoryBudget::Enforce();
+      REQUIRE(report.total == 350);
+      REQUIRE(cheap.requests.size() == 1);
+      REQUIRE(dear.requests.size() == 1);
+      REQUIRE(MemoryBudget::GetReport().total == 350);
+   }
+
+   SECTION("Unregistered consumers are not measured")
+   {
+      MemoryBudget::SetBudget(0);
+      {
+         MemoryBudget::Consumer temporary{ "temporary", 0, []{
+            return size_t{ 1000 }; } };
+         REQUIRE(MemoryBudget::Enforce().total == 1000);
+      }
+      REQUIRE(MemoryBudget::Enforce().total == 0);
+   }
+
+   MemoryBudget::SetBudget(oldBudget);
+}
@@ -0,0 +1,129 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  MemoryStreamTest.cpp
+
+**********************************************************************/
+#include <catch2/catch.hpp>
+
+#include "BufferedStreamReader.h"
+#include "MemoryStream.h"
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+
+namespace {
+std::vector<uint8_t> Gather(const MemoryStream& stream)
+{
+   std::vector<uint8_t> result;
+   for (auto [data, size] : stream)
+   {
+      const auto begin = static_cast<const uint8_t*>(data);
+      result.insert(result.end(), begin, begin + size);
+   }
+   return result;
+}
+
+class VectorReader final : public BufferedStreamReader
+{
+public:
+   VectorReader(std::vector<uint8_t> data, size_t bufferSize, size_t readSize)
+       : BufferedStreamReader { bufferSize }
+       , mData { std::move(data) }
+       , mReadSize { readSize }
+   {
+   }
+
+protected:
+   bool HasMoreData() const override
+   {
+      return mOffset < mData.size();
+   }
+
+   size_t ReadData(void* buffer, size_t maxBytes) override
+   {
+      // Short reads, as the blob streams of a project may give
+      const auto count =
+         std::min({ maxBytes, mReadSize, mData.size() - mOffset });
+      std::memcpy(buffer, mData.data() + mOffset, count);
+      mOffset += count;
+      return count;
+   }
+
+private:
+   std::vector<uint8_t> mData;
+   size_t mReadSize;
+   size_t mOffset { 0 };
+};
+}
+
+TEST_CASE("MemoryStream spans")
+{
+   MemoryStream stream;
+
+   stream.AppendData("abc", 3);
+
+   auto span = static_cast<char*>(stream.Reserve(5));
+   std::memcpy(span, "defgh", 5);
+   // Only a part of the reserved span is used
+   stream.Commit(2);
+
+   REQUIRE(stream.GetSize() == 5);
+   // One chunk is returned without copying
+   REQUIRE(stream.GetData() == (*stream.begin()).first);
+   REQUIRE(std::memcmp(stream.GetData(), "abcde", 5) == 0);
+
+   // A span that doesn't fit the last chunk starts another
+   std::fill_n(
+      static_cast<uint8_t*>(stream.Reserve(MemoryStream::MaxSpan)),
+      MemoryStream::MaxSpan, 7);
+   stream.Commit(MemoryStream::MaxSpan);
+   stream.AppendByte('z');
+
+   const auto data = Gather(stream);
+   REQUIRE(data.size() == 5 + MemoryStream::MaxSpan + 1);
+   REQUIRE(std::equal(data.begin(), data.begin() + 5, "abcde"));
+   REQUIRE(std::all_of(
+      data.begin() + 5, data.end() - 1, [](uint8_t c) { return c == 7; }));
+   REQUIRE(data.back() == 'z');
+
+   REQUIRE(std::memcmp(stream.GetData(), data.data(), data.size()) == 0);
+}
+
+TEST_CASE("BufferedStreamReader views")
+{
+   std::vector<uint8_t> data(1000);
+   std::iota(data.begin(), data.end(), 0);
+
+   VectorReader reader { data, 64, 10 };
+
+   uint8_t value;
+   REQUIRE(reader.ReadValue(value));
+   REQUIRE(value == 0);
+
+   // Longer than what was read at once
+   auto [view, size] = reader.ReadView(30);
+   REQUIRE(size == 30);
+   REQUIRE(std::equal(
+      static_cast<const uint8_t*>(view),
+      static_cast<const uint8_t*>(view) + size, data.begin() + 1));
+
+   // Longer than the buffer; nothing is read
+   std::tie(view, size) = reader.ReadView(65);
+   REQUIRE(view == nullptr);
+   REQUIRE(reader.GetC() == 31);
+
+   std::vector<uint8_t> rest(1000);
+   rest.resize(reader.Read(rest.data(), rest.size() - 40));
+   REQUIRE(rest.size() == 1000 - 40);
+   REQUIRE(std::equal(rest.begin(), rest.end(), data.begin() + 32));
+
+   // The end of the data
+   std::tie(view, size) = reader.ReadView(64);
+   REQUIRE(size == 8);
+   REQUIRE(static_cast<const uint8_t*>(view)[7] == uint8_t(999));
+   REQUIRE(reader.Eof());
+}
@@ -0,0 +1,66 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  ObjectPoolTest.cpp
+
+**********************************************************************/
+#include <catch2/catch.hpp>
+
+#include "ObjectPool.h"
+
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+TEST_CASE("ObjectPool")
+{
+   SECTION("Freed blocks are reused")
+   {
+      const auto p = ObjectPool::Allocate(40, 8);
+      ObjectPool::Deallocate(p, 40, 8);
+      // The same size class
+      const auto q = ObjectPool::Allocate(48, 8);
+      REQUIRE(q == p);
+      ObjectPool::Deallocate(q, 48, 8);
+   }
+
+   SECTION("Statistics")
+   {
+      const auto before = ObjectPool::GetStatistics();
+      std::vector<void*> blocks;
+      for (int ii = 0; ii < 10000; ++ii)
+         blocks.push_back(ObjectPool::Allocate(100, 8));
+      const auto during = ObjectPool::GetStatistics();
+      REQUIRE(during.used == before.used + 10000 * 112);
+      REQUIRE(during.reserved >= during.used);
+      for (auto p : blocks)
+         ObjectPool::Deallocate(p, 100, 8);
+      REQUIRE(ObjectPool::GetStatistics().used == before.used);
+   }
+
+   SECTION("Large and overaligned requests")
+   {
+      const auto before = ObjectPool::GetStatistics();
+      const auto big = ObjectPool::Allocate(ObjectPool::MaxSize + 1, 8);
+      struct alignas(64) Aligned { char c; };
+      const auto aligned =
+         ObjectPool::Allocator<Aligned>{}.allocate(1);
+      REQUIRE(reinterpret_cast<uintptr_t>(aligned) % 64 == 0);
+      REQUIRE(ObjectPool::GetStatistics().used == before.used);
+      ObjectPool::Allocator<Aligned>{}.deallocate(aligned, 1);
+      ObjectPool::Deallocate(big, ObjectPool::MaxSize + 1, 8);
+   }
+
+   SECTION("Containers and shared objects, freed by other threads")
+   {
+      std::vector<int, ObjectPool::Allocator<int>> values(100, 7);
+      auto pValues = ObjectPool::MakeShared<decltype(values)>(values);
+      REQUIRE(pValues->size() == 100);
+      std::thread{ [pValues = std::move(pValues)]() mutable {
+         pValues.reset();
+      } }.join();
+      REQUIRE(values.back() == 7);
+   }
+}
@@ -0,0 +1,107 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  ObserverTest.cpp
+
+**********************************************************************/
+#include <catch2/catch.hpp>
+
+#include "Observer.h"
+
+#include <vector>
+
+namespace {
+struct Sum {
+   int value;
+};
+
+struct ThrowingPublisher : Observer::Publisher<Sum> {
+   using Publisher::Publish;
+};
+
+struct SumPublisher : Observer::CoalescingPublisher<Sum> {
+   SumPublisher()
+      : CoalescingPublisher{ [](const Sum &pending, const Sum &message) {
+         return Sum{ pending.value + message.value };
+      } }
+   {}
+   using CoalescingPublisher::Post;
+   using CoalescingPublisher::Flush;
+   using CoalescingPublisher::Publish;
+};
+}
+
+TEST_CASE("Publisher without a policy ignores exceptions")
+{
+   ThrowingPublisher publisher;
+   std::vector<int> received;
+   auto first = publisher.Subscribe([&](const Sum &sum){
+      received.push_back(sum.value);
+   });
+   auto second = publisher.Subscribe([](const Sum &){
+      throw 0;
+   });
+   publisher.Publish({ 1 });
+   REQUIRE(received == std::vector<int>{ 1 });
+}
+
+TEST_CASE("CoalescingPublisher")
+{
+   SumPublisher publisher;
+   std::vector<int> received;
+   auto subscription = publisher.Subscribe([&](const Sum &sum){
+      received.push_back(sum.value);
+   });
+
+   SECTION("Posts before a flush make one message")
+   {
+      REQUIRE(publisher.Post({ 1 }));
+      REQUIRE(!publisher.Post({ 2 }));
+      REQUIRE(!publisher.Post({ 3 }));
+      REQUIRE(publisher.IsPending());
+      REQUIRE(received.empty());
+      publisher.Flush();
+      REQUIRE(received == std::vector<int>{ 6 });
+      REQUIRE(!publisher.IsPending());
+      publisher.Flush();
+      REQUIRE(received.size() == 1);
+   }
+
+   SECTION("Publish does not wait")
+   {
+      publisher.Post({ 1 });
+      publisher.Publish({ 10 });
+      publisher.Flush();
+      REQUIRE(received == std::vector<int>{ 10, 1 });
+   }
+
+   SECTION("Callbacks may post for the next flush")
+   {
+      auto reposting = publisher.Subscribe([&](const Sum &sum){
+         if (sum.value < 3)
+            publisher.Post({ sum.value + 1 });
+      });
+      publisher.Post({ 1 });
+      publisher.Flush();
+      REQUIRE(publisher.IsPending());
+      publisher.Flush();
+      REQUIRE(received == std::vector<int>{ 1, 2 });
+   }
+
+   SECTION("The latest message replaces the pending one without a merge")
+   {
+      struct LatestPublisher : Observer::CoalescingPublisher<Sum> {
+         using CoalescingPublisher::Post;
+         using CoalescingPublisher::Flush;
+      } latest;
+      auto latestSubscription = latest.Subscribe([&](const Sum &sum){
+         received.push_back(sum.value);
+      });
+      latest.Post({ 1 });
+      latest.Post({ 2 });
+      latest.Flush();
+      REQUIRE(received == std::vector<int>{ 2 });
+   }
+}
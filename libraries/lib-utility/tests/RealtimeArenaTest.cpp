@@ -0,0 +1,83 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  RealtimeArenaTest.cpp
+
+**********************************************************************/
+#include <catch2/catch.hpp>
+
+#include "RealtimeArena.h"
+#include "RealtimeAllocationTrap.h"
+
+#include <cstdint>
+
+TEST_CASE("RealtimeArena")
+{
+   RealtimeArena arena;
+   REQUIRE(arena.Allocate<float>(1) == nullptr);
+   REQUIRE(arena.Failures() == 1);
+
+   arena.Reserve(1000);
+   REQUIRE(arena.Capacity() >= 1000);
+   REQUIRE(arena.Failures() == 0);
+
+   SECTION("Blocks are aligned and distinct")
+   {
+      const auto pChar = arena.Allocate<char>(3);
+      const auto pDouble = arena.Allocate<double>(4);
+      const auto pFloat = arena.Allocate<float>(5);
+      REQUIRE(pChar);
+      REQUIRE(pDouble);
+      REQUIRE(pFloat);
+      REQUIRE(reinterpret_cast<std::uintptr_t>(pDouble) % alignof(double)
+         == 0);
+      REQUIRE(reinterpret_cast<char*>(pDouble) >= pChar + 3);
+      REQUIRE(reinterpret_cast<char*>(pFloat) >=
+         reinterpret_cast<char*>(pDouble + 4));
+      REQUIRE(arena.Used() >= 3 + 4 * sizeof(double) + 5 * sizeof(float));
+   }
+
+   SECTION("Exhaustion fails without side effects")
+   {
+      const auto used = arena.Used();
+      REQUIRE(arena.Allocate<char>(arena.Capacity() + 1) == nullptr);
+      REQUIRE(arena.Used() == used);
+      REQUIRE(arena.Failures() == 1);
+      REQUIRE(arena.Allocate<char>(arena.Capacity()) != nullptr);
+   }
+
+   SECTION("Reset releases all blocks")
+   {
+      const auto p1 = arena.Allocate<int>(10);
+      arena.Allocate<int>(10);
+      const auto highWater = arena.Used();
+      arena.Reset();
+      REQUIRE(arena.Used() == 0);
+      REQUIRE(arena.Allocate<int>(10) == p1);
+      REQUIRE(arena.HighWater() == highWater);
+   }
+
+   SECTION("Bad alignment fails")
+   {
+      REQUIRE(arena.Allocate(8, 3) == nullptr);
+      REQUIRE(arena.Allocate(8, 2 * alignof(std::max_align_t)) == nullptr);
+   }
+}
+
+TEST_CASE("RealtimeAllocationTrap scopes")
+{
+   using namespace RealtimeAllocationTrap;
+   REQUIRE(!IsTrapping());
+   {
+      Scope scope;
+      REQUIRE(IsTrapping());
+      {
+         Exemption exemption;
+         REQUIRE(!IsTrapping());
+      }
+      REQUIRE(IsTrapping());
+   }
+   REQUIRE(!IsTrapping());
+}
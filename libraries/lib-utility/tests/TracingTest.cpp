@@ -0,0 +1,72 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  TracingTest.cpp
+
+**********************************************************************/
+#include <catch2/catch.hpp>
+
+#include "Tracing.h"
+
+#include <sstream>
+#include <thread>
+
+namespace {
+size_t Count(const std::string &string, const std::string &part)
+{
+   size_t result = 0;
+   for (auto pos = string.find(part); pos != std::string::npos;
+        pos = string.find(part, pos + 1))
+      ++result;
+   return result;
+}
+}
+
+TEST_CASE("Tracing")
+{
+   Tracing::RegisterThread("Main \"test\"");
+   {
+      TRACE_SCOPE("Before start");
+   }
+
+   Tracing::Start();
+   {
+      TRACE_SCOPE("Outer");
+      TRACE_SCOPE("Inner");
+   }
+   std::thread{ []{
+      Tracing::RegisterThread("Worker");
+      TRACE_SCOPE("Task");
+   } }.join();
+   // Not registered, named when it records
+   std::thread{ []{ TRACE_SCOPE("Anonymous"); } }.join();
+   Tracing::Stop();
+   {
+      TRACE_SCOPE("After stop");
+   }
+
+   std::ostringstream stream;
+   Tracing::WriteChromeTrace(stream);
+   const auto trace = stream.str();
+   REQUIRE(Count(trace, "\"ph\":\"X\"") == 4);
+   REQUIRE(Count(trace, "\"Outer\"") == 1);
+   REQUIRE(Count(trace, "\"Inner\"") == 1);
+   REQUIRE(Count(trace, "\"Task\"") == 1);
+   REQUIRE(Count(trace, "\"Anonymous\"") == 1);
+   REQUIRE(Count(trace, "Before start") == 0);
+   REQUIRE(Count(trace, "After stop") == 0);
+   REQUIRE(Count(trace, "\"thread_name\"") == 3);
+   REQUIRE(Count(trace, "\"Main \\\"test\\\"\"") == 1);
+   REQUIRE(Count(trace, "\"Worker\"") == 1);
+   REQUIRE(Count(trace, "\"Thread 3\"") == 1);
+   REQUIRE(trace.front() == '{');
+
+   // Events of an earlier recording are left out
+   Tracing::Start();
+   Tracing::Stop();
+   std::ostringstream again;
+   Tracing::WriteChromeTrace(again);
+   REQUIRE(Count(again.str(), "\"ph\":\"X\"") == 0);
+}
@@ -18,6 +18,7 @@ Paul Licameli split from ProjectWindow.cpp
 #include "UndoManager.h"
 #include "ViewInfo.h"
 
+#include <limits>
 #include <numeric>
 
 ViewportCallbacks::~ViewportCallbacks() = default;
@@ -41,11 +42,20 @@ const Viewport &Viewport::Get(const AudacityProject &project)
 }
 
 Viewport::Viewport(AudacityProject &project)
-   : mProject{ project }
+   : CoalescingPublisher{ [](const ViewportMessage &pending,
+      const ViewportMessage &message) {
+         return ViewportMessage{ pending.rescroll || message.rescroll,
+            pending.scrollbarVisibilityChanged ||
+               message.scrollbarVisibilityChanged,
+            pending.resize || message.resize };
+      } }
+   , mProject{ project }
    , mSnappingChangedSubscription{
       ProjectSnap::Get(project).Subscribe([this](auto&){ Redraw(); }) }
    , mUndoSubscription{
       UndoManager::Get(project).Subscribe([this](UndoRedoMessage message){
+         // Any change of the tracks may have been completed
+         mLastTrackTime.reset();
          switch (message.type) {
          case UndoRedoMessage::Pushed:
          case UndoRedoMessage::Modified:
@@ -58,6 +68,16 @@ Viewport::Viewport(AudacityProject &project)
             return;
          }
       }) }
+   , mTrackListSubscription{
+      TrackList::Get(project).Subscribe([this](const TrackListEvent &event){
+         switch (event.mType) {
+         case TrackListEvent::SELECTION_CHANGE:
+         case TrackListEvent::RESIZING:
+            break;
+         default:
+            mLastTrackTime.reset();
+         }
+      }) }
 {
 }
 
@@ -275,14 +295,8 @@ void Viewport::UpdateScrollbarsForTracks()
    const bool oldhstate = (viewInfo.GetScreenEndTime() - viewInfo.hpos) < total;
    const bool oldvstate = panelHeight < totalHeight;
 
-   auto &pendingTracks = PendingTracks::Get(mProject);
-   const auto LastTime = std::accumulate(tracks.begin(), tracks.end(),
-      viewInfo.selectedRegion.t1(),
-      [&pendingTracks](double acc, const Track *track){
-         // Iterate over pending changed tracks if present.
-         track = &pendingTracks.SubstitutePendingChangedTrack(*track);
-         return std::max(acc, track->GetEndTime());
-      });
+   const auto LastTime =
+      std::max(viewInfo.selectedRegion.t1(), GetLastTrackTime());
 
    const double screen = viewInfo.GetScreenEndTime() - viewInfo.hpos;
    const double halfScreen = screen / 2.0;
@@ -386,12 +400,37 @@ void Viewport::UpdateScrollbarsForTracks()
       (oldhstate != newhstate || oldvstate != newvstate), false });
 }
 
+double Viewport::GetLastTrackTime()
+{
+   if (mLastTrackTime)
+      return *mLastTrackTime;
+   auto &tracks = TrackList::Get(mProject);
+   auto &pendingTracks = PendingTracks::Get(mProject);
+   const auto lastTime = std::accumulate(tracks.begin(), tracks.end(),
+      -std::numeric_limits<double>::infinity(),
+      [&pendingTracks](double acc, const Track *track){
+         // Iterate over pending changed tracks if present.
+         track = &pendingTracks.SubstitutePendingChangedTrack(*track);
+         return std::max(acc, track->GetEndTime());
+      });
+   // Pending tracks, as in recording, grow without notifications
+   if (!pendingTracks.HasPendingTracks())
+      mLastTrackTime = lastTime;
+   return lastTime;
+}
+
 void Viewport::HandleResize()
+{
+   if (Post({ false, false, true }))
+      FlushWhenIdle();
+}
+
+void Viewport::FlushWhenIdle()
 {
    BasicUI::CallAfter( [wthis = weak_from_this()]{
       if (auto This = wthis.lock()) {
          This->UpdateScrollbarsForTracks();
-         This->Publish({ false, false, true });
+         This->Flush();
       }
    });
 }
@@ -457,32 +496,27 @@ void Viewport::ShowTrack(const Track &track)
 {
    auto &viewInfo = ViewInfo::Get(mProject);
 
-   int trackTop = 0;
-   int trackHeight = 0;
-   for (auto it : TrackList::Get(mProject)) {
-      trackTop += trackHeight;
-      trackHeight = mpCallbacks ? mpCallbacks->GetTrackHeight(*it) : 0;
-
-      if (it == &track) {
-         //We have found the track we want to ensure is visible.
-
-         //Get the size of the trackpanel.
-         const auto size =
-            mpCallbacks ? mpCallbacks->ViewportSize() : std::pair{ 1, 1 };
-         auto [width, height] = size;
-
-         if (trackTop < viewInfo.vpos) {
-            height = viewInfo.vpos - trackTop + scrollStep;
-            height /= scrollStep;
-            ScrollUpDown(-height);
-         }
-         else if (trackTop + trackHeight > viewInfo.vpos + height) {
-            height = (trackTop + trackHeight) - (viewInfo.vpos + height);
-            height = (height + scrollStep + 1) / scrollStep;
-            ScrollUpDown(height);
-         }
-
-         break;
+   // The positions of tracks are sums of heights that are kept up to date,
+   // so there is no need to visit the tracks above
+   if (track.GetOwner().get() == &TrackList::Get(mProject)) {
+      const auto trackTop = mpCallbacks ? mpCallbacks->GetTrackTop(track) : 0;
+      const auto trackHeight =
+         mpCallbacks ? mpCallbacks->GetTrackHeight(track) : 0;
+
+      //Get the size of the trackpanel.
+      const auto size =
+         mpCallbacks ? mpCallbacks->ViewportSize() : std::pair{ 1, 1 };
+      auto [width, height] = size;
+
+      if (trackTop < viewInfo.vpos) {
+         height = viewInfo.vpos - trackTop + scrollStep;
+         height /= scrollStep;
+         ScrollUpDown(-height);
+      }
+      else if (trackTop + trackHeight > viewInfo.vpos + height) {
+         height = (trackTop + trackHeight) - (viewInfo.vpos + height);
+         height = (height + scrollStep + 1) / scrollStep;
+         ScrollUpDown(height);
       }
    }
 
@@ -750,12 +784,8 @@ void Viewport::Redraw()
 {
    // Delay it until after channel views update their Y coordinates in response
    // to TrackList mesages
-   BasicUI::CallAfter([wthis = weak_from_this()]{
-      if (auto This = wthis.lock()) {
-         This->UpdateScrollbarsForTracks();
-         This->Publish({ true, false, false });
-      }
-   });
+   if (Post({ true, false, false }))
+      FlushWhenIdle();
 }
 
 void Viewport::SetToDefaultSize()
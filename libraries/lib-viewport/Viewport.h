@@ -14,6 +14,8 @@ Paul Licameli split from ProjectWindow.h
 #include "ClientData.h"
 #include "Observer.h"
 
+#include <optional>
+
 class AudacityProject;
 class Track;
 class TrackList;
@@ -30,6 +32,8 @@ public:
    virtual bool IsTrackMinimized(const Track &track) = 0;
    virtual void SetMinimized(Track &track, bool minimized) = 0;
    virtual int GetTrackHeight(const Track &track) = 0;
+   //! Sum of the heights of the tracks above the given one
+   virtual int GetTrackTop(const Track &track) = 0;
    virtual void SetChannelHeights(Track &track, unsigned height) = 0;
    virtual int GetTotalHeight(const TrackList &trackList) = 0;
 
@@ -59,7 +63,7 @@ struct ViewportMessage {
 };
 
 class VIEWPORT_API Viewport final
-   : public Observer::Publisher<ViewportMessage>
+   : public Observer::CoalescingPublisher<ViewportMessage>
    , public ClientData::Base
    , public std::enable_shared_from_this<Viewport>
 {
@@ -167,10 +171,14 @@ public:
    //! and sometimes rescroll to the top or left and repaint the whole view
    void UpdateScrollbarsForTracks();
 
+   //! Update scrollbars and publish a resize, when idle; calls of this and
+   //! Redraw() before then make one update
    void HandleResize();
 
    void ReinitScrollbars() { mbInitializingScrollbar = true; }
 
+   //! Update scrollbars and publish a rescroll, when idle; calls of this and
+   //! HandleResize() before then make one update
    void Redraw();
 
    //! Send a message to the main window PARENT of the viewport, to resize
@@ -182,6 +190,10 @@ private:
    double PixelWidthBeforeTime(double scrollto) const;
 
    void FinishAutoScroll();
+   //! Latest end time of the tracks, cached until they change
+   double GetLastTrackTime();
+   //! Arrange to update scrollbars and publish the pending message
+   void FlushWhenIdle();
 
    void OnUndoPushedModified();
    void OnUndoRedo();
@@ -193,8 +205,12 @@ private:
    const Observer::Subscription
         mSnappingChangedSubscription
       , mUndoSubscription
+      , mTrackListSubscription
    ;
 
+   //! Valid while there are no pending tracks and no changes of tracks
+   std::optional<double> mLastTrackTime;
+
    double total{ 1.0 };                // total width in secs
 
    // Current horizontal scroll bar positions, in pixels
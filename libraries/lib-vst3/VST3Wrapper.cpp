@@ -556,8 +556,18 @@ void VST3Wrapper::InitializeComponents()
    if(!SetupProcessing(*mEffectComponent, mSetup))
       throw std::runtime_error("bus configuration not supported");
 
-   mParameterQueues = std::make_unique<SingleInputParameterValue[]>(mEditController->getParameterCount());
-   mParameters.reserve(mEditController->getParameterCount());
+   CacheBusLayout();
+
+   const auto parameterCount = mEditController->getParameterCount();
+   mParameterQueues = std::make_unique<SingleInputParameterValue[]>(parameterCount);
+   mParameters.reserve(parameterCount);
+   mPendingPositions.assign(parameterCount, -1);
+   for(int32 i = 0; i < parameterCount; ++i)
+   {
+      Vst::ParameterInfo parameterInfo { };
+      if(mEditController->getParameterInfo(i, parameterInfo) == kResultOk)
+         mParameterIndices[parameterInfo.id] = i;
+   }
 
    Steinberg::MemoryStream stateStream;
    if(mEffectComponent->getState(&stateStream) == kResultOk)
@@ -756,6 +766,7 @@ bool VST3Wrapper::Initialize(EffectSettings& settings, Steinberg::Vst::SampleRat
       return false;
 
    mSetup = setup;
+   CacheBusLayout();
 
    FetchSettings(settings);
 
@@ -805,6 +816,20 @@ void VST3Wrapper::ConsumeChanges(const EffectSettings& settings)
    const auto& vst3settings = GetSettings(settings);
    for(auto& p : vst3settings.parameterChanges)
    {
+      if(auto index = mParameterIndices.find(p.first); index != mParameterIndices.end())
+      {
+         auto& position = mPendingPositions[index->second];
+         if(position < 0)
+         {
+            //Within reserved capacity
+            position = static_cast<int>(mParameters.size());
+            mParameters.push_back(p);
+         }
+         else
+            mParameters[position].second = p.second;
+         continue;
+      }
+      //Not listed by the controller, unlikely
       auto it = std::find_if(mParameters.begin(), mParameters.end(), [&p](const auto& v) { return v.first == p.first; });
       if(it != mParameters.end())
          it->second = p.second;
@@ -813,6 +838,30 @@ void VST3Wrapper::ConsumeChanges(const EffectSettings& settings)
    }
 }
 
+void VST3Wrapper::CacheBusLayout()
+{
+   using namespace Steinberg;
+
+   mBusLayoutValid = true;
+   const auto cacheBuses = [this](Vst::BusDirection direction, auto& buses)
+   {
+      buses.resize(mEffectComponent->getBusCount(Vst::kAudio, direction));
+      for(int busIndex = 0; busIndex < static_cast<int>(buses.size()); ++busIndex)
+      {
+         auto& bus = buses[busIndex];
+         bus = { };
+         Vst::BusInfo busInfo { };
+         if(mEffectComponent->getBusInfo(Vst::kAudio, direction, busIndex, busInfo) != kResultOk)
+            mBusLayoutValid = false;
+         //aux is not yet supported
+         else if(busInfo.busType == Vst::kMain)
+            bus.numChannels = busInfo.channelCount;
+      }
+   };
+   cacheBuses(Vst::kInput, mInputBuses);
+   cacheBuses(Vst::kOutput, mOutputBuses);
+}
+
 //Used as a workaround for issue #2555: some plugins do not accept changes
 //via IEditController::setParamNormalized, but seem to read current
 //parameter values directly from the DSP model.
@@ -838,6 +887,7 @@ void VST3Wrapper::FlushParameters(EffectSettings& settings, bool* hasChanges)
          return;
 
       SetupProcessing(*mEffectComponent, mSetup);
+      CacheBusLayout();
       mActive = true;
       if(mEffectComponent->setActive(true) == Steinberg::kResultOk)
       {
@@ -862,8 +912,16 @@ size_t VST3Wrapper::Process(const float* const* inBlock, float* const* outBlock,
    using namespace Steinberg;
    
    InputParameterChanges inputParameterChanges(mParameters, mParameterQueues.get());
+   for(auto& p : mParameters)
+   {
+      if(auto index = mParameterIndices.find(p.first); index != mParameterIndices.end())
+         mPendingPositions[index->second] = -1;
+   }
    mParameters.clear();
 
+   if(!mBusLayoutValid)
+      return 0;
+
    Vst::ProcessData data;
    data.processMode = mSetup.processMode;
    data.symbolicSampleSize = mSetup.symbolicSampleSize;
@@ -878,65 +936,34 @@ size_t VST3Wrapper::Process(const float* const* inBlock, float* const* outBlock,
       static_cast<decltype(blockLen)>(mSetup.maxSamplesPerBlock)
    ));
 
-   data.numInputs = inBlock == nullptr ? 0 : mEffectComponent->getBusCount(Vst::kAudio, Vst::kInput);
-   data.numOutputs = outBlock == nullptr ? 0 : mEffectComponent->getBusCount(Vst::kAudio, Vst::kOutput);
+   data.numInputs = inBlock == nullptr ? 0 : static_cast<int32>(mInputBuses.size());
+   data.numOutputs = outBlock == nullptr ? 0 : static_cast<int32>(mOutputBuses.size());
 
    if(data.numInputs > 0)
    {
       int inputBlocksOffset {0};
-
-      data.inputs = static_cast<Vst::AudioBusBuffers*>(
-         alloca(sizeof(Vst::AudioBusBuffers) * data.numInputs));
-
-      for(int busIndex = 0; busIndex < data.numInputs; ++busIndex)
+      for(auto& bus : mInputBuses)
       {
-         Vst::BusInfo busInfo { };
-         if(mEffectComponent->getBusInfo(Vst::kAudio, Vst::kInput, busIndex, busInfo) != kResultOk)
-         {
-            return 0;
-         }
-         if(busInfo.busType == Vst::kMain)
-         {
-            data.inputs[busIndex].numChannels = busInfo.channelCount;
-            data.inputs[busIndex].channelBuffers32 = const_cast<float**>(inBlock + inputBlocksOffset);
-            inputBlocksOffset += busInfo.channelCount;
-         }
-         else
-         {
-            //aux is not yet supported
-            data.inputs[busIndex].numChannels = 0;
-            data.inputs[busIndex].channelBuffers32 = nullptr;
-         }
-         data.inputs[busIndex].silenceFlags = 0UL;
+         bus.channelBuffers32 = bus.numChannels > 0
+            ? const_cast<float**>(inBlock + inputBlocksOffset)
+            : nullptr;
+         inputBlocksOffset += bus.numChannels;
+         bus.silenceFlags = 0UL;
       }
+      data.inputs = mInputBuses.data();
    }
    if(data.numOutputs > 0)
    {
       int outputBlocksOffset {0};
-
-      data.outputs = static_cast<Vst::AudioBusBuffers*>(
-         alloca(sizeof(Vst::AudioBusBuffers) * data.numOutputs));
-      for(int busIndex = 0; busIndex < data.numOutputs; ++busIndex)
+      for(auto& bus : mOutputBuses)
       {
-         Vst::BusInfo busInfo { };
-         if(mEffectComponent->getBusInfo(Vst::kAudio, Vst::kOutput, busIndex, busInfo) != kResultOk)
-         {
-            return 0;
-         }
-         if(busInfo.busType == Vst::kMain)
-         {
-            data.outputs[busIndex].numChannels = busInfo.channelCount;
-            data.outputs[busIndex].channelBuffers32 = const_cast<float**>(outBlock + outputBlocksOffset);
-            outputBlocksOffset += busInfo.channelCount;
-         }
-         else
-         {
-            //aux is not yet supported
-            data.outputs[busIndex].numChannels = 0;
-            data.outputs[busIndex].channelBuffers32 = nullptr;
-         }
-         data.outputs[busIndex].silenceFlags = 0UL;
+         bus.channelBuffers32 = bus.numChannels > 0
+            ? const_cast<float**>(outBlock + outputBlocksOffset)
+            : nullptr;
+         outputBlocksOffset += bus.numChannels;
+         bus.silenceFlags = 0UL;
       }
+      data.outputs = mOutputBuses.data();
    }
 
    const auto processResult = mAudioProcessor->process(data);
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <unordered_map>
+#include <vector>
+
 #include <pluginterfaces/base/smartpointer.h>
 #include <pluginterfaces/vst/ivstaudioprocessor.h>
 #include <pluginterfaces/vst/ivstparameterchanges.h>
@@ -149,10 +152,18 @@ private:
 
    //Reads runtime data changes to apply them during next processing pass
    void ConsumeChanges(const EffectSettings& settings);
+   //Call after bus arrangement has changed, before Process
+   void CacheBusLayout();
 
    bool mActive {false};
 
    std::vector<std::pair<Steinberg::Vst::ParamID, Steinberg::Vst::ParamValue>> mParameters;
+   //Index of each parameter known to the controller, so that changes are
+   //merged into mParameters without a search
+   std::unordered_map<Steinberg::Vst::ParamID, size_t> mParameterIndices;
+   //Position in mParameters of the pending change of each parameter, by
+   //parameter index, or -1
+   std::vector<int> mPendingPositions;
    //A preallocated array of Steinberg::Vst::IParameterValueQueue
    //used as a view to an actual parameter changes that reside
    //in VST3EffectSettings structure, dynamically assigned during
@@ -160,4 +171,10 @@ private:
    std::unique_ptr<SingleInputParameterValue[]> mParameterQueues;
 
    Steinberg::Vst::ProcessContext mProcessContext { };
+
+   //Buses as last configured; Process only assigns the channel buffers, so
+   //that it queries nothing from the component and allocates nothing
+   std::vector<Steinberg::Vst::AudioBusBuffers> mInputBuses;
+   std::vector<Steinberg::Vst::AudioBusBuffers> mOutputBuses;
+   bool mBusLayoutValid { false };
 };
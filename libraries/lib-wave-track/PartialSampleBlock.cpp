@@ -0,0 +1,211 @@
+/**********************************************************************
+
+Audacity: A Digital Audio Editor
+
+PartialSampleBlock.cpp
+
+**********************************************************************/
+
+#include "PartialSampleBlock.h"
+
+#include "XMLWriter.h"
+#include "SampleFormat.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <limits>
+
+const char *PartialSampleBlock::Offset_attr = "viewoffset";
+const char *PartialSampleBlock::Length_attr = "viewlength";
+const char *PartialSampleBlock::Reversed_attr = "viewreversed";
+
+namespace {
+//! Ids of views count up from the least value, far from the negative ids of
+//! silent blocks and the positive ids of stored blocks
+std::atomic<SampleBlockID> sNextID{ std::numeric_limits<SampleBlockID>::min() };
+}
+
+SampleBlockPtr PartialSampleBlock::Create(const SampleBlockPtr &pBase,
+   size_t offset, size_t length, bool reversed)
+{
+   assert(pBase);
+   assert(length > 0);
+   assert(offset + length <= pBase->GetSampleCount());
+   if (!reversed && offset == 0 && length == pBase->GetSampleCount())
+      return pBase;
+   if (auto pView = dynamic_cast<const PartialSampleBlock*>(pBase.get()))
+      return Create(pView->mpBase, pView->BaseStart(offset, length), length,
+         reversed != pView->mReversed);
+   return
+      std::make_shared<PartialSampleBlock>(pBase, offset, length, reversed);
+}
+
+SampleBlockPtr PartialSampleBlock::Create(
+   const SampleBlockPtr &pBlock, const AttributesList &attrs)
+{
+   long long offset = -1, length = -1;
+   bool reversed = false;
+   for (auto &[attr, value] : attrs) {
+      if (attr == Offset_attr)
+         value.TryGet(offset);
+      else if (attr == Length_attr)
+         value.TryGet(length);
+      else if (attr == Reversed_attr)
+         value.TryGet(reversed);
+   }
+   if (!pBlock || offset < 0 || length <= 0 ||
+       static_cast<unsigned long long>(offset + length) >
+          pBlock->GetSampleCount())
+      return pBlock;
+   return Create(pBlock, offset, length, reversed);
+}
+
+const SampleBlockPtr &PartialSampleBlock::GetStorage(
+   const SampleBlockPtr &pBlock)
+{
+   if (auto pView = dynamic_cast<const PartialSampleBlock*>(pBlock.get()))
+      return pView->mpBase;
+   return pBlock;
+}
+
+PartialSampleBlock::PartialSampleBlock(const SampleBlockPtr &pBase,
+   size_t offset, size_t length, bool reversed)
+   : mpBase{ pBase }, mOffset{ offset }, mLength{ length }
+   , mReversed{ reversed }
+   , mID{ sNextID++ }
+{
+}
+
+PartialSampleBlock::~PartialSampleBlock() = default;
+
+void PartialSampleBlock::CloseLock() noexcept
+{
+   mpBase->CloseLock();
+}
+
+SampleBlockID PartialSampleBlock::GetBlockID() const
+{
+   return mID;
+}
+
+BlockSampleView PartialSampleBlock::GetFloatSampleView(bool mayThrow)
+{
+   const auto pAll = mpBase->GetFloatSampleView(mayThrow);
+   auto result = std::make_shared<std::vector<float>>(mLength);
+   if (pAll && pAll->size() >= mOffset + mLength) {
+      const auto first = pAll->begin() + mOffset;
+      if (mReversed)
+         std::reverse_copy(first, first + mLength, result->begin());
+      else
+         std::copy(first, first + mLength, result->begin());
+   }
+   return result;
+}
+
+sampleFormat PartialSampleBlock::GetSampleFormat() const
+{
+   return mpBase->GetSampleFormat();
+}
+
+size_t PartialSampleBlock::GetSampleCount() const
+{
+   return mLength;
+}
+
+bool PartialSampleBlock::GetSummary(float *dest,
+   size_t frameoffset, size_t numframes, size_t frameSamples)
+{
+   bool result = true;
+   for (size_t ii = 0; ii < numframes; ++ii, dest += 3) {
+      const auto start = (frameoffset + ii) * frameSamples;
+      if (start >= mLength) {
+         std::fill(dest, dest + 3, 0.0f);
+         continue;
+      }
+      const auto len = std::min(frameSamples, mLength - start);
+      try {
+         const auto minMax = mpBase->GetMinMaxRMS(BaseStart(start, len), len);
+         dest[0] = minMax.min;
+         dest[1] = minMax.max;
+         dest[2] = minMax.RMS;
+      }
+      catch (...) {
+         std::fill(dest, dest + 3, 0.0f);
+         result = false;
+      }
+   }
+   return result;
+}
+
+bool PartialSampleBlock::GetSummary256(
+   float *dest, size_t frameoffset, size_t numframes)
+{
+   return GetSummary(dest, frameoffset, numframes, 256);
+}
+
+bool PartialSampleBlock::GetSummary64k(
+   float *dest, size_t frameoffset, size_t numframes)
+{
+   return GetSummary(dest, frameoffset, numframes, 65536);
+}
+
+size_t PartialSampleBlock::GetSpaceUsage() const
+{
+   return 0;
+}
+
+void PartialSampleBlock::Prefetch() noexcept
+{
+   mpBase->Prefetch();
+}
+
+bool PartialSampleBlock::IsResident() const noexcept
+{
+   return mpBase->IsResident();
+}
+
+std::shared_ptr<const void> PartialSampleBlock::PinResident() const
+{
+   return mpBase->PinResident();
+}
+
+void PartialSampleBlock::SaveXML(XMLWriter &xmlFile)
+{
+   mpBase->SaveXML(xmlFile);
+   xmlFile.WriteAttr(Offset_attr, mOffset);
+   xmlFile.WriteAttr(Length_attr, mLength);
+   if (mReversed)
+      xmlFile.WriteAttr(Reversed_attr, mReversed);
+}
+
+size_t PartialSampleBlock::BaseStart(size_t start, size_t len) const
+{
+   return mOffset + (mReversed ? mLength - start - len : start);
+}
+
+size_t PartialSampleBlock::DoGetSamples(samplePtr dest,
+   sampleFormat destformat, size_t sampleoffset, size_t numsamples)
+{
+   if (sampleoffset >= mLength)
+      return 0;
+   numsamples = std::min(numsamples, mLength - sampleoffset);
+   const auto result = mpBase->GetSamples(dest, destformat,
+      BaseStart(sampleoffset, numsamples), numsamples);
+   if (mReversed)
+      ReverseSamples(dest, destformat, 0, static_cast<int>(numsamples));
+   return result;
+}
+
+MinMaxRMS PartialSampleBlock::DoGetMinMaxRMS(size_t start, size_t len)
+{
+   if (start >= mLength)
+      return {};
+   len = std::min(len, mLength - start);
+   return mpBase->GetMinMaxRMS(BaseStart(start, len), len);
+}
+
+MinMaxRMS PartialSampleBlock::DoGetMinMaxRMS() const
+{
+   return mpBase->GetMinMaxRMS(mOffset, mLength);
+}
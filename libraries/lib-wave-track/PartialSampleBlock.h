@@ -0,0 +1,99 @@
+/**********************************************************************
+
+Audacity: A Digital Audio Editor
+
+PartialSampleBlock.h
+
+**********************************************************************/
+
+#ifndef __AUDACITY_PARTIAL_SAMPLE_BLOCK__
+#define __AUDACITY_PARTIAL_SAMPLE_BLOCK__
+
+#include "SampleBlock.h"
+
+//! A run of the samples of another block, sharing the storage of that block,
+//! and maybe read backwards
+/*!
+ Lets copies of parts of blocks, as at the ends of a copied range of
+ samples, refer to the original instead of duplicating the sample data; and
+ lets reversal rearrange blocks instead of rewriting them.
+ The samples never change, so no copy on write is needed:  edits of a
+ sequence make new blocks anyway.
+
+ The view has its own id, for caches keyed by id, but only for this
+ session; keys kept longer must be made of the id of the storage and of the
+ range of the view.  It serializes as its
+ base block with two more attributes, and the blocks visited by
+ WaveTrackUtilities::VisitBlocks() are the bases, so that the storage of
+ the bases is kept
+ */
+class WAVE_TRACK_API PartialSampleBlock final : public SampleBlock
+{
+public:
+   //! Names of the attributes added to those of the base block
+   static const char *Offset_attr;
+   static const char *Length_attr;
+   static const char *Reversed_attr;
+
+   //! @return pBase itself if the range is all of it, forwards; a view of the
+   //! base of pBase if pBase is another view
+   /*!
+    @param offset and length are of the samples of pBase, in its order
+    @param reversed whether to read the range backwards
+    @pre `pBase && length > 0 && offset + length <= pBase->GetSampleCount()`
+    */
+   static SampleBlockPtr Create(const SampleBlockPtr &pBase,
+      size_t offset, size_t length, bool reversed = false);
+
+   //! @return pBlock, or a view of it if attrs has the attributes of a view
+   static SampleBlockPtr Create(
+      const SampleBlockPtr &pBlock, const AttributesList &attrs);
+
+   //! @return the base of a view, or else the argument
+   static const SampleBlockPtr &GetStorage(const SampleBlockPtr &pBlock);
+
+   //! Of the first sample of the view in the base
+   size_t GetOffset() const { return mOffset; }
+   bool IsReversed() const { return mReversed; }
+
+   PartialSampleBlock(const SampleBlockPtr &pBase,
+      size_t offset, size_t length, bool reversed);
+   ~PartialSampleBlock() override;
+
+   void CloseLock() noexcept override;
+   SampleBlockID GetBlockID() const override;
+   BlockSampleView GetFloatSampleView(bool mayThrow) override;
+   sampleFormat GetSampleFormat() const override;
+   size_t GetSampleCount() const override;
+   bool GetSummary256(
+      float *dest, size_t frameoffset, size_t numframes) override;
+   bool GetSummary64k(
+      float *dest, size_t frameoffset, size_t numframes) override;
+   //! Zero, because the storage is the base block's
+   size_t GetSpaceUsage() const override;
+   void Prefetch() noexcept override;
+   bool IsResident() const noexcept override;
+   std::shared_ptr<const void> PinResident() const override;
+   void SaveXML(XMLWriter &xmlFile) override;
+
+protected:
+   size_t DoGetSamples(samplePtr dest, sampleFormat destformat,
+      size_t sampleoffset, size_t numsamples) override;
+   MinMaxRMS DoGetMinMaxRMS(size_t start, size_t len) override;
+   MinMaxRMS DoGetMinMaxRMS() const override;
+
+private:
+   //! Summarize frames computed from the samples of the base
+   bool GetSummary(float *dest,
+      size_t frameoffset, size_t numframes, size_t frameSamples);
+   //! @return start in the base of the samples [start, start + len) of this
+   size_t BaseStart(size_t start, size_t len) const;
+
+   const SampleBlockPtr mpBase;
+   const size_t mOffset;
+   const size_t mLength;
+   const bool mReversed;
+   const SampleBlockID mID;
+};
+
+#endif
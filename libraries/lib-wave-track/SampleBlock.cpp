@@ -8,11 +8,14 @@ SampleBlock.cpp
 
 
 #include "InconsistencyException.h"
+#include "PartialSampleBlock.h"
 #include "SampleBlock.h"
 #include "SampleFormat.h"
 
 #include <wx/defs.h>
 
+#include <cassert>
+
 SampleBlockFactoryPtr SampleBlockFactory::New( AudacityProject &project )
 {
    auto &factory = Factory::Get();
@@ -34,6 +37,24 @@ SampleBlockPtr SampleBlockFactory::Create(constSamplePtr src,
    return result;
 }
 
+SampleBlockPtr SampleBlockFactory::CreateFromBuffer(SampleBuffer &buffer,
+   size_t numsamples,
+   sampleFormat srcformat)
+{
+   auto result = DoCreateFromBuffer(buffer, numsamples, srcformat);
+   if (!result)
+      THROW_INCONSISTENCY_EXCEPTION;
+   Publisher<SampleBlockCreateMessage>::Publish({});
+   return result;
+}
+
+SampleBlockPtr SampleBlockFactory::DoCreateFromBuffer(SampleBuffer &buffer,
+   size_t numsamples,
+   sampleFormat srcformat)
+{
+   return DoCreate(buffer.ptr(), numsamples, srcformat);
+}
+
 SampleBlockPtr SampleBlockFactory::CreateSilent(
    size_t numsamples,
    sampleFormat srcformat)
@@ -52,6 +73,8 @@ SampleBlockPtr SampleBlockFactory::CreateFromXML(
    auto result = DoCreateFromXML(srcformat, attrs);
    if (!result)
       THROW_INCONSISTENCY_EXCEPTION;
+   // The block may be only part of the stored one
+   result = PartialSampleBlock::Create(result, attrs);
    Publisher<SampleBlockCreateMessage>::Publish({});
    return result;
 }
@@ -66,8 +89,89 @@ SampleBlockPtr SampleBlockFactory::CreateFromId(
    return result;
 }
 
+SampleBlockPtr SampleBlockFactory::CreateDeferred(
+   const SampleBlockSourcePtr &pSource,
+   sampleCount start, size_t numsamples, sampleFormat srcformat)
+{
+   auto result = DoCreateDeferred(pSource, start, numsamples, srcformat);
+   if (!result)
+      THROW_INCONSISTENCY_EXCEPTION;
+   Publisher<SampleBlockCreateMessage>::Publish({});
+   return result;
+}
+
+SampleBlockPtr SampleBlockFactory::DoCreateDeferred(
+   const SampleBlockSourcePtr &pSource,
+   sampleCount start, size_t numsamples, sampleFormat srcformat)
+{
+   SampleBuffer buffer{ numsamples, srcformat };
+   pSource->Read(start, numsamples, buffer.ptr(), srcformat);
+   return DoCreateFromBuffer(buffer, numsamples, srcformat);
+}
+
+bool SampleBlockFactory::GetSamples(
+   const SampleBlockRanges &ranges, sampleFormat destformat, bool mayThrow)
+{
+   try { return DoGetSamples(ranges, destformat); }
+   catch( ... ) {
+      if( mayThrow )
+         throw;
+      for (auto &range : ranges)
+         ClearSamples( range.dest, destformat, 0, range.numsamples );
+      return false;
+   }
+}
+
+bool SampleBlockFactory::DoGetSamples(
+   const SampleBlockRanges &ranges, sampleFormat destformat)
+{
+   bool result = true;
+   for (auto &range : ranges) {
+      assert(range.pBlock);
+      const auto count = range.pBlock->GetSamples(range.dest, destformat,
+         range.sampleoffset, range.numsamples);
+      if (count != range.numsamples)
+         result = false;
+   }
+   return result;
+}
+
+void SampleBlockFactory::Flush()
+{
+}
+
+void SampleBlockFactory::FlushDeferred()
+{
+}
+
+auto SampleBlockFactory::GetCacheStatistics() const -> CacheStatistics
+{
+   return {};
+}
+
+SampleBlockSource::~SampleBlockSource() = default;
+
 SampleBlock::~SampleBlock() = default;
 
+void SampleBlock::Prefetch() noexcept
+{
+}
+
+bool SampleBlock::IsResident() const noexcept
+{
+   return false;
+}
+
+std::shared_ptr<const void> SampleBlock::PinResident() const
+{
+   return nullptr;
+}
+
+std::string SampleBlock::GetContentHash() const
+{
+   return {};
+}
+
 size_t SampleBlock::GetSamples(samplePtr dest,
                    sampleFormat destformat,
                    size_t sampleoffset,
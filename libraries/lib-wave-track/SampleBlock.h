@@ -10,12 +10,16 @@ SampleBlock.h
 #define __AUDACITY_SAMPLE_BLOCK__
 
 #include "GlobalVariable.h"
+#include "SampleCount.h"
 #include "SampleFormat.h"
 #include "AudioSegmentSampleView.h"
 
+#include <atomic>
 #include <functional>
 #include <memory>
+#include <string>
 #include <unordered_set>
+#include <vector>
 
 #include "Observer.h"
 #include "XMLTagHandler.h"
@@ -90,6 +94,27 @@ public:
 
    virtual size_t GetSpaceUsage() const = 0;
 
+   //! Hint that the contents will soon be read; default does nothing
+   /*! The override may load them into memory, and may be called from a worker
+    thread.  It must not throw. */
+   virtual void Prefetch() noexcept;
+
+   //! Whether reading the contents needs no access to storage; default false
+   /*! May be called from any thread.  It must not throw. */
+   virtual bool IsResident() const noexcept;
+
+   //! Keep the contents resident, so that no eviction from caches makes
+   //! reading them access storage, until the result is destroyed
+   /*! May be called from any thread.  Default returns null.
+    @return null if the contents are not resident now */
+   virtual std::shared_ptr<const void> PinResident() const;
+
+   //! SHA-256 of the samples as stored, if it was computed with the summaries
+   /*! Computed only when the factory ComputesContentHashes().
+    May be called from any thread.  Default returns empty.
+    @return hexadecimal, as from crypto::sha256(), or empty */
+   virtual std::string GetContentHash() const;
+
    virtual void SaveXML(XMLWriter &xmlFile) = 0;
 
 protected:
@@ -114,6 +139,31 @@ BlockSpaceUsageAccumulator (unsigned long long &total)
 
 struct SampleBlockCreateMessage { };
 
+//! Samples kept outside of the project, such as in an imported file
+/*! Blocks made by SampleBlockFactory::CreateDeferred() read from it until
+ their samples are copied into the storage of the project */
+class WAVE_TRACK_API SampleBlockSource
+{
+public:
+   virtual ~SampleBlockSource();
+
+   //! Read samples in the given format, or else throw
+   /*! May be called from any thread */
+   virtual void Read(sampleCount start, size_t numsamples,
+      samplePtr dest, sampleFormat format) = 0;
+};
+using SampleBlockSourcePtr = std::shared_ptr<SampleBlockSource>;
+
+//! A run of samples to be fetched from one block into a caller's buffer
+struct SampleBlockRange
+{
+   SampleBlock *pBlock{};
+   samplePtr dest{};
+   size_t sampleoffset{};
+   size_t numsamples{};
+};
+using SampleBlockRanges = std::vector<SampleBlockRange>;
+
 ///\brief abstract base class with methods to produce @ref SampleBlock objects
 class WAVE_TRACK_API SampleBlockFactory
    : public Observer::Publisher<SampleBlockCreateMessage>
@@ -134,6 +184,16 @@ public:
       size_t numsamples,
       sampleFormat srcformat);
 
+   //! Like Create(), but the block may take the storage of the buffer
+   /*!
+    Returns a non-null pointer or else throws an exception.
+    Afterward the buffer may be empty:  but not if there was an exception.
+    @pre `buffer` holds at least numsamples samples in srcformat
+    */
+   SampleBlockPtr CreateFromBuffer(SampleBuffer &buffer,
+      size_t numsamples,
+      sampleFormat srcformat);
+
    // Returns a non-null pointer or else throws an exception
    SampleBlockPtr CreateSilent(
       size_t numsamples,
@@ -147,6 +207,54 @@ public:
    // Potentially returns a null pointer
    SampleBlockPtr CreateFromId(sampleFormat srcformat, SampleBlockID id);
 
+   //! Make a block of samples that stay in the source until the factory
+   //! copies them into storage, later, or when they are first needed
+   /*!
+    Returns a non-null pointer or else throws an exception.
+    The source must outlive the block's use of it, which it shares.
+    */
+   SampleBlockPtr CreateDeferred(const SampleBlockSourcePtr &pSource,
+      sampleCount start, size_t numsamples, sampleFormat srcformat);
+
+   //! Fetch several ranges of samples, typically from consecutive blocks
+   /*!
+    Lets the storage satisfy the whole request with fewer round trips than
+    one call of SampleBlock::GetSamples for each range.
+    If !mayThrow and there is an error, fills all destinations with zeroes
+    and returns false.
+    @return whether every range was read completely
+    */
+   bool GetSamples(const SampleBlockRanges &ranges,
+      sampleFormat destformat, bool mayThrow = true);
+
+   //! Complete any deferred writes of block data to storage; may throw
+   /*! Default does nothing.  Samples of blocks made by CreateDeferred()
+    may still be only in their sources. */
+   virtual void Flush();
+
+   //! Copy into storage the samples of all blocks made by CreateDeferred()
+   //! that are still only in their sources; may throw
+   /*! Default does nothing */
+   virtual void FlushDeferred();
+
+   //! Describes a cache of block contents that a factory may keep
+   struct CacheStatistics {
+      size_t hits{};
+      size_t misses{};
+      size_t bytes{};  //!< currently held
+      size_t budget{}; //!< limit of bytes held; zero when there is no cache
+   };
+   //! Default implementation returns all zeroes
+   virtual CacheStatistics GetCacheStatistics() const;
+
+   //! Whether new blocks should hash their samples, while summarizing them
+   /*! Costs some time in each new block, but saves reading them again to
+    hash them later, as for synchronization with cloud storage */
+   void SetComputesContentHashes(bool compute) noexcept
+   { mComputesContentHashes = compute; }
+   bool ComputesContentHashes() const noexcept
+   { return mComputesContentHashes; }
+
    using SampleBlockIDs = std::unordered_set<SampleBlockID>;
    /*! @return ids of all sample blocks created by this factory and still extant */
    virtual SampleBlockIDs GetActiveBlockIDs() = 0;
@@ -158,6 +266,11 @@ protected:
       size_t numsamples,
       sampleFormat srcformat) = 0;
 
+   //! Default implementation copies the buffer, calling DoCreate()
+   virtual SampleBlockPtr DoCreateFromBuffer(SampleBuffer &buffer,
+      size_t numsamples,
+      sampleFormat srcformat);
+
    // The override should throw more informative exceptions on error than the
    // default InconsistencyException thrown by CreateSilent
    virtual SampleBlockPtr DoCreateSilent(
@@ -172,6 +285,18 @@ protected:
 
    virtual SampleBlockPtr
    DoCreateFromId(sampleFormat srcformat, SampleBlockID id) = 0;
+
+   //! Default implementation reads the source now, calling
+   //! DoCreateFromBuffer()
+   virtual SampleBlockPtr DoCreateDeferred(const SampleBlockSourcePtr &pSource,
+      sampleCount start, size_t numsamples, sampleFormat srcformat);
+
+   //! Default implementation reads each range separately; may throw
+   virtual bool DoGetSamples(
+      const SampleBlockRanges &ranges, sampleFormat destformat);
+
+private:
+   std::atomic<bool> mComputesContentHashes{ false };
 };
 
 #endif
@@ -32,6 +32,7 @@
 #include "Sequence.h"
 
 #include <algorithm>
+#include <limits>
 #include <optional>
 #include <float.h>
 #include <math.h>
@@ -42,6 +43,7 @@
 
 #include "BasicUI.h"
 #include "Dither.h"
+#include "PartialSampleBlock.h"
 #include "SampleBlock.h"
 #include "InconsistencyException.h"
 
@@ -238,6 +240,53 @@ bool Sequence::ConvertToSampleFormat(sampleFormat format,
    return true;
 }
 
+bool Sequence::Defragment(size_t &budget, DefragmentStatistics &statistics)
+{
+   const auto isSmall = [this](const SeqBlock &block){
+      return block.sb->GetSampleCount() < mMinSamples; };
+   const auto spaceOf = [](auto first, auto last){
+      unsigned long long space = 0;
+      for (; first != last; ++first)
+         space += first->sb->GetSpaceUsage();
+      return space;
+   };
+
+   for (size_t ii = 0; ii + 1 < mBlock.size();) {
+      // Find a run of small blocks that fit in one
+      auto jj = ii;
+      size_t sum = 0;
+      while (jj < mBlock.size() && isSmall(mBlock[jj]) &&
+             sum + mBlock[jj].sb->GetSampleCount() <= mMaxSamples)
+         sum += mBlock[jj++].sb->GetSampleCount();
+      if (jj - ii < 2) {
+         ++ii;
+         continue;
+      }
+      if (sum > budget)
+         return true;
+
+      BlockArray replacement;
+      replacement.insert(replacement.end(),
+         mBlock.begin() + ii, mBlock.begin() + jj);
+      size_t b0 = ii, b1 = jj;
+      CoalesceFragments(b0, b1, replacement, 0);
+      const auto spaceBefore = spaceOf(mBlock.begin() + b0, mBlock.begin() + b1);
+      const auto spaceAfter = spaceOf(replacement.begin(), replacement.end());
+      const auto nBlocks = replacement.size();
+      ReplaceBlocksIfConsistent(b0, b1, replacement, mNumSamples,
+         wxT("Sequence::Defragment()"));
+
+      // No-fail from here
+      statistics.blocksBefore += b1 - b0;
+      statistics.blocksAfter += nBlocks;
+      statistics.spaceBefore += spaceBefore;
+      statistics.spaceAfter += spaceAfter;
+      budget -= sum;
+      ii = b0 + nBlocks;
+   }
+   return false;
+}
+
 std::pair<float, float> Sequence::GetMinMax(
    sampleCount start, sampleCount len, bool mayThrow) const
 {
@@ -320,6 +369,45 @@ std::pair<float, float> Sequence::GetMinMax(
    return { min, max };
 }
 
+auto Sequence::GetSummarySpans(sampleCount start, size_t len) const
+   -> std::vector<SummarySpan>
+{
+   constexpr size_t FrameLength = 256;
+   constexpr auto unknown = std::numeric_limits<float>::infinity();
+   std::vector<SummarySpan> result;
+   std::vector<float> summary;
+   if (start < mNumSamples) {
+      for (auto b = FindBlock(start); len > 0 && b < int(mBlock.size()); ++b) {
+         const SeqBlock &theBlock = mBlock[b];
+         const auto &theFile = theBlock.sb;
+         const auto blockLen = theFile->GetSampleCount();
+         const auto offset = (start - theBlock.start).as_size_t();
+         const auto count = std::min(len, blockLen - offset);
+         const auto frame0 = offset / FrameLength;
+         const auto frame1 = (offset + count - 1) / FrameLength + 1;
+         summary.resize(3 * (frame1 - frame0));
+         const bool ok =
+            theFile->GetSummary256(summary.data(), frame0, frame1 - frame0);
+         for (auto frame = frame0; frame < frame1; ++frame) {
+            const auto frameStart = frame * FrameLength;
+            const auto frameEnd = std::min(frameStart + FrameLength, blockLen);
+            const auto spanStart = std::max(frameStart, offset);
+            const auto spanEnd = std::min(frameEnd, offset + count);
+            const auto minMax = &summary[3 * (frame - frame0)];
+            result.push_back({ spanEnd - spanStart,
+               ok ? std::max(-minMax[0], minMax[1]) : unknown,
+               spanStart == frameStart && spanEnd == frameEnd });
+         }
+         start += count;
+         len -= count;
+      }
+   }
+   // Past the end of the blocks
+   if (len > 0)
+      result.push_back({ len, unknown, false });
+   return result;
+}
+
 float Sequence::GetRMS(sampleCount start, sampleCount len, bool mayThrow) const
 {
    // len is the number of samples that we want the rms of.
@@ -429,12 +517,19 @@ std::unique_ptr<Sequence> Sequence::Copy( const SampleBlockFactoryPtr &pFactory,
       blocklen =
          ( std::min(s1, block0.start + sb->GetSampleCount()) - s0 ).as_size_t();
       wxASSERT(blocklen <= (int)mMaxSamples); // Vaughan, 2012-02-29
-      ensureSampleBufferSize(buffer, format, bufferSize, blocklen);
-      Get(b0, buffer.ptr(), format, s0, blocklen, true);
+      if (!pUseFactory)
+         // Refer to part of the block, without duplicating samples
+         AppendBlock(nullptr, format, dest->mBlock, dest->mNumSamples,
+            SeqBlock{ PartialSampleBlock::Create(sb,
+               (s0 - block0.start).as_size_t(), blocklen), 0 });
+      else {
+         ensureSampleBufferSize(buffer, format, bufferSize, blocklen);
+         Get(b0, buffer.ptr(), format, s0, blocklen, true);
 
-      dest->Append(
-         buffer.ptr(), format, blocklen, 1, mSampleFormats.Effective());
-      dest->Flush();
+         dest->Append(
+            buffer.ptr(), format, blocklen, 1, mSampleFormats.Effective());
+         dest->Flush();
+      }
    }
    else
       --b0;
@@ -454,11 +549,16 @@ std::unique_ptr<Sequence> Sequence::Copy( const SampleBlockFactoryPtr &pFactory,
       blocklen = (s1 - block.start).as_size_t();
       wxASSERT(blocklen <= (int)mMaxSamples); // Vaughan, 2012-02-29
       if (blocklen < (int)sb->GetSampleCount()) {
-         ensureSampleBufferSize(buffer, format, bufferSize, blocklen);
-         Get(b1, buffer.ptr(), format, block.start, blocklen, true);
-         dest->Append(
-            buffer.ptr(), format, blocklen, 1, mSampleFormats.Effective());
-         dest->Flush();
+         if (!pUseFactory)
+            AppendBlock(nullptr, format, dest->mBlock, dest->mNumSamples,
+               SeqBlock{ PartialSampleBlock::Create(sb, 0, blocklen), 0 });
+         else {
+            ensureSampleBufferSize(buffer, format, bufferSize, blocklen);
+            Get(b1, buffer.ptr(), format, block.start, blocklen, true);
+            dest->Append(
+               buffer.ptr(), format, blocklen, 1, mSampleFormats.Effective());
+            dest->Flush();
+         }
       }
       else
          // Special case of a whole block
@@ -478,15 +578,29 @@ namespace {
       return numSamples > wxLL(9223372036854775807);
    }
 
+   //! Reads a block of another factory, until the samples are copied
+   class BlockSource final : public SampleBlockSource {
+   public:
+      explicit BlockSource(SampleBlockPtr sb) : mSb{ move(sb) } {}
+      void Read(sampleCount start, size_t numsamples,
+         samplePtr dest, sampleFormat format) override
+      {
+         mSb->GetSamples(dest, format, start.as_size_t(), numsamples);
+      }
+   private:
+      const SampleBlockPtr mSb;
+   };
+
    SampleBlockPtr ShareOrCopySampleBlock(
       SampleBlockFactory *pFactory, sampleFormat format, SampleBlockPtr sb )
    {
       if ( pFactory ) {
-         // must copy contents to a fresh SampleBlock object in another database
+         // must copy contents to a fresh SampleBlock object in another
+         // database; the factory may defer that, so that pasting between
+         // projects does not wait to read and write all the samples
          auto sampleCount = sb->GetSampleCount();
-         SampleBuffer buffer{ sampleCount, format };
-         sb->GetSamples( buffer.ptr(), format, 0, sampleCount );
-         sb = pFactory->Create( buffer.ptr(), sampleCount, format );
+         sb = pFactory->CreateDeferred(
+            std::make_shared<BlockSource>(move(sb)), 0, sampleCount, format );
       }
       else
          // Can just share
@@ -550,8 +664,10 @@ void Sequence::Paste(sampleCount s, const Sequence *src)
       // onto the end because the current last block is longer than the
       // minimum size
 
-      // Build and swap a copy so there is a strong exception safety guarantee
-      BlockArray newBlock{ mBlock };
+      // Build only the additional blocks so there is a strong exception
+      // safety guarantee
+      BlockArray newBlock;
+      newBlock.reserve(srcNumBlocks);
       sampleCount samples = mNumSamples;
       for (unsigned int i = 0; i < srcNumBlocks; i++)
          // AppendBlock may throw for limited disk space, if pasting from
@@ -559,8 +675,10 @@ void Sequence::Paste(sampleCount s, const Sequence *src)
          AppendBlock(pUseFactory, format,
             newBlock, samples, srcBlock[i]);
 
-      CommitChangesIfConsistent
-         (newBlock, samples, wxT("Paste branch one"));
+      size_t b0 = numBlocks, b1 = numBlocks;
+      CoalesceFragments(b0, b1, newBlock, samples - mNumSamples);
+      ReplaceBlocksIfConsistent
+         (b0, b1, newBlock, samples, wxT("Paste branch one"));
       mSampleFormats.UpdateEffective(src->mSampleFormats.Effective());
       return;
    }
@@ -614,91 +732,90 @@ void Sequence::Paste(sampleCount s, const Sequence *src)
       return;
    }
 
-   // Case three: if we are inserting four or fewer blocks,
-   // it's simplest to just lump all the data together
-   // into one big block along with the split block,
-   // then resplit it all
+   // Case three: share the source blocks, and split the block at s into
+   // views of its parts; short fragments at the seams are then coalesced
    BlockArray newBlock;
-   newBlock.reserve(numBlocks + srcNumBlocks + 2);
-   newBlock.insert(newBlock.end(), mBlock.begin(), mBlock.begin() + b);
+   newBlock.reserve(srcNumBlocks + 2);
 
-   SeqBlock &splitBlock = mBlock[b];
-   auto splitLen = splitBlock.sb->GetSampleCount();
+   const SeqBlock &splitBlock = mBlock[b];
+   const auto splitLen = splitBlock.sb->GetSampleCount();
    // s lies within splitBlock
-   auto splitPoint = ( s - splitBlock.start ).as_size_t();
-
-   unsigned int i;
-   if (srcNumBlocks <= 4) {
-
-      // addedLen is at most four times maximum block size
-      auto sAddedLen = addedLen.as_size_t();
-      const auto sum = splitLen + sAddedLen;
-
-      SampleBuffer sumBuffer(sum, format);
-      Read(sumBuffer.ptr(), format, splitBlock, 0, splitPoint, true);
-      src->Get(0, sumBuffer.ptr() + splitPoint * sampleSize,
-               format,
-               0, sAddedLen, true);
-      Read(sumBuffer.ptr() + (splitPoint + sAddedLen) * sampleSize, format,
-           splitBlock, splitPoint,
-           splitLen - splitPoint, true);
-
-      Blockify(*mpFactory, mMaxSamples, format,
-               newBlock, splitBlock.start, sumBuffer.ptr(), sum);
-   } else {
-
-      // The final case is that we're inserting at least five blocks.
-      // We divide these into three groups: the first two get merged
-      // with the first half of the split block, the middle ones get
-      // used whole, and the last two get merged with the last
-      // half of the split block.
-
-      const auto srcFirstTwoLen =
-          srcBlock[0].sb->GetSampleCount() + srcBlock[1].sb->GetSampleCount();
-      const auto leftLen = splitPoint + srcFirstTwoLen;
-
-      const SeqBlock &penultimate = srcBlock[srcNumBlocks - 2];
-      const auto srcLastTwoLen =
-         penultimate.sb->GetSampleCount() +
-         srcBlock[srcNumBlocks - 1].sb->GetSampleCount();
-      const auto rightSplit = splitBlock.sb->GetSampleCount() - splitPoint;
-      const auto rightLen = rightSplit + srcLastTwoLen;
-
-      SampleBuffer sampleBuffer(std::max(leftLen, rightLen), format);
+   const auto splitPoint = ( s - splitBlock.start ).as_size_t();
+
+   if (splitPoint > 0)
+      newBlock.push_back(SeqBlock{
+         PartialSampleBlock::Create(splitBlock.sb, 0, splitPoint),
+         splitBlock.start });
+   for (const auto &block : srcBlock) {
+      // May throw for limited disk space, if pasting from one project into
+      // another.
+      auto sb = ShareOrCopySampleBlock( pUseFactory, format, block.sb );
+      newBlock.push_back(SeqBlock(sb, block.start + s));
+   }
+   if (splitPoint < splitLen)
+      newBlock.push_back(SeqBlock{
+         PartialSampleBlock::Create(
+            splitBlock.sb, splitPoint, splitLen - splitPoint),
+         s + addedLen });
+
+   // Splice the NEW blocks in for the split block, moving the remaining
+   // blocks later
+   size_t b0 = b, b1 = b + 1;
+   CoalesceFragments(b0, b1, newBlock, addedLen);
+   ReplaceBlocksIfConsistent(b0, b1,
+      newBlock, mNumSamples + addedLen, wxT("Paste branch three"));
 
-      Read(sampleBuffer.ptr(), format, splitBlock, 0, splitPoint, true);
-      src->Get(0, sampleBuffer.ptr() + splitPoint*sampleSize,
-               format, 0, srcFirstTwoLen, true);
+   mSampleFormats.UpdateEffective(src->mSampleFormats.Effective());
+}
 
-      Blockify(*mpFactory, mMaxSamples, format,
-               newBlock, splitBlock.start, sampleBuffer.ptr(), leftLen);
+/*! @excsafety{Strong} */
+void Sequence::Reverse(sampleCount start, sampleCount len)
+{
+   if (len == 0)
+      return;
 
-      for (i = 2; i < srcNumBlocks - 2; i++) {
-         const SeqBlock &block = srcBlock[i];
-         auto sb = ShareOrCopySampleBlock(
-            pUseFactory, format, block.sb );
-         newBlock.push_back(SeqBlock(sb, block.start + s));
-      }
+   if (len < 0 || start < 0 || start + len > mNumSamples)
+      THROW_INCONSISTENCY_EXCEPTION;
 
-      auto lastStart = penultimate.start;
-      src->Get(srcNumBlocks - 2, sampleBuffer.ptr(), format,
-               lastStart, srcLastTwoLen, true);
-      Read(sampleBuffer.ptr() + srcLastTwoLen * sampleSize, format,
-           splitBlock, splitPoint, rightSplit, true);
+   const auto end = start + len;
+   const size_t b0 = FindBlock(start);
+   const size_t b1 = FindBlock(end - 1);
 
-      Blockify(*mpFactory, mMaxSamples, format,
-               newBlock, s + lastStart, sampleBuffer.ptr(), rightLen);
+   BlockArray newBlock;
+   newBlock.reserve(b1 - b0 + 3);
+   auto pos = mBlock[b0].start;
+   const auto push = [&](SampleBlockPtr sb){
+      const auto length = sb->GetSampleCount();
+      newBlock.push_back(SeqBlock{ move(sb), pos });
+      pos += length;
+   };
+
+   // Any part of the first block before the range
+   const SeqBlock &first = mBlock[b0];
+   if (start > first.start)
+      push(PartialSampleBlock::Create(
+         first.sb, 0, (start - first.start).as_size_t()));
+
+   // The blocks of the range, the last first, each read backwards
+   for (auto bb = b1 + 1; bb-- > b0;) {
+      const SeqBlock &block = mBlock[bb];
+      const auto blockEnd = block.start + block.sb->GetSampleCount();
+      const auto s0 = std::max(start, block.start);
+      const auto s1 = std::min(end, blockEnd);
+      push(PartialSampleBlock::Create(block.sb,
+         (s0 - block.start).as_size_t(), (s1 - s0).as_size_t(), true));
    }
 
-   // Copy remaining blocks to NEW block array and
-   // swap the NEW block array in for the old
-   for (i = b + 1; i < numBlocks; i++)
-      newBlock.push_back(mBlock[i].Plus(addedLen));
+   // Any part of the last block after the range
+   const SeqBlock &last = mBlock[b1];
+   const auto lastEnd = last.start + last.sb->GetSampleCount();
+   if (end < lastEnd)
+      push(PartialSampleBlock::Create(last.sb,
+         (end - last.start).as_size_t(), (lastEnd - end).as_size_t()));
 
-   CommitChangesIfConsistent
-      (newBlock, mNumSamples + addedLen, wxT("Paste branch three"));
-
-   mSampleFormats.UpdateEffective(src->mSampleFormats.Effective());
+   size_t c0 = b0, c1 = b1 + 1;
+   CoalesceFragments(c0, c1, newBlock, 0);
+   ReplaceBlocksIfConsistent(c0, c1, newBlock, mNumSamples, wxT("Reverse"));
 }
 
 /*! @excsafety{Strong} */
@@ -1064,11 +1181,13 @@ int Sequence::FindBlock(sampleCount pos) const
    size_t lo = 0, hi = numBlocks, guess;
    sampleCount loSamples = 0, hiSamples = mNumSamples;
 
-   while (true) {
+   for (bool bisect = false; true; bisect = !bisect) {
       //this is not a binary search, but a
       //dictionary search where we guess something smarter than the binary division
       //of the unsearched area, since samples are usually proportional to block file number.
-      const double frac = (pos - loSamples).as_double() /
+      //But every other guess divides the area in half, so that very uneven
+      //block lengths can't make the search linear.
+      const double frac = bisect ? 0.5 : (pos - loSamples).as_double() /
          (hiSamples - loSamples).as_double();
       guess = std::min(hi - 1, lo + size_t(frac * (hi - lo)));
       const SeqBlock &block = mBlock[guess];
@@ -1101,6 +1220,48 @@ int Sequence::FindBlock(sampleCount pos) const
    return rval;
 }
 
+void Sequence::Prefetch(sampleCount start, sampleCount len) const noexcept
+{
+   start = std::max<sampleCount>(start, 0);
+   const auto end = std::min(start + len, mNumSamples);
+   if (start >= end)
+      return;
+   for (int b = FindBlock(start), nBlocks = mBlock.size();
+      b < nBlocks && mBlock[b].start < end; ++b)
+      mBlock[b].sb->Prefetch();
+}
+
+bool Sequence::IsResident(sampleCount start, sampleCount len) const noexcept
+{
+   start = std::max<sampleCount>(start, 0);
+   const auto end = std::min(start + len, mNumSamples);
+   if (start >= end)
+      return true;
+   for (int b = FindBlock(start), nBlocks = mBlock.size();
+      b < nBlocks && mBlock[b].start < end; ++b)
+      if (!mBlock[b].sb->IsResident())
+         return false;
+   return true;
+}
+
+std::shared_ptr<const void>
+Sequence::PinResident(sampleCount start, sampleCount len) const
+{
+   std::vector<std::shared_ptr<const void>> pins;
+   start = std::max<sampleCount>(start, 0);
+   const auto end = std::min(start + len, mNumSamples);
+   if (start < end)
+      for (int b = FindBlock(start), nBlocks = mBlock.size();
+         b < nBlocks && mBlock[b].start < end; ++b) {
+         auto pin = mBlock[b].sb->PinResident();
+         if (!pin)
+            return nullptr;
+         pins.push_back(move(pin));
+      }
+   return std::make_shared<const std::vector<std::shared_ptr<const void>>>(
+      move(pins));
+}
+
 //static
 bool Sequence::Read(samplePtr buffer, sampleFormat format,
                     const SeqBlock &b, size_t blockRelativeStart, size_t len,
@@ -1185,7 +1346,10 @@ bool Sequence::Get(samplePtr buffer, sampleFormat format,
 bool Sequence::Get(int b, samplePtr buffer, sampleFormat format,
    sampleCount start, size_t len, bool mayThrow) const
 {
-   bool result = true;
+   // Gather the ranges of all blocks touched, so that the factory may fetch
+   // them from storage in fewer requests
+   SampleBlockRanges ranges;
+   const auto totalLen = len;
    while (len) {
       const SeqBlock &block = mBlock[b];
       // start is in block
@@ -1193,14 +1357,24 @@ bool Sequence::Get(int b, samplePtr buffer, sampleFormat format,
       // bstart is not more than block length
       const auto blen = std::min(len, block.sb->GetSampleCount() - bstart);
 
-      if (! Read(buffer, format, block, bstart, blen, mayThrow) )
-         result = false;
+      ranges.push_back({ block.sb.get(), buffer, bstart, blen });
 
       len -= blen;
       buffer += (blen * SAMPLE_SIZE(format));
       b++;
       start += blen;
    }
+
+   if (ranges.size() == 1) {
+      // Avoid the generality
+      const auto &range = ranges.front();
+      return Read(range.dest, format, mBlock[b - 1],
+         range.sampleoffset, range.numsamples, mayThrow);
+   }
+
+   const auto result = mpFactory->GetSamples(ranges, format, mayThrow);
+   if (!result)
+      wxLogWarning(wxT("Expected to read %ld samples, failed."), totalLen);
    return result;
 }
 
@@ -1227,9 +1401,10 @@ void Sequence::SetSamples(constSamplePtr buffer, sampleFormat format,
       temp.Allocate(tempSize, dstFormat);
    }
 
-   int b = FindBlock(start);
+   const int b0 = FindBlock(start);
+   int b = b0;
+   // Only the overwritten blocks are replaced
    BlockArray newBlock;
-   std::copy( mBlock.begin(), mBlock.begin() + b, std::back_inserter(newBlock) );
 
    while (len > 0
       // Redundant termination condition,
@@ -1315,9 +1490,8 @@ void Sequence::SetSamples(constSamplePtr buffer, sampleFormat format,
       b++;
    }
 
-   std::copy( mBlock.begin() + b, mBlock.end(), std::back_inserter(newBlock) );
-
-   CommitChangesIfConsistent( newBlock, mNumSamples, wxT("SetSamples") );
+   ReplaceBlocksIfConsistent( b0, b, newBlock, mNumSamples,
+      wxT("SetSamples") );
 
    mSampleFormats.UpdateEffective(effectiveFormat);
 }
@@ -1372,6 +1546,35 @@ void Sequence::AppendSharedBlock(const SeqBlock::SampleBlockPtr &pBlock)
 #endif
 }
 
+/*! @excsafety{Strong} */
+void Sequence::AppendDeferred(const SampleBlockSourcePtr &pSource,
+   sampleCount start, sampleCount len, sampleFormat effectiveFormat)
+{
+   Flush();
+
+   // Quick check to make sure that it doesn't overflow
+   if (Overflows(mNumSamples.as_double() + len.as_double()))
+      THROW_INCONSISTENCY_EXCEPTION;
+
+   const auto format = mSampleFormats.Stored();
+   BlockArray newBlocks;
+   auto newNumSamples = mNumSamples;
+   for (sampleCount done = 0; done < len;) {
+      const auto blockLen =
+         limitSampleBufferSize(GetIdealBlockSize(), len - done);
+      newBlocks.emplace_back(
+         mpFactory->CreateDeferred(pSource, start + done, blockLen, format),
+         newNumSamples);
+      done += blockLen;
+      newNumSamples += blockLen;
+   }
+
+   AppendBlocksIfConsistent(newBlocks, false,
+                            newNumSamples, wxT("AppendDeferred"));
+   // Change our effective format now that nothing threw
+   mSampleFormats.UpdateEffective(std::min(effectiveFormat, format));
+}
+
 /*! @excsafety{Weak} */
 bool Sequence::Append(
    constSamplePtr buffer, sampleFormat format, size_t len, size_t stride,
@@ -1385,7 +1588,21 @@ bool Sequence::Append(
    bool result = false;
    auto blockSize = GetIdealAppendLen();
    for(;;) {
-      if (mAppendBufferLen >= blockSize) {
+      if (mAppendBufferLen == blockSize &&
+          (mBlock.empty() ||
+           mBlock.back().sb->GetSampleCount() >= mMinSamples)) {
+         // The staged samples make exactly one new block, with no need to
+         // coalesce with the last:  hand over the buffer without copying
+         // use Strong-guarantee
+         DoAppendStaged(blockSize);
+         mSampleFormats.UpdateEffective(mAppendEffectiveFormat);
+         result = true;
+         mAppendBufferLen = 0;
+         if (!mAppendBuffer.ptr())
+            mAppendBuffer.Allocate(mMaxSamples, seqFormat);
+         blockSize = GetIdealAppendLen();
+      }
+      else if (mAppendBufferLen >= blockSize) {
          // flush some previously appended contents
          // use Strong-guarantee
          // Already dithered if needed when accumulated into mAppendBuffer
@@ -1407,7 +1624,11 @@ bool Sequence::Append(
 
       // use No-fail-guarantee for rest of this "for"
       wxASSERT(mAppendBufferLen <= mMaxSamples);
-      auto toCopy = std::min(len, mMaxSamples - mAppendBufferLen);
+      // Stage no more than one block, so that it can be handed over whole
+      const auto room = mAppendBufferLen < blockSize
+         ? blockSize - mAppendBufferLen
+         : mMaxSamples - mAppendBufferLen;
+      auto toCopy = std::min(len, room);
 
       // If dithering of appended material is done at all, it happens here
       CopySamples(buffer, format,
@@ -1427,6 +1648,33 @@ bool Sequence::Append(
    return result;
 }
 
+/*! @excsafety{Strong} */
+void Sequence::DoAppendStaged(size_t len)
+{
+   // Quick check to make sure that it doesn't overflow
+   if (Overflows(mNumSamples.as_double() + ((double)len)))
+      THROW_INCONSISTENCY_EXCEPTION;
+
+   // The factory leaves the buffer as it was, if it throws
+   const auto format = mSampleFormats.Stored();
+   auto pBlock = mpFactory->CreateFromBuffer(mAppendBuffer, len, format);
+
+   BlockArray newBlock;
+   newBlock.push_back(SeqBlock(pBlock, mNumSamples));
+   try {
+      AppendBlocksIfConsistent(newBlock, false, mNumSamples + len,
+         wxT("Append"));
+   }
+   catch (...) {
+      if (!mAppendBuffer.ptr()) {
+         // Take the samples back from the block
+         mAppendBuffer.Allocate(mMaxSamples, format);
+         pBlock->GetSamples(mAppendBuffer.ptr(), format, 0, len, false);
+      }
+      throw;
+   }
+}
+
 /*! @excsafety{Strong} */
 SeqBlock::SampleBlockPtr Sequence::DoAppend(
    constSamplePtr buffer, sampleFormat format, size_t len, bool coalesce)
@@ -1646,14 +1894,11 @@ void Sequence::Delete(sampleCount start, sampleCount len)
       return;
    }
 
-   // Create a NEW array of blocks
+   // Create a NEW array of the blocks to replace those from b0 through b1,
+   // and possibly one more at either side
    BlockArray newBlock;
-   newBlock.reserve(numBlocks - (b1 - b0) + 2);
-
-   // Copy the blocks before the deletion point over to
-   // the NEW array
-   newBlock.insert(newBlock.end(), mBlock.begin(), mBlock.begin() + b0);
-   unsigned int i;
+   newBlock.reserve(4);
+   size_t first = b0;
 
    // First grab the samples in block b0 before the deletion point
    // into preBuffer.  If this is enough samples for its own block,
@@ -1687,7 +1932,8 @@ void Sequence::Delete(sampleCount start, sampleCount len)
          Read(scratch.ptr() + prepreLen*sampleSize, format,
               preBlock, 0, preBufferLen, true);
 
-         newBlock.pop_back();
+         // Replace the previous block too
+         --first;
          Blockify(*mpFactory, mMaxSamples, format,
                   newBlock, prepreBlock.start, scratch.ptr(), sum);
       }
@@ -1743,12 +1989,11 @@ void Sequence::Delete(sampleCount start, sampleCount len)
       // right on the end of a block.
    }
 
-   // Copy the remaining blocks over from the old array
-   for (i = b1 + 1; i < numBlocks; i++)
-      newBlock.push_back(mBlock[i].Plus(-len));
-
-   CommitChangesIfConsistent
-      (newBlock, mNumSamples - len, wxT("Delete - branch two"));
+   // Splice the NEW blocks in, moving the remaining blocks earlier
+   size_t last = b1 + 1;
+   CoalesceFragments(first, last, newBlock, -len);
+   ReplaceBlocksIfConsistent(first, last,
+      newBlock, mNumSamples - len, wxT("Delete - branch two"));
 }
 
 void Sequence::ConsistencyCheck(const wxChar *whereStr, bool mayThrow) const
@@ -1862,6 +2107,133 @@ void Sequence::AppendBlocksIfConsistent
    consistent = true;
 }
 
+void Sequence::CoalesceFragments(size_t &b0, size_t &b1,
+   BlockArray &replacement, sampleCount delta) const
+{
+   // Candidates are the replacement and the neighbors of the range, the
+   // latter at the starts they will have
+   BlockArray candidates;
+   candidates.reserve(replacement.size() + 2);
+   const bool hasLeft = b0 > 0, hasRight = b1 < mBlock.size();
+   if (hasLeft)
+      candidates.push_back(mBlock[b0 - 1]);
+   candidates.insert(candidates.end(), replacement.begin(), replacement.end());
+   if (hasRight)
+      candidates.push_back(mBlock[b1].Plus(delta));
+
+   const auto isSmall = [this](const SeqBlock &block){
+      return block.sb->GetSampleCount() < mMinSamples; };
+   const auto nCandidates = candidates.size();
+   // Quick exit when no two small blocks are adjacent
+   bool any = false;
+   for (size_t ii = 1; !any && ii < nCandidates; ++ii)
+      any = isSmall(candidates[ii - 1]) && isSmall(candidates[ii]);
+   if (!any)
+      return;
+
+   const auto format = mSampleFormats.Stored();
+   const auto sampleSize = SAMPLE_SIZE(format);
+   SampleBuffer buffer(mMaxSamples, format);
+   BlockArray result;
+   result.reserve(nCandidates);
+   bool mergedLeft = false, mergedRight = false;
+   for (size_t ii = 0; ii < nCandidates;) {
+      // Find a run of small blocks that fit in one
+      auto jj = ii;
+      size_t sum = 0;
+      while (jj < nCandidates && isSmall(candidates[jj]) &&
+             sum + candidates[jj].sb->GetSampleCount() <= mMaxSamples)
+         sum += candidates[jj++].sb->GetSampleCount();
+      if (jj - ii < 2) {
+         result.push_back(candidates[ii++]);
+         continue;
+      }
+      size_t offset = 0;
+      for (auto kk = ii; kk < jj; ++kk) {
+         const auto &block = candidates[kk];
+         const auto len = block.sb->GetSampleCount();
+         Read(buffer.ptr() + offset * sampleSize, format, block, 0, len, true);
+         offset += len;
+      }
+      Blockify(*mpFactory, mMaxSamples, format,
+         result, candidates[ii].start, buffer.ptr(), sum);
+      mergedLeft = mergedLeft || (hasLeft && ii == 0);
+      mergedRight = mergedRight || (hasRight && jj == nCandidates);
+      ii = jj;
+   }
+
+   // Neighbors that were not merged stay where they are
+   if (hasLeft && !mergedLeft)
+      result.erase(result.begin());
+   if (hasRight && !mergedRight)
+      result.pop_back();
+
+   // use No-fail-guarantee
+   replacement.swap(result);
+   if (mergedLeft)
+      --b0;
+   if (mergedRight)
+      ++b1;
+}
+
+void Sequence::ReplaceBlocksIfConsistent(size_t b0, size_t b1,
+   BlockArray &replacement, sampleCount numSamples, const wxChar *whereStr)
+{
+   const auto numBlocks = mBlock.size();
+   wxASSERT(b0 <= b1 && b1 <= numBlocks);
+   const auto delta = numSamples - mNumSamples;
+
+   // Check only the replacement, and that it meets its neighbors
+   bool consistent = true;
+   auto pos = b0 < numBlocks ? mBlock[b0].start : mNumSamples;
+   for (const auto &block : replacement) {
+      if (!block.sb || block.start != pos ||
+          block.sb->GetSampleCount() > mMaxSamples) {
+         consistent = false;
+         break;
+      }
+      pos += block.sb->GetSampleCount();
+   }
+   if (consistent)
+      consistent = (b1 < numBlocks ? mBlock[b1].start + delta : numSamples)
+         == pos;
+
+   if (!consistent) {
+      // Get the full diagnosis from the usual check of the whole new array
+      BlockArray newBlock;
+      newBlock.reserve(numBlocks - (b1 - b0) + replacement.size());
+      newBlock.insert(newBlock.end(), mBlock.begin(), mBlock.begin() + b0);
+      newBlock.insert(newBlock.end(), replacement.begin(), replacement.end());
+      for (auto ii = b1; ii < numBlocks; ++ii)
+         newBlock.push_back(mBlock[ii].Plus(delta));
+      CommitChangesIfConsistent(newBlock, numSamples, whereStr);
+      return;
+   }
+
+   // Make room first; nothing has changed if this throws
+   mBlock.reserve(numBlocks - (b1 - b0) + replacement.size());
+
+   // now commit
+   // use No-fail-guarantee
+
+   if (delta != 0)
+      for (auto ii = b1; ii < numBlocks; ++ii)
+         mBlock[ii].start += delta;
+
+   // Overwrite in place as many as possible, then erase or insert the rest
+   const auto nOld = b1 - b0, nNew = replacement.size();
+   const auto nCommon = std::min(nOld, nNew);
+   std::move(replacement.begin(), replacement.begin() + nCommon,
+      mBlock.begin() + b0);
+   if (nOld > nNew)
+      mBlock.erase(mBlock.begin() + b0 + nCommon, mBlock.begin() + b1);
+   else
+      mBlock.insert(mBlock.begin() + b0 + nCommon,
+         std::make_move_iterator(replacement.begin() + nCommon),
+         std::make_move_iterator(replacement.end()));
+   mNumSamples = numSamples;
+}
+
 void Sequence::DebugPrintf
    (const BlockArray &mBlock, sampleCount mNumSamples, wxString *dest)
 {
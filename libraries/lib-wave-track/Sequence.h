@@ -15,6 +15,7 @@
 #include <vector>
 #include <functional>
 
+#include "ObjectPool.h"
 #include "SampleFormat.h"
 #include "XMLTagHandler.h"
 
@@ -24,6 +25,8 @@
 class SampleBlock;
 class SampleBlockFactory;
 using SampleBlockFactoryPtr = std::shared_ptr<SampleBlockFactory>;
+class SampleBlockSource;
+using SampleBlockSourcePtr = std::shared_ptr<SampleBlockSource>;
 
 // This is an internal data structure!  For advanced use only.
 class SeqBlock {
@@ -47,9 +50,20 @@ class SeqBlock {
       return SeqBlock(sb, start + delta);
    }
 };
-class BlockArray : public std::vector<SeqBlock> {};
+//! Pooled, because edits make and copy many short arrays
+class BlockArray
+   : public std::vector<SeqBlock, ObjectPool::Allocator<SeqBlock>> {};
 using BlockPtrArray = std::vector<SeqBlock*>; // non-owning pointers
 
+//! What Sequence::Defragment() did
+struct DefragmentStatistics {
+   size_t blocksBefore{ 0 };
+   size_t blocksAfter{ 0 };
+   //! Space used by the blocks replaced, and by their replacements
+   unsigned long long spaceBefore{ 0 };
+   unsigned long long spaceAfter{ 0 };
+};
+
 class WAVE_TRACK_API Sequence final : public XMLTagHandler{
  public:
 
@@ -129,6 +143,14 @@ class WAVE_TRACK_API Sequence final : public XMLTagHandler{
    /*! @excsafety{Strong} */
    void Paste(sampleCount s0, const Sequence *src);
 
+   //! Reverse the samples in [start, start + len)
+   /*!
+    Blocks are rearranged as views that read them backwards, so samples are
+    read and written only to coalesce short fragments at the ends
+    @excsafety{Strong}
+    */
+   void Reverse(sampleCount start, sampleCount len);
+
    size_t GetIdealAppendLen() const;
 
    /*!
@@ -164,6 +186,14 @@ class WAVE_TRACK_API Sequence final : public XMLTagHandler{
    //! Append a complete block, not coalescing
    /*! @excsafety{Strong} */
    void AppendSharedBlock(const SeqBlock::SampleBlockPtr &pBlock);
+   //! Append new blocks, not coalescing, whose samples stay in the source
+   //! until the factory copies them
+   /*!
+    The source is read in the stored format, after flushing the append buffer
+    @excsafety{Strong}
+    */
+   void AppendDeferred(const SampleBlockSourcePtr &pSource,
+      sampleCount start, sampleCount len, sampleFormat effectiveFormat);
    /*! @excsafety{Strong} */
    void Delete(sampleCount start, sampleCount len);
 
@@ -207,6 +237,22 @@ class WAVE_TRACK_API Sequence final : public XMLTagHandler{
    bool ConvertToSampleFormat(sampleFormat format,
       const std::function<void(size_t)> & progressReport = {});
 
+   //
+   // Defragmenting
+   //
+
+   //! Rewrite runs of adjacent blocks shorter than the minimum into blocks
+   //! of up to the maximum size
+   /*!
+    The sequence holds the same samples afterward.
+    @param budget samples that may be rewritten, decreased by those that are
+    @return whether the budget ran out before all runs were rewritten
+
+    If it throws, runs already rewritten stay so, and the samples are
+    unchanged either way
+    */
+   bool Defragment(size_t &budget, DefragmentStatistics &statistics);
+
    //
    // Retrieving summary info
    //
@@ -215,6 +261,21 @@ class WAVE_TRACK_API Sequence final : public XMLTagHandler{
       sampleCount start, sampleCount len, bool mayThrow) const;
    float GetRMS(sampleCount start, sampleCount len, bool mayThrow) const;
 
+   //! A 256-sample summary frame of a block, or the part of one in a range
+   struct SummarySpan {
+      size_t length;
+      //! Greatest magnitude in the whole frame, or infinity if the summary
+      //! could not be read
+      float peak;
+      //! Whether the span is all of the frame, so that one of its samples
+      //! has the peak magnitude
+      bool whole;
+   };
+   //! Consecutive spans covering samples [start, start + len), from the
+   //! stored summaries, without reading the samples
+   std::vector<SummarySpan> GetSummarySpans(
+      sampleCount start, size_t len) const;
+
    //
    // Getting block size and alignment information
    //
@@ -276,6 +337,11 @@ class WAVE_TRACK_API Sequence final : public XMLTagHandler{
    SeqBlock::SampleBlockPtr DoAppend(
       constSamplePtr buffer, sampleFormat format, size_t len, bool coalesce);
 
+   //! Append the first len samples of mAppendBuffer as one new block, which
+   //! may take the storage of the buffer without copying
+   /*! @excsafety{Strong} */
+   void DoAppendStaged(size_t len);
+
    static void AppendBlock(SampleBlockFactory *pFactory, sampleFormat format,
                            BlockArray &blocks,
                            sampleCount &numSamples,
@@ -307,6 +373,19 @@ public:
 
    int FindBlock(sampleCount pos) const;
 
+   //! Hint to the blocks covering the range that they will soon be read
+   /*! @excsafety{No-fail} */
+   void Prefetch(sampleCount start, sampleCount len) const noexcept;
+
+   //! Whether all blocks covering the range are resident in memory
+   /*! @excsafety{No-fail} */
+   bool IsResident(sampleCount start, sampleCount len) const noexcept;
+
+   //! Keep resident all blocks covering the range, until the result is
+   //! destroyed; null if they are not all resident
+   std::shared_ptr<const void>
+   PinResident(sampleCount start, sampleCount len) const;
+
    static bool Read(samplePtr buffer, sampleFormat format,
              const SeqBlock &b,
              size_t blockRelativeStart, size_t len, bool mayThrow);
@@ -337,6 +416,26 @@ private:
       (BlockArray &additionalBlocks, bool replaceLast,
        sampleCount numSamples, const wxChar *whereStr);
 
+   //! Replace blocks [b0, b1) with the given ones, and move the start of all
+   //! later blocks so that the sequence has numSamples in all
+   /*!
+    Only the replacement is checked, and the array is edited in place, so
+    the cost of a local edit does not grow with copies of the whole array
+    */
+   void ReplaceBlocksIfConsistent(size_t b0, size_t b1,
+      BlockArray &replacement, sampleCount numSamples, const wxChar *whereStr);
+
+   //! Merge runs of adjacent blocks shorter than the minimum, in a
+   //! replacement for blocks [b0, b1) and with the blocks just outside
+   /*!
+    Keeps the fragments that edits leave at their ends, or bring in with
+    pasted sequences, from accumulating.  May widen [b0, b1) to replace a
+    merged neighbor too.  Changes nothing in this if it throws.
+    @param delta how much blocks after the range will move
+    */
+   void CoalesceFragments(size_t &b0, size_t &b1,
+      BlockArray &replacement, sampleCount delta) const;
+
 };
 
 #endif // __AUDACITY_SEQUENCE__
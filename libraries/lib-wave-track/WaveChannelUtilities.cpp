@@ -58,6 +58,38 @@ WaveChannelUtilities::GetMinMax(const WaveChannel &channel,
    return results;
 }
 
+std::vector<Sequence::SummarySpan> WaveChannelUtilities::GetSummarySpans(
+   const WaveChannel &channel, sampleCount start, size_t len)
+{
+   std::vector<Sequence::SummarySpan> result;
+   const auto end = start + len;
+   auto pos = start;
+   const auto addGap = [&](sampleCount until) {
+      if (until > pos) {
+         result.push_back({ (until - pos).as_size_t(), 0.0f, true });
+         pos = until;
+      }
+   };
+   for (const auto &pClip : SortedClipArray(channel)) {
+      const auto clipStart = pClip->GetPlayStartSample();
+      const auto clipEnd = pClip->GetPlayEndSample();
+      if (clipEnd <= pos || clipStart >= end)
+         continue;
+      if (pClip->HasPitchOrSpeed())
+         return {};
+      addGap(clipStart);
+      const auto spanEnd = std::min(clipEnd, end);
+      // Offset into the sequence as in WaveClip::GetSamples
+      const auto spans = pClip->GetSequence().GetSummarySpans(
+         pos - clipStart + pClip->TimeToSamples(pClip->GetTrimLeft()),
+         (spanEnd - pos).as_size_t());
+      result.insert(result.end(), spans.begin(), spans.end());
+      pos = spanEnd;
+   }
+   addGap(end);
+   return result;
+}
+
 float WaveChannelUtilities::GetRMS(const WaveChannel &channel,
    double t0, double t1, bool mayThrow)
 {
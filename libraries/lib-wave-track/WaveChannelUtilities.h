@@ -19,6 +19,7 @@ enum class sampleFormat : unsigned;
 class WaveChannel;
 class WaveClipChannel;
 
+#include "Sequence.h"
 #include <algorithm>
 #include <functional>
 #include <memory>
@@ -87,6 +88,15 @@ WAVE_TRACK_API std::pair<float, float> GetMinMax(const WaveChannel &channel,
 WAVE_TRACK_API float GetRMS(const WaveChannel &channel,
    double t0, double t1, bool mayThrow = true);
 
+//! Summary spans of the samples [start, start + len) that GetFloats() would
+//! fetch, with spans of zero peak for gaps between clips
+/*!
+ @return empty if a clip in the range has pitch or speed change, because the
+ summaries do not describe the rendered samples
+ */
+WAVE_TRACK_API std::vector<Sequence::SummarySpan> GetSummarySpans(
+   const WaveChannel &channel, sampleCount start, size_t len);
+
 /*!
  @brief Gets as many samples as it can, but no more than `2 *
  numSideSamples + 1`, centered around `t`. Reads nothing if
@@ -16,6 +16,9 @@
 #include "WaveClip.h"
 
 #include <math.h>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
 #include <numeric>
 #include <optional>
 #include <vector>
@@ -24,10 +27,13 @@
 #include "BasicUI.h"
 #include "Envelope.h"
 #include "InconsistencyException.h"
+#include "ObjectPool.h"
 #include "Resample.h"
 #include "Sequence.h"
+#include "StretchedClipCache.h"
 #include "TimeAndPitchInterface.h"
 #include "UserException.h"
+#include "concurrency/ThreadPool.h"
 
 #ifdef _OPENMP
 #include <omp.h>
@@ -59,6 +65,164 @@ void WaveClipListener::Erase(size_t)
 {
 }
 
+namespace {
+//! A stretched rendering held in sample blocks, one sequence per channel
+class SequenceRendering final : public StretchedClipRendering
+{
+public:
+   explicit SequenceRendering(std::vector<std::unique_ptr<Sequence>> sequences)
+      : mSequences{ move(sequences) }
+   {}
+
+   sampleCount GetSampleCount() const override
+   {
+      return mSequences[0]->GetNumSamples();
+   }
+
+   AudioSegmentSampleView GetSampleView(
+      size_t iChannel, sampleCount start, size_t length) const override
+   {
+      return mSequences[iChannel]->GetFloatSampleView(start, length, false);
+   }
+
+private:
+   const std::vector<std::unique_ptr<Sequence>> mSequences;
+};
+}
+
+//! The few most recent stretched renderings of one clip
+class WaveClipStretchCache final
+{
+public:
+   //! What a rendering depends on, besides the key
+   struct State {
+      //! Changes with the samples
+      unsigned long long generation;
+      sampleCount start;
+      sampleCount length;
+      int rate;
+
+      bool operator ==(const State &other) const
+      {
+         return generation == other.generation && start == other.start &&
+            length == other.length && rate == other.rate;
+      }
+   };
+
+   static constexpr size_t MaxEntries = 4;
+
+   unsigned long long Generation() const { return mGeneration.load(); }
+
+   void Invalidate() noexcept
+   {
+      ++mGeneration;
+      std::lock_guard<std::mutex> guard{ mMutex };
+      mEntries.clear();
+   }
+
+   std::shared_ptr<const StretchedClipRendering>
+   Find(const StretchedClipKey &key, const State &state)
+   {
+      std::lock_guard<std::mutex> guard{ mMutex };
+      for (const auto &entry : mEntries)
+         if (entry.key == key && entry.state == state)
+            return entry.pRendering;
+      return {};
+   }
+
+   void Add(const StretchedClipKey &key, const State &state,
+      std::shared_ptr<const StretchedClipRendering> pRendering)
+   {
+      std::lock_guard<std::mutex> guard{ mMutex };
+      if (state.generation != mGeneration)
+         return;
+      // Newest first
+      mEntries.insert(mEntries.begin(), { key, state, move(pRendering) });
+      if (mEntries.size() > MaxEntries)
+         mEntries.pop_back();
+   }
+
+private:
+   struct Entry {
+      StretchedClipKey key;
+      State state;
+      std::shared_ptr<const StretchedClipRendering> pRendering;
+   };
+
+   std::atomic<unsigned long long> mGeneration{ 0 };
+   std::mutex mMutex;
+   std::vector<Entry> mEntries;
+};
+
+namespace {
+class WaveClipStretchSlot final : public StretchedClipSlot
+{
+public:
+   WaveClipStretchSlot(std::shared_ptr<WaveClipStretchCache> pCache,
+      const StretchedClipKey &key, const WaveClipStretchCache::State &state,
+      SampleBlockFactoryPtr pFactory)
+      : mpCache{ move(pCache) }, mKey{ key }, mState{ state }
+      , mpFactory{ move(pFactory) }
+   {}
+
+   std::shared_ptr<const StretchedClipRendering> Find() const override
+   {
+      return mpCache->Find(mKey, mState);
+   }
+
+   void Store(std::vector<std::vector<float>> channels) override
+   {
+      // Make sample blocks in the main thread, as for other edits
+      BasicUI::CallAfter([
+         wCache = std::weak_ptr{ mpCache }, key = mKey, state = mState,
+         pFactory = mpFactory, channels = move(channels)
+      ]{
+         const auto pCache = wCache.lock();
+         if (!pCache || pCache->Generation() != state.generation)
+            return;
+         std::vector<std::unique_ptr<Sequence>> sequences;
+         try {
+            for (const auto &channel : channels) {
+               auto pSequence = std::make_unique<Sequence>(
+                  pFactory, SampleFormats{ floatSample, floatSample });
+               pSequence->Append(
+                  reinterpret_cast<constSamplePtr>(channel.data()),
+                  floatSample, channel.size(), 1, floatSample);
+               pSequence->Flush();
+               sequences.push_back(move(pSequence));
+            }
+         }
+         catch (...) {
+            // Not worth reporting; the clip is stretched again next time
+            return;
+         }
+         pCache->Add(key, state,
+            std::make_shared<SequenceRendering>(move(sequences)));
+      });
+   }
+
+private:
+   const std::shared_ptr<WaveClipStretchCache> mpCache;
+   const StretchedClipKey mKey;
+   const WaveClipStretchCache::State mState;
+   const SampleBlockFactoryPtr mpFactory;
+};
+}
+
+std::shared_ptr<WaveClipStretchCache> WaveClip::MakeStretchCache()
+{
+   return std::make_shared<WaveClipStretchCache>();
+}
+
+std::shared_ptr<StretchedClipSlot>
+WaveClip::GetStretchedClipSlot(const StretchedClipKey &key) const
+{
+   return std::make_shared<WaveClipStretchSlot>(mStretchCache, key,
+      WaveClipStretchCache::State{ mStretchCache->Generation(),
+         TimeToSamples(mTrimLeft), GetVisibleSampleCount(), mRate },
+      GetFactory());
+}
+
 WaveClipChannel::~WaveClipChannel() = default;
 
 Envelope &WaveClipChannel::GetEnvelope()
@@ -269,7 +433,7 @@ WaveClip::WaveClip(
    if (copyCutlines)
       for (const auto &clip: orig.mCutLines)
          mCutLines.push_back(
-            std::make_shared<WaveClip>(*clip, factory, true, token));
+            ObjectPool::MakeShared<WaveClip>(*clip, factory, true, token));
 
    mIsPlaceholder = orig.GetIsPlaceholder();
 
@@ -325,7 +489,7 @@ WaveClip::WaveClip(
    if (copyCutlines)
       for (const auto &cutline : orig.mCutLines)
          mCutLines.push_back(
-            std::make_shared<WaveClip>(*cutline, factory, true));
+            ObjectPool::MakeShared<WaveClip>(*cutline, factory, true));
 
    assert(NChannels() == orig.NChannels());
    assert(CheckInvariants());
@@ -408,6 +572,21 @@ void WaveClip::SetSamples(size_t ii,
    MarkChanged();
 }
 
+void WaveClip::Reverse(sampleCount start, sampleCount len)
+{
+   StrongInvariantScope scope{ *this };
+   Transaction transaction{ *this };
+
+   // use Strong-guarantee
+   const auto s0 = start + TimeToSamples(mTrimLeft);
+   for (auto &pSequence : mSequences)
+      pSequence->Reverse(s0, len);
+
+   // use No-fail-guarantee
+   transaction.Commit();
+   MarkChanged();
+}
+
 void WaveClip::SetEnvelope(std::unique_ptr<Envelope> p)
 {
    assert(p);
@@ -428,6 +607,7 @@ size_t WaveClip::GetAppendBufferLen(size_t iChannel) const
 
 void WaveClip::DiscardRightChannel()
 {
+   BoundsChanged();
    mSequences.resize(1);
    this->Attachments::ForEach([](WaveClipListener &attachment){
       attachment.Erase(1);
@@ -450,6 +630,23 @@ void WaveClip::SwapChannels()
    assert(CheckInvariants());
 }
 
+bool WaveClip::HasIdenticalChannels() const
+{
+   assert(NChannels() == 2);
+   const auto &left = *mSequences[0], &right = *mSequences[1];
+   if (left.GetAppendBufferLen() > 0 || right.GetAppendBufferLen() > 0)
+      return false;
+   const auto &leftBlocks = left.GetBlockArray();
+   const auto &rightBlocks = right.GetBlockArray();
+   if (!std::equal(leftBlocks.begin(), leftBlocks.end(),
+      rightBlocks.begin(), rightBlocks.end(),
+      [](const SeqBlock &a, const SeqBlock &b){
+         return a.sb == b.sb && a.start == b.start; }))
+      return false;
+   return std::all_of(mCutLines.begin(), mCutLines.end(),
+      [](const auto &pCutline){ return pCutline->HasIdenticalChannels(); });
+}
+
 void WaveClip::TransferSequence(WaveClip &origClip, WaveClip &newClip)
 {
    // Move right channel into result
@@ -483,7 +680,7 @@ std::shared_ptr<WaveClip> WaveClip::SplitChannels()
 
    // Make empty copies of this and all cutlines
    CreateToken token{ true };
-   auto result = std::make_shared<WaveClip>(*this, GetFactory(), true, token);
+   auto result = ObjectPool::MakeShared<WaveClip>(*this, GetFactory(), true, token);
 
    // Move one Sequence
    TransferSequence(*this, *result);
@@ -511,6 +708,7 @@ std::shared_ptr<WaveClip> WaveClip::SplitChannels()
 
 void WaveClip::MakeStereo(WaveClip &&other, bool mustAlign)
 {
+   BoundsChanged();
    assert(NChannels() == 1);
    assert(other.NChannels() == 1);
    assert(GetSampleFormats() == other.GetSampleFormats());
@@ -545,6 +743,11 @@ size_t WaveClip::GreatestAppendBufferLen() const
 void WaveClip::OnProjectTempoChange(
    const std::optional<double>& oldTempo, double newTempo)
 {
+   // Clips already at the tempo keep their bounds and their caches
+   if (mRawAudioTempo.has_value() &&
+       (oldTempo.has_value() ? *oldTempo == newTempo : mProjectTempo == newTempo))
+      return;
+   BoundsChanged();
    if (!mRawAudioTempo.has_value())
       // When we have tempo detection ready (either by header-file
       // read-up or signal analysis) we can use something smarter than that. In
@@ -568,6 +771,7 @@ void WaveClip::OnProjectTempoChange(
 
 void WaveClip::StretchLeftTo(double to)
 {
+   BoundsChanged();
    const auto pet = GetPlayEndTime();
    if (to >= pet)
       return;
@@ -587,6 +791,7 @@ void WaveClip::StretchLeftTo(double to)
 
 void WaveClip::StretchRightTo(double to)
 {
+   BoundsChanged();
    const auto pst = GetPlayStartTime();
    if (to <= pst)
       return;
@@ -598,6 +803,7 @@ void WaveClip::StretchRightTo(double to)
 
 void WaveClip::StretchBy(double ratio)
 {
+   BoundsChanged();
    const auto pst = GetPlayStartTime();
    mSequenceOffset = pst - mTrimLeft * ratio;
    mTrimLeft *= ratio;
@@ -732,9 +938,26 @@ constSamplePtr WaveClip::GetAppendBuffer(size_t ii) const
    return mSequences[ii]->GetAppendBuffer();
 }
 
+namespace {
+std::atomic<unsigned long long> sBoundsEpoch{ 0 };
+}
+
+unsigned long long WaveClip::GetBoundsEpoch() noexcept
+{
+   return sBoundsEpoch.load(std::memory_order_acquire);
+}
+
+void WaveClip::BoundsChanged() noexcept
+{
+   sBoundsEpoch.fetch_add(1, std::memory_order_acq_rel);
+}
+
 void WaveClip::MarkChanged() noexcept // NOFAIL-GUARANTEE
 {
+   // Most changes of samples change the length too
+   BoundsChanged();
    Attachments::ForEach(std::mem_fn(&WaveClipListener::MarkChanged));
+   mStretchCache->Invalidate();
 }
 
 std::pair<float, float> WaveClip::GetMinMax(size_t ii,
@@ -761,6 +984,51 @@ std::pair<float, float> WaveClip::GetMinMax(size_t ii,
    return mSequences[ii]->GetMinMax(s0, s1 - s0, mayThrow);
 }
 
+void WaveClip::Prefetch(double t0, double t1) const noexcept
+{
+   t0 = std::max(t0, GetPlayStartTime());
+   t1 = std::min(t1, GetPlayEndTime());
+   if (t0 >= t1)
+      return;
+   const auto s0 = TimeToSequenceSamples(t0);
+   const auto s1 = TimeToSequenceSamples(t1);
+   for (auto &pSequence : mSequences)
+      pSequence->Prefetch(s0, s1 - s0);
+}
+
+bool WaveClip::IsResident(double t0, double t1) const noexcept
+{
+   t0 = std::max(t0, GetPlayStartTime());
+   t1 = std::min(t1, GetPlayEndTime());
+   if (t0 >= t1)
+      return true;
+   const auto s0 = TimeToSequenceSamples(t0);
+   const auto s1 = TimeToSequenceSamples(t1);
+   for (auto &pSequence : mSequences)
+      if (!pSequence->IsResident(s0, s1 - s0))
+         return false;
+   return true;
+}
+
+std::shared_ptr<const void> WaveClip::PinResident(double t0, double t1) const
+{
+   std::vector<std::shared_ptr<const void>> pins;
+   t0 = std::max(t0, GetPlayStartTime());
+   t1 = std::min(t1, GetPlayEndTime());
+   if (t0 < t1) {
+      const auto s0 = TimeToSequenceSamples(t0);
+      const auto s1 = TimeToSequenceSamples(t1);
+      for (auto &pSequence : mSequences) {
+         auto pin = pSequence->PinResident(s0, s1 - s0);
+         if (!pin)
+            return nullptr;
+         pins.push_back(move(pin));
+      }
+   }
+   return std::make_shared<const std::vector<std::shared_ptr<const void>>>(
+      move(pins));
+}
+
 float WaveClip::GetRMS(size_t ii, double t0, double t1, bool mayThrow) const
 {
    assert(ii < NChannels());
@@ -803,6 +1071,30 @@ void WaveClip::ConvertToSampleFormat(sampleFormat format,
    transaction.Commit();
 }
 
+bool WaveClip::Defragment(
+   size_t &budget, DefragmentStatistics &statistics)
+{
+   // This mutator does not require the strong invariant.  It leaves sample
+   // counts unchanged in each sequence.
+   Transaction transaction{ *this };
+
+   auto newBudget = budget;
+   auto newStatistics = statistics;
+   bool exhausted = false;
+   for (auto &pSequence : mSequences)
+      if (pSequence->Defragment(newBudget, newStatistics)) {
+         exhausted = true;
+         break;
+      }
+   if (newStatistics.blocksBefore != statistics.blocksBefore)
+      MarkChanged();
+
+   transaction.Commit();
+   budget = newBudget;
+   statistics = newStatistics;
+   return exhausted;
+}
+
 /*! @excsafety{No-fail} */
 void WaveClip::UpdateEnvelopeTrackLen()
 {
@@ -866,6 +1158,18 @@ bool WaveClip::Append(size_t iChannel, const size_t nChannels,
    return appended;
 }
 
+void WaveClip::AppendDeferred(size_t iChannel,
+   const SampleBlockSourcePtr &pSource,
+   sampleCount start, sampleCount len, sampleFormat effectiveFormat)
+{
+   assert(iChannel < NChannels());
+   mSequences[iChannel]->AppendDeferred(pSource, start, len, effectiveFormat);
+
+   // use No-fail-guarantee
+   UpdateEnvelopeTrackLen();
+   MarkChanged();
+}
+
 bool WaveClip::Append(constSamplePtr buffers[], sampleFormat format,
    size_t len, unsigned int stride, sampleFormat effectiveFormat)
 {
@@ -917,6 +1221,7 @@ void WaveClip::Flush()
 
 void WaveClip::RepairChannels()
 {
+   BoundsChanged();
    if (NChannels() < 2)
       return;
    // Be sure of consistency of sample counts
@@ -946,6 +1251,7 @@ static constexpr auto Name_attr = "name";
 
 bool WaveClip::HandleXMLTag(const std::string_view& tag, const AttributesList &attrs)
 {
+   BoundsChanged();
    if (tag == WaveClip_tag)
    {
       double dblValue;
@@ -1052,7 +1358,7 @@ XMLTagHandler *WaveClip::HandleXMLChild(const std::string_view& tag)
       // Sequence::Sequence; but then the Sequence will deserialize format
       // again
       mCutLines.push_back(
-         std::make_shared<WaveClip>(
+         ObjectPool::MakeShared<WaveClip>(
             // Make only one channel now, but recursive deserialization
             // increases the width later
             1, pFirst->GetFactory(),
@@ -1104,7 +1410,7 @@ bool WaveClip::Paste(double t0, const WaveClip& o)
    if (!o.StrongInvariant()) {
       assert(false); // precondition not honored
       // But try to repair it and continue in release
-      dup = std::make_shared<WaveClip>(o, o.GetFactory(), true);
+      dup = ObjectPool::MakeShared<WaveClip>(o, o.GetFactory(), true);
       dup->RepairChannels();
       pOther = dup.get();
    }
@@ -1145,7 +1451,7 @@ bool WaveClip::Paste(double t0, const WaveClip& o)
       finisher = ClearSequence(GetSequenceStartTime(), t0);
       SetTrimLeft(other.GetTrimLeft());
 
-      auto copy = std::make_shared<WaveClip>(other, factory, true);
+      auto copy = ObjectPool::MakeShared<WaveClip>(other, factory, true);
       copy->ClearSequence(copy->GetPlayEndTime(), copy->GetSequenceEndTime())
          .Commit();
       newClip = std::move(copy);
@@ -1155,14 +1461,14 @@ bool WaveClip::Paste(double t0, const WaveClip& o)
       finisher = ClearSequence(GetPlayEndTime(), GetSequenceEndTime());
       SetTrimRight(other.GetTrimRight());
       
-      auto copy = std::make_shared<WaveClip>(other, factory, true);
+      auto copy = ObjectPool::MakeShared<WaveClip>(other, factory, true);
       copy->ClearSequence(copy->GetSequenceStartTime(), copy->GetPlayStartTime())
          .Commit();
       newClip = std::move(copy);
    }
    else
    {
-      newClip = std::make_shared<WaveClip>(other, factory, true);
+      newClip = ObjectPool::MakeShared<WaveClip>(other, factory, true);
       newClip->ClearSequence(newClip->GetPlayEndTime(), newClip->GetSequenceEndTime())
          .Commit();
       newClip->ClearSequence(newClip->GetSequenceStartTime(), newClip->GetPlayStartTime())
@@ -1173,7 +1479,7 @@ bool WaveClip::Paste(double t0, const WaveClip& o)
 
    if (clipNeedsResampling || clipNeedsNewFormat)
    {
-      auto copy = std::make_shared<WaveClip>(*newClip.get(), factory, true);
+      auto copy = ObjectPool::MakeShared<WaveClip>(*newClip.get(), factory, true);
 
       if (clipNeedsResampling)
          // The other clip's rate is different from ours, so resample
@@ -1189,7 +1495,7 @@ bool WaveClip::Paste(double t0, const WaveClip& o)
    WaveClipHolders newCutlines;
    for (const auto &cutline: newClip->mCutLines)
    {
-      auto cutlineCopy = std::make_shared<WaveClip>(*cutline, factory,
+      auto cutlineCopy = ObjectPool::MakeShared<WaveClip>(*cutline, factory,
          // Recursively copy cutlines of cutlines.  They don't need
          // their offsets adjusted.
          true);
@@ -1350,6 +1656,7 @@ auto WaveClip::ClearSequence(double t0, double t1) -> ClearSequenceFinisher
    // use Strong-guarantee
    for (auto &pSequence : mSequences)
       pSequence->Delete(s0, s1 - s0);
+   BoundsChanged();
    
    return { this, t0, t1, clip_t0, clip_t1 };
 }
@@ -1414,7 +1721,7 @@ void WaveClip::ClearAndAddCutLine(double t0, double t1)
    const double clip_t0 = std::max( t0, GetPlayStartTime() );
    const double clip_t1 = std::min( t1, GetPlayEndTime() );
 
-   auto newClip = std::make_shared<WaveClip>(
+   auto newClip = ObjectPool::MakeShared<WaveClip>(
       *this, GetFactory(), true, clip_t0, clip_t1);
    if(t1 < GetPlayEndTime())
    {
@@ -1582,6 +1889,7 @@ void WaveClip::SetRate(int rate)
 
 void WaveClip::SetRawAudioTempo(double tempo)
 {
+   BoundsChanged();
    mRawAudioTempo = tempo;
 }
 
@@ -1609,6 +1917,70 @@ PitchAndSpeedPreset WaveClip::GetPitchAndSpeedPreset() const
 }
 
 /*! @excsafety{Strong} */
+namespace {
+//! One channel of one segment of a clip to resample
+/*!
+ Input positions that are multiples of a step correspond exactly to output
+ positions, so that segments resampled independently join seamlessly.  Each
+ segment is preceded and followed by more input, to warm up the filter, but
+ only the output that corresponds to the segment itself is kept.
+ */
+struct ResampleJob {
+   const Sequence *pSequence{};
+   //! Input to feed, which contains the segment
+   sampleCount feedStart, feedEnd;
+   //! Output positions of the segment and of the start of feeding; no end
+   //! for the last segment, which keeps all that the resampler flushes
+   long long outStart{}, outFeedStart{};
+   std::optional<long long> outEnd;
+
+   std::vector<float> output;
+
+   void Run(double factor)
+   {
+      constexpr size_t bufsize = 65536;
+      Floats inBuffer{ bufsize };
+      Floats outBuffer{ bufsize };
+      auto pResample = ::Resample::Acquire(true, factor, factor);
+      auto pos = feedStart;
+      auto outPos = outFeedStart;
+      size_t outGenerated = 0;
+      if (outEnd)
+         output.reserve(*outEnd - outStart);
+      while (pos < feedEnd || outGenerated > 0) {
+         const auto inLen = limitSampleBufferSize(bufsize, feedEnd - pos);
+         const bool isLast = ((pos + inLen) == feedEnd);
+         if (!pSequence->Get(
+            (samplePtr)inBuffer.get(), floatSample, pos, inLen, true))
+            throw SimpleMessageBoxException{
+               ExceptionType::Internal,
+               XO("Resampling failed."),
+               XO("Warning"),
+               "Error:_Resampling"
+            };
+         const auto [used, generated] = pResample->Process(factor,
+            inBuffer.get(), inLen, isLast, outBuffer.get(), bufsize);
+         outGenerated = generated;
+         const auto made = static_cast<long long>(generated);
+         // Keep only the part within the segment
+         const auto keepStart = std::max(outPos, outStart);
+         const auto keepEnd = outEnd
+            ? std::min(outPos + made, *outEnd)
+            : outPos + made;
+         if (keepStart < keepEnd)
+            output.insert(output.end(),
+               outBuffer.get() + (keepStart - outPos),
+               outBuffer.get() + (keepEnd - outPos));
+         outPos += made;
+         pos += used;
+         if (outEnd && outPos >= *outEnd)
+            break;
+      }
+      ::Resample::Recycle(move(pResample));
+   }
+};
+}
+
 void WaveClip::Resample(int rate, BasicUI::ProgressDialog *progress)
 {
    // This mutator does not require the strong invariant.
@@ -1621,92 +1993,82 @@ void WaveClip::Resample(int rate, BasicUI::ProgressDialog *progress)
 
    // This function does its own RAII without a Transaction
 
-   double factor = (double)rate / (double)mRate;
-   ::Resample resample(true, factor, factor); // constant rate resampling
-
-   const size_t bufsize = 65536;
-   Floats inBuffer{ bufsize };
-   Floats outBuffer{ bufsize };
-   sampleCount pos = 0;
-   bool error = false;
-   int outGenerated = 0;
-   const auto numSamples = GetNumSamples();
+   const double factor = (double)rate / (double)mRate;
+   const auto numSamples = GetNumSamples().as_long_long();
 
    // These sequences are appended to below
    auto newSequences = GetEmptySequenceCopies();
 
-   /**
-    * We want to keep going as long as we have something to feed the resampler
-    * with OR as long as the resampler spews out samples (which could continue
-    * for a few iterations after we stop feeding it)
-    */
-   while (pos < numSamples || outGenerated > 0) {
-      const auto inLen = limitSampleBufferSize( bufsize, numSamples - pos );
-
-      bool isLast = ((pos + inLen) == numSamples);
-
-      auto ppNewSequence = newSequences.begin();
-      std::optional<std::pair<size_t, size_t>> results{};
-      for (auto &pSequence : mSequences) {
-         auto &pNewSequence = *ppNewSequence++;
-         if (!pSequence->Get((samplePtr)inBuffer.get(), floatSample, pos, inLen, true))
-         {
-            error = true;
-            break;
-         }
-
-         // Expect the same results for all channels, or else fail
-         auto newResults = resample.Process(factor, inBuffer.get(), inLen,
-            isLast, outBuffer.get(), bufsize);
-         if (!results)
-            results.emplace(newResults);
-         else if (*results != newResults) {
-            error = true;
-            break;
+   // Each channel has its own resampler.  Long clips are cut into segments
+   // whose boundaries are multiples of inStep, with enough extra input on
+   // each side to exceed the filter lengths of the best soxr methods
+   const auto divisor = std::gcd(rate, mRate);
+   const long long inStep = mRate / divisor, outStep = rate / divisor;
+   const auto roundUp = [inStep](long long count){
+      return std::max<long long>(1, (count + inStep - 1) / inStep) * inStep;
+   };
+   const auto segmentLen = roundUp(1 << 20);
+   const auto warmUp = roundUp(1 << 15);
+
+   auto &pool = audacity::concurrency::ThreadPool::GetDefault();
+   // A worker of the pool would run all jobs itself, so make fewer at once
+   // then
+   const bool parallel = !pool.IsWorkerThread();
+   const auto nChannels = mSequences.size();
+   const size_t jobsPerWave =
+      parallel ? pool.GetThreadsCount() + 1 : nChannels;
+   const size_t segmentsPerWave =
+      std::max<size_t>(1, (jobsPerWave + nChannels - 1) / nChannels);
+
+   long long segmentStart = 0;
+   do {
+      // Make a wave of jobs for consecutive segments and all channels
+      std::vector<ResampleJob> jobs;
+      jobs.reserve(segmentsPerWave * nChannels);
+      for (size_t iSegment = 0;
+         iSegment < segmentsPerWave && (segmentStart < numSamples || jobs.empty());
+         ++iSegment
+      ) {
+         const auto segmentEnd = std::min(segmentStart + segmentLen, numSamples);
+         const bool last = (segmentEnd == numSamples);
+         for (auto &pSequence : mSequences) {
+            auto &job = jobs.emplace_back();
+            job.pSequence = pSequence.get();
+            job.feedStart = std::max<long long>(0, segmentStart - warmUp);
+            job.feedEnd = std::min(numSamples, segmentEnd + warmUp);
+            job.outStart = segmentStart / inStep * outStep;
+            job.outFeedStart = job.feedStart.as_long_long() / inStep * outStep;
+            if (!last)
+               job.outEnd = segmentEnd / inStep * outStep;
          }
+         segmentStart = segmentEnd;
+      }
 
-         outGenerated = results->second;
-         if (outGenerated < 0) {
-            error = true;
-            break;
-         }
+      pool.ParallelFor(jobs.size(), [&](size_t ii){ jobs[ii].Run(factor); });
 
-         pNewSequence->Append((samplePtr)outBuffer.get(), floatSample,
-            outGenerated, 1,
+      // Append in order
+      for (size_t ii = 0; ii < jobs.size(); ++ii) {
+         auto &output = jobs[ii].output;
+         newSequences[ii % nChannels]->Append(
+            (samplePtr)output.data(), floatSample, output.size(), 1,
             widestSampleFormat /* computed samples need dither */
          );
       }
-      if (results)
-         pos += results->first;
 
       if (progress)
       {
-         auto updateResult = progress->Poll(
-            pos.as_long_long(),
-            numSamples.as_long_long()
-         );
-         error = (updateResult != BasicUI::ProgressResult::Success);
-         if (error)
+         auto updateResult = progress->Poll(segmentStart, numSamples);
+         if (updateResult != BasicUI::ProgressResult::Success)
             throw UserException{};
       }
-   }
+   } while (segmentStart < numSamples);
 
-   if (error)
-      throw SimpleMessageBoxException{
-         ExceptionType::Internal,
-         XO("Resampling failed."),
-         XO("Warning"),
-         "Error:_Resampling"
-      };
-   else
-   {
-      // Use No-fail-guarantee in these steps
-      mSequences = move(newSequences);
-      mRate = rate;
-      Flush();
-      Attachments::ForEach( std::mem_fn( &WaveClipListener::Invalidate ) );
-      MarkChanged();
-   }
+   // Use No-fail-guarantee in these steps
+   mSequences = move(newSequences);
+   mRate = rate;
+   Flush();
+   Attachments::ForEach( std::mem_fn( &WaveClipListener::Invalidate ) );
+   MarkChanged();
 }
 
 void WaveClip::SetName(const wxString& name)
@@ -1800,6 +2162,7 @@ sampleCount WaveClip::GetVisibleSampleCount() const
 
 void WaveClip::SetTrimLeft(double trim)
 {
+   BoundsChanged();
     mTrimLeft = std::max(.0, trim);
 }
 
@@ -1810,6 +2173,7 @@ double WaveClip::GetTrimLeft() const noexcept
 
 void WaveClip::SetTrimRight(double trim)
 {
+   BoundsChanged();
     mTrimRight = std::max(.0, trim);
 }
 
@@ -1849,6 +2213,7 @@ void WaveClip::TrimQuarternotesFromRight(double quarters)
 
 void WaveClip::TrimLeftTo(double to)
 {
+   BoundsChanged();
    mTrimLeft =
       std::clamp(to, SnapToTrackSample(mSequenceOffset), GetPlayEndTime()) -
       mSequenceOffset;
@@ -1856,6 +2221,7 @@ void WaveClip::TrimLeftTo(double to)
 
 void WaveClip::TrimRightTo(double to)
 {
+   BoundsChanged();
    const auto endTime = SnapToTrackSample(GetSequenceEndTime());
    mTrimRight = endTime - std::clamp(to, GetPlayStartTime(), endTime);
 }
@@ -1869,6 +2235,7 @@ double WaveClip::GetSequenceStartTime() const noexcept
 
 void WaveClip::SetSequenceStartTime(double startTime)
 {
+   BoundsChanged();
     mSequenceOffset = startTime;
     mEnvelope->SetOffset(startTime);
 }
@@ -2058,5 +2425,6 @@ WaveClip::Transaction::~Transaction()
       clip.mSequences.swap(sequences);
       clip.mTrimLeft = mTrimLeft;
       clip.mTrimRight = mTrimRight;
+      BoundsChanged();
    }
 }
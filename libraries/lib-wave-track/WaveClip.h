@@ -28,12 +28,16 @@
 #include <vector>
 
 class BlockArray;
+struct DefragmentStatistics;
 class Envelope;
 class sampleCount;
 class SampleBlock;
 class SampleBlockFactory;
 using SampleBlockFactoryPtr = std::shared_ptr<SampleBlockFactory>;
+class SampleBlockSource;
+using SampleBlockSourcePtr = std::shared_ptr<SampleBlockSource>;
 class Sequence;
+class WaveClipStretchCache;
 class wxFileNameWrapper;
 namespace BasicUI { class ProgressDialog; }
 
@@ -334,6 +338,13 @@ public:
    void ConvertToSampleFormat(sampleFormat format,
       const std::function<void(size_t)> & progressReport = {});
 
+   //! Merge runs of undersized blocks in each sequence, not in cutlines
+   /*!
+    @copydetails Sequence::Defragment
+    */
+   /*! @excsafety{Strong} */
+   bool Defragment(size_t &budget, DefragmentStatistics &statistics);
+
    int GetRate() const override
    {
       return mRate;
@@ -373,6 +384,11 @@ public:
    SubscribeToPitchAndSpeedPresetChange(
       std::function<void(PitchAndSpeedPreset)> cb) const override;
 
+   //! Renderings are kept in sample blocks of the clip's factory, and
+   //! forgotten when the samples change
+   std::shared_ptr<StretchedClipSlot>
+   GetStretchedClipSlot(const StretchedClipKey& key) const override;
+
    // Resample clip. This also will set the rate, but without changing
    // the length of the clip
    void Resample(int rate, BasicUI::ProgressDialog *progress = nullptr);
@@ -436,6 +452,10 @@ public:
    /*! @excsafety{No-fail} */
    void ShiftBy(double delta) noexcept;
 
+   //! A number that changes whenever the play region of any clip may change
+   /*! Lets tracks cache lookups of clips by time */
+   static unsigned long long GetBoundsEpoch() noexcept;
+
    //! The play region is an open-closed interval, [...), where "[ =
    //! GetPlayStartTime()", and ") = GetPlayEndTime()."
 
@@ -548,6 +568,16 @@ public:
       */
    );
 
+   //! Reverse the samples of all channels in [start, start + len), without
+   //! rewriting them; the envelope is unchanged
+   /*!
+    @pre `StrongInvariant()`
+    @post `StrongInvariant()`
+    @param start relative to clip play start sample
+    @excsafety{Strong}
+    */
+   void Reverse(sampleCount start, sampleCount len);
+
    //! @}
 
    Envelope &GetEnvelope() noexcept { return *mEnvelope; }
@@ -590,6 +620,20 @@ public:
     */
    float GetRMS(size_t ii, double t0, double t1, bool mayThrow) const;
 
+   //! Hint that samples of all channels, visible within [t0, t1], will soon
+   //! be needed
+   /*! @excsafety{No-fail} */
+   void Prefetch(double t0, double t1) const noexcept;
+
+   //! Whether samples of all channels, visible within [t0, t1], are resident
+   //! in memory
+   /*! @excsafety{No-fail} */
+   bool IsResident(double t0, double t1) const noexcept;
+
+   //! Keep resident the samples of all channels, visible within [t0, t1],
+   //! until the result is destroyed; null if they are not all resident
+   std::shared_ptr<const void> PinResident(double t0, double t1) const;
+
    /** Whenever you do an operation to the sequence that will change the number
     * of samples (that is, the length of the clip), you will want to call this
     * function to tell the envelope about it. */
@@ -641,6 +685,17 @@ public:
       */
    );
 
+   //! Append to one channel blocks whose samples stay in the source until
+   //! the factory copies them
+   /*!
+    The channel is flushed first.  Like Append(iChannel, ...), this may
+    violate the strong invariant condition until the other channels catch up.
+
+    @pre `iChannel < NChannels()`
+    */
+   void AppendDeferred(size_t iChannel, const SampleBlockSourcePtr &pSource,
+      sampleCount start, sampleCount len, sampleFormat effectiveFormat);
+
    //! Append (non-interleaved) samples to all channels
    //! You must call Flush after the last Append
    /*!
@@ -815,6 +870,11 @@ public:
    //! @pre `NChannels() == 2`
    void SwapChannels();
 
+   //! Whether both channels, and those of all cutlines, are the same
+   //! sequence of the same sample blocks, with nothing left to append
+   //! @pre `NChannels() == 2`
+   bool HasIdenticalChannels() const;
+
    //! A stereo WaveClip becomes mono, keeping the left side and returning a
    //! new clip with the right side samples
    /*!
@@ -873,6 +933,10 @@ private:
    /*! @excsafety{No-fail} */
    void MarkChanged() noexcept;
 
+   //! Called by operations that may move the ends of the play region
+   /*! @excsafety{No-fail} */
+   static void BoundsChanged() noexcept;
+
    // Always gives non-negative answer, not more than sample sequence length
    // even if t0 really falls outside that range
    sampleCount TimeToSequenceSamples(double t) const;
@@ -976,6 +1040,12 @@ private:
    bool mIsPlaceholder { false };
 
    wxString mName;
+
+   static std::shared_ptr<WaveClipStretchCache> MakeStretchCache();
+   //! Stretched renderings for playback; not copied with the clip
+   const std::shared_ptr<WaveClipStretchCache> mStretchCache {
+      MakeStretchCache()
+   };
 };
 
 #endif
@@ -0,0 +1,238 @@
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file WaveClipAnalysisCache.cpp
+
+**********************************************************************/
+#include "WaveClipAnalysisCache.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "SampleBlock.h"
+#include "Sequence.h"
+#include "XMLAttributeValueView.h"
+#include "XMLWriter.h"
+
+namespace {
+constexpr auto Analyses_attr = "analyses";
+
+//! FNV-1a, of the bytes of each value from least significant, so that the
+//! digest saved in a project is the same on any machine
+class Digester {
+public:
+   void Add(uint64_t value)
+   {
+      for (int ii = 0; ii < 8; ++ii) {
+         mHash ^= (value >> (8 * ii)) & 0xff;
+         mHash *= 0x100000001b3ull;
+      }
+   }
+   void Add(double value)
+   {
+      uint64_t bits;
+      memcpy(&bits, &value, sizeof(bits));
+      Add(bits);
+   }
+   uint64_t Get() const { return mHash; }
+private:
+   uint64_t mHash{ 0xcbf29ce484222325ull };
+};
+
+// Attribute value holds entries separated by ';' and their fields by ','
+void Escape(std::string &dest, std::string_view field)
+{
+   for (const auto c : field) {
+      switch (c) {
+      case '%': dest += "%25"; break;
+      case ',': dest += "%2C"; break;
+      case ';': dest += "%3B"; break;
+      default: dest += c; break;
+      }
+   }
+}
+
+int HexDigit(char c)
+{
+   return c >= '0' && c <= '9' ? c - '0'
+      : c >= 'A' && c <= 'F' ? c - 'A' + 10
+      : -1;
+}
+
+//! Takes malformed escapes literally
+std::string Unescape(std::string_view field)
+{
+   std::string result;
+   for (size_t ii = 0; ii < field.size(); ++ii) {
+      int high, low;
+      if (field[ii] == '%' && ii + 2 < field.size() &&
+          (high = HexDigit(field[ii + 1])) >= 0 &&
+          (low = HexDigit(field[ii + 2])) >= 0) {
+         result += static_cast<char>(high * 16 + low);
+         ii += 2;
+      }
+      else
+         result += field[ii];
+   }
+   return result;
+}
+
+std::vector<std::string_view> Split(std::string_view value, char separator)
+{
+   std::vector<std::string_view> result;
+   while (true) {
+      const auto pos = value.find(separator);
+      result.push_back(value.substr(0, pos));
+      if (pos == std::string_view::npos)
+         break;
+      value.remove_prefix(pos + 1);
+   }
+   return result;
+}
+}
+
+static WaveClip::Attachments::RegisteredFactory sKeyA{ [](WaveClip &) {
+   return std::make_unique<WaveClipAnalysisCache>();
+} };
+
+WaveClipAnalysisCache &WaveClipAnalysisCache::Get(WaveClip &clip)
+{
+   return clip.Attachments::Get<WaveClipAnalysisCache>(sKeyA);
+}
+
+const WaveClipAnalysisCache &WaveClipAnalysisCache::Get(const WaveClip &clip)
+{
+   return Get(const_cast<WaveClip&>(clip));
+}
+
+std::optional<uint64_t> WaveClipAnalysisCache::GetDigest(const WaveClip &clip)
+{
+   Digester digester;
+   digester.Add(static_cast<uint64_t>(clip.GetRate()));
+   digester.Add(clip.GetTrimLeft());
+   digester.Add(clip.GetTrimRight());
+   for (size_t ii = 0; ii < clip.NChannels(); ++ii) {
+      const auto &sequence = *clip.GetSequence(ii);
+      if (sequence.GetAppendBufferLen() > 0)
+         return {};
+      // Block IDs are never reused in a project; those of silence are
+      // negative lengths
+      for (const auto &block : sequence.GetBlockArray())
+         digester.Add(static_cast<uint64_t>(block.sb->GetBlockID()));
+      // Separate the channels
+      digester.Add(uint64_t{ 0 });
+   }
+   return digester.Get();
+}
+
+std::optional<std::string> WaveClipAnalysisCache::Find(const WaveClip &clip,
+   std::string_view type, std::string_view parameters)
+{
+   const auto digest = GetDigest(clip);
+   if (!digest)
+      return {};
+   auto &cache = Get(clip);
+   std::lock_guard<std::mutex> guard{ cache.mMutex };
+   const auto &entries = cache.mEntries;
+   const auto end = entries.end(),
+      found = std::find_if(entries.begin(), end, [&](const Entry &entry){
+         return entry.digest == *digest && entry.type == type &&
+            entry.parameters == parameters;
+      });
+   if (found == end)
+      return {};
+   return found->result;
+}
+
+void WaveClipAnalysisCache::Store(const WaveClip &clip,
+   std::string_view type, std::string_view parameters, std::string result)
+{
+   const auto digest = GetDigest(clip);
+   if (!digest)
+      return;
+   // const_cast: a clip is not modified by remembering facts about it
+   auto &cache = Get(const_cast<WaveClip&>(clip));
+   std::lock_guard<std::mutex> guard{ cache.mMutex };
+   auto &entries = cache.mEntries;
+   entries.erase(std::remove_if(entries.begin(), entries.end(),
+      [&](const Entry &entry){
+         return entry.digest != *digest ||
+            (entry.type == type && entry.parameters == parameters);
+      }), entries.end());
+   if (entries.size() >= MaxEntries)
+      entries.erase(entries.begin());
+   entries.push_back({ std::string{ type }, std::string{ parameters },
+      *digest, std::move(result) });
+}
+
+WaveClipAnalysisCache::WaveClipAnalysisCache() = default;
+
+WaveClipAnalysisCache::WaveClipAnalysisCache(
+   const WaveClipAnalysisCache &other)
+{
+   std::lock_guard<std::mutex> guard{ other.mMutex };
+   mEntries = other.mEntries;
+}
+
+WaveClipAnalysisCache::~WaveClipAnalysisCache() = default;
+
+std::unique_ptr<WaveClipListener> WaveClipAnalysisCache::Clone() const
+{
+   return std::make_unique<WaveClipAnalysisCache>(*this);
+}
+
+void WaveClipAnalysisCache::MarkChanged() noexcept
+{
+}
+
+void WaveClipAnalysisCache::Invalidate()
+{
+}
+
+void WaveClipAnalysisCache::WriteXMLAttributes(XMLWriter &writer) const
+{
+   std::string value;
+   {
+      std::lock_guard<std::mutex> guard{ mMutex };
+      for (const auto &entry : mEntries) {
+         if (!value.empty())
+            value += ';';
+         Escape(value, entry.type);
+         value += ',';
+         Escape(value, entry.parameters);
+         value += ',';
+         value += std::to_string(entry.digest);
+         value += ',';
+         Escape(value, entry.result);
+      }
+   }
+   if (!value.empty())
+      writer.WriteAttr(Analyses_attr, wxString::FromUTF8(value));
+}
+
+bool WaveClipAnalysisCache::HandleXMLAttribute(const std::string_view &attr,
+   const XMLAttributeValueView &valueView)
+{
+   if (attr != Analyses_attr)
+      return false;
+   const auto value = valueView.ToString();
+   std::vector<Entry> entries;
+   for (const auto entry : Split(value, ';')) {
+      const auto fields = Split(entry, ',');
+      if (fields.size() != 4)
+         continue;
+      Entry result{ Unescape(fields[0]), Unescape(fields[1]), 0,
+         Unescape(fields[3]) };
+      try {
+         result.digest = std::stoull(std::string{ fields[2] });
+      }
+      catch (const std::exception &) {
+         continue;
+      }
+      entries.push_back(std::move(result));
+   }
+   std::lock_guard<std::mutex> guard{ mMutex };
+   mEntries = std::move(entries);
+   return true;
+}
@@ -0,0 +1,80 @@
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file WaveClipAnalysisCache.h
+  @brief Remembers results of analyses of the audio of a clip
+
+**********************************************************************/
+#ifndef __AUDACITY_WAVE_CLIP_ANALYSIS_CACHE__
+#define __AUDACITY_WAVE_CLIP_ANALYSIS_CACHE__
+
+#include "WaveClip.h"
+
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+//! Attachment of a clip holding results of analyses, such as of tempo,
+//! loudness, peaks or silences, so that each is done once for the same audio
+/*!
+ Results are strings, in whatever form each type of analysis chooses, stored
+ under the type, the parameters of the analysis, and a digest of the sample
+ blocks, trims and rate of the clip.  So, no edit needs to invalidate them:
+ changed audio just stops matching.  Copies of the clip keep the results, and
+ they are saved with the project.
+
+ Find and Store may be called from worker threads, but the attachment must
+ first be made, with Get, in the main thread.
+ */
+class WAVE_TRACK_API WaveClipAnalysisCache final : public WaveClipListener
+{
+public:
+   //! Results kept for each clip; stale ones go first
+   static constexpr size_t MaxEntries = 16;
+
+   static WaveClipAnalysisCache &Get(WaveClip &clip);
+   static const WaveClipAnalysisCache &Get(const WaveClip &clip);
+
+   //! @return a digest of what the audio of the clip depends on, or nothing
+   //! if some samples are not yet in blocks
+   static std::optional<uint64_t> GetDigest(const WaveClip &clip);
+
+   //! @return a result stored for the present audio of the clip
+   static std::optional<std::string> Find(const WaveClip &clip,
+      std::string_view type, std::string_view parameters);
+
+   //! Remember a result for the present audio of the clip, if it has a digest
+   static void Store(const WaveClip &clip,
+      std::string_view type, std::string_view parameters, std::string result);
+
+   WaveClipAnalysisCache();
+   WaveClipAnalysisCache(const WaveClipAnalysisCache &other);
+   ~WaveClipAnalysisCache() override;
+
+   std::unique_ptr<WaveClipListener> Clone() const override;
+
+   void MarkChanged() noexcept override;
+   void Invalidate() override;
+
+   void WriteXMLAttributes(XMLWriter &writer) const override;
+   bool HandleXMLAttribute(const std::string_view &attr,
+      const XMLAttributeValueView &valueView) override;
+
+private:
+   struct Entry {
+      std::string type;
+      std::string parameters;
+      uint64_t digest;
+      std::string result;
+   };
+
+   mutable std::mutex mMutex;
+   //! Newest last
+   std::vector<Entry> mEntries;
+};
+
+#endif
@@ -36,6 +36,7 @@ from the project that will own the track.
 
 #include <algorithm>
 #include <float.h>
+#include <limits>
 #include <math.h>
 #include <numeric>
 #include <optional>
@@ -64,111 +65,148 @@ from the project that will own the track.
 
 
 #include "InconsistencyException.h"
+#include "ObjectPool.h"
 
 #include "ProjectFormatExtensionsRegistry.h"
+#include "concurrency/ThreadPool.h"
 
 #include <cmath>
 
 using std::max;
 
+namespace {
+//! The rendering of pitch and speed of one interval into a copy
 /*!
- * @post result: `result->GetStretchRatio() == 1`
+ Steps of stretching are independent of other intervals and may run in a
+ worker thread, while the owning thread appends the results of the steps
  */
-namespace {
-WaveTrack::IntervalHolder GetRenderedCopy(
-   const WaveTrack::IntervalHolder &pInterval,
-   const std::function<void(double)>& reportProgress,
-   const SampleBlockFactoryPtr& factory, sampleFormat format)
-{
-   auto &interval = *pInterval;
-   using Interval = WaveTrack::Interval;
-   if (!interval.HasPitchOrSpeed())
-      return pInterval;
+class RenderJob
+{
+public:
+   //! Samples of each channel that one step makes
+   static constexpr size_t StepSize = 1 << 16;
+
+   //! @pre `pInterval->HasPitchOrSpeed()`
+   RenderJob(const WaveTrack::IntervalHolder &pInterval,
+      const SampleBlockFactoryPtr &factory, sampleFormat format)
+      : mpInterval{ pInterval }
+      , mDst{ std::make_shared<WaveTrack::Interval>(
+         pInterval->NChannels(), factory, format, pInterval->GetRate()) }
+      , mOriginalPlayStartTime{ pInterval->GetPlayStartTime() }
+      , mOriginalPlayEndTime{ pInterval->GetPlayEndTime() }
+   {
+      auto &interval = *mpInterval;
+      const auto stretchRatio = interval.GetStretchRatio();
+      // Leave 1 second of raw, unstretched audio before and after visible
+      // region to give the algorithm a chance to be in a steady state when
+      // reaching the play boundaries.
+      mTmpPlayStartTime = std::max(
+         interval.GetSequenceStartTime(), mOriginalPlayStartTime - stretchRatio);
+      const auto tmpPlayEndTime = std::min(
+         interval.GetSequenceEndTime(), mOriginalPlayEndTime + stretchRatio);
+      interval.TrimLeftTo(mTmpPlayStartTime);
+      interval.TrimRightTo(tmpPlayEndTime);
+
+      constexpr auto sourceDurationToDiscard = 0.;
+      mSource.emplace(
+         interval, sourceDurationToDiscard, PlaybackDirection::forward);
+      TimeAndPitchInterface::Parameters params;
+      params.timeRatio = stretchRatio;
+      params.pitchRatio = std::pow(2., interval.GetCentShift() / 1200.);
+      params.preserveFormants = interval.GetPitchAndSpeedPreset() ==
+         PitchAndSpeedPreset::OptimizeForVoice;
+      mStretcher.emplace(interval.GetRate(), interval.NChannels(), *mSource,
+         std::move(params));
+
+      // Post-rendering sample counts, i.e., stretched units
+      mTotalNumOutSamples = sampleCount {
+         interval.GetVisibleSampleCount().as_double() * stretchRatio };
+      mBuffers.resize(interval.NChannels());
+      for (auto &buffer : mBuffers)
+         buffer.resize(StepSize);
+   }
 
-   const auto dst = std::make_shared<Interval>(
-      interval.NChannels(), factory, format, interval.GetRate());
+   ~RenderJob()
+   {
+      // The source is unchanged, whether or not it is replaced by the copy
+      auto &interval = *mpInterval;
+      interval.TrimLeftTo(mOriginalPlayStartTime);
+      interval.TrimRightTo(mOriginalPlayEndTime);
+   }
 
-   const auto originalPlayStartTime = interval.GetPlayStartTime();
-   const auto originalPlayEndTime = interval.GetPlayEndTime();
-   const auto stretchRatio = interval.GetStretchRatio();
+   bool Done() const { return mNumOutSamples >= mTotalNumOutSamples; }
+   double Rendered() const { return mNumOutSamples.as_double(); }
+   double Total() const { return mTotalNumOutSamples.as_double(); }
 
-   auto success = false;
-   Finally Do { [&] {
-      if (!success)
-      {
-         interval.TrimLeftTo(originalPlayStartTime);
-         interval.TrimRightTo(originalPlayEndTime);
+   //! Stretch the next step into the buffers; may run in a worker thread
+   void Step()
+   {
+      constexpr auto blockSize = 1024;
+      const auto numSamples = limitSampleBufferSize(
+         StepSize, mTotalNumOutSamples - mNumOutSamples);
+      float *channels[2]{};
+      mStepSamples = 0;
+      while (mStepSamples < numSamples) {
+         const auto numSamplesToGet =
+            std::min<size_t>(blockSize, numSamples - mStepSamples);
+         for (size_t ii = 0; ii < mBuffers.size(); ++ii)
+            channels[ii] = mBuffers[ii].data() + mStepSamples;
+         mStretcher->GetSamples(channels, numSamplesToGet);
+         mStepSamples += numSamplesToGet;
       }
-   } };
-
-   // Leave 1 second of raw, unstretched audio before and after visible region
-   // to give the algorithm a chance to be in a steady state when reaching the
-   // play boundaries.
-   const auto tmpPlayStartTime =
-      std::max(interval.GetSequenceStartTime(), originalPlayStartTime - stretchRatio);
-   const auto tmpPlayEndTime =
-      std::min(interval.GetSequenceEndTime(), originalPlayEndTime + stretchRatio);
-   interval.TrimLeftTo(tmpPlayStartTime);
-   interval.TrimRightTo(tmpPlayEndTime);
-
-   constexpr auto sourceDurationToDiscard = 0.;
-   constexpr auto blockSize = 1024;
-   const auto numChannels = interval.NChannels();
-   ClipTimeAndPitchSource stretcherSource { interval, sourceDurationToDiscard,
-                                            PlaybackDirection::forward };
-   TimeAndPitchInterface::Parameters params;
-   params.timeRatio = stretchRatio;
-   params.pitchRatio = std::pow(2., interval.GetCentShift() / 1200.);
-   params.preserveFormants =
-      interval.GetPitchAndSpeedPreset() == PitchAndSpeedPreset::OptimizeForVoice;
-   StaffPadTimeAndPitch stretcher { interval.GetRate(), numChannels,
-                                    stretcherSource, std::move(params) };
-
-   // Post-rendering sample counts, i.e., stretched units
-   const auto totalNumOutSamples =
-      sampleCount { interval.GetVisibleSampleCount().as_double() *
-                    stretchRatio };
-
-   sampleCount numOutSamples { 0 };
-   AudioContainer container(blockSize, numChannels);
-
-   while (numOutSamples < totalNumOutSamples)
+   }
+
+   //! Append the results of Step() to the copy
+   void Append()
    {
-      const auto numSamplesToGet =
-         limitSampleBufferSize(blockSize, totalNumOutSamples - numOutSamples);
-      stretcher.GetSamples(container.Get(), numSamplesToGet);
       constSamplePtr data[2];
-      data[0] = reinterpret_cast<constSamplePtr>(container.Get()[0]);
-      if (interval.NChannels() == 2)
-         data[1] = reinterpret_cast<constSamplePtr>(container.Get()[1]);
-      dst->Append(data, floatSample, numSamplesToGet, 1, widestSampleFormat);
-      numOutSamples += numSamplesToGet;
-      if (reportProgress)
-         reportProgress(
-            numOutSamples.as_double() / totalNumOutSamples.as_double());
+      for (size_t ii = 0; ii < mBuffers.size(); ++ii)
+         data[ii] = reinterpret_cast<constSamplePtr>(mBuffers[ii].data());
+      mDst->Append(data, floatSample, mStepSamples, 1, widestSampleFormat);
+      mNumOutSamples += mStepSamples;
    }
-   dst->Flush();
 
-   // Now we're all like `this` except unstretched. We can clear leading and
-   // trailing, stretching transient parts.
-   dst->SetPlayStartTime(tmpPlayStartTime);
-   dst->ClearLeft(originalPlayStartTime);
-   dst->ClearRight(originalPlayEndTime);
-
-   // We don't preserve cutlines but the relevant part of the envelope.
-   auto dstEnvelope = std::make_unique<Envelope>(interval.GetEnvelope());
-   const auto samplePeriod = 1. / interval.GetRate();
-   dstEnvelope->CollapseRegion(
-      originalPlayEndTime, interval.GetSequenceEndTime() + samplePeriod, samplePeriod);
-   dstEnvelope->CollapseRegion(0, originalPlayStartTime, samplePeriod);
-   dstEnvelope->SetOffset(originalPlayStartTime);
-   dst->SetEnvelope(move(dstEnvelope));
-
-   success = true;
+   /*!
+    @pre `Done()`
+    @post result: `result->GetStretchRatio() == 1`
+    */
+   WaveTrack::IntervalHolder Finish()
+   {
+      auto &interval = *mpInterval;
+      mDst->Flush();
+
+      // Now we're all like `this` except unstretched. We can clear leading
+      // and trailing, stretching transient parts.
+      mDst->SetPlayStartTime(mTmpPlayStartTime);
+      mDst->ClearLeft(mOriginalPlayStartTime);
+      mDst->ClearRight(mOriginalPlayEndTime);
+
+      // We don't preserve cutlines but the relevant part of the envelope.
+      auto dstEnvelope = std::make_unique<Envelope>(interval.GetEnvelope());
+      const auto samplePeriod = 1. / interval.GetRate();
+      dstEnvelope->CollapseRegion(mOriginalPlayEndTime,
+         interval.GetSequenceEndTime() + samplePeriod, samplePeriod);
+      dstEnvelope->CollapseRegion(0, mOriginalPlayStartTime, samplePeriod);
+      dstEnvelope->SetOffset(mOriginalPlayStartTime);
+      mDst->SetEnvelope(move(dstEnvelope));
+
+      assert(!mDst->HasPitchOrSpeed());
+      return mDst;
+   }
 
-   assert(!dst->HasPitchOrSpeed());
-   return dst;
-}
+private:
+   const WaveTrack::IntervalHolder mpInterval;
+   const WaveTrack::IntervalHolder mDst;
+   const double mOriginalPlayStartTime;
+   const double mOriginalPlayEndTime;
+   double mTmpPlayStartTime{};
+   std::optional<ClipTimeAndPitchSource> mSource;
+   std::optional<StaffPadTimeAndPitch> mStretcher;
+   sampleCount mTotalNumOutSamples{ 0 };
+   sampleCount mNumOutSamples{ 0 };
+   std::vector<std::vector<float>> mBuffers;
+   size_t mStepSamples{ 0 };
+};
 }
 
 std::shared_ptr<const WaveTrack::Interval>
@@ -202,11 +240,51 @@ WaveTrack::IntervalHolder WaveTrack::GetNextInterval(
 
 WaveTrack::IntervalHolder WaveTrack::GetIntervalAtTime(double t)
 {
-   IntervalHolder result;
-   for (const auto &interval : Intervals())
-      if (interval->WithinPlayRegion(t))
-         return interval;
-   return nullptr;
+   const auto lock = mClipIndex.Update(mClips);
+   return mClipIndex.Find(t);
+}
+
+void WaveTrack::ClipIndex::Invalidate() noexcept
+{
+   std::lock_guard<std::mutex> guard{ mMutex };
+   mValid = false;
+}
+
+std::unique_lock<std::mutex>
+WaveTrack::ClipIndex::Update(const WaveClipHolders &clips)
+{
+   std::unique_lock<std::mutex> lock{ mMutex };
+   const auto epoch = WaveClip::GetBoundsEpoch();
+   if (mValid && epoch == mEpoch)
+      return lock;
+
+   mSorted = clips;
+   std::stable_sort(mSorted.begin(), mSorted.end(),
+      [](const auto &pA, const auto &pB){
+         return pA->GetPlayStartTime() < pB->GetPlayStartTime(); });
+   const auto size = mSorted.size();
+   mStarts.resize(size);
+   mEnds.resize(size);
+   mMaxEnds.resize(size);
+   auto maxEnd = -std::numeric_limits<double>::infinity();
+   for (size_t ii = 0; ii < size; ++ii) {
+      mStarts[ii] = mSorted[ii]->GetPlayStartTime();
+      mEnds[ii] = mSorted[ii]->GetPlayEndTime();
+      mMaxEnds[ii] = maxEnd = std::max(maxEnd, mEnds[ii]);
+   }
+   mEpoch = epoch;
+   mValid = true;
+   return lock;
+}
+
+const WaveClipHolder &WaveTrack::ClipIndex::Find(double t) const
+{
+   static const WaveClipHolder null;
+   const auto end = std::upper_bound(mStarts.begin(), mStarts.end(), t);
+   for (auto ii = end - mStarts.begin(); ii-- > 0 && mMaxEnds[ii] > t;)
+      if (mEnds[ii] > t)
+         return mSorted[ii];
+   return null;
 }
 
 namespace {
@@ -520,7 +598,7 @@ void WaveTrack::CopyClips(WaveClipHolders &clips,
 {
    for (const auto &clip : orig)
       InsertClip(clips,
-         std::make_shared<WaveClip>(*clip, pFactory, true),
+         ObjectPool::MakeShared<WaveClip>(*clip, pFactory, true),
          false, backup, false);
 }
 
@@ -750,6 +828,8 @@ WaveChannel::Intervals() const {
 
 WaveClipHolders &WaveTrack::NarrowClips()
 {
+   // The caller may add or remove clips
+   mClipIndex.Invalidate();
    return mClips;
 }
 
@@ -1047,6 +1127,7 @@ auto WaveTrack::SplitChannels() -> std::vector<Holder>
       auto pNewTrack = result.emplace_back(EmptyCopy(1));
       for (auto &pClip : mClips)
          pNewTrack->mClips.emplace_back(pClip->SplitChannels());
+      pNewTrack->mClipIndex.Invalidate();
       this->mRightChannel.reset();
       auto iter = pOwner->Find(this);
       pOwner->Insert(*++iter, pNewTrack);
@@ -1070,6 +1151,13 @@ void WaveTrack::SwapChannels()
    });
 }
 
+bool WaveTrack::HasIdenticalChannels() const
+{
+   assert(NChannels() == 2);
+   return std::all_of(mClips.begin(), mClips.end(),
+      [](const auto &pClip){ return pClip->HasIdenticalChannels(); });
+}
+
 Track::Holder WaveTrack::Copy(double t0, double t1, bool forClipboard) const
 {
    if (t1 < t0)
@@ -1915,6 +2003,7 @@ bool WaveTrack::InsertClip(WaveClipHolders &clips, WaveClipHolder clip,
    if (tempo.has_value())
       clip->OnProjectTempoChange(std::nullopt, *tempo);
    clips.push_back(std::move(clip));
+   mClipIndex.Invalidate();
    Publish({ clips.back(),
       newClip ? WaveTrackMessage::New : WaveTrackMessage::Inserted });
 
@@ -1923,13 +2012,30 @@ bool WaveTrack::InsertClip(WaveClipHolders &clips, WaveClipHolder clip,
 
 void WaveTrack::ApplyPitchAndSpeed(
    std::optional<TimeInterval> interval, ProgressReporter reportProgress)
+{
+   ApplyPitchAndSpeed({ this }, interval, std::move(reportProgress));
+}
+
+void WaveTrack::ApplyPitchAndSpeed(const std::vector<WaveTrack*> &tracks,
+   std::optional<TimeInterval> interval, ProgressReporter reportProgress)
+{
+   TrackIntervals srcIntervals;
+   for (const auto pTrack : tracks)
+      if (auto intervals = pTrack->SplitForPitchAndSpeed(interval);
+          !intervals.empty())
+         srcIntervals.emplace_back(pTrack, move(intervals));
+   ApplyPitchAndSpeedOnIntervals(srcIntervals, reportProgress);
+}
+
+auto WaveTrack::SplitForPitchAndSpeed(std::optional<TimeInterval> interval)
+   -> IntervalHolders
 {
    // Assert that the interval is reasonable, but this function will be no-op
    // anyway if not
    assert(!interval.has_value() ||
           interval->first <= interval->second);
    if (GetNumClips() == 0)
-      return;
+      return {};
    const auto startTime =
       interval ? std::max(SnapToSample(interval->first), GetStartTime()) :
                  GetStartTime();
@@ -1937,7 +2043,7 @@ void WaveTrack::ApplyPitchAndSpeed(
       interval ? std::min(SnapToSample(interval->second), GetEndTime()) :
                  GetEndTime();
    if (startTime >= endTime)
-      return;
+      return {};
 
    // Here we assume that left- and right clips are aligned.
    if (auto clipAtT0 = GetClipAtTime(startTime);
@@ -1957,8 +2063,7 @@ void WaveTrack::ApplyPitchAndSpeed(
          srcIntervals.push_back(clip);
       clip = GetNextInterval(*clip, PlaybackDirection::forward);
    }
-
-   ApplyPitchAndSpeedOnIntervals(srcIntervals, reportProgress);
+   return srcIntervals;
 }
 
 /*! @excsafety{Weak} */
@@ -2221,6 +2326,13 @@ bool WaveChannel::Append(constSamplePtr buffer, sampleFormat format,
       .Append(iChannel, buffer, format, len, 1, widestSampleFormat);
 }
 
+void WaveChannel::AppendDeferred(const SampleBlockSourcePtr &pSource,
+   sampleCount start, sampleCount len, sampleFormat effectiveFormat)
+{
+   GetTrack()
+      .AppendDeferred(GetChannelIndex(), pSource, start, len, effectiveFormat);
+}
+
 /*! @excsafety{Partial}
 -- Some prefix (maybe none) of the buffer is appended,
 and no content already flushed to disk is lost. */
@@ -2236,6 +2348,15 @@ bool WaveTrack::Append(size_t iChannel,
       buffers, format, len, stride, effectiveFormat);
 }
 
+void WaveTrack::AppendDeferred(size_t iChannel,
+   const SampleBlockSourcePtr &pSource,
+   sampleCount start, sampleCount len, sampleFormat effectiveFormat)
+{
+   assert(iChannel < NChannels());
+   RightmostOrNewClip()
+      ->AppendDeferred(iChannel, pSource, start, len, effectiveFormat);
+}
+
 size_t WaveTrack::GetBestBlockSize(sampleCount s) const
 {
    auto bestBlockSize = GetMaxBlockSize();
@@ -2437,7 +2558,7 @@ XMLTagHandler *WaveTrack::HandleXMLChild(const std::string_view& tag)
       // though the consistency check of channels with each other remains to do.
       // Not all `WaveTrackData` fields are properly initialized by now,
       // use deserialization helpers.
-      auto clip = std::make_shared<WaveClip>(1,
+      auto clip = ObjectPool::MakeShared<WaveClip>(1,
          mpFactory, mLegacyFormat, mLegacyRate);
       const auto xmlHandler = clip.get();
       auto &clips = NarrowClips();
@@ -2919,16 +3040,56 @@ void WaveTrack::GetEnvelopeValues(
       std::reverse(buffer, buffer + bufferLen);
 }
 
+void WaveChannel::Prefetch(double t0, double t1) const noexcept
+{
+   GetTrack().Prefetch(t0, t1);
+}
+
+void WaveTrack::Prefetch(double t0, double t1) const noexcept
+{
+   for (const auto &clip: Intervals())
+      clip->Prefetch(t0, t1);
+}
+
+bool WaveChannel::IsResident(double t0, double t1) const noexcept
+{
+   return GetTrack().IsResident(t0, t1);
+}
+
+bool WaveTrack::IsResident(double t0, double t1) const noexcept
+{
+   for (const auto &clip: Intervals())
+      if (!clip->IsResident(t0, t1))
+         return false;
+   return true;
+}
+
+std::shared_ptr<const void>
+WaveChannel::PinResident(double t0, double t1) const
+{
+   return GetTrack().PinResident(t0, t1);
+}
+
+std::shared_ptr<const void>
+WaveTrack::PinResident(double t0, double t1) const
+{
+   std::vector<std::shared_ptr<const void>> pins;
+   for (const auto &clip: Intervals()) {
+      auto pin = clip->PinResident(t0, t1);
+      if (!pin)
+         return nullptr;
+      pins.push_back(move(pin));
+   }
+   return std::make_shared<const std::vector<std::shared_ptr<const void>>>(
+      move(pins));
+}
+
 // When the time is both the end of a clip and the start of the next clip, the
 // latter clip is returned.
 auto WaveTrack::GetClipAtTime(double time) const -> IntervalConstHolder
 {
-   const auto clips = SortedClipArray();
-   auto p = std::find_if(
-      clips.rbegin(), clips.rend(), [&](const auto &pClip) {
-         return pClip->WithinPlayRegion(time);
-      });
-   return p != clips.rend() ? *p : nullptr;
+   const auto lock = mClipIndex.Update(mClips);
+   return mClipIndex.Find(time);
 }
 
 auto WaveTrack::CreateClip(double offset, const wxString& name,
@@ -2936,7 +3097,7 @@ auto WaveTrack::CreateClip(double offset, const wxString& name,
 {
    if (pToCopy) {
       auto pNewClip =
-         std::make_shared<WaveClip>(*pToCopy, mpFactory, copyCutlines);
+         ObjectPool::MakeShared<WaveClip>(*pToCopy, mpFactory, copyCutlines);
       pNewClip->SetName(name);
       pNewClip->SetSequenceStartTime(offset);
       return pNewClip;
@@ -2960,7 +3121,7 @@ void WaveTrack::CreateRight()
 auto WaveTrack::DoCreateClip(double offset, const wxString& name) const
    -> WaveClipHolder
 {
-   auto clip = std::make_shared<WaveClip>(NChannels(),
+   auto clip = ObjectPool::MakeShared<WaveClip>(NChannels(),
       mpFactory, GetSampleFormat(), GetRate());
    clip->SetName(name);
    clip->SetSequenceStartTime(offset);
@@ -3086,41 +3247,36 @@ bool WaveTrack::CanOffsetClips(
 bool WaveTrack::CanInsertClip(
    const Interval& candidateClip, double& slideBy, double tolerance) const
 {
-   const auto &clips = Intervals();
-   if (clips.empty())
+   if (mClips.empty())
       return true;
+   const auto lock = mClipIndex.Update(mClips);
    // Find clip in this that overlaps most with `clip`:
    const auto candidateClipStartTime = candidateClip.GetPlayStartTime();
    const auto candidateClipEndTime = candidateClip.GetPlayEndTime();
    const auto t0 = SnapToSample(candidateClipStartTime + slideBy);
    const auto t1 = SnapToSample(candidateClipEndTime + slideBy);
-   std::vector<double> overlaps;
-   std::transform(
-      clips.begin(), clips.end(), std::back_inserter(overlaps),
-      [&](const auto& pClip) {
-         return pClip->IntersectsPlayRegion(t0, t1) ?
-                   std::min(pClip->GetPlayEndTime(), t1) -
-                      std::max(pClip->GetPlayStartTime(), t0) :
-                   0.0;
-      });
-   const auto maxOverlap = std::max_element(overlaps.begin(), overlaps.end());
-   if (*maxOverlap > tolerance)
+   // Only clips intersecting the candidate can overlap it; if none does, the
+   // overlap is zero and the slide stays as it is
+   auto maxOverlap = 0.0;
+   const Interval *overlappedClip = nullptr;
+   mClipIndex.AnyIntersecting(t0, t1, [&](const auto &pClip){
+      const auto overlap = std::min(pClip->GetPlayEndTime(), t1) -
+         std::max(pClip->GetPlayStartTime(), t0);
+      if (!overlappedClip || overlap > maxOverlap) {
+         maxOverlap = overlap;
+         overlappedClip = pClip.get();
+      }
       return false;
-   auto iter = clips.begin();
-   std::advance(iter, std::distance(overlaps.begin(), maxOverlap));
-   const auto overlappedClip = *iter;
-   const auto requiredOffset =  slideBy +
-             *maxOverlap * (overlappedClip->GetPlayStartTime() < t0 ? 1 : -1);
-   // Brute-force check to see if there's another clip that'd be in the way.
-   if (std::any_of(
-          clips.begin(), clips.end(),
-          [&](const auto& pClip)
-          {
-             const auto result = pClip->IntersectsPlayRegion(
-                SnapToSample(candidateClipStartTime + requiredOffset),
-                SnapToSample(candidateClipEndTime + requiredOffset));
-             return result;
-          }))
+   });
+   if (maxOverlap > tolerance)
+      return false;
+   const auto requiredOffset = !overlappedClip ? slideBy : slideBy +
+             maxOverlap * (overlappedClip->GetPlayStartTime() < t0 ? 1 : -1);
+   // Check to see if there's another clip that'd be in the way.
+   if (mClipIndex.AnyIntersecting(
+          SnapToSample(candidateClipStartTime + requiredOffset),
+          SnapToSample(candidateClipEndTime + requiredOffset),
+          [](const auto &){ return true; }))
       return false;
    slideBy = requiredOffset;
    return true;
@@ -3181,19 +3337,82 @@ void WaveTrack::ApplyPitchAndSpeedOnIntervals(
    const IntervalHolders& srcIntervals,
    const ProgressReporter& reportProgress)
 {
-   IntervalHolders dstIntervals;
-   dstIntervals.reserve(srcIntervals.size());
-   std::transform(
-      srcIntervals.begin(), srcIntervals.end(),
-      std::back_inserter(dstIntervals), [&](const IntervalHolder& interval) {
-         return GetRenderedCopy(interval,
-            reportProgress, mpFactory, GetSampleFormat());
-      });
+   ApplyPitchAndSpeedOnIntervals(
+      TrackIntervals{ { this, srcIntervals } }, reportProgress);
+}
+
+void WaveTrack::ApplyPitchAndSpeedOnIntervals(
+   const TrackIntervals &srcIntervals,
+   const ProgressReporter& reportProgress)
+{
+   // Flatten the intervals to render, of all tracks
+   struct Source {
+      WaveTrack &track;
+      IntervalHolder interval;
+      IntervalHolder rendered;
+   };
+   std::vector<Source> sources;
+   for (const auto &[pTrack, intervals] : srcIntervals)
+      for (const auto &interval : intervals)
+         sources.push_back({ *pTrack, interval,
+            // An interval without pitch or speed is its own rendering
+            interval->HasPitchOrSpeed() ? nullptr : interval });
+
+   // Total of stretched samples, for progress
+   double total = 0;
+   for (const auto &source : sources)
+      if (!source.rendered)
+         total += source.interval->GetVisibleSampleCount().as_double() *
+            source.interval->GetStretchRatio();
+   double finished = 0;
+
+   auto &pool = audacity::concurrency::ThreadPool::GetDefault();
+   // A worker of the pool would step all jobs itself, so set up one at a time
+   // then
+   const bool parallel = !pool.IsWorkerThread() && pool.GetThreadsCount() > 1;
+   // Bound the memory of stretchers and their buffers
+   const size_t maxJobs = parallel ? pool.GetThreadsCount() + 1 : 1;
+
+   // Jobs that are set up, with indices of their sources
+   std::vector<std::pair<std::unique_ptr<RenderJob>, size_t>> jobs;
+   size_t next = 0;
+   while (true) {
+      // Start rendering more intervals, in order
+      for (; jobs.size() < maxJobs && next < sources.size(); ++next) {
+         auto &source = sources[next];
+         if (!source.rendered)
+            jobs.emplace_back(std::make_unique<RenderJob>(source.interval,
+               source.track.mpFactory, source.track.GetSampleFormat()), next);
+      }
+      if (jobs.empty())
+         break;
+
+      // Stretch a step of each interval concurrently
+      pool.ParallelFor(jobs.size(), [&](size_t ii){ jobs[ii].first->Step(); });
+
+      // Append in this thread, which owns the sample block factories
+      double rendered = 0;
+      for (auto iter = jobs.begin(); iter != jobs.end();) {
+         auto &[pJob, index] = *iter;
+         pJob->Append();
+         if (pJob->Done()) {
+            finished += pJob->Total();
+            sources[index].rendered = pJob->Finish();
+            iter = jobs.erase(iter);
+         }
+         else {
+            rendered += pJob->Rendered();
+            ++iter;
+         }
+      }
+      if (reportProgress && total > 0)
+         reportProgress(std::min(1.0, (finished + rendered) / total));
+   }
 
    // If we reach this point it means that no error was thrown - we can replace
    // the source with the destination intervals.
-   for (auto i = 0; i < srcIntervals.size(); ++i)
-      ReplaceInterval(srcIntervals[i], dstIntervals[i]);
+   for (const auto &source : sources)
+      source.track.ReplaceInterval(source.interval, source.rendered);
 }
 
 namespace {
@@ -3220,8 +3439,10 @@ void WaveTrack::RemoveInterval(const IntervalHolder& interval)
 {
    const auto end = mClips.end(),
       iter = find(mClips.begin(), end, interval);
-   if (iter != end)
+   if (iter != end) {
       mClips.erase(iter);
+      mClipIndex.Invalidate();
+   }
 }
 
 void WaveTrack::ReplaceInterval(
@@ -3259,32 +3480,20 @@ bool WaveTrack::SetFloats(const float *const *buffers,
 
 auto WaveTrack::SortedClipArray() const -> IntervalConstHolders
 {
-   const auto &intervals = Intervals();
-   IntervalConstHolders clips{ intervals.begin(), intervals.end() };
-   const auto comp = [](const auto &a, const auto &b) {
-      return a->GetPlayStartTime() < b->GetPlayStartTime(); };
-   std::sort(clips.begin(), clips.end(), comp);
-   return clips;
+   const auto lock = mClipIndex.Update(mClips);
+   const auto &sorted = mClipIndex.Sorted();
+   return { sorted.begin(), sorted.end() };
 }
 
 auto WaveTrack::SortedIntervalArray() -> IntervalHolders
 {
-   const auto &intervals = Intervals();
-   IntervalHolders result;
-   copy(intervals.begin(), intervals.end(), back_inserter(result));
-   sort(result.begin(), result.end(), [](const auto &pA, const auto &pB){
-      return pA->GetPlayStartTime() < pB->GetPlayStartTime(); });
-   return result;
+   const auto lock = mClipIndex.Update(mClips);
+   return mClipIndex.Sorted();
 }
 
 auto WaveTrack::SortedIntervalArray() const -> IntervalConstHolders
 {
-   const auto &intervals = Intervals();
-   IntervalConstHolders result;
-   copy(intervals.begin(), intervals.end(), back_inserter(result));
-   sort(result.begin(), result.end(), [](const auto &pA, const auto &pB){
-      return pA->GetPlayStartTime() < pB->GetPlayStartTime(); });
-   return result;
+   return SortedClipArray();
 }
 
 void WaveTrack::ZipClips(bool mustAlign)
@@ -3330,6 +3539,7 @@ void WaveTrack::ZipClips(bool mustAlign)
       mClips.emplace_back(move(*iterRight));
       ++iterRight;
    }
+   mClipIndex.Invalidate();
 
    this->MergeChannelAttachments(std::move(*pRight));
 
@@ -19,7 +19,9 @@
 #include "SampleTrack.h"
 #include "WideSampleSequence.h"
 
+#include <algorithm>
 #include <functional>
+#include <mutex>
 #include <optional>
 #include <vector>
 #include <wx/thread.h>
@@ -32,6 +34,8 @@ namespace BasicUI{ class ProgressDialog; }
 
 class SampleBlockFactory;
 using SampleBlockFactoryPtr = std::shared_ptr<SampleBlockFactory>;
+class SampleBlockSource;
+using SampleBlockSourcePtr = std::shared_ptr<SampleBlockSource>;
 
 class TimeWarper;
 
@@ -113,6 +117,10 @@ public:
    void GetEnvelopeValues(
       double* buffer, size_t bufferLen, double t0,
       bool backwards) const override;
+   void Prefetch(double t0, double t1) const noexcept override;
+   bool IsResident(double t0, double t1) const noexcept override;
+   std::shared_ptr<const void>
+   PinResident(double t0, double t1) const override;
    sampleFormat WidestEffectiveFormat() const override;
 
    ChannelGroup &DoGetChannelGroup() const override;
@@ -183,6 +191,11 @@ public:
     */
    bool Append(constSamplePtr buffer, sampleFormat format, size_t len);
 
+   //! Append samples that stay in the source until the project copies them,
+   //! to the same clip that Append() would
+   void AppendDeferred(const SampleBlockSourcePtr &pSource,
+      sampleCount start, sampleCount len, sampleFormat effectiveFormat);
+
    //! A hint for sizing of well aligned fetches
    inline size_t GetBestBlockSize(sampleCount t) const;
    //! A hint for sizing of well aligned fetches
@@ -373,6 +386,11 @@ public:
    //! @pre `NChannels() == 2`
    void SwapChannels();
 
+   //! Whether the channels of every clip share all their sample blocks, so
+   //! that MakeMono() loses nothing but the duplication
+   //! @pre `NChannels() == 2`
+   bool HasIdenticalChannels() const;
+
    // If forClipboard is true,
    // and there is no clip at the end time of the selection, then the result
    // will contain a "placeholder" clip whose only purpose is to make
@@ -431,6 +449,10 @@ public:
     */
    void ApplyPitchAndSpeed(
       std::optional<TimeInterval> interval, ProgressReporter reportProgress);
+   //! ApplyPitchAndSpeed() for several tracks, rendering the clips of all of
+   //! them concurrently
+   static void ApplyPitchAndSpeed(const std::vector<WaveTrack*> &tracks,
+      std::optional<TimeInterval> interval, ProgressReporter reportProgress);
 
    void SyncLockAdjust(double oldT1, double newT1) override;
 
@@ -453,6 +475,14 @@ public:
       sampleFormat effectiveFormat = widestSampleFormat)
    override;
 
+   /*!
+    Like Append(iChannel, ...), but the samples stay in the source until the
+    sample block factory copies them
+    @pre `iChannel < NChannels()`
+    */
+   void AppendDeferred(size_t iChannel, const SampleBlockSourcePtr &pSource,
+      sampleCount start, sampleCount len, sampleFormat effectiveFormat);
+
    void Flush() override;
 
    void RepairChannels() override;
@@ -507,6 +537,18 @@ public:
       double* buffer, size_t bufferLen, double t0,
       bool backwards) const override;
 
+   //! Warms the sample blocks of all channels of clips intersecting [t0, t1]
+   void Prefetch(double t0, double t1) const noexcept override;
+
+   //! Whether the sample blocks of all channels of clips intersecting [t0, t1]
+   //! are resident in memory
+   bool IsResident(double t0, double t1) const noexcept override;
+
+   //! Keep resident the sample blocks of all channels of clips intersecting
+   //! [t0, t1]; null if they are not all resident
+   std::shared_ptr<const void>
+   PinResident(double t0, double t1) const override;
+
    //
    // Getting information about the track's internal block sizes
    // and alignment for efficiency
@@ -744,6 +786,14 @@ private:
    void ApplyPitchAndSpeedOnIntervals(
       const std::vector<IntervalHolder>& intervals,
       const ProgressReporter& reportProgress);
+   using TrackIntervals = std::vector<std::pair<WaveTrack*, IntervalHolders>>;
+   //! Render the intervals of the tracks concurrently, then replace them
+   static void ApplyPitchAndSpeedOnIntervals(
+      const TrackIntervals &intervals,
+      const ProgressReporter& reportProgress);
+   //! Split clips with pitch or speed at the bounds of the interval
+   /*! @return the clips with pitch or speed, within the interval */
+   IntervalHolders SplitForPitchAndSpeed(std::optional<TimeInterval> interval);
    /*!
     @pre `oldOne->NChannels() == newOne->NChannels()`
     @pre newOne and oldOne are the same, or else newOne is not already owned by
@@ -774,6 +824,62 @@ private:
     */
    WaveClipHolders mClips;
 
+   //! The clips sorted by play start time, for lookups by time in
+   //! logarithmic time
+   /*!
+    Rebuilt lazily, when the list of clips changed, or when any clip's play
+    region may have moved, as told by WaveClip::GetBoundsEpoch()
+    */
+   class ClipIndex {
+   public:
+      ClipIndex() = default;
+      //! Copies start out stale
+      ClipIndex(const ClipIndex &) {}
+      ClipIndex &operator =(const ClipIndex &)
+      { Invalidate(); return *this; }
+
+      void Invalidate() noexcept;
+
+      //! Rebuilds the index if it is stale
+      //! @return lock to hold while using the index
+      std::unique_lock<std::mutex> Update(const WaveClipHolders &clips);
+
+      //! @pre `Update()` was called and its lock is held
+      const WaveClipHolders &Sorted() const { return mSorted; }
+
+      //! Last clip, by start time, whose play region contains t, or null;
+      //! latest of overlapped clips, or later of abutting ones
+      //! @pre `Update()` was called and its lock is held
+      const WaveClipHolder &Find(double t) const;
+
+      //! Visit clips whose play regions intersect [t0, t1), in decreasing
+      //! order of start time, until f returns true
+      //! @return whether f returned true
+      //! @pre `Update()` was called and its lock is held
+      template<typename F> bool AnyIntersecting(double t0, double t1, F f)
+         const
+      {
+         const auto end = std::lower_bound(mStarts.begin(), mStarts.end(), t1);
+         // Clips starting earlier can still overlap while the greatest end
+         // time among them exceeds t0
+         for (auto ii = end - mStarts.begin(); ii-- > 0 && mMaxEnds[ii] > t0;)
+            if (mEnds[ii] > t0 && f(mSorted[ii]))
+               return true;
+         return false;
+      }
+
+   private:
+      std::mutex mMutex;
+      WaveClipHolders mSorted;
+      std::vector<double> mStarts;
+      std::vector<double> mEnds;
+      //! Running maximum of mEnds
+      std::vector<double> mMaxEnds;
+      unsigned long long mEpoch{ 0 };
+      bool mValid{ false };
+   };
+   mutable ClipIndex mClipIndex;
+
    mutable int  mLegacyRate{ 0 }; //!< used only during deserialization
    sampleFormat mLegacyFormat{ undefinedSample }; //!< used only during deserialization
 
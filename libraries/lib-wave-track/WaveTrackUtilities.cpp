@@ -9,6 +9,7 @@
 
 **********************************************************************/
 #include "WaveTrackUtilities.h"
+#include "PartialSampleBlock.h"
 #include "SampleBlock.h"
 #include "Sequence.h"
 #include "WaveClip.h"
@@ -62,67 +63,6 @@ void WaveTrackUtilities::AllClipsIterator::Push(IntervalHolders clips)
    }
 }
 
-namespace {
-bool ReverseOneClip(WaveTrack &track,
-   sampleCount start, sampleCount len,
-   sampleCount originalStart, sampleCount originalEnd,
-      const WaveTrackUtilities::ProgressReport &report)
-{
-   bool rc = true;
-   // keep track of two blocks whose data we will swap
-   auto first = start;
-
-   auto blockSize = track.GetMaxBlockSize();
-   const auto width = track.NChannels();
-   Floats buffers0[2]{
-      Floats(blockSize), width > 1 ? Floats(blockSize) : Floats{} };
-   float *pointers0[2]{ buffers0[0].get(),
-      width > 1 ? buffers0[1].get() : nullptr };
-   Floats buffers1[2]{
-      Floats(blockSize), width > 1 ? Floats(blockSize) : Floats{} };
-   float *pointers1[2]{ buffers1[0].get(),
-      width > 1 ? buffers1[1].get() : nullptr };
-   constexpr auto reverseBuffers =
-   [](float *const (&pointers)[2], size_t size){
-      for (const auto pointer : pointers)
-         if (pointer)
-            std::reverse(pointer, pointer + size);
-   };
-
-   auto originalLen = originalEnd - originalStart;
-
-   while (len > 1) {
-      auto block =
-         limitSampleBufferSize(track.GetBestBlockSize(first), len / 2);
-      auto second = first + (len - block);
-
-      track.GetFloats(0, width, pointers0, first, block);
-      reverseBuffers(pointers0, block);
-      track.GetFloats(0, width, pointers1, second, block);
-      reverseBuffers(pointers1, block);
-      // Don't dither on later rendering if only reversing samples
-      const bool success =
-         track.SetFloats(pointers1, first, block, narrowestSampleFormat)
-         &&
-         track.SetFloats(pointers0, second, block, narrowestSampleFormat);
-      if (!success)
-         return false;
-
-      len -= 2 * block;
-      first += block;
-
-      if (!report(
-         2 * (first - originalStart).as_double() / originalLen.as_double()
-      )) {
-         rc = false;
-         break;
-      }
-   }
-
-   return rc;
-}
-}
-
 bool WaveTrackUtilities::Reverse(WaveTrack &track,
    sampleCount start, sampleCount len, const ProgressReport &progress)
 {
@@ -214,10 +154,12 @@ bool WaveTrackUtilities::Reverse(WaveTrack &track,
 
          auto revStart = std::max(clipStart, start);
          auto revEnd = std::min(end, clipEnd);
-         auto revLen = revEnd - revStart;
          if (revEnd >= revStart) {
-            // reverse the clip
-            if (!ReverseOneClip(track, revStart, revLen, start, end, progress))
+            // reverse the clip, which lies within the selection, by
+            // rearranging its blocks
+            clip->Reverse(0, clip->GetVisibleSampleCount());
+            if (progress && !progress(
+               (revEnd - start).as_double() / (end - start).as_double()))
             {
                rValue = false;
                break;
@@ -373,6 +315,16 @@ void WaveTrackUtilities::DiscardTrimmed(WaveTrack &track)
    }
 }
 
+bool WaveTrackUtilities::Defragment(TrackList &tracks,
+   size_t &budget, DefragmentStatistics &statistics)
+{
+   for (auto wt : tracks.Any<WaveTrack>())
+      for (const auto &pClip : GetAllClips(*wt))
+         if (pClip->Defragment(budget, statistics))
+            return true;
+   return false;
+}
+
 void WaveTrackUtilities::VisitBlocks(TrackList &tracks, BlockVisitor visitor,
    SampleBlockIDSet *pIDs)
 {
@@ -383,7 +335,8 @@ void WaveTrackUtilities::VisitBlocks(TrackList &tracks, BlockVisitor visitor,
          for (const auto &pChannel : pClip->Channels()) {
             auto blocks = pChannel->GetSequenceBlockArray();
             for (const auto &block : *blocks) {
-               auto &pBlock = block.sb;
+               // Visit the block that holds the storage of a partial one
+               auto &pBlock = PartialSampleBlock::GetStorage(block.sb);
                if (pBlock) {
                   if (pIDs && !pIDs->insert(pBlock->GetBlockID()).second)
                      continue;
@@ -442,6 +395,21 @@ ProjectFormatExtensionsRegistry::Extension stretchedClipsExtension(
       return BaseProjectFormatVersion;
    }
 );
+
+// If any blocks are parts of stored blocks, don't allow older versions to
+// open the project.  Otherwise they would read the whole stored blocks.
+ProjectFormatExtensionsRegistry::Extension partialBlocksExtension(
+   [](const AudacityProject& project) -> ProjectFormatVersion {
+      const TrackList& trackList = TrackList::Get(project);
+      for (auto wt : trackList.Any<const WaveTrack>())
+         for (const auto& clip : GetAllClips(*wt))
+            for (const auto &pChannel : clip->Channels())
+               for (const auto &block : *pChannel->GetSequenceBlockArray())
+                  if (dynamic_cast<const PartialSampleBlock*>(block.sb.get()))
+                     return { 3, 6, 0, 0 };
+      return BaseProjectFormatVersion;
+   }
+);
 }
 
 void WaveTrackUtilities::ExpandClipTillNextOne(
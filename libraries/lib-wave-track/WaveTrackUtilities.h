@@ -17,6 +17,7 @@
 #include "WaveTrack.h"
 #include <unordered_set>
 
+struct DefragmentStatistics;
 class SampleBlock;
 class sampleCount;
 class TrackList;
@@ -181,6 +182,14 @@ WAVE_TRACK_API void VisitBlocks(TrackList &tracks, BlockVisitor visitor,
 WAVE_TRACK_API void InspectBlocks(const TrackList &tracks,
    BlockInspector inspector, SampleBlockIDSet *pIDs = nullptr);
 
+//! Merge runs of undersized sample blocks in all clips and cutlines
+/*!
+ @param budget samples that may be rewritten, decreased by those that are
+ @return whether the budget ran out before all runs were rewritten
+ */
+WAVE_TRACK_API bool Defragment(TrackList &tracks,
+   size_t &budget, DefragmentStatistics &statistics);
+
 /*!
  @pre t0 <= t1
  */
@@ -0,0 +1,216 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  MemorySampleBlock.cpp
+
+**********************************************************************/
+#include "MemorySampleBlock.h"
+#include "Dither.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace
+{
+constexpr size_t fields = 3;
+
+//! Summarize each `frame` of `count` triples into one
+std::vector<float> Summarize(const float* triples, size_t count, size_t frame)
+{
+   const auto frames = (count + frame - 1) / frame;
+   std::vector<float> result(frames * fields);
+   for (size_t ii = 0; ii < frames; ++ii)
+   {
+      const auto first = ii * frame;
+      const auto last = std::min(count, first + frame);
+      float min = FLT_MAX, max = -FLT_MAX;
+      double sumsq = 0;
+      for (auto jj = first; jj < last; ++jj)
+      {
+         min = std::min(min, triples[jj * fields]);
+         max = std::max(max, triples[jj * fields + 1]);
+         sumsq += triples[jj * fields + 2] * triples[jj * fields + 2];
+      }
+      result[ii * fields] = min;
+      result[ii * fields + 1] = max;
+      result[ii * fields + 2] = std::sqrt(sumsq / (last - first));
+   }
+   return result;
+}
+
+MinMaxRMS MinMaxRMSOf(const float* samples, size_t len)
+{
+   if (len == 0)
+      return {};
+   MinMaxRMS result { samples[0], samples[0], 0 };
+   double sumsq = 0;
+   for (size_t ii = 0; ii < len; ++ii)
+   {
+      result.min = std::min(result.min, samples[ii]);
+      result.max = std::max(result.max, samples[ii]);
+      sumsq += samples[ii] * samples[ii];
+   }
+   result.RMS = std::sqrt(sumsq / len);
+   return result;
+}
+
+bool CopySummary(const std::vector<float>& summary, float* dest,
+   size_t frameoffset, size_t numframes)
+{
+   const auto frames = summary.size() / fields;
+   const auto available =
+      frameoffset < frames ? std::min(numframes, frames - frameoffset) : 0;
+   if (available > 0)
+   {
+      const auto begin = summary.begin() + frameoffset * fields;
+      std::copy(begin, begin + available * fields, dest);
+   }
+   std::fill(dest + available * fields, dest + numframes * fields, 0.0f);
+   return true;
+}
+} // namespace
+
+MemorySampleBlock::MemorySampleBlock(SampleBlockID id, constSamplePtr src,
+   size_t numsamples, sampleFormat srcformat)
+    : mID { id }
+    , mFormat { srcformat }
+    , mCount { numsamples }
+    , mSamples(src, src + numsamples * SAMPLE_SIZE(srcformat))
+{
+   std::vector<float> floats(numsamples);
+   SamplesToFloats(src, srcformat, floats.data(), numsamples);
+   const auto frames = (numsamples + 255) / 256;
+   mSummary256.resize(frames * fields);
+   for (size_t ii = 0; ii < frames; ++ii)
+   {
+      const auto first = ii * 256;
+      const auto len = std::min<size_t>(256, numsamples - first);
+      const auto summary = MinMaxRMSOf(floats.data() + first, len);
+      mSummary256[ii * fields] = summary.min;
+      mSummary256[ii * fields + 1] = summary.max;
+      mSummary256[ii * fields + 2] = summary.RMS;
+   }
+   mSummary64k = Summarize(mSummary256.data(), frames, 256);
+   mMinMaxRMS = MinMaxRMSOf(floats.data(), numsamples);
+}
+
+MemorySampleBlock::~MemorySampleBlock() = default;
+
+void MemorySampleBlock::CloseLock() noexcept
+{
+}
+
+SampleBlockID MemorySampleBlock::GetBlockID() const
+{
+   return mID;
+}
+
+BlockSampleView MemorySampleBlock::GetFloatSampleView(bool)
+{
+   auto result = std::make_shared<std::vector<float>>(mCount);
+   SamplesToFloats(mSamples.data(), mFormat, result->data(), mCount);
+   return result;
+}
+
+sampleFormat MemorySampleBlock::GetSampleFormat() const
+{
+   return mFormat;
+}
+
+size_t MemorySampleBlock::GetSampleCount() const
+{
+   return mCount;
+}
+
+bool MemorySampleBlock::GetSummary256(
+   float* dest, size_t frameoffset, size_t numframes)
+{
+   return CopySummary(mSummary256, dest, frameoffset, numframes);
+}
+
+bool MemorySampleBlock::GetSummary64k(
+   float* dest, size_t frameoffset, size_t numframes)
+{
+   return CopySummary(mSummary64k, dest, frameoffset, numframes);
+}
+
+size_t MemorySampleBlock::GetSpaceUsage() const
+{
+   return mSamples.size();
+}
+
+bool MemorySampleBlock::IsResident() const noexcept
+{
+   return true;
+}
+
+std::shared_ptr<const void> MemorySampleBlock::PinResident() const
+{
+   // Always resident; nothing to keep, but the result must not be null
+   return std::make_shared<const int>();
+}
+
+void MemorySampleBlock::SaveXML(XMLWriter&)
+{
+}
+
+size_t MemorySampleBlock::DoGetSamples(samplePtr dest,
+   sampleFormat destformat, size_t sampleoffset, size_t numsamples)
+{
+   numsamples = std::min(numsamples, mCount - std::min(mCount, sampleoffset));
+   CopySamples(mSamples.data() + sampleoffset * SAMPLE_SIZE(mFormat), mFormat,
+      dest, destformat, numsamples, DitherType::none);
+   return numsamples;
+}
+
+MinMaxRMS MemorySampleBlock::DoGetMinMaxRMS(size_t start, size_t len)
+{
+   len = std::min(len, mCount - std::min(mCount, start));
+   std::vector<float> floats(len);
+   SamplesToFloats(mSamples.data() + start * SAMPLE_SIZE(mFormat), mFormat,
+      floats.data(), len);
+   return MinMaxRMSOf(floats.data(), len);
+}
+
+MinMaxRMS MemorySampleBlock::DoGetMinMaxRMS() const
+{
+   return mMinMaxRMS;
+}
+
+MemorySampleBlockFactory::~MemorySampleBlockFactory() = default;
+
+auto MemorySampleBlockFactory::GetActiveBlockIDs() -> SampleBlockIDs
+{
+   return {};
+}
+
+SampleBlockPtr MemorySampleBlockFactory::DoCreate(
+   constSamplePtr src, size_t numsamples, sampleFormat srcformat)
+{
+   return std::make_shared<MemorySampleBlock>(
+      ++mLastID, src, numsamples, srcformat);
+}
+
+SampleBlockPtr MemorySampleBlockFactory::DoCreateSilent(
+   size_t numsamples, sampleFormat srcformat)
+{
+   std::vector<char> silence(numsamples * SAMPLE_SIZE(srcformat));
+   return std::make_shared<MemorySampleBlock>(
+      -static_cast<SampleBlockID>(numsamples), silence.data(), numsamples,
+      srcformat);
+}
+
+SampleBlockPtr MemorySampleBlockFactory::DoCreateFromXML(
+   sampleFormat, const AttributesList&)
+{
+   return nullptr;
+}
+
+SampleBlockPtr
+MemorySampleBlockFactory::DoCreateFromId(sampleFormat, SampleBlockID)
+{
+   return nullptr;
+}
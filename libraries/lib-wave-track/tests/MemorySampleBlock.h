@@ -0,0 +1,73 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  MemorySampleBlock.h
+
+  Sample blocks held in memory, with summaries computed as the project's
+  blocks compute them, so that benchmarks of sequences measure the editing
+  and reading, and not the storage
+
+**********************************************************************/
+#pragma once
+
+#include "SampleBlock.h"
+
+#include <vector>
+
+class MemorySampleBlock final : public SampleBlock
+{
+public:
+   MemorySampleBlock(SampleBlockID id, constSamplePtr src,
+      size_t numsamples, sampleFormat srcformat);
+   ~MemorySampleBlock() override;
+
+   void CloseLock() noexcept override;
+   SampleBlockID GetBlockID() const override;
+   BlockSampleView GetFloatSampleView(bool mayThrow) override;
+   sampleFormat GetSampleFormat() const override;
+   size_t GetSampleCount() const override;
+   bool GetSummary256(
+      float *dest, size_t frameoffset, size_t numframes) override;
+   bool GetSummary64k(
+      float *dest, size_t frameoffset, size_t numframes) override;
+   size_t GetSpaceUsage() const override;
+   bool IsResident() const noexcept override;
+   std::shared_ptr<const void> PinResident() const override;
+   void SaveXML(XMLWriter &xmlFile) override;
+
+private:
+   size_t DoGetSamples(samplePtr dest, sampleFormat destformat,
+      size_t sampleoffset, size_t numsamples) override;
+   MinMaxRMS DoGetMinMaxRMS(size_t start, size_t len) override;
+   MinMaxRMS DoGetMinMaxRMS() const override;
+
+   const SampleBlockID mID;
+   const sampleFormat mFormat;
+   const size_t mCount;
+   std::vector<char> mSamples;
+   //! Triples of min, max and rms
+   std::vector<float> mSummary256;
+   std::vector<float> mSummary64k;
+   MinMaxRMS mMinMaxRMS;
+};
+
+class MemorySampleBlockFactory final : public SampleBlockFactory
+{
+public:
+   ~MemorySampleBlockFactory() override;
+
+private:
+   SampleBlockIDs GetActiveBlockIDs() override;
+   SampleBlockPtr DoCreate(constSamplePtr src,
+      size_t numsamples, sampleFormat srcformat) override;
+   SampleBlockPtr DoCreateSilent(
+      size_t numsamples, sampleFormat srcformat) override;
+   SampleBlockPtr DoCreateFromXML(
+      sampleFormat srcformat, const AttributesList &attrs) override;
+   SampleBlockPtr DoCreateFromId(
+      sampleFormat srcformat, SampleBlockID id) override;
+
+   SampleBlockID mLastID{ 0 };
+};
@@ -0,0 +1,414 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  PerformanceBenchmark.cpp
+
+  Throughput of editing, reading and summarizing sequences, of sample block
+  storage, mixing, resampling, FFT and effect processing, without a user
+  interface, so that a build farm can track it from release to release.
+
+  The edit and read cases are those of the Benchmark dialog.  Each case
+  writes one line of JSON for each measurement, appended to the file named
+  by the environment variable AUDACITY_BENCHMARK_OUTPUT, or else to the
+  standard output.
+
+**********************************************************************/
+#include "MemorySampleBlock.h"
+
+#include "Dither.h"
+#include "LookaheadCompressor.h"
+#include "Mix.h"
+#include "MockedPrefs.h"
+#include "PartitionedConvolver.h"
+#include "Project.h"
+#include "ProjectRate.h"
+#include "RealFFTPlan.h"
+#include "Resample.h"
+#include "Sequence.h"
+#include "StretchingSequence.h"
+#include "WaveChannelUtilities.h"
+#include "WaveClip.h"
+#include "WaveTrack.h"
+
+#include <catch2/catch.hpp>
+#include <sqlite3.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <locale>
+#include <random>
+#include <sstream>
+#include <vector>
+
+namespace
+{
+MockedPrefs prefs;
+const auto project = AudacityProject::Create();
+const auto tracks = TrackList::Create(project.get());
+
+constexpr double rate = 44100;
+
+//! Writes `{"benchmark": name, "seconds": ..., "count": ..., "unit": unit,
+//! "per_second": ...}`
+void Report(const std::string& name, double seconds, double count,
+   const std::string& unit)
+{
+   std::ostringstream line;
+   line.imbue(std::locale::classic());
+   line << "{\"benchmark\": \"" << name << "\", \"seconds\": " << seconds
+        << ", \"count\": " << count << ", \"unit\": \"" << unit
+        << "\", \"per_second\": " << (seconds > 0 ? count / seconds : 0.0)
+        << "}";
+   const auto path = std::getenv("AUDACITY_BENCHMARK_OUTPUT");
+   if (path && *path)
+   {
+      std::ofstream file { path, std::ios::app };
+      file << line.str() << std::endl;
+   }
+   else
+      std::cout << line.str() << std::endl;
+}
+
+template <typename F> double Seconds(F f)
+{
+   using namespace std::chrono;
+   const auto start = steady_clock::now();
+   f();
+   return duration<double>(steady_clock::now() - start).count();
+}
+
+std::vector<float> Noise(size_t len, unsigned seed)
+{
+   std::minstd_rand engine { seed };
+   std::uniform_real_distribution<float> distribution { -0.5f, 0.5f };
+   std::vector<float> result(len);
+   for (auto& sample : result)
+      sample = distribution(engine);
+   return result;
+}
+
+std::shared_ptr<WaveTrack>
+NewTrack(size_t nChannels, sampleFormat format, double trackRate = rate)
+{
+   const auto track =
+      WaveTrackFactory { ProjectRate::Get(*project),
+                         std::make_shared<MemorySampleBlockFactory>() }
+         .Create(nChannels, format, trackRate);
+   tracks->Add(track);
+   return track;
+}
+
+std::shared_ptr<WaveTrack> NoiseTrack(size_t nChannels, size_t len)
+{
+   const auto track = NewTrack(nChannels, floatSample);
+   for (size_t ii = 0; ii < nChannels; ++ii)
+   {
+      const auto samples = Noise(len, ii + 1);
+      track->Append(ii, reinterpret_cast<constSamplePtr>(samples.data()),
+         floatSample, len);
+   }
+   track->Flush();
+   return track;
+}
+} // namespace
+
+TEST_CASE("SequenceEditAndReadBenchmark")
+{
+   // As the defaults of the Benchmark dialog, except for the block size,
+   // which is that of projects
+   using SampleType = short;
+   constexpr auto format = int16Sample;
+   constexpr uint64_t dataSize = 32; // MB
+   constexpr int trials = 100;
+   std::minstd_rand engine { 234657 };
+
+   // So that times are sample counts
+   const auto t = NewTrack(1, format, 1);
+
+   uint64_t chunkSize = 200 + engine() % 100;
+   uint64_t nChunks = (dataSize * 1048576) / (chunkSize * sizeof(SampleType));
+   std::vector<SampleType> small1(nChunks);
+   std::vector<SampleType> block(chunkSize);
+   for (uint64_t i = 0; i < nChunks; ++i)
+   {
+      const auto v = static_cast<SampleType>(engine());
+      small1[i] = v;
+      std::fill(block.begin(), block.end(), v);
+      t->Append(0, reinterpret_cast<constSamplePtr>(block.data()), format,
+         chunkSize);
+   }
+   t->Flush();
+   const auto total = nChunks * chunkSize;
+   REQUIRE(t->GetClip(0)->GetVisibleSampleCount() == total);
+
+   const auto editSeconds = Seconds([&] {
+      for (int z = 0; z < trials; ++z)
+      {
+         const uint64_t x0 = engine() % nChunks;
+         const uint64_t xlen = 1 + engine() % (nChunks - x0);
+         const auto tmp = t->Cut(
+            double(x0 * chunkSize), double((x0 + xlen) * chunkSize));
+         const uint64_t y0 = engine() % (nChunks - xlen + 1);
+         t->Paste(double(y0 * chunkSize), *tmp);
+         REQUIRE(t->GetClip(0)->GetVisibleSampleCount() == total);
+
+         // Permute small1 correspondingly to the cut and paste
+         const auto first = small1.data();
+         if (x0 + xlen < nChunks)
+            std::rotate(first + x0, first + x0 + xlen, first + nChunks);
+         std::rotate(first + y0, first + nChunks - xlen, first + nChunks);
+      }
+   });
+   Report("sequence-edit", editSeconds, trials, "edits");
+
+   int bad = 0;
+   const auto readSeconds = Seconds([&] {
+      for (uint64_t i = 0; i < nChunks; ++i)
+      {
+         auto pBlock = reinterpret_cast<samplePtr>(block.data());
+         t->DoGet(0, 1, &pBlock, format, i * chunkSize, chunkSize, false);
+         if (std::any_of(block.begin(), block.end(),
+                [&](SampleType sample) { return sample != small1[i]; }))
+            ++bad;
+      }
+   });
+   REQUIRE(bad == 0);
+   Report("sequence-read", readSeconds, total, "samples");
+}
+
+TEST_CASE("SequenceSummaryBenchmark")
+{
+   // Three minutes of stereo
+   constexpr size_t len = 180 * rate;
+   const auto track = NoiseTrack(2, len);
+
+   // As the waveform of a wide window zoomed out, and then zoomed in
+   for (const size_t window : { 1 << 16, 1 << 10 })
+   {
+      size_t count = 0;
+      const auto seconds = Seconds([&] {
+         for (const auto pChannel : track->Channels())
+            for (size_t start = 0; start + window <= len; start += window)
+            {
+               const auto t0 = start / rate;
+               const auto t1 = (start + window) / rate;
+               WaveChannelUtilities::GetMinMax(*pChannel, t0, t1);
+               WaveChannelUtilities::GetRMS(*pChannel, t0, t1);
+               ++count;
+            }
+      });
+      Report("sequence-summary-" + std::to_string(window), seconds, count,
+         "windows");
+   }
+
+   size_t spans = 0;
+   const auto seconds = Seconds([&] {
+      for (const auto pChannel : track->Channels())
+         spans +=
+            WaveChannelUtilities::GetSummarySpans(*pChannel, 0, len).size();
+   });
+   REQUIRE(spans > 0);
+   Report("sequence-summary-spans", seconds, 2.0 * len, "samples");
+}
+
+TEST_CASE("SampleBlockStorageBenchmark")
+{
+   // Same schema and statements as the blocks of projects, in memory, so
+   // that the cost of SQLite is measured and not that of the disk
+   sqlite3* db = nullptr;
+   REQUIRE(sqlite3_open(":memory:", &db) == SQLITE_OK);
+   const auto close = finally([&] { sqlite3_close(db); });
+   REQUIRE(
+      sqlite3_exec(
+         db,
+         "CREATE TABLE sampleblocks("
+         "  blockid              INTEGER PRIMARY KEY AUTOINCREMENT,"
+         "  sampleformat         INTEGER,"
+         "  summin               REAL,"
+         "  summax               REAL,"
+         "  sumrms               REAL,"
+         "  summary256           BLOB,"
+         "  summary64k           BLOB,"
+         "  samples              BLOB"
+         ");",
+         nullptr, nullptr, nullptr) == SQLITE_OK);
+
+   // Blocks of the largest size, of floats
+   constexpr size_t blockLen = 1 << 18;
+   constexpr int nBlocks = 128;
+   const auto samples = Noise(blockLen, 1);
+   const std::vector<float> summary256(3 * blockLen / 256);
+   const std::vector<float> summary64k(3 * blockLen / 65536);
+   const auto bytes = blockLen * sizeof(float);
+
+   sqlite3_stmt* insert = nullptr;
+   REQUIRE(
+      sqlite3_prepare_v3(
+         db,
+         "INSERT INTO sampleblocks (sampleformat, summin, summax, sumrms,"
+         "                          summary256, summary64k, samples)"
+         "                         VALUES(?1,?2,?3,?4,?5,?6,?7);",
+         -1, SQLITE_PREPARE_PERSISTENT, &insert, nullptr) == SQLITE_OK);
+   const auto writeSeconds = Seconds([&] {
+      for (int ii = 0; ii < nBlocks; ++ii)
+      {
+         sqlite3_bind_int(insert, 1, floatSample);
+         sqlite3_bind_double(insert, 2, -0.5);
+         sqlite3_bind_double(insert, 3, 0.5);
+         sqlite3_bind_double(insert, 4, 0.29);
+         sqlite3_bind_blob(insert, 5, summary256.data(),
+            summary256.size() * sizeof(float), SQLITE_STATIC);
+         sqlite3_bind_blob(insert, 6, summary64k.data(),
+            summary64k.size() * sizeof(float), SQLITE_STATIC);
+         sqlite3_bind_blob(
+            insert, 7, samples.data(), bytes, SQLITE_STATIC);
+         REQUIRE(sqlite3_step(insert) == SQLITE_DONE);
+         sqlite3_clear_bindings(insert);
+         sqlite3_reset(insert);
+      }
+   });
+   sqlite3_finalize(insert);
+   Report("block-write", writeSeconds, double(nBlocks) * bytes, "bytes");
+
+   sqlite3_stmt* select = nullptr;
+   REQUIRE(
+      sqlite3_prepare_v3(
+         db, "SELECT samples FROM sampleblocks WHERE blockid = ?1;", -1,
+         SQLITE_PREPARE_PERSISTENT, &select, nullptr) == SQLITE_OK);
+   std::vector<float> buffer(blockLen);
+   const auto readSeconds = Seconds([&] {
+      for (int ii = 1; ii <= nBlocks; ++ii)
+      {
+         sqlite3_bind_int64(select, 1, ii);
+         REQUIRE(sqlite3_step(select) == SQLITE_ROW);
+         REQUIRE(sqlite3_column_bytes(select, 0) == int(bytes));
+         memcpy(buffer.data(), sqlite3_column_blob(select, 0), bytes);
+         sqlite3_clear_bindings(select);
+         sqlite3_reset(select);
+      }
+   });
+   sqlite3_finalize(select);
+   REQUIRE(buffer == samples);
+   Report("block-read", readSeconds, double(nBlocks) * bytes, "bytes");
+}
+
+TEST_CASE("MixBenchmark")
+{
+   // Four stereo tracks of a minute, as for export, without and with
+   // resampling
+   constexpr size_t len = 60 * rate;
+   std::vector<std::shared_ptr<WaveTrack>> sources;
+   for (int ii = 0; ii < 4; ++ii)
+      sources.push_back(NoiseTrack(2, len));
+
+   for (const double outRate : { rate, 48000.0 })
+   {
+      Mixer::Inputs inputs;
+      for (const auto& pTrack : sources)
+         inputs.emplace_back(
+            StretchingSequence::Create(*pTrack, pTrack->GetClipInterfaces()));
+      Mixer mixer { move(inputs), true, Mixer::WarpOptions { 1.0, 1.0 }, 0.0,
+                    len / rate, 2, 1 << 14, false, outRate, floatSample };
+      size_t count = 0;
+      const auto seconds = Seconds([&] {
+         while (const auto blockLen = mixer.Process())
+            count += blockLen;
+      });
+      REQUIRE(count > 0);
+      Report(outRate == rate ? "mix" : "mix-resample", seconds, count,
+         "frames");
+   }
+}
+
+TEST_CASE("ResampleBenchmark")
+{
+   // A minute, to the next common rate, at both qualities
+   constexpr size_t len = 60 * rate;
+   constexpr double factor = 48000 / rate;
+   const auto input = Noise(len, 1);
+   std::vector<float> output(len * factor + 1024);
+   for (const bool best : { false, true })
+   {
+      Resample resample { best, factor, factor };
+      size_t produced = 0;
+      const auto seconds = Seconds([&] {
+         for (size_t done = 0; done < len;)
+         {
+            const auto blockLen = std::min<size_t>(1 << 14, len - done);
+            const auto [used, made] = resample.Process(factor,
+               input.data() + done, blockLen, done + blockLen == len,
+               output.data() + produced, output.size() - produced);
+            done += used;
+            produced += made;
+            if (used == 0 && made == 0)
+               break;
+         }
+      });
+      REQUIRE(produced > 0);
+      Report(best ? "resample-best" : "resample-fast", seconds, len, "samples");
+   }
+}
+
+TEST_CASE("FFTBenchmark")
+{
+   // Sizes of the spectrogram and of spectral effects
+   constexpr size_t samples = 1 << 22;
+   for (const size_t size : { 1024, 4096 })
+   {
+      RealFFTPlan plan { size };
+      auto buffer = Noise(size, 1);
+      const auto repetitions = samples / size;
+      const auto seconds = Seconds([&] {
+         for (size_t ii = 0; ii < repetitions; ++ii)
+            plan.Forward(buffer.data());
+      });
+      Report("fft-" + std::to_string(size), seconds, repetitions, "transforms");
+   }
+}
+
+TEST_CASE("EffectProcessingBenchmark")
+{
+   // A minute of stereo through the kernels of the compressor and of
+   // convolution with a second of reverberation
+   constexpr size_t len = 60 * rate;
+   constexpr size_t blockLen = 512;
+   auto left = Noise(len, 1), right = Noise(len, 2);
+
+   {
+      LookaheadCompressor compressor { 2, rate, 5.0, {} };
+      const auto seconds = Seconds([&] {
+         for (size_t done = 0; done + blockLen <= len; done += blockLen)
+         {
+            float* const channels[] { left.data() + done, right.data() + done };
+            compressor.Process(channels, channels, blockLen);
+         }
+      });
+      Report("effect-compressor", seconds, 2.0 * len, "samples");
+   }
+
+   {
+      auto response = Noise(size_t(rate), 3);
+      for (size_t ii = 0; ii < response.size(); ++ii)
+         response[ii] *= std::exp(-5.0 * ii / rate);
+      PartitionedConvolver leftConvolver { response.data(), response.size(),
+                                           blockLen },
+         rightConvolver { response.data(), response.size(), blockLen };
+      const auto seconds = Seconds([&] {
+         for (size_t done = 0; done + blockLen <= len; done += blockLen)
+         {
+            leftConvolver.Process(
+               left.data() + done, left.data() + done, blockLen);
+            rightConvolver.Process(
+               right.data() + done, right.data() + done, blockLen);
+         }
+      });
+      Report("effect-convolution", seconds, 2.0 * len, "samples");
+   }
+}
@@ -41,6 +41,8 @@ wxString sLine;
 // the number of lines consumed by the tokenizer
 int sLineNumber = -1;
 
+DispatchMonitor sMonitor;
+
 BoolSetting JournalEnabled{ L"/Journal/Enabled", false };
 
 class JournalLogger final
@@ -223,6 +225,11 @@ void SetInputFileName(const wxString &path)
    sFileNameIn = path;
 }
 
+wxString GetInputFileName()
+{
+   return IsReplaying() ? sFileIn.GetName() : wxString{};
+}
+
 bool Begin( const FilePath &dataDir )
 {
    if ( !GetError() && !sFileNameIn.empty() ) {
@@ -311,13 +318,21 @@ bool Dispatch()
          wxString::Format("unknown command: %s", name.ToStdString().c_str()));
 
    // Pass all the fields including the command name to the function
+   const auto start = std::chrono::steady_clock::now();
    if (!iter->second(words))
       throw SyncException(wxString::Format(
          "command '%s' has failed", wxJoin(words, ',').ToStdString().c_str()));
+   if (sMonitor)
+      sMonitor(words, std::chrono::steady_clock::now() - start);
 
    return true;
 }
 
+void SetDispatchMonitor( DispatchMonitor monitor )
+{
+   sMonitor = move(monitor);
+}
+
 void Sync( const wxString &string )
 {
    if ( IsRecording() || IsReplaying() ) {
@@ -11,6 +11,9 @@
 #ifndef __AUDACITY_JOURNAL__
 #define __AUDACITY_JOURNAL__
 
+#include <chrono>
+#include <functional>
+
 #include "Identifier.h"
 class wxArrayString;
 class wxArrayStringEx;
@@ -42,6 +45,10 @@ namespace Journal
    WX_INIT_API
    void SetInputFileName( const wxString &path );
 
+   //\brief The absolute path of the played back journal file, after Begin()
+   WX_INIT_API
+   wxString GetInputFileName();
+
    //\brief Initialize playback if a file name has been set, and initialize
    // output if recording is enabled.
    // Must be called after wxWidgets initializes.
@@ -65,6 +72,15 @@ namespace Journal
    WX_INIT_API
    bool Dispatch();
 
+   //! Function receiving each dispatched command, with the time it took
+   using DispatchMonitor = std::function< void(
+      const wxArrayStringEx &fields, std::chrono::steady_clock::duration ) >;
+
+   //\brief Install a monitor of Dispatch(), replacing any previous one;
+   // pass an empty function to remove it
+   WX_INIT_API
+   void SetDispatchMonitor( DispatchMonitor monitor );
+
    //\brief If recording, output the strings; if playing back, require
    // identical strings.  None of them may contain newlines
    WX_INIT_API
@@ -49,13 +49,16 @@ bool XMLFileReader::Parse(XMLTagHandler *baseHandler,
 
    mBaseHandler = baseHandler;
 
-   const size_t bufferSize = 16384;
-   char buffer[16384];
+   // Read into the parser's own buffer, which XML_Parse() would otherwise
+   // copy each chunk into; and in larger chunks
+   const int bufferSize = 65536;
    int done = 0;
    do {
-      size_t len = fread(buffer, 1, bufferSize, theXMLFile.fp());
+      // Null only if out of memory, which XML_GetErrorCode() then reports
+      void *const buffer = XML_GetBuffer(mParser, bufferSize);
+      size_t len = buffer ? fread(buffer, 1, bufferSize, theXMLFile.fp()) : 0;
       done = (len < bufferSize);
-      if (!XML_Parse(mParser, buffer, len, done)) {
+      if (!buffer || !XML_ParseBuffer(mParser, len, done)) {
 
          // Embedded error string from expat doesn't translate (yet)
          // We could make a table of XOs if we wanted so that it could
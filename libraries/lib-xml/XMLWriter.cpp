@@ -29,6 +29,7 @@ the general functionality for creating XML in UTF8 encoding.
 #include <wx/defs.h>
 #include <wx/ffile.h>
 
+#include <algorithm>
 #include <cstring>
 
 #include "ToChars.h"
@@ -582,32 +583,50 @@ MemoryStream XMLUtf8BufferWriter::ConsumeResult()
 
 void XMLUtf8BufferWriter::WriteEscaped(const std::string_view& value)
 {
-   for (auto c : value)
+   // Escape into the stream in place, in spans that fit the longest entity
+   // for each character, few enough not to waste much of a chunk
+   constexpr size_t maxEscapedSize = 6;
+   constexpr size_t spanChars = 4096;
+
+   const auto append = [](char* out, const std::string_view& entity)
+   { return std::copy(entity.begin(), entity.end(), out); };
+
+   for (size_t first = 0; first < value.size(); first += spanChars)
    {
-      switch (c)
+      const auto chars = value.substr(first, spanChars);
+      const auto start =
+         static_cast<char*>(mStream.Reserve(chars.size() * maxEscapedSize));
+      auto out = start;
+
+      for (auto c : chars)
       {
-      case wxT('\''):
-         Write("&apos;");
-         break;
+         switch (c)
+         {
+         case wxT('\''):
+            out = append(out, "&apos;");
+            break;
 
-      case wxT('"'):
-         Write("&quot;");
-         break;
+         case wxT('"'):
+            out = append(out, "&quot;");
+            break;
 
-      case wxT('&'):
-         Write("&amp;");
-         break;
+         case wxT('&'):
+            out = append(out, "&amp;");
+            break;
 
-      case wxT('<'):
-         Write("&lt;");
-         break;
+         case wxT('<'):
+            out = append(out, "&lt;");
+            break;
 
-      case wxT('>'):
-         Write("&gt;");
-         break;
-      default:
-         if (static_cast<uint8_t>(c) > 0x1F || charXMLCompatiblity[c] != 0)
-            mStream.AppendByte(c);
+         case wxT('>'):
+            out = append(out, "&gt;");
+            break;
+         default:
+            if (static_cast<uint8_t>(c) > 0x1F || charXMLCompatiblity[c] != 0)
+               *out++ = c;
+         }
       }
+
+      mStream.Commit(out - start);
    }
 }
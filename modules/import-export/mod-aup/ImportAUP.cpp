@@ -48,8 +48,11 @@
 #include "ImportUtils.h"
 
 #include "NumericConverterFormats.h"
+#include "concurrency/ThreadPool.h"
 
+#include <future>
 #include <map>
+#include <set>
 
 #define DESC XO("AUP project files (*.aup)")
 
@@ -144,14 +147,36 @@ private:
                 sampleCount origin = 0,
                 int channel = 0);
 
+   //! Samples of a block file, read and converted, perhaps on a worker thread
+   struct BlockData
+   {
+      SampleBuffer buffer;
+      //! Empty if the samples were read
+      TranslatableString warning;
+   };
+
+   //! Read a block file; touches no state of the import
+   static BlockData ReadBlock(const FilePath &audioFilename,
+                              sampleCount len,
+                              sampleFormat format,
+                              sampleCount origin,
+                              int channel);
+
+   //! Start reading block files ahead of AddSamples(), a bounded number at
+   //! a time, beginning while the project is still being parsed
+   void Prefetch();
+
    // These two use the collected file information in a second pass
    bool AddSilence(sampleCount len);
+   //! @param prefetched if valid, holds the result of ReadBlock(); else it
+   //! is called now, if the block is not shared with an earlier one
    bool AddSamples(const FilePath &blockFilename,
                    const FilePath &audioFilename,
                    sampleCount len,
                    sampleFormat format,
                    sampleCount origin = 0,
-                   int channel = 0);
+                   int channel = 0,
+                   std::future<BlockData> prefetched = {});
 
    bool SetError(const TranslatableString &msg);
    bool SetWarning(const TranslatableString &msg);
@@ -191,10 +216,19 @@ private:
       sampleFormat format;
       sampleCount origin;
       int channel;
+      std::future<BlockData> data;
    } fileinfo;
    std::vector<fileinfo> mFiles;
    sampleCount mTotalSamples;
 
+   //! Index in mFiles of the next file that Prefetch() may read
+   size_t mNextPrefetch{ 0 };
+   //! Index in mFiles of the next file to add to a clip
+   size_t mNextAdd{ 0 };
+   //! Which block files were already given to Prefetch(); later uses of the
+   //! same file share the first block
+   std::set<wxString> mPrefetched;
+
    sampleFormat mFormat;
    unsigned long mNumChannels;
 
@@ -354,8 +388,11 @@ void AUPImportFileHandle::Import(
    // (If we keep this entire source file at all)
 
    sampleCount processed = 0;
-   for (auto fi : mFiles)
+   for (mNextAdd = 0; mNextAdd < mFiles.size(); ++mNextAdd)
    {
+      auto &fi = mFiles[mNextAdd];
+      Prefetch();
+
       if(mTotalSamples.as_double() > 0)
          progressListener.OnImportProgress(processed.as_double() / mTotalSamples.as_double());
       if(IsCancelled())
@@ -378,7 +415,7 @@ void AUPImportFileHandle::Import(
       else
       {
          if (!AddSamples(fi.blockFile, fi.audioFile,
-                    fi.len, fi.format, fi.origin, fi.channel))
+                    fi.len, fi.format, fi.origin, fi.channel, std::move(fi.data)))
          {
             progressListener.OnImportResult(ImportProgressListener::ImportResult::Error);
             return;
@@ -1416,9 +1453,34 @@ void AUPImportFileHandle::AddFile(sampleCount len,
    fi.origin = origin,
    fi.channel = channel;
 
-   mFiles.push_back(fi);
+   mFiles.push_back(std::move(fi));
 
    mTotalSamples += len;
+
+   Prefetch();
+}
+
+void AUPImportFileHandle::Prefetch()
+{
+   auto &pool = audacity::concurrency::ThreadPool::GetDefault();
+   // Waiting for the pool from one of its own workers could deadlock
+   if (pool.IsWorkerThread())
+      return;
+
+   // Enough to keep the workers busy, but bounding the memory held
+   const auto window = 2 * pool.GetThreadsCount();
+   for (; mNextPrefetch < mFiles.size() && mNextPrefetch < mNextAdd + window;
+        ++mNextPrefetch)
+   {
+      auto &fi = mFiles[mNextPrefetch];
+      if (fi.blockFile.empty() ||
+          !mPrefetched.insert(wxFileNameFromPath(fi.blockFile)).second)
+         continue;
+      fi.data = pool.Async([audioFile = fi.audioFile, len = fi.len,
+         format = fi.format, origin = fi.origin, channel = fi.channel]{
+            return ReadBlock(audioFile, len, format, origin, channel);
+         });
+   }
 }
 
 bool AUPImportFileHandle::AddSilence(sampleCount len)
@@ -1445,7 +1507,8 @@ bool AUPImportFileHandle::AddSamples(const FilePath &blockFilename,
                                      sampleCount len,
                                      sampleFormat format,
                                      sampleCount origin /* = 0 */,
-                                     int channel /* = 0 */)
+                                     int channel /* = 0 */,
+                                     std::future<BlockData> prefetched /* = {} */)
 {
    auto pClip = mClip ? mClip : mWaveTrack->RightmostOrNewClip().get();
    auto &pBlock = mFileMap[wxFileNameFromPath(blockFilename)].second;
@@ -1457,16 +1520,6 @@ bool AUPImportFileHandle::AddSamples(const FilePath &blockFilename,
       return true;
    }
 
-   // Third party library has its own type alias, check it before
-   // adding origin + size_t
-   static_assert(sizeof(sampleCount::type) <= sizeof(sf_count_t),
-                 "Type sf_count_t is too narrow to hold a sampleCount");
-
-   SF_INFO info;
-   memset(&info, 0, sizeof(info));
-
-   wxFile f; // will be closed when it goes out of scope
-   SNDFILE *sf = nullptr;
    bool success = false;
 
 #ifndef UNCAUGHT_EXCEPTIONS_UNAVAILABLE
@@ -1475,12 +1528,6 @@ bool AUPImportFileHandle::AddSamples(const FilePath &blockFilename,
 
    auto cleanup = finally([&]
    {
-      // Do this before any throwing might happen
-      if (sf)
-      {
-         SFCall<int>(sf_close, sf);
-      }
-
       if (!success)
       {
          SetWarning(XO("Error while processing %s\n\nInserting silence.").Format(audioFilename));
@@ -1497,32 +1544,86 @@ bool AUPImportFileHandle::AddSamples(const FilePath &blockFilename,
       }
    });
 
-   if (!f.Open(audioFilename))
+   // Rethrows any exception from the worker thread
+   auto data = prefetched.valid()
+      ? prefetched.get()
+      : ReadBlock(audioFilename, len, format, origin, channel);
+   if (!data.warning.empty())
    {
-      SetWarning(XO("Failed to open %s").Format(audioFilename));
+      SetWarning(data.warning);
 
       return true;
    }
 
+   wxASSERT(mClip || mWaveTrack);
+
+   // Add the samples to the clip/track
+   if (pClip)
+   {
+      if (pClip->NChannels() != 1)
+         return false;
+      pBlock = pClip->AppendLegacyNewBlock(data.buffer.ptr(), format, len.as_size_t());
+   }
+
+   // Let the finally block know everything is good
+   success = true;
+
+   return true;
+}
+
+AUPImportFileHandle::BlockData AUPImportFileHandle::ReadBlock(
+   const FilePath &audioFilename,
+   sampleCount len,
+   sampleFormat format,
+   sampleCount origin,
+   int channel)
+{
+   BlockData result;
+
+   // Third party library has its own type alias, check it before
+   // adding origin + size_t
+   static_assert(sizeof(sampleCount::type) <= sizeof(sf_count_t),
+                 "Type sf_count_t is too narrow to hold a sampleCount");
+
+   SF_INFO info;
+   memset(&info, 0, sizeof(info));
+
+   wxFile f; // will be closed when it goes out of scope
+   SNDFILE *sf = nullptr;
+   auto cleanup = finally([&]
+   {
+      if (sf)
+      {
+         SFCall<int>(sf_close, sf);
+      }
+   });
+
+   if (!f.Open(audioFilename))
+   {
+      result.warning = XO("Failed to open %s").Format(audioFilename);
+
+      return result;
+   }
+
    // Even though there is an sf_open() that takes a filename, use the one that
    // takes a file descriptor since wxWidgets can open a file with a Unicode name and
    // libsndfile can't (under Windows).
    sf = SFCall<SNDFILE*>(sf_open_fd, f.fd(), SFM_READ, &info, FALSE);
    if (!sf)
    {
-      SetWarning(XO("Failed to open %s").Format(audioFilename));
+      result.warning = XO("Failed to open %s").Format(audioFilename);
 
-      return true;
+      return result;
    }
 
    if (origin > 0)
    {
       if (SFCall<sf_count_t>(sf_seek, sf, origin.as_long_long(), SEEK_SET) < 0)
       {
-         SetWarning(XO("Failed to seek to position %lld in %s")
-            .Format(origin.as_long_long(), audioFilename));
+         result.warning = XO("Failed to seek to position %lld in %s")
+            .Format(origin.as_long_long(), audioFilename);
 
-         return true;
+         return result;
       }
    }
 
@@ -1532,8 +1633,8 @@ bool AUPImportFileHandle::AddSamples(const FilePath &blockFilename,
    wxASSERT(channels >= 1);
    wxASSERT(channel < channels);
 
-   SampleBuffer buffer(cnt, format);
-   samplePtr bufptr = buffer.ptr();
+   result.buffer.Allocate(cnt, format);
+   samplePtr bufptr = result.buffer.ptr();
 
    size_t framesRead = 0;
 
@@ -1550,10 +1651,10 @@ bool AUPImportFileHandle::AddSamples(const FilePath &blockFilename,
       framesRead = SFCall<sf_count_t>(sf_readf_int, sf, (int *) bufptr, cnt);
       if (framesRead != cnt)
       {
-         SetWarning(XO("Unable to read %lld samples from %s")
-            .Format(cnt, audioFilename));
+         result.warning = XO("Unable to read %lld samples from %s")
+            .Format(cnt, audioFilename);
 
-         return true;
+         return result;
       }
 
       // libsndfile gave us the 3 byte sample in the 3 most
@@ -1577,10 +1678,10 @@ bool AUPImportFileHandle::AddSamples(const FilePath &blockFilename,
       framesRead = SFCall<sf_count_t>(sf_readf_short, sf, tmpptr, cnt);
       if (framesRead != cnt)
       {
-         SetWarning(XO("Unable to read %lld samples from %s")
-            .Format(cnt, audioFilename));
+         result.warning = XO("Unable to read %lld samples from %s")
+            .Format(cnt, audioFilename);
 
-         return true;
+         return result;
       }
 
       for (size_t i = 0; i < framesRead; i++)
@@ -1611,10 +1712,10 @@ bool AUPImportFileHandle::AddSamples(const FilePath &blockFilename,
       framesRead = SFCall<sf_count_t>(sf_readf_float, sf, tmpptr, cnt);
       if (framesRead != cnt)
       {
-         SetWarning(XO("Unable to read %lld samples from %s")
-            .Format(cnt, audioFilename));
+         result.warning = XO("Unable to read %lld samples from %s")
+            .Format(cnt, audioFilename);
 
-         return true;
+         return result;
       }
 
       /*
@@ -1639,20 +1740,7 @@ bool AUPImportFileHandle::AddSamples(const FilePath &blockFilename,
                   channels /* source stride */);
    }
 
-   wxASSERT(mClip || mWaveTrack);
-
-   // Add the samples to the clip/track
-   if (pClip)
-   {
-      if (pClip->NChannels() != 1)
-         return false;
-      pBlock = pClip->AppendLegacyNewBlock(bufptr, format, cnt);
-   }
-
-   // Let the finally block know everything is good
-   success = true;
-
-   return true;
+   return result;
 }
 
 bool AUPImportFileHandle::SetError(const TranslatableString &msg)
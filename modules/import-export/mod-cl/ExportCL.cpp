@@ -13,12 +13,16 @@
 
 #include "ProjectRate.h"
 
+#include <condition_variable>
+#include <functional>
+#include <mutex>
 #include <thread>
 
 #include <wx/app.h>
 #include <wx/cmdline.h>
 #include <wx/combobox.h>
 #include <wx/button.h>
+#include <wx/file.h>
 #include <wx/log.h>
 #include <wx/process.h>
 #include <wx/sizer.h>
@@ -155,16 +159,162 @@ private:
    int mStatus;
 };
 
+//----------------------------------------------------------------------------
+// PipeWriter
+//----------------------------------------------------------------------------
+
+//! Writes to the standard input of the command on its own thread, so that
+//! the next block can be mixed while the pipe is full
+class PipeWriter final
+{
+public:
+   //! How long to wait at a time for the writer, before calling idle again
+   static constexpr auto IdleInterval = std::chrono::milliseconds(10);
+
+   explicit PipeWriter(wxOutputStream &os)
+      : mStream{ os }
+      , mThread{ [this]{ Run(); } }
+   {
+   }
+
+   ~PipeWriter()
+   {
+      {
+         std::lock_guard<std::mutex> lock{ mMutex };
+         mStop = true;
+      }
+      mCondition.notify_all();
+      mThread.join();
+   }
+
+   //! Queue a copy of the bytes, waiting while both buffers are busy
+   /*!
+    @param idle called while waiting
+    @return false if writing to the stream failed
+    */
+   bool Write(const void *data, size_t bytes, const std::function<void()> &idle)
+   {
+      std::unique_lock<std::mutex> lock{ mMutex };
+      while (!mFailed && mFilled == 2) {
+         if (!mCondition.wait_for(lock, IdleInterval,
+            [this]{ return mFailed || mFilled < 2; }))
+         {
+            lock.unlock();
+            idle();
+            lock.lock();
+         }
+      }
+      if (mFailed)
+         return false;
+
+      // Only this thread touches the buffer that is not filled
+      auto &buffer = mBuffers[(mNext + mFilled) % 2];
+      lock.unlock();
+      const auto begin = static_cast<const char*>(data);
+      buffer.assign(begin, begin + bytes);
+      lock.lock();
+
+      ++mFilled;
+      mCondition.notify_all();
+      return true;
+   }
+
+   //! Wait until everything queued is written
+   /*!
+    @param idle called while waiting
+    @return false if writing to the stream failed
+    */
+   bool Flush(const std::function<void()> &idle)
+   {
+      std::unique_lock<std::mutex> lock{ mMutex };
+      while (!mFailed && mFilled > 0) {
+         if (!mCondition.wait_for(lock, IdleInterval,
+            [this]{ return mFailed || mFilled == 0; }))
+         {
+            lock.unlock();
+            idle();
+            lock.lock();
+         }
+      }
+      return !mFailed;
+   }
+
+private:
+   void Run()
+   {
+      while (true) {
+         std::unique_lock<std::mutex> lock{ mMutex };
+         mCondition.wait(lock, [this]{ return mStop || mFilled > 0; });
+         if (mStop)
+            return;
+         const auto &buffer = mBuffers[mNext];
+         lock.unlock();
+
+         // Write the whole block, as fast as the command reads it
+         auto data = buffer.data();
+         auto bytes = buffer.size();
+         bool ok = true;
+         while (bytes > 0) {
+            mStream.Write(data, bytes);
+            if (!mStream.IsOk()) {
+               ok = false;
+               break;
+            }
+            const auto written = mStream.LastWrite();
+            if (written == 0) {
+               // The pipe is full; don't spin
+               using namespace std::chrono;
+               std::this_thread::sleep_for(1ms);
+               std::lock_guard<std::mutex> guard{ mMutex };
+               if (mStop)
+                  return;
+               continue;
+            }
+            bytes -= written;
+            data += written;
+         }
+
+         lock.lock();
+         if (!ok)
+            mFailed = true;
+         else {
+            mNext = (mNext + 1) % 2;
+            --mFilled;
+         }
+         mCondition.notify_all();
+         if (!ok)
+            return;
+      }
+   }
+
+   wxOutputStream &mStream;
+
+   std::mutex mMutex;
+   std::condition_variable mCondition;
+   std::vector<char> mBuffers[2];
+   //! Index of the buffer being written, or to write next
+   size_t mNext{ 0 };
+   //! How many buffers wait to be written, or are being written
+   size_t mFilled{ 0 };
+   bool mFailed{ false };
+   bool mStop{ false };
+
+   // Last, so that the rest is ready when it starts
+   std::thread mThread;
+};
+
 }
 
 enum : int {
    CLOptionIDCommand = 0,
-   CLOptionIDShowOutput
+   CLOptionIDShowOutput,
+   CLOptionIDRawPipe
 };
 
 const std::vector<ExportOption> CLOptions {
    { CLOptionIDCommand, {}, std::string() },
-   { CLOptionIDShowOutput, {}, false }
+   { CLOptionIDShowOutput, {}, false },
+   { CLOptionIDRawPipe, {}, std::string() }
 };
 
 class ExportOptionsCLEditor final
@@ -173,6 +323,8 @@ class ExportOptionsCLEditor final
 {
    wxString mCommand {wxT("lame - \"%f\"")};
    bool mShowOutput {false};
+   //! Named pipe for raw samples, instead of running the command
+   wxString mRawPipe;
    bool mInitialized {false};
 public:
 
@@ -224,6 +376,13 @@ public:
 
                S.AddFixedText( {} );
                S.TieCheckBox(XXO("Show output"), mShowOutput);
+               S.AddFixedText( {} );
+
+               mLastRawPipe = mRawPipe;
+               S.AddTextBox(XXO("Raw output pipe:"), mRawPipe, 0)
+                  ->Bind(wxEVT_TEXT, [this](wxCommandEvent& event) {
+                     mLastRawPipe = event.GetString();
+                  });
             }
             S.EndMultiColumn();
          }
@@ -236,6 +395,10 @@ public:
       named by %f, will read.  And yes, it's %f, not %s -- this isn't actually used
       in the program as a format string.  Keep %f unchanged. */
    "Data will be piped to standard in. \"%f\" uses the file name in the export window."), 250);
+         S.AddTitle(XO(
+   /* i18n-hint: "named pipe" is a special file through which another program,
+      already running, reads the data as it is written. */
+   "If a raw output pipe is given, the command is not run, and the samples are written to that named pipe as 32-bit floats, without a header."), 250);
       }
       S.EndVerticalLay();
    }
@@ -299,6 +462,10 @@ public:
 
    bool TransferDataFromWindow() override
    {
+      mRawPipe = mLastRawPipe;
+      if(!mRawPipe.empty())
+         // The command will not run
+         return true;
       if(IsValidCommand(mLastCommand))
       {
          mCommand = mLastCommand;
@@ -341,6 +508,11 @@ public:
          value = mShowOutput;
          return true;
       }
+      if(id == CLOptionIDRawPipe)
+      {
+         value = std::string(mRawPipe.ToUTF8());
+         return true;
+      }
       return false;
    }
 
@@ -356,6 +528,11 @@ public:
          mShowOutput = *std::get_if<bool>(&value);
          return true;
       }
+      if(id == CLOptionIDRawPipe && std::holds_alternative<std::string>(value))
+      {
+         mRawPipe = wxString::FromUTF8(*std::get_if<std::string>(&value));
+         return true;
+      }
       return false;
    }
 
@@ -363,12 +540,14 @@ public:
    {
       mCommand = config.Read(wxT("/FileFormats/ExternalProgramExportCommand"), mCommand);
       mShowOutput = config.Read(wxT("/FileFormats/ExternalProgramShowOutput"), mShowOutput);
+      mRawPipe = config.Read(wxT("/FileFormats/ExternalProgramRawPipe"), mRawPipe);
    }
 
    void Store(audacity::BasicSettings& config) const override
    {
       config.Write(wxT("/FileFormats/ExternalProgramExportCommand"), mCommand);
       config.Write(wxT("/FileFormats/ExternalProgramShowOutput"), mShowOutput);
+      config.Write(wxT("/FileFormats/ExternalProgramRawPipe"), mRawPipe);
    }
 
 private:
@@ -411,6 +590,8 @@ private:
    //Currently mCommandBox isn't available from
    //`TransferDataFromWindow` since parent window is destroyed.
    wxString mLastCommand;
+   //Likewise for the raw output pipe
+   wxString mLastRawPipe;
 
    FileHistory mHistory;
 };
@@ -428,6 +609,8 @@ class CLExportProcessor : public ExportProcessor
       std::unique_ptr<Mixer> mixer;
       wxString output;
       std::unique_ptr<ExportCLProcess> process;
+      //! Open instead of the process, when writing raw samples to a pipe
+      wxFile rawPipe;
    } context;
 public:
 
@@ -442,6 +625,7 @@ public:
    ExportResult Process(ExportProcessorDelegate& delegate) override;
 
 private:
+   ExportResult ProcessRaw(ExportProcessorDelegate& delegate);
 
    static std::vector<char> GetMetaChunk(const Tags *metadata);
 };
@@ -515,6 +699,22 @@ bool CLExportProcessor::Initialize(AudacityProject& project,
       context.cmd.Replace( "%f", "%f.wav" );
    context.cmd.Replace(wxT("%f"), path);
 
+   const auto rawPipe = wxString::FromUTF8(ExportPluginHelpers::GetParameterValue<std::string>(parameters, CLOptionIDRawPipe));
+   if (!rawPipe.empty()) {
+      // Write to a named pipe, which another program already reads
+      if (!context.rawPipe.Open(rawPipe, wxFile::write))
+         throw ExportException(XO("Cannot export audio to %s")
+            .Format( rawPipe )
+            .Translation());
+
+      context.mixer = ExportPluginHelpers::CreateMixer(
+         TrackList::Get( project ), selectionOnly, t0, t1, channels,
+         44100 * 5, true, lrint(sampleRate), floatSample, mixerSpec);
+
+      context.status = XO("Exporting the audio to %s").Format(rawPipe);
+      return true;
+   }
+
    // Kick off the command
    context.process = std::make_unique<ExportCLProcess>(&context.output);
    auto& process = *context.process;
@@ -651,62 +851,61 @@ bool CLExportProcessor::Initialize(AudacityProject& project,
 ExportResult CLExportProcessor::Process(ExportProcessorDelegate& delegate)
 {
    delegate.SetStatusString(context.status);
+   if (!context.process)
+      return ProcessRaw(delegate);
+
    auto& process = *context.process;
    auto exportResult = ExportResult::Success;
    {
-      size_t numBytes = 0;
-      constSamplePtr mixed = nullptr;
-
       wxOutputStream *os = process.GetOutputStream();
       auto closeIt = finally ( [&] {
          // Should make the process die, before propagating any exception
          process.CloseOutput();
       } );
 
-      // Start piping the mixed data to the command
-      while (exportResult == ExportResult::Success && process.IsActive() && os->IsOk()) {
-         // Capture any stdout and stderr from the command
+      // Capture any stdout and stderr from the command, also while waiting
+      // for the pipe, so that the command does not block on its own output
+      const auto drain = [&]{
          Drain(process.GetInputStream(), &context.output);
          Drain(process.GetErrorStream(), &context.output);
+      };
 
-         // Need to mix another block
-         if (numBytes == 0) {
-            auto numSamples = context.mixer->Process();
-            if (numSamples == 0)
-               break;
+      // Destroyed before closeIt
+      PipeWriter writer{ *os };
+
+      // Start piping the mixed data to the command
+      while (exportResult == ExportResult::Success && process.IsActive()) {
+         drain();
 
-            mixed = context.mixer->GetBuffer();
-            numBytes = numSamples * context.channels;
+         auto numSamples = context.mixer->Process();
+         if (numSamples == 0)
+            break;
 
-            // Byte-swapping is necessary on big-endian machines, since
-            // WAV files are little-endian
+         auto mixed = context.mixer->GetBuffer();
+         size_t numBytes = numSamples * context.channels;
+
+         // Byte-swapping is necessary on big-endian machines, since
+         // WAV files are little-endian
 #if wxBYTE_ORDER == wxBIG_ENDIAN
-            auto buffer = (const float *) mixed;
-            for (int i = 0; i < numBytes; i++) {
-               buffer[i] = wxUINT32_SWAP_ON_BE(buffer[i]);
-            }
-#endif
-            numBytes *= SAMPLE_SIZE(floatSample);
+         auto buffer = (const float *) mixed;
+         for (int i = 0; i < numBytes; i++) {
+            buffer[i] = wxUINT32_SWAP_ON_BE(buffer[i]);
          }
+#endif
+         numBytes *= SAMPLE_SIZE(floatSample);
 
-         // Don't write too much at once...pipes may not be able to handle it
-         size_t bytes = wxMin(numBytes, 4096);
-         numBytes -= bytes;
-
-         while (bytes > 0) {
-            os->Write(mixed, bytes);
-            if (!os->IsOk()) {
-               exportResult = ExportResult::Error;
-               break;
-            }
-            bytes -= os->LastWrite();
-            mixed += os->LastWrite();
+         // The writer copies the block, and the mixer may go on
+         if (!writer.Write(mixed, numBytes, drain)) {
+            exportResult = ExportResult::Error;
+            break;
          }
 
-         if(exportResult == ExportResult::Success)
-            exportResult = ExportPluginHelpers::UpdateProgress(
-               delegate, *context.mixer, context.t0, context.t1);
+         exportResult = ExportPluginHelpers::UpdateProgress(
+            delegate, *context.mixer, context.t0, context.t1);
       }
+
+      if (exportResult == ExportResult::Success && !writer.Flush(drain))
+         exportResult = ExportResult::Error;
       // Done with the progress display
    }
 
@@ -753,6 +952,35 @@ ExportResult CLExportProcessor::Process(ExportProcessorDelegate& delegate)
    return exportResult;
 }
 
+ExportResult CLExportProcessor::ProcessRaw(ExportProcessorDelegate& delegate)
+{
+   auto exportResult = ExportResult::Success;
+   while (exportResult == ExportResult::Success) {
+      auto numSamples = context.mixer->Process();
+      if (numSamples == 0)
+         break;
+
+      // Write straight from the mixer's buffer, in the native byte order;
+      // the reader of the pipe paces the export
+      auto mixed = context.mixer->GetBuffer();
+      size_t numBytes = numSamples * context.channels * SAMPLE_SIZE(floatSample);
+      while (numBytes > 0) {
+         const auto written = context.rawPipe.Write(mixed, numBytes);
+         if (written == 0) {
+            exportResult = ExportResult::Error;
+            break;
+         }
+         numBytes -= written;
+         mixed += written;
+      }
+
+      if(exportResult == ExportResult::Success)
+         exportResult = ExportPluginHelpers::UpdateProgress(
+            delegate, *context.mixer, context.t0, context.t1);
+   }
+   context.rawPipe.Close();
+   return exportResult;
+}
 
 std::vector<char> CLExportProcessor::GetMetaChunk(const Tags *tags)
 {
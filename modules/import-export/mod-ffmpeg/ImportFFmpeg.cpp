@@ -23,6 +23,15 @@ Licensed under the GNU General Public License v2 or later
 #include "FFmpeg.h"
 #include "FFmpegFunctions.h"
 
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <thread>
+
 #include <wx/log.h>
 #include <wx/window.h>
 
@@ -185,8 +194,144 @@ struct StreamContext final
    sampleFormat SampleFormat { floatSample };
 
    bool Use { true };
+
+   //! With a time range, the time in seconds of the first packet read,
+   //! and whether a packet past the range was read
+   std::optional<double> FirstTime;
+   bool RangeDone { false };
+};
+
+//! Samples of one packet, decoded but not yet appended to a track
+struct DecodedPacket final
+{
+   //! Index of the stream in mStreamContexts and mStreams
+   size_t Stream { 0 };
+
+   //! Channels interleaved in the data, and how many of them to append
+   int Channels { 0 };
+   int AppendedChannels { 0 };
+
+   sampleFormat SampleFormat { floatSample };
+   std::vector<int16_t> Int16Data;
+   std::vector<float> FloatData;
+};
+
+namespace {
+//! Appends decoded packets on a worker thread, while the calling thread
+//! demultiplexes and decodes the next ones
+/*!
+ Packets pass through a bounded queue, so memory use does not depend on the
+ length of the file
+ */
+class AppendPipeline final
+{
+public:
+   using Consumer = std::function<void(const DecodedPacket&)>;
+
+   //! How many packets decoding may run ahead of appending
+   static constexpr size_t QueueDepth = 16;
+
+   explicit AppendPipeline(Consumer consumer)
+      : mConsumer{ std::move(consumer) }
+      , mThread{ [this]{ Run(); } }
+   {}
+   AppendPipeline(const AppendPipeline&) = delete;
+   AppendPipeline &operator=(const AppendPipeline&) = delete;
+
+   //! Discards what is not yet appended, if the import ends early
+   ~AppendPipeline();
+
+   //! Wait for room in the queue, then enqueue
+   /*! @throws whatever the consumer threw for an earlier packet */
+   void Push(DecodedPacket packet);
+
+   //! Wait until all pushed packets are appended
+   /*! @throws whatever the consumer threw */
+   void Finish();
+
+private:
+   void Run();
+
+   const Consumer mConsumer;
+
+   std::deque<DecodedPacket> mQueue;
+   std::mutex mMutex;
+   std::condition_variable mPushed, mPopped;
+   bool mStop { false };
+   bool mFinished { false };
+   std::exception_ptr mException;
+   std::thread mThread;
 };
 
+AppendPipeline::~AppendPipeline()
+{
+   if (mThread.joinable()) {
+      {
+         std::lock_guard<std::mutex> lock{ mMutex };
+         mStop = true;
+      }
+      mPushed.notify_one();
+      mThread.join();
+   }
+}
+
+void AppendPipeline::Push(DecodedPacket packet)
+{
+   {
+      std::unique_lock<std::mutex> lock{ mMutex };
+      mPopped.wait(lock, [this]{
+         return mStop || mQueue.size() < QueueDepth; });
+      if (mException)
+         std::rethrow_exception(mException);
+      mQueue.push_back(std::move(packet));
+   }
+   mPushed.notify_one();
+}
+
+void AppendPipeline::Finish()
+{
+   {
+      std::lock_guard<std::mutex> lock{ mMutex };
+      mFinished = true;
+   }
+   mPushed.notify_one();
+   if (mThread.joinable())
+      mThread.join();
+   if (mException)
+      std::rethrow_exception(mException);
+}
+
+void AppendPipeline::Run()
+{
+   while (true) {
+      DecodedPacket packet;
+      {
+         std::unique_lock<std::mutex> lock{ mMutex };
+         mPushed.wait(lock, [this]{
+            return mStop || mFinished || !mQueue.empty(); });
+         if (mStop || mQueue.empty())
+            return;
+         packet = std::move(mQueue.front());
+         mQueue.pop_front();
+      }
+      mPopped.notify_one();
+
+      try {
+         mConsumer(packet);
+      }
+      catch (...) {
+         {
+            std::lock_guard<std::mutex> lock{ mMutex };
+            mException = std::current_exception();
+            mStop = true;
+         }
+         mPopped.notify_one();
+         return;
+      }
+   }
+}
+}
+
 ///! Does actual import, returned by FFmpegImportPlugin::Open
 class FFmpegImportFileHandle final : public ImportFileHandle
 {
@@ -217,9 +362,19 @@ public:
 
    void Stop() override;
 
-   ///! Writes decoded data into WaveTracks.
+   bool SetTimeRange(const ImportTimeRange& range) override;
+
+   ///! Decodes a packet, and updates the progress
    ///\param sc - stream context
-   void WriteData(StreamContext* sc, const AVPacketWrapper* packet);
+   DecodedPacket DecodePacket(StreamContext* sc, const AVPacketWrapper* packet);
+
+   ///! Notes the time of a packet when importing a time range
+   ///\return false if the packet is past the range
+   bool InRange(StreamContext& sc, const AVPacketWrapper& packet);
+
+   ///! Writes decoded data into WaveTracks.
+   ///! May be called on another thread than DecodePacket()
+   void WriteData(const DecodedPacket& decoded);
 
    ///! Writes extracted metadata to tags object
    ///\param avf - file context
@@ -272,6 +427,7 @@ private:
 
    bool                  mCancelled = false;     //!< True if importing was canceled by user
    bool                  mStopped = false;       //!< True if importing was stopped by user
+   std::optional<ImportTimeRange> mTimeRange;    //!< Interval of the file to import, if not all
    const FilePath        mName;
    std::vector<WaveTrack::Holder> mStreams;
 };
@@ -383,7 +539,12 @@ bool FFmpegImportFileHandle::InitCodecs()
 
          auto codecContextPtr = stream->GetAVCodecContext();
 
-         if ( codecContextPtr->Open( codecContextPtr->GetCodec() ) < 0 )
+         // Zero threads lets the decoder choose how many, for the kinds of
+         // threading (frame, slice) that it supports
+         AVDictionaryWrapper options(*mFFmpeg);
+         options.Set("threads", "0");
+
+         if ( codecContextPtr->Open( codecContextPtr->GetCodec(), &options ) < 0 )
          {
             wxLogError(wxT("FFmpeg : Open() failed. Index[%02d], Codec[%02x - %s]"),i,id,name);
             //Can't open decoder - skip this stream
@@ -491,15 +652,26 @@ void FFmpegImportFileHandle::Import(
             s, (long long)streamStartTime, double(streamStartTime) / 1000);
       }
 
-      if (stream_delay > 0) {
+      // With a time range, the track is trimmed relative to the first
+      // packet instead
+      if (stream_delay > 0 && !mTimeRange) {
          stream->InsertSilence(0, double(stream_delay) / AUDACITY_AV_TIME_BASE);
       }
 
       mStreams.push_back(stream);
    }
 
+   // Start near the range, if seeking fails this just decodes more
+   if (mTimeRange && mTimeRange->t0 > 0)
+      mAVFormatContext->SeekTo(
+         static_cast<int64_t>(mTimeRange->t0 * AUDACITY_AV_TIME_BASE));
+
    // This is the heart of the importing process
 
+   // Appending, with conversion and writing of blocks, overlaps decoding
+   AppendPipeline pipeline{
+      [this](const DecodedPacket& decoded){ WriteData(decoded); } };
+
    // Read frames.
    for (std::unique_ptr<AVPacketWrapper> packet;
         (packet = mAVFormatContext->ReadNextPacket()) != nullptr &&
@@ -515,7 +687,15 @@ void FFmpegImportFileHandle::Import(
       if (streamContextIt == mStreamContexts.end())
          continue;
 
-      WriteData(&(*streamContextIt), packet.get());
+      if (mTimeRange && !InRange(*streamContextIt, *packet))
+      {
+         if (std::all_of(mStreamContexts.begin(), mStreamContexts.end(),
+            [](const StreamContext& ctx){ return ctx.RangeDone; }))
+            break;
+         continue;
+      }
+
+      pipeline.Push(DecodePacket(&(*streamContextIt), packet.get()));
       if(mProgressLen > 0)
          progressListener.OnImportProgress(static_cast<double>(mProgressPos) /
                                            static_cast<double>(mProgressLen));
@@ -527,7 +707,7 @@ void FFmpegImportFileHandle::Import(
       auto emptyPacket = mFFmpeg->CreateAVPacketWrapper();
 
       for (StreamContext& sc : mStreamContexts)
-         WriteData(&sc, emptyPacket.get());
+         pipeline.Push(DecodePacket(&sc, emptyPacket.get()));
    }
 
    if(mCancelled)
@@ -536,9 +716,21 @@ void FFmpegImportFileHandle::Import(
       return;
    }
 
+   pipeline.Finish();
+
    // Copy audio from mChannels to newly created tracks (destroying mChannels elements in process)
    ImportUtils::FinalizeImport(outTracks, mStreams);
 
+   // Trim the flushed tracks to the range, which the first packets may
+   // precede because seeking finds a key frame
+   if (mTimeRange)
+      for (unsigned s = 0; s < mStreamContexts.size(); ++s)
+      {
+         const auto firstTime = mStreamContexts[s].FirstTime.value_or(0.0);
+         ImportUtils::TrimToRange(*mStreams[s],
+            mTimeRange->t0 - firstTime, mTimeRange->t1 - firstTime);
+      }
+
    // Save metadata
    WriteMetadata(tags);
    progressListener.OnImportResult(mStopped
@@ -563,70 +755,44 @@ void FFmpegImportFileHandle::Stop()
       mStopped = true;
 }
 
-void FFmpegImportFileHandle::WriteData(StreamContext *sc, const AVPacketWrapper* packet)
+bool FFmpegImportFileHandle::SetTimeRange(const ImportTimeRange& range)
 {
-   // Find the stream in mStreamContexts array
-   auto streamIt = std::find_if(
-      mStreamContexts.begin(),
-      mStreamContexts.end(),
-      [&](StreamContext& context) { return sc == &context; }
-   );
-
-   // Stream is not found. This should not really happen
-   if (streamIt == mStreamContexts.end())
-   {
-      //VS: Shouldn't this mean import failure?
-      return;
-   }
-   auto stream = mStreams[std::distance(mStreamContexts.begin(), streamIt)];
-
-   const auto nChannels = std::min(sc->CodecContext->GetChannels(), sc->InitialChannels);
+   mTimeRange = range;
+   return true;
+}
 
-   // Write audio into WaveTracks
-   if (sc->SampleFormat == int16Sample)
-   {
-      auto data = sc->CodecContext->DecodeAudioPacketInt16(packet);
-      const auto channelsCount = sc->CodecContext->GetChannels();
-      const auto samplesPerChannel = data.size() / channelsCount;
+bool FFmpegImportFileHandle::InRange(
+   StreamContext& sc, const AVPacketWrapper& packet)
+{
+   const auto pts = packet.GetPresentationTimestamp();
+   if (pts == AUDACITY_AV_NOPTS_VALUE)
+      return !sc.RangeDone;
+
+   const auto timeBase =
+      mAVFormatContext->GetStream(sc.StreamIndex)->GetTimeBase();
+   const double time = double(pts) * timeBase.num / timeBase.den;
+   if (!sc.FirstTime)
+      sc.FirstTime = time;
+   // Packets are in order within the stream, so the rest are past it too
+   if (time >= mTimeRange->t1)
+      sc.RangeDone = true;
+   return !sc.RangeDone;
+}
 
-      unsigned chn = 0;
-      ImportUtils::ForEachChannel(*stream, [&](auto& channel)
-      {
-         if(chn >= nChannels)
-            return;
+DecodedPacket FFmpegImportFileHandle::DecodePacket(
+   StreamContext *sc, const AVPacketWrapper* packet)
+{
+   DecodedPacket decoded;
+   decoded.Stream = sc - mStreamContexts.data();
+   decoded.Channels = sc->CodecContext->GetChannels();
+   decoded.AppendedChannels = std::min(decoded.Channels, sc->InitialChannels);
+   decoded.SampleFormat = sc->SampleFormat;
 
-         channel.AppendBuffer(
-            reinterpret_cast<samplePtr>(data.data() + chn),
-            sc->SampleFormat,
-            samplesPerChannel,
-            sc->CodecContext->GetChannels(),
-            sc->SampleFormat
-         );
-         ++chn;
-      });
-   }
+   if (sc->SampleFormat == int16Sample)
+      decoded.Int16Data = sc->CodecContext->DecodeAudioPacketInt16(packet);
    else if (sc->SampleFormat == floatSample)
-   {
-      auto data = sc->CodecContext->DecodeAudioPacketFloat(packet);
-      const auto channelsCount = sc->CodecContext->GetChannels();
-      const auto samplesPerChannel = data.size() / channelsCount;
+      decoded.FloatData = sc->CodecContext->DecodeAudioPacketFloat(packet);
 
-      auto channelIndex = 0;
-      ImportUtils::ForEachChannel(*stream, [&](auto& channel)
-      {
-         if(channelIndex >= nChannels)
-            return;
-
-         channel.AppendBuffer(
-            reinterpret_cast<samplePtr>(data.data() + channelIndex),
-            sc->SampleFormat,
-            samplesPerChannel,
-            sc->CodecContext->GetChannels(),
-            sc->SampleFormat
-         );
-         ++channelIndex;
-      });
-   }
    const AVStreamWrapper* avStream = mAVFormatContext->GetStream(sc->StreamIndex);
 
    int64_t filesize = mFFmpeg->avio_size(mAVFormatContext->GetAVIOContext()->GetWrappedValue());
@@ -660,6 +826,47 @@ void FFmpegImportFileHandle::WriteData(StreamContext *sc, const AVPacketWrapper*
       mProgressPos = packet->GetPos();
       mProgressLen = filesize;
    }
+
+   return decoded;
+}
+
+void FFmpegImportFileHandle::WriteData(const DecodedPacket& decoded)
+{
+   auto stream = mStreams[decoded.Stream];
+   if (decoded.Channels <= 0)
+      return;
+
+   // Write audio into WaveTracks
+   const auto format = decoded.SampleFormat;
+   constSamplePtr data;
+   size_t size;
+   if (format == int16Sample) {
+      data = reinterpret_cast<constSamplePtr>(decoded.Int16Data.data());
+      size = decoded.Int16Data.size();
+   }
+   else if (format == floatSample) {
+      data = reinterpret_cast<constSamplePtr>(decoded.FloatData.data());
+      size = decoded.FloatData.size();
+   }
+   else
+      return;
+   const auto samplesPerChannel = size / decoded.Channels;
+
+   int chn = 0;
+   ImportUtils::ForEachChannel(*stream, [&](auto& channel)
+   {
+      if(chn >= decoded.AppendedChannels)
+         return;
+
+      channel.AppendBuffer(
+         data + chn * SAMPLE_SIZE(format),
+         format,
+         samplesPerChannel,
+         decoded.Channels,
+         format
+      );
+      ++chn;
+   });
 }
 
 void FFmpegImportFileHandle::WriteMetadata(Tags *tags)
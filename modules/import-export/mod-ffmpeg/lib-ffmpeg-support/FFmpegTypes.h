@@ -79,6 +79,8 @@
 
 #define AUDACITY_AV_TIME_BASE (1000 * 1000)
 
+#define AUDACITY_AVSEEK_FLAG_BACKWARD 1
+
 #define AUDACITY_AV_CODEC_FLAG_QSCALE (1 << 1)
 
 #define AUDACITY_AV_CODEC_CAP_SMALL_LAST_FRAME    (1 <<  6)
@@ -109,6 +109,13 @@ std::unique_ptr<AVPacketWrapper> AVFormatContextWrapper::ReadNextPacket()
    return packet;
 }
 
+bool AVFormatContextWrapper::SeekTo(int64_t timestamp)
+{
+   // Stream index -1 means the timestamp is in AV_TIME_BASE units
+   return mFFmpeg.av_seek_frame(
+      mAVFormatContext, -1, timestamp, AUDACITY_AVSEEK_FLAG_BACKWARD) >= 0;
+}
+
 std::unique_ptr<AVStreamWrapper> AVFormatContextWrapper::CreateStream()
 {
    // The complementary deallocation happens in avformat_free_context
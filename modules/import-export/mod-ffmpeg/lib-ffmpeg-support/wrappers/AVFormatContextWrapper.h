@@ -56,6 +56,11 @@ public:
    //! @return is null at end of stream
    std::unique_ptr<AVPacketWrapper> ReadNextPacket();
 
+   //! Seeks to the last key frame at or before the timestamp
+   //! \param timestamp in AUDACITY_AV_TIME_BASE units
+   //! @return whether seeking succeeded
+   bool SeekTo(int64_t timestamp);
+
    std::unique_ptr<AVStreamWrapper> CreateStream();
 
    const AVInputFormatWrapper* GetInputFormat() const noexcept;
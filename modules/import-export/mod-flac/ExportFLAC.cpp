@@ -32,10 +32,14 @@ Joshua Haberman
 
 #include "wxFileNameWrapper.h"
 
+#include "ExportMixerPipeline.h"
 #include "ExportPluginHelpers.h"
 #include "ExportPluginRegistry.h"
 #include "PlainExportOptionsEditor.h"
 
+#include <algorithm>
+#include <thread>
+
 //----------------------------------------------------------------------------
 // ExportFLACOptions Class
 //----------------------------------------------------------------------------
@@ -132,6 +136,14 @@ ChoiceSetting FLACLevel{
 
 #define SAMPLES_PER_RUN 8192u
 
+// Seconds between points of the SEEKTABLE
+#define SECONDS_PER_SEEK_POINT 10
+
+/* libFLAC 1.5.0 (API version 14) can encode frames on several threads */
+#if defined FLAC_API_VERSION_CURRENT && FLAC_API_VERSION_CURRENT >= 14
+#define FLAC_ENCODER_THREADS
+#endif
+
 /* FLACPP_API_VERSION_CURRENT is 6 for libFLAC++ from flac-1.1.3 (see <FLAC++/export.h>) */
 #if !defined FLACPP_API_VERSION_CURRENT || FLACPP_API_VERSION_CURRENT < 6
 #define LEGACY_FLAC
@@ -184,7 +196,10 @@ class FLACExportProcessor final : public ExportProcessor
       sampleFormat format;
       FLAC::Encoder::File encoder;
       wxFFile f;
-      std::unique_ptr<Mixer> mixer;
+      std::unique_ptr<ExportMixerPipeline> mixer;
+      // The encoder fills in the seek points, and must be able to until
+      // finish()
+      FLAC__StreamMetadataHandle seekTable;
    } context;
 
 public:
@@ -202,6 +217,8 @@ public:
 private:
 
    FLAC__StreamMetadataHandle MakeMetadata(AudacityProject *project, const Tags *tags) const;
+   static FLAC__StreamMetadataHandle MakeSeekTable(
+      unsigned sampleRate, FLAC__uint64 totalSamples);
 };
 
 class ExportFLAC final : public ExportPlugin
@@ -331,11 +348,19 @@ bool FLACExportProcessor::Initialize(AudacityProject& project,
       throw ExportErrorException("FLAC:283");
    }
 
+   // A SEEKTABLE, so that players and importers can seek without bisecting
+   // the file
+   const auto totalSamples =
+      static_cast<FLAC__uint64>(std::max(0.0, t1 - t0) * sampleRate + 0.5);
+   if (success && totalSamples > 0) {
+      success = encoder.set_total_samples_estimate(totalSamples);
+      context.seekTable = MakeSeekTable(lrint(sampleRate), totalSamples);
+   }
+
    if (success && metadata) {
       // set_metadata expects an array of pointers to metadata and a size.
-      // The size is 1.
-      FLAC__StreamMetadata *p = metadata.get();
-      success = encoder.set_metadata(&p, 1);
+      FLAC__StreamMetadata *p[] = { metadata.get(), context.seekTable.get() };
+      success = encoder.set_metadata(p, context.seekTable ? 2 : 1);
    }
 
    
@@ -374,6 +399,14 @@ bool FLACExportProcessor::Initialize(AudacityProject& project,
    encoder.set_rice_parameter_search_dist(flacLevels[levelPref].rice_parameter_search_dist) &&
    encoder.set_max_lpc_order(flacLevels[levelPref].max_lpc_order);
 
+#ifdef FLAC_ENCODER_THREADS
+   // Frames are independent, so libFLAC can encode several at once and
+   // still write them in order, with correct STREAMINFO and seek points.
+   // It returns an error status, and leaves one thread, if not built with
+   // thread support; that is not a failure.
+   encoder.set_num_threads(std::max(1u, std::thread::hardware_concurrency()));
+#endif
+
    if (!success) {
       // TODO: more precise message
       throw ExportErrorException("FLAC:336");
@@ -402,10 +435,11 @@ bool FLACExportProcessor::Initialize(AudacityProject& project,
 
    metadata.reset();
 
-   context.mixer = ExportPluginHelpers::CreateMixer(tracks, selectionOnly,
+   context.mixer = std::make_unique<ExportMixerPipeline>(
+      ExportPluginHelpers::CreateMixer(tracks, selectionOnly,
                             t0, t1,
                             numChannels, SAMPLES_PER_RUN, false,
-                            sampleRate, context.format, mixerSpec);
+                            sampleRate, context.format, mixerSpec));
 
    context.status = selectionOnly
       ? XO("Exporting the selected audio as FLAC")
@@ -525,6 +559,23 @@ FLAC__StreamMetadataHandle FLACExportProcessor::MakeMetadata(AudacityProject *pr
    return metadata;
 }
 
+FLAC__StreamMetadataHandle FLACExportProcessor::MakeSeekTable(
+   unsigned sampleRate, FLAC__uint64 totalSamples)
+{
+   auto seekTable = FLAC__StreamMetadataHandle(
+      ::FLAC__metadata_object_new(FLAC__METADATA_TYPE_SEEKTABLE)
+   );
+
+   // Placeholders that the encoder replaces with the frames it writes
+   if (!seekTable ||
+       !::FLAC__metadata_object_seektable_template_append_spaced_points_by_samples(
+          seekTable.get(), SECONDS_PER_SEEK_POINT * sampleRate, totalSamples) ||
+       !::FLAC__metadata_object_seektable_template_sort(seekTable.get(), true))
+      return {};
+
+   return seekTable;
+}
+
 static ExportPluginRegistry::RegisteredPlugin sRegisteredPlugin{ "FLAC",
    []{ return std::make_unique< ExportFLAC >(); }
 };
@@ -45,6 +45,8 @@ static const auto exts = {
 
 #include "FLAC++/decoder.h"
 
+#include <algorithm>
+
 #include "WaveTrack.h"
 #include "ImportUtils.h"
 
@@ -128,6 +130,10 @@ public:
       TrackHolders& outTracks, Tags* tags,
       std::optional<LibFileFormats::AcidizerTags>& outAcidTags) override;
 
+   bool SupportsConcurrentImport() const override { return true; }
+
+   bool SetTimeRange(const ImportTimeRange& range) override;
+
    wxInt32 GetStreamCount() override { return 1; }
 
    const TranslatableStrings &GetStreamInfo() override
@@ -149,6 +155,9 @@ private:
    FLAC__uint64          mNumSamples;
    FLAC__uint64          mSamplesDone;
    bool                  mStreamInfoDone;
+   bool                  mUseRange{ false };
+   FLAC__uint64          mRangeStart{ 0 };
+   FLAC__uint64          mRangeEnd{ 0 };
    WaveTrack::Holder     mTrack;
 };
 
@@ -221,39 +230,52 @@ FLAC__StreamDecoderWriteStatus MyFLACFile::write_callback(const FLAC__Frame *fra
 {
    // Don't let C++ exceptions propagate through libflac
    return GuardedCall< FLAC__StreamDecoderWriteStatus > ( [&] {
-      auto tmp = ArrayOf< short >{ frame->header.blocksize };
+      // Don't append past the end of a requested range
+      auto blocksize = frame->header.blocksize;
+      if (mFile->mUseRange)
+         blocksize = static_cast<unsigned>(std::min<FLAC__uint64>(
+            blocksize, mFile->mRangeEnd - mFile->mSamplesDone));
+
+      auto tmp = ArrayOf< short >{ blocksize };
 
       unsigned chn = 0;
       ImportUtils::ForEachChannel(*mFile->mTrack, [&](auto& channel)
       {
          if (frame->header.bits_per_sample <= 16) {
             if (frame->header.bits_per_sample == 8) {
-               for (unsigned int s = 0; s < frame->header.blocksize; s++) {
+               for (unsigned int s = 0; s < blocksize; s++) {
                   tmp[s] = buffer[chn][s] << 8;
                }
             } else /* if (frame->header.bits_per_sample == 16) */ {
-               for (unsigned int s = 0; s < frame->header.blocksize; s++) {
+               for (unsigned int s = 0; s < blocksize; s++) {
                   tmp[s] = buffer[chn][s];
                }
             }
 
             channel.AppendBuffer((samplePtr)tmp.get(),
                      int16Sample,
-                     frame->header.blocksize, 1,
+                     blocksize, 1,
                      int16Sample);
          }
          else {
             channel.AppendBuffer((samplePtr)buffer[chn],
                      int24Sample,
-                     frame->header.blocksize, 1,
+                     blocksize, 1,
                      int24Sample);
          }
          ++chn;
       });
 
-      mFile->mSamplesDone += frame->header.blocksize;
+      mFile->mSamplesDone += blocksize;
 
-      if(mFile->mNumSamples > 0)
+      if (mFile->mUseRange)
+      {
+         if (mFile->mRangeEnd > mFile->mRangeStart)
+            mImportProgressListener->OnImportProgress(
+               static_cast<double>(mFile->mSamplesDone - mFile->mRangeStart) /
+               static_cast<double>(mFile->mRangeEnd - mFile->mRangeStart));
+      }
+      else if(mFile->mNumSamples > 0)
          mImportProgressListener->OnImportProgress(static_cast<double>(mFile->mSamplesDone) /
                                                    static_cast<double>(mFile->mNumSamples));
 
@@ -262,6 +284,10 @@ FLAC__StreamDecoderWriteStatus MyFLACFile::write_callback(const FLAC__Frame *fra
          return FLAC__STREAM_DECODER_WRITE_STATUS_ABORT;
       }
 
+      // Stop decoding at the end of the range
+      if (mFile->mUseRange && mFile->mSamplesDone >= mFile->mRangeEnd)
+         return FLAC__STREAM_DECODER_WRITE_STATUS_ABORT;
+
       return FLAC__STREAM_DECODER_WRITE_STATUS_CONTINUE;
    }, MakeSimpleGuard(FLAC__STREAM_DECODER_WRITE_STATUS_ABORT) );
 }
@@ -392,6 +418,25 @@ auto FLACImportFileHandle::GetFileUncompressedBytes() -> ByteCount
    return 0;
 }
 
+bool FLACImportFileHandle::SetTimeRange(const ImportTimeRange& range)
+{
+   if (!mStreamInfoDone || mSampleRate == 0)
+      return false;
+
+   const auto toSample = [&](double t) {
+      auto sample =
+         static_cast<FLAC__uint64>(std::max(0.0, t) * mSampleRate + 0.5);
+      // Total samples may be unknown (zero) in the STREAMINFO
+      if (mNumSamples > 0)
+         sample = std::min(sample, mNumSamples);
+      return sample;
+   };
+   mRangeStart = toSample(range.t0);
+   mRangeEnd = std::max(mRangeStart, toSample(range.t1));
+   mUseRange = true;
+   return true;
+}
+
 void FLACImportFileHandle::Import(
    ImportProgressListener& progressListener, WaveTrackFactory* trackFactory,
    TrackHolders& outTracks, Tags* tags,
@@ -409,13 +454,31 @@ void FLACImportFileHandle::Import(
 
    mFile->mImportProgressListener = &progressListener;
 
-   // TODO: Vigilant Sentry: Variable res unused after assignment (error code DA1)
-   //    Should check the result.
-   #ifdef LEGACY_FLAC
-      bool res = (mFile->process_until_end_of_file() != 0);
-   #else
-      bool res = (mFile->process_until_end_of_stream() != 0);
-   #endif
+   if (mUseRange)
+   {
+      // The decoder uses the SEEKTABLE if there is one, else it bisects the
+      // file; while seeking it passes the rest of the target frame to
+      // write_callback
+      mSamplesDone = mRangeStart;
+      // Decoding may also stop during the seek, if the range is that short
+      if (mRangeStart > 0 && mRangeStart < mRangeEnd &&
+          !mFile->seek_absolute(mRangeStart) && mSamplesDone == mRangeStart)
+      {
+         progressListener.OnImportResult(ImportProgressListener::ImportResult::Error);
+         return;
+      }
+   }
+
+   if (!mUseRange || mSamplesDone < mRangeEnd)
+   {
+      // TODO: Vigilant Sentry: Variable res unused after assignment (error code DA1)
+      //    Should check the result.
+      #ifdef LEGACY_FLAC
+         bool res = (mFile->process_until_end_of_file() != 0);
+      #else
+         bool res = (mFile->process_until_end_of_stream() != 0);
+      #endif
+   }
 
    if(IsCancelled())
    {
@@ -95,6 +95,7 @@
 #endif
 
 #include "ExportOptionsEditor.h"
+#include "ExportMixerPipeline.h"
 #include "ExportPluginHelpers.h"
 #include "ExportPluginRegistry.h"
 #include "SelectFile.h"
@@ -1605,7 +1606,7 @@ class MP3ExportProcessor final : public ExportProcessor
       wxFileOffset infoTagPos;
       size_t bufferSize;
       int inSamples;
-      std::unique_ptr<Mixer> mixer;
+      std::unique_ptr<ExportMixerPipeline> mixer;
    } context;
 
 public:
@@ -1950,10 +1951,11 @@ bool MP3ExportProcessor::Initialize(AudacityProject& project,
             .Format( bitrate );
    }
 
-   context.mixer = ExportPluginHelpers::CreateMixer(tracks, selectionOnly,
+   context.mixer = std::make_unique<ExportMixerPipeline>(
+      ExportPluginHelpers::CreateMixer(tracks, selectionOnly,
          t0, t1,
          channels, context.inSamples, true,
-         rate, floatSample, mixerSpec);
+         rate, floatSample, mixerSpec));
 
    return true;
 }
@@ -10,6 +10,7 @@
 */
 
 #include <wx/defs.h>
+#include <algorithm>
 #include <cstddef>
 #include <cstring>
 
@@ -133,6 +134,10 @@ public:
       TrackHolders& outTracks, Tags* tags,
       std::optional<LibFileFormats::AcidizerTags>& outAcidTags) override;
 
+   bool SupportsConcurrentImport() const override { return true; }
+
+   bool SetTimeRange(const ImportTimeRange& range) override;
+
    bool SetupOutputFormat();
 
    void ReadTags(Tags* tags);
@@ -159,6 +164,10 @@ private:
 
    bool mFloat64Output {};
 
+   bool mUseRange { false };
+   off_t mRangeStart { 0 };
+   off_t mRangeEnd { 0 };
+
    friend MP3ImportPlugin;
 }; // class MP3ImportFileHandle
 
@@ -260,6 +269,30 @@ void MP3ImportFileHandle::SetStreamUsage(wxInt32 WXUNUSED(StreamID), bool WXUNUS
 {
 }
 
+bool MP3ImportFileHandle::SetTimeRange(const ImportTimeRange& range)
+{
+   long rate;
+   int channels;
+   int encoding;
+   if (mpg123_getformat(mHandle, &rate, &channels, &encoding) != MPG123_OK ||
+       rate <= 0)
+      return false;
+
+   // mpg123_scan() in Open() built the frame index, so the length is exact
+   const off_t length = mpg123_length(mHandle);
+
+   const auto toSample = [&](double t) {
+      auto sample = static_cast<off_t>(std::max(0.0, t) * rate + 0.5);
+      if (length > 0)
+         sample = std::min(sample, length);
+      return sample;
+   };
+   mRangeStart = toSample(range.t0);
+   mRangeEnd = std::max(mRangeStart, toSample(range.t1));
+   mUseRange = true;
+   return true;
+}
+
 void MP3ImportFileHandle::Import(
    ImportProgressListener& progressListener, WaveTrackFactory* trackFactory,
    TrackHolders& outTracks, Tags* tags,
@@ -288,10 +321,32 @@ void MP3ImportFileHandle::Import(
 
    int ret = MPG123_OK;
 
-   while ((ret = mpg123_decode_frame(mHandle, &frameIndex, &data, &dataSize)) ==
+   // Samples still to append from a requested range
+   off_t rangeLeft = mRangeEnd - mRangeStart;
+   if (mUseRange)
+   {
+      // Seeking uses the frame index, and the next decoded frame starts
+      // exactly at the sample sought
+      if (rangeLeft == 0)
+         ret = MPG123_DONE;
+      else if (mpg123_seek(mHandle, mRangeStart, SEEK_SET) < 0)
+      {
+         wxLogError(
+            "Failed to seek in MP3 file: %s", mpg123_strerror(mHandle));
+
+         progressListener.OnImportResult(ImportProgressListener::ImportResult::Error);
+         return;
+      }
+   }
+
+   while (ret == MPG123_OK &&
+          (ret = mpg123_decode_frame(mHandle, &frameIndex, &data, &dataSize)) ==
                  MPG123_OK)
    {
-      if(framesCount > 0)
+      if (mUseRange)
+         progressListener.OnImportProgress(
+            1.0 - static_cast<double>(rangeLeft) / (mRangeEnd - mRangeStart));
+      else if(framesCount > 0)
          progressListener.OnImportProgress(static_cast<double>(frameIndex) / static_cast<double>(framesCount));
 
       if(IsCancelled())
@@ -302,7 +357,9 @@ void MP3ImportFileHandle::Import(
       //VS: doesn't implement Stop behavior...
 
       constSamplePtr samples = reinterpret_cast<constSamplePtr>(data);
-      const size_t samplesCount = dataSize / sizeof(float) / mNumChannels;
+      size_t samplesCount = dataSize / sizeof(float) / mNumChannels;
+      if (mUseRange)
+         samplesCount = std::min<size_t>(samplesCount, rangeLeft);
 
       // libmpg123 picks up the format based on some "internal" precision.
       // This case is not expected to happen
@@ -330,6 +387,9 @@ void MP3ImportFileHandle::Import(
             floatSample);
          ++chn;
       });
+
+      if (mUseRange && (rangeLeft -= samplesCount) == 0)
+         ret = MPG123_DONE;
    }
 
    if (ret != MPG123_DONE)
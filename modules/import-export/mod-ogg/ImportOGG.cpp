@@ -103,6 +103,8 @@ public:
       TrackHolders& outTracks, Tags* tags,
       std::optional<LibFileFormats::AcidizerTags>& outAcidTags) override;
 
+   bool SupportsConcurrentImport() const override { return true; }
+
    wxInt32 GetStreamCount() override
    {
       if (mVorbisFile)
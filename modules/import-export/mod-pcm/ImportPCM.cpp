@@ -33,14 +33,18 @@
 #error Requires libsndfile 1.0 or higher
 #endif
 
+#include "FileException.h"
 #include "FileFormats.h"
 #include "GetAcidizerTags.h"
 #include "ImportPlugin.h"
 #include "ImportProgressListener.h"
 #include "ImportUtils.h"
+#include "MappedPCMReader.h"
+#include "SampleBlock.h"
 #include "WaveTrack.h"
 
 #include <algorithm>
+#include <mutex>
 
 #ifdef USE_LIBID3TAG
    #include <id3tag.h>
@@ -86,6 +90,8 @@ public:
       TrackHolders& outTracks, Tags* tags,
       std::optional<LibFileFormats::AcidizerTags>& outAcidTags) override;
 
+   bool SupportsConcurrentImport() const override { return true; }
+
    wxInt32 GetStreamCount() override { return 1; }
 
    const TranslatableStrings &GetStreamInfo() override
@@ -98,12 +104,95 @@ public:
    {}
 
 private:
+   //! Whether the tracks can refer to the file itself, until the project
+   //! copies the samples
+   bool CanImportOnDemand() const;
+
    SFFile                mFile;
    const SF_INFO         mInfo;
    sampleFormat          mEffectiveFormat;
    sampleFormat          mFormat;
+   const bool            mOnDemand;
+};
+
+namespace {
+//! Open with a file descriptor, because wxWidgets can open a file with a
+//! Unicode name and libsndfile can't (under Windows)
+SFFile OpenSFFile(const FilePath &filename, SF_INFO &info)
+{
+   wxFile f;   // will be closed when it goes out of scope
+   SFFile file;
+   if (f.Open(filename))
+      file.reset(SFCall<SNDFILE*>(sf_open_fd, f.fd(), SFM_READ, &info, TRUE));
+
+   // The file descriptor is now owned by "file", so we must tell "f" to leave
+   // it alone.  The file descriptor is closed by the destructor of file even
+   // if an error occurs.
+   f.Detach();
+   return file;
+}
+
+//! A file shared by the sources of its channels
+struct PCMFile {
+   PCMFile(const FilePath &name, SFFile &&file, const SF_INFO &info)
+      : mName{ name }, mFile{ std::move(file) }, mInfo{ info }
+   {}
+
+   const FilePath mName;
+   //! Serializes seeks and reads
+   std::mutex mMutex;
+   SFFile mFile;
+   const SF_INFO mInfo;
 };
 
+//! Reads one channel of a file, which is deinterleaved on demand
+class PCMFileSource final : public SampleBlockSource
+{
+public:
+   PCMFileSource(std::shared_ptr<PCMFile> pFile, unsigned channel)
+      : mpFile{ std::move(pFile) }, mChannel{ channel }
+   {}
+
+   void Read(sampleCount start, size_t numsamples,
+      samplePtr dest, sampleFormat format) override;
+
+private:
+   const std::shared_ptr<PCMFile> mpFile;
+   const unsigned mChannel;
+};
+
+void PCMFileSource::Read(sampleCount start, size_t numsamples,
+   samplePtr dest, sampleFormat format)
+{
+   auto &file = *mpFile;
+   const auto channels = file.mInfo.channels;
+   // Read 16 bit samples as they are, and anything else as float, as the
+   // copying import does
+   const auto readFormat = (format == int16Sample) ? int16Sample : floatSample;
+   SampleBuffer interleaved{ numsamples * channels, readFormat };
+
+   {
+      std::lock_guard<std::mutex> lock{ file.mMutex };
+      sf_count_t read = -1;
+      if (SFCall<sf_count_t>(sf_seek, file.mFile.get(),
+            start.as_long_long(), SEEK_SET) >= 0) {
+         if (readFormat == int16Sample)
+            read = SFCall<sf_count_t>(sf_readf_short, file.mFile.get(),
+               (short *)interleaved.ptr(), numsamples);
+         else
+            read = SFCall<sf_count_t>(sf_readf_float, file.mFile.get(),
+               (float *)interleaved.ptr(), numsamples);
+      }
+      // The file may have changed or gone since the import
+      if (read != static_cast<sf_count_t>(numsamples))
+         throw FileException{ FileException::Cause::Read, file.mName };
+   }
+
+   CopySamples(interleaved.ptr() + mChannel * SAMPLE_SIZE(readFormat),
+      readFormat, dest, format, numsamples, DitherType::none, channels);
+}
+}
+
 TranslatableString PCMImportPlugin::GetPluginFormatDescription()
 {
     return DESC;
@@ -113,8 +202,6 @@ std::unique_ptr<ImportFileHandle> PCMImportPlugin::Open(
    const FilePath &filename, AudacityProject*)
 {
    SF_INFO info;
-   wxFile f;   // will be closed when it goes out of scope
-   SFFile file;
 
    memset(&info, 0, sizeof(info));
 
@@ -136,17 +223,7 @@ std::unique_ptr<ImportFileHandle> PCMImportPlugin::Open(
 #endif
 
 
-   if (f.Open(filename)) {
-      // Even though there is an sf_open() that takes a filename, use the one that
-      // takes a file descriptor since wxWidgets can open a file with a Unicode name and
-      // libsndfile can't (under Windows).
-      file.reset(SFCall<SNDFILE*>(sf_open_fd, f.fd(), SFM_READ, &info, TRUE));
-   }
-
-   // The file descriptor is now owned by "file", so we must tell "f" to leave
-   // it alone.  The file descriptor is closed by the destructor of file even if an error
-   // occurs.
-   f.Detach();
+   auto file = OpenSFFile(filename, info);
 
    if (!file) {
       // TODO: Handle error
@@ -182,7 +259,9 @@ PCMImportFileHandle::PCMImportFileHandle(const FilePath &name,
                                          SFFile &&file, SF_INFO info)
 :  ImportFileHandleEx(name),
    mFile(std::move(file)),
-   mInfo(info)
+   mInfo(info),
+   // Read the preference now, in the main thread
+   mOnDemand{ ImportOnDemand.Read() }
 {
    wxASSERT(info.channels >= 0);
 
@@ -266,6 +345,25 @@ using Unevaluated2 = decltype(
       untranslated, {} };
 }
 
+bool PCMImportFileHandle::CanImportOnDemand() const
+{
+   if (!mOnDemand || !mInfo.seekable || mInfo.channels < 1)
+      return false;
+   // Only where reading at a given frame is cheap
+   switch (mInfo.format & SF_FORMAT_SUBMASK) {
+   case SF_FORMAT_PCM_S8:
+   case SF_FORMAT_PCM_16:
+   case SF_FORMAT_PCM_24:
+   case SF_FORMAT_PCM_32:
+   case SF_FORMAT_PCM_U8:
+   case SF_FORMAT_FLOAT:
+   case SF_FORMAT_DOUBLE:
+      return true;
+   default:
+      return false;
+   }
+}
+
 auto PCMImportFileHandle::GetFileUncompressedBytes() -> ByteCount
 {
    return mInfo.frames * mInfo.channels * SAMPLE_SIZE(mFormat);
@@ -299,7 +397,27 @@ void PCMImportFileHandle::Import(
       (sampleCount)mInfo.frames; // convert from sf_count_t
    auto maxBlockSize = track->GetMaxBlockSize();
 
-   {
+   std::shared_ptr<PCMFile> pFile;
+   if (CanImportOnDemand()) {
+      // Open again, for the sources, which outlive this handle
+      SF_INFO info{};
+      if (auto file = OpenSFFile(GetFilename(), info))
+         pFile = std::make_shared<PCMFile>(
+            GetFilename(), std::move(file), info);
+   }
+
+   if (pFile) {
+      // In the "on-demand" mode, the blocks refer to the file, and the
+      // samples are copied into the project later
+      unsigned c = 0;
+      ImportUtils::ForEachChannel(*track, [&](auto& channel)
+      {
+         channel.AppendDeferred(std::make_shared<PCMFileSource>(pFile, c++),
+            0, fileTotalFrames, mEffectiveFormat);
+      });
+      progressListener.OnImportProgress(1.0);
+   }
+   else {
       // Otherwise, we're in the "copy" mode, where we read in the actual
       // samples from the file and store our own local copy of the
       // samples in the tracks.
@@ -321,9 +439,15 @@ void PCMImportFileHandle::Import(
          return;
       }
 
+      // Uncompressed samples are read from a mapping of the file, without
+      // the copies of buffered reading
+      const auto reader = MappedPCMReader::Open(GetFilename(), mFile.get(),
+         mInfo, (mFormat == int16Sample) ? int16Sample : floatSample);
+
       SampleBuffer srcbuffer, buffer;
       wxASSERT(mInfo.channels >= 0);
-      while (NULL == srcbuffer.Allocate(maxBlock * mInfo.channels, mFormat).ptr() ||
+      while ((!reader &&
+              NULL == srcbuffer.Allocate(maxBlock * mInfo.channels, mFormat).ptr()) ||
              NULL == buffer.Allocate(maxBlock, mFormat).ptr())
       {
          maxBlock /= 2;
@@ -340,7 +464,10 @@ void PCMImportFileHandle::Import(
       do {
          block = maxBlock;
 
-         if (mFormat == int16Sample)
+         if (reader)
+            block = limitSampleBufferSize(maxBlock,
+               fileTotalFrames - framescompleted);
+         else if (mFormat == int16Sample)
             block = SFCall<sf_count_t>(sf_readf_short, mFile.get(), (short *)srcbuffer.ptr(), block);
          //import 24 bit int as float and have the append function convert it.  This is how PCMAliasBlockFile worked too.
          else
@@ -351,7 +478,22 @@ void PCMImportFileHandle::Import(
             block = maxBlock;
          }
 
-         if (block) {
+         if (block && reader) {
+            unsigned c = 0;
+            ImportUtils::ForEachChannel(*track, [&](auto& channel)
+            {
+               size_t stride;
+               const auto samples = reader->Read(
+                  framescompleted.as_long_long(), block, c, buffer.ptr(),
+                  stride);
+               channel.AppendBuffer(samples,
+                  (mFormat == int16Sample) ? int16Sample : floatSample,
+                  block, stride, mEffectiveFormat);
+               ++c;
+            });
+            framescompleted += block;
+         }
+         else if (block) {
             unsigned c = 0;
             ImportUtils::ForEachChannel(*track, [&](auto& channel)
             {
@@ -25,6 +25,7 @@
 #include "Track.h"
 #include "Tags.h"
 
+#include "ExportMixerPipeline.h"
 #include "ExportPluginHelpers.h"
 #include "ExportOptionsEditor.h"
 #include "ExportPluginRegistry.h"
@@ -256,7 +257,7 @@ class WavPackExportProcessor final : public ExportProcessor
       sampleFormat format;
       WriteId outWvFile, outWvcFile;
       WavpackContext *wpc{};
-      std::unique_ptr<Mixer> mixer;
+      std::unique_ptr<ExportMixerPipeline> mixer;
       std::unique_ptr<Tags> metadata;
    } context;
 public:
@@ -485,10 +486,11 @@ bool WavPackExportProcessor::Initialize(AudacityProject& project,
          : *metadata
       );
 
-   context.mixer = ExportPluginHelpers::CreateMixer(tracks, selectionOnly,
+   context.mixer = std::make_unique<ExportMixerPipeline>(
+      ExportPluginHelpers::CreateMixer(tracks, selectionOnly,
          t0, t1,
          numChannels, SAMPLES_PER_RUN, true,
-         sampleRate, context.format, mixerSpec);
+         sampleRate, context.format, mixerSpec));
 
    return true;
 }
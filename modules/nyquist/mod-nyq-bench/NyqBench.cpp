@@ -23,8 +23,11 @@
 #include <wx/textctrl.h>
 #include <wx/toolbar.h>
 
+#include <wx/app.h>
+
 #include "ActiveProject.h"
 #include "AudioIOBase.h"
+#include "BasicUI.h"
 #include "CommonCommandFlags.h"
 #include "ModuleConstants.h"
 #include "Prefs.h"
@@ -38,6 +41,7 @@
 #include "AudacityMessageBox.h"
 
 #include "NyqBench.h"
+#include "NyqBenchRunner.h"
 
 #include <iostream>
 #include <ostream>
@@ -111,6 +115,19 @@ void RegisterMenuItems()
       ) )
    };
 }
+
+void ScheduleHeadlessRun()
+{
+   auto options = NyqBenchRunner::FromEnvironment();
+   if (!options)
+      return;
+   // The first project exists by the time the event loop runs
+   BasicUI::CallAfter([options = *options]{
+      if (auto project = GetActiveProject().lock())
+         NyqBenchRunner::Run(*project, options);
+      wxTheApp->ExitMainLoop();
+   });
+}
 }
 
 DEFINE_VERSION_CHECK
@@ -126,6 +143,7 @@ extern "C"
       switch (type){
          case ModuleInitialize:
             RegisterMenuItems();
+            ScheduleHeadlessRun();
             break;
          case AppQuiting: {
             //It is perfectly OK for gBench to be NULL.
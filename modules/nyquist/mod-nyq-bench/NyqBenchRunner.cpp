@@ -0,0 +1,249 @@
+/**********************************************************************
+
+  NyqBenchRunner.cpp
+
+*//*******************************************************************/
+
+#include "NyqBenchRunner.h"
+
+#include <wx/dir.h>
+#include <wx/ffile.h>
+#include <wx/filename.h>
+#include <wx/utils.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <streambuf>
+#include <vector>
+
+#include "CommandContext.h"
+#include "Project.h"
+#include "ViewInfo.h"
+#include "WaveTrack.h"
+#include "effects/EffectManager.h"
+#include "effects/EffectUI.h"
+#include "effects/nyquist/Nyquist.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+//! Times garbage collections by the messages XLISP writes when *gc-flag* is
+//! set:  "[ gc: total ..." when one begins and "... ]" when it ends
+class GcTimer final : public std::streambuf
+{
+public:
+   GcTimer()
+      : mOld{ std::cout.rdbuf(this) }
+   {}
+   ~GcTimer() override
+   {
+      std::cout.rdbuf(mOld);
+   }
+
+   double Seconds() const
+   {
+      return std::chrono::duration<double>(mTotal).count();
+   }
+   unsigned Count() const { return mCount; }
+
+   int overflow(int c) override
+   {
+      if (c == EOF)
+         return 0;
+      if (!mInGc) {
+         mRecent += static_cast<char>(c);
+         if (mRecent.size() > Marker.size())
+            mRecent.erase(0, mRecent.size() - Marker.size());
+         if (mRecent == Marker) {
+            mInGc = true;
+            mStart = Clock::now();
+            mRecent.clear();
+         }
+      }
+      else if (c == ']') {
+         mInGc = false;
+         mTotal += Clock::now() - mStart;
+         ++mCount;
+      }
+      return c;
+   }
+
+private:
+   static inline const std::string Marker{ "[ gc:" };
+
+   std::streambuf *const mOld;
+   std::string mRecent;
+   bool mInGc{ false };
+   Clock::time_point mStart;
+   Clock::duration mTotal{};
+   unsigned mCount{ 0 };
+};
+
+//! Same rule as NyquistEffect::ParseProgram() uses to tell the syntaxes
+bool IsSal(const wxString &script)
+{
+   for (const auto &line : wxSplit(script, wxT('\n'))) {
+      if (line.empty() || line[0] == wxT(';') || line[0] == wxT('$'))
+         continue;
+      if (line[0] == wxT('(') ||
+          (line[0] == wxT('#') && line.length() > 1 && line[1] == wxT('|')))
+         return false;
+      if (line.Upper().Find(wxT("RETURN")) != wxNOT_FOUND)
+         return true;
+   }
+   return false;
+}
+
+//! Replaces the tracks of the project with one of a sine tone and some noise
+void GenerateAudio(AudacityProject &project, const NyqBenchRunner::Options &options)
+{
+   auto &tracks = TrackList::Get(project);
+   tracks.Clear();
+
+   const auto track = WaveTrackFactory::Get(project)
+      .Create(options.channels, floatSample, options.rate);
+   const auto total = static_cast<size_t>(options.seconds * options.rate);
+   constexpr size_t chunk = 65536;
+   std::vector<float> buffer(chunk);
+   // Same audio on every run
+   std::minstd_rand engine{ 1 };
+   std::uniform_real_distribution<float> noise{ -0.05f, 0.05f };
+   for (size_t channel = 0; channel < options.channels; ++channel) {
+      const auto frequency = 440.0 * (channel + 1);
+      for (size_t done = 0; done < total; done += chunk) {
+         const auto count = std::min(chunk, total - done);
+         for (size_t i = 0; i < count; ++i)
+            buffer[i] = 0.5f * std::sin(2 * M_PI * frequency *
+               (done + i) / options.rate) + noise(engine);
+         track->Append(channel, reinterpret_cast<constSamplePtr>(buffer.data()),
+            floatSample, count);
+      }
+   }
+   track->Flush();
+   tracks.Add(track);
+   track->SetSelected(true);
+   ViewInfo::Get(project).selectedRegion.setTimes(0, options.seconds);
+}
+
+sampleCount CountOutputSamples(AudacityProject &project)
+{
+   sampleCount result = 0;
+   for (const auto track : TrackList::Get(project).Any<const WaveTrack>())
+      result += track->TimeToLongSamples(
+         track->GetEndTime() - track->GetStartTime()) * track->NChannels();
+   return result;
+}
+
+wxString Quote(const wxString &value)
+{
+   auto result = value;
+   result.Replace(wxT("\\"), wxT("\\\\"));
+   result.Replace(wxT("\""), wxT("\\\""));
+   return wxT("\"") + result + wxT("\"");
+}
+
+}
+
+std::optional<NyqBenchRunner::Options> NyqBenchRunner::FromEnvironment()
+{
+   Options options;
+   if (!wxGetEnv(wxT("AUDACITY_NYQ_BENCH"), &options.suite) ||
+       options.suite.empty())
+      return {};
+
+   wxString value;
+   double number;
+   if (wxGetEnv(wxT("AUDACITY_NYQ_BENCH_SECONDS"), &value) &&
+       value.ToCDouble(&number) && number > 0)
+      options.seconds = number;
+   if (wxGetEnv(wxT("AUDACITY_NYQ_BENCH_CHANNELS"), &value) &&
+       value.ToCDouble(&number) && (number == 1 || number == 2))
+      options.channels = static_cast<unsigned>(number);
+   if (wxGetEnv(wxT("AUDACITY_NYQ_BENCH_RATE"), &value) &&
+       value.ToCDouble(&number) && number > 0)
+      options.rate = number;
+   wxGetEnv(wxT("AUDACITY_NYQ_BENCH_OUTPUT"), &options.output);
+   return options;
+}
+
+int NyqBenchRunner::Run(AudacityProject &project, const Options &options)
+{
+   wxArrayString scripts;
+   if (wxDir::Exists(options.suite))
+      wxDir::GetAllFiles(options.suite, &scripts, wxT("*.ny"), wxDIR_FILES);
+   scripts.Sort();
+
+   std::ofstream file;
+   if (!options.output.empty())
+      file.open(options.output.ToStdString());
+   // GcTimer takes over std::cout during evaluation, so keep the real one
+   std::ostream results{ file.is_open() ? file.rdbuf() : std::cout.rdbuf() };
+
+   int failures = 0;
+   for (const auto &path : scripts) {
+      const auto name = wxFileName{ path }.GetName();
+      wxString script;
+      wxFFile in{ path };
+      if (!in.IsOpened() || !in.ReadAll(&script)) {
+         ++failures;
+         results << wxString::Format(
+            "{\"script\": %s, \"ok\": false, \"error\": \"unreadable\"}",
+            Quote(name)).ToStdString() << std::endl;
+         continue;
+      }
+      // Turn on the garbage collection messages for this evaluation only
+      script = (IsSal(script)
+         ? wxT("set *gc-flag* = #t\n")
+         : wxT("(setf *gc-flag* t)\n")) + script;
+
+      GenerateAudio(project, options);
+      const auto inputSamples =
+         static_cast<long long>(options.seconds * options.rate) * options.channels;
+
+      // As in NyqBench::OnGo
+      auto pEffect =
+         std::make_unique<NyquistEffect>(L"Nyquist Effect Workbench");
+      auto &effect = *pEffect;
+      const PluginID &ID =
+         EffectManager::Get().RegisterEffect(std::move(pEffect));
+      effect.SetCommand(script);
+      effect.RedirectOutput();
+
+      bool ok;
+      double seconds, cpuSeconds, gcSeconds;
+      unsigned gcCount;
+      {
+         GcTimer gcTimer;
+         const auto cpuStart = std::clock();
+         const auto start = Clock::now();
+         ok = EffectUI::DoEffect(ID, CommandContext(project),
+            EffectManager::kConfigured | EffectManager::kSkipState |
+            EffectManager::kDontRepeatLast);
+         seconds = std::chrono::duration<double>(Clock::now() - start).count();
+         cpuSeconds = double(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+         gcSeconds = gcTimer.Seconds();
+         gcCount = gcTimer.Count();
+      }
+      EffectManager::Get().UnregisterEffect(ID);
+
+      if (!ok)
+         ++failures;
+      const auto outputSamples = CountOutputSamples(project).as_long_long();
+      results << wxString::Format(
+         "{\"script\": %s, \"ok\": %s, \"seconds\": %s, \"cpu_seconds\": %s, "
+         "\"gc_seconds\": %s, \"gc_count\": %u, \"input_samples\": %lld, "
+         "\"output_samples\": %lld, \"samples_per_second\": %s}",
+         Quote(name), ok ? "true" : "false",
+         wxString::FromCDouble(seconds), wxString::FromCDouble(cpuSeconds),
+         wxString::FromCDouble(gcSeconds), gcCount, inputSamples, outputSamples,
+         wxString::FromCDouble(seconds > 0 ? outputSamples / seconds : 0.0)
+      ).ToStdString() << std::endl;
+   }
+   return failures;
+}
@@ -0,0 +1,55 @@
+/**********************************************************************
+
+  NyqBenchRunner.h
+
+**********************************************************************/
+
+#ifndef __NYQUIST_EFFECT_WORKBENCH_RUNNER__
+#define __NYQUIST_EFFECT_WORKBENCH_RUNNER__
+
+#include <optional>
+
+#include <wx/string.h>
+
+class AudacityProject;
+
+//----------------------------------------------------------------------------
+// NyqBenchRunner
+//----------------------------------------------------------------------------
+
+//! Headless mode of the workbench, for profiling Nyquist in automated runs
+/*!
+ Each .ny script of a suite directory runs, in turn, on a fresh track of
+ generated audio.  One line of JSON is written for each script, with the
+ wall clock and processor time of the evaluation, the time spent in garbage
+ collection, and the throughput of output samples.
+
+ Audacity's command line rejects options it does not know, so the mode is
+ chosen with environment variables:
+   AUDACITY_NYQ_BENCH           directory of the suite (required)
+   AUDACITY_NYQ_BENCH_SECONDS   length of the generated audio, default 60
+   AUDACITY_NYQ_BENCH_CHANNELS  1 or 2, default 2
+   AUDACITY_NYQ_BENCH_RATE      sample rate, default 44100
+   AUDACITY_NYQ_BENCH_OUTPUT    results file, default standard output
+ Audacity exits when the suite is done.
+ */
+namespace NyqBenchRunner
+{
+   struct Options
+   {
+      wxString suite;
+      double seconds{ 60.0 };
+      unsigned channels{ 2 };
+      double rate{ 44100.0 };
+      wxString output;
+   };
+
+   //! @return options if headless mode was asked for
+   std::optional<Options> FromEnvironment();
+
+   //! Runs the suite in the project, replacing its tracks
+   //! @return number of scripts that failed
+   int Run(AudacityProject &project, const Options &options);
+}
+
+#endif
@@ -0,0 +1,127 @@
+// BinaryProtocol.cpp
+//
+// Implements the framed protocol of mod-script-pipe, described in
+// BinaryProtocol.h
+
+#include <wx/wx.h>
+#include "BinaryProtocol.h"
+#include "Base64.h"
+#include "commands/ScriptCommandRelay.h"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+const char BinaryProtocolGreeting[] = "BinaryProtocol: Version=1";
+const char BinaryProtocolReply[] = "BinaryProtocol: OK\n";
+
+namespace {
+//! Reject frames larger than this, which are surely not from a script
+constexpr uint32_t MaxFrameBytes = 1 << 28;
+
+enum RecordKind : unsigned char {
+   TextRecord = 0,
+   SamplesRecord = 1,
+};
+
+void AppendCount(std::string &bytes, uint32_t count)
+{
+   for (int ii = 0; ii < 4; ++ii)
+      bytes.push_back(static_cast<char>((count >> (8 * ii)) & 0xff));
+}
+
+void AppendRecord(std::string &bytes, RecordKind kind,
+   const void *pData, size_t nBytes)
+{
+   bytes.push_back(static_cast<char>(kind));
+   AppendCount(bytes, static_cast<uint32_t>(nBytes));
+   bytes.append(static_cast<const char*>(pData), nBytes);
+}
+
+//! The response of GetSamples, without a file, is lines of base64, then the
+//! status
+bool AppendSamples(
+   std::string &bytes, const wxString &command, const wxString &response)
+{
+   if (command.BeforeFirst(wxT(':')).Trim().Trim(false) != wxT("GetSamples") ||
+       command.Contains(wxT("File=")))
+      return false;
+   const auto separator = response.rfind(wxT("\nBatchCommand finished: "));
+   if (separator == wxString::npos ||
+       !response.Mid(separator).StartsWith(
+          wxT("\nBatchCommand finished: OK")))
+      return false;
+
+   const auto lines = wxSplit(response.Left(separator), wxT('\n'), 0);
+   bytes.reserve(bytes.size() + 5 + separator * 3 / 4);
+   bytes.push_back(static_cast<char>(SamplesRecord));
+   const auto countPosition = bytes.size();
+   AppendCount(bytes, 0);
+   const auto dataPosition = bytes.size();
+   std::vector<char> chunk;
+   for (const auto &line : lines) {
+      chunk.resize(line.length() * 3 / 4 + 3);
+      const auto nChunk = Base64::Decode(line, chunk.data());
+      bytes.append(chunk.data(), nChunk);
+   }
+   // Fill in the count
+   const auto count = static_cast<uint32_t>(bytes.size() - dataPosition);
+   for (int ii = 0; ii < 4; ++ii)
+      bytes[countPosition + ii] = static_cast<char>((count >> (8 * ii)) & 0xff);
+   return true;
+}
+
+bool IsBinaryProtocolGreeting(const char *line)
+{
+   const auto length = strlen(BinaryProtocolGreeting);
+   // Allow the line ending that the line protocol strips
+   return strncmp(line, BinaryProtocolGreeting, length) == 0 &&
+      strspn(line + length, "\r\n") == strlen(line + length);
+}
+
+void ServeBinaryProtocol(const ReadBytes &read, const WriteBytes &write)
+{
+   if (!write(BinaryProtocolReply, strlen(BinaryProtocolReply)))
+      return;
+
+   std::string request;
+   std::string reply;
+   while (true) {
+      unsigned char header[4];
+      if (!read(header, sizeof header))
+         return;
+      const uint32_t length = header[0] | (header[1] << 8) |
+         (header[2] << 16) | (uint32_t(header[3]) << 24);
+      if (length > MaxFrameBytes)
+         return;
+      request.resize(length);
+      if (length > 0 && !read(&request[0], length))
+         return;
+
+      wxArrayString commands;
+      for (auto &line : wxSplit(
+         wxString::FromUTF8(request.data(), request.size()), wxT('\n'), 0)) {
+         line.Replace(wxT("\r"), wxT(""));
+         if (!line.empty())
+            commands.push_back(line);
+      }
+      wxArrayString responses;
+      ScriptCommandRelay::ExecuteBatch(commands, responses);
+
+      reply.clear();
+      AppendCount(reply, 0);
+      for (size_t ii = 0; ii < commands.size(); ++ii) {
+         const auto &response = responses[ii];
+         if (!AppendSamples(reply, commands[ii], response)) {
+            const auto text = response.ToUTF8();
+            AppendRecord(reply, TextRecord, text.data(), text.length());
+         }
+      }
+      // Fill in the length of the frame
+      const auto frameLength = static_cast<uint32_t>(reply.size() - 4);
+      for (int ii = 0; ii < 4; ++ii)
+         reply[ii] = static_cast<char>((frameLength >> (8 * ii)) & 0xff);
+      if (!write(reply.data(), reply.size()))
+         return;
+   }
+}
@@ -0,0 +1,42 @@
+// BinaryProtocol.h
+//
+// A framed protocol for mod-script-pipe, which a script selects by sending
+// the greeting line as its first command.  After the reply line, each
+// request is a frame holding a batch of commands, and each reply is a frame
+// holding one record for each command, in order.
+//
+// A frame is a 32 bit little endian count of bytes, then the bytes.
+// Commands of a request frame are UTF-8 text, separated by newlines.
+// A record of a reply is one byte of kind, a 32 bit little endian count of
+// bytes, then the bytes:
+//   kind 0: the UTF-8 response, as the line protocol would send it
+//   kind 1: the samples of a successful GetSamples command without a file,
+//           as little endian 32 bit floats
+//
+// All commands of a frame are sent to the main thread before any response is
+// awaited, and the script may send more frames before reading replies.
+
+#ifndef __BINARY_PROTOCOL__
+#define __BINARY_PROTOCOL__
+
+#include <cstddef>
+#include <functional>
+#include <string>
+
+//! First line that a script sends to select the binary protocol
+extern const char BinaryProtocolGreeting[];
+//! The line sent back before the first frame
+extern const char BinaryProtocolReply[];
+
+//! Reads exactly that many bytes, returning false at end or on error
+using ReadBytes = std::function<bool(void *pBytes, size_t nBytes)>;
+//! Writes all the bytes, flushing them, returning false on error
+using WriteBytes = std::function<bool(const void *pBytes, size_t nBytes)>;
+
+//! Whether a line received by the server is the greeting
+bool IsBinaryProtocolGreeting(const char *line);
+
+//! Serve frames until reading or writing fails
+void ServeBinaryProtocol(const ReadBytes &read, const WriteBytes &write);
+
+#endif
@@ -5,6 +5,8 @@
 #include <stdio.h>
 #include <tchar.h>
 
+#include "BinaryProtocol.h"
+
 const int nBuff = 1024;
 
 extern "C" int DoSrv( char * pIn );
@@ -79,6 +81,40 @@ void PipeServer()
 
             printf( "Rxd %s\n", chRequest );
 
+            if( IsBinaryProtocolGreeting( chRequest ) )
+            {
+               // Frames may span messages, or share them
+               auto read = [&]( void *pBytes, size_t nBytes ){
+                  auto p = static_cast<char *>( pBytes );
+                  while( nBytes > 0 )
+                  {
+                     DWORD nRead = 0;
+                     if( !ReadFile( hPipeToSrv, p, static_cast<DWORD>( nBytes ), &nRead, NULL ) &&
+                         GetLastError() != ERROR_MORE_DATA )
+                        return false;
+                     if( nRead == 0 )
+                        return false;
+                     p += nRead;
+                     nBytes -= nRead;
+                  }
+                  return true;
+               };
+               auto write = [&]( const void *pBytes, size_t nBytes ){
+                  auto p = static_cast<const char *>( pBytes );
+                  while( nBytes > 0 )
+                  {
+                     DWORD nWritten = 0;
+                     if( !WriteFile( hPipeFromSrv, p, static_cast<DWORD>( nBytes ), &nWritten, NULL ) )
+                        return false;
+                     p += nWritten;
+                     nBytes -= nWritten;
+                  }
+                  return true;
+               };
+               ServeBinaryProtocol( read, write );
+               break;
+            }
+
             DoSrv( chRequest );
             jj++;
             while( true )
@@ -114,6 +150,8 @@ void PipeServer()
 #include <unistd.h>
 #include <string.h>
 
+#include "BinaryProtocol.h"
+
 const char fifotmpl[] = "/tmp/audacity_script_pipe.%s.%d";
 
 const int nBuff = 1024;
@@ -175,6 +213,20 @@ void PipeServer()
       buf[len - 1] = '\0';
 
       printf("Server received %s\n", buf);
+
+      if (IsBinaryProtocolGreeting(buf))
+      {
+         ServeBinaryProtocol(
+            [&](void *pBytes, size_t nBytes) {
+               return fread(pBytes, 1, nBytes, toFifo) == nBytes;
+            },
+            [&](const void *pBytes, size_t nBytes) {
+               return fwrite(pBytes, 1, nBytes, fromFifo) == nBytes &&
+                  fflush(fromFifo) == 0;
+            });
+         break;
+      }
+
       DoSrv(buf);
 
       while (true)
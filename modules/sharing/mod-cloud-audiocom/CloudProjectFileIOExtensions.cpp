@@ -312,6 +312,10 @@ void SaveToCloud(
    ioExtension.SetSnapshotCallbackForNextSave(std::move(snapshotCallback));
 
    ProjectFileManager::Get(project).Save();
+
+   // The save may have stopped before the snapshot was created; don't call
+   // the callback at some later save
+   ioExtension.SetSnapshotCallbackForNextSave({});
 }
 
 bool ResaveLocally(AudacityProject& project)
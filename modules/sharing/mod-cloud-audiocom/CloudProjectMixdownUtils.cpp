@@ -72,63 +72,86 @@ void UploadMixdown(
    AudacityProject& project,
    std::function<void(AudacityProject&, MixdownState)> onComplete)
 {
+   auto cancellationContext = concurrency::CancellationContext::Create();
+
+   // The dialog is made after the save, which may show dialogs of its own;
+   // progress of rendering until then is not shown
+   auto progressDialog =
+      std::make_shared<std::unique_ptr<BasicUI::ProgressDialog>>();
+
+   // Render the mixdown while the blocks are hashed and the snapshot is
+   // created, so that saving takes the time of the slower
+   auto mixdownUploader = MixdownUploader::Upload(
+      cancellationContext, GetServiceConfig(), project,
+      [progressDialog, cancellationContext](auto progress)
+      {
+         if (!*progressDialog)
+            return;
+
+         if (
+            (*progressDialog)
+               ->Poll(static_cast<unsigned>(progress * 10000), 10000) !=
+            BasicUI::ProgressResult::Success)
+            cancellationContext->Cancel();
+      });
+
+   bool snapshotCreated = false;
+
    SaveToCloud(
       project, UploadMode::Normal,
-      [&project, onComplete = std::move(onComplete)](const auto& response)
+      [&](const auto& response)
       {
-         auto cancellationContext = concurrency::CancellationContext::Create();
+         snapshotCreated = true;
+         mixdownUploader->SetUrls(response.SyncState.MixdownUrls);
+      });
 
-         auto progressDialog = BasicUI::MakeProgress(
-            XO("Save to audio.com"), XO("Generating audio preview..."),
-            BasicUI::ProgressShowCancel);
+   if (!snapshotCreated)
+   {
+      // The save failed or was cancelled; stop rendering, and keep the
+      // uploader until the export thread is done with it
+      cancellationContext->Cancel();
 
-         auto mixdownUploader = MixdownUploader::Upload(
-            cancellationContext, GetServiceConfig(), project,
-            [progressDialog = progressDialog.get(),
-             cancellationContext](auto progress)
-            {
-               if (
-                  progressDialog->Poll(
-                     static_cast<unsigned>(progress * 10000), 10000) !=
-                  BasicUI::ProgressResult::Success)
-                  cancellationContext->Cancel();
-            });
+      auto future = mixdownUploader->GetResultFuture();
 
-         mixdownUploader->SetUrls(response.SyncState.MixdownUrls);
+      while (future.wait_for(std::chrono::milliseconds(50)) !=
+             std::future_status::ready)
+         BasicUI::Yield();
 
-         BasicUI::CallAfter(
-            [&project,
-             progressDialog = std::shared_ptr { std::move(progressDialog) },
-             mixdownUploader, cancellationContext, onComplete]() mutable
-            {
-               auto& projectCloudExtension =
-                  ProjectCloudExtension::Get(project);
+      return;
+   }
+
+   *progressDialog = BasicUI::MakeProgress(
+      XO("Save to audio.com"), XO("Generating audio preview..."),
+      BasicUI::ProgressShowCancel);
 
-               auto subscription = projectCloudExtension.SubscribeStatusChanged(
-                  [progressDialog = progressDialog.get(), mixdownUploader,
-                   cancellationContext](
-                     const CloudStatusChangedMessage& message)
-                  {
-                     if (message.Status != ProjectSyncStatus::Failed)
-                        return;
+   BasicUI::CallAfter(
+      [&project, progressDialog, mixdownUploader, cancellationContext,
+       onComplete]() mutable
+      {
+         auto& projectCloudExtension = ProjectCloudExtension::Get(project);
+
+         auto subscription = projectCloudExtension.SubscribeStatusChanged(
+            [cancellationContext](const CloudStatusChangedMessage& message)
+            {
+               if (message.Status != ProjectSyncStatus::Failed)
+                  return;
 
-                     cancellationContext->Cancel();
-                  },
-                  true);
+               cancellationContext->Cancel();
+            },
+            true);
 
-               auto future = mixdownUploader->GetResultFuture();
+         auto future = mixdownUploader->GetResultFuture();
 
-               while (future.wait_for(std::chrono::milliseconds(50)) !=
-                      std::future_status::ready)
-                  BasicUI::Yield();
+         while (future.wait_for(std::chrono::milliseconds(50)) !=
+                std::future_status::ready)
+            BasicUI::Yield();
 
-               auto result = future.get();
+         auto result = future.get();
 
-               progressDialog.reset();
+         progressDialog->reset();
 
-               if (onComplete)
-                  onComplete(project, result.State);
-            });
+         if (onComplete)
+            onComplete(project, result.State);
       });
 }
 
@@ -0,0 +1,90 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+
+"""Tests the binary protocol of the audacity pipe.
+
+Sends batches of commands in frames, several frames before reading the
+replies, and fetches samples of the first track as 32 bit floats.
+See modules/scripting/mod-script-pipe/BinaryProtocol.h for the framing.
+
+Make sure Audacity is running first, with a wave track in the project, and
+that mod-script-pipe is enabled before running this script.
+
+Requires Python 3.
+
+"""
+
+import os
+import struct
+import sys
+
+
+if sys.platform == 'win32':
+    TONAME = '\\\\.\\pipe\\ToSrvPipe'
+    FROMNAME = '\\\\.\\pipe\\FromSrvPipe'
+    EOL = b'\r\n\0'
+else:
+    TONAME = '/tmp/audacity_script_pipe.to.' + str(os.getuid())
+    FROMNAME = '/tmp/audacity_script_pipe.from.' + str(os.getuid())
+    EOL = b'\n'
+
+TOFILE = open(TONAME, 'wb')
+FROMFILE = open(FROMNAME, 'rb')
+
+TOFILE.write(b'BinaryProtocol: Version=1' + EOL)
+TOFILE.flush()
+assert FROMFILE.readline() == b'BinaryProtocol: OK\n'
+
+
+def read_exactly(count):
+    """Read count bytes from the pipe."""
+    data = b''
+    while len(data) < count:
+        more = FROMFILE.read(count - len(data))
+        if not more:
+            sys.exit('Pipe closed')
+        data += more
+    return data
+
+
+def send_batch(commands):
+    """Send one frame of commands, without waiting for the reply."""
+    payload = '\n'.join(commands).encode('utf-8')
+    TOFILE.write(struct.pack('<I', len(payload)) + payload)
+    TOFILE.flush()
+
+
+def read_reply():
+    """Return the records of one reply frame, as (kind, bytes) pairs."""
+    (length,) = struct.unpack('<I', read_exactly(4))
+    frame = read_exactly(length)
+    records = []
+    position = 0
+    while position < length:
+        kind, count = struct.unpack_from('<BI', frame, position)
+        position += 5
+        records.append((kind, frame[position:position + count]))
+        position += count
+    return records
+
+
+def quick_test():
+    """Pipeline some batches, then fetch samples."""
+    batches = [['Select: Track=0 Start=0 End=%d' % ii, 'GetInfo: Type=Tracks']
+               for ii in range(1, 4)]
+    for batch in batches:
+        send_batch(batch)
+    for batch in batches:
+        for kind, data in read_reply():
+            print(kind, data.decode('utf-8')[:60])
+
+    send_batch(['GetSamples: Track=0 Channel=0 Start=0 End=1'])
+    for kind, data in read_reply():
+        if kind == 1:
+            samples = struct.unpack('<%df' % (len(data) // 4), data)
+            print('Received %d samples, peak %f'
+                  % (len(samples), max(map(abs, samples), default=0)))
+        else:
+            print(data.decode('utf-8'))
+
+quick_test()
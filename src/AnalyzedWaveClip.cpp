@@ -11,7 +11,49 @@
 #include "AnalyzedWaveClip.h"
 
 #include "ClipMirAudioReader.h"
+#include "MusicInformationRetrieval.h"
 #include "WaveClip.h"
+#include "WaveClipAnalysisCache.h"
+
+#include <locale>
+#include <sstream>
+
+namespace
+{
+constexpr auto meterAnalysis = "meter";
+
+//! "none", or the tempo and the index of the time signature or -1
+std::string Serialize(const std::optional<MIR::MusicalMeter>& meter)
+{
+   if (!meter)
+      return "none";
+   std::ostringstream stream;
+   stream.imbue(std::locale::classic());
+   stream.precision(17);
+   stream << meter->bpm << ' '
+          << (meter->timeSignature ? static_cast<int>(*meter->timeSignature) :
+                                     -1);
+   return stream.str();
+}
+
+//! @return nothing if the string is malformed
+std::optional<std::optional<MIR::MusicalMeter>>
+Deserialize(const std::string& value)
+{
+   if (value == "none")
+      return std::optional<MIR::MusicalMeter> {};
+   std::istringstream stream { value };
+   stream.imbue(std::locale::classic());
+   double bpm = 0;
+   int timeSignature = -1;
+   if (!(stream >> bpm >> timeSignature) || timeSignature < -1 ||
+       timeSignature >= static_cast<int>(MIR::TimeSignature::_count))
+      return {};
+   return std::optional<MIR::MusicalMeter> { MIR::MusicalMeter {
+      bpm, timeSignature < 0 ? std::optional<MIR::TimeSignature> {} :
+                               static_cast<MIR::TimeSignature>(timeSignature) } };
+}
+} // namespace
 
 AnalyzedWaveClip::AnalyzedWaveClip(
    std::shared_ptr<ClipMirAudioReader> reader,
@@ -33,6 +75,23 @@ void AnalyzedWaveClip::SetRawAudioTempo(double tempo)
       mReader->clip->SetRawAudioTempo(tempo);
 }
 
+std::optional<MIR::MusicalMeter> AnalyzedWaveClip::GetMusicalMeter(
+   const ClipMirAudioReader& reader, MIR::FalsePositiveTolerance tolerance,
+   const std::function<void(double)>& progressCallback)
+{
+   const auto& clip = *reader.clip;
+   const auto parameters = std::to_string(static_cast<int>(tolerance));
+   if (const auto found =
+          WaveClipAnalysisCache::Find(clip, meterAnalysis, parameters))
+      if (const auto meter = Deserialize(*found))
+         return *meter;
+   auto meter =
+      MIR::GetMusicalMeterFromSignal(reader, tolerance, progressCallback);
+   WaveClipAnalysisCache::Store(
+      clip, meterAnalysis, parameters, Serialize(meter));
+   return meter;
+}
+
 void AnalyzedWaveClip::Synchronize()
 {
    if (!mReader || !mSyncInfo)
@@ -11,6 +11,7 @@
 #pragma once
 
 #include "MirTypes.h"
+#include <functional>
 #include <memory>
 
 class ClipMirAudioReader;
@@ -26,6 +27,15 @@ public:
    void SetRawAudioTempo(double tempo) override;
    void Synchronize() override;
 
+   /*!
+    * @brief Like `MIR::GetMusicalMeterFromSignal`, but remembering results in
+    * the `WaveClipAnalysisCache` of the clip of the reader, so that the same
+    * audio is not analyzed over again.  May be called from worker threads.
+    */
+   static std::optional<MIR::MusicalMeter> GetMusicalMeter(
+      const ClipMirAudioReader& reader, MIR::FalsePositiveTolerance tolerance,
+      const std::function<void(double)>& progressCallback);
+
 private:
    const std::shared_ptr<ClipMirAudioReader> mReader;
    const std::optional<MIR::ProjectSyncInfo> mSyncInfo;
@@ -72,6 +72,7 @@ It handles initialization and termination by subclassing wxApp.
 #include "Clipboard.h"
 #include "CommandLineArgs.h"
 #include "CrashReport.h" // for HAS_CRASH_REPORT
+#include "DeviceManager.h"
 #include "commands/CommandHandler.h"
 #include "commands/AppCommandEvent.h"
 #include "widgets/ASlider.h"
@@ -111,6 +112,7 @@ It handles initialization and termination by subclassing wxApp.
 #include "wxWidgetsBasicUI.h"
 #include "LogWindow.h"
 #include "FrameStatisticsDialog.h"
+#include "MemoryStatisticsDialog.h"
 #include "PluginStartupRegistration.h"
 #include "IncompatiblePluginsDialog.h"
 #include "wxWidgetsWindowPlacement.h"
@@ -127,9 +129,6 @@ It handles initialization and termination by subclassing wxApp.
 #include "prefs/KeyConfigPrefs.h"
 #endif
 
-//temporarily commented out till it is added to all projects
-//#include "Profiler.h"
-
 #include "ModuleManager.h"
 #include "PluginHost.h"
 
@@ -158,11 +157,14 @@ It handles initialization and termination by subclassing wxApp.
 
 #include "../images/Audacity-splash.xpm"
 
+#include <cstdlib>
+#include <fstream>
 #include <thread>
 
 #include "ExportPluginRegistry.h"
 #include "SettingsWX.h"
 #include "prefs/EffectsPrefs.h"
+#include "Tracing.h"
 
 #ifdef HAS_CUSTOM_URL_HANDLING
 #include "URLSchemesRegistry.h"
@@ -574,12 +576,9 @@ static void QuitAudacity(bool bForce)
    #if !defined(__WXMAC__)
    LogWindow::Destroy();
    FrameStatisticsDialog::Destroy();
+   MemoryStatisticsDialog::Destroy();
    #endif
 
-   //print out profile if we have one by deleting it
-   //temporarily commented out till it is added to all projects
-   //DELETE Profiler::Instance();
-
    // Save last log for diagnosis
    auto logger = AudacityLogger::Get();
    if (logger)
@@ -1353,6 +1352,12 @@ bool AudacityApp::OnInit()
    // Ensure we have an event loop during initialization
    wxEventLoopGuarantor eventLoop;
 
+   // Setting AUDACITY_TRACE to a path records timed scopes of all threads,
+   // written there on exit in the Chrome trace format
+   Tracing::RegisterThread("Main");
+   if (const auto tracePath = getenv("AUDACITY_TRACE"); tracePath && *tracePath)
+      Tracing::Start();
+
    OnInit0();
 
    FileNames::InitializePathList();
@@ -1378,6 +1383,7 @@ bool AudacityApp::OnInit()
    mThemeChangeSubscription = theTheme.Subscribe(OnThemeChange);
 
    {
+      TRACE_SCOPE("LoadPreferredTheme");
       wxBusyCursor busy;
       theTheme.LoadPreferredTheme();
    }
@@ -1444,14 +1450,20 @@ bool AudacityApp::InitPart2()
    InitCommandHandler();
 
    // Initialize the ModuleManager, including loading found modules
-   ModuleManager::Get().Initialize();
+   {
+      TRACE_SCOPE("ModuleManager::Initialize");
+      ModuleManager::Get().Initialize();
+   }
 
    // Initialize the PluginManager
-   PluginManager::Get().Initialize( [](const FilePath &localFileName){
-      return std::make_unique<SettingsWX>(
-         AudacityFileConfig::Create({}, {}, localFileName)
-      );
-   });
+   {
+      TRACE_SCOPE("PluginManager::Initialize");
+      PluginManager::Get().Initialize( [](const FilePath &localFileName){
+         return std::make_unique<SettingsWX>(
+            AudacityFileConfig::Create({}, {}, localFileName)
+         );
+      });
+   }
 
    // Parse command line and handle options that might require
    // immediate exit...no need to initialize all of the audio
@@ -1544,6 +1556,10 @@ bool AudacityApp::InitPart2()
       InitDitherers();
       AudioIO::Init();
 
+      // Probing devices is slow, so let it overlap the building of the
+      // first window, until its device toolbars need the results
+      DeviceManager::Instance()->StartScan();
+
 #ifdef __WXMAC__
 
       // On the Mac, users don't expect a program to quit when you close the last window.
@@ -1601,6 +1617,7 @@ bool AudacityApp::InitPart2()
    // Root cause is problem with wxSplashScreen and other dialogs co-existing, that
    // seemed to arrive with wx3.
    {
+      TRACE_SCOPE("ProjectManager::New");
       project = ProjectManager::New();
    }
 
@@ -2470,6 +2487,12 @@ int AudacityApp::OnExit()
    // Terminate the PluginManager (must be done before deleting the locale)
    PluginManager::Get().Terminate();
 
+   if (Tracing::IsRecording()) {
+      Tracing::Stop();
+      std::ofstream traceFile{ getenv("AUDACITY_TRACE") };
+      Tracing::WriteChromeTrace(traceFile);
+   }
+
    return 0;
 }
 
@@ -0,0 +1,115 @@
+/**********************************************************************
+
+Audacity: A Digital Audio Editor
+
+@file AudioEngineStatistics.cpp
+
+**********************************************************************/
+
+#include "AudioEngineStatistics.h"
+
+#include "AudioIO.h"
+#include "PluginManager.h"
+#include "RealtimeEffectList.h"
+#include "RealtimeEffectState.h"
+#include "WaveTrack.h"
+
+namespace AudioEngineStatistics {
+
+namespace {
+const wxString Microseconds = wxT("us");
+const wxString Percents = wxT("%");
+
+void GatherEffects(
+   std::vector<Entry> &entries, const RealtimeEffectList &list,
+   const wxString &owner)
+{
+   list.Visit([&](const RealtimeEffectState &state, bool){
+      const auto snapshot = state.GetProcessingTimes().GetSnapshot();
+      if (snapshot.count == 0)
+         return;
+      const auto name =
+         PluginManager::GetEffectNameFromID(state.GetID()).GET();
+      entries.push_back({ name, owner, Microseconds,
+         /* i18n-hint: %s is the name of an effect */
+         XO("Realtime effect %s").Format(name), snapshot });
+   });
+}
+}
+
+std::vector<Entry> Gather(const AudacityProject &project)
+{
+   std::vector<Entry> entries;
+   if (auto pAudioIO = AudioIO::Get()) {
+      const auto &statistics = pAudioIO->GetStatistics();
+      entries = {
+         { wxT("callbackDuration"), {}, Microseconds,
+            XO("Audio callback duration"),
+            statistics.callbackDuration.GetSnapshot() },
+         { wxT("callbackLoad"), {}, Percents,
+            XO("Audio callback duration, relative to its deadline"),
+            statistics.callbackLoad.GetSnapshot() },
+         { wxT("playbackFill"), {}, Percents,
+            XO("Playback buffer occupancy"),
+            statistics.playbackFill.GetSnapshot() },
+         { wxT("captureFill"), {}, Percents,
+            XO("Capture buffer occupancy"),
+            statistics.captureFill.GetSnapshot() },
+         { wxT("playbackResampling"), {}, Microseconds,
+            XO("Playback mixing and resampling"),
+            statistics.playbackResampling.GetSnapshot() },
+         { wxT("captureResampling"), {}, Microseconds,
+            XO("Capture resampling"),
+            statistics.captureResampling.GetSnapshot() },
+         { wxT("realtimeChain"), {}, Microseconds,
+            /* i18n-hint: %d is a number of threads */
+            XO("Realtime effect chain of one track, in up to %d threads")
+               .Format(static_cast<int>(statistics.realtimeThreads.load(
+                  std::memory_order_relaxed))),
+            statistics.realtimeChain.GetSnapshot() },
+      };
+   }
+
+   GatherEffects(entries, RealtimeEffectList::Get(project), {});
+   for (auto pTrack : TrackList::Get(project).Any<const WaveTrack>())
+      GatherEffects(entries,
+         RealtimeEffectList::Get(*pTrack), pTrack->GetName());
+   return entries;
+}
+
+wxString Format(const std::vector<Entry> &entries)
+{
+   wxString result;
+   for (const auto &entry : entries) {
+      const auto &snapshot = entry.snapshot;
+      result += entry.description.Translation();
+      if (!entry.owner.empty())
+         result += wxString::Format(wxT(" (%s)"), entry.owner);
+      result += wxT("\n");
+
+      result += wxString::Format(
+         wxT("  count %llu, mean %.1f, 50%% %llu, 90%% %llu, 99%% %llu, ")
+         wxT("max %llu %s\n"),
+         static_cast<unsigned long long>(snapshot.count),
+         snapshot.Mean(),
+         static_cast<unsigned long long>(snapshot.Percentile(0.5)),
+         static_cast<unsigned long long>(snapshot.Percentile(0.9)),
+         static_cast<unsigned long long>(snapshot.Percentile(0.99)),
+         static_cast<unsigned long long>(snapshot.max),
+         entry.unit);
+
+      for (size_t ii = 0; ii < AtomicHistogram::BinsCount; ++ii) {
+         if (snapshot.counts[ii] == 0)
+            continue;
+         result += wxString::Format(wxT("  [%llu, %llu) %s: %llu\n"),
+            static_cast<unsigned long long>(snapshot.BinLower(ii)),
+            static_cast<unsigned long long>(snapshot.BinUpper(ii)),
+            entry.unit,
+            static_cast<unsigned long long>(snapshot.counts[ii]));
+      }
+      result += wxT("\n");
+   }
+   return result;
+}
+
+}
@@ -0,0 +1,45 @@
+/**********************************************************************
+
+Audacity: A Digital Audio Editor
+
+@file AudioEngineStatistics.h
+@brief Collects the instrumentation of the audio engine and of realtime
+effects, for display and for scripting
+
+**********************************************************************/
+
+#ifndef __AUDACITY_AUDIO_ENGINE_STATISTICS__
+#define __AUDACITY_AUDIO_ENGINE_STATISTICS__
+
+#include "AtomicHistogram.h"
+#include "Internat.h"
+
+#include <vector>
+
+class AudacityProject;
+
+namespace AudioEngineStatistics {
+
+//! One distribution, with what it measures
+struct Entry {
+   //! Stable, for scripts, such as "callbackDuration" or an effect's name
+   wxString name;
+   //! Name of the track with the effect; empty for the engine and for
+   //! effects on the master list
+   wxString owner;
+   //! "us" for microseconds or "%" for percents
+   wxString unit;
+   TranslatableString description;
+   AtomicHistogram::Snapshot snapshot;
+};
+
+//! Snapshots of the engine's histograms, then of each realtime effect of the
+//! project; may be called during playback
+AUDACITY_DLL_API std::vector<Entry> Gather(const AudacityProject &project);
+
+//! A table of summaries and bins, for the diagnostics dialog
+AUDACITY_DLL_API wxString Format(const std::vector<Entry> &entries);
+
+}
+
+#endif
@@ -34,16 +34,26 @@
 #include <wx/imaglist.h>
 #include <wx/settings.h>
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <future>
+
+#include "BasicUI.h"
 #include "Clipboard.h"
+#include "DBConnection.h"
 #include "ShuttleGui.h"
 #include "MenuCreator.h"
 #include "Prefs.h"
 #include "Project.h"
+#include "ProjectFileIO.h"
 #include "ProjectFileManager.h"
 #include "ProjectHistory.h"
 #include "ProjectManager.h"
 #include "ProjectWindows.h"
 #include "SelectUtilities.h"
+#include "Tags.h"
 #include "Track.h"
 #include "CommandManager.h"
 #include "Effect.h"
@@ -53,6 +63,8 @@
 #include "../images/Empty9x16.xpm"
 #include "UndoManager.h"
 #include "Viewport.h"
+#include "WaveTrack.h"
+#include "concurrency/ThreadPool.h"
 
 #include "AllThemeResources.h"
 
@@ -326,6 +338,130 @@ void ApplyMacroDialog::ApplyMacroToProject( int iMacro, bool bHasGui )
    Raise();
 }
 
+namespace {
+//! Decodes the files after the one that a macro is applied to, each into its
+//! own invisible project, so that decoding overlaps the commands of the macro
+/*!
+ The commands still run one file at a time in the open project, on the main
+ thread, because they dispatch through its menus and may show dialogs.
+ Decoding only a few files ahead bounds the space that waiting files use.
+ */
+class FileDecoder final
+{
+public:
+   FileDecoder(AudacityProject &project, const wxArrayString &files)
+      : mProject{ project }
+      , mFiles{ files }
+      , mFilesAhead{ std::clamp<size_t>(
+         audacity::concurrency::ThreadPool::GetDefault().GetThreadsCount(),
+         1, 4) }
+   {
+   }
+
+   ~FileDecoder()
+   {
+      // Abandon decodings and wait for them to end, before their projects
+      // are destroyed
+      mCancel = true;
+      for (auto &pDecoding : mDecodings)
+         if (pDecoding && pDecoding->future.valid())
+            pDecoding->future.wait();
+   }
+
+   //! Import file `iFile` into the project, then start decoding more files
+   /*! Call with increasing `iFile`. Files that could not be decoded ahead are
+    imported as by ProjectFileManager::Import(), which reports errors */
+   bool Import(size_t iFile)
+   {
+      DecodeAhead(iFile);
+      std::unique_ptr<Decoding> pDecoding;
+      if (!mDecodings.empty()) {
+         pDecoding = std::move(mDecodings.front());
+         mDecodings.pop_front();
+      }
+      DecodeAhead(iFile + 1);
+
+      if (pDecoding) {
+         // Let windows repaint while waiting
+         while (pDecoding->future.wait_for(std::chrono::milliseconds{ 50 })
+            != std::future_status::ready)
+            BasicUI::Yield();
+         pDecoding->future.get();
+      }
+      if (!pDecoding || !pDecoding->job.imported)
+         return ProjectFileManager::Get(mProject).Import(mFiles[iFile]);
+
+      auto &job = pDecoding->job;
+      auto newTags = Tags::Get(mProject).Duplicate();
+      newTags->Merge(*job.tags);
+      Tags::Set(mProject, newTags);
+
+      // Copy the samples into the database of the project
+      TrackHolders tracks;
+      {
+         BulkWriteScope bulkWrite{ mProject };
+         const auto &pFactory =
+            WaveTrackFactory::Get(mProject).GetSampleBlockFactory();
+         for (const auto &pTrack : job.tracks) {
+            if (const auto pWaveTrack =
+               dynamic_cast<const WaveTrack*>(pTrack.get())) {
+               const auto pCopy = pWaveTrack->EmptyCopy(pFactory);
+               pCopy->Paste(0.0, *pWaveTrack);
+               tracks.push_back(pCopy);
+            }
+            else
+               tracks.push_back(pTrack->Duplicate());
+         }
+      }
+      pDecoding.reset();
+      ProjectFileManager::Get(mProject)
+         .AddImportedTracks(mFiles[iFile], std::move(tracks));
+      return true;
+   }
+
+private:
+   struct Decoding {
+      //! Destroyed last, after the tracks that use its database
+      InvisibleTemporaryProject temp;
+      Importer::ImportJob job;
+      std::future<ImportProgressListener::ImportResult> future;
+   };
+
+   //! Start decoding the files up to `mFilesAhead` after `iFile`
+   void DecodeAhead(size_t iFile)
+   {
+      const auto end = std::min(mFiles.size(), iFile + mFilesAhead + 1);
+      for (mNext = std::max(mNext, iFile); mNext < end; ++mNext) {
+         auto pDecoding = std::make_unique<Decoding>();
+         auto &project = pDecoding->temp.Project();
+         // Open the database here, and not first on the worker
+         if (!ProjectFileManager::Get(project).OpenProject()) {
+            mDecodings.push_back(nullptr);
+            continue;
+         }
+         auto &job = pDecoding->job;
+         job.fileName = mFiles[mNext];
+         job.tags = std::make_shared<Tags>();
+         job.tags->Clear();
+         pDecoding->future = Importer::Get().ImportAsync(
+            project, job, &WaveTrackFactory::Get(project), mCancel);
+         if (!pDecoding->future.valid())
+            pDecoding.reset();
+         mDecodings.push_back(std::move(pDecoding));
+      }
+   }
+
+   AudacityProject &mProject;
+   const wxArrayString &mFiles;
+   const size_t mFilesAhead;
+   //! Null where a file is imported only when its turn comes
+   std::deque<std::unique_ptr<Decoding>> mDecodings;
+   //! Index of the file after the last in mDecodings
+   size_t mNext{ 0 };
+   std::atomic<bool> mCancel{ false };
+};
+}
+
 void ApplyMacroDialog::OnApplyToFiles(wxCommandEvent & WXUNUSED(event))
 {
    long item = mMacros->GetNextItem(-1,
@@ -454,6 +590,7 @@ void ApplyMacroDialog::OnApplyToFiles(wxCommandEvent & WXUNUSED(event))
       Clipboard::Scope scope;
 
       wxWindowDisabler wd(&activityWin);
+      FileDecoder decoder{ *project, files };
       for (i = 0; i < (int)files.size(); i++) {
          if (i > 0) {
             //Clear the arrow in previous item.
@@ -461,9 +598,14 @@ void ApplyMacroDialog::OnApplyToFiles(wxCommandEvent & WXUNUSED(event))
          }
          fileList->SetItemImage(i, 1, 1);
          fileList->EnsureVisible(i);
+         activityWin.SetTitle(
+            /* i18n-hint: The title of the window of a macro applied to
+               files, then the number of the file, and how many there are */
+            XO("%s - File %d of %d")
+               .Format(GetTitle(), i + 1, (int)files.size()).Translation());
 
          auto success = GuardedCall<bool>([&] {
-            ProjectFileManager::Get(*project).Import(files[i]);
+            decoder.Import(i);
             Viewport::Get(*project).ZoomFitHorizontallyAndShowTrack(nullptr);
             SelectUtilities::DoSelectAll(*project);
             if (!mMacroCommands.ApplyMacro(mCatalog))
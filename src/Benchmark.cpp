@@ -323,8 +323,9 @@ void BenchmarkDialog::OnRun( wxCommandEvent & WXUNUSED(event))
    if (!Validate())
       return;
 
-   // This code will become part of libaudacity,
-   // and this class will be phased out.
+   // The same edits and reads run without this dialog, with other
+   // measurements, in the lib-wave-track-benchmark test; and this class will
+   // be phased out.
    long blockSize, numEdits, dataSize, randSeed;
 
    mBlockSizeStr.ToLong(&blockSize);
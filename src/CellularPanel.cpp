@@ -30,6 +30,7 @@
 
 #include "CellularPanel.h"
 
+#include <optional>
 #include <wx/eventfilter.h>
 #include <wx/setup.h> // for wxUSE_* macros
 #include "KeyboardCapture.h"
@@ -104,6 +105,35 @@ struct CellularPanel::State
    std::weak_ptr<TrackPanelCell> mLastCell;
    std::vector<UIHandlePtr> mTargets;
    size_t mTarget {};
+
+   //! What the hit test of mLastCell depended on, besides the model
+   struct HitTestKey {
+      wxRect rect;
+      wxPoint position;
+      int modifiers{};
+      unsigned buttons{};
+
+      explicit HitTestKey(const TrackPanelMouseState &tpmState)
+         : rect{ tpmState.rect }
+         , position{ tpmState.state.GetPosition() }
+         , modifiers{ tpmState.state.GetModifiers() }
+         , buttons{ (tpmState.state.LeftIsDown() ? 1u : 0u) |
+            (tpmState.state.MiddleIsDown() ? 2u : 0u) |
+            (tpmState.state.RightIsDown() ? 4u : 0u) |
+            (tpmState.state.Aux1IsDown() ? 8u : 0u) |
+            (tpmState.state.Aux2IsDown() ? 16u : 0u) }
+      {}
+
+      bool operator == (const HitTestKey &other) const
+      {
+         return rect == other.rect && position == other.position &&
+            modifiers == other.modifiers && buttons == other.buttons;
+      }
+   };
+   //! Set when mTargets may be reused for motion that does not really move;
+   //! reset when the panel draws, or the present mouse state is requested
+   //! anew, because the model or the view may have changed
+   std::optional<HitTestKey> mHitTestKey;
    unsigned mMouseOverUpdateFlags{};
 
    int mMouseMostRecentX;
@@ -258,6 +288,9 @@ void CellularPanel::HandleCursorForPresentMouseState(bool doHit)
    // or change of toolbar button,
    // and change the cursor appropriately.
 
+   // Something besides the mouse may have changed what it hits
+   mState->mHitTestKey.reset();
+
    // Get the button and key states
    auto state = ::wxGetMouseState();
    // Remap the position
@@ -327,20 +360,26 @@ void CellularPanel::HandleMotion
 
       // Now do the
       // UIHANDLE HIT TEST !
-      state.mTargets.clear();
-      if (newCell)
-         state.mTargets = newCell->HitTest(tpmState, GetProject());
-      state.mTarget = 0;
-
-      // Find the old target's NEW place if we can
-      if (oldHandle) {
-         auto begin = state.mTargets.begin(), end = state.mTargets.end(),
-            iter = std::find(begin, end, oldHandle);
-         if (iter != end) {
-            size_t newPosition = iter - begin;
-            if (newPosition <= oldPosition)
-               state.mTarget = newPosition;
-            // else, some NEW hit at this position takes priority
+      // Unless it would give the same targets again, as for repeated events
+      // without real motion, which need not make new handles
+      const State::HitTestKey key{ tpmState };
+      if (!(newCell && state.mHitTestKey && *state.mHitTestKey == key)) {
+         state.mTargets.clear();
+         if (newCell)
+            state.mTargets = newCell->HitTest(tpmState, GetProject());
+         state.mTarget = 0;
+         state.mHitTestKey.emplace(key);
+
+         // Find the old target's NEW place if we can
+         if (oldHandle) {
+            auto begin = state.mTargets.begin(), end = state.mTargets.end(),
+               iter = std::find(begin, end, oldHandle);
+            if (iter != end) {
+               size_t newPosition = iter - begin;
+               if (newPosition <= oldPosition)
+                  state.mTarget = newPosition;
+               // else, some NEW hit at this position takes priority
+            }
          }
       }
 
@@ -1225,6 +1264,7 @@ void CellularPanel::ClearTargets()
    state.mTargets.clear();
    state.mTarget = 0;
    state.mMouseOverUpdateFlags = 0;
+   state.mHitTestKey.reset();
 }
 
 std::shared_ptr<TrackPanelCell> CellularPanel::LastCell() const
@@ -1233,9 +1273,14 @@ std::shared_ptr<TrackPanelCell> CellularPanel::LastCell() const
    return state.mLastCell.lock();
 }
 
-void CellularPanel::Draw( TrackPanelDrawingContext &context, unsigned nPasses )
+void CellularPanel::Draw( TrackPanelDrawingContext &context, unsigned nPasses,
+   const wxRect *pClip )
 {
+   // What is drawn anew may hit differently
+   mState->mHitTestKey.reset();
+
    const auto panelRect = GetClientRect();
+   const auto clipRect = pClip ? pClip->Intersect( panelRect ) : panelRect;
    auto lastCell = LastCell();
    for ( unsigned iPass = 0; iPass < nPasses; ++iPass ) {
 
@@ -1244,7 +1289,7 @@ void CellularPanel::Draw( TrackPanelDrawingContext &context, unsigned nPasses )
          // Draw the node
          const auto newRect = node.DrawingArea(
             context, rect, panelRect, iPass );
-         if ( newRect.Intersects( panelRect ) )
+         if ( newRect.Intersects( clipRect ) )
             node.Draw( context, newRect, iPass );
 
          // Draw the current handle if it is associated with the node
@@ -1253,7 +1298,7 @@ void CellularPanel::Draw( TrackPanelDrawingContext &context, unsigned nPasses )
             if ( target ) {
                const auto targetRect =
                   target->DrawingArea( context, rect, panelRect, iPass );
-               if ( targetRect.Intersects( panelRect ) )
+               if ( targetRect.Intersects( clipRect ) )
                   target->Draw( context, targetRect, iPass );
             }
          }
@@ -114,7 +114,9 @@ public:
    // and of handles associated with such cells,
    // and of all groups of cells,
    // repeatedly with a pass count from 0 to nPasses - 1
-   void Draw( TrackPanelDrawingContext &context, unsigned nPasses );
+   // If pClip is not null, skip those not intersecting it
+   void Draw( TrackPanelDrawingContext &context, unsigned nPasses,
+      const wxRect *pClip = nullptr );
    
 protected:
    bool HasEscape();
@@ -11,6 +11,7 @@
 #include "ClipMirAudioReader.h"
 #include "ClipInterface.h"
 #include "WaveClip.h"
+#include "WaveClipAnalysisCache.h"
 
 #include <cassert>
 
@@ -22,6 +23,8 @@ ClipMirAudioReader::ClipMirAudioReader(
     , clip(*singleClipWaveTrack.Intervals().begin())
     , mClip(singleClipWaveTrack.GetClipInterfaces()[0])
 {
+   // Attach now, in the main thread, for analyses that may be done in others
+   WaveClipAnalysisCache::Get(*clip);
 }
 
 double ClipMirAudioReader::GetSampleRate() const
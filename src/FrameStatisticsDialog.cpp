@@ -37,6 +37,8 @@ public:
          {
             S.AddFixedText(Verbatim("Track Panel Rendering"));
             AddSection(S, FrameStatistics::SectionID::TrackPanel);
+            S.AddFixedText(Verbatim("Track Panel Partial Rendering"));
+            AddSection(S, FrameStatistics::SectionID::TrackPanelPartial);
             S.AddFixedText(Verbatim("Waveform Rendering (per clip)"));
             AddSection(S, FrameStatistics::SectionID::WaveformView);
             S.AddFixedText(Verbatim("WaveDataCache Lookups"));
@@ -88,6 +90,12 @@ private:
          S.AddFixedText(Verbatim("Avg:"));
          mSections[size_t(sectionID)].Avg = S.AddVariableText({});
 
+         S.AddFixedText(Verbatim("P90:"));
+         mSections[size_t(sectionID)].P90 = S.AddVariableText({});
+
+         S.AddFixedText(Verbatim("P99:"));
+         mSections[size_t(sectionID)].P99 = S.AddVariableText({});
+
          S.AddFixedText(Verbatim("Events:"));
          mSections[size_t(sectionID)].Events = S.AddVariableText({});
       }
@@ -116,6 +124,8 @@ private:
          section.Min->SetLabel(FormatTime(profilerSection.GetMinDuration()));
          section.Max->SetLabel(FormatTime(profilerSection.GetMaxDuration()));
          section.Avg->SetLabel(FormatTime(profilerSection.GetAverageDuration()));
+         section.P90->SetLabel(FormatTime(profilerSection.GetPercentile(90)));
+         section.P99->SetLabel(FormatTime(profilerSection.GetPercentile(99)));
       }
       else
       {
@@ -123,6 +133,8 @@ private:
          section.Min->SetLabel(L"n/a");
          section.Max->SetLabel(L"n/a");
          section.Avg->SetLabel(L"n/a");
+         section.P90->SetLabel(L"n/a");
+         section.P99->SetLabel(L"n/a");
       }
 
       section.Events->SetLabel(std::to_string(profilerSection.GetEventsCount()));
@@ -136,6 +148,8 @@ private:
       wxStaticText* Min;
       wxStaticText* Max;
       wxStaticText* Avg;
+      wxStaticText* P90;
+      wxStaticText* P99;
       wxStaticText* Events;
 
       bool Dirty { true };
@@ -32,6 +32,7 @@ undo memory so as to free up space.
 #include "AudioIO.h"
 #include "Clipboard.h"
 #include "CommonCommandFlags.h"
+#include "CompactUndoTracks.h"
 #include "Diags.h"
 #include "../images/Arrow.xpm"
 #include "../images/Empty9x16.xpm"
@@ -46,7 +47,11 @@ undo memory so as to free up space.
 #include "HelpSystem.h"
 
 #include <unordered_set>
+#include "Envelope.h"
+#include "LabelTrack.h"
 #include "SampleBlock.h"
+#include "Sequence.h"
+#include "WaveClip.h"
 #include "WaveTrack.h"
 #include "WaveTrackUtilities.h"
 
@@ -68,7 +73,45 @@ struct SpaceUsageCalculator {
       return result;
    }
 
+   //! Approximate bytes of the track structures that a state holds in
+   //! memory, not counting sample blocks, which are in the project file
+   static Type CalculateMemory(const WaveClip &clip)
+   {
+      Type result = sizeof(WaveClip) + sizeof(Envelope) +
+         clip.GetEnvelope().GetNumberOfPoints() * sizeof(EnvPoint);
+      for (size_t ii = 0; ii < clip.NChannels(); ++ii)
+         result += sizeof(Sequence) +
+            clip.GetSequence(ii)->GetBlockArray().size() * sizeof(SeqBlock);
+      for (const auto &pCutLine : clip.GetCutLines())
+         result += CalculateMemory(*pCutLine);
+      return result;
+   }
+
+   static Type CalculateMemory(const TrackList &tracks)
+   {
+      Type result = 0;
+      for (auto pTrack : tracks)
+         result += pTrack->TypeSwitch<Type>(
+            [](const WaveTrack &track) {
+               Type result = sizeof(WaveTrack);
+               for (const auto &pClip : track.Intervals())
+                  result += CalculateMemory(*pClip);
+               return result;
+            },
+            [](const LabelTrack &track) {
+               Type result = sizeof(LabelTrack);
+               for (const auto &label : track.GetLabels())
+                  result += sizeof(LabelStruct) +
+                     label.title.length() * sizeof(wxStringCharType);
+               return result;
+            },
+            [](const Track &) -> Type { return sizeof(Track); }
+         );
+      return result;
+   }
+
    SpaceArray space;
+   SpaceArray memory;
    Type clipboardSpaceUsage;
 
    void Calculate( UndoManager &manager )
@@ -92,9 +135,17 @@ struct SpaceUsageCalculator {
 
       manager.VisitStates(
          [this, &seen](const UndoStackElem &elem) {
-            // Scan all tracks at current level
-            if (auto pTracks = UndoTracks::Find(elem))
-               space.push_back(CalculateUsage(*pTracks, seen));
+            // Scan all tracks at current level, compact or not
+            Type usage = 0;
+            CompactUndoTracks::InspectBlocks(
+               elem, BlockSpaceUsageAccumulator( usage ), &seen);
+            space.push_back(usage);
+            // Each state has its own copies of the structures, or their
+            // encoding
+            const auto pTracks = UndoTracks::Find(elem);
+            memory.push_back(pTracks
+               ? CalculateMemory(*pTracks)
+               : CompactUndoTracks::GetMemory(elem));
          },
          true // newest state first
       );
@@ -176,7 +227,8 @@ void HistoryDialog::Populate(ShuttleGui & S)
             .ConnectRoot(wxEVT_KEY_DOWN, &HistoryDialog::OnListKeyDown)
             .AddListControlReportMode(
                { { XO("Action"), wxLIST_FORMAT_LEFT, 260 },
-                 { XO("Used Space"), wxLIST_FORMAT_LEFT, 125 } },
+                 { XO("Used Space"), wxLIST_FORMAT_LEFT, 125 },
+                 { XO("Memory"), wxLIST_FORMAT_LEFT, 100 } },
                wxLC_SINGLE_SEL
             );
 
@@ -190,6 +242,10 @@ void HistoryDialog::Populate(ShuttleGui & S)
             mTotal = S.Id(ID_TOTAL).Style(wxTE_READONLY).AddTextBox({}, wxT(""), 10);
             S.AddVariableText( {} )->Hide();
 
+            S.AddPrompt(XXO("Memor&y used"));
+            mMemory = S.Style(wxTE_READONLY).AddTextBox({}, wxT(""), 10);
+            S.AddVariableText( {} )->Hide();
+
 #if defined(ALLOW_DISCARD)
             S.AddPrompt(XXO("&Undo levels available"));
             mAvail = S.Id(ID_AVAIL).Style(wxTE_READONLY).AddTextBox({}, wxT(""), 10);
@@ -232,7 +288,8 @@ void HistoryDialog::Populate(ShuttleGui & S)
    Layout();
    Fit();
    SetMinSize(GetSize());
-   mList->SetColumnWidth(0, mList->GetClientSize().x - mList->GetColumnWidth(1));
+   mList->SetColumnWidth(0, mList->GetClientSize().x -
+      mList->GetColumnWidth(1) - mList->GetColumnWidth(2));
    mList->SetTextColour(wxSystemSettings::GetColour(wxSYS_COLOUR_WINDOWTEXT));
 }
 
@@ -290,25 +347,31 @@ void HistoryDialog::DoUpdate()
 
    // point to size for oldest state
    auto iter = calculator.space.rbegin();
+   auto memoryIter = calculator.memory.rbegin();
 
    mList->DeleteAllItems();
 
    wxLongLong_t total = 0;
+   wxLongLong_t totalMemory = 0;
    mSelected = mManager->GetCurrentState();
    mManager->VisitStates(
       [&]( const UndoStackElem &elem ){
          const auto space = *iter++;
          total += space;
          const auto size = Internat::FormatSize(space);
+         const auto memory = *memoryIter++;
+         totalMemory += memory;
          const auto &desc = elem.description;
          mList->InsertItem(i, desc.Translation(), i == mSelected ? 1 : 0);
          mList->SetItem(i, 1, size.Translation());
+         mList->SetItem(i, 2, Internat::FormatSize(memory).Translation());
          ++i;
       },
       false // oldest state first
    );
 
    mTotal->SetValue(Internat::FormatSize(total).Translation());
+   mMemory->SetValue(Internat::FormatSize(totalMemory).Translation());
 
    auto clipboardUsage = calculator.clipboardSpaceUsage;
    mClipboard->SetValue(Internat::FormatSize(clipboardUsage).Translation());
@@ -462,7 +525,8 @@ void HistoryDialog::OnShow(wxShowEvent & event)
 void HistoryDialog::OnSize(wxSizeEvent & WXUNUSED(event))
 {
    Layout();
-   mList->SetColumnWidth(0, mList->GetClientSize().x - mList->GetColumnWidth(1));
+   mList->SetColumnWidth(0, mList->GetClientSize().x -
+      mList->GetColumnWidth(1) - mList->GetColumnWidth(2));
    if (mList->GetItemCount() > 0)
       mList->EnsureVisible(mSelected);
 }
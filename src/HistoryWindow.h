@@ -67,6 +67,7 @@ class HistoryDialog final : public wxDialogWrapper,
    UndoManager       *mManager;
    wxListCtrl        *mList;
    wxTextCtrl        *mTotal;
+   wxTextCtrl        *mMemory;
    wxTextCtrl        *mClipboard;
    wxTextCtrl        *mAvail;
    wxSpinCtrl        *mLevels;
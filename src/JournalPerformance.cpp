@@ -0,0 +1,209 @@
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file JournalPerformance.cpp
+  @brief Journal commands that time the replay and compare it with a
+  baseline, so that tests catch slower interactions
+
+*//*******************************************************************/
+
+#include "Journal.h"
+#include "JournalRegistry.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <map>
+#include <vector>
+
+#include <wx/filename.h>
+#include <wx/textfile.h>
+
+#include "AudioIO.h"
+#include "FileNames.h"
+#include "FrameStatistics.h"
+#include "wxArrayStringEx.h"
+
+/*
+ A journal measures the lines between these two:
+
+ PerfStart
+ PerfCheck,<baseline file>[,<tolerance percent>]
+
+ PerfCheck writes the measurements to journalperf.txt in the data
+ directory, one per line, as a value and a name.  That file can be copied
+ to be the baseline, whose path is relative to the journal.  The check
+ fails if any value exceeds its baseline by more than the tolerance, and
+ passes if there is no baseline yet.
+
+ Values are milliseconds, except for audio loads, in percent.  Audio
+ values are of the most recent stream only, because each stream resets
+ them.
+ */
+
+namespace Journal {
+
+namespace {
+
+constexpr auto StartCode = wxT("PerfStart");
+constexpr auto CheckCode = wxT("PerfCheck");
+constexpr double DefaultTolerance = 25;
+
+using Metrics = std::map<wxString, double>;
+
+//! Milliseconds of each replayed command, by its kind
+std::map<wxString, std::vector<double>> sDurations;
+
+wxString EventName(const wxArrayStringEx &fields)
+{
+   // Menu commands by their names, other events by their windows
+   return fields.size() > 1 ? fields[0] + ':' + fields[1] : fields[0];
+}
+
+//! Nearest rank percentile
+double Percentile(std::vector<double> values, double percent)
+{
+   if (values.empty())
+      return 0;
+   std::sort(values.begin(), values.end());
+   const auto rank = size_t(std::ceil(percent / 100 * values.size()));
+   return values[std::max<size_t>(rank, 1) - 1];
+}
+
+double ToMilliseconds(FrameStatistics::Duration duration)
+{
+   return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+Metrics Measure()
+{
+   Metrics metrics;
+   for (const auto &[name, durations] : sDurations) {
+      metrics[name + wxT(".p50")] = Percentile(durations, 50);
+      metrics[name + wxT(".max")] = Percentile(durations, 100);
+   }
+
+   for (size_t i = 0; i < size_t(FrameStatistics::SectionID::Count); ++i) {
+      const auto id = FrameStatistics::SectionID(i);
+      const auto &section = FrameStatistics::GetSection(id);
+      if (section.GetEventsCount() == 0)
+         continue;
+      const auto name =
+         wxT("Frame.") + wxString{ FrameStatistics::GetSectionName(id) };
+      metrics[name + wxT(".p50")] = ToMilliseconds(section.GetPercentile(50));
+      metrics[name + wxT(".p90")] = ToMilliseconds(section.GetPercentile(90));
+   }
+
+   if (const auto pAudioIO = AudioIO::Get()) {
+      const auto &statistics = pAudioIO->GetStatistics();
+      const auto duration = statistics.callbackDuration.GetSnapshot();
+      if (duration.count > 0) {
+         // Microseconds to milliseconds
+         metrics[wxT("Audio.callbackDuration.p99")] =
+            duration.Percentile(0.99) / 1000.0;
+         metrics[wxT("Audio.callbackLoad.p99")] =
+            statistics.callbackLoad.GetSnapshot().Percentile(0.99);
+      }
+      const auto resampling = statistics.playbackResampling.GetSnapshot();
+      if (resampling.count > 0)
+         metrics[wxT("Audio.playbackResampling.p99")] =
+            resampling.Percentile(0.99) / 1000.0;
+      const auto chain = statistics.realtimeChain.GetSnapshot();
+      if (chain.count > 0) {
+         metrics[wxT("Audio.realtimeChain.p99")] =
+            chain.Percentile(0.99) / 1000.0;
+         metrics[wxT("Audio.realtimeThreads")] =
+            statistics.realtimeThreads.load(std::memory_order_relaxed);
+      }
+   }
+   return metrics;
+}
+
+bool Write(const Metrics &metrics, const wxString &path)
+{
+   wxTextFile file{ path };
+   if (!(file.Exists() ? file.Open() : file.Create()))
+      return false;
+   file.Clear();
+   for (const auto &[name, value] : metrics)
+      file.AddLine(wxString::Format(wxT("%.3f "), value) + name);
+   return file.Write();
+}
+
+bool Read(const wxString &path, Metrics &metrics)
+{
+   wxTextFile file{ path };
+   if (!file.Exists() || !file.Open())
+      return false;
+   for (size_t ii = 0; ii < file.GetLineCount(); ++ii) {
+      const auto &line = file[ii];
+      double value;
+      const auto space = line.Find(' ');
+      if (space != wxNOT_FOUND && line.Left(space).ToCDouble(&value))
+         metrics[line.Mid(space + 1)] = value;
+   }
+   return true;
+}
+
+RegisteredCommand sStartCommand{ StartCode,
+[]( const wxArrayStringEx &fields )
+{
+   if (fields.size() != 1)
+      return false;
+   sDurations.clear();
+   FrameStatistics::Reset();
+   SetDispatchMonitor(
+   []( const wxArrayStringEx &words,
+      std::chrono::steady_clock::duration duration )
+   {
+      if (words[0] == StartCode || words[0] == CheckCode)
+         return;
+      sDurations[EventName(words)].push_back(
+         std::chrono::duration<double, std::milli>(duration).count());
+   });
+   return true;
+}
+};
+
+RegisteredCommand sCheckCommand{ CheckCode,
+[]( const wxArrayStringEx &fields )
+{
+   double tolerance = DefaultTolerance;
+   if (fields.size() < 2 || fields.size() > 3 ||
+       (fields.size() == 3 && !fields[2].ToCDouble(&tolerance)))
+      return false;
+
+   const auto measured = Measure();
+   if (!Write(measured,
+      wxFileName{ FileNames::DataDir(), wxT("journalperf"), wxT("txt") }
+         .GetFullPath()))
+      return false;
+
+   wxFileName baselineName{ fields[1] };
+   baselineName.MakeAbsolute(wxFileName{ GetInputFileName() }.GetPath());
+   Metrics baseline;
+   if (!Read(baselineName.GetFullPath(), baseline))
+      return true;
+
+   wxString regressions;
+   for (const auto &[name, value] : baseline) {
+      const auto iter = measured.find(name);
+      if (iter == measured.end())
+         continue;
+      // Allow a millisecond or a percent of noise in the least values
+      const auto limit =
+         std::max(value * (1 + tolerance / 100), value + 1.0);
+      if (iter->second > limit)
+         regressions += wxString::Format(
+            wxT(" %s %.3f exceeds %.3f;"), name, iter->second, limit);
+   }
+   if (!regressions.empty())
+      throw SyncException(wxT("performance regressed:") + regressions);
+   return true;
+}
+};
+
+}
+
+}
@@ -373,20 +373,12 @@ bool LabelDialog::TransferDataFromWindow()
    int i;
    int tndx = 0;
 
-   // Clear label tracks of labels
+   // Remove the edited label; without a selected track, all labels are
+   // replaced below
    for (auto lt : mTracks->Any<LabelTrack>()) {
       ++tndx;
-      if (!mSelectedTrack) {
-         for (i = lt->GetNumLabels() - 1; i >= 0 ; i--) {
-            lt->DeleteLabel(i);
-         }
-      }
-      else if (mSelectedTrack == lt && mIndex > -1) {
+      if (mSelectedTrack && mSelectedTrack == lt && mIndex > -1)
          lt->DeleteLabel(mIndex);
-      }
-      else
-         // Do nothing to the nonselected tracks
-         ;
    }
 
    // Create any added tracks
@@ -402,25 +394,32 @@ bool LabelDialog::TransferDataFromWindow()
       tndx++;
    }
 
-   // Repopulate with updated labels
+   // Gather the updated labels of each track, so that each is sorted once
+   std::vector<std::pair<LabelTrack *, LabelArray>> trackLabels;
+   for (auto lt : mTracks->Any<LabelTrack>())
+      trackLabels.emplace_back(lt, LabelArray{});
    for (i = 0; i < cnt; i++) {
       RowData &rd = mData[i];
 
-      // Look for track with matching index
-      tndx = 1;
-      LabelTrack *lt{};
-      for (auto t : mTracks->Any<LabelTrack>()) {
-         lt = t;
-         if (rd.index == tndx++) {
-            break;
-         }
-      }
-      wxASSERT(lt);
-      if (!lt)
+      // Look for track with matching index, else the last
+      wxASSERT(!trackLabels.empty());
+      if (trackLabels.empty())
          return false;
+      auto ii = trackLabels.size() - 1;
+      if (rd.index >= 1 && size_t(rd.index) <= trackLabels.size())
+         ii = rd.index - 1;
 
-      // Add the label to it
-      lt->AddLabel(rd.selectedRegion, rd.title);
+      trackLabels[ii].second.push_back({ rd.selectedRegion, rd.title });
+   }
+
+   // Repopulate with updated labels
+   for (auto &[lt, labels] : trackLabels) {
+      if (!mSelectedTrack)
+         lt->SetLabels(move(labels));
+      else if (!labels.empty())
+         lt->AddLabels(move(labels));
+      else
+         continue;
       LabelTrackView::Get( *lt ).ResetTextSelection();
    }
 
@@ -32,6 +32,7 @@ for drawing different aspects of the label and its text box.
 #include "LabelTrack.h"
 
 #include <algorithm>
+#include <iterator>
 #include <limits.h>
 #include <float.h>
 
@@ -722,8 +723,8 @@ void LabelTrack::Import(wxTextFile & in, LabelFormat format)
 
    int lines = in.GetLineCount();
 
-   mLabels.clear();
-   mLabels.reserve(lines);
+   LabelArray labels;
+   labels.reserve(lines);
 
    //Currently, we expect a tag file to have two values and a label
    //on each line. If the second token is not a number, we treat
@@ -733,13 +734,13 @@ void LabelTrack::Import(wxTextFile & in, LabelFormat format)
       try {
          // Let LabelStruct::Import advance index
          LabelStruct l { LabelStruct::Import(in, index, format) };
-         mLabels.push_back(l);
+         labels.push_back(l);
       }
       catch(const LabelStruct::BadFormatException&) { error = true; }
    }
    if (error)
       ::AudacityMessageBox( XO("One or more saved labels could not be read.") );
-   SortLabels();
+   SetLabels(move(labels));
 }
 
 bool LabelTrack::HandleXMLTag(const std::string_view& tag, const AttributesList &attrs)
@@ -1095,13 +1096,12 @@ int LabelTrack::AddLabel(const SelectedRegion &selectedRegion,
 {
    LabelStruct l { selectedRegion, title };
 
-   int len = mLabels.size();
-   int pos = 0;
-
-   while (pos < len && mLabels[pos].getT0() < selectedRegion.t0())
-      pos++;
+   const auto iter = std::partition_point(mLabels.begin(), mLabels.end(),
+      [&](const LabelStruct &label){
+         return label.getT0() < selectedRegion.t0(); });
+   const int pos = iter - mLabels.begin();
 
-   mLabels.insert(mLabels.begin() + pos, l);
+   mLabels.insert(iter, l);
 
    Publish({ LabelTrackEvent::Addition,
       this->SharedPointer<LabelTrack>(), title, -1, pos });
@@ -1120,6 +1120,42 @@ void LabelTrack::DeleteLabel(int index)
       this->SharedPointer<LabelTrack>(), title, index, -1 });
 }
 
+namespace {
+bool StartsBefore(const LabelStruct &a, const LabelStruct &b)
+{
+   return a.getT0() < b.getT0();
+}
+}
+
+void LabelTrack::SetLabels(LabelArray labels)
+{
+   std::stable_sort(labels.begin(), labels.end(), StartsBefore);
+   mLabels.swap(labels);
+   miLastLabel = -1;
+
+   Publish({ LabelTrackEvent::Replacement,
+      this->SharedPointer<LabelTrack>(), {}, -1, -1 });
+}
+
+void LabelTrack::AddLabels(LabelArray labels)
+{
+   std::stable_sort(labels.begin(), labels.end(), StartsBefore);
+   // New labels go before old ones at equal times, as in AddLabel()
+   LabelArray merged;
+   merged.reserve(mLabels.size() + labels.size());
+   std::merge(
+      std::make_move_iterator(labels.begin()),
+      std::make_move_iterator(labels.end()),
+      std::make_move_iterator(mLabels.begin()),
+      std::make_move_iterator(mLabels.end()),
+      std::back_inserter(merged), StartsBefore);
+   mLabels.swap(merged);
+   miLastLabel = -1;
+
+   Publish({ LabelTrackEvent::Replacement,
+      this->SharedPointer<LabelTrack>(), {}, -1, -1 });
+}
+
 /// Sorts the labels in order of their starting times.
 /// This function is called often (whilst dragging a label)
 /// We expect them to be very nearly in order, so insertion
@@ -1161,9 +1197,13 @@ wxString LabelTrack::GetTextOfLabels(double t0, double t1) const
    bool firstLabel = true;
    wxString retVal;
 
-   for (auto &labelStruct: mLabels) {
-      if (labelStruct.getT0() >= t0 &&
-          labelStruct.getT1() <= t1)
+   // Labels are sorted by start, so visit only those starting in the region
+   const auto begin = std::partition_point(mLabels.begin(), mLabels.end(),
+      [&](const LabelStruct &label){ return label.getT0() < t0; });
+   for (auto iter = begin;
+        iter != mLabels.end() && iter->getT0() <= t1; ++iter) {
+      auto &labelStruct = *iter;
+      if (labelStruct.getT1() <= t1)
       {
          if (!firstLabel)
             retVal += '\t';
@@ -1188,12 +1228,11 @@ int LabelTrack::FindNextLabel(const SelectedRegion& currentRegion)
       }
       else {
          i = 0;
-         if (currentRegion.t0() < mLabels[len - 1].getT0()) {
-            while (i < len &&
-                  mLabels[i].getT0() <= currentRegion.t0()) {
-               i++;
-            }
-         }
+         if (currentRegion.t0() < mLabels[len - 1].getT0())
+            i = std::partition_point(mLabels.begin(), mLabels.end(),
+               [&](const LabelStruct &label){
+                  return label.getT0() <= currentRegion.t0(); })
+            - mLabels.begin();
       }
    }
 
@@ -1214,12 +1253,11 @@ int LabelTrack::FindNextLabel(const SelectedRegion& currentRegion)
       }
       else {
          i = len - 1;
-         if (currentRegion.t0() > mLabels[0].getT0()) {
-            while (i >=0  &&
-                  mLabels[i].getT0() >= currentRegion.t0()) {
-               i--;
-            }
-         }
+         if (currentRegion.t0() > mLabels[0].getT0())
+            i = std::partition_point(mLabels.begin(), mLabels.end(),
+               [&](const LabelStruct &label){
+                  return label.getT0() < currentRegion.t0(); })
+            - mLabels.begin() - 1;
       }
    }
 
@@ -162,6 +162,14 @@ public:
    //This deletes the label at given index.
    void DeleteLabel(int index);
 
+   //! Replace all labels, sorting them once by start time
+   /*! Publishes one Replacement event, rather than a deletion or addition
+    for each label, which makes it linear for many labels */
+   void SetLabels(LabelArray labels);
+   //! Add many labels, sorting them once among the others
+   /*! Publishes one Replacement event, as SetLabels() does */
+   void AddLabels(LabelArray labels);
+
    // This pastes labels without shifting existing ones
    bool PasteOver(double t, const Track &src);
 
@@ -232,17 +240,19 @@ struct LabelTrackEvent
       Deletion,
       Permutation,
       Selection,
+      //! All labels may have changed, as after SetLabels()
+      Replacement,
    } type;
 
    const std::weak_ptr<Track> mpTrack;
 
-   // invalid for selection events
+   // invalid for selection and replacement events
    wxString mTitle;
 
-   // invalid for addition and selection events
+   // invalid for addition, selection and replacement events
    int mFormerPosition;
 
-   // invalid for deletion and selection events
+   // invalid for deletion, selection and replacement events
    int mPresentPosition;
 
    LabelTrackEvent( Type type, const std::shared_ptr<LabelTrack> &pTrack,
@@ -0,0 +1,143 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  LoudnessMeter.cpp
+
+*******************************************************************//*!
+
+\class LoudnessMeter
+\brief Momentary, short-term and integrated loudness, and true peak, of
+  playback, for live monitoring
+
+*//*******************************************************************/
+#include "LoudnessMeter.h"
+
+#include "AudioIOBase.h"
+#include "Project.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+constexpr auto None = -std::numeric_limits<float>::infinity();
+
+float ToDecibels(double power)
+{
+   return power > 0 ? 10 * log10(power) : None;
+}
+}
+
+static const AudacityProject::AttachedObjects::RegisteredFactory sKey {
+   [](AudacityProject&) { return std::make_shared<LoudnessMeter>(); }
+};
+
+LoudnessMeter &LoudnessMeter::Get(AudacityProject &project)
+{
+   return project.AttachedObjects::Get<LoudnessMeter>(sKey);
+}
+
+const LoudnessMeter &LoudnessMeter::Get(const AudacityProject &project)
+{
+   return Get(const_cast<AudacityProject&>(project));
+}
+
+LoudnessMeter::LoudnessMeter()
+   : mMomentary{ None }, mShortTerm{ None }, mIntegrated{ None }
+   , mTruePeak{ None }
+{
+}
+
+LoudnessMeter::~LoudnessMeter() = default;
+
+void LoudnessMeter::Reset(double rate)
+{
+   // Process() may be running during a stream, as when a meter toolbar is
+   // rebuilt; then keep the filters, for the rate of that stream
+   if (!AudioIOBase::Get()->IsStreamActive() &&
+       (!mLoudness || rate != mRate)) {
+      mRate = rate;
+      mLoudness.emplace(rate, MaxChannels);
+      mLoudness->Reserve(ChunkSize);
+   }
+   RequestReset();
+}
+
+void LoudnessMeter::RequestReset()
+{
+   mResetPending.store(true);
+   mMomentary.store(None);
+   mShortTerm.store(None);
+   mIntegrated.store(None);
+   mTruePeak.store(None);
+}
+
+void LoudnessMeter::DoReset()
+{
+   if (mLoudness)
+      mLoudness->Reset();
+   for (auto &truePeak : mTruePeaks)
+      truePeak.Reset();
+   mBlockCount = 0;
+   mMomentary.store(None);
+   mShortTerm.store(None);
+   mIntegrated.store(None);
+   mTruePeak.store(None);
+}
+
+void LoudnessMeter::Process(
+   unsigned numChannels, size_t numFrames, const float *samples)
+{
+   if (!mLoudness || numChannels == 0)
+      return;
+   if (mResetPending.exchange(false))
+      DoReset();
+
+   // The weighting filters want each channel apart
+   const float *channels[MaxChannels];
+   for (size_t channel = 0; channel < MaxChannels; ++channel)
+      channels[channel] = mBuffers[channel];
+   for (size_t start = 0; start < numFrames; start += ChunkSize) {
+      const auto count = std::min(ChunkSize, numFrames - start);
+      const auto frames = samples + start * numChannels;
+      for (size_t channel = 0; channel < MaxChannels; ++channel) {
+         const auto buffer = mBuffers[channel];
+         if (channel < numChannels)
+            for (size_t ii = 0; ii < count; ++ii)
+               buffer[ii] = frames[ii * numChannels + channel];
+         else
+            std::fill(buffer, buffer + count, 0.0f);
+      }
+      mLoudness->ProcessSamples(channels, count);
+   }
+
+   const auto nTruePeaks = std::min<size_t>(numChannels, MaxChannels);
+   for (size_t channel = 0; channel < nTruePeaks; ++channel)
+      mTruePeaks[channel].Process(samples + channel, numFrames, numChannels);
+
+   Publish();
+}
+
+void LoudnessMeter::Publish()
+{
+   auto &loudness = *mLoudness;
+   mMomentary.store(ToDecibels(loudness.MomentaryLoudness()));
+   mShortTerm.store(ToDecibels(loudness.ShortTermLoudness()));
+   // Gating visits the whole histogram, so only when it changes, about
+   // ten times a second
+   if (const auto count = loudness.GetBlockCount(); count != mBlockCount) {
+      mBlockCount = count;
+      mIntegrated.store(ToDecibels(loudness.GatedLoudness()));
+   }
+   float peak = 0;
+   for (const auto &truePeak : mTruePeaks)
+      peak = std::max(peak, truePeak.GetPeak());
+   mTruePeak.store(ToDecibels(peak * peak));
+}
+
+auto LoudnessMeter::GetReadings() const -> Readings
+{
+   return { mMomentary.load(), mShortTerm.load(), mIntegrated.load(),
+      mTruePeak.load() };
+}
@@ -0,0 +1,77 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  LoudnessMeter.h
+
+**********************************************************************/
+#ifndef __AUDACITY_LOUDNESS_METER__
+#define __AUDACITY_LOUDNESS_METER__
+
+#include "ClientData.h"
+#include "TruePeak.h"
+#include "effects/EBUR128.h"
+
+#include <atomic>
+#include <optional>
+
+class AudacityProject;
+
+//! EBU R128 loudness of what the project plays, as the playback meter gets it
+/*!
+ Process() runs in the audio thread, and neither allocates nor locks; other
+ functions run in the main thread, except that the readings may be taken and
+ a reset requested from any thread.
+ */
+class LoudnessMeter final : public ClientData::Base
+{
+public:
+   //! Channels measured; more are ignored, and a single one counts once
+   static constexpr size_t MaxChannels = 2;
+
+   static LoudnessMeter &Get(AudacityProject &project);
+   static const LoudnessMeter &Get(const AudacityProject &project);
+
+   LoudnessMeter();
+   LoudnessMeter(const LoudnessMeter&) = delete;
+   LoudnessMeter &operator=(const LoudnessMeter&) = delete;
+   ~LoudnessMeter() override;
+
+   //! Start measuring again, at the next Process(), for a stream at the given
+   //! rate
+   /*! The rate takes effect only if no stream is active */
+   void Reset(double rate);
+
+   //! Start measuring again, at the next Process()
+   void RequestReset();
+
+   //! Measure interleaved samples
+   void Process(unsigned numChannels, size_t numFrames, const float *samples);
+
+   //! In LUFS, except true peak in dBTP; minus infinity when there are none
+   struct Readings {
+      float momentary;
+      float shortTerm;
+      float integrated;
+      float truePeak;
+   };
+   Readings GetReadings() const;
+
+private:
+   void DoReset();
+   void Publish();
+
+   //! Most frames deinterleaved at once
+   static constexpr size_t ChunkSize = 512;
+
+   std::optional<EBUR128> mLoudness;
+   TruePeak mTruePeaks[MaxChannels];
+   float mBuffers[MaxChannels][ChunkSize];
+   double mRate{ 0 };
+   size_t mBlockCount{ 0 };
+
+   std::atomic<bool> mResetPending{ false };
+   std::atomic<float> mMomentary, mShortTerm, mIntegrated, mTruePeak;
+};
+
+#endif
@@ -0,0 +1,199 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  LoudnessMeterWindow.cpp
+
+*******************************************************************//*!
+
+\class LoudnessMeterDialog
+\brief Live EBU R128 loudness of playback, from the playback meter, so that
+  no meter plug-in is needed
+
+*//*******************************************************************/
+
+#include "LoudnessMeterWindow.h"
+
+#include <wx/button.h>
+#include <wx/textctrl.h>
+
+#include "LoudnessMeter.h"
+#include "ProjectWindows.h"
+#include "ShuttleGui.h"
+
+#include <cmath>
+
+enum {
+   ID_RESET = 1000,
+   ID_TIMER,
+};
+
+BEGIN_EVENT_TABLE(LoudnessMeterDialog, wxDialogWrapper)
+   EVT_TIMER(ID_TIMER, LoudnessMeterDialog::OnTimer)
+   EVT_BUTTON(ID_RESET, LoudnessMeterDialog::OnReset)
+   EVT_CLOSE(LoudnessMeterDialog::OnCloseWindow)
+END_EVENT_TABLE()
+
+#define LoudnessMeterTitle XO("Loudness Meter")
+
+namespace {
+//! Refreshes of the readings each second
+constexpr int RefreshRate = 10;
+
+wxString FormatReading(float value, const TranslatableString &unit)
+{
+   if (!std::isfinite(value))
+      return wxT("-");
+   return wxString::Format(wxT("%.1f "), value) + unit.Translation();
+}
+}
+
+LoudnessMeterDialog::LoudnessMeterDialog(AudacityProject &project)
+   : wxDialogWrapper(FindProjectFrame(&project), wxID_ANY,
+      LoudnessMeterTitle, wxDefaultPosition, wxDefaultSize,
+      wxDEFAULT_DIALOG_STYLE | wxRESIZE_BORDER)
+   , mProject{ project }
+   , mTimer{ this, ID_TIMER }
+{
+   SetName();
+
+   ShuttleGui S(this, eIsCreating);
+   Populate(S);
+}
+
+void LoudnessMeterDialog::Populate(ShuttleGui & S)
+{
+   S.SetBorder(5);
+   S.StartVerticalLay(true);
+   {
+      S.StartStatic(XO("Playback"), 1);
+      {
+         S.StartMultiColumn(2, wxCENTRE);
+         {
+            /* i18n-hint: EBU R128 loudness of the latest 400 ms */
+            S.AddPrompt(XXO("&Momentary"));
+            mMomentary = S.Style(wxTE_READONLY).AddTextBox({}, wxT(""), 12);
+
+            /* i18n-hint: EBU R128 loudness of the latest 3 seconds */
+            S.AddPrompt(XXO("&Short-term"));
+            mShortTerm = S.Style(wxTE_READONLY).AddTextBox({}, wxT(""), 12);
+
+            /* i18n-hint: EBU R128 loudness since playback began */
+            S.AddPrompt(XXO("&Integrated"));
+            mIntegrated = S.Style(wxTE_READONLY).AddTextBox({}, wxT(""), 12);
+
+            /* i18n-hint: Greatest level between samples, measured by
+               oversampling */
+            S.AddPrompt(XXO("&True peak"));
+            mTruePeak = S.Style(wxTE_READONLY).AddTextBox({}, wxT(""), 12);
+         }
+         S.EndMultiColumn();
+      }
+      S.EndStatic();
+
+      auto reset = safenew wxButton(this, ID_RESET, _("&Reset"));
+      S.AddStandardButtons(eOkButton, reset);
+   }
+   S.EndVerticalLay();
+
+   Layout();
+   Fit();
+   SetMinSize(GetSize());
+   UpdateReadings();
+}
+
+bool LoudnessMeterDialog::Show(bool show)
+{
+   // Poll only while shown
+   if (show)
+      mTimer.Start(1000 / RefreshRate);
+   else
+      mTimer.Stop();
+   UpdateReadings();
+   return wxDialogWrapper::Show(show);
+}
+
+void LoudnessMeterDialog::UpdateReadings()
+{
+   const auto readings = LoudnessMeter::Get(mProject).GetReadings();
+   /* i18n-hint: Loudness Units relative to Full Scale */
+   const auto lufs = XO("LUFS");
+   mMomentary->ChangeValue(FormatReading(readings.momentary, lufs));
+   mShortTerm->ChangeValue(FormatReading(readings.shortTerm, lufs));
+   mIntegrated->ChangeValue(FormatReading(readings.integrated, lufs));
+   /* i18n-hint: Decibels relative to full scale, of true peak */
+   mTruePeak->ChangeValue(FormatReading(readings.truePeak, XO("dBTP")));
+}
+
+void LoudnessMeterDialog::OnTimer(wxTimerEvent & WXUNUSED(event))
+{
+   UpdateReadings();
+}
+
+void LoudnessMeterDialog::OnReset(wxCommandEvent & WXUNUSED(event))
+{
+   LoudnessMeter::Get(mProject).RequestReset();
+   UpdateReadings();
+}
+
+void LoudnessMeterDialog::OnCloseWindow(wxCloseEvent & WXUNUSED(event))
+{
+   this->Show(false);
+}
+
+// PrefsListener implementation
+void LoudnessMeterDialog::UpdatePrefs()
+{
+   bool shown = IsShown();
+   if (shown) {
+      Show(false);
+   }
+
+   SetSizer(nullptr);
+   DestroyChildren();
+
+   SetTitle(LoudnessMeterTitle);
+   ShuttleGui S(this, eIsCreating);
+   Populate(S);
+
+   if (shown) {
+      Show(true);
+   }
+}
+
+// Remaining code hooks this add-on into the application
+#include "CommandContext.h"
+#include "CommonCommandFlags.h"
+#include "MenuRegistry.h"
+
+namespace {
+
+// Loudness meter window attached to each project is built on demand by:
+AttachedWindows::RegisteredFactory sLoudnessMeterWindowKey{
+   []( AudacityProject &parent ) -> wxWeakRef< wxWindow > {
+      return safenew LoudnessMeterDialog( parent );
+   }
+};
+
+// Define our extra menu item that invokes that factory
+void OnLoudnessMeter(const CommandContext &context)
+{
+   auto &project = context.project;
+
+   auto loudnessMeterWindow =
+      &GetAttachedWindows(project).Get(sLoudnessMeterWindowKey);
+   loudnessMeterWindow->Show();
+   loudnessMeterWindow->Raise();
+}
+
+// Register that menu item
+
+using namespace MenuRegistry;
+AttachedItem sAttachment{
+   // Useful while playing, so always enabled
+   Command( wxT("LoudnessMeter"), XXO("&Loudness Meter"), OnLoudnessMeter,
+      AlwaysEnabledFlag ),
+   wxT("View/Windows")
+};
+
+}
@@ -0,0 +1,53 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  LoudnessMeterWindow.h
+
+**********************************************************************/
+
+#ifndef __AUDACITY_LOUDNESS_METER_WINDOW__
+#define __AUDACITY_LOUDNESS_METER_WINDOW__
+
+#include "Prefs.h"
+#include "wxPanelWrapper.h" // to inherit
+
+#include <wx/timer.h> // member variable
+
+class wxTextCtrl;
+class AudacityProject;
+class ShuttleGui;
+
+//! Shows the readings of the LoudnessMeter of a project, while the project
+//! plays
+class LoudnessMeterDialog final : public wxDialogWrapper,
+                                  public PrefsListener
+{
+ public:
+   explicit LoudnessMeterDialog(AudacityProject &project);
+
+   bool Show(bool show = true) override;
+
+ private:
+   void Populate(ShuttleGui & S);
+   void UpdateReadings();
+
+   void OnTimer(wxTimerEvent & event);
+   void OnReset(wxCommandEvent & event);
+   void OnCloseWindow(wxCloseEvent & event);
+
+   // PrefsListener implementation
+   void UpdatePrefs() override;
+
+   AudacityProject &mProject;
+   wxTimer mTimer;
+   wxTextCtrl *mMomentary{};
+   wxTextCtrl *mShortTerm{};
+   wxTextCtrl *mIntegrated{};
+   wxTextCtrl *mTruePeak{};
+
+ public:
+   DECLARE_EVENT_TABLE()
+};
+
+#endif
@@ -0,0 +1,143 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  MemoryStatisticsDialog.cpp
+
+**********************************************************************/
+#include "MemoryStatisticsDialog.h"
+
+#include "Internat.h"
+#include "MemoryBudget.h"
+#include "MemoryX.h"
+
+#include "ShuttleGui.h"
+#include "wxPanelWrapper.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <wx/stattext.h>
+#include <wx/timer.h>
+
+namespace
+{
+class Dialog : public wxDialogWrapper
+{
+public:
+
+   Dialog()
+       : wxDialogWrapper(nullptr, wxID_ANY, Verbatim("Memory Statistics"))
+   {
+      // Consumers register statically, so they are all known by now
+      const auto report = MemoryBudget::GetReport();
+
+      ShuttleGui S(this, eIsCreating);
+
+      S.Style(wxNO_BORDER | wxTAB_TRAVERSAL).Prop(true).StartPanel();
+      {
+         S.StartVerticalLay(true);
+         {
+            S.StartMultiColumn(3, wxEXPAND);
+            {
+               S.AddFixedText(Verbatim("Consumer"));
+               S.AddFixedText(Verbatim("Held"));
+               S.AddFixedText(Verbatim("Evicted"));
+               for (const auto &usage : report.usages) {
+                  wxString name = usage.name;
+                  if (!usage.evictable)
+                     name += " (not evictable)";
+                  S.AddFixedText(Verbatim(name));
+                  mRows.push_back({ S.AddVariableText({}),
+                     S.AddVariableText({}) });
+               }
+            }
+            S.EndMultiColumn();
+
+            S.StartMultiColumn(2, wxEXPAND);
+            {
+               S.AddFixedText(Verbatim("Total:"));
+               mTotal = S.AddVariableText({});
+
+               S.AddFixedText(Verbatim("Budget:"));
+               mBudget = S.AddVariableText({});
+
+               S.AddFixedText(Verbatim("Evictions:"));
+               mEnforcements = S.AddVariableText({});
+            }
+            S.EndMultiColumn();
+         }
+         S.EndVerticalLay();
+      }
+      S.EndPanel();
+
+      Update(report);
+
+      Layout();
+      Fit();
+
+      // The budget is enforced at idle time, at most once a second
+      mTimer.Bind(wxEVT_TIMER,
+         [this](wxTimerEvent&) { Update(MemoryBudget::GetReport()); });
+      mTimer.Start(1000);
+   }
+
+private:
+   static wxString FormatBytes(size_t bytes)
+   {
+      return Internat::FormatSize(static_cast<double>(bytes)).Translation();
+   }
+
+   void Update(const MemoryBudget::Report &report)
+   {
+      const auto count = std::min(mRows.size(), report.usages.size());
+      for (size_t i = 0; i < count; ++i) {
+         mRows[i].Bytes->SetLabel(FormatBytes(report.usages[i].bytes));
+         mRows[i].Evicted->SetLabel(FormatBytes(report.usages[i].evicted));
+      }
+
+      mTotal->SetLabel(FormatBytes(report.total));
+      mBudget->SetLabel(
+         report.budget > 0 ? FormatBytes(report.budget) : wxString{ L"none" });
+      mEnforcements->SetLabel(std::to_string(report.enforcements));
+   }
+
+   struct Row final
+   {
+      wxStaticText* Bytes;
+      wxStaticText* Evicted;
+   };
+
+   std::vector<Row> mRows;
+   wxStaticText* mTotal;
+   wxStaticText* mBudget;
+   wxStaticText* mEnforcements;
+
+   wxTimer mTimer;
+};
+
+Destroy_ptr<Dialog> sDialog;
+}
+
+void MemoryStatisticsDialog::Show(bool show)
+{
+   if (!show)
+   {
+      if (sDialog != nullptr)
+         sDialog->Show(false);
+
+      return;
+   }
+
+   if (sDialog == nullptr)
+      sDialog.reset(safenew Dialog);
+
+   sDialog->Show(true);
+}
+
+void MemoryStatisticsDialog::Destroy()
+{
+   sDialog.reset();
+}
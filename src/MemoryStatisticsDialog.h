@@ -0,0 +1,20 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  MemoryStatisticsDialog.h
+
+**********************************************************************/
+#pragma once
+
+//! A dialog that displays the memory that caches hold, against the
+//! MemoryBudget
+class MemoryStatisticsDialog final
+{
+public:
+   //! Shows the dialog
+   static void Show(bool show);
+   //! Destroys the dialog to prevent Audacity from hanging on exit
+   static void Destroy();
+};
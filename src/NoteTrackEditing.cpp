@@ -27,5 +27,6 @@ DEFINE_ATTACHED_VIRTUAL_OVERRIDE(OnNoteTrackProjectTempoChange) {
       const auto newDuration = seq.get_dur() * ratio;
       seq.stretch_region(0, b1, newDuration);
       seq.set_real_dur(newDuration);
+      track.InvalidateNoteIndex();
    };
 }
@@ -10,6 +10,7 @@
 
 #include "PluginStartupRegistration.h"
 
+#include <algorithm>
 #include <thread>
 
 #include <wx/log.h>
@@ -30,6 +31,11 @@ namespace
       OnPluginScanTimeout = wxID_HIGHEST + 1,
    };
 
+   //Each validator runs its own host process
+   constexpr size_t MaxValidators = 8;
+   //Milliseconds between checks whether a validation takes too long
+   constexpr int TimeoutCheckInterval = 1000;
+
    class PluginScanDialog : public wxDialogWrapper
    {
       wxStaticText* mText{nullptr};
@@ -127,18 +133,17 @@ namespace
    };
 }
 
-PluginStartupRegistration::PluginStartupRegistration(const std::map<wxString, std::vector<wxString>>& pluginsToProcess)
+PluginStartupRegistration::Worker::Worker(PluginStartupRegistration& owner)
+   : mOwner(owner)
 {
-   for(auto& p : pluginsToProcess)
-      mPluginsToProcess.push_back(p);
 }
 
-void PluginStartupRegistration::OnInternalError(const wxString& error)
+void PluginStartupRegistration::Worker::OnInternalError(const wxString& error)
 {
-   StopWithError(error);
+   mOwner.StopWithError(error);
 }
 
-void PluginStartupRegistration::OnPluginFound(const PluginDescriptor& desc)
+void PluginStartupRegistration::Worker::OnPluginFound(const PluginDescriptor& desc)
 {
    if(!mValidProviderFound)
       mFailedPluginsCache.clear();
@@ -149,7 +154,7 @@ void PluginStartupRegistration::OnPluginFound(const PluginDescriptor& desc)
    PluginManager::Get().RegisterPlugin(PluginDescriptor { desc });
 }
 
-void PluginStartupRegistration::OnPluginValidationFailed(const wxString& providerId, const wxString& path)
+void PluginStartupRegistration::Worker::OnPluginValidationFailed(const wxString& providerId, const wxString& path)
 {
    PluginID ID = providerId + wxT("_") + path;
    PluginDescriptor pluginDescriptor;
@@ -165,41 +170,53 @@ void PluginStartupRegistration::OnPluginValidationFailed(const wxString& provide
    mFailedPluginsCache.push_back(std::move(pluginDescriptor));
 }
 
-
-void PluginStartupRegistration::OnValidationFinished()
+void PluginStartupRegistration::Worker::OnValidationFinished()
 {
-   ++mCurrentPluginProviderIndex;
+   ++mProviderIndex;
    if(mValidProviderFound ||
-      mPluginsToProcess[mCurrentPluginIndex].second.size() == mCurrentPluginProviderIndex)
+      mOwner.mPluginsToProcess[mPluginIndex].second.size() == mProviderIndex)
+      mOwner.FinishPlugin(*this);
+   mOwner.ProcessNext(*this);
+}
+
+PluginStartupRegistration::PluginStartupRegistration(const std::map<wxString, std::vector<wxString>>& pluginsToProcess)
+{
+   for(auto& p : pluginsToProcess)
+      mPluginsToProcess.push_back(p);
+}
+
+PluginStartupRegistration::~PluginStartupRegistration() = default;
+
+void PluginStartupRegistration::FinishPlugin(Worker& worker)
+{
+   auto& failedPluginsCache = worker.mFailedPluginsCache;
+   if(!failedPluginsCache.empty())
    {
-      if(!mFailedPluginsCache.empty())
+      //we've tried all providers associated with same module path...
+      if(!worker.mValidProviderFound)
       {
-         //we've tried all providers associated with same module path...
-         if(!mValidProviderFound)
-         {
-            //...but none of them succeeded
-            mFailedPluginsPaths.push_back(mFailedPluginsCache[0].GetPath());
+         //...but none of them succeeded
+         mFailedPluginsPaths.push_back(failedPluginsCache[0].GetPath());
 
-            //Same plugin path, but different providers, we need to register all of them
-            for(auto& desc : mFailedPluginsCache)
-               PluginManager::Get().RegisterPlugin(std::move(desc));
-         }
-         //plugin type was detected, but plugin instance validation has failed
-         else
+         //Same plugin path, but different providers, we need to register all of them
+         for(auto& desc : failedPluginsCache)
+            PluginManager::Get().RegisterPlugin(std::move(desc));
+      }
+      //plugin type was detected, but plugin instance validation has failed
+      else
+      {
+         for(auto& desc : failedPluginsCache)
          {
-            for(auto& desc : mFailedPluginsCache)
-            {
-               if(desc.GetPluginType() != PluginTypeStub)
-                  mFailedPluginsPaths.push_back(desc.GetPath());
-            }
+            if(desc.GetPluginType() != PluginTypeStub)
+               mFailedPluginsPaths.push_back(desc.GetPath());
          }
       }
-      ++mCurrentPluginIndex;
-      mCurrentPluginProviderIndex = 0;
-      mValidProviderFound = false;
-      mFailedPluginsCache.clear();
    }
-   ProcessNext();
+   ++mFinishedPluginsCount;
+   worker.mActive = false;
+   worker.mProviderIndex = 0;
+   worker.mValidProviderFound = false;
+   failedPluginsCache.clear();
 }
 
 const std::vector<wxString>& PluginStartupRegistration::GetFailedPluginsPaths() const noexcept
@@ -212,34 +229,43 @@ void PluginStartupRegistration::Run(std::chrono::seconds timeout)
    PluginScanDialog dialog(nullptr, wxID_ANY, XO("Searching for plugins"));
    wxTimer timeoutTimer(&dialog, OnPluginScanTimeout);
    mScanDialog = &dialog;
-   mTimeoutTimer = &timeoutTimer;
    mTimeout = timeout;
 
    dialog.Bind(wxEVT_BUTTON, [this](wxCommandEvent& evt) {
       evt.Skip();
       if(evt.GetId() == wxID_IGNORE)
-         Skip();
+         SkipOldest();
    });
    dialog.Bind(wxEVT_TIMER, [this](wxTimerEvent& evt) {
       if(evt.GetId() == OnPluginScanTimeout)
-      {
-         if(mValidator && mValidator->InactiveSince() < mRequestStartTime)
-            Skip();
-         //else
-         //   wxMessageBox("Please check for plugin popups!");
-      }
+         CheckTimeouts();
       else
          evt.Skip();
    });
    dialog.Bind(wxEVT_CLOSE_WINDOW, [this](wxCloseEvent& evt) {
       evt.Skip();
-      mValidator.reset();
+      for(auto& worker : mWorkers)
+         worker->mValidator.reset();
+      //Results of all the workers are saved at once
       PluginManager::Get().Save();
       PluginManager::Get().NotifyPluginsChanged();
    });
 
+   //Each worker has its own host process, so a plugin that crashes or hangs
+   //stops only the one worker; the others go on with the remaining plugins
+   const auto workersCount = std::clamp<size_t>(
+      std::thread::hardware_concurrency(), 1, MaxValidators);
+   for(size_t i = 0; i < std::min(workersCount, mPluginsToProcess.size()); ++i)
+      mWorkers.push_back(std::make_unique<Worker>(*this));
+
+   if(mTimeout.count() > 0)
+      timeoutTimer.Start(TimeoutCheckInterval);
+
    dialog.CenterOnScreen();
-   ProcessNext();
+   if(mWorkers.empty())
+      Stop();
+   for(auto& worker : mWorkers)
+      ProcessNext(*worker);
    dialog.ShowModal();
 }
 
@@ -249,34 +275,60 @@ void PluginStartupRegistration::Stop()
       dialog->Close();
 }
 
-void PluginStartupRegistration::Skip()
+void PluginStartupRegistration::SkipOldest()
+{
+   Worker* oldest{nullptr};
+   for(auto& worker : mWorkers)
+   {
+      if(worker->mActive && worker->mValidator &&
+         (oldest == nullptr || worker->mRequestStartTime < oldest->mRequestStartTime))
+         oldest = worker.get();
+   }
+   if(oldest != nullptr)
+      Skip(*oldest);
+}
+
+void PluginStartupRegistration::CheckTimeouts()
+{
+   const auto now = std::chrono::system_clock::now();
+   for(auto& worker : mWorkers)
+   {
+      if(worker->mActive && worker->mValidator &&
+         now - worker->mRequestStartTime >= mTimeout &&
+         worker->mValidator->InactiveSince() < worker->mRequestStartTime)
+         Skip(*worker);
+      //else
+      //   wxMessageBox("Please check for plugin popups!");
+   }
+}
+
+void PluginStartupRegistration::Skip(Worker& worker)
 {
    //Drop current validator, no more callbacks will be received from now
-   mValidator->SetDelegate(nullptr);
+   worker.mValidator->SetDelegate(nullptr);
    //While on Linux and MacOS socket `shutdown()` wakes up `select()` almost
    //immediately, on Windows it sometimes get delayed on unspecified amount
    //of time. As we do not expect any data we can safely move remaining
    //operations to another thread.
-   std::thread([validator = std::shared_ptr<AsyncPluginValidator>(std::move(mValidator))]{ }).detach();
+   std::thread([validator = std::shared_ptr<AsyncPluginValidator>(std::move(worker.mValidator))]{ }).detach();
 
-   if(!mValidProviderFound)
+   const auto& [path, providers] = mPluginsToProcess[worker.mPluginIndex];
+   if(!worker.mValidProviderFound)
    {
       // Validator didn't report anything yet or it tried
       // one or more providers that didn't recognize the plugin.
       // In that case we assume that none of the remaining providers
       // can recognize that plugin.
       // Note: create stub `PluginDescriptors` for each associated provider
-      for(;mCurrentPluginProviderIndex < mPluginsToProcess[mCurrentPluginIndex].second.size(); ++mCurrentPluginProviderIndex)
-         OnPluginValidationFailed(
-            mPluginsToProcess[mCurrentPluginIndex].second[mCurrentPluginProviderIndex],
-            mPluginsToProcess[mCurrentPluginIndex].first);
-      mCurrentPluginProviderIndex = mPluginsToProcess[mCurrentPluginIndex].second.size() - 1;
+      for(; worker.mProviderIndex < providers.size(); ++worker.mProviderIndex)
+         worker.OnPluginValidationFailed(providers[worker.mProviderIndex], path);
+      worker.mProviderIndex = providers.size() - 1;
    }
    //else
    //    Don't assume that `OnValidationFinished()` and `OnPluginFound()`
    //    aren't deferred within run loop
 
-   OnValidationFinished();
+   worker.OnValidationFinished();
 }
 
 void PluginStartupRegistration::StopWithError(const wxString& msg)
@@ -286,33 +338,42 @@ void PluginStartupRegistration::StopWithError(const wxString& msg)
    Stop();
 }
 
-void PluginStartupRegistration::ProcessNext()
+void PluginStartupRegistration::UpdateProgress(const wxString& path)
 {
-   if(mCurrentPluginIndex == mPluginsToProcess.size())
+   if(auto dialog = static_cast<PluginScanDialog*>(mScanDialog.get()))
    {
-      Stop();
-      return;
+      const auto progress = static_cast<float>(mFinishedPluginsCount) / static_cast<float>(mPluginsToProcess.size());
+      dialog->UpdateProgress(path, progress);
    }
+}
 
-   try
+void PluginStartupRegistration::ProcessNext(Worker& worker)
+{
+   if(!worker.mActive)
    {
-      if(auto dialog = static_cast<PluginScanDialog*>(mScanDialog.get()))
+      if(mNextPluginIndex == mPluginsToProcess.size())
       {
-         const auto progress = static_cast<float>(mCurrentPluginIndex) / static_cast<float>(mPluginsToProcess.size());
-         dialog->UpdateProgress(
-            mPluginsToProcess[mCurrentPluginIndex].first,
-            progress);
+         //Wait for the plugins the other workers still validate
+         if(std::none_of(mWorkers.begin(), mWorkers.end(),
+            [](auto& other) { return other->mActive; }))
+            Stop();
+         return;
       }
-      if(!mValidator)
-         mValidator = std::make_unique<AsyncPluginValidator>(*this);
+      worker.mPluginIndex = mNextPluginIndex++;
+      worker.mActive = true;
+   }
 
-      mValidator->Validate(
-         mPluginsToProcess[mCurrentPluginIndex].second[mCurrentPluginProviderIndex],
-         mPluginsToProcess[mCurrentPluginIndex].first
+   try
+   {
+      UpdateProgress(mPluginsToProcess[worker.mPluginIndex].first);
+      if(!worker.mValidator)
+         worker.mValidator = std::make_unique<AsyncPluginValidator>(worker);
+
+      worker.mValidator->Validate(
+         mPluginsToProcess[worker.mPluginIndex].second[worker.mProviderIndex],
+         mPluginsToProcess[worker.mPluginIndex].first
       );
-      mRequestStartTime = std::chrono::system_clock::now();
-      if(auto timer = mTimeoutTimer.get())
-         timer->StartOnce(std::chrono::duration_cast<std::chrono::milliseconds>(mTimeout).count());
+      worker.mRequestStartTime = std::chrono::system_clock::now();
    }
    catch(std::exception& e)
    {
@@ -323,4 +384,3 @@ void PluginStartupRegistration::ProcessNext()
       StopWithError("unknown error");
    }
 }
-
@@ -20,25 +20,43 @@
 #include "wxPanelWrapper.h"
 
 ///Helper class that passes plugins provided in constructor
-///to plugin validator, then "good" plugins are registered in
-///PluginManager. 
-class PluginStartupRegistration final :
-   public AsyncPluginValidator::Delegate
+///to plugin validators, then "good" plugins are registered in
+///PluginManager. Several validators, each with its own host process,
+///work at once, each on a different plugin path.
+class PluginStartupRegistration final
 {
-   std::unique_ptr<AsyncPluginValidator> mValidator;
+   ///Validates the providers of one plugin path at a time
+   class Worker final : public AsyncPluginValidator::Delegate
+   {
+   public:
+      explicit Worker(PluginStartupRegistration& owner);
+
+      void OnInternalError(const wxString& error) override;
+      void OnPluginFound(const PluginDescriptor& desc) override;
+      void OnPluginValidationFailed(const wxString& providerId, const wxString& path) override;
+      void OnValidationFinished() override;
+
+      PluginStartupRegistration& mOwner;
+      std::unique_ptr<AsyncPluginValidator> mValidator;
+      bool mActive{false};
+      size_t mPluginIndex{0};
+      size_t mProviderIndex{0};
+      bool mValidProviderFound{false};
+      std::vector<PluginDescriptor> mFailedPluginsCache;
+      std::chrono::system_clock::time_point mRequestStartTime{};
+   };
+
+   std::vector<std::unique_ptr<Worker>> mWorkers;
    std::vector<std::pair<wxString, std::vector<wxString>>> mPluginsToProcess;
-   size_t mCurrentPluginIndex{0};
-   size_t mCurrentPluginProviderIndex{0};
-   bool mValidProviderFound{false};
+   size_t mNextPluginIndex{0};
+   size_t mFinishedPluginsCount{0};
    std::vector<wxString> mFailedPluginsPaths;
-   std::vector<PluginDescriptor> mFailedPluginsCache;
    wxWeakRef<wxDialogWrapper> mScanDialog;
-   wxWeakRef<wxTimer> mTimeoutTimer;
    std::chrono::system_clock::duration mTimeout{};
-   std::chrono::system_clock::time_point mRequestStartTime{};
 public:
 
    PluginStartupRegistration(const std::map<wxString, std::vector<wxString>>& pluginsToProcess);
+   ~PluginStartupRegistration();
 
    ///Starts validation, showing dialog that blocks execution until
    ///process is complete or canceled
@@ -49,15 +67,15 @@ public:
    ///Returns list of paths of plugins that didn't pass validation for some reason
    const std::vector<wxString>& GetFailedPluginsPaths() const noexcept;
 
-   void OnInternalError(const wxString& error) override;
-   void OnPluginFound(const PluginDescriptor& desc) override;
-   void OnPluginValidationFailed(const wxString& providerId, const wxString& path) override;
-   void OnValidationFinished() override;
-
 private:
    
    void Stop();
-   void Skip();
+   ///Gives up on the plugin of the worker that has waited longest
+   void SkipOldest();
+   void Skip(Worker& worker);
+   void CheckTimeouts();
    void StopWithError(const wxString& msg);
-   void ProcessNext();
+   void ProcessNext(Worker& worker);
+   void FinishPlugin(Worker& worker);
+   void UpdateProgress(const wxString& path);
 };
@@ -22,6 +22,7 @@ Paul Licameli split from ProjectManager.cpp
 #include "CommandManager.h"
 #include "CommonCommandFlags.h"
 #include "DefaultPlaybackPolicy.h"
+#include "FrozenTracks.h"
 #include "Meter.h"
 #include "Mix.h"
 #include "PendingTracks.h"
@@ -732,7 +733,7 @@ void ProjectAudioManager::OnRecord(bool altAppearance)
             auto it = std::find_if(
                transportTracks.playbackSequences.begin(), end,
                [&wt](const auto& playbackSequence) {
-                  return playbackSequence->FindChannelGroup() ==
+                  return FrozenTracks::FindSourceGroup(*playbackSequence) ==
                          wt->FindChannelGroup();
                });
             if (it != end)
@@ -833,7 +834,8 @@ bool ProjectAudioManager::DoRecord(AudacityProject &project,
             const auto &range = transportSequences.playbackSequences;
             bool prerollTrack = any_of(range.begin(), range.end(),
                [&](const auto &pSequence){
-                  return shared.get() == pSequence->FindChannelGroup(); });
+                  return shared.get() ==
+                     FrozenTracks::FindSourceGroup(*pSequence); });
             if (prerollTrack)
                transportSequences.prerollSequences.push_back(shared);
 
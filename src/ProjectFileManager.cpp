@@ -22,6 +22,7 @@ Paul Licameli split from AudacityProject.cpp
 #include "BasicUI.h"
 #include "ClipMirAudioReader.h"
 #include "CodeConversions.h"
+#include "DBConnection.h"
 #include "Export.h"
 #include "HelpText.h"
 #include "Import.h"
@@ -57,6 +58,7 @@ Paul Licameli split from AudacityProject.cpp
 #include "WaveTrack.h"
 #include "WaveTrackUtilities.h"
 #include "XMLFileReader.h"
+#include "concurrency/ThreadPool.h"
 #include "import/ImportStreamDialog.h"
 #include "prefs/ImportExportPrefs.h"
 #include "widgets/FileHistory.h"
@@ -67,6 +69,10 @@ Paul Licameli split from AudacityProject.cpp
 
 #include "ProjectFileIOExtension.h"
 
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <numeric>
 #include <optional>
 #include <wx/frame.h>
 #include <wx/log.h>
@@ -816,8 +822,11 @@ void ProjectFileManager::CompactProjectOnClose()
       for (auto wt : mLastSavedTracks->Any<WaveTrack>())
          WaveTrackUtilities::CloseLock(*wt);
 
-      // Attempt to compact the project
-      projectFileIO.Compact( { mLastSavedTracks.get() } );
+      // Attempt to compact the project, but don't delay the close too long
+      // when that can be resumed in the next session
+      constexpr double MaxCompactSecondsOnClose = 5.0;
+      projectFileIO.Compact(
+         { mLastSavedTracks.get() }, false, MaxCompactSecondsOnClose );
 
       if ( !projectFileIO.WasCompacted() &&
           UndoManager::Get( project ).UnsavedChanges() ) {
@@ -1360,9 +1369,10 @@ private:
 };
 } // namespace
 
-bool ProjectFileManager::Import(const FilePath& fileName, bool addToHistory)
+bool ProjectFileManager::Import(const FilePath& fileName, bool addToHistory,
+   const std::optional<ImportTimeRange>& timeRange)
 {
-   return Import(std::vector<FilePath> { fileName }, addToHistory);
+   return Import(std::vector<FilePath> { fileName }, addToHistory, timeRange);
 }
 
 namespace
@@ -1378,41 +1388,178 @@ std::vector<std::shared_ptr<MIR::AnalyzedAudioClip>> RunTempoDetection(
    auto progress = MakeProgress(
       XO("Music Information Retrieval"), XO("Analyzing imported audio"),
       ProgressShowCancel);
-   auto count = 0;
-   const auto reportProgress = [&](double progressFraction) {
-      const auto result = progress->Poll(
-         (count + progressFraction) / readers.size() * 1000, 1000);
-      if (result != ProgressResult::Success)
-         throw UserException {};
+   const auto poll = [&](double progressFraction) {
+      const auto result =
+         progress->Poll(progressFraction / readers.size() * 1000, 1000);
+      return result == ProgressResult::Success;
    };
 
+   // Analyses of clips are independent, and write only their own entries
+   std::vector<std::optional<MIR::ProjectSyncInfo>> syncInfos(readers.size());
+   std::vector<std::atomic<double>> fractions(readers.size());
+   for (auto& fraction : fractions)
+      fraction.store(0.0, std::memory_order_relaxed);
+   std::atomic<bool> cancelled { false };
+   const auto analyze = [&](size_t i,
+                            std::function<void(double)> reportProgress) {
+      const auto& reader = readers[i];
+      const MIR::ProjectSyncInfoInput input {
+         *reader,
+         reader->filename,
+         reader->tags,
+         std::move(reportProgress),
+         projectTempo,
+         projectWasEmpty,
+         isBeatsAndMeasures,
+         [&reader](
+            const MIR::MirAudioReader&, MIR::FalsePositiveTolerance tolerance,
+            const std::function<void(double)>& progressCallback) {
+            return AnalyzedWaveClip::GetMusicalMeter(
+               *reader, tolerance, progressCallback);
+         },
+      };
+      if (auto syncInfo = MIR::GetProjectSyncInfo(input))
+         syncInfos[i].emplace(*syncInfo);
+   };
+
+   if (readers.size() == 1)
+      // Frames of the one clip are analyzed concurrently instead, and
+      // progress is reported in this thread
+      analyze(0, [&](double progressFraction) {
+         if (!poll(progressFraction))
+            throw UserException {};
+      });
+   else
+   {
+      auto& pool = audacity::concurrency::ThreadPool::GetDefault();
+      std::vector<std::future<void>> futures;
+      futures.reserve(readers.size());
+      for (size_t i = 0; i < readers.size(); ++i)
+         futures.push_back(pool.Async([&, i] {
+            analyze(i, [&, i](double progressFraction) {
+               if (cancelled.load(std::memory_order_relaxed))
+                  throw UserException {};
+               fractions[i].store(progressFraction, std::memory_order_relaxed);
+            });
+         }));
+
+      // Poll the progress dialog here, and wait for all before any rethrow
+      std::exception_ptr pException;
+      for (auto& future : futures)
+      {
+         while (future.wait_for(std::chrono::milliseconds { 50 }) !=
+                std::future_status::ready)
+         {
+            const auto total = std::accumulate(
+               fractions.begin(), fractions.end(), 0.0,
+               [](double sum, const std::atomic<double>& fraction) {
+                  return sum + fraction.load(std::memory_order_relaxed);
+               });
+            if (!cancelled && !poll(total))
+               cancelled = true;
+         }
+         try
+         {
+            future.get();
+         }
+         catch (...)
+         {
+            if (!pException)
+               pException = std::current_exception();
+         }
+      }
+      if (pException)
+         std::rethrow_exception(pException);
+      if (cancelled)
+         throw UserException {};
+   }
+
    std::vector<std::shared_ptr<MIR::AnalyzedAudioClip>> analyzedClips;
    analyzedClips.reserve(readers.size());
-   std::transform(
-      readers.begin(), readers.end(), std::back_inserter(analyzedClips),
-      [&](const std::shared_ptr<ClipMirAudioReader>& reader) {
-         const MIR::ProjectSyncInfoInput input {
-            *reader,      reader->filename, reader->tags,       reportProgress,
-            projectTempo, projectWasEmpty,  isBeatsAndMeasures,
-         };
-         auto syncInfo = MIR::GetProjectSyncInfo(input);
-         ++count;
-         return std::make_shared<AnalyzedWaveClip>(reader, syncInfo);
-      });
+   for (size_t i = 0; i < readers.size(); ++i)
+      analyzedClips.push_back(
+         std::make_shared<AnalyzedWaveClip>(readers[i], syncInfos[i]));
    return analyzedClips;
 }
+
+//! Conform imported tracks to the project tempo
+//! @return a reader of the lone imported wave track if there is one, for
+//! tempo detection; else null
+std::shared_ptr<ClipMirAudioReader> PrepareImportedTracks(
+   AudacityProject& project, const FilePath& fileName,
+   const TrackHolders& newTracks,
+   std::optional<LibFileFormats::AcidizerTags> acidTags)
+{
+   const auto projectTempo = ProjectTimeSignature::Get(project).GetTempo();
+   for (auto track : newTracks)
+      DoProjectTempoChange(*track, projectTempo);
+
+   if (newTracks.size() == 1)
+   {
+      if (const auto waveTrack = dynamic_cast<WaveTrack*>(newTracks[0].get()))
+         return std::make_shared<ClipMirAudioReader>(
+            std::move(acidTags), fileName.ToStdString(), *waveTrack);
+   }
+   return nullptr;
+}
 } // namespace
 
 bool ProjectFileManager::Import(
-   const std::vector<FilePath>& fileNames, bool addToHistory)
+   const std::vector<FilePath>& fileNames, bool addToHistory,
+   const std::optional<ImportTimeRange>& timeRange)
 {
+   using ImportResult = ImportProgressListener::ImportResult;
+   auto &project = mProject;
    const auto projectWasEmpty =
-      TrackList::Get(mProject).Any<WaveTrack>().empty();
+      TrackList::Get(project).Any<WaveTrack>().empty();
    std::vector<std::shared_ptr<ClipMirAudioReader>> resultingReaders;
+
+   // Decode the files that allow it all at once; the others, and those that
+   // failed, are imported one at a time below, which reports the errors
+   std::vector<Importer::ImportJob> jobs;
+   auto concurrentResult = ImportResult::Success;
+   // Concurrent import decodes whole files
+   if (fileNames.size() > 1 && !timeRange) {
+      for (const auto &fileName : fileNames) {
+         auto tags = std::make_shared<Tags>();
+         tags->Clear();
+         jobs.push_back({ fileName, std::move(tags) });
+      }
+      ImportProgress importProgress(project);
+      BulkWriteScope bulkWrite{ project };
+      concurrentResult = Importer::Get().ImportConcurrently(
+         project, jobs, &importProgress, &WaveTrackFactory::Get(project));
+      if (concurrentResult == ImportResult::Cancelled)
+         return false;
+   }
+
+   // Add the tracks in the order of the files, as if imported one at a time
+   const auto addJob = [&](Importer::ImportJob &job,
+      std::shared_ptr<ClipMirAudioReader>& resultingReader) {
+      auto newTags = Tags::Get(project).Duplicate();
+      newTags->Merge(*job.tags);
+      Tags::Set(project, newTags);
+      resultingReader = PrepareImportedTracks(
+         project, job.fileName, job.tracks, std::move(job.acidTags));
+      if (addToHistory)
+         FileHistory::Global().Append(job.fileName);
+      // PRL: Undo history is incremented inside this:
+      AddImportedTracks(job.fileName, std::move(job.tracks));
+   };
+
+   size_t iFile = 0;
    const auto success = std::all_of(
       fileNames.begin(), fileNames.end(), [&](const FilePath& fileName) {
          std::shared_ptr<ClipMirAudioReader> resultingReader;
-         const auto success = Import(fileName, addToHistory, resultingReader);
+         auto success = true;
+         if (jobs.empty())
+            success =
+               Import(fileName, addToHistory, resultingReader, timeRange);
+         else if (auto &job = jobs[iFile++]; job.imported)
+            addJob(job, resultingReader);
+         // After the user stopped, import no more files
+         else if (concurrentResult == ImportResult::Success)
+            success = Import(fileName, addToHistory, resultingReader, {});
          if (success && resultingReader)
             resultingReaders.push_back(std::move(resultingReader));
          return success;
@@ -1433,7 +1580,8 @@ bool ProjectFileManager::Import(
 // If pNewTrackList is passed in non-NULL, it gets filled with the pointers to NEW tracks.
 bool ProjectFileManager::Import(
    const FilePath& fileName, bool addToHistory,
-   std::shared_ptr<ClipMirAudioReader>& resultingReader)
+   std::shared_ptr<ClipMirAudioReader>& resultingReader,
+   const std::optional<ImportTimeRange>& timeRange)
 {
    auto &project = mProject;
    auto &projectFileIO = ProjectFileIO::Get(project);
@@ -1502,9 +1650,15 @@ bool ProjectFileManager::Import(
 
       ImportProgress importProgress(project);
       std::optional<LibFileFormats::AcidizerTags> acidTags;
-      bool success = Importer::Get().Import(
-         project, fileName, &importProgress, &WaveTrackFactory::Get(project),
-         newTracks, newTags.get(), acidTags, errorMessage);
+      bool success = false;
+      {
+         // Commit the imported sample blocks in large groups rather than
+         // one at a time
+         BulkWriteScope bulkWrite{ project };
+         success = Importer::Get().Import(
+            project, fileName, &importProgress, &WaveTrackFactory::Get(project),
+            newTracks, newTags.get(), acidTags, errorMessage, timeRange);
+      }
       if (!errorMessage.empty()) {
          // Error message derived from Importer::Import
          // Additional help via a Help button links to the manual.
@@ -1514,17 +1668,8 @@ bool ProjectFileManager::Import(
       if (!success)
          return false;
 
-      const auto projectTempo = ProjectTimeSignature::Get(project).GetTempo();
-      for (auto track : newTracks)
-         DoProjectTempoChange(*track, projectTempo);
-
-      if (newTracks.size() == 1)
-      {
-         if (const auto waveTrack = dynamic_cast<WaveTrack*>(newTracks[0].get()))
-            resultingReader.reset(new ClipMirAudioReader {
-               std::move(acidTags), fileName.ToStdString(),
-               *waveTrack });
-      }
+      resultingReader = PrepareImportedTracks(
+         project, fileName, newTracks, std::move(acidTags));
 
       if (addToHistory) {
          FileHistory::Global().Append(fileName);
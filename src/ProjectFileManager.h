@@ -13,10 +13,12 @@ Paul Licameli split from AudacityProject.h
 
 #include <functional>
 #include <memory>
+#include <optional>
 #include <vector>
 
 #include "ClientData.h" // to inherit
 #include "FileNames.h" // for FileType
+#include "ImportForwards.h" // for ImportTimeRange
 
 class wxString;
 class wxFileName;
@@ -95,9 +97,12 @@ public:
    static AudacityProject *OpenFile( const ProjectChooserFn &chooser,
       const FilePath &fileName, bool addtohistory = true);
 
+   //! @param timeRange if given, import only that interval of each file
    bool
-   Import(const std::vector<FilePath>& fileNames, bool addToHistory = true);
-   bool Import(const FilePath& fileName, bool addToHistory = true);
+   Import(const std::vector<FilePath>& fileNames, bool addToHistory = true,
+      const std::optional<ImportTimeRange>& timeRange = {});
+   bool Import(const FilePath& fileName, bool addToHistory = true,
+      const std::optional<ImportTimeRange>& timeRange = {});
 
    void Compact();
 
@@ -120,7 +125,8 @@ public:
 private:
    bool Import(
       const FilePath& fileName, bool addToHistory,
-      std::shared_ptr<ClipMirAudioReader>& resultingReader);
+      std::shared_ptr<ClipMirAudioReader>& resultingReader,
+      const std::optional<ImportTimeRange>& timeRange);
 
    /*!
     @param fileName a path assumed to exist and contain an .aup3 project
@@ -528,6 +528,12 @@ void ProjectManager::OnCloseWindow(wxCloseEvent & event)
       }
    }
 
+   // Audio pasted from this project into others may still be read from its
+   // blocks, until they copy it; finish that before the connection closes
+   for (auto pProject : AllProjects{})
+      if (pProject.get() != &mProject)
+         ProjectFileIO::Get(*pProject).MaterializeDeferredBlocks();
+
    // JKC: For Win98 and Linux do not detach the menu bar.
    // We want wxWidgets to clean it up for us.
    // TODO: Is there a Mac issue here??
@@ -541,6 +547,9 @@ void ProjectManager::OnCloseWindow(wxCloseEvent & event)
    projectFileIO.SetBypass();
 
    {
+      // Mixers kept for the next playback also hold the tracks
+      ProjectAudioIO::Get( project ).ReleaseWarmMixers();
+
       // This can reduce reference counts of sample blocks in the project's
       // tracks.
       UndoManager::Get( project ).ClearStates();
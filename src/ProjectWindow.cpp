@@ -461,6 +461,8 @@ struct Adapter final : ViewportCallbacks {
    { if (mwWindow) mwWindow->SetMinimized(track, minimized); }
    int GetTrackHeight(const Track &track) override
    { return mwWindow ? mwWindow->GetTrackHeight(track) : 0; }
+   int GetTrackTop(const Track &track) override
+   { return mwWindow ? mwWindow->GetTrackTop(track) : 0; }
    void SetChannelHeights(Track &track, unsigned height) override
    { if (mwWindow) mwWindow->SetChannelHeights(track, height); }
    int GetTotalHeight(const TrackList &trackList) override
@@ -719,6 +721,11 @@ int ProjectWindow::GetTrackHeight(const Track &track)
    return ChannelView::GetChannelGroupHeight(&track);
 }
 
+int ProjectWindow::GetTrackTop(const Track &track)
+{
+   return ChannelView::Get(*track.GetChannel(0)).GetCumulativeHeightBefore();
+}
+
 int ProjectWindow::GetTotalHeight(const TrackList &trackList)
 {
    return ChannelView::GetTotalHeight(trackList);
@@ -129,6 +129,7 @@ public:
    bool IsTrackMinimized(const Track &track) ;
    void SetMinimized(Track &track, bool minimized) ;
    int GetTrackHeight(const Track &track) ;
+   int GetTrackTop(const Track &track) ;
    void SetChannelHeights(Track &track, unsigned height) ;
    int GetTotalHeight(const TrackList &trackList) ;
    int GetHorizontalThumbPosition() const ;
@@ -12,7 +12,67 @@
 #include "AudioIO.h"
 #include "Mix.h"
 
+#include <chrono>
+
 namespace {
+//! Predicts where scrubbing goes from the velocity of the scrub position, so
+//! that samples there are read before they are played
+class ScrubPredictor
+{
+public:
+   using Clock = std::chrono::steady_clock;
+
+   //! Real seconds ahead to predict
+   static constexpr double Lookahead = 0.5;
+   //! Sequence seconds to prefetch around the predicted range
+   static constexpr double Margin = 1.0;
+
+   void Reset()
+   {
+      mHasLast = mHasRange = false;
+      mVelocity = 0;
+   }
+
+   //! Request the next range, even if not moving, as when the last request
+   //! was not taken
+   void Forget() { mHasRange = false; }
+
+   //! Note a polled position; returns whether [t0, t1] should be prefetched,
+   //! which happens when the predicted range leaves the one last prefetched
+   bool Update(double position, Clock::time_point now,
+      double &t0, double &t1)
+   {
+      if (mHasLast) {
+         const auto dt =
+            std::chrono::duration<double>(now - mLastTime).count();
+         if (dt > 0)
+            // Smooth the jitter of mouse positions
+            mVelocity = (mVelocity + (position - mLastPosition) / dt) / 2;
+      }
+      mHasLast = true;
+      mLastPosition = position;
+      mLastTime = now;
+
+      const auto predicted = position + mVelocity * Lookahead;
+      const auto lo = std::min(position, predicted);
+      const auto hi = std::max(position, predicted);
+      if (mHasRange && lo >= mT0 && hi <= mT1)
+         return false;
+      mHasRange = true;
+      t0 = mT0 = lo - Margin;
+      t1 = mT1 = hi + Margin;
+      return true;
+   }
+
+private:
+   Clock::time_point mLastTime;
+   double mLastPosition{};
+   double mVelocity{};
+   double mT0{}, mT1{};
+   bool mHasLast{ false };
+   bool mHasRange{ false };
+};
+
 struct ScrubQueue : NonInterferingBase
 {
    static ScrubQueue Instance;
@@ -25,6 +85,7 @@ struct ScrubQueue : NonInterferingBase
    {
       mRate = rate;
       mStartTime = t0;
+      mPredictor.Reset();
       const double t1 = options.bySpeed ? options.initSpeed : t0;
       Update( t1, options );
 
@@ -37,6 +98,17 @@ struct ScrubQueue : NonInterferingBase
    {
       // Called by another thread
       mMessage.Write({ end, options });
+
+      // Begin reading where the scrub is headed, so that a jump does not
+      // wait for storage
+      const auto position = options.bySpeed ? LastTrackTime() : end;
+      double t0, t1;
+      if (mPredictor.Update(position, ScrubPredictor::Clock::now(), t0, t1)) {
+         const auto gAudioIO = AudioIO::Get();
+         if (!(gAudioIO && gAudioIO->PrefetchPlayback(
+            std::max(options.minTime, t0), std::min(options.maxTime, t1))))
+            mPredictor.Forget();
+      }
    }
 
    void Get(sampleCount &startSample, sampleCount &endSample,
@@ -285,6 +357,8 @@ private:
    };
    MessageBuffer<Message> mMessage;
    sampleCount mAccumulatedSeekDuration{};
+   //! Used only by the thread that calls Update()
+   ScrubPredictor mPredictor;
 };
 
 ScrubQueue ScrubQueue::Instance;
@@ -343,6 +417,12 @@ ScrubbingPlaybackPolicy::SuggestedBufferTimes(PlaybackSchedule &)
    };
 }
 
+bool ScrubbingPlaybackPolicy::AllowDirectPlayback( PlaybackSchedule & )
+{
+   // Scrubbing may jump anywhere, to material not resident
+   return false;
+}
+
 bool ScrubbingPlaybackPolicy::AllowSeek( PlaybackSchedule & )
 {
    // While scrubbing, ignore seek requests
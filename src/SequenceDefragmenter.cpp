@@ -0,0 +1,125 @@
+/**********************************************************************
+
+Audacity: A Digital Audio Editor
+
+@file SequenceDefragmenter.cpp
+@brief Attaches an idle time merger of undersized sample blocks to each
+project
+
+**********************************************************************/
+
+#include "AppEvents.h"
+#include "AudioIOBase.h"
+#include "ClientData.h"
+#include "Internat.h"
+#include "Observer.h"
+#include "Project.h"
+#include "ProjectHistory.h"
+#include "ProjectWindows.h"
+#include "Sequence.h"
+#include "UndoManager.h"
+#include "WaveTrackUtilities.h"
+#include <wx/frame.h>
+#include <wx/log.h>
+
+namespace {
+//! Samples that may be rewritten in one idle event
+constexpr size_t IdleBudget = 1 << 21;
+
+//! After edits, rewrites runs of the small blocks that cutting and pasting
+//! leave, a bounded amount at each idle event, and modifies the current undo
+//! state, so that undo and redo and crash recovery see the same samples
+struct SequenceDefragmenter : ClientData::Base {
+   SequenceDefragmenter(AudacityProject &project)
+      : mProject{ project }
+   {
+      mUndoSubscription = UndoManager::Get(project).Subscribe(
+      [this](const UndoRedoMessage &message){
+         switch (message.type) {
+         // Not Modified, which the commits here cause; nor UndoOrRedo, so
+         // that older states are not rewritten over again
+         case UndoRedoMessage::Pushed:
+         case UndoRedoMessage::Reset:
+            mPending = true;
+            break;
+         default:
+            break;
+         }
+      });
+      mIdleSubscription = AppEvents::OnAppIdle([this]{ OnIdle(); });
+   }
+
+   void OnIdle()
+   {
+      if (!mPending || !MayRun())
+         return;
+
+      auto budget = IdleBudget;
+      bool exhausted = false;
+      auto statistics = mStatistics;
+      auto commit = [&]{
+         if (statistics.blocksBefore == mStatistics.blocksBefore)
+            return;
+         mStatistics = statistics;
+         // this might fail and throw
+         ProjectHistory::Get(mProject).ModifyState(true);
+      };
+      try {
+         exhausted = WaveTrackUtilities::Defragment(
+            TrackList::Get(mProject), budget, statistics);
+      }
+      catch (...) {
+         // Keep what was rewritten, which holds the same samples, and try
+         // again after another edit
+         mPending = false;
+         commit();
+         throw;
+      }
+      commit();
+      if (!exhausted) {
+         mPending = false;
+         Report();
+      }
+   }
+
+   //! Stay out of the way of modal dialogs, dragging, and streams
+   bool MayRun() const
+   {
+      const auto pFrame = FindProjectFrame(&mProject);
+      if (!pFrame || !pFrame->IsEnabled() || wxWindow::GetCapture())
+         return false;
+      const auto gAudioIO = AudioIOBase::Get();
+      return !(gAudioIO && gAudioIO->IsBusy());
+   }
+
+   void Report()
+   {
+      if (mStatistics.blocksBefore == 0)
+         return;
+      const auto reclaimed =
+         mStatistics.spaceBefore > mStatistics.spaceAfter
+            ? mStatistics.spaceBefore - mStatistics.spaceAfter
+            : 0ull;
+      // Replaced blocks are freed only when no undo state, or saved version
+      // of the project, still uses them
+      wxLogInfo(
+         wxT("Defragmented %llu sample blocks into %llu; %s reclaimable"),
+         static_cast<unsigned long long>(mStatistics.blocksBefore),
+         static_cast<unsigned long long>(mStatistics.blocksAfter),
+         Internat::FormatSize(static_cast<double>(reclaimed)).Translation());
+      mStatistics = {};
+   }
+
+   AudacityProject &mProject;
+   DefragmentStatistics mStatistics;
+   Observer::Subscription mUndoSubscription;
+   Observer::Subscription mIdleSubscription;
+   bool mPending{ false };
+};
+}
+
+static AudacityProject::AttachedObjects::RegisteredFactory sKey {
+   []( AudacityProject &project ) {
+      return std::make_shared<SequenceDefragmenter>(project);
+   }
+};
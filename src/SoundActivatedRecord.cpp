@@ -21,6 +21,7 @@
 
 #include "SoundActivatedRecord.h"
 
+#include "AudioIO.h"
 #include "ShuttleGui.h"
 #include "Prefs.h"
 #include "Decibels.h"
@@ -70,6 +71,7 @@ void SoundActivatedRecordDialog::OnOK(wxCommandEvent & WXUNUSED(event))
    PopulateOrExchange( S );
 
    gPrefs->Flush();
+   PrefsListener::Broadcast(AudioIOPrefsID());
 
    EndModal(0);
 }
@@ -14,10 +14,13 @@
 *//*******************************************************************/
 
 #include <iostream>
+#include <map>
+#include <set>
 #include "FFT.h"
 #include "ProjectHistory.h"
 #include "SpectralDataManager.h"
 #include "WaveTrack.h"
+#include "concurrency/ThreadPool.h"
 
 SpectralDataManager::SpectralDataManager()= default;
 
@@ -170,15 +173,136 @@ bool SpectralDataManager::Worker::DoFinish() {
 bool SpectralDataManager::Worker::Process(const WaveChannel &channel,
    const std::shared_ptr<SpectralData> &pSpectralData)
 {
-   mpSpectralData = pSpectralData;
-   const auto hopSize = mpSpectralData->GetHopSize();
-   const auto startSample = mpSpectralData->GetStartSample();
-   // Correct the first hop num, because SpectrumTransformer will send
-   // a few initial windows that overlay the range only partially
-   mStartHopNum = startSample / hopSize - (mStepsPerWindow - 1);
-   mWindowCount = 0;
-   return TrackSpectrumTransformer::Process(Processor, channel, 1,
-      mpSpectralData->GetCorrectedStartSample(), mpSpectralData->GetLength());
+   // The output is the input, less the removed bins of each edited window;
+   // unedited windows would reconstruct the input by overlap-add, so they
+   // are not transformed at all
+   const long long hopSize = pSpectralData->GetHopSize();
+   wxASSERT(hopSize == static_cast<long long>(mStepSize));
+   const auto first = pSpectralData->GetCorrectedStartSample();
+   const auto len = pSpectralData->GetLength();
+   if (len <= 0)
+      return true;
+   const long long windowSize = mWindowSize;
+   // Where the window of hop 0 starts, so that the first full window is
+   // centered at the start of the data, as in the streaming transform
+   const auto offset = first - pSpectralData->GetStartSample();
+
+   // Merge all strokes, keeping only windows that the transform would take
+   Edits edits;
+   {
+      std::map<long long, std::set<int>> bins;
+      for (const auto &stroke : pSpectralData->dataHistory)
+         for (const auto &[hop, hopBins] : stroke) {
+            const auto start = hop * hopSize + offset;
+            if (!hopBins.empty() &&
+                start >= first - windowSize + hopSize && start < first + len)
+               bins[hop].insert(hopBins.begin(), hopBins.end());
+         }
+      for (auto &[hop, hopBins] : bins)
+         edits.emplace_back(
+            hop, std::vector<int>(hopBins.begin(), hopBins.end()));
+   }
+
+   // Segments of output are independent, because each one also transforms
+   // the edited windows overlapping its ends
+   constexpr size_t SegmentSize = 1 << 18;
+   auto &pool = audacity::concurrency::ThreadPool::GetDefault();
+   // A worker of the pool would do all jobs itself, so don't buffer more
+   // segments then
+   const auto nJobs =
+      pool.IsWorkerThread() ? 1 : std::max<size_t>(1, pool.GetThreadsCount());
+   struct Job {
+      long long start;
+      size_t len;
+      FloatVector input, output;
+   };
+   std::vector<Job> jobs(nJobs);
+   const auto end = first + len;
+   for (auto start = first; start < end;) {
+      // Read in this thread, so that no two threads read the same blocks
+      size_t nn = 0;
+      for (; nn < nJobs && start < end; ++nn, start += SegmentSize) {
+         auto &job = jobs[nn];
+         job.start = start;
+         job.len = std::min<long long>(SegmentSize, end - start);
+         job.input.assign(job.len + 2 * mWindowSize, 0.0f);
+         job.output.resize(job.len);
+         const auto readStart = std::max(first, start - windowSize);
+         const auto readEnd =
+            std::min<long long>(end, start + job.len + windowSize);
+         channel.GetFloats(
+            job.input.data() + (readStart - (start - windowSize)),
+            readStart, readEnd - readStart);
+      }
+
+      pool.ParallelFor(nn, [&](size_t ii){
+         auto &job = jobs[ii];
+         ApplyEdits(edits, offset, job.input, job.start, job.len, job.output);
+      });
+
+      for (size_t ii = 0; ii < nn; ++ii)
+         TrackSpectrumTransformer::DoOutput(
+            jobs[ii].output.data(), jobs[ii].len);
+   }
+   return true;
+}
+
+void SpectralDataManager::Worker::ApplyEdits(const Edits &edits,
+   long long offset, const FloatVector &input, long long first, size_t len,
+   FloatVector &output) const
+{
+   const long long windowSize = mWindowSize;
+   const auto &inWindow = InWindow();
+   const auto &outWindow = OutWindow();
+   std::copy(input.begin() + mWindowSize, input.begin() + mWindowSize + len,
+      output.begin());
+
+   // Edited windows overlapping [first, first + len)
+   const auto hopSize = static_cast<long long>(mStepSize);
+   // Less one, for division rounding toward zero
+   const auto firstHop = (first - windowSize - offset) / hopSize - 1;
+   auto iter = std::lower_bound(edits.begin(), edits.end(), firstHop,
+      [](const auto &edit, long long hop){ return edit.first < hop; });
+   if (iter == edits.end())
+      return;
+
+   RealFFTPlan fft{ mWindowSize };
+   PffftFloatVector frame(mWindowSize), removed(mWindowSize);
+   for (; iter != edits.end(); ++iter) {
+      const auto &[hop, bins] = *iter;
+      const auto start = hop * hopSize + offset;
+      if (start >= first + static_cast<long long>(len))
+         break;
+      if (start + windowSize <= first)
+         continue;
+
+      // The windowed frame, as the streaming transform takes it
+      const auto pInput = input.data() + (start - (first - windowSize));
+      for (size_t ii = 0; ii < mWindowSize; ++ii)
+         frame[ii] = inWindow.empty() ? pInput[ii] : pInput[ii] * inWindow[ii];
+      fft.Forward(frame.data());
+
+      // Keep only the bins to remove; bin 0 stands for the DC and Nyquist
+      // coefficients both
+      std::fill(removed.begin(), removed.end(), 0.0f);
+      for (const auto bin : bins) {
+         if (bin < 0 || bin >= static_cast<int>(mWindowSize / 2))
+            continue;
+         removed[2 * bin] = frame[2 * bin];
+         removed[2 * bin + 1] = frame[2 * bin + 1];
+      }
+      fft.Inverse(removed.data());
+
+      // Subtract their share of the overlap-add
+      const auto lo = std::max(first, start);
+      const auto hi =
+         std::min(first + static_cast<long long>(len), start + windowSize);
+      for (auto pos = lo; pos < hi; ++pos) {
+         const auto ii = pos - start;
+         output[pos - first] -= outWindow.empty()
+            ? removed[ii] : removed[ii] * outWindow[ii];
+      }
+   }
 }
 
 int SpectralDataManager::Worker::ProcessSnapping(const WaveChannel &channel,
@@ -298,44 +422,6 @@ bool SpectralDataManager::Worker::OvertonesProcessor(SpectrumTransformer &transf
    return true;
 }
 
-bool SpectralDataManager::Worker::Processor(SpectrumTransformer &transformer)
-{
-   auto &worker = static_cast<Worker &>(transformer);
-   // Compute power spectrum in the newest window
-   {
-      MyWindow &record = worker.NthWindow(0);
-      float *pSpectrum = &record.mSpectrums[0];
-      const double dc = record.mRealFFTs[0];
-      *pSpectrum++ = dc * dc;
-      float *pReal = &record.mRealFFTs[1], *pImag = &record.mImagFFTs[1];
-      for (size_t nn = worker.mSpectrumSize - 2; nn--;) {
-         const double re = *pReal++, im = *pImag++;
-         *pSpectrum++ = re * re + im * im;
-      }
-      const double nyquist = record.mImagFFTs[0];
-      *pSpectrum = nyquist * nyquist;
-   }
-
-   worker.ApplyEffectToSelection();
-   return true;
-}
-
-bool SpectralDataManager::Worker::ApplyEffectToSelection() {
-   auto &record = NthWindow(0);
-
-   for(auto &spectralDataMap: mpSpectralData->dataHistory){
-      // For all added frequency
-      for(const int &freqBin: spectralDataMap[mStartHopNum]){
-         record.mRealFFTs[freqBin] = 0;
-         record.mImagFFTs[freqBin] = 0;
-      }
-   }
-
-   mWindowCount++;
-   mStartHopNum ++;
-   return true;
-}
-
 auto SpectralDataManager::Worker::NewWindow(size_t windowSize)
 -> std::unique_ptr<Window>
 {
@@ -73,20 +73,30 @@ protected:
    }
    std::unique_ptr<Window> NewWindow(size_t windowSize) override;
    bool DoStart() override;
-   static bool Processor(SpectrumTransformer &transformer);
    static bool OvertonesProcessor(SpectrumTransformer &transformer);
    static bool SnappingProcessor(SpectrumTransformer &transformer);
    bool DoFinish() override;
 
 private:
-   bool ApplyEffectToSelection();
-   std::shared_ptr<SpectralData> mpSpectralData;
-   int mWindowCount { 0 };
+   //! Frequency bins to remove, by hop number, in increasing hop order
+   using Edits = std::vector<std::pair<long long, std::vector<int>>>;
+
+   //! Subtract from samples the removed bins of the edited windows that
+   //! overlap them
+   /*!
+    @param input samples from `first - mWindowSize`, zero outside the range
+    processed
+    @param offset where the window of hop 0 starts
+    @param[out] output `len` samples from `first`
+    */
+   void ApplyEdits(const Edits &edits, long long offset,
+      const FloatVector &input, long long first, size_t len,
+      FloatVector &output) const;
+
    double mSnapSamplingRate;
    double mSnapThreshold;
    double mOvertonesThreshold;
    std::vector<int> mOvertonesTargetFreqBin;
    int mSnapTargetFreqBin;
    int mSnapReturnFreqBin { -1 };
-   long long mStartHopNum { 0 };
 };
@@ -26,6 +26,9 @@ and in the spectrogram spectral selection.
 #include "FFT.h"
 
 #include "SampleFormat.h"
+#include "concurrency/ThreadPool.h"
+#include <algorithm>
+#include <atomic>
 #include <wx/dcclient.h>
 
 FreqGauge::FreqGauge(wxWindow * parent, wxWindowID winid)
@@ -121,9 +124,7 @@ bool SpectrumAnalyst::Calculate(Algorithm alg, int windowFunc,
    auto half = mWindowSize / 2;
    mProcessed.resize(mWindowSize);
 
-   Floats in{ mWindowSize };
    Floats out{ mWindowSize };
-   Floats out2{ mWindowSize };
    Floats win{ mWindowSize };
 
    for (size_t i = 0; i < mWindowSize; i++) {
@@ -147,89 +148,128 @@ bool SpectrumAnalyst::Calculate(Algorithm alg, int windowFunc,
       progress->SetRange(dataLen);
    }
 
-   size_t start = 0;
-   int windows = 0;
-   while (start + mWindowSize <= dataLen) {
-      for (size_t i = 0; i < mWindowSize; i++)
-         in[i] = win[i] * data[start + i];
-
-      switch (alg) {
-         case Spectrum:
-            PowerSpectrum(mWindowSize, in.get(), out.get());
-
-            for (size_t i = 0; i < half; i++)
-               mProcessed[i] += out[i];
-            break;
-
-         case Autocorrelation:
-         case CubeRootAutocorrelation:
-         case EnhancedAutocorrelation:
-
-            // Take FFT
-            RealFFT(mWindowSize, in.get(), out.get(), out2.get());
-            // Compute power
-            for (size_t i = 0; i < mWindowSize; i++)
-               in[i] = (out[i] * out[i]) + (out2[i] * out2[i]);
-
-            if (alg == Autocorrelation) {
-               for (size_t i = 0; i < mWindowSize; i++)
-                  in[i] = sqrt(in[i]);
-            }
-            if (alg == CubeRootAutocorrelation ||
-                alg == EnhancedAutocorrelation) {
-               // Tolonen and Karjalainen recommend taking the cube root
-               // of the power, instead of the square root
+   // Windows overlap by half
+   const size_t windows = (dataLen - mWindowSize) / half + 1;
 
-               for (size_t i = 0; i < mWindowSize; i++)
-                  in[i] = pow(in[i], 1.0f / 3.0f);
-            }
-            // Take FFT
-            RealFFT(mWindowSize, in.get(), out.get(), out2.get());
-
-            // Take real part of result
-            for (size_t i = 0; i < half; i++)
-               mProcessed[i] += out[i];
-            break;
-
-         case Cepstrum:
-            RealFFT(mWindowSize, in.get(), out.get(), out2.get());
-
-            // Compute log power
-            // Set a sane lower limit assuming maximum time amplitude of 1.0
-            {
-               float power;
-               float minpower = 1e-20*mWindowSize*mWindowSize;
-               for (size_t i = 0; i < mWindowSize; i++)
-               {
-                  power = (out[i] * out[i]) + (out2[i] * out2[i]);
-                  if(power < minpower)
-                     in[i] = log(minpower);
-                  else
-                     in[i] = log(power);
+   // Sum the results for a range of windows; independent of other ranges,
+   // so that ranges can be given to different threads
+   auto accumulate = [&, windowSize = mWindowSize]
+   (size_t firstWindow, size_t lastWindow, float *sums) {
+      Floats in{ windowSize };
+      Floats out{ windowSize };
+      Floats out2{ windowSize };
+
+      for (auto window = firstWindow; window < lastWindow; ++window) {
+         const auto start = window * half;
+         for (size_t i = 0; i < windowSize; i++)
+            in[i] = win[i] * data[start + i];
+
+         switch (alg) {
+            case Spectrum:
+               PowerSpectrum(windowSize, in.get(), out.get());
+
+               for (size_t i = 0; i < half; i++)
+                  sums[i] += out[i];
+               break;
+
+            case Autocorrelation:
+            case CubeRootAutocorrelation:
+            case EnhancedAutocorrelation:
+
+               // Take FFT
+               RealFFT(windowSize, in.get(), out.get(), out2.get());
+               // Compute power
+               for (size_t i = 0; i < windowSize; i++)
+                  in[i] = (out[i] * out[i]) + (out2[i] * out2[i]);
+
+               if (alg == Autocorrelation) {
+                  for (size_t i = 0; i < windowSize; i++)
+                     in[i] = sqrt(in[i]);
+               }
+               if (alg == CubeRootAutocorrelation ||
+                   alg == EnhancedAutocorrelation) {
+                  // Tolonen and Karjalainen recommend taking the cube root
+                  // of the power, instead of the square root
+
+                  for (size_t i = 0; i < windowSize; i++)
+                     in[i] = pow(in[i], 1.0f / 3.0f);
                }
-               // Take IFFT
-               InverseRealFFT(mWindowSize, in.get(), NULL, out.get());
+               // Take FFT
+               RealFFT(windowSize, in.get(), out.get(), out2.get());
 
                // Take real part of result
                for (size_t i = 0; i < half; i++)
-                  mProcessed[i] += out[i];
-            }
+                  sums[i] += out[i];
+               break;
 
-            break;
+            case Cepstrum:
+               RealFFT(windowSize, in.get(), out.get(), out2.get());
+
+               // Compute log power
+               // Set a sane lower limit assuming maximum time amplitude of 1.0
+               {
+                  float power;
+                  float minpower = 1e-20*windowSize*windowSize;
+                  for (size_t i = 0; i < windowSize; i++)
+                  {
+                     power = (out[i] * out[i]) + (out2[i] * out2[i]);
+                     if(power < minpower)
+                        in[i] = log(minpower);
+                     else
+                        in[i] = log(power);
+                  }
+                  // Take IFFT
+                  InverseRealFFT(windowSize, in.get(), NULL, out.get());
+
+                  // Take real part of result
+                  for (size_t i = 0; i < half; i++)
+                     sums[i] += out[i];
+               }
 
-         default:
-            wxASSERT(false);
-            break;
-      }                         //switch
+               break;
 
-      // Update the progress bar
-      if (progress) {
-         progress->SetValue(start);
+            default:
+               wxASSERT(false);
+               break;
+         }                         //switch
+      }
+   };
+
+   // Divide the windows into ranges for the threads of the pool and this
+   // thread; each range sums into its own partial sums, except the first,
+   // which sums into the result
+   auto &pool = audacity::concurrency::ThreadPool::GetDefault();
+   const auto nThreads = pool.IsWorkerThread() ? 1 : pool.GetThreadsCount() + 1;
+   // Several ranges per thread, to balance the load and to update the
+   // progress often enough
+   constexpr size_t RangesPerThread = 4, MinWindowsPerRange = 8;
+   const auto windowsPerRange = std::max(MinWindowsPerRange,
+      (windows + nThreads * RangesPerThread - 1) / (nThreads * RangesPerThread));
+   const auto nRanges = nThreads == 1
+      ? 1 : (windows + windowsPerRange - 1) / windowsPerRange;
+   const auto rangeSize = nRanges == 1 ? windows : windowsPerRange;
+
+   std::vector<std::vector<float>> partials(
+      nRanges - 1, std::vector<float>(half));
+   // Ranges go to whichever thread is free; this thread updates the progress
+   // bar between its ranges
+   std::atomic<size_t> nextRange{ 0 }, doneRanges{ 0 };
+   pool.ParallelFor(std::min(nThreads, nRanges), [&](size_t slot){
+      for (size_t range; (range = nextRange++) < nRanges;) {
+         const auto first = range * rangeSize;
+         const auto last = std::min(windows, first + rangeSize);
+         accumulate(first, last,
+            range == 0 ? mProcessed.data() : partials[range - 1].data());
+         const auto done = ++doneRanges;
+         if (slot == 0 && progress)
+            progress->SetValue(std::min(windows, done * rangeSize) * half);
       }
+   });
 
-      start += half;
-      windows++;
-   }
+   // Reduce in a fixed order, so results do not depend on the timing
+   for (const auto &sums : partials)
+      for (size_t i = 0; i < half; i++)
+         mProcessed[i] += sums[i];
 
    if (progress) {
       // Reset for next time
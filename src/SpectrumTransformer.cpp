@@ -25,7 +25,7 @@ SpectrumTransformer::SpectrumTransformer( bool needsOutput,
 , mStepSize{ mWindowSize / mStepsPerWindow }
 , mLeadingPadding{ leadingPadding }
 , mTrailingPadding{ trailingPadding }
-, hFFT{ GetFFT(mWindowSize) }
+, mFFT{ mWindowSize }
 , mFFTBuffer( mWindowSize )
 , mInWaveBuffer( mWindowSize )
 , mOutOverlapBuffer( mWindowSize )
@@ -211,7 +211,7 @@ void SpectrumTransformer::FillFirstWindow()
       else
          memmove(pFFTBuffer, pInWaveBuffer, mWindowSize * sizeof(float));
    }
-   RealFFTf(mFFTBuffer.data(), hFFT.get());
+   mFFT.Forward(mFFTBuffer.data());
 
    auto &record = Nth(0);
 
@@ -219,12 +219,11 @@ void SpectrumTransformer::FillFirstWindow()
    {
       float *pReal = &record.mRealFFTs[1];
       float *pImag = &record.mImagFFTs[1];
-      int *pBitReversed = &hFFT->BitReversed[1];
+      const float *pFFTBuffer = &mFFTBuffer[2];
       const auto last = mSpectrumSize - 1;
       for (size_t ii = 1; ii < last; ++ii) {
-         const int kk = *pBitReversed++;
-         *pReal++ = mFFTBuffer[kk];
-         *pImag++ = mFFTBuffer[kk + 1];
+         *pReal++ = *pFFTBuffer++;
+         *pImag++ = *pFFTBuffer++;
       }
       // DC and Fs/2 bins need to be handled specially
       const float dc = mFFTBuffer[0];
@@ -281,7 +280,6 @@ void SpectrumTransformer::OutputStep()
    if (!mNeedsOutput)
       return;
    if (QueueIsFull()) {
-      const auto last = mSpectrumSize - 1;
       Window &record = **mQueue.rbegin();
 
       const float *pReal = &record.mRealFFTs[1];
@@ -297,27 +295,21 @@ void SpectrumTransformer::OutputStep()
       mFFTBuffer[1] = record.mImagFFTs[0];
 
       // Invert the FFT into the output buffer
-      InverseRealFFTf(mFFTBuffer.data(), hFFT.get());
+      mFFT.Inverse(mFFTBuffer.data());
 
       // Overlap-add
       if (mOutWindow.size() > 0) {
          auto pOut = mOutOverlapBuffer.data();
          auto pWindow = mOutWindow.data();
-         auto pBitReversed = &hFFT->BitReversed[0];
-         for (size_t jj = 0; jj < last; ++jj) {
-            auto kk = *pBitReversed++;
-            *pOut++ += mFFTBuffer[kk] * (*pWindow++);
-            *pOut++ += mFFTBuffer[kk + 1] * (*pWindow++);
-         }
+         auto pFFTBuffer = mFFTBuffer.data();
+         for (size_t jj = 0; jj < mWindowSize; ++jj)
+            *pOut++ += *pFFTBuffer++ * (*pWindow++);
       }
       else {
          auto pOut = mOutOverlapBuffer.data();
-         auto pBitReversed = &hFFT->BitReversed[0];
-         for (size_t jj = 0; jj < last; ++jj) {
-            auto kk = *pBitReversed++;
-            *pOut++ += mFFTBuffer[kk];
-            *pOut++ += mFFTBuffer[kk + 1];
-         }
+         auto pFFTBuffer = mFFTBuffer.data();
+         for (size_t jj = 0; jj < mWindowSize; ++jj)
+            *pOut++ += *pFFTBuffer++;
       }
       auto buffer = mOutOverlapBuffer.data();
       if (mOutStepCount >= 0) {
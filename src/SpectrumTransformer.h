@@ -16,7 +16,7 @@ Paul Licameli
 #include <memory>
 #include <vector>
 #include "audacity/Types.h"
-#include "RealFFTf.h"
+#include "RealFFTPlan.h"
 #include "SampleCount.h"
 
 enum eWindowFunctions : int;
@@ -152,6 +152,11 @@ private:
    void OutputStep();
 
 protected:
+   //! The window functions, scaled so that overlap-add reconstructs the
+   //! input; empty if rectangular
+   const FloatVector &InWindow() const { return mInWindow; }
+   const FloatVector &OutWindow() const { return mOutWindow; }
+
    const size_t mWindowSize;
    const size_t mSpectrumSize;
 
@@ -164,13 +169,13 @@ protected:
 
 private:
    std::vector<std::unique_ptr<Window>> mQueue;
-   HFFT     hFFT;
+   RealFFTPlan mFFT;
    sampleCount mInSampleCount = 0;
    sampleCount mOutStepCount = 0; //!< sometimes negative
    size_t mInWavePos = 0;
 
    //! These have size mWindowSize:
-   FloatVector mFFTBuffer;
+   PffftFloatVector mFFTBuffer;
    FloatVector mInWaveBuffer;
    FloatVector mOutOverlapBuffer;
    //! These have size mWindowSize, or 0 for rectangular window:
@@ -47,6 +47,7 @@
 #include "ProjectFileManager.h"
 #include "ProjectManager.h"
 #include "ProjectRate.h"
+#include "QualitySettings.h"
 #include "ProjectWindows.h"
 #include "Project.h"
 #include "Prefs.h"
@@ -535,6 +536,15 @@ int TimerRecordDialog::RunWaitDialog()
          // Don't proceed, but don't treat it as canceled recording. User just canceled waiting.
          return POST_TIMER_RECORD_CANCEL_WAIT;
       } else {
+         // Reserve room for the whole duration, and checkpoint as it goes
+         const auto seconds =
+            m_TimeSpan_Duration.GetMilliseconds().ToDouble() / 1000;
+         ProjectFileIO::Get( mProject ).BeginLongRecording(
+            static_cast<int64_t>(seconds *
+               ProjectRate::Get( mProject ).GetRate() *
+               AudioIORecordChannels.Read() *
+               SAMPLE_SIZE(QualitySettings::SampleFormatChoice())));
+
          // Record for specified time.
          ProjectAudioManager::Get( mProject ).OnRecord(false);
          bool bIsRecording = true;
@@ -588,6 +598,7 @@ int TimerRecordDialog::RunWaitDialog()
    // Must do this AFTER the timer project dialog has been deleted to ensure the application
    // responds to the AUDIOIO events...see not about bug #334 in the ProgressDialog constructor.
    ProjectAudioManager::Get( mProject ).Stop();
+   ProjectFileIO::Get( mProject ).EndLongRecording();
 
    // Let the caller handle cancellation or failure from recording progress.
    if (updateResult == ProgressResult::Cancelled || updateResult == ProgressResult::Failed)
@@ -505,6 +505,7 @@ void TrackPanel::OnPaint(wxPaintEvent & /* event */)
       {
          // Reset (should a mutex be used???)
          mRefreshBacking = false;
+         mDirtyBacking = {};
 
          // Redraw the backing bitmap
          DrawTracks(&GetBackingDCForRepaint());
@@ -514,6 +515,17 @@ void TrackPanel::OnPaint(wxPaintEvent & /* event */)
       }
       else
       {
+         if (!mDirtyBacking.IsEmpty()) {
+            // Redraw only the tracks that were refreshed
+            auto partialSw = FrameStatistics::CreateStopwatch(
+               FrameStatistics::SectionID::TrackPanelPartial);
+            const auto dirty = mDirtyBacking;
+            mDirtyBacking = {};
+            auto &backingDC = GetBackingDCForRepaint();
+            wxDCClipper clipper{ backingDC, dirty };
+            DrawTracks(&backingDC, &dirty);
+            box.Union(dirty);
+         }
          // Copy full, possibly clipped, damage rectangle
          RepairBitmap(dc, box.x, box.y, box.width, box.height);
       }
@@ -788,8 +800,15 @@ void TrackPanel::RefreshTrack(Track *trk, bool refreshbacking)
 
    wxRect rect(left, top, width, height);
 
-   if( refreshbacking )
-      mRefreshBacking = true;
+   // Let OnPaint() redraw the backing bitmap only for this track, and for
+   // any others refreshed before it paints
+   if( refreshbacking ) {
+      const auto visible = rect.Intersect(GetClientRect());
+      if (mDirtyBacking.IsEmpty())
+         mDirtyBacking = visible;
+      else if (!visible.IsEmpty())
+         mDirtyBacking.Union(visible);
+   }
 
    Refresh( false, &rect );
 }
@@ -835,7 +854,7 @@ void TrackPanel::OnAudioIO(AudioIOEvent evt)
 /// Draw the actual track areas.  We only draw the borders
 /// and the little buttons and menues and whatnot here, the
 /// actual contents of each track are drawn by the TrackArtist.
-void TrackPanel::DrawTracks(wxDC * dc)
+void TrackPanel::DrawTracks(wxDC * dc, const wxRect *pClip)
 {
    wxRegion region = GetUpdateRegion();
 
@@ -878,7 +897,7 @@ void TrackPanel::DrawTracks(wxDC * dc)
    mTrackArtist->onBrushTool = brushFlag;
    mTrackArtist->hasSolo = hasSolo;
 
-   this->CellularPanel::Draw( context, TrackArtist::NPasses );
+   this->CellularPanel::Draw( context, TrackArtist::NPasses, pClip );
 }
 
 void TrackPanel::SetBackgroundCell
@@ -166,7 +166,9 @@ public:
    AdornedRulerPanel * GetRuler(){ return mRuler;}
 
 protected:
-   void DrawTracks(wxDC * dc);
+   //! Redraw into the backing bitmap, only where tracks intersect pClip if
+   //! it is not null
+   void DrawTracks(wxDC * dc, const wxRect *pClip = nullptr);
 
 public:
    // Set the object that performs catch-all event handling when the pointer
@@ -213,6 +215,9 @@ protected:
    int mTimeCount;
 
    bool mRefreshBacking;
+   //! Area of the backing bitmap to redraw, if not all of it, coalescing the
+   //! tracks that were refreshed since the last paint
+   wxRect mDirtyBacking;
 
 
 protected:
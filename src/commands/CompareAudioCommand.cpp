@@ -16,6 +16,10 @@
 \brief Returns information about the amount of audio that is about a certain
 threshold of difference in two selected tracks
 
+Pairs of channels are compared concurrently.  Where both channels read the
+same sample block at the same position, the samples are equal and are not
+read.  Given MaxErrors, the comparison stops once that many samples differ.
+
 *//*******************************************************************/
 
 
@@ -27,9 +31,16 @@ threshold of difference in two selected tracks
 #include "LoadCommands.h"
 #include "ViewInfo.h"
 #include "WaveTrack.h"
+#include "concurrency/ThreadPool.h"
 
-
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cmath>
 #include <float.h>
+#include <future>
+#include <vector>
 
 #include "SettingsVisitor.h"
 #include "ShuttleGui.h"
@@ -52,6 +63,7 @@ extern void RegisterCompareAudio( Registrar & R){
 template<bool Const>
 bool CompareAudioCommand::VisitSettings( SettingsVisitorBase<Const> & S ){
    S.Define( errorThreshold,  wxT("Threshold"),   0.0f,  0.0f,    0.01f,    1.0f );
+   S.OptionalN( bHasMaxErrors ).Define( mMaxErrors, wxT("MaxErrors"), 1, 1, INT_MAX );
    return true;
 }
 bool CompareAudioCommand::VisitSettings( SettingsVisitor & S )
@@ -69,6 +81,11 @@ void CompareAudioCommand::PopulateOrExchange(ShuttleGui & S)
       S.TieTextBox(XXO("Threshold:"),errorThreshold);
    }
    S.EndMultiColumn();
+   S.StartMultiColumn(3, wxALIGN_CENTER);
+   {
+      S.Optional( bHasMaxErrors ).TieNumericTextBox( XXO("Max Errors:"), mMaxErrors );
+   }
+   S.EndMultiColumn();
 }
 
 // Update member variables with project selection data (and validate)
@@ -106,14 +123,121 @@ bool CompareAudioCommand::GetSelection(const CommandContext &context, AudacityPr
    return true;
 }
 
-double CompareAudioCommand::CompareSample(double value1, double value2)
+namespace {
+//! Spans of track samples, sorted, where two channels are known to be equal
+using Spans = std::vector<std::pair<sampleCount, sampleCount>>;
+
+//! Find where both channels read the same sample block at the same position
+/*!
+ Clips with pitch or speed are rendered and never read directly, so they
+ are left out.  Blocks with equal summaries are not skipped, because equal
+ summaries do not imply equal samples.
+ */
+Spans SharedBlockSpans(const WaveChannel &channel0, const WaveChannel &channel1)
 {
-   return fabs(value1 - value2);
+   Spans spans;
+   for (const auto &pClip0 : channel0.Intervals()) {
+      if (pClip0->HasPitchOrSpeed())
+         continue;
+      for (const auto &pClip1 : channel1.Intervals()) {
+         if (pClip1->HasPitchOrSpeed())
+            continue;
+         const auto start = std::max(
+            pClip0->GetPlayStartSample(), pClip1->GetPlayStartSample());
+         const auto end = std::min(
+            pClip0->GetPlayEndSample(), pClip1->GetPlayEndSample());
+         const auto pBlocks0 = pClip0->GetSequenceBlockArray();
+         const auto pBlocks1 = pClip1->GetSequenceBlockArray();
+         if (start >= end || !pBlocks0 || !pBlocks1)
+            continue;
+
+         // Track samples where the sequences begin, before trimming
+         const auto origin0 = pClip0->GetPlayStartSample() -
+            pClip0->TimeToSamples(pClip0->GetTrimLeft());
+         const auto origin1 = pClip1->GetPlayStartSample() -
+            pClip1->TimeToSamples(pClip1->GetTrimLeft());
+
+         // Walk both block arrays in order of track samples
+         size_t ii = 0, jj = 0;
+         while (ii < pBlocks0->size() && jj < pBlocks1->size()) {
+            const auto &block0 = (*pBlocks0)[ii];
+            const auto &block1 = (*pBlocks1)[jj];
+            const auto begin0 = origin0 + block0.start;
+            const auto begin1 = origin1 + block1.start;
+            const auto end0 = begin0 + block0.sb->GetSampleCount();
+            const auto end1 = begin1 + block1.sb->GetSampleCount();
+            if (begin0 == begin1 && end0 == end1 &&
+                block0.sb->GetBlockID() == block1.sb->GetBlockID()) {
+               const auto first = std::max(begin0, start);
+               const auto last = std::min(end0, end);
+               if (first < last)
+                  spans.emplace_back(first, last);
+            }
+            if (end0 <= end1)
+               ++ii;
+            if (end1 <= end0)
+               ++jj;
+         }
+      }
+   }
+   std::sort(spans.begin(), spans.end());
+   return spans;
 }
 
-inline int min(int a, int b)
+//! Count samples differing by more than the threshold
+/*! Without branches, so that the compiler vectorizes the loop */
+long CountDifferences(
+   const float *buffer0, const float *buffer1, size_t len, double threshold)
 {
-   return (a < b) ? a : b;
+   long count = 0;
+   for (size_t ii = 0; ii < len; ++ii)
+      count += std::abs(double(buffer0[ii]) - double(buffer1[ii])) > threshold;
+   return count;
+}
+
+//! Compare one pair of channels in [s0, s1), adding to the shared counts
+/*! @param maxErrors if positive, stop when errors reaches it */
+void CompareChannels(const WaveChannel &channel0, const WaveChannel &channel1,
+   sampleCount s0, sampleCount s1, double threshold, long maxErrors,
+   std::atomic<long> &errors, std::atomic<long long> &compared)
+{
+   const auto spans = SharedBlockSpans(channel0, channel1);
+   auto pSpan = spans.begin();
+
+   const auto buffSize =
+      std::min(channel0.GetMaxBlockSize(), channel1.GetMaxBlockSize());
+   Floats buff0{ buffSize };
+   Floats buff1{ buffSize };
+
+   auto position = s0;
+   while (position < s1) {
+      if (maxErrors > 0 && errors.load(std::memory_order_relaxed) >= maxErrors)
+         break;
+
+      while (pSpan != spans.end() && pSpan->second <= position)
+         ++pSpan;
+      if (pSpan != spans.end() && pSpan->first <= position) {
+         // Equal samples; count them as compared without reading them
+         const auto next = std::min(pSpan->second, s1);
+         compared += (next - position).as_long_long();
+         position = next;
+         continue;
+      }
+      const auto limit =
+         pSpan != spans.end() ? std::min(pSpan->first, s1) : s1;
+
+      // Get a block of data into the buffers
+      const auto block = limitSampleBufferSize(
+         std::min(channel0.GetBestBlockSize(position), buffSize),
+         limit - position);
+      channel0.GetFloats(buff0.get(), position, block);
+      channel1.GetFloats(buff1.get(), position, block);
+      errors += CountDifferences(buff0.get(), buff1.get(), block, threshold);
+
+      position += block;
+      compared += block;
+   }
+}
 }
 
 bool CompareAudioCommand::Apply(const CommandContext & context)
@@ -128,47 +252,44 @@ bool CompareAudioCommand::Apply(const CommandContext & context)
       + mTrack1->GetName() + wxT("'.");
    context.Status(msg);
 
-   long errorCount = 0;
-   // Initialize buffers for track data to be analyzed
-   auto buffSize = std::min(mTrack0->GetMaxBlockSize(), mTrack1->GetMaxBlockSize());
+   std::atomic<long> errors{ 0 };
+   std::atomic<long long> compared{ 0 };
+   const long maxErrors = bHasMaxErrors ? mMaxErrors : 0;
 
-   Floats buff0{ buffSize };
-   Floats buff1{ buffSize };
-
-   // Compare tracks block by block
+   // Compare pairs of channels concurrently
    auto s0 = mTrack0->TimeToLongSamples(mT0);
    auto s1 = mTrack0->TimeToLongSamples(mT1);
-   const auto channels0 = mTrack0->Channels();
+   auto &pool = audacity::concurrency::ThreadPool::GetDefault();
+   std::vector<std::future<void>> futures;
    auto iter = mTrack1->Channels().begin();
-   for (const auto pChannel0 : channels0) {
+   for (const auto pChannel0 : mTrack0->Channels()) {
       const auto pChannel1 = *iter++;
-      auto position = s0;
-      auto length = s1 - s0;
-      while (position < s1) {
-         // Get a block of data into the buffers
-         auto block = limitSampleBufferSize(
-            pChannel0->GetBestBlockSize(position), s1 - position
-         );
-         pChannel0->GetFloats(buff0.get(), position, block);
-         pChannel1->GetFloats(buff1.get(), position, block);
-
-         for (decltype(block) buffPos = 0; buffPos < block; ++buffPos)
-            if (CompareSample(buff0[buffPos], buff1[buffPos]) > errorThreshold)
-               ++errorCount;
-
-         position += block;
-         context.Progress(
-            (position - s0).as_double() /
-            length.as_double()
-         );
-      }
+      futures.push_back(pool.Async(
+         [&, pChannel0, pChannel1]{
+            CompareChannels(*pChannel0, *pChannel1, s0, s1, errorThreshold,
+               maxErrors, errors, compared);
+         }));
    }
 
+   // Wait for all before any rethrows, because they use the counts
+   const auto length = (s1 - s0).as_double() * futures.size();
+   for (auto &future : futures)
+      while (future.wait_for(std::chrono::milliseconds(50)) !=
+             std::future_status::ready)
+         context.Progress(compared.load() / length);
+   for (auto &future : futures)
+      future.get();
+   context.Progress(1.0);
+
    // Output the results
+   long errorCount = errors.load();
    double errorSeconds = mTrack0->LongSamplesToTime(errorCount);
    context.Status(wxString::Format(wxT("%li"), errorCount));
    context.Status(wxString::Format(wxT("%.4f"), errorSeconds));
-   context.Status(wxString::Format(wxT("Finished comparison: %li samples (%.3f seconds) exceeded the error threshold of %f."), errorCount, errorSeconds, errorThreshold));
+   if (maxErrors > 0 && errorCount >= maxErrors)
+      context.Status(wxString::Format(wxT("Stopped comparison: at least %li samples exceeded the error threshold of %f."), errorCount, errorThreshold));
+   else
+      context.Status(wxString::Format(wxT("Finished comparison: %li samples (%.3f seconds) exceeded the error threshold of %f."), errorCount, errorSeconds, errorThreshold));
    return true;
 }
 
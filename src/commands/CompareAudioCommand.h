@@ -43,16 +43,14 @@ public:
 
 private:
    double errorThreshold;
+   int mMaxErrors;
+   bool bHasMaxErrors;
    double mT0, mT1;
    const WaveTrack *mTrack0;
    const WaveTrack *mTrack1;
 
    // Update member variables with project selection data (and validate)
    bool GetSelection(const CommandContext &context, AudacityProject &proj);
-
-protected:
-   double CompareSample(double value1, double value2) /* not override */;
-
 };
 
 #endif /* End of include guard: __COMPAREAUDIOCOMMAND__ */
@@ -0,0 +1,120 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  GetFrameStatisticsCommand.cpp
+
+**********************************************************************/
+#include "GetFrameStatisticsCommand.h"
+
+#include "CommandDispatch.h"
+#include "MenuRegistry.h"
+#include "LoadCommands.h"
+#include "CommandContext.h"
+#include "FrameStatistics.h"
+#include "SettingsVisitor.h"
+#include "ShuttleGui.h"
+
+const ComponentInterfaceSymbol GetFrameStatisticsCommand::Symbol
+{ XO("Get Frame Statistics") };
+
+namespace{ BuiltinCommandsModule::Registration< GetFrameStatisticsCommand > reg; }
+
+template<bool Const>
+bool GetFrameStatisticsCommand::VisitSettings( SettingsVisitorBase<Const> & S ){
+   S.Define( mReset, wxT("Reset"), false );
+   return true;
+}
+
+bool GetFrameStatisticsCommand::VisitSettings( SettingsVisitor & S )
+   { return VisitSettings<false>(S); }
+
+bool GetFrameStatisticsCommand::VisitSettings( ConstSettingsVisitor & S )
+   { return VisitSettings<true>(S); }
+
+void GetFrameStatisticsCommand::PopulateOrExchange(ShuttleGui & S)
+{
+   S.AddSpace(0, 5);
+
+   S.StartMultiColumn(2, wxALIGN_CENTER);
+   {
+      S.TieCheckBox(XXO("Reset after reporting"), mReset);
+   }
+   S.EndMultiColumn();
+}
+
+namespace {
+double ToMilliseconds(FrameStatistics::Duration duration)
+{
+   return std::chrono::duration<double, std::milli>(duration).count();
+}
+}
+
+bool GetFrameStatisticsCommand::Apply(const CommandContext & context)
+{
+   using Section = FrameStatistics::Section;
+
+   context.StartArray();
+   for (size_t i = 0; i < size_t(FrameStatistics::SectionID::Count); ++i) {
+      const auto id = FrameStatistics::SectionID(i);
+      const auto &section = FrameStatistics::GetSection(id);
+      const auto count = section.GetEventsCount();
+
+      context.StartStruct();
+      context.AddItem( wxString{ FrameStatistics::GetSectionName(id) }, "name" );
+      context.AddItem( double(count), "events" );
+      if (count > 0) {
+         context.AddItem( ToMilliseconds(section.GetLastDuration()), "last" );
+         context.AddItem( ToMilliseconds(section.GetMinDuration()), "min" );
+         context.AddItem( ToMilliseconds(section.GetMaxDuration()), "max" );
+         context.AddItem( ToMilliseconds(section.GetAverageDuration()), "avg" );
+         context.AddItem( ToMilliseconds(section.GetPercentile(50)), "p50" );
+         context.AddItem( ToMilliseconds(section.GetPercentile(90)), "p90" );
+         context.AddItem( ToMilliseconds(section.GetPercentile(99)), "p99" );
+      }
+
+      // Counts of all events, by bins starting at powers of two microseconds
+      context.StartField( "histogram" );
+      context.StartArray();
+      const auto &histogram = section.GetHistogram();
+      for (size_t bin = 0; bin < Section::HISTOGRAM_BINS; ++bin) {
+         context.StartStruct();
+         context.AddItem(
+            ToMilliseconds(Section::GetHistogramBinStart(bin)), "from" );
+         context.AddItem( double(histogram[bin]), "count" );
+         context.EndStruct();
+      }
+      context.EndArray();
+      context.EndField();
+
+      // The most recent frames, oldest first
+      context.StartField( "recent" );
+      context.StartArray();
+      for (const auto duration : section.GetRecentDurations())
+         context.AddItem( ToMilliseconds(duration) );
+      context.EndArray();
+      context.EndField();
+
+      context.EndStruct();
+   }
+   context.EndArray();
+
+   if (mReset)
+      FrameStatistics::Reset();
+   return true;
+}
+
+namespace {
+using namespace MenuRegistry;
+
+// Register menu items
+
+AttachedItem sAttachment{
+   // Works during playback, when redraws are busiest
+   Command( wxT("GetFrameStatistics"), XXO("Get Frame Statistics..."),
+      CommandDispatch::OnAudacityCommand, AlwaysEnabledFlag ),
+   wxT("Optional/Extra/Part2/Scriptables2")
+};
+
+}
@@ -0,0 +1,39 @@
+/*  SPDX-License-Identifier: GPL-2.0-or-later */
+/*!********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  GetFrameStatisticsCommand.h
+
+**********************************************************************/
+#ifndef __GET_FRAME_STATISTICS_COMMAND__
+#define __GET_FRAME_STATISTICS_COMMAND__
+
+#include "CommandType.h"
+#include "Command.h"
+
+//! Command to report the FrameStatistics of TrackPanel painting, so that
+//! scripted tests can detect redraw regressions
+class GetFrameStatisticsCommand : public AudacityCommand
+{
+public:
+   static const ComponentInterfaceSymbol Symbol;
+
+   // ComponentInterface overrides
+   ComponentInterfaceSymbol GetSymbol() const override {return Symbol;};
+   TranslatableString GetDescription() const override
+   {return XO("Gets the durations of drawing the tracks, in milliseconds.");};
+   template<bool Const> bool VisitSettings( SettingsVisitorBase<Const> &S );
+   bool VisitSettings( SettingsVisitor & S ) override;
+   bool VisitSettings( ConstSettingsVisitor & S ) override;
+   void PopulateOrExchange(ShuttleGui & S) override;
+   bool Apply(const CommandContext & context) override;
+
+   // AudacityCommand overrides
+   ManualPageID ManualPage() override
+   {return L"Extra_Menu:_Scriptables_II#get_frame_statistics";}
+public:
+   bool mReset;
+};
+
+#endif
@@ -17,12 +17,14 @@ This class now lists
 - Clips
 - Labels
 - Boxes
+- Audio statistics
 
 *//*******************************************************************/
 
 
 #include "GetInfoCommand.h"
 
+#include "../AudioEngineStatistics.h"
 #include "CommandDispatch.h"
 #include "../CommonCommandFlags.h"
 #include "LoadCommands.h"
@@ -72,6 +74,7 @@ enum {
    kEnvelopes,
    kLabels,
    kBoxes,
+   kAudioStatistics,
    nTypes
 };
 
@@ -86,6 +89,7 @@ static const EnumValueSymbol kTypes[nTypes] =
    { XO("Envelopes") },
    { XO("Labels") },
    { XO("Boxes") },
+   { wxT("AudioStatistics"), XO("Audio Statistics") },
 };
 
 enum {
@@ -171,6 +175,7 @@ bool GetInfoCommand::ApplyInner(const CommandContext &context)
       case kEnvelopes    : return SendEnvelopes( context );
       case kLabels       : return SendLabels( context );
       case kBoxes        : return SendBoxes( context );
+      case kAudioStatistics : return SendAudioStatistics( context );
       default:
          context.Status( "Command options not recognised" );
    }
@@ -515,6 +520,40 @@ bool GetInfoCommand::SendTracks(const CommandContext & context)
    return true;
 }
 
+bool GetInfoCommand::SendAudioStatistics(const CommandContext &context)
+{
+   context.StartArray();
+   for (const auto &entry : AudioEngineStatistics::Gather(context.project)) {
+      const auto &snapshot = entry.snapshot;
+      context.StartStruct();
+      context.AddItem( entry.name, "name" );
+      context.AddItem( entry.owner, "track" );
+      context.AddItem( entry.unit, "unit" );
+      context.AddItem( (double)snapshot.count, "count" );
+      context.AddItem( snapshot.Mean(), "mean" );
+      context.AddItem( (double)snapshot.Percentile(0.5), "p50" );
+      context.AddItem( (double)snapshot.Percentile(0.9), "p90" );
+      context.AddItem( (double)snapshot.Percentile(0.99), "p99" );
+      context.AddItem( (double)snapshot.max, "max" );
+      context.StartField( "bins" );
+      context.StartArray();
+      for (size_t ii = 0; ii < AtomicHistogram::BinsCount; ++ii) {
+         if (snapshot.counts[ii] == 0)
+            continue;
+         context.StartStruct();
+         context.AddItem( (double)snapshot.BinLower(ii), "lower" );
+         context.AddItem( (double)snapshot.BinUpper(ii), "upper" );
+         context.AddItem( (double)snapshot.counts[ii], "count" );
+         context.EndStruct();
+      }
+      context.EndArray();
+      context.EndField();
+      context.EndStruct();
+   }
+   context.EndArray();
+   return true;
+}
+
 bool GetInfoCommand::SendClips(const CommandContext &context)
 {
    auto &tracks = TrackList::Get( context.project );
@@ -0,0 +1,153 @@
+/**********************************************************************
+
+   Audacity - A Digital Audio Editor
+   Copyright 1999-2018 Audacity Team
+   License: wxwidgets
+
+******************************************************************//**
+
+\file GetSamplesCommand.cpp
+\brief Definitions for GetSamplesCommand
+
+\class GetSamplesCommand
+\brief Command that sends samples of one channel as little endian 32 bit
+floats, in lines of base64 for chunks of samples, which is much shorter than
+numbers in text.  The binary protocol of mod-script-pipe sends them unencoded.
+Given a file, instead writes the floats there, which may be in shared memory,
+and sends only their count.
+
+*//*******************************************************************/
+
+
+#include "GetSamplesCommand.h"
+
+#include "CommandDispatch.h"
+#include "MenuRegistry.h"
+#include "../CommonCommandFlags.h"
+#include "LoadCommands.h"
+#include "Base64.h"
+#include "WaveTrack.h"
+#include "SettingsVisitor.h"
+#include "ShuttleGui.h"
+#include "CommandContext.h"
+
+#include <wx/ffile.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+const ComponentInterfaceSymbol GetSamplesCommand::Symbol
+{ XO("Get Samples") };
+
+namespace{ BuiltinCommandsModule::Registration< GetSamplesCommand > reg; }
+
+template<bool Const>
+bool GetSamplesCommand::VisitSettings( SettingsVisitorBase<Const> & S ){
+   S.Define(               mTrackIndex,   wxT("Track"),   0, 0, 10000 );
+   S.Define(               mChannelIndex, wxT("Channel"), 0, 0, 100 );
+   S.Define(               mT0,           wxT("Start"),   0.0, 0.0, 1e10 );
+   S.OptionalN( bHasT1 ).Define( mT1,     wxT("End"),     0.0, 0.0, 1e10 );
+   S.OptionalN( bHasFileName ).Define( mFileName, wxT("File"), wxString{} );
+   return true;
+}
+bool GetSamplesCommand::VisitSettings( SettingsVisitor & S )
+   { return VisitSettings<false>(S); }
+
+bool GetSamplesCommand::VisitSettings( ConstSettingsVisitor & S )
+   { return VisitSettings<true>(S); }
+
+void GetSamplesCommand::PopulateOrExchange(ShuttleGui & S)
+{
+   S.AddSpace(0, 5);
+
+   S.StartMultiColumn(2, wxALIGN_CENTER);
+   {
+      S.TieNumericTextBox( XXO("Track:"),   mTrackIndex );
+      S.TieNumericTextBox( XXO("Channel:"), mChannelIndex );
+      S.TieNumericTextBox( XXO("Start:"),   mT0 );
+   }
+   S.EndMultiColumn();
+   S.StartMultiColumn(3, wxALIGN_CENTER);
+   {
+      S.Optional( bHasT1 ).TieNumericTextBox( XXO("End:"), mT1 );
+      S.Optional( bHasFileName ).TieTextBox( XXO("File:"), mFileName );
+   }
+   S.EndMultiColumn();
+}
+
+bool GetSamplesCommand::Apply(const CommandContext & context)
+{
+   const WaveTrack *pTrack = nullptr;
+   int index = 0;
+   for (const auto pOther : TrackList::Get( context.project ))
+      if (index++ == mTrackIndex) {
+         pTrack = dynamic_cast<const WaveTrack*>(pOther);
+         break;
+      }
+   if (!pTrack) {
+      context.Error(wxT("Track is not a wave track."));
+      return false;
+   }
+   const auto pChannel = pTrack->GetChannel(mChannelIndex);
+   if (!pChannel) {
+      context.Error(wxT("Track has no such channel."));
+      return false;
+   }
+
+   const auto t1 = bHasT1 ? mT1 : pTrack->GetEndTime();
+   const auto s0 = pTrack->TimeToLongSamples(mT0);
+   const auto s1 = std::max(s0, pTrack->TimeToLongSamples(t1));
+
+   wxFFile file;
+   if (bHasFileName && !file.Open(mFileName, wxT("wb"))) {
+      context.Error(wxT("Could not open the file for writing."));
+      return false;
+   }
+
+   // Read large chunks, each spanning many sample blocks
+   std::vector<float> samples(limitSampleBufferSize(ChunkSamples, s1 - s0));
+   std::vector<unsigned char> bytes(samples.size() * sizeof(float));
+   for (auto position = s0; position < s1;) {
+      const auto len = limitSampleBufferSize(ChunkSamples, s1 - position);
+      pChannel->GetFloats(samples.data(), position, len);
+      position += len;
+
+      // Make the bytes little endian on any machine
+      for (size_t ii = 0; ii < len; ++ii) {
+         uint32_t bits;
+         memcpy(&bits, &samples[ii], sizeof bits);
+         for (size_t jj = 0; jj < sizeof bits; ++jj)
+            bytes[ii * sizeof bits + jj] = (bits >> (8 * jj)) & 0xff;
+      }
+      const auto nBytes = len * sizeof(float);
+      if (bHasFileName) {
+         if (file.Write(bytes.data(), nBytes) != nBytes) {
+            context.Error(wxT("Could not write the file."));
+            return false;
+         }
+      }
+      else
+         // One line for each chunk, where the empty line ends the response
+         context.Status((position - len == s0 ? wxT("") : wxT("\n")) +
+            Base64::Encode(bytes.data(), nBytes));
+      context.Progress((position - s0).as_double() / (s1 - s0).as_double());
+   }
+   if (bHasFileName)
+      context.Status(wxString::Format(wxT("%lld"), (s1 - s0).as_long_long()));
+   return true;
+}
+
+namespace {
+using namespace MenuRegistry;
+
+// Register menu items
+
+AttachedItem sAttachment{
+   Command( wxT("GetSamples"), XXO("Get Samples..."),
+      CommandDispatch::OnAudacityCommand, AudioIONotBusyFlag() ),
+   wxT("Optional/Extra/Part2/Scriptables2")
+};
+
+}
@@ -0,0 +1,50 @@
+/**********************************************************************
+
+   Audacity - A Digital Audio Editor
+   Copyright 1999-2018 Audacity Team
+   License: wxwidgets
+
+******************************************************************//**
+
+\file GetSamplesCommand.h
+\brief Declarations of GetSamplesCommand class
+
+*//*******************************************************************/
+
+#ifndef __GET_SAMPLES_COMMAND__
+#define __GET_SAMPLES_COMMAND__
+
+#include "Command.h"
+#include "CommandType.h"
+
+class GetSamplesCommand final : public AudacityCommand
+{
+public:
+   static const ComponentInterfaceSymbol Symbol;
+
+   //! Samples read at once, and sent in one line of text
+   static constexpr size_t ChunkSamples = 1 << 20;
+
+   // ComponentInterface overrides
+   ComponentInterfaceSymbol GetSymbol() const override {return Symbol;}
+   TranslatableString GetDescription() const override {return XO("Gets samples of a channel of a track, as 32 bit floats.");};
+   template<bool Const> bool VisitSettings( SettingsVisitorBase<Const> &S );
+   bool VisitSettings( SettingsVisitor & S ) override;
+   bool VisitSettings( ConstSettingsVisitor & S ) override;
+   void PopulateOrExchange(ShuttleGui & S) override;
+
+   // AudacityCommand overrides
+   ManualPageID ManualPage() override {return L"Extra_Menu:_Scriptables_II#get_samples";}
+   bool Apply(const CommandContext &context) override;
+
+private:
+   int mTrackIndex;
+   int mChannelIndex;
+   double mT0;
+   double mT1;
+   wxString mFileName;
+   bool bHasT1;
+   bool bHasFileName;
+};
+
+#endif /* End of include guard: __GET_SAMPLES_COMMAND__ */
@@ -35,6 +35,8 @@
 #include "ExportPluginRegistry.h"
 #include "ExportProgressUI.h"
 
+#include <float.h>
+
 
 const ComponentInterfaceSymbol ImportCommand::Symbol
 { XO("Import2") };
@@ -44,6 +46,8 @@ namespace{ BuiltinCommandsModule::Registration< ImportCommand > reg; }
 template<bool Const>
 bool ImportCommand::VisitSettings( SettingsVisitorBase<Const> & S ){
    S.Define( mFileName, wxT("Filename"), wxString{} );
+   S.OptionalN( bHasT0 ).Define( mT0, wxT("Start"), 0.0, 0.0, (double)FLT_MAX);
+   S.OptionalN( bHasT1 ).Define( mT1, wxT("End"), 0.0, 0.0, (double)FLT_MAX);
    return true;
 }
 
@@ -60,6 +64,8 @@ void ImportCommand::PopulateOrExchange(ShuttleGui & S)
    S.StartMultiColumn(2, wxALIGN_CENTER);
    {
       S.TieTextBox(XXO("File Name:"),mFileName);
+      S.Optional( bHasT0 ).TieTextBox(XXO("Start Time:"), mT0);
+      S.Optional( bHasT1 ).TieTextBox(XXO("End Time:"),   mT1);
    }
    S.EndMultiColumn();
 }
@@ -67,8 +73,21 @@ void ImportCommand::PopulateOrExchange(ShuttleGui & S)
 bool ImportCommand::Apply(const CommandContext & context)
 {
    bool wasEmpty = TrackList::Get(context.project).empty();
-   const bool success =
-      ProjectFileManager::Get(context.project).Import(mFileName, false);
+
+   // Import only part of the file if either end is given
+   std::optional<ImportTimeRange> timeRange;
+   if (bHasT0 || bHasT1) {
+      const auto t0 = bHasT0 ? mT0 : 0.0;
+      const auto t1 = bHasT1 ? mT1 : (double)FLT_MAX;
+      if (t1 < t0) {
+         context.Error(wxT("End time is before start time"));
+         return false;
+      }
+      timeRange = ImportTimeRange{ t0, t1 };
+   }
+
+   const bool success = ProjectFileManager::Get(context.project)
+      .Import(mFileName, false, timeRange);
 
    if (success && wasEmpty)
       SelectUtilities::SelectAllIfNone( context.project );
@@ -82,6 +101,7 @@ bool ExportCommand::VisitSettings( SettingsVisitorBase<Const> & S ){
    fn.SetName("exported.wav");
    S.Define(mFileName, wxT("Filename"), fn.GetFullPath());
    S.Define( mnChannels, wxT("NumChannels"),  1 );
+   S.OptionalN( bHasFormats ).Define( mFormats, wxT("Formats"), wxString{} );
    return true;
 }
 
@@ -106,6 +126,12 @@ void ExportCommand::PopulateOrExchange(ShuttleGui & S)
       S.TieTextBox(XXO("Number of Channels:"),mnChannels);
    }
    S.EndMultiColumn();
+
+   S.StartMultiColumn(3, wxALIGN_CENTER);
+   {
+      S.Optional( bHasFormats ).TieTextBox(XXO("Also Export Formats:"),mFormats);
+   }
+   S.EndMultiColumn();
 }
 
 bool ExportCommand::Apply(const CommandContext & context)
@@ -124,32 +150,53 @@ bool ExportCommand::Apply(const CommandContext & context)
    }
    wxString extension = mFileName.Mid(splitAt+1).MakeUpper();
 
-   auto [plugin, formatIndex] = ExportPluginRegistry::Get().FindFormat(extension);
+   // The file name, then the same name with each of the other extensions
+   std::vector<std::pair<wxString, wxString>> files{ { extension, mFileName } };
+   if (bHasFormats)
+   {
+      for (auto format : wxSplit(mFormats, wxT(',')))
+      {
+         format = format.Trim(true).Trim(false).MakeUpper();
+         if (!format.empty() && format != extension)
+            files.emplace_back(format, mFileName.Left(splitAt+1) + format.Lower());
+      }
+   }
 
-   if(plugin != nullptr)
+   std::vector<ExportTaskBuilder> builders;
+   for (const auto &[format, fileName] : files)
    {
+      auto [plugin, formatIndex] = ExportPluginRegistry::Get().FindFormat(format);
+      if (plugin == nullptr)
+      {
+         context.Error(wxString::Format(wxT("Could not export to %s format!"), format));
+         return false;
+      }
+
       auto editor = plugin->CreateOptionsEditor(formatIndex, nullptr);
       editor->Load(*gPrefs);
 
-      auto builder = ExportTaskBuilder{}
+      builders.push_back(ExportTaskBuilder{}
          .SetParameters(ExportUtils::ParametersFromEditor(*editor))
          .SetNumChannels(std::max(0, mnChannels))
          .SetSampleRate(ProjectRate::Get(context.project).GetRate())
          .SetPlugin(plugin)
-         .SetFileName(mFileName)
-         .SetRange(t0, t1, true);
+         .SetFileName(fileName)
+         .SetRange(t0, t1, true));
+   }
 
-      auto result = ExportResult::Error;
-      ExportProgressUI::ExceptionWrappedCall([&]
-      {
-         result = ExportProgressUI::Show(builder.Build(context.project));
-      });
-      if (result == ExportResult::Success || result == ExportResult::Stopped)
-      {
+   auto result = ExportResult::Error;
+   ExportProgressUI::ExceptionWrappedCall([&]
+   {
+      // Mix once for all of the files
+      result = ExportProgressUI::Show(
+         ExportTaskBuilder::BuildShared(context.project, move(builders)));
+   });
+   if (result == ExportResult::Success || result == ExportResult::Stopped)
+   {
+      for (const auto &[format, fileName] : files)
          context.Status(wxString::Format(wxT("Exported to %s format: %s"),
-                                         extension, mFileName));
-         return true;
-      }
+                                         format, fileName));
+      return true;
    }
 
    context.Error(wxString::Format(wxT("Could not export to %s format!"), extension));
@@ -41,6 +41,10 @@ public:
    ManualPageID ManualPage() override {return L"Extra_Menu:_Scriptables_II#import";}
 public:
    wxString mFileName;
+   double mT0{ 0.0 };
+   double mT1{ 0.0 };
+   bool bHasT0{ false };
+   bool bHasT1{ false };
 };
 
 class ExportCommand : public AudacityCommand
@@ -62,4 +66,7 @@ public:
 public:
    wxString mFileName;
    int mnChannels;
+   //! Comma separated extensions of more files to export from the same mix
+   wxString mFormats;
+   bool bHasFormats;
 };
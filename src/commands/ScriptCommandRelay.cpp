@@ -27,7 +27,9 @@ code out of ModuleManager.
 #include "AppCommandEvent.h"
 #include "Project.h"
 #include <wx/app.h>
+#include <wx/arrstr.h>
 #include <thread>
+#include <vector>
 
 /// This is the function which actually obeys one command.
 static int ExecCommand(wxString *pIn, wxString *pOut, bool fromMain)
@@ -75,6 +77,34 @@ static int ExecFromMain(wxString *pIn, wxString *pOut)
    return ExecCommand(pIn, pOut, true);
 }
 
+void ScriptCommandRelay::ExecuteBatch(
+   const wxArrayString &commands, wxArrayString &responses)
+{
+   responses.clear();
+   const auto pProject = ::GetActiveProject().lock();
+   if (!pProject) {
+      responses.Add(wxString{}, commands.size());
+      return;
+   }
+
+   // Send all before awaiting any, so that the main thread runs them
+   // back to back
+   std::vector<std::unique_ptr<CommandBuilder>> builders;
+   builders.reserve(commands.size());
+   for (const auto &command : commands) {
+      auto pBuilder = std::make_unique<CommandBuilder>(*pProject, command);
+      if (pBuilder->WasValid()) {
+         AppCommandEvent ev;
+         ev.SetCommand(pBuilder->GetCommand());
+         wxTheApp->AddPendingEvent(ev);
+      }
+      builders.push_back(std::move(pBuilder));
+   }
+
+   for (const auto &pBuilder : builders)
+      responses.Add(pBuilder->GetResponse());
+}
+
 /// Starts the script server
 void ScriptCommandRelay::StartScriptServer(tpRegScriptServerFunc scriptFn)
 {
@@ -20,6 +20,7 @@
 
 #include <memory>
 
+class wxArrayString;
 class wxString;
 
 typedef int(*tpExecScriptServerFunc)(wxString * pIn, wxString * pOut);
@@ -29,6 +30,12 @@ class AUDACITY_DLL_API ScriptCommandRelay
 {
 public:
    static void StartScriptServer(tpRegScriptServerFunc scriptFn);
+
+   //! Execute commands from the worker (script) thread, sending all of them
+   //! to the main thread before waiting for their responses, in order
+   /*! All are built for the project that is active when this is called */
+   static void ExecuteBatch(
+      const wxArrayString &commands, wxArrayString &responses);
 };
 
 // The void * return is actually a Lisp LVAL and will be cast to such as needed.
@@ -355,6 +355,17 @@ std::shared_ptr<EffectInstance> EffectAmplify::MakeInstance() const
    return std::make_shared<Instance>(const_cast<EffectAmplify&>(*this));
 }
 
+bool EffectAmplify::ProcessesTracksConcurrently() const
+{
+   // The instances call through to ProcessBlock(), which only reads mRatio
+   return true;
+}
+
+bool EffectAmplify::ProcessesChunksIndependently() const
+{
+   return true;
+}
+
 // EffectAmplify implementation
 
 void EffectAmplify::CheckClip()
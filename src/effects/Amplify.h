@@ -65,6 +65,9 @@ public:
 
    std::shared_ptr<EffectInstance> MakeInstance() const override;
 
+   bool ProcessesTracksConcurrently() const override;
+   bool ProcessesChunksIndependently() const override;
+
 private:
    struct Instance : StatefulPerTrackEffect::Instance {
       using StatefulPerTrackEffect::Instance::Instance;
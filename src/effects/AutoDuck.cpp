@@ -22,6 +22,7 @@
 #include "LoadEffects.h"
 #include "UserException.h"
 
+#include <algorithm>
 #include <math.h>
 
 #include <wx/dcclient.h>
@@ -34,6 +35,7 @@
 #include "Theme.h"
 #include "../widgets/valnum.h"
 
+#include "WaveChannelUtilities.h"
 #include "WaveClip.h"
 #include "WaveTrack.h"
 #include "TimeStretching.h"
@@ -71,6 +73,41 @@ struct AutoDuckRegion
    double t1;
 };
 
+namespace {
+//! Runs of the control track that the summaries show to be below the
+//! threshold are skipped without reading, if at least this long
+constexpr size_t kMinSkip = 4 * kRMSWindowSize;
+
+//! Samples of a ramp that share one evaluation of the starting gain
+constexpr size_t kRampChunk = 64;
+
+//! Multiply by the gain of a ramp, starting at gainDb and changing by stepDb
+//! each sample
+/*!
+ The gain is exponential in the sample, so it is a product of the gain at the
+ start of each chunk, and a table of the gains of the steps within a chunk
+ */
+void ApplyRamp(float *buffer, size_t len, double gainDb, double stepDb)
+{
+   float factors[kRampChunk];
+   for (size_t ii = 0; ii < kRampChunk; ++ii)
+      factors[ii] = DB_TO_LINEAR(stepDb * ii);
+   for (size_t ii = 0; ii < len; ii += kRampChunk) {
+      const auto count = std::min(kRampChunk, len - ii);
+      const float gain = DB_TO_LINEAR(gainDb + stepDb * ii);
+      const auto pBuffer = buffer + ii;
+      for (size_t jj = 0; jj < count; ++jj)
+         pBuffer[jj] *= gain * factors[jj];
+   }
+}
+
+void ApplyGain(float *buffer, size_t len, float gain)
+{
+   for (size_t ii = 0; ii < len; ++ii)
+      buffer[ii] *= gain;
+}
+}
+
 /*
  * Effect implementation
  */
@@ -244,17 +281,16 @@ bool EffectAutoDuck::Process(EffectInstance &, EffectSettings &)
       auto pos = start;
 
       const auto pControlChannel = *pControlTrack->Channels().begin();
-      while (pos < end)
-      {
-         const auto len = limitSampleBufferSize( kBufSize, end - pos );
 
-         pControlChannel->GetFloats(buf.get(), pos, len);
+      // Update the state for the samples [from, from + count)
+      const auto scan = [&](sampleCount from, size_t count) {
+         pControlChannel->GetFloats(buf.get(), from, count);
 
-         for (auto i = pos; i < pos + len; i++)
+         for (auto i = from; i < from + count; i++)
          {
             rmsSum -= rmsWindow[rmsPos];
-            // i - pos is bounded by len:
-            auto index = ( i - pos ).as_size_t();
+            // i - from is bounded by count:
+            auto index = ( i - from ).as_size_t();
             rmsWindow[rmsPos] = buf[ index ] * buf[ index ];
             rmsSum += rmsWindow[rmsPos];
             rmsPos = (rmsPos + 1) % kRMSWindowSize;
@@ -297,9 +333,75 @@ bool EffectAutoDuck::Process(EffectInstance &, EffectSettings &)
                }
             }
          }
+      };
+
+      // Update the state for samples [from, from + count), all known to be
+      // below the threshold, as scan() would, and preceded by at least a
+      // window of such samples
+      const auto skip = [&](sampleCount from, size_t count) {
+         if (inDuckRegion) {
+            const auto needed =
+               std::max<sampleCount>(minSamplesPause - curSamplesPause, 1);
+            if (needed <= count) {
+               curSamplesPause = minSamplesPause;
+               double duckRegionEnd = pControlTrack->LongSamplesToTime(
+                  from + needed - 1 - curSamplesPause);
+               regions.push_back(AutoDuckRegion(
+                  duckRegionStart - mOuterFadeDownLen,
+                  duckRegionEnd + mOuterFadeUpLen));
+               inDuckRegion = false;
+            }
+            else
+               curSamplesPause += count;
+         }
 
-         pos += len;
+         // Refill the window with the last samples
+         const auto windowStart = from + count - kRMSWindowSize;
+         pControlChannel->GetFloats(buf.get(), windowStart, kRMSWindowSize);
+         rmsSum = 0;
+         for (size_t ii = 0; ii < kRMSWindowSize; ++ii) {
+            rmsWindow[ii] = buf[ii] * buf[ii];
+            rmsSum += rmsWindow[ii];
+         }
+         rmsPos = 0;
+      };
+
+      while (pos < end)
+      {
+         const auto len = limitSampleBufferSize( kBufSize, end - pos );
 
+         // A window of samples whose peaks are all below the threshold
+         // can't exceed it; only the first window of a long run of such
+         // samples needs reading, to flush the louder samples before it
+         const auto spans =
+            WaveChannelUtilities::GetSummarySpans(*pControlChannel, pos, len);
+         size_t done = 0, quiet = 0, offset = 0;
+         const auto flush = [&]{
+            if (quiet >= kMinSkip) {
+               const auto quietStart = offset - quiet;
+               if (quietStart > done)
+                  scan(pos + done, quietStart - done);
+               scan(pos + quietStart, kRMSWindowSize);
+               skip(pos + quietStart + kRMSWindowSize,
+                  quiet - kRMSWindowSize);
+               done = offset;
+            }
+            quiet = 0;
+         };
+         for (const auto &span : spans) {
+            // Squared in float, as the window is
+            const float square = span.peak * span.peak;
+            if (square * double(kRMSWindowSize) < threshold)
+               quiet += span.length;
+            else
+               flush();
+            offset += span.length;
+         }
+         flush();
+         if (done < len)
+            scan(pos + done, len - done);
+
+         pos += len;
          if (TotalProgress(
             (pos - start).as_double() /
             (end - start).as_double() /
@@ -455,7 +557,8 @@ bool EffectAutoDuck::TransferDataFromWindow(EffectSettings &)
 
 // EffectAutoDuck implementation
 
-// this currently does an exponential fade
+// this currently does an exponential fade, in pieces that are each a ramp in
+// dB, or constant
 bool EffectAutoDuck::ApplyDuckFade(int trackNum, WaveChannel &track,
    double t0, double t1)
 {
@@ -477,27 +580,47 @@ bool EffectAutoDuck::ApplyDuckFade(int trackNum, WaveChannel &track,
    if (fadeUpSamples < 1)
       fadeUpSamples = 1;
 
-   float fadeDownStep = mDuckAmountDb / fadeDownSamples.as_double();
-   float fadeUpStep = mDuckAmountDb / fadeUpSamples.as_double();
+   const double fadeDownStep = mDuckAmountDb / fadeDownSamples.as_double();
+   const double fadeUpStep = mDuckAmountDb / fadeUpSamples.as_double();
+
+   // The gain in dB is the greatest of the fade down, the fade up, and the
+   // duck amount.  Find the offsets from start where it changes from one
+   // to the next.
+   const auto length = end - start;
+   auto downEnd = fadeDownSamples;
+   auto upStart = length - fadeUpSamples;
+   if (downEnd > upStart)
+      // The fades cross before reaching the duck amount
+      downEnd = upStart = sampleCount(ceil(length.as_double() *
+         fadeDownSamples.as_double() /
+         (fadeDownSamples + fadeUpSamples).as_double()));
+   const float duckGain = DB_TO_LINEAR(mDuckAmountDb);
 
    while (pos < end) {
       const auto len = limitSampleBufferSize(kBufSize, end - pos);
       track.GetFloats(buf.get(), pos, len);
-      for (auto i = pos; i < pos + len; ++i) {
-         float gainDown = fadeDownStep * (i - start).as_float();
-         float gainUp = fadeUpStep * (end - i).as_float();
 
-         float gain;
-         if (gainDown > gainUp)
-            gain = gainDown;
-         else
-            gain = gainUp;
-         if (gain < mDuckAmountDb)
-            gain = mDuckAmountDb;
-
-         // i - pos is bounded by len:
-         buf[ ( i - pos ).as_size_t() ] *= DB_TO_LINEAR(gain);
-      }
+      // Apply function to the part of the buffer at offsets [from, to)
+      const auto first = pos - start;
+      const auto apply = [&](sampleCount from, sampleCount to,
+         const auto &function) {
+         from = std::max(from, first);
+         to = std::min(to, first + len);
+         if (from < to)
+            function(buf.get() + (from - first).as_size_t(),
+               (to - from).as_size_t(), from);
+      };
+      apply(0, downEnd, [&](float *buffer, size_t count, sampleCount from){
+         ApplyRamp(buffer, count,
+            fadeDownStep * from.as_double(), fadeDownStep);
+      });
+      apply(downEnd, upStart, [&](float *buffer, size_t count, sampleCount){
+         ApplyGain(buffer, count, duckGain);
+      });
+      apply(upStart, length, [&](float *buffer, size_t count, sampleCount from){
+         ApplyRamp(buffer, count,
+            fadeUpStep * (length - from).as_double(), -fadeUpStep);
+      });
 
       if (!track.SetFloats(buf.get(), pos, len)) {
          cancel = true;
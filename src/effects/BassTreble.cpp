@@ -141,10 +141,8 @@ struct EffectBassTreble::Instance
                                  float* const*          outBlock,
                                  size_t                 blockLen);
 
-   static void Coefficients(double hz, double slope, double gain, double samplerate, int type,
-      double& a0, double& a1, double& a2, double& b0, double& b1, double& b2);
-
-   static float DoFilter(EffectBassTrebleState& data, float in);
+   //! Shelf filter, normalized so that a0 is 1
+   static Biquad Coefficients(double hz, double slope, double gain, double samplerate, int type);
 
    EffectBassTrebleState mState;
    std::vector<EffectBassTreble::Instance> mSlaves;
@@ -157,6 +155,12 @@ EffectBassTreble::MakeInstance() const
    return std::make_shared<Instance>(*this);
 }
 
+bool EffectBassTreble::ProcessesTracksConcurrently() const
+{
+   // Filter state is in each instance; settings are only read
+   return true;
+}
+
 
 EffectBassTreble::EffectBassTreble()
 {
@@ -390,29 +394,9 @@ void EffectBassTreble::Instance::InstanceInit(EffectSettings& settings, EffectBa
    data.hzBass = 250.0f;   // could be tunable in a more advanced version
    data.hzTreble = 4000.0f;   // could be tunable in a more advanced version
 
-   data.a0Bass = 1;
-   data.a1Bass = 0;
-   data.a2Bass = 0;
-   data.b0Bass = 0;
-   data.b1Bass = 0;
-   data.b2Bass = 0;
-
-   data.a0Treble = 1;
-   data.a1Treble = 0;
-   data.a2Treble = 0;
-   data.b0Treble = 0;
-   data.b1Treble = 0;
-   data.b2Treble = 0;
-
-   data.xn1Bass = 0;
-   data.xn2Bass = 0;
-   data.yn1Bass = 0;
-   data.yn2Bass = 0;
-
-   data.xn1Treble = 0;
-   data.xn2Treble = 0;
-   data.yn1Treble = 0;
-   data.yn2Treble = 0;
+   // Coefficients are computed by the first InstanceProcess()
+   const Biquad shelves[2];
+   data.filters = BiquadCascade{ shelves, 2 };
 
    data.bass = -1;
    data.treble = -1;
@@ -436,19 +420,22 @@ size_t EffectBassTreble::Instance::InstanceProcess(EffectSettings &settings,
    data.gain = DB_TO_LINEAR(ms.mGain);
 
    // Compute coefficients of the low shelf biquand IIR filter
-   if (data.bass != oldBass)
-      Coefficients(data.hzBass, data.slope, ms.mBass, data.samplerate, kBass,
-                  data.a0Bass, data.a1Bass, data.a2Bass,
-                  data.b0Bass, data.b1Bass, data.b2Bass);
+   if (data.bass != oldBass) {
+      data.filters.SetCoefficients(0, Coefficients(data.hzBass, data.slope,
+         ms.mBass, data.samplerate, kBass));
+      data.bass = oldBass;
+   }
 
    // Compute coefficients of the high shelf biquand IIR filter
-   if (data.treble != oldTreble)
-      Coefficients(data.hzTreble, data.slope, ms.mTreble, data.samplerate, kTreble,
-                  data.a0Treble, data.a1Treble, data.a2Treble,
-                  data.b0Treble, data.b1Treble, data.b2Treble);
+   if (data.treble != oldTreble) {
+      data.filters.SetCoefficients(1, Coefficients(data.hzTreble, data.slope,
+         ms.mTreble, data.samplerate, kTreble));
+      data.treble = oldTreble;
+   }
 
+   data.filters.Process(ibuf, obuf, blockLen);
    for (decltype(blockLen) i = 0; i < blockLen; i++) {
-      obuf[i] = DoFilter(data, ibuf[i]) * data.gain;
+      obuf[i] *= data.gain;
    }
 
    return blockLen;
@@ -459,10 +446,10 @@ size_t EffectBassTreble::Instance::InstanceProcess(EffectSettings &settings,
 // Effect implementation
 
 
-void EffectBassTreble::Instance::Coefficients(double hz, double slope, double gain, double samplerate, int type,
-                                   double& a0, double& a1, double& a2,
-                                   double& b0, double& b1, double& b2)
+Biquad EffectBassTreble::Instance::Coefficients(
+   double hz, double slope, double gain, double samplerate, int type)
 {
+   double a0, a1, a2, b0, b1, b2;
    double w = 2 * M_PI * hz / samplerate;
    double a = exp(log(10.0) * gain / 40);
    double b = sqrt((a * a + 1) / slope - (pow((a - 1), 2)));
@@ -485,31 +472,16 @@ void EffectBassTreble::Instance::Coefficients(double hz, double slope, double ga
       a1 = 2 * ((a - 1) - (a + 1) * cos(w));
       a2 = (a + 1) - (a - 1) * cos(w) - b * sin(w);
    }
-}
-
-float EffectBassTreble::Instance::DoFilter(EffectBassTrebleState & data, float in)
-{
-   // Bass filter
-   float out = (data.b0Bass * in + data.b1Bass * data.xn1Bass + data.b2Bass * data.xn2Bass -
-         data.a1Bass * data.yn1Bass - data.a2Bass * data.yn2Bass) / data.a0Bass;
-   data.xn2Bass = data.xn1Bass;
-   data.xn1Bass = in;
-   data.yn2Bass = data.yn1Bass;
-   data.yn1Bass = out;
 
-   // Treble filter
-   in = out;
-   out = (data.b0Treble * in + data.b1Treble * data.xn1Treble + data.b2Treble * data.xn2Treble -
-         data.a1Treble * data.yn1Treble - data.a2Treble * data.yn2Treble) / data.a0Treble;
-   data.xn2Treble = data.xn1Treble;
-   data.xn1Treble = in;
-   data.yn2Treble = data.yn1Treble;
-   data.yn1Treble = out;
-
-   return out;
+   Biquad result;
+   result.fNumerCoeffs[Biquad::B0] = b0 / a0;
+   result.fNumerCoeffs[Biquad::B1] = b1 / a0;
+   result.fNumerCoeffs[Biquad::B2] = b2 / a0;
+   result.fDenomCoeffs[Biquad::A1] = a1 / a0;
+   result.fDenomCoeffs[Biquad::A2] = a2 / a0;
+   return result;
 }
 
-
 void EffectBassTreble::Editor::OnBassText(wxCommandEvent & WXUNUSED(evt))
 {
    auto& ms = mSettings;
@@ -11,9 +11,20 @@ Max Maisel
 
 #include "Biquad.h"
 
+#include <algorithm>
 #include <cmath>
 #include <wx/utils.h>
 
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#  if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#     define BIQUAD_SSE2
+#     include <emmintrin.h>
+#  endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#  define BIQUAD_NEON
+#  include <arm_neon.h>
+#endif
+
 #define square(a) ((a)*(a))
 #define PI M_PI
 
@@ -41,6 +52,187 @@ void Biquad::Process(const float* pfIn, float* pfOut, int iNumSamples)
       *pfOut++ = ProcessOne(*pfIn++);
 }
 
+namespace {
+
+//! Samples converted to double and filtered in place at once
+constexpr size_t ChunkSize = 256;
+//! Sections pipelined together; longer cascades pass over a chunk again
+constexpr size_t MaxSections = 16;
+
+//! States or coefficients of two consecutive sections, in the low and high
+//! lanes
+#if defined(BIQUAD_SSE2)
+using Pair = __m128d;
+inline Pair Make(double lo, double hi) { return _mm_set_pd(hi, lo); }
+inline Pair Add(Pair a, Pair b) { return _mm_add_pd(a, b); }
+inline Pair Sub(Pair a, Pair b) { return _mm_sub_pd(a, b); }
+inline Pair Mul(Pair a, Pair b) { return _mm_mul_pd(a, b); }
+inline double Low(Pair a) { return _mm_cvtsd_f64(a); }
+inline double High(Pair a) { return _mm_cvtsd_f64(_mm_unpackhi_pd(a, a)); }
+//! The high lane of a and the low lane of b
+inline Pair Shift(Pair a, Pair b) { return _mm_shuffle_pd(a, b, 1); }
+//! x and the low lane of b
+inline Pair Feed(double x, Pair b)
+   { return _mm_unpacklo_pd(_mm_set_sd(x), b); }
+#elif defined(BIQUAD_NEON)
+using Pair = float64x2_t;
+inline Pair Make(double lo, double hi)
+   { return vcombine_f64(vdup_n_f64(lo), vdup_n_f64(hi)); }
+inline Pair Add(Pair a, Pair b) { return vaddq_f64(a, b); }
+inline Pair Sub(Pair a, Pair b) { return vsubq_f64(a, b); }
+inline Pair Mul(Pair a, Pair b) { return vmulq_f64(a, b); }
+inline double Low(Pair a) { return vgetq_lane_f64(a, 0); }
+inline double High(Pair a) { return vgetq_lane_f64(a, 1); }
+inline Pair Shift(Pair a, Pair b) { return vextq_f64(a, b, 1); }
+inline Pair Feed(double x, Pair b)
+   { return vsetq_lane_f64(x, vextq_f64(b, b, 1), 0); }
+#else
+// Lanes as members, which compilers may still vectorize
+struct Pair { double lo, hi; };
+inline Pair Make(double lo, double hi) { return { lo, hi }; }
+inline Pair Add(Pair a, Pair b) { return { a.lo + b.lo, a.hi + b.hi }; }
+inline Pair Sub(Pair a, Pair b) { return { a.lo - b.lo, a.hi - b.hi }; }
+inline Pair Mul(Pair a, Pair b) { return { a.lo * b.lo, a.hi * b.hi }; }
+inline double Low(Pair a) { return a.lo; }
+inline double High(Pair a) { return a.hi; }
+inline Pair Shift(Pair a, Pair b) { return { a.hi, b.lo }; }
+inline Pair Feed(double x, Pair b) { return { x, b.lo }; }
+#endif
+
+}
+
+BiquadCascade::BiquadCascade(const Biquad *sections, size_t count)
+   : mSections(count + (count & 1))
+   , mCount{ count }
+{
+   for (size_t ii = 0; ii < count; ++ii)
+      SetCoefficients(ii, sections[ii]);
+}
+
+void BiquadCascade::SetCoefficients(size_t index, const Biquad &section)
+{
+   auto &s = mSections[index];
+   s.b0 = section.fNumerCoeffs[Biquad::B0];
+   s.b1 = section.fNumerCoeffs[Biquad::B1];
+   s.b2 = section.fNumerCoeffs[Biquad::B2];
+   s.a1 = section.fDenomCoeffs[Biquad::A1];
+   s.a2 = section.fDenomCoeffs[Biquad::A2];
+}
+
+void BiquadCascade::Reset()
+{
+   for (auto &s : mSections)
+      s.s1 = s.s2 = s.y = 0;
+}
+
+void BiquadCascade::Process(const float *in, float *out, size_t len)
+{
+   DoProcess(in, out, len);
+}
+
+void BiquadCascade::Process(const float *in, double *out, size_t len)
+{
+   DoProcess(in, out, len);
+}
+
+template<typename Sample>
+void BiquadCascade::DoProcess(const float *in, Sample *out, size_t len)
+{
+   double buffer[ChunkSize];
+   while (len > 0) {
+      const auto n = std::min(len, ChunkSize);
+      std::copy(in, in + n, buffer);
+      ProcessChunk(buffer, n);
+      for (size_t ii = 0; ii < n; ++ii)
+         out[ii] = static_cast<Sample>(buffer[ii]);
+      in += n;
+      out += n;
+      len -= n;
+   }
+}
+
+void BiquadCascade::ProcessChunk(double *buffer, size_t len)
+{
+   for (size_t first = 0; first < mSections.size(); first += MaxSections) {
+      const auto sections = mSections.data() + first;
+      const auto count = std::min(MaxSections, mSections.size() - first);
+      const auto lag = count - 1;
+      // Sections start in turn, then all run together, then finish in turn
+      size_t t = 0;
+      for (; t < std::min(lag, len); ++t)
+         Step(sections, count, buffer, len, t);
+      if (t < len) {
+         switch (count / 2) {
+#define BIQUAD_PIPELINE(Pairs) \
+         case Pairs: Pipeline<Pairs>(sections, buffer, t, len); break;
+         BIQUAD_PIPELINE(1) BIQUAD_PIPELINE(2) BIQUAD_PIPELINE(3)
+         BIQUAD_PIPELINE(4) BIQUAD_PIPELINE(5) BIQUAD_PIPELINE(6)
+         BIQUAD_PIPELINE(7) BIQUAD_PIPELINE(8)
+#undef BIQUAD_PIPELINE
+         default: break;
+         }
+         t = len;
+      }
+      for (; t < len + lag; ++t)
+         Step(sections, count, buffer, len, t);
+   }
+}
+
+void BiquadCascade::Step(Section *sections, size_t count,
+   double *buffer, size_t len, size_t t)
+{
+   // Section k computes sample t - k, if it is in the chunk; the last goes
+   // first, so that each takes the output of the one before it from the step
+   // before
+   const auto lag = count - 1;
+   const auto first = t >= len ? t - len + 1 : 0;
+   for (auto k = std::min(t, lag) + 1; k-- > first;) {
+      auto &s = sections[k];
+      const auto x = k == 0 ? buffer[t] : sections[k - 1].y;
+      const auto y = s.b0 * x + s.s1;
+      s.s1 = s.b1 * x - s.a1 * y + s.s2;
+      s.s2 = s.b2 * x - s.a2 * y;
+      s.y = y;
+   }
+   if (t >= lag)
+      buffer[t - lag] = sections[lag].y;
+}
+
+template<size_t Pairs> void BiquadCascade::Pipeline(Section *sections,
+   double *buffer, size_t begin, size_t end)
+{
+   Pair b0[Pairs], b1[Pairs], b2[Pairs], a1[Pairs], a2[Pairs];
+   Pair s1[Pairs], s2[Pairs], y[Pairs];
+   for (size_t p = 0; p < Pairs; ++p) {
+      const auto &lo = sections[2 * p], &hi = sections[2 * p + 1];
+      b0[p] = Make(lo.b0, hi.b0);
+      b1[p] = Make(lo.b1, hi.b1);
+      b2[p] = Make(lo.b2, hi.b2);
+      a1[p] = Make(lo.a1, hi.a1);
+      a2[p] = Make(lo.a2, hi.a2);
+      s1[p] = Make(lo.s1, hi.s1);
+      s2[p] = Make(lo.s2, hi.s2);
+      y[p] = Make(lo.y, hi.y);
+   }
+   constexpr auto lag = 2 * Pairs - 1;
+   for (auto t = begin; t < end; ++t) {
+      for (auto p = Pairs; p-- > 0;) {
+         const auto x = p == 0 ? Feed(buffer[t], y[0]) : Shift(y[p - 1], y[p]);
+         const auto out = Add(Mul(b0[p], x), s1[p]);
+         s1[p] = Add(Sub(Mul(b1[p], x), Mul(a1[p], out)), s2[p]);
+         s2[p] = Sub(Mul(b2[p], x), Mul(a2[p], out));
+         y[p] = out;
+      }
+      buffer[t - lag] = High(y[Pairs - 1]);
+   }
+   for (size_t p = 0; p < Pairs; ++p) {
+      auto &lo = sections[2 * p], &hi = sections[2 * p + 1];
+      lo.s1 = Low(s1[p]), hi.s1 = High(s1[p]);
+      lo.s2 = Low(s2[p]), hi.s2 = High(s2[p]);
+      lo.y = Low(y[p]), hi.y = High(y[p]);
+   }
+}
+
 const double Biquad::s_fChebyCoeffs[MAX_Order][MAX_Order + 1] =
 {
    // For Chebyshev polynomials of the first kind (see http://en.wikipedia.org/wiki/Chebyshev_polynomial)
@@ -14,6 +14,8 @@ Max Maisel
 
 #include "MemoryX.h"
 
+#include <vector>
+
 /// \brief Represents a biquad digital filter.
 struct Biquad
 {
@@ -76,4 +78,55 @@ struct Biquad
    static double ChebyPoly(int Order, double NormFreq);
 };
 
+/// \brief A cascade of biquads in transposed direct form II, computed two
+/// sections at a time in the lanes of SSE2 or NEON vectors
+/*!
+ Each section runs one sample behind the section before it, so that all
+ sections of one step are independent of each other, and the step is not
+ limited by the latency of a chain of feedback through all of them.
+
+ Samples are filtered in chunks in a buffer on the stack, in double, so
+ Process() does not allocate and may be used in realtime processing.
+ */
+class BiquadCascade final
+{
+public:
+   BiquadCascade() = default;
+   //! Copy the coefficients of sections, but not their states, which are
+   //! reset
+   BiquadCascade(const Biquad *sections, size_t count);
+
+   size_t GetCount() const { return mCount; }
+
+   //! Change the coefficients of a section but not its state, as when
+   //! settings change during playback
+   void SetCoefficients(size_t index, const Biquad &section);
+   void Reset();
+
+   //! @param out may equal in
+   void Process(const float *in, float *out, size_t len);
+   //! @param out may equal in
+   void Process(const float *in, double *out, size_t len);
+
+private:
+   struct Section {
+      double b0{ 1 }, b1{ 0 }, b2{ 0 }, a1{ 0 }, a2{ 0 };
+      double s1{ 0 }, s2{ 0 };
+      //! Output of the latest step
+      double y{ 0 };
+   };
+
+   template<typename Sample>
+   void DoProcess(const float *in, Sample *out, size_t len);
+   void ProcessChunk(double *buffer, size_t len);
+   static void Step(Section *sections, size_t count,
+      double *buffer, size_t len, size_t t);
+   template<size_t Pairs> static void Pipeline(Section *sections,
+      double *buffer, size_t begin, size_t end);
+
+   //! Padded to an even count with a section that passes samples through
+   std::vector<Section> mSections;
+   size_t mCount{ 0 };
+};
+
 #endif
@@ -29,6 +29,7 @@
 #include "Prefs.h"
 #include "Resample.h"
 #include "ShuttleGui.h"
+#include "concurrency/ThreadPool.h"
 #include "SyncLock.h"
 #include "../widgets/NumericTextCtrl.h"
 #include "../widgets/valnum.h"
@@ -207,6 +208,52 @@ auto EffectChangeSpeed::FindGaps(
    return gaps;
 }
 
+namespace {
+//! Bound on the samples that one channel makes in one step
+constexpr size_t MaxStepOutput = 1 << 20;
+}
+
+//! The resampling of one channel, which is independent of other channels
+struct EffectChangeSpeed::ChannelJob {
+   ChannelJob(const WaveChannel &channel, WaveChannel &output,
+      sampleCount start, sampleCount end, double factor)
+      : channel{ channel }, output{ output }, pos{ start }, end{ end }
+      , resample{ true, factor, factor } // constant rate resampling
+   {}
+
+   //! Resample the input of the step into result; may run in a worker thread
+   void Step(double factor)
+   {
+      const bool last = (pos + input.size() >= end);
+      // mFactor is at most 100-fold so this shouldn't overflow size_t
+      result.resize(size_t(factor * input.size() + 10));
+      size_t used = 0, made = 0;
+      while (true) {
+         const auto [idone, odone] = resample.Process(factor,
+            input.data() + used, input.size() - used, last,
+            result.data() + made, result.size() - made);
+         used += idone;
+         made += odone;
+         if (used >= input.size() && made < result.size())
+            break;
+         if (idone == 0 && odone == 0)
+            break;
+         // Make room for the rest of the output
+         if (made == result.size())
+            result.resize(made + made / 2 + 10);
+      }
+      result.resize(made);
+   }
+
+   const WaveChannel &channel;
+   WaveChannel &output;
+   sampleCount pos;
+   const sampleCount end;
+   Resample resample;
+   std::vector<float> input;
+   std::vector<float> result;
+};
+
 bool EffectChangeSpeed::Process(EffectInstance &, EffectSettings &)
 {
    // Similar to EffectSoundTouch::Process()
@@ -217,10 +264,18 @@ bool EffectChangeSpeed::Process(EffectInstance &, EffectSettings &)
    EffectOutputTracks outputs { *mTracks, GetType(), { { mT0, mT1 } }, true };
    bool bGoodResult = true;
 
-   mCurTrackNum = 0;
-
    mFactor = 100.0 / (100.0 + m_PercentChange);
 
+   // Wave tracks to finish after resampling all their channels together
+   struct TrackJob {
+      WaveTrack &track;
+      double t0, t1;
+      Gaps gaps;
+      std::shared_ptr<WaveTrack> pNewTrack;
+   };
+   std::vector<TrackJob> trackJobs;
+   ChannelJobs channelJobs;
+
    outputs.Get().Any().VisitWhile(bGoodResult,
       [&](LabelTrack &lt) {
          if (SyncLock::IsSelectedOrSyncLockSelected(lt)) {
@@ -247,39 +302,15 @@ bool EffectChangeSpeed::Process(EffectInstance &, EffectSettings &)
             auto start = outWaveTrack.TimeToLongSamples(mCurT0);
             auto end = outWaveTrack.TimeToLongSamples(mCurT1);
 
-            const auto gaps = FindGaps(outWaveTrack, mCurT0, mCurT1);
-
-            auto pNewTrack = outWaveTrack.EmptyCopy();
-            auto iter = pNewTrack->Channels().begin();
-            for (const auto pChannel : outWaveTrack.Channels()) {
-               // ProcessOne() (implemented below) processes a single channel
-               if (ProcessOne(*pChannel, **iter++, start, end))
-                  ++mCurTrackNum;
-               else {
-                  pNewTrack.reset();
-                  break;
-               }
-            }
-            if (!pNewTrack) {
-               bGoodResult = false;
-               return;
-            }
-            pNewTrack->Flush();
-
-            const double newLength = pNewTrack->GetEndTime();
-            const LinearTimeWarper warper{
-               mCurT0, mCurT0, mCurT1, mCurT0 + newLength };
-
-            outWaveTrack.ClearAndPaste(mCurT0, mCurT1,
-               *pNewTrack, true, true, &warper);
-
-               // Finally, recreate the gaps
-            for (const auto [st, et] : gaps)
-               if (st >= mCurT0 && et <= mCurT1 && st != et)
-                  outWaveTrack.SplitDelete(warper.Warp(st), warper.Warp(et));
+            trackJobs.push_back({ outWaveTrack, mCurT0, mCurT1,
+               FindGaps(outWaveTrack, mCurT0, mCurT1),
+               outWaveTrack.EmptyCopy() });
+            auto &job = trackJobs.back();
+            auto iter = job.pNewTrack->Channels().begin();
+            for (const auto pChannel : outWaveTrack.Channels())
+               channelJobs.push_back(std::make_unique<ChannelJob>(
+                  *pChannel, **iter++, start, end, mFactor));
          }
-         else
-            mCurTrackNum += outWaveTrack.NChannels();
       }; },
       [&](Track &t) {
          if (SyncLock::IsSyncLockSelected(t))
@@ -287,6 +318,27 @@ bool EffectChangeSpeed::Process(EffectInstance &, EffectSettings &)
       }
    );
 
+   if (bGoodResult)
+      bGoodResult = ProcessChannels(channelJobs);
+
+   for (auto iter = trackJobs.begin();
+        bGoodResult && iter != trackJobs.end(); ++iter) {
+      auto &[outWaveTrack, curT0, curT1, gaps, pNewTrack] = *iter;
+      pNewTrack->Flush();
+
+      const double newLength = pNewTrack->GetEndTime();
+      const LinearTimeWarper warper{
+         curT0, curT0, curT1, curT0 + newLength };
+
+      outWaveTrack.ClearAndPaste(curT0, curT1,
+         *pNewTrack, true, true, &warper);
+
+         // Finally, recreate the gaps
+      for (const auto [st, et] : gaps)
+         if (st >= curT0 && et <= curT1 && st != et)
+            outWaveTrack.SplitDelete(warper.Warp(st), warper.Warp(et));
+   }
+
    if (bGoodResult)
       outputs.Commit();
 
@@ -488,67 +540,57 @@ bool EffectChangeSpeed::ProcessLabelTrack(LabelTrack *lt)
    return true;
 }
 
-// ProcessOne() takes a track, transforms it to bunch of buffer-blocks,
-// and calls libsamplerate code on these blocks.
-bool EffectChangeSpeed::ProcessOne(
-   const WaveChannel &track, WaveChannel &outputTrack,
-   sampleCount start, sampleCount end)
-{
-   //Get the length of the selection (as double). len is
-   //used simple to calculate a progress meter, so it is easier
-   //to make it a double now than it is to do it later
-   auto len = (end - start).as_double();
-
-   // Initiate processing buffers, most likely shorter than
-   // the length of the selection being processed.
-   auto inBufferSize = track.GetMaxBlockSize();
-
-   Floats inBuffer{ inBufferSize };
-
-   // mFactor is at most 100-fold so this shouldn't overflow size_t
-   auto outBufferSize = size_t( mFactor * inBufferSize + 10 );
-   Floats outBuffer{ outBufferSize };
-
-   // Set up the resampling stuff for this track.
-   Resample resample(true, mFactor, mFactor); // constant rate resampling
-
-   //Go through the track one buffer at a time. samplePos counts which
-   //sample the current buffer starts at.
-   bool bResult = true;
-   auto samplePos = start;
-   while (samplePos < end) {
-      //Get a blockSize of samples (smaller than the size of the buffer)
-      auto blockSize = limitSampleBufferSize(
-         track.GetBestBlockSize(samplePos),
-         end - samplePos
-      );
-
-      //Get the samples from the track and put them in the buffer
-      track.GetFloats(inBuffer.get(), samplePos, blockSize);
-
-      const auto results = resample.Process(mFactor,
-                                    inBuffer.get(),
-                                    blockSize,
-                                    ((samplePos + blockSize) >= end),
-                                    outBuffer.get(),
-                                    outBufferSize);
-      const auto outgen = results.second;
-
-      if (outgen > 0)
-         outputTrack.Append((samplePtr)outBuffer.get(), floatSample,
-                             outgen);
-
-      // Increment samplePos
-      samplePos += results.first;
-
-      // Update the Progress meter
-      if (TrackProgress(mCurTrackNum, (samplePos - start).as_double() / len)) {
-         bResult = false;
-         break;
+// ProcessChannels() reads and writes the channels in this thread, and lets
+// libsamplerate resample steps of them in the thread pool.  The results do
+// not depend on the number of threads.
+bool EffectChangeSpeed::ProcessChannels(const ChannelJobs &jobs)
+{
+   auto &pool = audacity::concurrency::ThreadPool::GetDefault();
+   // Bound the number of channels at once, and so the memory
+   const auto nJobs = std::max<size_t>(1, pool.GetThreadsCount());
+   const auto stepSize =
+      std::max<size_t>(4096, MaxStepOutput / std::max(1.0, mFactor));
+
+   //Get the length of the selections (as double). total is
+   //used simply to calculate a progress meter
+   double total = 0, done = 0;
+   for (const auto &pJob : jobs)
+      total += (pJob->end - pJob->pos).as_double();
+
+   for (size_t first = 0; first < jobs.size(); first += nJobs) {
+      const auto last = std::min(jobs.size(), first + nJobs);
+      while (true) {
+         //Get the samples of a step from each channel not yet finished
+         std::vector<ChannelJob*> active;
+         for (auto ii = first; ii < last; ++ii) {
+            auto &job = *jobs[ii];
+            if (job.pos >= job.end)
+               continue;
+            job.input.resize(limitSampleBufferSize(stepSize, job.end - job.pos));
+            job.channel.GetFloats(job.input.data(), job.pos, job.input.size());
+            active.push_back(&job);
+         }
+         if (active.empty())
+            break;
+
+         pool.ParallelFor(active.size(),
+            [&](size_t ii){ active[ii]->Step(mFactor); });
+
+         for (const auto pJob : active) {
+            if (!pJob->result.empty())
+               pJob->output.Append((samplePtr)pJob->result.data(),
+                  floatSample, pJob->result.size());
+            pJob->pos += pJob->input.size();
+            done += pJob->input.size();
+         }
+
+         // Update the Progress meter
+         if (TotalProgress(done / total))
+            return false;
       }
    }
 
-   return bResult;
+   return true;
 }
 
 // handler implementations for EffectChangeSpeed
@@ -67,8 +67,10 @@ private:
    Gaps FindGaps(
       const WaveTrack &track, const double curT0, const double curT1);
 
-   bool ProcessOne(const WaveChannel &track, WaveChannel &outputTrack,
-      sampleCount start, sampleCount end);
+   struct ChannelJob;
+   using ChannelJobs = std::vector<std::unique_ptr<ChannelJob>>;
+   //! Resample the channels concurrently, a step of each at a time
+   bool ProcessChannels(const ChannelJobs &jobs);
    bool ProcessLabelTrack(LabelTrack *t);
 
    // handlers
@@ -91,7 +93,6 @@ private:
    wxWeakRef<wxWindow> mUIParent{};
 
    // track related
-   int    mCurTrackNum;
    double mCurT0;
    double mCurT1;
 
@@ -30,6 +30,8 @@
 
 #include <math.h>
 
+#include <cstring>
+
 #include <wx/slider.h>
 #include <wx/valgen.h>
 
@@ -39,6 +41,7 @@
 #include "../widgets/valnum.h"
 
 #include "WaveTrack.h"
+#include "concurrency/ThreadPool.h"
 
 enum
 {
@@ -165,22 +168,10 @@ bool EffectClickRemoval::ProcessOne(
    bool bResult = true;
    decltype(len) s = 0;
    Floats buffer{ idealBlockLen };
-   Floats datawindow{ windowSize };
    while ((len - s) > windowSize / 2) {
       auto block = limitSampleBufferSize(idealBlockLen, len - s);
       track.GetFloats(buffer.get(), start + s, block);
-      for (decltype(block) i = 0;
-           i + windowSize / 2 < block; i += windowSize / 2
-      ) {
-         auto wcopy = std::min(windowSize, block - i);
-         for (decltype(wcopy) j = 0; j < wcopy; ++j)
-            datawindow[j] = buffer[i + j];
-         for (auto j = wcopy; j < windowSize; ++j)
-            datawindow[j] = 0;
-         mbDidSomething |= RemoveClicks(windowSize, datawindow.get());
-         for (decltype(wcopy) j = 0; j < wcopy; ++j)
-           buffer[i+j] = datawindow[j];
-      }
+      mbDidSomething |= RemoveClicksInBlock(buffer.get(), block);
 
       if (mbDidSomething) {
          // RemoveClicks() actually did something.
@@ -198,7 +189,73 @@ bool EffectClickRemoval::ProcessOne(
    return bResult;
 }
 
-bool EffectClickRemoval::RemoveClicks(size_t len, float *buffer)
+// Each window overlaps the next by half, and sees the clicks that the one
+// before removed there, so windows are not independent.  But clicks are
+// rare; so all windows are first processed concurrently from the unchanged
+// block, and then, in order, each result is kept if the window began with
+// the samples it was computed from, and otherwise computed again.  The
+// result does not depend on the number of threads.
+bool EffectClickRemoval::RemoveClicksInBlock(float *buffer, size_t block) const
+{
+   const auto step = windowSize / 2;
+   size_t nWindows = 0;
+   while (nWindows * step + step < block)
+      ++nWindows;
+   if (nWindows == 0)
+      return false;
+
+   // A window, from the buffer, padded with zeroes
+   const auto fill = [&](float *window, size_t i) {
+      const auto wcopy = std::min(windowSize, block - i);
+      std::copy(buffer + i, buffer + i + wcopy, window);
+      std::fill(window + wcopy, window + windowSize, 0.0f);
+   };
+
+   // Speculate
+   Floats original{ block };
+   std::copy(buffer, buffer + block, original.get());
+   Floats results{ nWindows * windowSize };
+   std::vector<char> changed(nWindows);
+   const auto speculate = [&](size_t first, size_t last) {
+      for (auto k = first; k < last; ++k) {
+         const auto window = results.get() + k * windowSize;
+         fill(window, k * step);
+         changed[k] = RemoveClicks(windowSize, window);
+      }
+   };
+
+   auto &pool = audacity::concurrency::ThreadPool::GetDefault();
+   // A worker of the pool would do all jobs itself, so don't split then
+   const auto nJobs = pool.IsWorkerThread() ? 1 :
+      std::min(nWindows, std::max<size_t>(1, pool.GetThreadsCount()));
+   const auto perJob = (nWindows + nJobs - 1) / nJobs;
+   pool.ParallelFor(nJobs, [&](size_t job){
+      speculate(job * perJob, std::min(nWindows, (job + 1) * perJob));
+   });
+
+   // Validate in order
+   bool bResult = false;
+   Floats datawindow{ windowSize };
+   for (size_t k = 0; k < nWindows; ++k) {
+      const auto i = k * step;
+      const auto wcopy = std::min(windowSize, block - i);
+      // Only the first half can differ, but the padding of a short window
+      // may reach into it
+      const auto overlap = std::min(step, wcopy);
+      const float *window = results.get() + k * windowSize;
+      bool windowChanged = changed[k];
+      if (memcmp(buffer + i, original.get() + i, overlap * sizeof(float))) {
+         fill(datawindow.get(), i);
+         windowChanged = RemoveClicks(windowSize, datawindow.get());
+         window = datawindow.get();
+      }
+      bResult |= windowChanged;
+      std::copy(window, window + wcopy, buffer + i);
+   }
+   return bResult;
+}
+
+bool EffectClickRemoval::RemoveClicks(size_t len, float *buffer) const
 {
    bool bResult = false; // This effect usually does nothing.
    size_t i;
@@ -207,7 +264,6 @@ bool EffectClickRemoval::RemoveClicks(size_t len, float *buffer)
 
    float msw;
    int ww;
-   int s2 = sep/2;
    Floats ms_seq{ len };
    Floats b2{ len };
 
@@ -225,11 +281,12 @@ bool EffectClickRemoval::RemoveClicks(size_t len, float *buffer)
          ms_seq[j] += ms_seq[j+i];
    }
 
-   /* Cheat by truncating sep to next-lower power of two... */
-   sep = i;
+   /* Cheat by rounding sep up to a power of two... */
+   const size_t span = i;
+   const int s2 = span/2;
 
-   for( i=0; i<len-sep; i++ ) {
-      ms_seq[i] /= sep;
+   for( i=0; i<len-span; i++ ) {
+      ms_seq[i] /= span;
    }
    /* ww runs from about 4 to mClickWidth.  wrc is the reciprocal;
     * chosen so that integer roundoff doesn't clobber us.
@@ -238,7 +295,7 @@ bool EffectClickRemoval::RemoveClicks(size_t len, float *buffer)
    for(wrc=mClickWidth/4; wrc>=1; wrc /= 2) {
       ww = mClickWidth/wrc;
 
-      for( i=0; i<len-sep; i++ ){
+      for( i=0; i<len-span; i++ ){
          msw = 0;
          for( j=0; (int)j<ww; j++) {
             msw += b2[i+s2+j];
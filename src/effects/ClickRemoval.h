@@ -60,7 +60,9 @@ private:
    bool ProcessOne(int count, WaveChannel &track,
       sampleCount start, sampleCount len);
 
-   bool RemoveClicks(size_t len, float *buffer);
+   //! @return whether any clicks were removed
+   bool RemoveClicksInBlock(float *buffer, size_t block) const;
+   bool RemoveClicks(size_t len, float *buffer) const;
 
    void OnWidthText(wxCommandEvent & evt);
    void OnThreshText(wxCommandEvent & evt);
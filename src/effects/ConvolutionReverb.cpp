@@ -0,0 +1,473 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  ConvolutionReverb.cpp
+
+*******************************************************************//**
+
+\class EffectConvolutionReverb
+\brief A reverberation by convolution with a recorded impulse response
+
+*//*******************************************************************/
+#include "ConvolutionReverb.h"
+#include "EffectEditor.h"
+#include "LoadEffects.h"
+
+#include <wx/file.h>
+#include <wx/spinctrl.h>
+#include <wx/textctrl.h>
+
+#include "FileFormats.h"
+#include "PartitionedConvolver.h"
+#include "Resample.h"
+#include "SelectFile.h"
+#include "ShuttleGui.h"
+
+#include "sndfile.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace {
+//! Partition size for destructive processing, trading latency for speed
+constexpr size_t DestructivePartitionSize = 4096;
+//! Partition size for realtime processing, which is also the latency
+constexpr size_t RealtimePartitionSize = 256;
+//! Longer responses are truncated
+constexpr double MaxResponseSeconds = 30.0;
+//! Length of work space, so that realtime processing does not allocate
+constexpr size_t ScratchSize = 4096;
+
+//! Read up to two channels of an audio file, resampled to `rate`, and
+//! normalized so that the louder channel has unit energy
+/*!
+ @return empty if the file can't be read
+ */
+std::vector<std::vector<float>> LoadResponse(
+   const wxString &path, double rate)
+{
+   wxFile f;   // will be closed when it goes out of scope
+   SFFile sndFile;
+   SF_INFO info{};
+   // Use the file descriptor so that wxWidgets opens Unicode names, as in
+   // ImportRaw
+   if (path.empty() || !f.Open(path))
+      return {};
+   sndFile.reset(SFCall<SNDFILE*>(sf_open_fd, f.fd(), SFM_READ, &info, FALSE));
+   if (!sndFile || info.channels < 1 || info.samplerate < 1)
+      return {};
+
+   const size_t nFileChannels = info.channels;
+   const auto frames = std::min(info.frames,
+      static_cast<sf_count_t>(MaxResponseSeconds * info.samplerate));
+   std::vector<float> interleaved(frames * nFileChannels);
+   const auto read = SFCall<sf_count_t>(
+      sf_readf_float, sndFile.get(), interleaved.data(), frames);
+   if (read <= 0)
+      return {};
+
+   const auto nChannels = std::min<size_t>(2, nFileChannels);
+   std::vector<std::vector<float>> result(nChannels);
+   const double factor = rate / info.samplerate;
+   for (size_t iChannel = 0; iChannel < nChannels; ++iChannel) {
+      std::vector<float> samples(read);
+      for (sf_count_t ii = 0; ii < read; ++ii)
+         samples[ii] = interleaved[ii * nFileChannels + iChannel];
+      auto &response = result[iChannel];
+      if (factor == 1.0)
+         response = std::move(samples);
+      else {
+         Resample resample{ true, factor, factor };
+         response.resize(std::ceil(read * factor) + 1);
+         const auto produced = resample.Process(factor,
+            samples.data(), samples.size(), true,
+            response.data(), response.size()).second;
+         response.resize(produced);
+      }
+   }
+
+   double energy = 0;
+   for (const auto &response : result) {
+      double channelEnergy = 0;
+      for (auto sample : response)
+         channelEnergy += double(sample) * sample;
+      energy = std::max(energy, channelEnergy);
+   }
+   if (energy == 0)
+      return {};
+   const auto scale = float(1.0 / std::sqrt(energy));
+   for (auto &response : result)
+      for (auto &sample : response)
+         sample *= scale;
+   return result;
+}
+}
+
+const EffectParameterMethods& EffectConvolutionReverb::Parameters() const
+{
+   static CapturedParameters<EffectConvolutionReverb,
+      ImpulseFile, WetGain, DryGain
+   > parameters;
+   return parameters;
+}
+
+const ComponentInterfaceSymbol EffectConvolutionReverb::Symbol
+{ XO("Convolution Reverb") };
+
+namespace{ BuiltinEffectsModule::Registration< EffectConvolutionReverb > reg; }
+
+struct EffectConvolutionReverb::Instance
+   : public PerTrackEffect::Instance
+   , public EffectInstanceWithBlockSize
+{
+   explicit Instance(const PerTrackEffect& effect)
+      : PerTrackEffect::Instance{ effect }
+      , mScratch(ScratchSize)
+   {}
+
+   bool ProcessInitialize(EffectSettings &settings, double sampleRate,
+      ChannelNames chanMap) override;
+
+   size_t ProcessBlock(EffectSettings& settings,
+      const float* const* inBlock, float* const* outBlock, size_t blockLen)
+      override;
+
+   // Realtime section
+
+   bool RealtimeInitialize(EffectSettings& settings, double sampleRate)
+      override;
+
+   bool RealtimeAddProcessor(EffectSettings& settings, EffectOutputs *,
+      unsigned numChannels, float sampleRate) override;
+
+   bool RealtimeFinalize(EffectSettings& settings) noexcept override;
+
+   bool RealtimeSuspend() override;
+
+   size_t RealtimeProcess(size_t group, EffectSettings& settings,
+      const float* const* inbuf, float* const* outbuf, size_t numSamples)
+      override;
+
+   unsigned GetAudioOutCount() const override
+   {
+      return 2;
+   }
+
+   unsigned GetAudioInCount() const override
+   {
+      return 2;
+   }
+
+   SampleCount GetLatency(const EffectSettings &, double) const override
+   {
+      return mPartitionSize;
+   }
+
+   //! Convolvers for the two channels; the second is null for mono tracks
+   using Processor = std::array<std::unique_ptr<PartitionedConvolver>, 2>;
+
+   //! Load the response if the file or rate changed
+   bool Load(const EffectSettings &settings, double sampleRate);
+   void MakeProcessor(Processor &processor, size_t nChannels) const;
+   size_t Process(Processor &processor, const EffectSettings &settings,
+      const float* const* inBlock, float* const* outBlock, size_t blockLen);
+
+   std::vector<std::vector<float>> mResponse;
+   wxString mLoadedFile;
+   double mLoadedRate{ 0 };
+   size_t mPartitionSize{ DestructivePartitionSize };
+
+   Processor mDestructive;
+   //! One for each realtime processor
+   std::vector<Processor> mProcessors;
+   std::vector<float> mScratch;
+};
+
+bool EffectConvolutionReverb::Instance::Load(
+   const EffectSettings &settings, double sampleRate)
+{
+   const auto &path = GetSettings(settings).mImpulseFile;
+   if (!mResponse.empty() && path == mLoadedFile && sampleRate == mLoadedRate)
+      return true;
+   mResponse = LoadResponse(path, sampleRate);
+   mLoadedFile = path;
+   mLoadedRate = sampleRate;
+   return !mResponse.empty();
+}
+
+void EffectConvolutionReverb::Instance::MakeProcessor(
+   Processor &processor, size_t nChannels) const
+{
+   for (size_t iChannel = 0; iChannel < 2; ++iChannel) {
+      if (iChannel < nChannels) {
+         // A mono response serves both channels
+         const auto &response =
+            mResponse[std::min(iChannel, mResponse.size() - 1)];
+         processor[iChannel] = std::make_unique<PartitionedConvolver>(
+            response.data(), response.size(), mPartitionSize);
+      }
+      else
+         processor[iChannel].reset();
+   }
+}
+
+bool EffectConvolutionReverb::Instance::ProcessInitialize(
+   EffectSettings &settings, double sampleRate, ChannelNames chanMap)
+{
+   mPartitionSize = DestructivePartitionSize;
+   if (!Load(settings, sampleRate)) {
+      EffectUIServices::DoMessageBox(mProcessor,
+         XO("Could not read the impulse response \"%s\".")
+            .Format(GetSettings(settings).mImpulseFile));
+      return false;
+   }
+   const bool stereo = chanMap && chanMap[0] != ChannelNameEOL &&
+      chanMap[1] == ChannelNameFrontRight;
+   MakeProcessor(mDestructive, stereo ? 2 : 1);
+   return true;
+}
+
+size_t EffectConvolutionReverb::Instance::ProcessBlock(
+   EffectSettings& settings,
+   const float* const* inBlock, float* const* outBlock, size_t blockLen)
+{
+   return Process(mDestructive, settings, inBlock, outBlock, blockLen);
+}
+
+bool EffectConvolutionReverb::Instance::RealtimeInitialize(
+   EffectSettings& settings, double sampleRate)
+{
+   SetBlockSize(512);
+   mProcessors.clear();
+   mPartitionSize = RealtimePartitionSize;
+   return Load(settings, sampleRate);
+}
+
+bool EffectConvolutionReverb::Instance::RealtimeAddProcessor(
+   EffectSettings& settings, EffectOutputs *, unsigned, float sampleRate)
+{
+   // Changes of the file take effect here, not during processing, because
+   // reading it is too slow for the audio thread
+   if (!Load(settings, sampleRate))
+      return false;
+   MakeProcessor(mProcessors.emplace_back(), 2);
+   return true;
+}
+
+bool EffectConvolutionReverb::Instance::RealtimeFinalize(
+   EffectSettings&) noexcept
+{
+   mProcessors.clear();
+   return true;
+}
+
+bool EffectConvolutionReverb::Instance::RealtimeSuspend()
+{
+   for (auto &processor : mProcessors)
+      for (auto &pConvolver : processor)
+         if (pConvolver)
+            pConvolver->Reset();
+   return true;
+}
+
+size_t EffectConvolutionReverb::Instance::RealtimeProcess(size_t group,
+   EffectSettings& settings,
+   const float* const* inbuf, float* const* outbuf, size_t numSamples)
+{
+   if (group >= mProcessors.size())
+      return 0;
+   return Process(mProcessors[group], settings, inbuf, outbuf, numSamples);
+}
+
+size_t EffectConvolutionReverb::Instance::Process(Processor &processor,
+   const EffectSettings &settings,
+   const float* const* inBlock, float* const* outBlock, size_t blockLen)
+{
+   const auto &cs = GetSettings(settings);
+   const auto wet = float(DB_TO_LINEAR(cs.mWetGain));
+   const auto dry = float(DB_TO_LINEAR(cs.mDryGain));
+   const auto scratch = mScratch.data();
+   for (size_t iChannel = 0; iChannel < 2; ++iChannel) {
+      const auto &pConvolver = processor[iChannel];
+      if (!pConvolver)
+         continue;
+      const float *in = inBlock[iChannel];
+      float *out = outBlock[iChannel];
+      // Input and output may be the same
+      for (size_t done = 0; done < blockLen;) {
+         const auto count = std::min(blockLen - done, ScratchSize);
+         pConvolver->Process(in + done, scratch, count);
+         for (size_t ii = 0; ii < count; ++ii)
+            out[done + ii] = dry * in[done + ii] + wet * scratch[ii];
+         done += count;
+      }
+   }
+   return blockLen;
+}
+
+std::shared_ptr<EffectInstance>
+EffectConvolutionReverb::MakeInstance() const
+{
+   return std::make_shared<Instance>(*this);
+}
+
+EffectConvolutionReverb::EffectConvolutionReverb()
+{
+   SetLinearEffectFlag(true);
+}
+
+EffectConvolutionReverb::~EffectConvolutionReverb()
+{
+}
+
+// ComponentInterface implementation
+
+ComponentInterfaceSymbol EffectConvolutionReverb::GetSymbol() const
+{
+   return Symbol;
+}
+
+TranslatableString EffectConvolutionReverb::GetDescription() const
+{
+   return XO("Applies the reverberation of a recorded impulse response");
+}
+
+ManualPageID EffectConvolutionReverb::ManualPage() const
+{
+   return L"Convolution_Reverb";
+}
+
+// EffectDefinitionInterface implementation
+
+EffectType EffectConvolutionReverb::GetType() const
+{
+   return EffectTypeProcess;
+}
+
+auto EffectConvolutionReverb::RealtimeSupport() const -> RealtimeSince
+{
+   return RealtimeSince::Always;
+}
+
+struct EffectConvolutionReverb::Editor
+   : EffectEditor
+{
+   Editor(const EffectUIServices& services, EffectSettingsAccess& access,
+      const EffectConvolutionReverbSettings& settings
+   )  : EffectEditor{ services, access }
+      , mSettings{ settings }
+   {}
+   virtual ~Editor() = default;
+
+   bool ValidateUI() override;
+   bool UpdateUI() override;
+
+   void PopulateOrExchange(ShuttleGui& S);
+
+   void OnBrowse(wxCommandEvent &evt);
+   void OnChange(wxCommandEvent &evt);
+
+   EffectConvolutionReverbSettings mSettings;
+
+   wxTextCtrl *mImpulseFileT{};
+   wxSpinCtrl *mWetGainT{};
+   wxSpinCtrl *mDryGainT{};
+};
+
+std::unique_ptr<EffectEditor> EffectConvolutionReverb::MakeEditor(
+   ShuttleGui & S, EffectInstance &, EffectSettingsAccess &access,
+   const EffectOutputs *) const
+{
+   auto& settings = access.Get();
+   auto& myEffSettings = GetSettings(settings);
+   auto result = std::make_unique<Editor>(*this, access, myEffSettings);
+   result->PopulateOrExchange(S);
+   return result;
+}
+
+void EffectConvolutionReverb::Editor::PopulateOrExchange(ShuttleGui & S)
+{
+   S.AddSpace(0, 5);
+
+   S.StartMultiColumn(3, wxEXPAND);
+   {
+      S.SetStretchyCol(1);
+      mImpulseFileT = S.AddTextBox(
+         XXO("&Impulse response:"), mSettings.mImpulseFile, 40);
+      BindTo(*mImpulseFileT, wxEVT_TEXT, &Editor::OnChange);
+      BindTo(*S.AddButton(XXO("&Browse...")),
+         wxEVT_BUTTON, &Editor::OnBrowse);
+   }
+   S.EndMultiColumn();
+
+   S.StartMultiColumn(2, wxALIGN_CENTER);
+   {
+      mWetGainT = S.AddSpinCtrl(XXO("&Wet Gain (dB):"),
+         mSettings.mWetGain, WetGain.max, WetGain.min);
+      BindTo(*mWetGainT, wxEVT_SPINCTRL, &Editor::OnChange);
+      mDryGainT = S.AddSpinCtrl(XXO("Dr&y Gain (dB):"),
+         mSettings.mDryGain, DryGain.max, DryGain.min);
+      BindTo(*mDryGainT, wxEVT_SPINCTRL, &Editor::OnChange);
+   }
+   S.EndMultiColumn();
+}
+
+bool EffectConvolutionReverb::Editor::ValidateUI()
+{
+   mSettings.mImpulseFile = mImpulseFileT->GetValue();
+   mSettings.mWetGain = mWetGainT->GetValue();
+   mSettings.mDryGain = mDryGainT->GetValue();
+
+   mAccess.ModifySettings
+   (
+      [this](EffectSettings& settings)
+      {
+         // pass back the modified settings to the MessageBuffer
+
+         EffectConvolutionReverb::GetSettings(settings) = mSettings;
+         return nullptr;
+      }
+   );
+
+   return true;
+}
+
+bool EffectConvolutionReverb::Editor::UpdateUI()
+{
+   // get the settings from the MessageBuffer and write them to our local copy
+   mSettings = GetSettings(mAccess.Get());
+
+   mImpulseFileT->ChangeValue(mSettings.mImpulseFile);
+   mWetGainT->SetValue(int(mSettings.mWetGain));
+   mDryGainT->SetValue(int(mSettings.mDryGain));
+
+   return true;
+}
+
+void EffectConvolutionReverb::Editor::OnBrowse(wxCommandEvent &)
+{
+   const auto path = SelectFile(FileNames::Operation::Open,
+      XO("Select an Impulse Response"),
+      wxEmptyString,
+      wxEmptyString,
+      wxEmptyString,
+      {
+         { XO("Audio files"), sf_get_all_extensions() },
+         FileNames::AllFiles
+      },
+      wxFD_OPEN | wxRESIZE_BORDER,
+      nullptr);
+
+   // User canceled...
+   if (path.empty())
+      return;
+
+   mImpulseFileT->SetValue(path);
+}
+
+void EffectConvolutionReverb::Editor::OnChange(wxCommandEvent &)
+{
+   ValidateUI();
+}
@@ -60,17 +60,24 @@ const EnumValueSymbol EffectDistortion::kTableTypeStrings[nTableTypes] =
    { XO("Hard Limiter 1413") }
 };
 
+const EnumValueSymbol
+EffectDistortion::kOversamplingStrings[nOversamplingFactors] =
+{
+   { XO("None") },
+   { XO("2x") },
+   { XO("4x") },
+   { XO("8x") }
+};
+
 const EffectParameterMethods& EffectDistortion::Parameters() const
 {
    static CapturedParameters<EffectDistortion,
-      TableTypeIndx, DCBlock, Threshold_dB, NoiseFloor, Param1, Param2, Repeats
+      TableTypeIndx, DCBlock, Threshold_dB, NoiseFloor, Param1, Param2, Repeats,
+      OversamplingFactor
    > parameters;
    return parameters;
 }
 
-// How many samples are processed before recomputing the lookup table again
-#define skipsamples 1000
-
 static const struct
 {
    const TranslatableString name;
@@ -147,6 +154,7 @@ struct EffectDistortion::Editor
 
    // Control Handlers
    void OnTypeChoice(wxCommandEvent& evt);
+   void OnOversamplingChoice(wxCommandEvent& evt);
    void OnDCBlockCheckbox(wxCommandEvent& evt);
    void OnThresholdText(wxCommandEvent& evt);
    void OnThresholdSlider(wxCommandEvent& evt);
@@ -160,6 +168,7 @@ struct EffectDistortion::Editor
    void OnRepeatsSlider(wxCommandEvent& evt);
 
    wxChoice* mTypeChoiceCtrl;
+   wxChoice* mOversamplingChoiceCtrl;
    wxTextCtrl* mThresholdT;
    wxTextCtrl* mNoiseFloorT;
    wxTextCtrl* mParam1T;
@@ -293,7 +302,9 @@ struct EffectDistortion::Instance
    // Cubic formula: y = x - (x^3 / 3.0)
    inline double Cubic(const EffectDistortionSettings&, double x);
 
-   float WaveShaper(float sample, EffectDistortionSettings& ms);
+   //! Shape samples in place, then mix them with the unshaped samples
+   void WaveShaper(float* samples, size_t len,
+      float preGain, double wet, double dry) const;
    float DCFilter(EffectDistortionState& data, float sample);
 
    unsigned GetAudioInCount() const override;
@@ -486,6 +497,19 @@ void EffectDistortion::Editor::PopulateOrExchange(ShuttleGui& S)
          BindTo(*mDCBlockCheckBox, wxEVT_CHECKBOX, &Editor::OnDCBlockCheckbox);
       }
       S.EndMultiColumn();
+
+      S.StartMultiColumn(2, wxCENTER);
+      {
+         mOversamplingChoiceCtrl = S
+            .MinSize( { -1, -1 } )
+            .Validator<wxGenericValidator>(&ms.mOversampling)
+            .AddChoice(XXO("Oversampling:"),
+               Msgids(kOversamplingStrings, nOversamplingFactors));
+
+         BindTo(*mOversamplingChoiceCtrl, wxEVT_CHOICE,
+            &Editor::OnOversamplingChoice);
+      }
+      S.EndMultiColumn();
       S.AddSpace(0, 10);
 
 
@@ -657,7 +681,6 @@ void EffectDistortion::Instance::InstanceInit(EffectDistortionState& data, Effec
    auto& ms = GetSettings(settings);
   
    data.samplerate = sampleRate;
-   data.skipcount = 0;
    data.tablechoiceindx = ms.mTableChoiceIndx;
    data.dcblock         = ms.mDCBlock;
    data.threshold       = ms.mThreshold_dB;
@@ -673,6 +696,9 @@ void EffectDistortion::Instance::InstanceInit(EffectDistortionState& data, Effec
    while (!data.queuesamples.empty())
       data.queuesamples.pop();
 
+   data.oversampler.SetFactor(1u << ms.mOversampling);
+   data.oversampler.Reset();
+
    MakeTable(data, ms);
 
    return;
@@ -701,57 +727,52 @@ size_t EffectDistortion::Instance::InstanceProcess(EffectSettings &settings,
    data.threshold = ms.mThreshold_dB;
    data.noisefloor = ms.mNoiseFloor;
    data.param1 = ms.mParam1;
+   data.param2 = ms.mParam2;
    data.repeats = ms.mRepeats;
 
-   for (decltype(blockLen) i = 0; i < blockLen; i++) {
-      if (update && ((data.skipcount++) % skipsamples == 0)) {
-         MakeTable(data, ms);
-      }
+   if (update)
+      MakeTable(data, ms);
 
-      switch (ms.mTableChoiceIndx)
-      {
-      case kHardClip:
-         // Param2 = make-up gain.
-         obuf[i] = WaveShaper(ibuf[i], ms) * ((1 - p2) + (data.mMakeupGain * p2));
-         break;
-      case kSoftClip:
-         // Param2 = make-up gain.
-         obuf[i] = WaveShaper(ibuf[i], ms) * ((1 - p2) + (data.mMakeupGain * p2));
-         break;
-      case kHalfSinCurve:
-         obuf[i] = WaveShaper(ibuf[i], ms) * p2;
-         break;
-      case kExpCurve:
-         obuf[i] = WaveShaper(ibuf[i], ms) * p2;
-         break;
-      case kLogCurve:
-         obuf[i] = WaveShaper(ibuf[i], ms) * p2;
-         break;
-      case kCubic:
-         obuf[i] = WaveShaper(ibuf[i], ms) * p2;
-         break;
-      case kEvenHarmonics:
-         obuf[i] = WaveShaper(ibuf[i], ms);
-         break;
-      case kSinCurve:
-         obuf[i] = WaveShaper(ibuf[i], ms) * p2;
-         break;
-      case kLeveller:
-         obuf[i] = WaveShaper(ibuf[i], ms);
-         break;
-      case kRectifier:
-         obuf[i] = WaveShaper(ibuf[i], ms);
-         break;
-      case kHardLimiter:
-         // Mix equivalent to LADSPA effect's "Wet / Residual" mix
-         obuf[i] = (WaveShaper(ibuf[i], ms) * (p1 - p2)) + (ibuf[i] * p2);
-         break;
-      default:
-         obuf[i] = WaveShaper(ibuf[i], ms);
-      }
-      if (ms.mDCBlock) {
+   // Pre-gain, and gains of the shaped and of the unshaped samples
+   float preGain = 1;
+   double wet = 1;
+   double dry = 0;
+   switch (ms.mTableChoiceIndx)
+   {
+   case kHardClip:
+      // Param1 = pre-gain, Param2 = make-up gain.
+      preGain = 1 + p1;
+      wet = (1 - p2) + (data.mMakeupGain * p2);
+      break;
+   case kSoftClip:
+      // Param2 = make-up gain.
+      wet = (1 - p2) + (data.mMakeupGain * p2);
+      break;
+   case kHalfSinCurve:
+   case kExpCurve:
+   case kLogCurve:
+   case kCubic:
+   case kSinCurve:
+      wet = p2;
+      break;
+   case kHardLimiter:
+      // Mix equivalent to LADSPA effect's "Wet / Residual" mix
+      wet = p1 - p2;
+      dry = p2;
+      break;
+   default:
+      break;
+   }
+
+   data.oversampler.SetFactor(1u << ms.mOversampling);
+   data.oversampler.Process(ibuf, obuf, blockLen,
+      [&](float *samples, size_t len){
+         WaveShaper(samples, len, preGain, wet, dry);
+      });
+
+   if (ms.mDCBlock) {
+      for (decltype(blockLen) i = 0; i < blockLen; i++)
          obuf[i] = DCFilter(data, obuf[i]);
-      }
    }
 
    return blockLen;
@@ -767,6 +788,14 @@ void EffectDistortion::Editor::OnTypeChoice(wxCommandEvent& /*evt*/)
    Publish(EffectSettingChanged{});
 }
 
+void EffectDistortion::Editor::OnOversamplingChoice(wxCommandEvent& /*evt*/)
+{
+   mOversamplingChoiceCtrl->GetValidator()->TransferFromWindow();
+
+   ValidateUI();
+   Publish(EffectSettingChanged{});
+}
+
 void EffectDistortion::Editor::OnDCBlockCheckbox(wxCommandEvent& /*evt*/)
 {
    auto& ms = mSettings;
@@ -1498,33 +1527,25 @@ void EffectDistortion::Instance::CopyHalfTable()
 }
 
 
-float EffectDistortion::Instance::WaveShaper(float sample, EffectDistortionSettings& ms)
+void EffectDistortion::Instance::WaveShaper(float* samples, size_t len,
+   float preGain, double wet, double dry) const
 {
-   float out;
-   int index;
-   double xOffset;
-   double amount = 1;
+   // Without branches, so that the loop may be vectorized
+   for (size_t i = 0; i < len; i++) {
+      const float in = samples[i];
+      const float sample = in * preGain;
 
-   switch (ms.mTableChoiceIndx)
-   {
-      // Do any pre-processing here
-      case kHardClip:
-         // Pre-gain
-         amount = ms.mParam1 / 100.0;
-         sample *= 1+amount;
-         break;
-      default: break;
-   }
-
-   index = std::floor(sample * STEPS) + STEPS;
-   index = wxMax<int>(wxMin<int>(index, 2 * STEPS - 1), 0);
-   xOffset = ((1 + sample) * STEPS) - index;
-   xOffset = wxMin<double>(wxMax<double>(xOffset, 0.0), 1.0);   // Clip at 0dB
+      int index = std::floor(sample * STEPS) + STEPS;
+      index = std::max<int>(std::min<int>(index, 2 * STEPS - 1), 0);
+      double xOffset = ((1 + sample) * STEPS) - index;
+      xOffset = std::min<double>(std::max<double>(xOffset, 0.0), 1.0);   // Clip at 0dB
 
-   // linear interpolation: y = y0 + (y1-y0)*(x-x0)
-   out = mTable[index] + (mTable[index + 1] - mTable[index]) * xOffset;
+      // linear interpolation: y = y0 + (y1-y0)*(x-x0)
+      const float out =
+         mTable[index] + (mTable[index + 1] - mTable[index]) * xOffset;
 
-   return out;
+      samples[i] = out * wet + in * dry;
+   }
 }
 
 
@@ -15,6 +15,7 @@
 
 #include "StatelessPerTrackEffect.h"
 #include "ShuttleAutomation.h"
+#include "Oversampling.h"
 
 class ShuttleGui;
 
@@ -27,7 +28,6 @@ class EffectDistortionState
 {
 public:
    float       samplerate;
-   sampleCount skipcount;
    int         tablechoiceindx;
    bool        dcblock;
    double      threshold;
@@ -40,6 +40,9 @@ public:
    std::queue<float> queuesamples;
    double queuetotal;
 
+   // Shaping is done at a multiple of the rate, to avoid aliasing
+   Oversampling::Oversampler oversampler;
+
    bool mbSavedFilterState{ defaultDCBlock };
 
    // mMakeupGain is used by some distortion types to pass the
@@ -57,6 +60,7 @@ struct EffectDistortionSettings
    static constexpr double mDefaultParam1          =  50.0;
    static constexpr double mDefaultParam2          =  50.0;
    static constexpr int    mDefaultRepeats         = 1;
+   static constexpr int    mDefaultOversampling    = 0;
 
    int    mTableChoiceIndx{ mDefaultTableChoiceIndx };
    bool   mDCBlock        { mDefaultDCBlock };
@@ -65,6 +69,8 @@ struct EffectDistortionSettings
    double mParam1         { mDefaultParam1 };
    double mParam2         { mDefaultParam2 };
    int    mRepeats        { mDefaultRepeats };
+   //! Index of the factor, 1, 2, 4 or 8
+   int    mOversampling   { mDefaultOversampling };
 };
 
 
@@ -145,6 +151,17 @@ private:
 
    static const EnumValueSymbol kTableTypeStrings[nTableTypes];
 
+   enum kOversamplingFactor
+   {
+      kOversampleNone,
+      kOversample2x,
+      kOversample4x,
+      kOversample8x,
+      nOversamplingFactors
+   };
+
+   static const EnumValueSymbol kOversamplingStrings[nOversamplingFactors];
+
 // (Note: 'Repeats' is the total number of times the effect is applied.)
 static constexpr EnumParameter TableTypeIndx
 { &EffectDistortionSettings::mTableChoiceIndx, L"Type",
@@ -174,6 +191,10 @@ static constexpr EffectParameter Repeats{
    &EffectDistortionSettings::mRepeats,  L"Repeats",
     EffectDistortionSettings::mDefaultRepeats,       0,       5,                  1    };
 
+static constexpr EnumParameter OversamplingFactor
+{ &EffectDistortionSettings::mOversampling, L"Oversampling",
+   EffectDistortionSettings::mDefaultOversampling,   0,      nOversamplingFactors-1,    1, kOversamplingStrings, nOversamplingFactors    };
+
 };
 
 #endif
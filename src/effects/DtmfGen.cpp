@@ -17,6 +17,7 @@
 #include "DtmfGen.h"
 #include "EffectEditor.h"
 #include "LoadEffects.h"
+#include "Oscillators.h"
 
 #include <wx/slider.h>
 #include <wx/valgen.h>
@@ -552,7 +553,7 @@ bool EffectDtmf::MakeDtmfTone(float *buffer, size_t len, float fs, wxChar tone,
 */
 
    float f1, f2=0.0;
-   double A,B;
+   double A;
 
    // select low tone: left column
    switch (tone) {
@@ -606,17 +607,27 @@ bool EffectDtmf::MakeDtmfTone(float *buffer, size_t len, float fs, wxChar tone,
          f2=0;
    }
 
-   // precalculations
-   A=B=2*M_PI/fs;
-   A*=f1;
-   B*=f2;
+   // precalculations: cycles per sample
+   const double cycles1 = f1 / fs, cycles2 = f2 / fs;
 
    // now generate the wave: 'last' is used to avoid phase errors
    // when inside the inner for loop of the Process() function.
-   for(decltype(len) i = 0; i < len; i++) {
-      buffer[i] = amplitude * 0.5 *
-         (sin( A * (i + last).as_double() ) +
-          sin( B * (i + last).as_double() ));
+   // Phases of the first tone go into buffer and of the second into phases,
+   // a chunk at a time, and then become sines
+   constexpr size_t chunkSize = 256;
+   float phases[chunkSize];
+   for (decltype(len) i = 0; i < len; i += chunkSize) {
+      const auto n = std::min(chunkSize, len - i);
+      for (size_t j = 0; j < n; j++) {
+         const auto t = (i + j + last).as_double();
+         const auto p1 = cycles1 * t, p2 = cycles2 * t;
+         buffer[i + j] = p1 - floor(p1 + 0.5);
+         phases[j] = p2 - floor(p2 + 0.5);
+      }
+      Oscillators::Sine(buffer + i, buffer + i, n);
+      Oscillators::Sine(phases, phases, n);
+      for (size_t j = 0; j < n; j++)
+         buffer[i + j] = amplitude * 0.5 * (buffer[i + j] + phases[j]);
    }
 
    // generate a fade-in of duration 1/250th of second
@@ -9,7 +9,10 @@ Max Maisel
 ***********************************************************************/
 
 #include "EBUR128.h"
+#include "concurrency/ThreadPool.h"
+#include <algorithm>
 #include <cstring>
+#include <numeric>
 
 EBUR128::EBUR128(double rate, size_t channels)
    : mChannelCount{ channels }
@@ -19,16 +22,53 @@ EBUR128::EBUR128(double rate, size_t channels)
 {
    mLoudnessHist.reinit(HIST_BIN_COUNT, false);
    mBlockRingBuffer.reinit(mBlockSize);
-   mWeightingFilter.reinit(mChannelCount, false);
-   for(size_t channel = 0; channel < mChannelCount; ++channel)
-      mWeightingFilter[channel] = CalcWeightingFilter(mRate);
+   mWeightingFilter = MakeWeightingFilters();
+
+   memset(mLoudnessHist.get(), 0, HIST_BIN_COUNT*sizeof(long int));
+   // Make the table now, and not where allocation is not allowed
+   BinPowers();
+}
+
+void EBUR128::Reserve(size_t len)
+{
+   mPowers.reserve(len);
+}
 
+void EBUR128::Reset()
+{
    memset(mLoudnessHist.get(), 0, HIST_BIN_COUNT*sizeof(long int));
    for(size_t channel = 0; channel < mChannelCount; ++channel)
-   {
-      mWeightingFilter[channel][0].Reset();
-      mWeightingFilter[channel][1].Reset();
-   }
+      mWeightingFilter[channel].Reset();
+   mSampleCount = 0;
+   mBlockRingPos = 0;
+   mBlockRingSize = 0;
+   mBlockCount = 0;
+   mMomentaryPower = 0;
+   std::fill(mHopPowers, mHopPowers + SHORT_TERM_HOPS, 0.0);
+   std::fill(mHopLengths, mHopLengths + SHORT_TERM_HOPS, 0);
+   mHopPos = 0;
+   mHopPower = 0;
+   mHopLength = 0;
+}
+
+const double *EBUR128::BinPowers()
+{
+   static const auto powers = []{
+      std::vector<double> result(HIST_BIN_COUNT);
+      for(size_t i = 0; i < HIST_BIN_COUNT; ++i)
+         result[i] = pow(10, -GAMMA_A / double(HIST_BIN_COUNT) * (i+1) + GAMMA_A);
+      return result;
+   }();
+   return powers.data();
+}
+
+ArrayOf<BiquadCascade> EBUR128::MakeWeightingFilters() const
+{
+   ArrayOf<BiquadCascade> filters{ mChannelCount, false };
+   const auto sections = CalcWeightingFilter(mRate);
+   for(size_t channel = 0; channel < mChannelCount; ++channel)
+      filters[channel] = BiquadCascade{ sections.get(), 2 };
+   return filters;
 }
 
 // fs: sample rate
@@ -83,8 +123,7 @@ ArrayOf<Biquad> EBUR128::CalcWeightingFilter(double fs)
 void EBUR128::ProcessSampleFromChannel(float x_in, size_t channel) const
 {
    double value;
-   value = mWeightingFilter[channel][0].ProcessOne(x_in);
-   value = mWeightingFilter[channel][1].ProcessOne(value);
+   mWeightingFilter[channel].Process(&x_in, &value, 1);
    if(channel == 0)
       mBlockRingBuffer[mBlockRingPos] = value * value;
    else
@@ -97,11 +136,25 @@ void EBUR128::ProcessSampleFromChannel(float x_in, size_t channel) const
 
 void EBUR128::NextSample()
 {
-   ++mBlockRingPos;
-   ++mBlockRingSize;
+   mHopPower += mBlockRingBuffer[mBlockRingPos];
+   Advance(1);
+}
+
+void EBUR128::Advance(size_t n)
+{
+   mBlockRingPos += n;
+   mBlockRingSize += n;
+   mHopLength += n;
 
    if(mBlockRingPos % mBlockOverlap == 0)
    {
+      // The hop ends
+      mHopPowers[mHopPos] = mHopPower;
+      mHopLengths[mHopPos] = mHopLength;
+      mHopPos = (mHopPos + 1) % SHORT_TERM_HOPS;
+      mHopPower = 0;
+      mHopLength = 0;
+
       // A new full block of samples was submitted.
       if(mBlockRingSize >= mBlockSize)
          AddBlockToHistogram(mBlockSize);
@@ -109,24 +162,103 @@ void EBUR128::NextSample()
    // Close the ring.
    if(mBlockRingPos == mBlockSize)
       mBlockRingPos = 0;
-   ++mSampleCount;
+   mSampleCount += n;
 }
 
-double EBUR128::IntegrativeLoudness()
+void EBUR128::ProcessSamples(const float *const *channels, size_t len)
 {
-   // EBU R128: z_i = mean square without root
+   const size_t warmUp = ceil(WarmUpSeconds * mRate);
+   auto &pool = audacity::concurrency::ThreadPool::GetDefault();
+   // A worker of the pool would weigh all stretches itself, so don't split
+   // then; and make stretches long compared with the warm-up they repeat
+   const size_t nStretches = pool.IsWorkerThread()
+      ? 1 : std::clamp<size_t>(len / (8 * warmUp), 1, pool.GetThreadsCount());
 
-   // Calculate Gamma_R from histogram.
+   // Filters of the first stretch continue from the previous call; don't
+   // allocate for the others if there are none
+   std::vector<ArrayOf<BiquadCascade>> filters;
+   if (nStretches > 1)
+      filters.resize(nStretches);
+   for (size_t ii = 1; ii < nStretches; ++ii)
+      filters[ii] = MakeWeightingFilters();
+
+   mPowers.resize(len);
+   const auto weigh = [&](size_t ii) {
+      auto &stretchFilters = ii == 0 ? mWeightingFilter : filters[ii];
+      const auto begin = len * ii / nStretches;
+      const auto end = len * (ii + 1) / nStretches;
+      const auto warmUpBegin = ii == 0 ? begin : begin - warmUp;
+      // Filter outputs, in chunks
+      constexpr size_t chunkSize = 512;
+      double values[chunkSize];
+      for (size_t channel = 0; channel < mChannelCount; ++channel) {
+         auto &filter = stretchFilters[channel];
+         const auto pIn = channels[channel];
+         for (auto i = warmUpBegin; i < begin;) {
+            const auto n = std::min(chunkSize, begin - i);
+            filter.Process(pIn + i, values, n);
+            i += n;
+         }
+         for (auto i = begin; i < end;) {
+            const auto n = std::min(chunkSize, end - i);
+            filter.Process(pIn + i, values, n);
+            // Add the power of additional channels as in
+            // ProcessSampleFromChannel()
+            for (size_t j = 0; j < n; ++j) {
+               if (channel == 0)
+                  mPowers[i + j] = values[j] * values[j];
+               else
+                  mPowers[i + j] += values[j] * values[j];
+            }
+            i += n;
+         }
+      }
+   };
+
+   pool.ParallelFor(nStretches, weigh);
+
+   // The next call continues from the end of the last stretch
+   if (nStretches > 1)
+      std::swap(mWeightingFilter, filters[nStretches - 1]);
+
+   // As NextSample() for each, but in runs up to where it would do more
+   // than count
+   for (size_t i = 0; i < len;) {
+      const auto n = std::min({ len - i,
+         mBlockOverlap - mBlockRingPos % mBlockOverlap,
+         mBlockSize - mBlockRingPos });
+      const auto first = mPowers.begin() + i;
+      std::copy(first, first + n, &mBlockRingBuffer[mBlockRingPos]);
+      mHopPower = std::accumulate(first, first + n, mHopPower);
+      Advance(n);
+      i += n;
+   }
+}
+
+double EBUR128::IntegrativeLoudness()
+{
    double sum_v;
    long int sum_c;
    HistogramSums(0, sum_v, sum_c);
 
    // Handle incomplete block if no non-zero block was found.
    if(sum_c == 0)
-   {
       AddBlockToHistogram(mBlockRingSize);
-      HistogramSums(0, sum_v, sum_c);
-   }
+
+   return GatedLoudness();
+}
+
+double EBUR128::GatedLoudness() const
+{
+   // EBU R128: z_i = mean square without root
+
+   // Calculate Gamma_R from histogram.
+   double sum_v;
+   long int sum_c;
+   HistogramSums(0, sum_v, sum_c);
+   if(sum_c == 0)
+      // Nothing above the absolute threshold
+      return 0;
 
    // Histogram values are simplified log(x^2) immediate values
    // without -0.691 + 10*(...) to safe computing power. This is
@@ -142,19 +274,36 @@ double EBUR128::IntegrativeLoudness()
       // Silence was processed.
       return 0;
    // LUFS is defined as -0.691 dB + 10*log10(sum(channels))
-   return 0.8529037031 * sum_v / sum_c;
+   return LOUDNESS_SCALE * sum_v / sum_c;
+}
+
+double EBUR128::MomentaryLoudness() const
+{
+   return LOUDNESS_SCALE * mMomentaryPower;
+}
+
+double EBUR128::ShortTermLoudness() const
+{
+   double power = std::accumulate(mHopPowers, mHopPowers + SHORT_TERM_HOPS, 0.0);
+   size_t length = std::accumulate(mHopLengths, mHopLengths + SHORT_TERM_HOPS, size_t{ 0 });
+   if(length == 0)
+   {
+      // Not yet one hop
+      power = mHopPower;
+      length = mHopLength;
+   }
+   return length == 0 ? 0 : LOUDNESS_SCALE * power / length;
 }
 
 void
 EBUR128::HistogramSums(size_t start_idx, double& sum_v, long int& sum_c) const
 {
-    double val;
+    const auto powers = BinPowers();
     sum_v = 0;
     sum_c = 0;
     for(size_t i = start_idx; i < HIST_BIN_COUNT; ++i)
     {
-       val = -GAMMA_A / double(HIST_BIN_COUNT) * (i+1) + GAMMA_A;
-       sum_v += pow(10, val) * mLoudnessHist[i];
+       sum_v += powers[i] * mLoudnessHist[i];
        sum_c += mLoudnessHist[i];
     }
 }
@@ -170,6 +319,8 @@ void EBUR128::AddBlockToHistogram(size_t validLen)
    // The actual value of mBlockRingSize does not matter
    // since this is only used to detect if blocks are complete (>= mBlockSize).
    mBlockRingSize = mBlockSize;
+   if(validLen == 0)
+      return;
 
    size_t idx;
    double blockVal = 0;
@@ -180,7 +331,9 @@ void EBUR128::AddBlockToHistogram(size_t validLen)
    // without -0.691 + 10*(...) to safe computing power. This is
    // possible because these constant cancel out anyway during the
    // following processing steps.
-   blockVal = log10(blockVal/double(validLen));
+   ++mBlockCount;
+   mMomentaryPower = blockVal/double(validLen);
+   blockVal = log10(mMomentaryPower);
    // log(blockVal) is within ]-inf, 1]
    idx = round((blockVal - GAMMA_A) * double(HIST_BIN_COUNT) / -GAMMA_A - 1);
 
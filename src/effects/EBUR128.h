@@ -16,6 +16,7 @@ Max Maisel
 #include "SampleFormat.h"
 
 #include <cmath>
+#include <vector>
 
 /// \brief Implements EBU-R128 loudness measurement.
 class EBUR128
@@ -29,17 +30,58 @@ public:
    static ArrayOf<Biquad> CalcWeightingFilter(double fs);
    void ProcessSampleFromChannel(float x_in, size_t channel) const;
    void NextSample();
+   //! Same as ProcessSampleFromChannel() for each channel, then NextSample(),
+   //! for each of `len` samples
+   /*!
+    The weighting filters, which are the costly part, run on the thread pool
+    for long enough buffers, in stretches.  The filters of each stretch but
+    the first start from rest WarmUpSeconds before it, and by then settle to
+    within rounding of their uninterrupted state.
+    @param channels one pointer for each channel
+    */
+   void ProcessSamples(const float *const *channels, size_t len);
+   //! Let ProcessSamples() take up to len samples without allocating
+   /*! Buffers so short also don't use the thread pool, so that the audio
+    thread may measure them */
+   void Reserve(size_t len);
+   //! Forget all samples, as if newly constructed; does not allocate
+   void Reset();
    double IntegrativeLoudness();
+   //! Like IntegrativeLoudness(), but of full blocks only, and without
+   //! changing the histogram, so that it may be asked while samples are
+   //! still coming; 0 before the first full block
+   double GatedLoudness() const;
+   //! Loudness of the latest full 400 ms block, or 0 before there is one
+   double MomentaryLoudness() const;
+   //! Loudness of the latest 3 s, or of all samples if fewer
+   double ShortTermLoudness() const;
+   //! Count of blocks added to the histogram; the loudnesses above change
+   //! only when this does
+   size_t GetBlockCount() const { return mBlockCount; }
    inline double IntegrativeLoudnessToLUFS(double loudness)
       { return 10 * log10(loudness); }
 
 private:
    void HistogramSums(size_t start_idx, double& sum_v, long int& sum_c) const;
    void AddBlockToHistogram(size_t validLen);
+   //! Count n more samples in the ring, and add any block that completes
+   /*! @pre n does not pass the next multiple of mBlockOverlap, or the end
+    of the ring */
+   void Advance(size_t n);
+   //! Loudness, as histogram sums are, of each bin
+   static const double *BinPowers();
+   //! Weighting filters of all channels, at rest
+   ArrayOf<BiquadCascade> MakeWeightingFilters() const;
 
    static constexpr size_t HIST_BIN_COUNT = 65536;
+   /// The weighting filters decay by many orders of magnitude in this time
+   static constexpr double WarmUpSeconds = 0.5;
    /// EBU R128 absolute threshold
    static constexpr double GAMMA_A = (-70.0 + 0.691) / 10.0;
+   /// BS.1770 scale of mean squares to loudness, 10^(-0.691 / 10)
+   static constexpr double LOUDNESS_SCALE = 0.8529037031;
+   /// Hops of 100 ms in the short-term window of 3 s
+   static constexpr size_t SHORT_TERM_HOPS = 30;
    ArrayOf<long int> mLoudnessHist;
    Doubles mBlockRingBuffer;
    size_t mSampleCount{ 0 };
@@ -49,12 +91,24 @@ private:
    const double mRate;
    const size_t mBlockSize;
    const size_t mBlockOverlap;
+   size_t mBlockCount{ 0 };
+   /// Mean square of the latest block added to the histogram
+   double mMomentaryPower{ 0 };
 
-   /// This is be an array of arrays of the type
-   /// mWeightingFilter[CHANNEL][FILTER] with
-   /// CHANNEL = LEFT/RIGHT (0/1) and
-   /// FILTER  = HSF/HPF    (0/1)
-   ArrayOf<ArrayOf<Biquad>> mWeightingFilter;
+   /// Sums of squares, and lengths, of the latest hops between blocks
+   double mHopPowers[SHORT_TERM_HOPS]{};
+   size_t mHopLengths[SHORT_TERM_HOPS]{};
+   size_t mHopPos{ 0 };
+   /// The hop in progress
+   double mHopPower{ 0 };
+   size_t mHopLength{ 0 };
+
+   /// mWeightingFilter[CHANNEL] with
+   /// CHANNEL = LEFT/RIGHT (0/1)
+   /// is the cascade of the HSF and then the HPF
+   ArrayOf<BiquadCascade> mWeightingFilter;
+   /// Work space of ProcessSamples()
+   std::vector<double> mPowers;
 };
 
 #endif
@@ -28,6 +28,18 @@
 #include "AudacityMessageBox.h"
 #include "../widgets/valnum.h"
 
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#  if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#     define ECHO_SSE2
+#     include <emmintrin.h>
+#  endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#  define ECHO_NEON
+#  include <arm_neon.h>
+#endif
+
 const EffectParameterMethods& EffectEcho::Parameters() const
 {
    static CapturedParameters<EffectEcho,
@@ -58,6 +70,17 @@ struct EffectEcho::Instance
 
    bool ProcessFinalize() noexcept override;
 
+   bool RealtimeInitialize(EffectSettings& settings, double) override;
+
+   bool RealtimeAddProcessor(EffectSettings& settings,
+      EffectOutputs *pOutputs, unsigned numChannels, float sampleRate) override;
+
+   bool RealtimeFinalize(EffectSettings& settings) noexcept override;
+
+   size_t RealtimeProcess(size_t group, EffectSettings& settings,
+      const float* const* inbuf, float* const* outbuf, size_t numSamples)
+      override;
+
    unsigned GetAudioOutCount() const override
    {
       return 1;
@@ -68,12 +91,35 @@ struct EffectEcho::Instance
       return 1;
    }
 
+   //! Allocate a cleared history of length samples
+   /*! @return false if it is more than memory allows */
+   bool InstanceInit(size_t length);
+
+   void InstanceProcess(float decay,
+      const float *ibuf, float *obuf, size_t blockLen);
+
    Floats history;
-   size_t histPos;
-   size_t histLen;
+   size_t histPos{};
+   size_t histLen{};
+   size_t capacity{};
+   double mSampleRate{};
+   std::vector<EffectEcho::Instance> mSlaves;
 };
 
+namespace {
+//! Seconds of history allocated for realtime processing, so that the delay
+//! can change without allocation in the audio thread
+constexpr double RealtimeCapacity = 10.0;
 
+//! Length of history for the delay, or 0 if it does not fit in size_t
+size_t HistoryLength(double sampleRate, double delay)
+{
+   const auto requestedHistLen = (sampleCount) (sampleRate * delay);
+   // Don't violate the assertion in as_size_t
+   const auto histLen = static_cast<size_t>(requestedHistLen.as_long_long());
+   return requestedHistLen == histLen ? histLen : 0;
+}
+}
 
 std::shared_ptr<EffectInstance> EffectEcho::MakeInstance() const
 {
@@ -116,6 +162,11 @@ EffectType EffectEcho::GetType() const
    return EffectTypeProcess;
 }
 
+auto EffectEcho::RealtimeSupport() const -> RealtimeSince
+{
+   return RealtimeSince::After_3_1;
+}
+
 bool EffectEcho::Instance::ProcessInitialize(
    EffectSettings& settings, double sampleRate, ChannelNames)
 {
@@ -123,25 +174,17 @@ bool EffectEcho::Instance::ProcessInitialize(
    if (echoSettings.delay == 0.0)
       return false;
 
-   histPos = 0;
-   auto requestedHistLen = (sampleCount) (sampleRate * echoSettings.delay);
+   mSampleRate = sampleRate;
+   histLen = HistoryLength(sampleRate, echoSettings.delay);
 
-   // Guard against extreme delay values input by the user
-   try {
-      // Guard against huge delay values from the user.
-      // Don't violate the assertion in as_size_t
-      if (requestedHistLen !=
-            (histLen = static_cast<size_t>(requestedHistLen.as_long_long())))
-         throw std::bad_alloc{};
-      history.reinit(histLen, true);
-   }
-   catch ( const std::bad_alloc& ) {
+   // Guard against huge delay values from the user.
+   if (histLen == 0 || !InstanceInit(histLen)) {
       EffectUIServices::DoMessageBox(mProcessor,
          XO("Requested value exceeds memory capacity."));
       return false;
    }
 
-   return history != NULL;
+   return true;
 }
 
 bool EffectEcho::Instance::ProcessFinalize() noexcept
@@ -152,21 +195,112 @@ bool EffectEcho::Instance::ProcessFinalize() noexcept
 size_t EffectEcho::Instance::ProcessBlock(EffectSettings& settings,
    const float *const *inBlock, float *const *outBlock, size_t blockLen)
 {
+   InstanceProcess(GetSettings(settings).decay,
+      inBlock[0], outBlock[0], blockLen);
+   return blockLen;
+}
+
+bool EffectEcho::Instance::RealtimeInitialize(EffectSettings &, double)
+{
+   SetBlockSize(512);
+   mSlaves.clear();
+   return true;
+}
+
+bool EffectEcho::Instance::RealtimeAddProcessor(
+   EffectSettings& settings, EffectOutputs *, unsigned, float sampleRate)
+{
+   auto& echoSettings = GetSettings(settings);
+   EffectEcho::Instance slave(mProcessor);
+   slave.mSampleRate = sampleRate;
+   slave.histLen = std::max<size_t>(1,
+      HistoryLength(sampleRate, echoSettings.delay));
+   const auto capacity = std::max(slave.histLen,
+      HistoryLength(sampleRate, RealtimeCapacity));
+   if (!slave.InstanceInit(capacity))
+      return false;
+   mSlaves.push_back(std::move(slave));
+   return true;
+}
+
+bool EffectEcho::Instance::RealtimeFinalize(EffectSettings &) noexcept
+{
+   mSlaves.clear();
+   return true;
+}
+
+size_t EffectEcho::Instance::RealtimeProcess(size_t group,
+   EffectSettings &settings,
+   const float *const *inbuf, float *const *outbuf, size_t numSamples)
+{
+   if (group >= mSlaves.size())
+      return 0;
    auto& echoSettings = GetSettings(settings);
-   
-   const float *ibuf = inBlock[0];
-   float *obuf = outBlock[0];
+   auto& slave = mSlaves[group];
+
+   // A changed delay restarts the echoes, within the allocated history
+   const auto newLen = std::clamp<size_t>(
+      HistoryLength(slave.mSampleRate, echoSettings.delay),
+      1, slave.capacity);
+   if (newLen != slave.histLen) {
+      slave.histLen = newLen;
+      slave.histPos = 0;
+      std::fill(slave.history.get(), slave.history.get() + newLen, 0.0f);
+   }
 
-   for (decltype(blockLen) i = 0; i < blockLen; i++, histPos++)
-   {
+   slave.InstanceProcess(echoSettings.decay, inbuf[0], outbuf[0], numSamples);
+   return numSamples;
+}
+
+bool EffectEcho::Instance::InstanceInit(size_t length)
+{
+   histPos = 0;
+   try {
+      history.reinit(length, true);
+   }
+   catch ( const std::bad_alloc& ) {
+      capacity = 0;
+      return false;
+   }
+   capacity = length;
+   return true;
+}
+
+void EffectEcho::Instance::InstanceProcess(float decay,
+   const float *ibuf, float *obuf, size_t blockLen)
+{
+   // Runs of the block up to the end of the history, so that the inner loop
+   // has no branch; samples of one run don't depend on each other
+   for (size_t i = 0; i < blockLen;) {
       if (histPos == histLen)
-      {
          histPos = 0;
+      const auto n = std::min(blockLen - i, histLen - histPos);
+      const auto pIn = ibuf + i;
+      const auto pOut = obuf + i;
+      const auto pHistory = history.get() + histPos;
+      size_t j = 0;
+#if defined(ECHO_SSE2)
+      const auto gain = _mm_set1_ps(decay);
+      for (; j + 4 <= n; j += 4) {
+         const auto y = _mm_add_ps(_mm_loadu_ps(pIn + j),
+            _mm_mul_ps(_mm_loadu_ps(pHistory + j), gain));
+         _mm_storeu_ps(pHistory + j, y);
+         _mm_storeu_ps(pOut + j, y);
       }
-      history[histPos] = obuf[i] = ibuf[i] + history[histPos] * echoSettings.decay;
+#elif defined(ECHO_NEON)
+      const auto gain = vdupq_n_f32(decay);
+      for (; j + 4 <= n; j += 4) {
+         const auto y =
+            vmlaq_f32(vld1q_f32(pIn + j), vld1q_f32(pHistory + j), gain);
+         vst1q_f32(pHistory + j, y);
+         vst1q_f32(pOut + j, y);
+      }
+#endif
+      for (; j < n; ++j)
+         pHistory[j] = pOut[j] = pIn[j] + pHistory[j] * decay;
+      i += n;
+      histPos += n;
    }
-
-   return blockLen;
 }
 
 
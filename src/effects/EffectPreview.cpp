@@ -16,13 +16,88 @@
 
 #include "AudioIO.h"
 #include "BasicUI.h"
+#include "Envelope.h"
 #include "MixAndRender.h"
 #include "ProjectAudioIO.h"
+#include "SampleBlock.h"
+#include "Sequence.h"
 #include "TransportUtilities.h"
+#include "WaveClip.h"
 #include "WaveTrack.h"
 
+#include <algorithm>
+
+namespace {
+//! Everything about the selected tracks that the render depends on
+std::vector<double> SourceFingerprint(const TrackList &tracks)
+{
+   std::vector<double> result;
+   for (const auto pTrack : tracks.Selected<const WaveTrack>()) {
+      result.insert(result.end(), {
+         pTrack->GetRate(), pTrack->GetGain(), pTrack->GetPan(),
+         double(pTrack->NChannels())
+      });
+      for (const auto pClip : pTrack->Intervals()) {
+         result.insert(result.end(), {
+            pClip->GetPlayStartTime(), pClip->GetPlayEndTime(),
+            pClip->GetTrimLeft(), pClip->GetStretchRatio(),
+            double(pClip->GetCentShift())
+         });
+         const auto &envelope = pClip->GetEnvelope();
+         const auto nPoints = envelope.GetNumberOfPoints();
+         result.push_back(nPoints);
+         for (size_t ii = 0; ii < nPoints; ++ii)
+            result.insert(result.end(),
+               { envelope[ii].GetT(), envelope[ii].GetVal() });
+         // Sample blocks never change, so their ids identify the samples
+         for (size_t iChannel = 0; iChannel < pClip->NChannels(); ++iChannel) {
+            const auto &blocks = *pClip->GetSequenceBlockArray(iChannel);
+            result.push_back(blocks.size());
+            for (const auto &block : blocks)
+               result.insert(result.end(), {
+                  block.start.as_double(), double(block.sb->GetBlockID())
+               });
+         }
+      }
+   }
+   return result;
+}
+}
+
+bool EffectPreviewCache::Key::operator ==(const Key &other) const
+{
+   return parameters == other.parameters &&
+      t0 == other.t0 && t1 == other.t1 && sources == other.sources;
+}
+
+EffectPreviewCache::EffectPreviewCache() = default;
+EffectPreviewCache::~EffectPreviewCache() = default;
+
+auto EffectPreviewCache::Find(const Key &key) -> const Entry *
+{
+   const auto iter = std::find_if(mEntries.begin(), mEntries.end(),
+      [&](const Entry &entry){ return entry.key == key; });
+   if (iter == mEntries.end())
+      return nullptr;
+   std::rotate(mEntries.begin(), iter, iter + 1);
+   return &mEntries.front();
+}
+
+void EffectPreviewCache::Add(Entry entry)
+{
+   mEntries.insert(mEntries.begin(), std::move(entry));
+   if (mEntries.size() > MaxEntries)
+      mEntries.resize(MaxEntries);
+}
+
+void EffectPreviewCache::Clear()
+{
+   mEntries.clear();
+}
+
 void EffectPreview(EffectBase &effect,
-   EffectSettingsAccess &access, std::function<void()> updateUI, bool dryOnly)
+   EffectSettingsAccess &access, std::function<void()> updateUI, bool dryOnly,
+   EffectPreviewCache *pCache)
 {
    auto cleanup0 = effect.BeginPreview(access.Get());
 
@@ -112,62 +187,90 @@ void EffectPreview(EffectBase &effect,
          BasicUI::SetFocus(*FocusDialog);
    } );
 
-   // Build NEW tracklist from rendering tracks
    // Set the same owning project, so FindProject() can see it within Process()
    const auto pProject = saveTracks->GetOwner();
-   mTracks = TrackList::Create(pProject);
-
-   // Linear Effect preview optimised by pre-mixing to one track.
-   // Generators need to generate per track.
-   if (isLinearEffect && !isGenerator) {
-      auto newTrack = MixAndRender(
-         saveTracks->Selected<const WaveTrack>(),
-         Mixer::WarpOptions{ saveTracks->GetOwner() },
-         wxString{}, // Don't care about the name of the temporary tracks
-         factory, rate, floatSample, mT0, t1);
-      if (!newTrack)
-         return;
-      mTracks->Add(newTrack);
-
-      newTrack->MoveTo(0);
-      newTrack->SetSelected(true);
+
+   // A render of the same settings and sources may be replayed
+   EffectPreviewCache::Key key;
+   const EffectPreviewCache::Entry *pCached = nullptr;
+   if (pCache && !dryOnly) {
+      if (effect.SaveSettingsAsString(settings, key.parameters)) {
+         key.t0 = mT0;
+         key.t1 = t1;
+         // The end of processing and the project rate also matter
+         key.sources = { mT1, rate };
+         const auto sources = SourceFingerprint(*saveTracks);
+         key.sources.insert(key.sources.end(), sources.begin(), sources.end());
+         pCached = pCache->Find(key);
+      }
+      else
+         pCache = nullptr;
+   }
+
+   if (pCached) {
+      mTracks = pCached->tracks;
+      mT0 = pCached->t0;
+      mT1 = pCached->t1;
    }
    else {
-      for (auto src : saveTracks->Selected<const WaveTrack>()) {
-         auto dest = src->Copy(mT0, t1);
-         dest->SetSelected(true);
-         mTracks->Add(dest);
+      // Build NEW tracklist from rendering tracks
+      mTracks = TrackList::Create(pProject);
+
+      // Linear Effect preview optimised by pre-mixing to one track.
+      // Generators need to generate per track.
+      if (isLinearEffect && !isGenerator) {
+         auto newTrack = MixAndRender(
+            saveTracks->Selected<const WaveTrack>(),
+            Mixer::WarpOptions{ saveTracks->GetOwner() },
+            wxString{}, // Don't care about the name of the temporary tracks
+            factory, rate, floatSample, mT0, t1);
+         if (!newTrack)
+            return;
+         mTracks->Add(newTrack);
+
+         newTrack->MoveTo(0);
+         newTrack->SetSelected(true);
+      }
+      else {
+         for (auto src : saveTracks->Selected<const WaveTrack>()) {
+            auto dest = src->Copy(mT0, t1);
+            dest->SetSelected(true);
+            mTracks->Add(dest);
+         }
       }
-   }
 
-   // NEW tracks start at time zero.
-   // Adjust mT0 and mT1 to be the times to process, and to
-   // play back in these tracks
-   mT1 -= mT0;
-   mT0 = 0.0;
-
-   // Update track/group counts
-   effect.CountWaveTracks();
-
-   // Apply effect
-   if (!dryOnly) {
-      using namespace BasicUI;
-      auto progress = MakeProgress(
-         effect.GetName(),
-         XO("Preparing preview"),
-         ProgressShowStop
-      ); // Have only "Stop" button.
-      auto vr = valueRestorer( mProgress, progress.get() );
-
-      auto vr2 = valueRestorer( mIsPreview, true );
-
-      access.ModifySettings([&](EffectSettings &settings){
-         // Preview of non-realtime effect
-         auto pInstance =
-            std::dynamic_pointer_cast<EffectInstanceEx>(effect.MakeInstance());
-         success = pInstance && pInstance->Process(settings);
-         return nullptr;
-      });
+      // NEW tracks start at time zero.
+      // Adjust mT0 and mT1 to be the times to process, and to
+      // play back in these tracks
+      mT1 -= mT0;
+      mT0 = 0.0;
+
+      // Update track/group counts
+      effect.CountWaveTracks();
+
+      // Apply effect
+      if (!dryOnly) {
+         using namespace BasicUI;
+         auto progress = MakeProgress(
+            effect.GetName(),
+            XO("Preparing preview"),
+            ProgressShowStop
+         ); // Have only "Stop" button.
+         auto vr = valueRestorer( mProgress, progress.get() );
+
+         auto vr2 = valueRestorer( mIsPreview, true );
+
+         access.ModifySettings([&](EffectSettings &settings){
+            // Preview of non-realtime effect
+            auto pInstance =
+               std::dynamic_pointer_cast<EffectInstanceEx>(effect.MakeInstance());
+            success = pInstance && pInstance->Process(settings);
+            return nullptr;
+         });
+      }
+
+      if (success && pCache)
+         pCache->Add({ std::move(key), mTracks, mT0, mT1 });
    }
 
    if (success)
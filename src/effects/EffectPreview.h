@@ -14,16 +14,64 @@
 #define __AUDACITY_EFFECT_PREVIEW__
 
 #include <functional>
+#include <memory>
+#include <vector>
+#include <wx/string.h>
 
 class EffectBase;
 class EffectSettingsAccess;
+class TrackList;
+
+//! Renders of previews, kept for the life of one effect dialog
+/*!
+ Renders are keyed by the effect settings, the previewed times, and the
+ placement, gains and sample block ids of the clips of the selected tracks,
+ so that playing again, or returning to earlier settings, replays a render
+ without applying the effect again.
+
+ It holds sample blocks of the project, so it must not outlive the dialog.
+ */
+class EffectPreviewCache final
+{
+public:
+   struct Key {
+      wxString parameters;
+      double t0{}, t1{};
+      std::vector<double> sources;
+
+      bool operator ==(const Key &other) const;
+   };
+
+   struct Entry {
+      Key key;
+      std::shared_ptr<TrackList> tracks;
+      //! Times to play in the tracks, as Process() left them
+      double t0{}, t1{};
+   };
+
+   //! Least recently used renders are discarded beyond this number
+   static constexpr size_t MaxEntries = 4;
+
+   EffectPreviewCache();
+   ~EffectPreviewCache();
+
+   //! @return null if not found, else makes the entry most recently used
+   const Entry *Find(const Key &key);
+   void Add(Entry entry);
+   void Clear();
+
+private:
+   //! Most recently used first
+   std::vector<Entry> mEntries;
+};
 
 //! Calculate temporary tracks of limited length with effect applied and play
 /*!
  @param updateUI called after adjusting temporary settings and before play
+ @param pCache if not null, reuses and keeps renders
  */
 void EffectPreview(EffectBase &effect,
    EffectSettingsAccess &access, std::function<void()> updateUI,
-   bool dryOnly);
+   bool dryOnly, EffectPreviewCache *pCache = nullptr);
 
 #endif
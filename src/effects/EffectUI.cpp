@@ -760,7 +760,10 @@ void EffectUIHost::OnPlay(wxCommandEvent & WXUNUSED(evt))
       return;
    
    auto updater = [this]{ TransferDataToWindow(); };
-   EffectPreview(mEffectUIHost, *mpAccess, updater, false);
+   if (!mpPreviewCache)
+      mpPreviewCache = std::make_unique<EffectPreviewCache>();
+   EffectPreview(mEffectUIHost, *mpAccess, updater, false,
+      mpPreviewCache.get());
    // After restoration of settings and effect state:
    // In case any dialog control depends on mT1 or mDuration:
    updater();
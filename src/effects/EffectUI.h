@@ -34,6 +34,7 @@ struct AudioIOEvent;
 class AudacityCommand;
 class AudacityProject;
 class EffectBase;
+class EffectPreviewCache;
 class RealtimeEffectState;
 
 class wxCheckBox;
@@ -156,6 +157,9 @@ private:
 
    std::unique_ptr<EffectEditor> mpEditor;
 
+   //! Renders of previews, made on first play
+   std::unique_ptr<EffectPreviewCache> mpPreviewCache;
+
    DECLARE_EVENT_TABLE()
 };
 
@@ -41,6 +41,7 @@
 
 #include "WaveClip.h"
 #include "WaveTrack.h"
+#include "concurrency/ThreadPool.h"
 
 const EffectParameterMethods& EffectEqualization::Parameters() const
 {
@@ -367,10 +368,46 @@ struct EffectEqualization::Task {
    Task(size_t M, size_t idealBlockLen, WaveChannel &channel)
       : buffer{ idealBlockLen }
       , idealBlockLen{ idealBlockLen }
+      , lumps{ (idealBlockLen / (windowSize - (M - 1))) * windowSize }
       , output{ channel }
       , leftTailRemaining{ (M - 1) / 2 }
    {
       memset(lastWindow, 0, windowSize * sizeof(float));
+      const auto nThreads = std::max<size_t>(1,
+         audacity::concurrency::ThreadPool::GetDefault().GetThreadsCount());
+      for (size_t ii = 0; ii < nThreads; ++ii)
+         workSpaces.push_back(std::make_unique<WorkSpace>());
+   }
+
+   //! Fill `lumps` with the filtered, zero-padded lumps of L samples of
+   //! `block` samples of `buffer`
+   /*!
+    Lumps are independent until the overlap-add, so they are filtered on the
+    thread pool, each thread with its own FFT plan
+    @pre `block <= idealBlockLen`
+    */
+   void FilterLumps(const EqualizationFilter &filter, size_t block, size_t L)
+   {
+      const auto nLumps = (block + L - 1) / L;
+      const auto filterRange = [&](size_t iRange, size_t nRanges) {
+         auto &space = *workSpaces[iRange];
+         const auto end = nLumps * (iRange + 1) / nRanges;
+         for (auto ii = nLumps * iRange / nRanges; ii < end; ++ii) {
+            const auto pLump = lumps.get() + ii * windowSize;
+            const auto pSamples = buffer.get() + ii * L;
+            const auto wcopy = std::min(L, block - ii * L);
+            std::copy(pSamples, pSamples + wcopy, pLump);
+            std::fill(pLump + wcopy, pLump + windowSize, 0.0f);
+            filter.Filter(windowSize, pLump, space.fft, space.scratch.get());
+         }
+      };
+
+      auto &pool = audacity::concurrency::ThreadPool::GetDefault();
+      // A worker of the pool would filter all ranges itself, so don't split
+      const auto nRanges = pool.IsWorkerThread()
+         ? 1 : std::max<size_t>(1, std::min(nLumps, workSpaces.size()));
+      pool.ParallelFor(nRanges,
+         [&](size_t iRange){ filterRange(iRange, nRanges); });
    }
 
    void AccumulateSamples(constSamplePtr buffer, size_t len)
@@ -389,6 +426,14 @@ struct EffectEqualization::Task {
    Floats buffer;
    const size_t idealBlockLen;
 
+   //! Filtered lumps of the current block, `windowSize` samples each
+   Floats lumps;
+   struct WorkSpace {
+      RealFFTPlan fft{ windowSize };
+      Floats scratch{ windowSize };
+   };
+   std::vector<std::unique_ptr<WorkSpace>> workSpaces;
+
    // These pointers are swapped after each FFT window
    float *thisWindow{ window1.get() };
    float *lastWindow{ window2.get() };
@@ -502,16 +547,13 @@ bool EffectEqualization::ProcessOne(Task &task,
       auto block = limitSampleBufferSize( task.idealBlockLen, len );
 
       t.GetFloats(buffer.get(), s, block);
+      task.FilterLumps(mParameters, block, L);
 
       for(size_t i = 0; i < block; i += L)   //go through block in lumps of length L
       {
          wcopy = std::min <size_t> (L, block - i);
-         for(size_t j = 0; j < wcopy; j++)
-            thisWindow[j] = buffer[i+j];   //copy the L (or remaining) samples
-         for(auto j = wcopy; j < windowSize; j++)
-            thisWindow[j] = 0;   //this includes the padding
-
-         mParameters.Filter(windowSize, thisWindow);
+         const auto pLump = task.lumps.get() + (i / L) * windowSize;
+         std::copy(pLump, pLump + windowSize, thisWindow);
 
          // Overlap - Add
          for(size_t j = 0; (j < M - 1) && (j < wcopy); j++)
@@ -14,6 +14,7 @@
 #include "EqualizationFilter.h"
 #include "Envelope.h"
 #include "FFT.h"
+#include <algorithm>
 
 EqualizationFilter::EqualizationFilter(const EffectSettingsManager &manager)
    : EqualizationParameters{ manager }
@@ -28,7 +29,6 @@ EqualizationFilter::EqualizationFilter(const EffectSettingsManager &manager)
    mLinEnvelope.SetTrackLen(1.0);
 }
 
-#include "RealFFTf.h"
 bool EqualizationFilter::CalcFilter()
 {
    // Inverse-transform the given curve from frequency domain to time;
@@ -147,6 +147,12 @@ bool EqualizationFilter::CalcFilter()
 }
 
 void EqualizationFilter::Filter(size_t len, float *buffer) const
+{
+   Filter(len, buffer, mFFT, mFFTBuffer.get());
+}
+
+void EqualizationFilter::Filter(size_t len, float *buffer,
+   RealFFTPlan &fft, float *scratch) const
 {
    // Transform a window of the time-domain signal to frequency;
    // Multiply by corresponding coefficients;
@@ -154,23 +160,23 @@ void EqualizationFilter::Filter(size_t len, float *buffer) const
 
    float re,im;
    // Apply FFT
-   RealFFTf(buffer, hFFT.get());
+   fft.Forward(buffer);
    //FFT(len, false, inr, NULL, outr, outi);
 
    // Apply filter
    // DC component is purely real
-   mFFTBuffer[0] = buffer[0] * mFilterFuncR[0];
+   scratch[0] = buffer[0] * mFilterFuncR[0];
    for(size_t i = 1; i < (len / 2); i++)
    {
-      re=buffer[hFFT->BitReversed[i]  ];
-      im=buffer[hFFT->BitReversed[i]+1];
-      mFFTBuffer[2*i  ] = re*mFilterFuncR[i] - im*mFilterFuncI[i];
-      mFFTBuffer[2*i+1] = re*mFilterFuncI[i] + im*mFilterFuncR[i];
+      re=buffer[2*i  ];
+      im=buffer[2*i+1];
+      scratch[2*i  ] = re*mFilterFuncR[i] - im*mFilterFuncI[i];
+      scratch[2*i+1] = re*mFilterFuncI[i] + im*mFilterFuncR[i];
    }
    // Fs/2 component is purely real
-   mFFTBuffer[1] = buffer[1] * mFilterFuncR[len/2];
+   scratch[1] = buffer[1] * mFilterFuncR[len/2];
 
    // Inverse FFT and normalization
-   InverseRealFFTf(mFFTBuffer.get(), hFFT.get());
-   ReorderToTime(hFFT.get(), mFFTBuffer.get(), buffer);
+   fft.Inverse(scratch);
+   std::copy(scratch, scratch + len, buffer);
 }
@@ -16,7 +16,7 @@
 
 #include "EqualizationParameters.h" // base class
 #include "Envelope.h" // member
-#include "RealFFTf.h" // member
+#include "RealFFTPlan.h" // member
 using Floats = ArrayOf<float>;
 
 //! Extend EqualizationParameters with frequency domain coefficients computed
@@ -40,6 +40,14 @@ struct EqualizationFilter : EqualizationParameters {
    //! Transform a given buffer of time domain signal, which should be zero
    //! padded left and right for the tails
    void Filter(size_t len, float *buffer) const;
+   //! Same, but with the given work space, so that calls with distinct
+   //! work space may be made at once in several threads
+   /*!
+    @pre `fft.Size() == len`
+    @param scratch has room for `len` floats
+    */
+   void Filter(size_t len, float *buffer,
+      RealFFTPlan &fft, float *scratch) const;
 
    const Envelope &ChooseEnvelope() const
    { return mLin ? mLinEnvelope : mLogEnvelope; }
@@ -51,7 +59,8 @@ struct EqualizationFilter : EqualizationParameters {
    { return IsLinear() ? mLinEnvelope : mLogEnvelope; }
 
    Envelope mLinEnvelope, mLogEnvelope;
-   HFFT hFFT{ GetFFT(windowSize) };
+   //! Work space of Filter()
+   mutable RealFFTPlan mFFT{ windowSize };
    Floats mFFTBuffer{ windowSize };
    Floats mFilterFuncR{ windowSize }, mFilterFuncI{ windowSize };
    double mLoFreq{ loFreqI };
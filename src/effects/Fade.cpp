@@ -18,6 +18,16 @@
 
 #include "LoadEffects.h"
 
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#  if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#     define FADE_SSE2
+#     include <emmintrin.h>
+#  endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#  define FADE_NEON
+#  include <arm_neon.h>
+#endif
+
 const ComponentInterfaceSymbol EffectFadeIn::Symbol
 { XO("Fade In") };
 
@@ -88,24 +98,32 @@ size_t EffectFade::ProcessBlock(EffectSettings &,
    const float *ibuf = inBlock[0];
    float *obuf = outBlock[0];
 
-   if (mFadeIn)
-   {
-      for (decltype(blockLen) i = 0; i < blockLen; i++)
-      {
-         obuf[i] =
-            (ibuf[i] * ( mSample++ ).as_float()) /
-            mSampleCnt.as_float();
-      }
+   // The gain of sample i of the block is gain + i * step; the gain at the
+   // block start is found in double, so that long selections don't drift
+   const auto count = mSampleCnt.as_double();
+   const float step = (mFadeIn ? 1 : -1) / count;
+   const float gain = (mFadeIn
+      ? mSample.as_double()
+      : (mSampleCnt - 1 - mSample).as_double()) / count;
+   mSample += blockLen;
+
+   size_t i = 0;
+#if defined(FADE_SSE2)
+   const auto offsets = _mm_mul_ps(_mm_set_ps(3, 2, 1, 0), _mm_set1_ps(step));
+   for (; i + 4 <= blockLen; i += 4) {
+      const auto gains = _mm_add_ps(_mm_set1_ps(gain + i * step), offsets);
+      _mm_storeu_ps(obuf + i, _mm_mul_ps(_mm_loadu_ps(ibuf + i), gains));
    }
-   else
-   {
-      for (decltype(blockLen) i = 0; i < blockLen; i++)
-      {
-         obuf[i] = (ibuf[i] *
-                    ( mSampleCnt - 1 - mSample++ ).as_float()) /
-            mSampleCnt.as_float();
-      }
+#elif defined(FADE_NEON)
+   const float lanes[]{ 0, 1, 2, 3 };
+   const auto offsets = vmulq_n_f32(vld1q_f32(lanes), step);
+   for (; i + 4 <= blockLen; i += 4) {
+      const auto gains = vaddq_f32(vdupq_n_f32(gain + i * step), offsets);
+      vst1q_f32(obuf + i, vmulq_f32(vld1q_f32(ibuf + i), gains));
    }
+#endif
+   for (; i < blockLen; ++i)
+      obuf[i] = ibuf[i] * (gain + i * step);
 
    return blockLen;
 }
@@ -23,15 +23,18 @@
 #include "EffectOutputTracks.h"
 #include "LoadEffects.h"
 
+#include <chrono>
+#include <future>
 #include <math.h>
 
-
 #include "ShuttleGui.h"
 #include "../widgets/valnum.h"
 #include "AudacityMessageBox.h"
 
 #include "../LabelTrack.h"
+#include "WaveChannelUtilities.h"
 #include "WaveTrack.h"
+#include "concurrency/ThreadPool.h"
 
 const EffectParameterMethods& EffectFindClipping::Parameters() const
 {
@@ -97,7 +100,11 @@ bool EffectFindClipping::Process(EffectInstance &, EffectSettings &)
       modifiedTrack.emplace(ModifyAnalysisTrack(*this, *clt, name)),
       lt = modifiedTrack->get();
 
-   int count = 0;
+   struct Job {
+      std::shared_ptr<const WaveChannel> pChannel;
+      sampleCount start, len;
+   };
+   std::vector<Job> jobs;
 
    // JC: Only process selected tracks.
    // PRL:  Compute the strech into temporary tracks.  Don't commit the stretch.
@@ -113,11 +120,81 @@ bool EffectFindClipping::Process(EffectInstance &, EffectSettings &)
          auto len = end - start;
 
          for (const auto pChannel : t->Channels())
-            if (!ProcessOne(*lt, count++, *pChannel, start, len))
+            jobs.push_back({ pChannel, start, len });
+      }
+   }
+
+   // Find the runs in all channels at once, then label them in order
+   std::vector<std::vector<ClippedRun>> runs(jobs.size());
+   const auto find = [&](size_t ii, AnalysisProgress *pProgress) {
+      const auto &job = jobs[ii];
+      return ProcessOne(runs[ii], ii, *job.pChannel, job.start, job.len,
+         pProgress);
+   };
+   try {
+      auto &pool = audacity::concurrency::ThreadPool::GetDefault();
+      if (jobs.size() < 2 || pool.IsWorkerThread() ||
+          pool.GetThreadsCount() < 2) {
+         for (size_t ii = 0; ii < jobs.size(); ++ii)
+            if (!find(ii, nullptr))
                return false;
       }
+      else {
+         std::vector<AnalysisProgress> progress(jobs.size());
+         std::vector<std::future<bool>> futures;
+         futures.reserve(jobs.size());
+         for (size_t ii = 0; ii < jobs.size(); ++ii)
+            futures.push_back(pool.Async([&find, &progress, ii]{
+               return find(ii, &progress[ii]);
+            }));
+
+         // Show progress here while the workers analyze
+         bool cancelled = false;
+         for (auto &future : futures) {
+            while (future.wait_for(std::chrono::milliseconds(50)) !=
+               std::future_status::ready) {
+               if (cancelled)
+                  continue;
+               double sum = 0;
+               for (auto &channelProgress : progress)
+                  sum += channelProgress.fraction.load(
+                     std::memory_order_relaxed);
+               if (TotalProgress(sum / jobs.size())) {
+                  cancelled = true;
+                  for (auto &channelProgress : progress)
+                     channelProgress.cancelled.store(true,
+                        std::memory_order_relaxed);
+               }
+            }
+         }
+
+         // All are ready, so the first exception can propagate
+         bool result = !cancelled;
+         for (auto &future : futures)
+            result = future.get() && result;
+         if (!result)
+            return false;
+      }
+   }
+   catch( const std::bad_alloc & ) {
+      EffectUIServices::DoMessageBox(*this,
+         XO("Requested value exceeds memory capacity."));
+      return false;
    }
 
+   for (const auto &channelRuns : runs)
+      for (const auto &run : channelRuns)
+         lt->AddLabel(SelectedRegion(run.t0, run.t1),
+            /*!
+             i18n-hint: Two numbers are substituted; the second is the
+             size of a set, the first is the size of a subset, and not
+             understood as an ordinal (i.e., not meaning "first", or
+             "second", etc.)
+             */
+            XC("%lld of %lld", "find clipping")
+               .Format(run.clipped.as_long_long(), run.total.as_long_long())
+               .Translation());
+
    // No cancellation, so commit the addition of the track.
    if (addedTrack)
       addedTrack->Commit();
@@ -126,88 +203,115 @@ bool EffectFindClipping::Process(EffectInstance &, EffectSettings &)
    return true;
 }
 
-bool EffectFindClipping::ProcessOne(LabelTrack &lt,
-   int count, const WaveChannel &wt, sampleCount start, sampleCount len)
+bool EffectFindClipping::ProcessOne(std::vector<ClippedRun> &runs,
+   int count, const WaveChannel &wt, sampleCount start, sampleCount len,
+   AnalysisProgress *pProgress)
 {
-   bool bGoodResult = true;
    size_t blockSize = (mStart * 1000);
 
    if (len < mStart)
       return true;
 
-   Floats buffer;
-   try {
-      // mStart should be positive.
-      // if we are throwing bad_alloc and mStart is negative, find out why.
-      if (mStart < 0 || (int)blockSize < mStart)
-         // overflow
-         throw std::bad_alloc{};
-      buffer.reinit(blockSize);
-   }
-   catch( const std::bad_alloc & ) {
-      EffectUIServices::DoMessageBox(*this,
-         XO("Requested value exceeds memory capacity."));
-      return false;
-   }
-
-   float *ptr = buffer.get();
+   // mStart should be positive.
+   // if we are throwing bad_alloc and mStart is negative, find out why.
+   if (mStart < 0 || (int)blockSize < mStart)
+      // overflow
+      throw std::bad_alloc{};
+   Floats buffer{ blockSize };
 
    decltype(len) s = 0, startrun = 0, stoprun = 0, samps = 0;
-   decltype(blockSize) block = 0;
    double startTime = -1.0;
 
-   while (s < len) {
-      if (block == 0) {
-         if (TrackProgress(count, s.as_double() / len.as_double() )) {
-            bGoodResult = false;
-            break;
+   const auto endRun = [&]{
+      // The run ended mStop samples before s
+      runs.push_back({ startTime, wt.LongSamplesToTime(start + s - mStop),
+         startrun, samps - mStop });
+      startrun = 0;
+      stoprun = 0;
+      samps = 0;
+   };
+
+   // Examine samples [s, s + count)
+   const auto scan = [&](size_t count) {
+      wt.GetFloats(buffer.get(), start + s, count);
+      const float *ptr = buffer.get();
+      for (const auto end = s + count; s < end; ++s) {
+         float v = fabs(*ptr++);
+         if (v >= MAX_AUDIO) {
+            if (startrun == 0) {
+               startTime = wt.LongSamplesToTime(start + s);
+               samps = 0;
+            }
+            else
+               stoprun = 0;
+            startrun++;
+            samps++;
+         }
+         else {
+            if (startrun >= mStart) {
+               stoprun++;
+               samps++;
+               if (stoprun >= mStop)
+                  endRun();
+            }
+            else
+               startrun = 0;
          }
-         block = limitSampleBufferSize( blockSize, len - s );
-         wt.GetFloats(buffer.get(), start + s, block);
-         ptr = buffer.get();
       }
-
-      float v = fabs(*ptr++);
-      if (v >= MAX_AUDIO) {
-         if (startrun == 0) {
-            startTime = wt.LongSamplesToTime(start + s);
-            samps = 0;
+   };
+
+   // Pass samples [s, s + count), which the summaries show are all below
+   // MAX_AUDIO, as scan() would
+   const auto skip = [&](size_t count) {
+      if (startrun >= mStart) {
+         const auto needed = mStop - stoprun;
+         if (needed <= count) {
+            s += needed - 1;
+            samps += needed;
+            endRun();
+            s += count - needed + 1;
+            return;
          }
-         else
-            stoprun = 0;
-         startrun++;
-         samps++;
+         stoprun += count;
+         samps += count;
       }
-      else {
-         if (startrun >= mStart) {
-            stoprun++;
-            samps++;
-            if (stoprun >= mStop) {
-               lt.AddLabel(
-                  SelectedRegion(startTime,
-                     wt.LongSamplesToTime(start + s - mStop)),
-                  /*!
-                   i18n-hint: Two numbers are substituted; the second is the
-                   size of a set, the first is the size of a subset, and not
-                   understood as an ordinal (i.e., not meaning "first", or
-                   "second", etc.)
-                   */
-                  XC("%lld of %lld", "find clipping")
-                     .Format(startrun.as_long_long(),
-                        (samps - mStop).as_long_long())
-                     .Translation());
-               startrun = 0;
-               stoprun = 0;
-               samps = 0;
-            }
+      else
+         startrun = 0;
+      s += count;
+   };
+
+   while (s < len) {
+      if (pProgress) {
+         pProgress->fraction.store(s.as_double() / len.as_double(),
+            std::memory_order_relaxed);
+         if (pProgress->cancelled.load(std::memory_order_relaxed))
+            return false;
+      }
+      else if (TrackProgress(count, s.as_double() / len.as_double() ))
+         return false;
+
+      const auto block = limitSampleBufferSize( blockSize, len - s );
+      // Read only the spans whose peaks reach full scale, or that have no
+      // summary
+      const auto spans =
+         WaveChannelUtilities::GetSummarySpans(wt, start + s, block);
+      size_t pending = 0;
+      for (const auto &span : spans) {
+         if (span.peak < MAX_AUDIO) {
+            if (pending > 0)
+               scan(pending);
+            pending = 0;
+            skip(span.length);
          }
          else
-            startrun = 0;
+            pending += span.length;
       }
-      s++;
-      block--;
+      if (spans.empty())
+         pending = block;
+      if (pending > 0)
+         scan(pending);
    }
-   return bGoodResult;
+   return true;
 }
 
 std::unique_ptr<EffectEditor> EffectFindClipping::PopulateOrExchange(
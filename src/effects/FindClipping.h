@@ -19,7 +19,10 @@ class WaveChannel;
 
 #include "StatefulEffect.h"
 #include "ShuttleAutomation.h"
+#include "SampleCount.h"
 #include <wx/weakref.h>
+#include <atomic>
+#include <vector>
 
 class EffectFindClipping final : public StatefulEffect
 {
@@ -55,8 +58,22 @@ public:
 private:
    // EffectFindCliping implementation
 
-   bool ProcessOne(LabelTrack &lt, int count, const WaveChannel &wt,
-      sampleCount start, sampleCount len);
+   //! A run of clipped samples, to be labelled
+   struct ClippedRun {
+      double t0, t1;
+      sampleCount clipped, total;
+   };
+
+   //! Progress of an analysis on a worker thread, shown by the main thread
+   struct AnalysisProgress {
+      std::atomic<double> fraction{ 0 };
+      std::atomic<bool> cancelled{ false };
+   };
+
+   // If pProgress is not NULL, progress goes there and not to the dialog.
+   bool ProcessOne(std::vector<ClippedRun> &runs, int count,
+      const WaveChannel &wt, sampleCount start, sampleCount len,
+      AnalysisProgress *pProgress);
 
    wxWeakRef<wxWindow> mUIParent{};
 
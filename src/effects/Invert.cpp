@@ -84,3 +84,13 @@ bool EffectInvert::NeedsDither() const
 {
    return false;
 }
+
+bool EffectInvert::ProcessesTracksConcurrently() const
+{
+   return true;
+}
+
+bool EffectInvert::ProcessesChunksIndependently() const
+{
+   return true;
+}
@@ -40,6 +40,11 @@ public:
       override;
 
    bool NeedsDither() const override;
+
+   // PerTrackEffect implementation
+
+   bool ProcessesTracksConcurrently() const override;
+   bool ProcessesChunksIndependently() const override;
 };
 
 #endif
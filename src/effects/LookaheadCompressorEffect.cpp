@@ -0,0 +1,316 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  LookaheadCompressorEffect.cpp
+
+*******************************************************************//**
+
+\class EffectLookaheadCompressor
+\brief A single pass compressor and limiter with lookahead, which can be
+applied in realtime
+
+*//*******************************************************************/
+#include "LookaheadCompressorEffect.h"
+#include "EffectEditor.h"
+#include "LoadEffects.h"
+
+#include "LookaheadCompressor.h"
+#include "ShuttleGui.h"
+#include "../widgets/valnum.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+LookaheadCompressor::Parameters
+MakeParameters(const EffectLookaheadCompressorSettings &settings)
+{
+   LookaheadCompressor::Parameters parameters;
+   parameters.thresholdDb = settings.mThresholdDB;
+   parameters.ratio = settings.mRatio;
+   parameters.kneeDb = settings.mKneeDB;
+   parameters.attackMs = settings.mAttackTime;
+   parameters.releaseMs = settings.mReleaseTime;
+   parameters.makeupDb = settings.mMakeupGainDB;
+   return parameters;
+}
+}
+
+const EffectParameterMethods& EffectLookaheadCompressor::Parameters() const
+{
+   static CapturedParameters<EffectLookaheadCompressor,
+      Threshold, Ratio, Knee, AttackTime, ReleaseTime, Lookahead, MakeupGain
+   > parameters;
+   return parameters;
+}
+
+const ComponentInterfaceSymbol EffectLookaheadCompressor::Symbol
+{ XO("Lookahead Compressor") };
+
+namespace{ BuiltinEffectsModule::Registration< EffectLookaheadCompressor > reg; }
+
+struct EffectLookaheadCompressor::Instance
+   : public PerTrackEffect::Instance
+   , public EffectInstanceWithBlockSize
+{
+   explicit Instance(const PerTrackEffect& effect)
+      : PerTrackEffect::Instance{ effect }
+   {}
+
+   bool ProcessInitialize(EffectSettings &settings, double sampleRate,
+      ChannelNames chanMap) override;
+
+   size_t ProcessBlock(EffectSettings& settings,
+      const float* const* inBlock, float* const* outBlock, size_t blockLen)
+      override;
+
+   // Realtime section
+
+   bool RealtimeInitialize(EffectSettings& settings, double sampleRate)
+      override;
+
+   bool RealtimeAddProcessor(EffectSettings& settings, EffectOutputs *,
+      unsigned numChannels, float sampleRate) override;
+
+   bool RealtimeFinalize(EffectSettings& settings) noexcept override;
+
+   bool RealtimeSuspend() override;
+
+   size_t RealtimeProcess(size_t group, EffectSettings& settings,
+      const float* const* inbuf, float* const* outbuf, size_t numSamples)
+      override;
+
+   unsigned GetAudioOutCount() const override
+   {
+      return 2;
+   }
+
+   unsigned GetAudioInCount() const override
+   {
+      return 2;
+   }
+
+   SampleCount GetLatency(const EffectSettings &settings, double sampleRate)
+      const override
+   {
+      // The lookahead of realtime processors is fixed when they are made
+      if (!mProcessors.empty())
+         return mProcessors.front()->Latency();
+      return std::max(0.0, std::round(
+         GetSettings(settings).mLookahead * 0.001 * sampleRate));
+   }
+
+   std::unique_ptr<LookaheadCompressor> mDestructive;
+   //! One for each realtime processor
+   std::vector<std::unique_ptr<LookaheadCompressor>> mProcessors;
+};
+
+bool EffectLookaheadCompressor::Instance::ProcessInitialize(
+   EffectSettings &settings, double sampleRate, ChannelNames chanMap)
+{
+   const auto &cs = GetSettings(settings);
+   const bool stereo = chanMap && chanMap[0] != ChannelNameEOL &&
+      chanMap[1] == ChannelNameFrontRight;
+   mDestructive = std::make_unique<LookaheadCompressor>(
+      stereo ? 2 : 1, sampleRate, cs.mLookahead, MakeParameters(cs));
+   return true;
+}
+
+size_t EffectLookaheadCompressor::Instance::ProcessBlock(
+   EffectSettings&,
+   const float* const* inBlock, float* const* outBlock, size_t blockLen)
+{
+   mDestructive->Process(inBlock, outBlock, blockLen);
+   return blockLen;
+}
+
+bool EffectLookaheadCompressor::Instance::RealtimeInitialize(
+   EffectSettings&, double)
+{
+   SetBlockSize(512);
+   mProcessors.clear();
+   return true;
+}
+
+bool EffectLookaheadCompressor::Instance::RealtimeAddProcessor(
+   EffectSettings& settings, EffectOutputs *, unsigned, float sampleRate)
+{
+   const auto &cs = GetSettings(settings);
+   // All processors must have the same latency; the lookahead of the first
+   // one prevails until realtime processing is initialized again
+   const auto lookahead = mProcessors.empty()
+      ? cs.mLookahead
+      : mProcessors.front()->Latency() * 1000.0 / sampleRate;
+   mProcessors.push_back(std::make_unique<LookaheadCompressor>(
+      2, sampleRate, lookahead, MakeParameters(cs)));
+   return true;
+}
+
+bool EffectLookaheadCompressor::Instance::RealtimeFinalize(
+   EffectSettings&) noexcept
+{
+   mProcessors.clear();
+   return true;
+}
+
+bool EffectLookaheadCompressor::Instance::RealtimeSuspend()
+{
+   for (auto &pProcessor : mProcessors)
+      pProcessor->Reset();
+   return true;
+}
+
+size_t EffectLookaheadCompressor::Instance::RealtimeProcess(size_t group,
+   EffectSettings& settings,
+   const float* const* inbuf, float* const* outbuf, size_t numSamples)
+{
+   if (group >= mProcessors.size())
+      return 0;
+   auto &processor = *mProcessors[group];
+   // Cheap, and does not allocate
+   processor.SetParameters(MakeParameters(GetSettings(settings)));
+   processor.Process(inbuf, outbuf, numSamples);
+   return numSamples;
+}
+
+std::shared_ptr<EffectInstance>
+EffectLookaheadCompressor::MakeInstance() const
+{
+   return std::make_shared<Instance>(*this);
+}
+
+EffectLookaheadCompressor::EffectLookaheadCompressor()
+{
+}
+
+EffectLookaheadCompressor::~EffectLookaheadCompressor()
+{
+}
+
+// ComponentInterface implementation
+
+ComponentInterfaceSymbol EffectLookaheadCompressor::GetSymbol() const
+{
+   return Symbol;
+}
+
+TranslatableString EffectLookaheadCompressor::GetDescription() const
+{
+   return XO("Compresses or limits the dynamic range of audio in one pass, "
+      "looking ahead to catch transients");
+}
+
+ManualPageID EffectLookaheadCompressor::ManualPage() const
+{
+   return L"Lookahead_Compressor";
+}
+
+// EffectDefinitionInterface implementation
+
+EffectType EffectLookaheadCompressor::GetType() const
+{
+   return EffectTypeProcess;
+}
+
+auto EffectLookaheadCompressor::RealtimeSupport() const -> RealtimeSince
+{
+   return RealtimeSince::Always;
+}
+
+struct EffectLookaheadCompressor::Editor
+   : EffectEditor
+{
+   Editor(const EffectUIServices& services, EffectSettingsAccess& access,
+      const EffectLookaheadCompressorSettings& settings
+   )  : EffectEditor{ services, access }
+      , mSettings{ settings }
+   {}
+   virtual ~Editor() = default;
+
+   bool ValidateUI() override;
+   bool UpdateUI() override;
+
+   void PopulateOrExchange(ShuttleGui& S);
+
+   EffectLookaheadCompressorSettings mSettings;
+};
+
+std::unique_ptr<EffectEditor> EffectLookaheadCompressor::MakeEditor(
+   ShuttleGui & S, EffectInstance &, EffectSettingsAccess &access,
+   const EffectOutputs *) const
+{
+   auto& settings = access.Get();
+   auto& myEffSettings = GetSettings(settings);
+   auto result = std::make_unique<Editor>(*this, access, myEffSettings);
+   result->PopulateOrExchange(S);
+   return result;
+}
+
+void EffectLookaheadCompressor::Editor::PopulateOrExchange(ShuttleGui & S)
+{
+   S.AddSpace(0, 5);
+
+   S.StartMultiColumn(2, wxALIGN_CENTER);
+   {
+      S.Validator<FloatingPointValidator<double>>(
+            1, &mSettings.mThresholdDB, NumValidatorStyle::NO_TRAILING_ZEROES,
+            Threshold.min, Threshold.max)
+         .AddTextBox(XXO("&Threshold (dB):"), L"", 10);
+
+      S.Validator<FloatingPointValidator<double>>(
+            1, &mSettings.mRatio, NumValidatorStyle::NO_TRAILING_ZEROES,
+            Ratio.min, Ratio.max)
+         .AddTextBox(XXO("&Ratio:"), L"", 10);
+
+      S.Validator<FloatingPointValidator<double>>(
+            1, &mSettings.mKneeDB, NumValidatorStyle::NO_TRAILING_ZEROES,
+            Knee.min, Knee.max)
+         .AddTextBox(XXO("&Knee width (dB):"), L"", 10);
+
+      S.Validator<FloatingPointValidator<double>>(
+            1, &mSettings.mAttackTime, NumValidatorStyle::NO_TRAILING_ZEROES,
+            AttackTime.min, AttackTime.max)
+         .AddTextBox(XXO("&Attack time (ms):"), L"", 10);
+
+      S.Validator<FloatingPointValidator<double>>(
+            0, &mSettings.mReleaseTime, NumValidatorStyle::NO_TRAILING_ZEROES,
+            ReleaseTime.min, ReleaseTime.max)
+         .AddTextBox(XXO("R&elease time (ms):"), L"", 10);
+
+      S.Validator<FloatingPointValidator<double>>(
+            1, &mSettings.mLookahead, NumValidatorStyle::NO_TRAILING_ZEROES,
+            Lookahead.min, Lookahead.max)
+         .AddTextBox(XXO("&Lookahead (ms):"), L"", 10);
+
+      S.Validator<FloatingPointValidator<double>>(
+            1, &mSettings.mMakeupGainDB, NumValidatorStyle::NO_TRAILING_ZEROES,
+            MakeupGain.min, MakeupGain.max)
+         .AddTextBox(XXO("&Make-up gain (dB):"), L"", 10);
+   }
+   S.EndMultiColumn();
+}
+
+bool EffectLookaheadCompressor::Editor::ValidateUI()
+{
+   mAccess.ModifySettings
+   (
+      [this](EffectSettings& settings)
+      {
+         // pass back the modified settings to the MessageBuffer
+
+         EffectLookaheadCompressor::GetSettings(settings) = mSettings;
+         return nullptr;
+      }
+   );
+
+   return true;
+}
+
+bool EffectLookaheadCompressor::Editor::UpdateUI()
+{
+   // get the settings from the MessageBuffer and write them to our local copy
+   mSettings = GetSettings(mAccess.Get());
+
+   return true;
+}
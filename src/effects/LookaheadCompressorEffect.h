@@ -0,0 +1,102 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  LookaheadCompressorEffect.h
+
+**********************************************************************/
+
+#ifndef __AUDACITY_EFFECT_LOOKAHEAD_COMPRESSOR__
+#define __AUDACITY_EFFECT_LOOKAHEAD_COMPRESSOR__
+
+#include "StatelessPerTrackEffect.h"
+#include "ShuttleAutomation.h"
+
+struct EffectLookaheadCompressorSettings
+{
+   static constexpr double thresholdDefault = -12.0;
+   static constexpr double ratioDefault = 4.0;
+   static constexpr double kneeDefault = 6.0;
+   static constexpr double attackDefault = 10.0;
+   static constexpr double releaseDefault = 150.0;
+   static constexpr double lookaheadDefault = 5.0;
+   static constexpr double makeupDefault = 0.0;
+
+   double mThresholdDB{ thresholdDefault };
+   double mRatio{ ratioDefault };
+   double mKneeDB{ kneeDefault };
+   //! Milliseconds
+   double mAttackTime{ attackDefault };
+   //! Milliseconds
+   double mReleaseTime{ releaseDefault };
+   //! Milliseconds; this is also the latency
+   double mLookahead{ lookaheadDefault };
+   double mMakeupGainDB{ makeupDefault };
+};
+
+//! Compressor and limiter in one pass, that can also be applied in realtime
+/*!
+ Unlike EffectCompressor, it does not scan the selection first to normalize,
+ so the level is set by an explicit make-up gain instead.
+ */
+class EffectLookaheadCompressor final : public EffectWithSettings<
+   EffectLookaheadCompressorSettings, StatelessPerTrackEffect
+>
+{
+public:
+   static const ComponentInterfaceSymbol Symbol;
+
+   EffectLookaheadCompressor();
+   virtual ~EffectLookaheadCompressor();
+
+   // ComponentInterface implementation
+
+   ComponentInterfaceSymbol GetSymbol() const override;
+   TranslatableString GetDescription() const override;
+   ManualPageID ManualPage() const override;
+
+   // EffectDefinitionInterface implementation
+
+   EffectType GetType() const override;
+   RealtimeSince RealtimeSupport() const override;
+
+   // Effect implementation
+
+   std::unique_ptr<EffectEditor> MakeEditor(
+      ShuttleGui & S, EffectInstance &instance,
+      EffectSettingsAccess &access, const EffectOutputs *pOutputs)
+   const override;
+
+   struct Editor;
+
+   struct Instance;
+
+   std::shared_ptr<EffectInstance> MakeInstance() const override;
+
+private:
+   const EffectParameterMethods& Parameters() const override;
+
+static constexpr EffectParameter Threshold{
+   &EffectLookaheadCompressorSettings::mThresholdDB,
+   L"Threshold", EffectLookaheadCompressorSettings::thresholdDefault, -60, 0, 1 };
+static constexpr EffectParameter Ratio{
+   &EffectLookaheadCompressorSettings::mRatio,
+   L"Ratio", EffectLookaheadCompressorSettings::ratioDefault, 1, 50, 10 };
+static constexpr EffectParameter Knee{
+   &EffectLookaheadCompressorSettings::mKneeDB,
+   L"Knee", EffectLookaheadCompressorSettings::kneeDefault, 0, 24, 1 };
+static constexpr EffectParameter AttackTime{
+   &EffectLookaheadCompressorSettings::mAttackTime,
+   L"AttackTime", EffectLookaheadCompressorSettings::attackDefault, 0.1, 500, 10 };
+static constexpr EffectParameter ReleaseTime{
+   &EffectLookaheadCompressorSettings::mReleaseTime,
+   L"ReleaseTime", EffectLookaheadCompressorSettings::releaseDefault, 1, 5000, 1 };
+static constexpr EffectParameter Lookahead{
+   &EffectLookaheadCompressorSettings::mLookahead,
+   L"Lookahead", EffectLookaheadCompressorSettings::lookaheadDefault, 0, 50, 10 };
+static constexpr EffectParameter MakeupGain{
+   &EffectLookaheadCompressorSettings::mMakeupGainDB,
+   L"MakeupGain", EffectLookaheadCompressorSettings::makeupDefault, -24, 24, 1 };
+};
+
+#endif
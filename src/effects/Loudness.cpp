@@ -368,6 +368,9 @@ void EffectLoudness::AllocBuffers(TrackList &outputs)
          stereoTrackFound = true;
    }
 
+   // Room for several blocks at once, for the analysis
+   mTrackBufferCapacity *= AnalysisBlocks;
+
    // Initiate a processing buffer. This buffer will (most likely)
    // be shorter than the length of the track being processed.
    mTrackBuffer[0].reinit(mTrackBufferCapacity);
@@ -420,8 +423,10 @@ bool EffectLoudness::ProcessOne(WaveChannel &track, size_t nChannels,
    while (s < end) {
       // Get a block of samples (smaller than the size of the buffer)
       // Adjust the block size if it is the final block in the track
+      // Analysis takes the whole buffer at once, which lets EBUR128 split
+      // the filtering among threads
       auto blockLen = limitSampleBufferSize(
-         track.GetBestBlockSize(s),
+         pLoudnessProcessor ? mTrackBufferCapacity : track.GetBestBlockSize(s),
          mTrackBufferCapacity);
 
       const size_t remainingLen = (end - s).as_size_t();
@@ -471,13 +476,9 @@ void EffectLoudness::LoadBufferBlock(WaveChannel &track, size_t nChannels,
 /// (for loudness).
 bool EffectLoudness::AnalyseBufferBlock(EBUR128 &loudnessProcessor)
 {
-   for(size_t i = 0; i < mTrackBufferLen; i++)
-   {
-      loudnessProcessor.ProcessSampleFromChannel(mTrackBuffer[0][i], 0);
-      if (mProcStereo)
-         loudnessProcessor.ProcessSampleFromChannel(mTrackBuffer[1][i], 1);
-      loudnessProcessor.NextSample();
-   }
+   const float *const channels[2]{
+      mTrackBuffer[0].get(), mTrackBuffer[1].get() };
+   loudnessProcessor.ProcessSamples(channels, mTrackBufferLen);
 
    if (!UpdateProgress())
       return false;
@@ -107,6 +107,9 @@ private:
    wxCheckBox *mStereoIndCheckBox;
    wxCheckBox *mDualMonoCheckBox;
 
+   //! Analysis reads this many of the largest sample blocks at once
+   static constexpr size_t AnalysisBlocks = 8;
+
    Floats mTrackBuffer[2];    // MM: must be increased once surround channels are supported
    size_t mTrackBufferLen;
    size_t mTrackBufferCapacity;
@@ -103,6 +103,9 @@ bool EffectNoise::ProcessInitialize(EffectSettings &,
    double sampleRate, ChannelNames)
 {
    mSampleRate = sampleRate;
+   // Seeded from rand(), which made all of the noise before, so that srand()
+   // still repeats it
+   mNoise = Oscillators::SeedNoise(rand());
    return true;
 }
 
@@ -113,7 +116,9 @@ size_t EffectNoise::ProcessBlock(EffectSettings &,
 
    float white;
    float amplitude;
-   float div = ((float) RAND_MAX) / 2.0f;
+
+   // The white noise for all types, filtered in place for the others
+   Oscillators::WhiteNoise(mNoise, buffer, size);
 
    switch (mType)
    {
@@ -121,7 +126,7 @@ size_t EffectNoise::ProcessBlock(EffectSettings &,
    case kWhite: // white
        for (decltype(size) i = 0; i < size; i++)
        {
-          buffer[i] = mAmp * ((rand() / div) - 1.0f);
+          buffer[i] *= mAmp;
        }
        break;
 
@@ -132,7 +137,7 @@ size_t EffectNoise::ProcessBlock(EffectSettings &,
       amplitude = mAmp * 0.129f;
       for (decltype(size) i = 0; i < size; i++)
       {
-         white = (rand() / div) - 1.0f;
+         white = buffer[i];
          buf0 = 0.99886f * buf0 + 0.0555179f * white;
          buf1 = 0.99332f * buf1 + 0.0750759f * white;
          buf2 = 0.96900f * buf2 + 0.1538520f * white;
@@ -159,7 +164,7 @@ size_t EffectNoise::ProcessBlock(EffectSettings &,
 
       for (decltype(size) i = 0; i < size; i++)
       {
-         white = (rand() / div) - 1.0f;
+         white = buffer[i];
          z = leakage * y + white * scaling;
          y = fabs(z) > 1.0
             ? leakage * y - white * scaling
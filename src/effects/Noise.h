@@ -14,6 +14,7 @@
 #define __AUDACITY_EFFECT_NOISE__
 
 #include "StatefulPerTrackEffect.h"
+#include "Oscillators.h"
 #include "ShuttleAutomation.h"
 #include <wx/weakref.h>
 
@@ -65,6 +66,7 @@ private:
    double mAmp;
 
    float y, z, buf0, buf1, buf2, buf3, buf4, buf5, buf6;
+   Oscillators::NoiseState mNoise{};
 
    NumericTextCtrl *mNoiseDurationT;
 
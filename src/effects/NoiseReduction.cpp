@@ -54,6 +54,7 @@
 
 #include "WaveTrack.h"
 #include "AudacityMessageBox.h"
+#include "concurrency/ThreadPool.h"
 #include "../widgets/valnum.h"
 
 #include <algorithm>
@@ -262,6 +263,7 @@ struct MyTransformer : TrackSpectrumTransformer {
          windowSize, stepsPerWindow, leadingPadding, trailingPadding
       }
       , mWorker{ worker }
+      , mFreqSmoothingScratch(windowSize / 2 + 1)
    {
    }
    struct MyWindow : public Window
@@ -280,9 +282,16 @@ struct MyTransformer : TrackSpectrumTransformer {
    MyWindow &NthWindow(int nn) { return static_cast<MyWindow&>(Nth(nn)); }
    std::unique_ptr<Window> NewWindow(size_t windowSize) override;
    bool DoStart() override;
+   //! Collects output in mPending, which the thread that started the
+   //! processing appends to the track
+   void DoOutput(const float *outBuffer, size_t mStepSize) override;
    bool DoFinish() override;
 
    EffectNoiseReduction::Worker &mWorker;
+   // Owned here, not by the worker, so that channels may be processed at once
+   FloatVector mFreqSmoothingScratch;
+   FloatVector mPending;
+   sampleCount mWindowCount = 0;
 };
 
 //----------------------------------------------------------------------------
@@ -309,7 +318,12 @@ public:
 
    static bool Processor(SpectrumTransformer &transformer);
 
-   void ApplyFreqSmoothing(FloatVector &gains);
+   //! Reduce noise in all channels of the given tracks, on the thread pool
+   struct Reduction;
+   bool ReduceChannels(eWindowFunctions inWindowType,
+      eWindowFunctions outWindowType, std::vector<Reduction> &reductions);
+
+   void ApplyFreqSmoothing(FloatVector &gains, FloatVector &scratch) const;
    void GatherStatistics(MyTransformer &transformer);
    inline bool Classify(
       MyTransformer &transformer, unsigned nWindows, int band);
@@ -322,7 +336,6 @@ public:
    const Settings &mSettings;
    Statistics &mStatistics;
 
-   FloatVector mFreqSmoothingScratch;
    const size_t mFreqSmoothingBins;
    // When spectral selection limits the affected band:
    size_t mBinLow;  // inclusive lower bound
@@ -341,10 +354,16 @@ public:
    unsigned  mCenter;
    unsigned  mHistoryLen;
 
-   // Following are for progress indicator only:
+   // Following are for progress indicator of profiling only:
    unsigned  mProgressTrackCount = 0;
    sampleCount mLen = 0;
-   sampleCount mProgressWindowCount = 0;
+};
+
+//! A selected track, and its copy that receives the reduced channels
+struct EffectNoiseReduction::Worker::Reduction {
+   WaveTrack &track;
+   WaveTrack::Holder pTempTrack;
+   sampleCount start, len;
 };
 
 /****************************************************************//**
@@ -633,6 +652,11 @@ MyTransformer::MyWindow::~MyWindow()
 {
 }
 
+void MyTransformer::DoOutput(const float *outBuffer, size_t mStepSize)
+{
+   mPending.insert(mPending.end(), outBuffer, outBuffer + mStepSize);
+}
+
 bool EffectNoiseReduction::Process(EffectInstance &, EffectSettings &)
 {
    // This same code will either reduce noise or profile it
@@ -723,8 +747,8 @@ bool EffectNoiseReduction::Worker::Process(
    TrackList &tracks, double inT0, double inT1)
 {
    mProgressTrackCount = 0;
+   std::vector<Reduction> reductions;
    for (auto track : tracks.Selected<WaveTrack>()) {
-      mProgressWindowCount = 0;
       if (track->GetRate() != mStatistics.mRate) {
          if (mDoProfile)
             EffectUIServices::DoMessageBox(mEffect,
@@ -745,46 +769,27 @@ bool EffectNoiseReduction::Worker::Process(
          auto start = track->TimeToLongSamples(t0);
          auto end = track->TimeToLongSamples(t1);
          const auto len = end - start;
-         mLen = len;
-         const auto extra =
-            (mSettings.StepsPerWindow() - 1) * mSettings.SpectrumSize();
-         // Adjust denominator for presence or absence of padding,
-         // which makes the number of windows visited either more or less
-         // than the number of window steps in the data.
-         if (mDoProfile)
-            mLen -= extra;
-         else
-            mLen += extra;
-
-         auto t0 = track->LongSamplesToTime(start);
-         auto tLen = track->LongSamplesToTime(len);
-         std::optional<WaveTrack::Holder> ppTempTrack;
-         std::optional<ChannelGroup::ChannelIterator<WaveChannel>> pIter;
-         WaveTrack *pFirstTrack{};
-         if (!mSettings.mDoProfile) {
-            ppTempTrack.emplace(track->EmptyCopy());
-            pFirstTrack = ppTempTrack->get();
-            pIter.emplace(pFirstTrack->Channels().begin());
+         if (!mDoProfile) {
+            // Reduce after all tracks are checked
+            reductions.push_back({ *track, track->EmptyCopy(), start, len });
+            continue;
          }
+
+         // Adjust denominator for absence of padding, which makes the number
+         // of windows visited less than the number of window steps in the data.
+         mLen = len -
+            (mSettings.StepsPerWindow() - 1) * mSettings.SpectrumSize();
          for (const auto pChannel : track->Channels()) {
-            auto pOutputTrack = pIter ? *(*pIter)++ : nullptr;
-            MyTransformer transformer{ *this, pOutputTrack.get(),
-               !mSettings.mDoProfile, inWindowType, outWindowType,
+            MyTransformer transformer{ *this, nullptr,
+               false, inWindowType, outWindowType,
                mSettings.WindowSize(), mSettings.StepsPerWindow(),
-               !mSettings.mDoProfile, !mSettings.mDoProfile
+               false, false
             };
             if (!transformer
                .Process(Processor, *pChannel, mHistoryLen, start, len))
                return false;
             ++mProgressTrackCount;
          }
-         if (ppTempTrack) {
-            TrackSpectrumTransformer::PostProcess(*pFirstTrack, len);
-            constexpr auto preserveSplits = true;
-            constexpr auto merge = true;
-            track->ClearAndPaste(
-               t0, t0 + tLen, **ppTempTrack, preserveSplits, merge);
-         }
       }
    }
 
@@ -795,11 +800,132 @@ bool EffectNoiseReduction::Worker::Process(
          return false;
       }
    }
+   else {
+      if (!ReduceChannels(inWindowType, outWindowType, reductions))
+         return false;
+      for (auto &[track, pTempTrack, start, len] : reductions) {
+         TrackSpectrumTransformer::PostProcess(*pTempTrack, len);
+         constexpr auto preserveSplits = true;
+         constexpr auto merge = true;
+         const auto t0 = track.LongSamplesToTime(start);
+         const auto tLen = track.LongSamplesToTime(len);
+         track.ClearAndPaste(
+            t0, t0 + tLen, *pTempTrack, preserveSplits, merge);
+      }
+   }
+
+   return true;
+}
+
+bool EffectNoiseReduction::Worker::ReduceChannels(
+   eWindowFunctions inWindowType, eWindowFunctions outWindowType,
+   std::vector<Reduction> &reductions)
+{
+   // One channel's transformer, with its position in the input
+   struct Job {
+      Job(Worker &worker, const WaveChannel &input, WaveChannel &output,
+         eWindowFunctions inWindowType, eWindowFunctions outWindowType,
+         sampleCount start, sampleCount len)
+         : transformer{ worker, &output, true, inWindowType, outWindowType,
+            worker.mSettings.WindowSize(), worker.mSettings.StepsPerWindow(),
+            true, true }
+         , input{ input }, output{ output }
+         , pos{ start }, end{ start + len }
+         , buffer(input.GetMaxBlockSize())
+      {}
+      MyTransformer transformer;
+      const WaveChannel &input;
+      WaveChannel &output;
+      sampleCount pos, end;
+      FloatVector buffer;
+      bool finished = false;
+      bool ok = true;
+   };
+
+   // Extra windows visited because of the padding, for progress
+   const auto extra =
+      (mSettings.StepsPerWindow() - 1) * mSettings.SpectrumSize();
+   struct Input {
+      const WaveChannel &channel;
+      std::shared_ptr<WaveChannel> pOutput;
+      sampleCount start, len;
+   };
+   std::vector<Input> inputs;
+   double totalWindows = 0;
+   for (auto &[track, pTempTrack, start, len] : reductions) {
+      auto iter = pTempTrack->Channels().begin();
+      for (const auto pChannel : track.Channels()) {
+         inputs.push_back({ *pChannel, *iter++, start, len });
+         totalWindows +=
+            (len + extra).as_double() / mSettings.StepSize();
+      }
+   }
 
+   // Rounds take one block of input for each job, on the thread pool;
+   // output is appended to the tracks in this thread
+   const auto step = [](Job &job){
+      if (job.pos < job.end) {
+         const auto blockSize = limitSampleBufferSize(
+            std::min(job.buffer.size(), job.input.GetBestBlockSize(job.pos)),
+            job.end - job.pos);
+         job.input.GetFloats(job.buffer.data(), job.pos, blockSize);
+         job.pos += blockSize;
+         job.ok = job.transformer
+            .ProcessSamples(Processor, job.buffer.data(), blockSize);
+      }
+      else {
+         job.ok = job.transformer.Finish(Processor);
+         job.finished = true;
+      }
+   };
+
+   auto &pool = audacity::concurrency::ThreadPool::GetDefault();
+   // Bound the number of transformers at once
+   const auto nJobs = std::max<size_t>(1, pool.GetThreadsCount());
+   double finishedWindows = 0;
+   for (size_t first = 0; first < inputs.size(); first += nJobs) {
+      const auto last = std::min(inputs.size(), first + nJobs);
+      std::vector<std::unique_ptr<Job>> jobs;
+      for (auto ii = first; ii < last; ++ii) {
+         const auto &input = inputs[ii];
+         auto &job = *jobs.emplace_back(std::make_unique<Job>(*this,
+            input.channel, *input.pOutput, inWindowType, outWindowType,
+            input.start, input.len));
+         if (!job.transformer.Start(mHistoryLen))
+            return false;
+      }
+      while (!jobs.empty()) {
+         pool.ParallelFor(jobs.size(), [&](size_t ii){ step(*jobs[ii]); });
+
+         double windows = finishedWindows;
+         for (auto iter = jobs.begin(); iter != jobs.end();) {
+            auto &job = **iter;
+            if (!job.ok)
+               return false;
+            auto &pending = job.transformer.mPending;
+            job.output.Append(reinterpret_cast<constSamplePtr>(pending.data()),
+               floatSample, pending.size());
+            pending.clear();
+            if (job.finished) {
+               finishedWindows += job.transformer.mWindowCount.as_double();
+               windows += job.transformer.mWindowCount.as_double();
+               iter = jobs.erase(iter);
+            }
+            else {
+               windows += job.transformer.mWindowCount.as_double();
+               ++iter;
+            }
+         }
+         if (mEffect.TotalProgress(
+            std::min(1.0, windows / std::max(1.0, totalWindows))))
+            return false;
+      }
+   }
    return true;
 }
 
-void EffectNoiseReduction::Worker::ApplyFreqSmoothing(FloatVector &gains)
+void EffectNoiseReduction::Worker::ApplyFreqSmoothing(
+   FloatVector &gains, FloatVector &scratch) const
 {
    // Given an array of gain mutipliers, average them
    // GEOMETRICALLY.  Don't multiply and take nth root --
@@ -809,27 +935,30 @@ void EffectNoiseReduction::Worker::ApplyFreqSmoothing(FloatVector &gains)
       return;
 
    const auto spectrumSize = mSettings.SpectrumSize();
-
-   {
-      auto pScratch = mFreqSmoothingScratch.data();
-      std::fill(pScratch, pScratch + spectrumSize, 0.0f);
-   }
+   const auto pGains = gains.data();
+   const auto pScratch = scratch.data();
 
    for (size_t ii = 0; ii < spectrumSize; ++ii)
-      gains[ii] = log(gains[ii]);
-
+      pScratch[ii] = log(pGains[ii]);
+
+   // Slide a window of bins over the logs, adding the bins entering and
+   // subtracting the bins leaving, instead of summing the whole window for
+   // each bin.  Accumulate in double, to limit the drift.
+   const int last = spectrumSize - 1;
+   const int bins = mFreqSmoothingBins;
+   double sum = 0;
+   // Sum is of the bins from lo to hi inclusive
+   int lo = 0, hi = -1;
    // ii must be signed
-   for (int ii = 0; ii < (int)spectrumSize; ++ii) {
-      const int j0 = std::max(0, ii - (int)mFreqSmoothingBins);
-      const int j1 = std::min(spectrumSize - 1, ii + mFreqSmoothingBins);
-      for(int jj = j0; jj <= j1; ++jj) {
-         mFreqSmoothingScratch[ii] += gains[jj];
-      }
-      mFreqSmoothingScratch[ii] /= (j1 - j0 + 1);
+   for (int ii = 0; ii <= last; ++ii) {
+      const int j0 = std::max(0, ii - bins);
+      const int j1 = std::min(last, ii + bins);
+      while (hi < j1)
+         sum += pScratch[++hi];
+      while (lo < j0)
+         sum -= pScratch[lo++];
+      pGains[ii] = exp(sum / (j1 - j0 + 1));
    }
-
-   for (size_t ii = 0; ii < spectrumSize; ++ii)
-      gains[ii] = exp(mFreqSmoothingScratch[ii]);
 }
 
 EffectNoiseReduction::Worker::Worker(EffectNoiseReduction &effect,
@@ -844,7 +973,6 @@ EffectNoiseReduction::Worker::Worker(EffectNoiseReduction &effect,
 , mSettings{ settings }
 , mStatistics{ statistics }
 
-, mFreqSmoothingScratch(mSettings.SpectrumSize())
 , mFreqSmoothingBins{ size_t(std::max(0.0, settings.mFreqSmoothingBands)) }
 , mBinLow{ 0 }
 , mBinHigh{ mSettings.SpectrumSize() }
@@ -939,10 +1067,15 @@ bool EffectNoiseReduction::Worker::Processor(SpectrumTransformer &trans)
    else
       worker.ReduceNoise(transformer);
 
+   ++transformer.mWindowCount;
+   if (!worker.mDoProfile)
+      // ReduceChannels() reports progress between blocks
+      return true;
+
    // Update the Progress meter, let user cancel
    return !worker.mEffect.TrackProgress(worker.mProgressTrackCount,
       std::min(1.0,
-         ((++worker.mProgressWindowCount).as_double() *
+         (transformer.mWindowCount.as_double() *
           worker.mSettings.StepSize()) / worker.mLen.as_double()));
 }
 
@@ -1169,7 +1302,7 @@ void EffectNoiseReduction::Worker::ReduceNoise(MyTransformer &transformer)
       if (mNoiseReductionChoice != NRC_ISOLATE_NOISE)
          // Apply frequency smoothing to output gain
          // Gains are not less than mNoiseAttenFactor
-         ApplyFreqSmoothing(record.mGains);
+         ApplyFreqSmoothing(record.mGains, transformer.mFreqSmoothingScratch);
 
       // Apply gain to FFT
       {
@@ -19,6 +19,7 @@
 #include "LoadEffects.h"
 
 #include <algorithm>
+#include <random>
 
 #include <math.h>
 
@@ -26,6 +27,8 @@
 
 #include "ShuttleGui.h"
 #include "FFT.h"
+#include "RealFFTPlan.h"
+#include "concurrency/ThreadPool.h"
 #include "../widgets/valnum.h"
 #include "AudacityMessageBox.h"
 #include "Prefs.h"
@@ -42,8 +45,20 @@ const EffectParameterMethods& EffectPaulstretch::Parameters() const
    return parameters;
 }
 
+namespace {
+//! Bound on the memory for windows of one batch
+constexpr size_t MaxBatchBytes = 64 * 1024 * 1024;
+}
+
 /// \brief Class that helps EffectPaulStretch.  It does the FFTs and inner loop
 /// of the effect.
+/*!
+ Each window of output depends only on one window of input, and on random
+ phases seeded by the number of the window, so windows can be randomized
+ concurrently, with one RealFFTPlan for each thread, and with the same result
+ for any number of threads.  Only the input pool and the crossfade of
+ consecutive windows are sequential.
+ */
 class PaulStretch
 {
 public:
@@ -51,14 +66,24 @@ public:
    //in_bufsize is also a half of a FFT buffer (in samples)
    virtual ~PaulStretch();
 
-   void process(float *smps, size_t nsmps);
+   //! Add NEW samples to the pool, and copy the whole pool into `window`
+   void add_samples(const float *smps, size_t nsmps, float *window);
+
+   //! Replace `poolsize` samples of `window` with samples of the same
+   //! spectral magnitudes and random phases
+   /*!
+    May be called concurrently, each time with a distinct plan
+    @param plan of size `poolsize`
+    */
+   void randomize(float *window, RealFFTPlan &plan, unsigned seed) const;
+
+   //! Crossfade a randomized window with the previous one, into out_buf
+   void make_output(const float *window);
 
    size_t get_nsamples();//how many samples are required to be added in the pool next time
    size_t get_nsamples_for_fill();//how many samples are required to be added for a complete buffer refill (at start of the song or after seek)
 
 private:
-   void process_spectrum(float *WXUNUSED(freq)) {};
-
    const float samplerate;
    const float rap;
    const size_t in_bufsize;
@@ -68,6 +93,7 @@ public:
    const Floats out_buf;
 
 private:
+   //! First half of the previous randomized window
    const Floats old_out_smp_buf;
 
 public:
@@ -75,10 +101,10 @@ public:
 
 private:
    const Floats in_pool;//de marimea in_bufsize
+   //! Hann window, computed once
+   const Floats window_func;
 
    double remained_samples;//how many fraction of samples has remained (0..1)
-
-   const Floats fft_smps, fft_c, fft_s, fft_freq, fft_tmp;
 };
 
 //
@@ -348,41 +374,74 @@ bool EffectPaulstretch::ProcessOne(const WaveChannel &track,
       // the constructor of the PaulStretch object
 
       PaulStretch stretch(amount, stretch_buf_size, rate);
-
-      auto nget = stretch.get_nsamples_for_fill();
-
-      auto bufsize = stretch.poolsize;
+      const auto bufsize = stretch.poolsize;
       Floats buffer0{ bufsize };
-      float *bufferptr0 = buffer0.get();
-      bool first_time = true;
-
-      const auto fade_len = std::min<size_t>(100, bufsize / 2 - 1);
-      bool cancelled = false;
-
-      {
-         Floats fade_track_smps{ fade_len };
-         decltype(len) s=0;
 
-         while (s < len) {
-            track.GetFloats(bufferptr0, start + s, nget);
-            stretch.process(buffer0.get(), nget);
-
-            if (first_time) {
-               stretch.process(buffer0.get(), 0);
-            };
+      auto &pool = audacity::concurrency::ThreadPool::GetDefault();
+      const size_t nThreads =
+         pool.IsWorkerThread() ? 1 : pool.GetThreadsCount();
+      // Enough windows to keep all threads busy, but within a memory bound
+      const auto batchSize = std::clamp<size_t>(
+         MaxBatchBytes / (bufsize * sizeof(float)), 1, 4 * nThreads);
+      std::vector<PffftFloatVector> windows(
+         batchSize, PffftFloatVector(bufsize));
+      // Input position after the read for each window of the batch
+      std::vector<sampleCount> positions(batchSize);
+      std::vector<std::unique_ptr<RealFFTPlan>> plans;
+      for (size_t ii = 0; ii < std::min(nThreads, batchSize); ++ii)
+         plans.push_back(std::make_unique<RealFFTPlan>(bufsize));
 
+      const auto fade_len = std::min<size_t>(100, bufsize / 2 - 1);
+      Floats fade_track_smps{ fade_len };
+
+      decltype(len) s = 0;
+      // Count of windows; the first is only the previous of the second, which
+      // randomizes the same pool again
+      unsigned iWindow = 0;
+      bool gathered = false;
+      while (!gathered) {
+         // Fill the pool for each window of the batch, in sequence
+         size_t nWindows = 0;
+         for (; nWindows < batchSize && !gathered; ++nWindows) {
+            const auto window = iWindow + nWindows;
+            size_t nget = 0;
+            if (window == 0)
+               nget = stretch.get_nsamples_for_fill();
+            else if (window > 1)
+               nget = stretch.get_nsamples();
+            if (nget > 0)
+               track.GetFloats(buffer0.get(), start + s, nget);
+            stretch.add_samples(
+               buffer0.get(), nget, windows[nWindows].data());
             s += nget;
+            positions[nWindows] = s;
+            gathered = window > 0 && s >= len;
+         }
 
-            if (first_time){//blend the start of the selection
+         // Randomize the windows concurrently, each thread with its own plan
+         const auto nSlots = std::min(plans.size(), nWindows);
+         const auto randomize = [&](size_t slot){
+            for (auto ii = slot; ii < nWindows; ii += nSlots)
+               stretch.randomize(
+                  windows[ii].data(), *plans[slot], iWindow + ii);
+         };
+         pool.ParallelFor(nSlots, randomize);
+
+         // Crossfade and append in sequence
+         for (size_t ii = 0; ii < nWindows; ++ii, ++iWindow) {
+            stretch.make_output(windows[ii].data());
+            if (iWindow == 0)
+               continue;
+
+            if (iWindow == 1) {//blend the start of the selection
                track.GetFloats(fade_track_smps.get(), start, fade_len);
-               first_time = false;
                for (size_t i = 0; i < fade_len; i++){
                   float fi = (float)i / (float)fade_len;
                   stretch.out_buf[i] =
                      stretch.out_buf[i] * fi + (1.0 - fi) * fade_track_smps[i];
                }
             }
-            if (s >= len){//blend the end of the selection
+            if (positions[ii] >= len) {//blend the end of the selection
                track.GetFloats(fade_track_smps.get(), end - fade_len, fade_len);
                for (size_t i = 0; i < fade_len; i++){
                   float fi = (float)i / (float)fade_len;
@@ -395,18 +454,14 @@ bool EffectPaulstretch::ProcessOne(const WaveChannel &track,
 
             outputTrack.Append((samplePtr)stretch.out_buf.get(), floatSample, stretch.out_bufsize);
 
-            nget = stretch.get_nsamples();
             if (TrackProgress(count,
-               s.as_double() / len.as_double()
-            )) {
-               cancelled = true;
-               break;
-            }
+               positions[ii].as_double() / len.as_double()
+            ))
+               return false;
          }
       }
 
-      if (!cancelled)
-         return true;
+      return true;
    }
    catch ( const std::bad_alloc& ) {
       EffectUIServices::DoMessageBox(*this, badAllocMessage);
@@ -423,23 +478,21 @@ PaulStretch::PaulStretch(float rap_, size_t in_bufsize_, float samplerate_ )
    , in_bufsize { in_bufsize_ }
    , out_bufsize { std::max(size_t{ 8 }, in_bufsize) }
    , out_buf { out_bufsize }
-   , old_out_smp_buf { out_bufsize * 2, true }
+   , old_out_smp_buf { out_bufsize, true }
    , poolsize { in_bufsize_ * 2 }
    , in_pool { poolsize, true }
+   , window_func { poolsize }
    , remained_samples { 0.0 }
-   , fft_smps { poolsize, true }
-   , fft_c { poolsize, true }
-   , fft_s { poolsize, true }
-   , fft_freq { poolsize, true }
-   , fft_tmp { poolsize }
 {
+   std::fill(window_func.get(), window_func.get() + poolsize, 1.0f);
+   WindowFunc(eWinFuncHann, poolsize, window_func.get());
 }
 
 PaulStretch::~PaulStretch()
 {
 }
 
-void PaulStretch::process(float *smps, size_t nsmps)
+void PaulStretch::add_samples(const float *smps, size_t nsmps, float *window)
 {
    //add NEW samples to the pool
    if ((smps != NULL) && (nsmps != 0)) {
@@ -459,40 +512,34 @@ void PaulStretch::process(float *smps, size_t nsmps)
 
    //get the samples from the pool
    for (size_t i = 0; i < poolsize; i++)
-      fft_smps[i] = in_pool[i];
-   WindowFunc(eWinFuncHann, poolsize, fft_smps.get());
-
-   RealFFT(poolsize, fft_smps.get(), fft_c.get(), fft_s.get());
-
-   for (size_t i = 0; i < poolsize / 2; i++)
-      fft_freq[i] = sqrt(fft_c[i] * fft_c[i] + fft_s[i] * fft_s[i]);
-   process_spectrum(fft_freq.get());
+      window[i] = in_pool[i];
+}
 
+void PaulStretch::randomize(
+   float *window, RealFFTPlan &plan, unsigned seed) const
+{
+   for (size_t i = 0; i < poolsize; i++)
+      window[i] *= window_func[i];
+   plan.Forward(window);
 
    //put randomize phases to frequencies and do a IFFT
-   float inv_2p15_2pi = 1.0 / 16384.0 * (float)M_PI;
+   std::minstd_rand random{ seed + 1 };
+   std::uniform_real_distribution<float> phases{ 0.0f, float(2 * M_PI) };
    for (size_t i = 1; i < poolsize / 2; i++) {
-      unsigned int random = (rand()) & 0x7fff;
-      float phase = random * inv_2p15_2pi;
-      float s = fft_freq[i] * sin(phase);
-      float c = fft_freq[i] * cos(phase);
-
-      fft_c[i] = fft_c[poolsize - i] = c;
-
-      fft_s[i] = s; fft_s[poolsize - i] = -s;
-   }
-   fft_c[0] = fft_s[0] = 0.0;
-   fft_c[poolsize / 2] = fft_s[poolsize / 2] = 0.0;
-
-   FFT(poolsize, true, fft_c.get(), fft_s.get(), fft_smps.get(), fft_tmp.get());
-
-   float max = 0.0, max2 = 0.0;
-   for (size_t i = 0; i < poolsize; i++) {
-      max = std::max(max, fabsf(fft_tmp[i]));
-      max2 = std::max(max2, fabsf(fft_smps[i]));
+      auto &re = window[2 * i], &im = window[2 * i + 1];
+      const float freq = sqrt(re * re + im * im);
+      const float phase = phases(random);
+      re = freq * cos(phase);
+      im = freq * sin(phase);
    }
+   // DC and Nyquist
+   window[0] = window[1] = 0.0;
 
+   plan.Inverse(window);
+}
 
+void PaulStretch::make_output(const float *window)
+{
    //make the output buffer
    float tmp = 1.0 / (float) out_bufsize * M_PI;
    float hinv_sqrt2 = 0.853553390593f;//(1.0+1.0/sqrt(2))*0.5;
@@ -505,15 +552,15 @@ void PaulStretch::process(float *smps, size_t nsmps)
 
    for (size_t i = 0; i < out_bufsize; i++) {
       float a = (0.5 + 0.5 * cos(i * tmp));
-      float out = fft_smps[i + out_bufsize] * (1.0 - a) + old_out_smp_buf[i] * a;
+      float out = window[i + out_bufsize] * (1.0 - a) + old_out_smp_buf[i] * a;
       out_buf[i] =
          out * (hinv_sqrt2 - (1.0 - hinv_sqrt2) * cos(i * 2.0 * tmp)) *
          ampfactor;
    }
 
    //copy the current output buffer to old buffer
-   for (size_t i = 0; i < out_bufsize * 2; i++)
-      old_out_smp_buf[i] = fft_smps[i];
+   for (size_t i = 0; i < out_bufsize; i++)
+      old_out_smp_buf[i] = window[i];
 }
 
 size_t PaulStretch::get_nsamples()
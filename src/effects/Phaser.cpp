@@ -21,6 +21,7 @@
 #include "EffectEditor.h"
 #include "LoadEffects.h"
 
+#include <algorithm>
 #include <math.h>
 
 #include <wx/slider.h>
@@ -496,18 +497,29 @@ size_t EffectPhaser::Instance::InstanceProcess(EffectSettings &settings,
    data.phase = ms.mPhase * M_PI / 180;
    data.outgain = DB_TO_LINEAR(ms.mOutGain);
 
-   for (decltype(blockLen) i = 0; i < blockLen; i++)
-   {
-      double in = ibuf[i];
+   // Constants of the block
+   const int stages = ms.mStages;
+   // Feedback must be less than 100% to avoid infinite gain.
+   const double feedback = ms.mFeedback / 101.0;
+   const double wet = data.outgain * ms.mDryWet / 255;
+   const double dry = data.outgain * (255 - ms.mDryWet) / 255;
 
-      double m = in + data.fbout * ms.mFeedback / 101;  // Feedback must be less than 100% to avoid infinite gain.
+   // State in locals for the inner loops, so that it may stay in registers
+   double old[NUM_STAGES];
+   std::copy(data.old, data.old + stages, old);
+   double fbout = data.fbout;
 
-      if (((data.skipcount++) % lfoskipsamples) == 0)
+   // Runs of samples between recomputations of the lfo value
+   for (decltype(blockLen) i = 0; i < blockLen;)
+   {
+      const auto offset = (data.skipcount % lfoskipsamples).as_size_t();
+      const auto n = std::min<size_t>(blockLen - i, lfoskipsamples - offset);
+      if (offset == 0)
       {
          //compute sine between 0 and 1
          data.gain =
             (1.0 +
-             cos(data.skipcount.as_double() * data.lfoskip
+             cos((data.skipcount + 1).as_double() * data.lfoskip
                  + data.phase)) / 2.0;
 
          // change lfo shape
@@ -516,19 +528,31 @@ size_t EffectPhaser::Instance::InstanceProcess(EffectSettings &settings,
          // attenuate the lfo
          data.gain = 1.0 - data.gain / 255.0 * ms.mDepth;
       }
+      data.skipcount += n;
+      const double gain = data.gain;
 
-      // phasing routine
-      for (int j = 0; j < ms.mStages; j++)
+      for (const auto end = i + n; i < end; i++)
       {
-         double tmp = data.old[j];
-         data.old[j] = data.gain * tmp + m;
-         m = tmp - data.gain * data.old[j];
-      }
-      data.fbout = m;
+         double in = ibuf[i];
+
+         double m = in + fbout * feedback;
 
-      obuf[i] = (float) (data.outgain * (m * ms.mDryWet + in * (255 - ms.mDryWet)) / 255);
+         // phasing routine
+         for (int j = 0; j < stages; j++)
+         {
+            double tmp = old[j];
+            old[j] = gain * tmp + m;
+            m = tmp - gain * old[j];
+         }
+         fbout = m;
+
+         obuf[i] = (float) (m * wet + in * dry);
+      }
    }
 
+   std::copy(old, old + stages, data.old);
+   data.fbout = fbout;
+
    return blockLen;
 }
 
@@ -21,8 +21,11 @@ effect that uses SBSMS to do its processing (TimeScale)
 #include "WaveClip.h"
 #include "WaveTrack.h"
 #include "TimeWarper.h"
+#include "concurrency/ThreadPool.h"
 
 #include <cassert>
+#include <chrono>
+#include <exception>
 
 enum {
   SBSMSOutBlockSize = 512
@@ -223,6 +226,72 @@ double EffectSBSMS::getRate(double rateStart, double rateEnd, SlideType slideTyp
    return slide.getRate(t);
 }
 
+namespace {
+//! Output frames of each track made in one step
+constexpr long StepFrames = 1 << 16;
+}
+
+//! The stretching of one track, which is independent of other tracks
+/*! SBSMS may also use threads of its own for its bands, where it is built
+ MULTITHREADED */
+struct EffectSBSMS::TrackJob {
+   TrackJob(WaveTrack &track) : track{ track } {}
+
+   bool Done() const { return !(pos < samplesOut && outputCount); }
+
+   //! Make the output of a step; may run in a worker thread
+   /*! The input callbacks read the track in the same thread */
+   void Step()
+   {
+      audio outBuf[SBSMSOutBlockSize];
+      left.clear();
+      right.clear();
+      long made = 0;
+      while (made < StepFrames && !Done()) {
+         const auto frames =
+            limitSampleBufferSize(SBSMSOutBlockSize, samplesOut - pos);
+
+         outputCount = pResampler->read(outBuf, frames);
+         for (int i = 0; i < outputCount; ++i) {
+            left.push_back(outBuf[i][0]);
+            if (rb.outputRightChannel)
+               right.push_back(outBuf[i][1]);
+         }
+         pos += outputCount;
+         made += outputCount;
+      }
+
+      auto pException = rb.mpException;
+      rb.mpException = {};
+      if (pException)
+         std::rethrow_exception(pException);
+   }
+
+   //! Append what Step() made
+   void Write()
+   {
+      rb.outputLeftChannel->Append(
+         (samplePtr)left.data(), floatSample, left.size());
+      if (rb.outputRightChannel)
+         rb.outputRightChannel->Append(
+            (samplePtr)right.data(), floatSample, right.size());
+   }
+
+   WaveTrack &track;
+   // Each track has its own slides, so that no state is shared among threads
+   std::unique_ptr<Slide> pRateSlide;
+   std::unique_ptr<Slide> pPitchSlide;
+   ResampleBuf rb;
+   std::unique_ptr<Resampler> pResampler;
+   WaveTrack::Holder outputTrack;
+   std::unique_ptr<TimeWarper> warper;
+   // Samples in output after resampling back
+   sampleCount samplesOut;
+   long pos = 0;
+   long outputCount = -1;
+   std::vector<float> left, right;
+};
+
 bool EffectSBSMS::Process(EffectInstance &, EffectSettings &)
 {
    bool bGoodResult = true;
@@ -230,14 +299,15 @@ bool EffectSBSMS::Process(EffectInstance &, EffectSettings &)
    //Iterate over each track
    //all needed because this effect needs to introduce silence in the group tracks to keep sync
    EffectOutputTracks outputs { *mTracks, GetType(), { { mT0, mT1 } }, true };
-   mCurTrackNum = 0;
 
    double maxDuration = 0.0;
 
    Slide rateSlide(rateSlideType,rateStart,rateEnd);
-   Slide pitchSlide(pitchSlideType,pitchStart,pitchEnd);
    mTotalStretch = rateSlide.getTotalStretch();
 
+   // Wave tracks to finish after stretching all of them together
+   TrackJobs jobs;
+
    outputs.Get().Any().VisitWhile(bGoodResult,
       [&](auto &&fallthrough){ return [&](LabelTrack &lt) {
          if (!(lt.GetSelected() || SyncLock::IsSyncLockSelected(lt)))
@@ -260,16 +330,20 @@ bool EffectSBSMS::Process(EffectInstance &, EffectSettings &)
             const auto rightTrack = (channels.size() > 1)
                ? (* ++ channels.first).get()
                : nullptr;
-            if (rightTrack)
-               mCurTrackNum++; // Increment for rightTrack, too.
 
             // SBSMS has a fixed sample rate - we just convert to its sample
             // rate and then convert back
             const float srTrack = track.GetRate();
             const float srProcess = bLinkRatePitch ? srTrack : 44100.0;
 
+            auto &job = *jobs.emplace_back(std::make_unique<TrackJob>(track));
+            job.pRateSlide =
+               std::make_unique<Slide>(rateSlideType, rateStart, rateEnd);
+            job.pPitchSlide =
+               std::make_unique<Slide>(pitchSlideType, pitchStart, pitchEnd);
+
             // the resampler needs a callback to supply its samples
-            ResampleBuf rb;
+            auto &rb = job.rb;
             const auto maxBlockSize = track.GetMaxBlockSize();
             rb.blockSize = maxBlockSize;
             rb.buf.reinit(rb.blockSize, true);
@@ -299,7 +373,8 @@ bool EffectSBSMS::Process(EffectInstance &, EffectSettings &)
                  sizeof(_sbsms_::SampleCountType),
 "Type _sbsms_::SampleCountType is too narrow to hold a sampleCount");
               rb.iface = std::make_unique<SBSMSInterfaceSliding>(
-                  &rateSlide, &pitchSlide, bPitchReferenceInput,
+                  job.pRateSlide.get(), job.pPitchSlide.get(),
+                  bPitchReferenceInput,
                   static_cast<_sbsms_::SampleCountType>(
                      samplesToProcess.as_long_long()),
                   0, nullptr);
@@ -320,25 +395,22 @@ bool EffectSBSMS::Process(EffectInstance &, EffectSettings &)
                rb.offset = start;
                rb.end = end;
                rb.iface = std::make_unique<SBSMSEffectInterface>(
-                  rb.resampler.get(), &rateSlide, &pitchSlide,
-                  bPitchReferenceInput,
+                  rb.resampler.get(), job.pRateSlide.get(),
+                  job.pPitchSlide.get(), bPitchReferenceInput,
                   static_cast<_sbsms_::SampleCountType>(
                      samplesToProcess.as_long_long()),
                   0,
                   rb.quality.get());
             }
 
-            Resampler resampler(outResampleCB, &rb, outSlideType);
-
-            audio outBuf[SBSMSOutBlockSize];
-            float outBufLeft[2 * SBSMSOutBlockSize];
-            float outBufRight[2 * SBSMSOutBlockSize];
+            job.pResampler =
+               std::make_unique<Resampler>(outResampleCB, &rb, outSlideType);
 
             // Samples in output after SBSMS
             const sampleCount samplesToOutput = rb.iface->getSamplesToOutput();
 
             // Samples in output after resampling back
-            const auto samplesOut = static_cast<sampleCount>(
+            job.samplesOut = static_cast<sampleCount>(
                samplesToOutput.as_float() * (srTrack / srProcess));
 
             // Duration in track time
@@ -347,70 +419,16 @@ bool EffectSBSMS::Process(EffectInstance &, EffectSettings &)
             if (duration > maxDuration)
                maxDuration = duration;
 
-            const auto warper = createTimeWarper(
+            job.warper = createTimeWarper(
                mT0, mT1, maxDuration, rateStart, rateEnd, rateSlideType);
 
-            WaveTrack::Holder outputTrack = track.EmptyCopy();
-            auto iter = outputTrack->Channels().begin();
-            rb.outputTrack = outputTrack.get();
+            job.outputTrack = track.EmptyCopy();
+            auto iter = job.outputTrack->Channels().begin();
+            rb.outputTrack = job.outputTrack.get();
             rb.outputLeftChannel = (*iter++).get();
             if (rightTrack)
                rb.outputRightChannel = (*iter).get();
-
-            long pos = 0;
-            long outputCount = -1;
-
-            // process
-            while (pos < samplesOut && outputCount) {
-               const auto frames =
-                  limitSampleBufferSize(SBSMSOutBlockSize, samplesOut - pos);
-
-               outputCount = resampler.read(outBuf, frames);
-               for (int i = 0; i < outputCount; ++i) {
-                  outBufLeft[i] = outBuf[i][0];
-                  if (rightTrack)
-                     outBufRight[i] = outBuf[i][1];
-               }
-               pos += outputCount;
-               rb.outputLeftChannel->Append(
-                  (samplePtr)outBufLeft, floatSample, outputCount);
-               if (rightTrack)
-                  rb.outputRightChannel->Append(
-                     (samplePtr)outBufRight, floatSample, outputCount);
-
-               double frac = static_cast<double>(pos) / samplesOut.as_double();
-               int nWhichTrack = mCurTrackNum;
-               if (rightTrack) {
-                  nWhichTrack = 2 * (mCurTrackNum / 2);
-                  if (frac < 0.5)
-                     // Show twice as far for each track,
-                     // because we're doing 2 at once.
-                     frac *= 2.0;
-                  else {
-                     nWhichTrack++;
-                     frac -= 0.5;
-                     // Show twice as far for each track,
-                     // because we're doing 2 at once.
-                     frac *= 2.0;
-                  }
-               }
-               if (TrackProgress(nWhichTrack, frac)) {
-                  bGoodResult = false;
-                  return;
-               }
-            }
-
-            {
-               auto pException = rb.mpException;
-               rb.mpException = {};
-               if (pException)
-                  std::rethrow_exception(pException);
-            }
-
-            rb.outputTrack->Flush();
-            Finalize(track, *outputTrack, *warper);
          }
-         mCurTrackNum++;
       }; },
       [&](Track &t) {
          if (SyncLock::IsSyncLockSelected(t))
@@ -419,11 +437,69 @@ bool EffectSBSMS::Process(EffectInstance &, EffectSettings &)
    );
 
    if (bGoodResult)
+      bGoodResult = ProcessTracks(jobs);
+
+   if (bGoodResult) {
+      for (const auto &pJob : jobs) {
+         pJob->outputTrack->Flush();
+         Finalize(pJob->track, *pJob->outputTrack, *pJob->warper);
+      }
       outputs.Commit();
+   }
 
    return bGoodResult;
 }
 
+// ProcessTracks() appends to the tracks in this thread, and lets SBSMS make
+// steps of output of each track in the thread pool, reading the input there.
+bool EffectSBSMS::ProcessTracks(const TrackJobs &jobs)
+{
+   using namespace std::chrono;
+   auto &pool = audacity::concurrency::ThreadPool::GetDefault();
+   // Bound the number of tracks at once, and so the memory and threads
+   const auto nJobs = std::max<size_t>(1, pool.GetThreadsCount());
+
+   double total = 0, done = 0;
+   // Seconds of output made, for the real-time factor
+   double seconds = 0;
+   for (const auto &pJob : jobs)
+      total += pJob->samplesOut.as_double();
+   const auto startTime = steady_clock::now();
+
+   for (size_t first = 0; first < jobs.size(); first += nJobs) {
+      const auto last = std::min(jobs.size(), first + nJobs);
+      while (true) {
+         std::vector<TrackJob*> active;
+         for (auto ii = first; ii < last; ++ii)
+            if (!jobs[ii]->Done())
+               active.push_back(jobs[ii].get());
+         if (active.empty())
+            break;
+
+         pool.ParallelFor(active.size(),
+            [&](size_t ii){ active[ii]->Step(); });
+
+         for (const auto pJob : active) {
+            pJob->Write();
+            done += pJob->left.size();
+            seconds += pJob->left.size() / pJob->track.GetRate();
+         }
+
+         const auto elapsed =
+            duration<double>(steady_clock::now() - startTime).count();
+         auto message = TranslatableString{};
+         if (elapsed > 0)
+            /* i18n-hint: how many seconds of audio are made in one second */
+            message = XO("Stretching at %.1f times real time")
+               .Format(seconds / elapsed);
+         if (TotalProgress(total > 0 ? done / total : 1.0, message))
+            return false;
+      }
+   }
+
+   return true;
+}
+
 void EffectSBSMS::Finalize(
    WaveTrack &orig, const WaveTrack &out, const TimeWarper &warper)
 {
@@ -54,11 +54,15 @@ private:
    void Finalize(
       WaveTrack &orig, const WaveTrack &out, const TimeWarper &warper);
 
+   struct TrackJob;
+   using TrackJobs = std::vector<std::unique_ptr<TrackJob>>;
+   //! Stretch the tracks concurrently, a step of each at a time
+   bool ProcessTracks(const TrackJobs &jobs);
+
    double rateStart, rateEnd, pitchStart, pitchEnd;
    bool bLinkRatePitch, bRateReferenceInput, bPitchReferenceInput;
    SlideType rateSlideType;
    SlideType pitchSlideType;
-   int mCurTrackNum;
    float mTotalStretch;
 
    friend class EffectChangeTempo;
@@ -100,6 +100,8 @@ private:
    int mOrder;
    int mOrderIndex;
    ArrayOf<Biquad> mpBiquad;
+   //! Copy of mpBiquad that processes, made by ProcessInitialize()
+   BiquadCascade mCascade;
 
    double mdBMax;
    double mdBMin;
@@ -26,6 +26,7 @@ effect that uses SoundTouch to do its processing (ChangeTempo
 #include "WaveTrack.h"
 #include "NoteTrack.h"
 #include "TimeWarper.h"
+#include "concurrency/ThreadPool.h"
 
 // Soundtouch defines these as well, which are also in generated configmac.h
 // and configunix.h, so get rid of them before including,
@@ -70,6 +71,107 @@ bool EffectSoundTouch::ProcessNoteTrack(NoteTrack *nt, const TimeWarper &warper)
 }
 #endif
 
+namespace {
+//! Frames of each track read for one step
+constexpr size_t StepFrames = 1 << 18;
+//! Frames given to SoundTouch at once
+constexpr size_t PutFrames = 8192;
+}
+
+//! The stretching of one track, which is independent of other tracks
+struct EffectSoundTouch::TrackJob {
+   TrackJob(WaveTrack &orig,
+      std::unique_ptr<soundtouch::SoundTouch> pSoundTouch,
+      sampleCount start, sampleCount end)
+      : orig{ orig }, pOut{ orig.EmptyCopy() }
+      , pSoundTouch{ move(pSoundTouch) }
+      , nChannels{ std::min<size_t>(2, orig.NChannels()) }
+      , pos{ start }, end{ end }
+   {
+      // TODO: more-than-two-channels
+      //Inform soundtouch of the number of channels
+      this->pSoundTouch->setChannels(nChannels);
+      this->pSoundTouch->setSampleRate(
+         static_cast<unsigned int>(orig.GetRate() + 0.5));
+   }
+
+   //! Get the samples of the next step from the track
+   void Read()
+   {
+      nFrames = limitSampleBufferSize(StepFrames, end - pos);
+      inputs.resize(nChannels);
+      auto channels = orig.Channels();
+      auto iter = channels.begin();
+      for (auto &input : inputs) {
+         input.resize(nFrames);
+         (*iter++)->GetFloats(input.data(), pos, nFrames);
+      }
+   }
+
+   //! Stretch the samples that Read() got; may run in a worker thread
+   void Step()
+   {
+      const bool last = (pos + nFrames >= end);
+      // Soundtouch wants the channels interleaved
+      Floats interleaved{ PutFrames * nChannels };
+      result.clear();
+      for (size_t frame = 0; frame < nFrames; frame += PutFrames) {
+         const auto block = std::min(PutFrames, nFrames - frame);
+         for (size_t index = 0; index < block; ++index)
+            for (size_t channel = 0; channel < nChannels; ++channel)
+               interleaved[index * nChannels + channel] =
+                  inputs[channel][frame + index];
+         pSoundTouch->putSamples(interleaved.get(), block);
+         Receive();
+      }
+      if (last) {
+         // Tell SoundTouch to finish processing any remaining samples
+         pSoundTouch->flush();
+         Receive();
+      }
+   }
+
+   //! Append what Step() made, and advance
+   void Write()
+   {
+      const auto nOut = result.size() / nChannels;
+      if (nOut > 0) {
+         // Dis-interleave the result into separate track buffers.
+         Floats buffer{ nOut };
+         auto channels = pOut->Channels();
+         auto iter = channels.begin();
+         for (size_t channel = 0; channel < nChannels; ++channel) {
+            for (size_t index = 0; index < nOut; ++index)
+               buffer[index] = result[index * nChannels + channel];
+            (*iter++)->Append((samplePtr)buffer.get(), floatSample, nOut);
+         }
+      }
+      pos += nFrames;
+   }
+
+   WaveTrack &orig;
+   const std::shared_ptr<WaveTrack> pOut;
+   const std::unique_ptr<soundtouch::SoundTouch> pSoundTouch;
+   const size_t nChannels;
+   sampleCount pos;
+   const sampleCount end;
+   size_t nFrames{};
+   std::vector<std::vector<float>> inputs;
+   std::vector<float> result;
+
+private:
+   //! Get back samples from SoundTouch
+   void Receive()
+   {
+      const auto outputCount = pSoundTouch->numSamples();
+      if (outputCount > 0) {
+         const auto size = result.size();
+         result.resize(size + outputCount * nChannels);
+         pSoundTouch->receiveSamples(result.data() + size, outputCount);
+      }
+   }
+};
+
 bool EffectSoundTouch::ProcessWithTimeWarper(InitFunction initer,
                                              const TimeWarper &warper,
                                              bool preserveLength)
@@ -91,9 +193,11 @@ bool EffectSoundTouch::ProcessWithTimeWarper(InitFunction initer,
    bool bGoodResult = true;
 
    mPreserveLength = preserveLength;
-   mCurTrackNum = 0;
    m_maxNewLength = 0.0;
 
+   // Wave tracks to finish after stretching all of them together
+   TrackJobs jobs;
+
    outputs.Get().Any().VisitWhile(bGoodResult,
       [&](auto &&fallthrough){ return [&](LabelTrack &lt) {
          if ( !(lt.GetSelected() ||
@@ -121,36 +225,11 @@ bool EffectSoundTouch::ProcessWithTimeWarper(InitFunction initer,
             const auto start = orig.TimeToLongSamples(mT0);
             const auto end = orig.TimeToLongSamples(mT1);
 
-            const auto tempTrack = orig.EmptyCopy();
-            auto &out = *tempTrack;
-
-            const auto pSoundTouch = std::make_unique<soundtouch::SoundTouch>();
+            auto pSoundTouch = std::make_unique<soundtouch::SoundTouch>();
             initer(pSoundTouch.get());
-
-            // TODO: more-than-two-channels
-            auto channels = orig.Channels();
-            if (channels.size() > 1) {
-
-               //Inform soundtouch there's 2 channels
-               pSoundTouch->setChannels(2);
-
-               //ProcessStereo() (implemented below) processes a stereo track
-               if (!ProcessStereo(pSoundTouch.get(),
-                  orig, out, start, end, warper))
-                  bGoodResult = false;
-               mCurTrackNum++; // Increment for rightTrack, too.
-            } else {
-               //Inform soundtouch there's a single channel
-               pSoundTouch->setChannels(1);
-
-               //ProcessOne() (implemented below) processes a single track
-               if (!ProcessOne(pSoundTouch.get(), **channels.begin(),
-                     out, start, end, warper))
-                  bGoodResult = false;
-            }
-            // pSoundTouch is destroyed here
+            jobs.push_back(std::make_unique<TrackJob>(
+               orig, move(pSoundTouch), start, end));
          }
-         mCurTrackNum++;
       }; },
       [&](Track &t) {
          if (mustSync && SyncLock::IsSyncLockSelected(t))
@@ -159,212 +238,70 @@ bool EffectSoundTouch::ProcessWithTimeWarper(InitFunction initer,
    );
 
    if (bGoodResult)
-      outputs.Commit();
-
-   return bGoodResult;
-}
-
-//ProcessOne() takes a track, transforms it to bunch of buffer-blocks,
-//and executes ProcessSoundTouch on these blocks
-bool EffectSoundTouch::ProcessOne(soundtouch::SoundTouch *pSoundTouch,
-   WaveChannel &orig, WaveTrack &out,
-   sampleCount start, sampleCount end,
-   const TimeWarper &warper)
-{
-   // ProcessStereo handles the stereo case instead.  This is a precondition
-   // for Append:
-   assert(out.NChannels() == 1);
+      bGoodResult = ProcessTracks(jobs);
 
-   pSoundTouch->setSampleRate(
-      static_cast<unsigned int>((orig.GetRate() + 0.5)));
+   if (bGoodResult) {
+      for (const auto &pJob : jobs) {
+         auto &out = *pJob->pOut;
+         out.Flush();
 
-   //Get the length of the buffer (as double). len is
-   //used simple to calculate a progress meter, so it is easier
-   //to make it a double now than it is to do it later
-   auto len = (end - start).as_double();
+         // Transfer output samples to the original
+         Finalize(pJob->orig, out, warper);
 
-   {
-      //Initiate a processing buffer.  This buffer will (most likely)
-      //be shorter than the length of the track being processed.
-      Floats buffer{ orig.GetMaxBlockSize() };
-
-      //Go through the track one buffer at a time. s counts which
-      //sample the current buffer starts at.
-      auto s = start;
-      while (s < end) {
-         //Get a block of samples (smaller than the size of the buffer)
-         const auto block = std::min<size_t>(8192,
-            limitSampleBufferSize(orig.GetBestBlockSize(s), end - s));
-
-         //Get the samples from the track and put them in the buffer
-         orig.GetFloats(buffer.get(), s, block);
-
-         //Add samples to SoundTouch
-         pSoundTouch->putSamples(buffer.get(), block);
-
-         //Get back samples from SoundTouch
-         unsigned int outputCount = pSoundTouch->numSamples();
-         if (outputCount > 0) {
-            Floats buffer2{ outputCount };
-            pSoundTouch->receiveSamples(buffer2.get(), outputCount);
-            out.Append(0, (samplePtr)buffer2.get(), floatSample, outputCount);
-         }
-
-         //Increment s one blockfull of samples
-         s += block;
-
-         //Update the Progress meter
-         if (TrackProgress(mCurTrackNum, (s - start).as_double() / len))
-            return false;
+         // Track the longest result length
+         m_maxNewLength = std::max(m_maxNewLength, out.GetEndTime());
       }
-
-      // Tell SoundTouch to finish processing any remaining samples
-      pSoundTouch->flush();   // this should only be used for changeTempo - it dumps data otherwise with pRateTransposer->clear();
-
-      unsigned int outputCount = pSoundTouch->numSamples();
-      if (outputCount > 0) {
-         Floats buffer2{ outputCount };
-         pSoundTouch->receiveSamples(buffer2.get(), outputCount);
-         out.Append(0, (samplePtr)buffer2.get(), floatSample, outputCount);
-      }
-
-      out.Flush();
+      outputs.Commit();
    }
 
-   // Transfer output samples to the original
-   Finalize(orig.GetTrack(), out, warper);
-
-   double newLength = out.GetEndTime();
-   m_maxNewLength = std::max(m_maxNewLength, newLength);
-
-   //Return true because the effect processing succeeded.
-   return true;
+   return bGoodResult;
 }
 
-bool EffectSoundTouch::ProcessStereo(soundtouch::SoundTouch *pSoundTouch,
-   WaveTrack &orig, WaveTrack &outputTrack,
-   sampleCount start, sampleCount end, const TimeWarper &warper)
+// ProcessTracks() reads and writes the tracks in this thread, and lets
+// SoundTouch stretch steps of them in the thread pool.  Channels of one track
+// stay interleaved in one SoundTouch, which keeps them coherent.  The results
+// do not depend on the number of threads.
+bool EffectSoundTouch::ProcessTracks(const TrackJobs &jobs)
 {
-   pSoundTouch->setSampleRate(
-      static_cast<unsigned int>(orig.GetRate() + 0.5));
-
-   auto channels = orig.Channels();
-   auto &leftTrack = **channels.first++;
-   auto &rightTrack = **channels.first;
-
-   auto newChannels = outputTrack.Channels();
-   auto &outputLeftTrack = **newChannels.first++;
-   auto &outputRightTrack = **newChannels.first;
-
-   //Get the length of the buffer (as double). len is
-   //used simple to calculate a progress meter, so it is easier
-   //to make it a double now than it is to do it later
-   double len = (end - start).as_double();
-
-   //Initiate a processing buffer.  This buffer will (most likely)
-   //be shorter than the length of the track being processed.
-   // Make soundTouchBuffer twice as big as MaxBlockSize for each channel,
-   // because Soundtouch wants them interleaved, i.e., each
-   // Soundtouch sample is left-right pair.
-   auto maxBlockSize = orig.GetMaxBlockSize();
-   {
-      Floats leftBuffer{ maxBlockSize };
-      Floats rightBuffer{ maxBlockSize };
-      Floats soundTouchBuffer{ maxBlockSize * 2 };
-
-      // Go through the track one stereo buffer at a time.
-      // sourceSampleCount counts the sample at which the current buffer starts,
-      // per channel.
-      auto sourceSampleCount = start;
-      while (sourceSampleCount < end) {
-         auto blockSize = limitSampleBufferSize(
-            orig.GetBestBlockSize(sourceSampleCount),
-            end - sourceSampleCount
-         );
-
-         // Get the samples from the tracks and put them in the buffers.
-         leftTrack.GetFloats((leftBuffer.get()), sourceSampleCount, blockSize);
-         rightTrack
-            .GetFloats((rightBuffer.get()), sourceSampleCount, blockSize);
-
-         // Interleave into soundTouchBuffer.
-         for (decltype(blockSize) index = 0; index < blockSize; index++) {
-            soundTouchBuffer[index * 2] = leftBuffer[index];
-            soundTouchBuffer[(index * 2) + 1] = rightBuffer[index];
+   auto &pool = audacity::concurrency::ThreadPool::GetDefault();
+   // Bound the number of tracks at once, and so the memory
+   const auto nJobs = std::max<size_t>(1, pool.GetThreadsCount());
+
+   //Get the length of the selections (as double). total is
+   //used simply to calculate a progress meter
+   double total = 0, done = 0;
+   for (const auto &pJob : jobs)
+      total += (pJob->end - pJob->pos).as_double();
+
+   for (size_t first = 0; first < jobs.size(); first += nJobs) {
+      const auto last = std::min(jobs.size(), first + nJobs);
+      while (true) {
+         //Get the samples of a step from each track not yet finished
+         std::vector<TrackJob*> active;
+         for (auto ii = first; ii < last; ++ii) {
+            auto &job = *jobs[ii];
+            if (job.pos >= job.end)
+               continue;
+            job.Read();
+            active.push_back(&job);
          }
+         if (active.empty())
+            break;
 
-         //Add samples to SoundTouch
-         pSoundTouch->putSamples(soundTouchBuffer.get(), blockSize);
+         pool.ParallelFor(active.size(),
+            [&](size_t ii){ active[ii]->Step(); });
 
-         //Get back samples from SoundTouch
-         unsigned int outputCount = pSoundTouch->numSamples();
-         if (outputCount > 0)
-            this->ProcessStereoResults(pSoundTouch,
-               outputCount, outputLeftTrack, outputRightTrack);
-
-         //Increment sourceSampleCount one blockfull of samples
-         sourceSampleCount += blockSize;
+         for (const auto pJob : active) {
+            done += pJob->nFrames;
+            pJob->Write();
+         }
 
          //Update the Progress meter
-         // mCurTrackNum is left track. Include right track.
-         int nWhichTrack = mCurTrackNum;
-         double frac = (sourceSampleCount - start).as_double() / len;
-         if (frac < 0.5)
-            frac *= 2.0; // Show twice as far for each track, because we're doing 2 at once.
-         else
-         {
-            nWhichTrack++;
-            frac -= 0.5;
-            frac *= 2.0; // Show twice as far for each track, because we're doing 2 at once.
-         }
-         if (TrackProgress(nWhichTrack, frac))
+         if (TotalProgress(done / total))
             return false;
       }
-
-      // Tell SoundTouch to finish processing any remaining samples
-      pSoundTouch->flush();
-
-      unsigned int outputCount = pSoundTouch->numSamples();
-      if (outputCount > 0)
-         this->ProcessStereoResults(pSoundTouch,
-            outputCount, outputLeftTrack, outputRightTrack);
-
-      outputTrack.Flush();
-   }
-
-   // Transfer output samples to the original
-   Finalize(orig, outputTrack, warper);
-
-
-   // Track the longest result length
-   double newLength = outputTrack.GetEndTime();
-   m_maxNewLength = std::max(m_maxNewLength, newLength);
-
-   //Return true because the effect processing succeeded.
-   return true;
-}
-
-bool EffectSoundTouch::ProcessStereoResults(soundtouch::SoundTouch *pSoundTouch,
-   const size_t outputCount,
-   WaveChannel &outputLeftTrack,
-   WaveChannel &outputRightTrack)
-{
-   Floats outputSoundTouchBuffer{ outputCount * 2 };
-   pSoundTouch->receiveSamples(outputSoundTouchBuffer.get(), outputCount);
-
-   // Dis-interleave outputSoundTouchBuffer into separate track buffers.
-   Floats outputLeftBuffer{ outputCount };
-   Floats outputRightBuffer{ outputCount };
-   for (unsigned int index = 0; index < outputCount; ++index) {
-      outputLeftBuffer[index] = outputSoundTouchBuffer[index * 2];
-      outputRightBuffer[index] = outputSoundTouchBuffer[(index * 2) + 1];
    }
 
-   outputLeftTrack.Append(
-      (samplePtr)outputLeftBuffer.get(), floatSample, outputCount);
-   outputRightTrack.Append(
-      (samplePtr)outputRightBuffer.get(), floatSample, outputCount);
-
    return true;
 }
 
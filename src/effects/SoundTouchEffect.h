@@ -57,17 +57,10 @@ private:
 #ifdef USE_MIDI
    bool ProcessNoteTrack(NoteTrack *track, const TimeWarper &warper);
 #endif
-   bool ProcessOne(soundtouch::SoundTouch *pSoundTouch,
-      WaveChannel &orig, WaveTrack &out, sampleCount start, sampleCount end,
-      const TimeWarper &warper);
-   bool ProcessStereo(soundtouch::SoundTouch *pSoundTouch,
-      WaveTrack &orig, WaveTrack &out,
-      sampleCount start, sampleCount end,
-      const TimeWarper &warper);
-   bool ProcessStereoResults(soundtouch::SoundTouch *pSoundTouch,
-      const size_t outputCount,
-      WaveChannel &outputLeftTrack,
-      WaveChannel &outputRightTrack);
+   struct TrackJob;
+   using TrackJobs = std::vector<std::unique_ptr<TrackJob>>;
+   //! Stretch the tracks concurrently, a step of each at a time
+   bool ProcessTracks(const TrackJobs &jobs);
    /*!
     @pre `out.NChannels() == orig.NChannels()`
     */
@@ -75,8 +68,6 @@ private:
 
    bool   mPreserveLength;
 
-   int    mCurTrackNum;
-
    double m_maxNewLength;
 };
 
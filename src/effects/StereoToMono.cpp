@@ -20,6 +20,7 @@
 
 #include "Mix.h"
 #include "MixAndRender.h"
+#include "MixDown.h"
 #include "Project.h"
 #include "RealtimeEffectList.h"
 #include "WaveTrack.h"
@@ -127,43 +128,91 @@ bool EffectStereoToMono::ProcessOne(TrackList &outputs,
 
    const auto start = track.GetStartTime();
    const auto end = track.GetEndTime();
-
-   Mixer::Inputs tracks;
-   tracks.emplace_back(
-      track.SharedPointer<const SampleTrack>(), GetEffectStages(track));
-
-   Mixer mixer(move(tracks),
-      true,                // Throw to abort mix-and-render if read fails:
-      Mixer::WarpOptions{ inputTracks()->GetOwner() },
-      start,
-      end,
-      1,
-      idealBlockLen,
-      false,               // Not interleaved
-      track.GetRate(),
-      floatSample);
+   const auto startSample = track.TimeToLongSamples(start);
+   const auto endSample = track.TimeToLongSamples(end);
+
+   auto stages = GetEffectStages(track);
+   const auto leftGain = track.GetChannelGain(0);
+   const auto rightGain = track.GetChannelGain(1);
+   if (stages.empty() && leftGain == rightGain &&
+      track.HasIdenticalChannels()) {
+      // The mix of equal channels is either one of them:  keep the sample
+      // blocks of the left, and read nothing
+      track.MakeMono();
+      RealtimeEffectList::Get(track).Clear();
+      curTime += endSample - startSample;
+      return !TotalProgress(curTime.as_double() / totalTime.as_double());
+   }
 
    // Always make mono output; don't use EmptyCopy
    auto outTrack = track.EmptyCopy(1);
    auto tempList = TrackList::Temporary(nullptr, outTrack);
    outTrack->ConvertToSampleFormat(floatSample);
 
-   double denominator = track.GetChannelGain(0) + track.GetChannelGain(1);
-   while (auto blockLen = mixer.Process()) {
-      auto buffer = mixer.GetBuffer();
-      for (auto i = 0; i < blockLen; i++)
-         ((float *)buffer)[i] /= denominator;
-
-      // If mixing channels that both had only 16 bit effective format
-      // (for example), and no gains or envelopes, still there should be
-      // dithering because of the averaging above, which may introduce samples
-      // lying between the quantization levels.  So use widestSampleFormat.
-      outTrack->Append(0,
-         buffer, floatSample, blockLen, 1, widestSampleFormat);
-
-      curTime += blockLen;
-      if (TotalProgress(curTime.as_double() / totalTime.as_double()))
-         return false;
+   double denominator = leftGain + rightGain;
+
+   // If mixing channels that both had only 16 bit effective format
+   // (for example), and no gains or envelopes, still there should be
+   // dithering because of the averaging below, which may introduce samples
+   // lying between the quantization levels.  So use widestSampleFormat.
+   if (stages.empty()) {
+      // Without effect stages, a Mixer would only apply the gains and the
+      // envelope, so do that directly, reading both channels at once
+      Floats left{ idealBlockLen }, right{ idealBlockLen };
+      float *const buffers[]{ left.get(), right.get() };
+      const bool trivialEnvelope = track.HasTrivialEnvelope();
+      Doubles envelope{ trivialEnvelope ? 0 : idealBlockLen };
+      const float leftWeight = leftGain / denominator;
+      const float rightWeight = rightGain / denominator;
+      for (auto pos = startSample; pos < endSample;) {
+         const auto blockLen =
+            limitSampleBufferSize(idealBlockLen, endSample - pos);
+         track.GetFloats(0, 2, buffers, pos, blockLen);
+         MixDown::WeightedSum(left.get(), right.get(),
+            leftWeight, rightWeight, left.get(), blockLen);
+         if (!trivialEnvelope) {
+            track.GetEnvelopeValues(envelope.get(), blockLen,
+               track.LongSamplesToTime(pos), false);
+            for (size_t i = 0; i < blockLen; ++i)
+               left[i] *= envelope[i];
+         }
+         outTrack->Append(0, (samplePtr)left.get(), floatSample, blockLen, 1,
+            widestSampleFormat);
+
+         pos += blockLen;
+         curTime += blockLen;
+         if (TotalProgress(curTime.as_double() / totalTime.as_double()))
+            return false;
+      }
+   }
+   else {
+      Mixer::Inputs tracks;
+      tracks.emplace_back(
+         track.SharedPointer<const SampleTrack>(), move(stages));
+
+      Mixer mixer(move(tracks),
+         true,                // Throw to abort mix-and-render if read fails:
+         Mixer::WarpOptions{ inputTracks()->GetOwner() },
+         start,
+         end,
+         1,
+         idealBlockLen,
+         false,               // Not interleaved
+         track.GetRate(),
+         floatSample);
+
+      while (auto blockLen = mixer.Process()) {
+         auto buffer = mixer.GetBuffer();
+         for (auto i = 0; i < blockLen; i++)
+            ((float *)buffer)[i] /= denominator;
+
+         outTrack->Append(0,
+            buffer, floatSample, blockLen, 1, widestSampleFormat);
+
+         curTime += blockLen;
+         if (TotalProgress(curTime.as_double() / totalTime.as_double()))
+            return false;
+      }
    }
    outTrack->Flush();
 
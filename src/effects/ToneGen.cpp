@@ -20,6 +20,7 @@ frequency changes smoothly during the tone.
 #include "ToneGen.h"
 #include "EffectEditor.h"
 #include "LoadEffects.h"
+#include "Oscillators.h"
 
 #include <math.h>
 
@@ -145,24 +146,56 @@ bool EffectToneGen::ProcessInitialize(
    EffectSettings &, double sampleRate, ChannelNames chanMap)
 {
    mSampleRate = sampleRate;
-   mPositionInCycles = 0.0;
+   mPhase = 0.0;
    mSample = 0;
    return true;
 }
 
+namespace {
+//! Band limited square wave, by a Hann windowed sum of the odd harmonics
+//! below the Nyquist frequency, up to the 199th; each harmonic and its
+//! weight follow from the two before them, without trigonometric functions of
+//! their own
+float SquareNoAlias(double phase, double frequency, double rate)
+{
+   const double pre4divPI = 4.0 / M_PI;
+   const auto theta = 2.0 * M_PI * phase;
+   const auto omega = 2.0 * M_PI * frequency / rate;
+   //do fundamental (k=1) outside loop
+   const auto sin1 = sin(theta);
+   const auto cos1 = cos(omega);
+   const double b = (1.0 + cos1) / pre4divPI;  //scaling
+   double f = pre4divPI * sin1;
+   // sin(k theta) and cos(k omega) for the latest odd k and the one before
+   double sinK = sin1, sinPrev = -sin1;
+   double cosK = cos1, cosPrev = cos1;
+   const double twoCos2Theta = 2.0 * (1.0 - 2.0 * sin1 * sin1);
+   const double twoCos2Omega = 2.0 * (2.0 * cos1 * cos1 - 1.0);
+   for (int k = 3; (k < 200) && (k * frequency < rate / 2.0); k += 2)
+   {
+      const auto sinNext = twoCos2Theta * sinK - sinPrev;
+      sinPrev = sinK;
+      sinK = sinNext;
+      const auto cosNext = twoCos2Omega * cosK - cosPrev;
+      cosPrev = cosK;
+      cosK = cosNext;
+      //Hann Window in freq domain
+      const auto a = 1.0 + cosK;
+      //calc harmonic, apply window, scale to amplitude of fundamental
+      f += a * sinK / (b * k);
+   }
+   return f;
+}
+}
+
 size_t EffectToneGen::ProcessBlock(EffectSettings &,
    const float *const *, float *const *outBlock, size_t blockLen)
 {
    float *buffer = outBlock[0];
-   double throwaway = 0;        //passed to modf but never used
-   double f = 0.0;
-   double a, b;
-   int k;
 
    double frequencyQuantum;
    double BlendedFrequency;
    double BlendedAmplitude;
-   double BlendedLogFrequency = 0.0;
 
    // calculate delta, and reposition from where we left
    auto doubleSampleCount = mSampleCnt.as_double();
@@ -172,10 +205,6 @@ size_t EffectToneGen::ProcessBlock(EffectSettings &,
    BlendedAmplitude = mAmplitude0 +
       amplitudeQuantum * doubleSample;
 
-   // precalculations:
-   double pre2PI = 2.0 * M_PI;
-   double pre4divPI = 4.0 / M_PI;
-
    // initial setup should calculate deltas
    if (mInterpolation == kLogarithmic)
    {
@@ -184,8 +213,10 @@ size_t EffectToneGen::ProcessBlock(EffectSettings &,
       mLogFrequency[1] = log10(mFrequency1);
       // calculate delta, and reposition from where we left
       frequencyQuantum = (mLogFrequency[1] - mLogFrequency[0]) / doubleSampleCount;
-      BlendedLogFrequency = mLogFrequency[0] + frequencyQuantum * doubleSample;
-      BlendedFrequency = pow(10.0, BlendedLogFrequency);
+      BlendedFrequency =
+         pow(10.0, mLogFrequency[0] + frequencyQuantum * doubleSample);
+      // Step the frequency by a ratio, which is exact enough within a block
+      frequencyQuantum = pow(10.0, frequencyQuantum);
    }
    else
    {
@@ -194,56 +225,56 @@ size_t EffectToneGen::ProcessBlock(EffectSettings &,
       BlendedFrequency = mFrequency0 + frequencyQuantum * doubleSample;
    }
 
-   // synth loop
-   for (decltype(blockLen) i = 0; i < blockLen; i++)
-   {
+   const auto advance = [&]{
+      mPhase += BlendedFrequency / mSampleRate;
+      mPhase -= floor(mPhase + 0.5);
+      if (mInterpolation == kLogarithmic)
+         BlendedFrequency *= frequencyQuantum;
+      else
+         BlendedFrequency += frequencyQuantum;
+   };
+
+   // synth loop, in passes over the buffer:  first the phases, then the
+   // waveforms of them, with vectors where possible
+   if (mWaveform == kSquareNoAlias) {
+      // The harmonics depend on the frequency of each sample
+      for (decltype(blockLen) i = 0; i < blockLen; i++) {
+         buffer[i] = SquareNoAlias(mPhase, BlendedFrequency, mSampleRate);
+         advance();
+      }
+   }
+   else {
+      for (decltype(blockLen) i = 0; i < blockLen; i++) {
+         buffer[i] = (float) mPhase;
+         advance();
+      }
       switch (mWaveform)
       {
       case kSine:
-         f = sin(pre2PI * mPositionInCycles / mSampleRate);
+         Oscillators::Sine(buffer, buffer, blockLen);
          break;
       case kSquare:
-         f = (modf(mPositionInCycles / mSampleRate, &throwaway) < 0.5) ? 1.0 : -1.0;
+         for (decltype(blockLen) i = 0; i < blockLen; i++)
+            buffer[i] = buffer[i] >= 0 ? 1.0f : -1.0f;
          break;
       case kSawtooth:
-         f = (2.0 * modf(mPositionInCycles / mSampleRate + 0.5, &throwaway)) - 1.0;
+         for (decltype(blockLen) i = 0; i < blockLen; i++)
+            buffer[i] *= 2;
          break;
       case kTriangle:
-         f = modf(mPositionInCycles / mSampleRate, &throwaway);
-         if(f < 0.25) {
-             f *= 4.0;
-         } else if(f > 0.75) {
-             f = (f - 1.0) * 4.0;
-         } else { /* f >= 0.25 || f <= 0.75 */
-             f = (0.5 - f) * 4.0;
+         for (decltype(blockLen) i = 0; i < blockLen; i++) {
+            // 4 times the phase, folded about the quarter cycles
+            const auto f = buffer[i];
+            buffer[i] = 4 * (fabs(f) <= 0.25f ? f : copysign(0.5f, f) - f);
          }
          break;
-      case kSquareNoAlias:    // Good down to 110Hz @ 44100Hz sampling.
-         //do fundamental (k=1) outside loop
-         b = (1.0 + cos((pre2PI * BlendedFrequency) / mSampleRate)) / pre4divPI;  //scaling
-         f = pre4divPI * sin(pre2PI * mPositionInCycles / mSampleRate);
-         for (k = 3; (k < 200) && (k * BlendedFrequency < mSampleRate / 2.0); k += 2)
-         {
-            //Hann Window in freq domain
-            a = 1.0 + cos((pre2PI * k * BlendedFrequency) / mSampleRate);
-            //calc harmonic, apply window, scale to amplitude of fundamental
-            f += a * sin(pre2PI * mPositionInCycles / mSampleRate * k) / (b * k);
-         }
       }
-      // insert value in buffer
-      buffer[i] = (float) (BlendedAmplitude * f);
-      // update freq,amplitude
-      mPositionInCycles += BlendedFrequency;
+   }
+
+   // apply the amplitude
+   for (decltype(blockLen) i = 0; i < blockLen; i++) {
+      buffer[i] = (float) (BlendedAmplitude * buffer[i]);
       BlendedAmplitude += amplitudeQuantum;
-      if (mInterpolation == kLogarithmic)
-      {
-         BlendedLogFrequency += frequencyQuantum;
-         BlendedFrequency = pow(10.0, BlendedLogFrequency);
-      }
-      else
-      {
-         BlendedFrequency += frequencyQuantum;
-      }
    }
 
    // update external placeholder
@@ -67,7 +67,8 @@ private:
    // mSample is an external placeholder to remember the last "buffer"
    // position so we use it to reinitialize from where we left
    sampleCount mSample;
-   double mPositionInCycles;
+   //! In cycles, in [-1/2, 1/2)
+   double mPhase;
 
    // If we made these static variables,
    // Tone and Chirp would share the same parameters.
@@ -21,6 +21,8 @@
 #include "LoadEffects.h"
 
 #include <algorithm>
+#include <chrono>
+#include <future>
 #include <list>
 #include <limits>
 #include <math.h>
@@ -34,6 +36,8 @@
 #include "ShuttleGui.h"
 #include "SyncLock.h"
 #include "WaveTrack.h"
+#include "WaveChannelUtilities.h"
+#include "concurrency/ThreadPool.h"
 #include "../widgets/valnum.h"
 #include "AudacityMessageBox.h"
 
@@ -103,6 +107,60 @@ static const double DEF_MinTruncMs = 0.001;
 // Typical fraction of total time taken by detection (better to guess low)
 const double detectFrac = 0.4;
 
+namespace {
+//! Samples are read in windows of this length only where the block summaries
+//! don't decide whether they are all silent
+constexpr size_t SummaryWindow = 1024;
+
+enum class WindowKind { Silent, Loud, Undecided };
+
+//! Classify windows of SummaryWindow samples of [start, start + len) of all
+//! channels, by the block summaries
+/*!
+ A window is Silent when all its samples are below the threshold, and Loud
+ when it surely has at least one sample that is not
+ @return empty if the summaries are not usable
+ */
+std::vector<WindowKind> ClassifyWindows(const WaveTrack &wt,
+   sampleCount start, size_t len, double threshold)
+{
+   const auto nWindows = (len + SummaryWindow - 1) / SummaryWindow;
+   std::vector<WindowKind> result(nWindows, WindowKind::Silent);
+   std::vector<WindowKind> kinds;
+   for (const auto pChannel : wt.Channels()) {
+      const auto spans =
+         WaveChannelUtilities::GetSummarySpans(*pChannel, start, len);
+      if (spans.empty())
+         return {};
+      kinds.assign(nWindows, WindowKind::Silent);
+      size_t pos = 0;
+      for (const auto &span : spans) {
+         if (span.length == 0)
+            continue;
+         if (span.peak >= threshold) {
+            const auto first = pos / SummaryWindow;
+            const auto last = (pos + span.length - 1) / SummaryWindow;
+            for (auto ii = first; ii <= last; ++ii) {
+               auto &kind = kinds[ii];
+               if (span.whole && first == last)
+                  kind = WindowKind::Loud;
+               else if (kind == WindowKind::Silent)
+                  kind = WindowKind::Undecided;
+            }
+         }
+         pos += span.length;
+      }
+      // A loud sample in any channel makes the frame not silent
+      for (size_t ii = 0; ii < nWindows; ++ii)
+         if (kinds[ii] == WindowKind::Loud ||
+            (kinds[ii] == WindowKind::Undecided &&
+             result[ii] == WindowKind::Silent))
+            result[ii] = kinds[ii];
+   }
+   return result;
+}
+}
+
 const ComponentInterfaceSymbol EffectTruncSilence::Symbol
 { XO("Truncate Silence") };
 
@@ -278,13 +336,18 @@ bool EffectTruncSilence::ProcessIndependently()
    };
    double newT1 = 0.0;
 
+   std::vector<WaveTrack*> tracks;
+   for (auto track : outputs.Get().Selected<WaveTrack>())
+      tracks.push_back(track);
+   // The groups are disjoint, so all analysis can precede all removal
+   std::vector<RegionList> allSilences;
+   if (!FindSilencesConcurrently(allSilences, tracks))
+      return false;
+
    {
       unsigned iGroup = 0;
-      for (auto track : outputs.Get().Selected<WaveTrack>()) {
-         RegionList silences;
-         if (!FindSilences(silences,
-            TrackList::SingletonRange(&as_const(*track))))
-            return false;
+      for (auto track : tracks) {
+         const RegionList &silences = allSilences[iGroup];
          // Treat tracks in the sync lock group only
          Track *groupFirst, *groupLast;
          auto range = syncLock
@@ -331,8 +394,60 @@ bool EffectTruncSilence::ProcessAll()
    return false;
 }
 
+bool EffectTruncSilence::FindSilencesConcurrently(
+   std::vector<RegionList> &silences, const std::vector<WaveTrack*> &tracks)
+{
+   silences.resize(tracks.size());
+   const auto find = [&](size_t ii, AnalysisProgress *pProgress) {
+      return FindSilences(silences[ii],
+         TrackList::SingletonRange(&as_const(*tracks[ii])), pProgress);
+   };
+
+   auto &pool = audacity::concurrency::ThreadPool::GetDefault();
+   if (tracks.size() < 2 || pool.IsWorkerThread() ||
+       pool.GetThreadsCount() < 2) {
+      for (size_t ii = 0; ii < tracks.size(); ++ii)
+         if (!find(ii, nullptr))
+            return false;
+      return true;
+   }
+
+   std::vector<AnalysisProgress> progress(tracks.size());
+   std::vector<std::future<bool>> futures;
+   futures.reserve(tracks.size());
+   for (size_t ii = 0; ii < tracks.size(); ++ii)
+      futures.push_back(pool.Async([&find, &progress, ii]{
+         return find(ii, &progress[ii]);
+      }));
+
+   // Show progress here while the workers analyze
+   bool cancelled = false;
+   for (auto &future : futures) {
+      while (future.wait_for(std::chrono::milliseconds(50)) !=
+         std::future_status::ready) {
+         if (cancelled)
+            continue;
+         double sum = 0;
+         for (auto &trackProgress : progress)
+            sum += trackProgress.fraction.load(std::memory_order_relaxed);
+         if (TotalProgress(detectFrac * sum / tracks.size())) {
+            cancelled = true;
+            for (auto &trackProgress : progress)
+               trackProgress.cancelled.store(true, std::memory_order_relaxed);
+         }
+      }
+   }
+
+   // All are ready, so the first exception can propagate
+   bool result = !cancelled;
+   for (auto &future : futures)
+      result = future.get() && result;
+   return result;
+}
+
 bool EffectTruncSilence::FindSilences(RegionList &silences,
-   const TrackIterRange<const WaveTrack> &range)
+   const TrackIterRange<const WaveTrack> &range,
+   AnalysisProgress *pProgress) const
 {
    // Start with the whole selection silent
    silences.push_back(Region(mT0, mT1));
@@ -354,8 +469,8 @@ bool EffectTruncSilence::FindSilences(RegionList &silences,
       sampleCount silentFrame = 0;
 
       // Detect silences
-      bool cancelled = !(Analyze(
-         silences, trackSilences, *wt, &silentFrame, &index, whichTrack));
+      bool cancelled = !(Analyze(silences, trackSilences, *wt,
+         &silentFrame, &index, whichTrack, nullptr, nullptr, pProgress));
 
       // Buffer has been freed, so we're OK to return if cancelled
       if (cancelled)
@@ -514,7 +629,7 @@ bool EffectTruncSilence::DoRemoval(const RegionList &silences,
 bool EffectTruncSilence::Analyze(RegionList& silenceList,
    RegionList& trackSilences, const WaveTrack &wt, sampleCount* silentFrame,
    sampleCount* index, int whichTrack, double* inputLength,
-   double* minInputLength) const
+   double* minInputLength, AnalysisProgress *pProgress) const
 {
    const auto rate = wt.GetRate();
 
@@ -528,10 +643,18 @@ bool EffectTruncSilence::Analyze(RegionList& silenceList,
    auto end = wt.TimeToLongSamples(mT1);
    sampleCount outLength = 0;
 
-   double previewLength;
-   gPrefs->Read(wxT("/AudioIO/EffectsPreviewLen"), &previewLength, 6.0);
    // Minimum required length in samples.
-   const sampleCount previewLen(previewLength * rate);
+   sampleCount previewLen = 0;
+   if (inputLength) {
+      double previewLength;
+      gPrefs->Read(wxT("/AudioIO/EffectsPreviewLen"), &previewLength, 6.0);
+      previewLen = sampleCount(previewLength * rate);
+   }
+
+   // Silences shorter than two windows are never recorded, so the samples
+   // between the first and last of consecutive loud windows don't matter
+   const bool useSummaries =
+      !inputLength && minSilenceFrames >= 2 * SummaryWindow;
 
    // Keep position in overall silences list for optimization
    RegionList::iterator rit(silenceList.begin());
@@ -554,7 +677,14 @@ bool EffectTruncSilence::Analyze(RegionList& silenceList,
          return true;
       }
 
-      if (!inputLength) {
+      if (pProgress) {
+         pProgress->fraction.store(
+            (*index - start).as_double() / (end - start).as_double(),
+            std::memory_order_relaxed);
+         if (pProgress->cancelled.load(std::memory_order_relaxed))
+            return false;
+      }
+      else if (!inputLength) {
          // Show progress dialog, test for cancellation
          bool cancelled = TotalProgress(
                detectFrac * (whichTrack +
@@ -614,62 +744,95 @@ bool EffectTruncSilence::Analyze(RegionList& silenceList,
       // Limit size of current block if we've reached the end
       auto count = limitSampleBufferSize( blockLen, end - *index );
 
-      // Fill buffers
-      size_t iChannel = 0;
-      for (const auto pChannel : wt.Channels())
-         pChannel->GetFloats(buffers[iChannel++].get(), *index, count);
-
-      // Look for silenceList in current block
-      for (decltype(count) i = 0; i < count; ++i) {
-         if (inputLength && ((outLength >= previewLen) ||
-            (outLength > wt.TimeToLongSamples(*minInputLength)))
-         ) {
-            *inputLength =
-               wt.LongSamplesToTime(*index + i) - wt.LongSamplesToTime(start);
-            break;
-         }
+      // Look for silences in [offset, offset + n) of the current block
+      const auto scan = [&](size_t offset, size_t n) {
+         // Fill buffers
+         size_t iChannel = 0;
+         for (const auto pChannel : wt.Channels())
+            pChannel->GetFloats(buffers[iChannel++].get() + offset,
+               *index + offset, n);
+
+         for (auto i = offset; i < offset + n; ++i) {
+            if (inputLength && ((outLength >= previewLen) ||
+               (outLength > wt.TimeToLongSamples(*minInputLength)))
+            ) {
+               *inputLength = wt.LongSamplesToTime(*index + i)
+                  - wt.LongSamplesToTime(start);
+               return;
+            }
 
-         const bool silent = std::all_of(buffers, buffers + iChannel,
-         [&](const Floats &buffer){
-            return fabs(buffer[i]) < truncDbSilenceThreshold;
-         });
-         if (silent)
-            (*silentFrame)++;
-         else {
-            sampleCount allowed = 0;
-            if (*silentFrame >= minSilenceFrames) {
-               if (inputLength) {
-                  switch (mActionIndex) {
-                     case kTruncate:
-                        outLength +=
-                           wt.TimeToLongSamples(mTruncLongestAllowedSilence);
-                        break;
-                     case kCompress:
-                        allowed =
-                           wt.TimeToLongSamples(mInitialAllowedSilence);
-                        outLength += sampleCount(
-                           allowed.as_double() +
-                              (*silentFrame - allowed).as_double()
-                                 * mSilenceCompressPercent / 100.0
-                        );
-                        break;
-                     // default: // Not currently used.
+            const bool silent = std::all_of(buffers, buffers + iChannel,
+            [&](const Floats &buffer){
+               return fabs(buffer[i]) < truncDbSilenceThreshold;
+            });
+            if (silent)
+               (*silentFrame)++;
+            else {
+               sampleCount allowed = 0;
+               if (*silentFrame >= minSilenceFrames) {
+                  if (inputLength) {
+                     switch (mActionIndex) {
+                        case kTruncate:
+                           outLength +=
+                              wt.TimeToLongSamples(mTruncLongestAllowedSilence);
+                           break;
+                        case kCompress:
+                           allowed =
+                              wt.TimeToLongSamples(mInitialAllowedSilence);
+                           outLength += sampleCount(
+                              allowed.as_double() +
+                                 (*silentFrame - allowed).as_double()
+                                    * mSilenceCompressPercent / 100.0
+                           );
+                           break;
+                        // default: // Not currently used.
+                     }
                   }
-               }
 
-               // Record the silent region
-               trackSilences.push_back(Region(
-                  wt.LongSamplesToTime(*index + i - *silentFrame),
-                  wt.LongSamplesToTime(*index + i)
-               ));
-            }
-            else if (inputLength) {   // included as part of non-silence
-               outLength += *silentFrame;
+                  // Record the silent region
+                  trackSilences.push_back(Region(
+                     wt.LongSamplesToTime(*index + i - *silentFrame),
+                     wt.LongSamplesToTime(*index + i)
+                  ));
+               }
+               else if (inputLength) {   // included as part of non-silence
+                  outLength += *silentFrame;
+               }
+               *silentFrame = 0;
+               if (inputLength) {
+                   ++outLength;   // Add non-silent sample to outLength
+               }
             }
-            *silentFrame = 0;
-            if (inputLength) {
-                ++outLength;   // Add non-silent sample to outLength
+         }
+      };
+
+      const auto windows = useSummaries
+         ? ClassifyWindows(wt, *index, count, truncDbSilenceThreshold)
+         : std::vector<WindowKind>{};
+      const auto windowLen = [&](size_t ii) {
+         return std::min(SummaryWindow, count - ii * SummaryWindow);
+      };
+      if (windows.empty())
+         scan(0, count);
+      for (size_t ii = 0; ii < windows.size();) {
+         if (windows[ii] == WindowKind::Silent)
+            *silentFrame += windowLen(ii++);
+         else if (windows[ii] == WindowKind::Loud) {
+            auto jj = ii + 1;
+            while (jj < windows.size() && windows[jj] == WindowKind::Loud)
+               ++jj;
+            scan(ii * SummaryWindow, windowLen(ii));
+            if (jj - ii > 1) {
+               // Skip to the last loud window; its first loud sample ends
+               // the silence anyway, too short to record
+               *silentFrame = 0;
+               scan((jj - 1) * SummaryWindow, windowLen(jj - 1));
             }
+            ii = jj;
+         }
+         else {
+            scan(ii * SummaryWindow, windowLen(ii));
+            ++ii;
          }
       }
       // Next block
@@ -794,7 +957,8 @@ bool EffectTruncSilence::TransferDataFromWindow(EffectSettings &)
 // EffectTruncSilence implementation
 
 // Finds the intersection of the ordered region lists, stores in dest
-void EffectTruncSilence::Intersect(RegionList &dest, const RegionList &src)
+void EffectTruncSilence::Intersect(
+   RegionList &dest, const RegionList &src) const
 {
    RegionList::iterator destIter;
    destIter = dest.begin();
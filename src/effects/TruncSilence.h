@@ -20,6 +20,8 @@
 #include "StatefulEffect.h"
 #include "ShuttleAutomation.h"
 #include "Track.h"
+#include <atomic>
+#include <vector>
 #include <wx/weakref.h>
 
 class ShuttleGui;
@@ -56,13 +58,21 @@ public:
    double CalcPreviewInputLength(
       const EffectSettings &settings, double previewLength) const override;
 
+   //! Progress of an analysis on a worker thread, shown by the main thread
+   struct AnalysisProgress {
+      std::atomic<double> fraction{ 0 };
+      std::atomic<bool> cancelled{ false };
+   };
+
    // Analyze a single track to find silences
    // If inputLength is not NULL we are calculating the minimum
    // amount of input for previewing.
+   // If pProgress is not NULL, progress goes there and not to the dialog.
    bool Analyze(RegionList &silenceList, RegionList &trackSilences,
       const WaveTrack &wt, sampleCount* silentFrame, sampleCount* index,
       int whichTrack, double* inputLength = nullptr,
-      double* minInputLength = nullptr) const;
+      double* minInputLength = nullptr,
+      AnalysisProgress *pProgress = nullptr) const;
 
    bool Process(EffectInstance &instance, EffectSettings &settings) override;
    std::unique_ptr<EffectEditor> PopulateOrExchange(
@@ -78,7 +88,7 @@ private:
 
    //ToDo ... put BlendFrames in Effects, Project, or other class
    // void BlendFrames(float* buffer, int leftIndex, int rightIndex, int blendFrameCount);
-   void Intersect(RegionList &dest, const RegionList & src);
+   void Intersect(RegionList &dest, const RegionList & src) const;
 
    void OnControlChange(wxCommandEvent & evt);
    void UpdateUI();
@@ -86,7 +96,12 @@ private:
    bool ProcessIndependently();
    bool ProcessAll();
    bool FindSilences(RegionList &silences,
-      const TrackIterRange<const WaveTrack> &range);
+      const TrackIterRange<const WaveTrack> &range,
+      AnalysisProgress *pProgress = nullptr) const;
+   //! Find the silences of each track on the thread pool
+   //! @return false if cancelled
+   bool FindSilencesConcurrently(std::vector<RegionList> &silences,
+      const std::vector<WaveTrack*> &tracks);
    bool DoRemoval(const RegionList &silences,
       const TrackIterRange<Track> &range,
       unsigned iGroup, unsigned nGroups,
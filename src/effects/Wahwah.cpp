@@ -23,6 +23,7 @@
 #include "EffectEditor.h"
 #include "LoadEffects.h"
 
+#include <algorithm>
 #include <math.h>
 
 #include <wx/slider.h>
@@ -419,8 +420,6 @@ size_t EffectWahwah::Instance::InstanceProcess(EffectSettings& settings,
    
    const float *ibuf = inBlock[0];
    float *obuf = outBlock[0];
-   double frequency, omega, sn, cs, alpha;
-   double in, out;
 
    data.lfoskip = ms.mFreq * 2 * M_PI / data.samplerate;
    data.depth = ms.mDepth / 100.0;
@@ -429,36 +428,57 @@ size_t EffectWahwah::Instance::InstanceProcess(EffectSettings& settings,
    data.phase = ms.mPhase * M_PI / 180.0;
    data.outgain = DB_TO_LINEAR(ms.mOutGain);
 
-   for (decltype(blockLen) i = 0; i < blockLen; i++)
-   {
-      in = (double) ibuf[i];
+   // State in locals for the inner loops, so that it may stay in registers
+   double xn1 = data.xn1, xn2 = data.xn2, yn1 = data.yn1, yn2 = data.yn2;
 
-      if ((data.skipcount++) % lfoskipsamples == 0)
+   // Runs of samples between recomputations of the filter
+   for (decltype(blockLen) i = 0; i < blockLen;)
+   {
+      const auto offset = data.skipcount % lfoskipsamples;
+      const auto n = std::min<size_t>(blockLen - i, lfoskipsamples - offset);
+      if (offset == 0)
       {
-         frequency = (1 + cos(data.skipcount * data.lfoskip + data.phase)) / 2;
+         double frequency =
+            (1 + cos((data.skipcount + 1) * data.lfoskip + data.phase)) / 2;
          frequency = frequency * data.depth * (1 - data.freqofs) + data.freqofs;
          frequency = exp((frequency - 1) * 6);
-         omega = M_PI * frequency;
-         sn = sin(omega);
-         cs = cos(omega);
-         alpha = sn / (2 * ms.mRes);
+         const double omega = M_PI * frequency;
+         const double sn = sin(omega);
+         const double cs = cos(omega);
+         const double alpha = sn / (2 * ms.mRes);
          data.b0 = (1 - cs) / 2;
          data.b1 = 1 - cs;
          data.b2 = (1 - cs) / 2;
          data.a0 = 1 + alpha;
          data.a1 = -2 * cs;
          data.a2 = 1 - alpha;
-      };
-      out = (data.b0 * in + data.b1 * data.xn1 + data.b2 * data.xn2 - data.a1 * data.yn1 - data.a2 * data.yn2) / data.a0;
-      data.xn2 = data.xn1;
-      data.xn1 = in;
-      data.yn2 = data.yn1;
-      data.yn1 = out;
-      out *= data.outgain;
-
-      obuf[i] = (float) out;
+      }
+      data.skipcount += n;
+
+      // Coefficients normalized once per run, with the output gain
+      const double b0 = data.b0 / data.a0, b1 = data.b1 / data.a0,
+         b2 = data.b2 / data.a0, a1 = data.a1 / data.a0,
+         a2 = data.a2 / data.a0;
+      const double outgain = data.outgain;
+
+      for (const auto end = i + n; i < end; i++)
+      {
+         const double in = ibuf[i];
+         const double out = b0 * in + b1 * xn1 + b2 * xn2 - a1 * yn1 - a2 * yn2;
+         xn2 = xn1;
+         xn1 = in;
+         yn2 = yn1;
+         yn1 = out;
+
+         obuf[i] = (float) (out * outgain);
+      }
    }
 
+   data.xn1 = xn1;
+   data.xn2 = xn2;
+   data.yn1 = yn1;
+   data.yn2 = yn2;
+
    return blockLen;
 }
 
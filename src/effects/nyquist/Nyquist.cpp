@@ -690,7 +690,10 @@ struct NyquistEffect::NyxContext {
    unsigned          mCurNumChannels{}; //!< Not used in the callbacks
 
    using Buffer = std::unique_ptr<float[]>;
+   //! How many sample blocks GetCallback reads from the track at once
+   static constexpr size_t InputBlocksPerRead = 16;
    Buffer            mCurBuffer[2]; //!< used only in GetCallback
+   size_t            mCurBufferCapacity[2]{};
    sampleCount       mCurBufferStart[2]{};
    size_t            mCurBufferLen[2]{};
    sampleCount       mCurLen{};
@@ -2562,36 +2565,35 @@ int NyquistEffect::NyxContext::StaticGetCallback(float *buffer, int channel,
 int NyquistEffect::NyxContext::GetCallback(float *buffer, int ch,
    int64_t start, int64_t len, int64_t)
 {
-   if (mCurBuffer[ch]) {
-      if ((mCurStart + start) < mCurBufferStart[ch] ||
-          (mCurStart + start) + len >
-          mCurBufferStart[ch] + mCurBufferLen[ch]) {
-         mCurBuffer[ch].reset();
-      }
-   }
-
-   if (!mCurBuffer[ch]) {
-      mCurBufferStart[ch] = (mCurStart + start);
-      mCurBufferLen[ch] = mCurTrack[ch]->GetBestBlockSize(mCurBufferStart[ch]);
-
-      if (mCurBufferLen[ch] < (size_t) len)
-         mCurBufferLen[ch] = mCurTrack[ch]->GetIdealBlockSize();
-
-      mCurBufferLen[ch] = limitSampleBufferSize(mCurBufferLen[ch],
-         mCurStart + mCurLen - mCurBufferStart[ch]);
-
-      // C++20
-      // mCurBuffer[ch] = std::make_unique_for_overwrite(mCurBufferLen[ch]);
-      mCurBuffer[ch] = Buffer{ safenew float[ mCurBufferLen[ch] ] };
+   const auto first = mCurStart + start;
+   if (!mCurBuffer[ch] || first < mCurBufferStart[ch] ||
+       first + len > mCurBufferStart[ch] + mCurBufferLen[ch]) {
+      // Nyquist asks for much less than a block at a time; read several
+      // whole blocks ahead, so that most requests are only a copy
+      auto bufferLen = mCurTrack[ch]->GetBestBlockSize(first) +
+         (InputBlocksPerRead - 1) * mCurTrack[ch]->GetIdealBlockSize();
+      bufferLen = std::max<size_t>(bufferLen, len);
+      bufferLen = limitSampleBufferSize(bufferLen, mCurStart + mCurLen - first);
+
+      // Reuse the allocation when it is big enough
+      if (bufferLen > mCurBufferCapacity[ch]) {
+         // C++20
+         // mCurBuffer[ch] = std::make_unique_for_overwrite(bufferLen);
+         mCurBuffer[ch] = Buffer{ safenew float[ bufferLen ] };
+         mCurBufferCapacity[ch] = bufferLen;
+      }
+      mCurBufferStart[ch] = first;
+      // Not valid until filled
+      mCurBufferLen[ch] = 0;
       try {
-         mCurTrack[ch]->GetFloats( mCurBuffer[ch].get(),
-            mCurBufferStart[ch], mCurBufferLen[ch]);
+         mCurTrack[ch]->GetFloats( mCurBuffer[ch].get(), first, bufferLen);
       }
       catch ( ... ) {
          // Save the exception object for re-throw when out of the library
          mpException = std::current_exception();
          return -1;
       }
+      mCurBufferLen[ch] = bufferLen;
    }
 
    // We have guaranteed above that this is nonnegative and bounded by
@@ -37,6 +37,9 @@
 
 #include "../../LabelTrack.h"
 #include "WaveTrack.h"
+#include "concurrency/ThreadPool.h"
+
+#include <algorithm>
 
 enum
 {
@@ -316,6 +319,124 @@ bool VampEffect::Init()
    return true;
 }
 
+namespace {
+//! Labels found in one channel group, added to its track after all analysis
+using Labels = std::vector<std::pair<SelectedRegion, wxString>>;
+
+void AddFeatures(Labels &labels, Vamp::Plugin::FeatureSet &features,
+   int output)
+{
+   for (Vamp::Plugin::FeatureList::iterator fli = features[output].begin();
+        fli != features[output].end(); ++fli)
+   {
+      Vamp::RealTime ftime0 = fli->timestamp;
+      double ltime0 = ftime0.sec + (double(ftime0.nsec) / 1000000000.0);
+
+      Vamp::RealTime ftime1 = ftime0;
+      if (fli->hasDuration) ftime1 = ftime0 + fli->duration;
+      double ltime1 = ftime1.sec + (double(ftime1.nsec) / 1000000000.0);
+
+      wxString label = LAT1CTOWX(fli->label.c_str());
+      if (label == wxString())
+      {
+         if (fli->values.empty())
+         {
+            label = wxString::Format(LAT1CTOWX("%.3f"), ltime0);
+         }
+         else
+         {
+            label = wxString::Format(LAT1CTOWX("%.3f"), *fli->values.begin());
+         }
+      }
+
+      labels.emplace_back(SelectedRegion(ltime0, ltime1), label);
+   }
+}
+
+//! Analysis of one channel group, by a plugin instance of its own
+struct AnalysisJob
+{
+   //! Samples read from the track at once, for several overlapping blocks
+   static constexpr size_t WindowSize = 1 << 16;
+
+   AnalysisJob(Vamp::Plugin &plugin, const WaveChannel *left,
+      const WaveChannel *right, size_t step, size_t block,
+      sampleCount start, sampleCount len)
+      : plugin{ plugin }, left{ left }, right{ right }
+      , channels{ right ? 2u : 1u }
+      , step{ step }, block{ block }
+      , stepsPerRead{ std::max<size_t>(1,
+         (std::max(WindowSize, block) - block) / step + 1) }
+      , start{ start }, end{ start + len }, pos{ start }
+      , data{ channels, (stepsPerRead - 1) * step + block }
+   {}
+
+   //! Process one window's worth of blocks, called on any thread
+   void Advance(double rate, int output)
+   {
+      const auto remaining = end - pos;
+      const auto steps = std::min<sampleCount>(stepsPerRead,
+         (remaining + (step - 1)) / step).as_size_t();
+      const auto window = (steps - 1) * step + block;
+      const auto request = limitSampleBufferSize(window, remaining);
+
+      if (left)
+         left->GetFloats(data[0].get(), pos, request);
+      if (right)
+         right->GetFloats(data[1].get(), pos, request);
+      for (unsigned c = 0; c < channels; ++c)
+         std::fill(data[c].get() + request, data[c].get() + window, 0.f);
+
+      float *buffers[2]{};
+      for (size_t k = 0; k < steps; ++k)
+      {
+         for (unsigned c = 0; c < channels; ++c)
+            buffers[c] = data[c].get() + k * step;
+
+         // UNSAFE_SAMPLE_COUNT_TRUNCATION
+         // Truncation in case of very long tracks!
+         Vamp::RealTime timestamp = Vamp::RealTime::frame2RealTime(
+            long( (pos + k * step).as_long_long() ),
+            (int)(rate + 0.5)
+         );
+
+         Vamp::Plugin::FeatureSet features =
+            plugin.process(buffers, timestamp);
+         AddFeatures(labels, features, output);
+      }
+      pos += steps * step;
+
+      if (pos >= end)
+      {
+         Vamp::Plugin::FeatureSet features = plugin.getRemainingFeatures();
+         AddFeatures(labels, features, output);
+         finished = true;
+      }
+   }
+
+   double Fraction() const
+   {
+      const auto len = (end - start).as_double();
+      return len > 0 ? std::min(1.0, (pos - start).as_double() / len) : 1.0;
+   }
+
+   Vamp::Plugin &plugin;
+   //! Null when the effect's own plugin serves
+   std::unique_ptr<Vamp::Plugin> pOwnedPlugin;
+   const WaveChannel *const left;
+   const WaveChannel *const right;
+   const unsigned channels;
+   const size_t step, block;
+   const size_t stepsPerRead;
+   const sampleCount start, end;
+   sampleCount pos;
+   FloatBuffers data;
+   LabelTrack *ltrack{};
+   Labels labels;
+   bool finished{ false };
+};
+}
+
 bool VampEffect::Process(EffectInstance &, EffectSettings &)
 {
    if (!mPlugin)
@@ -323,10 +444,7 @@ bool VampEffect::Process(EffectInstance &, EffectSettings &)
       return false;
    }
 
-   int count = 0;
-
    bool multiple = false;
-   unsigned prevTrackChannels = 0;
 
    if (GetNumWaveGroups() > 1)
    {
@@ -339,156 +457,125 @@ bool VampEffect::Process(EffectInstance &, EffectSettings &)
 
    std::vector<std::shared_ptr<AddedAnalysisTrack>> addedTracks;
 
-   for (auto pTrack : inputTracks()->Any<const WaveTrack>())
+   const auto range = inputTracks()->Any<const WaveTrack>();
+   const std::vector<const WaveTrack *> tracks{ range.begin(), range.end() };
+   double totalLength = 0;
+   for (auto pTrack : tracks)
    {
-      auto channelGroup = pTrack->Channels();
-      auto left = *channelGroup.first++;
-
-      unsigned channels = 1;
-
-      // channelGroup now contains all but the first channel
-      const auto right =
-         channelGroup.size() ? *channelGroup.first++ : nullptr;
-      if (right)
-         channels = 2;
-
       sampleCount start = 0;
       sampleCount len = 0;
       GetBounds(*pTrack, &start, &len);
+      totalLength += len.as_double();
+   }
+
+   // Each channel group gets its own plugin instance, so that the groups
+   // can be analyzed at once on the thread pool; a batch of them at a time
+   // bounds the number of instances
+   auto &pool = audacity::concurrency::ThreadPool::GetDefault();
+   const auto nJobs = std::max<size_t>(1, pool.GetThreadsCount());
+   double finishedLength = 0;
+   for (size_t first = 0; first < tracks.size(); first += nJobs)
+   {
+      const auto last = std::min(tracks.size(), first + nJobs);
+      std::vector<std::unique_ptr<AnalysisJob>> jobs;
+      for (auto ii = first; ii < last; ++ii)
+      {
+         const auto pTrack = tracks[ii];
+         auto channelGroup = pTrack->Channels();
+         auto left = *channelGroup.first++;
 
-      // TODO: more-than-two-channels
+         unsigned channels = 1;
 
-      size_t step = mPlugin->getPreferredStepSize();
-      size_t block = mPlugin->getPreferredBlockSize();
+         // channelGroup now contains all but the first channel
+         const auto right =
+            channelGroup.size() ? *channelGroup.first++ : nullptr;
+         if (right)
+            channels = 2;
 
-      bool initialiseRequired = true;
+         sampleCount start = 0;
+         sampleCount len = 0;
+         GetBounds(*pTrack, &start, &len);
 
-      if (block == 0)
-      {
-         if (step != 0)
-         {
-            block = step;
-         }
-         else
+         // TODO: more-than-two-channels
+
+         std::unique_ptr<Vamp::Plugin> pOwnedPlugin;
+         if (ii > 0)
          {
-            block = 1024;
+            pOwnedPlugin = ClonePlugin();
+            if (!pOwnedPlugin)
+            {
+               EffectUIServices::DoMessageBox(*this,
+                  XO("Sorry, failed to load Vamp Plug-in."));
+               return false;
+            }
          }
-      }
+         auto &plugin = pOwnedPlugin ? *pOwnedPlugin : *mPlugin;
 
-      if (step == 0)
-      {
-         step = block;
-      }
+         size_t step = plugin.getPreferredStepSize();
+         size_t block = plugin.getPreferredBlockSize();
 
-      if (prevTrackChannels > 0)
-      {
-         // Plugin has already been initialised, so if the number of
-         // channels remains the same, we only need to do a reset.
-         // Otherwise we need to re-construct the whole plugin,
-         // because a Vamp plugin can't be re-initialised.
-         if (prevTrackChannels == channels)
+         if (block == 0)
          {
-            mPlugin->reset();
-            initialiseRequired = false;
+            if (step != 0)
+            {
+               block = step;
+            }
+            else
+            {
+               block = 1024;
+            }
          }
-         else
+
+         if (step == 0)
          {
-            //!!! todo: retain parameters previously set
-            Init();
+            step = block;
          }
-      }
 
-      if (initialiseRequired)
-      {
-         if (!mPlugin->initialise(channels, step, block))
+         if (!plugin.initialise(channels, step, block))
          {
             EffectUIServices::DoMessageBox(*this,
                XO("Sorry, Vamp Plug-in failed to initialize."));
             return false;
          }
-      }
 
-      const auto effectName = GetSymbol().Translation();
-      addedTracks.push_back(AddAnalysisTrack(*this,
-         multiple
-         ? wxString::Format( _("%s: %s"), pTrack->GetName(), effectName )
-         : effectName
-      ));
-      LabelTrack *ltrack = addedTracks.back()->get();
-
-      FloatBuffers data{ channels, block };
-
-      auto originalLen = len;
-
-      auto pos = start;
+         const auto effectName = GetSymbol().Translation();
+         addedTracks.push_back(AddAnalysisTrack(*this,
+            multiple
+            ? wxString::Format( _("%s: %s"), pTrack->GetName(), effectName )
+            : effectName
+         ));
+
+         auto &job = *jobs.emplace_back(std::make_unique<AnalysisJob>(
+            plugin, left.get(), right.get(), step, block, start, len));
+         job.pOwnedPlugin = move(pOwnedPlugin);
+         job.ltrack = addedTracks.back()->get();
+         if (len == 0)
+            job.finished = true;
+      }
 
-      while (len != 0)
+      const auto advance = [this](AnalysisJob &job){
+         if (!job.finished)
+            job.Advance(mRate, mOutput);
+      };
+      while (std::any_of(jobs.begin(), jobs.end(),
+         [](auto &pJob){ return !pJob->finished; }))
       {
-         const auto request = limitSampleBufferSize( block, len );
-
-         if (left)
-            left->GetFloats(data[0].get(), pos, request);
-
-         if (right)
-            right->GetFloats(data[1].get(), pos, request);
-
-         if (request < block)
-         {
-            for (unsigned int c = 0; c < channels; ++c)
-            {
-               for (decltype(block) i = request; i < block; ++i)
-               {
-                  data[c][i] = 0.f;
-               }
-            }
-         }
+         pool.ParallelFor(jobs.size(), [&](size_t ii){ advance(*jobs[ii]); });
 
-         // UNSAFE_SAMPLE_COUNT_TRUNCATION
-         // Truncation in case of very long tracks!
-         Vamp::RealTime timestamp = Vamp::RealTime::frame2RealTime(
-            long( pos.as_long_long() ),
-            (int)(mRate + 0.5)
-         );
-
-         Vamp::Plugin::FeatureSet features = mPlugin->process(
-            reinterpret_cast< float** >( data.get() ), timestamp);
-         AddFeatures(ltrack, features);
-
-         if (len > (int)step)
-         {
-            len -= step;
-         }
-         else
-         {
-            len = 0;
-         }
-
-         pos += step;
-
-         if (channels > 1)
-         {
-            if (TrackGroupProgress(count,
-                  (pos - start).as_double() /
-                  originalLen.as_double() ))
-            {
-               return false;
-            }
-         }
-         else
-         {
-            if (TrackProgress(count,
-                  (pos - start).as_double() /
-                  originalLen.as_double() ))
-            {
-               return false;
-            }
-         }
+         double length = finishedLength;
+         for (auto &pJob : jobs)
+            length += pJob->Fraction() * (pJob->end - pJob->start).as_double();
+         if (TotalProgress(totalLength > 0 ? length / totalLength : 1.0))
+            return false;
       }
 
-      Vamp::Plugin::FeatureSet features = mPlugin->getRemainingFeatures();
-      AddFeatures(ltrack, features);
-
-      prevTrackChannels = channels;
+      // Write the labels in the main thread
+      for (auto &pJob : jobs)
+      {
+         for (auto &[region, label] : pJob->labels)
+            pJob->ltrack->AddLabel(region, label);
+         finishedLength += (pJob->end - pJob->start).as_double();
+      }
    }
 
    // All completed without cancellation, so commit the addition of tracks now
@@ -498,6 +585,23 @@ bool VampEffect::Process(EffectInstance &, EffectSettings &)
    return true;
 }
 
+std::unique_ptr<Vamp::Plugin> VampEffect::ClonePlugin() const
+{
+   Vamp::HostExt::PluginLoader *loader = Vamp::HostExt::PluginLoader::getInstance();
+   std::unique_ptr<Vamp::Plugin> plugin{
+      loader->loadPlugin(mKey, mRate, Vamp::HostExt::PluginLoader::ADAPT_ALL) };
+   if (!plugin)
+      return {};
+
+   // Select the program first, as it may set parameters
+   if (!mPlugin->getPrograms().empty())
+      plugin->selectProgram(mPlugin->getCurrentProgram());
+   for (const auto &parameter : mParameters)
+      plugin->setParameter(parameter.identifier,
+         mPlugin->getParameter(parameter.identifier));
+   return plugin;
+}
+
 std::unique_ptr<EffectEditor> VampEffect::PopulateOrExchange(
    ShuttleGui & S, EffectInstance &, EffectSettingsAccess &,
    const EffectOutputs *)
@@ -686,36 +790,6 @@ bool VampEffect::TransferDataFromWindow(EffectSettings &)
 
 // VampEffect implementation
 
-void VampEffect::AddFeatures(LabelTrack *ltrack,
-                             Vamp::Plugin::FeatureSet &features)
-{
-   for (Vamp::Plugin::FeatureList::iterator fli = features[mOutput].begin();
-        fli != features[mOutput].end(); ++fli)
-   {
-      Vamp::RealTime ftime0 = fli->timestamp;
-      double ltime0 = ftime0.sec + (double(ftime0.nsec) / 1000000000.0);
-
-      Vamp::RealTime ftime1 = ftime0;
-      if (fli->hasDuration) ftime1 = ftime0 + fli->duration;
-      double ltime1 = ftime1.sec + (double(ftime1.nsec) / 1000000000.0);
-
-      wxString label = LAT1CTOWX(fli->label.c_str());
-      if (label == wxString())
-      {
-         if (fli->values.empty())
-         {
-            label = wxString::Format(LAT1CTOWX("%.3f"), ltime0);
-         }
-         else
-         {
-            label = wxString::Format(LAT1CTOWX("%.3f"), *fli->values.begin());
-         }
-      }
-
-      ltrack->AddLabel(SelectedRegion(ltime0, ltime1), label);
-   }
-}
-
 void VampEffect::UpdateFromPlugin()
 {
    for (size_t p = 0, cnt = mParameters.size(); p < cnt; p++)
@@ -79,7 +79,8 @@ public:
 private:
    // VampEffect implementation
 
-   void AddFeatures(LabelTrack *track, Vamp::Plugin::FeatureSet & features);
+   //! Another instance of the plugin, with the same program and parameters
+   std::unique_ptr<Vamp::Plugin> ClonePlugin() const;
 
    void UpdateFromPlugin();
 
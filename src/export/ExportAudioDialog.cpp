@@ -13,6 +13,7 @@
 #include "ExportAudioDialog.h"
 
 #include <numeric>
+#include <set>
 
 #include <wx/frame.h>
 
@@ -96,6 +97,9 @@ BoolSetting ExportAudioOverwriteExisting { L"/ExportAudioDialog/OverwriteExistin
 
 BoolSetting ExportAudioSkipSilenceAtBeginning { L"/ExportAudioDialog/SkipSilenceAtBeginning", false };
 
+// More than one exports several of the multiple files at a time
+IntSetting ExportAudioSplitThreads { L"/ExportAudioDialog/SplitThreads", 1 };
+
 StringSetting ExportAudioDefaultFormat{ L"/ExportAudioDialog/Format", L"WAV" };
 
 StringSetting ExportAudioDefaultPath{ L"ExportAudioDialog/DefaultPath", L"" };
@@ -382,6 +386,12 @@ void ExportAudioDialog::PopulateOrExchange(ShuttleGui& S)
          mOverwriteExisting = S
             .Id(OverwriteExistingFilesID)
             .TieCheckBox(XO("Overwrite existing files"), ExportAudioOverwriteExisting);
+
+         S.StartHorizontalLay(wxALIGN_LEFT);
+         {
+            S.TieSpinCtrl(XO("Files exported at a time:"), ExportAudioSplitThreads, 64, 1);
+         }
+         S.EndHorizontalLay();
       }
       S.EndPanel();
       
@@ -868,6 +878,14 @@ ExportResult ExportAudioDialog::DoExportSplitByLabels(const ExportPlugin& plugin
                                                       const ExportProcessor::Parameters& parameters,
                                                       FilePaths& exporterFiles)
 {
+   if (const auto workers = ExportAudioSplitThreads.Read(); workers > 1)
+   {
+      std::vector<size_t> indices(mExportSettings.size());
+      std::iota(indices.begin(), indices.end(), 0);
+      return DoExportConcurrently(plugin, formatIndex, parameters, false,
+         indices, {}, workers, exporterFiles);
+   }
+
    auto ok = ExportResult::Success;   // did it work?
    /* Go round again and do the exporting (so this run is slow but
     * non-interactive) */
@@ -921,6 +939,23 @@ ExportResult ExportAudioDialog::DoExportSplitByTracks(const ExportPlugin& plugin
    for (auto tr : tracks.Selected<WaveTrack>())
       tr->SetSelected(false);
 
+   if (const auto workers = ExportAudioSplitThreads.Read(); workers > 1)
+   {
+      // Each export takes its tracks from the selection when built
+      std::vector<WaveTrack*> selected;
+      for (auto tr : waveTracks)
+         selected.push_back(tr);
+      std::vector<size_t> indices(
+         std::min(selected.size(), mExportSettings.size()));
+      std::iota(indices.begin(), indices.end(), 0);
+      return DoExportConcurrently(plugin, formatIndex, parameters, true,
+         indices, [&](size_t index) {
+            for (auto tr : tracks.Selected<WaveTrack>())
+               tr->SetSelected(false);
+            selected[index]->SetSelected(true);
+         }, workers, exporterFiles);
+   }
+
    auto ok = ExportResult::Success;
 
    int count = 0;
@@ -965,25 +1000,102 @@ ExportResult ExportAudioDialog::DoExportSplitByTracks(const ExportPlugin& plugin
    return ok ;
 }
 
-ExportResult ExportAudioDialog::DoExport(const ExportPlugin& plugin,
-                                         int formatIndex,
-                                         const ExportProcessor::Parameters& parameters,
-                                         const wxFileName& filename,
-                                         int channels,
-                                         double t0, double t1, bool selectedOnly,
-                                         const Tags& tags,
-                                         FilePaths& exportedFiles)
+ExportResult ExportAudioDialog::DoExportConcurrently(const ExportPlugin& plugin,
+                                                      int formatIndex,
+                                                      const ExportProcessor::Parameters& parameters,
+                                                      bool selectedOnly,
+                                                      const std::vector<size_t>& indices,
+                                                      const std::function<void(size_t)>& prepare,
+                                                      size_t workers,
+                                                      FilePaths& exportedFiles)
 {
-   wxFileName name;
+   auto ok = ExportResult::Success;
+   auto next = indices.begin();
+   while (next != indices.end())
+   {
+      // Build the next batch.  A file named twice waits for the next batch,
+      // so that the files are named, and overwritten, as if exported in turn.
+      std::vector<ExportTask> tasks;
+      std::vector<wxFileName> backups;
+      std::vector<wxString> fullPaths;
+      std::set<wxString> targets;
+      auto result = ExportResult::Error;
+      std::vector<std::shared_future<ExportResult>> results;
+      ExportProgressUI::ExceptionWrappedCall([&]
+      {
+         for (; next != indices.end() && tasks.size() < workers; ++next)
+         {
+            const auto& activeSetting = mExportSettings[*next];
+            // Bug 1440 fix.
+            if( activeSetting.filename.GetName().empty() )
+               continue;
+            if (!targets.insert(activeSetting.filename.GetFullPath()).second)
+               break;
 
-   wxLogDebug(wxT("Doing multiple Export: File name \"%s\""), (filename.GetFullName()));
-   wxLogDebug(wxT("Channels: %i, Start: %lf, End: %lf "), channels, t0, t1);
-   if (selectedOnly)
-      wxLogDebug(wxT("Selected Region Only"));
-   else
-      wxLogDebug(wxT("Whole Project"));
+            if (prepare)
+               prepare(*next);
+            fullPaths.push_back(PrepareExportFile(activeSetting.filename,
+               backups.emplace_back()));
+            tasks.push_back(ExportTaskBuilder{}.SetPlugin(&plugin, formatIndex)
+               .SetParameters(parameters)
+               .SetRange(activeSetting.t0, activeSetting.t1, selectedOnly)
+               .SetTags(&activeSetting.tags)
+               .SetNumChannels(activeSetting.channels)
+               .SetFileName(fullPaths.back())
+               .SetSampleRate(mExportOptionsPanel->GetSampleRate())
+               .Build(mProject));
+         }
+         if (!tasks.empty())
+            result = ExportProgressUI::Show(
+               MakeConcurrentExportTask(move(tasks), &results));
+      });
+      if (fullPaths.empty())
+         break;
+
+      for (size_t ii = 0; ii < fullPaths.size(); ++ii)
+      {
+         bool success{false};
+         if (ii < results.size())
+         {
+            try {
+               const auto fileResult = results[ii].get();
+               success = fileResult == ExportResult::Success ||
+                  fileResult == ExportResult::Stopped;
+            }
+            catch (...) {
+               // Already reported
+            }
+         }
+         FinishExportFile(backups[ii], fullPaths[ii], success);
+         if (success)
+            exportedFiles.push_back(fullPaths[ii]);
+      }
+
+      ok = result;
+      if (ok == ExportResult::Stopped) {
+         AudacityMessageDialog dlgMessage(
+            nullptr,
+            XO("Continue to export remaining files?"),
+            XO("Export"),
+            wxYES_NO | wxNO_DEFAULT | wxICON_WARNING);
+         if (dlgMessage.ShowModal() != wxID_YES ) {
+            // User decided not to continue - bail out!
+            break;
+         }
+      }
+      else if (ok != ExportResult::Success) {
+         break;
+      }
+   }
+
+   return ok;
+}
+
+wxString ExportAudioDialog::PrepareExportFile(const wxFileName& filename,
+                                              wxFileName& backup) const
+{
+   wxFileName name;
 
-   wxFileName backup;
    if (mOverwriteExisting->GetValue()) {
       name = filename;
       backup.Assign(name);
@@ -1006,25 +1118,53 @@ ExportResult ExportAudioDialog::DoExport(const ExportPlugin& plugin,
       }
    }
 
-   bool success{false};
-   const wxString fullPath{name.GetFullPath()};
+   return name.GetFullPath();
+}
 
-   auto cleanup = finally( [&] {
-      if (backup.IsOk()) {
-         if ( success )
-            // Remove backup
-            ::wxRemoveFile(backup.GetFullPath());
-         else {
-            // Restore original
-            ::wxRemoveFile(fullPath);
-            ::wxRenameFile(backup.GetFullPath(), fullPath);
-         }
-      }
+void ExportAudioDialog::FinishExportFile(const wxFileName& backup,
+                                         const wxString& fullPath,
+                                         bool success)
+{
+   if (backup.IsOk()) {
+      if ( success )
+         // Remove backup
+         ::wxRemoveFile(backup.GetFullPath());
       else {
-         if ( ! success )
-            // Remove any new, and only partially written, file.
-            ::wxRemoveFile(fullPath);
+         // Restore original
+         ::wxRemoveFile(fullPath);
+         ::wxRenameFile(backup.GetFullPath(), fullPath);
       }
+   }
+   else {
+      if ( ! success )
+         // Remove any new, and only partially written, file.
+         ::wxRemoveFile(fullPath);
+   }
+}
+
+ExportResult ExportAudioDialog::DoExport(const ExportPlugin& plugin,
+                                         int formatIndex,
+                                         const ExportProcessor::Parameters& parameters,
+                                         const wxFileName& filename,
+                                         int channels,
+                                         double t0, double t1, bool selectedOnly,
+                                         const Tags& tags,
+                                         FilePaths& exportedFiles)
+{
+   wxLogDebug(wxT("Doing multiple Export: File name \"%s\""), (filename.GetFullName()));
+   wxLogDebug(wxT("Channels: %i, Start: %lf, End: %lf "), channels, t0, t1);
+   if (selectedOnly)
+      wxLogDebug(wxT("Selected Region Only"));
+   else
+      wxLogDebug(wxT("Whole Project"));
+
+   wxFileName backup;
+   const wxString fullPath{ PrepareExportFile(filename, backup) };
+
+   bool success{false};
+
+   auto cleanup = finally( [&] {
+      FinishExportFile(backup, fullPath, success);
    } );
    
    auto result = ExportResult::Error;
@@ -1047,5 +1187,3 @@ ExportResult ExportAudioDialog::DoExport(const ExportPlugin& plugin,
    
    return result;
 }
-
-
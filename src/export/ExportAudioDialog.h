@@ -10,6 +10,8 @@
 
 #pragma once
 
+#include <functional>
+
 #include "wxPanelWrapper.h"
 #include "ExportTypes.h"
 #include <wx/filename.h>
@@ -95,6 +97,25 @@ private:
                                       const ExportProcessor::Parameters& parameters,
                                       FilePaths& exporterFiles);
    
+   //! Export the files of mExportSettings at the given indices, several at a time
+   /*!
+    @param prepare called with each index just before its export is built
+    */
+   ExportResult DoExportConcurrently(const ExportPlugin& plugin,
+                                     int formatIndex,
+                                     const ExportProcessor::Parameters& parameters,
+                                     bool selectedOnly,
+                                     const std::vector<size_t>& indices,
+                                     const std::function<void(size_t)>& prepare,
+                                     size_t workers,
+                                     FilePaths& exportedFiles);
+
+   //! Choose the path to export to, moving aside any file to be overwritten
+   wxString PrepareExportFile(const wxFileName& filename, wxFileName& backup) const;
+   //! Restore or remove the backup, and remove a failed export
+   static void FinishExportFile(const wxFileName& backup, const wxString& fullPath,
+                                bool success);
+
    ExportResult DoExport(const ExportPlugin& plugin,
                          int formatIndex,
                          const ExportProcessor::Parameters& parameters,
@@ -29,6 +29,7 @@ and sample size to help you importing data of an unknown format.
 
 #include "AudioIOBase.h"
 #include "FileFormats.h"
+#include "MappedPCMReader.h"
 #include "Prefs.h"
 #include "ProjectRate.h"
 #include "SelectFile.h"
@@ -182,7 +183,17 @@ void ImportRaw(const AudacityProject &project, wxWindow *parent, const wxString
 
       const auto maxBlockSize = (*trackList->Any<WaveTrack>().begin())->GetMaxBlockSize();
 
-      SampleBuffer srcbuffer(maxBlockSize * numChannels, format);
+      // Uncompressed samples are read from a mapping of the file, without
+      // the copies of buffered reading
+      auto mappedInfo = sndInfo;
+      mappedInfo.frames = totalFrames.as_long_long();
+      const auto reader = MappedPCMReader::Open(fileName, sndFile.get(),
+         mappedInfo, (format == int16Sample) ? int16Sample : floatSample,
+         offset);
+
+      SampleBuffer srcbuffer;
+      if (!reader)
+         srcbuffer.Allocate(maxBlockSize * numChannels, format);
       SampleBuffer buffer(maxBlockSize, format);
 
       decltype(totalFrames) framescompleted = 0;
@@ -202,7 +213,9 @@ void ImportRaw(const AudacityProject &project, wxWindow *parent, const wxString
             limitSampleBufferSize( maxBlockSize, totalFrames - framescompleted );
 
          sf_count_t sf_result;
-         if (format == int16Sample)
+         if (reader)
+            sf_result = block;
+         else if (format == int16Sample)
             sf_result = SFCall<sf_count_t>(sf_readf_short, sndFile.get(), (short *)srcbuffer.ptr(), block);
          else
             sf_result = SFCall<sf_count_t>(sf_readf_float, sndFile.get(), (float *)srcbuffer.ptr(), block);
@@ -216,7 +229,22 @@ void ImportRaw(const AudacityProject &project, wxWindow *parent, const wxString
             throw FileException{ FileException::Cause::Read, fileName };
          }
 
-         if (block) {
+         if (block && reader) {
+            size_t c = 0;
+            ImportUtils::ForEachChannel(*trackList, [&](auto& channel)
+            {
+               size_t stride;
+               const auto samples = reader->Read(
+                  framescompleted.as_long_long(), block, c, buffer.ptr(),
+                  stride);
+               channel.AppendBuffer(samples,
+                  ((format == int16Sample) ? int16Sample : floatSample), block,
+                  stride, sf_subtype_to_effective_format(encoding));
+               ++c;
+            });
+            framescompleted += block;
+         }
+         else if (block) {
             size_t c = 0;
             ImportUtils::ForEachChannel(*trackList, [&](auto& channel)
             {
@@ -17,7 +17,9 @@
 #include "RawAudioGuess.h"
 
 #include "AudacityException.h"
+#include "concurrency/ThreadPool.h"
 
+#include <vector>
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
@@ -290,6 +292,79 @@ static void Extract(bool bits16,
    *len2 = dataCount2;
 }
 
+//! One interpretation of the data as floating-point
+struct FloatCandidate {
+   unsigned prec;
+   int endian;
+   size_t offset;
+   //! Whether the interpretation is plausible
+   bool accepted;
+   float smoothAvg;
+};
+
+//! Decide whether the candidate is plausible, and how smooth it is
+static void TestFloatFormat(unsigned numTests, const ArrayOf<char> rawData[],
+                            size_t dataSize, FloatCandidate &candidate)
+{
+   unsigned finiteVotes = 0;
+   unsigned maxminVotes = 0;
+   float smoothAvg = 0;
+   size_t len1;
+   size_t len2;
+
+   ArrayOf<float> data1{ dataSize + 4 };
+   ArrayOf<float> data2{ dataSize + 4 };
+
+   for(unsigned test = 0; test < numTests; test++) {
+      float min, max;
+
+      ExtractFloats(candidate.prec == 1, candidate.endian == 1,
+                    true, /* stereo */
+                    candidate.offset,
+                    rawData[test].get(), dataSize,
+                    data1.get(), data2.get(), &len1, &len2);
+
+      size_t i = 0;
+      for(; i < len1; i++)
+         // This code is testing for NaNs.
+         // We'd like to know if all data is finite.
+         if (!(data1[i]>=0 || data1[i]<=0) ||
+             !(data2[i]>=0 || data2[i]<=0))
+            break;
+      if (i == len1)
+         // all data is finite.
+         finiteVotes++;
+
+      min = data1[0];
+      max = data1[0];
+      for(i = 1; i < len1; i++) {
+         if (data1[i]<min)
+            min = data1[i];
+         if (data1[i]>max)
+            max = data1[i];
+      }
+      for(i = 1; i < len2; i++) {
+         if (data2[i]<min)
+            min = data2[i];
+         if (data2[i]>max)
+            max = data2[i];
+      }
+
+      if (min < -0.01 && min >= -100000 &&
+          max > 0.01 && max <= 100000)
+         maxminVotes++;
+
+      smoothAvg += SecondDStat(data1.get(), len1) / max;
+   }
+
+   smoothAvg /= numTests;
+
+   candidate.smoothAvg = smoothAvg;
+   candidate.accepted = finiteVotes > numTests/2 &&
+      finiteVotes > numTests-2 &&
+      maxminVotes > numTests/2;
+}
+
 static int GuessFloatFormats(unsigned numTests, const ArrayOf<char> rawData[], size_t dataSize,
                              size_t *out_offset, unsigned *out_channels)
 {
@@ -328,81 +403,36 @@ static int GuessFloatFormats(unsigned numTests, const ArrayOf<char> rawData[], s
     * because big-endian floats actually still look and act
     * like floats when you interpret them as little-endian
     * floats with a 1-byte offset.
+    *
+    * The candidates are independent, so they are tested at once on the
+    * thread pool, then compared in the same order as before.
     */
 
-   for(unsigned int prec = 0; prec < 2; prec++) {
-      for(int endian = 0; endian < 2; endian++) {
-         for(size_t offset = 0; offset < (4 * prec + 4); offset++) {
-            unsigned finiteVotes = 0;
-            unsigned maxminVotes = 0;
-            float smoothAvg = 0;
-
-           #if RAW_GUESS_DEBUG
-            wxFprintf(af, "prec=%d endian=%d offset=%d\n",
-                    prec, endian, (int)offset);
-           #endif
-
-            for(unsigned test = 0; test < numTests; test++) {
-               float min, max;
-
-               ExtractFloats(prec == 1, endian == 1,
-                             true, /* stereo */
-                             offset,
-                             rawData[test].get(), dataSize,
-                             data1.get(), data2.get(), &len1, &len2);
-
-               size_t i = 0;
-               for(; i < len1; i++)
-                  // This code is testing for NaNs.
-                  // We'd like to know if all data is finite.
-                  if (!(data1[i]>=0 || data1[i]<=0) ||
-                      !(data2[i]>=0 || data2[i]<=0))
-                     break;
-               if (i == len1)
-                  // all data is finite.
-                  finiteVotes++;
-
-               min = data1[0];
-               max = data1[0];
-               for(i = 1; i < len1; i++) {
-                  if (data1[i]<min)
-                     min = data1[i];
-                  if (data1[i]>max)
-                     max = data1[i];
-               }
-               for(i = 1; i < len2; i++) {
-                  if (data2[i]<min)
-                     min = data2[i];
-                  if (data2[i]>max)
-                     max = data2[i];
-               }
-
-               if (min < -0.01 && min >= -100000 &&
-                   max > 0.01 && max <= 100000)
-                  maxminVotes++;
-
-               smoothAvg += SecondDStat(data1.get(), len1) / max;
-            }
-
-            smoothAvg /= numTests;
-
-           #if RAW_GUESS_DEBUG
-            wxFprintf(af, "finite: %ud/%ud maxmin: %ud/%ud smooth: %f\n",
-                    finiteVotes, numTests, maxminVotes, numTests,
-                    smoothAvg);
-           #endif
-
-            if (finiteVotes > numTests/2 &&
-                finiteVotes > numTests-2 &&
-                maxminVotes > numTests/2 &&
-                smoothAvg < bestSmoothAvg) {
-
-               bestSmoothAvg = smoothAvg;
-               bestOffset = offset;
-               bestPrec = prec;
-               bestEndian = endian;
-            }
-         }
+   std::vector<FloatCandidate> candidates;
+   for(unsigned int prec = 0; prec < 2; prec++)
+      for(int endian = 0; endian < 2; endian++)
+         for(size_t offset = 0; offset < (4 * prec + 4); offset++)
+            candidates.push_back({ prec, endian, offset, false, 0 });
+
+   auto &pool = audacity::concurrency::ThreadPool::GetDefault();
+   pool.ParallelFor(candidates.size(), [&](size_t ii){
+      TestFloatFormat(numTests, rawData, dataSize, candidates[ii]);
+   });
+
+   for (const auto &candidate : candidates) {
+     #if RAW_GUESS_DEBUG
+      wxFprintf(af, "prec=%d endian=%d offset=%d accepted: %d smooth: %f\n",
+              candidate.prec, candidate.endian, (int)candidate.offset,
+              candidate.accepted, candidate.smoothAvg);
+     #endif
+
+      if (candidate.accepted &&
+          candidate.smoothAvg < bestSmoothAvg) {
+
+         bestSmoothAvg = candidate.smoothAvg;
+         bestOffset = candidate.offset;
+         bestPrec = candidate.prec;
+         bestEndian = candidate.endian;
       }
    }
 
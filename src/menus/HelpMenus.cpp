@@ -7,6 +7,7 @@
 #include "../AboutDialog.h"
 #include "AllThemeResources.h"
 #include "AudioIO.h"
+#include "../AudioEngineStatistics.h"
 #include "../CommonCommandFlags.h"
 #include "../CrashReport.h" // for HAS_CRASH_REPORT
 #include "FileNames.h"
@@ -29,6 +30,7 @@
 #include "HelpSystem.h"
 
 #include "FrameStatisticsDialog.h"
+#include "MemoryStatisticsDialog.h"
 
 #if defined(HAVE_UPDATES_CHECK)
 #include "update/UpdateManager.h"
@@ -276,6 +278,15 @@ void OnAudioDeviceInfo(const CommandContext &context)
       XO("Audio Device Info"), wxT("deviceinfo.txt") );
 }
 
+void OnAudioEngineStatistics(const CommandContext &context)
+{
+   auto &project = context.project;
+   const auto info = AudioEngineStatistics::Format(
+      AudioEngineStatistics::Gather(project));
+   ShowDiagnostics( project, info,
+      XO("Audio Engine Statistics"), wxT("audiostatistics.txt"), true );
+}
+
 void OnShowLog( const CommandContext &context )
 {
    LogWindow::Show();
@@ -369,6 +380,11 @@ void OnFrameStatistics(const CommandContext&)
    FrameStatisticsDialog::Show(true);
 }
 
+void OnMemoryStatistics(const CommandContext&)
+{
+   MemoryStatisticsDialog::Show(true);
+}
+
 #if defined(HAVE_UPDATES_CHECK)
 void OnCheckForUpdates(const CommandContext &WXUNUSED(context))
 {
@@ -436,6 +452,9 @@ auto HelpMenu()
             Command( wxT("DeviceInfo"), XXO("Au&dio Device Info..."),
                OnAudioDeviceInfo,
                AudioIONotBusyFlag() ),
+            Command( wxT("AudioStatistics"), XXO("Audio &Engine Statistics..."),
+               OnAudioEngineStatistics,
+               AlwaysEnabledFlag ),
             Command( wxT("Log"), XXO("Show &Log..."), OnShowLog,
                AlwaysEnabledFlag ),
       #if defined(HAS_CRASH_REPORT)
@@ -465,6 +484,11 @@ auto HelpMenu()
             Command(
                  wxT("FrameStatistics"), Verbatim("Frame Statistics..."),
                  OnFrameStatistics,
+                 AlwaysEnabledFlag),
+
+            Command(
+                 wxT("MemoryStatistics"), Verbatim("Memory Statistics..."),
+                 OnMemoryStatistics,
                  AlwaysEnabledFlag)
       #endif
          )
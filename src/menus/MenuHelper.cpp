@@ -11,12 +11,18 @@ namespace {
 
 using EffectsMenuGroups = std::vector<std::pair<TranslatableString, std::vector<TranslatableString>>>;
 
+//! Compared lexicographically to order the plugins of a section
+using SortKey = std::vector<wxString>;
+
 struct MenuSectionBuilder
 {
    std::vector<const PluginDescriptor*> plugins;
 
    std::function<bool(const PluginDescriptor*)> filter;
-   std::function<bool(const PluginDescriptor*, const PluginDescriptor*)> compare;
+   //! Found once for each plugin, not in each comparison, because the
+   //! translations and the lookups of vendors and families are costly when
+   //! there are thousands of plugins
+   std::function<SortKey(const PluginDescriptor*)> sortKey;
    std::function<void(MenuHelper::Group&, std::vector<const PluginDescriptor*>&)> add;
 };
 
@@ -400,116 +406,74 @@ void AddGroupedEffectMenuItems(
    doAddGroup();
 }
 
-bool CompareEffectsByName(const PluginDescriptor *a, const PluginDescriptor *b)
+SortKey EffectsByName(const PluginDescriptor *plug)
 {
-   return
-      std::make_pair( a->GetSymbol().Translation(), a->GetPath() ) <
-      std::make_pair( b->GetSymbol().Translation(), b->GetPath() );
+   return { plug->GetSymbol().Translation(), plug->GetPath() };
 }
 
-bool CompareEffectsByPublisher(
-   const PluginDescriptor *a, const PluginDescriptor *b)
+SortKey EffectsByPublisher(const PluginDescriptor *plug)
 {
-   auto &em = EffectManager::Get();
-   
-   auto akey = em.GetVendorName(a->GetID());
-   auto bkey = em.GetVendorName(b->GetID());
-
-   if (akey.empty())
-      akey = XO("Uncategorized");
-   if (bkey.empty())
-      bkey = XO("Uncategorized");
-
-   return
-      std::make_tuple(
-         akey.Translation(), a->GetSymbol().Translation(), a->GetPath() ) <
-      std::make_tuple(
-         bkey.Translation(), b->GetSymbol().Translation(), b->GetPath() );
+   auto key = EffectManager::Get().GetVendorName(plug->GetID());
+   if (key.empty())
+      key = XO("Uncategorized");
+
+   return { key.Translation(), plug->GetSymbol().Translation(), plug->GetPath() };
 }
 
-bool CompareEffectsByPublisherAndName(
-   const PluginDescriptor *a, const PluginDescriptor *b)
+SortKey EffectsByPublisherAndName(const PluginDescriptor *plug)
 {
-   auto &em = EffectManager::Get();
-   auto akey = em.GetVendorName(a->GetID());
-   auto bkey = em.GetVendorName(b->GetID());
-
-   if (a->IsEffectDefault())
-      akey = {};
-   if (b->IsEffectDefault())
-      bkey = {};
-
-   return
-      std::make_tuple(
-         akey.Translation(), a->GetSymbol().Translation(), a->GetPath() ) <
-      std::make_tuple(
-         bkey.Translation(), b->GetSymbol().Translation(), b->GetPath() );
+   auto key = EffectManager::Get().GetVendorName(plug->GetID());
+   if (plug->IsEffectDefault())
+      key = {};
+
+   return { key.Translation(), plug->GetSymbol().Translation(), plug->GetPath() };
 }
 
-bool CompareEffectsByTypeAndName(
-   const PluginDescriptor *a, const PluginDescriptor *b)
+SortKey EffectsByTypeAndName(const PluginDescriptor *plug)
 {
-   auto &em = EffectManager::Get();
-   auto akey = em.GetEffectFamilyName(a->GetID());
-   auto bkey = em.GetEffectFamilyName(b->GetID());
-
-   if (akey.empty())
-      akey = XO("Uncategorized");
-   if (bkey.empty())
-      bkey = XO("Uncategorized");
-
-   if (a->IsEffectDefault())
-      akey = {};
-   if (b->IsEffectDefault())
-      bkey = {};
-
-   return
-      std::make_tuple(
-         akey.Translation(), a->GetSymbol().Translation(), a->GetPath() ) <
-      std::make_tuple(
-         bkey.Translation(), b->GetSymbol().Translation(), b->GetPath() );
+   auto key = EffectManager::Get().GetEffectFamilyName(plug->GetID());
+   if (key.empty())
+      key = XO("Uncategorized");
+   if (plug->IsEffectDefault())
+      key = {};
+
+   return { key.Translation(), plug->GetSymbol().Translation(), plug->GetPath() };
 }
 
-bool CompareEffectsByType(const PluginDescriptor *a, const PluginDescriptor *b)
+SortKey EffectsByType(const PluginDescriptor *plug)
 {
-   auto &em = EffectManager::Get();
-   auto akey = em.GetEffectFamilyName(a->GetID());
-   auto bkey = em.GetEffectFamilyName(b->GetID());
-
-   if (akey.empty())
-      akey = XO("Uncategorized");
-   if (bkey.empty())
-      bkey = XO("Uncategorized");
-
-   return
-      std::make_tuple(
-         akey.Translation(), a->GetSymbol().Translation(), a->GetPath() ) <
-      std::make_tuple(
-         bkey.Translation(), b->GetSymbol().Translation(), b->GetPath() );
+   auto key = EffectManager::Get().GetEffectFamilyName(plug->GetID());
+   if (key.empty())
+      key = XO("Uncategorized");
+
+   return { key.Translation(), plug->GetSymbol().Translation(), plug->GetPath() };
 }
 
-bool ComapareEffectsByTypeAndPublisher(const PluginDescriptor *a, const PluginDescriptor *b)
+SortKey EffectsByTypeAndPublisher(const PluginDescriptor *plug)
 {
    auto &em = EffectManager::Get();
-   auto aType = em.GetEffectFamilyName(a->GetID());
-   auto bType = em.GetEffectFamilyName(b->GetID());
-   auto aVendor = em.GetVendorName(a->GetID());
-   auto bVendor = em.GetVendorName(b->GetID());
-
-   if (aType.empty())
-      aType = XO("Uncategorized");
-   if (bType.empty())
-      bType = XO("Uncategorized");
-   if (aVendor.empty())
-      aVendor = XO("Unknown");
-   if (bVendor.empty())
-      bVendor = XO("Unknown");
-
-   return
-      std::make_tuple(
-         aType.Translation(), aVendor.Translation(), a->GetSymbol().Translation(), a->GetPath() ) <
-      std::make_tuple(
-         bType.Translation(), bVendor.Translation(), b->GetSymbol().Translation(), b->GetPath() );
+   auto type = em.GetEffectFamilyName(plug->GetID());
+   auto vendor = em.GetVendorName(plug->GetID());
+   if (type.empty())
+      type = XO("Uncategorized");
+   if (vendor.empty())
+      vendor = XO("Unknown");
+
+   return { type.Translation(), vendor.Translation(),
+      plug->GetSymbol().Translation(), plug->GetPath() };
+}
+
+void SortPlugins(std::vector<const PluginDescriptor*> &plugins,
+   const std::function<SortKey(const PluginDescriptor*)> &sortKey)
+{
+   std::vector<std::pair<SortKey, const PluginDescriptor*>> keyed;
+   keyed.reserve(plugins.size());
+   for (auto plug : plugins)
+      keyed.emplace_back(sortKey(plug), plug);
+   std::sort(keyed.begin(), keyed.end(),
+      [](const auto &a, const auto &b){ return a.first < b.first; });
+   std::transform(keyed.begin(), keyed.end(), plugins.begin(),
+      [](const auto &pair){ return pair.second; });
 }
 
 bool IsEnabledPlugin(const PluginDescriptor* plug)
@@ -533,10 +497,11 @@ bool IsBundledPlugin(const PluginDescriptor* plug)
 {
    if(IsDefaultPlugin(plug))
       return true;
-   auto applicationResourcePath = wxFileName(FileNames::ResourcesDir());
+   static const auto applicationResourcePath =
+      wxFileName(FileNames::ResourcesDir()).GetPath();
    auto pluginPath = wxFileName(plug->GetPath());
    pluginPath.MakeAbsolute();
-   return pluginPath.GetPath().StartsWith(applicationResourcePath.GetPath());
+   return pluginPath.GetPath().StartsWith(applicationResourcePath);
 }
 
 auto MakeGroupsFilter(const EffectsMenuGroups& list) -> auto
@@ -610,7 +575,7 @@ void MenuHelper::PopulateEffectsMenu(
             MenuSectionBuilder {
                {},
                IsEnabledPlugin,
-               CompareEffectsByPublisher,
+               EffectsByPublisher,
                MakeAddGroupedItems(GroupBy::Publisher)
             });
       }
@@ -620,14 +585,14 @@ void MenuHelper::PopulateEffectsMenu(
             MenuSectionBuilder {
                {},
                [](auto plug){ return IsEnabledPlugin(plug) && IsBundledPlugin(plug); } ,
-               CompareEffectsByName,
+               EffectsByName,
                MakeAddSortedItems(SortBy::Name)
             });
          sections.emplace_back(
             MenuSectionBuilder {
                {},
                IsEnabledPlugin,
-               CompareEffectsByPublisher,
+               EffectsByPublisher,
                MakeAddGroupedItems(GroupBy::Publisher)
             });
       }
@@ -638,14 +603,14 @@ void MenuHelper::PopulateEffectsMenu(
          MenuSectionBuilder {
             {},
             DefaultFilter,
-            CompareEffectsByName,
+            EffectsByName,
             MakeAddSortedItems(SortBy::PublisherName)
          });
       sections.emplace_back(
          MenuSectionBuilder {
             {},
             IsEnabledPlugin,
-            CompareEffectsByPublisherAndName,
+            EffectsByPublisherAndName,
             MakeAddSortedItems(SortBy::PublisherName)
          });
    }
@@ -655,14 +620,14 @@ void MenuHelper::PopulateEffectsMenu(
          MenuSectionBuilder {
             {},
             DefaultFilter,
-            CompareEffectsByName,
+            EffectsByName,
             MakeAddSortedItems(SortBy::TypeName)
          });
       sections.emplace_back(
          MenuSectionBuilder {
             {},
             IsEnabledPlugin,
-            CompareEffectsByPublisherAndName,
+            EffectsByPublisherAndName,
             MakeAddSortedItems(SortBy::TypeName)
          });
    }
@@ -672,14 +637,14 @@ void MenuHelper::PopulateEffectsMenu(
          MenuSectionBuilder {
             {},
             DefaultFilter,
-            CompareEffectsByPublisher,
+            EffectsByPublisher,
             MakeAddGroupedItems(GroupBy::Publisher)
          });
       sections.emplace_back(
          MenuSectionBuilder {
             {},
             IsEnabledPlugin,
-            CompareEffectsByPublisher,
+            EffectsByPublisher,
             MakeAddGroupedItems(GroupBy::Publisher)
          });
    }
@@ -689,14 +654,14 @@ void MenuHelper::PopulateEffectsMenu(
          MenuSectionBuilder {
             {},
             DefaultFilter,
-            CompareEffectsByType,
+            EffectsByType,
             MakeAddGroupedItems(GroupBy::Type)
          });
       sections.emplace_back(
          MenuSectionBuilder {
             {},
             IsEnabledPlugin,
-            CompareEffectsByType,
+            EffectsByType,
             MakeAddGroupedItems(GroupBy::Type)
          });
    }
@@ -706,14 +671,14 @@ void MenuHelper::PopulateEffectsMenu(
          MenuSectionBuilder {
             {},
             DefaultFilter,
-            CompareEffectsByType,
+            EffectsByType,
             MakeAddGroupedItems(GroupBy::Type)
          });
       sections.push_back(
          MenuSectionBuilder {
             {},
             IsEnabledPlugin,
-            ComapareEffectsByTypeAndPublisher,
+            EffectsByTypeAndPublisher,
             MakeAddGroupedItems(GroupBy::TypePublisher)
          });
    }
@@ -723,14 +688,14 @@ void MenuHelper::PopulateEffectsMenu(
          MenuSectionBuilder {
             {},
             DefaultFilter,
-            CompareEffectsByName,
+            EffectsByName,
             MakeAddSortedItems(SortBy::Name)
          });
       sections.emplace_back(
          MenuSectionBuilder {
             {},
             IsEnabledPlugin,
-            CompareEffectsByName,
+            EffectsByName,
             MakeAddSortedItems(SortBy::Name)
          });
    }
@@ -751,8 +716,8 @@ void MenuHelper::PopulateEffectsMenu(
 
    for(auto& section : sections)
    {
-      if(section.compare != nullptr)
-         std::sort(section.plugins.begin(), section.plugins.end(), section.compare);
+      if(section.sortKey != nullptr)
+         SortPlugins(section.plugins, section.sortKey);
 
       if (menuItems.empty()) {
          auto group = MenuRegistry::Items("");
@@ -1,5 +1,6 @@
 #include "../CommonCommandFlags.h"
 #include "../LabelTrack.h"
+#include "FrozenTracks.h"
 #include "MixAndRender.h"
 
 #include "Prefs.h"
@@ -568,6 +569,22 @@ void OnMixAndRenderToNewTrack(const CommandContext &context)
    DoMixAndRender(project, true);
 }
 
+void OnFreezeEffects(const CommandContext &context)
+{
+   auto &project = context.project;
+   auto &frozenTracks = FrozenTracks::Get(project);
+   for (auto pTrack : TrackList::Get(project).Selected<const WaveTrack>())
+      frozenTracks.Freeze(*pTrack);
+}
+
+void OnUnfreezeEffects(const CommandContext &context)
+{
+   auto &project = context.project;
+   auto &frozenTracks = FrozenTracks::Get(project);
+   for (auto pTrack : TrackList::Get(project).Selected<const WaveTrack>())
+      frozenTracks.Unfreeze(*pTrack);
+}
+
 void OnResample(const CommandContext &context)
 {
    auto &project = context.project;
@@ -867,6 +884,7 @@ void OnScoreAlign(const CommandContext &context)
    }
 
    if (result == SA_SUCCESS) {
+      alignedNoteTrack->InvalidateNoteIndex();
       tracks->Replace(nt, holder);
       AudacityMessageBox(
          XO("Alignment completed: MIDI from %.2f to %.2f secs, Audio from %.2f to %.2f secs.")
@@ -1154,7 +1172,15 @@ auto TracksMenu()
             Command( wxT("MixAndRenderToNewTrack"),
                XXO("Mix and Render to Ne&w Track"),
                OnMixAndRenderToNewTrack,
-               AudioIONotBusyFlag() | WaveTracksSelectedFlag(), wxT("Ctrl+Shift+M") )
+               AudioIONotBusyFlag() | WaveTracksSelectedFlag(), wxT("Ctrl+Shift+M") ),
+            Command( wxT("FreezeEffects"),
+               XXO("Free&ze Realtime Effects"),
+               OnFreezeEffects,
+               AudioIONotBusyFlag() | WaveTracksSelectedFlag() ),
+            Command( wxT("UnfreezeEffects"),
+               XXO("&Unfreeze Realtime Effects"),
+               OnUnfreezeEffects,
+               AudioIONotBusyFlag() | WaveTracksSelectedFlag() )
          ),
 
          Command( wxT("Resample"), XXO("&Resample..."), OnResample,
@@ -432,6 +432,7 @@ void OnToggleSWPlaythrough(const CommandContext &WXUNUSED(context) )
    gPrefs->Read(wxT("/AudioIO/SWPlaythrough"), &SWPlaythrough, false);
    gPrefs->Write(wxT("/AudioIO/SWPlaythrough"), !SWPlaythrough);
    gPrefs->Flush();
+   PrefsListener::Broadcast(AudioIOPrefsID());
    ToolManager::ModifyAllProjectToolbarMenus();
 }
 
@@ -28,6 +28,7 @@
 #include "PluginRegistrationDialog.h"
 #include "MenuCreator.h"
 #include "Prefs.h"
+#include "RealtimeSandbox.h"
 #include "ShuttleGui.h"
 
 EffectsPrefs::EffectsPrefs(wxWindow * parent, wxWindowID winid)
@@ -120,20 +121,12 @@ void EffectsPrefs::PopulateOrExchange(ShuttleGui & S)
           .TieChoice( XXO("Realtime effect o&rganization:"), RealtimeEffectsGroupBy);
       }
       S.TieCheckBox(XXO("&Skip effects scanning at startup"), SkipEffectsScanAtStartup);
+      S.TieCheckBox(XXO("Run realtime effects in a separate &process"),
+         RealtimeSandbox::Enabled);
       S.EndMultiColumn();
    }
    S.EndStatic();
 
-#ifdef EXPERIMENTAL_EQ_SSE_THREADED
-   S.StartStatic(XO("Instruction Set"));
-   {
-      S.TieCheckBox(XXO("&Use SSE/SSE2/.../AVX"),
-                    {wxT("/SSE/GUI"),
-                    true});
-   }
-   S.EndStatic();
-#endif
-
    if (auto pButton = S.AddButton(XXO("Open Plugin &Manager"), wxALIGN_LEFT))
       pButton->Bind(wxEVT_BUTTON, [this](auto) {
          //Adding dependency on PluginRegistrationDialog, not good. Alternatively
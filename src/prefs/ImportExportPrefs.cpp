@@ -22,6 +22,7 @@
 #include <wx/statbox.h>
 #include <wx/stattext.h>
 
+#include "Import.h"
 #include "NoteTrack.h"
 #include "Prefs.h"
 #include "ShuttleGui.h"
@@ -159,6 +160,14 @@ void ImportExportPrefs::PopulateOrExchange(ShuttleGui & S)
    }
    S.EndStatic();
 
+   S.StartStatic(XO("Uncompressed Imports"));
+   {
+      S.TieCheckBox(
+         XXO("&Read uncompressed files from the original location (faster)"),
+         ImportOnDemand);
+   }
+   S.EndStatic();
+
    S.EndScroller();
 }
 
@@ -27,6 +27,7 @@
 #include "Dither.h"
 #include "Prefs.h"
 #include "Resample.h"
+#include "SampleBlockCodec.h"
 #include "ShuttleGui.h"
 
 //////////
@@ -104,6 +105,15 @@ void QualityPrefs::PopulateOrExchange(ShuttleGui & S)
       S.EndMultiColumn();
    }
    S.EndStatic();
+
+   if (SampleBlockCodec::IsAvailable()) {
+      S.StartStatic(XO("Storage"));
+      {
+         S.TieCheckBox(XXO("Compress audio losslessly in &new projects"),
+                       SampleBlockCompression::DefaultEnabled);
+      }
+      S.EndStatic();
+   }
    S.EndScroller();
 
 }
@@ -52,6 +52,8 @@ IntSetting SpectrumFrequencyGain{
    L"/Spectrum/FrequencyGain", 0 };
 IntSetting SpectrumGain{
    L"/Spectrum/Gain", 20 };
+BoolSetting SpectrumKeepInProjectFile{
+   L"/Spectrum/KeepInProjectFile", false };
 BoolSetting SpectrumGrayscale{
    L"/Spectrum/Grayscale", false };
 IntSetting SpectrumMinFreq{
@@ -88,6 +90,7 @@ void SpectrogramSettings::Globals::SavePrefs()
 #ifdef SPECTRAL_SELECTION_GLOBAL_SWITCH
    SpectrumEnableSelection.Write(spectralSelection);
 #endif
+   SpectrumKeepInProjectFile.Write(keepInProjectFile);
 }
 
 void SpectrogramSettings::Globals::LoadPrefs()
@@ -95,6 +98,7 @@ void SpectrogramSettings::Globals::LoadPrefs()
 #ifdef SPECTRAL_SELECTION_GLOBAL_SWITCH
    spectralSelection = SpectrumEnableSelection.Read();
 #endif
+   keepInProjectFile = SpectrumKeepInProjectFile.Read();
 }
 
 SpectrogramSettings::Globals
@@ -170,7 +174,6 @@ SpectrogramSettings::SpectrogramSettings(const SpectrogramSettings &other)
 #endif
 
    // Do not copy these!
-   , hFFT{}
    , window{}
    , tWindow{}
    , dWindow{}
@@ -527,7 +530,6 @@ auto SpectrogramSettings::Clone() const -> PointerType
 
 void SpectrogramSettings::DestroyWindows()
 {
-   hFFT.reset();
    window.reset();
    dWindow.reset();
    tWindow.reset();
@@ -592,14 +594,13 @@ namespace
 
 void SpectrogramSettings::CacheWindows()
 {
-   if (hFFT == NULL || window == NULL) {
+   if (window == NULL) {
 
       double scale;
       auto factor = ZeroPaddingFactor();
       const auto fftLen = WindowSize() * factor;
       const auto padding = (WindowSize() * (factor - 1)) / 2;
 
-      hFFT = GetFFT(fftLen);
       RecreateWindow(window, WINDOW, fftLen, padding, windowType, windowSize, scale);
       if (algorithm == algReassignment) {
          RecreateWindow(tWindow, TWINDOW, fftLen, padding, windowType, windowSize, scale);
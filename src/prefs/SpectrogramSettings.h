@@ -14,12 +14,10 @@ Paul Licameli
 #include "ClientData.h" // to inherit
 #include "Prefs.h"
 #include "SampleFormat.h"
-#include "RealFFTf.h"
 
 #undef SPECTRAL_SELECTION_GLOBAL_SWITCH
 
 class EnumValueSymbols;
-struct FFTParam;
 class NumberScale;
 class SpectrumPrefs;
 class wxArrayStringEx;
@@ -44,6 +42,10 @@ public:
       bool spectralSelection;
 #endif
 
+      //! Whether to keep calculated spectrograms in project files, for
+      //! reopening them
+      bool keepInProjectFile;
+
    private:
       Globals();
       void LoadPrefs();
@@ -196,7 +198,6 @@ public:
    // Following fields are derived from preferences.
 
    // Variables used for computing the spectrum
-   HFFT           hFFT;
    Floats         window;
 
    // Two other windows for computing reassigned spectrogram
@@ -309,6 +309,15 @@ void SpectrumPrefs::PopulateOrExchange(ShuttleGui & S)
 #endif //EXPERIMENTAL_FIND_NOTES
    // S.EndStatic();
 
+   if (!mWc) {
+      S.StartStatic(XO("Project files"));
+      {
+         S.TieCheckBox(XXO("&Keep spectrograms in the project file"),
+            SpectrogramSettings::Globals::Get().keepInProjectFile);
+      }
+      S.EndStatic();
+   }
+
 #ifdef SPECTRAL_SELECTION_GLOBAL_SWITCH
    S.StartStatic(XO("Global settings"));
    {
@@ -137,6 +137,8 @@ void LabelTrackView::BindTo( LabelTrack *pParent )
          return OnLabelPermuted(e);
       case LabelTrackEvent::Selection:
          return OnSelectionChange(e);
+      case LabelTrackEvent::Replacement:
+         return OnLabelsReplaced(e);
       default:
          return;
       }
@@ -2154,6 +2156,16 @@ void LabelTrackView::OnLabelPermuted(const LabelTrackEvent &e)
    fix(mTextEditIndex);
 }
 
+void LabelTrackView::OnLabelsReplaced(const LabelTrackEvent &e)
+{
+   if (e.mpTrack.lock() != FindLabelTrack())
+      return;
+
+   // Stored indices no longer mean the same labels
+   SetNavigationIndex(-1);
+   ResetTextSelection();
+}
+
 void LabelTrackView::OnSelectionChange(const LabelTrackEvent &e)
 {
    if (e.mpTrack.lock() != FindLabelTrack())
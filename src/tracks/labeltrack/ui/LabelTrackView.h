@@ -252,6 +252,7 @@ private:
    void OnLabelAdded( const LabelTrackEvent& );
    void OnLabelDeleted( const LabelTrackEvent& );
    void OnLabelPermuted( const LabelTrackEvent& );
+   void OnLabelsReplaced( const LabelTrackEvent& );
    void OnSelectionChange( const LabelTrackEvent& );
 
    Observer::Subscription mSubscription;
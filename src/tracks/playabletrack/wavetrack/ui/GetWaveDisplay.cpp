@@ -17,6 +17,7 @@
 #include "SampleBlock.h"
 #include "SampleCount.h"
 #include "Sequence.h"
+#include "WaveformPyramid.h"
 
 namespace {
 
@@ -27,9 +28,7 @@ struct MinMaxSumsq
       min = FLT_MAX, max = -FLT_MAX, sumsq = 0.0f;
       while (count--) {
          float v;
-         switch (divisor) {
-         default:
-         case 1:
+         if (divisor == 1) {
             // array holds samples
             v = *pv++;
             if (v < min)
@@ -37,9 +36,8 @@ struct MinMaxSumsq
             if (v > max)
                max = v;
             sumsq += v * v;
-            break;
-         case 256:
-         case 65536:
+         }
+         else {
             // array holds triples of min, max, and rms values
             v = *pv++;
             if (v < min)
@@ -49,7 +47,6 @@ struct MinMaxSumsq
                max = v;
             v = *pv++;
             sumsq += v * v;
-            break;
          }
       }
    }
@@ -63,7 +60,7 @@ struct MinMaxSumsq
 
 bool GetWaveDisplay(const Sequence &sequence,
    float *min, float *max, float *rms,
-   size_t len, const sampleCount *where)
+   size_t len, const sampleCount *where, WaveformPyramid *pPyramid)
 {
    wxASSERT(len > 0);
    const auto s0 = std::max(sampleCount(0), where[0]);
@@ -121,23 +118,43 @@ bool GetWaveDisplay(const Sequence &sequence,
                 (whereNext = std::min(s1 - 1, where[nextPixel])) < nextSrcX)
             ++nextPixel;
       }
-      if (nextPixel == pixel)
+      if (nextPixel == pixel) {
          // The entire block's samples fall within one pixel column.
          // Either it's a rare odd block at the end, or else,
          // we must be really zoomed out!
-         // Omit the entire block's contents from min/max/rms
-         // calculation, which is not correct, but correctness might not
-         // be worth the compute time if this happens every pixel
-         // column. -- PRL
+         // Impute the block's own min/max/rms, kept in memory, to the
+         // previous column
+         if (b > block0 && pixel > 0) {
+            const auto values = seqBlock.sb->GetMinMaxRMS(false);
+            const int blockSamples = seqBlock.sb->GetSampleCount();
+            const int lastPixel = pixel - 1;
+            float &lastMin = min[lastPixel];
+            lastMin = std::min(lastMin, values.min);
+            float &lastMax = max[lastPixel];
+            lastMax = std::max(lastMax, values.max);
+            float &lastRms = rms[lastPixel];
+            const int lastNumSamples = lastRmsDenom * lastDivisor;
+            lastRms = sqrt(
+               (lastRms * lastRms * lastNumSamples +
+                  values.RMS * values.RMS * blockSamples) /
+               (lastNumSamples + blockSamples)
+            );
+            lastDivisor = 1;
+            lastRmsDenom = lastNumSamples + blockSamples;
+         }
          continue;
+      }
       if (nextPixel == len)
          whereNext = s1;
 
       // Decide the summary level
       const double samplesPerPixel =
          (whereNext - whereNow).as_double() / (nextPixel - pixel);
+      const int pyramidDivisor =
+         pPyramid ? WaveformPyramid::ChooseDivisor(samplesPerPixel) : 0;
       const int divisor =
-           (samplesPerPixel >= 65536) ? 65536
+           pyramidDivisor ? pyramidDivisor
+         : (samplesPerPixel >= 65536) ? 65536
          : (samplesPerPixel >= 256) ? 256
          : 1;
 
@@ -163,7 +180,11 @@ bool GetWaveDisplay(const Sequence &sequence,
       }
 
       // Read from the block file or its summary
-      switch (divisor) {
+      if (pyramidDivisor)
+         // Read triples, from memory after the first time for the block
+         pPyramid->GetSummary(
+            *seqBlock.sb, divisor, temp.get(), startPosition, num);
+      else switch (divisor) {
       default:
       case 1:
          // Read samples
@@ -14,15 +14,18 @@
 #include <cstddef>
 class Sequence;
 class sampleCount;
+class WaveformPyramid;
 
 // where is input, assumed to be nondecreasing, and its size is len + 1.
 // min, max, rms, bl are outputs, and their lengths are len.
 // Each position in the output arrays corresponds to one column of pixels.
 // The column for pixel p covers samples from
 // where[p] up to (but excluding) where[p + 1].
+// If pPyramid is not null, it supplies summaries coarser than 256 samples.
 // Return true if successful.
 bool GetWaveDisplay(const Sequence &sequence,
    float *min, float *max, float *rms,
-   size_t len, const sampleCount *where);
+   size_t len, const sampleCount *where,
+   WaveformPyramid *pPyramid = nullptr);
 
 #endif
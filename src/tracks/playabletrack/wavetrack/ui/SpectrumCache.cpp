@@ -11,37 +11,146 @@
 #include "SpectrumCache.h"
 
 #include "../../../../prefs/SpectrogramSettings.h"
-#include "RealFFTf.h"
+#include "BasicUI.h"
+#include "MemoryBudget.h"
+#include "PartialSampleBlock.h"
+#include "RealFFTPlan.h"
+#include "SampleBlock.h"
 #include "Sequence.h"
 #include "Spectrum.h"
+#include "SpectrogramTileStore.h"
 #include "WaveClipUIUtilities.h"
 #include "WaveTrack.h"
 #include "WideSampleSequence.h"
+#include "concurrency/ThreadPool.h"
+#include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <mutex>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+
+//! What calculation of the spectrum needs of SpectrogramSettings, which
+//! belong to the main thread
+struct SpectrumParameters
+{
+   explicit SpectrumParameters(const SpectrogramSettings &settings)
+      : algorithm{ settings.algorithm }
+      , windowType{ settings.windowType }
+      , windowSize{ settings.WindowSize() }
+      , zeroPaddingFactor{ settings.ZeroPaddingFactor() }
+      , nBins{ settings.NBins() }
+      , frequencyGain{ settings.frequencyGain }
+      , window{ settings.window.get() }
+      , tWindow{ settings.tWindow.get() }
+      , dWindow{ settings.dWindow.get() }
+   {
+   }
+
+   int algorithm;
+   int windowType;
+   size_t windowSize;
+   size_t zeroPaddingFactor;
+   size_t nBins;
+   int frequencyGain;
+   const float *window;
+   const float *tWindow;
+   const float *dWindow;
+};
+
+//! The samples of one channel of a clip, sharing its sample blocks, which
+//! never change, so that other threads can read them while the clip is edited
+class SpectrogramSamples
+{
+public:
+   explicit SpectrogramSamples(const WaveChannelInterval &clip)
+      : mBlocks{ clip.GetSequence().GetBlockArray() }
+      , mOffset{ clip.TimeToSamples(clip.GetTrimLeft()) }
+      , mNumSamples{ clip.GetSequence().GetNumSamples() }
+      , mRate{ clip.GetRate() }
+      , mStretchRatio{ clip.GetStretchRatio() }
+   {
+   }
+
+   sampleCount GetNumSamples() const { return mNumSamples; }
+   int GetRate() const { return mRate; }
+   double GetStretchRatio() const { return mStretchRatio; }
+
+   //! Hash of the block ids and positions, which changes with any edit
+   uint64_t GetContentKey() const;
+
+   //! Like WaveClipChannel::GetSampleView, but never throws, and is silent
+   //! past the end
+   AudioSegmentSampleView GetSampleView(sampleCount start, size_t length) const
+   {
+      start += mOffset;
+      if (start >= mNumSamples)
+         return AudioSegmentSampleView{ length };
+      length = limitSampleBufferSize(length, mNumSamples - start);
+      // The last block that starts at or before `start`
+      auto iter = std::upper_bound(mBlocks.begin(), mBlocks.end(), start,
+         [](sampleCount pos, const SeqBlock &block){
+            return pos < block.start; });
+      --iter;
+      const auto offset = (start - iter->start).as_size_t();
+      std::vector<BlockSampleView> blockViews;
+      for (auto cursor = start; cursor < start + length; ++iter) {
+         constexpr auto mayThrow = false; // Don't throw just for display
+         blockViews.push_back(iter->sb->GetFloatSampleView(mayThrow));
+         cursor = iter->start + iter->sb->GetSampleCount();
+      }
+      return { move(blockViews), offset, length };
+   }
+
+private:
+   const BlockArray mBlocks;
+   const sampleCount mOffset;
+   const sampleCount mNumSamples;
+   const int mRate;
+   const double mStretchRatio;
+};
+
+struct SpecCache::Background
+{
+   //! Changes when requests are cancelled
+   std::atomic<unsigned long long> epoch{ 0 };
+
+   struct Tile {
+      unsigned long long epoch;
+      unsigned request;
+      std::vector<sampleCount> where;
+      std::vector<float> freq;
+      //! If present, the tile goes to the store
+      std::optional<SpectrogramTileStore::Key> key;
+   };
+   std::mutex mutex;
+   std::vector<Tile> arrived;
+};
 
 namespace {
 
-static void ComputeSpectrumUsingRealFFTf
-   (float * __restrict buffer, const FFTParam *hFFT,
+static void ComputeSpectrumUsingRealFFT
+   (float * __restrict buffer, RealFFTPlan &fft,
     const float * __restrict window, size_t len, float * __restrict out)
 {
    size_t i;
-   if(len > hFFT->Points * 2)
-      len = hFFT->Points * 2;
+   const auto fftLen = fft.Size();
+   if(len > fftLen)
+      len = fftLen;
    for(i = 0; i < len; i++)
       buffer[i] *= window[i];
-   for( ; i < (hFFT->Points * 2); i++)
+   for( ; i < fftLen; i++)
       buffer[i] = 0; // zero pad as needed
-   RealFFTf(buffer, hFFT);
+   fft.Forward(buffer);
    // Handle the (real-only) DC
    float power = buffer[0] * buffer[0];
    if(power <= 0)
       out[0] = -160.0;
    else
       out[0] = 10.0 * log10f(power);
-   for(i = 1; i < hFFT->Points; i++) {
-      const int index = hFFT->BitReversed[i];
-      const float re = buffer[index], im = buffer[index + 1];
+   for(i = 1; i < fftLen / 2; i++) {
+      const float re = buffer[2 * i], im = buffer[2 * i + 1];
       power = re * re + im * im;
       if(power <= 0)
          out[i] = -160.0;
@@ -70,6 +179,80 @@ void ComputeSpectrogramGainFactors
    }
 }
 
+//! Copy of the window, for the thread pool
+struct OwnedSpectrumParameters final : SpectrumParameters
+{
+   explicit OwnedSpectrumParameters(const SpectrogramSettings &settings)
+      : SpectrumParameters{ settings }
+      , mWindow(window, window + windowSize * zeroPaddingFactor)
+   {
+      window = mWindow.data();
+      // Reassignment is not calculated in the background
+      tWindow = dWindow = nullptr;
+   }
+
+   const std::vector<float> mWindow;
+};
+
+//! FNV-1a, which unlike std::hash is the same in every session
+struct KeyHash
+{
+   template<typename T> KeyHash &operator()(T value)
+   {
+      static_assert(std::is_integral_v<T>);
+      // The same width on all platforms
+      const auto wide = static_cast<long long>(value);
+      const auto bytes = reinterpret_cast<const unsigned char*>(&wide);
+      for (size_t ii = 0; ii < sizeof(wide); ++ii)
+         result = (result ^ bytes[ii]) * 0x100000001b3ull;
+      return *this;
+   }
+   uint64_t result = 0xcbf29ce484222325ull;
+};
+
+//! Change this when the calculation changes, so that stored tiles are not
+//! used
+constexpr int StoredTileVersion = 2;
+
+SpectrogramTileStore::Key
+MakeStoreKey(const SpectrumParameters &parameters,
+   const SpectrogramSamples &samples)
+{
+   return {
+      samples.GetContentKey(),
+      KeyHash{}(StoredTileVersion)(parameters.algorithm)
+         (parameters.windowType)(parameters.windowSize)
+         (parameters.zeroPaddingFactor)(parameters.nBins)
+         (parameters.frequencyGain)(samples.GetRate())
+      .result
+   };
+}
+
+//! Columns calculated by one task of the thread pool
+constexpr size_t TileWidth = 32;
+//! No more missing columns than this are calculated at once, as when
+//! scrolling by a few pixels, which is not worth the flicker of placeholders
+constexpr size_t MaxColumnsInForeground = 2 * TileWidth;
+//! Value of columns not yet calculated, drawn in the colour of silence
+constexpr float PlaceholderValue = -160.0f;
+
+}
+
+uint64_t SpectrogramSamples::GetContentKey() const
+{
+   KeyHash hash;
+   hash(mOffset.as_long_long())(mNumSamples.as_long_long())(mBlocks.size());
+   for (const auto &block : mBlocks) {
+      // Ids of views of blocks are not kept between sessions, but those of
+      // their storage are; the key may be of tiles stored in the project
+      const auto &pStorage = PartialSampleBlock::GetStorage(block.sb);
+      hash(block.start.as_long_long())(pStorage->GetBlockID())
+         (block.sb->GetSampleCount());
+      if (const auto pView =
+         dynamic_cast<const PartialSampleBlock*>(block.sb.get()))
+         hash(pView->GetOffset())(pView->IsReversed());
+   }
+   return hash.result;
 }
 
 bool SpecCache::Matches(
@@ -92,21 +275,22 @@ bool SpecCache::Matches(
 }
 
 bool SpecCache::CalculateOneSpectrum(
-   const SpectrogramSettings& settings, const WaveChannelInterval& clip,
+   const SpectrumParameters& parameters, const SpectrogramSamples& samples,
    const int xx, double pixelsPerSecond, int lowerBoundX, int upperBoundX,
-   const std::vector<float>& gainFactors, float* __restrict scratch,
-   float* __restrict out) const
+   const std::vector<float>& gainFactors, RealFFTPlan &fft,
+   float* __restrict scratch, float* __restrict out,
+   const PowerSink *pSink) const
 {
    bool result = false;
    const bool reassignment =
-      (settings.algorithm == SpectrogramSettings::algReassignment);
-   const size_t windowSizeSetting = settings.WindowSize();
+      (parameters.algorithm == SpectrogramSettings::algReassignment);
+   const size_t windowSizeSetting = parameters.windowSize;
 
    sampleCount from;
 
-   const auto numSamples = clip.GetSequence().GetNumSamples();
-   const auto sampleRate = clip.GetRate();
-   const auto stretchRatio = clip.GetStretchRatio();
+   const auto numSamples = samples.GetNumSamples();
+   const auto sampleRate = samples.GetRate();
+   const auto stretchRatio = samples.GetStretchRatio();
    const auto samplesPerPixel = sampleRate / pixelsPerSecond / stretchRatio;
    // xx may be for a column that is out of the visible bounds, but only
    // when we are calculating reassignment contributions that may cross into
@@ -120,14 +304,15 @@ bool SpecCache::CalculateOneSpectrum(
       from = where[xx];
 
    const bool autocorrelation =
-      settings.algorithm == SpectrogramSettings::algPitchEAC;
-   const size_t zeroPaddingFactorSetting = settings.ZeroPaddingFactor();
+      parameters.algorithm == SpectrogramSettings::algPitchEAC;
+   const size_t zeroPaddingFactorSetting = parameters.zeroPaddingFactor;
    const size_t padding = (windowSizeSetting * (zeroPaddingFactorSetting - 1)) / 2;
    const size_t fftLen = windowSizeSetting * zeroPaddingFactorSetting;
-   auto nBins = settings.NBins();
+   auto nBins = parameters.nBins;
 
    if (from < 0 || from >= numSamples) {
-      if (xx >= 0 && xx < (int)len) {
+      // A sink is zeroed already
+      if (!pSink && xx >= 0 && xx < (int)len) {
          // Pixel column is out of bounds of the clip!  Should not happen.
          float *const results = &out[nBins * xx];
          std::fill(results, results + nBins, 0.0f);
@@ -167,12 +352,11 @@ bool SpecCache::CalculateOneSpectrum(
          }
 
          if (myLen > 0) {
-            constexpr auto iChannel = 0u;
-            constexpr auto mayThrow = false; // Don't throw just for display
-            mSampleCacheHolder.emplace(
-               clip.GetSampleView(from, myLen, mayThrow));
+            // Local, because threads of the pool calculate columns of one
+            // cache at once for reassignment
+            const auto view = samples.GetSampleView(from, myLen);
             floats.resize(myLen);
-            mSampleCacheHolder->Copy(floats.data(), myLen);
+            view.Copy(floats.data(), myLen);
             useBuffer = floats.data();
             if (copy) {
                if (useBuffer)
@@ -193,11 +377,11 @@ bool SpecCache::CalculateOneSpectrum(
          // This function does not mutate useBuffer
          ComputeSpectrum(
             useBuffer, windowSizeSetting, windowSizeSetting, results,
-            autocorrelation, settings.windowType);
+            autocorrelation, parameters.windowType);
       }
       else if (reassignment) {
          static const double epsilon = 1e-16;
-         const auto hFFT = settings.hFFT.get();
+         const auto half = fftLen / 2;
 
          float *const scratch2 = scratch + fftLen;
          std::copy(scratch, scratch2, scratch2);
@@ -206,87 +390,90 @@ bool SpecCache::CalculateOneSpectrum(
          std::copy(scratch, scratch2, scratch3);
 
          {
-            const float *const window = settings.window.get();
+            const float *const window = parameters.window;
             for (size_t ii = 0; ii < fftLen; ++ii)
                scratch[ii] *= window[ii];
-            RealFFTf(scratch, hFFT);
+            fft.Forward(scratch);
          }
 
          {
-            const float *const dWindow = settings.dWindow.get();
+            const float *const dWindow = parameters.dWindow;
             for (size_t ii = 0; ii < fftLen; ++ii)
                scratch2[ii] *= dWindow[ii];
-            RealFFTf(scratch2, hFFT);
+            fft.Forward(scratch2);
          }
 
          {
-            const float *const tWindow = settings.tWindow.get();
+            const float *const tWindow = parameters.tWindow;
             for (size_t ii = 0; ii < fftLen; ++ii)
                scratch3[ii] *= tWindow[ii];
-            RealFFTf(scratch3, hFFT);
+            fft.Forward(scratch3);
          }
 
-         for (size_t ii = 0; ii < hFFT->Points; ++ii) {
-            const int index = hFFT->BitReversed[ii];
+         // Complex quotients for all the bins at once, in arrays, so that
+         // the compiler can vectorize; bins are scattered after
+         float *const powers = scratch + 3 * fftLen;
+         float *const bins = powers + half;
+         float *const timeCorrections = bins + half;
+         {
+            // DC is real; the Fs/2 bin is in place of its imaginary part
+            const float denomRe = scratch[0];
+            powers[0] = denomRe * denomRe;
+            bins[0] = 0;
+            timeCorrections[0] = scratch3[0] * denomRe / powers[0];
+         }
+         const float multiplier = -(fftLen / (2.0f * M_PI));
+         for (size_t ii = 1; ii < half; ++ii) {
+            const auto index = 2 * ii;
             const float
-               denomRe = scratch[index],
-               denomIm = ii == 0 ? 0 : scratch[index + 1];
-            const double power = denomRe * denomRe + denomIm * denomIm;
+               denomRe = scratch[index], denomIm = scratch[index + 1],
+               numRe = scratch2[index], numIm = scratch2[index + 1],
+               tNumRe = scratch3[index], tNumIm = scratch3[index + 1];
+            const float power = denomRe * denomRe + denomIm * denomIm;
+            powers[ii] = power;
+            // Find complex quotient --
+            // Which means, multiply numerator by conjugate of denominator,
+            // then divide by norm squared of denominator --
+            // Then just take its imaginary part.
+            // With appropriate multiplier, that becomes the correction of
+            // the frequency bin.
+            const float quotIm = (-numRe * denomIm + numIm * denomRe) / power;
+            bins[ii] = ii + multiplier * quotIm + 0.5f;
+            // Find another complex quotient --
+            // Then just take its real part.
+            // The result has sample interval as unit.
+            timeCorrections[ii] = (tNumRe * denomRe + tNumIm * denomIm) / power;
+         }
+
+         const double pixelsPerSample = pixelsPerSecond / sampleRate;
+         for (size_t ii = 0; ii < half; ++ii) {
+            const float power = powers[ii];
             if (power < epsilon)
-               // Avoid dividing by near-zero below
+               // The quotients divided by near-zero
                continue;
 
-            double freqCorrection;
-            {
-               const double multiplier = -(fftLen / (2.0f * M_PI));
-               const float
-                  numRe = scratch2[index],
-                  numIm = ii == 0 ? 0 : scratch2[index + 1];
-               // Find complex quotient --
-               // Which means, multiply numerator by conjugate of denominator,
-               // then divide by norm squared of denominator --
-               // Then just take its imaginary part.
-               const double
-                  quotIm = (-numRe * denomIm + numIm * denomRe) / power;
-               // With appropriate multiplier, that becomes the correction of
-               // the frequency bin.
-               freqCorrection = multiplier * quotIm;
-            }
-
-            const int bin = (int)((int)ii + freqCorrection + 0.5f);
+            const int bin = (int)bins[ii];
             // Must check if correction takes bin out of bounds, above or below!
             // bin is signed!
-            if (bin >= 0 && bin < (int)hFFT->Points) {
-               double timeCorrection;
-               {
-                  const float
-                     numRe = scratch3[index],
-                     numIm = ii == 0 ? 0 : scratch3[index + 1];
-                  // Find another complex quotient --
-                  // Then just take its real part.
-                  // The result has sample interval as unit.
-                  timeCorrection =
-                     (numRe * denomRe + numIm * denomIm) / power;
-               }
-
+            if (bin >= 0 && bin < (int)half) {
                // PRL: timeCorrection is scaled to the clip's raw sample rate,
                // without the stretching ratio correction for real time. We want
                // to find the correct X coordinate for that.
                int correctedX = (floor(
-                  0.5 + xx + timeCorrection * pixelsPerSecond / sampleRate));
+                  0.5 + xx + timeCorrections[ii] * pixelsPerSample));
                if (correctedX >= lowerBoundX && correctedX < upperBoundX)
                {
                   result = true;
 
                   // This is non-negative, because bin and correctedX are
-                  auto ind = (int)nBins * correctedX + bin;
-#ifdef _OPENMP
-                  // This assignment can race if index reaches into another thread's bins.
-                  // The probability of a race very low, so this carries little overhead,
-                  // about 5% slower vs allowing it to race.
-                  #pragma omp atomic update
-#endif
-                  out[ind] += power;
+                  const auto ind = nBins * correctedX + bin;
+                  if (!pSink)
+                     out[ind] += power;
+                  else if (correctedX >= pSink->begin &&
+                           correctedX < pSink->end)
+                     pSink->values[ind - nBins * pSink->begin] += power;
+                  else
+                     pSink->pSpill->emplace_back(ind, power);
                }
             }
          }
@@ -302,8 +489,8 @@ bool SpecCache::CalculateOneSpectrum(
          // the part of useBuffer in the padding zones.
 
          // This function mutates useBuffer
-         ComputeSpectrumUsingRealFFTf
-            (useBuffer, settings.hFFT.get(), settings.window.get(), fftLen, results);
+         ComputeSpectrumUsingRealFFT
+            (useBuffer, fft, parameters.window, fftLen, results);
          if (!gainFactors.empty()) {
             // Apply a frequency-dependent gain factor
             for (size_t ii = 0; ii < nBins; ++ii)
@@ -329,6 +516,8 @@ void SpecCache::Grow(
    // Sample counts corresponding to the columns, and to one past the end.
    where.resize(len_ + 1);
 
+   columnStates.resize(len_, Missing);
+
    len = len_;
    algorithm = settings.algorithm;
    spp = samplesPerPixel;
@@ -343,23 +532,34 @@ void SpecCache::Populate(
    const SpectrogramSettings& settings, const WaveChannelInterval& clip,
    int copyBegin, int copyEnd, size_t numPixels, double pixelsPerSecond)
 {
-   const auto sampleRate = clip.GetRate();
-   const int &frequencyGainSetting = settings.frequencyGain;
-   const size_t windowSizeSetting = settings.WindowSize();
+   DoPopulate(SpectrumParameters{ settings }, SpectrogramSamples{ clip },
+      copyBegin, copyEnd, numPixels, pixelsPerSecond);
+}
+
+void SpecCache::DoPopulate(
+   const SpectrumParameters& parameters, const SpectrogramSamples& samples,
+   int copyBegin, int copyEnd, size_t numPixels, double pixelsPerSecond)
+{
+   const auto sampleRate = samples.GetRate();
+   const int &frequencyGainSetting = parameters.frequencyGain;
+   const size_t windowSizeSetting = parameters.windowSize;
    const bool autocorrelation =
-      settings.algorithm == SpectrogramSettings::algPitchEAC;
+      parameters.algorithm == SpectrogramSettings::algPitchEAC;
    const bool reassignment =
-      settings.algorithm == SpectrogramSettings::algReassignment;
-   const size_t zeroPaddingFactorSetting = settings.ZeroPaddingFactor();
+      parameters.algorithm == SpectrogramSettings::algReassignment;
+   const size_t zeroPaddingFactorSetting = parameters.zeroPaddingFactor;
 
    // FFT length may be longer than the window of samples that affect results
    // because of zero padding done for increased frequency resolution
    const size_t fftLen = windowSizeSetting * zeroPaddingFactorSetting;
-   const auto nBins = settings.NBins();
+   const auto nBins = parameters.nBins;
 
    const size_t bufferSize = fftLen;
-   const size_t scratchSize = reassignment ? 3 * bufferSize : bufferSize;
-   std::vector<float> scratch(scratchSize);
+   const size_t scratchSize =
+      reassignment ? 3 * bufferSize + 3 * (bufferSize / 2) : bufferSize;
+   // Aligned, so that the transform does not copy
+   PffftFloatVector scratch(scratchSize);
+   RealFFTPlan fft{ fftLen };
 
    std::vector<float> gainFactors;
    if (!autocorrelation)
@@ -372,40 +572,14 @@ void SpecCache::Populate(
       const int lowerBoundX = jj == 0 ? 0 : copyEnd;
       const int upperBoundX = jj == 0 ? copyBegin : numPixels;
 
-// todo(mhodgkinson): I don't find an option to define _OPENMP anywhere. Is this
-// still of interest?
-#ifdef _OPENMP
-      // Storage for mutable per-thread data.
-      // private clause ensures one copy per thread
-      struct ThreadLocalStorage {
-         ThreadLocalStorage()  { }
-         ~ThreadLocalStorage() { }
-
-         void init(SampleTrackCache &waveTrackCache, size_t scratchSize) {
-            if (!cache) {
-               cache = std::make_unique<SampleTrackCache>(waveTrackCache.GetTrack());
-               scratch.resize(scratchSize);
-            }
-         }
-         std::unique_ptr<SampleTrackCache> cache;
-         std::vector<float> scratch;
-      } tls;
-
-      #pragma omp parallel for private(tls)
-#endif
-      for (auto xx = lowerBoundX; xx < upperBoundX; ++xx)
-      {
-#ifdef _OPENMP
-         tls.init(waveTrackCache, scratchSize);
-         SampleTrackCache& cache = *tls.cache;
-         float* buffer = &tls.scratch[0];
-#else
-         float* buffer = &scratch[0];
-#endif
-         CalculateOneSpectrum(
-            settings, clip, xx, pixelsPerSecond, lowerBoundX, upperBoundX,
-            gainFactors, buffer, &freq[0]);
-      }
+      if (reassignment)
+         PopulateReassigned(parameters, samples, lowerBoundX, upperBoundX,
+            pixelsPerSecond, gainFactors, scratchSize);
+      else
+         for (auto xx = lowerBoundX; xx < upperBoundX; ++xx)
+            CalculateOneSpectrum(
+               parameters, samples, xx, pixelsPerSecond, lowerBoundX,
+               upperBoundX, gainFactors, fft, &scratch[0], &freq[0]);
 
       if (reassignment) {
          // Need to look beyond the edges of the range to accumulate more
@@ -413,13 +587,13 @@ void SpecCache::Populate(
          // I'm not sure what's a good stopping criterion?
          auto xx = lowerBoundX;
          const double pixelsPerSample =
-            pixelsPerSecond * clip.GetStretchRatio() / sampleRate;
+            pixelsPerSecond * samples.GetStretchRatio() / sampleRate;
          const int limit = std::min((int)(0.5 + fftLen * pixelsPerSample), 100);
          for (int ii = 0; ii < limit; ++ii)
          {
             const bool result = CalculateOneSpectrum(
-               settings, clip, --xx, pixelsPerSecond, lowerBoundX, upperBoundX,
-               gainFactors, &scratch[0], &freq[0]);
+               parameters, samples, --xx, pixelsPerSecond, lowerBoundX, upperBoundX,
+               gainFactors, fft, &scratch[0], &freq[0]);
             if (!result)
                break;
          }
@@ -428,8 +602,8 @@ void SpecCache::Populate(
          for (int ii = 0; ii < limit; ++ii)
          {
             const bool result = CalculateOneSpectrum(
-               settings, clip, xx++, pixelsPerSecond, lowerBoundX, upperBoundX,
-               gainFactors, &scratch[0], &freq[0]);
+               parameters, samples, xx++, pixelsPerSecond, lowerBoundX, upperBoundX,
+               gainFactors, fft, &scratch[0], &freq[0]);
             if (!result)
                break;
          }
@@ -455,17 +629,313 @@ void SpecCache::Populate(
             }
          }
       }
+
+      std::fill(columnStates.begin() + lowerBoundX,
+         columnStates.begin() + upperBoundX, Ready);
+   }
+}
+
+void SpecCache::PopulateReassigned(
+   const SpectrumParameters& parameters, const SpectrogramSamples& samples,
+   int lowerBoundX, int upperBoundX, double pixelsPerSecond,
+   const std::vector<float>& gainFactors, size_t scratchSize)
+{
+   if (upperBoundX <= lowerBoundX)
+      return;
+
+   const auto nBins = parameters.nBins;
+   const size_t fftLen = parameters.windowSize * parameters.zeroPaddingFactor;
+   // Power moves by no more columns than the window spans, unless the
+   // quotients are ill-conditioned, so each range of columns sums into a
+   // buffer only so much wider, and the rest is spilled
+   const int margin =
+      1 + static_cast<int>(fftLen * pixelsPerSecond / samples.GetRate());
+
+   struct Range {
+      int first, last;
+      std::vector<float> values;
+      std::vector<std::pair<size_t, float>> spill;
+      PowerSink sink;
+   };
+   auto calculate = [&](Range &range) {
+      range.values.resize(nBins * (range.sink.end - range.sink.begin));
+      range.sink.values = range.values.data();
+      range.sink.pSpill = &range.spill;
+      PffftFloatVector scratch(scratchSize);
+      RealFFTPlan fft{ fftLen };
+      for (auto xx = range.first; xx < range.last; ++xx)
+         CalculateOneSpectrum(
+            parameters, samples, xx, pixelsPerSecond, lowerBoundX,
+            upperBoundX, gainFactors, fft, scratch.data(), nullptr,
+            &range.sink);
+   };
+
+   auto &pool = audacity::concurrency::ThreadPool::GetDefault();
+   const auto nThreads =
+      pool.IsWorkerThread() ? 1 : pool.GetThreadsCount() + 1;
+   const auto width = upperBoundX - lowerBoundX;
+   const auto nRanges = std::max(1, std::min<int>(nThreads, width / TileWidth));
+   std::vector<Range> ranges(nRanges);
+   for (int ii = 0; ii < nRanges; ++ii) {
+      auto &range = ranges[ii];
+      range.first = lowerBoundX + width * ii / nRanges;
+      range.last = lowerBoundX + width * (ii + 1) / nRanges;
+      range.sink.begin = std::max(lowerBoundX, range.first - margin);
+      range.sink.end = std::min(upperBoundX, range.last + margin);
+   }
+
+   pool.ParallelFor(nRanges, [&](size_t ii){ calculate(ranges[ii]); });
+
+   // Sum up in a fixed order, so that the result does not depend on timing
+   for (const auto &range : ranges) {
+      float *const dest = &freq[nBins * range.sink.begin];
+      for (size_t ii = 0; ii < range.values.size(); ++ii)
+         dest[ii] += range.values[ii];
+      for (const auto &[ind, power] : range.spill)
+         freq[ind] += power;
+   }
+}
+
+bool SpecCache::PopulateInBackground(
+   const SpectrogramSettings& settings, const WaveChannelInterval& clip,
+   double pixelsPerSecond, std::function<void()> onArrival,
+   SpectrogramTileStore *pStore)
+{
+   assert(settings.algorithm != SpectrogramSettings::algReassignment);
+   auto numMissing = static_cast<size_t>(
+      std::count(columnStates.begin(), columnStates.end(), Missing));
+   if (numMissing == 0)
+      return false;
+
+   const auto pSamples = std::make_shared<const SpectrogramSamples>(clip);
+   const auto nBins = settings.NBins();
+   std::optional<SpectrogramTileStore::Key> key;
+   if (pStore) {
+      key = MakeStoreKey(SpectrumParameters{ settings }, *pSamples);
+      const auto first =
+         std::find(columnStates.begin(), columnStates.end(), Missing);
+      const auto last =
+         std::find(columnStates.rbegin(), columnStates.rend(), Missing);
+      const auto whereEnd = where.begin() + len;
+      const auto tiles = pStore->Load(*key,
+         where[first - columnStates.begin()].as_long_long(),
+         where[columnStates.rend() - last - 1].as_long_long(),
+         [&](SpectrogramTileStore::Position position){
+            const auto [begin, end] = std::equal_range(
+               where.begin(), whereEnd, sampleCount{ position });
+            return std::any_of(begin, end, [&](const sampleCount &pos){
+               return columnStates[&pos - where.data()] == Missing; });
+         });
+      for (const auto &tile : tiles) {
+         if (tile.values.size() != nBins * tile.positions.size())
+            continue;
+         const std::vector<sampleCount> positions(
+            tile.positions.begin(), tile.positions.end());
+         numMissing -=
+            FillColumns(positions, tile.values.data(), nBins, Missing);
+      }
+      if (numMissing == 0)
+         return true;
    }
+
+   // Runs of missing columns, no wider than a tile
+   const auto nextTile = [&](size_t begin) {
+      while (begin < len && columnStates[begin] != Missing)
+         ++begin;
+      auto end = begin;
+      while (end < len && end - begin < TileWidth &&
+             columnStates[end] == Missing)
+         ++end;
+      return std::pair{ begin, end };
+   };
+
+   if (numMissing <= MaxColumnsInForeground) {
+      const SpectrumParameters parameters{ settings };
+      for (auto [begin, end] = nextTile(0); begin < len;
+           std::tie(begin, end) = nextTile(end))
+         // Calculate [begin, end), as if the rest were copied
+         DoPopulate(parameters, *pSamples, 0, begin, end, pixelsPerSecond);
+      return true;
+   }
+
+   if (!mBackground)
+      mBackground = std::make_shared<Background>();
+   const auto epoch = mBackground->epoch.load();
+   const auto pParameters =
+      std::make_shared<const OwnedSpectrumParameters>(settings);
+   auto &pool = audacity::concurrency::ThreadPool::GetDefault();
+   for (auto [begin, end] = nextTile(0); begin < len;
+        std::tie(begin, end) = nextTile(end)) {
+      const auto request = mNextRequest++;
+      mPendingRequests.insert(request);
+      std::fill(columnStates.begin() + begin, columnStates.begin() + end,
+         request);
+      std::fill(freq.begin() + nBins * begin, freq.begin() + nBins * end,
+         PlaceholderValue);
+      std::vector<sampleCount> positions(
+         where.begin() + begin, where.begin() + end);
+      pool.Post([
+         wBackground = std::weak_ptr<Background>{ mBackground },
+         epoch, request, pParameters, pSamples,
+         positions = move(positions), pixelsPerSecond, onArrival, key
+      ]() mutable {
+         const auto pBackground = wBackground.lock();
+         if (!pBackground || pBackground->epoch.load() != epoch)
+            // Cancelled
+            return;
+         SpecCache tile;
+         tile.len = positions.size();
+         tile.where = positions;
+         tile.where.push_back(positions.back());
+         tile.freq.resize(tile.len * pParameters->nBins);
+         tile.columnStates.resize(tile.len);
+         tile.DoPopulate(
+            *pParameters, *pSamples, 0, 0, tile.len, pixelsPerSecond);
+         {
+            std::lock_guard<std::mutex> lock{ pBackground->mutex };
+            pBackground->arrived.push_back(
+               { epoch, request, move(positions), move(tile.freq), key });
+         }
+         BasicUI::CallAfter(onArrival);
+      });
+   }
+   return true;
+}
+
+bool SpecCache::ReceiveColumns(SpectrogramTileStore *pStore)
+{
+   if (!mBackground)
+      return false;
+   std::vector<Background::Tile> tiles;
+   {
+      std::lock_guard<std::mutex> lock{ mBackground->mutex };
+      tiles.swap(mBackground->arrived);
+   }
+   if (tiles.empty())
+      return false;
+
+   const auto epoch = mBackground->epoch.load();
+   bool received = false;
+   for (auto &tile : tiles) {
+      if (tile.epoch != epoch)
+         continue;
+      mPendingRequests.erase(tile.request);
+      const auto nBins = tile.freq.size() / tile.where.size();
+      if (FillColumns(tile.where, tile.freq.data(), nBins, tile.request) > 0)
+         received = true;
+      if (pStore && tile.key) {
+         std::vector<SpectrogramTileStore::Position> positions;
+         for (const auto &position : tile.where)
+            positions.push_back(position.as_long_long());
+         pStore->Store(*tile.key, { move(positions), move(tile.freq) });
+      }
+   }
+
+   // Columns that no pending tile will fill must be requested again
+   for (auto &state : columnStates)
+      if (state != Ready && state != Missing &&
+          mPendingRequests.count(state) == 0)
+         state = Missing;
+
+   return received;
+}
+
+size_t SpecCache::FillColumns(const std::vector<sampleCount> &positions,
+   const float *values, size_t nBins, unsigned state)
+{
+   const auto whereEnd = where.begin() + len;
+   size_t filled = 0;
+   for (size_t ii = 0; ii < positions.size(); ++ii) {
+      // Find columns by sample position, which stays the same as the
+      // cache scrolls
+      const auto [first, last] =
+         std::equal_range(where.begin(), whereEnd, positions[ii]);
+      for (auto iter = first; iter != last; ++iter) {
+         const auto xx = iter - where.begin();
+         if (columnStates[xx] != state)
+            continue;
+         std::copy_n(values + nBins * ii, nBins, freq.begin() + nBins * xx);
+         columnStates[xx] = Ready;
+         ++filled;
+      }
+   }
+   return filled;
+}
+
+void SpecCache::CancelColumns()
+{
+   if (mBackground)
+      ++mBackground->epoch;
+   mPendingRequests.clear();
+   std::fill(columnStates.begin(), columnStates.end(), Missing);
+}
+
+void SpecCache::MoveColumns(
+   size_t numPixels, int copyBegin, int copyEnd, int oldX0)
+{
+   std::vector<unsigned> states(numPixels, Missing);
+   for (auto xx = copyBegin; xx < copyEnd; ++xx)
+      if (xx + oldX0 >= 0 && xx + oldX0 < (int)columnStates.size())
+         states[xx] = columnStates[xx + oldX0];
+   columnStates.swap(states);
+}
+
+namespace {
+// Guards the set of caches, not their contents
+std::mutex &InstancesMutex()
+{
+   static std::mutex mutex;
+   return mutex;
+}
+
+std::vector<WaveClipSpectrumCache*> &Instances()
+{
+   static std::vector<WaveClipSpectrumCache*> instances;
+   return instances;
+}
+
+unsigned long long sUses = 0;
+
+// Recalculated with transforms, unless the tile store has the columns
+MemoryBudget::Consumer sConsumer{ "Spectrogram caches", 30,
+   []{
+      std::lock_guard<std::mutex> lock{ InstancesMutex() };
+      size_t bytes = 0;
+      for (auto pCache : Instances())
+         bytes += pCache->GetMemory();
+      return bytes;
+   },
+   [](size_t bytes){
+      std::lock_guard<std::mutex> lock{ InstancesMutex() };
+      auto instances = Instances();
+      std::sort(instances.begin(), instances.end(),
+         [](auto pCache1, auto pCache2){
+            return pCache1->mLastUse < pCache2->mLastUse; });
+      size_t freed = 0;
+      for (auto pCache : instances) {
+         if (freed >= bytes)
+            break;
+         freed += pCache->Evict();
+      }
+      return freed;
+   }
+};
 }
 
 bool WaveClipSpectrumCache::GetSpectrogram(
    const WaveChannelInterval &clip,
    const float*& spectrogram, SpectrogramSettings& settings,
    const sampleCount*& where, size_t numPixels, double t0,
-   double pixelsPerSecond)
-
+   double pixelsPerSecond, std::function<void()> onArrival,
+   SpectrogramTileStore *pStore)
 {
    auto &mSpecCache = mSpecCaches[clip.GetChannelIndex()];
+   mLastUse = ++sUses;
+
+   // Reassignment accumulates across columns, and so is not tiled
+   const bool inBackground = onArrival &&
+      settings.algorithm != SpectrogramSettings::algReassignment;
+   bool updated = mSpecCache->ReceiveColumns(pStore);
 
    const auto sampleRate = clip.GetRate();
    const auto stretchRatio = clip.GetStretchRatio();
@@ -480,10 +950,17 @@ bool WaveClipSpectrumCache::GetSpectrogram(
 
    if (match && mSpecCache->start == t0 && mSpecCache->len >= numPixels)
    {
+      if (inBackground) {
+         // Request again any columns that tiles did not fill
+         settings.CacheWindows();
+         updated = mSpecCache->PopulateInBackground(
+            settings, clip, pixelsPerSecond, move(onArrival), pStore) ||
+            updated;
+      }
       spectrogram = &mSpecCache->freq[0];
       where = &mSpecCache->where[0];
 
-      return false;  //hit cache completely
+      return updated;  //hit cache completely, but for arrivals
    }
 
    // Caching is not implemented for reassignment, unless for
@@ -503,6 +980,10 @@ bool WaveClipSpectrumCache::GetSpectrogram(
       mSpecCache = std::make_unique<SpecCache>();
    }
 
+   if (!match)
+      // Tiles being calculated are for other settings or samples
+      mSpecCache->CancelColumns();
+
    int oldX0 = 0;
    double correction = 0.0;
 
@@ -521,6 +1002,7 @@ bool WaveClipSpectrumCache::GetSpectrogram(
    }
 
    // Resize the cache, keep the contents unchanged.
+   mSpecCache->MoveColumns(numPixels, copyBegin, copyEnd, oldX0);
    mSpecCache->Grow(numPixels, settings, samplesPerPixel, t0);
    mSpecCache->leftTrim = clip.GetTrimLeft();
    mSpecCache->rightTrim = clip.GetTrimRight();
@@ -562,8 +1044,12 @@ bool WaveClipSpectrumCache::GetSpectrogram(
       mSpecCache->where, numPixels, addBias, correction, t0, sampleRate,
       stretchRatio, samplesPerPixel);
 
-   mSpecCache->Populate(
-      settings, clip, copyBegin, copyEnd, numPixels, pixelsPerSecond);
+   if (inBackground)
+      mSpecCache->PopulateInBackground(
+         settings, clip, pixelsPerSecond, move(onArrival), pStore);
+   else
+      mSpecCache->Populate(
+         settings, clip, copyBegin, copyEnd, numPixels, pixelsPerSecond);
 
    mSpecCache->dirty = mDirty;
    spectrogram = &mSpecCache->freq[0];
@@ -578,10 +1064,16 @@ WaveClipSpectrumCache::WaveClipSpectrumCache(size_t nChannels)
 {
    for (auto &pCache : mSpecCaches)
       pCache = std::make_unique<SpecCache>();
+   std::lock_guard<std::mutex> lock{ InstancesMutex() };
+   Instances().push_back(this);
 }
 
 WaveClipSpectrumCache::~WaveClipSpectrumCache()
 {
+   std::lock_guard<std::mutex> lock{ InstancesMutex() };
+   auto &instances = Instances();
+   instances.erase(
+      std::remove(instances.begin(), instances.end(), this), instances.end());
 }
 
 std::unique_ptr<WaveClipListener> WaveClipSpectrumCache::Clone() const
@@ -636,3 +1128,29 @@ void WaveClipSpectrumCache::Erase(size_t index)
    if (index < mSpecPxCaches.size())
       mSpecPxCaches.erase(mSpecPxCaches.begin() + index);
 }
+
+size_t WaveClipSpectrumCache::GetMemory() const
+{
+   size_t bytes = 0;
+   for (auto &pCache : mSpecCaches)
+      if (pCache)
+         bytes += sizeof(SpecCache) +
+            pCache->freq.capacity() * sizeof(float) +
+            pCache->where.capacity() * sizeof(sampleCount) +
+            pCache->columnStates.capacity() * sizeof(unsigned);
+   for (auto &pPxCache : mSpecPxCaches)
+      if (pPxCache)
+         bytes += sizeof(SpecPxCache) + pPxCache->len * sizeof(float);
+   return bytes;
+}
+
+size_t WaveClipSpectrumCache::Evict()
+{
+   const auto bytes = GetMemory();
+   // Tiles that the thread pool still calculates are dropped, as when
+   // settings change
+   Invalidate();
+   for (auto &pPxCache : mSpecPxCaches)
+      pPxCache.reset();
+   return bytes - std::min(bytes, GetMemory());
+}
@@ -11,12 +11,18 @@
 #ifndef __AUDACITY_WAVECLIP_SPECTRUM_CACHE__
 #define __AUDACITY_WAVECLIP_SPECTRUM_CACHE__
 
+class RealFFTPlan;
 class sampleCount;
+class SpectrogramSamples;
 class SpectrogramSettings;
+class SpectrogramTileStore;
+struct SpectrumParameters;
 class WaveClipChannel;
 using WaveChannelInterval = WaveClipChannel;
 class WideSampleSequence;
 
+#include <functional>
+#include <set>
 #include <vector>
 #include "MemoryX.h"
 #include "WaveClip.h" // to inherit WaveClipListener
@@ -55,6 +61,35 @@ public:
       const SpectrogramSettings& settings, const WaveChannelInterval& clip,
       int copyBegin, int copyEnd, size_t numPixels, double pixelsPerSecond);
 
+   //! Calculate the columns neither calculated nor requested yet; when there
+   //! are many, load what the store has of them, then request the rest in
+   //! tiles from the default thread pool and fill them with placeholders
+   //! meanwhile
+   /*!
+    @pre `settings.algorithm != SpectrogramSettings::algReassignment`
+    @param onArrival called on the main thread whenever a tile is ready for
+    `ReceiveColumns`
+    @param pStore if not null, where tiles are loaded from, and later stored
+    */
+   //! @return whether any column changed
+   bool PopulateInBackground(
+      const SpectrogramSettings& settings, const WaveChannelInterval& clip,
+      double pixelsPerSecond, std::function<void()> onArrival,
+      SpectrogramTileStore *pStore = nullptr);
+
+   //! Copy into the cache the columns that the thread pool calculated
+   //! @param pStore if not null, receives the tiles that were requested with
+   //! it
+   //! @return whether there were any
+   bool ReceiveColumns(SpectrogramTileStore *pStore = nullptr);
+
+   //! Drop the requests, as for a change of settings
+   void CancelColumns();
+
+   //! Shift the states of columns as `freq` is shifted when scrolling, and
+   //! mark the others as not calculated
+   void MoveColumns(size_t numPixels, int copyBegin, int copyEnd, int oldX0);
+
    size_t       len { 0 }; // counts pixels, not samples
    int          algorithm;
    double       spp; // samples per pixel
@@ -70,15 +105,58 @@ public:
 
    int          dirty;
 
+   //! For each column, `Missing`, `Ready`, or the number of the request for
+   //! its tile
+   std::vector<unsigned> columnStates;
+   static constexpr unsigned Missing = 0, Ready = 1;
+
 private:
+   struct Background;
+
+   void DoPopulate(
+      const SpectrumParameters& parameters, const SpectrogramSamples& samples,
+      int copyBegin, int copyEnd, size_t numPixels, double pixelsPerSecond);
+
+   //! Copy columns of a tile into those in the given state at the same sample
+   //! positions, and make them `Ready`
+   //! @return how many columns were filled
+   size_t FillColumns(const std::vector<sampleCount> &positions,
+      const float *values, size_t nBins, unsigned state);
+
+   //! Where one thread sums the reassigned power of columns
+   struct PowerSink {
+      //! nBins values for each column from begin to end
+      float *values;
+      int begin, end;
+      //! Receives indices into `freq` and power for other columns
+      std::vector<std::pair<size_t, float>> *pSpill;
+   };
+
    // Calculate one column of the spectrum
+   /*!
+    @param scratch 3 * fftLen + 3 * (fftLen / 2) floats for reassignment,
+    else fftLen
+    @param pSink if not null, receives reassigned power instead of `out`
+    */
    bool CalculateOneSpectrum(
-      const SpectrogramSettings& settings, const WaveChannelInterval &clip,
+      const SpectrumParameters& parameters, const SpectrogramSamples &samples,
       const int xx, double pixelsPerSecond, int lowerBoundX, int upperBoundX,
-      const std::vector<float>& gainFactors, float* __restrict scratch,
-      float* __restrict out) const;
-
-   mutable std::optional<AudioSegmentSampleView> mSampleCacheHolder;
+      const std::vector<float>& gainFactors, RealFFTPlan &fft,
+      float* __restrict scratch, float* __restrict out,
+      const PowerSink *pSink = nullptr) const;
+
+   //! Sum the reassigned power of columns from lowerBoundX to upperBoundX
+   //! with the thread pool
+   void PopulateReassigned(
+      const SpectrumParameters& parameters, const SpectrogramSamples& samples,
+      int lowerBoundX, int upperBoundX, double pixelsPerSecond,
+      const std::vector<float>& gainFactors, size_t scratchSize);
+
+   //! Shared with the tasks in the thread pool
+   std::shared_ptr<Background> mBackground;
+   //! Requests whose tiles were not yet received
+   std::set<unsigned> mPendingRequests;
+   unsigned mNextRequest{ Ready + 1 };
 };
 
 class SpecPxCache {
@@ -102,6 +180,8 @@ public:
    int maxFreq;
 };
 
+//! Registered as a consumer of the MemoryBudget; caches are used, measured,
+//! and evicted only on the main thread, but may be made and destroyed on others
 struct WaveClipSpectrumCache final : WaveClipListener
 {
    explicit WaveClipSpectrumCache(size_t nChannels);
@@ -124,15 +204,31 @@ struct WaveClipSpectrumCache final : WaveClipListener
    // > only the 0th channel of sequence is really used
    // > In the interim, this still works correctly for WideSampleSequence backed
    // > by a right channel track, which always ignores its partner.
+   // If `onArrival` is not null, it may be called later on the main thread,
+   // when columns calculated in the background are ready for another call.
+   // Those columns are also kept in `pStore`, if it is not null.
    bool GetSpectrogram(const WaveChannelInterval &clip,
       const float *&spectrogram,
       SpectrogramSettings &spectrogramSettings,
       const sampleCount *&where, size_t numPixels,
-      double t0 /*absolute time*/, double pixelsPerSecond);
+      double t0 /*absolute time*/, double pixelsPerSecond,
+      std::function<void()> onArrival = {},
+      SpectrogramTileStore *pStore = nullptr);
 
    void MakeStereo(WaveClipListener &&other, bool aligned) override;
    void SwapChannels() override;
    void Erase(size_t index) override;
+
+   //! Bytes held by the spectrum and pixel caches of all channels
+   size_t GetMemory() const;
+
+   //! Discard the spectrum and pixel caches of all channels
+   //! @return bytes freed
+   size_t Evict();
+
+   //! Increases with each use of any cache, for eviction of the least
+   //! recently used first
+   unsigned long long mLastUse{ 0 };
 };
 
 #endif
@@ -26,9 +26,12 @@ Paul Licameli split from WaveChannelView.cpp
 #include "AColor.h"
 #include "PendingTracks.h"
 #include "Prefs.h"
+#include "SpectrogramTileStore.h"
+#include "Tracing.h"
 #include "NumberScale.h"
 #include "../../../../TrackArt.h"
 #include "../../../../TrackArtist.h"
+#include "../../../../TrackPanel.h"
 #include "../../../../TrackPanelDrawingContext.h"
 #include "ViewInfo.h"
 #include "WaveClip.h"
@@ -39,6 +42,7 @@ Paul Licameli split from WaveChannelView.cpp
 
 #include <wx/dcmemory.h>
 #include <wx/graphics.h>
+#include <wx/weakref.h>
 
 #include "float_cast.h"
 
@@ -348,9 +352,7 @@ void DrawClipSpectrum(TrackPanelDrawingContext &context,
   const auto &selectedRegion = *artist->pSelectedRegion;
   const auto &zoomInfo = *artist->pZoomInfo;
 
-#ifdef PROFILE_WAVEFORM
-   Profiler profiler;
-#endif
+   TRACE_SCOPE("DrawClipSpectrum");
 
    //If clip is "too small" draw a placeholder instead of
    //attempting to fit the contents into a few pixels
@@ -424,9 +426,21 @@ void DrawClipSpectrum(TrackPanelDrawingContext &context,
    const double binUnit = sampleRate / (2 * half);
    const float *freq = 0;
    const sampleCount *where = 0;
+   // Columns not yet calculated are drawn as silence, until they arrive from
+   // the background and the panel repaints
+   std::function<void()> onArrival;
+   if (artist->parent)
+      onArrival = [panel = wxWeakRef<wxWindow>{ artist->parent }]{
+         if (panel)
+            panel->Refresh(false);
+      };
+   SpectrogramTileStore *pStore = nullptr;
+   if (artist->parent && artist->parent->GetProject() &&
+       SpectrogramSettings::Globals::Get().keepInProjectFile)
+      pStore = &SpectrogramTileStore::Get(*artist->parent->GetProject());
    bool updated = WaveClipSpectrumCache::Get(clip).GetSpectrogram(
       clip, freq, settings, where, (size_t)hiddenMid.width, t0,
-      averagePixelsPerSecond);
+      averagePixelsPerSecond, move(onArrival), pStore);
    auto nBins = settings.NBins();
 
    float minFreq, maxFreq;
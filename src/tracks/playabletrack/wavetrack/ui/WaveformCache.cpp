@@ -10,11 +10,16 @@
 
 #include "WaveformCache.h"
 
+#include <algorithm>
 #include <cmath>
+#include <mutex>
+#include <optional>
 #include "Sequence.h"
 #include "GetWaveDisplay.h"
+#include "MemoryBudget.h"
 #include "WaveClipUIUtilities.h"
 #include "WaveTrack.h"
+#include "WaveformPyramid.h"
 
 class WaveCache {
 public:
@@ -56,8 +61,123 @@ public:
    std::vector<float> min;
    std::vector<float> max;
    std::vector<float> rms;
+
+   //! The sample blocks that the columns were computed from
+   struct Block {
+      sampleCount start;
+      size_t count;
+      long long id;
+   };
+   std::vector<Block> blocks;
+
+   size_t GetMemory() const
+   {
+      return sizeof(*this) + where.capacity() * sizeof(sampleCount) +
+         (min.capacity() + max.capacity() + rms.capacity()) * sizeof(float) +
+         blocks.capacity() * sizeof(Block);
+   }
+};
+
+struct WaveClipWaveformCache::ChannelPyramid
+{
+   WaveformPyramid pyramid;
+   //! Value of mDirty when blocks no longer in the sequence were discarded
+   int dirty{ -1 };
+};
+
+namespace {
+// Guards the set of caches, not their contents
+std::mutex &InstancesMutex()
+{
+   static std::mutex mutex;
+   return mutex;
+}
+
+std::vector<WaveClipWaveformCache*> &Instances()
+{
+   static std::vector<WaveClipWaveformCache*> instances;
+   return instances;
+}
+
+unsigned long long sUses = 0;
+
+// Rebuilt from the summaries of the blocks, which costs more than reading
+// the blocks again
+MemoryBudget::Consumer sConsumer{ "Waveform caches", 20,
+   []{
+      std::lock_guard<std::mutex> lock{ InstancesMutex() };
+      size_t bytes = 0;
+      for (auto pCache : Instances())
+         bytes += pCache->GetMemory();
+      return bytes;
+   },
+   [](size_t bytes){
+      std::lock_guard<std::mutex> lock{ InstancesMutex() };
+      auto instances = Instances();
+      std::sort(instances.begin(), instances.end(),
+         [](auto pCache1, auto pCache2){
+            return pCache1->mLastUse < pCache2->mLastUse; });
+      size_t freed = 0;
+      for (auto pCache : instances) {
+         if (freed >= bytes)
+            break;
+         freed += pCache->Evict();
+      }
+      return freed;
+   }
 };
 
+using ColumnRanges = std::vector<std::pair<size_t, size_t>>;
+
+//! Find the columns from begin to end, copied from the old cache, whose
+//! samples are not all in blocks that are in both caches at the same place
+/*!
+ Sample blocks never change, so an edit of a part of a long clip leaves most
+ columns valid.
+ */
+void FindStaleColumns(const WaveCache &oldCache, const WaveCache &newCache,
+   size_t begin, size_t end, ColumnRanges &ranges)
+{
+   // Merged intervals of samples in unchanged blocks
+   std::vector<std::pair<sampleCount, sampleCount>> unchanged;
+   const auto &oldBlocks = oldCache.blocks;
+   for (const auto &block : newCache.blocks) {
+      const auto iter = std::lower_bound(oldBlocks.begin(), oldBlocks.end(),
+         block.start, [](const WaveCache::Block &old, sampleCount start){
+            return old.start < start; });
+      if (iter == oldBlocks.end() || iter->start != block.start ||
+          iter->id != block.id || iter->count != block.count)
+         continue;
+      const auto blockEnd = block.start + block.count;
+      if (!unchanged.empty() && unchanged.back().second == block.start)
+         unchanged.back().second = blockEnd;
+      else
+         unchanged.emplace_back(block.start, blockEnd);
+   }
+
+   const auto &where = newCache.where;
+   auto interval = unchanged.begin();
+   std::optional<size_t> staleBegin;
+   for (auto ii = begin; ii < end; ++ii) {
+      // As in GetWaveDisplay, each column has at least one sample
+      const auto s0 = where[ii];
+      const auto s1 = std::max(where[ii + 1], s0 + 1);
+      while (interval != unchanged.end() && interval->second <= s0)
+         ++interval;
+      const bool valid = interval != unchanged.end() &&
+         interval->first <= s0 && s1 <= interval->second;
+      if (!valid && !staleBegin)
+         staleBegin = ii;
+      else if (valid && staleBegin) {
+         ranges.emplace_back(*staleBegin, ii);
+         staleBegin.reset();
+      }
+   }
+   if (staleBegin)
+      ranges.emplace_back(*staleBegin, end);
+}
+}
+
 //
 // Getting high-level data from the track for screen display and
 // clipping calculations
@@ -68,6 +188,7 @@ bool WaveClipWaveformCache::GetWaveDisplay(
    double t0, double pixelsPerSecond)
 {
    auto &waveCache = mWaveCaches[clip.GetChannelIndex()];
+   mLastUse = ++sUses;
 
    t0 += clip.GetTrimLeft();
 
@@ -82,6 +203,8 @@ bool WaveClipWaveformCache::GetWaveDisplay(
    float *max;
    float *rms;
    std::vector<sampleCount> *pWhere;
+   // Besides p0 to p1, columns to compute
+   ColumnRanges ranges;
 
    if (allocated) {
       // assume ownWhere is filled.
@@ -103,8 +226,9 @@ bool WaveClipWaveformCache::GetWaveDisplay(
          waveCache &&
          (fabs(samplesPerPixel - waveCache->samplesPerPixel) * numPixels < 1.0);
 
-      const bool match = waveCache && samplesPerPixelMatch &&
-                         waveCache->len > 0 && waveCache->dirty == mDirty;
+      const bool sameZoom =
+         waveCache && samplesPerPixelMatch && waveCache->len > 0;
+      const bool match = sameZoom && waveCache->dirty == mDirty;
 
       if (match &&
          waveCache->start == t0 &&
@@ -123,7 +247,9 @@ bool WaveClipWaveformCache::GetWaveDisplay(
       int oldX0 = 0;
       double correction = 0.0;
       size_t copyBegin = 0, copyEnd = 0;
-      if (match) {
+      // Columns computed before an edit may be reused too, if their
+      // samples did not change
+      if (sameZoom) {
          WaveClipUIUtilities::findCorrection(
             oldCache->where, oldCache->len, numPixels, t0, sampleRate,
             stretchRatio, samplesPerPixel, oldX0, correction);
@@ -150,6 +276,10 @@ bool WaveClipWaveformCache::GetWaveDisplay(
          *pWhere, numPixels, addBias, correction, t0, sampleRate, stretchRatio,
          samplesPerPixel);
 
+      for (const auto &block : clip.GetSequence().GetBlockArray())
+         waveCache->blocks.push_back({
+            block.start, block.sb->GetSampleCount(), block.sb->GetBlockID() });
+
       // The range of pixels we must fetch from the Sequence:
       p0 = (copyBegin > 0) ? 0 : copyEnd;
       p1 = (copyEnd >= numPixels) ? copyBegin : numPixels;
@@ -167,10 +297,31 @@ bool WaveClipWaveformCache::GetWaveDisplay(
          memcpy(&min[copyBegin], &oldCache->min[srcIdx], sizeFloats);
          memcpy(&max[copyBegin], &oldCache->max[srcIdx], sizeFloats);
          memcpy(&rms[copyBegin], &oldCache->rms[srcIdx], sizeFloats);
+
+         if (oldCache->dirty != mDirty) {
+            // Some copied columns may be stale after edits, except those
+            // computed anew anyway
+            auto staleBegin = copyBegin, staleEnd = copyEnd;
+            if (p1 > p0) {
+               if (p0 <= staleBegin)
+                  staleBegin = std::max(staleBegin, p1);
+               else
+                  staleEnd = std::min(staleEnd, p0);
+            }
+            if (staleEnd > staleBegin)
+               FindStaleColumns(
+                  *oldCache, *waveCache, staleBegin, staleEnd, ranges);
+         }
       }
    }
 
-   if (p1 > p0) {
+   // Compute the columns from p0 to p1, then those invalidated by edits
+   const bool requested = (p1 > p0);
+   if (requested)
+      ranges.emplace(ranges.begin(), p0, p1);
+   for (size_t iRange = 0; iRange < ranges.size(); ++iRange) {
+      auto [c0, c1] = ranges[iRange];
+      const bool stale = !requested || iRange > 0;
       // Cache was not used or did not satisfy the whole request
       std::vector<sampleCount> &where = *pWhere;
 
@@ -178,23 +329,23 @@ bool WaveClipWaveformCache::GetWaveDisplay(
 
       const auto &sequence = clip.GetSequence();
       auto numSamples = sequence.GetNumSamples();
-      auto a = p0;
+      auto a = c0;
 
       // Not all of the required columns might be in the sequence.
       // Some might be in the append buffer.
-      for (; a < p1; ++a) {
+      for (; a < c1; ++a) {
          if (where[a + 1] > numSamples)
             break;
       }
 
       // Handle the columns that land in the append buffer.
       //compute the values that are outside the overlap from scratch.
-      if (a < p1) {
+      if (a < c1) {
          const auto appendBufferLen = clip.GetAppendBufferLen();
          const auto &appendBuffer = clip.GetAppendBuffer();
          sampleFormat seqFormat = sequence.GetSampleFormats().Stored();
          bool didUpdate = false;
-         for(auto i = a; i < p1; i++) {
+         for(auto i = a; i < c1; i++) {
             auto left = std::max(sampleCount{ 0 },
                                  where[i] - numSamples);
             auto right = std::min(sampleCount{ appendBufferLen },
@@ -243,16 +394,26 @@ bool WaveClipWaveformCache::GetWaveDisplay(
 
          // Shrink the right end of the range to fetch from Sequence
          if(didUpdate)
-            p1 = a;
+            c1 = a;
       }
 
       // Done with append buffer, now fetch the rest of the cache miss
       // from the sequence
-      if (p1 > p0) {
-         if (!::GetWaveDisplay(sequence, &min[p0], &max[p0], &rms[p0], p1 - p0,
-            &where[p0]))
+      if (c1 > c0) {
+         auto &channelPyramid = *mPyramids[clip.GetChannelIndex()];
+         if (channelPyramid.dirty != mDirty) {
+            channelPyramid.pyramid.Retain(sequence.GetBlockArray());
+            channelPyramid.dirty = mDirty;
+         }
+         if (!::GetWaveDisplay(sequence, &min[c0], &max[c0], &rms[c0], c1 - c0,
+            &where[c0], &channelPyramid.pyramid))
          {
-            return false;
+            if (!stale)
+               return false;
+            // The edit shortened the sequence before these columns
+            std::fill(&min[c0], &min[c1], 0.0f);
+            std::fill(&max[c0], &max[c1], 0.0f);
+            std::fill(&rms[c0], &rms[c1], 0.0f);
          }
       }
    }
@@ -270,13 +431,22 @@ bool WaveClipWaveformCache::GetWaveDisplay(
 
 WaveClipWaveformCache::WaveClipWaveformCache(size_t nChannels)
    : mWaveCaches(nChannels)
+   , mPyramids(nChannels)
 {
    for (auto &pCache : mWaveCaches)
       pCache = std::make_unique<WaveCache>();
+   for (auto &pPyramid : mPyramids)
+      pPyramid = std::make_unique<ChannelPyramid>();
+   std::lock_guard<std::mutex> lock{ InstancesMutex() };
+   Instances().push_back(this);
 }
 
 WaveClipWaveformCache::~WaveClipWaveformCache()
 {
+   std::lock_guard<std::mutex> lock{ InstancesMutex() };
+   auto &instances = Instances();
+   instances.erase(
+      std::remove(instances.begin(), instances.end(), this), instances.end());
 }
 
 std::unique_ptr<WaveClipListener> WaveClipWaveformCache::Clone() const
@@ -313,16 +483,48 @@ void WaveClipWaveformCache::MakeStereo(WaveClipListener &&other, bool)
    auto pOther = dynamic_cast<WaveClipWaveformCache *>(&other);
    assert(pOther); // precondition
    mWaveCaches.push_back(move(pOther->mWaveCaches[0]));
+   mPyramids.push_back(move(pOther->mPyramids[0]));
 }
 
 void WaveClipWaveformCache::SwapChannels()
 {
    mWaveCaches.resize(2);
    std::swap(mWaveCaches[0], mWaveCaches[1]);
+   mPyramids.resize(2);
+   std::swap(mPyramids[0], mPyramids[1]);
+   for (auto &pPyramid : mPyramids)
+      if (!pPyramid)
+         pPyramid = std::make_unique<ChannelPyramid>();
 }
 
 void WaveClipWaveformCache::Erase(size_t index)
 {
    if (index < mWaveCaches.size())
       mWaveCaches.erase(mWaveCaches.begin() + index);
+   if (index < mPyramids.size())
+      mPyramids.erase(mPyramids.begin() + index);
+}
+
+size_t WaveClipWaveformCache::GetMemory() const
+{
+   size_t bytes = 0;
+   for (auto &pCache : mWaveCaches)
+      if (pCache)
+         bytes += pCache->GetMemory();
+   for (auto &pPyramid : mPyramids)
+      if (pPyramid)
+         bytes += pPyramid->pyramid.GetMemory();
+   return bytes;
+}
+
+size_t WaveClipWaveformCache::Evict()
+{
+   const auto bytes = GetMemory();
+   Invalidate();
+   for (auto &pPyramid : mPyramids)
+      if (pPyramid) {
+         pPyramid->pyramid.Clear();
+         pPyramid->dirty = -1;
+      }
+   return bytes - std::min(bytes, GetMemory());
 }
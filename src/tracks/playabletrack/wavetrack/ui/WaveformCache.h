@@ -58,6 +58,8 @@ public:
    }
 };
 
+//! Registered as a consumer of the MemoryBudget; caches are used, measured,
+//! and evicted only on the main thread, but may be made and destroyed on others
 struct WaveClipWaveformCache final : WaveClipListener
 {
    explicit WaveClipWaveformCache(size_t nChannels);
@@ -69,6 +71,10 @@ struct WaveClipWaveformCache final : WaveClipListener
    std::vector<std::unique_ptr<WaveCache>> mWaveCaches;
    int mDirty { 0 };
 
+   // Coarse summaries of the sample blocks of each channel, kept across edits
+   struct ChannelPyramid;
+   std::vector<std::unique_ptr<ChannelPyramid>> mPyramids;
+
    static WaveClipWaveformCache &Get(const WaveChannelInterval &clip);
 
    void MarkChanged() noexcept override; // NOFAIL-GUARANTEE
@@ -84,6 +90,17 @@ struct WaveClipWaveformCache final : WaveClipListener
    void MakeStereo(WaveClipListener &&other, bool aligned) override;
    void SwapChannels() override;
    void Erase(size_t index) override;
+
+   //! Bytes held by the caches and pyramids of all channels
+   size_t GetMemory() const;
+
+   //! Discard the caches and pyramids of all channels
+   //! @return bytes freed
+   size_t Evict();
+
+   //! Increases with each use of any cache, for eviction of the least
+   //! recently used first
+   unsigned long long mLastUse{ 0 };
 };
 
 #endif
@@ -0,0 +1,131 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file WaveformPyramid.cpp
+
+**********************************************************************/
+
+#include "WaveformPyramid.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cfloat>
+#include <cmath>
+#include <unordered_set>
+#include "SampleBlock.h"
+#include "Sequence.h"
+
+namespace {
+
+constexpr size_t Fields = 3; // min, max, rms
+
+//! Group frames of childDivisor samples of a block by WaveformPyramid::Ratio
+std::vector<float> Reduce(
+   const float *child, size_t childDivisor, size_t numSamples)
+{
+   const auto divisor = childDivisor * WaveformPyramid::Ratio;
+   const auto nChildren = (numSamples + childDivisor - 1) / childDivisor;
+   const auto nFrames = (numSamples + divisor - 1) / divisor;
+   std::vector<float> result(Fields * nFrames);
+   for (size_t ii = 0; ii < nFrames; ++ii) {
+      float min = FLT_MAX, max = -FLT_MAX;
+      double sumsq = 0;
+      size_t count = 0;
+      const auto end =
+         std::min(nChildren, (ii + 1) * WaveformPyramid::Ratio);
+      for (auto jj = ii * WaveformPyramid::Ratio; jj < end; ++jj) {
+         const float *const frame = child + Fields * jj;
+         min = std::min(min, frame[0]);
+         max = std::max(max, frame[1]);
+         // The last frame may be for fewer samples
+         const auto n = std::min(childDivisor, numSamples - jj * childDivisor);
+         sumsq += double(frame[2]) * frame[2] * n;
+         count += n;
+      }
+      float *const frame = &result[Fields * ii];
+      frame[0] = min;
+      frame[1] = max;
+      frame[2] = std::sqrt(sumsq / count);
+   }
+   return result;
+}
+
+}
+
+size_t WaveformPyramid::ChooseDivisor(double samplesPerPixel)
+{
+   if (samplesPerPixel < BaseDivisor)
+      return 0;
+   auto divisor = BaseDivisor;
+   while (divisor < MaxDivisor && divisor * Ratio <= samplesPerPixel)
+      divisor *= Ratio;
+   return divisor;
+}
+
+void WaveformPyramid::GetSummary(SampleBlock &block, size_t divisor,
+   float *dest, size_t frameOffset, size_t numFrames)
+{
+   size_t level = 0;
+   for (auto d = BaseDivisor; d < divisor; d *= Ratio)
+      ++level;
+   assert(level < NumLevels);
+   const auto &frames = GetLevels(block)[level];
+
+   const auto nFrames = frames.size() / Fields;
+   const auto first = std::min(frameOffset, nFrames);
+   const auto last = std::min(frameOffset + numFrames, nFrames);
+   const auto copied = std::copy(
+      frames.begin() + Fields * first, frames.begin() + Fields * last, dest);
+   std::fill(copied, dest + Fields * numFrames, 0.0f);
+}
+
+auto WaveformPyramid::GetLevels(SampleBlock &block) -> const Levels &
+{
+   const auto id = block.GetBlockID();
+   if (const auto iter = mLevels.find(id); iter != mLevels.end())
+      return iter->second;
+
+   const auto numSamples = block.GetSampleCount();
+   constexpr size_t SummaryDivisor = 256;
+   std::vector<float> summary256(
+      Fields * ((numSamples + SummaryDivisor - 1) / SummaryDivisor));
+   // Fills with zeroes if read fails
+   block.GetSummary256(summary256.data(), 0, summary256.size() / Fields);
+
+   Levels levels;
+   levels[0] = Reduce(summary256.data(), SummaryDivisor, numSamples);
+   for (size_t level = 1, divisor = BaseDivisor; level < NumLevels;
+        ++level, divisor *= Ratio)
+      levels[level] = Reduce(levels[level - 1].data(), divisor, numSamples);
+   return mLevels.emplace(id, std::move(levels)).first->second;
+}
+
+void WaveformPyramid::Retain(const BlockArray &blocks)
+{
+   std::unordered_set<long long> ids;
+   for (const auto &block : blocks)
+      ids.insert(block.sb->GetBlockID());
+   for (auto iter = mLevels.begin(); iter != mLevels.end();) {
+      if (ids.count(iter->first))
+         ++iter;
+      else
+         iter = mLevels.erase(iter);
+   }
+}
+
+size_t WaveformPyramid::GetMemory() const
+{
+   size_t bytes = 0;
+   for (const auto &[id, levels] : mLevels) {
+      bytes += sizeof(id) + sizeof(levels);
+      for (const auto &level : levels)
+         bytes += level.capacity() * sizeof(float);
+   }
+   return bytes;
+}
+
+void WaveformPyramid::Clear()
+{
+   mLevels.clear();
+}
@@ -0,0 +1,68 @@
+/**********************************************************************
+
+  Audacity: A Digital Audio Editor
+
+  @file WaveformPyramid.h
+
+**********************************************************************/
+
+#ifndef __AUDACITY_WAVEFORM_PYRAMID__
+#define __AUDACITY_WAVEFORM_PYRAMID__
+
+#include <array>
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+class BlockArray;
+class SampleBlock;
+
+//! Summaries of the blocks of one channel of a clip, coarser than the
+//! 256-sample summaries that the blocks store
+/*!
+ Each level groups four frames of the level below into one frame
+ of min, max, and rms, from 1024 up to 65536 samples per frame, aligned to
+ the start of the block.  Levels of a block are built on first use from its
+ 256-sample summary, which is read only once.
+
+ Sample blocks never change, so the levels are kept by block id and survive
+ edits of the clip; only those of blocks no longer in the sequence are
+ discarded, by Retain().
+ */
+class WaveformPyramid
+{
+public:
+   static constexpr size_t BaseDivisor = 1024;
+   static constexpr size_t Ratio = 4;
+   static constexpr size_t NumLevels = 4;
+   static constexpr size_t MaxDivisor = 65536;
+
+   //! Coarsest divisor of a level, not more than samples per pixel
+   //! @return 0 if samples per pixel are less than BaseDivisor
+   static size_t ChooseDivisor(double samplesPerPixel);
+
+   //! Copy triples of min, max, and rms into dest
+   /*!
+    @pre `divisor` is a result of ChooseDivisor, not 0
+    Fills with zeroes past the end of the block
+    */
+   void GetSummary(SampleBlock &block, size_t divisor,
+      float *dest, size_t frameOffset, size_t numFrames);
+
+   //! Discard the levels of blocks not in the array
+   void Retain(const BlockArray &blocks);
+
+   //! Bytes held by the levels of all blocks
+   size_t GetMemory() const;
+
+   //! Discard the levels of all blocks; they are built again when used
+   void Clear();
+
+private:
+   using Levels = std::array<std::vector<float>, NumLevels>;
+   const Levels &GetLevels(SampleBlock &block);
+
+   std::unordered_map<long long, Levels> mLevels;
+};
+
+#endif
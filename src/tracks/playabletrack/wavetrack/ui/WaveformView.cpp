@@ -332,6 +332,45 @@ void FindWavePortions
    }
 }
 
+//! Fill the union of one pixel wide columns, from tops[ii] down to
+//! bottoms[ii] inclusive, at x + ii, with one polygon for each run of
+//! nonempty columns
+/*!
+ Much faster than a line for each column, which made the paint time grow with
+ the number of tracks; the result is the same pixels.
+ Columns with bottoms[ii] < tops[ii] are skipped.
+ */
+void FillColumns(wxDC &dc, const wxColour &colour, int x, int y,
+   const int *tops, const int *bottoms, int width)
+{
+   dc.SetPen(*wxTRANSPARENT_PEN);
+   dc.SetBrush(wxBrush{ colour });
+
+   // Steps along the tops left to right, then the bottoms right to left
+   std::vector<wxPoint> points;
+   points.reserve(4 * width);
+   for (int x0 = 0; x0 < width;) {
+      if (bottoms[x0] < tops[x0]) {
+         ++x0;
+         continue;
+      }
+      int x1 = x0;
+      while (x1 < width && bottoms[x1] >= tops[x1])
+         ++x1;
+      points.clear();
+      for (int ii = x0; ii < x1; ++ii) {
+         points.emplace_back(x + ii, y + tops[ii]);
+         points.emplace_back(x + ii + 1, y + tops[ii]);
+      }
+      for (int ii = x1; ii-- > x0;) {
+         points.emplace_back(x + ii + 1, y + bottoms[ii] + 1);
+         points.emplace_back(x + ii, y + bottoms[ii] + 1);
+      }
+      dc.DrawPolygon(static_cast<int>(points.size()), points.data());
+      x0 = x1;
+   }
+}
+
 void DrawMinMaxRMS(
    TrackPanelDrawingContext &context, const wxRect & rect, const double env[],
    float zoomMin, float zoomMax,
@@ -349,6 +388,8 @@ void DrawMinMaxRMS(
    int h2;
    ArrayOf<int> r1{ size_t(rect.width) };
    ArrayOf<int> r2{ size_t(rect.width) };
+   ArrayOf<int> tops{ size_t(rect.width) };
+   ArrayOf<int> bottoms{ size_t(rect.width) };
    ArrayOf<int> clipped;
    int clipcnt = 0;
 
@@ -367,7 +408,6 @@ void DrawMinMaxRMS(
    const auto &muteSamplePen = artist->muteSamplePen;
    const auto &samplePen = artist->samplePen;
 
-   dc.SetPen(muted ? muteSamplePen : samplePen);
    for (int x0 = 0; x0 < rect.width; ++x0) {
       int xx = rect.x + x0;
       double v;
@@ -419,20 +459,24 @@ void DrawMinMaxRMS(
          r2[x0] = r1[x0];
       }
 
-      AColor::Line(dc, xx, rect.y + h2, xx, rect.y + h1);
+      // A line from h2 to h1, either way up
+      tops[x0] = std::min(h1, h2);
+      bottoms[x0] = std::max(h1, h2);
    }
+   FillColumns(dc, (muted ? muteSamplePen : samplePen).GetColour(),
+      rect.x, rect.y, tops.get(), bottoms.get(), rect.width);
 
-   // Stroke rms over the min-max
+   // Stroke rms over the min-max, but not where its ends coincide
    const auto &muteRmsPen = artist->muteRmsPen;
    const auto &rmsPen = artist->rmsPen;
 
-   dc.SetPen(muted ? muteRmsPen : rmsPen);
    for (int x0 = 0; x0 < rect.width; ++x0) {
-      int xx = rect.x + x0;
-      if (r1[x0] != r2[x0]) {
-         AColor::Line(dc, xx, rect.y + r2[x0], xx, rect.y + r1[x0]);
-      }
+      // r2 is not below r1, as adjusted above
+      tops[x0] = r2[x0];
+      bottoms[x0] = (r1[x0] != r2[x0]) ? r1[x0] : r1[x0] - 1;
    }
+   FillColumns(dc, (muted ? muteRmsPen : rmsPen).GetColour(),
+      rect.x, rect.y, tops.get(), bottoms.get(), rect.width);
 
    // Draw the clipping lines
    if (clipcnt) {
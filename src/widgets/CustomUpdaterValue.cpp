@@ -86,7 +86,8 @@ bool CustomUpdaterValue::TickCustom(wxDC& dc, int labelIdx, wxFont font,
       outputs.bits,
       mLeft, mTop, spacing, mFonts.lead,
       mFlip,
-      mOrientation);
+      mOrientation,
+      &context.mTextCache);
 
    if (!result.second.text)
       // Always a non-empty optional
@@ -44,7 +44,8 @@ bool GeneratedUpdater::Tick(wxDC& dc,
    Label lab;
    lab.value = d;
    lab.pos = pos;
-   lab.text = tickSizes.LabelString(d, context.mpRulerFormat);
+   lab.text = tickSizes.LabelString(
+      d, context.mpRulerFormat, &context.mTextCache);
    lab.units = mUnits;
 
    const auto result = RulerUpdater::MakeTick(
@@ -53,7 +54,8 @@ bool GeneratedUpdater::Tick(wxDC& dc,
       outputs.bits,
       mLeft, mTop, spacing, mFonts.lead,
       mFlip,
-      mOrientation);
+      mOrientation,
+      &context.mTextCache);
 
    auto& rect = result.first;
    outputs.box.Union(rect);
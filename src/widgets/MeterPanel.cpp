@@ -61,6 +61,8 @@
 #include "ImageManipulation.h"
 #include "Decibels.h"
 #include "LinearUpdater.h"
+#include "../LoudnessMeter.h"
+#include "MeterLevels.h"
 #include "Project.h"
 #include "ProjectAudioIO.h"
 #include "ProjectStatus.h"
@@ -331,6 +333,9 @@ MeterPanel::MeterPanel(AudacityProject *project,
 
    mIsFocused = false;
 
+   if (!mIsInput && mStyle != MixerTrackCluster && mProject)
+      mpLoudnessMeter = &LoudnessMeter::Get(*mProject);
+
 #if wxUSE_ACCESSIBILITY
    SetAccessible(safenew MeterAx(this));
 #endif
@@ -903,6 +908,10 @@ void MeterPanel::Reset(double sampleRate, bool resetClipping)
       ResetBar(&mBar[j], resetClipping);
    }
 
+   // Loudness integrates over each playback, but the readings stay after it
+   if (mpLoudnessMeter && resetClipping)
+      mpLoudnessMeter->Reset(sampleRate);
+
    // wxTimers seem to be a little unreliable - sometimes they stop for
    // no good reason, so this "primes" it every now and then...
    mTimer.Stop();
@@ -957,38 +966,31 @@ static float ToDB(float v, float range)
 void MeterPanel::UpdateDisplay(
    unsigned numChannels, int numFrames, const float *sampleData)
 {
-   auto sptr = sampleData;
    auto num = std::min(numChannels, mNumBars);
    MeterUpdateMsg msg;
 
    memset(&msg, 0, sizeof(msg));
    msg.numFrames = numFrames;
 
-   for(int i=0; i<numFrames; i++) {
-      for(unsigned int j=0; j<num; j++) {
-         msg.peak[j] = floatMax(msg.peak[j], fabs(sptr[j]));
-         msg.rms[j] += sptr[j]*sptr[j];
-
-         // In addition to looking for mNumPeakSamplesToClip peaked
-         // samples in a row, also send the number of peaked samples
-         // at the head and tail, in case there's a run of peaked samples
-         // that crosses block boundaries
-         if (fabs(sptr[j])>=MAX_AUDIO) {
-            if (msg.headPeakCount[j]==i)
-               msg.headPeakCount[j]++;
-            msg.tailPeakCount[j]++;
-            if (msg.tailPeakCount[j] > mNumPeakSamplesToClip)
-               msg.clipping[j] = true;
-         }
-         else
-            msg.tailPeakCount[j] = 0;
-      }
-      sptr += numChannels;
+   // In addition to looking for mNumPeakSamplesToClip peaked
+   // samples in a row, also send the number of peaked samples
+   // at the head and tail, in case there's a run of peaked samples
+   // that crosses block boundaries
+   MeterLevels::Levels levels[kMaxMeterBars];
+   MeterLevels::Measure(sampleData, numChannels, std::max(numFrames, 0),
+      levels, num, mNumPeakSamplesToClip, MAX_AUDIO);
+   for(unsigned int j=0; j<num; j++) {
+      msg.peak[j] = levels[j].peak;
+      msg.rms[j] = levels[j].rms;
+      msg.clipping[j] = levels[j].clipping;
+      msg.headPeakCount[j] = levels[j].headPeakCount;
+      msg.tailPeakCount[j] = levels[j].tailPeakCount;
    }
-   for(unsigned int j=0; j<mNumBars; j++)
-      msg.rms[j] = sqrt(msg.rms[j]/numFrames);
 
    mQueue.Put(msg);
+
+   if (mpLoudnessMeter)
+      mpLoudnessMeter->Process(numChannels, std::max(numFrames, 0), sampleData);
 }
 
 // Vaughan, 2010-11-29: This not currently used. See comments in MixerTrackCluster::UpdateMeter().
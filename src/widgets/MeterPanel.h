@@ -31,6 +31,7 @@
 
 class AudacityProject;
 struct AudioIOEvent;
+class LoudnessMeter;
 
 // Increase this when we add support for multichannel meters
 // (most of the code is already there)
@@ -251,6 +252,8 @@ class AUDACITY_DLL_API MeterPanel final
    Observer::Subscription mAudioCaptureSubscription;
 
    AudacityProject *mProject;
+   //! Of the project, fed by the playback meter of its toolbar, else null
+   LoudnessMeter *mpLoudnessMeter{};
    MeterUpdateQueue mQueue;
    wxTimer          mTimer;
    wxTimer          mTipTimer;
@@ -113,7 +113,7 @@ void Ruler::SetUpdater(const RulerUpdater *pUpdater)
 {
    if (mpUpdater != pUpdater) {
       mpUpdater = pUpdater;
-      Invalidate();
+      InvalidateLayout();
    }
 }
 
@@ -134,7 +134,7 @@ void Ruler::SetDbMirrorValue( const double d )
    if (mRulerStruct.mDbMirrorValue != d) {
       mRulerStruct.mDbMirrorValue = d;
 
-      Invalidate();
+      InvalidateLayout();
    }
 }
 
@@ -145,7 +145,7 @@ void Ruler::SetOrientation(int orient)
    if (mRulerStruct.mOrientation != orient) {
       mRulerStruct.mOrientation = orient;
 
-      Invalidate();
+      InvalidateLayout();
    }
 }
 
@@ -172,7 +172,7 @@ void Ruler::SetRange
       mRulerStruct.mHiddenMin = hiddenMin;
       mRulerStruct.mHiddenMax = hiddenMax;
 
-      Invalidate();
+      InvalidateLayout();
    }
 }
 
@@ -185,7 +185,7 @@ void Ruler::SetLabelEdges(bool labelEdges)
    if (mRulerStruct.mLabelEdges != labelEdges) {
       mRulerStruct.mLabelEdges = labelEdges;
 
-      Invalidate();
+      InvalidateLayout();
    }
 }
 
@@ -198,7 +198,7 @@ void Ruler::SetFlip(bool flip)
    if (mRulerStruct.mFlip != flip) {
       mRulerStruct.mFlip = flip;
 
-      Invalidate();
+      InvalidateLayout();
    }
 }
 
@@ -248,7 +248,7 @@ void Ruler::SetNumberScale(const NumberScale &scale)
 {
    if ( mRulerStruct.mNumberScale != scale ) {
       mRulerStruct.mNumberScale = scale;
-      Invalidate();
+      InvalidateLayout();
    }
 }
 
@@ -268,7 +268,7 @@ void Ruler::SetTickLengths(const TickLengths& tLengths)
       inv = true;
    }
 
-   if (inv) Invalidate();
+   if (inv) InvalidateLayout();
 }
 
 void Ruler::OfflimitsPixels(int start, int end)
@@ -298,7 +298,7 @@ void Ruler::OfflimitsPixels(int start, int end)
    for(int i = start; i <= end; i++)
       mUserBits[i] = true;
 
-   Invalidate();
+   InvalidateLayout();
 }
 
 void Ruler::SetBounds(int left, int top, int right, int bottom)
@@ -310,11 +310,17 @@ void Ruler::SetBounds(int left, int top, int right, int bottom)
       mRulerStruct.mRight = right;
       mRulerStruct.mBottom = bottom;
 
-      Invalidate();
+      InvalidateLayout();
    }
 }
 
 void Ruler::Invalidate()
+{
+   mRulerStruct.mTextCache.Clear();
+   InvalidateLayout();
+}
+
+void Ruler::InvalidateLayout()
 {
    if (mRulerStruct.mOrientation == wxHORIZONTAL)
       mRulerStruct.mLength = mRulerStruct.mRight-mRulerStruct.mLeft;
@@ -507,7 +513,8 @@ void Ruler::Draw(wxDC& dc, const Envelope* envelope) const
          }
       }
 
-      label.Draw(dc, mTwoTone, mTickColour, mRulerStruct.mpFonts);
+      label.Draw(dc, mTwoTone, mTickColour, mRulerStruct.mpFonts,
+         &mRulerStruct.mTextCache);
    };
 
    for( const auto &label : cache.mMajorLabels )
@@ -135,11 +135,16 @@ class AUDACITY_DLL_API Ruler :
    void SetTickColour( const wxColour & colour)
    { mTickColour = colour; mPen.SetColour( colour );}
 
-   // Force regeneration of labels at next draw time
+   // Force regeneration of labels at next draw time, also of their texts,
+   // in case the state of the format was mutated elsewhere
    void Invalidate();
 
  private:
 
+   // Force regeneration of labels at next draw time, but reuse texts that
+   // were formatted and measured before, as the ruler scrolls
+   void InvalidateLayout();
+
    void ChooseFonts( wxDC &dc ) const;
 
    void UpdateCache( wxDC &dc, const Envelope* envelope ) const;
@@ -59,8 +59,43 @@ RulerUpdater::TickSizes::TickSizes(
          format->SetTickSizes(mUnits, mMajor, mMinor, mMinorMinor, mDigits);
    }
 
+namespace {
+// Bound the caches, though they would not grow much, unless zooming often
+constexpr size_t MaxCachedTexts = 4096;
+}
+
+const wxString &RulerStruct::TextCache::GetString(
+   const StringKey &key, const std::function<wxString()> &format)
+{
+   if (auto iter = mStrings.find(key); iter != mStrings.end())
+      return iter->second;
+   if (mStrings.size() >= MaxCachedTexts)
+      mStrings.clear();
+   return mStrings.emplace(key, format()).first->second;
+}
+
+auto RulerStruct::TextCache::GetExtent(
+   wxDC &dc, const wxString &text, const wxFont &font) -> const Extent &
+{
+   const ExtentKey key{ text, font.GetPointSize(), font.GetWeight() };
+   if (auto iter = mExtents.find(key); iter != mExtents.end())
+      return iter->second;
+   if (mExtents.size() >= MaxCachedTexts)
+      mExtents.clear();
+   Extent extent{};
+   dc.GetTextExtent(text,
+      &extent.width, &extent.height, &extent.descent, &extent.lead, &font);
+   return mExtents.emplace(key, extent).first->second;
+}
+
+void RulerStruct::TextCache::Clear()
+{
+   mStrings.clear();
+   mExtents.clear();
+}
+
 TranslatableString RulerUpdater::TickSizes::LabelString(
-   double d, const RulerFormat *format) const
+   double d, const RulerFormat *format, RulerStruct::TextCache *pCache) const
    {
       // Given a value, turn it into a string according
       // to the current ruler format.  The number of digits of
@@ -70,22 +105,29 @@ TranslatableString RulerUpdater::TickSizes::LabelString(
       // Should not be called unless TickSizes is instantiated
       wxASSERT(mUnits > 0);
 
-      wxString s;
+      const auto makeString = [&]{
+         wxString s;
 
-      // PRL Todo: are all these cases properly localized?  (Decimal points,
-      // hour-minute-second, etc.?)
+         // PRL Todo: are all these cases properly localized?  (Decimal points,
+         // hour-minute-second, etc.?)
 
-      if (format)
-         format->SetLabelString(s, d, mUnits, mMinor, mDigits, tickType);
+         if (format)
+            format->SetLabelString(s, d, mUnits, mMinor, mDigits, tickType);
+         return s;
+      };
 
-      auto result = Verbatim(s);
+      auto result = pCache
+         ? Verbatim(pCache->GetString(
+            { d, mUnits, mMinor, mDigits, tickType }, makeString))
+         : Verbatim(makeString());
 
       return result;
  }
 
 void RulerUpdater::Label::Draw(
    wxDC& dc, bool twoTone, wxColour c,
-   std::unique_ptr<RulerStruct::Fonts>& fonts) const
+   std::unique_ptr<RulerStruct::Fonts>& fonts,
+   RulerStruct::TextCache *pCache) const
 {
    if (text.has_value() && !text->empty()) {
       bool altColor = twoTone && value < 0.0;
@@ -95,9 +137,11 @@ void RulerUpdater::Label::Draw(
       if (dc.GetFont() == fonts->major) {
          // Do not draw units as bolded
          dc.DrawText(text->Translation(), lx, ly);
-         wxSize textSize = dc.GetTextExtent(text->Translation());
+         const auto width = pCache
+            ? pCache->GetExtent(dc, text->Translation(), fonts->major).width
+            : dc.GetTextExtent(text->Translation()).GetWidth();
          dc.SetFont(fonts->minor);
-         int unitX = lx + textSize.GetWidth();
+         int unitX = lx + width;
          dc.DrawText(units.Translation(), unitX, ly);
          dc.SetFont(fonts->major);
       }
@@ -113,7 +157,7 @@ auto RulerUpdater::MakeTick(
    wxDC& dc, wxFont font,
    std::vector<bool>& bits,
    int left, int top, int spacing, int lead,
-   bool flip, int orientation)
+   bool flip, int orientation, RulerStruct::TextCache *pCache)
    -> std::pair< wxRect, Label >
 {
    lab.lx = left - 1000; // don't display
@@ -131,7 +175,13 @@ auto RulerUpdater::MakeTick(
    // Do not put the text into results until we are sure it does not overlap
    lab.text = {};
    lab.units = {};
-   dc.GetTextExtent(str.Translation(), &strW, &strH, &strD, &strL);
+   if (pCache) {
+      const auto &extent = pCache->GetExtent(dc, str.Translation(), font);
+      strW = extent.width, strH = extent.height,
+         strD = extent.descent, strL = extent.lead;
+   }
+   else
+      dc.GetTextExtent(str.Translation(), &strW, &strH, &strD, &strL);
 
    int strPos, strLen, strLeft, strTop;
    if (orientation == wxHORIZONTAL) {
@@ -18,7 +18,10 @@
 #include "RulerFormat.h" // member variable
 
 #include <wx/font.h>
+#include <functional>
+#include <map>
 #include <optional>
+#include <tuple>
 
 class wxDC;
 class wxColor;
@@ -52,6 +55,27 @@ struct RulerStruct {
    mutable std::unique_ptr<Fonts> mpFonts;
    TranslatableString mUnits;
 
+   //! Label strings and their extents, kept while the ticks only move, as in
+   //! scrolling; cleared when the format, the units or the fonts change
+   struct TextCache {
+      //! Value, units, minor, digits, tick type
+      using StringKey = std::tuple<double, double, double, int, int>;
+      //! Text, point size, weight
+      using ExtentKey = std::tuple<wxString, int, int>;
+      struct Extent { wxCoord width, height, descent, lead; };
+
+      const wxString &GetString(const StringKey &key,
+         const std::function<wxString()> &format);
+      const Extent &GetExtent(wxDC &dc, const wxString &text,
+         const wxFont &font);
+      void Clear();
+
+   private:
+      std::map<StringKey, wxString> mStrings;
+      std::map<ExtentKey, Extent> mExtents;
+   };
+   mutable TextCache mTextCache;
+
    NumberScale mNumberScale;
 };
 
@@ -69,7 +93,8 @@ public:
       TranslatableString units;
 
       void Draw(wxDC& dc, bool twoTone, wxColour c,
-         std::unique_ptr<RulerStruct::Fonts>& fonts) const;
+         std::unique_ptr<RulerStruct::Fonts>& fonts,
+         RulerStruct::TextCache *pCache = nullptr) const;
    };
    using Labels = std::vector<Label>;
 
@@ -108,7 +133,8 @@ protected:
          double UPP, int orientation, const RulerFormat *format, bool log
       );
 
-      TranslatableString LabelString(double d, const RulerFormat *format) const;
+      TranslatableString LabelString(double d, const RulerFormat *format,
+         RulerStruct::TextCache *pCache = nullptr) const;
    };
 
    static std::pair< wxRect, Label > MakeTick(
@@ -116,7 +142,8 @@ protected:
       wxDC& dc, wxFont font,
       std::vector<bool>& bits,
       int left, int top, int spacing, int lead,
-      bool flip, int orientation);
+      bool flip, int orientation,
+      RulerStruct::TextCache *pCache = nullptr);
 
    void BoxAdjust(
       UpdateOutputs& allOutputs,